@@ -0,0 +1,355 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Microbenchmarks for the synthesis hot paths. Built with the same flags as
+// the library so the internal structures match.
+//
+// usage: SonivoxBenchmark [-P <path_to_res_folder>] [benchmark options]
+//
+// BM_DLSParser converts the first DLS collection found in kDLSFile from the
+// resource folder (the SonivoxTest resources), all other inputs are synthetic.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+extern "C" {
+#include "eas_data.h"
+#include "eas_host.h"
+#include "eas_math.h"
+#include "eas_mdls.h"
+#include "eas_mixer.h"
+#include "eas_reverb.h"
+#include "eas_wtengine.h"
+#include "eas_wtsynth.h"
+}
+
+static constexpr const char *kDLSFile = "testmxmf.mxmf";
+static constexpr EAS_I32 kWaveSize = 1024;
+static constexpr EAS_I32 kTicksPerBeat = 480;
+
+static std::string gResPath = "/data/local/tmp/SonivoxTestRes/";
+
+// time_per_sample from the number of samples rendered per iteration, plus
+// voices_per_core (voices one core can render in real time) for voice
+// benchmarks or realtime_x (multiple of real time) for the others
+static void setSampleCounters(benchmark::State &state, double samplesPerIteration,
+                              bool perVoice) {
+    double samples = samplesPerIteration * state.iterations();
+    state.counters["time_per_sample"] = benchmark::Counter(
+            samples, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters[perVoice ? "voices_per_core" : "realtime_x"] =
+            benchmark::Counter(samples / _OUTPUT_SAMPLE_RATE, benchmark::Counter::kIsRate);
+}
+
+static EAS_RESULT openMemoryStream(EAS_DATA_HANDLE *pEASData, EAS_HANDLE *pStream,
+                                   EAS_FILE *pFile, EAS_MEMORY_FILE *pMemFile,
+                                   const std::vector<uint8_t> &data) {
+    EAS_RESULT result;
+    EAS_InitMemoryLocator(pFile, pMemFile, data.data(), (EAS_I32)data.size());
+    if ((result = EAS_Init(pEASData)) != EAS_SUCCESS) return result;
+    if ((result = EAS_OpenFile(*pEASData, pFile, pStream)) != EAS_SUCCESS) return result;
+    return EAS_Prepare(*pEASData, *pStream);
+}
+
+static void closeMemoryStream(EAS_DATA_HANDLE easData, EAS_HANDLE stream) {
+    EAS_CloseFile(easData, stream);
+    EAS_Shutdown(easData);
+}
+
+static void putVarLength(std::vector<uint8_t> &out, uint32_t value) {
+    uint8_t bytes[4];
+    int count = 0;
+    do {
+        bytes[count++] = value & 0x7f;
+        value >>= 7;
+    } while (value);
+    while (count--) out.push_back(bytes[count] | (count ? 0x80 : 0));
+}
+
+// type 0 SMF at 120 bpm with eventsPerBeat note on/off events per beat
+static std::vector<uint8_t> makeSMF(int eventsPerBeat, int beats) {
+    std::vector<uint8_t> track = {0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20};
+    uint32_t delta = 0;
+    uint32_t ticks = kTicksPerBeat / eventsPerBeat;
+    for (int i = 0; i < eventsPerBeat * beats; i++) {
+        uint8_t channel = (i >> 1) % 16;
+        uint8_t note = 36 + (i >> 1) % 48;
+        putVarLength(track, delta);
+        track.push_back(((i & 1) ? 0x80 : 0x90) | channel);
+        track.push_back(note);
+        track.push_back((i & 1) ? 0 : 100);
+        delta = ticks;
+    }
+    putVarLength(track, delta);
+    track.insert(track.end(), {0xff, 0x2f, 0x00});
+
+    std::vector<uint8_t> smf = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1,
+                                kTicksPerBeat >> 8, kTicksPerBeat & 0xff,
+                                'M', 'T', 'r', 'k'};
+    uint32_t size = track.size();
+    for (int shift = 24; shift >= 0; shift -= 8) smf.push_back((size >> shift) & 0xff);
+    smf.insert(smf.end(), track.begin(), track.end());
+    return smf;
+}
+
+// args: number of voices, filter enabled, cubic interpolation
+static void BM_WTProcessVoice(benchmark::State &state) {
+    EAS_I32 numVoices = state.range(0);
+    std::vector<EAS_SAMPLE> wave(kWaveSize + 1);
+    for (EAS_I32 i = 0; i <= kWaveSize; i++) {
+        wave[i] = (EAS_SAMPLE)(((i * 97) & 0x7fff) - 0x4000);
+    }
+
+    std::vector<S_WT_VOICE> voices(numVoices);
+    std::vector<S_WT_INT_FRAME> frames(numVoices);
+    std::vector<EAS_PCM> voiceBuffer(BUFFER_SIZE_IN_MONO_SAMPLES);
+    std::vector<EAS_I32> mixBuffer(BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS);
+    for (EAS_I32 i = 0; i < numVoices; i++) {
+        S_WT_VOICE *pVoice = &voices[i];
+        S_WT_INT_FRAME *pFrame = &frames[i];
+        memset(pVoice, 0, sizeof(*pVoice));
+        memset(pFrame, 0, sizeof(*pFrame));
+        pVoice->loopStart = (EAS_U32)(uintptr_t)&wave[0];
+        pVoice->loopEnd = (EAS_U32)(uintptr_t)&wave[kWaveSize - 1];
+        pVoice->phaseAccum = (EAS_U32)(uintptr_t)&wave[(i * 37) % kWaveSize];
+#if (NUM_OUTPUT_CHANNELS == 2)
+        pVoice->gainLeft = 0x5a82;
+        pVoice->gainRight = 0x5a82;
+#endif
+        pFrame->frame.gainTarget = 0x2000;
+        pFrame->prevGain = 0x2000;
+        // a spread of pitches around the original sample pitch
+        pFrame->frame.phaseIncrement = PHASE_ONE / 2 + (i * PHASE_ONE) / numVoices;
+#ifdef _FILTER_ENABLED
+        if (state.range(1)) WT_SetFilterCoeffs(pFrame, -1200 - 64 * i, i & FILTER_Q_MASK);
+#endif
+#ifdef _CUBIC_INTERPOLATION
+        pVoice->sampleStart = pVoice->loopStart;
+        pFrame->cubic = (EAS_BOOL)state.range(2);
+#endif
+        pFrame->pAudioBuffer = voiceBuffer.data();
+        pFrame->pMixBuffer = mixBuffer.data();
+        pFrame->numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+    }
+
+    for (auto _ : state) {
+        memset(mixBuffer.data(), 0, mixBuffer.size() * sizeof(EAS_I32));
+        for (EAS_I32 i = 0; i < numVoices; i++) WT_ProcessVoice(&voices[i], &frames[i]);
+        benchmark::DoNotOptimize(mixBuffer.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, (double)numVoices * BUFFER_SIZE_IN_MONO_SAMPLES, true);
+}
+BENCHMARK(BM_WTProcessVoice)->ArgsProduct({{1, 8, 32, MAX_SYNTH_VOICES}, {0, 1}, {0, 1}});
+
+static void BM_SynthMasterGain(benchmark::State &state) {
+    std::vector<EAS_I32> mixBuffer(BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS);
+    std::vector<EAS_PCM> output(BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS);
+    for (size_t i = 0; i < mixBuffer.size(); i++) mixBuffer[i] = (EAS_I32)(i * 7919) - 0x80000;
+
+    for (auto _ : state) {
+        SynthMasterGain(mixBuffer.data(), output.data(), 0x4000,
+                        BUFFER_SIZE_IN_MONO_SAMPLES);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, BUFFER_SIZE_IN_MONO_SAMPLES, false);
+}
+BENCHMARK(BM_SynthMasterGain);
+
+// master gain plus all enabled post-processing effects, arg: reverb enabled
+static void BM_MixEnginePost(benchmark::State &state) {
+    EAS_DATA_HANDLE easData;
+    if (EAS_Init(&easData) != EAS_SUCCESS) {
+        state.SkipWithError("Failed to initialize synthesizer library");
+        return;
+    }
+    EAS_SetParameter(easData, EAS_MODULE_REVERB, EAS_PARAM_REVERB_BYPASS, !state.range(0));
+    std::vector<EAS_PCM> output(BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS);
+    easData->pOutputAudioBuffer = output.data();
+
+    for (auto _ : state) {
+        for (EAS_I32 i = 0; i < BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS; i++) {
+            easData->pMixBuffer[i] = (EAS_I32)(i * 7919) - 0x80000;
+        }
+        EAS_MixEnginePost(easData, BUFFER_SIZE_IN_MONO_SAMPLES);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, BUFFER_SIZE_IN_MONO_SAMPLES, false);
+    EAS_Shutdown(easData);
+}
+BENCHMARK(BM_MixEnginePost)->Arg(0)->Arg(1);
+
+// the reverb effect alone, arg: preset
+static void BM_Reverb(benchmark::State &state) {
+    EAS_DATA_HANDLE easData;
+    if (EAS_Init(&easData) != EAS_SUCCESS) {
+        state.SkipWithError("Failed to initialize synthesizer library");
+        return;
+    }
+    S_EFFECTS_MODULE *pReverb = &easData->effectsModules[EAS_MODULE_REVERB];
+    if (pReverb->effectData == NULL) {
+        EAS_Shutdown(easData);
+        state.SkipWithError("Reverb not available");
+        return;
+    }
+    EAS_SetParameter(easData, EAS_MODULE_REVERB, EAS_PARAM_REVERB_PRESET, state.range(0));
+    EAS_SetParameter(easData, EAS_MODULE_REVERB, EAS_PARAM_REVERB_BYPASS, EAS_FALSE);
+    std::vector<EAS_PCM> buffer(BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS);
+    for (size_t i = 0; i < buffer.size(); i++) buffer[i] = (EAS_PCM)((i * 7919) & 0x3fff);
+
+    for (auto _ : state) {
+        (*pReverb->effect->pfProcess)(pReverb->effectData, buffer.data(), buffer.data(),
+                                      BUFFER_SIZE_IN_MONO_SAMPLES);
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, BUFFER_SIZE_IN_MONO_SAMPLES, false);
+    EAS_Shutdown(easData);
+}
+BENCHMARK(BM_Reverb)->DenseRange(EAS_PARAM_REVERB_LARGE_HALL, EAS_PARAM_REVERB_ROOM);
+
+static void BM_DLSParser(benchmark::State &state) {
+    std::string path = gResPath + kDLSFile;
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == NULL) {
+        state.SkipWithError(("Failed to open " + path).c_str());
+        return;
+    }
+    std::vector<uint8_t> data;
+    uint8_t block[4096];
+    size_t count;
+    while ((count = fread(block, 1, sizeof(block), fp)) > 0) {
+        data.insert(data.end(), block, block + count);
+    }
+    fclose(fp);
+
+    // find the first DLS collection in the file
+    EAS_I32 offset = -1;
+    for (size_t i = 0; i + 12 <= data.size(); i++) {
+        if (memcmp(&data[i], "RIFF", 4) == 0 && memcmp(&data[i + 8], "DLS ", 4) == 0) {
+            offset = (EAS_I32)i;
+            break;
+        }
+    }
+    if (offset < 0) {
+        state.SkipWithError("No DLS collection found");
+        return;
+    }
+
+    EAS_HW_DATA_HANDLE hwInstData;
+    EAS_FILE file;
+    EAS_MEMORY_FILE memFile;
+    EAS_FILE_HANDLE fileHandle;
+    EAS_InitMemoryLocator(&file, &memFile, data.data(), (EAS_I32)data.size());
+    if (EAS_HWInit(&hwInstData) != EAS_SUCCESS ||
+        EAS_HWOpenFile(hwInstData, &file, &fileHandle, EAS_FILE_READ) != EAS_SUCCESS) {
+        state.SkipWithError("Failed to open DLS collection");
+        return;
+    }
+
+    for (auto _ : state) {
+        // the collection is released every time so it is never taken from the cache
+        S_DLS *pDLS = NULL;
+        if (DLSParser(hwInstData, fileHandle, offset, &pDLS) != EAS_SUCCESS) {
+            state.SkipWithError("Failed to parse DLS collection");
+            break;
+        }
+        DLSCleanup(hwInstData, pDLS);
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)(data.size() - offset));
+    EAS_HWCloseFile(hwInstData, fileHandle);
+    EAS_HWShutdown(hwInstData);
+}
+BENCHMARK(BM_DLSParser);
+
+// parse a minute of events without rendering, arg: events per beat
+static void BM_SMFParse(benchmark::State &state) {
+    int eventsPerBeat = state.range(0);
+    std::vector<uint8_t> smf = makeSMF(eventsPerBeat, 120);
+    EAS_DATA_HANDLE easData;
+    EAS_HANDLE stream;
+    EAS_FILE file;
+    EAS_MEMORY_FILE memFile;
+    if (openMemoryStream(&easData, &stream, &file, &memFile, smf) != EAS_SUCCESS) {
+        state.SkipWithError("Failed to open SMF");
+        return;
+    }
+
+    for (auto _ : state) {
+        EAS_I32 playLength;
+        if (EAS_ParseMetaData(easData, stream, &playLength) != EAS_SUCCESS) {
+            state.SkipWithError("Failed to parse SMF");
+            break;
+        }
+        benchmark::DoNotOptimize(playLength);
+    }
+    double events = (double)eventsPerBeat * 120 * state.iterations();
+    state.counters["time_per_event"] = benchmark::Counter(
+            events, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    closeMemoryStream(easData, stream);
+}
+BENCHMARK(BM_SMFParse)->RangeMultiplier(4)->Range(1, 256);
+
+// seek from the start of a two minute SMF, arg: target position in percent
+static void BM_Locate(benchmark::State &state) {
+    std::vector<uint8_t> smf = makeSMF(16, 240);
+    EAS_DATA_HANDLE easData;
+    EAS_HANDLE stream;
+    EAS_FILE file;
+    EAS_MEMORY_FILE memFile;
+    if (openMemoryStream(&easData, &stream, &file, &memFile, smf) != EAS_SUCCESS) {
+        state.SkipWithError("Failed to open SMF");
+        return;
+    }
+    EAS_I32 target = (EAS_I32)(120000 * state.range(0) / 100);
+
+    for (auto _ : state) {
+        if (EAS_Locate(easData, stream, 0, EAS_FALSE) != EAS_SUCCESS ||
+            EAS_Locate(easData, stream, target, EAS_FALSE) != EAS_SUCCESS) {
+            state.SkipWithError("Failed to locate");
+            break;
+        }
+    }
+    closeMemoryStream(easData, stream);
+}
+BENCHMARK(BM_Locate)->Arg(10)->Arg(50)->Arg(90)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char **argv) {
+    // take the resource folder option before the benchmark library sees it
+    int count = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-P") == 0 && i + 1 < argc) {
+            gResPath = argv[++i];
+            if (gResPath.back() != '/') gResPath += '/';
+        } else {
+            argv[count++] = argv[i];
+        }
+    }
+    argc = count;
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
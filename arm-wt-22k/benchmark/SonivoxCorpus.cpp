@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Performance regression runner over a corpus of files. Renders every file
+// of the resource folder that the library can play, plus a generated worst
+// case MIDI file, and records for each one the real time factor, the peak
+// frame time, the peak voice count and a hash of the output. Compared to a
+// baseline written by an earlier run, a kernel change is checked for bit
+// exactness and speed in one run.
+//
+// usage: SonivoxCorpus [-P <path_to_res_folder>] [-w <baseline>] [-b <baseline>]
+//                      [-t <tolerance_percent>] [-r <runs>] [-m <max_seconds>] [file ...]
+//
+//  -w  write the results as a baseline
+//  -b  compare against a baseline; a changed hash or voice count, or a real
+//      time factor more than the tolerance (default 10%) below the baseline
+//      is a regression and makes the exit status 1
+//  -r  render each file this many times (default 3) and keep the fastest;
+//      every run must produce the same output
+//  -m  stop rendering a file after this many seconds of audio (default 300)
+//
+// Realtime factors and frame times depend on the device, so a baseline is
+// only comparable on the device and build that wrote it. Hashes depend on
+// the build flags of the library.
+
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <libsonivox/eas.h>
+
+// the generated file, 16 channels starting a note each every eighth beat
+static constexpr const char *kDenseName = "@dense.mid";
+static constexpr int kTicksPerBeat = 480;
+static constexpr int kDenseSteps = 320;
+static constexpr int kDenseHold = 8;
+
+static const char *const kExtensions[] = {".mid",  ".midi", ".smf", ".xmf", ".mxmf", ".rmf",
+                                          ".imy",  ".rtttl", ".rtx", ".ota", ".wav"};
+
+struct Result {
+    uint64_t hash = 0;
+    double realtime = 0;            // seconds of audio per second of rendering
+    uint32_t peakFrameUs = 0;       // slowest EAS_Render of one frame
+    int32_t peakVoices = -1;        // -1 if the library has no metrics
+};
+
+static void putVarLength(std::vector<uint8_t> &out, uint32_t value) {
+    uint8_t bytes[4];
+    int count = 0;
+    do {
+        bytes[count++] = value & 0x7f;
+        value >>= 7;
+    } while (value);
+    while (count--) out.push_back(bytes[count] | (count ? 0x80 : 0));
+}
+
+// type 0 SMF at 120 bpm holding 16 * kDenseHold notes at once, far more
+// than the voice pool, on a different program per channel
+static std::vector<uint8_t> makeDenseSMF() {
+    std::vector<uint8_t> track = {0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20};
+    uint32_t delta = 0;
+    auto event = [&](uint8_t status, uint8_t data1, int data2) {
+        putVarLength(track, delta);
+        track.push_back(status);
+        track.push_back(data1);
+        if (data2 >= 0) track.push_back(data2);
+        delta = 0;
+    };
+    auto note = [](int step, int channel) { return (uint8_t)(36 + (step * 7 + channel * 5) % 60); };
+
+    for (int channel = 0; channel < 16; channel++) event(0xc0 | channel, channel * 8, -1);
+    for (int step = 0; step < kDenseSteps + kDenseHold; step++) {
+        for (int channel = 0; channel < 16; channel++) {
+            if (step >= kDenseHold) event(0x80 | channel, note(step - kDenseHold, channel), 0);
+            if (step < kDenseSteps) event(0x90 | channel, note(step, channel), 64 + channel * 4);
+        }
+        delta = kTicksPerBeat / 8;
+    }
+    delta = 0;
+    putVarLength(track, delta);
+    track.insert(track.end(), {0xff, 0x2f, 0x00});
+
+    std::vector<uint8_t> smf = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1,
+                                kTicksPerBeat >> 8, kTicksPerBeat & 0xff,
+                                'M', 'T', 'r', 'k'};
+    uint32_t size = track.size();
+    for (int shift = 24; shift >= 0; shift -= 8) smf.push_back((size >> shift) & 0xff);
+    smf.insert(smf.end(), track.begin(), track.end());
+    return smf;
+}
+
+static bool readFile(const std::string &path, std::vector<uint8_t> &data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !data.empty();
+}
+
+static bool isCorpusFile(const std::string &name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    // skip the output of other tools next to the inputs
+    if (lower.find("_out.") != std::string::npos) return false;
+    for (const char *extension : kExtensions) {
+        size_t length = strlen(extension);
+        if (lower.size() > length && lower.compare(lower.size() - length, length, extension) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::vector<std::string> listCorpus(const std::string &resPath) {
+    std::vector<std::string> names;
+    DIR *dir = opendir(resPath.c_str());
+    if (dir != nullptr) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (isCorpusFile(entry->d_name)) names.push_back(entry->d_name);
+        }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+    names.push_back(kDenseName);
+    return names;
+}
+
+// FNV-1a over the little endian samples, so hashes compare across devices
+static uint64_t hashSamples(uint64_t hash, const EAS_PCM *pSamples, EAS_I32 count) {
+    for (EAS_I32 i = 0; i < count; i++) {
+        uint16_t sample = (uint16_t)pSamples[i];
+        hash = (hash ^ (sample & 0xff)) * 0x100000001b3ULL;
+        hash = (hash ^ (sample >> 8)) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// renders the file once on a new instance
+static EAS_RESULT renderOnce(const std::vector<uint8_t> &data, double maxSeconds, Result *pResult) {
+    const S_EAS_LIB_CONFIG *pConfig = EAS_Config();
+    EAS_DATA_HANDLE easData = nullptr;
+    EAS_HANDLE stream = nullptr;
+    EAS_FILE file;
+    EAS_MEMORY_FILE memFile;
+    EAS_RESULT result;
+
+    EAS_InitMemoryLocator(&file, &memFile, data.data(), (EAS_I32)data.size());
+    if ((result = EAS_Init(&easData)) != EAS_SUCCESS) return result;
+    if ((result = EAS_OpenFile(easData, &file, &stream)) == EAS_SUCCESS) {
+        result = EAS_Prepare(easData, stream);
+    }
+
+    std::vector<EAS_PCM> buffer(pConfig->mixBufferSize * pConfig->numChannels);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    uint64_t maxSamples = (uint64_t)(maxSeconds * pConfig->sampleRate);
+    uint64_t totalSamples = 0;
+    std::chrono::steady_clock::duration elapsed(0);
+    std::chrono::steady_clock::duration peak(0);
+    while (result == EAS_SUCCESS && totalSamples < maxSamples) {
+        EAS_STATE state;
+        if ((result = EAS_State(easData, stream, &state)) != EAS_SUCCESS) break;
+        if (state == EAS_STATE_STOPPED || state == EAS_STATE_ERROR) break;
+
+        EAS_I32 count = 0;
+        auto start = std::chrono::steady_clock::now();
+        result = EAS_Render(easData, buffer.data(), pConfig->mixBufferSize, &count);
+        auto frameTime = std::chrono::steady_clock::now() - start;
+        elapsed += frameTime;
+        peak = std::max(peak, frameTime);
+        hash = hashSamples(hash, buffer.data(), count * pConfig->numChannels);
+        totalSamples += count;
+    }
+
+    if (result == EAS_SUCCESS) {
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        pResult->hash = hash;
+        pResult->realtime = seconds > 0 ? totalSamples / (seconds * pConfig->sampleRate) : 0;
+        pResult->peakFrameUs =
+                (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(peak).count();
+        S_EAS_METRICS metrics;
+        pResult->peakVoices = -1;
+        if (EAS_GetMetrics(easData, &metrics) == EAS_SUCCESS) {
+            pResult->peakVoices = (int32_t)metrics.histograms[EAS_METRIC_VOICES].max;
+        }
+    }
+    if (stream != nullptr) EAS_CloseFile(easData, stream);
+    EAS_Shutdown(easData);
+    return result;
+}
+
+static bool readBaseline(const std::string &path, std::map<std::string, Result> &baseline) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        char name[256];
+        unsigned long long hash;
+        Result result;
+        if (sscanf(line.c_str(), "%255s %llx %lf %u %d", name, &hash, &result.realtime,
+                   &result.peakFrameUs, &result.peakVoices) == 5) {
+            result.hash = hash;
+            baseline[name] = result;
+        }
+    }
+    return true;
+}
+
+static std::string percent(double now, double before) {
+    if (before <= 0) return "";
+    char text[32];
+    snprintf(text, sizeof(text), "%+.0f%%", 100.0 * (now - before) / before);
+    return text;
+}
+
+int main(int argc, char **argv) {
+    std::string resPath = "/data/local/tmp/SonivoxTestRes/";
+    std::string baselinePath;
+    std::string writePath;
+    double tolerance = 10;
+    int runs = 3;
+    double maxSeconds = 300;
+    std::vector<std::string> names;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "-P") == 0 && hasValue) {
+            resPath = argv[++i];
+            if (resPath.back() != '/') resPath += '/';
+        } else if (strcmp(argv[i], "-b") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "-w") == 0 && hasValue) {
+            writePath = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0 && hasValue) {
+            tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && hasValue) {
+            runs = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "-m") == 0 && hasValue) {
+            maxSeconds = atof(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        } else {
+            names.push_back(argv[i]);
+        }
+    }
+    if (names.empty()) names = listCorpus(resPath);
+
+    std::map<std::string, Result> baseline;
+    if (!baselinePath.empty() && !readBaseline(baselinePath, baseline)) {
+        fprintf(stderr, "Failed to read baseline %s\n", baselinePath.c_str());
+        return 2;
+    }
+
+    FILE *out = nullptr;
+    if (!writePath.empty()) {
+        if ((out = fopen(writePath.c_str(), "w")) == nullptr) {
+            fprintf(stderr, "Failed to write baseline %s\n", writePath.c_str());
+            return 2;
+        }
+        fprintf(out, "# name hash realtime_x peak_frame_us peak_voices\n");
+    }
+
+    int regressions = 0;
+    printf("%-24s %10s %-7s %8s %-7s %6s  %s\n", "file", "realtime", "", "peak us", "", "voices", "hash");
+    for (const std::string &name : names) {
+        std::vector<uint8_t> data;
+        if (name == kDenseName) {
+            data = makeDenseSMF();
+        } else if (!readFile(resPath + name, data)) {
+            printf("%-24s failed to read\n", name.c_str());
+            regressions++;
+            continue;
+        }
+
+        // keep the fastest run, the output must not change between runs
+        Result best;
+        EAS_RESULT result = EAS_SUCCESS;
+        bool deterministic = true;
+        for (int run = 0; run < runs && result == EAS_SUCCESS; run++) {
+            Result current;
+            if ((result = renderOnce(data, maxSeconds, &current)) != EAS_SUCCESS) break;
+            if (run > 0 && current.hash != best.hash) deterministic = false;
+            if (run == 0 || current.realtime > best.realtime) best.realtime = current.realtime;
+            if (run == 0 || current.peakFrameUs < best.peakFrameUs) best.peakFrameUs = current.peakFrameUs;
+            best.hash = current.hash;
+            best.peakVoices = current.peakVoices;
+        }
+        if (result != EAS_SUCCESS) {
+            // files the build can't play, e.g. without _WAVE_PARSER, are not regressions
+            bool known = baseline.count(name) != 0;
+            printf("%-24s error %ld%s\n", name.c_str(), (long)result, known ? "  REGRESSION" : "");
+            if (known) regressions++;
+            continue;
+        }
+
+        std::string status;
+        auto entry = baseline.find(name);
+        if (!deterministic) status += "  NONDETERMINISTIC";
+        if (entry != baseline.end()) {
+            const Result &before = entry->second;
+            if (best.hash != before.hash) status += "  OUTPUT CHANGED";
+            if (best.peakVoices != before.peakVoices) status += "  VOICES CHANGED";
+            if (best.realtime < before.realtime * (1 - tolerance / 100)) status += "  SLOWER";
+        }
+        if (!status.empty()) regressions++;
+        if (entry == baseline.end() && !baseline.empty()) status += "  new";
+
+        std::string realtimeDelta, peakDelta;
+        if (entry != baseline.end()) {
+            realtimeDelta = percent(best.realtime, entry->second.realtime);
+            peakDelta = percent(best.peakFrameUs, entry->second.peakFrameUs);
+        }
+        printf("%-24s %9.1fx %-7s %8u %-7s %6d  %016llx%s\n", name.c_str(), best.realtime,
+               realtimeDelta.c_str(), best.peakFrameUs, peakDelta.c_str(), best.peakVoices,
+               (unsigned long long)best.hash, status.c_str());
+        if (out != nullptr) {
+            fprintf(out, "%s %016llx %.2f %u %d\n", name.c_str(), (unsigned long long)best.hash,
+                    best.realtime, best.peakFrameUs, best.peakVoices);
+        }
+    }
+
+    if (out != nullptr) fclose(out);
+    if (!baseline.empty()) printf("%d regression(s)\n", regressions);
+    return regressions ? 1 : 0;
+}
@@ -59,6 +59,190 @@ typedef struct
     EAS_CHAR    *buildGUID;
 } S_EAS_LIB_CONFIG;
 
+/* filter quality of the output resampler */
+typedef enum
+{
+    EAS_RESAMPLER_QUALITY_DEFAULT = 0,
+    EAS_RESAMPLER_QUALITY_LOW,          /* 8 taps, for low end devices */
+    EAS_RESAMPLER_QUALITY_MEDIUM,       /* 16 taps */
+    EAS_RESAMPLER_QUALITY_HIGH          /* 32 taps */
+} E_EAS_RESAMPLER_QUALITY;
+
+/* wavetable interpolation mode set with EAS_SetInterpolation */
+typedef enum
+{
+    EAS_INTERPOLATION_LINEAR = 0,       /* 2 point linear for every voice */
+    EAS_INTERPOLATION_CUBIC,            /* 4 point cubic for every voice */
+    EAS_INTERPOLATION_ADAPTIVE          /* cubic for loud voices, linear for quiet ones */
+} E_EAS_INTERPOLATION;
+
+/* synthesis engine set with EAS_SetSynthEngine and EAS_SetStreamEngine */
+typedef enum
+{
+    EAS_SYNTH_ENGINE_DEFAULT = 0,       /* the instance setting, wavetable for an instance */
+    EAS_SYNTH_ENGINE_WAVETABLE,         /* the sound library and DLS collections */
+    EAS_SYNTH_ENGINE_FM                 /* the built-in FM patch set, no samples */
+} E_EAS_SYNTH_ENGINE;
+
+/* sample formats written by EAS_RenderFormat, all interleaved */
+typedef enum
+{
+    EAS_PCM_FORMAT_16 = 0,              /* 16-bit signed, same as EAS_Render */
+    EAS_PCM_FORMAT_FLOAT,               /* 32-bit float, full scale is +/-1.0 */
+    EAS_PCM_FORMAT_24_PACKED,           /* 24-bit signed, 3 bytes little endian */
+    EAS_PCM_FORMAT_32                   /* 32-bit signed */
+} E_EAS_PCM_FORMAT;
+
+/* instance configuration passed to EAS_InitEx */
+typedef struct
+{
+    EAS_I32     sampleRate;         /* output sample rate in Hz, 0 for the compiled rate */
+    EAS_I32     resamplerQuality;   /* E_EAS_RESAMPLER_QUALITY when the output is resampled */
+    EAS_FILE_LOCATOR soundLibrary;  /* sound library file, NULL for the built-in library */
+    const EAS_ALLOCATOR *pAllocator; /* memory allocator, NULL for the C library */
+    void        *pArena;            /* memory for the arena, NULL to get it from the allocator */
+    EAS_I32     arenaSize;          /* bytes in the arena, 0 for no arena */
+    EAS_I32     maxStreams;         /* streams that can be open at once, 0 for MAX_NUMBER_STREAMS */
+    EAS_I32     maxVoices;          /* voices in the voice pool, 0 for MAX_SYNTH_VOICES */
+    EAS_I32     maxSynths;          /* virtual synthesizers, 0 for MAX_VIRTUAL_SYNTHESIZERS */
+} S_EAS_INIT_CONFIG;
+
+/* statistics returned by EAS_RenderFile and EAS_RenderToBuffer */
+typedef struct
+{
+    EAS_I32     numSamples;         /* samples rendered per channel */
+    EAS_U32     elapsedTime;        /* wall clock time in microseconds */
+    EAS_I32     samplesPerSec;      /* samples rendered per second of wall clock time */
+} S_EAS_RENDER_STATS;
+
+/* timing of a render that overran its deadline, see EAS_SetDeadlineCallback */
+typedef struct
+{
+    EAS_I32     numSamples;         /* samples per channel rendered */
+    EAS_U32     budget;             /* microseconds allowed for them */
+    EAS_U32     totalTime;          /* microseconds taken */
+    EAS_U32     parseTime;          /* microseconds parsing the streams */
+    EAS_U32     renderTime;         /* microseconds synthesizing the voices */
+    EAS_U32     postTime;           /* microseconds mixing PCM streams, effects, output and JET */
+    EAS_I32     numVoices;          /* voices synthesized */
+    EAS_I32     numStolenVoices;    /* voices stolen */
+    EAS_I32     numParsedStreams;   /* streams that parsed events */
+    EAS_HANDLE  slowestStream;      /* the stream that took longest to parse, NULL if none did */
+    EAS_U32     slowestParseTime;   /* microseconds it took */
+} S_EAS_FRAME_TIMING;
+
+/* callback function for EAS_SetDeadlineCallback, called on the render thread */
+typedef void (*EAS_DEADLINE_CALLBACK) (EAS_VOID_PTR pUserData, const S_EAS_FRAME_TIMING *pTiming);
+
+/* callback function for EAS_DrainDiagnostics, severity is an _EAS_SEVERITY_ value from eas_report.h */
+typedef void (*EAS_DIAG_CALLBACK) (EAS_VOID_PTR pUserData, EAS_INT severity, const char *pMessage);
+
+/* limits on the work of one parse, see EAS_SetParseLimits; 0 for no limit */
+typedef struct
+{
+    EAS_I32     maxEvents;          /* events parsed by one call */
+    EAS_I32     maxNodes;           /* nodes in the tree of an XMF file */
+    EAS_I32     maxTime;            /* milliseconds spent parsing in one call */
+} S_EAS_PARSE_LIMITS;
+
+/* one instance to advance with EAS_RenderBatch */
+typedef struct
+{
+    EAS_DATA_HANDLE pEASData;       /* instance, at most once in a batch */
+    EAS_PCM     *pOut;              /* output buffer */
+    EAS_I32     numRequested;       /* samples per channel to render */
+    EAS_I32     numGenerated;       /* set to the samples per channel rendered */
+    EAS_RESULT  result;             /* set to the result of EAS_Render */
+} S_EAS_BATCH_ITEM;
+
+/* commands for EAS_PostRenderCommand, each calls the function of the same name */
+typedef enum
+{
+    EAS_RENDER_CMD_VOLUME = 0,          /* EAS_SetVolume, param[0] is the volume */
+    EAS_RENDER_CMD_LOCATE,              /* EAS_Locate, param[0] is the time in milliseconds, param[1] the offset flag */
+    EAS_RENDER_CMD_PAUSE,               /* EAS_Pause */
+    EAS_RENDER_CMD_RESUME,              /* EAS_Resume */
+    EAS_RENDER_CMD_JET_QUEUE,           /* JET_QueueSegment, param[0] to param[5] are its arguments after the handle */
+    EAS_RENDER_CMD_JET_PLAY,            /* JET_Play */
+    EAS_RENDER_CMD_JET_PAUSE,           /* JET_Pause */
+    EAS_NUM_RENDER_CMDS
+} E_EAS_RENDER_CMD;
+
+typedef struct
+{
+    EAS_I32     command;            /* E_EAS_RENDER_CMD */
+    EAS_HANDLE  stream;             /* stream, NULL for the master volume and the JET commands */
+    EAS_U32     sampleTime;         /* output position to apply the command at, 0 for as soon as possible */
+    EAS_I32     param[6];
+} S_EAS_RENDER_COMMAND;
+
+/* state of the render-ahead thread, see EAS_GetRenderAheadStatus */
+typedef struct
+{
+    EAS_U32     position;           /* samples per channel read by EAS_ReadRenderAhead */
+    EAS_I32     buffered;           /* samples per channel rendered and not yet read */
+    EAS_U32     underruns;          /* samples per channel EAS_ReadRenderAhead could not supply */
+    EAS_RESULT  result;             /* error that stopped the render thread, or EAS_SUCCESS */
+    EAS_RESULT  commandResult;      /* last error returned by a command, or EAS_SUCCESS */
+} S_EAS_RENDER_AHEAD_STATUS;
+
+/* position of a stream at the end of the last frame rendered, see EAS_GetPosition */
+typedef struct
+{
+    EAS_U32     sampleTime;         /* EAS_GetSampleTime at the end of the frame */
+    EAS_U32     samples;            /* stream position in samples at the synthesis rate */
+    EAS_I32     ticks;              /* MIDI tick of the stream, -1 if it has none or no more events */
+    EAS_I32     latency;            /* output samples rendered up to the end of the frame and not yet returned */
+} S_EAS_POSITION;
+
+/* bytes of memory allocated by an instance, see EAS_GetMemoryUsage */
+typedef struct
+{
+    EAS_I32     voiceManager;       /* voice manager, voices and synthesizers */
+    EAS_I32     mixBuffers;         /* mix, worker, stem and output resampler buffers */
+    EAS_I32     effects;            /* effects modules */
+    EAS_I32     dls;                /* DLS collections and sound libraries of this instance */
+    EAS_I32     parsers;            /* state of the file parsers, PCM and MIDI streams */
+    EAS_I32     pcmCache;           /* rendered PCM kept by the PCM cache */
+    EAS_I32     host;               /* host instance data, file caches and threads */
+    EAS_I32     other;              /* instance data, stream table, JET and metrics */
+    EAS_I32     total;              /* sum of the above */
+    EAS_I32     sharedDLS;          /* DLS collections and sound libraries shared by all instances, not in total */
+} S_EAS_MEMORY_USAGE;
+
+/* per-frame metrics collected by the metrics module */
+typedef enum
+{
+    EAS_METRIC_FRAME_TIME = 0,          /* microseconds to render the frame */
+    EAS_METRIC_PARSE_TIME,              /* microseconds parsing events */
+    EAS_METRIC_RENDER_TIME,             /* microseconds rendering voices */
+    EAS_METRIC_REVERB_TIME,             /* microseconds in the reverb, included in post time */
+    EAS_METRIC_POST_TIME,               /* microseconds in the mix engine post-processing */
+    EAS_METRIC_VOICES,                  /* voices rendered */
+    EAS_METRIC_STOLEN_VOICES,           /* voices stolen */
+    EAS_METRIC_WORKLOAD,                /* voice manager workload */
+    EAS_NUM_METRICS
+} E_EAS_METRIC;
+
+/* histogram bin 0 counts zero values, bin n counts values from 2^(n-1) to 2^n - 1, the last bin counts the rest */
+#define EAS_METRICS_HISTOGRAM_BINS  16
+
+typedef struct
+{
+    EAS_U32     count;              /* number of frames recorded */
+    EAS_U32     total;              /* sum of the recorded values */
+    EAS_U32     max;                /* largest recorded value */
+    EAS_U32     bins[EAS_METRICS_HISTOGRAM_BINS];
+} S_EAS_HISTOGRAM;
+
+typedef struct
+{
+    EAS_U32         numFrames;          /* frames rendered since the last reset */
+    EAS_U32         maxFrameVoices;     /* voices rendered in the slowest frame */
+    EAS_U32         maxFrameRenderTime; /* render time of the slowest frame in milliseconds */
+    S_EAS_HISTOGRAM histograms[EAS_NUM_METRICS];
+} S_EAS_METRICS;
+
 /* enumerated effects module numbers for configuration */
 typedef enum
 {
@@ -82,155 +266,1514 @@ typedef enum
 } E_OPT_MODULES;
 #define NUM_OPTIONAL_MODULES    2
 
-/* enumerated audio decoders for configuration */
-typedef enum
-{
-    EAS_DECODER_PCM = 0,
-    EAS_DECODER_SMAF_ADPCM,
-    EAS_DECODER_IMA_ADPCM,
-    EAS_DECODER_7BIT_SMAF_ADPCM,
-    EAS_DECODER_NOT_SUPPORTED
-} E_DECODER_MODULES;
-#define NUM_DECODER_MODULES     4
+/* enumerated audio decoders for configuration */
+typedef enum
+{
+    EAS_DECODER_PCM = 0,
+    EAS_DECODER_SMAF_ADPCM,
+    EAS_DECODER_IMA_ADPCM,
+    EAS_DECODER_7BIT_SMAF_ADPCM,
+    EAS_DECODER_NOT_SUPPORTED
+} E_DECODER_MODULES;
+#define NUM_DECODER_MODULES     4
+
+/* defines for EAS_PEOpenStream flags parameter */
+#define PCM_FLAGS_STEREO        0x00000100  /* stream is stereo */
+#define PCM_FLAGS_8_BIT         0x00000001  /* 8-bit format */
+#define PCM_FLAGS_UNSIGNED      0x00000010  /* unsigned format */
+#define PCM_FLAGS_STREAMING     0x80000000  /* streaming mode */
+
+/* maximum volume setting */
+#define EAS_MAX_VOLUME          100
+
+/* maximum number of stems for EAS_RenderStems */
+#define EAS_MAX_STEMS           8
+
+/* maximum number of inserts in each chain for EAS_AddInsert */
+#define EAS_MAX_INSERTS         4
+
+/* maximum number of threads of a batch renderer */
+#define EAS_MAX_BATCH_THREADS   8
+
+/*----------------------------------------------------------------------------
+ * EAS_Init()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Initialize the synthesizer library
+ *
+ * Inputs:
+ *  polyphony       - number of voices to play (dynamic memory model only)
+ *  ppLibData       - pointer to data handle variable for this instance
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData);
+
+/*----------------------------------------------------------------------------
+ * EAS_InitEx()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Initialize the synthesizer library with an instance configuration.
+ *
+ * The output sample rate may be the compiled rate, or twice the compiled
+ * rate when the library is built with _RUNTIME_SAMPLE_RATE (e.g. 44100 Hz
+ * from a 22050 Hz build). At twice the rate each frame holds twice as many
+ * samples; use EAS_GetInstanceConfig() for the mix buffer size.
+ *
+ * When the library is built with _OUTPUT_RESAMPLER, any other rate from
+ * 8000 to 48000 Hz is produced by synthesizing at the compiled rate and
+ * resampling the mixed output. Frames then produce a varying number of
+ * samples, which EAS_Render() absorbs for any request size.
+ *
+ * Inputs:
+ *  ppEASData       - pointer to data handle variable for this instance
+ *  pConfig         - instance configuration, NULL for the compiled defaults
+ *
+ * When soundLibrary is set, the library is loaded as by
+ * EAS_LoadSoundLibrary() and used by every stream of the instance. It is
+ * unloaded by EAS_Shutdown(); memory the locator refers to must stay
+ * valid until then. When the library is built with _SOUNDBANK_CACHE, a
+ * sound library file that is not in memory is read and decoded once for
+ * the process: instances initialized with files of the same contents share
+ * one read-only copy, which the last of them frees.
+ *
+ * When the library is built with _MEMORY_ARENA, pAllocator replaces the
+ * C library for every allocation of the instance. With an arenaSize the
+ * whole instance is allocated from one cache aligned block instead, at
+ * pArena or allocated once when pArena is NULL, and opening and closing
+ * streams reuses the memory of the arena. Allocations fail with
+ * EAS_ERROR_MALLOC_FAILED when the arena is full; EAS_GetArenaUsage()
+ * helps to size it. The memory must stay valid until EAS_Shutdown().
+ * Such an instance does not share DLS collections or sound libraries with
+ * other instances.
+ *
+ * Instances are independent and may be used on different threads at
+ * once. Everything they share is read-only while they render: the
+ * built-in sound library, the reverb presets and the math, pan and
+ * filter tables are constant data, and cached DLS collections and sound
+ * libraries are written only under a process wide lock when an instance
+ * loads or releases one. Rendering writes only the memory of its own
+ * instance, so concurrent renders take no lock and write no common cache
+ * line; only allocations from the C library heap may place the edges of
+ * two instances in one line, which an arena per instance rules out.
+ *
+ * When the library is built with _DYNAMIC_STREAMS, maxStreams sizes the
+ * table of streams, so one instance can play more than MAX_NUMBER_STREAMS
+ * files and MIDI streams at once with a single voice pool, mix buffer and
+ * effects chain. Up to MAX_DYNAMIC_STREAMS are allowed.
+ *
+ * When the library is built with _RUNTIME_POLYPHONY, maxVoices and
+ * maxSynths size the voice pool and the number of virtual synthesizers
+ * (one per file stream) below the compiled limits. The voice tables are
+ * allocated to fit, so an instance for ringtones can run with a few voices
+ * in proportionally less memory. EAS_GetInstanceConfig() reports the
+ * voice count.
+ *
+ * Outputs:
+ *  EAS_ERROR_PARAMETER_RANGE if the sample rate, maxStreams, maxVoices or
+ *  maxSynths is not supported
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _RUNTIME_SAMPLE_RATE
+ *  or, for an allocator or arena, without _MEMORY_ARENA, or for more than
+ *  MAX_NUMBER_STREAMS streams without _DYNAMIC_STREAMS, or for other voice
+ *  or synthesizer counts without _RUNTIME_POLYPHONY
+ *  EAS_ERROR_SOUND_LIBRARY if the sound library file cannot be used
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_InitEx (EAS_DATA_HANDLE *ppEASData, const S_EAS_INIT_CONFIG *pConfig);
+
+/*----------------------------------------------------------------------------
+ * EAS_Config()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns a pointer to a structure containing the configuration options
+ * in this library build.
+ *
+ * Inputs:
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC const S_EAS_LIB_CONFIG *EAS_Config (void);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetInstanceConfig()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the library configuration with the output sample rate and mix
+ * buffer size of this instance, which may differ from EAS_Config() for
+ * an instance created with EAS_InitEx().
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pConfig         - receives the configuration
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetInstanceConfig (EAS_DATA_HANDLE pEASData, S_EAS_LIB_CONFIG *pConfig);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetArenaUsage()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the memory allocated from the arena of an instance created with
+ * an arenaSize (see EAS_InitEx)
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pInUse          - receives the bytes allocated now
+ *  pPeak           - receives the most bytes allocated at any time
+ *
+ * Outputs:
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if the instance has no arena
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _MEMORY_ARENA
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetArenaUsage (EAS_DATA_HANDLE pEASData, EAS_I32 *pInUse, EAS_I32 *pPeak);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetMemoryUsage()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the bytes of memory the instance has allocated, by what they
+ * are used for. Collections in the DLS collection cache and cached sound
+ * libraries are counted once for the process in sharedDLS, since any
+ * instance using them may be the one to free them. The counts exclude allocator and arena overhead and
+ * memory of a static memory model build.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pUsage          - receives the memory usage
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _MEMORY_ACCOUNTING
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetMemoryUsage (EAS_DATA_HANDLE pEASData, S_EAS_MEMORY_USAGE *pUsage);
+
+/*----------------------------------------------------------------------------
+ * EAS_Shutdown()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Shuts down the library. Deallocates any memory associated with the
+ * synthesizer (dynamic memory model only)
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_Shutdown (EAS_DATA_HANDLE pEASData);
+
+/*----------------------------------------------------------------------------
+ * EAS_AcquireInstance()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns an instance with the compiled defaults, reusing one released by
+ * EAS_ReleaseInstance when the pool has one. A reused instance renders
+ * exactly like a new one, and skips the allocation and the setup of the
+ * voice manager and effects.
+ *
+ * Inputs:
+ *  ppEASData       - pointer to data handle variable for this instance
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _INSTANCE_POOL or for
+ *  the static memory model
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_AcquireInstance (EAS_DATA_HANDLE *ppEASData);
+
+/*----------------------------------------------------------------------------
+ * EAS_ReleaseInstance()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Closes every stream of the instance and returns it to the pool. The
+ * volume, PCM cache, render threads, stems, DLS collection and synthesizer
+ * settings go back to their defaults. Instances not from
+ * EAS_AcquireInstance, instances JET was started on and instances that
+ * don't fit in the pool (EAS_INSTANCE_POOL_SIZE) are shut down instead.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_ReleaseInstance (EAS_DATA_HANDLE pEASData);
+
+/*----------------------------------------------------------------------------
+ * EAS_FlushInstancePool()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Shuts down the instances kept in the pool, e.g. when the host is
+ * unloaded or needs the memory back
+ *
+ * Inputs:
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_FlushInstancePool (void);
+
+/*----------------------------------------------------------------------------
+ * EAS_Render()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parse the Midi data and render PCM audio data.
+ *
+ * Any number of samples may be requested. Requests that are not a multiple
+ * of the mix buffer size reported by EAS_GetInstanceConfig() are handled by
+ * holding the remainder of the last frame internally until the next call.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  nNumRequested   - requested num samples to generate
+ *  pnNumGenerated  - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated);
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderFormat()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Same as EAS_Render, but writes the samples in the given format.
+ *
+ * The wider formats are converted straight from the 32-bit mix buffer and
+ * keep about 24 bits of the synthesizer output. Effects such as the reverb
+ * are still computed at 16 bits and added to the wide signal. Resampled
+ * output (see EAS_InitEx) is only 16-bit precise in every format.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pOut            - output buffer, numRequested samples of the format
+ *  format          - E_EAS_PCM_FORMAT
+ *  numRequested    - requested num samples to generate
+ *  pNumGenerated   - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_ERROR_PARAMETER_RANGE if the format is not supported
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _HIGH_RES_OUTPUT
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderFormat (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pOut, EAS_I32 format, EAS_I32 numRequested, EAS_I32 *pNumGenerated);
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderRing()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Same as EAS_Render, but writes into a ring buffer owned by the caller,
+ * such as a shared MMAP buffer, wrapping around at its end. The frames
+ * on either side of the end are rendered straight into the ring, only
+ * the frame that straddles it is split from the carry buffer. The caller
+ * keeps the read and write positions and advances its write position by
+ * the samples generated.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pRing           - ring buffer of ringSize samples
+ *  ringSize        - samples in the ring
+ *  writePos        - sample of the ring written first, below ringSize
+ *  numRequested    - requested num samples to generate, at most ringSize
+ *  pNumGenerated   - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_BUFFER_SIZE_MISMATCH if the write position or the request do not
+ *  fit in the ring
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderRing (EAS_DATA_HANDLE pEASData, EAS_PCM *pRing, EAS_I32 ringSize, EAS_I32 writePos, EAS_I32 numRequested, EAS_I32 *pNumGenerated);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetStemCount()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the number of stems EAS_RenderStems splits the output into. All
+ * MIDI channels start in stem 0, use EAS_SetStreamStem to move them.
+ * Setting the count to 0 frees the stem buffers.
+ *
+ * While stems are enabled, voices are synthesized on the calling thread
+ * only; see EAS_SetRenderThreads.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  numStems        - number of stems, 0 to EAS_MAX_STEMS
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _STEM_OUTPUT
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetStemCount (EAS_DATA_HANDLE pEASData, EAS_I32 numStems);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetStreamStem()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Assigns one MIDI channel of a stream, or all of them, to a stem.
+ * Channels assigned to a stem at or past the stem count go to stem 0.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to stream
+ *  channel         - MIDI channel 0 to 15, or -1 for every channel
+ *  stem            - stem number, below EAS_MAX_STEMS
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _STEM_OUTPUT
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetStreamStem (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 channel, EAS_I32 stem);
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderStems()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Same as EAS_Render, but also writes each stem to its own buffer. The
+ * stems are dry: they have the master volume applied but none of the
+ * output effects, such as the reverb. The regular output still has the
+ * effects and is the same as EAS_Render would produce.
+ *
+ * numRequested must be a multiple of the mix buffer size. Stems are not
+ * available when the output is resampled (see EAS_InitEx).
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pOut            - output buffer
+ *  ppStems         - one buffer per stem, the size of pOut; NULL entries are skipped
+ *  numRequested    - requested num samples to generate
+ *  pNumGenerated   - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_BUFFER_SIZE_MISMATCH if numRequested is not a whole number of frames
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if stems are not enabled, the output is
+ *  resampled, or part of a frame is left from EAS_Render
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _STEM_OUTPUT
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderStems (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_PCM * const *ppStems, EAS_I32 numRequested, EAS_I32 *pNumGenerated);
+
+/*----------------------------------------------------------------------------
+ * EAS_AddInsert()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds an effect to the insert chain of a stream, or to the master chain.
+ * Inserts process the 32-bit mix in place, before the master volume and
+ * the output effects. A chain runs its inserts in index order, the new
+ * insert takes the lowest free index.
+ *
+ * The master chain processes the whole mix. A stream chain processes the
+ * voices of one MIDI stream; they are then added to the mix, or to stem 0
+ * when stems are enabled. While a stream has inserts that are not
+ * bypassed, voices are synthesized on the calling thread only.
+ *
+ * The instance data of the effect starts as pUserData and is passed to
+ * pfInit, which may replace it. pfInit, pfShutdown, pFGetParam and
+ * pFSetParam may be NULL. The interface must stay valid until the insert
+ * is removed.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to a MIDI stream, or NULL for the master chain
+ *  pEffect         - effect interface
+ *  pUserData       - initial instance data of the effect
+ *  pIndex          - receives the index of the insert in the chain
+ *
+ * Outputs:
+ *  EAS_ERROR_PARAMETER_RANGE if the chain already has EAS_MAX_INSERTS inserts
+ *  EAS_ERROR_INVALID_PARAMETER if the stream has no synthesizer
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _INSERT_EFFECTS
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_AddInsert (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, const S_EFFECTS32_INTERFACE *pEffect, EAS_VOID_PTR pUserData, EAS_I32 *pIndex);
+
+/*----------------------------------------------------------------------------
+ * EAS_RemoveInsert()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Shuts down an insert and removes it from its chain. The inserts of a
+ * stream are also removed when the stream is closed, and the master
+ * inserts by EAS_Shutdown.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to a MIDI stream, or NULL for the master chain
+ *  index           - index from EAS_AddInsert
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RemoveInsert (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 index);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetInsertBypass()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Bypasses an insert, or puts it back in the chain. A bypassed insert is
+ * not called and keeps its state; a chain with every insert bypassed
+ * renders the same output as no chain.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to a MIDI stream, or NULL for the master chain
+ *  index           - index from EAS_AddInsert
+ *  bypass          - EAS_TRUE to bypass the insert
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetInsertBypass (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 index, EAS_BOOL bypass);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetInsertParameter()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Passes a parameter to the pFSetParam function of an insert
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to a MIDI stream, or NULL for the master chain
+ *  index           - index from EAS_AddInsert
+ *  param           - parameter number, defined by the effect
+ *  value           - new value
+ *
+ * Outputs:
+ *  EAS_ERROR_NOT_IMPLEMENTED if the effect has no pFSetParam
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetInsertParameter (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 index, EAS_I32 param, EAS_I32 value);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetInsertParameter()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reads a parameter with the pFGetParam function of an insert
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to a MIDI stream, or NULL for the master chain
+ *  index           - index from EAS_AddInsert
+ *  param           - parameter number, defined by the effect
+ *  pValue          - receives the value
+ *
+ * Outputs:
+ *  EAS_ERROR_NOT_IMPLEMENTED if the effect has no pFGetParam
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetInsertParameter (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 index, EAS_I32 param, EAS_I32 *pValue);
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderFile()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Opens a file, renders it to the end as fast as possible and closes it.
+ * PCM data is passed to the write function in large blocks. JET processing
+ * and the metrics timers are skipped. Intended for transcoding on an
+ * instance that has no other streams open.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  locator         - file locator
+ *  pfWrite         - called with each block of PCM data, rendering stops
+ *                    if it returns anything other than EAS_SUCCESS
+ *  pUserData       - passed to the write function
+ *  pStats          - optional pointer to render statistics
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderFile (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_RENDER_WRITE_FUNC pfWrite, EAS_VOID_PTR pUserData, S_EAS_RENDER_STATS *pStats);
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderToBuffer()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Same as EAS_RenderFile, but renders into the caller's buffer.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  locator         - file locator
+ *  pBuffer         - output buffer
+ *  bufferSize      - size of the output buffer in samples per channel
+ *  pStats          - optional pointer to render statistics, numSamples is
+ *                    the number of samples written to pBuffer
+ *
+ * Outputs:
+ *  EAS_BUFFER_FULL if the buffer filled before the end of the file
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderToBuffer (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_PCM *pBuffer, EAS_I32 bufferSize, S_EAS_RENDER_STATS *pStats);
+
+/* files larger than this are never kept in the PCM cache */
+#ifndef EAS_PCM_CACHE_MAX_FILE_SIZE
+#define EAS_PCM_CACHE_MAX_FILE_SIZE     (256 * 1024)
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_SetPCMCacheSize()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Enables the PCM cache for files that are played over and over, such as
+ * ringtones and notification sounds. The first time a file is played its
+ * synthesized audio is recorded; later plays of the same file with the
+ * same stream volume and transposition skip the parser and synthesizer.
+ * The master volume and the effects are applied as the file plays, so
+ * they may differ between plays. The output is identical to the
+ * synthesizer's.
+ *
+ * A stream only uses the cache while it is the only stream open, plays
+ * from the start and is not paused, located or given other settings;
+ * JET, stem output and a CPU budget keep the cache off. A stream playing
+ * from the cache that stops qualifying continues from the synthesizer.
+ * Files must be open after the cache is enabled for it to be used, and
+ * files larger than EAS_PCM_CACHE_MAX_FILE_SIZE bytes are not cached. The
+ * cache is disabled by default; the least recently used files are evicted
+ * to keep it within its size.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  maxSize         - bytes of memory the cache may use, 0 disables the
+ *                    cache and frees it
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _PCM_CACHE or with the static memory model
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetPCMCacheSize (EAS_DATA_HANDLE pEASData, EAS_I32 maxSize);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetToneCacheSize()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Enables the cache of compiled iMelody, RTTTL and OTA ringtones. When a
+ * ringtone is prepared, its notes are compiled into an event list; with
+ * the cache enabled the list is kept, and preparing a file with the same
+ * contents again copies the list instead of parsing the file. Playback is
+ * identical either way. The cache is disabled by default; the least
+ * recently used lists are evicted to keep it within its size.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  numEntries      - ringtones the cache may keep, 0 disables the cache
+ *                    and frees it
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _RINGTONE_EVENT_CACHE or with the static memory model
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetToneCacheSize (EAS_DATA_HANDLE pEASData, EAS_I32 numEntries);
+
+/*----------------------------------------------------------------------------
+ * EAS_PrecacheFile()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders a file into the PCM cache as fast as possible without playing
+ * it, so the first time it is played already comes from the cache. The
+ * file is cached with the default stream volume and no transposition.
+ * Files too long for the cache are rendered but not kept.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  locator         - file locator
+ *
+ * Outputs:
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if the cache is disabled or another
+ *  stream is open
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_PrecacheFile (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetPCMCacheUsage()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the memory used by the files in the PCM cache, including a file
+ * being recorded.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pSize           - receives the size in bytes, 0 if nothing is cached
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _PCM_CACHE
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetPCMCacheUsage (EAS_DATA_HANDLE pEASData, EAS_I32 *pSize);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetRenderThreads()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the number of threads used to synthesize voices in EAS_Render.
+ * The calling thread counts as one, so 1 (the default) renders serially.
+ * The output is identical for any number of threads.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  numThreads      - number of render threads
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _PARALLEL_VOICE_RENDER
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetRenderThreads (EAS_DATA_HANDLE pEASData, EAS_I32 numThreads);
+
+/*----------------------------------------------------------------------------
+ * EAS_CreateBatch()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Creates a batch renderer, a pool of threads that advances many library
+ * instances with EAS_RenderBatch. The calling thread of EAS_RenderBatch
+ * counts as one of the threads.
+ *
+ * Inputs:
+ *  numThreads      - number of threads, 1 to EAS_MAX_BATCH_THREADS
+ *  pBatch          - receives the batch handle
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _BATCH_RENDER
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_CreateBatch (EAS_I32 numThreads, EAS_BATCH_HANDLE *pBatch);
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderBatch()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Calls EAS_Render for every item on the threads of the batch and returns
+ * when all are done. The item at index i belongs to thread i modulo the
+ * number of threads, which renders its own items first and then takes
+ * items from the threads that are behind. Passing the instances in the
+ * same order on every call keeps each instance on one thread, with its
+ * voices and samples in that thread's cache.
+ *
+ * The instances must not be used by any other thread during the call.
+ *
+ * Inputs:
+ *  batch           - handle from EAS_CreateBatch
+ *  pItems          - the instances and their output buffers
+ *  numItems        - number of items
+ *
+ * Outputs:
+ *  the result of the first item that failed, EAS_SUCCESS if none did
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderBatch (EAS_BATCH_HANDLE batch, S_EAS_BATCH_ITEM *pItems, EAS_I32 numItems);
+
+/*----------------------------------------------------------------------------
+ * EAS_DestroyBatch()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Stops the threads of a batch renderer and frees it
+ *
+ * Inputs:
+ *  batch           - handle from EAS_CreateBatch
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_DestroyBatch (EAS_BATCH_HANDLE batch);
+
+/*----------------------------------------------------------------------------
+ * EAS_StartRenderAhead()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Starts a thread that renders the output ahead of time into a ring
+ * buffer, so jitter in parsing and file reads is absorbed by the ring
+ * instead of reaching the audio callback. The callback reads the ring with
+ * EAS_ReadRenderAhead, which never waits.
+ *
+ * The ring adds depth samples of latency. Until EAS_StopRenderAhead the
+ * render thread owns the instance: the application may only call
+ * EAS_ReadRenderAhead, EAS_PostRenderCommand and EAS_GetRenderAheadStatus.
+ * Streams are opened and prepared before starting.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  depth           - samples per channel in the ring, rounded up to a power
+ *                    of 2 of at least two mix buffers
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_ALREADY_ACTIVE if the render thread is running
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _RENDER_AHEAD
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_StartRenderAhead (EAS_DATA_HANDLE pEASData, EAS_I32 depth);
+
+/*----------------------------------------------------------------------------
+ * EAS_StopRenderAhead()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Stops the render thread and frees the ring. Audio not yet read and
+ * commands not yet applied are dropped. EAS_Shutdown stops the thread too.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_StopRenderAhead (EAS_DATA_HANDLE pEASData);
+
+/*----------------------------------------------------------------------------
+ * EAS_ReadRenderAhead()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Copies rendered audio out of the ring without waiting. When the ring
+ * holds less than requested, the rest of the buffer is silenced and the
+ * shortfall is counted as an underrun. Must be called from one thread.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pOut            - output buffer
+ *  numRequested    - samples per channel wanted
+ *  pNumGenerated   - receives the samples per channel copied from the ring
+ *
+ * Outputs:
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if the render thread is not running
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_ReadRenderAhead (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated);
+
+/*----------------------------------------------------------------------------
+ * EAS_PostRenderCommand()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Queues a command for the render thread. The thread applies it before
+ * rendering the first frame at or after its sample time, counted on the
+ * same clock as the position in S_EAS_RENDER_AHEAD_STATUS; a time already
+ * rendered applies it before the next frame. Commands are applied in the
+ * order they are posted, so a command holds back the ones after it until
+ * it is due. Must be called from one thread.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pCommand        - the command, copied into the queue
+ *
+ * Outputs:
+ *  EAS_ERROR_QUEUE_IS_FULL if the render thread is not keeping up
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if the render thread is not running
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_PostRenderCommand (EAS_DATA_HANDLE pEASData, const S_EAS_RENDER_COMMAND *pCommand);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetRenderAheadStatus()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reports the read position, the fill of the ring and any errors of the
+ * render thread
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStatus         - receives the status
+ *
+ * Outputs:
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if the render thread is not running
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetRenderAheadStatus (EAS_DATA_HANDLE pEASData, S_EAS_RENDER_AHEAD_STATUS *pStatus);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetCPUBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Limits the time EAS_Render may spend on each frame. The library times
+ * every frame and lowers the polyphony to stay within the budget, muting
+ * the lowest priority voices as it would for a voice steal; SP-MIDI
+ * content mutes channels by its MIP table first. Polyphony recovers as
+ * load drops. Offline rendering is not limited.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  budget          - microseconds per frame, 0 (the default) for no limit
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _CPU_BUDGET
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetCPUBudget (EAS_DATA_HANDLE pEASData, EAS_I32 budget);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetPolyphonyLimit()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the number of voices the instance currently allows. This is
+ * the size of the voice pool, MAX_SYNTH_VOICES unless set with
+ * EAS_InitEx(), unless a CPU budget has lowered it.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pPolyphony      - receives the voice limit
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetPolyphonyLimit (EAS_DATA_HANDLE pEASData, EAS_I32 *pPolyphony);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetDeadlineCallback()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Times each frame EAS_Render synthesizes against a deadline and calls
+ * pfCallback with a breakdown of the time whenever a frame takes longer.
+ * Blocks and slices are held to the deadline scaled to their length. The
+ * callback is called from EAS_Render before it returns, so a player can
+ * react to a near miss, for instance by lowering the CPU budget, before
+ * it becomes an underrun. It must return quickly and must not render,
+ * open or close streams on the instance. Offline renders are not timed.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  budget          - microseconds per frame, 0 to stop timing
+ *  pfCallback      - function called for each late frame
+ *  pUserData       - passed to the callback
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _DEADLINE_MONITOR
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetDeadlineCallback (EAS_DATA_HANDLE pEASData, EAS_I32 budget, EAS_DEADLINE_CALLBACK pfCallback, EAS_VOID_PTR pUserData);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetParseLimits()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Bounds the work the parsers do for one call, so a malformed file with
+ * millions of simultaneous events or a huge XMF tree cannot hold a media
+ * scanner or the render thread for seconds. The event and time limits
+ * apply to each render frame, EAS_ParseMetaData, EAS_Locate and EAS_Prepare
+ * (which may compile the events of the file); the node limit applies when
+ * an XMF file is opened. A call that exceeds a limit fails with
+ * EAS_ERROR_PARSE_LIMIT and the stream can only be closed.
+ * The limits apply to streams opened afterwards and to later calls on
+ * open streams.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pLimits         - the limits, NULL to remove them
+ *
+ * Outputs:
+ *  EAS_ERROR_PARAMETER_RANGE if a limit is negative
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _PARSE_LIMITS
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetParseLimits (EAS_DATA_HANDLE pEASData, const S_EAS_PARSE_LIMITS *pLimits);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetInterpolation()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Selects the wavetable interpolator (E_EAS_INTERPOLATION). Cubic
+ * interpolation reduces the aliasing of pitched up samples at about
+ * twice the cost of linear. The adaptive mode picks it per voice each
+ * frame, so only voices loud enough for the difference to be heard pay
+ * for it. The default is linear.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  mode            - interpolation mode
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _CUBIC_INTERPOLATION
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetInterpolation (EAS_DATA_HANDLE pEASData, EAS_I32 mode);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetSynthEngine()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Selects the engine (E_EAS_SYNTH_ENGINE) that plays the MIDI channels of
+ * all streams that have not selected one with EAS_SetStreamEngine. The FM
+ * engine plays a built-in General MIDI patch set with two operators per
+ * voice, it needs no sample bank and costs a fraction of a wavetable
+ * voice, for devices that cannot afford the wavetable path. The change
+ * applies to the notes started afterwards. The default is the wavetable.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  engine          - EAS_SYNTH_ENGINE_WAVETABLE or EAS_SYNTH_ENGINE_FM
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _FM_FALLBACK
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetSynthEngine (EAS_DATA_HANDLE pEASData, EAS_I32 engine);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetStreamEngine()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Selects the engine that plays a MIDI channel of a stream, so a stream
+ * may play some channels on the FM engine and the others on the
+ * wavetable. EAS_SYNTH_ENGINE_DEFAULT returns the channel to the instance
+ * setting. The change applies to the notes started afterwards.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to stream
+ *  channel         - MIDI channel 0-15, or -1 for all channels
+ *  engine          - E_EAS_SYNTH_ENGINE
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _FM_FALLBACK
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetStreamEngine (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 channel, EAS_I32 engine);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetRenderBlock()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets how many frames EAS_Render synthesizes at a time. Envelopes, LFOs
+ * and effects still update once per frame, but the voice loop, parsing
+ * and output conversion run once per block, which saves their per-call
+ * cost when the host renders large buffers. Note-ons keep their sample
+ * position within the block; other events and JET processing take effect
+ * at block boundaries. A block is only used for requests of at least that
+ * many frames, and never while resampling or playing through the PCM
+ * cache. The default is 1.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  frames          - frames per block, 1 to 4
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _BLOCK_RENDER and frames is not 1
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetRenderBlock (EAS_DATA_HANDLE pEASData, EAS_I32 frames);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetRenderSlice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets how many samples EAS_Render synthesizes at a time, for hosts that
+ * play live input from EAS_WriteMIDIStream with buffers smaller than a
+ * frame. The MIDI stream input is read at every slice, so a note-on
+ * sounds in the next slice instead of the next frame. File parsing,
+ * envelopes, LFOs and JET processing still run once per frame, so the
+ * sound and its timing do not depend on the slice size; a note-off or
+ * controller change reaches voices already playing at the next frame.
+ * Slices cannot be combined with render blocks or the PCM cache. The
+ * default is the frame size, see EAS_Config.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  samples         - the frame size, or the frame size divided by 2 or 4
+ *
+ * Outputs:
+ *  EAS_ERROR_PARAMETER_RANGE if samples is not one of these sizes
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if the instance resamples its output
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _LOW_LATENCY and samples is not the frame size
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetRenderSlice (EAS_DATA_HANDLE pEASData, EAS_I32 samples);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetFrameBuffer()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Attaches the frame buffer of a split architecture library. The voices
+ * of the regions marked off-chip are synthesized by a wavetable engine in
+ * another process or on a DSP, which shares the frame buffer with this
+ * instance and calls WTE_RunEngine (see eas_wtoffload.h). EAS_Render waits
+ * for the engine at the end of each frame and adds its mix to the output.
+ * Until a frame buffer is attached the off-chip voices are silent.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pFrameBuffer    - the frame buffer, or NULL to detach it
+ *
+ * Outputs:
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if any voice is playing
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _SPLIT_ARCHITECTURE
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetFrameBuffer (EAS_DATA_HANDLE pEASData, EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
+
+/*----------------------------------------------------------------------------
+ * EAS_DrainDiagnostics()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Logs the diagnostics posted by the render path since the last call.
+ * With _DIAG_RING, EAS_Render does not write to the Android log, which
+ * can block, but posts its diagnostics to a ring shared by every instance
+ * in the process. Call this periodically from a thread that may block,
+ * never from the thread that calls EAS_Render. Events posted while the
+ * ring is full are lost and reported as a count.
+ *
+ * Inputs:
+ *  pfCallback      - receives each message, or NULL to write them to the
+ *                    Android log and the SafetyNet events to SafetyNet
+ *  pUserData       - passed to the callback
+ *  pNumEvents      - receives the number of events drained, may be NULL
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _DIAG_RING, in which case diagnostics are logged when posted
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_DrainDiagnostics (EAS_DIAG_CALLBACK pfCallback, EAS_VOID_PTR pUserData, EAS_I32 *pNumEvents);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetRealtimeRender()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Makes EAS_Render safe to call from a realtime audio thread. In this mode
+ * EAS_OpenFile and JET_OpenFile read the whole file into memory, so that
+ * the parsers never call the file callbacks while rendering, and the JET
+ * segment queue no longer opens, prepares or closes the segments while
+ * rendering, which the application does by calling JET_Service from
+ * another thread between renders. Progressive and background opens are
+ * not available in this mode.
+ *
+ * Debug builds with _RT_SAFE_CHECKS assert when EAS_Render allocates
+ * memory or calls the file callbacks.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  enable          - EAS_TRUE for realtime rendering
+ *
+ * Outputs:
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if a stream or a JET file is open
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _RT_SAFE_RENDER, or with JET_INTERFACE but without _JET_DYNAMIC_QUEUE
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetRealtimeRender (EAS_DATA_HANDLE pEASData, EAS_BOOL enable);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetIdleMode()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * The instance is idle once no voice or PCM stream is playing and the
+ * output has been silent long enough for the reverb and chorus tails to
+ * have died away. While it is idle, each frame is silent until a stream
+ * plays its next event or the application starts a new sound. With
+ * skipIdle set, EAS_Render zero fills the output of an idle frame instead
+ * of running the master gain and effects on the silent mix. The reverb
+ * and chorus still see the frame, they return at once with no tail left,
+ * and a chain with any other effect is processed in full. The output is
+ * the same either way.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  skipIdle        - EAS_TRUE to zero fill idle frames
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _IDLE_DETECT
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetIdleMode (EAS_DATA_HANDLE pEASData, EAS_BOOL skipIdle);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetPipelinedRender()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Splits each frame EAS_Render renders across two threads: while the
+ * master gain, the insert effects, the reverb and the chorus process a
+ * frame, a worker thread parses the events of the next one. The output
+ * is the same as without the pipeline. A frame is pipelined only when
+ * EAS_Render renders another whole frame after it in the same call, so
+ * the last frame of each call, low latency slices, the output resampler
+ * and the CPU budget render as before, as do EAS_RenderFormat and the
+ * offline renders.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  enable          - EAS_TRUE to start the worker thread, EAS_FALSE to
+ *                    stop it
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _PIPELINED_RENDER
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetPipelinedRender (EAS_DATA_HANDLE pEASData, EAS_BOOL enable);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetSilence()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reports whether the last frame EAS_Render produced was silent, and
+ * whether the instance is idle (see EAS_SetIdleMode). While it is idle a
+ * host can stop its output and sleep until the time EAS_GetNextEventTime
+ * returns for its streams, then resume rendering. The synthesizer does
+ * not advance while EAS_Render is not called, so the next event still
+ * plays in time with the rest of the stream.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pSilent         - receives EAS_TRUE if the last frame was silent
+ *  pIdle           - receives EAS_TRUE if the instance is idle, may be NULL
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _IDLE_DETECT
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetSilence (EAS_DATA_HANDLE pEASData, EAS_BOOL *pSilent, EAS_BOOL *pIdle);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetTransposition)
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the key tranposition for the synthesizer. Transposes all
+ * melodic instruments by the specified amount. Range is limited
+ * to +/-12 semitones.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  streamHandle    - handle to stream
+ *  transposition   - +/-12 semitones
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetTransposition (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_I32 transposition);
+#define MAX_TRANSPOSE       12
+
 
-/* defines for EAS_PEOpenStream flags parameter */
-#define PCM_FLAGS_STEREO        0x00000100  /* stream is stereo */
-#define PCM_FLAGS_8_BIT         0x00000001  /* 8-bit format */
-#define PCM_FLAGS_UNSIGNED      0x00000010  /* unsigned format */
-#define PCM_FLAGS_STREAMING     0x80000000  /* streaming mode */
+/*----------------------------------------------------------------------------
+ * EAS_SetVolume()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Set the master volume for the mixer. The default volume setting is
+ * 90 (-10 dB). The volume range is 0 to 100 in 1dB increments.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * volume           - the desired master volume
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * overrides any previously set master volume from sysex
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetVolume (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_I32 volume);
 
-/* maximum volume setting */
-#define EAS_MAX_VOLUME          100
+/*----------------------------------------------------------------------------
+ * EAS_InitMemoryLocator()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets up a file locator for content that is already in memory, e.g. a
+ * memory mapped file. Files opened with the locator are parsed directly
+ * from memory instead of through readAt calls. The memory and pMemFile
+ * must remain valid until all streams opened with the locator are closed.
+ *
+ * Inputs:
+ * locator          - file locator to initialize
+ * pMemFile         - storage for the memory region description
+ * pData            - pointer to the file contents
+ * size             - size of the file in bytes
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC void EAS_InitMemoryLocator (EAS_FILE_LOCATOR locator, EAS_MEMORY_FILE *pMemFile, const void *pData, EAS_I32 size);
 
 /*----------------------------------------------------------------------------
- * EAS_Init()
+ * EAS_LoadSoundLibrary()
  *----------------------------------------------------------------------------
  * Purpose:
- * Initialize the synthesizer library
+ * Loads a wavetable sound library file, written by EAS_WriteSoundLibrary,
+ * to use in place of the built-in library. The file must match the
+ * sample rate and sample depth of the build.
+ *
+ * Pass a memory locator (EAS_InitMemoryLocator) for a memory mapped file:
+ * the sample data is then used in place, so it stays clean and is shared
+ * by every process mapping the file. Only the small tables are copied.
+ * The mapping must remain valid until the library is unloaded. Other
+ * locators are read into memory.
  *
  * Inputs:
- *  polyphony       - number of voices to play (dynamic memory model only)
- *  ppLibData       - pointer to data handle variable for this instance
+ * pEASData         - pointer to overall EAS data structure
+ * locator          - sound library file
+ * ppLib            - receives the sound library handle
  *
  * Outputs:
+ *  EAS_ERROR_SOUND_LIBRARY if the file is damaged or does not match the build
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _EXTERNAL_SOUNDBANK
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData);
+EAS_PUBLIC EAS_RESULT EAS_LoadSoundLibrary (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_SNDLIB_HANDLE *ppLib);
 
 /*----------------------------------------------------------------------------
- * EAS_Config()
+ * EAS_SetSoundLibrary()
  *----------------------------------------------------------------------------
  * Purpose:
- * Returns a pointer to a structure containing the configuration options
- * in this library build.
+ * Selects the sound library for a stream, or with a NULL stream handle,
+ * for streams opened from now on. Switching a stream that is playing
+ * cuts off its notes, and its channels keep their programs.
  *
  * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * streamHandle     - stream, or NULL for streams opened later
+ * pLib             - library from EAS_LoadSoundLibrary, NULL for the built-in library
  *
  * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _EXTERNAL_SOUNDBANK
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC const S_EAS_LIB_CONFIG *EAS_Config (void);
+EAS_PUBLIC EAS_RESULT EAS_SetSoundLibrary (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_SNDLIB_HANDLE pLib);
 
 /*----------------------------------------------------------------------------
- * EAS_Shutdown()
+ * EAS_UnloadSoundLibrary()
  *----------------------------------------------------------------------------
  * Purpose:
- * Shuts down the library. Deallocates any memory associated with the
- * synthesizer (dynamic memory model only)
+ * Frees a library loaded by EAS_LoadSoundLibrary. The library must not be
+ * selected for any stream, or for streams opened later.
  *
  * Inputs:
- *  pEASData        - handle to data for this instance
+ * pEASData         - pointer to overall EAS data structure
+ * pLib             - library from EAS_LoadSoundLibrary
  *
  * Outputs:
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if the library is still selected
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _EXTERNAL_SOUNDBANK
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_Shutdown (EAS_DATA_HANDLE pEASData);
+EAS_PUBLIC EAS_RESULT EAS_UnloadSoundLibrary (EAS_DATA_HANDLE pEASData, EAS_SNDLIB_HANDLE pLib);
 
 /*----------------------------------------------------------------------------
- * EAS_Render()
+ * EAS_WriteSoundLibrary()
  *----------------------------------------------------------------------------
  * Purpose:
- * Parse the Midi data and render PCM audio data.
+ * Writes a sound library in the file format read by EAS_LoadSoundLibrary,
+ * e.g. to convert the built-in library to a file. Call with a NULL buffer
+ * to get the size of the file.
  *
  * Inputs:
- *  pEASData        - buffer for internal EAS data
- *  pOut            - output buffer pointer
- *  nNumRequested   - requested num samples to generate
- *  pnNumGenerated  - actual number of samples generated
+ * pEASData         - pointer to overall EAS data structure
+ * pLib             - library to write, NULL for the built-in library
+ * pBuffer          - receives the file, or NULL
+ * bufferSize       - size of pBuffer in bytes
+ * pSize            - receives the size of the file in bytes
  *
  * Outputs:
- *  EAS_SUCCESS if PCM data was successfully rendered
+ *  EAS_BUFFER_SIZE_MISMATCH if pBuffer is too small
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if built without _EXTERNAL_SOUNDBANK
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated);
+EAS_PUBLIC EAS_RESULT EAS_WriteSoundLibrary (EAS_DATA_HANDLE pEASData, EAS_SNDLIB_HANDLE pLib, EAS_VOID_PTR pBuffer, EAS_I32 bufferSize, EAS_I32 *pSize);
 
 /*----------------------------------------------------------------------------
- * EAS_SetTransposition)
+ * EAS_OpenFile()
  *----------------------------------------------------------------------------
  * Purpose:
- * Sets the key tranposition for the synthesizer. Transposes all
- * melodic instruments by the specified amount. Range is limited
- * to +/-12 semitones.
+ * Opens a file for audio playback.
  *
  * Inputs:
- *  pEASData        - handle to data for this instance
- *  streamHandle    - handle to stream
- *  transposition   - +/-12 semitones
+ * pEASData         - pointer to overall EAS data structure
+ * locator          - pointer to filename or other locating information
+ * pStreamHandle    - pointer to stream handle variable
  *
  * Outputs:
  *
+ *
  * Side Effects:
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_SetTransposition (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_I32 transposition);
-#define MAX_TRANSPOSE       12
-
+EAS_PUBLIC EAS_RESULT EAS_OpenFile (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_HANDLE *pStreamHandle);
 
 /*----------------------------------------------------------------------------
- * EAS_SetVolume()
+ * EAS_OpenFileAsync()
  *----------------------------------------------------------------------------
  * Purpose:
- * Set the master volume for the mixer. The default volume setting is
- * 90 (-10 dB). The volume range is 0 to 100 in 1dB increments.
+ * Opens and prepares a file on a background thread, so the caller can keep
+ * rendering the other streams. The file itself is opened before this
+ * returns, so the locator need not stay valid.
+ *
+ * When the stream is prepared, or the open fails, pfCallback is called on
+ * the background thread. A prepared stream plays from the next render.
+ * The callback must not call the library. Until EAS_WaitOpen returns the
+ * only calls allowed on the stream are EAS_WaitOpen and EAS_CloseFile,
+ * both of which wait for the background thread.
  *
  * Inputs:
  * pEASData         - pointer to overall EAS data structure
- * volume           - the desired master volume
+ * locator          - pointer to filename or other locating information
+ * pfCallback       - optional function called when the open completes
+ * pUserData        - passed to the callback
+ * pStreamHandle    - pointer to stream handle variable
  *
  * Outputs:
  *
  *
  * Side Effects:
- * overrides any previously set master volume from sysex
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_SetVolume (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_I32 volume);
+EAS_PUBLIC EAS_RESULT EAS_OpenFileAsync (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_OPEN_CALLBACK pfCallback, EAS_VOID_PTR pUserData, EAS_HANDLE *pStreamHandle);
 
 /*----------------------------------------------------------------------------
- * EAS_OpenFile()
+ * EAS_OpenFileProgressive()
  *----------------------------------------------------------------------------
  * Purpose:
- * Opens a file for audio playback.
+ * Opens a file that is still downloading, so playback can start before
+ * the whole file has arrived. Only SMF files can be played this way, XMF
+ * needs its whole tree and DLS collection first.
+ *
+ * The locator size function must return the full length of the file.
+ * readAt is only asked for bytes past the available count by the file
+ * cache and may return fewer bytes than requested.
+ *
+ * EAS_Prepare returns EAS_ERROR_DATA_UNDERRUN until the header and the
+ * start of every track have arrived, call it again after more data with
+ * EAS_SetStreamAvailable. Since type 1 tracks are stored one after the
+ * other this is most of a type 1 file, while a type 0 file can start
+ * after a few bytes. While the next event has not arrived the stream
+ * pauses, EAS_State reports EAS_STATE_PAUSING or EAS_STATE_PAUSED, and it
+ * resumes where it stopped when the data arrives. EAS_Locate beyond the
+ * data and EAS_ParseMetaData return EAS_ERROR_DATA_UNDERRUN until the
+ * download is complete.
  *
  * Inputs:
  * pEASData         - pointer to overall EAS data structure
  * locator          - pointer to filename or other locating information
+ * available        - bytes of the file received so far
  * pStreamHandle    - pointer to stream handle variable
  *
  * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the file type can't be played progressively
+ *  or if built without _PROGRESSIVE_FILES
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_OpenFileProgressive (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_I32 available, EAS_HANDLE *pStreamHandle);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetStreamAvailable()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reports more of a file opened with EAS_OpenFileProgressive. A stream
+ * paused waiting for data plays again from the next render.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * streamHandle     - stream handle from EAS_OpenFileProgressive
+ * available        - bytes of the file received so far
+ * complete         - EAS_TRUE once the whole file has arrived, available is then ignored
  *
+ * Outputs:
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if the stream was prepared without
+ *  EAS_OpenFileProgressive
  *
  * Side Effects:
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_OpenFile (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_HANDLE *pStreamHandle);
+EAS_PUBLIC EAS_RESULT EAS_SetStreamAvailable (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_I32 available, EAS_BOOL complete);
+
+/*----------------------------------------------------------------------------
+ * EAS_WaitOpen()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Waits for an open started by EAS_OpenFileAsync to complete. If the open
+ * failed the stream handle is released and must not be used again.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * streamHandle     - stream handle from EAS_OpenFileAsync
+ *
+ * Outputs:
+ * result of the open and prepare
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_WaitOpen (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle);
 
 #ifdef MMAPI_SUPPORT
 /*----------------------------------------------------------------------------
@@ -298,6 +1841,33 @@ EAS_PUBLIC EAS_RESULT EAS_GetFileType (EAS_DATA_HANDLE pEASData, EAS_HANDLE stre
 */
 EAS_PUBLIC EAS_RESULT EAS_ParseMetaData (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_I32 *pPlayLength);
 
+/*----------------------------------------------------------------------------
+ * EAS_ProbeFile()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the file type, play length and metadata of a file without an
+ * EAS_Init instance. Only the file parser runs; no synthesizer, mix
+ * buffers or effects are allocated, and the play length comes from the
+ * parser's timing alone. Each call is independent, so any number of
+ * threads may probe files at the same time.
+ *
+ * Inputs:
+ * locator          - pointer to filename or other locating information
+ * cbFunc           - optional metadata callback, see EAS_RegisterMetaDataCallback
+ * metaDataBuffer   - pointer to metadata buffer
+ * metaDataBufSize  - maximum size of the metadata buffer
+ * pUserData        - passed to the callback
+ * pFileType        - pointer to variable to store the file type, may be NULL
+ * pPlayLength      - pointer to variable to store the play length (in msecs)
+ *
+ * Outputs:
+ * EAS_ERROR_UNRECOGNIZED_FORMAT if no parser recognizes the file
+ * EAS_ERROR_FEATURE_NOT_AVAILABLE with the static memory model
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_ProbeFile (EAS_FILE_LOCATOR locator, EAS_METADATA_CBFUNC cbFunc, char *metaDataBuffer, EAS_I32 metaDataBufSize, EAS_VOID_PTR pUserData, EAS_I32 *pFileType, EAS_I32 *pPlayLength);
+
 /*----------------------------------------------------------------------------
  * EAS_Prepare()
  *----------------------------------------------------------------------------
@@ -426,6 +1996,12 @@ EAS_PUBLIC EAS_RESULT EAS_OpenMIDIStream (EAS_DATA_HANDLE pEASData, EAS_HANDLE *
  * Purpose:
  * Send data to the MIDI stream device
  *
+ * When the library is built with the MIDI input ring, the data is queued
+ * and played at the start of the next frame rendered. It may then be
+ * called from one thread other than the one calling EAS_Render without
+ * locking. EAS_ERROR_QUEUE_IS_FULL is returned and nothing is written if
+ * the queue doesn't have room for the whole buffer.
+ *
  * Inputs:
  * pEASData         - pointer to overall EAS data structure
  * streamHandle     - stream handle
@@ -441,6 +2017,52 @@ EAS_PUBLIC EAS_RESULT EAS_OpenMIDIStream (EAS_DATA_HANDLE pEASData, EAS_HANDLE *
 */
 EAS_PUBLIC EAS_RESULT EAS_WriteMIDIStream(EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_U8 *pBuffer, EAS_I32 count);
 
+/*----------------------------------------------------------------------------
+ * EAS_WriteMIDIStreamAt()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Queue data for the MIDI stream device to be played at a given sample time.
+ * Data due before the end of a frame is played at the start of that frame.
+ * Calls must be made in time order from a single thread. Returns
+ * EAS_ERROR_FEATURE_NOT_AVAILABLE if the library is built without the MIDI
+ * input ring.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * streamHandle     - stream handle
+ * pBuffer          - pointer to buffer
+ * count            - number of bytes to write
+ * sampleTime       - due time, see EAS_GetSampleTime
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_WriteMIDIStreamAt (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_U8 *pBuffer, EAS_I32 count, EAS_U32 sampleTime);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetSampleTime()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the number of samples rendered since the library was initialized.
+ * The count wraps around. It may be read from any thread.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSampleTime      - pointer to variable to receive the sample count
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetSampleTime (EAS_DATA_HANDLE pEASData, EAS_U32 *pSampleTime);
+
 /*----------------------------------------------------------------------------
  * EAS_CloseMIDIStream()
  *----------------------------------------------------------------------------
@@ -503,6 +2125,122 @@ EAS_PUBLIC EAS_RESULT EAS_Locate (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHan
 */
 EAS_PUBLIC EAS_RESULT EAS_GetLocation (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_I32 *pTime);
 
+/*----------------------------------------------------------------------------
+ * EAS_GetNextEventTime()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the time until the next event of the stream
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * streamHandle     - file handle
+ *
+ * Outputs:
+ * The milliseconds of playback until the stream plays its next event,
+ * 0 for streams such as audio files that play all the time, and -1 if
+ * it has no more events or is paused.
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetNextEventTime (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_I32 *pTime);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetPosition()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the position of the stream at the end of the last frame
+ * rendered, in samples and in MIDI ticks, along with the output samples
+ * between that point and the next sample EAS_Render returns. Those are
+ * the part of a frame held for the next call, the rest of a frame being
+ * rendered in slices (see EAS_SetRenderSlice), and the delay of the output
+ * resampler. The next sample EAS_Render returns is therefore latency
+ * output samples before the position. The samples advance by exactly the
+ * frame size per frame, unlike EAS_GetLocation, whose milliseconds are
+ * rounded to the update period.
+ *
+ * While EAS_StartRenderAhead is running the position may not be read, the
+ * ring adds the samples EAS_GetRenderAheadStatus reports as buffered.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * streamHandle     - file handle
+ * pPosition        - receives the position
+ *
+ * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _POSITION_REPORT
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetPosition (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, S_EAS_POSITION *pPosition);
+
+/*----------------------------------------------------------------------------
+ * EAS_SaveState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Takes a snapshot of a MIDI stream that EAS_RestoreState can return it to
+ * at any later time, without the reset and reparse of EAS_Locate. The
+ * snapshot holds the parser position, the channel state of the stream's
+ * synthesizer and the complete state of the voices it is playing, so
+ * notes sounding at the snapshot continue from that point.
+ *
+ * A snapshot is only valid for the stream it was taken of, in the same
+ * library instance and with the same sound library and DLS collection.
+ * It holds addresses and cannot be kept across processes. The effects
+ * are shared by all streams and are not part of it. Call with pState
+ * NULL to get the size to allocate, which does not change while the
+ * stream is open.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * streamHandle     - file handle
+ * pState           - receives the snapshot, or NULL
+ * size             - size of pState in bytes
+ * pStateSize       - receives the size of the snapshot, or the size needed
+ *
+ * Outputs:
+ *  EAS_BUFFER_SIZE_MISMATCH if pState is too small
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if the stream is not ready, playing
+ *  or paused
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE for streams other than SMF and XMF, or
+ *  if the library was built without _ENGINE_SNAPSHOT
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SaveState (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, void *pState, EAS_I32 size, EAS_I32 *pStateSize);
+
+/*----------------------------------------------------------------------------
+ * EAS_RestoreState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns a stream to a snapshot from EAS_SaveState. The voices playing
+ * on the stream stop at once and those of the snapshot take their place.
+ * The stream volume, transposition and polyphony are not changed.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * streamHandle     - file handle
+ * pState           - snapshot
+ * size             - size of the snapshot in bytes
+ *
+ * Outputs:
+ *  EAS_ERROR_INVALID_PARAMETER if the snapshot is not one of this stream
+ *  or the sound library has changed since, the stream is not changed
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE if the library was built without
+ *  _ENGINE_SNAPSHOT
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RestoreState (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, const void *pState, EAS_I32 size);
+
 /*----------------------------------------------------------------------------
  * EAS_Pause()
  *----------------------------------------------------------------------------
@@ -608,6 +2346,27 @@ EAS_PUBLIC EAS_RESULT EAS_MetricsReport (EAS_DATA_HANDLE pEASData);
 EAS_PUBLIC EAS_RESULT EAS_MetricsReset (EAS_DATA_HANDLE pEASData);
 #endif
 
+/*----------------------------------------------------------------------------
+ * EAS_GetMetrics()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns a snapshot of the per-frame metrics collected since the last
+ * call to EAS_MetricsReset. Returns EAS_ERROR_FEATURE_NOT_AVAILABLE if
+ * the library was built without _METRICS_ENABLED.
+ *
+ * Inputs:
+ * pEASData             - instance data handle
+ * pMetrics             - pointer to structure to receive the metrics
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetMetrics (EAS_DATA_HANDLE pEASData, S_EAS_METRICS *pMetrics);
+
 /*----------------------------------------------------------------------------
  * EAS_SearchFile
  *----------------------------------------------------------------------------
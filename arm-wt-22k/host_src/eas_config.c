@@ -140,6 +140,9 @@ extern EAS_VOID_PTR eas_SMFData;
 extern EAS_VOID_PTR eas_Data;
 extern EAS_VOID_PTR eas_MixBuffer;
 extern EAS_VOID_PTR eas_Synth;
+#ifdef _RUNTIME_POLYPHONY
+extern EAS_VOID_PTR eas_SynthTables;
+#endif
 extern EAS_VOID_PTR eas_MIDI;
 extern EAS_VOID_PTR eas_PCMData;
 extern EAS_VOID_PTR eas_MIDIData;
@@ -428,6 +431,121 @@ EAS_VOID_PTR EAS_CMEnumModules (EAS_INT module)
     return parserModules[module];
 }
 
+#ifdef _FAST_FILE_PROBE
+/*----------------------------------------------------------------------------
+ * EAS_CMModuleNum()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the module number of a parser in parserModules, -1 if the
+ * parser is not in this build
+ *----------------------------------------------------------------------------
+*/
+static EAS_INT EAS_CMModuleNum (EAS_VOID_PTR pModule)
+{
+    EAS_INT module;
+
+    for (module = 0; module < (EAS_INT) NUM_PARSER_MODULES; module++)
+        if (parserModules[module] == pModule)
+            return module;
+    return -1;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_CMMatch()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks for a magic string at the given offset in the header
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL EAS_CMMatch (const EAS_U8 *pHeader, EAS_I32 count, EAS_I32 offset, const char *pMagic)
+{
+    while (*pMagic)
+    {
+        if ((offset >= count) || (pHeader[offset] != (EAS_U8) *pMagic))
+            return EAS_FALSE;
+        offset++;
+        pMagic++;
+    }
+    return EAS_TRUE;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_CMProbeModule()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Picks the file parser from the magic number at the start of the file.
+ * The checks run in module list order: SMF, XMF and WAVE files start with
+ * a four character code, an OTA file with a command length followed by
+ * the ringtone command (0x25 in the upper 7 bits), iMelody with the
+ * BEGIN:IMELODY line and RTTTL with a printable name ended by a colon.
+ * An RTTTL name of BEGIN is left to the full search since iMelody is
+ * asked first.
+ *
+ * Inputs:
+ *  pHeader         - start of the file
+ *  count           - bytes in pHeader
+ *
+ * Outputs:
+ *  returns the module number for EAS_CMEnumModules or -1 if the header
+ *  has no recognizable magic number
+ *----------------------------------------------------------------------------
+*/
+EAS_INT EAS_CMProbeModule (const EAS_U8 *pHeader, EAS_I32 count)
+{
+#if defined(_RTTTL_PARSER) && !defined(_SMAF_PARSER)
+    EAS_I32 i;
+#endif
+
+    if (EAS_CMMatch(pHeader, count, 0, "MThd"))
+        return EAS_CMModuleNum(&EAS_SMF_Parser);
+
+#ifdef _XMF_PARSER
+    if (EAS_CMMatch(pHeader, count, 0, "XMF_"))
+        return EAS_CMModuleNum(&EAS_XMF_Parser);
+#endif
+
+#ifdef _WAVE_PARSER
+    if (EAS_CMMatch(pHeader, count, 0, "RIFF") && EAS_CMMatch(pHeader, count, 8, "WAVE"))
+        return EAS_CMModuleNum(&EAS_Wave_Parser);
+#endif
+
+    /* SMAF has no probe, so nothing behind it may be picked */
+#ifndef _SMAF_PARSER
+
+#ifdef _OTA_PARSER
+    if ((count >= 2) && (pHeader[0] != 0) && ((pHeader[1] >> 1) == 0x25))
+        return EAS_CMModuleNum(&EAS_OTA_Parser);
+#endif
+
+#ifdef _IMELODY_PARSER
+    if (EAS_CMMatch(pHeader, count, 0, "BEGIN:IMELODY"))
+        return EAS_CMModuleNum(&EAS_iMelody_Parser);
+#endif
+
+#ifdef _RTTTL_PARSER
+    /* the iMelody parser ignores case and carriage returns */
+    if ((count > 0) && (pHeader[0] > ' '))
+    {
+        for (i = 0; (i < count) && (pHeader[i] >= ' ') && (pHeader[i] < 0x7f); i++)
+        {
+            if (pHeader[i] != ':')
+                continue;
+            if ((i == 5) && ((pHeader[0] | 0x20) == 'b') && ((pHeader[1] | 0x20) == 'e') &&
+                ((pHeader[2] | 0x20) == 'g') && ((pHeader[3] | 0x20) == 'i') && ((pHeader[4] | 0x20) == 'n'))
+                break;
+            if (i > 0)
+                return EAS_CMModuleNum(&EAS_RTTTL_Parser);
+            break;
+        }
+    }
+#endif
+
+#endif /* _SMAF_PARSER */
+
+    return -1;
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * EAS_CMEnumData()
  *----------------------------------------------------------------------------
@@ -462,6 +580,12 @@ EAS_VOID_PTR EAS_CMEnumData (EAS_INT dataModule)
     case EAS_CM_SYNTH_DATA:
         return &eas_Synth;
 
+#ifdef _RUNTIME_POLYPHONY
+    /* voice tables for synth */
+    case EAS_CM_SYNTH_TABLES:
+        return &eas_SynthTables;
+#endif
+
     /* instance data for MIDI parser */
     case EAS_CM_MIDI_DATA:
         return &eas_MIDI;
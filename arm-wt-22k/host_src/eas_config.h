@@ -64,7 +64,8 @@ typedef enum {
     EAS_CM_IMELODY_DATA,
     EAS_CM_RTTTL_DATA,
     EAS_CM_WAVE_DATA,
-    EAS_CM_CMF_DATA
+    EAS_CM_CMF_DATA,
+    EAS_CM_SYNTH_TABLES
 } E_CM_DATA_MODULES;
 
 typedef struct
@@ -111,6 +112,31 @@ EAS_BOOL EAS_CMStaticMemoryModel (void);
 */
 EAS_VOID_PTR EAS_CMEnumModules (EAS_INT module);
 
+#ifdef _FAST_FILE_PROBE
+/* bytes of the file header EAS_CMProbeModule looks at */
+#define EAS_CM_PROBE_SIZE   16
+
+/*----------------------------------------------------------------------------
+ * EAS_CMProbeModule()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Picks the file parser from the magic number at the start of the file.
+ * A parser is only picked when every parser ahead of it in the module
+ * list would reject the header, so trying it first cannot change which
+ * parser claims the file.
+ *
+ * Inputs:
+ *  pHeader         - start of the file
+ *  count           - bytes in pHeader, up to EAS_CM_PROBE_SIZE
+ *
+ * Outputs:
+ *  returns the module number for EAS_CMEnumModules or -1 if the header
+ *  has no recognizable magic number
+ *----------------------------------------------------------------------------
+*/
+EAS_INT EAS_CMProbeModule (const EAS_U8 *pHeader, EAS_I32 count);
+#endif
+
 /*----------------------------------------------------------------------------
  * EAS_CMEnumData()
  *----------------------------------------------------------------------------
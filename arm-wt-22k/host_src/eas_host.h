@@ -44,12 +44,46 @@ extern "C" {
 
 /* initialization and shutdown routines */
 extern EAS_RESULT EAS_HWInit(EAS_HW_DATA_HANDLE *hwInstData);
+extern EAS_RESULT EAS_HWInitEx(EAS_HW_DATA_HANDLE *hwInstData, const EAS_ALLOCATOR *pAllocator, void *pArena, EAS_I32 arenaSize);
 extern EAS_RESULT EAS_HWShutdown(EAS_HW_DATA_HANDLE hwInstData);
 
 /* threading */
 extern void* EAS_HWRegisterSignalHandler();
 extern EAS_RESULT EAS_HWUnRegisterSignalHandler(void *cookie);
 
+/* worker threads */
+typedef void (*EAS_HW_WORKER_FUNC)(EAS_VOID_PTR pArg, EAS_INT workerNum);
+extern EAS_RESULT EAS_HWCreateWorkers(EAS_HW_DATA_HANDLE hwInstData, EAS_INT numWorkers, EAS_HW_WORKER_FUNC pfWorker, EAS_VOID_PTR pArg, EAS_HW_WORKERS_HANDLE *pWorkers);
+extern void EAS_HWRunWorkers(EAS_HW_WORKERS_HANDLE workers);
+extern void EAS_HWDestroyWorkers(EAS_HW_DATA_HANDLE hwInstData, EAS_HW_WORKERS_HANDLE workers);
+
+/* background threads */
+typedef void (*EAS_HW_THREAD_FUNC)(EAS_VOID_PTR pArg);
+extern EAS_RESULT EAS_HWCreateThread(EAS_HW_DATA_HANDLE hwInstData, EAS_HW_THREAD_FUNC pfThread, EAS_VOID_PTR pArg, EAS_HW_THREAD_HANDLE *pThread);
+extern void EAS_HWJoinThread(EAS_HW_DATA_HANDLE hwInstData, EAS_HW_THREAD_HANDLE thread);
+extern void EAS_HWSleep(EAS_HW_DATA_HANDLE hwInstData, EAS_U32 microseconds);
+
+/* process wide lock for data shared between library instances */
+extern void EAS_HWGlobalLock(void);
+extern void EAS_HWGlobalUnlock(void);
+
+/* recursive lock for data shared by the threads using one library instance */
+extern void EAS_HWLock(EAS_HW_DATA_HANDLE hwInstData);
+extern void EAS_HWUnlock(EAS_HW_DATA_HANDLE hwInstData);
+
+/* load-acquire and store-release of a word shared between two threads */
+extern EAS_U32 EAS_HWAtomicLoad(volatile EAS_U32 *pValue);
+extern void EAS_HWAtomicStore(volatile EAS_U32 *pValue, EAS_U32 value);
+
+/* adds to a word shared by any number of threads and returns its previous value */
+extern EAS_U32 EAS_HWAtomicAdd(volatile EAS_U32 *pValue, EAS_U32 value);
+
+/* replaces a word shared by any number of threads if it still holds the expected value */
+extern EAS_BOOL EAS_HWAtomicCompareSwap(volatile EAS_U32 *pValue, EAS_U32 expected, EAS_U32 value);
+
+/* free running microsecond clock for measuring elapsed time */
+extern EAS_U32 EAS_HWGetTime(EAS_HW_DATA_HANDLE hwInstData);
+
 /* memory functions */
 extern void *EAS_HWMemSet(void *s, int c, EAS_I32 n);
 extern void *EAS_HWMemCpy(void *s1, const void *s2, EAS_I32 n);
@@ -58,8 +92,40 @@ extern EAS_I32 EAS_HWMemCmp(const void *s1, const void *s2, EAS_I32 n);
 /* memory allocation */
 extern void *EAS_HWMalloc(EAS_HW_DATA_HANDLE hwInstData, EAS_I32 size);
 extern void EAS_HWFree(EAS_HW_DATA_HANDLE hwInstData, void *p);
+extern EAS_BOOL EAS_HWSharedHeap(EAS_HW_DATA_HANDLE hwInstData);
+extern EAS_RESULT EAS_HWArenaUsage(EAS_HW_DATA_HANDLE hwInstData, EAS_I32 *pInUse, EAS_I32 *pPeak);
+
+/*
+ * memory categories for EAS_GetMemoryUsage, each module defines
+ * EAS_MEM_CATEGORY before its includes to charge its allocations
+ * to a category other than EAS_MEM_OTHER
+ */
+#define EAS_MEM_OTHER           0
+#define EAS_MEM_VOICE_MGR       1
+#define EAS_MEM_MIX_BUFFERS     2
+#define EAS_MEM_EFFECTS         3
+#define EAS_MEM_DLS             4
+#define EAS_MEM_PARSERS         5
+#define EAS_MEM_PCM_CACHE       6
+#define EAS_MEM_HOST            7
+#define EAS_MEM_SHARED          8   /* may be freed by another instance, charged to none */
+#define EAS_MEM_NUM_CATEGORIES  9
+
+#ifndef EAS_MEM_CATEGORY
+#define EAS_MEM_CATEGORY        EAS_MEM_OTHER
+#endif
+
+#ifdef _MEMORY_ACCOUNTING
+extern void *EAS_HWMallocCategory(EAS_HW_DATA_HANDLE hwInstData, EAS_I32 size, EAS_INT category);
+extern EAS_RESULT EAS_HWMemoryUsage(EAS_HW_DATA_HANDLE hwInstData, EAS_I32 *pUsage);
+#define EAS_HWMalloc(hwInstData, size) EAS_HWMallocCategory(hwInstData, size, EAS_MEM_CATEGORY)
+#else
+#define EAS_HWMallocCategory(hwInstData, size, category) ((void) (category), EAS_HWMalloc(hwInstData, size))
+#endif
 
 /* file I/O */
+extern int EAS_HWMemReadAt(void *handle, void *buf, int offset, int size);
+extern int EAS_HWMemSize(void *handle);
 extern EAS_RESULT EAS_HWOpenFile(EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_LOCATOR locator, EAS_FILE_HANDLE *pFile, EAS_FILE_MODE mode);
 extern EAS_RESULT EAS_HWReadFile(EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, void *pBuffer, EAS_I32 n, EAS_I32 *pBytesRead);
 extern EAS_RESULT EAS_HWGetByte(EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, void *p);
@@ -72,6 +138,22 @@ extern EAS_RESULT EAS_HWFileLength (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HAND
 extern EAS_RESULT EAS_HWDupHandle (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, EAS_FILE_HANDLE* pFile);
 extern EAS_RESULT EAS_HWCloseFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file);
 
+/* read-only view of a whole file that stays valid after the file is closed */
+extern EAS_RESULT EAS_HWMapFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, const void **ppData, EAS_I32 *pSize, EAS_VOID_PTR *pMapping);
+extern void EAS_HWUnmapFile (EAS_HW_DATA_HANDLE hwInstData, EAS_VOID_PTR mapping);
+
+/* contents of a file the host already holds in memory, NULL for other files */
+extern EAS_RESULT EAS_HWFileData (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, const void **ppData, EAS_I32 *pSize);
+
+#ifdef _RT_SAFE_RENDER
+/* reads a whole file into memory so later reads through it and its duplicates never reach the host */
+extern EAS_RESULT EAS_HWPreloadFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file);
+
+/* brackets a render that must not allocate or read files, checked with _RT_SAFE_CHECKS */
+extern void EAS_HWBeginRealtime (EAS_HW_DATA_HANDLE hwInstData);
+extern void EAS_HWEndRealtime (EAS_HW_DATA_HANDLE hwInstData);
+#endif
+
 /* vibrate, LED, and backlight functions */
 extern EAS_RESULT EAS_HWVibrate(EAS_HW_DATA_HANDLE hwInstData, EAS_BOOL state);
 extern EAS_RESULT EAS_HWLED(EAS_HW_DATA_HANDLE hwInstData, EAS_BOOL state);
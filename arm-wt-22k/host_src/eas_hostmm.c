@@ -12,7 +12,8 @@
  * Modify this file to suit the needs of your particular system.
  *
  * EAS_MAX_FILE_HANDLES sets the maximum number of MIDI streams within
- * a MIDI type 1 file that can be played.
+ * a MIDI type 1 file that can be played. The file table starts with
+ * EAS_FILE_HANDLE_BLOCK handles and grows as more are needed.
  *
  * EAS_HW_FILE is a structure to support the file I/O functions. It
  * comprises the file descriptor, the file read pointer, and
@@ -40,6 +41,9 @@
  *----------------------------------------------------------------------------
 */
 
+/* the host's own allocations are reported as host memory */
+#define EAS_MEM_CATEGORY    EAS_MEM_HOST
+
 #ifdef _lint
 #include "lint_stdlib.h"
 #else
@@ -55,6 +59,7 @@
 #include <errno.h>
 #include <signal.h>
 #include <pthread.h>
+#include <time.h>
 #include <media/MediaPlayerInterface.h>
 #endif
 
@@ -62,6 +67,19 @@
 
 /* Only for debugging LED, vibrate, and backlight functions */
 #include "eas_report.h"
+#include "eas_trace.h"
+
+/*
+ * with _RT_SAFE_CHECKS, allocating, freeing or reading a file through the
+ * host on a thread that is running a realtime render is a bug in the library
+ */
+#if defined(_RT_SAFE_RENDER) && defined(_RT_SAFE_CHECKS)
+#include <assert.h>
+static __thread EAS_INT EAS_realtimeDepth;
+#define EAS_HW_CHECK_NOT_REALTIME()     assert(EAS_realtimeDepth == 0)
+#else
+#define EAS_HW_CHECK_NOT_REALTIME()
+#endif
 
 /* this module requires dynamic memory support */
 #ifdef _STATIC_MEMORY
@@ -75,6 +93,54 @@
 #define EAS_MAX_FILE_HANDLES    100
 #endif
 
+/*
+ * handles in the instance data and added each time the file table grows.
+ * Handles are pointers into the table, so the blocks never move; they are
+ * kept until shutdown and free handles are linked into a list, so open,
+ * dup and close take constant time.
+ */
+#ifndef EAS_FILE_HANDLE_BLOCK
+#define EAS_FILE_HANDLE_BLOCK   16
+#endif
+
+/*
+ * read-ahead cache for readAt files, shared by duplicated handles. The
+ * cache starts with EAS_FILE_CACHE_BLOCKS blocks and each duplicate adds
+ * one, up to EAS_FILE_CACHE_MAX_BLOCKS, so every SMF track can keep its
+ * own block. Set EAS_FILE_CACHE_BLOCKS to 0 to disable the cache.
+ */
+#ifndef EAS_FILE_CACHE_BLOCK_SIZE
+#define EAS_FILE_CACHE_BLOCK_SIZE   4096
+#endif
+
+#ifndef EAS_FILE_CACHE_BLOCKS
+#define EAS_FILE_CACHE_BLOCKS       4
+#endif
+
+#ifndef EAS_FILE_CACHE_MAX_BLOCKS
+#define EAS_FILE_CACHE_MAX_BLOCKS   34
+#endif
+
+typedef struct eas_hw_cache_block_tag
+{
+    EAS_U8 *pData;          /* allocated on first use */
+    int start;
+    int count;
+    EAS_U32 lastUse;
+} EAS_HW_CACHE_BLOCK;
+
+typedef struct eas_hw_file_cache_tag
+{
+    EAS_HW_CACHE_BLOCK blocks[EAS_FILE_CACHE_MAX_BLOCKS];
+    int numBlocks;
+    int fileSize;
+    int refCount;
+    EAS_U32 useCount;
+#ifdef _RT_SAFE_RENDER
+    EAS_U8 *pPreload;       /* whole file, see EAS_HWPreloadFile */
+#endif
+} EAS_HW_FILE_CACHE;
+
 /*
  * this structure and the related function are here
  * to support the ability to create duplicate handles
@@ -89,140 +155,1260 @@ typedef struct eas_hw_file_tag
     int (*size)(void *handle);
     int filePos;
     void *handle;
+    const EAS_U8 *pData;    /* contents of memory files, else NULL */
+    int dataSize;
+    EAS_HW_FILE_CACHE *pCache;
+    EAS_HW_CACHE_BLOCK *pBlock;     /* last cache block used by this handle */
+    struct eas_hw_file_tag *pNextFree;  /* next free handle, unused while open */
 } EAS_HW_FILE;
 
+/* handles added to the file table after EAS_HWInit */
+typedef struct eas_hw_file_block_tag
+{
+    struct eas_hw_file_block_tag *pNext;
+    EAS_HW_FILE files[];
+} EAS_HW_FILE_BLOCK;
+
+/*
+ * memory arena, allocations are carved from one block given to
+ * EAS_HWInitEx. Free blocks are kept in address order and merged with
+ * their neighbours. Freed blocks up to EAS_ARENA_SLAB_MAX bytes are kept
+ * on a list per size instead, so the parser and stream structures that
+ * are freed and allocated again on every open are reused as is.
+ */
+#define EAS_ARENA_ALIGN         16      /* alignment of every allocation */
+#define EAS_ARENA_LINE          64      /* the arena starts on a cache line */
+#define EAS_ARENA_MIN_BLOCK     (2 * EAS_ARENA_ALIGN)
+
+#ifndef EAS_ARENA_SLAB_MAX
+#define EAS_ARENA_SLAB_MAX      1024
+#endif
+#define EAS_ARENA_SLAB_CLASSES  (EAS_ARENA_SLAB_MAX / EAS_ARENA_ALIGN)
+
+/* header of an arena block, the allocation follows it at EAS_ARENA_ALIGN */
+typedef struct eas_hw_arena_block_tag
+{
+    size_t size;                                /* bytes including the header */
+    struct eas_hw_arena_block_tag *pNext;       /* next free block, unused while allocated */
+} EAS_HW_ARENA_BLOCK;
+
+typedef struct eas_hw_arena_tag
+{
+    EAS_HW_ARENA_BLOCK *pFree;                  /* free blocks in address order */
+    EAS_HW_ARENA_BLOCK *pSlabs[EAS_ARENA_SLAB_CLASSES];
+    EAS_U8 *pBase;                              /* allocations come from pBase to pBase + size */
+    size_t size;
+    size_t inUse;                               /* bytes allocated including headers */
+    size_t peak;
+    void *pOwned;                               /* block allocated for the arena, NULL if the caller's */
+    pthread_mutex_t lock;                       /* only held inside allocations */
+} EAS_HW_ARENA;
+
 typedef struct eas_hw_inst_data_tag
 {
-    EAS_HW_FILE files[EAS_MAX_FILE_HANDLES];
+    EAS_HW_FILE files[EAS_FILE_HANDLE_BLOCK];
+    EAS_HW_FILE *pFreeFiles;            /* free handles */
+    EAS_HW_FILE_BLOCK *pFileBlocks;     /* handles added to the table */
+    int numFiles;                       /* handles in the table */
+    pthread_mutex_t lock;   /* instance lock, also protects the file table */
+    EAS_ALLOCATOR allocator;    /* pfMalloc is NULL for the C library */
+    EAS_HW_ARENA *pArena;       /* NULL if there is no arena */
+    EAS_HW_ARENA arena;
+#ifdef _MEMORY_ACCOUNTING
+    EAS_I32 memUsage[EAS_MEM_NUM_CATEGORIES];   /* bytes allocated, updated atomically */
+#endif
 } EAS_HW_INST_DATA;
 
+typedef struct eas_hw_thread_tag
+{
+    pthread_t thread;
+    EAS_HW_THREAD_FUNC pfThread;
+    EAS_VOID_PTR pArg;
+} EAS_HW_THREAD;
+
+#ifndef EAS_MAX_WORKERS
+#define EAS_MAX_WORKERS         8
+#endif
+
+/*
+ * worker thread pool, the calling thread acts as worker 0
+ * so only numWorkers - 1 threads are created
+ */
+typedef struct eas_hw_worker_thread_tag
+{
+    pthread_t thread;
+    struct eas_hw_workers_tag *pWorkers;
+    EAS_INT workerNum;
+} EAS_HW_WORKER_THREAD;
+
+typedef struct eas_hw_workers_tag
+{
+    EAS_HW_WORKER_THREAD threads[EAS_MAX_WORKERS];
+    pthread_mutex_t lock;
+    pthread_cond_t startCond;
+    pthread_cond_t doneCond;
+    EAS_HW_WORKER_FUNC pfWorker;
+    EAS_VOID_PTR pArg;
+    EAS_INT numWorkers;
+    EAS_INT numThreads;
+    EAS_INT pending;
+    EAS_U32 generation;
+    EAS_BOOL quit;
+} EAS_HW_WORKERS;
+
 pthread_key_t EAS_sigbuskey;
 
+/* protects data shared between library instances */
+static pthread_mutex_t EAS_globalLock = PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef _MEMORY_ACCOUNTING
+/* every allocation starts with its size and category, padded to keep the alignment of the allocator */
+#define EAS_MEM_HEADER_SIZE     16
+
+/* bytes allocated as EAS_MEM_SHARED by all instances */
+static EAS_I32 EAS_sharedMemUsage;
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_HWAddFiles
+ *
+ * Add closed handles to the file table
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_HWAddFiles (EAS_HW_DATA_HANDLE hwInstData, EAS_HW_FILE *files, int count)
+{
+    int i;
+
+    /* the lowest handle is used first */
+    for (i = count - 1; i >= 0; i--)
+    {
+        files[i].handle = NULL;
+        files[i].pNextFree = hwInstData->pFreeFiles;
+        hwInstData->pFreeFiles = &files[i];
+    }
+    hwInstData->numFiles += count;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_HWInit
+ *
+ * Initialize host wrapper interface
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_HWInit (EAS_HW_DATA_HANDLE *pHWInstData)
+{
+    return EAS_HWInitEx(pHWInstData, NULL, NULL, 0);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_HWInitEx
+ *
+ * Initialize host wrapper interface with its own memory. EAS_HWMalloc
+ * uses pAllocator instead of the C library when it is not NULL. When
+ * arenaSize is not zero everything is allocated from one arena instead,
+ * the caller's block at pArena or, if pArena is NULL, a block of
+ * arenaSize bytes from the allocator. The instance data is placed at the
+ * start of the arena.
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_HWInitEx (EAS_HW_DATA_HANDLE *pHWInstData, const EAS_ALLOCATOR *pAllocator, void *pArena, EAS_I32 arenaSize)
+{
+    EAS_HW_INST_DATA *pHW;
+    pthread_mutexattr_t attr;
+    void *pOwned;
+    size_t start = 0;
+    size_t end = 0;
+
+    *pHWInstData = NULL;
+    if ((arenaSize < 0) || ((pArena != NULL) && (arenaSize == 0)))
+        return EAS_ERROR_PARAMETER_RANGE;
+    if ((pAllocator != NULL) && ((pAllocator->pfMalloc == NULL) || (pAllocator->pfFree == NULL)))
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    /* need to track file opens for duplicate handles */
+    pOwned = NULL;
+    if (arenaSize > 0)
+    {
+        /* the instance data goes on the first cache line of the arena */
+        if (pArena == NULL)
+        {
+            pArena = pOwned = (pAllocator != NULL) ? pAllocator->pfMalloc(pAllocator->pContext, arenaSize) : malloc((size_t) arenaSize);
+            if (pArena == NULL)
+                return EAS_ERROR_MALLOC_FAILED;
+        }
+        start = ((size_t) pArena + EAS_ARENA_LINE - 1) & ~((size_t) EAS_ARENA_LINE - 1);
+        end = ((size_t) pArena + (size_t) arenaSize) & ~((size_t) EAS_ARENA_ALIGN - 1);
+        if (end < start + ((sizeof(EAS_HW_INST_DATA) + EAS_ARENA_LINE - 1) & ~((size_t) EAS_ARENA_LINE - 1)) + EAS_ARENA_MIN_BLOCK)
+        {
+            if (pOwned != NULL)
+            {
+                if (pAllocator != NULL)
+                    pAllocator->pfFree(pAllocator->pContext, pOwned);
+                else
+                    free(pOwned);
+            }
+            return EAS_ERROR_MALLOC_FAILED;
+        }
+        pHW = (EAS_HW_INST_DATA*) start;
+    }
+    else if (pAllocator != NULL)
+        pHW = pAllocator->pfMalloc(pAllocator->pContext, sizeof(EAS_HW_INST_DATA));
+    else
+        pHW = malloc(sizeof(EAS_HW_INST_DATA));
+    if (pHW == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    *pHWInstData = pHW;
+
+    EAS_HWMemSet(*pHWInstData, 0, sizeof(EAS_HW_INST_DATA));
+    if (pAllocator != NULL)
+        pHW->allocator = *pAllocator;
+
+    /* the rest of the arena is one free block */
+    if (arenaSize > 0)
+    {
+        pHW->pArena = &pHW->arena;
+        pHW->arena.pBase = (EAS_U8*) start + ((sizeof(EAS_HW_INST_DATA) + EAS_ARENA_LINE - 1) & ~((size_t) EAS_ARENA_LINE - 1));
+        pHW->arena.size = end - (size_t) pHW->arena.pBase;
+        pHW->arena.pFree = (EAS_HW_ARENA_BLOCK*) pHW->arena.pBase;
+        pHW->arena.pFree->size = pHW->arena.size;
+        pHW->arena.pFree->pNext = NULL;
+        pHW->arena.pOwned = pOwned;
+        pthread_mutex_init(&pHW->arena.lock, NULL);
+    }
+
+    EAS_HWAddFiles(pHW, pHW->files, EAS_FILE_HANDLE_BLOCK);
+
+    /* the lock is recursive so a locked caller can close files */
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&(*pHWInstData)->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_HWShutdown
+ *
+ * Shut down host wrapper interface
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_HWShutdown (EAS_HW_DATA_HANDLE hwInstData)
+{
+    EAS_HW_FILE_BLOCK *pBlock;
+    void *p;
+
+    /* free the handles added to the file table */
+    while ((pBlock = hwInstData->pFileBlocks) != NULL)
+    {
+        hwInstData->pFileBlocks = pBlock->pNext;
+        EAS_HWFree(hwInstData, pBlock);
+    }
+
+    pthread_mutex_destroy(&hwInstData->lock);
+
+    /* the instance data is in the arena */
+    p = hwInstData;
+    if (hwInstData->pArena != NULL)
+    {
+        pthread_mutex_destroy(&hwInstData->arena.lock);
+        p = hwInstData->arena.pOwned;
+    }
+    if (p == NULL)
+        return EAS_SUCCESS;
+    if (hwInstData->allocator.pfMalloc != NULL)
+        hwInstData->allocator.pfFree(hwInstData->allocator.pContext, p);
+    else
+        free(p);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWWorkerThread
+ *
+ * Thread function for the worker pool
+ *
+ *----------------------------------------------------------------------------
+*/
+static void *EAS_HWWorkerThread (void *p)
+{
+    EAS_HW_WORKER_THREAD *pThread = (EAS_HW_WORKER_THREAD*) p;
+    EAS_HW_WORKERS *pWorkers = pThread->pWorkers;
+    EAS_U32 generation = 0;
+
+    pthread_mutex_lock(&pWorkers->lock);
+    for (;;)
+    {
+        /* wait for the next batch of work */
+        while (!pWorkers->quit && (pWorkers->generation == generation))
+            pthread_cond_wait(&pWorkers->startCond, &pWorkers->lock);
+        if (pWorkers->quit)
+            break;
+        generation = pWorkers->generation;
+        pthread_mutex_unlock(&pWorkers->lock);
+
+        (*pWorkers->pfWorker)(pWorkers->pArg, pThread->workerNum);
+
+        pthread_mutex_lock(&pWorkers->lock);
+        if (--pWorkers->pending == 0)
+            pthread_cond_signal(&pWorkers->doneCond);
+    }
+    pthread_mutex_unlock(&pWorkers->lock);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWCreateWorkers
+ *
+ * Create a pool of worker threads. Each call to EAS_HWRunWorkers calls
+ * pfWorker once for each worker number from 0 to numWorkers - 1, with
+ * worker 0 running on the calling thread.
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_HWCreateWorkers (EAS_HW_DATA_HANDLE hwInstData, EAS_INT numWorkers, EAS_HW_WORKER_FUNC pfWorker, EAS_VOID_PTR pArg, EAS_HW_WORKERS_HANDLE *pWorkers)
+{
+    EAS_HW_WORKERS *pPool;
+    EAS_INT i;
+
+    *pWorkers = NULL;
+    if ((numWorkers < 1) || (numWorkers > EAS_MAX_WORKERS))
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    pPool = EAS_HWMalloc(hwInstData, sizeof(EAS_HW_WORKERS));
+    if (pPool == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    EAS_HWMemSet(pPool, 0, sizeof(EAS_HW_WORKERS));
+    pthread_mutex_init(&pPool->lock, NULL);
+    pthread_cond_init(&pPool->startCond, NULL);
+    pthread_cond_init(&pPool->doneCond, NULL);
+    pPool->pfWorker = pfWorker;
+    pPool->pArg = pArg;
+    pPool->numWorkers = numWorkers;
+
+    for (i = 1; i < numWorkers; i++)
+    {
+        pPool->threads[i].pWorkers = pPool;
+        pPool->threads[i].workerNum = i;
+        if (pthread_create(&pPool->threads[i].thread, NULL, EAS_HWWorkerThread, &pPool->threads[i]) != 0)
+        {
+            EAS_HWDestroyWorkers(hwInstData, pPool);
+            return EAS_ERROR_MALLOC_FAILED;
+        }
+        pPool->numThreads = i;
+    }
+
+    *pWorkers = pPool;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWRunWorkers
+ *
+ * Run one batch of work on all workers and wait for them to finish
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_HWRunWorkers (EAS_HW_WORKERS_HANDLE workers)
+{
+    pthread_mutex_lock(&workers->lock);
+    workers->pending = workers->numThreads;
+    workers->generation++;
+    pthread_cond_broadcast(&workers->startCond);
+    pthread_mutex_unlock(&workers->lock);
+
+    (*workers->pfWorker)(workers->pArg, 0);
+
+    pthread_mutex_lock(&workers->lock);
+    while (workers->pending > 0)
+        pthread_cond_wait(&workers->doneCond, &workers->lock);
+    pthread_mutex_unlock(&workers->lock);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWDestroyWorkers
+ *
+ * Stop the worker threads and free the pool
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_HWDestroyWorkers (EAS_HW_DATA_HANDLE hwInstData, EAS_HW_WORKERS_HANDLE workers)
+{
+    EAS_INT i;
+
+    if (workers == NULL)
+        return;
+
+    pthread_mutex_lock(&workers->lock);
+    workers->quit = EAS_TRUE;
+    pthread_cond_broadcast(&workers->startCond);
+    pthread_mutex_unlock(&workers->lock);
+
+    for (i = 1; i <= workers->numThreads; i++)
+        pthread_join(workers->threads[i].thread, NULL);
+
+    pthread_cond_destroy(&workers->doneCond);
+    pthread_cond_destroy(&workers->startCond);
+    pthread_mutex_destroy(&workers->lock);
+    EAS_HWFree(hwInstData, workers);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWThread
+ *
+ * Thread function for EAS_HWCreateThread
+ *
+ *----------------------------------------------------------------------------
+*/
+static void *EAS_HWThread (void *p)
+{
+    EAS_HW_THREAD *pThread = (EAS_HW_THREAD*) p;
+
+    (*pThread->pfThread)(pThread->pArg);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWCreateThread
+ *
+ * Start a thread that calls pfThread once. The thread must be joined
+ * with EAS_HWJoinThread.
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_HWCreateThread (EAS_HW_DATA_HANDLE hwInstData, EAS_HW_THREAD_FUNC pfThread, EAS_VOID_PTR pArg, EAS_HW_THREAD_HANDLE *pThread)
+{
+    EAS_HW_THREAD *pNewThread;
+
+    *pThread = NULL;
+    pNewThread = EAS_HWMalloc(hwInstData, sizeof(EAS_HW_THREAD));
+    if (pNewThread == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    pNewThread->pfThread = pfThread;
+    pNewThread->pArg = pArg;
+    if (pthread_create(&pNewThread->thread, NULL, EAS_HWThread, pNewThread) != 0)
+    {
+        EAS_HWFree(hwInstData, pNewThread);
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+
+    *pThread = pNewThread;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWJoinThread
+ *
+ * Wait for a thread started by EAS_HWCreateThread to return, and free it
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_HWJoinThread (EAS_HW_DATA_HANDLE hwInstData, EAS_HW_THREAD_HANDLE thread)
+{
+    if (thread == NULL)
+        return;
+    pthread_join(thread->thread, NULL);
+    EAS_HWFree(hwInstData, thread);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWSleep
+ *
+ * Suspends the calling thread for at least the given time
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, hwInstData) hwInstData available for customer use */
+void EAS_HWSleep (EAS_HW_DATA_HANDLE hwInstData, EAS_U32 microseconds)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t) (microseconds / 1000000);
+    ts.tv_nsec = (long) (microseconds % 1000000) * 1000;
+    while ((nanosleep(&ts, &ts) != 0) && (errno == EINTR))
+        ;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWGlobalLock
+ *
+ * Lock data shared between all library instances in the process
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_HWGlobalLock (void)
+{
+    pthread_mutex_lock(&EAS_globalLock);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWGlobalUnlock
+ *
+ * Unlock data shared between all library instances in the process
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_HWGlobalUnlock (void)
+{
+    pthread_mutex_unlock(&EAS_globalLock);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWLock
+ *
+ * Lock data shared by the threads using one library instance
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_HWLock (EAS_HW_DATA_HANDLE hwInstData)
+{
+    pthread_mutex_lock(&hwInstData->lock);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWUnlock
+ *
+ * Unlock data shared by the threads using one library instance
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_HWUnlock (EAS_HW_DATA_HANDLE hwInstData)
+{
+    pthread_mutex_unlock(&hwInstData->lock);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWAtomicLoad
+ *
+ * Reads a word written by another thread. Writes made by that thread
+ * before it stored the word are visible once the new value is seen.
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_U32 EAS_HWAtomicLoad (volatile EAS_U32 *pValue)
+{
+    return __atomic_load_n(pValue, __ATOMIC_ACQUIRE);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWAtomicStore
+ *
+ * Writes a word read by another thread, after all previous writes
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_HWAtomicStore (volatile EAS_U32 *pValue, EAS_U32 value)
+{
+    __atomic_store_n(pValue, value, __ATOMIC_RELEASE);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWAtomicAdd
+ *
+ * Adds to a word that several threads update and returns the value it had
+ * before. No two callers see the same previous value.
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_U32 EAS_HWAtomicAdd (volatile EAS_U32 *pValue, EAS_U32 value)
+{
+    return __atomic_fetch_add(pValue, value, __ATOMIC_ACQ_REL);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWAtomicCompareSwap
+ *
+ * Writes value to a word that several threads update if the word still
+ * holds expected. Returns EAS_TRUE if this caller made the change.
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL EAS_HWAtomicCompareSwap (volatile EAS_U32 *pValue, EAS_U32 expected, EAS_U32 value)
+{
+    return __atomic_compare_exchange_n(pValue, &expected, value, EAS_FALSE,
+        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ? EAS_TRUE : EAS_FALSE;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWGetTime
+ *
+ * Returns a free running microsecond count. Only differences between two
+ * values are meaningful.
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, hwInstData) hwInstData available for customer use */
+EAS_U32 EAS_HWGetTime (EAS_HW_DATA_HANDLE hwInstData)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (EAS_U32) ts.tv_sec * 1000000 + (EAS_U32) (ts.tv_nsec / 1000);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWArenaInsert
+ *
+ * Returns a block to the address ordered free list of the arena, merging
+ * it with the free blocks on either side
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_HWArenaInsert (EAS_HW_ARENA *pArena, EAS_HW_ARENA_BLOCK *pBlock)
+{
+    EAS_HW_ARENA_BLOCK **ppPrev;
+    EAS_HW_ARENA_BLOCK *pPrev;
+
+    pPrev = NULL;
+    for (ppPrev = &pArena->pFree; (*ppPrev != NULL) && (*ppPrev < pBlock); ppPrev = &(*ppPrev)->pNext)
+        pPrev = *ppPrev;
+
+    /* merge with the next block */
+    pBlock->pNext = *ppPrev;
+    if ((pBlock->pNext != NULL) && ((EAS_U8*) pBlock + pBlock->size == (EAS_U8*) pBlock->pNext))
+    {
+        pBlock->size += pBlock->pNext->size;
+        pBlock->pNext = pBlock->pNext->pNext;
+    }
+
+    /* merge with the previous block */
+    if ((pPrev != NULL) && ((EAS_U8*) pPrev + pPrev->size == (EAS_U8*) pBlock))
+    {
+        pPrev->size += pBlock->size;
+        pPrev->pNext = pBlock->pNext;
+    }
+    else
+        *ppPrev = pBlock;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWArenaAlloc
+ *
+ * Allocates from the arena, returns NULL when the arena is full
+ *
+ *----------------------------------------------------------------------------
+*/
+static void *EAS_HWArenaAlloc (EAS_HW_ARENA *pArena, size_t size)
+{
+    EAS_HW_ARENA_BLOCK **ppBlock;
+    EAS_HW_ARENA_BLOCK *pBlock;
+    EAS_HW_ARENA_BLOCK *pRest;
+    size_t slab;
+    int retry;
+
+    if (size > pArena->size)
+        return NULL;
+    size = (size + 2 * EAS_ARENA_ALIGN - 1) & ~((size_t) EAS_ARENA_ALIGN - 1);
+
+    pthread_mutex_lock(&pArena->lock);
+    pBlock = NULL;
+
+    /* reuse a block of the same size */
+    if (size <= EAS_ARENA_SLAB_MAX)
+    {
+        pBlock = pArena->pSlabs[size / EAS_ARENA_ALIGN - 1];
+        if (pBlock != NULL)
+            pArena->pSlabs[size / EAS_ARENA_ALIGN - 1] = pBlock->pNext;
+    }
+
+    /* otherwise take the first free block that is large enough */
+    for (retry = 0; (pBlock == NULL) && (retry < 2); retry++)
+    {
+        for (ppBlock = &pArena->pFree; *ppBlock != NULL; ppBlock = &(*ppBlock)->pNext)
+        {
+            if ((*ppBlock)->size >= size)
+                break;
+        }
+        if ((pBlock = *ppBlock) != NULL)
+        {
+            if (pBlock->size - size >= EAS_ARENA_MIN_BLOCK)
+            {
+                pRest = (EAS_HW_ARENA_BLOCK*) ((EAS_U8*) pBlock + size);
+                pRest->size = pBlock->size - size;
+                pRest->pNext = pBlock->pNext;
+                pBlock->size = size;
+                *ppBlock = pRest;
+            }
+            else
+                *ppBlock = pBlock->pNext;
+            break;
+        }
+
+        /* give the blocks kept for reuse back and try again */
+        for (slab = 0; slab < EAS_ARENA_SLAB_CLASSES; slab++)
+        {
+            while ((pRest = pArena->pSlabs[slab]) != NULL)
+            {
+                pArena->pSlabs[slab] = pRest->pNext;
+                EAS_HWArenaInsert(pArena, pRest);
+            }
+        }
+    }
+
+    if (pBlock != NULL)
+    {
+        pArena->inUse += pBlock->size;
+        if (pArena->inUse > pArena->peak)
+            pArena->peak = pArena->inUse;
+    }
+    pthread_mutex_unlock(&pArena->lock);
+    return (pBlock != NULL) ? (EAS_U8*) pBlock + EAS_ARENA_ALIGN : NULL;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWArenaFree
+ *
+ * Frees memory allocated from the arena
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_HWArenaFree (EAS_HW_ARENA *pArena, void *p)
+{
+    EAS_HW_ARENA_BLOCK *pBlock = (EAS_HW_ARENA_BLOCK*) ((EAS_U8*) p - EAS_ARENA_ALIGN);
+
+    pthread_mutex_lock(&pArena->lock);
+    pArena->inUse -= pBlock->size;
+    if (pBlock->size <= EAS_ARENA_SLAB_MAX)
+    {
+        pBlock->pNext = pArena->pSlabs[pBlock->size / EAS_ARENA_ALIGN - 1];
+        pArena->pSlabs[pBlock->size / EAS_ARENA_ALIGN - 1] = pBlock;
+    }
+    else
+        EAS_HWArenaInsert(pArena, pBlock);
+    pthread_mutex_unlock(&pArena->lock);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWAllocate
+ *
+ * Allocates dynamic memory from the arena, the allocator or the C library
+ *
+ *----------------------------------------------------------------------------
+*/
+static void *EAS_HWAllocate (EAS_HW_DATA_HANDLE hwInstData, EAS_I32 size)
+{
+    EAS_HW_CHECK_NOT_REALTIME();
+    if (hwInstData->pArena != NULL)
+        return EAS_HWArenaAlloc(hwInstData->pArena, (size_t) size);
+    if (hwInstData->allocator.pfMalloc != NULL)
+        return hwInstData->allocator.pfMalloc(hwInstData->allocator.pContext, size);
+    return malloc((size_t) size);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWRelease
+ *
+ * Frees memory from EAS_HWAllocate
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_HWRelease (EAS_HW_DATA_HANDLE hwInstData, void *p)
+{
+    EAS_HW_CHECK_NOT_REALTIME();
+    if (hwInstData->pArena != NULL)
+        EAS_HWArenaFree(hwInstData->pArena, p);
+    else if (hwInstData->allocator.pfMalloc != NULL)
+        hwInstData->allocator.pfFree(hwInstData->allocator.pContext, p);
+    else
+        free(p);
+}
+
+#ifdef _MEMORY_ACCOUNTING
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWMallocCategory
+ *
+ * Allocates dynamic memory and charges it to a category of the instance
+ *
+ *----------------------------------------------------------------------------
+*/
+void *EAS_HWMallocCategory (EAS_HW_DATA_HANDLE hwInstData, EAS_I32 size, EAS_INT category)
+{
+    EAS_I32 *pHeader;
+
+    if ((size <= 0) || (size > 0x7fffffff - EAS_MEM_HEADER_SIZE))
+        return NULL;
+    if ((category < 0) || (category >= EAS_MEM_NUM_CATEGORIES))
+        category = EAS_MEM_OTHER;
+    if ((pHeader = EAS_HWAllocate(hwInstData, size + EAS_MEM_HEADER_SIZE)) == NULL)
+        return NULL;
+    pHeader[0] = size;
+    pHeader[1] = (EAS_I32) category;
+    if (category == EAS_MEM_SHARED)
+        __atomic_add_fetch(&EAS_sharedMemUsage, size, __ATOMIC_RELAXED);
+    else
+        __atomic_add_fetch(&hwInstData->memUsage[category], size, __ATOMIC_RELAXED);
+    return (EAS_U8*) pHeader + EAS_MEM_HEADER_SIZE;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWMemoryUsage
+ *
+ * Returns the bytes allocated in each category. EAS_MEM_SHARED holds the
+ * total for all instances and EAS_MEM_HOST includes the instance data.
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_HWMemoryUsage (EAS_HW_DATA_HANDLE hwInstData, EAS_I32 *pUsage)
+{
+    EAS_INT i;
+
+    for (i = 0; i < EAS_MEM_NUM_CATEGORIES; i++)
+        pUsage[i] = __atomic_load_n(&hwInstData->memUsage[i], __ATOMIC_RELAXED);
+    pUsage[EAS_MEM_SHARED] = __atomic_load_n(&EAS_sharedMemUsage, __ATOMIC_RELAXED);
+    pUsage[EAS_MEM_HOST] += (EAS_I32) sizeof(EAS_HW_INST_DATA);
+    return EAS_SUCCESS;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWMalloc
+ *
+ * Allocates dynamic memory
+ *
+ *----------------------------------------------------------------------------
+*/
+#undef EAS_HWMalloc
+void *EAS_HWMalloc (EAS_HW_DATA_HANDLE hwInstData, EAS_I32 size)
+{
+#ifdef _MEMORY_ACCOUNTING
+    return EAS_HWMallocCategory(hwInstData, size, EAS_MEM_OTHER);
+#else
+    /* Since this whole library loves signed sizes, let's not let
+     * negative or 0 values through */
+    if (size <= 0)
+      return NULL;
+    return EAS_HWAllocate(hwInstData, size);
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWFree
+ *
+ * Frees dynamic memory
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_HWFree (EAS_HW_DATA_HANDLE hwInstData, void *p)
+{
+#ifdef _MEMORY_ACCOUNTING
+    EAS_I32 *pHeader;
+#endif
+
+    if (p == NULL)
+        return;
+#ifdef _MEMORY_ACCOUNTING
+    /* shared memory may come from another instance */
+    pHeader = (EAS_I32*) ((EAS_U8*) p - EAS_MEM_HEADER_SIZE);
+    if (pHeader[1] == EAS_MEM_SHARED)
+        __atomic_sub_fetch(&EAS_sharedMemUsage, pHeader[0], __ATOMIC_RELAXED);
+    else
+        __atomic_sub_fetch(&hwInstData->memUsage[pHeader[1]], pHeader[0], __ATOMIC_RELAXED);
+    p = pHeader;
+#endif
+    EAS_HWRelease(hwInstData, p);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWSharedHeap
+ *
+ * Returns EAS_TRUE if memory allocated by this instance may be freed by
+ * another one, i.e. both use the C library heap
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL EAS_HWSharedHeap (EAS_HW_DATA_HANDLE hwInstData)
+{
+    return (hwInstData->pArena == NULL) && (hwInstData->allocator.pfMalloc == NULL);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWArenaUsage
+ *
+ * Returns the bytes allocated from the arena, now and at most since the
+ * instance was initialized
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_HWArenaUsage (EAS_HW_DATA_HANDLE hwInstData, EAS_I32 *pInUse, EAS_I32 *pPeak)
+{
+    EAS_HW_ARENA *pArena = hwInstData->pArena;
+
+    if (pArena == NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    pthread_mutex_lock(&pArena->lock);
+    *pInUse = (EAS_I32) pArena->inUse;
+    *pPeak = (EAS_I32) pArena->peak;
+    pthread_mutex_unlock(&pArena->lock);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWMemCpy
+ *
+ * Copy memory wrapper
+ *
+ *----------------------------------------------------------------------------
+*/
+void *EAS_HWMemCpy (void *dest, const void *src, EAS_I32 amount)
+{
+    if (amount < 0)  {
+      EAS_ReportEx(_EAS_SEVERITY_NOFILTER, 0x1a54b6e8, 0x00000004 , amount);
+      exit(255);
+    }
+    return memcpy(dest, src, (size_t) amount);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWMemSet
+ *
+ * Set memory wrapper
+ *
+ *----------------------------------------------------------------------------
+*/
+void *EAS_HWMemSet (void *dest, int val, EAS_I32 amount)
+{
+    if (amount < 0)  {
+      EAS_ReportEx(_EAS_SEVERITY_NOFILTER, 0x1a54b6e8, 0x00000005 , amount);
+      exit(255);
+    }
+    return memset(dest, val, (size_t) amount);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWMemCmp
+ *
+ * Compare memory wrapper
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 EAS_HWMemCmp (const void *s1, const void *s2, EAS_I32 amount)
+{
+    if (amount < 0) {
+      EAS_ReportEx(_EAS_SEVERITY_NOFILTER, 0x1a54b6e8, 0x00000006 , amount);
+      exit(255);
+    }
+    return (EAS_I32) memcmp(s1, s2, (size_t) amount);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWMemReadAt
+ *
+ * readAt function for memory files. Files opened with this function are
+ * read directly from memory by the functions below, it is only called by
+ * hosts that do not recognize memory files.
+ *
+ *----------------------------------------------------------------------------
+*/
+int EAS_HWMemReadAt (void *handle, void *buf, int offset, int size)
+{
+    const EAS_MEMORY_FILE *pMemFile = (const EAS_MEMORY_FILE*) handle;
+
+    if ((offset < 0) || (size < 0) || (offset > pMemFile->size))
+        return 0;
+    if (size > pMemFile->size - offset)
+        size = (int) (pMemFile->size - offset);
+    memcpy(buf, (const EAS_U8*) pMemFile->pData + offset, (size_t) size);
+    return size;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWMemSize
+ *
+ * size function for memory files
+ *
+ *----------------------------------------------------------------------------
+*/
+int EAS_HWMemSize (void *handle)
+{
+    return (int) ((const EAS_MEMORY_FILE*) handle)->size;
+}
+
 /*----------------------------------------------------------------------------
- * EAS_HWInit
  *
- * Initialize host wrapper interface
+ * EAS_HWFileSize
+ *
+ * Returns the size of the file
  *
  *----------------------------------------------------------------------------
 */
-EAS_RESULT EAS_HWInit (EAS_HW_DATA_HANDLE *pHWInstData)
+static int EAS_HWFileSize (EAS_HW_FILE *file)
 {
-    EAS_HW_FILE *file;
-    int i;
-
-    /* need to track file opens for duplicate handles */
-    *pHWInstData = malloc(sizeof(EAS_HW_INST_DATA));
-    if (!(*pHWInstData))
-        return EAS_ERROR_MALLOC_FAILED;
-
-    EAS_HWMemSet(*pHWInstData, 0, sizeof(EAS_HW_INST_DATA));
-
-    file = (*pHWInstData)->files;
-    for (i = 0; i < EAS_MAX_FILE_HANDLES; i++)
-    {
-        file->handle = NULL;
-        file++;
-    }
+    if (file->pData != NULL)
+        return file->dataSize;
+    if (file->pCache != NULL)
+        return file->pCache->fileSize;
+    return file->size(file->handle);
+}
 
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWReadAt
+ *
+ * Read through the file's readAt function, traced so that slow reads by
+ * the host show up in the render they delay
+ *
+ *----------------------------------------------------------------------------
+*/
+static int EAS_HWReadAt (EAS_HW_FILE *file, void *buf, int offset, int size)
+{
+    int count;
 
-    return EAS_SUCCESS;
+    EAS_HW_CHECK_NOT_REALTIME();
+    EAS_TRACE_BEGIN("EAS_HWReadAt");
+    count = file->readAt(file->handle, buf, offset, size);
+    EAS_TRACE_END();
+    return count;
 }
 
 /*----------------------------------------------------------------------------
- * EAS_HWShutdown
  *
- * Shut down host wrapper interface
+ * EAS_HWCacheBlocks
+ *
+ * Returns the number of cache blocks needed to hold the whole file
  *
  *----------------------------------------------------------------------------
 */
-EAS_RESULT EAS_HWShutdown (EAS_HW_DATA_HANDLE hwInstData)
+static int EAS_HWCacheBlocks (int fileSize)
 {
-
-    free(hwInstData);
-    return EAS_SUCCESS;
+    return (fileSize + EAS_FILE_CACHE_BLOCK_SIZE - 1) / EAS_FILE_CACHE_BLOCK_SIZE;
 }
 
 /*----------------------------------------------------------------------------
  *
- * EAS_HWMalloc
+ * EAS_HWCreateCache
  *
- * Allocates dynamic memory
+ * Create the read-ahead cache for a readAt file, leaves the file
+ * uncached if there is not enough memory
  *
  *----------------------------------------------------------------------------
 */
-/*lint -esym(715, hwInstData) hwInstData available for customer use */
-void *EAS_HWMalloc (EAS_HW_DATA_HANDLE hwInstData, EAS_I32 size)
+static void EAS_HWCreateCache (EAS_HW_DATA_HANDLE hwInstData, EAS_HW_FILE *file)
 {
-    /* Since this whole library loves signed sizes, let's not let
-     * negative or 0 values through */
-    if (size <= 0)
-      return NULL;
-    return malloc((size_t) size);
+    EAS_HW_FILE_CACHE *pCache;
+    int fileSize;
+
+    file->pCache = NULL;
+    file->pBlock = NULL;
+    if (EAS_FILE_CACHE_BLOCKS == 0)
+        return;
+
+    fileSize = file->size(file->handle);
+    if (fileSize <= 0)
+        return;
+
+    pCache = EAS_HWMalloc(hwInstData, sizeof(EAS_HW_FILE_CACHE));
+    if (pCache == NULL)
+        return;
+    memset(pCache, 0, sizeof(EAS_HW_FILE_CACHE));
+    pCache->fileSize = fileSize;
+    pCache->refCount = 1;
+    pCache->numBlocks = EAS_HWCacheBlocks(fileSize);
+    if (pCache->numBlocks > EAS_FILE_CACHE_BLOCKS)
+        pCache->numBlocks = EAS_FILE_CACHE_BLOCKS;
+    file->pCache = pCache;
 }
 
 /*----------------------------------------------------------------------------
  *
- * EAS_HWFree
+ * EAS_HWReleaseCache
  *
- * Frees dynamic memory
+ * Release a reference to the read-ahead cache of a file
  *
  *----------------------------------------------------------------------------
 */
-/*lint -esym(715, hwInstData) hwInstData available for customer use */
-void EAS_HWFree (EAS_HW_DATA_HANDLE hwInstData, void *p)
+static void EAS_HWReleaseCache (EAS_HW_DATA_HANDLE hwInstData, EAS_HW_FILE *file)
 {
-    free(p);
+    EAS_HW_FILE_CACHE *pCache = file->pCache;
+    int i;
+
+    file->pCache = NULL;
+    file->pBlock = NULL;
+    if ((pCache == NULL) || (--pCache->refCount > 0))
+        return;
+
+    for (i = 0; i < EAS_FILE_CACHE_MAX_BLOCKS; i++)
+        EAS_HWFree(hwInstData, pCache->blocks[i].pData);
+#ifdef _RT_SAFE_RENDER
+    EAS_HWFree(hwInstData, pCache->pPreload);
+#endif
+    EAS_HWFree(hwInstData, pCache);
 }
 
 /*----------------------------------------------------------------------------
  *
- * EAS_HWMemCpy
+ * EAS_HWCacheLookup
  *
- * Copy memory wrapper
+ * Returns the cache block holding the byte at position, reading it into
+ * the least recently used block if necessary. Returns NULL if the data
+ * could not be read.
  *
  *----------------------------------------------------------------------------
 */
-void *EAS_HWMemCpy (void *dest, const void *src, EAS_I32 amount)
+static EAS_HW_CACHE_BLOCK *EAS_HWCacheLookup (EAS_HW_DATA_HANDLE hwInstData, EAS_HW_FILE *file, int position)
 {
-    if (amount < 0)  {
-      EAS_ReportEx(_EAS_SEVERITY_NOFILTER, 0x1a54b6e8, 0x00000004 , amount);
-      exit(255);
+    EAS_HW_FILE_CACHE *pCache = file->pCache;
+    EAS_HW_CACHE_BLOCK *pBlock;
+    EAS_HW_CACHE_BLOCK *pVictim;
+    int start;
+    int count;
+    int i;
+
+    /* look for the block in the cache */
+    start = position - (position % EAS_FILE_CACHE_BLOCK_SIZE);
+    pVictim = NULL;
+    for (i = 0; i < pCache->numBlocks; i++)
+    {
+        pBlock = &pCache->blocks[i];
+        if ((pBlock->pData != NULL) && (pBlock->start == start) && (pBlock->count > position - start))
+        {
+            pBlock->lastUse = ++pCache->useCount;
+            return pBlock;
+        }
+
+        /* use an empty block, otherwise the least recently used one */
+        if ((pVictim == NULL) || (pVictim->pData != NULL && ((pBlock->pData == NULL) || (pBlock->lastUse < pVictim->lastUse))))
+            pVictim = pBlock;
     }
-    return memcpy(dest, src, (size_t) amount);
+
+    /* read the block */
+    if (pVictim->pData == NULL)
+    {
+        pVictim->pData = EAS_HWMalloc(hwInstData, EAS_FILE_CACHE_BLOCK_SIZE);
+        if (pVictim->pData == NULL)
+            return NULL;
+    }
+    count = pCache->fileSize - start;
+    if (count > EAS_FILE_CACHE_BLOCK_SIZE)
+        count = EAS_FILE_CACHE_BLOCK_SIZE;
+    count = EAS_HWReadAt(file, pVictim->pData, start, count);
+    if (count <= position - start)
+    {
+        pVictim->count = 0;
+        return NULL;
+    }
+    pVictim->start = start;
+    pVictim->count = count;
+    pVictim->lastUse = ++pCache->useCount;
+    return pVictim;
 }
 
 /*----------------------------------------------------------------------------
  *
- * EAS_HWMemSet
+ * EAS_HWCacheRead
  *
- * Set memory wrapper
+ * Read from a cached file, returns the number of bytes read
  *
  *----------------------------------------------------------------------------
 */
-void *EAS_HWMemSet (void *dest, int val, EAS_I32 amount)
+static int EAS_HWCacheRead (EAS_HW_DATA_HANDLE hwInstData, EAS_HW_FILE *file, EAS_U8 *pBuffer, int n)
 {
-    if (amount < 0)  {
-      EAS_ReportEx(_EAS_SEVERITY_NOFILTER, 0x1a54b6e8, 0x00000005 , amount);
-      exit(255);
+    EAS_HW_CACHE_BLOCK *pBlock;
+    int position;
+    int total;
+    int count;
+
+    /* large reads bypass the cache */
+    if (n >= EAS_FILE_CACHE_BLOCK_SIZE)
+    {
+        count = EAS_HWReadAt(file, pBuffer, file->filePos, n);
+        return (count > 0) ? count : 0;
     }
-    return memset(dest, val, (size_t) amount);
+
+    position = file->filePos;
+    for (total = 0; total < n; total += count)
+    {
+        pBlock = file->pBlock;
+        if ((pBlock == NULL) || (position < pBlock->start) || (position >= pBlock->start + pBlock->count))
+        {
+            if ((pBlock = EAS_HWCacheLookup(hwInstData, file, position)) == NULL)
+                break;
+            file->pBlock = pBlock;
+        }
+
+        count = pBlock->start + pBlock->count - position;
+        if (count > n - total)
+            count = n - total;
+        memcpy(pBuffer + total, pBlock->pData + (position - pBlock->start), (size_t) count);
+        position += count;
+    }
+    return total;
 }
 
 /*----------------------------------------------------------------------------
  *
- * EAS_HWMemCmp
+ * EAS_HWAllocFile
  *
- * Compare memory wrapper
+ * Take a free handle from the file table, growing it if necessary. The
+ * caller holds the instance lock.
  *
  *----------------------------------------------------------------------------
 */
-EAS_I32 EAS_HWMemCmp (const void *s1, const void *s2, EAS_I32 amount)
+static EAS_RESULT EAS_HWAllocFile (EAS_HW_DATA_HANDLE hwInstData, EAS_HW_FILE **pFile)
 {
-    if (amount < 0) {
-      EAS_ReportEx(_EAS_SEVERITY_NOFILTER, 0x1a54b6e8, 0x00000006 , amount);
-      exit(255);
+    EAS_HW_FILE_BLOCK *pBlock;
+    EAS_HW_FILE *file;
+    int count;
+
+    if (hwInstData->pFreeFiles == NULL)
+    {
+        /* too many open files */
+        count = EAS_MAX_FILE_HANDLES - hwInstData->numFiles;
+        if (count <= 0)
+            return EAS_ERROR_MAX_FILES_OPEN;
+        if (count > EAS_FILE_HANDLE_BLOCK)
+            count = EAS_FILE_HANDLE_BLOCK;
+
+        pBlock = EAS_HWMalloc(hwInstData, (EAS_I32) (sizeof(EAS_HW_FILE_BLOCK) + (size_t) count * sizeof(EAS_HW_FILE)));
+        if (pBlock == NULL)
+            return EAS_ERROR_MALLOC_FAILED;
+        memset(pBlock, 0, sizeof(EAS_HW_FILE_BLOCK) + (size_t) count * sizeof(EAS_HW_FILE));
+        pBlock->pNext = hwInstData->pFileBlocks;
+        hwInstData->pFileBlocks = pBlock;
+        EAS_HWAddFiles(hwInstData, pBlock->files, count);
     }
-    return (EAS_I32) memcmp(s1, s2, (size_t) amount);
+
+    file = hwInstData->pFreeFiles;
+    hwInstData->pFreeFiles = file->pNextFree;
+    file->pNextFree = NULL;
+    *pFile = file;
+    return EAS_SUCCESS;
 }
 
 /*----------------------------------------------------------------------------
@@ -236,8 +1422,9 @@ EAS_I32 EAS_HWMemCmp (const void *s1, const void *s2, EAS_I32 amount)
 EAS_RESULT EAS_HWOpenFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_LOCATOR locator, EAS_FILE_HANDLE *pFile, EAS_FILE_MODE mode)
 {
     EAS_HW_FILE *file;
-    int fd;
-    int i, temp;
+    EAS_RESULT result;
+
+    EAS_HW_CHECK_NOT_REALTIME();
 
     /* set return value to NULL */
     *pFile = NULL;
@@ -246,25 +1433,35 @@ EAS_RESULT EAS_HWOpenFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_LOCATOR locat
     if (mode != EAS_FILE_READ)
         return EAS_ERROR_INVALID_FILE_MODE;
 
-    /* find an empty entry in the file table */
-    file = hwInstData->files;
-    for (i = 0; i < EAS_MAX_FILE_HANDLES; i++)
+    /* take an empty entry in the file table */
+    EAS_HWLock(hwInstData);
+    if ((result = EAS_HWAllocFile(hwInstData, &file)) != EAS_SUCCESS)
     {
-        /* is this slot being used? */
-        if (file->handle == NULL)
-        {
-            file->handle = locator->handle;
-            file->readAt = locator->readAt;
-            file->size = locator->size;
-            file->filePos = 0;
-            *pFile = file;
-            return EAS_SUCCESS;
-        }
-        file++;
+        EAS_HWUnlock(hwInstData);
+        return result;
+    }
+    file->handle = locator->handle;
+    file->readAt = locator->readAt;
+    file->size = locator->size;
+    file->filePos = 0;
+
+    /* memory files are read directly */
+    file->pData = NULL;
+    file->dataSize = 0;
+    if (locator->readAt == EAS_HWMemReadAt)
+    {
+        file->pData = (const EAS_U8*) ((EAS_MEMORY_FILE*) locator->handle)->pData;
+        file->dataSize = (int) ((EAS_MEMORY_FILE*) locator->handle)->size;
+        file->pCache = NULL;
+        file->pBlock = NULL;
     }
 
-    /* too many open files */
-    return EAS_ERROR_MAX_FILES_OPEN;
+    /* other files are read through the read-ahead cache */
+    else
+        EAS_HWCreateCache(hwInstData, file);
+    EAS_HWUnlock(hwInstData);
+    *pFile = file;
+    return EAS_SUCCESS;
 }
 
 
@@ -289,7 +1486,7 @@ EAS_RESULT EAS_HWReadFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file,
       return EAS_EOF;
 
     /* calculate the bytes to read */
-    count = file->size(file->handle) - file->filePos;
+    count = EAS_HWFileSize(file) - file->filePos;
     if (n < count)
         count = n;
     if (count < 0)
@@ -297,7 +1494,12 @@ EAS_RESULT EAS_HWReadFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file,
 
     /* copy the data to the requested location, and advance the pointer */
     if (count) {
-        count = file->readAt(file->handle, pBuffer, file->filePos, count);
+        if (file->pData != NULL)
+            memcpy(pBuffer, file->pData + file->filePos, (size_t) count);
+        else if (file->pCache != NULL)
+            count = EAS_HWCacheRead(hwInstData, file, pBuffer, count);
+        else
+            count = EAS_HWReadAt(file, pBuffer, file->filePos, count);
     }
     file->filePos += count;
     *pBytesRead = count;
@@ -319,7 +1521,23 @@ EAS_RESULT EAS_HWReadFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file,
 /*lint -esym(715, hwInstData) hwInstData available for customer use */
 EAS_RESULT EAS_HWGetByte (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, void *p)
 {
+    EAS_HW_CACHE_BLOCK *pBlock;
     EAS_I32 numread;
+
+    /* memory files are read in place */
+    if ((file->pData != NULL) && (file->filePos >= 0) && (file->filePos < file->dataSize))
+    {
+        *((EAS_U8*) p) = file->pData[file->filePos++];
+        return EAS_SUCCESS;
+    }
+
+    /* so are bytes in this handle's current cache block */
+    pBlock = file->pBlock;
+    if ((pBlock != NULL) && (file->filePos >= pBlock->start) && (file->filePos < pBlock->start + pBlock->count))
+    {
+        *((EAS_U8*) p) = pBlock->pData[file->filePos++ - pBlock->start];
+        return EAS_SUCCESS;
+    }
     return EAS_HWReadFile(hwInstData, file, p, 1, &numread);
 }
 
@@ -337,11 +1555,22 @@ EAS_RESULT EAS_HWGetWord (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, v
     EAS_RESULT result;
     EAS_U8 c1, c2;
 
+    /* memory files are read in place */
+    if ((file->pData != NULL) && (file->filePos >= 0) && (file->filePos <= file->dataSize - 2))
+    {
+        c1 = file->pData[file->filePos];
+        c2 = file->pData[file->filePos + 1];
+        file->filePos += 2;
+    }
+
     /* read 2 bytes from the file */
-    if ((result = EAS_HWGetByte(hwInstData, file, &c1)) != EAS_SUCCESS)
-        return result;
-    if ((result = EAS_HWGetByte(hwInstData, file, &c2)) != EAS_SUCCESS)
-        return result;
+    else
+    {
+        if ((result = EAS_HWGetByte(hwInstData, file, &c1)) != EAS_SUCCESS)
+            return result;
+        if ((result = EAS_HWGetByte(hwInstData, file, &c2)) != EAS_SUCCESS)
+            return result;
+    }
 
     /* order them as requested */
     if (msbFirst)
@@ -366,15 +1595,28 @@ EAS_RESULT EAS_HWGetDWord (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file,
     EAS_RESULT result;
     EAS_U8 c1, c2,c3,c4;
 
+    /* memory files are read in place */
+    if ((file->pData != NULL) && (file->filePos >= 0) && (file->filePos <= file->dataSize - 4))
+    {
+        c1 = file->pData[file->filePos];
+        c2 = file->pData[file->filePos + 1];
+        c3 = file->pData[file->filePos + 2];
+        c4 = file->pData[file->filePos + 3];
+        file->filePos += 4;
+    }
+
     /* read 4 bytes from the file */
-    if ((result = EAS_HWGetByte(hwInstData, file, &c1)) != EAS_SUCCESS)
-        return result;
-    if ((result = EAS_HWGetByte(hwInstData, file, &c2)) != EAS_SUCCESS)
-        return result;
-    if ((result = EAS_HWGetByte(hwInstData, file, &c3)) != EAS_SUCCESS)
-        return result;
-    if ((result = EAS_HWGetByte(hwInstData, file, &c4)) != EAS_SUCCESS)
-        return result;
+    else
+    {
+        if ((result = EAS_HWGetByte(hwInstData, file, &c1)) != EAS_SUCCESS)
+            return result;
+        if ((result = EAS_HWGetByte(hwInstData, file, &c2)) != EAS_SUCCESS)
+            return result;
+        if ((result = EAS_HWGetByte(hwInstData, file, &c3)) != EAS_SUCCESS)
+            return result;
+        if ((result = EAS_HWGetByte(hwInstData, file, &c4)) != EAS_SUCCESS)
+            return result;
+    }
 
     /* order them as requested */
     if (msbFirst)
@@ -422,7 +1664,7 @@ EAS_RESULT EAS_HWFileSeek (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file,
         return EAS_ERROR_INVALID_HANDLE;
 
     /* validate new position */
-    if ((position < 0) || (position > file->size(file->handle)))
+    if ((position < 0) || (position > EAS_HWFileSize(file)))
         return EAS_ERROR_FILE_SEEK;
 
     /* save new position */
@@ -448,7 +1690,7 @@ EAS_RESULT EAS_HWFileSeekOfs (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fil
 
     /* determine the file position */
     position += file->filePos;
-    if ((position < 0) || (position > file->size(file->handle)))
+    if ((position < 0) || (position > EAS_HWFileSize(file)))
         return EAS_ERROR_FILE_SEEK;
 
     /* save new position */
@@ -457,6 +1699,26 @@ EAS_RESULT EAS_HWFileSeekOfs (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fil
 }
 
 
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWFileLength
+ *
+ * Return the file length
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, hwInstData) hwInstData available for customer use */
+EAS_RESULT EAS_HWFileLength (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, EAS_I32 *pLength)
+{
+
+    /* make sure we have a valid handle */
+    if (file->handle == NULL)
+        return EAS_ERROR_INVALID_HANDLE;
+
+    *pLength = EAS_HWFileSize(file);
+    return EAS_SUCCESS;
+}
+
 /*----------------------------------------------------------------------------
  *
  * EAS_HWDupHandle
@@ -468,33 +1730,44 @@ EAS_RESULT EAS_HWFileSeekOfs (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fil
 EAS_RESULT EAS_HWDupHandle (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, EAS_FILE_HANDLE *pDupFile)
 {
     EAS_HW_FILE *dupFile;
-    int i;
+    EAS_RESULT result;
+
+    EAS_HW_CHECK_NOT_REALTIME();
 
     /* make sure we have a valid handle */
     if (file->handle == NULL)
         return EAS_ERROR_INVALID_HANDLE;
 
-    /* find an empty entry in the file table */
-    dupFile = hwInstData->files;
-    for (i = 0; i < EAS_MAX_FILE_HANDLES; i++)
+    /* take an empty entry in the file table */
+    EAS_HWLock(hwInstData);
+    if ((result = EAS_HWAllocFile(hwInstData, &dupFile)) != EAS_SUCCESS)
     {
-        /* is this slot being used? */
-        if (dupFile->handle == NULL)
-        {
-            /* copy info from the handle to be duplicated */
-            dupFile->handle = file->handle;
-            dupFile->filePos = file->filePos;
-            dupFile->readAt = file->readAt;
-            dupFile->size = file->size;
-
-            *pDupFile = dupFile;
-            return EAS_SUCCESS;
-        }
-        dupFile++;
+        EAS_HWUnlock(hwInstData);
+        return result;
+    }
+
+    /* copy info from the handle to be duplicated */
+    dupFile->handle = file->handle;
+    dupFile->filePos = file->filePos;
+    dupFile->readAt = file->readAt;
+    dupFile->size = file->size;
+    dupFile->pData = file->pData;
+    dupFile->dataSize = file->dataSize;
+
+    /* share the cache, with one more block for the new handle */
+    dupFile->pCache = file->pCache;
+    dupFile->pBlock = file->pBlock;
+    if (file->pCache != NULL)
+    {
+        file->pCache->refCount++;
+        if ((file->pCache->numBlocks < EAS_FILE_CACHE_MAX_BLOCKS) &&
+            (file->pCache->numBlocks < EAS_HWCacheBlocks(file->pCache->fileSize)))
+            file->pCache->numBlocks++;
     }
 
-    /* too many open files */
-    return EAS_ERROR_MAX_FILES_OPEN;
+    EAS_HWUnlock(hwInstData);
+    *pDupFile = dupFile;
+    return EAS_SUCCESS;
 }
 
 /*----------------------------------------------------------------------------
@@ -510,15 +1783,220 @@ EAS_RESULT EAS_HWCloseFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file1
     EAS_HW_FILE *file2,*dupFile;
     int i;
 
+    EAS_HW_CHECK_NOT_REALTIME();
 
     /* make sure we have a valid handle */
     if (file1->handle == NULL)
         return EAS_ERROR_INVALID_HANDLE;
 
+    /* return the entry to the free list */
+    EAS_HWLock(hwInstData);
+    EAS_HWReleaseCache(hwInstData, file1);
     file1->handle = NULL;
+    file1->pNextFree = hwInstData->pFreeFiles;
+    hwInstData->pFreeFiles = file1;
+    EAS_HWUnlock(hwInstData);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWMapFile
+ *
+ * Returns a read-only view of the whole file. Memory files, which is how
+ * the host passes content it has memory mapped, are used in place and
+ * must stay valid until the view is unmapped. Other files are read into
+ * an allocated copy. The view stays valid after the file is closed.
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_HWMapFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, const void **ppData, EAS_I32 *pSize, EAS_VOID_PTR *pMapping)
+{
+    EAS_U8 *pCopy;
+    int size;
+    int count;
+    int offset;
+
+    *ppData = NULL;
+    *pSize = 0;
+    *pMapping = NULL;
+
+    /* make sure we have a valid handle */
+    if (file->handle == NULL)
+        return EAS_ERROR_INVALID_HANDLE;
+
+    /* memory files need no copy */
+    if (file->pData != NULL)
+    {
+        *ppData = file->pData;
+        *pSize = file->dataSize;
+        return EAS_SUCCESS;
+    }
+
+    /* read anything else into memory */
+    size = EAS_HWFileSize(file);
+    if (size <= 0)
+        return EAS_ERROR_FILE_READ_FAILED;
+    if ((pCopy = EAS_HWMalloc(hwInstData, size)) == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    for (offset = 0; offset < size; offset += count)
+    {
+        count = EAS_HWReadAt(file, pCopy + offset, offset, size - offset);
+        if (count <= 0)
+        {
+            EAS_HWFree(hwInstData, pCopy);
+            return EAS_ERROR_FILE_READ_FAILED;
+        }
+    }
+
+    *ppData = pCopy;
+    *pSize = size;
+    *pMapping = pCopy;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWUnmapFile
+ *
+ * Releases a view returned by EAS_HWMapFile
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_HWUnmapFile (EAS_HW_DATA_HANDLE hwInstData, EAS_VOID_PTR mapping)
+{
+    EAS_HWFree(hwInstData, mapping);
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWFileData
+ *
+ * Returns the contents of a memory file, which stay valid while the host
+ * keeps the file open. Returns NULL for other files instead of reading
+ * them, so the caller can fall back to reading what it needs.
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, hwInstData) hwInstData available for customer use */
+EAS_RESULT EAS_HWFileData (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file, const void **ppData, EAS_I32 *pSize)
+{
+    *ppData = NULL;
+    *pSize = 0;
+
+    /* make sure we have a valid handle */
+    if (file->handle == NULL)
+        return EAS_ERROR_INVALID_HANDLE;
+
+    if (file->pData != NULL)
+    {
+        *ppData = file->pData;
+        *pSize = file->dataSize;
+    }
+    return EAS_SUCCESS;
+}
+
+#ifdef _RT_SAFE_RENDER
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWPreloadFile
+ *
+ * Reads a readAt file into memory, after which it and the handles later
+ * duplicated from it are read like memory files. The copy belongs to the
+ * read-ahead cache, so it is freed when the last of the handles is closed.
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_HWPreloadFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file)
+{
+    EAS_HW_FILE_CACHE *pCache;
+    EAS_U8 *pCopy;
+    int size;
+    int count;
+    int offset;
+
+    /* make sure we have a valid handle */
+    if (file->handle == NULL)
+        return EAS_ERROR_INVALID_HANDLE;
+
+    /* memory files are already in memory */
+    if (file->pData != NULL)
+        return EAS_SUCCESS;
+
+    size = EAS_HWFileSize(file);
+    if (size <= 0)
+        return EAS_ERROR_FILE_READ_FAILED;
+    if ((pCopy = EAS_HWMalloc(hwInstData, size)) == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    for (offset = 0; offset < size; offset += count)
+    {
+        count = EAS_HWReadAt(file, pCopy + offset, offset, size - offset);
+        if (count <= 0)
+        {
+            EAS_HWFree(hwInstData, pCopy);
+            return EAS_ERROR_FILE_READ_FAILED;
+        }
+    }
+
+    /* an uncached file gets a cache to own the copy */
+    EAS_HWLock(hwInstData);
+    if ((pCache = file->pCache) == NULL)
+    {
+        if ((pCache = EAS_HWMalloc(hwInstData, sizeof(EAS_HW_FILE_CACHE))) == NULL)
+        {
+            EAS_HWUnlock(hwInstData);
+            EAS_HWFree(hwInstData, pCopy);
+            return EAS_ERROR_MALLOC_FAILED;
+        }
+        memset(pCache, 0, sizeof(EAS_HW_FILE_CACHE));
+        pCache->fileSize = size;
+        pCache->refCount = 1;
+        file->pCache = pCache;
+        file->pBlock = NULL;
+    }
+    EAS_HWFree(hwInstData, pCache->pPreload);
+    pCache->pPreload = pCopy;
+    file->pData = pCopy;
+    file->dataSize = size;
+    EAS_HWUnlock(hwInstData);
     return EAS_SUCCESS;
 }
 
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWBeginRealtime
+ *
+ * Marks the calling thread as running a realtime render. With
+ * _RT_SAFE_CHECKS, allocating, freeing, opening or reading a file until
+ * EAS_HWEndRealtime asserts.
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, hwInstData) hwInstData available for customer use */
+void EAS_HWBeginRealtime (EAS_HW_DATA_HANDLE hwInstData)
+{
+#ifdef _RT_SAFE_CHECKS
+    EAS_realtimeDepth++;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWEndRealtime
+ *
+ * Ends the realtime render started by EAS_HWBeginRealtime
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, hwInstData) hwInstData available for customer use */
+void EAS_HWEndRealtime (EAS_HW_DATA_HANDLE hwInstData)
+{
+#ifdef _RT_SAFE_CHECKS
+    EAS_realtimeDepth--;
+#endif
+}
+#endif
+
 /*----------------------------------------------------------------------------
  *
  * EAS_HWVibrate
@@ -0,0 +1,49 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_trace.h
+ *
+ * Contents and purpose:
+ * Trace points for the phases of a render, so that a missed audio deadline
+ * can be attributed to parsing, synthesis, effects, JET or file reads in
+ * a system trace. With _TRACE_ENABLED the macros emit atrace sections and
+ * counters under the audio tag, which cost one test of the enabled tags
+ * while tracing is off. Without it they compile to nothing. A host without
+ * atrace can map the macros to its own tracer here.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_TRACE_H
+#define _EAS_TRACE_H
+
+#ifdef _TRACE_ENABLED
+#include <cutils/trace.h>
+
+/* a section must end on the thread that began it, before any section begun inside it */
+#define EAS_TRACE_BEGIN(name)           atrace_begin(ATRACE_TAG_AUDIO, name)
+#define EAS_TRACE_END()                 atrace_end(ATRACE_TAG_AUDIO)
+
+/* a counter track holds the last value written to it */
+#define EAS_TRACE_COUNTER(name, value)  atrace_int(ATRACE_TAG_AUDIO, name, (int32_t) (value))
+#else
+#define EAS_TRACE_BEGIN(name)           ((void) 0)
+#define EAS_TRACE_END()                 ((void) 0)
+#define EAS_TRACE_COUNTER(name, value)  ((void) 0)
+#endif
+
+#endif /* end _EAS_TRACE_H */
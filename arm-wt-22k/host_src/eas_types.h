@@ -77,6 +77,8 @@ typedef long EAS_RESULT;
 #define EAS_ERROR_QUEUE_IS_EMPTY            -37
 #define EAS_ERROR_FEATURE_ALREADY_ACTIVE    -38
 #define EAS_ERROR_DATA_INCONSISTENCY        -39
+#define EAS_ERROR_PARSE_LIMIT               -40
+#define EAS_ERROR_DATA_UNDERRUN             -41
 
 /* special return codes */
 #define EAS_EOF                             3
@@ -145,6 +147,19 @@ typedef struct s_eas_file_tag {
     int(*size)(void *handle);
 } EAS_FILE, *EAS_FILE_LOCATOR;
 
+/* content already in memory, see EAS_InitMemoryLocator */
+typedef struct s_eas_memory_file_tag {
+    const void *pData;
+    EAS_I32 size;
+} EAS_MEMORY_FILE;
+
+/* memory allocator for a library instance, see EAS_InitEx */
+typedef struct s_eas_allocator_tag {
+    void *(*pfMalloc)(void *pContext, EAS_I32 size);
+    void (*pfFree)(void *pContext, void *p);
+    void *pContext;
+} EAS_ALLOCATOR;
+
 /* handle to stream */
 typedef struct s_eas_stream_tag *EAS_HANDLE;
 
@@ -157,6 +172,15 @@ typedef struct s_eas_data_tag *EAS_DATA_HANDLE;
 /* handle to persistent data for host wrapper interface */
 typedef struct eas_hw_inst_data_tag *EAS_HW_DATA_HANDLE;
 
+/* handle to a pool of host worker threads */
+typedef struct eas_hw_workers_tag *EAS_HW_WORKERS_HANDLE;
+
+/* handle to a host thread */
+typedef struct eas_hw_thread_tag *EAS_HW_THREAD_HANDLE;
+
+/* handle to a batch renderer, see EAS_CreateBatch */
+typedef struct s_eas_batch_tag *EAS_BATCH_HANDLE;
+
 /* handle to sound library */
 typedef struct s_eas_sndlib_tag *EAS_SNDLIB_HANDLE;
 typedef struct s_eas_dls_tag *EAS_DLSLIB_HANDLE;
@@ -178,6 +202,28 @@ typedef void *EAS_VOID_PTR;
 #endif
 #endif
 
+/* sample storage is aligned to the data cache line */
+#ifndef EAS_CACHE_LINE_SIZE
+#define EAS_CACHE_LINE_SIZE 64
+#endif
+
+#ifndef EAS_CACHE_ALIGNED
+#if defined (__GNUC__)
+#define EAS_CACHE_ALIGNED __attribute__((aligned(EAS_CACHE_LINE_SIZE)))
+#else
+#define EAS_CACHE_ALIGNED
+#endif
+#endif
+
+/* hint that data is read soon, it does nothing without compiler support */
+#ifndef EAS_PREFETCH
+#if defined (__GNUC__)
+#define EAS_PREFETCH(p) __builtin_prefetch((p), 0, 3)
+#else
+#define EAS_PREFETCH(p)
+#endif
+#endif
+
 /* define NULL value */
 #ifndef NULL
 #define NULL 0
@@ -197,6 +243,25 @@ typedef enum
 /* metadata callback function */
 typedef void (*EAS_METADATA_CBFUNC) (E_EAS_METADATA_TYPE metaDataType, char *metaDataBuf, EAS_VOID_PTR pUserData);
 
+/* callback function for EAS_RenderFile, numSamples is the number of samples per channel */
+typedef EAS_RESULT (*EAS_RENDER_WRITE_FUNC) (EAS_VOID_PTR pUserData, const EAS_PCM *pBuffer, EAS_I32 numSamples);
+
+/* callback function for EAS_OpenFileAsync, called on the background thread */
+typedef void (*EAS_OPEN_CALLBACK) (EAS_VOID_PTR pUserData, EAS_HANDLE streamHandle, EAS_RESULT result);
+
+/*
+ * effect interface for EAS_AddInsert, the effect processes the 32-bit mix
+ * in place, numSamples is the number of samples per channel
+ */
+typedef struct
+{
+    EAS_RESULT  (*pfInit)(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData);
+    void        (*pfProcess)(EAS_VOID_PTR pInstData, EAS_I32 *in, EAS_I32 *out, EAS_I32 numSamples);
+    EAS_RESULT  (*pfShutdown)(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
+    EAS_RESULT  (*pFGetParam)(EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue);
+    EAS_RESULT  (*pFSetParam)(EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value);
+} S_EFFECTS32_INTERFACE;
+
 /* file types for metadata return codes */
 typedef enum
 {
@@ -44,6 +44,9 @@ typedef struct s_jet_config_tag
 {
     EAS_U8      appEventRangeLow;
     EAS_U8      appEventRangeHigh;
+    EAS_U16     appEventQueueSize;      /* power of 2, 0 for the default */
+    EAS_U8      segmentQueueDepth;      /* 0 for the default */
+    EAS_U8      maxLibraries;           /* DLS collections in a file, 0 for the default */
 } S_JET_CONFIG;
 
 typedef struct s_jet_status_tag
@@ -66,6 +69,9 @@ typedef struct s_jet_event_tag
     EAS_U8      value;
 } S_JET_EVENT;
 
+/* application event callback, see JET_SetEventCallback */
+typedef void (*JET_EVENT_CALLBACK) (EAS_VOID_PTR pUserData, EAS_U32 eventRaw, const S_JET_EVENT *pEvent, EAS_U32 sampleTime);
+
 /*----------------------------------------------------------------------------
  * JET_Init()
  *----------------------------------------------------------------------------
@@ -74,6 +80,14 @@ typedef struct s_jet_event_tag
  * to use defaults. If passing config data, configSize should be
  * sizeof(S_JET_CONFIG). This allows for future expansion of the
  * config structure while maintaining compatibility.
+ *
+ * With _JET_EVENT_RING, appEventQueueSize sets the number of application
+ * events that can wait for JET_GetEvent, a power of 2 up to 4096.
+ * Otherwise it must be 0.
+ *
+ * With _JET_DYNAMIC_QUEUE, segmentQueueDepth sets the number of segments
+ * that can be queued, 2 to 64, and maxLibraries the number of DLS
+ * collections a file can hold, up to 64. Otherwise they must be 0.
  *----------------------------------------------------------------------------
 */
 EAS_PUBLIC EAS_RESULT JET_Init (EAS_DATA_HANDLE easHandle, const S_JET_CONFIG *pConfig, EAS_INT configSize);
@@ -126,6 +140,38 @@ EAS_PUBLIC EAS_RESULT JET_Status (EAS_DATA_HANDLE easHandle, S_JET_STATUS *pStat
 */
 EAS_PUBLIC EAS_BOOL JET_GetEvent (EAS_DATA_HANDLE easHandle, EAS_U32 *pEventRaw, S_JET_EVENT *pEvent);
 
+/*----------------------------------------------------------------------------
+ * JET_GetTimedEvent()
+ *----------------------------------------------------------------------------
+ * Checks for application events, like JET_GetEvent, and also returns the
+ * sample the event falls on, on the EAS_GetSampleTime clock. With
+ * _JET_EVENT_RING this may be called from any one thread while another
+ * thread renders. Without it the sample time is always 0.
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_BOOL JET_GetTimedEvent (EAS_DATA_HANDLE easHandle, EAS_U32 *pEventRaw, S_JET_EVENT *pEvent, EAS_U32 *pSampleTime);
+
+/*----------------------------------------------------------------------------
+ * JET_GetEventOverflows()
+ *----------------------------------------------------------------------------
+ * Returns the number of application events dropped because the queue was
+ * full since JET_Init
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_GetEventOverflows (EAS_DATA_HANDLE easHandle, EAS_U32 *pCount);
+
+/*----------------------------------------------------------------------------
+ * JET_SetEventCallback()
+ *----------------------------------------------------------------------------
+ * Delivers application events to a callback on the render thread at the
+ * end of the frame they fall in, instead of queueing them for
+ * JET_GetEvent. Pass NULL to go back to polling. Call it from the render
+ * thread or while not rendering. Returns EAS_ERROR_FEATURE_NOT_AVAILABLE
+ * without _JET_EVENT_RING.
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_SetEventCallback (EAS_DATA_HANDLE easHandle, JET_EVENT_CALLBACK pCallback, EAS_VOID_PTR pUserData);
+
 /*----------------------------------------------------------------------------
  * JET_ParseEvent()
  *----------------------------------------------------------------------------
@@ -137,11 +183,39 @@ EAS_PUBLIC void JET_ParseEvent (EAS_U32 event, S_JET_EVENT *pEvent);
 /*----------------------------------------------------------------------------
  * JET_QueueSegment()
  *----------------------------------------------------------------------------
- * Queue a segment for playback
+ * Queue a segment for playback. With _JET_PREFETCH the segment is also
+ * prepared here, so starting it does not load it on the render thread.
  *----------------------------------------------------------------------------
 */
 EAS_PUBLIC EAS_RESULT JET_QueueSegment (EAS_DATA_HANDLE easHandle, EAS_INT segmentNum, EAS_INT libNum, EAS_INT repeatCount, EAS_INT transpose, EAS_U32 muteFlags, EAS_U8 userID);
 
+/*----------------------------------------------------------------------------
+ * JET_QueueSegmentAsync()
+ *----------------------------------------------------------------------------
+ * Queue a segment for playback from a thread other than the render
+ * thread, while it renders. The segment joins the queue in a later frame,
+ * one per frame, as soon as there is room, so more segments than the
+ * queue depth can wait. Calls must come from a single thread. Returns
+ * EAS_ERROR_QUEUE_IS_FULL if segmentQueueDepth segments are already
+ * waiting, and EAS_ERROR_FEATURE_NOT_AVAILABLE without _JET_DYNAMIC_QUEUE.
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_QueueSegmentAsync (EAS_DATA_HANDLE easHandle, EAS_INT segmentNum, EAS_INT libNum, EAS_INT repeatCount, EAS_INT transpose, EAS_U32 muteFlags, EAS_U8 userID);
+
+/*----------------------------------------------------------------------------
+ * JET_Service()
+ *----------------------------------------------------------------------------
+ * In realtime mode (see EAS_SetRealtimeRender) EAS_Render does not open,
+ * prepare or close segments. Call this from a thread that may block, like
+ * the other JET calls between renders, often enough that the segment after
+ * the playing one is prepared before it is due; a segment that is not yet
+ * prepared when the one before it ends starts late. Also joins the
+ * segments queued by JET_QueueSegmentAsync. Returns
+ * EAS_ERROR_FEATURE_NOT_AVAILABLE without _JET_DYNAMIC_QUEUE.
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_Service (EAS_DATA_HANDLE easHandle);
+
 /*----------------------------------------------------------------------------
  * JET_Play()
  *----------------------------------------------------------------------------
@@ -182,6 +256,37 @@ EAS_PUBLIC EAS_RESULT JET_SetMuteFlag (EAS_DATA_HANDLE easHandle, EAS_INT trackN
 */
 EAS_PUBLIC EAS_RESULT JET_TriggerClip (EAS_DATA_HANDLE easHandle, EAS_INT clipID);
 
+/*----------------------------------------------------------------------------
+ * JET_SetMuteFlagsAt()
+ *----------------------------------------------------------------------------
+ * Change the state of the mute flags of the playing segment at a sample
+ * time, see EAS_GetSampleTime. Notes the segment starts before that sample
+ * are not affected, those at or after it are, even within a frame. A time
+ * that has passed takes effect at the start of the next frame. Returns
+ * EAS_ERROR_QUEUE_IS_FULL if 16 changes and triggers are already waiting,
+ * and EAS_ERROR_FEATURE_NOT_AVAILABLE without _JET_TIMED_COMMANDS.
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_SetMuteFlagsAt (EAS_DATA_HANDLE easHandle, EAS_U32 muteFlags, EAS_U32 sampleTime);
+
+/*----------------------------------------------------------------------------
+ * JET_SetMuteFlagAt()
+ *----------------------------------------------------------------------------
+ * Change the state of a single mute flag at a sample time, as
+ * JET_SetMuteFlagsAt does
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_SetMuteFlagAt (EAS_DATA_HANDLE easHandle, EAS_INT trackNum, EAS_BOOL muteFlag, EAS_U32 sampleTime);
+
+/*----------------------------------------------------------------------------
+ * JET_TriggerClipAt()
+ *----------------------------------------------------------------------------
+ * Trigger a clip at a sample time, as JET_SetMuteFlagsAt does. The clip
+ * starts at the first clip start event at or after that sample.
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_TriggerClipAt (EAS_DATA_HANDLE easHandle, EAS_INT clipID, EAS_U32 sampleTime);
+
 /*----------------------------------------------------------------------------
  * JET_Clear_Queue()
  *----------------------------------------------------------------------------
@@ -23,6 +23,8 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "eas.h"
 #include "eas_report.h"
@@ -105,6 +107,9 @@ typedef void (*EAS_LOG_FUNC)(EAS_INT severity, char *msg);
 static EAS_LOG_FUNC logCallback = NULL;
 static char messageBuffer[MAX_DEBUG_MSG_LEN];
 
+/* messageBuffer is shared by the engines of a bounce */
+static pthread_mutex_t messageMutex = PTHREAD_MUTEX_INITIALIZER;
+
 /* error counts */
 static EAS_INT eas_fatalErrors;
 static EAS_INT eas_errors;
@@ -206,6 +211,7 @@ void EAS_ReportEx (int severity, unsigned long hashCode, int serialNum, ...)
         if ((debugMessages[i].m_nHashCode == hashCode) &&
         (debugMessages[i].m_nSerialNum == serialNum))
         {
+            pthread_mutex_lock(&messageMutex);
             va_start(vargs, serialNum);
 #ifdef WIN32
             vsprintf_s(messageBuffer, sizeof(messageBuffer), fmt, vargs);
@@ -214,6 +220,7 @@ void EAS_ReportEx (int severity, unsigned long hashCode, int serialNum, ...)
 #endif
             logCallback(severity, messageBuffer);
             va_end(vargs);
+            pthread_mutex_unlock(&messageMutex);
             return;
         }
     }
@@ -255,6 +262,7 @@ void EAS_Report (int severity, const char *fmt, ...)
     if (logCallback == NULL)
         return;
 
+    pthread_mutex_lock(&messageMutex);
     va_start(vargs, fmt);
 #ifdef _WIN32
     vsprintf_s(messageBuffer, sizeof(messageBuffer), fmt, vargs);
@@ -263,6 +271,7 @@ void EAS_Report (int severity, const char *fmt, ...)
 #endif
     logCallback(severity, messageBuffer);
     va_end(vargs);
+    pthread_mutex_unlock(&messageMutex);
 } /* end EAS_Report */
 
 /*----------------------------------------------------------------------------
@@ -299,6 +308,7 @@ void EAS_ReportX (int severity, const char *fmt, ...)
     if (logCallback == NULL)
         return;
 
+    pthread_mutex_lock(&messageMutex);
     va_start(vargs, fmt);
 #ifdef _WIN32
     vsprintf_s(messageBuffer, sizeof(messageBuffer), fmt, vargs);
@@ -307,6 +317,7 @@ void EAS_ReportX (int severity, const char *fmt, ...)
 #endif
     logCallback(severity, messageBuffer);
     va_end(vargs);
+    pthread_mutex_unlock(&messageMutex);
 }
 #endif
 
@@ -625,6 +636,258 @@ EAS_EXPORT EAS_RESULT CloseWaveOutDevice()
     return EAS_SUCCESS;
 }
 
+#ifdef JET_INTERFACE
+/*----------------------------------------------------------------------------
+ * Offline bounce
+ *
+ * Renders JET segments to WAV files as fast as the synth can go, without
+ * the output device. Each segment gets an engine of its own and the
+ * segments are shared out between one thread per core.
+ *----------------------------------------------------------------------------
+*/
+
+/* audio rendered after a segment ends, for the release and reverb tails */
+#define BOUNCE_TAIL_MSEC        1000
+
+/* longest bounce of one segment, in case it never ends */
+#define BOUNCE_MAX_MSEC         (30 * 60 * 1000)
+
+#define MAX_BOUNCE_THREADS      32
+
+/* one segment to bounce, see JET_BounceSegments */
+typedef struct
+{
+    EAS_INT         segmentNum;
+    EAS_INT         libNum;             /* DLS library, -1 for the segment's own */
+    EAS_INT         repeatCount;        /* must not be -1, a bounce has to end */
+    EAS_INT         transpose;
+    EAS_U32         muteFlags;          /* 0 plays every track, clips included */
+    const char      *outFile;           /* WAV file written */
+    EAS_I32         numSamples;         /* returns the sample frames written */
+    EAS_RESULT      result;             /* returns the result of the bounce */
+} S_JET_BOUNCE_SEGMENT;
+
+typedef struct
+{
+    const char              *jetFile;
+    S_JET_BOUNCE_SEGMENT    *pSegments;
+    EAS_INT                 numSegments;
+    EAS_INT                 nextSegment;
+    pthread_mutex_t         lock;
+} S_JET_BOUNCE;
+
+/*----------------------------------------------------------------------------
+ * PutLE()
+ *----------------------------------------------------------------------------
+ * Stores a little endian value of numBytes bytes
+*/
+static void PutLE (EAS_U8 *p, EAS_U32 value, int numBytes)
+{
+    while (numBytes--)
+    {
+        *p++ = (EAS_U8) value;
+        value >>= 8;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * WriteWaveHeader()
+ *----------------------------------------------------------------------------
+ * Writes the header of a 16-bit PCM WAV file of numSamples sample frames
+*/
+static EAS_BOOL WriteWaveHeader (FILE *pFile, const S_EAS_LIB_CONFIG *pLibConfig, EAS_I32 numSamples)
+{
+    EAS_U32 blockAlign = (EAS_U32) pLibConfig->numChannels * sizeof(EAS_PCM);
+    EAS_U32 dataSize = (EAS_U32) numSamples * blockAlign;
+    EAS_U8 header[44];
+
+    memcpy(&header[0], "RIFF", 4);
+    PutLE(&header[4], 36 + dataSize, 4);
+    memcpy(&header[8], "WAVEfmt ", 8);
+    PutLE(&header[16], 16, 4);
+    PutLE(&header[20], 1, 2);                                   /* PCM */
+    PutLE(&header[22], (EAS_U32) pLibConfig->numChannels, 2);
+    PutLE(&header[24], (EAS_U32) pLibConfig->sampleRate, 4);
+    PutLE(&header[28], (EAS_U32) pLibConfig->sampleRate * blockAlign, 4);
+    PutLE(&header[32], blockAlign, 2);
+    PutLE(&header[34], 16, 2);
+    memcpy(&header[36], "data", 4);
+    PutLE(&header[40], dataSize, 4);
+
+    if (fseek(pFile, 0L, SEEK_SET) != 0)
+        return EAS_FALSE;
+    return (fwrite(header, sizeof(header), 1, pFile) == 1) ? EAS_TRUE : EAS_FALSE;
+}
+
+/*----------------------------------------------------------------------------
+ * BounceSegment()
+ *----------------------------------------------------------------------------
+ * Renders one segment with an engine of its own
+*/
+static EAS_RESULT BounceSegment (const char *jetFile, S_JET_BOUNCE_SEGMENT *pSeg)
+{
+    const S_EAS_LIB_CONFIG *pLibConfig = EAS_Config();
+    EAS_DATA_HANDLE easHandle = NULL;
+    EAS_PCM *pAudioBuffer = NULL;
+    FILE *pFile = NULL;
+    S_JET_STATUS status;
+    EAS_RESULT result;
+    EAS_I32 count;
+    EAS_I32 tailSamples;
+    EAS_I32 maxSamples;
+    EAS_BOOL jetOpen = EAS_FALSE;
+
+    pSeg->numSamples = 0;
+    if (pSeg->repeatCount < 0)
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    tailSamples = (EAS_I32) (((long long) pLibConfig->sampleRate * BOUNCE_TAIL_MSEC) / 1000);
+    maxSamples = (EAS_I32) (((long long) pLibConfig->sampleRate * BOUNCE_MAX_MSEC) / 1000);
+
+    pAudioBuffer = malloc((size_t) (pLibConfig->mixBufferSize * pLibConfig->numChannels) * sizeof(EAS_PCM));
+    if (pAudioBuffer == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+
+    if ((result = EAS_Init(&easHandle)) != EAS_SUCCESS)
+        goto done;
+    if ((result = JET_Init(easHandle, NULL, 0)) != EAS_SUCCESS)
+        goto done;
+    if ((result = JET_OpenFile(easHandle, (EAS_FILE_LOCATOR) jetFile)) != EAS_SUCCESS)
+        goto done;
+    jetOpen = EAS_TRUE;
+    if ((result = JET_QueueSegment(easHandle, pSeg->segmentNum, pSeg->libNum, pSeg->repeatCount,
+        pSeg->transpose, pSeg->muteFlags, (EAS_U8) pSeg->segmentNum)) != EAS_SUCCESS)
+        goto done;
+    if ((result = JET_Play(easHandle)) != EAS_SUCCESS)
+        goto done;
+
+    if ((pFile = fopen(pSeg->outFile, "wb")) == NULL)
+    {
+        result = EAS_ERROR_FILE_OPEN_FAILED;
+        goto done;
+    }
+    if (!WriteWaveHeader(pFile, pLibConfig, 0))
+    {
+        result = EAS_FAILURE;
+        goto done;
+    }
+
+    /* render until the segment and its tail are done */
+    while ((tailSamples > 0) && (pSeg->numSamples < maxSamples))
+    {
+        if ((result = EAS_Render(easHandle, pAudioBuffer, pLibConfig->mixBufferSize, &count)) != EAS_SUCCESS)
+            goto done;
+        if (fwrite(pAudioBuffer, sizeof(EAS_PCM) * (size_t) pLibConfig->numChannels, (size_t) count, pFile) != (size_t) count)
+        {
+            result = EAS_FAILURE;
+            goto done;
+        }
+        pSeg->numSamples += count;
+
+        if ((result = JET_Status(easHandle, &status)) != EAS_SUCCESS)
+            goto done;
+        if (status.numQueuedSegments == 0)
+            tailSamples -= count;
+    }
+
+    if (!WriteWaveHeader(pFile, pLibConfig, pSeg->numSamples))
+        result = EAS_FAILURE;
+
+done:
+    if (pFile != NULL)
+    {
+        if ((fclose(pFile) != 0) && (result == EAS_SUCCESS))
+            result = EAS_FAILURE;
+    }
+    if (easHandle != NULL)
+    {
+        if (jetOpen)
+            JET_CloseFile(easHandle);
+        JET_Shutdown(easHandle);
+        EAS_Shutdown(easHandle);
+    }
+    free(pAudioBuffer);
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+ * BounceThread()
+ *----------------------------------------------------------------------------
+ * Bounces segments until there are none left
+*/
+static void *BounceThread (void *pArg)
+{
+    S_JET_BOUNCE *pBounce = (S_JET_BOUNCE *) pArg;
+    S_JET_BOUNCE_SEGMENT *pSeg;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&pBounce->lock);
+        pSeg = NULL;
+        if (pBounce->nextSegment < pBounce->numSegments)
+            pSeg = &pBounce->pSegments[pBounce->nextSegment++];
+        pthread_mutex_unlock(&pBounce->lock);
+
+        if (pSeg == NULL)
+            return NULL;
+        pSeg->result = BounceSegment(pBounce->jetFile, pSeg);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * JET_BounceSegments()
+ *----------------------------------------------------------------------------
+ * Renders each segment of a JET file to its own WAV file, faster than
+ * realtime and several at a time. maxThreads of 0 uses one thread per
+ * core. The result of each segment is returned in the segment, and the
+ * first failure is also returned by the call.
+*/
+EAS_EXPORT EAS_RESULT JET_BounceSegments (const char *jetFile, S_JET_BOUNCE_SEGMENT *pSegments, EAS_INT numSegments, EAS_INT maxThreads)
+{
+    pthread_t threads[MAX_BOUNCE_THREADS];
+    S_JET_BOUNCE bounce;
+    EAS_INT numThreads;
+    EAS_INT i;
+
+    if ((jetFile == NULL) || (pSegments == NULL) || (numSegments <= 0))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    if (maxThreads <= 0)
+        maxThreads = (EAS_INT) sysconf(_SC_NPROCESSORS_ONLN);
+    numThreads = maxThreads;
+    if (numThreads > numSegments)
+        numThreads = numSegments;
+    if (numThreads > MAX_BOUNCE_THREADS)
+        numThreads = MAX_BOUNCE_THREADS;
+    if (numThreads < 1)
+        numThreads = 1;
+
+    bounce.jetFile = jetFile;
+    bounce.pSegments = pSegments;
+    bounce.numSegments = numSegments;
+    bounce.nextSegment = 0;
+    pthread_mutex_init(&bounce.lock, NULL);
+    for (i = 0; i < numSegments; i++)
+        pSegments[i].result = EAS_FAILURE;
+
+    /* the calling thread bounces too if a thread can't be started */
+    for (i = 0; i < numThreads; i++)
+        if (pthread_create(&threads[i], NULL, BounceThread, &bounce) != 0)
+            break;
+    numThreads = i;
+    if (numThreads == 0)
+        (void) BounceThread(&bounce);
+    for (i = 0; i < numThreads; i++)
+        pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&bounce.lock);
+
+    for (i = 0; i < numSegments; i++)
+        if (pSegments[i].result != EAS_SUCCESS)
+            return pSegments[i].result;
+    return EAS_SUCCESS;
+}
+#endif
+
 
 #if defined(_DEBUG) && !defined(MSC)
 #include <crtdbg.h>
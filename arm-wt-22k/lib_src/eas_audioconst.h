@@ -93,5 +93,40 @@
 #error "_SAMPLE_RATE_XXXXX must be defined to valid rate"
 #endif
 
+/*----------------------------------------------------------------------------
+ * With _RUNTIME_SAMPLE_RATE an instance may also run at 2^MAX_RATE_SHIFT
+ * times the compiled rate. The frame keeps its duration and grows to
+ * BUFFER_SIZE_IN_MONO_SAMPLES << rateShift samples, so the frame buffers
+ * are sized for the largest frame.
+ *----------------------------------------------------------------------------
+*/
+#ifdef _RUNTIME_SAMPLE_RATE
+#define MAX_RATE_SHIFT                  1
+#else
+#define MAX_RATE_SHIFT                  0
+#endif
+#define MAX_BUFFER_SIZE_IN_MONO_SAMPLES (BUFFER_SIZE_IN_MONO_SAMPLES << MAX_RATE_SHIFT)
+
+/*----------------------------------------------------------------------------
+ * With _BLOCK_RENDER EAS_Render may render up to MAX_RENDER_BLOCK_FRAMES
+ * frames in one pass of the synthesizer, see EAS_SetRenderBlock. The
+ * synthesis parameters are still updated every frame, only the mix
+ * buffers hold the whole block.
+ *----------------------------------------------------------------------------
+*/
+#ifdef _BLOCK_RENDER
+#define MAX_RENDER_BLOCK_FRAMES         4
+#else
+#define MAX_RENDER_BLOCK_FRAMES         1
+#endif
+#define MAX_BLOCK_SIZE_IN_MONO_SAMPLES  (MAX_BUFFER_SIZE_IN_MONO_SAMPLES * MAX_RENDER_BLOCK_FRAMES)
+
+/*----------------------------------------------------------------------------
+ * With _LOW_LATENCY a frame may be rendered in slices of the frame size
+ * shifted right by up to MAX_RENDER_SLICE_SHIFT, see EAS_SetRenderSlice.
+ *----------------------------------------------------------------------------
+*/
+#define MAX_RENDER_SLICE_SHIFT          2
+
 #endif /* #ifndef _EAS_AUDIOCONST_H */
 
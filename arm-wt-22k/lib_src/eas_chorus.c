@@ -0,0 +1,683 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_chorus.c
+ *
+ * Contents and purpose:
+ * Contains the implementation of the Chorus effect.
+ *
+ * Each output channel is mixed with a copy of itself read from a delay
+ * line through a tap that is swept by a triangle LFO, the channels a
+ * quarter cycle apart. The tap positions are computed once per block and
+ * stepped linearly across it, so the per sample work is the linear
+ * interpolation and the wet mix.
+ *
+ * The wet level follows the largest chorus send (CC93) of the channels
+ * that have voices. While no channel has a send the chorus is idle and
+ * the output is the input.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+/* allocations of this module are reported as effects memory */
+#define EAS_MEM_CATEGORY    EAS_MEM_EFFECTS
+
+/*------------------------------------
+ * includes
+ *------------------------------------
+*/
+
+#include "eas_data.h"
+#include "eas_effects.h"
+#include "eas_math.h"
+#include "eas_chorusdata.h"
+#include "eas_chorus.h"
+#include "eas_config.h"
+#include "eas_host.h"
+#include "eas_report.h"
+
+/* prototypes for effects interface */
+static EAS_RESULT ChorusInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData);
+static void ChorusProcess (EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst, EAS_I32 numSamples);
+static EAS_RESULT ChorusShutdown (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
+static EAS_RESULT ChorusGetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue);
+static EAS_RESULT ChorusSetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value);
+static void ChorusReset (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
+static void ChorusSetDefaults (EAS_DATA_HANDLE pEASData, S_CHORUS_OBJECT *pChorusData);
+static void ChorusUpdate (S_CHORUS_OBJECT *pChorusData);
+
+/*----------------------------------------------------------------------------
+ * chorusPresets
+ *----------------------------------------------------------------------------
+ * The presets, shared read-only by every chorus instance in the process.
+ *----------------------------------------------------------------------------
+*/
+static const S_CHORUS_PRESET chorusPresets[NUM_CHORUS_PRESETS] =
+{
+    { 120, 20,  60, 16384 },    /* EAS_PARAM_CHORUS_PRESET1 */
+    { 100, 30, 100, 16384 },    /* EAS_PARAM_CHORUS_PRESET2 */
+    { 150, 50,  40, 19661 },    /* EAS_PARAM_CHORUS_PRESET3 */
+    {  70, 15, 250, 13107 }     /* EAS_PARAM_CHORUS_PRESET4 */
+};
+
+/*----------------------------------------------------------------------------
+ * Chorus effects interface
+ *----------------------------------------------------------------------------
+*/
+const S_EFFECTS_INTERFACE EAS_Chorus =
+{
+    ChorusInit,
+    ChorusProcess,
+    ChorusShutdown,
+    ChorusGetParam,
+    ChorusSetParam,
+    ChorusReset
+};
+
+/*----------------------------------------------------------------------------
+ * ChorusInit()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Allocates and initializes the Chorus effect.
+ *
+ * Inputs:
+ * pEASData - instance data
+ * pInstData - receives the chorus instance data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT ChorusInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
+{
+    S_CHORUS_OBJECT *pChorusData;
+
+    /* check Configuration Module for data allocation */
+    if (pEASData->staticMemoryModel)
+        pChorusData = EAS_CMEnumFXData(EAS_MODULE_CHORUS);
+
+    /* allocate dynamic memory */
+    else
+        pChorusData = EAS_HWMalloc(pEASData->hwInstData, sizeof(S_CHORUS_OBJECT));
+
+    if (pChorusData == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_FATAL, "Failed to allocate Chorus memory\n"); */ }
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+
+    /* clear the structure */
+    EAS_HWMemSet(pChorusData, 0, sizeof(S_CHORUS_OBJECT));
+
+    ChorusSetDefaults(pEASData, pChorusData);
+
+    *pInstData = pChorusData;
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusSetDefaults()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the chorus state after initialization
+ *
+ * Inputs:
+ * pEASData - instance data, for the output rate
+ * pChorusData - cleared chorus instance data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ChorusSetDefaults (EAS_DATA_HANDLE pEASData, S_CHORUS_OBJECT *pChorusData)
+{
+    const S_CHORUS_PRESET *pPreset;
+
+    /* the delays are in samples at the output rate */
+    pChorusData->m_nSampleRate = _OUTPUT_SAMPLE_RATE;
+#ifdef _RUNTIME_SAMPLE_RATE
+    pChorusData->m_nSampleRate <<= ((S_EAS_DATA*) pEASData)->rateShift;
+#endif
+
+    pChorusData->m_nCurrentPreset = CHORUS_DEFAULT_PRESET;
+    pPreset = &chorusPresets[CHORUS_DEFAULT_PRESET];
+    pChorusData->m_nRate = pPreset->m_nRate;
+    pChorusData->m_nDepthParam = pPreset->m_nDepth;
+    pChorusData->m_nLevel = pPreset->m_nLevel;
+    ChorusUpdate(pChorusData);
+
+    /* nothing has been written to the delay lines yet */
+    pChorusData->m_bIdle = EAS_TRUE;
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusReset()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the chorus to the state after ChorusInit
+ *
+ * Inputs:
+ * pEASData - instance data
+ * pInstData - chorus instance data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ChorusReset (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData)
+{
+    S_CHORUS_OBJECT *pChorusData = (S_CHORUS_OBJECT*) pInstData;
+
+    EAS_HWMemSet(pChorusData, 0, sizeof(S_CHORUS_OBJECT));
+    ChorusSetDefaults(pEASData, pChorusData);
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusDelayInSamples()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts a time in 0.1 ms to 16.16 samples at the output rate
+ *
+ * Inputs:
+ * time - in 0.1 ms
+ * sampleRate - output rate
+ *
+ * Outputs:
+ * delay in 16.16 samples
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 ChorusDelayInSamples (EAS_I32 time, EAS_I32 sampleRate)
+{
+    EAS_I32 temp;
+
+    /* split so the 16 bit fraction does not overflow */
+    temp = time * sampleRate;
+    return ((temp / 10000) << 16) + (((temp % 10000) << 16) / 10000);
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusUpdate()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Recomputes the delays and the LFO increment from the parameters
+ *
+ * Inputs:
+ * pChorusData - chorus instance data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ChorusUpdate (S_CHORUS_OBJECT *pChorusData)
+{
+    pChorusData->m_nDelay = ChorusDelayInSamples(chorusPresets[pChorusData->m_nCurrentPreset].m_nDelay, pChorusData->m_nSampleRate);
+    pChorusData->m_nDepth = ChorusDelayInSamples(pChorusData->m_nDepthParam, pChorusData->m_nSampleRate);
+    pChorusData->m_nPhaseIncrement = (uint32_t) ((((uint64_t) pChorusData->m_nRate) << 32) /
+        (100 * (uint64_t) pChorusData->m_nSampleRate));
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusClear()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Clears the delay lines when the chorus leaves the idle state, they
+ * were not written while it was idle
+ *
+ * Inputs:
+ * pChorusData - chorus instance data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ChorusClear (S_CHORUS_OBJECT *pChorusData)
+{
+    EAS_HWMemSet(pChorusData->m_nDelayLine, 0, (EAS_I32) sizeof(pChorusData->m_nDelayLine));
+    pChorusData->m_nWriteIndex = 0;
+    pChorusData->m_nSilentSamples = 0;
+    pChorusData->m_nGain = 0;
+    pChorusData->m_bIdle = EAS_FALSE;
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusDelay()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the tap delay for an LFO phase, the base delay plus the depth
+ * scaled by a triangle wave from zero to one
+ *
+ * Inputs:
+ * pChorusData - chorus instance data
+ * phase - LFO phase, 2^32 is a cycle
+ *
+ * Outputs:
+ * delay in 16.16 samples
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 ChorusDelay (const S_CHORUS_OBJECT *pChorusData, uint32_t phase)
+{
+    uint32_t triangle;
+
+    /* fold the second half cycle back down, 16 bits */
+    if (phase & 0x80000000u)
+        phase = ~phase;
+    triangle = phase >> 15;
+
+    /*lint -e{704} <avoid divide> */
+    return pChorusData->m_nDelay + (pChorusData->m_nDepth >> 8) * (EAS_I32) (triangle >> 8);
+}
+
+/*----------------------------------------------------------------------------
+ * Vector kernels
+ *
+ * The tap interpolation and wet gain are vectorized with NEON or SSE2
+ * intrinsics when the target always provides them. Define
+ * _NO_SIMD_KERNEL to force the C reference code, the output is
+ * bit-exact either way.
+ *----------------------------------------------------------------------------
+*/
+#if !defined(_NO_SIMD_KERNEL)
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define _NEON_KERNEL
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#define _SSE2_KERNEL
+#include <emmintrin.h>
+#endif
+#endif
+
+/*----------------------------------------------------------------------------
+ * ChorusInterpolate()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Interpolates the taps of a block between the delay line samples on
+ * either side of them and scales them by the wet gain
+ *
+ * Inputs:
+ * pEarly - delay line sample before each tap
+ * pLate - delay line sample after each tap
+ * pFrac - position of each tap between the two, 0 to 16383
+ * pWet - receives the scaled taps
+ * gain - wet gain, 0 to 32767
+ * numSamples - number of taps
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ChorusInterpolate (const EAS_PCM *pEarly, const EAS_PCM *pLate, const EAS_I16 *pFrac, EAS_PCM *pWet, EAS_I32 gain, EAS_I32 numSamples)
+{
+    EAS_I32 acc;
+    EAS_I32 k;
+
+    k = 0;
+
+#if defined(_NEON_KERNEL)
+    {
+        int16x8_t vGain;
+        int16x8_t vOne;
+        int16x8_t vEarly;
+        int16x8_t vLate;
+        int16x8_t vFrac;
+        int16x8_t vWeight;
+        int32x4_t vLo;
+        int32x4_t vHi;
+
+        vGain = vdupq_n_s16((int16_t) gain);
+        vOne = vdupq_n_s16(16384);
+        for (; k + 8 <= numSamples; k += 8)
+        {
+            vEarly = vld1q_s16(pEarly + k);
+            vLate = vld1q_s16(pLate + k);
+            vFrac = vld1q_s16(pFrac + k);
+            vWeight = vsubq_s16(vOne, vFrac);
+            vLo = vmlal_s16(vmull_s16(vget_low_s16(vEarly), vget_low_s16(vWeight)), vget_low_s16(vLate), vget_low_s16(vFrac));
+            vHi = vmlal_s16(vmull_s16(vget_high_s16(vEarly), vget_high_s16(vWeight)), vget_high_s16(vLate), vget_high_s16(vFrac));
+
+            /* (2 * tap * gain) >> 16 is (tap * gain) >> 15 */
+            vst1q_s16(pWet + k, vqdmulhq_s16(vcombine_s16(vshrn_n_s32(vLo, 14), vshrn_n_s32(vHi, 14)), vGain));
+        }
+    }
+#elif defined(_SSE2_KERNEL)
+    {
+        __m128i vGain;
+        __m128i vOne;
+        __m128i vEarly;
+        __m128i vLate;
+        __m128i vFrac;
+        __m128i vWeight;
+        __m128i vLo;
+        __m128i vHi;
+        __m128i vTap;
+
+        vGain = _mm_set1_epi16((short) gain);
+        vOne = _mm_set1_epi16(16384);
+        for (; k + 8 <= numSamples; k += 8)
+        {
+            vEarly = _mm_loadu_si128((const __m128i*) (pEarly + k));
+            vLate = _mm_loadu_si128((const __m128i*) (pLate + k));
+            vFrac = _mm_loadu_si128((const __m128i*) (pFrac + k));
+            vWeight = _mm_sub_epi16(vOne, vFrac);
+
+            /* early * weight + late * frac for each pair */
+            vLo = _mm_madd_epi16(_mm_unpacklo_epi16(vEarly, vLate), _mm_unpacklo_epi16(vWeight, vFrac));
+            vHi = _mm_madd_epi16(_mm_unpackhi_epi16(vEarly, vLate), _mm_unpackhi_epi16(vWeight, vFrac));
+            vTap = _mm_packs_epi32(_mm_srai_epi32(vLo, 14), _mm_srai_epi32(vHi, 14));
+
+            /* (tap * gain) >> 15 from the high and low halves of the product */
+            vLo = _mm_mullo_epi16(vTap, vGain);
+            vHi = _mm_mulhi_epi16(vTap, vGain);
+            _mm_storeu_si128((__m128i*) (pWet + k), _mm_or_si128(_mm_slli_epi16(vHi, 1), _mm_srli_epi16(vLo, 15)));
+        }
+    }
+#endif
+
+    for (; k < numSamples; k++)
+    {
+        acc = pEarly[k] * (16384 - pFrac[k]) + pLate[k] * pFrac[k];
+        /*lint -e{704} <avoid divide> */
+        acc >>= 14;
+        /*lint -e{704} <avoid divide> */
+        pWet[k] = (EAS_PCM) ((acc * gain) >> 15);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusBlock()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds the chorus to a block of at most CHORUS_BLOCK_SIZE samples
+ *
+ * Inputs:
+ * pChorusData - chorus instance data
+ * pBuffer - interleaved dry signal, the wet signal is added to it
+ * numSamples - samples per channel
+ * target - wet gain to move toward
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ChorusBlock (S_CHORUS_OBJECT *pChorusData, EAS_PCM *pBuffer, EAS_I32 numSamples, EAS_I32 target)
+{
+    EAS_PCM early[CHORUS_BLOCK_SIZE];
+    EAS_PCM late[CHORUS_BLOCK_SIZE];
+    EAS_I16 frac[CHORUS_BLOCK_SIZE];
+    EAS_PCM wet[CHORUS_BLOCK_SIZE];
+    const EAS_PCM *pDelayLine;
+    uint32_t phase;
+    uint32_t pos;
+    uint32_t index;
+    EAS_I32 delay;
+    EAS_I32 step;
+    EAS_I32 gain;
+    EAS_I32 temp;
+    EAS_I32 k;
+    EAS_INT ch;
+
+    /* step the gain toward the target, once per block */
+    gain = pChorusData->m_nGain;
+    if (gain < target)
+        gain = (gain + CHORUS_GAIN_STEP < target) ? gain + CHORUS_GAIN_STEP : target;
+    else if (gain > target)
+        gain = (gain - CHORUS_GAIN_STEP > target) ? gain - CHORUS_GAIN_STEP : target;
+    pChorusData->m_nGain = (EAS_I16) gain;
+
+    /* write the block first, every tap is at least a millisecond behind it */
+    for (ch = 0; ch < NUM_OUTPUT_CHANNELS; ch++)
+        for (k = 0; k < numSamples; k++)
+            pChorusData->m_nDelayLine[ch][(pChorusData->m_nWriteIndex + k) & CHORUS_DELAY_LINE_MASK] = pBuffer[k * NUM_OUTPUT_CHANNELS + ch];
+
+    for (ch = 0; ch < NUM_OUTPUT_CHANNELS; ch++)
+    {
+        /* the channels are modulated a quarter cycle apart */
+        phase = pChorusData->m_nPhase + (uint32_t) ch * 0x40000000u;
+        delay = ChorusDelay(pChorusData, phase);
+        /*lint -e{704} <avoid divide> */
+        step = (ChorusDelay(pChorusData, phase + (pChorusData->m_nPhaseIncrement << CHORUS_BLOCK_BITS)) - delay) >> CHORUS_BLOCK_BITS;
+
+        /* gather the delay line samples around each tap */
+        pDelayLine = pChorusData->m_nDelayLine[ch];
+        pos = ((uint32_t) pChorusData->m_nWriteIndex << 16) - (uint32_t) delay;
+        for (k = 0; k < numSamples; k++)
+        {
+            index = (pos >> 16) & CHORUS_DELAY_LINE_MASK;
+            early[k] = pDelayLine[index];
+            late[k] = pDelayLine[(index + 1) & CHORUS_DELAY_LINE_MASK];
+            frac[k] = (EAS_I16) ((pos & 0xffff) >> 2);
+            pos += (uint32_t) (0x10000 - step);
+        }
+
+        ChorusInterpolate(early, late, frac, wet, gain, numSamples);
+
+        /* add the wet signal */
+        for (k = 0; k < numSamples; k++)
+        {
+            temp = pBuffer[k * NUM_OUTPUT_CHANNELS + ch] + wet[k];
+            pBuffer[k * NUM_OUTPUT_CHANNELS + ch] = (EAS_PCM) SATURATE(temp);
+        }
+    }
+
+    pChorusData->m_nWriteIndex = (EAS_U16) ((pChorusData->m_nWriteIndex + numSamples) & CHORUS_DELAY_LINE_MASK);
+    pChorusData->m_nPhase += pChorusData->m_nPhaseIncrement * (uint32_t) numSamples;
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusProcess()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds the chorus to the requested number of samples
+ *
+ * Inputs:
+ * pInstData - chorus instance data
+ * pSrc - src buffer
+ * pDst - dst buffer (may be the same as pSrc)
+ * numSamples - samples per channel
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ChorusProcess (EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst, EAS_I32 numSamples)
+{
+    S_CHORUS_OBJECT *pChorusData;
+    EAS_I32 target;
+    EAS_I32 count;
+    EAS_I32 i;
+
+    pChorusData = (S_CHORUS_OBJECT*) pInstData;
+
+    /* the dry signal passes unchanged */
+    if (pSrc != pDst)
+        EAS_HWMemCpy(pDst, pSrc, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+
+    /* the wet level follows the send, a bypass fades it out */
+    target = 0;
+    if (!pChorusData->m_bBypass)
+        target = (pChorusData->m_nLevel * pChorusData->m_nSend) / 127;
+
+    /* idle until a channel with voices has a send */
+    if (pChorusData->m_bIdle)
+    {
+        if (target == 0)
+            return;
+        ChorusClear(pChorusData);
+    }
+    else if ((target == 0) && (pChorusData->m_nGain == 0))
+    {
+        pChorusData->m_bIdle = EAS_TRUE;
+        return;
+    }
+
+    /* once the delay lines only hold silence, silent input needs no processing */
+    for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+    {
+        if (pDst[i] != 0)
+            break;
+    }
+    if (i < numSamples * NUM_OUTPUT_CHANNELS)
+        pChorusData->m_nSilentSamples = 0;
+    else if (pChorusData->m_nSilentSamples >= CHORUS_DELAY_LINE_SIZE)
+    {
+        pChorusData->m_nGain = (EAS_I16) target;
+        return;
+    }
+    else
+        pChorusData->m_nSilentSamples += numSamples;
+
+    while (numSamples > 0)
+    {
+        count = (numSamples < CHORUS_BLOCK_SIZE) ? numSamples : CHORUS_BLOCK_SIZE;
+        ChorusBlock(pChorusData, pDst, count, target);
+        pDst += count * NUM_OUTPUT_CHANNELS;
+        numSamples -= count;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusShutdown()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees the Chorus effect.
+ *
+ * Inputs:
+ * pEASData - instance data
+ * pInstData - chorus instance data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT ChorusShutdown (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData)
+{
+    /* check Configuration Module for static memory allocation */
+    if (!pEASData->staticMemoryModel)
+        EAS_HWFree(pEASData->hwInstData, pInstData);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusGetParam()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Get a Chorus parameter
+ *
+ * Inputs:
+ * pInstData - chorus instance data
+ * param - parameter index
+ * *pValue - pointer to variable to hold retrieved value
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT ChorusGetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue)
+{
+    S_CHORUS_OBJECT *p;
+
+    p = (S_CHORUS_OBJECT*) pInstData;
+
+    switch (param)
+    {
+        case EAS_PARAM_CHORUS_BYPASS:
+            *pValue = (EAS_I32) p->m_bBypass;
+            break;
+        case EAS_PARAM_CHORUS_PRESET:
+            *pValue = p->m_nCurrentPreset;
+            break;
+        case EAS_PARAM_CHORUS_RATE:
+            *pValue = p->m_nRate;
+            break;
+        case EAS_PARAM_CHORUS_DEPTH:
+            *pValue = p->m_nDepthParam;
+            break;
+        case EAS_PARAM_CHORUS_LEVEL:
+            *pValue = p->m_nLevel;
+            break;
+        default:
+            return EAS_ERROR_INVALID_PARAMETER;
+    }
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusSetParam()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Set a Chorus parameter
+ *
+ * Inputs:
+ * pInstData - chorus instance data
+ * param - parameter index
+ * value - new parameter value
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT ChorusSetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value)
+{
+    S_CHORUS_OBJECT *p;
+    const S_CHORUS_PRESET *pPreset;
+
+    p = (S_CHORUS_OBJECT*) pInstData;
+
+    switch (param)
+    {
+        case EAS_PARAM_CHORUS_BYPASS:
+            p->m_bBypass = (EAS_BOOL) value;
+            break;
+        case EAS_PARAM_CHORUS_PRESET:
+            if (value < EAS_PARAM_CHORUS_PRESET1 || value > EAS_PARAM_CHORUS_PRESET4)
+                return EAS_ERROR_INVALID_PARAMETER;
+            p->m_nCurrentPreset = (EAS_I16) value;
+            pPreset = &chorusPresets[value];
+            p->m_nRate = pPreset->m_nRate;
+            p->m_nDepthParam = pPreset->m_nDepth;
+            p->m_nLevel = pPreset->m_nLevel;
+            ChorusUpdate(p);
+            break;
+        case EAS_PARAM_CHORUS_RATE:
+            if (value > EAS_CHORUS_RATE_MAX || value < EAS_CHORUS_RATE_MIN)
+                return EAS_ERROR_INVALID_PARAMETER;
+            p->m_nRate = (EAS_I16) value;
+            ChorusUpdate(p);
+            break;
+        case EAS_PARAM_CHORUS_DEPTH:
+            if (value > EAS_CHORUS_DEPTH_MAX || value < EAS_CHORUS_DEPTH_MIN)
+                return EAS_ERROR_INVALID_PARAMETER;
+            p->m_nDepthParam = (EAS_I16) value;
+            ChorusUpdate(p);
+            break;
+        case EAS_PARAM_CHORUS_LEVEL:
+            if (value > EAS_CHORUS_LEVEL_MAX || value < EAS_CHORUS_LEVEL_MIN)
+                return EAS_ERROR_INVALID_PARAMETER;
+            p->m_nLevel = (EAS_I16) value;
+            break;
+        case CHORUS_PARAM_SEND:
+            if (value > 127 || value < 0)
+                return EAS_ERROR_INVALID_PARAMETER;
+            p->m_nSend = (EAS_I16) value;
+            break;
+        default:
+            return EAS_ERROR_INVALID_PARAMETER;
+    }
+    return EAS_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_chorusdata.h
+ *
+ * Contents and purpose:
+ * Contains the data structures for the Chorus effect.
+ *
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_CHORUSDATA_H
+#define _EAS_CHORUSDATA_H
+
+#include "eas_types.h"
+#include "eas_audioconst.h"
+#include <stdint.h>
+
+/*------------------------------------
+ * defines
+ *------------------------------------
+*/
+
+/* the modulated delay is recomputed every CHORUS_BLOCK_SIZE samples */
+#define CHORUS_BLOCK_BITS               5
+#define CHORUS_BLOCK_SIZE               (1 << CHORUS_BLOCK_BITS)
+
+/* longest delay of any setting, the base delay plus the depth */
+#define CHORUS_MAX_DELAY_MS             25
+
+/*
+Each output channel has its own delay line, a power of two long enough
+for the longest delay and one block at the highest output rate.
+*/
+#define CHORUS_MAX_DELAY_IN_SAMPLES     (((_OUTPUT_SAMPLE_RATE << MAX_RATE_SHIFT) * CHORUS_MAX_DELAY_MS) / 1000 + 1)
+#if (CHORUS_MAX_DELAY_IN_SAMPLES + CHORUS_BLOCK_SIZE) <= 1024
+#define CHORUS_DELAY_LINE_SIZE          1024
+#elif (CHORUS_MAX_DELAY_IN_SAMPLES + CHORUS_BLOCK_SIZE) <= 2048
+#define CHORUS_DELAY_LINE_SIZE          2048
+#else
+#define CHORUS_DELAY_LINE_SIZE          4096
+#endif
+#define CHORUS_DELAY_LINE_MASK          (CHORUS_DELAY_LINE_SIZE - 1)
+
+/* the wet gain moves at most this much per block, about 50 ms from off to full */
+#define CHORUS_GAIN_STEP                (32767 >> 5)
+
+/*
+The mixer sets this parameter every frame to the largest chorus send
+(CC93) of the channels that have voices, the effect is idle while it
+is zero. It is not one of the public E_CHORUS_PARAMS.
+*/
+#define CHORUS_PARAM_SEND               0x100
+
+#define NUM_CHORUS_PRESETS              4
+#define CHORUS_DEFAULT_PRESET           0
+
+/* rate in 0.01 Hz, depth in 0.1 ms, level in 1.15 */
+#define EAS_CHORUS_RATE_MAX             500
+#define EAS_CHORUS_RATE_MIN             10
+#define EAS_CHORUS_DEPTH_MAX            100
+#define EAS_CHORUS_DEPTH_MIN            0
+#define EAS_CHORUS_LEVEL_MAX            32767
+#define EAS_CHORUS_LEVEL_MIN            0
+
+/* parameters of a preset */
+typedef struct
+{
+    EAS_I16             m_nDelay;       // base delay, 0.1 ms, at least 1 ms and at most CHORUS_MAX_DELAY_MS less the depth
+
+    EAS_I16             m_nDepth;       // modulation depth, 0.1 ms
+
+    EAS_I16             m_nRate;        // modulation rate, 0.01 Hz
+
+    EAS_I16             m_nLevel;       // wet level at full send
+
+} S_CHORUS_PRESET;
+
+/* chorus instance data */
+typedef struct
+{
+    EAS_PCM             m_nDelayLine[NUM_OUTPUT_CHANNELS][CHORUS_DELAY_LINE_SIZE];
+
+    uint32_t            m_nPhase;                   // LFO phase of the first channel, 2^32 is a cycle
+
+    uint32_t            m_nPhaseIncrement;          // LFO phase increment per sample
+
+    EAS_I32             m_nDelay;                   // base delay, 16.16 samples
+
+    EAS_I32             m_nDepth;                   // modulation depth, 16.16 samples
+
+    EAS_I32             m_nSampleRate;              // output rate
+
+    EAS_I32             m_nSilentSamples;           // samples of silent input written to the delay lines
+
+    EAS_U16             m_nWriteIndex;              // next delay line sample to write
+
+    EAS_I16             m_nGain;                    // wet gain of the last block
+
+    EAS_I16             m_nSend;                    // largest channel send, 0 to 127
+
+    EAS_I16             m_nCurrentPreset;           // preset number
+
+    EAS_I16             m_nRate;                    // modulation rate, 0.01 Hz
+
+    EAS_I16             m_nDepthParam;              // modulation depth, 0.1 ms
+
+    EAS_I16             m_nLevel;                   // wet level at full send
+
+    EAS_BOOL            m_bBypass;                  // if EAS_TRUE, then bypass the chorus and copy input to output
+
+    EAS_BOOL            m_bIdle;                    // if EAS_TRUE, the delay lines are stale and processing is skipped
+
+} S_CHORUS_OBJECT;
+
+#endif /* #ifndef _EAS_CHORUSDATA_H */
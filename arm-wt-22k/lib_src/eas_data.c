@@ -33,5 +33,8 @@
 // globals
 S_EAS_DATA eas_Data;
 S_VOICE_MGR eas_Synth;
+#ifdef _RUNTIME_POLYPHONY
+S_VM_TABLES eas_SynthTables;
+#endif
 S_SYNTH eas_MIDI;
 
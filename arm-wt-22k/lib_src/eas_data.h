@@ -56,10 +56,28 @@
 #include "eas_perf.h"
 #endif
 
+#ifdef _OUTPUT_RESAMPLER
+#include "eas_resampler.h"
+#endif
+
+#ifdef _PCM_CACHE
+#include "eas_pcmcache.h"
+#endif
+
 #ifndef MAX_NUMBER_STREAMS
 #define MAX_NUMBER_STREAMS          4
 #endif
 
+/* most streams EAS_InitEx accepts in maxStreams */
+#ifndef MAX_DYNAMIC_STREAMS
+#define MAX_DYNAMIC_STREAMS         256
+#endif
+
+/* samples rendered since init, the clock of the MIDI input ring, of JET event timestamps and of stream positions */
+#if defined(_MIDI_INPUT_RING) || defined(_JET_EVENT_RING) || defined(_JET_TIMED_COMMANDS) || defined(_POSITION_REPORT)
+#define _SAMPLE_CLOCK
+#endif
+
 /* flags for S_EAS_STREAM */
 #define STREAM_FLAGS_PARSED         1
 #define STREAM_FLAGS_PAUSE          2
@@ -76,6 +94,15 @@ typedef struct s_eas_stream_tag
     EAS_VOID_PTR                    handle;
     EAS_U8                          volume;
     EAS_BOOL8                       streamFlags;
+#ifdef _ASYNC_OPEN
+    struct s_eas_async_open_tag     *pAsyncOpen;    /* background open, until it is joined */
+#endif
+#ifdef _PCM_CACHE
+    S_PCM_CACHE_KEY                 cacheKey;       /* file and settings the output depends on */
+    S_PCM_CACHE_ENTRY               *pCacheEntry;   /* entry being recorded or played */
+    EAS_I32                         cacheFrame;     /* next frame to play from the entry */
+    EAS_U8                          cacheState;     /* PCM_CACHE_XXX */
+#endif
 } S_EAS_STREAM;
 
 /* default master volume is -10dB */
@@ -86,6 +113,50 @@ typedef struct s_eas_stream_tag
 /* 10 dB of boost available for individual parsers */
 #define STREAM_VOLUME_HEADROOM      10
 
+/* samples per channel in one render frame of this instance */
+#ifdef _RUNTIME_SAMPLE_RATE
+#define EAS_FRAME_SIZE(pEASData)    (BUFFER_SIZE_IN_MONO_SAMPLES << (pEASData)->rateShift)
+#else
+#define EAS_FRAME_SIZE(pEASData)    BUFFER_SIZE_IN_MONO_SAMPLES
+#endif
+
+/* samples per channel in the block of frames being rendered, set by EAS_Render */
+#ifdef _BLOCK_RENDER
+#define EAS_BLOCK_FRAMES(pEASData)  ((pEASData)->renderFrames)
+#else
+#define EAS_BLOCK_FRAMES(pEASData)  1
+#endif
+#define EAS_BLOCK_SIZE(pEASData)    (EAS_FRAME_SIZE(pEASData) * EAS_BLOCK_FRAMES(pEASData))
+
+/* size of the stream table, and the slots below the highest one in use */
+#ifdef _DYNAMIC_STREAMS
+#define EAS_MAX_STREAMS(pEASData)   ((pEASData)->maxStreams)
+#define EAS_STREAM_SLOTS(pEASData)  ((pEASData)->streamSlots)
+#else
+#define EAS_MAX_STREAMS(pEASData)   MAX_NUMBER_STREAMS
+#define EAS_STREAM_SLOTS(pEASData)  MAX_NUMBER_STREAMS
+#endif
+
+/* samples per channel in one render call of the synthesizer, a frame or a slice of one */
+#ifdef _LOW_LATENCY
+#define EAS_SLICE_SIZE(pEASData)    ((pEASData)->sliceSize)
+#else
+#define EAS_SLICE_SIZE(pEASData)    EAS_FRAME_SIZE(pEASData)
+#endif
+
+/* most samples per channel one render frame can produce */
+#ifdef _OUTPUT_RESAMPLER
+#define EAS_MAX_FRAME_OUTPUT(pEASData)  (((pEASData)->pResampler != NULL) ? RESAMPLER_MAX_OUTPUT_SAMPLES : EAS_SLICE_SIZE(pEASData))
+#else
+#define EAS_MAX_FRAME_OUTPUT(pEASData)  EAS_SLICE_SIZE(pEASData)
+#endif
+
+#if defined(_OUTPUT_RESAMPLER) && (RESAMPLER_MAX_OUTPUT_SAMPLES > MAX_BUFFER_SIZE_IN_MONO_SAMPLES)
+#define MAX_FRAME_OUTPUT_SAMPLES    RESAMPLER_MAX_OUTPUT_SAMPLES
+#else
+#define MAX_FRAME_OUTPUT_SAMPLES    MAX_BUFFER_SIZE_IN_MONO_SAMPLES
+#endif
+
 /* amalgamated persistent data type */
 typedef struct s_eas_data_tag
 {
@@ -96,6 +167,11 @@ typedef struct s_eas_data_tag
 
     S_EFFECTS_MODULE                effectsModules[NUM_EFFECTS_MODULES];
 
+#ifdef _INSERT_EFFECTS
+    /* inserts on the whole mix, NULL until the first EAS_AddInsert */
+    S_INSERT_CHAIN                  *pMasterInserts;
+#endif
+
 #ifdef _METRICS_ENABLED
     S_METRICS_INTERFACE             *pMetricsModule;
     EAS_VOID_PTR                    pMetricsData;
@@ -104,6 +180,68 @@ typedef struct s_eas_data_tag
     EAS_I32                         *pMixBuffer;
     EAS_PCM                         *pOutputAudioBuffer;
 
+    /* remainder of the last frame when EAS_Render ends part way through it */
+    EAS_PCM                         carryBuffer[MAX_FRAME_OUTPUT_SAMPLES * NUM_OUTPUT_CHANNELS];
+    EAS_I32                         carryOffset;
+    EAS_I32                         carryCount;
+
+#ifdef _HIGH_RES_OUTPUT
+    /* frame at full precision for EAS_RenderFormat, left justified */
+    int32_t                         wideBuffer[MAX_FRAME_OUTPUT_SAMPLES * NUM_OUTPUT_CHANNELS];
+    int32_t                         *pWideOutput;       /* set while the mix engine fills wideBuffer */
+    EAS_BOOL                        carryWide;          /* carry is held in wideBuffer */
+#endif
+
+#ifdef _RUNTIME_SAMPLE_RATE
+    /* output rate is _OUTPUT_SAMPLE_RATE << rateShift */
+    EAS_I32                         rateShift;
+#endif
+
+#ifdef _OUTPUT_RESAMPLER
+    /* converts the mixed output to the device rate, NULL if not needed */
+    S_EAS_RESAMPLER                 *pResampler;
+#endif
+
+#ifdef _BLOCK_RENDER
+    /* frames EAS_Render synthesizes per call, and the frames in the current one */
+    EAS_I32                         blockFrames;
+    EAS_I32                         renderFrames;
+#endif
+
+#ifdef _LOW_LATENCY
+    /* samples per slice of a frame, and the position of the next slice in the frame */
+    EAS_I32                         sliceSize;
+    EAS_I32                         slicePos;
+#endif
+
+#ifdef _DEADLINE_MONITOR
+    /* microseconds a frame may take, and the function told when one takes longer */
+    EAS_U32                         deadlineBudget;
+    EAS_DEADLINE_CALLBACK           pfDeadlineCallback;
+    EAS_VOID_PTR                    pDeadlineUserData;
+#endif
+
+#ifdef _PARSE_LIMITS
+    /* bounds on the work of one parse */
+    S_EAS_PARSE_LIMITS              parseLimits;
+#endif
+
+#ifdef _EXTERNAL_SOUNDBANK
+    /* sound library loaded by EAS_InitEx, unloaded at shutdown */
+    EAS_SNDLIB_HANDLE               pSoundLibrary;
+#endif
+
+#ifdef _PCM_CACHE
+    /* rendered audio of files played before */
+    S_PCM_CACHE                     pcmCache;
+#endif
+
+#ifdef _RINGTONE_EVENT_CACHE
+    /* event lists of ringtones compiled before, most recently used first */
+    struct s_tone_cache_entry_tag   *pToneCache;
+    EAS_I32                         toneCacheSize;  /* event lists kept, 0 if the cache is disabled */
+#endif
+
 #ifdef AUX_MIXER
     S_EAS_AUX_MIXER                 auxMixer;
 #endif
@@ -112,22 +250,164 @@ typedef struct s_eas_data_tag
     EAS_VOID_PTR                    pMaximizerData;
 #endif
 
+#ifdef _DYNAMIC_STREAMS
+    /* table of maxStreams streams, defaultStreams unless more were asked for */
+    S_EAS_STREAM                    *streams;
+    S_EAS_STREAM                    defaultStreams[MAX_NUMBER_STREAMS];
+    EAS_INT                         maxStreams;
+    EAS_INT                         streamSlots;    /* one past the highest slot in use */
+#else
     S_EAS_STREAM                    streams[MAX_NUMBER_STREAMS];
+#endif
 
     S_VOICE_MGR                     *pVoiceMgr;
 
+    /* PCM engine streams, MAX_PCM_STREAMS entries allocated by the first open */
+    S_PCM_STATE                     *pPCMStreams;
+
 #ifdef JET_INTERFACE
     JET_DATA_HANDLE                 jetHandle;
 #endif
 
     EAS_U32                         renderTime;
+#ifdef _COALESCE_CONTROLLERS
+    /* end of the frame being parsed in msecs/256, events before it are applied together */
+    EAS_U32                         parseEndTime;
+#endif
+#ifdef _SAMPLE_CLOCK
+    volatile EAS_U32                sampleTime;
+#endif
     EAS_I16                         masterGain;
     EAS_U8                          masterVolume;
     EAS_BOOL8                       staticMemoryModel;
+#ifdef _INSTANCE_POOL
+    EAS_BOOL8                       pooled;         /* created by EAS_AcquireInstance */
+#endif
 #ifdef FILE_HEADER_SEARCH
     EAS_BOOL8                       searchHeaderFlag;
 #endif
+#ifdef _ASYNC_OPEN
+    EAS_INT                         asyncOpens;     /* opens not yet joined, render locks while non-zero */
+#endif
+#ifdef _RENDER_AHEAD
+    /* render thread and its ring, NULL unless EAS_StartRenderAhead is in effect */
+    struct s_eas_render_ahead_tag   *pRenderAhead;
+#endif
+#ifdef _PIPELINED_RENDER
+    /* workers of the pipelined render, NULL unless EAS_SetPipelinedRender is in effect */
+    struct s_eas_pipeline_tag       *pPipeline;
+    EAS_I32                         pipeRemaining;  /* samples EAS_Render renders after the current frame */
+#endif
+#ifdef _RT_SAFE_RENDER
+    EAS_BOOL8                       realtimeRender; /* see EAS_SetRealtimeRender */
+#endif
+#ifdef _CHORUS_ENABLED
+    EAS_U8                          chorusSend;     /* chorus send of the frame being post-processed */
+#endif
+#ifdef _IDLE_DETECT
+    EAS_I32                         silentSamples;  /* silent output in a row with no voice or PCM stream playing */
+    EAS_BOOL8                       silentFrame;    /* the last frame rendered was silent */
+    EAS_BOOL8                       skipIdle;       /* zero fill idle frames, see EAS_SetIdleMode */
+#endif
 } S_EAS_DATA;
 
+#ifdef _ASYNC_OPEN
+/* a stream being opened and prepared on a background thread */
+typedef struct s_eas_async_open_tag
+{
+    S_EAS_DATA                      *pEASData;
+    S_EAS_STREAM                    *pStream;
+    EAS_FILE_HANDLE                 fileHandle;
+    EAS_OPEN_CALLBACK               pfCallback;
+    EAS_VOID_PTR                    pUserData;
+    EAS_HW_THREAD_HANDLE            thread;
+    EAS_RESULT                      result;
+} S_EAS_ASYNC_OPEN;
+#endif
+
+#ifdef _BATCH_RENDER
+/*
+ * Batch renderer. Each thread has a share of the items of a batch, taken
+ * in order through its counter by the thread itself and by the threads
+ * that have finished their own share.
+ */
+typedef struct s_eas_batch_tag
+{
+    EAS_HW_DATA_HANDLE              hwInstData;     /* owned by the batch, for its allocations */
+    EAS_HW_WORKERS_HANDLE           workers;
+    EAS_INT                         numThreads;
+    S_EAS_BATCH_ITEM                *pItems;        /* items of the batch in progress */
+    EAS_I32                         numItems;
+    volatile EAS_U32                next[EAS_MAX_BATCH_THREADS];    /* items of each share taken */
+} S_EAS_BATCH;
+#endif
+
+#ifdef _RENDER_AHEAD
+/* commands EAS_PostRenderCommand can queue, must be a power of 2 */
+#ifndef RENDER_AHEAD_COMMANDS
+#define RENDER_AHEAD_COMMANDS       64
+#endif
+
+/*
+ * Output rendered ahead by a background thread. The ring and the command
+ * queue each have one writer and one reader, their counters only increase
+ * and are published with EAS_HWAtomicStore.
+ */
+typedef struct s_eas_render_ahead_tag
+{
+    S_EAS_DATA                      *pEASData;
+    EAS_HW_THREAD_HANDLE            thread;
+    EAS_PCM                         *pRing;         /* ringSize samples per channel */
+    EAS_PCM                         *pChunk;        /* chunkSize samples per channel, rendered before the copy to the ring */
+    EAS_U32                         ringSize;       /* a power of 2 */
+    EAS_I32                         chunkSize;      /* samples per channel the thread renders at a time */
+    EAS_U32                         sleepTime;      /* microseconds the thread waits for room in the ring */
+    volatile EAS_U32                head;           /* samples written, by the render thread */
+    volatile EAS_U32                tail;           /* samples read, by EAS_ReadRenderAhead */
+    volatile EAS_U32                underruns;      /* by EAS_ReadRenderAhead */
+    volatile EAS_U32                stop;           /* set to end the render thread */
+    volatile EAS_U32                result;         /* EAS_RESULT that ended the render thread */
+    volatile EAS_U32                commandResult;  /* last failed EAS_RESULT of a command */
+    volatile EAS_U32                commandHead;    /* commands posted, by EAS_PostRenderCommand */
+    volatile EAS_U32                commandTail;    /* commands applied, by the render thread */
+    S_EAS_RENDER_COMMAND            commands[RENDER_AHEAD_COMMANDS];
+} S_EAS_RENDER_AHEAD;
+#endif
+
+/* outcome of the parse of a frame, see EAS_ParseFrame */
+typedef struct s_eas_parsed_frame_tag
+{
+#ifdef _PCM_CACHE
+    S_EAS_STREAM                    *pCacheStream;  /* stream played from the PCM cache, NULL if none */
+#endif
+#ifdef _DEADLINE_MONITOR
+    S_EAS_FRAME_TIMING              *pTiming;       /* NULL if the frame is not timed */
+    EAS_U32                         mark;           /* time of the last mark */
+#endif
+    EAS_BOOL8                       aborted;        /* the frame is not rendered */
+} S_EAS_PARSED_FRAME;
+
+#ifdef _PIPELINED_RENDER
+/*
+ * Pipelined render. Worker 0 post-processes a frame while worker 1
+ * parses the next one, the voice manager and the streams belong to
+ * worker 1 until the join.
+ */
+typedef struct s_eas_pipeline_tag
+{
+    EAS_HW_WORKERS_HANDLE           workers;
+    S_EAS_PARSED_FRAME              frame;          /* parse of the next frame */
+#ifdef _DEADLINE_MONITOR
+    S_EAS_FRAME_TIMING              timing;         /* parse timing of the next frame */
+#endif
+    EAS_I32                         numSamples;     /* samples per channel of the frame post-processed */
+    EAS_I32                         frames;         /* block frames of the next frame */
+    EAS_I32                         numParse;       /* samples per channel of the frame parsed */
+    EAS_RESULT                      result;         /* of the parse */
+    EAS_BOOL8                       idleFrame;      /* the frame post-processed is idle */
+    EAS_BOOL8                       parsed;         /* the next frame has been parsed */
+} S_EAS_PIPELINE;
+#endif
+
 #endif
 
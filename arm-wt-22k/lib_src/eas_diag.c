@@ -0,0 +1,272 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_diag.c
+ *
+ * Contents and purpose:
+ * Diagnostics posted by the render path, see eas_diag.h.
+ *
+ * The ring is shared by every library instance in the process, since the
+ * wavetable kernels that post most events know nothing of the instance
+ * they render for, and any number of render threads may post at once.
+ * A writer claims a cell by advancing head with a compare and swap, fills
+ * it in and publishes it by storing its sequence word. The sequence word
+ * of a cell is the lap of the position it is free for, plus one once it
+ * holds an event, so a ring of zeros is an empty ring. When the ring is
+ * full the event is counted as lost rather than waiting for a reader.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+/*------------------------------------
+ * includes
+ *------------------------------------
+*/
+
+#define LOG_TAG "Sonivox"
+#include "log/log.h"
+#include <cutils/log.h>
+#include <stdio.h>
+
+#include "eas_diag.h"
+#include "eas_host.h"
+#include "eas_report.h"
+
+/* SafetyNet tag for android_errorWriteLog */
+#define EAS_DIAG_SAFETYNET_TAG          0x534e4554
+
+/* how each event is logged */
+typedef struct
+{
+    EAS_INT         severity;           /* _EAS_SEVERITY_ERROR or _EAS_SEVERITY_WARNING */
+    const char      *pBugId;            /* SafetyNet bug, NULL if none */
+    const char      *pFormat;           /* message, with at most one %ld for the argument */
+} S_EAS_DIAG_INFO;
+
+static const S_EAS_DIAG_INFO diagInfo[eDiagNumEvents] =
+{
+    { _EAS_SEVERITY_ERROR, NULL, "unknown diagnostic event %ld" },
+    { _EAS_SEVERITY_ERROR, "26366256", "b/26366256" },
+    { _EAS_SEVERITY_ERROR, "26366256", "b/26366256 numSamples=%ld" },
+    { _EAS_SEVERITY_WARNING, NULL, "phaseIncrement=%ld wrapped to the loop" },
+    { _EAS_SEVERITY_ERROR, "68953854", "SMF_ParseMetaEvent() negative len = %ld" },
+    { _EAS_SEVERITY_ERROR, "68953854", "SMF_ParseMetaEvent() too large len = %ld" },
+    { _EAS_SEVERITY_ERROR, NULL, "EAS_ParseEvents() pfEvent returned %ld" },
+    { _EAS_SEVERITY_ERROR, "68664359", "EAS_ParseEvents() aborting, %ld events. Infinite loop in song file?!" }
+};
+
+/*----------------------------------------------------------------------------
+ * EAS_DiagEmit()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Formats an event and passes it to the callback, or to the Android log
+ * and SafetyNet when there is no callback. May block.
+ *
+ * Inputs:
+ * pfCallback       - receives the message, NULL for the Android log
+ * pUserData        - passed to the callback
+ * event            - the event
+ * arg              - its argument
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_DiagEmit (EAS_DIAG_CALLBACK pfCallback, EAS_VOID_PTR pUserData, EAS_U32 event, EAS_I32 arg)
+{
+    const S_EAS_DIAG_INFO *pInfo;
+    char message[EAS_DIAG_MAX_MESSAGE];
+
+    if ((event == eDiagNone) || (event >= eDiagNumEvents))
+    {
+        arg = (EAS_I32) event;
+        event = eDiagNone;
+    }
+    pInfo = &diagInfo[event];
+    snprintf(message, sizeof(message), pInfo->pFormat, (long) arg);
+
+    if (pfCallback != NULL)
+    {
+        (*pfCallback)(pUserData, pInfo->severity, message);
+        return;
+    }
+
+    if (pInfo->severity == _EAS_SEVERITY_WARNING)
+        ALOGW("%s", message);
+    else
+        ALOGE("%s", message);
+    if (pInfo->pBugId != NULL)
+        android_errorWriteLog(EAS_DIAG_SAFETYNET_TAG, pInfo->pBugId);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_DiagLog()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Logs an event at once. Used for every event without _DIAG_RING.
+ *
+ * Inputs:
+ * event            - the event
+ * arg              - its argument
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_DiagLog (E_EAS_DIAG_EVENT event, EAS_I32 arg)
+{
+    EAS_DiagEmit(NULL, NULL, (EAS_U32) event, arg);
+}
+
+#ifdef _DIAG_RING
+
+/* an event in the ring */
+typedef struct
+{
+    volatile EAS_U32    seq;            /* lap of the position the cell is free for, plus one while full */
+    EAS_U32             event;
+    EAS_I32             arg;
+} S_EAS_DIAG_CELL;
+
+/* the ring, the reader side is protected by the global lock */
+static struct
+{
+    volatile EAS_U32    head;           /* positions claimed by writers */
+    volatile EAS_U32    lost;           /* events posted to a full ring */
+    EAS_U32             tail;           /* positions drained */
+    EAS_U32             lostReported;   /* lost events already reported */
+    S_EAS_DIAG_CELL     cells[EAS_DIAG_RING_SIZE];
+} diagRing;
+
+/*----------------------------------------------------------------------------
+ * EAS_DiagPost()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Posts an event to the ring. Never blocks and may be called from any
+ * number of threads at once.
+ *
+ * Inputs:
+ * event            - the event
+ * arg              - its argument
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_DiagPost (E_EAS_DIAG_EVENT event, EAS_I32 arg)
+{
+    S_EAS_DIAG_CELL *pCell;
+    EAS_U32 pos;
+    EAS_I32 diff;
+
+    pos = EAS_HWAtomicLoad(&diagRing.head);
+    for (;;)
+    {
+        pCell = &diagRing.cells[pos & EAS_DIAG_RING_MASK];
+        diff = (EAS_I32) (EAS_HWAtomicLoad(&pCell->seq) - (pos & ~(EAS_U32) EAS_DIAG_RING_MASK));
+
+        /* the cell is free for this position, try to claim it */
+        if (diff == 0)
+        {
+            if (EAS_HWAtomicCompareSwap(&diagRing.head, pos, pos + 1))
+                break;
+        }
+
+        /* the cell still holds the event of the previous lap */
+        else if (diff < 0)
+        {
+            (void) EAS_HWAtomicAdd(&diagRing.lost, 1);
+            return;
+        }
+
+        /* another writer claimed this position first */
+        pos = EAS_HWAtomicLoad(&diagRing.head);
+    }
+
+    pCell->event = (EAS_U32) event;
+    pCell->arg = arg;
+    EAS_HWAtomicStore(&pCell->seq, (pos & ~(EAS_U32) EAS_DIAG_RING_MASK) + 1);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_DiagDrain()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Removes the events in the ring and logs them, followed by the number of
+ * events lost since the last drain, if any. See EAS_DrainDiagnostics.
+ *
+ * Inputs:
+ * pfCallback       - receives the messages, NULL for the Android log
+ * pUserData        - passed to the callback
+ * pNumEvents       - receives the number of events drained, may be NULL
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_DiagDrain (EAS_DIAG_CALLBACK pfCallback, EAS_VOID_PTR pUserData, EAS_I32 *pNumEvents)
+{
+    S_EAS_DIAG_CELL *pCell;
+    EAS_U32 base;
+    EAS_U32 event;
+    EAS_U32 lost;
+    EAS_I32 arg;
+    EAS_I32 count;
+
+    count = 0;
+    for (;;)
+    {
+        /* take one event at a time, the callback may use the library */
+        EAS_HWGlobalLock();
+        pCell = &diagRing.cells[diagRing.tail & EAS_DIAG_RING_MASK];
+        base = diagRing.tail & ~(EAS_U32) EAS_DIAG_RING_MASK;
+        if (EAS_HWAtomicLoad(&pCell->seq) != base + 1)
+        {
+            EAS_HWGlobalUnlock();
+            break;
+        }
+        event = pCell->event;
+        arg = pCell->arg;
+        EAS_HWAtomicStore(&pCell->seq, base + EAS_DIAG_RING_SIZE);
+        diagRing.tail++;
+        EAS_HWGlobalUnlock();
+
+        EAS_DiagEmit(pfCallback, pUserData, event, arg);
+        count++;
+    }
+
+    /* report the events that did not fit */
+    EAS_HWGlobalLock();
+    lost = EAS_HWAtomicLoad(&diagRing.lost) - diagRing.lostReported;
+    diagRing.lostReported += lost;
+    EAS_HWGlobalUnlock();
+    if (lost)
+    {
+        char message[EAS_DIAG_MAX_MESSAGE];
+        snprintf(message, sizeof(message), "%lu diagnostic events lost", (unsigned long) lost);
+        if (pfCallback != NULL)
+            (*pfCallback)(pUserData, _EAS_SEVERITY_WARNING, message);
+        else
+            ALOGW("%s", message);
+    }
+
+    if (pNumEvents != NULL)
+        *pNumEvents = count;
+    return EAS_SUCCESS;
+}
+
+#endif /* #ifdef _DIAG_RING */
@@ -0,0 +1,79 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_diag.h
+ *
+ * Contents and purpose:
+ * Diagnostics posted by the render path. Writing to the Android log can
+ * block, so with _DIAG_RING the synthesizer only posts an event code and
+ * an argument to a fixed size ring, and EAS_DrainDiagnostics turns them
+ * into log messages later on a thread that may block.
+ *
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_DIAG_H
+#define _EAS_DIAG_H
+
+#include "eas_types.h"
+#include "eas.h"
+
+/* events in the ring, a power of 2 */
+#ifndef EAS_DIAG_RING_SIZE
+#define EAS_DIAG_RING_SIZE              64
+#endif
+#define EAS_DIAG_RING_MASK              (EAS_DIAG_RING_SIZE - 1)
+
+/* longest message passed to a diagnostics callback */
+#define EAS_DIAG_MAX_MESSAGE            96
+
+/* events, see the table in eas_diag.c for their messages */
+typedef enum
+{
+    eDiagNone = 0,
+    eDiagNoSamples,                     /* a voice was rendered with no samples */
+    eDiagSampleEnd,                     /* the samples to the end of a sample were negative */
+    eDiagPhaseIncrement,                /* a phase increment longer than the loop was wrapped */
+    eDiagNegativeLength,                /* SMF meta event or sysex with a negative length */
+    eDiagLargeLength,                   /* SMF meta event or sysex running past the file size limit */
+    eDiagParseError,                    /* a parser failed while rendering */
+    eDiagEventLimit,                    /* too many events in one frame */
+    eDiagNumEvents
+} E_EAS_DIAG_EVENT;
+
+/*----------------------------------------------------------------------------
+ * EAS_DIAG_POST()
+ *----------------------------------------------------------------------------
+ * Reports an event from code that may run on the audio thread. Without
+ * _DIAG_RING the event is logged at once, as it always was.
+ *----------------------------------------------------------------------------
+*/
+#ifdef _DIAG_RING
+#define EAS_DIAG_POST(event, arg)       EAS_DiagPost((event), (EAS_I32) (arg))
+#else
+#define EAS_DIAG_POST(event, arg)       EAS_DiagLog((event), (EAS_I32) (arg))
+#endif
+
+/* prototypes */
+#ifdef _DIAG_RING
+void EAS_DiagPost (E_EAS_DIAG_EVENT event, EAS_I32 arg);
+EAS_RESULT EAS_DiagDrain (EAS_DIAG_CALLBACK pfCallback, EAS_VOID_PTR pUserData, EAS_I32 *pNumEvents);
+#endif
+void EAS_DiagLog (E_EAS_DIAG_EVENT event, EAS_I32 arg);
+
+#endif /* #ifndef _EAS_DIAG_H */
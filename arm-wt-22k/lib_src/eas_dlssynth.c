@@ -173,7 +173,11 @@ static EAS_I32 DLS_UpdatePhaseInc (S_WT_VOICE *pWTVoice, const S_DLS_ARTICULATIO
     pitchCents += FMUL_15x15(pDLSArt->eg2ToPitch, pWTVoice->eg2Value);
 
     /* convert from cents to linear phase increment */
+#ifdef _ARTICULATION_CACHE
+    return WT_Cached2toX(&pWTVoice->cache.pitchCents, &pWTVoice->cache.phaseIncrement, pitchCents);
+#else
     return EAS_Calculate2toX(pitchCents);
+#endif
 }
 
 /*----------------------------------------------------------------------------
@@ -286,6 +290,9 @@ static void DLS_UpdateFilter (S_SYNTH_VOICE *pVoice, S_WT_VOICE *pWTVoice, S_WT_
 
     /* subtract the A5 offset and the sampling frequency */
     cutoff -= FILTER_CUTOFF_FREQ_ADJUST + A5_PITCH_OFFSET_IN_CENTS;
+#ifdef _RUNTIME_SAMPLE_RATE
+    cutoff -= pIntFrame->rateShift * 1200;
+#endif
 
     /* limit the cutoff frequency */
     if (cutoff > FILTER_CUTOFF_MAX_PITCH_CENTS)
@@ -293,7 +300,11 @@ static void DLS_UpdateFilter (S_SYNTH_VOICE *pVoice, S_WT_VOICE *pWTVoice, S_WT_
     else if (cutoff < FILTER_CUTOFF_MIN_PITCH_CENTS)
         cutoff = FILTER_CUTOFF_MIN_PITCH_CENTS;
 
+#ifdef _ARTICULATION_CACHE
+    WT_SetCachedFilterCoeffs(pWTVoice, pIntFrame, cutoff, pDLSArt->filterQandFlags & FILTER_Q_MASK);
+#else
     WT_SetFilterCoeffs(pIntFrame, cutoff, pDLSArt->filterQandFlags & FILTER_Q_MASK);
+#endif
 }
 
 /*----------------------------------------------------------------------------
@@ -344,8 +355,20 @@ EAS_RESULT DLS_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOIC
     pWTVoice->filter.z1 = 0;
     pWTVoice->filter.z2 = 0;
 
-    /* initialize the oscillator */
+    /* initialize the oscillator, DLS samples are never compressed */
+#ifdef _WT_ADPCM
+    pWTVoice->flags = 0;
+#endif
+#ifdef _DLS_LAZY_SAMPLES
+    /* VMStartVoice has loaded the wave */
+    if (pSynth->pDLS->pDLSWaves != NULL)
+        pWTVoice->phaseAccum = (EAS_U32) pSynth->pDLS->pDLSWaves[pDLSRegion->wtRegion.waveIndex].pSamples;
+    else
+#endif
     pWTVoice->phaseAccum = (EAS_U32) pSynth->pDLS->pDLSSamples + pSynth->pDLS->pDLSSampleOffsets[pDLSRegion->wtRegion.waveIndex];
+#ifdef _CUBIC_INTERPOLATION
+    pWTVoice->sampleStart = pWTVoice->phaseAccum;
+#endif
     if (pDLSRegion->wtRegion.region.keyGroupAndFlags & REGION_FLAG_IS_LOOPED)
     {
         pWTVoice->loopStart = pWTVoice->phaseAccum + pDLSRegion->wtRegion.loopStart;
@@ -375,7 +398,7 @@ EAS_RESULT DLS_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOIC
  *
  *----------------------------------------------------------------------------
 */
-EAS_BOOL DLS_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum, EAS_I32 *pMixBuffer, EAS_I32 numSamples)
+EAS_BOOL DLS_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum, EAS_PCM *pVoiceBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSamples)
 {
     S_WT_VOICE *pWTVoice;
     S_SYNTH_CHANNEL *pChannel;
@@ -390,6 +413,12 @@ EAS_BOOL DLS_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     pDLSRegion = &pSynth->pDLS->pDLSRegions[pVoice->regionIndex & REGION_INDEX_MASK];
     pChannel = &pSynth->channels[pVoice->channel & 15];
     pDLSArt = &pSynth->pDLS->pDLSArticulations[pWTVoice->artIndex];
+#ifdef _RUNTIME_SAMPLE_RATE
+    intFrame.rateShift = pVoiceMgr->rateShift;
+#endif
+#ifdef _LOW_LATENCY
+    intFrame.rampOffset = 0;
+#endif
 
     /* update the envelopes */
     DLS_UpdateEnvelope(pVoice, pChannel, &pDLSArt->eg1, &pWTVoice->eg1Value, &pWTVoice->eg1Increment, &pWTVoice->eg1State);
@@ -407,17 +436,30 @@ EAS_BOOL DLS_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     if ((pChannel ->channelFlags & CHANNEL_FLAG_RHYTHM_CHANNEL) == 0)
         temp += pSynth->globalTranspose * 100;
 
+#ifdef _RUNTIME_SAMPLE_RATE
+    /* each doubling of the output rate lowers the increment one octave */
+    temp -= intFrame.rateShift * 1200;
+#endif
+
     /* calculate phase increment including modulation effects */
     intFrame.frame.phaseIncrement = DLS_UpdatePhaseInc(pWTVoice, pDLSArt, pChannel, temp);
 
     /* calculate gain including modulation effects */
     intFrame.frame.gainTarget = DLS_UpdateGain(pWTVoice, pDLSArt, pChannel, pDLSRegion->wtRegion.gain, pVoice->velocity);
     intFrame.prevGain = pVoice->gain;
+#ifdef _CUBIC_INTERPOLATION
+    intFrame.cubic = WT_UseCubic(pVoiceMgr->interpolation, intFrame.frame.gainTarget);
+#endif
 
     DLS_UpdateFilter(pVoice, pWTVoice, &intFrame, pChannel, pDLSArt);
+#ifdef _FILTER_RAMP
+    /* a new note has no earlier coefficients to ramp from */
+    if (pVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)
+        WT_SaveFilterCoeffs(pWTVoice, &intFrame.frame);
+#endif
 
     /* call into engine to generate samples */
-    intFrame.pAudioBuffer = pVoiceMgr->voiceBuffer;
+    intFrame.pAudioBuffer = pVoiceBuffer;
     intFrame.pMixBuffer = pMixBuffer;
     intFrame.numSamples = numSamples;
     if (numSamples < 0)
@@ -427,16 +469,40 @@ EAS_BOOL DLS_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     if ((pWTVoice->loopStart != WT_NOISE_GENERATOR) && (pWTVoice->loopStart == pWTVoice->loopEnd))
         done = WT_CheckSampleEnd(pWTVoice, &intFrame, EAS_FALSE);
 
+#ifdef _LOW_LATENCY
+    /* a sample ending after this slice ends in a later slice of the update period */
+    if (done && (intFrame.numSamples > numSamples) && (pVoice->framePos + numSamples < VM_UPDATE_PERIOD(pVoiceMgr)))
+    {
+        intFrame.numSamples = numSamples;
+        done = EAS_FALSE;
+    }
+#endif
+
+#ifdef _VOICE_CULLING
+    /* voices too quiet to be heard are not rendered */
+    if (WT_CullVoice(pWTVoice, pVoice->gain, intFrame.frame.gainTarget))
+        intFrame.numSamples = 0;
+    if (intFrame.numSamples > 0)
+#endif
     WT_ProcessVoice(pWTVoice, &intFrame);
 
     /* clear flag */
     pVoice->voiceFlags &= ~VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET;
 
+#ifdef _LOW_LATENCY
+    /* the gain reaches its target at the end of the update period */
+    if (!done && WT_StartSlices(pVoiceMgr, pVoice, pWTVoice, &intFrame, numSamples))
+        return EAS_FALSE;
+#endif
+
     /* if the update interval has elapsed, then force the current gain to the next
      * gain since we never actually reach the next gain when ramping -- we just get
      * very close to the target gain.
      */
     pVoice->gain = (EAS_I16) intFrame.frame.gainTarget;
+#ifdef _FILTER_RAMP
+    WT_SaveFilterCoeffs(pWTVoice, &intFrame.frame);
+#endif
 
     /* if voice has finished, set flag for voice manager */
     if ((pVoice->voiceState != eVoiceStateStolen) && (pWTVoice->eg1State == eEnvelopeStateMuted))
@@ -490,6 +556,13 @@ static void DLS_UpdateEnvelope (S_SYNTH_VOICE *pVoice, S_SYNTH_CHANNEL *pChannel
             *pState = eEnvelopeStateAttack;
             if (pEnvParams->attackTime != ZERO_TIME_IN_CENTS)
             {
+#ifdef _DLS_ENVELOPE_RATES
+                if (pEnvParams->velToAttack == 0)
+                {
+                    *pIncrement = pEnvParams->attackRate;
+                    return;
+                }
+#endif
                 /*lint -e{702} use shift for performance */
                 temp = pEnvParams->attackTime + ((pEnvParams->velToAttack * pVoice->velocity) >> 7);
                 *pIncrement = ConvertRate(temp);
@@ -511,6 +584,13 @@ static void DLS_UpdateEnvelope (S_SYNTH_VOICE *pVoice, S_SYNTH_CHANNEL *pChannel
             *pState = eEnvelopeStateHold;
             if (pEnvParams->holdTime != ZERO_TIME_IN_CENTS)
             {
+#ifdef _DLS_ENVELOPE_RATES
+                if (pEnvParams->keyNumToHold == 0)
+                {
+                    *pIncrement = pEnvParams->holdFrames;
+                    return;
+                }
+#endif
                 /*lint -e{702} use shift for performance */
                 temp = pEnvParams->holdTime + ((pEnvParams->keyNumToHold * pVoice->note) >> 7);
                 *pIncrement = ConvertDelay(temp);
@@ -531,6 +611,13 @@ static void DLS_UpdateEnvelope (S_SYNTH_VOICE *pVoice, S_SYNTH_CHANNEL *pChannel
             *pState = eEnvelopeStateDecay;
             if (pEnvParams->decayTime != ZERO_TIME_IN_CENTS)
             {
+#ifdef _DLS_ENVELOPE_RATES
+                if (pEnvParams->keyNumToDecay == 0)
+                {
+                    *pIncrement = pEnvParams->decayRate;
+                    return;
+                }
+#endif
                 /*lint -e{702} use shift for performance */
                 temp = pEnvParams->decayTime + ((pEnvParams->keyNumToDecay * pVoice->note) >> 7);
                 *pIncrement = ConvertRate(temp);
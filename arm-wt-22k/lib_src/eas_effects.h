@@ -31,6 +31,7 @@
 #define _EAS_EFFECTS_H
 
 #include "eas_types.h"
+#include "eas.h"
 
 typedef struct
 {
@@ -39,16 +40,10 @@ typedef struct
     EAS_RESULT  (*pfShutdown)(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
     EAS_RESULT  (*pFGetParam)(EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue);
     EAS_RESULT  (*pFSetParam)(EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value);
+    void        (*pfReset)(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);  /* back to the state after pfInit, may be NULL */
 } S_EFFECTS_INTERFACE;
 
-typedef struct
-{
-    EAS_RESULT  (*pfInit)(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData);
-    void        (*pfProcess)(EAS_VOID_PTR pInstData, EAS_I32 *in, EAS_I32 *out, EAS_I32 numSamples);
-    EAS_RESULT  (*pfShutdown)(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
-    EAS_RESULT  (*pFGetParam)(EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue);
-    EAS_RESULT  (*pFSetParam)(EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value);
-} S_EFFECTS32_INTERFACE;
+/* S_EFFECTS32_INTERFACE is in eas_types.h, applications implement it for EAS_AddInsert */
 
 /* mixer instance data */
 typedef struct
@@ -57,5 +52,27 @@ typedef struct
     EAS_VOID_PTR        effectData;
 } S_EFFECTS_MODULE;
 
+#ifdef _INSERT_EFFECTS
+/* one slot of an insert chain, the slot is free while effect is NULL */
+typedef struct
+{
+    const S_EFFECTS32_INTERFACE *effect;
+    EAS_VOID_PTR        effectData;
+    EAS_BOOL            bypass;
+} S_INSERT_EFFECT;
+
+/*
+ * Inserts run in slot order. Only the slots in use and not bypassed are in
+ * pActive, so a chain with every insert bypassed costs a single test.
+ */
+typedef struct s_insert_chain_tag
+{
+    S_INSERT_EFFECT     inserts[EAS_MAX_INSERTS];
+    S_INSERT_EFFECT     *pActive[EAS_MAX_INSERTS];
+    EAS_I32             *pBuffer;       /* mix of the stream's voices, NULL for the master chain */
+    EAS_INT             numActive;
+} S_INSERT_CHAIN;
+#endif
+
 #endif /* end _EAS_EFFECTS_H */
 
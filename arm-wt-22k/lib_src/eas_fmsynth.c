@@ -0,0 +1,946 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_fmsynth.c
+ *
+ * Contents and purpose:
+ * The FM fallback engine. Each voice is a sine carrier phase modulated by
+ * a sine or noise modulator with feedback, with an envelope per operator
+ * and a vibrato LFO stepped once per update period. The whole engine is a
+ * few small tables and the patch set below, so it stays in the data cache
+ * where a wavetable voice streams its samples through it.
+ *
+ * The wavetable synth hands the voices whose region index carries
+ * FLAG_RGN_IDX_FM_SYNTH to this engine, so FM and wavetable voices share
+ * the voice pool and a synth may mix both, one engine per channel.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+/*------------------------------------
+ * includes
+ *------------------------------------
+*/
+#include "eas_data.h"
+#include "eas_math.h"
+#include "eas_mixer.h"
+#include "eas_pan.h"
+#include "eas_fmengine.h"
+
+#ifdef _FM_FALLBACK
+
+/* frequency of MIDI note 0 in Hz, << 32 */
+#define FM_NOTE0_FREQ                   ((uint64_t) 35114788961)
+
+/* phase increment of MIDI note 0 at the compiled output rate */
+#define FM_NOTE0_PHASE_INC              ((uint32_t) (FM_NOTE0_FREQ / _OUTPUT_SAMPLE_RATE))
+
+/* highest operator pitch in cents, below half the sample rate */
+#define FM_MAX_CENTS                    12400
+
+/* vibrato of about 5.5 Hz, the LFO is stepped once per update period */
+#define FM_LFO_PHASE_INC                2092
+
+/* envelope values below this are silent */
+#define FM_EG_SILENCE                   16
+
+/* noise generator */
+#define FM_NOISE_SEED                   0x5eed1234
+#define FM_NEXT_NOISE(n)                ((n) * 1664525 + 1013904223)
+
+#ifdef _RUNTIME_SAMPLE_RATE
+#define FM_UPDATE_PERIOD_IN_BITS(pVoiceMgr)     (SYNTH_UPDATE_PERIOD_IN_BITS + (pVoiceMgr)->rateShift)
+#else
+#define FM_UPDATE_PERIOD_IN_BITS(pVoiceMgr)     SYNTH_UPDATE_PERIOD_IN_BITS
+#endif
+
+/*----------------------------------------------------------------------------
+ * fmSine
+ *
+ * One cycle of a sine, the extra entry lets the interpolation read past
+ * the end of the cycle
+ *----------------------------------------------------------------------------
+*/
+static const EAS_I16 fmSine[257] =
+{
+         0,    804,   1608,   2410,   3212,   4011,   4808,   5602,   6393,   7179,   7962,   8739,
+      9512,  10278,  11039,  11793,  12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+     18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,  23170,  23731,  24279,  24811,
+     25329,  25832,  26319,  26790,  27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+     30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,  32137,  32285,  32412,  32521,
+     32609,  32678,  32728,  32757,  32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+     32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,  30273,  29956,  29621,  29268,
+     28898,  28510,  28105,  27683,  27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+     23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,  18204,  17530,  16846,  16151,
+     15446,  14732,  14010,  13279,  12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+      6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,      0,   -804,  -1608,  -2410,
+     -3212,  -4011,  -4808,  -5602,  -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159,
+    -20787, -21403, -22005, -22594, -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+    -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580,
+    -31356, -31113, -30852, -30571, -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731, -23170, -22594, -22005, -21403,
+    -20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,  -6393,  -5602,  -4808,  -4011,
+     -3212,  -2410,  -1608,   -804,      0
+};
+
+/*----------------------------------------------------------------------------
+ * fmAttackStep
+ *
+ * Linear attack step per update period of about 5.8 ms, 32767 is instant.
+ * Rate 1 takes 6 ms and each rate is about 1.5 times slower.
+ *----------------------------------------------------------------------------
+*/
+static const EAS_I16 fmAttackStep[16] =
+{
+     32767,  31702,  21355,  14385,   9690,   6527,   4397,   2962,
+      1995,   1344,    905,    610,    411,    277,    186,    126
+};
+
+/*----------------------------------------------------------------------------
+ * fmDecayRate
+ *
+ * Exponential decay and release multiplier per update period, rate 0 falls
+ * 60 dB in 25 ms and each rate takes about 1.5 times longer
+ *----------------------------------------------------------------------------
+*/
+static const EAS_I16 fmDecayRate[16] =
+{
+      6589,  11540,  16616,  21065,  24580,  27177,  29013,  30273,
+     31122,  31687,  32061,  32306,  32467,  32572,  32640,  32685
+};
+
+/*----------------------------------------------------------------------------
+ * fmPatches
+ *
+ * The melodic patches, one region each, followed by the GM drum kit.
+ * Operators are { tuning, attack, decay, release, sustain, level, flags },
+ * the modulator first.
+ *----------------------------------------------------------------------------
+*/
+const S_FM_PATCH fmPatches[] =
+{
+    /* 0: acoustic piano */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {     0,  0,  9,  5,   0,  80, 0 },
+          {     0,  0, 12,  6,   0, 220, 0 } } },
+    /* 1: electric piano */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {  4569,  0,  5,  5,   0,  50, 0 },
+          {     0,  0, 11,  6,   0, 220, 0 } } },
+    /* 2: harpsichord, clavinet */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 3, 0,
+        { {  1200,  0,  8,  3,  40, 120, 0 },
+          {     0,  0, 10,  3,   0, 200, 0 } } },
+    /* 3: bells */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {  2169,  0,  9,  8,   0,  90, 0 },
+          {     0,  0, 12,  9,   0, 200, 0 } } },
+    /* 4: marimba, xylophone */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {  2400,  0,  4,  4,   0,  70, 0 },
+          {     0,  0,  8,  6,   0, 230, 0 } } },
+    /* 5: organ */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 2, 0,
+        { {  1200,  0,  0,  2, 255,  50, 0 },
+          {     0,  1,  0,  2, 255, 170, 0 } } },
+    /* 6: acoustic guitar */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 1, 0,
+        { {     0,  0,  7,  4,  20,  90, 0 },
+          {     0,  0, 11,  5,   0, 210, 0 } } },
+    /* 7: electric guitar */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 2, 0,
+        { {  1200,  0,  8,  4,  30,  80, 0 },
+          {     0,  0, 11,  5,   0, 200, 0 } } },
+    /* 8: overdriven guitar */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 6, 0,
+        { {     0,  0,  0,  3, 255, 140, 0 },
+          {     0,  0, 13,  4, 180, 190, 0 } } },
+    /* 9: bass */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {     0,  0,  6,  3,  30,  80, 0 },
+          {     0,  0, 10,  3,  60, 230, 0 } } },
+    /* 10: synth bass */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 5, 0,
+        { {     0,  0,  5,  3,  60, 120, 0 },
+          {     0,  0,  9,  3, 150, 220, 0 } } },
+    /* 11: strings */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 3, 0,
+        { {     0,  9,  0,  6, 255,  60, 0 },
+          {     0,  9,  0,  7, 255, 190, 0 } } },
+    /* 12: pizzicato, harp */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {     0,  0,  6,  5,   0,  60, 0 },
+          {     0,  0, 10,  7,   0, 210, 0 } } },
+    /* 13: timpani */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {   702,  0,  7,  7,   0,  60, 0 },
+          {     0,  0, 12,  9,   0, 230, 0 } } },
+    /* 14: choir */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {  1200, 10,  0,  7, 255,  30, 0 },
+          {     0, 10,  0,  8, 255, 180, 0 } } },
+    /* 15: orchestra hit */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 5, 0,
+        { {     0,  0,  7,  4,   0, 150, 0 },
+          {     0,  0,  8,  4,   0, 230, 0 } } },
+    /* 16: brass */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 4, 0,
+        { {     0,  6,  6,  4, 170, 110, 0 },
+          {     0,  4,  0,  4, 255, 200, 0 } } },
+    /* 17: saxophone, free reeds */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 3, 0,
+        { {     0,  5,  0,  4, 255,  80, 0 },
+          {     0,  4,  0,  4, 255, 200, 0 } } },
+    /* 18: double reeds, clarinet */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {  1200,  4,  0,  4, 255,  70, 0 },
+          {     0,  4,  0,  4, 255, 190, 0 } } },
+    /* 19: pipes */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {     0,  6,  0,  5, 255,  20, 0 },
+          {     0,  6,  0,  5, 255, 190, 0 } } },
+    /* 20: square lead */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {  1200,  0,  0,  3, 255,  90, 0 },
+          {     0,  0,  0,  3, 255, 180, 0 } } },
+    /* 21: sawtooth lead */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 7, 0,
+        { {     0,  0,  0,  3, 255, 100, 0 },
+          {     0,  0,  0,  3, 255, 180, 0 } } },
+    /* 22: pad */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 2, 0,
+        { {     0, 11,  0, 10, 255,  40, 0 },
+          {     0, 11,  0, 11, 255, 180, 0 } } },
+    /* 23: synth effects */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {  2169,  8, 12, 10,   0,  80, 0 },
+          {     0,  8, 13, 11,   0, 180, 0 } } },
+    /* 24: plucked ethnic */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 4, 0,
+        { {  1902,  0,  6,  4,   0, 110, 0 },
+          {     0,  0, 10,  5,   0, 200, 0 } } },
+    /* 25: kalimba */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {  2400,  0,  3,  5,   0,  60, 0 },
+          {     0,  0,  9,  6,   0, 220, 0 } } },
+    /* 26: bagpipe, fiddle, shanai */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 5, 0,
+        { {     0,  3,  0,  4, 255, 100, 0 },
+          {     0,  3,  0,  4, 255, 180, 0 } } },
+    /* 27: steel drums, agogo */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {  1720,  0,  6,  6,   0,  80, 0 },
+          {     0,  0,  9,  7,   0, 210, 0 } } },
+    /* 28: woodblock */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {  1200,  0,  2,  2,   0,  60, 0 },
+          {     0,  0,  4,  3,   0, 220, 0 } } },
+    /* 29: taiko, toms */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {     0,  0,  4,  4,   0,  50, 0 },
+          {     0,  0,  8,  6,   0, 230, 0 } } },
+    /* 30: noise effects */
+    { { REGION_FLAG_LAST_REGION, 0, 127 }, 0, 0,
+        { {     0,  0,  0,  6, 255,   0, FM_OPER_FLAG_NOISE },
+          {     0,  6,  0,  8, 255, 150, FM_OPER_FLAG_NOISE } } },
+    /* 31: bass drums */
+    { { 0, 35, 36 }, 0, 0,
+        { {  4500,  0,  2,  2,   0,  80, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO },
+          {  3300,  0,  6,  6,   0, 255, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 32: side stick */
+    { { 0, 37, 37 }, 0, 0,
+        { {     0,  0,  1,  1,   0,  60, FM_OPER_FLAG_NOISE },
+          {  7600,  0,  2,  2,   0, 200, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 33: snares, hand clap */
+    { { 0, 38, 40 }, 0, 0,
+        { {     0,  0,  6,  5,   0, 140, FM_OPER_FLAG_NOISE },
+          {  5500,  0,  5,  5,   0, 210, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 34: low floor tom */
+    { { 0, 41, 41 }, 0, 0,
+        { {     0,  0,  4,  4,   0,  50, FM_OPER_FLAG_NO_VIBRATO },
+          {     0,  0,  8,  6,   0, 230, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 35: closed hi-hat */
+    { { 0x0100, 42, 42 }, 0, 0,
+        { {     0,  0,  0,  0,   0,   0, 0 },
+          {     0,  0,  2,  2,   0, 120, FM_OPER_FLAG_NOISE } } },
+    /* 36: high floor tom */
+    { { 0, 43, 43 }, 0, 0,
+        { {     0,  0,  4,  4,   0,  50, FM_OPER_FLAG_NO_VIBRATO },
+          {     0,  0,  8,  6,   0, 230, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 37: pedal hi-hat */
+    { { 0x0100, 44, 44 }, 0, 0,
+        { {     0,  0,  0,  0,   0,   0, 0 },
+          {     0,  0,  2,  2,   0,  90, FM_OPER_FLAG_NOISE } } },
+    /* 38: low tom */
+    { { 0, 45, 45 }, 0, 0,
+        { {     0,  0,  4,  4,   0,  50, FM_OPER_FLAG_NO_VIBRATO },
+          {     0,  0,  8,  6,   0, 230, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 39: open hi-hat */
+    { { 0x0100, 46, 46 }, 0, 0,
+        { {     0,  0,  0,  0,   0,   0, 0 },
+          {     0,  0,  8,  4,   0, 110, FM_OPER_FLAG_NOISE } } },
+    /* 40: mid toms */
+    { { 0, 47, 48 }, 0, 0,
+        { {     0,  0,  4,  4,   0,  50, FM_OPER_FLAG_NO_VIBRATO },
+          {     0,  0,  8,  6,   0, 230, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 41: crash cymbal 1 */
+    { { 0, 49, 49 }, 0, 0,
+        { {     0,  0,  0,  0,   0,   0, 0 },
+          {     0,  0, 11,  8,   0, 130, FM_OPER_FLAG_NOISE } } },
+    /* 42: high tom */
+    { { 0, 50, 50 }, 0, 0,
+        { {     0,  0,  4,  4,   0,  50, FM_OPER_FLAG_NO_VIBRATO },
+          {     0,  0,  8,  6,   0, 230, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 43: ride cymbal 1 */
+    { { 0, 51, 51 }, 0, 0,
+        { { 10569,  0, 10,  8,   0, 140, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO },
+          {  8400,  0, 10,  8,   0, 110, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 44: chinese cymbal */
+    { { 0, 52, 52 }, 0, 0,
+        { {     0,  0,  0,  0,   0,   0, 0 },
+          {     0,  0, 10,  8,   0, 130, FM_OPER_FLAG_NOISE } } },
+    /* 45: ride bell */
+    { { 0, 53, 53 }, 0, 0,
+        { { 10969,  0,  8,  8,   0,  80, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO },
+          {  8800,  0,  9,  8,   0, 150, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 46: tambourine */
+    { { 0, 54, 54 }, 0, 0,
+        { {     0,  0,  0,  0,   0,   0, 0 },
+          {     0,  0,  4,  4,   0, 100, FM_OPER_FLAG_NOISE } } },
+    /* 47: splash cymbal */
+    { { 0, 55, 55 }, 0, 0,
+        { {     0,  0,  0,  0,   0,   0, 0 },
+          {     0,  0,  8,  6,   0, 120, FM_OPER_FLAG_NOISE } } },
+    /* 48: cowbell */
+    { { 0, 56, 56 }, 0, 0,
+        { {  8580,  0,  5,  5,   0,  60, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO },
+          {  7900,  0,  5,  5,   0, 170, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 49: crash cymbal 2 */
+    { { 0, 57, 57 }, 0, 0,
+        { {     0,  0,  0,  0,   0,   0, 0 },
+          {     0,  0, 11,  8,   0, 130, FM_OPER_FLAG_NOISE } } },
+    /* 50: vibraslap */
+    { { 0, 58, 58 }, 0, 0,
+        { {     0,  0,  8,  6,   0,  90, FM_OPER_FLAG_NOISE },
+          {  7000,  0,  8,  6,   0, 150, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 51: ride cymbal 2 */
+    { { 0, 59, 59 }, 0, 0,
+        { { 10569,  0, 10,  8,   0, 140, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO },
+          {  8400,  0, 10,  8,   0, 110, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 52: bongos, congas */
+    { { 0, 60, 64 }, 0, 0,
+        { {     0,  0,  3,  3,   0,  40, FM_OPER_FLAG_NO_VIBRATO },
+          {  1200,  0,  5,  5,   0, 200, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 53: timbales */
+    { { 0, 65, 66 }, 0, 0,
+        { {  2169,  0,  4,  4,   0,  30, FM_OPER_FLAG_NO_VIBRATO },
+          {  1200,  0,  6,  6,   0, 190, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 54: agogos */
+    { { 0, 67, 68 }, 0, 0,
+        { {  3369,  0,  6,  6,   0,  70, FM_OPER_FLAG_NO_VIBRATO },
+          {  1200,  0,  7,  7,   0, 150, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 55: cabasa, maracas */
+    { { 0, 69, 70 }, 0, 0,
+        { {     0,  0,  0,  0,   0,   0, 0 },
+          {     0,  0,  3,  3,   0,  90, FM_OPER_FLAG_NOISE } } },
+    /* 56: whistles */
+    { { 0x0400, 71, 72 }, 0, 0,
+        { {     0,  0,  0,  0,   0,   0, 0 },
+          {  2400,  2,  0,  3, 255, 120, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 57: guiros */
+    { { 0x0500, 73, 74 }, 0, 0,
+        { {     0,  0,  6,  4,   0, 110, FM_OPER_FLAG_NOISE },
+          {  1200,  0,  6,  4,   0, 120, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 58: claves, wood blocks */
+    { { 0, 75, 77 }, 0, 0,
+        { {  3102,  0,  2,  2,   0,  30, FM_OPER_FLAG_NO_VIBRATO },
+          {  1200,  0,  3,  3,   0, 200, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 59: cuicas */
+    { { 0x0300, 78, 79 }, 0, 0,
+        { {  1200,  0,  5,  5,   0,  60, FM_OPER_FLAG_NO_VIBRATO },
+          {     0,  0,  5,  5,   0, 170, FM_OPER_FLAG_NO_VIBRATO } } },
+    /* 60: triangles */
+    { { 0x0200 | REGION_FLAG_LAST_REGION, 80, 81 }, 0, 0,
+        { { 12169,  0,  8,  8,   0,  50, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO },
+          { 10000,  0,  8,  8,   0, 130, FM_OPER_FLAG_MONOTONE | FM_OPER_FLAG_NO_VIBRATO } } }
+};
+
+/*----------------------------------------------------------------------------
+ * fmProgramPatch
+ *
+ * Melodic patch of each GM program
+ *----------------------------------------------------------------------------
+*/
+const EAS_U8 fmProgramPatch[128] =
+{
+     0,  0,  0,  0,  1,  1,  2,  2,  3,  3,  3,  3,  4,  4,  3, 24,   /* 0-15 */
+     5,  5,  5,  5,  5, 17, 17, 17,  6,  6,  7,  7,  7,  8,  8,  3,   /* 16-31 */
+     9,  9,  9,  9,  9,  9, 10, 10, 11, 11, 11, 11, 11, 12, 12, 13,   /* 32-47 */
+    11, 11, 11, 11, 14, 14, 14, 15, 16, 16, 16, 16, 16, 16, 16, 16,   /* 48-63 */
+    17, 17, 17, 17, 18, 18, 18, 18, 19, 19, 19, 19, 19, 19, 19, 19,   /* 64-79 */
+    20, 21, 19, 19,  8, 14, 21, 10, 22, 22, 22, 22, 22, 22, 22, 22,   /* 80-95 */
+    23, 23, 23, 23, 23, 23, 23, 23, 24, 24, 24, 24, 25, 26, 26, 26,   /* 96-111 */
+     3, 27, 27, 28, 29, 29, 29, 30, 30, 30, 30, 30,  3, 30, 30, 30   /* 112-127 */
+};
+
+/*----------------------------------------------------------------------------
+ * FM_Sine()
+ *----------------------------------------------------------------------------
+ * Returns the sine of a phase, a full cycle is 2^32
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE EAS_I32 FM_Sine (uint32_t phase)
+{
+    EAS_I32 index;
+    EAS_I32 frac;
+
+    index = (EAS_I32) (phase >> 24);
+    frac = (EAS_I32) ((phase >> 9) & 0x7fff);
+    /*lint -e{704} <avoid divide>*/
+    return fmSine[index] + (((fmSine[index + 1] - fmSine[index]) * frac) >> 15);
+}
+
+/*----------------------------------------------------------------------------
+ * FM_PhaseInc()
+ *----------------------------------------------------------------------------
+ * Returns the phase increment of a pitch in cents above MIDI note 0
+ *----------------------------------------------------------------------------
+*/
+static uint32_t FM_PhaseInc (EAS_I32 cents)
+{
+    if (cents > FM_MAX_CENTS)
+        cents = FM_MAX_CENTS;
+    return (uint32_t) (((uint64_t) EAS_Calculate2toX(cents) * FM_NOTE0_PHASE_INC) >> 15);
+}
+
+/*----------------------------------------------------------------------------
+ * FM_UpdateEG()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Steps the envelope of an operator by one update period
+ *
+ * Inputs:
+ * pFMVoice - pointer to the FM voice
+ * oper - FM_MODULATOR or FM_CARRIER
+ * pOper - the operator of the patch
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void FM_UpdateEG (S_FM_VOICE *pFMVoice, EAS_INT oper, const S_FM_PATCH_OPER *pOper)
+{
+    EAS_I32 temp;
+    EAS_I32 sustain;
+
+    temp = pFMVoice->egValue[oper];
+    switch (pFMVoice->egState[oper])
+    {
+        case eEnvelopeStateAttack:
+            temp += fmAttackStep[pOper->attack & 15];
+            if (temp >= SYNTH_FULL_SCALE_EG1_GAIN)
+            {
+                temp = SYNTH_FULL_SCALE_EG1_GAIN;
+                pFMVoice->egState[oper] = eEnvelopeStateDecay;
+            }
+            break;
+
+        case eEnvelopeStateDecay:
+            temp = MULT_EG1_EG1(temp, fmDecayRate[pOper->decay & 15]);
+            sustain = (EAS_I32) pOper->sustain << 7;
+            if (temp <= sustain)
+            {
+                /* a sustain level of zero ends the note */
+                temp = sustain;
+                if (temp > 0)
+                    pFMVoice->egState[oper] = eEnvelopeStateSustain;
+                else
+                    pFMVoice->egState[oper] = eEnvelopeStateMuted;
+            }
+            break;
+
+        case eEnvelopeStateSustain:
+            return;
+
+        case eEnvelopeStateRelease:
+            temp = MULT_EG1_EG1(temp, fmDecayRate[pOper->release & 15]);
+            if (temp < FM_EG_SILENCE)
+            {
+                temp = 0;
+                pFMVoice->egState[oper] = eEnvelopeStateMuted;
+            }
+            break;
+
+        default:
+            temp = 0;
+            break;
+    }
+    pFMVoice->egValue[oper] = (EAS_I16) temp;
+}
+
+/*----------------------------------------------------------------------------
+ * FM_UpdateControl()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Calculates the pitch, modulation index and gain of a voice for the
+ * update period that is starting
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pSynth - pointer to the synth
+ * pVoice - pointer to the voice
+ * pFMVoice - pointer to the FM voice
+ * pPatch - the patch of the voice
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void FM_UpdateControl (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, S_FM_VOICE *pFMVoice, const S_FM_PATCH *pPatch)
+{
+    const S_FM_PATCH_OPER *pOper;
+    S_SYNTH_CHANNEL *pChannel;
+    EAS_I32 notePitch;
+    EAS_I32 vibrato;
+    EAS_I32 pitch;
+    EAS_I32 temp;
+    EAS_INT oper;
+
+    pChannel = &pSynth->channels[pVoice->channel & 15];
+
+    /* the triangle LFO, scaled by the mod wheel and channel pressure as for wavetable voices */
+    pFMVoice->lfoPhase = (EAS_U16) (pFMVoice->lfoPhase + FM_LFO_PHASE_INC);
+    temp = pFMVoice->lfoPhase;
+    if (temp >= 0x8000)
+        temp = 0xffff - temp;
+    temp = temp * 2 - 32767;
+    vibrato = MULT_EG1_EG1(DEFAULT_LFO_MOD_WHEEL_TO_PITCH_CENTS, (pChannel->modWheel) << (NUM_EG1_FRAC_BITS - 7));
+    vibrato += MULT_EG1_EG1(DEFAULT_LFO_CHANNEL_PRESSURE_TO_PITCH_CENTS, (pChannel->channelPressure) << (NUM_EG1_FRAC_BITS - 7));
+    vibrato = MULT_EG1_EG1(temp, vibrato);
+
+    /* base pitch, global transpose does not apply to drums */
+    pitch = pChannel->staticPitch;
+#ifdef _RUNTIME_SAMPLE_RATE
+    /* each doubling of the output rate lowers the increment one octave */
+    pitch -= pVoiceMgr->rateShift * 1200;
+#endif
+    if (pChannel->channelFlags & CHANNEL_FLAG_RHYTHM_CHANNEL)
+        notePitch = pVoice->note * 100;
+    else
+        notePitch = (pVoice->note + pSynth->globalTranspose) * 100;
+
+    for (oper = 0; oper < FM_NUM_OPERATORS; oper++)
+    {
+        pOper = &pPatch->oper[oper];
+        FM_UpdateEG(pFMVoice, oper, pOper);
+
+        temp = pitch + pOper->tuning;
+        if ((pOper->flags & FM_OPER_FLAG_MONOTONE) == 0)
+            temp += notePitch;
+        if ((pOper->flags & FM_OPER_FLAG_NO_VIBRATO) == 0)
+            temp += vibrato;
+        pFMVoice->phaseInc[oper] = FM_PhaseInc(temp);
+    }
+
+    /* the modulation index follows the modulator envelope and brightens with velocity */
+    pOper = &pPatch->oper[FM_MODULATOR];
+    temp = MULT_EG1_EG1(pFMVoice->egValue[FM_MODULATOR], (EAS_I32) pOper->level << 7);
+    /*lint -e{704} <avoid divide>*/
+    temp = (temp * (pVoice->velocity + 64)) >> 7;
+    if (temp > SYNTH_FULL_SCALE_EG1_GAIN)
+        temp = SYNTH_FULL_SCALE_EG1_GAIN;
+    pFMVoice->modTarget = (EAS_I16) temp;
+
+    /* velocity squared, carrier level, channel gain and carrier envelope */
+    pOper = &pPatch->oper[FM_CARRIER];
+    temp = (pVoice->velocity) << (NUM_EG1_FRAC_BITS - 7);
+    temp = MULT_EG1_EG1(temp, temp);
+    temp = MULT_EG1_EG1(temp, (EAS_I32) pOper->level << 7);
+    temp = MULT_EG1_EG1(temp, pChannel->staticGain);
+    temp = MULT_EG1_EG1(temp, pFMVoice->egValue[FM_CARRIER]);
+    pFMVoice->gainTarget = (EAS_I16) temp;
+}
+
+/*----------------------------------------------------------------------------
+ * FM_Synthesize()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Synthesizes samples of a voice and adds them to the mix buffer. The gain
+ * and the modulation index ramp to their targets over the update period,
+ * rampOffset samples of which have already been synthesized.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pVoice - pointer to the voice
+ * pFMVoice - pointer to the FM voice
+ * pPatch - the patch of the voice
+ * pMixBuffer - mix buffer
+ * numSamples - number of samples
+ * rampOffset - position in the update period
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void FM_Synthesize (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice, S_FM_VOICE *pFMVoice, const S_FM_PATCH *pPatch,
+    EAS_I32 *pMixBuffer, EAS_I32 numSamples, EAS_I32 rampOffset)
+{
+    EAS_I32 gain;
+    EAS_I32 gainIncrement;
+    EAS_I32 modIndex;
+    EAS_I32 modIncrement;
+    EAS_I32 mod;
+    EAS_I32 prevMod;
+    EAS_I32 out;
+    uint32_t modPhase;
+    uint32_t carPhase;
+    uint32_t modPhaseInc;
+    uint32_t carPhaseInc;
+    uint32_t feedback;
+    uint32_t noise;
+    EAS_BOOL modNoise;
+    EAS_BOOL carNoise;
+    EAS_INT periodBits;
+#if (NUM_OUTPUT_CHANNELS == 2)
+    EAS_I32 gainLeft;
+    EAS_I32 gainRight;
+
+    gainLeft = pFMVoice->gainLeft;
+    gainRight = pFMVoice->gainRight;
+#endif
+
+    periodBits = FM_UPDATE_PERIOD_IN_BITS(pVoiceMgr);
+    gainIncrement = (pFMVoice->gainTarget - pVoice->gain) * (1 << (16 - periodBits));
+    if (gainIncrement < 0)
+        gainIncrement++;
+    gain = pVoice->gain * (1 << 16) + gainIncrement * rampOffset;
+    modIncrement = (pFMVoice->modTarget - pFMVoice->modIndex) * (1 << (16 - periodBits));
+    if (modIncrement < 0)
+        modIncrement++;
+    modIndex = pFMVoice->modIndex * (1 << 16) + modIncrement * rampOffset;
+
+    modPhase = pFMVoice->phase[FM_MODULATOR];
+    carPhase = pFMVoice->phase[FM_CARRIER];
+    modPhaseInc = pFMVoice->phaseInc[FM_MODULATOR];
+    carPhaseInc = pFMVoice->phaseInc[FM_CARRIER];
+    noise = pFMVoice->noise;
+    modNoise = (EAS_BOOL) ((pPatch->oper[FM_MODULATOR].flags & FM_OPER_FLAG_NOISE) != 0);
+    carNoise = (EAS_BOOL) ((pPatch->oper[FM_CARRIER].flags & FM_OPER_FLAG_NOISE) != 0);
+
+    /* the feedback is the average of the last two modulator samples, pi at feedback 7 */
+    feedback = pPatch->feedback ? (uint32_t) 1 << ((pPatch->feedback & 7) + 8) : 0;
+    mod = pFMVoice->feedback;
+    prevMod = mod;
+
+    while (numSamples--)
+    {
+        if (modNoise || carNoise)
+            noise = FM_NEXT_NOISE(noise);
+
+        /* modulator */
+        if (modNoise)
+            mod = (EAS_I16) (noise >> 16);
+        else
+        {
+            out = mod;
+            mod = FM_Sine(modPhase + (uint32_t) (mod + prevMod) * feedback);
+            prevMod = out;
+        }
+
+        /* carrier, an index of 32767 is a phase deviation of pi */
+        modIndex += modIncrement;
+        if (carNoise)
+            out = (EAS_I16) (noise >> 16);
+        else
+            out = FM_Sine(carPhase + (uint32_t) (mod * (modIndex >> 16)) * 2);
+
+        /* scale by the gain, incrementally to prevent zipper noise */
+        gain += gainIncrement;
+        /*lint -e{704} <avoid divide>*/
+        out = (out * (gain >> 16)) >> 17;
+
+#if (NUM_OUTPUT_CHANNELS == 2)
+        /*lint -e{704} <avoid divide>*/
+        pMixBuffer[0] += (out * gainLeft) >> NUM_MIXER_GUARD_BITS;
+        /*lint -e{704} <avoid divide>*/
+        pMixBuffer[1] += (out * gainRight) >> NUM_MIXER_GUARD_BITS;
+        pMixBuffer += 2;
+#else
+        /*lint -e{704} <avoid divide>*/
+        *pMixBuffer++ += out >> (NUM_MIXER_GUARD_BITS - 1);
+#endif
+
+        modPhase += modPhaseInc;
+        carPhase += carPhaseInc;
+    }
+
+    pFMVoice->phase[FM_MODULATOR] = modPhase;
+    pFMVoice->phase[FM_CARRIER] = carPhase;
+    pFMVoice->noise = noise;
+    pFMVoice->feedback = (EAS_I16) mod;
+}
+
+/*----------------------------------------------------------------------------
+ * FM_StartVoice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Starts a note on an FM voice
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pSynth - pointer to the synth
+ * pVoice - pointer to the voice
+ * voiceNum - voice number
+ * regionIndex - FM region of the note
+ *
+ * Outputs:
+ * EAS_SUCCESS
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT FM_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum, EAS_U16 regionIndex)
+{
+    S_FM_VOICE *pFMVoice;
+    EAS_INT oper;
+#if (NUM_OUTPUT_CHANNELS == 2)
+    EAS_INT pan;
+#endif
+
+    pFMVoice = &pVoiceMgr->fmVoices[voiceNum];
+    pVoice->regionIndex = regionIndex;
+    pVoice->voiceFlags = VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET;
+    pVoice->gain = 0;
+
+    /* MIDI note on puts both operators into attack state */
+    for (oper = 0; oper < FM_NUM_OPERATORS; oper++)
+    {
+        pFMVoice->phase[oper] = 0;
+        pFMVoice->egValue[oper] = 0;
+        pFMVoice->egState[oper] = eEnvelopeStateAttack;
+    }
+    pFMVoice->noise = FM_NOISE_SEED;
+    pFMVoice->modIndex = 0;
+    pFMVoice->modTarget = 0;
+    pFMVoice->gainTarget = 0;
+    pFMVoice->feedback = 0;
+    pFMVoice->lfoPhase = 0;
+
+#ifdef _LOW_LATENCY
+    /* the first slice of the note updates its parameters */
+    pFMVoice->frameLeft = 0;
+    pFMVoice->rampOffset = 0;
+#endif
+
+#if (NUM_OUTPUT_CHANNELS == 2)
+    pan = (EAS_INT) pSynth->channels[pVoice->channel & 15].pan - 64;
+    pan += fmPatches[regionIndex & REGION_INDEX_MASK].pan;
+    EAS_CalcPanControl(pan, &pFMVoice->gainLeft, &pFMVoice->gainRight);
+#endif
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * FM_UpdateVoice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Synthesizes the samples of an FM voice and adds them to the mix buffer.
+ * The envelopes and pitch are updated once per update period, a call
+ * inside a period continues the ramps of the call that started it.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pSynth - pointer to the synth
+ * pVoice - pointer to the voice
+ * voiceNum - voice number
+ * pVoiceBuffer - not used
+ * pMixBuffer - mix buffer
+ * numSamples - number of samples
+ *
+ * Outputs:
+ * Returns EAS_TRUE if the voice has finished
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pVoiceBuffer) the voice buffer is not needed */
+EAS_BOOL FM_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum, EAS_PCM *pVoiceBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSamples)
+{
+    S_FM_VOICE *pFMVoice;
+    const S_FM_PATCH *pPatch;
+    EAS_I32 rampOffset;
+
+    pFMVoice = &pVoiceMgr->fmVoices[voiceNum];
+    pPatch = &fmPatches[pVoice->regionIndex & REGION_INDEX_MASK];
+
+#ifdef _LOW_LATENCY
+    if (pFMVoice->frameLeft <= 0)
+    {
+        FM_UpdateControl(pVoiceMgr, pSynth, pVoice, pFMVoice, pPatch);
+        pFMVoice->frameLeft = (EAS_I16) (VM_UPDATE_PERIOD(pVoiceMgr) - pVoice->framePos);
+        pFMVoice->rampOffset = 0;
+    }
+    if (numSamples > pFMVoice->frameLeft)
+        numSamples = pFMVoice->frameLeft;
+    rampOffset = pFMVoice->rampOffset;
+#else
+    FM_UpdateControl(pVoiceMgr, pSynth, pVoice, pFMVoice, pPatch);
+    rampOffset = 0;
+#endif
+
+    /* a silent voice is not synthesized */
+    if ((numSamples > 0) && ((pVoice->gain > 0) || (pFMVoice->gainTarget > 0)))
+        FM_Synthesize(pVoiceMgr, pVoice, pFMVoice, pPatch, pMixBuffer, numSamples, rampOffset);
+
+    /* clear flag */
+    pVoice->voiceFlags &= ~VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET;
+
+#ifdef _LOW_LATENCY
+    pFMVoice->rampOffset = (EAS_I16) (pFMVoice->rampOffset + numSamples);
+    pFMVoice->frameLeft = (EAS_I16) (pFMVoice->frameLeft - numSamples);
+    if (pFMVoice->frameLeft > 0)
+        return EAS_FALSE;
+#endif
+
+    /* the update period is complete, the ramps end on their targets */
+    pVoice->gain = pFMVoice->gainTarget;
+    pFMVoice->modIndex = pFMVoice->modTarget;
+
+    /* if voice has finished, set flag for voice manager */
+    return (EAS_BOOL) ((pVoice->voiceState != eVoiceStateStolen) && (pFMVoice->egState[FM_CARRIER] == eEnvelopeStateMuted));
+}
+
+/*----------------------------------------------------------------------------
+ * FM_ReleaseVoice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * The selected voice is being released.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pVoice - pointer to voice to release
+ * voiceNum - voice number
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pSynth) used in some implementations */
+void FM_ReleaseVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum)
+{
+    S_FM_VOICE *pFMVoice;
+    EAS_INT oper;
+
+    pFMVoice = &pVoiceMgr->fmVoices[voiceNum];
+    for (oper = 0; oper < FM_NUM_OPERATORS; oper++)
+    {
+        if (pFMVoice->egState[oper] != eEnvelopeStateMuted)
+            pFMVoice->egState[oper] = eEnvelopeStateRelease;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * FM_MuteVoice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * The selected voice is being muted, its gain ramps to zero in the next
+ * update period.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pVoice - pointer to voice to mute
+ * voiceNum - voice number
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pSynth) used in some implementations */
+void FM_MuteVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum)
+{
+    /* clear deferred action flags */
+    pVoice->voiceFlags &=
+        ~(VOICE_FLAG_DEFER_MIDI_NOTE_OFF |
+        VOICE_FLAG_SUSTAIN_PEDAL_DEFER_NOTE_OFF |
+        VOICE_FLAG_DEFER_MUTE);
+
+    pVoiceMgr->fmVoices[voiceNum].egState[FM_MODULATOR] = eEnvelopeStateMuted;
+    pVoiceMgr->fmVoices[voiceNum].egState[FM_CARRIER] = eEnvelopeStateMuted;
+}
+
+/*----------------------------------------------------------------------------
+ * FM_SustainPedal()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * The selected voice is held due to sustain pedal
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pVoice - pointer to voice to sustain
+ * voiceNum - voice number
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pChannel) used in some implementations */
+void FM_SustainPedal (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, S_SYNTH_CHANNEL *pChannel, EAS_I32 voiceNum)
+{
+    S_FM_VOICE *pFMVoice;
+    const S_FM_PATCH *pPatch;
+
+    /* don't catch the voice if below the sustain level */
+    pFMVoice = &pVoiceMgr->fmVoices[voiceNum];
+    pPatch = &fmPatches[pVoice->regionIndex & REGION_INDEX_MASK];
+    if (pFMVoice->egValue[FM_CARRIER] < ((EAS_I32) pPatch->oper[FM_CARRIER].sustain << 7))
+        return;
+
+    /* defer releasing this note until the damper pedal is off */
+    pFMVoice->egState[FM_CARRIER] = eEnvelopeStateDecay;
+    if (pFMVoice->egState[FM_MODULATOR] == eEnvelopeStateRelease)
+        pFMVoice->egState[FM_MODULATOR] = eEnvelopeStateDecay;
+    pVoice->voiceState = eVoiceStatePlay;
+    pVoice->voiceFlags |= VOICE_FLAG_SUSTAIN_PEDAL_DEFER_NOTE_OFF;
+}
+
+/*----------------------------------------------------------------------------
+ * FM_FindProgram()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the first region of a program of the built-in patch set, the
+ * drum kit on a rhythm channel
+ *
+ * Inputs:
+ * rhythm - EAS_TRUE for a rhythm channel
+ * program - GM program number
+ *
+ * Outputs:
+ * region index with FLAG_RGN_IDX_FM_SYNTH
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_U16 FM_FindProgram (EAS_BOOL rhythm, EAS_U8 program)
+{
+    if (rhythm)
+        return FLAG_RGN_IDX_FM_SYNTH | FM_FIRST_DRUM_REGION;
+    return (EAS_U16) (FLAG_RGN_IDX_FM_SYNTH | fmProgramPatch[program & 0x7f]);
+}
+
+#endif /* #ifdef _FM_FALLBACK */
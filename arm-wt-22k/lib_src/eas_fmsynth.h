@@ -0,0 +1,124 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_fmsynth.h
+ *
+ * Contents and purpose:
+ * Data structures of the FM fallback engine, a two operator FM voice
+ * with a built-in General MIDI patch set. It plays through the wavetable
+ * synth interface without a sample bank, at a fraction of the cost of a
+ * wavetable voice, for devices that cannot afford the wavetable path.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_FMSYNTH_H
+#define _EAS_FMSYNTH_H
+
+#include "eas_types.h"
+#include "eas_sndlib.h"
+#include <stdint.h>
+
+#ifdef _FM_FALLBACK
+
+#if !defined(EAS_WT_SYNTH)
+#error "_FM_FALLBACK is only supported with EAS_WT_SYNTH"
+#endif
+
+/* operators of a voice */
+#define FM_MODULATOR                0
+#define FM_CARRIER                  1
+#define FM_NUM_OPERATORS            2
+
+/* number of melodic patches, the drum regions follow them in fmPatches */
+#define FM_NUM_MELODIC_PATCHES      31
+#define FM_FIRST_DRUM_REGION        FM_NUM_MELODIC_PATCHES
+
+/*------------------------------------
+ * S_FM_PATCH_OPER
+ *
+ * One operator of a patch. The rates run from 0 (fastest) to 15, an
+ * attack rate of 0 is instant. tuning is in cents above the note, or
+ * the absolute pitch in cents (100 per MIDI note) with
+ * FM_OPER_FLAG_MONOTONE. level is the output level of the carrier or
+ * the modulation index of the modulator, 255 is an index of about pi.
+ *------------------------------------
+*/
+typedef struct s_fm_patch_oper_tag
+{
+    EAS_I16     tuning;
+    EAS_U8      attack;
+    EAS_U8      decay;
+    EAS_U8      release;
+    EAS_U8      sustain;            /* 0 to 255 */
+    EAS_U8      level;
+    EAS_U8      flags;              /* FM_OPER_FLAG_MONOTONE, _NO_VIBRATO and _NOISE */
+} S_FM_PATCH_OPER;
+
+/*------------------------------------
+ * S_FM_PATCH
+ *
+ * A melodic program or a drum region. The region is searched by the
+ * voice manager like a wavetable region.
+ *------------------------------------
+*/
+typedef struct s_fm_patch_tag
+{
+    S_REGION        region;
+    EAS_U8          feedback;       /* modulator self-modulation, 0 to 7 */
+    EAS_I8          pan;
+    S_FM_PATCH_OPER oper[FM_NUM_OPERATORS];
+} S_FM_PATCH;
+
+/*------------------------------------
+ * S_FM_VOICE
+ *
+ * State of an FM voice, in the voice manager alongside the wavetable
+ * voice of the same number
+ *------------------------------------
+*/
+typedef struct s_fm_voice_tag
+{
+    uint32_t    phase[FM_NUM_OPERATORS];    /* 2^32 is a cycle */
+    uint32_t    phaseInc[FM_NUM_OPERATORS];
+    uint32_t    noise;                      /* noise generator seed */
+    EAS_I16     egValue[FM_NUM_OPERATORS];
+    EAS_I16     modIndex;               /* modulation index at the start of the update period */
+    EAS_I16     modTarget;              /* modulation index at the end of the update period */
+    EAS_I16     gainTarget;             /* gain at the end of the update period */
+    EAS_I16     feedback;               /* last modulator output, for feedback */
+#if (NUM_OUTPUT_CHANNELS == 2)
+    EAS_I16     gainLeft;
+    EAS_I16     gainRight;
+#endif
+    EAS_U16     lfoPhase;
+#ifdef _LOW_LATENCY
+    EAS_I16     frameLeft;              /* samples left in the update period */
+    EAS_I16     rampOffset;             /* samples of the update period already synthesized */
+#endif
+    EAS_U8      egState[FM_NUM_OPERATORS];
+} S_FM_VOICE;
+
+/* the melodic patches followed by the drum regions */
+extern const S_FM_PATCH fmPatches[];
+
+/* melodic patch of each GM program */
+extern const EAS_U8 fmProgramPatch[128];
+
+#endif /* #ifdef _FM_FALLBACK */
+
+#endif /* #ifndef _EAS_FMSYNTH_H */
@@ -0,0 +1,403 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_imaadpcm.c
+ *
+ * Contents and purpose:
+ * IMA ADPCM decoder for WAVE files. Blocks are read whole by the PCM engine
+ * and decoded with table lookups into the stream's ring buffer. The tables
+ * are shared with the wavetable interpolator for compressed samples, and
+ * DLS collections use the encoder to compress their samples.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#include "eas_data.h"
+#include "eas_host.h"
+#include "eas_imaadpcm.h"
+#include "eas_pcm.h"
+#include "eas_report.h"
+
+#if defined(_IMA_DECODER) || defined(_WT_ADPCM)
+/*----------------------------------------------------------------------------
+ * imaDeltaTable
+ *
+ * Magnitude of the difference for each step index and the three low bits of
+ * a nibble, (step >> 3) plus step, step >> 1 and step >> 2 for each bit set.
+ * Decoding a nibble is one lookup instead of three tests and adds.
+ *----------------------------------------------------------------------------
+*/
+const EAS_U16 imaDeltaTable[(IMA_MAX_STEP_INDEX + 1) * IMA_MAG_STATES] =
+{
+        0,     1,     3,     4,     7,     8,    10,    11,
+        1,     3,     5,     7,     9,    11,    13,    15,
+        1,     3,     5,     7,    10,    12,    14,    16,
+        1,     3,     6,     8,    11,    13,    16,    18,
+        1,     3,     6,     8,    12,    14,    17,    19,
+        1,     4,     7,    10,    13,    16,    19,    22,
+        1,     4,     7,    10,    14,    17,    20,    23,
+        1,     4,     8,    11,    15,    18,    22,    25,
+        2,     6,    10,    14,    18,    22,    26,    30,
+        2,     6,    10,    14,    19,    23,    27,    31,
+        2,     6,    11,    15,    21,    25,    30,    34,
+        2,     7,    12,    17,    23,    28,    33,    38,
+        2,     7,    13,    18,    25,    30,    36,    41,
+        3,     9,    15,    21,    28,    34,    40,    46,
+        3,    10,    17,    24,    31,    38,    45,    52,
+        3,    10,    18,    25,    34,    41,    49,    56,
+        4,    12,    21,    29,    38,    46,    55,    63,
+        4,    13,    22,    31,    41,    50,    59,    68,
+        5,    15,    25,    35,    46,    56,    66,    76,
+        5,    16,    27,    38,    50,    61,    72,    83,
+        6,    18,    31,    43,    56,    68,    81,    93,
+        6,    19,    33,    46,    61,    74,    88,   101,
+        7,    22,    37,    52,    67,    82,    97,   112,
+        8,    24,    41,    57,    74,    90,   107,   123,
+        9,    27,    45,    63,    82,   100,   118,   136,
+       10,    30,    50,    70,    90,   110,   130,   150,
+       11,    33,    55,    77,    99,   121,   143,   165,
+       12,    36,    60,    84,   109,   133,   157,   181,
+       13,    39,    66,    92,   120,   146,   173,   199,
+       14,    43,    73,   102,   132,   161,   191,   220,
+       16,    48,    81,   113,   146,   178,   211,   243,
+       17,    52,    88,   123,   160,   195,   231,   266,
+       19,    58,    97,   136,   176,   215,   254,   293,
+       21,    64,   107,   150,   194,   237,   280,   323,
+       23,    70,   118,   165,   213,   260,   308,   355,
+       26,    78,   130,   182,   235,   287,   339,   391,
+       28,    85,   143,   200,   258,   315,   373,   430,
+       31,    94,   157,   220,   284,   347,   410,   473,
+       34,   103,   173,   242,   313,   382,   452,   521,
+       38,   114,   191,   267,   345,   421,   498,   574,
+       42,   126,   210,   294,   379,   463,   547,   631,
+       46,   138,   231,   323,   417,   509,   602,   694,
+       51,   153,   255,   357,   459,   561,   663,   765,
+       56,   168,   280,   392,   505,   617,   729,   841,
+       61,   184,   308,   431,   555,   678,   802,   925,
+       68,   204,   340,   476,   612,   748,   884,  1020,
+       74,   223,   373,   522,   672,   821,   971,  1120,
+       82,   246,   411,   575,   740,   904,  1069,  1233,
+       90,   271,   452,   633,   814,   995,  1176,  1357,
+       99,   298,   497,   696,   895,  1094,  1293,  1492,
+      109,   328,   547,   766,   985,  1204,  1423,  1642,
+      120,   360,   601,   841,  1083,  1323,  1564,  1804,
+      132,   397,   662,   927,  1192,  1457,  1722,  1987,
+      145,   436,   728,  1019,  1311,  1602,  1894,  2185,
+      160,   480,   801,  1121,  1442,  1762,  2083,  2403,
+      176,   528,   881,  1233,  1587,  1939,  2292,  2644,
+      194,   582,   970,  1358,  1746,  2134,  2522,  2910,
+      213,   639,  1066,  1492,  1920,  2346,  2773,  3199,
+      234,   703,  1173,  1642,  2112,  2581,  3051,  3520,
+      258,   774,  1291,  1807,  2324,  2840,  3357,  3873,
+      284,   852,  1420,  1988,  2556,  3124,  3692,  4260,
+      312,   936,  1561,  2185,  2811,  3435,  4060,  4684,
+      343,  1030,  1717,  2404,  3092,  3779,  4466,  5153,
+      378,  1134,  1890,  2646,  3402,  4158,  4914,  5670,
+      415,  1246,  2078,  2909,  3742,  4573,  5405,  6236,
+      457,  1372,  2287,  3202,  4117,  5032,  5947,  6862,
+      503,  1509,  2516,  3522,  4529,  5535,  6542,  7548,
+      553,  1660,  2767,  3874,  4981,  6088,  7195,  8302,
+      608,  1825,  3043,  4260,  5479,  6696,  7914,  9131,
+      669,  2008,  3348,  4687,  6027,  7366,  8706, 10045,
+      736,  2209,  3683,  5156,  6630,  8103,  9577, 11050,
+      810,  2431,  4052,  5673,  7294,  8915, 10536, 12157,
+      891,  2674,  4457,  6240,  8023,  9806, 11589, 13372,
+      980,  2941,  4902,  6863,  8825, 10786, 12747, 14708,
+     1078,  3235,  5393,  7550,  9708, 11865, 14023, 16180,
+     1186,  3559,  5932,  8305, 10679, 13052, 15425, 17798,
+     1305,  3915,  6526,  9136, 11747, 14357, 16968, 19578,
+     1435,  4306,  7178, 10049, 12922, 15793, 18665, 21536,
+     1579,  4737,  7896, 11054, 14214, 17372, 20531, 23689,
+     1737,  5211,  8686, 12160, 15636, 19110, 22585, 26059,
+     1911,  5733,  9555, 13377, 17200, 21022, 24844, 28666,
+     2102,  6306, 10511, 14715, 18920, 23124, 27329, 31533,
+     2312,  6937, 11562, 16187, 20812, 25437, 30062, 34687,
+     2543,  7630, 12718, 17805, 22893, 27980, 33068, 38155,
+     2798,  8394, 13990, 19586, 25183, 30779, 36375, 41971,
+     3077,  9232, 15388, 21543, 27700, 33855, 40011, 46166,
+     3385, 10156, 16928, 23699, 30471, 37242, 44014, 50785,
+     3724, 11172, 18621, 26069, 33518, 40966, 48415, 55863,
+     4095, 12286, 20478, 28669, 36862, 45053, 53245, 61436
+};
+
+/*----------------------------------------------------------------------------
+ * imaNextStepTable
+ *
+ * Row of the next step index for each step index and nibble magnitude,
+ * clamped to the table, already multiplied by IMA_MAG_STATES
+ *----------------------------------------------------------------------------
+*/
+const EAS_U16 imaNextStepTable[(IMA_MAX_STEP_INDEX + 1) * IMA_MAG_STATES] =
+{
+        0,     0,     0,     0,    16,    32,    48,    64,
+        0,     0,     0,     0,    24,    40,    56,    72,
+        8,     8,     8,     8,    32,    48,    64,    80,
+       16,    16,    16,    16,    40,    56,    72,    88,
+       24,    24,    24,    24,    48,    64,    80,    96,
+       32,    32,    32,    32,    56,    72,    88,   104,
+       40,    40,    40,    40,    64,    80,    96,   112,
+       48,    48,    48,    48,    72,    88,   104,   120,
+       56,    56,    56,    56,    80,    96,   112,   128,
+       64,    64,    64,    64,    88,   104,   120,   136,
+       72,    72,    72,    72,    96,   112,   128,   144,
+       80,    80,    80,    80,   104,   120,   136,   152,
+       88,    88,    88,    88,   112,   128,   144,   160,
+       96,    96,    96,    96,   120,   136,   152,   168,
+      104,   104,   104,   104,   128,   144,   160,   176,
+      112,   112,   112,   112,   136,   152,   168,   184,
+      120,   120,   120,   120,   144,   160,   176,   192,
+      128,   128,   128,   128,   152,   168,   184,   200,
+      136,   136,   136,   136,   160,   176,   192,   208,
+      144,   144,   144,   144,   168,   184,   200,   216,
+      152,   152,   152,   152,   176,   192,   208,   224,
+      160,   160,   160,   160,   184,   200,   216,   232,
+      168,   168,   168,   168,   192,   208,   224,   240,
+      176,   176,   176,   176,   200,   216,   232,   248,
+      184,   184,   184,   184,   208,   224,   240,   256,
+      192,   192,   192,   192,   216,   232,   248,   264,
+      200,   200,   200,   200,   224,   240,   256,   272,
+      208,   208,   208,   208,   232,   248,   264,   280,
+      216,   216,   216,   216,   240,   256,   272,   288,
+      224,   224,   224,   224,   248,   264,   280,   296,
+      232,   232,   232,   232,   256,   272,   288,   304,
+      240,   240,   240,   240,   264,   280,   296,   312,
+      248,   248,   248,   248,   272,   288,   304,   320,
+      256,   256,   256,   256,   280,   296,   312,   328,
+      264,   264,   264,   264,   288,   304,   320,   336,
+      272,   272,   272,   272,   296,   312,   328,   344,
+      280,   280,   280,   280,   304,   320,   336,   352,
+      288,   288,   288,   288,   312,   328,   344,   360,
+      296,   296,   296,   296,   320,   336,   352,   368,
+      304,   304,   304,   304,   328,   344,   360,   376,
+      312,   312,   312,   312,   336,   352,   368,   384,
+      320,   320,   320,   320,   344,   360,   376,   392,
+      328,   328,   328,   328,   352,   368,   384,   400,
+      336,   336,   336,   336,   360,   376,   392,   408,
+      344,   344,   344,   344,   368,   384,   400,   416,
+      352,   352,   352,   352,   376,   392,   408,   424,
+      360,   360,   360,   360,   384,   400,   416,   432,
+      368,   368,   368,   368,   392,   408,   424,   440,
+      376,   376,   376,   376,   400,   416,   432,   448,
+      384,   384,   384,   384,   408,   424,   440,   456,
+      392,   392,   392,   392,   416,   432,   448,   464,
+      400,   400,   400,   400,   424,   440,   456,   472,
+      408,   408,   408,   408,   432,   448,   464,   480,
+      416,   416,   416,   416,   440,   456,   472,   488,
+      424,   424,   424,   424,   448,   464,   480,   496,
+      432,   432,   432,   432,   456,   472,   488,   504,
+      440,   440,   440,   440,   464,   480,   496,   512,
+      448,   448,   448,   448,   472,   488,   504,   520,
+      456,   456,   456,   456,   480,   496,   512,   528,
+      464,   464,   464,   464,   488,   504,   520,   536,
+      472,   472,   472,   472,   496,   512,   528,   544,
+      480,   480,   480,   480,   504,   520,   536,   552,
+      488,   488,   488,   488,   512,   528,   544,   560,
+      496,   496,   496,   496,   520,   536,   552,   568,
+      504,   504,   504,   504,   528,   544,   560,   576,
+      512,   512,   512,   512,   536,   552,   568,   584,
+      520,   520,   520,   520,   544,   560,   576,   592,
+      528,   528,   528,   528,   552,   568,   584,   600,
+      536,   536,   536,   536,   560,   576,   592,   608,
+      544,   544,   544,   544,   568,   584,   600,   616,
+      552,   552,   552,   552,   576,   592,   608,   624,
+      560,   560,   560,   560,   584,   600,   616,   632,
+      568,   568,   568,   568,   592,   608,   624,   640,
+      576,   576,   576,   576,   600,   616,   632,   648,
+      584,   584,   584,   584,   608,   624,   640,   656,
+      592,   592,   592,   592,   616,   632,   648,   664,
+      600,   600,   600,   600,   624,   640,   656,   672,
+      608,   608,   608,   608,   632,   648,   664,   680,
+      616,   616,   616,   616,   640,   656,   672,   688,
+      624,   624,   624,   624,   648,   664,   680,   696,
+      632,   632,   632,   632,   656,   672,   688,   704,
+      640,   640,   640,   640,   664,   680,   696,   704,
+      648,   648,   648,   648,   672,   688,   704,   704,
+      656,   656,   656,   656,   680,   696,   704,   704,
+      664,   664,   664,   664,   688,   704,   704,   704,
+      672,   672,   672,   672,   696,   704,   704,   704,
+      680,   680,   680,   680,   704,   704,   704,   704,
+      688,   688,   688,   688,   704,   704,   704,   704,
+      696,   696,   696,   696,   704,   704,   704,   704
+};
+
+#endif
+
+#ifdef _IMA_DECODER
+
+/* stereo data alternates 4 bytes, 8 samples, of each channel */
+#define IMA_STEREO_GROUP        8
+
+/* local prototypes */
+static EAS_RESULT IMADecoderInit (EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState);
+static EAS_RESULT IMADecoderDecode (EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState);
+
+/*----------------------------------------------------------------------------
+ * IMADecoder
+ *
+ * Decoder interface for IMA ADPCM, WAVE format 0x11
+ *----------------------------------------------------------------------------
+*/
+const S_DECODER_INTERFACE IMADecoder =
+{
+    IMADecoderInit,
+    IMADecoderDecode
+};
+
+/*----------------------------------------------------------------------------
+ * IMADecoderInit()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks the block size and sets the frames in a block
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream, blockSize is the WAVE block align
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT IMADecoderInit (EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState)
+{
+    EAS_I32 dataSize;
+
+    /* the whole block is read at once */
+    if ((pState->blockSize > PCM_FILE_BUFFER_SIZE) || (pState->blockSize <= 0))
+        return EAS_ERROR_INVALID_PCM_TYPE;
+
+    if (pState->flags & PCM_FLAGS_STEREO)
+    {
+        dataSize = pState->blockSize - 2 * IMA_HEADER_SIZE;
+        if ((dataSize <= 0) || (dataSize % IMA_STEREO_GROUP))
+            return EAS_ERROR_INVALID_PCM_TYPE;
+        pState->samplesPerBlock = dataSize + 1;
+    }
+    else
+    {
+        dataSize = pState->blockSize - IMA_HEADER_SIZE;
+        if (dataSize <= 0)
+            return EAS_ERROR_INVALID_PCM_TYPE;
+        pState->samplesPerBlock = dataSize * 2 + 1;
+    }
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * IMADecoderDecode()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Decodes the block in the file buffer into the ring. The block is decoded
+ * a byte (two frames) at a time for mono and a group of eight frames for
+ * stereo, so decoding can stop when the ring is full and carry on from the
+ * same place on the next call.
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT IMADecoderDecode (EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState)
+{
+    const EAS_U8 *pSrc;
+    EAS_PCM *pRing;
+    EAS_U32 writePos;
+    EAS_I32 pos;
+    EAS_I32 end;
+    EAS_I32 space;
+    EAS_INT i;
+
+    pRing = pState->ring;
+    writePos = pState->writePos;
+    space = PCM_RING_SIZE - (EAS_I32) (writePos - pState->readPos);
+    pSrc = pState->fileBuffer;
+    pos = pState->blockPos;
+    end = pState->blockBytes;
+
+    if (pState->flags & PCM_FLAGS_STEREO)
+    {
+        /* the header holds the first frame */
+        if (pos == 0)
+        {
+            if (end < 2 * IMA_HEADER_SIZE)
+            {
+                pState->blockPos = end;
+                return EAS_SUCCESS;
+            }
+            pRing[writePos++ & PCM_RING_MASK] = IMADecodeHeader(&pState->decoderL, pSrc);
+            pRing[writePos++ & PCM_RING_MASK] = IMADecodeHeader(&pState->decoderR, pSrc + IMA_HEADER_SIZE);
+            pos = 2 * IMA_HEADER_SIZE;
+            space -= 2;
+        }
+
+        /* a short group at the end of the file is not played */
+        while ((pos + IMA_STEREO_GROUP <= end) && (space >= 2 * IMA_STEREO_GROUP))
+        {
+            for (i = 0; i < IMA_STEREO_GROUP / 2; i++)
+            {
+                EAS_INT left = pSrc[pos + i];
+                EAS_INT right = pSrc[pos + IMA_STEREO_GROUP / 2 + i];
+                pRing[writePos++ & PCM_RING_MASK] = IMADecodeNibble(&pState->decoderL, left & 0x0f);
+                pRing[writePos++ & PCM_RING_MASK] = IMADecodeNibble(&pState->decoderR, right & 0x0f);
+                pRing[writePos++ & PCM_RING_MASK] = IMADecodeNibble(&pState->decoderL, left >> 4);
+                pRing[writePos++ & PCM_RING_MASK] = IMADecodeNibble(&pState->decoderR, right >> 4);
+            }
+            pos += IMA_STEREO_GROUP;
+            space -= 2 * IMA_STEREO_GROUP;
+        }
+        if (pos + IMA_STEREO_GROUP > end)
+            pos = end;
+    }
+
+    else
+    {
+        if (pos == 0)
+        {
+            if (end < IMA_HEADER_SIZE)
+            {
+                pState->blockPos = end;
+                return EAS_SUCCESS;
+            }
+            pRing[writePos++ & PCM_RING_MASK] = IMADecodeHeader(&pState->decoderL, pSrc);
+            pos = IMA_HEADER_SIZE;
+            space--;
+        }
+
+        /* low nibble first */
+        while ((pos < end) && (space >= 2))
+        {
+            EAS_INT data = pSrc[pos++];
+            pRing[writePos++ & PCM_RING_MASK] = IMADecodeNibble(&pState->decoderL, data & 0x0f);
+            pRing[writePos++ & PCM_RING_MASK] = IMADecodeNibble(&pState->decoderL, data >> 4);
+            space -= 2;
+        }
+    }
+
+    pState->blockPos = pos;
+    pState->writePos = writePos;
+    return EAS_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_imaadpcm.h
+ *
+ * Contents and purpose:
+ * IMA ADPCM decode tables and the nibble decoder shared by the WAVE file
+ * decoder and the wavetable interpolator
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_IMAADPCM_H
+#define _EAS_IMAADPCM_H
+
+#include "eas_types.h"
+
+/* a block or compressed sample starts with a 4 byte header per channel */
+#define IMA_HEADER_SIZE         4
+
+/* rows of the decode tables, one for each magnitude of a nibble */
+#define IMA_MAG_STATES          8
+#define IMA_MAX_STEP_INDEX      88
+
+/*----------------------------------------------------------------------------
+ * S_DECODER_STATE
+ *
+ * State of one channel of an ADPCM decoder
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_decoder_state_tag
+{
+    EAS_I32             x1;                 /* current generated sample */
+    EAS_I32             step;               /* current ADPCM step index, in table rows */
+} S_DECODER_STATE;
+
+#if defined(_IMA_DECODER) || defined(_WT_ADPCM)
+/* magnitude of the difference for each step row and low 3 bits of a nibble */
+extern const EAS_U16 imaDeltaTable[(IMA_MAX_STEP_INDEX + 1) * IMA_MAG_STATES];
+
+/* next step row for each step row and low 3 bits of a nibble */
+extern const EAS_U16 imaNextStepTable[(IMA_MAX_STEP_INDEX + 1) * IMA_MAG_STATES];
+
+/*----------------------------------------------------------------------------
+ * IMADecodeNibble()
+ *----------------------------------------------------------------------------
+ * Decodes one nibble and returns the new sample
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE EAS_I32 IMADecodeNibble (S_DECODER_STATE *pDecoder, EAS_INT nibble)
+{
+    EAS_INT entry;
+    EAS_I32 x1;
+
+    entry = pDecoder->step + (nibble & 7);
+    x1 = pDecoder->x1;
+    if (nibble & 8)
+        x1 -= imaDeltaTable[entry];
+    else
+        x1 += imaDeltaTable[entry];
+    if (x1 > 32767)
+        x1 = 32767;
+    else if (x1 < -32768)
+        x1 = -32768;
+    pDecoder->x1 = x1;
+    pDecoder->step = imaNextStepTable[entry];
+    return x1;
+}
+
+/*----------------------------------------------------------------------------
+ * IMADecodeHeader()
+ *----------------------------------------------------------------------------
+ * Loads the predictor and step index of one channel from a header and
+ * returns the first sample
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE EAS_I32 IMADecodeHeader (S_DECODER_STATE *pDecoder, const EAS_U8 *pSrc)
+{
+    EAS_INT step;
+
+    pDecoder->x1 = (EAS_I16) (pSrc[0] | (pSrc[1] << 8));
+    step = pSrc[2];
+    if (step > IMA_MAX_STEP_INDEX)
+        step = IMA_MAX_STEP_INDEX;
+    pDecoder->step = step * IMA_MAG_STATES;
+    return pDecoder->x1;
+}
+#endif
+
+/* bytes holding numSamples compressed mono samples */
+#define IMA_ADPCM_SIZE(numSamples)      (IMA_HEADER_SIZE + ((numSamples) >> 1))
+
+/* samples decoded from a compressed sample of size bytes, the last may be padding */
+#define IMA_ADPCM_SAMPLES(size)         ((((size) - IMA_HEADER_SIZE) << 1) + 1)
+
+#endif /* end _EAS_IMAADPCM_H */
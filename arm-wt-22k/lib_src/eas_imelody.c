@@ -27,6 +27,9 @@
  *----------------------------------------------------------------------------
 */
 
+/* allocations of this module are reported as parser state */
+#define EAS_MEM_CATEGORY    EAS_MEM_PARSERS
+
 /* lint doesn't like the way some string.h files look */
 #ifdef _lint
 #include "lint_stdlib.h"
@@ -43,6 +46,7 @@
 #include "eas_config.h"
 #include "eas_vm_protos.h"
 #include "eas_imelodydata.h"
+#include "eas_tonecache.h"
 #include "eas_ctype.h"
 
 // #define _DEBUG_IMELODY
@@ -142,6 +146,10 @@ static EAS_RESULT IMY_ParseHeader (S_EAS_DATA *pEASData, S_IMELODY_DATA* pData);
 static EAS_I8 IMY_GetNextChar (EAS_HW_DATA_HANDLE hwInstData, S_IMELODY_DATA *pData, EAS_BOOL inHeader);
 static EAS_RESULT IMY_ReadLine (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I8 *buffer, EAS_I32 *pStartLine);
 static EAS_INT IMY_ParseLine (EAS_I8 *buffer, EAS_U8 *pIndex);
+#ifdef _RINGTONE_COMPILE_EVENTS
+static EAS_RESULT IMY_CompileEvents (S_EAS_DATA *pEASData, S_IMELODY_DATA *pData);
+static EAS_RESULT IMY_PlayEvent (S_EAS_DATA *pEASData, S_IMELODY_DATA *pData, EAS_INT parserMode);
+#endif
 
 
 /*----------------------------------------------------------------------------
@@ -279,6 +287,16 @@ static EAS_RESULT IMY_Prepare (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
 #endif
 
     pData ->state = EAS_STATE_READY;
+
+#ifdef _RINGTONE_COMPILE_EVENTS
+    /* unroll the melody into an event list, a metadata probe reads the file once */
+    if (!pEASData->staticMemoryModel && (pData->pSynth != NULL))
+    {
+        if ((result = IMY_CompileEvents(pEASData, pData)) != EAS_SUCCESS)
+            return result;
+    }
+#endif
+
     return EAS_SUCCESS;
 }
 
@@ -346,6 +364,12 @@ static EAS_RESULT IMY_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I
         pData->state = EAS_STATE_PLAY;
     }
 
+#ifdef _RINGTONE_COMPILE_EVENTS
+    /* play from the compiled event list */
+    if (pData->events != NULL)
+        return IMY_PlayEvent(pEASData, pData, parserMode);
+#endif
+
     /* initialize MIDI channel when the track starts playing */
     if (pData->time == 0)
     {
@@ -354,10 +378,12 @@ static EAS_RESULT IMY_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "IMY_Event: Reset\n"); */ }
 #endif
         /* set program to square lead */
-        VMProgramChange(pEASData->pVoiceMgr, pData->pSynth, IMELODY_CHANNEL, IMELODY_PROGRAM);
+        if (parserMode != eParserModeMetaData)
+            VMProgramChange(pEASData->pVoiceMgr, pData->pSynth, IMELODY_CHANNEL, IMELODY_PROGRAM);
 
         /* set channel volume to max */
-        VMControlChange(pEASData->pVoiceMgr, pData->pSynth, IMELODY_CHANNEL, 7, 127);
+        if (parserMode != eParserModeMetaData)
+            VMControlChange(pEASData->pVoiceMgr, pData->pSynth, IMELODY_CHANNEL, 7, 127);
     }
 
     /* check for end of note */
@@ -368,7 +394,8 @@ static EAS_RESULT IMY_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "Stopping note %d\n", pData->note); */ }
 #endif
         /* stop the note */
-        VMStopNote(pEASData->pVoiceMgr, pData->pSynth, IMELODY_CHANNEL, pData->note, 0);
+        if (parserMode != eParserModeMetaData)
+            VMStopNote(pEASData->pVoiceMgr, pData->pSynth, IMELODY_CHANNEL, pData->note, 0);
         pData->note = 0;
 
         /* check for rest between notes */
@@ -499,12 +526,21 @@ static EAS_RESULT IMY_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I
 
             /* ledon or ledoff */
             case 'l':
+#ifdef _RINGTONE_COMPILE_EVENTS
+                /* hardware commands are not compiled, the file is played instead */
+                if (pData->compiling)
+                    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
                 if (!IMY_GetLEDState(pEASData, pData))
                     eof = EAS_TRUE;
                 break;
 
             /* vibeon or vibeoff */
             case 'v':
+#ifdef _RINGTONE_COMPILE_EVENTS
+                if (pData->compiling)
+                    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
                 if (!IMY_GetVibeState(pEASData, pData))
                     eof = EAS_TRUE;
                 break;
@@ -513,6 +549,10 @@ static EAS_RESULT IMY_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I
             case 'b':
                 if (IMY_GetNextChar(pEASData->hwInstData, pData, EAS_FALSE) == 'a')
                 {
+#ifdef _RINGTONE_COMPILE_EVENTS
+                    if (pData->compiling)
+                        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
                     if (!IMY_GetBackState(pEASData, pData))
                         eof = EAS_TRUE;
                 }
@@ -655,6 +695,12 @@ static EAS_RESULT IMY_Close (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     if (pData->pSynth != NULL)
         VMMIDIShutdown(pEASData, pData->pSynth);
 
+#ifdef _RINGTONE_COMPILE_EVENTS
+    /* free the compiled event list */
+    if (pData->events != NULL)
+        EAS_HWFree(pEASData->hwInstData, pData->events);
+#endif
+
     /* if using dynamic memory, free it */
     if (!pEASData->staticMemoryModel)
         EAS_HWFree(pEASData->hwInstData, pData);
@@ -695,6 +741,9 @@ static EAS_RESULT IMY_Reset (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     /* reset time to zero */
     pData->time = 0;
     pData->note = 0;
+#ifdef _RINGTONE_COMPILE_EVENTS
+    pData->eventIndex = 0;
+#endif
 
     /* reset file position and re-parse header */
     pData->state = EAS_STATE_ERROR;
@@ -1752,3 +1801,199 @@ static EAS_INT IMY_ParseLine (EAS_I8 *buffer, EAS_U8 *pIndex)
     return TOKEN_INVALID;
 }
 
+
+#ifdef _RINGTONE_COMPILE_EVENTS
+/*----------------------------------------------------------------------------
+ * IMY_CompileEvents()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses the whole melody once and saves the notes and rests in an event
+ * list, so that playback and locating don't read the file. Finite repeats
+ * are unrolled. Melodies with an infinite repeat, LED, vibrator or
+ * backlight commands or a parsing error are left to be parsed from the file.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pData            - pointer to parser instance data
+ *
+ * Outputs:
+ * Returns EAS_SUCCESS if the melody is to be parsed from the file.
+ *
+ * Side Effects:
+ * The parser state is restored when done.
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT IMY_CompileEvents (S_EAS_DATA *pEASData, S_IMELODY_DATA *pData)
+{
+    S_IMELODY_DATA saved;
+    S_TONE_EVENT *pEvents;
+    S_TONE_EVENT *pEvent;
+    EAS_I32 filePos;
+    EAS_I32 time;
+    EAS_U32 numEvents;
+    EAS_U32 maxEvents;
+    EAS_RESULT result;
+    EAS_BOOL rest;
+#ifdef _RINGTONE_EVENT_CACHE
+    S_TONE_CACHE_KEY key;
+#endif
+
+    /* save the parser state, the walk below uses the parser */
+    if ((result = EAS_HWFilePos(pEASData->hwInstData, pData->fileHandle, &filePos)) != EAS_SUCCESS)
+        return result;
+#ifdef _RINGTONE_EVENT_CACHE
+    /* a ringtone compiled before is copied from the cache */
+    if ((result = EAS_ToneCacheLookup(pEASData, pData->fileHandle, TONE_CACHE_IMELODY, &key, &pData->events, &pData->numEvents)) != EAS_SUCCESS)
+        return result;
+    if (pData->events != NULL)
+    {
+        pData->eventIndex = 0;
+        return EAS_HWFileSeek(pEASData->hwInstData, pData->fileHandle, filePos);
+    }
+    if ((result = EAS_HWFileSeek(pEASData->hwInstData, pData->fileHandle, filePos)) != EAS_SUCCESS)
+        return result;
+#endif
+    saved = *pData;
+
+    pEvents = NULL;
+    numEvents = 0;
+    maxEvents = 0;
+    pData->compiling = EAS_TRUE;
+    for (;;)
+    {
+        /* a call that ends the rest after a note adds no event */
+        rest = (pData->note != 0) && (pData->restTicks != 0);
+        time = pData->time;
+        if ((result = IMY_Event(pEASData, pData, eParserModeMetaData)) != EAS_SUCCESS)
+            break;
+
+        /* infinite repeats are only played in play mode */
+        if (pData->repeatCount == 0)
+        {
+            result = EAS_ERROR_FEATURE_NOT_AVAILABLE;
+            break;
+        }
+        if (pData->state == EAS_STATE_STOPPING)
+            break;
+        if (rest || ((pData->note == 0) && (pData->time == time)))
+            continue;
+
+        /* grow the event list */
+        if (numEvents == maxEvents)
+        {
+            S_TONE_EVENT *pTemp;
+
+            if (maxEvents >= TONE_MAX_EVENTS)
+            {
+                result = EAS_ERROR_DATA_INCONSISTENCY;
+                break;
+            }
+            maxEvents += TONE_EVENT_BLOCK_SIZE;
+            if ((pTemp = EAS_HWMalloc(pEASData->hwInstData, (EAS_I32) (maxEvents * sizeof(S_TONE_EVENT)))) == NULL)
+            {
+                result = EAS_ERROR_MALLOC_FAILED;
+                break;
+            }
+            if (pEvents != NULL)
+            {
+                EAS_HWMemCpy(pTemp, pEvents, (EAS_I32) (numEvents * sizeof(S_TONE_EVENT)));
+                EAS_HWFree(pEASData->hwInstData, pEvents);
+            }
+            pEvents = pTemp;
+        }
+
+        /* save the note or rest, IMY_PlayNote takes the velocity from the volume */
+        pEvent = &pEvents[numEvents++];
+        pEvent->ticks = pData->time - time;
+        pEvent->restTicks = pData->note ? pData->restTicks : 0;
+        pEvent->note = pData->note;
+        pEvent->velocity = (EAS_U8) (pData->volume ? pData->volume * IMELODY_VEL_MUL + IMELODY_VEL_OFS : 0);
+    }
+
+    /* restore the parser state */
+    *pData = saved;
+    if ((result == EAS_SUCCESS) && (numEvents != 0))
+    {
+        pData->events = pEvents;
+        pData->numEvents = numEvents;
+        pData->eventIndex = 0;
+#ifdef _RINGTONE_EVENT_CACHE
+        EAS_ToneCacheStore(pEASData, &key, pEvents, numEvents);
+#endif
+    }
+    else
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "IMY_CompileEvents: parsing from file, error %d\n", result); */ }
+        if (pEvents != NULL)
+            EAS_HWFree(pEASData->hwInstData, pEvents);
+    }
+    return EAS_HWFileSeek(pEASData->hwInstData, pData->fileHandle, filePos);
+}
+
+/*----------------------------------------------------------------------------
+ * IMY_PlayEvent()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Plays the next event from the compiled event list, the same way
+ * IMY_Event plays it from the file
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pData            - pointer to parser instance data
+ * parserMode       - parser mode
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT IMY_PlayEvent (S_EAS_DATA *pEASData, S_IMELODY_DATA *pData, EAS_INT parserMode)
+{
+    S_TONE_EVENT *pEvent;
+
+    /* initialize MIDI channel when the track starts playing */
+    if ((pData->time == 0) && (parserMode != eParserModeMetaData))
+    {
+        VMProgramChange(pEASData->pVoiceMgr, pData->pSynth, IMELODY_CHANNEL, IMELODY_PROGRAM);
+        VMControlChange(pEASData->pVoiceMgr, pData->pSynth, IMELODY_CHANNEL, 7, 127);
+    }
+
+    /* check for end of note */
+    if (pData->note)
+    {
+        if (parserMode != eParserModeMetaData)
+            VMStopNote(pEASData->pVoiceMgr, pData->pSynth, IMELODY_CHANNEL, pData->note, 0);
+        pData->note = 0;
+
+        /* check for rest between notes */
+        if (pData->restTicks)
+        {
+            pData->time += pData->restTicks;
+            pData->restTicks = 0;
+            return EAS_SUCCESS;
+        }
+    }
+
+    /* end of the list */
+    if (pData->eventIndex >= pData->numEvents)
+    {
+        pData->state = EAS_STATE_STOPPING;
+        VMReleaseAllVoices(pEASData->pVoiceMgr, pData->pSynth);
+        return EAS_SUCCESS;
+    }
+
+    /* start the note */
+    pEvent = &pData->events[pData->eventIndex++];
+    if (pEvent->note)
+    {
+        pData->note = pEvent->note;
+        pData->restTicks = pEvent->restTicks;
+        if (parserMode == eParserModePlay)
+            VMStartNote(pEASData->pVoiceMgr, pData->pSynth, IMELODY_CHANNEL, pData->note, pEvent->velocity);
+    }
+    pData->time += pEvent->ticks;
+    return EAS_SUCCESS;
+}
+#endif
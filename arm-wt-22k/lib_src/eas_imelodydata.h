@@ -33,6 +33,7 @@
 #define EAS_IMELODYDATA_H
 
 #include "eas_data.h"
+#include "eas_miditypes.h"
 
 /* maximum line size as specified in iMelody V1.2 spec */
 #define MAX_LINE_SIZE           75
@@ -67,6 +68,12 @@ typedef struct
     EAS_U8          note;                       /* MIDI note number */
     EAS_I8          noteModifier;               /* sharp or flat */
     EAS_I8          buffer[MAX_LINE_SIZE+1];    /* buffer for ASCII data */
+#ifdef _RINGTONE_COMPILE_EVENTS
+    S_TONE_EVENT    *events;                    /* notes and rests of the whole file */
+    EAS_U32         numEvents;                  /* number of compiled events */
+    EAS_U32         eventIndex;                 /* index of next event */
+    EAS_BOOL        compiling;                  /* the event list is being compiled */
+#endif
 } S_IMELODY_DATA;
 
 #endif
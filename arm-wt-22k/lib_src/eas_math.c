@@ -36,6 +36,274 @@
 /* anything greater than this converts to a fraction too large to represent in 32-bits */
 #define MAX_CENTS    19200
 
+#ifdef _MATH_TABLES
+/*----------------------------------------------------------------------------
+ * 2^(frac / 4096) in 1.15 format for each fraction of a dent. The entries are
+ * the values of the GN2_TO_X power series, so EAS_Calculate2toX returns the
+ * same results with one load instead of three multiplies.
+ *----------------------------------------------------------------------------
+*/
+static const EAS_U16 eas2toXTable[DENTS_ONE] =
+{
+    32768, 32773, 32779, 32784, 32790, 32795, 32801, 32807, 32812, 32818, 32823, 32829, 32834, 32840, 32846, 32851,
+    32857, 32862, 32868, 32874, 32879, 32885, 32890, 32896, 32902, 32907, 32913, 32918, 32924, 32930, 32935, 32941,
+    32946, 32952, 32958, 32963, 32969, 32974, 32980, 32986, 32991, 32997, 33002, 33008, 33014, 33019, 33025, 33030,
+    33036, 33042, 33047, 33053, 33059, 33064, 33070, 33075, 33081, 33087, 33092, 33098, 33104, 33109, 33115, 33120,
+    33126, 33132, 33137, 33143, 33149, 33154, 33160, 33166, 33171, 33177, 33182, 33188, 33194, 33199, 33205, 33211,
+    33216, 33222, 33228, 33233, 33239, 33245, 33250, 33256, 33261, 33267, 33273, 33278, 33284, 33290, 33295, 33301,
+    33307, 33312, 33318, 33324, 33329, 33335, 33341, 33346, 33352, 33358, 33363, 33369, 33375, 33380, 33386, 33392,
+    33397, 33403, 33409, 33414, 33420, 33426, 33431, 33437, 33443, 33448, 33454, 33460, 33466, 33471, 33477, 33483,
+    33488, 33494, 33500, 33505, 33511, 33517, 33522, 33528, 33534, 33539, 33545, 33551, 33557, 33562, 33568, 33574,
+    33579, 33585, 33591, 33596, 33602, 33608, 33614, 33619, 33625, 33631, 33636, 33642, 33648, 33654, 33659, 33665,
+    33671, 33676, 33682, 33688, 33694, 33699, 33705, 33711, 33717, 33722, 33728, 33734, 33739, 33745, 33751, 33757,
+    33762, 33768, 33774, 33780, 33785, 33791, 33797, 33803, 33808, 33814, 33820, 33825, 33831, 33837, 33843, 33848,
+    33854, 33860, 33866, 33871, 33877, 33883, 33889, 33894, 33900, 33906, 33912, 33917, 33923, 33929, 33935, 33940,
+    33946, 33952, 33958, 33964, 33969, 33975, 33981, 33987, 33992, 33998, 34004, 34010, 34015, 34021, 34027, 34033,
+    34039, 34044, 34050, 34056, 34062, 34067, 34073, 34079, 34085, 34091, 34096, 34102, 34108, 34114, 34119, 34125,
+    34131, 34137, 34143, 34148, 34154, 34160, 34166, 34172, 34177, 34183, 34189, 34195, 34201, 34206, 34212, 34218,
+    34224, 34230, 34235, 34241, 34247, 34253, 34259, 34265, 34270, 34276, 34282, 34288, 34294, 34299, 34305, 34311,
+    34317, 34323, 34328, 34334, 34340, 34346, 34352, 34358, 34363, 34369, 34375, 34381, 34387, 34393, 34398, 34404,
+    34410, 34416, 34422, 34428, 34433, 34439, 34445, 34451, 34457, 34463, 34468, 34474, 34480, 34486, 34492, 34498,
+    34504, 34509, 34515, 34521, 34527, 34533, 34539, 34545, 34550, 34556, 34562, 34568, 34574, 34580, 34586, 34591,
+    34597, 34603, 34609, 34615, 34621, 34627, 34633, 34638, 34644, 34650, 34656, 34662, 34668, 34674, 34680, 34685,
+    34691, 34697, 34703, 34709, 34715, 34721, 34727, 34733, 34738, 34744, 34750, 34756, 34762, 34768, 34774, 34780,
+    34786, 34791, 34797, 34803, 34809, 34815, 34821, 34827, 34833, 34839, 34845, 34850, 34856, 34862, 34868, 34874,
+    34880, 34886, 34892, 34898, 34904, 34910, 34916, 34921, 34927, 34933, 34939, 34945, 34951, 34957, 34963, 34969,
+    34975, 34981, 34987, 34992, 34998, 35004, 35010, 35016, 35022, 35028, 35034, 35040, 35046, 35052, 35058, 35064,
+    35070, 35076, 35082, 35088, 35093, 35099, 35105, 35111, 35117, 35123, 35129, 35135, 35141, 35147, 35153, 35159,
+    35165, 35171, 35177, 35183, 35189, 35195, 35201, 35207, 35213, 35219, 35224, 35230, 35236, 35242, 35248, 35254,
+    35260, 35266, 35272, 35278, 35284, 35290, 35296, 35302, 35308, 35314, 35320, 35326, 35332, 35338, 35344, 35350,
+    35356, 35362, 35368, 35374, 35380, 35386, 35392, 35398, 35404, 35410, 35416, 35422, 35428, 35434, 35440, 35446,
+    35452, 35458, 35464, 35470, 35476, 35482, 35488, 35494, 35500, 35506, 35512, 35518, 35524, 35530, 35536, 35542,
+    35548, 35554, 35560, 35566, 35572, 35578, 35584, 35590, 35596, 35602, 35608, 35614, 35621, 35627, 35633, 35639,
+    35645, 35651, 35657, 35663, 35669, 35675, 35681, 35687, 35693, 35699, 35705, 35711, 35717, 35723, 35729, 35735,
+    35741, 35747, 35753, 35760, 35766, 35772, 35778, 35784, 35790, 35796, 35802, 35808, 35814, 35820, 35826, 35832,
+    35838, 35844, 35850, 35857, 35863, 35869, 35875, 35881, 35887, 35893, 35899, 35905, 35911, 35917, 35923, 35930,
+    35935, 35942, 35948, 35954, 35960, 35966, 35972, 35978, 35984, 35990, 35996, 36003, 36009, 36015, 36021, 36027,
+    36033, 36039, 36045, 36051, 36057, 36064, 36070, 36076, 36082, 36088, 36094, 36100, 36106, 36112, 36118, 36125,
+    36131, 36137, 36143, 36149, 36155, 36161, 36167, 36174, 36180, 36186, 36192, 36198, 36204, 36210, 36216, 36223,
+    36229, 36235, 36241, 36247, 36253, 36259, 36266, 36272, 36278, 36284, 36290, 36296, 36302, 36309, 36315, 36321,
+    36327, 36333, 36339, 36345, 36351, 36358, 36364, 36370, 36376, 36382, 36388, 36395, 36401, 36407, 36413, 36419,
+    36425, 36432, 36438, 36444, 36450, 36456, 36462, 36469, 36475, 36481, 36487, 36493, 36499, 36506, 36512, 36518,
+    36524, 36530, 36537, 36543, 36549, 36555, 36561, 36568, 36574, 36580, 36586, 36592, 36598, 36605, 36611, 36617,
+    36623, 36629, 36636, 36642, 36648, 36654, 36660, 36667, 36673, 36679, 36685, 36691, 36698, 36704, 36710, 36716,
+    36723, 36729, 36735, 36741, 36747, 36754, 36760, 36766, 36772, 36779, 36785, 36791, 36797, 36803, 36810, 36816,
+    36822, 36828, 36835, 36841, 36847, 36853, 36859, 36866, 36872, 36878, 36884, 36891, 36897, 36903, 36909, 36916,
+    36922, 36928, 36934, 36941, 36947, 36953, 36959, 36966, 36972, 36978, 36984, 36991, 36997, 37003, 37009, 37016,
+    37022, 37028, 37034, 37041, 37047, 37053, 37060, 37066, 37072, 37078, 37085, 37091, 37097, 37104, 37110, 37116,
+    37122, 37129, 37135, 37141, 37148, 37154, 37160, 37166, 37173, 37179, 37185, 37192, 37198, 37204, 37210, 37217,
+    37223, 37229, 37236, 37242, 37248, 37254, 37261, 37267, 37273, 37280, 37286, 37292, 37299, 37305, 37311, 37317,
+    37324, 37330, 37336, 37343, 37349, 37355, 37362, 37368, 37374, 37381, 37387, 37393, 37400, 37406, 37412, 37419,
+    37425, 37431, 37438, 37444, 37450, 37457, 37463, 37469, 37476, 37482, 37488, 37495, 37501, 37507, 37514, 37520,
+    37526, 37533, 37539, 37546, 37552, 37558, 37565, 37571, 37577, 37584, 37590, 37596, 37603, 37609, 37615, 37622,
+    37628, 37634, 37641, 37647, 37653, 37660, 37666, 37673, 37679, 37685, 37692, 37698, 37705, 37711, 37717, 37724,
+    37730, 37736, 37743, 37749, 37756, 37762, 37768, 37775, 37781, 37787, 37794, 37800, 37807, 37813, 37820, 37826,
+    37832, 37839, 37845, 37851, 37858, 37864, 37871, 37877, 37883, 37890, 37896, 37903, 37909, 37916, 37922, 37928,
+    37935, 37941, 37948, 37954, 37960, 37967, 37973, 37980, 37986, 37992, 37999, 38005, 38012, 38018, 38025, 38031,
+    38038, 38044, 38050, 38057, 38063, 38070, 38076, 38083, 38089, 38095, 38102, 38108, 38115, 38121, 38128, 38134,
+    38141, 38147, 38154, 38160, 38166, 38173, 38179, 38186, 38192, 38199, 38205, 38212, 38218, 38225, 38231, 38238,
+    38244, 38250, 38257, 38263, 38270, 38276, 38283, 38289, 38296, 38302, 38309, 38315, 38322, 38328, 38335, 38341,
+    38348, 38354, 38360, 38367, 38373, 38380, 38387, 38393, 38399, 38406, 38412, 38419, 38425, 38432, 38438, 38445,
+    38451, 38458, 38465, 38471, 38477, 38484, 38490, 38497, 38503, 38510, 38516, 38523, 38530, 38536, 38543, 38549,
+    38556, 38562, 38569, 38575, 38582, 38588, 38595, 38601, 38608, 38614, 38621, 38627, 38634, 38640, 38647, 38653,
+    38660, 38666, 38673, 38680, 38686, 38693, 38699, 38706, 38712, 38719, 38725, 38732, 38738, 38745, 38752, 38758,
+    38765, 38771, 38778, 38784, 38791, 38797, 38804, 38811, 38817, 38824, 38830, 38837, 38843, 38850, 38857, 38863,
+    38870, 38876, 38883, 38890, 38896, 38903, 38909, 38916, 38922, 38929, 38936, 38942, 38949, 38955, 38962, 38968,
+    38975, 38982, 38988, 38995, 39002, 39008, 39015, 39021, 39028, 39034, 39041, 39047, 39054, 39061, 39067, 39074,
+    39081, 39087, 39094, 39100, 39107, 39114, 39120, 39127, 39134, 39140, 39147, 39153, 39160, 39166, 39173, 39180,
+    39187, 39193, 39200, 39206, 39213, 39219, 39226, 39233, 39240, 39246, 39253, 39259, 39266, 39273, 39279, 39286,
+    39293, 39299, 39306, 39313, 39319, 39326, 39333, 39339, 39346, 39352, 39359, 39366, 39372, 39379, 39386, 39392,
+    39399, 39406, 39412, 39419, 39426, 39432, 39439, 39446, 39452, 39459, 39466, 39472, 39479, 39486, 39492, 39499,
+    39506, 39512, 39519, 39526, 39532, 39539, 39546, 39553, 39559, 39566, 39573, 39579, 39586, 39593, 39599, 39606,
+    39613, 39619, 39626, 39633, 39640, 39646, 39653, 39660, 39666, 39673, 39680, 39686, 39693, 39700, 39707, 39713,
+    39720, 39727, 39734, 39740, 39747, 39754, 39760, 39767, 39774, 39781, 39787, 39794, 39801, 39807, 39814, 39821,
+    39827, 39834, 39841, 39848, 39854, 39861, 39868, 39875, 39882, 39888, 39895, 39902, 39908, 39915, 39922, 39929,
+    39935, 39942, 39949, 39956, 39963, 39969, 39976, 39983, 39989, 39996, 40003, 40010, 40017, 40023, 40030, 40037,
+    40044, 40051, 40057, 40064, 40071, 40077, 40084, 40091, 40098, 40105, 40111, 40118, 40125, 40132, 40139, 40145,
+    40152, 40159, 40166, 40173, 40179, 40186, 40193, 40200, 40206, 40213, 40220, 40227, 40234, 40240, 40247, 40254,
+    40261, 40268, 40274, 40281, 40288, 40295, 40302, 40309, 40315, 40322, 40329, 40336, 40343, 40349, 40356, 40363,
+    40370, 40377, 40384, 40390, 40397, 40404, 40411, 40418, 40425, 40431, 40438, 40445, 40452, 40459, 40466, 40472,
+    40479, 40486, 40493, 40500, 40507, 40513, 40520, 40527, 40534, 40541, 40548, 40554, 40562, 40568, 40575, 40582,
+    40589, 40596, 40602, 40610, 40616, 40623, 40630, 40637, 40644, 40651, 40658, 40664, 40671, 40678, 40685, 40692,
+    40699, 40706, 40713, 40720, 40726, 40733, 40740, 40747, 40754, 40761, 40768, 40774, 40781, 40788, 40795, 40802,
+    40809, 40816, 40823, 40830, 40837, 40843, 40850, 40857, 40864, 40871, 40878, 40885, 40892, 40899, 40906, 40913,
+    40919, 40926, 40933, 40940, 40947, 40954, 40961, 40968, 40975, 40982, 40989, 40996, 41003, 41010, 41016, 41023,
+    41031, 41037, 41044, 41051, 41058, 41065, 41072, 41079, 41086, 41093, 41100, 41107, 41114, 41121, 41127, 41135,
+    41142, 41148, 41155, 41162, 41169, 41176, 41183, 41190, 41197, 41204, 41211, 41218, 41225, 41232, 41239, 41246,
+    41253, 41260, 41267, 41274, 41281, 41288, 41295, 41302, 41309, 41316, 41323, 41330, 41337, 41344, 41351, 41358,
+    41365, 41372, 41379, 41386, 41393, 41400, 41407, 41414, 41421, 41428, 41435, 41442, 41449, 41456, 41463, 41470,
+    41477, 41484, 41491, 41498, 41505, 41512, 41519, 41526, 41533, 41540, 41547, 41554, 41561, 41568, 41575, 41582,
+    41589, 41596, 41603, 41610, 41617, 41624, 41631, 41638, 41645, 41652, 41659, 41666, 41673, 41680, 41688, 41695,
+    41702, 41709, 41716, 41723, 41730, 41737, 41744, 41751, 41758, 41765, 41772, 41779, 41786, 41793, 41801, 41808,
+    41815, 41822, 41829, 41836, 41843, 41850, 41857, 41864, 41871, 41878, 41886, 41893, 41900, 41907, 41914, 41921,
+    41928, 41935, 41942, 41949, 41956, 41963, 41970, 41978, 41985, 41992, 41999, 42006, 42013, 42020, 42027, 42035,
+    42042, 42049, 42056, 42063, 42070, 42077, 42084, 42091, 42098, 42105, 42112, 42120, 42127, 42134, 42141, 42148,
+    42155, 42162, 42169, 42177, 42184, 42191, 42198, 42205, 42212, 42220, 42227, 42234, 42241, 42248, 42255, 42263,
+    42270, 42277, 42284, 42291, 42298, 42305, 42313, 42320, 42327, 42334, 42341, 42348, 42355, 42362, 42370, 42377,
+    42384, 42391, 42398, 42406, 42413, 42420, 42427, 42434, 42441, 42449, 42456, 42463, 42470, 42477, 42485, 42492,
+    42499, 42506, 42513, 42520, 42527, 42535, 42542, 42549, 42556, 42564, 42571, 42578, 42585, 42592, 42600, 42607,
+    42614, 42621, 42628, 42635, 42643, 42650, 42657, 42665, 42672, 42679, 42686, 42693, 42701, 42708, 42715, 42722,
+    42729, 42737, 42744, 42751, 42758, 42765, 42773, 42780, 42787, 42794, 42802, 42809, 42816, 42823, 42831, 42838,
+    42845, 42853, 42860, 42867, 42874, 42881, 42889, 42896, 42903, 42910, 42918, 42925, 42932, 42939, 42947, 42954,
+    42961, 42968, 42976, 42983, 42990, 42998, 43005, 43012, 43019, 43026, 43034, 43041, 43048, 43056, 43063, 43070,
+    43078, 43085, 43092, 43099, 43107, 43114, 43121, 43129, 43136, 43143, 43151, 43158, 43165, 43172, 43180, 43187,
+    43194, 43201, 43209, 43216, 43223, 43231, 43238, 43245, 43253, 43260, 43267, 43275, 43282, 43289, 43297, 43304,
+    43311, 43319, 43326, 43333, 43341, 43348, 43355, 43363, 43370, 43377, 43385, 43392, 43399, 43407, 43414, 43421,
+    43429, 43436, 43443, 43451, 43458, 43465, 43473, 43480, 43487, 43495, 43502, 43509, 43517, 43524, 43532, 43539,
+    43546, 43554, 43561, 43569, 43576, 43583, 43591, 43598, 43605, 43613, 43620, 43627, 43635, 43642, 43649, 43657,
+    43664, 43672, 43679, 43687, 43694, 43701, 43709, 43716, 43723, 43731, 43738, 43745, 43753, 43760, 43768, 43775,
+    43783, 43790, 43797, 43805, 43812, 43819, 43827, 43834, 43842, 43849, 43857, 43864, 43872, 43879, 43886, 43894,
+    43901, 43908, 43916, 43923, 43931, 43938, 43946, 43954, 43961, 43968, 43976, 43983, 43990, 43998, 44005, 44013,
+    44020, 44028, 44035, 44042, 44050, 44057, 44065, 44072, 44080, 44087, 44095, 44102, 44109, 44117, 44125, 44132,
+    44140, 44147, 44154, 44162, 44169, 44177, 44184, 44192, 44200, 44207, 44214, 44221, 44229, 44237, 44244, 44252,
+    44259, 44266, 44274, 44281, 44289, 44297, 44304, 44312, 44319, 44326, 44334, 44342, 44349, 44357, 44364, 44371,
+    44379, 44387, 44394, 44402, 44409, 44416, 44424, 44432, 44439, 44447, 44454, 44462, 44469, 44477, 44484, 44492,
+    44499, 44507, 44514, 44522, 44529, 44537, 44544, 44552, 44560, 44567, 44575, 44582, 44590, 44597, 44605, 44612,
+    44620, 44627, 44635, 44643, 44650, 44658, 44665, 44673, 44680, 44688, 44695, 44703, 44710, 44718, 44726, 44733,
+    44741, 44748, 44756, 44764, 44771, 44778, 44786, 44794, 44801, 44809, 44816, 44824, 44832, 44839, 44847, 44854,
+    44862, 44870, 44877, 44885, 44892, 44900, 44908, 44915, 44923, 44931, 44938, 44945, 44953, 44961, 44969, 44976,
+    44983, 44991, 44999, 45006, 45014, 45022, 45029, 45037, 45044, 45052, 45060, 45067, 45075, 45083, 45090, 45098,
+    45105, 45113, 45121, 45128, 45136, 45144, 45151, 45159, 45166, 45174, 45182, 45189, 45197, 45205, 45212, 45220,
+    45228, 45236, 45243, 45251, 45258, 45266, 45273, 45281, 45289, 45297, 45304, 45312, 45320, 45327, 45335, 45343,
+    45351, 45358, 45366, 45374, 45381, 45389, 45397, 45404, 45412, 45419, 45427, 45435, 45442, 45450, 45458, 45465,
+    45473, 45481, 45488, 45496, 45504, 45512, 45519, 45527, 45535, 45542, 45550, 45558, 45566, 45574, 45581, 45589,
+    45597, 45604, 45612, 45620, 45627, 45635, 45643, 45651, 45658, 45666, 45674, 45681, 45689, 45697, 45705, 45712,
+    45720, 45728, 45736, 45744, 45751, 45759, 45767, 45774, 45782, 45790, 45797, 45805, 45813, 45821, 45829, 45836,
+    45844, 45852, 45859, 45867, 45875, 45883, 45891, 45898, 45906, 45914, 45922, 45929, 45937, 45945, 45953, 45961,
+    45968, 45976, 45984, 45991, 45999, 46007, 46015, 46023, 46030, 46038, 46046, 46054, 46062, 46069, 46077, 46085,
+    46093, 46101, 46109, 46116, 46124, 46132, 46140, 46148, 46155, 46163, 46171, 46179, 46187, 46194, 46202, 46210,
+    46218, 46226, 46234, 46241, 46249, 46257, 46265, 46273, 46281, 46288, 46296, 46304, 46312, 46320, 46327, 46335,
+    46344, 46351, 46359, 46366, 46375, 46383, 46390, 46398, 46406, 46414, 46422, 46429, 46437, 46445, 46453, 46461,
+    46469, 46476, 46485, 46493, 46500, 46508, 46516, 46524, 46532, 46540, 46547, 46555, 46563, 46571, 46579, 46587,
+    46595, 46602, 46611, 46618, 46626, 46634, 46642, 46650, 46658, 46666, 46673, 46682, 46689, 46697, 46705, 46713,
+    46721, 46729, 46737, 46745, 46753, 46760, 46769, 46776, 46785, 46792, 46800, 46808, 46816, 46824, 46832, 46839,
+    46848, 46856, 46864, 46871, 46880, 46887, 46895, 46903, 46911, 46919, 46927, 46935, 46943, 46951, 46959, 46967,
+    46975, 46983, 46991, 46999, 47007, 47014, 47022, 47030, 47038, 47046, 47054, 47062, 47070, 47078, 47086, 47094,
+    47102, 47110, 47118, 47126, 47134, 47142, 47150, 47158, 47166, 47174, 47182, 47190, 47198, 47206, 47214, 47222,
+    47230, 47238, 47246, 47254, 47262, 47270, 47277, 47286, 47294, 47302, 47310, 47318, 47326, 47333, 47342, 47350,
+    47358, 47366, 47374, 47382, 47390, 47398, 47406, 47414, 47422, 47430, 47438, 47446, 47454, 47462, 47470, 47478,
+    47486, 47494, 47503, 47510, 47518, 47526, 47534, 47543, 47551, 47559, 47566, 47575, 47583, 47591, 47599, 47607,
+    47615, 47623, 47631, 47639, 47647, 47656, 47663, 47671, 47680, 47687, 47696, 47704, 47712, 47720, 47728, 47736,
+    47744, 47752, 47760, 47768, 47777, 47784, 47792, 47801, 47809, 47817, 47825, 47833, 47841, 47849, 47858, 47865,
+    47874, 47882, 47890, 47898, 47906, 47914, 47923, 47930, 47938, 47947, 47954, 47963, 47971, 47979, 47987, 47995,
+    48003, 48012, 48019, 48028, 48036, 48044, 48052, 48060, 48068, 48077, 48085, 48093, 48101, 48109, 48117, 48125,
+    48133, 48142, 48150, 48158, 48166, 48174, 48182, 48190, 48199, 48207, 48215, 48223, 48231, 48239, 48248, 48256,
+    48264, 48272, 48280, 48289, 48297, 48305, 48313, 48322, 48329, 48338, 48346, 48354, 48362, 48370, 48378, 48387,
+    48395, 48403, 48411, 48420, 48428, 48436, 48444, 48453, 48460, 48469, 48477, 48485, 48493, 48501, 48510, 48518,
+    48526, 48535, 48542, 48551, 48559, 48567, 48575, 48584, 48592, 48600, 48608, 48617, 48625, 48633, 48641, 48650,
+    48658, 48666, 48675, 48683, 48690, 48699, 48707, 48715, 48724, 48732, 48740, 48748, 48757, 48765, 48773, 48781,
+    48790, 48798, 48806, 48814, 48823, 48831, 48839, 48847, 48856, 48864, 48872, 48881, 48889, 48897, 48906, 48913,
+    48922, 48930, 48939, 48947, 48955, 48964, 48972, 48980, 48988, 48996, 49005, 49013, 49021, 49030, 49038, 49046,
+    49054, 49063, 49071, 49080, 49088, 49096, 49105, 49113, 49121, 49129, 49138, 49146, 49154, 49163, 49171, 49179,
+    49188, 49196, 49204, 49213, 49221, 49229, 49238, 49246, 49254, 49263, 49271, 49280, 49288, 49296, 49304, 49313,
+    49321, 49329, 49338, 49346, 49355, 49363, 49371, 49379, 49388, 49396, 49405, 49413, 49421, 49430, 49438, 49446,
+    49455, 49463, 49472, 49480, 49488, 49497, 49505, 49514, 49522, 49530, 49538, 49547, 49556, 49564, 49572, 49580,
+    49589, 49597, 49606, 49614, 49623, 49631, 49639, 49648, 49656, 49665, 49673, 49682, 49690, 49698, 49706, 49715,
+    49723, 49732, 49741, 49749, 49757, 49766, 49774, 49783, 49791, 49800, 49808, 49816, 49824, 49833, 49841, 49850,
+    49858, 49867, 49875, 49884, 49892, 49901, 49909, 49917, 49926, 49934, 49943, 49951, 49960, 49968, 49976, 49985,
+    49994, 50002, 50011, 50019, 50028, 50036, 50044, 50053, 50061, 50069, 50078, 50087, 50095, 50104, 50112, 50121,
+    50129, 50138, 50146, 50155, 50163, 50171, 50180, 50188, 50197, 50205, 50214, 50223, 50231, 50240, 50248, 50257,
+    50265, 50274, 50282, 50291, 50299, 50308, 50316, 50325, 50333, 50342, 50350, 50359, 50367, 50376, 50385, 50393,
+    50402, 50410, 50419, 50427, 50436, 50444, 50453, 50461, 50470, 50478, 50487, 50495, 50504, 50512, 50521, 50529,
+    50538, 50547, 50555, 50564, 50573, 50581, 50590, 50598, 50607, 50616, 50624, 50633, 50641, 50650, 50658, 50667,
+    50675, 50684, 50692, 50701, 50710, 50718, 50727, 50736, 50744, 50753, 50761, 50770, 50779, 50787, 50796, 50805,
+    50813, 50822, 50830, 50839, 50847, 50856, 50864, 50873, 50882, 50890, 50899, 50907, 50916, 50924, 50933, 50942,
+    50950, 50959, 50968, 50976, 50985, 50993, 51002, 51011, 51019, 51028, 51037, 51046, 51054, 51063, 51072, 51080,
+    51089, 51098, 51106, 51115, 51123, 51132, 51141, 51149, 51158, 51166, 51175, 51184, 51192, 51201, 51210, 51219,
+    51228, 51236, 51245, 51253, 51262, 51271, 51279, 51288, 51297, 51305, 51314, 51323, 51332, 51340, 51349, 51358,
+    51367, 51375, 51384, 51393, 51401, 51410, 51418, 51427, 51436, 51445, 51454, 51462, 51471, 51480, 51488, 51497,
+    51505, 51514, 51523, 51532, 51541, 51549, 51558, 51567, 51575, 51584, 51593, 51602, 51611, 51619, 51628, 51636,
+    51645, 51654, 51663, 51672, 51680, 51689, 51698, 51706, 51715, 51724, 51733, 51742, 51750, 51759, 51768, 51776,
+    51785, 51794, 51803, 51812, 51821, 51829, 51838, 51846, 51855, 51864, 51873, 51882, 51891, 51899, 51908, 51917,
+    51926, 51935, 51943, 51952, 51961, 51970, 51979, 51988, 51996, 52005, 52013, 52023, 52032, 52040, 52049, 52058,
+    52066, 52076, 52084, 52093, 52102, 52110, 52119, 52129, 52137, 52146, 52155, 52163, 52173, 52181, 52190, 52199,
+    52208, 52217, 52226, 52234, 52243, 52252, 52261, 52270, 52279, 52287, 52296, 52305, 52314, 52323, 52332, 52341,
+    52350, 52359, 52367, 52376, 52385, 52394, 52403, 52412, 52420, 52430, 52439, 52447, 52456, 52465, 52474, 52483,
+    52492, 52500, 52510, 52518, 52527, 52536, 52545, 52554, 52563, 52571, 52581, 52589, 52598, 52607, 52616, 52625,
+    52634, 52643, 52652, 52661, 52669, 52678, 52687, 52696, 52705, 52714, 52723, 52732, 52741, 52750, 52759, 52768,
+    52777, 52786, 52795, 52804, 52812, 52822, 52831, 52839, 52849, 52857, 52866, 52875, 52884, 52893, 52902, 52911,
+    52920, 52928, 52938, 52947, 52955, 52965, 52974, 52982, 52991, 53001, 53010, 53018, 53028, 53037, 53046, 53054,
+    53064, 53073, 53081, 53091, 53099, 53108, 53118, 53126, 53135, 53145, 53153, 53162, 53172, 53180, 53189, 53199,
+    53207, 53216, 53226, 53235, 53243, 53253, 53262, 53271, 53280, 53289, 53297, 53307, 53316, 53324, 53334, 53343,
+    53351, 53361, 53369, 53379, 53388, 53397, 53406, 53415, 53424, 53433, 53443, 53451, 53461, 53469, 53478, 53488,
+    53496, 53506, 53515, 53523, 53533, 53541, 53551, 53560, 53569, 53578, 53587, 53596, 53606, 53615, 53623, 53633,
+    53641, 53651, 53660, 53669, 53678, 53687, 53696, 53705, 53714, 53723, 53732, 53742, 53751, 53760, 53769, 53778,
+    53787, 53796, 53805, 53814, 53823, 53833, 53841, 53851, 53860, 53869, 53879, 53887, 53897, 53906, 53915, 53924,
+    53933, 53942, 53951, 53961, 53969, 53979, 53988, 53997, 54006, 54015, 54025, 54034, 54043, 54052, 54061, 54070,
+    54079, 54088, 54097, 54107, 54116, 54125, 54134, 54144, 54153, 54162, 54171, 54180, 54189, 54198, 54208, 54216,
+    54226, 54235, 54245, 54254, 54263, 54272, 54281, 54290, 54300, 54309, 54318, 54327, 54336, 54345, 54354, 54364,
+    54373, 54383, 54391, 54401, 54410, 54419, 54428, 54437, 54446, 54456, 54465, 54475, 54484, 54493, 54502, 54511,
+    54520, 54530, 54539, 54548, 54557, 54567, 54576, 54585, 54594, 54604, 54613, 54622, 54632, 54640, 54650, 54659,
+    54669, 54678, 54687, 54696, 54706, 54714, 54724, 54733, 54742, 54752, 54761, 54771, 54780, 54789, 54798, 54808,
+    54816, 54826, 54835, 54844, 54854, 54863, 54873, 54882, 54891, 54900, 54910, 54919, 54928, 54937, 54946, 54957,
+    54965, 54975, 54984, 54993, 55003, 55012, 55021, 55030, 55040, 55049, 55059, 55068, 55077, 55087, 55095, 55105,
+    55115, 55124, 55134, 55142, 55152, 55161, 55170, 55180, 55189, 55198, 55208, 55217, 55227, 55236, 55245, 55255,
+    55264, 55273, 55282, 55292, 55302, 55311, 55320, 55329, 55339, 55348, 55357, 55367, 55376, 55386, 55395, 55404,
+    55414, 55423, 55432, 55442, 55451, 55461, 55471, 55479, 55489, 55498, 55507, 55517, 55527, 55536, 55546, 55555,
+    55564, 55573, 55583, 55592, 55602, 55611, 55621, 55630, 55639, 55649, 55658, 55668, 55677, 55687, 55696, 55705,
+    55715, 55724, 55733, 55743, 55753, 55762, 55772, 55781, 55790, 55800, 55809, 55818, 55828, 55838, 55847, 55856,
+    55866, 55875, 55884, 55894, 55904, 55913, 55923, 55932, 55941, 55951, 55960, 55970, 55980, 55989, 55998, 56008,
+    56017, 56027, 56036, 56046, 56056, 56065, 56074, 56084, 56093, 56102, 56112, 56122, 56131, 56140, 56150, 56160,
+    56169, 56179, 56189, 56198, 56207, 56216, 56226, 56236, 56245, 56255, 56265, 56274, 56283, 56292, 56303, 56312,
+    56321, 56331, 56341, 56350, 56359, 56369, 56379, 56389, 56398, 56407, 56417, 56427, 56436, 56446, 56455, 56465,
+    56474, 56483, 56493, 56503, 56513, 56522, 56531, 56541, 56551, 56561, 56570, 56579, 56589, 56599, 56608, 56618,
+    56628, 56637, 56647, 56656, 56665, 56675, 56685, 56695, 56704, 56713, 56723, 56733, 56743, 56752, 56761, 56771,
+    56781, 56791, 56801, 56810, 56819, 56829, 56838, 56848, 56858, 56867, 56877, 56887, 56896, 56906, 56916, 56925,
+    56935, 56944, 56954, 56964, 56974, 56983, 56993, 57002, 57012, 57022, 57032, 57041, 57050, 57060, 57070, 57080,
+    57090, 57099, 57108, 57118, 57127, 57138, 57148, 57157, 57167, 57176, 57185, 57196, 57206, 57215, 57225, 57234,
+    57244, 57254, 57263, 57273, 57283, 57292, 57303, 57312, 57322, 57331, 57341, 57350, 57361, 57370, 57380, 57390,
+    57399, 57410, 57419, 57428, 57438, 57447, 57457, 57468, 57477, 57487, 57496, 57506, 57517, 57526, 57535, 57545,
+    57554, 57564, 57575, 57584, 57594, 57603, 57613, 57624, 57633, 57643, 57653, 57662, 57672, 57681, 57691, 57701,
+    57710, 57721, 57731, 57740, 57750, 57760, 57770, 57780, 57789, 57799, 57809, 57819, 57829, 57838, 57848, 57857,
+    57867, 57877, 57887, 57896, 57906, 57916, 57926, 57936, 57946, 57955, 57965, 57975, 57985, 57995, 58004, 58014,
+    58025, 58034, 58044, 58053, 58064, 58074, 58083, 58093, 58103, 58113, 58123, 58133, 58142, 58152, 58162, 58172,
+    58182, 58191, 58201, 58212, 58221, 58231, 58240, 58250, 58261, 58270, 58280, 58290, 58300, 58310, 58320, 58329,
+    58339, 58349, 58359, 58369, 58378, 58388, 58399, 58408, 58418, 58428, 58438, 58448, 58458, 58468, 58478, 58488,
+    58498, 58508, 58517, 58527, 58537, 58547, 58557, 58566, 58577, 58587, 58596, 58606, 58616, 58626, 58636, 58646,
+    58656, 58666, 58676, 58686, 58696, 58705, 58716, 58725, 58735, 58745, 58755, 58765, 58775, 58785, 58795, 58805,
+    58815, 58825, 58834, 58845, 58855, 58864, 58874, 58885, 58895, 58905, 58914, 58924, 58935, 58944, 58954, 58964,
+    58974, 58985, 58994, 59004, 59014, 59024, 59034, 59044, 59054, 59065, 59075, 59084, 59094, 59104, 59114, 59124,
+    59134, 59145, 59155, 59164, 59174, 59184, 59194, 59204, 59214, 59224, 59235, 59244, 59254, 59264, 59274, 59285,
+    59294, 59304, 59315, 59324, 59334, 59345, 59355, 59365, 59375, 59384, 59395, 59405, 59415, 59425, 59435, 59445,
+    59455, 59465, 59476, 59485, 59495, 59505, 59516, 59526, 59536, 59545, 59556, 59566, 59576, 59586, 59596, 59606,
+    59616, 59626, 59637, 59647, 59656, 59666, 59677, 59687, 59697, 59706, 59717, 59728, 59737, 59747, 59758, 59768,
+    59778, 59787, 59798, 59808, 59818, 59828, 59839, 59848, 59859, 59869, 59879, 59889, 59899, 59909, 59920, 59929,
+    59940, 59950, 59960, 59970, 59980, 59991, 60001, 60010, 60021, 60032, 60041, 60051, 60061, 60072, 60082, 60091,
+    60103, 60113, 60122, 60132, 60144, 60153, 60163, 60173, 60184, 60194, 60203, 60214, 60225, 60234, 60244, 60255,
+    60265, 60275, 60285, 60296, 60306, 60315, 60326, 60337, 60346, 60357, 60367, 60377, 60387, 60397, 60408, 60418,
+    60428, 60438, 60448, 60459, 60469, 60479, 60490, 60500, 60509, 60521, 60531, 60540, 60551, 60561, 60571, 60582,
+    60592, 60602, 60612, 60623, 60633, 60643, 60653, 60664, 60674, 60684, 60694, 60705, 60715, 60725, 60736, 60746,
+    60755, 60766, 60777, 60786, 60797, 60808, 60817, 60828, 60838, 60849, 60859, 60868, 60880, 60890, 60899, 60911,
+    60921, 60931, 60941, 60951, 60962, 60972, 60982, 60993, 61003, 61013, 61024, 61033, 61044, 61055, 61065, 61075,
+    61085, 61096, 61106, 61117, 61127, 61137, 61147, 61158, 61169, 61178, 61189, 61200, 61209, 61220, 61231, 61240,
+    61251, 61261, 61272, 61282, 61293, 61303, 61313, 61323, 61334, 61344, 61354, 61366, 61375, 61385, 61397, 61406,
+    61417, 61427, 61438, 61448, 61458, 61469, 61479, 61489, 61500, 61511, 61520, 61532, 61541, 61552, 61562, 61573,
+    61583, 61594, 61604, 61614, 61625, 61635, 61646, 61655, 61667, 61677, 61687, 61698, 61709, 61718, 61729, 61739,
+    61750, 61760, 61771, 61781, 61792, 61802, 61813, 61823, 61834, 61844, 61854, 61865, 61876, 61885, 61897, 61907,
+    61917, 61928, 61938, 61948, 61959, 61969, 61980, 61990, 62001, 62011, 62022, 62032, 62043, 62052, 62064, 62074,
+    62084, 62095, 62106, 62116, 62127, 62137, 62147, 62159, 62168, 62179, 62190, 62200, 62211, 62222, 62232, 62242,
+    62253, 62263, 62274, 62284, 62295, 62305, 62316, 62327, 62336, 62348, 62358, 62368, 62379, 62390, 62400, 62411,
+    62422, 62431, 62443, 62453, 62463, 62475, 62484, 62495, 62506, 62516, 62527, 62537, 62548, 62558, 62569, 62580,
+    62590, 62601, 62611, 62622, 62633, 62643, 62653, 62664, 62675, 62685, 62696, 62707, 62718, 62728, 62738, 62749,
+    62760, 62770, 62781, 62792, 62802, 62813, 62824, 62833, 62845, 62855, 62865, 62877, 62887, 62897, 62909, 62919,
+    62929, 62940, 62951, 62962, 62972, 62982, 62994, 63004, 63014, 63026, 63036, 63046, 63057, 63068, 63078, 63089,
+    63100, 63110, 63121, 63132, 63142, 63153, 63164, 63174, 63185, 63196, 63207, 63217, 63228, 63239, 63249, 63260,
+    63271, 63281, 63292, 63303, 63313, 63324, 63335, 63346, 63356, 63367, 63377, 63388, 63399, 63410, 63420, 63431,
+    63442, 63453, 63462, 63474, 63485, 63495, 63506, 63517, 63528, 63538, 63549, 63560, 63571, 63580, 63592, 63603,
+    63614, 63624, 63635, 63646, 63657, 63666, 63678, 63689, 63700, 63710, 63721, 63732, 63743, 63753, 63764, 63775,
+    63786, 63796, 63807, 63818, 63829, 63839, 63850, 63861, 63872, 63883, 63893, 63904, 63915, 63926, 63936, 63947,
+    63959, 63969, 63980, 63990, 64001, 64012, 64023, 64034, 64045, 64055, 64066, 64077, 64088, 64099, 64109, 64120,
+    64132, 64142, 64152, 64164, 64174, 64186, 64196, 64206, 64218, 64228, 64240, 64251, 64261, 64272, 64282, 64293,
+    64305, 64315, 64327, 64337, 64347, 64359, 64370, 64381, 64392, 64401, 64413, 64424, 64435, 64446, 64457, 64468,
+    64478, 64489, 64500, 64511, 64522, 64533, 64545, 64554, 64565, 64577, 64587, 64599, 64609, 64620, 64632, 64641,
+    64653, 64664, 64674, 64686, 64696, 64708, 64719, 64729, 64740, 64751, 64762, 64773, 64784, 64795, 64806, 64817,
+    64828, 64839, 64849, 64860, 64872, 64882, 64893, 64904, 64915, 64927, 64937, 64948, 64960, 64969, 64981, 64992,
+    65002, 65014, 65024, 65036, 65047, 65058, 65069, 65080, 65091, 65102, 65113, 65124, 65135, 65145, 65156, 65168,
+    65178, 65189, 65201, 65211, 65223, 65233, 65245, 65256, 65266, 65278, 65289, 65300, 65311, 65321, 65333, 65344,
+    65355, 65366, 65378, 65388, 65399, 65411, 65421, 65433, 65443, 65455, 65466, 65476, 65488, 65499, 65510, 65521
+};
+#endif
+
 /*----------------------------------------------------------------------------
  * EAS_Calculate2toX()
  *----------------------------------------------------------------------------
@@ -58,7 +326,10 @@ EAS_I32 EAS_Calculate2toX (EAS_I32 nCents)
 {
     EAS_I32 nDents;
     EAS_I32 nExponentInt, nExponentFrac;
-    EAS_I32 nTemp1, nTemp2;
+    EAS_I32 nTemp1;
+#ifndef _MATH_TABLES
+    EAS_I32 nTemp2;
+#endif
     EAS_I32 nResult;
 
     /* check for minimum value */
@@ -75,12 +346,17 @@ EAS_I32 EAS_Calculate2toX (EAS_I32 nCents)
     nExponentInt = GET_DENTS_INT_PART(nDents);
     nExponentFrac = GET_DENTS_FRAC_PART(nDents);
 
+#ifdef _MATH_TABLES
+    /* look up 2^(fracPart) */
+    nTemp1 = eas2toXTable[nExponentFrac];
+#else
     /*
     implement 2^(fracPart) as a power series
     */
     nTemp1 = GN2_TO_X2 + MULT_DENTS_COEF(nExponentFrac, GN2_TO_X3);
     nTemp2 = GN2_TO_X1 + MULT_DENTS_COEF(nExponentFrac, nTemp1);
     nTemp1 = GN2_TO_X0 + MULT_DENTS_COEF(nExponentFrac, nTemp2);
+#endif
 
     /*
     implement 2^(intPart) as
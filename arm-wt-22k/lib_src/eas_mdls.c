@@ -39,7 +39,10 @@
  * the host wrapper functions, we avoid having to flip bytes around
  * for big-endian processors. The default host wrapper versions of
  * these functions are insensitive to processor endian-ness due to
- * the fact that they read the file as a byte stream.
+ * the fact that they read the file as a byte stream. The chunk
+ * headers and articulation connections, which make up most of the
+ * reads, are read in blocks and assembled a byte at a time, which
+ * is just as insensitive.
  *
  * Dynamic Memory:
  *
@@ -57,10 +60,12 @@
  *
  * Parser Overview:
  *
- * We make two passes through the file, the first pass to count the
- * number of instruments, regions, etc. and allocate memory for
- * them. The second pass parses the data into the allocated data
- * structures.
+ * We make one pass through the file. The wave pool is parsed first,
+ * noting where the sample data of each wave is and how much memory
+ * it needs once converted. The instruments are then converted into
+ * temporary pools that grow as needed. Once everything is counted,
+ * the main block is allocated, the pools are copied into it and the
+ * samples are read straight from the positions noted earlier.
  *
  * Conditional chunks are challenging in that they can occur
  * anywhere in the list chunk that contains them. To simplify, we
@@ -102,6 +107,9 @@
  * structures.
 */
 
+/* allocations of this module are reported as DLS memory */
+#define EAS_MEM_CATEGORY    EAS_MEM_DLS
+
 #ifndef _FILTER_ENABLED
 #error "Filter must be enabled if DLS_SYNTHESIZER is enabled"
 #endif
@@ -123,12 +131,32 @@
 #include "dls.h"
 #include "dls2.h"
 #include "eas_report.h"
+#include <stdint.h>
 #include <string.h>
 
 //2 we should replace log10() function with fixed point routine in ConvertSampleRate()
 /* lint is choking on the ARM math.h file, so we declare the log10 function here */
 extern double log10(double x);
 
+/*----------------------------------------------------------------------------
+ * Vector kernels
+ *
+ * The conversion of 8-bit waves to 16-bit samples is vectorized with NEON
+ * or SSE2 intrinsics when the target always provides them. Define
+ * _NO_SIMD_KERNEL to force the C reference code, the output is bit-exact
+ * either way.
+ *----------------------------------------------------------------------------
+*/
+#if !defined(_NO_SIMD_KERNEL) && defined(_16_BIT_SAMPLES)
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define _NEON_KERNEL
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#define _SSE2_KERNEL
+#include <emmintrin.h>
+#endif
+#endif
+
 /*------------------------------------
  * defines
  *------------------------------------
@@ -142,6 +170,21 @@ extern double log10(double x);
 #define DLS_MAX_INST_COUNT      256
 #define MAX_DLS_WAVE_SIZE       (1024*1024)
 
+/* initial size of the temporary program, region and articulation pools */
+#define DLS_INITIAL_POOL_COUNT  16
+
+/* number of articulation connections read at a time */
+#define DLS_CONNECTION_BLOCK    16
+#define DLS_CONNECTION_SIZE     12
+
+/* space taken by a wave in the wave pool */
+#ifdef _CACHE_ALIGNED_SAMPLES
+/* each wave starts on a cache line and is followed by at least one silent sample */
+#define DLS_WAVE_POOL_SIZE(n)   (((EAS_U32) (n) + sizeof(EAS_SAMPLE) + EAS_CACHE_LINE_SIZE - 1) & ~(EAS_U32) (EAS_CACHE_LINE_SIZE - 1))
+#else
+#define DLS_WAVE_POOL_SIZE(n)   ((EAS_U32) (n))
+#endif
+
 #ifndef EAS_U32_MAX
 #define EAS_U32_MAX             (4294967295U)
 #endif
@@ -234,6 +277,9 @@ typedef struct
     EAS_U16 bitsPerSample;
     EAS_I16 fineTune;
     EAS_U8  unityNote;
+    EAS_I32 dataPos;
+    EAS_I32 dataSize;
+    EAS_U32 sampleLen;
 } S_WSMP_DATA;
 
 /* temporary data structure used while parsing a DLS file */
@@ -249,8 +295,13 @@ typedef struct
     EAS_U32             waveCount;
     EAS_U32             wavePoolSize;
     EAS_U32             wavePoolOffset;
+    EAS_U32             instCapacity;
+    EAS_U32             regionCapacity;
+    EAS_U32             artCapacity;
     EAS_BOOL            bigEndian;
     EAS_BOOL            filterUsed;
+    EAS_U32             lastSampleRate;
+    EAS_I16             lastSampleRateCents;
 } SDLS_SYNTHESIZER_DATA;
 
 /* connection lookup table */
@@ -422,6 +473,8 @@ static EAS_RESULT Parse_wave (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
 static EAS_RESULT Parse_wsmp (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, S_WSMP_DATA *p);
 static EAS_RESULT Parse_fmt (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, S_WSMP_DATA *p);
 static EAS_RESULT Parse_data (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_I32 size, S_WSMP_DATA *p, EAS_SAMPLE *pSample, EAS_U32 sampleLen);
+static EAS_RESULT LoadWaves (SDLS_SYNTHESIZER_DATA *pDLSData);
+static EAS_RESULT GrowPool (SDLS_SYNTHESIZER_DATA *pDLSData, void **ppPool, EAS_U32 *pCapacity, EAS_U32 index, EAS_U32 maxCount, EAS_I32 elementSize);
 static EAS_RESULT Parse_lins(SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_I32 size);
 static EAS_RESULT Parse_ins (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_I32 size);
 static EAS_RESULT Parse_insh (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_U32 *pRgnCount, EAS_U32 *pLocale);
@@ -434,26 +487,247 @@ static EAS_RESULT Parse_wlnk (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
 static EAS_RESULT Parse_cdl (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 size, EAS_U32 *pValue);
 static void Convert_rgn (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_U16 regionIndex, EAS_U16 artIndex, EAS_U16 waveIndex, S_WSMP_DATA *pWsmp);
 static void Convert_art (SDLS_SYNTHESIZER_DATA *pDLSData, const S_DLS_ART_VALUES *pDLSArt,  EAS_U16 artIndex);
+#ifdef _DLS_ENVELOPE_RATES
+static void ConvertEnvelopeRates (S_DLS_ENVELOPE *pEnv);
+#endif
 static EAS_I16 ConvertSampleRate (EAS_U32 sampleRate);
 static EAS_I16 ConvertSustain (EAS_I32 sustain);
 static EAS_I16 ConvertLFOPhaseIncrement (EAS_I32 pitchCents);
 static EAS_I8 ConvertPan (EAS_I32 pan);
 static EAS_U8 ConvertQ (EAS_I32 q);
+#ifdef _DLS_PROGRAM_INDEX
+static void BuildProgramIndex (S_DLS *pDLS);
+#endif
+#ifdef _DLS_KEY_INDEX
+static void BuildKeyIndex (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS, EAS_INT memCategory);
+#endif
 
 #ifdef _DEBUG_DLS
 static void DumpDLS (S_EAS *pEAS);
 #endif
 
+#ifdef _DLS_COLLECTION_CACHE
+/* converted collections shared by all library instances, protected by EAS_HWGlobalLock */
+static S_DLS *pDLSCache = NULL;
+#endif
+
+static EAS_RESULT DLSParseCollection (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_BOOL lazy, EAS_INT memCategory, EAS_DLSLIB_HANDLE *ppDLS);
+static void DLSFreeCollection (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS);
+
+#ifdef _DLS_COLLECTION_CACHE
+/*----------------------------------------------------------------------------
+ * DLSReadCollection ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reads the RIFF chunk of the DLS collection at offset into memory that
+ * any instance may free, and hashes it
+ *
+ * Inputs:
+ * hwInstData - host instance data
+ * fileHandle - file handle for input file
+ * offset - offset into file where DLS data starts
+ *
+ * Outputs:
+ * EAS_RESULT
+ * ppData, pSize, pHash - contents of the chunk, its size and FNV-1a hash
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT DLSReadCollection (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_U8 **ppData, EAS_I32 *pSize, EAS_U32 *pHash)
+{
+    EAS_RESULT result;
+    EAS_U32 chunkType;
+    EAS_I32 chunkSize;
+    EAS_I32 count;
+    EAS_U8 *pData;
+    EAS_U32 hash;
+    EAS_I32 i;
+
+    /* get the size of the RIFF chunk */
+    if ((result = EAS_HWFileSeek(hwInstData, fileHandle, offset)) != EAS_SUCCESS)
+        return result;
+    if ((result = EAS_HWGetDWord(hwInstData, fileHandle, &chunkType, EAS_TRUE)) != EAS_SUCCESS)
+        return result;
+    if ((result = EAS_HWGetDWord(hwInstData, fileHandle, &chunkSize, EAS_FALSE)) != EAS_SUCCESS)
+        return result;
+    if ((chunkSize <= 0) || (chunkSize > 0x7ffffff0))
+        return EAS_ERROR_FILE_FORMAT;
+    chunkSize += 8;
+
+    /* read the whole chunk, a cache hit is confirmed by comparing the contents */
+    if ((pData = EAS_HWMallocCategory(hwInstData, chunkSize, EAS_MEM_SHARED)) == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    if ((result = EAS_HWFileSeek(hwInstData, fileHandle, offset)) == EAS_SUCCESS)
+        result = EAS_HWReadFile(hwInstData, fileHandle, pData, chunkSize, &count);
+    if ((result != EAS_SUCCESS) || (count != chunkSize))
+    {
+        EAS_HWFree(hwInstData, pData);
+        return EAS_ERROR_FILE_READ_FAILED;
+    }
+    hash = 2166136261UL;
+    for (i = 0; i < chunkSize; i++)
+        hash = ((hash ^ pData[i]) * 16777619UL) & 0xffffffffUL;
+
+    *ppData = pData;
+    *pSize = chunkSize;
+    *pHash = hash;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * DLSFindCollection ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the cached collection converted from a chunk with these
+ * contents. The caller holds EAS_HWGlobalLock.
+ *
+ * Inputs:
+ * pData - contents of the chunk
+ * size - size of the chunk in bytes
+ * hash - FNV-1a hash of the contents
+ *
+ * Outputs:
+ * the collection, or NULL if there is none or it can't take another reference
+ *
+ *----------------------------------------------------------------------------
+*/
+static S_DLS *DLSFindCollection (const EAS_U8 *pData, EAS_I32 size, EAS_U32 hash)
+{
+    S_DLS *pDLS;
+
+    for (pDLS = pDLSCache; pDLS != NULL; pDLS = pDLS->pCacheNext)
+    {
+        if ((pDLS->cacheSize == size) && (pDLS->cacheHash == hash) && (pDLS->refCount < 0xffff) &&
+            (EAS_HWMemCmp(pDLS->pCacheData, pData, size) == 0))
+            return pDLS;
+    }
+    return NULL;
+}
+#endif
 
 /*----------------------------------------------------------------------------
  * DLSParser ()
  *----------------------------------------------------------------------------
  * Purpose:
+ * Returns the converted DLS collection at offset. With
+ * _DLS_COLLECTION_CACHE, collections with identical contents are
+ * converted once and shared by all library instances in the process
+ * that allocate from the C library heap.
+ *
+ * Inputs:
+ * hwInstData - host instance data
+ * fileHandle - file handle for input file
+ * offset - offset into file where DLS data starts
+ *
+ * Outputs:
+ * EAS_RESULT
+ * ppDLS - address of pointer to the DLS collection
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_DLSLIB_HANDLE *ppDLS)
+{
+#ifdef _DLS_COLLECTION_CACHE
+    EAS_RESULT result;
+    S_DLS *pDLS;
+    S_DLS *pNewDLS;
+    EAS_U8 *pData;
+    EAS_I32 size;
+    EAS_U32 hash;
+
+    /* another instance could not free memory from a private heap */
+    *ppDLS = NULL;
+    if (!EAS_HWSharedHeap(hwInstData))
+        return DLSParseCollection(hwInstData, fileHandle, offset, EAS_FALSE, EAS_MEM_DLS, ppDLS);
+
+    /* collections that can't be read are not cached, let the parser report the error */
+    if (DLSReadCollection(hwInstData, fileHandle, offset, &pData, &size, &hash) != EAS_SUCCESS)
+        return DLSParseCollection(hwInstData, fileHandle, offset, EAS_FALSE, EAS_MEM_DLS, ppDLS);
+
+    /* use the cached collection if there is one */
+    EAS_HWGlobalLock();
+    if ((pDLS = DLSFindCollection(pData, size, hash)) != NULL)
+        pDLS->refCount++;
+    EAS_HWGlobalUnlock();
+    if (pDLS != NULL)
+    {
+        EAS_HWFree(hwInstData, pData);
+        *ppDLS = pDLS;
+        return EAS_SUCCESS;
+    }
+
+    /* convert it without holding the lock, the instance that frees it may be another one */
+    if ((result = DLSParseCollection(hwInstData, fileHandle, offset, EAS_FALSE, EAS_MEM_SHARED, (EAS_DLSLIB_HANDLE*) &pNewDLS)) != EAS_SUCCESS)
+    {
+        EAS_HWFree(hwInstData, pData);
+        return result;
+    }
+    pNewDLS->cacheSize = size;
+    pNewDLS->cacheHash = hash;
+    pNewDLS->pCacheData = pData;
+
+    /* another instance may have converted the same collection in the meantime */
+    EAS_HWGlobalLock();
+    if ((pDLS = DLSFindCollection(pData, size, hash)) != NULL)
+    {
+        pDLS->refCount++;
+        EAS_HWGlobalUnlock();
+        DLSFreeCollection(hwInstData, pNewDLS);
+        *ppDLS = pDLS;
+        return EAS_SUCCESS;
+    }
+    pNewDLS->pCacheNext = pDLSCache;
+    pDLSCache = pNewDLS;
+    EAS_HWGlobalUnlock();
+
+    *ppDLS = pNewDLS;
+    return EAS_SUCCESS;
+#else
+    return DLSParseCollection(hwInstData, fileHandle, offset, EAS_FALSE, EAS_MEM_DLS, ppDLS);
+#endif
+}
+
+#ifdef _DLS_LAZY_SAMPLES
+/*----------------------------------------------------------------------------
+ * DLSParserLazy ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts the DLS collection at offset without loading its samples.
+ * Each wave is loaded by DLSLoadWave the first time a note needs it,
+ * through a duplicate of fileHandle, so the collection must be released
+ * before the host closes the file. For that reason it is not shared
+ * through the collection cache.
+ *
+ * Inputs:
+ * hwInstData - host instance data
+ * fileHandle - file handle for input file
+ * offset - offset into file where DLS data starts
+ *
+ * Outputs:
+ * EAS_RESULT
+ * ppDLS - address of pointer to the DLS collection
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT DLSParserLazy (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_DLSLIB_HANDLE *ppDLS)
+{
+    return DLSParseCollection(hwInstData, fileHandle, offset, EAS_TRUE, EAS_MEM_DLS, ppDLS);
+}
+#endif
+
+
+/*----------------------------------------------------------------------------
+ * DLSParseCollection ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses a DLS collection and converts it to EAS format
  *
  * Inputs:
  * pEASData - pointer to over EAS data instance
  * fileHandle - file handle for input file
  * offset - offset into file where DLS data starts
+ * lazy - leave the samples in the file until DLSLoadWave is called
+ * memCategory - memory category of the converted collection
  *
  * Outputs:
  * EAS_RESULT
@@ -461,7 +735,7 @@ static void DumpDLS (S_EAS *pEAS);
  *
  *----------------------------------------------------------------------------
 */
-EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_DLSLIB_HANDLE *ppDLS)
+static EAS_RESULT DLSParseCollection (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_BOOL lazy, EAS_INT memCategory, EAS_DLSLIB_HANDLE *ppDLS)
 {
     EAS_RESULT result;
     SDLS_SYNTHESIZER_DATA dls;
@@ -481,6 +755,13 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
     EAS_I32 linsSize;
     EAS_I32 ptblPos;
     EAS_I32 ptblSize;
+    EAS_I32 wavePoolSize;
+#ifdef _DLS_PROGRAM_INDEX
+    EAS_I32 indexSize;
+    EAS_INT indexBits;
+#endif
+    S_DLS pools;
+    void *pPool;
     void *p;
 
     /* zero counts and pointers */
@@ -577,28 +858,28 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
         return EAS_ERROR_UNRECOGNIZED_FORMAT;
     }
 
-    /* pre-parse the wave pool chunk */
+    /* parse the wave pool chunk, the samples are loaded once the collection is allocated */
     if ((result = Parse_ptbl(&dls, ptblPos, wvplPos, wvplSize)) != EAS_SUCCESS)
-        return result;
-
-    /* limit check  */
-    if ((dls.waveCount == 0) || (dls.waveCount > DLS_MAX_WAVE_COUNT))
     {
-        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "DLS file contains invalid #waves [%u]\n", dls.waveCount); */ }
-        return EAS_ERROR_FILE_FORMAT;
+        if (dls.wsmpData)
+            EAS_HWFree(dls.hwInstData, dls.wsmpData);
+        return result;
     }
 
-    /* allocate memory for wsmp data */
-    dls.wsmpData = EAS_HWMalloc(dls.hwInstData, (EAS_I32) (sizeof(S_WSMP_DATA) * dls.waveCount));
-    if (dls.wsmpData == NULL)
+    /* convert the instruments into temporary pools, starting with the default articulation */
+    EAS_HWMemSet(&pools, 0, sizeof(pools));
+    dls.pDLS = &pools;
+    pPool = NULL;
+    result = GrowPool(&dls, &pPool, &dls.artCapacity, 0, DLS_MAX_ART_COUNT + 1, (EAS_I32) sizeof(S_DLS_ARTICULATION));
+    pools.pDLSArticulations = pPool;
+    if (result == EAS_SUCCESS)
     {
-        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "EAS_HWMalloc for wsmp data failed\n"); */ }
-        return EAS_ERROR_MALLOC_FAILED;
+        Convert_art(&dls, &defaultArt, 0);
+        dls.artCount = 1;
+        result = Parse_lins(&dls, linsPos, linsSize);
     }
-    EAS_HWMemSet(dls.wsmpData, 0, (EAS_I32) (sizeof(S_WSMP_DATA) * dls.waveCount));
+    dls.pDLS = NULL;
 
-    /* pre-parse the lins chunk */
-    result = Parse_lins(&dls, linsPos, linsSize);
     if (result == EAS_SUCCESS)
     {
 
@@ -606,25 +887,26 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
         if ((dls.regionCount == 0) || (dls.regionCount > DLS_MAX_REGION_COUNT))
         {
             { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "DLS file contains invalid #regions [%u]\n", dls.regionCount); */ }
-            EAS_HWFree(dls.hwInstData, dls.wsmpData);
-            return EAS_ERROR_FILE_FORMAT;
+            result = EAS_ERROR_FILE_FORMAT;
         }
 
-        /* limit check  */
-        if ((dls.artCount == 0) || (dls.artCount > DLS_MAX_ART_COUNT))
+        /* limit check, the default articulation does not count */
+        else if ((dls.artCount == 1) || (dls.artCount > DLS_MAX_ART_COUNT + 1))
         {
             { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "DLS file contains invalid #articulations [%u]\n", dls.regionCount); */ }
-            EAS_HWFree(dls.hwInstData, dls.wsmpData);
-            return EAS_ERROR_FILE_FORMAT;
+            result = EAS_ERROR_FILE_FORMAT;
         }
 
         /* limit check  */
-        if ((dls.instCount == 0) || (dls.instCount > DLS_MAX_INST_COUNT))
+        else if ((dls.instCount == 0) || (dls.instCount > DLS_MAX_INST_COUNT))
         {
             { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "DLS file contains invalid #instruments [%u]\n", dls.instCount); */ }
-            EAS_HWFree(dls.hwInstData, dls.wsmpData);
-            return EAS_ERROR_FILE_FORMAT;
+            result = EAS_ERROR_FILE_FORMAT;
         }
+    }
+
+    if (result == EAS_SUCCESS)
+    {
 
         /* Allocate memory for the converted DLS data */
         /* calculate size of instrument data */
@@ -633,45 +915,66 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
         /* calculate size of region pool */
         rgnPoolSize = (EAS_I32) (sizeof(S_DLS_REGION) * dls.regionCount);
 
-        /* calculate size of articulation pool, add one for default articulation */
-        dls.artCount++;
+        /* calculate size of articulation pool, including the default articulation */
         artPoolSize = (EAS_I32) (sizeof(S_DLS_ARTICULATION) * dls.artCount);
 
         /* calculate size of wave length and offset arrays */
         waveLenSize = (EAS_I32) (dls.waveCount * sizeof(EAS_U32));
 
+        /* calculate size of wave pool */
+        wavePoolSize = (EAS_I32) dls.wavePoolSize;
+#ifdef _DLS_LAZY_SAMPLES
+        /* lazy collections only keep track of where each wave is */
+        if (lazy)
+            wavePoolSize = (EAS_I32) (dls.waveCount * sizeof(S_DLS_WAVE));
+#endif
+
         /* calculate final memory size */
-        size = (EAS_I32) sizeof(S_EAS) + instSize + rgnPoolSize + artPoolSize + (2 * waveLenSize) + (EAS_I32) dls.wavePoolSize;
-        if (size <= 0) {
-            EAS_HWFree(dls.hwInstData, dls.wsmpData);
-            return EAS_ERROR_FILE_FORMAT;
-        }
+        size = (EAS_I32) sizeof(S_DLS) + instSize + rgnPoolSize + artPoolSize + (2 * waveLenSize) + wavePoolSize;
+#ifdef _CACHE_ALIGNED_SAMPLES
+        /* room to start the wave pool on a cache line */
+        size += EAS_CACHE_LINE_SIZE - 1;
+#endif
+
+#ifdef _DLS_PROGRAM_INDEX
+        /* add the program index, at least twice the number of programs */
+        for (indexBits = 1; (1L << indexBits) < (EAS_I32) (2 * dls.instCount); indexBits++) {}
+        indexSize = (EAS_I32) sizeof(S_PROGRAM) << indexBits;
+        size += indexSize;
+#endif
+        if (size <= 0)
+            result = EAS_ERROR_FILE_FORMAT;
 
         /* allocate the main EAS chunk */
-        dls.pDLS = EAS_HWMalloc(dls.hwInstData, size);
-        if (dls.pDLS == NULL)
+        else if ((dls.pDLS = EAS_HWMallocCategory(dls.hwInstData, size, memCategory)) == NULL)
         {
             { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "EAS_HWMalloc failed for DLS memory allocation size %ld\n", size); */ }
-            EAS_HWFree(dls.hwInstData, dls.wsmpData);
-            return EAS_ERROR_MALLOC_FAILED;
+            result = EAS_ERROR_MALLOC_FAILED;
         }
+    }
+
+    if (result == EAS_SUCCESS)
+    {
         EAS_HWMemSet(dls.pDLS, 0, size);
         dls.pDLS->refCount = 1;
-        p = PtrOfs(dls.pDLS, sizeof(S_EAS));
+        p = PtrOfs(dls.pDLS, sizeof(S_DLS));
 
         /* setup pointer to programs */
         dls.pDLS->numDLSPrograms = (EAS_U16) dls.instCount;
         dls.pDLS->pDLSPrograms = p;
+        EAS_HWMemCpy(p, pools.pDLSPrograms, instSize);
         p = PtrOfs(p, instSize);
 
         /* setup pointer to regions */
         dls.pDLS->pDLSRegions = p;
         dls.pDLS->numDLSRegions = (EAS_U16) dls.regionCount;
+        EAS_HWMemCpy(p, pools.pDLSRegions, rgnPoolSize);
         p = PtrOfs(p, rgnPoolSize);
 
         /* setup pointer to articulations */
         dls.pDLS->numDLSArticulations = (EAS_U16) dls.artCount;
         dls.pDLS->pDLSArticulations = p;
+        EAS_HWMemCpy(p, pools.pDLSArticulations, artPoolSize);
         p = PtrOfs(p, artPoolSize);
 
         /* setup pointer to wave length table */
@@ -683,34 +986,70 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
         dls.pDLS->pDLSSampleOffsets = p;
         p = PtrOfs(p, waveLenSize);
 
+#ifdef _DLS_PROGRAM_INDEX
+        /* setup pointer to program index, ahead of the wave pool to keep it aligned */
+        dls.pDLS->programIndexBits = (EAS_U16) indexBits;
+        dls.pDLS->pProgramIndex = p;
+        p = PtrOfs(p, indexSize);
+#endif
+
         /* setup pointer to wave pool */
+#ifdef _CACHE_ALIGNED_SAMPLES
+        p = PtrOfs(p, (EAS_I32) (-(uintptr_t) p & (EAS_CACHE_LINE_SIZE - 1)));
+#endif
+#ifdef _DLS_LAZY_SAMPLES
+        if (lazy)
+            dls.pDLS->pDLSWaves = p;
+        else
+#endif
         dls.pDLS->pDLSSamples = p;
 
-        /* clear filter flag */
-        dls.filterUsed = EAS_FALSE;
-
-        /* parse the wave pool and load samples */
-        result = Parse_ptbl(&dls, ptblPos, wvplPos, wvplSize);
-    }
-
-    /* create the default articulation */
-    if (dls.pDLS) {
-        Convert_art(&dls, &defaultArt, 0);
-        dls.artCount = 1;
+        /* load the samples */
+        result = LoadWaves(&dls);
     }
 
-    /* parse the lins chunk and load instruments */
-    dls.regionCount = dls.instCount = 0;
-    if (result == EAS_SUCCESS)
-        result = Parse_lins(&dls, linsPos, linsSize);
-
     /* clean up any temporary objects that were allocated */
+    if (pools.pDLSPrograms)
+        EAS_HWFree(dls.hwInstData, pools.pDLSPrograms);
+    if (pools.pDLSRegions)
+        EAS_HWFree(dls.hwInstData, pools.pDLSRegions);
+    if (pools.pDLSArticulations)
+        EAS_HWFree(dls.hwInstData, pools.pDLSArticulations);
     if (dls.wsmpData)
         EAS_HWFree(dls.hwInstData, dls.wsmpData);
 
+#ifdef _DLS_LAZY_SAMPLES
+    /* keep our own handle to load the waves from */
+    if ((result == EAS_SUCCESS) && (dls.pDLS->pDLSWaves != NULL))
+    {
+        const void *pFileData;
+
+        result = EAS_HWDupHandle(dls.hwInstData, dls.fileHandle, &dls.pDLS->fileHandle);
+        if (result == EAS_SUCCESS)
+        {
+            dls.pDLS->hwInstData = dls.hwInstData;
+            dls.pDLS->wavePoolSize = dls.wavePoolSize;
+            dls.pDLS->bigEndian = dls.bigEndian;
+            result = EAS_HWFileData(dls.hwInstData, dls.pDLS->fileHandle, &pFileData, &dls.pDLS->fileDataSize);
+            dls.pDLS->pFileData = pFileData;
+            if (result != EAS_SUCCESS)
+            {
+                EAS_HWCloseFile(dls.hwInstData, dls.pDLS->fileHandle);
+                dls.pDLS->fileHandle = NULL;
+            }
+        }
+    }
+#endif
+
     /* if successful, return a pointer to the EAS collection */
     if (result == EAS_SUCCESS)
     {
+#ifdef _DLS_PROGRAM_INDEX
+        BuildProgramIndex(dls.pDLS);
+#endif
+#ifdef _DLS_KEY_INDEX
+        BuildKeyIndex(dls.hwInstData, dls.pDLS, memCategory);
+#endif
         *ppDLS = dls.pDLS;
 #ifdef _DEBUG_DLS
         DumpDLS(dls.pDLS);
@@ -718,52 +1057,338 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
     }
 
     /* something went wrong, deallocate the EAS collection */
-    else
-        DLSCleanup(dls.hwInstData, dls.pDLS);
+    else if (dls.pDLS)
+        EAS_HWFree(dls.hwInstData, dls.pDLS);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+ * DLSCleanup ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ *
+ * Inputs:
+ * pEASData - pointer to over EAS data instance
+ * pEAS - pointer to alternate EAS wavetable
+ *
+ * Outputs:
+ * EAS_RESULT
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT DLSCleanup (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS)
+{
+#ifdef _DLS_COLLECTION_CACHE
+    S_DLS **ppPrev;
+#endif
+
+    /* free the allocated memory */
+    if (pDLS)
+    {
+#ifdef _DLS_COLLECTION_CACHE
+        /* the collection may be shared with other instances */
+        EAS_HWGlobalLock();
+        if (pDLS->refCount)
+        {
+            if (--pDLS->refCount == 0)
+            {
+                for (ppPrev = &pDLSCache; *ppPrev != NULL; ppPrev = &(*ppPrev)->pCacheNext)
+                {
+                    if (*ppPrev == pDLS)
+                    {
+                        *ppPrev = pDLS->pCacheNext;
+                        break;
+                    }
+                }
+                EAS_HWGlobalUnlock();
+
+                /* may have been allocated by another instance, the host must allow this */
+                DLSFreeCollection(hwInstData, pDLS);
+                return EAS_SUCCESS;
+            }
+        }
+        EAS_HWGlobalUnlock();
+#else
+        if (pDLS->refCount)
+        {
+            if (--pDLS->refCount == 0)
+                DLSFreeCollection(hwInstData, pDLS);
+        }
+#endif
+    }
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * DLSFreeCollection ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees a DLS collection and everything allocated for it after parsing
+ *
+ * Inputs:
+ * hwInstData - host instance data
+ * pDLS - DLS collection
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void DLSFreeCollection (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS)
+{
+#ifdef _DLS_LAZY_SAMPLES
+    EAS_U16 waveIndex;
+
+    if (pDLS->pDLSWaves != NULL)
+    {
+        for (waveIndex = 0; waveIndex < pDLS->numDLSSamples; waveIndex++)
+        {
+            if (pDLS->pDLSWaves[waveIndex].allocated)
+                EAS_HWFree(hwInstData, pDLS->pDLSWaves[waveIndex].pSamples);
+        }
+        if (pDLS->fileHandle != NULL)
+            EAS_HWCloseFile(pDLS->hwInstData, pDLS->fileHandle);
+    }
+#endif
+#ifdef _DLS_KEY_INDEX
+    if (pDLS->pKeyIndex != NULL)
+        EAS_HWFree(hwInstData, pDLS->pKeyIndex);
+#endif
+#ifdef _DLS_COLLECTION_CACHE
+    if (pDLS->pCacheData != NULL)
+        EAS_HWFree(hwInstData, pDLS->pCacheData);
+#endif
+    EAS_HWFree(hwInstData, pDLS);
+}
+
+/*----------------------------------------------------------------------------
+ * DLSAddRef ()
+ *----------------------------------------------------------------------------
+ * Increment reference count
+ *----------------------------------------------------------------------------
+*/
+void DLSAddRef (S_DLS *pDLS)
+{
+    if (pDLS)
+    {
+#ifdef _DLS_COLLECTION_CACHE
+        EAS_HWGlobalLock();
+        pDLS->refCount++;
+        EAS_HWGlobalUnlock();
+#else
+        pDLS->refCount++;
+#endif
+    }
+}
+
+#ifdef _DLS_LAZY_SAMPLES
+/*----------------------------------------------------------------------------
+ * DLSLoadWave ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Makes the samples of a wave in a collection from DLSParserLazy
+ * available. Unlooped 16-bit waves in a memory file are used in place,
+ * anything else is read and converted into an allocation of its own.
+ * Does nothing for collections that were loaded in full.
+ *
+ * Inputs:
+ * pDLS - DLS collection
+ * waveIndex - wave to load
+ *
+ * Outputs:
+ * EAS_RESULT
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT DLSLoadWave (S_DLS *pDLS, EAS_U16 waveIndex)
+{
+    EAS_RESULT result;
+    SDLS_SYNTHESIZER_DATA dls;
+    S_WSMP_DATA wsmp;
+    S_DLS_WAVE *pWave;
+    EAS_SAMPLE *pSamples;
+    EAS_U32 sampleLen;
+
+    /* nothing to do if the samples are resident or already loaded */
+    if ((pDLS->pDLSWaves == NULL) || (waveIndex >= pDLS->numDLSSamples))
+        return EAS_SUCCESS;
+    pWave = &pDLS->pDLSWaves[waveIndex];
+    if (pWave->pSamples != NULL)
+        return EAS_SUCCESS;
+    sampleLen = pDLS->pDLSSampleLen[waveIndex];
+
+#if defined(_16_BIT_SAMPLES)
+    /* the file already holds the samples as the synth reads them, as long as no loop guard is needed */
+    if ((pDLS->pFileData != NULL) && (pWave->bitsPerSample == 16) && (pWave->loopLength == 0) &&
+        (((EAS_U32) (pDLS->pFileData + pWave->dataPos) & (sizeof(EAS_SAMPLE) - 1)) == 0) &&
+        (pWave->dataPos + pWave->dataSize + (EAS_I32) sizeof(EAS_SAMPLE) <= pDLS->fileDataSize))
+    {
+        /*lint -e{605,826} the synth does not write to the samples */
+        pWave->pSamples = (EAS_SAMPLE*) (pDLS->pFileData + pWave->dataPos);
+        pWave->allocated = EAS_FALSE;
+        return EAS_SUCCESS;
+    }
+#endif
+
+    /* one extra silent sample for the interpolator to read past the end */
+    pSamples = EAS_HWMalloc(pDLS->hwInstData, (EAS_I32) (sampleLen + sizeof(EAS_SAMPLE)));
+    if (pSamples == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "EAS_HWMalloc failed for DLS wave %u\n", waveIndex); */ }
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+    EAS_HWMemSet(pSamples, 0, (EAS_I32) (sampleLen + sizeof(EAS_SAMPLE)));
+
+    /* convert the wave as the parser would have */
+    EAS_HWMemSet(&dls, 0, sizeof(dls));
+    dls.hwInstData = pDLS->hwInstData;
+    dls.fileHandle = pDLS->fileHandle;
+    dls.bigEndian = pDLS->bigEndian;
+    dls.wavePoolOffset = pWave->poolOffset;
+    dls.wavePoolSize = pDLS->wavePoolSize;
+    EAS_HWMemSet(&wsmp, 0, sizeof(wsmp));
+    wsmp.bitsPerSample = pWave->bitsPerSample;
+    wsmp.loopStart = pWave->loopStart;
+    wsmp.loopLength = pWave->loopLength;
+    if ((result = Parse_data(&dls, pWave->dataPos, pWave->dataSize, &wsmp, pSamples, sampleLen)) != EAS_SUCCESS)
+    {
+        EAS_HWFree(pDLS->hwInstData, pSamples);
+        return result;
+    }
 
-    return result;
+    pWave->pSamples = pSamples;
+    pWave->allocated = EAS_TRUE;
+    return EAS_SUCCESS;
 }
+#endif
 
+#ifdef _DLS_PROGRAM_INDEX
 /*----------------------------------------------------------------------------
- * DLSCleanup ()
+ * BuildProgramIndex ()
  *----------------------------------------------------------------------------
  * Purpose:
+ * Fills the program index so a program change can find its program
+ * without searching the program list. Where two programs have the same
+ * locale, the first one is indexed, as a search would find it.
  *
  * Inputs:
- * pEASData - pointer to over EAS data instance
- * pEAS - pointer to alternate EAS wavetable
+ * pDLS         - DLS collection with pProgramIndex allocated
  *
  * Outputs:
- * EAS_RESULT
  *
  *----------------------------------------------------------------------------
 */
-EAS_RESULT DLSCleanup (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS)
+static void BuildProgramIndex (S_DLS *pDLS)
 {
+    S_PROGRAM *pIndex;
+    EAS_U32 mask;
+    EAS_U32 slot;
+    EAS_U32 i;
 
-    /* free the allocated memory */
-    if (pDLS)
+    pIndex = pDLS->pProgramIndex;
+    mask = (1UL << pDLS->programIndexBits) - 1;
+    for (slot = 0; slot <= mask; slot++)
+        pIndex[slot].regionIndex = INVALID_REGION_INDEX;
+
+    for (i = 0; i < pDLS->numDLSPrograms; i++)
     {
-        if (pDLS->refCount)
-        {
-            if (--pDLS->refCount == 0)
-                EAS_HWFree(hwInstData, pDLS);
-        }
+        slot = DLS_PROGRAM_HASH(pDLS->pDLSPrograms[i].locale, pDLS->programIndexBits);
+        while ((pIndex[slot].regionIndex != INVALID_REGION_INDEX) && (pIndex[slot].locale != pDLS->pDLSPrograms[i].locale))
+            slot = (slot + 1) & mask;
+        if (pIndex[slot].regionIndex == INVALID_REGION_INDEX)
+            pIndex[slot] = pDLS->pDLSPrograms[i];
     }
-    return EAS_SUCCESS;
 }
+#endif
 
+#ifdef _DLS_KEY_INDEX
 /*----------------------------------------------------------------------------
- * DLSAddRef ()
+ * BuildKeyIndex ()
  *----------------------------------------------------------------------------
- * Increment reference count
+ * Purpose:
+ * Lists, for each program and key, the regions whose key range covers the
+ * key, so a note-on only checks the velocity range of those regions. The
+ * lists keep region order so voices start in the same order as a search
+ * of the program would start them. If the index cannot be allocated the
+ * collection is still usable and note-ons search the program.
+ *
+ * Inputs:
+ * hwInstData   - host instance data for memory allocation
+ * pDLS         - parsed DLS collection
+ * memCategory  - memory category of the collection
+ *
+ * Outputs:
+ *
  *----------------------------------------------------------------------------
 */
-void DLSAddRef (S_DLS *pDLS)
+static void BuildKeyIndex (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS, EAS_INT memCategory)
 {
-    if (pDLS)
-        pDLS->refCount++;
+    const S_REGION *pRegion;
+    EAS_U32 *pKeyIndex;
+    EAS_U32 listSize;
+    EAS_U32 count;
+    EAS_U16 first;
+    EAS_U16 index;
+    EAS_INT program;
+    EAS_INT key;
+
+    pDLS->pKeyIndex = NULL;
+    pDLS->pRegionKeyIndex = NULL;
+    pDLS->pKeyRegions = NULL;
+
+    /* size the region lists */
+    listSize = 0;
+    for (program = 0; program < pDLS->numDLSPrograms; program++)
+    {
+        index = pDLS->pDLSPrograms[program].regionIndex & REGION_INDEX_MASK;
+        for (count = 0; index < pDLS->numDLSRegions; index++, count++)
+        {
+            pRegion = &pDLS->pDLSRegions[index].wtRegion.region;
+            if (pRegion->rangeHigh >= pRegion->rangeLow)
+                listSize += (EAS_U32) (pRegion->rangeHigh - pRegion->rangeLow + 1);
+            if (pRegion->keyGroupAndFlags & REGION_FLAG_LAST_REGION)
+                break;
+        }
+        if (index >= pDLS->numDLSRegions)
+            return;
+    }
+
+    /* one allocation for the key index, the region map and the lists */
+    pKeyIndex = EAS_HWMallocCategory(hwInstData, (EAS_I32) (pDLS->numDLSPrograms * DLS_KEY_INDEX_STRIDE * sizeof(EAS_U32) +
+        pDLS->numDLSRegions * sizeof(EAS_U16) + listSize * sizeof(EAS_U16)), memCategory);
+    if (pKeyIndex == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "Failed to allocate DLS key index\n"); */ }
+        return;
+    }
+    pDLS->pKeyIndex = pKeyIndex;
+    pDLS->pRegionKeyIndex = (EAS_U16*) &pKeyIndex[pDLS->numDLSPrograms * DLS_KEY_INDEX_STRIDE];
+    pDLS->pKeyRegions = &pDLS->pRegionKeyIndex[pDLS->numDLSRegions];
+    for (index = 0; index < pDLS->numDLSRegions; index++)
+        pDLS->pRegionKeyIndex[index] = DLS_NO_KEY_INDEX;
+
+    /* list the regions of each program that cover each key */
+    count = 0;
+    for (program = 0; program < pDLS->numDLSPrograms; program++)
+    {
+        first = pDLS->pDLSPrograms[program].regionIndex & REGION_INDEX_MASK;
+        pDLS->pRegionKeyIndex[first] = (EAS_U16) program;
+        for (key = 0; key < DLS_KEY_INDEX_STRIDE - 1; key++)
+        {
+            *pKeyIndex++ = count;
+            for (index = first; ; index++)
+            {
+                pRegion = &pDLS->pDLSRegions[index].wtRegion.region;
+                if ((key >= pRegion->rangeLow) && (key <= pRegion->rangeHigh))
+                    pDLS->pKeyRegions[count++] = index | FLAG_RGN_IDX_DLS_SYNTH;
+                if (pRegion->keyGroupAndFlags & REGION_FLAG_LAST_REGION)
+                    break;
+            }
+        }
+        *pKeyIndex++ = count;
+    }
 }
+#endif
 
 /*----------------------------------------------------------------------------
  * NextChunk ()
@@ -781,18 +1406,18 @@ void DLSAddRef (S_DLS *pDLS)
 static EAS_RESULT NextChunk (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 *pPos, EAS_U32 *pChunkType, EAS_I32 *pSize)
 {
     EAS_RESULT result;
+    EAS_U8 header[8];
+    EAS_I32 count;
 
     /* seek to start of chunk */
     if ((result = EAS_HWFileSeek(pDLSData->hwInstData, pDLSData->fileHandle, *pPos)) != EAS_SUCCESS)
         return result;
 
-    /* read the chunk type */
-    if ((result = EAS_HWGetDWord(pDLSData->hwInstData, pDLSData->fileHandle, pChunkType, EAS_TRUE)) != EAS_SUCCESS)
-        return result;
-
-    /* read the chunk size */
-    if ((result = EAS_HWGetDWord(pDLSData->hwInstData, pDLSData->fileHandle, pSize, EAS_FALSE)) != EAS_SUCCESS)
+    /* read the chunk type (big-endian) and size (little-endian) in one call */
+    if ((result = EAS_HWReadFile(pDLSData->hwInstData, pDLSData->fileHandle, header, (EAS_I32) sizeof(header), &count)) != EAS_SUCCESS)
         return result;
+    *pChunkType = ((EAS_U32) header[0] << 24) | ((EAS_U32) header[1] << 16) | ((EAS_U32) header[2] << 8) | (EAS_U32) header[3];
+    *pSize = (EAS_I32) ((EAS_U32) header[4] | ((EAS_U32) header[5] << 8) | ((EAS_U32) header[6] << 16) | ((EAS_U32) header[7] << 24));
 
     if (*pSize < 0) {
         ALOGE("b/37093318");
@@ -852,20 +1477,21 @@ static EAS_RESULT Parse_ptbl (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
     if ((result = EAS_HWGetDWord(pDLSData->hwInstData, pDLSData->fileHandle, &pDLSData->waveCount, EAS_FALSE)) != EAS_SUCCESS)
         return result;
 
-    /* if second pass, ensure waveCount matches with the value parsed in first pass */
-    if (pDLSData->pDLS)
+    /* limit check  */
+    if ((pDLSData->waveCount == 0) || (pDLSData->waveCount > DLS_MAX_WAVE_COUNT))
     {
-        if (pDLSData->waveCount != pDLSData->pDLS->numDLSSamples)
-        {
-            return EAS_ERROR_DATA_INCONSISTENCY;
-        }
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "DLS file contains invalid #waves [%u]\n", pDLSData->waveCount); */ }
+        return EAS_ERROR_FILE_FORMAT;
     }
 
-#if 0
-    /* just need the wave count on the first pass */
-    if (!pDLSData->pDLS)
-        return EAS_SUCCESS;
-#endif
+    /* allocate memory for wsmp data */
+    pDLSData->wsmpData = EAS_HWMalloc(pDLSData->hwInstData, (EAS_I32) (sizeof(S_WSMP_DATA) * pDLSData->waveCount));
+    if (pDLSData->wsmpData == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "EAS_HWMalloc for wsmp data failed\n"); */ }
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+    EAS_HWMemSet(pDLSData->wsmpData, 0, (EAS_I32) (sizeof(S_WSMP_DATA) * pDLSData->waveCount));
 
     /* open duplicate file handle */
     if ((result = EAS_HWDupHandle(pDLSData->hwInstData, pDLSData->fileHandle, &tempFile)) != EAS_SUCCESS)
@@ -887,7 +1513,10 @@ static EAS_RESULT Parse_ptbl (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
 
         /* parse the wave */
         if ((result = Parse_wave(pDLSData, wtblPos +(EAS_I32)  temp, waveIndex)) != EAS_SUCCESS)
+        {
+            EAS_HWCloseFile(pDLSData->hwInstData, tempFile);
             return result;
+        }
     }
 
     /* close the temporary handle and return */
@@ -921,8 +1550,6 @@ static EAS_RESULT Parse_wave (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
     EAS_I32 dataPos = 0;
     EAS_I32 dataSize = 0;
     S_WSMP_DATA *p;
-    void *pSample;
-    S_WSMP_DATA wsmp;
 
     /* seek to start of chunk */
     chunkPos = pos + 12;
@@ -978,11 +1605,7 @@ static EAS_RESULT Parse_wave (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
         return EAS_ERROR_SOUND_LIBRARY;
     }
 
-    /* for first pass, use temporary variable */
-    if (pDLSData->pDLS == NULL)
-        p = &wsmp;
-    else
-        p = &pDLSData->wsmpData[waveIndex];
+    p = &pDLSData->wsmpData[waveIndex];
 
     /* set the defaults */
     p->fineTune = 0;
@@ -1050,27 +1673,128 @@ static EAS_RESULT Parse_wave (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
             size += 2;
     }
 
-    /* for first pass, add size to wave pool size and return */
-    if (pDLSData->pDLS == NULL)
+    /* note where the samples are, LoadWaves reads them once the wave pool is allocated */
+    p->dataPos = dataPos;
+    p->dataSize = dataSize;
+    p->sampleLen = (EAS_U32) size;
+    pDLSData->wavePoolSize += DLS_WAVE_POOL_SIZE(size);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * LoadWaves ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reads the samples noted by Parse_wave into the wave pool, or for lazy
+ * collections just notes where they are
+ *
+ * Inputs:
+ * pDLSData - parser data with the collection allocated
+ *
+ * Outputs:
+ * EAS_RESULT
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT LoadWaves (SDLS_SYNTHESIZER_DATA *pDLSData)
+{
+    EAS_RESULT result;
+    S_WSMP_DATA *p;
+    void *pSample;
+    EAS_U16 waveIndex;
+
+    for (waveIndex = 0; waveIndex < pDLSData->waveCount; waveIndex++)
     {
-        pDLSData->wavePoolSize += (EAS_U32) size;
-        return EAS_SUCCESS;
+        p = &pDLSData->wsmpData[waveIndex];
+
+        pDLSData->pDLS->pDLSSampleOffsets[waveIndex] = pDLSData->wavePoolOffset;
+        pDLSData->pDLS->pDLSSampleLen[waveIndex] = p->sampleLen;
+        pDLSData->wavePoolOffset += DLS_WAVE_POOL_SIZE(p->sampleLen);
+        if (pDLSData->wavePoolOffset > pDLSData->wavePoolSize)
+        {
+            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Wave pool exceeded allocation\n"); */ }
+            return EAS_ERROR_SOUND_LIBRARY;
+        }
+
+#ifdef _DLS_LAZY_SAMPLES
+        /* lazy collections only note where the samples are */
+        if (pDLSData->pDLS->pDLSWaves != NULL)
+        {
+            S_DLS_WAVE *pWave;
+
+            pWave = &pDLSData->pDLS->pDLSWaves[waveIndex];
+            pWave->dataPos = p->dataPos;
+            pWave->dataSize = p->dataSize;
+            pWave->poolOffset = pDLSData->wavePoolOffset;
+            pWave->loopStart = p->loopStart;
+            pWave->loopLength = p->loopLength;
+            pWave->bitsPerSample = p->bitsPerSample;
+            continue;
+        }
+#endif
+
+        pSample = (EAS_U8*)pDLSData->pDLS->pDLSSamples + pDLSData->pDLS->pDLSSampleOffsets[waveIndex];
+        if ((result = Parse_data(pDLSData, p->dataPos, p->dataSize, p, pSample, p->sampleLen)) != EAS_SUCCESS)
+            return result;
     }
 
-    /* allocate memory and read in the sample data */
-    pSample = (EAS_U8*)pDLSData->pDLS->pDLSSamples + pDLSData->wavePoolOffset;
-    pDLSData->pDLS->pDLSSampleOffsets[waveIndex] = pDLSData->wavePoolOffset;
-    pDLSData->pDLS->pDLSSampleLen[waveIndex] = (EAS_U32) size;
-    pDLSData->wavePoolOffset += (EAS_U32) size;
-    if (pDLSData->wavePoolOffset > pDLSData->wavePoolSize)
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * GrowPool ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Makes sure a temporary pool has room for the element at index,
+ * doubling its size as needed. New elements are zeroed.
+ *
+ * Inputs:
+ * pDLSData - parser data
+ * ppPool - pool, replaced if it has to grow
+ * pCapacity - number of elements in the pool
+ * index - element that is needed
+ * maxCount - most elements a collection may have
+ * elementSize - size of an element
+ *
+ * Outputs:
+ * EAS_RESULT
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT GrowPool (SDLS_SYNTHESIZER_DATA *pDLSData, void **ppPool, EAS_U32 *pCapacity, EAS_U32 index, EAS_U32 maxCount, EAS_I32 elementSize)
+{
+    void *pNewPool;
+    EAS_U32 capacity;
+
+    if (index < *pCapacity)
+        return EAS_SUCCESS;
+    if (index >= maxCount)
     {
-        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Wave pool exceeded allocation\n"); */ }
-        return EAS_ERROR_SOUND_LIBRARY;
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "DLS collection exceeds %lu elements\n", maxCount); */ }
+        return EAS_ERROR_FILE_FORMAT;
     }
 
-    if ((result = Parse_data(pDLSData, dataPos, dataSize, p, pSample, (EAS_U32)size)) != EAS_SUCCESS)
-        return result;
+    capacity = (*pCapacity == 0) ? DLS_INITIAL_POOL_COUNT : (*pCapacity * 2);
+    while (capacity <= index)
+        capacity *= 2;
+    if (capacity > maxCount)
+        capacity = maxCount;
+
+    pNewPool = EAS_HWMalloc(pDLSData->hwInstData, (EAS_I32) capacity * elementSize);
+    if (pNewPool == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "EAS_HWMalloc failed for DLS pool of %lu elements\n", capacity); */ }
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+    EAS_HWMemSet(pNewPool, 0, (EAS_I32) capacity * elementSize);
+    if (*ppPool != NULL)
+    {
+        EAS_HWMemCpy(pNewPool, *ppPool, (EAS_I32) *pCapacity * elementSize);
+        EAS_HWFree(pDLSData->hwInstData, *ppPool);
+    }
 
+    *ppPool = pNewPool;
+    *pCapacity = capacity;
     return EAS_SUCCESS;
 }
 
@@ -1328,43 +2052,88 @@ static EAS_RESULT Parse_data (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
     return EAS_SUCCESS;
 }
 #elif defined(_16_BIT_SAMPLES)
+/*----------------------------------------------------------------------------
+ * Convert8BitSamples ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts unsigned 8-bit samples, stored in the second half of the
+ * buffer, to signed 16-bit samples in place. Every block is loaded before
+ * the samples converted from it are stored, and no store reaches an 8-bit
+ * sample that has not been loaded yet.
+ *
+ * Inputs:
+ * pSample - buffer of count 16-bit samples, the 8-bit samples at its middle
+ * count - number of samples
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void Convert8BitSamples (EAS_I16 *pSample, EAS_I32 count)
+{
+    const EAS_U8 *pInput;
+    EAS_I32 i;
+
+    pInput = (const EAS_U8*) pSample + count;
+    i = 0;
+
+#if defined(_NEON_KERNEL)
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16_t in = veorq_u8(vld1q_u8(pInput + i), vdupq_n_u8(0x80));
+        vst1q_s16(pSample + i, vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(in), 8)));
+        vst1q_s16(pSample + i + 8, vreinterpretq_s16_u16(vshll_n_u8(vget_high_u8(in), 8)));
+    }
+#elif defined(_SSE2_KERNEL)
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i in = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (pInput + i)), _mm_set1_epi8((char) 0x80));
+        _mm_storeu_si128((__m128i*) (pSample + i), _mm_unpacklo_epi8(_mm_setzero_si128(), in));
+        _mm_storeu_si128((__m128i*) (pSample + i + 8), _mm_unpackhi_epi8(_mm_setzero_si128(), in));
+    }
+#endif
+
+    for (; i < count; i++)
+        pSample[i] = (EAS_I16) ((pInput[i] ^ 0x80) << 8);
+}
+
+/*----------------------------------------------------------------------------
+ * Parse_data ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reads a wave into the sample buffer with a single read. 16-bit waves
+ * are already in the sample format, 8-bit waves are read into the second
+ * half of the buffer and converted in place.
+ *
+ * Inputs:
+ *
+ *
+ * Outputs:
+ *
+ *
+ *----------------------------------------------------------------------------
+*/
 static EAS_RESULT Parse_data (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_I32 size, S_WSMP_DATA *pWsmp, EAS_SAMPLE *pSample, EAS_U32 sampleLen)
 {
     EAS_RESULT result;
-    EAS_U8 convBuf[SAMPLE_CONVERT_CHUNK_SIZE];
-    EAS_I32 count = 0;
-    EAS_I32 i;
-    EAS_I16 *p;
+    EAS_I32 count;
 
     /* seek to start of chunk */
     if ((result = EAS_HWFileSeek(pDLSData->hwInstData, pDLSData->fileHandle, pos)) != EAS_SUCCESS)
         return result;
 
-        p = pSample;
-
-        while (size)
-        {
-            /* read a small chunk of data and convert it */
-            count = (size < SAMPLE_CONVERT_CHUNK_SIZE ? size : SAMPLE_CONVERT_CHUNK_SIZE);
-            if ((result = EAS_HWReadFile(pDLSData->hwInstData, pDLSData->fileHandle, convBuf, count, &count)) != EAS_SUCCESS)
-            {
-                return result;
-            }
-            size -= count;
-            if (pWsmp->bitsPerSample == 16)
-            {
-                memcpy(p, convBuf, count);
-                p += count >> 1;
-            }
-            else
-            {
-                for(i=0; i<count; i++)
-                {
-                    *p++ = (short)((convBuf[i] ^ 0x80) << 8);
-                }
-            }
+    if (pWsmp->bitsPerSample == 16)
+    {
+        if ((result = EAS_HWReadFile(pDLSData->hwInstData, pDLSData->fileHandle, pSample, size, &count)) != EAS_SUCCESS)
+            return result;
+    }
+    else
+    {
+        if ((result = EAS_HWReadFile(pDLSData->hwInstData, pDLSData->fileHandle, (EAS_U8*) pSample + size, size, &count)) != EAS_SUCCESS)
+            return result;
+        Convert8BitSamples(pSample, size);
+    }
 
-        }
     /* for looped samples, copy the last sample to the end */
     if (pWsmp->loopLength)
     {
@@ -1425,15 +2194,6 @@ static EAS_RESULT Parse_lins (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
         if (temp != CHUNK_INS)
             continue;
 
-        /* if second pass, ensure instCount is less than numDLSPrograms */
-        if (pDLSData->pDLS)
-        {
-            if (pDLSData->instCount >= pDLSData->pDLS->numDLSPrograms)
-            {
-                return EAS_ERROR_DATA_INCONSISTENCY;
-            }
-        }
-
         if ((result = Parse_ins(pDLSData, chunkPos + 12, size)) != EAS_SUCCESS)
             return result;
     }
@@ -1473,6 +2233,7 @@ static EAS_RESULT Parse_ins (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_I
     S_DLS_ART_VALUES art;
     S_PROGRAM *pProgram;
     EAS_U16 artIndex;
+    void *pPool;
 
     /* seek to start of chunk */
     if ((result = EAS_HWFileSeek(pDLSData->hwInstData, pDLSData->fileHandle, pos)) != EAS_SUCCESS)
@@ -1545,27 +2306,30 @@ static EAS_RESULT Parse_ins (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_I
         if ((result = Parse_lart(pDLSData, lar2Pos, lar2Size, &art)) != EAS_SUCCESS)
             return result;
 
+    /* convert the global articulation */
     if (art.values[PARAM_MODIFIED])
     {
         artIndex = (EAS_U16) pDLSData->artCount;
+        pPool = pDLSData->pDLS->pDLSArticulations;
+        result = GrowPool(pDLSData, &pPool, &pDLSData->artCapacity, artIndex, DLS_MAX_ART_COUNT + 1, (EAS_I32) sizeof(S_DLS_ARTICULATION));
+        pDLSData->pDLS->pDLSArticulations = pPool;
+        if (result != EAS_SUCCESS)
+            return result;
+        Convert_art(pDLSData, &art, artIndex);
         pDLSData->artCount++;
     }
 
-    /* convert data on second pass */
-    if (pDLSData->pDLS)
-    {
-
-        if (art.values[PARAM_MODIFIED])
-            Convert_art(pDLSData, &art, artIndex);
-
-        /* setup pointers */
-        pProgram = &pDLSData->pDLS->pDLSPrograms[pDLSData->instCount];
-
-        /* initialize instrument */
-        pProgram->locale = locale;
-        pProgram->regionIndex = (EAS_U16) pDLSData->regionCount | FLAG_RGN_IDX_DLS_SYNTH;
+    /* setup pointers */
+    pPool = pDLSData->pDLS->pDLSPrograms;
+    result = GrowPool(pDLSData, &pPool, &pDLSData->instCapacity, pDLSData->instCount, DLS_MAX_INST_COUNT, (EAS_I32) sizeof(S_PROGRAM));
+    pDLSData->pDLS->pDLSPrograms = pPool;
+    if (result != EAS_SUCCESS)
+        return result;
+    pProgram = &pDLSData->pDLS->pDLSPrograms[pDLSData->instCount];
 
-    }
+    /* initialize instrument */
+    pProgram->locale = locale;
+    pProgram->regionIndex = (EAS_U16) pDLSData->regionCount | FLAG_RGN_IDX_DLS_SYNTH;
 
     /* parse the region data */
     if ((result = Parse_lrgn(pDLSData, lrgnPos, lrgnSize, artIndex, regionCount)) != EAS_SUCCESS)
@@ -1646,6 +2410,7 @@ static EAS_RESULT Parse_lrgn (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
     EAS_I32 chunkPos;
     EAS_I32 endChunk;
     EAS_U16 regionCount;
+    void *pPool;
 
     /* seek to start of chunk */
     if ((result = EAS_HWFileSeek(pDLSData->hwInstData, pDLSData->fileHandle, pos)) != EAS_SUCCESS)
@@ -1669,14 +2434,12 @@ static EAS_RESULT Parse_lrgn (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
                 { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "DLS region count exceeded cRegions value in insh, extra region ignored\n"); */ }
                 return EAS_SUCCESS;
             }
-            /* if second pass, ensure regionCount is less than numDLSRegions */
-            if (pDLSData->pDLS)
-            {
-                if (pDLSData->regionCount >= pDLSData->pDLS->numDLSRegions)
-                {
-                    return EAS_ERROR_DATA_INCONSISTENCY;
-                }
-            }
+            /* make room for the region */
+            pPool = pDLSData->pDLS->pDLSRegions;
+            result = GrowPool(pDLSData, &pPool, &pDLSData->regionCapacity, pDLSData->regionCount, DLS_MAX_REGION_COUNT, (EAS_I32) sizeof(S_DLS_REGION));
+            pDLSData->pDLS->pDLSRegions = pPool;
+            if (result != EAS_SUCCESS)
+                return result;
             if ((result = Parse_rgn(pDLSData, chunkPos + 12, size, artIndex)) != EAS_SUCCESS)
                 return result;
             regionCount++;
@@ -1684,7 +2447,7 @@ static EAS_RESULT Parse_lrgn (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
     }
 
     /* set a flag in the last region */
-    if ((pDLSData->pDLS != NULL) && (regionCount > 0))
+    if (regionCount > 0)
         pDLSData->pDLS->pDLSRegions[pDLSData->regionCount - 1].wtRegion.region.keyGroupAndFlags |= REGION_FLAG_LAST_REGION;
 
     return EAS_SUCCESS;
@@ -1722,6 +2485,7 @@ static EAS_RESULT Parse_rgn (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_I
     S_WSMP_DATA wsmp;
     S_WSMP_DATA *pWsmp;
     EAS_U16 regionIndex;
+    void *pPool;
 
     /* seek to start of chunk */
     if ((result = EAS_HWFileSeek(pDLSData->hwInstData, pDLSData->fileHandle, pos)) != EAS_SUCCESS)
@@ -1817,48 +2581,43 @@ static EAS_RESULT Parse_rgn (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_I
             return result;
     }
 
-    /* if second pass, process region header */
-    if (pDLSData->pDLS)
+    /* if local data was found convert it */
+    if (art.values[PARAM_MODIFIED] == EAS_TRUE)
     {
+        pPool = pDLSData->pDLS->pDLSArticulations;
+        result = GrowPool(pDLSData, &pPool, &pDLSData->artCapacity, pDLSData->artCount, DLS_MAX_ART_COUNT + 1, (EAS_I32) sizeof(S_DLS_ARTICULATION));
+        pDLSData->pDLS->pDLSArticulations = pPool;
+        if (result != EAS_SUCCESS)
+            return result;
 
-        /* if local data was found convert it */
-        if (art.values[PARAM_MODIFIED] == EAS_TRUE)
-        {
-            /* ensure artCount is less than numDLSArticulations */
-            if (pDLSData->artCount >= pDLSData->pDLS->numDLSArticulations)
-            {
-                return EAS_ERROR_DATA_INCONSISTENCY;
-            }
+        Convert_art(pDLSData, &art, (EAS_U16) pDLSData->artCount);
+        artIndex = (EAS_U16) pDLSData->artCount;
+    }
 
-            Convert_art(pDLSData, &art, (EAS_U16) pDLSData->artCount);
-            artIndex = (EAS_U16) pDLSData->artCount;
-        }
+    /* parse region header */
+    if ((result = Parse_rgnh(pDLSData, rgnhPos, &pDLSData->pDLS->pDLSRegions[regionIndex & REGION_INDEX_MASK])) != EAS_SUCCESS)
+        return result;
 
-        /* parse region header */
-        if ((result = Parse_rgnh(pDLSData, rgnhPos, &pDLSData->pDLS->pDLSRegions[regionIndex & REGION_INDEX_MASK])) != EAS_SUCCESS)
+    /* parse wsmp chunk, copying parameters from original first */
+    if (wsmpPos)
+    {
+        EAS_HWMemCpy(&wsmp, pWsmp, sizeof(wsmp));
+        if ((result = Parse_wsmp(pDLSData, wsmpPos, &wsmp)) != EAS_SUCCESS)
             return result;
 
-        /* parse wsmp chunk, copying parameters from original first */
-        if (wsmpPos)
-        {
-            EAS_HWMemCpy(&wsmp, pWsmp, sizeof(wsmp));
-            if ((result = Parse_wsmp(pDLSData, wsmpPos, &wsmp)) != EAS_SUCCESS)
-                return result;
-
-            pWsmp = &wsmp;
-        }
+        pWsmp = &wsmp;
+    }
 
-        Convert_rgn(pDLSData, regionIndex, artIndex, (EAS_U16) waveIndex, pWsmp);
+    Convert_rgn(pDLSData, regionIndex, artIndex, (EAS_U16) waveIndex, pWsmp);
 
-        /* ensure loopStart and loopEnd fall in the range */
-        if (pWsmp->loopLength != 0)
+    /* ensure loopStart and loopEnd fall in the range */
+    if (pWsmp->loopLength != 0)
+    {
+        EAS_U32 sampleLen = pDLSData->wsmpData[waveIndex].sampleLen;
+        if (sampleLen < sizeof(EAS_SAMPLE)
+            || (pWsmp->loopStart + pWsmp->loopLength) * sizeof(EAS_SAMPLE) > sampleLen - sizeof(EAS_SAMPLE))
         {
-            EAS_U32 sampleLen = pDLSData->pDLS->pDLSSampleLen[waveIndex];
-            if (sampleLen < sizeof(EAS_SAMPLE)
-                || (pWsmp->loopStart + pWsmp->loopLength) * sizeof(EAS_SAMPLE) > sampleLen - sizeof(EAS_SAMPLE))
-            {
-                return EAS_FAILURE;
-            }
+            return EAS_FAILURE;
         }
     }
 
@@ -2057,10 +2816,13 @@ static EAS_RESULT Parse_art (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, S_DLS
     EAS_RESULT result;
     EAS_U32 structSize;
     EAS_U32 numConnections;
+    EAS_U32 blockCount;
+    EAS_U8 connections[DLS_CONNECTION_BLOCK * DLS_CONNECTION_SIZE];
+    EAS_U8 *p;
+    EAS_I32 count;
     EAS_U16 source;
     EAS_U16 control;
     EAS_U16 destination;
-    EAS_U16 transform;
     EAS_I32 scale;
     EAS_INT i;
 
@@ -2081,20 +2843,28 @@ static EAS_RESULT Parse_art (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, S_DLS
     if ((result = EAS_HWFileSeek(pDLSData->hwInstData, pDLSData->fileHandle, pos)) != EAS_SUCCESS)
         return result;
 
+    blockCount = 0;
+    p = connections;
     while (numConnections)
     {
         numConnections--;
-        /* read the connection data */
-        if ((result = EAS_HWGetWord(pDLSData->hwInstData, pDLSData->fileHandle, &source, EAS_FALSE)) != EAS_SUCCESS)
-            return result;
-        if ((result = EAS_HWGetWord(pDLSData->hwInstData, pDLSData->fileHandle, &control, EAS_FALSE)) != EAS_SUCCESS)
-            return result;
-        if ((result = EAS_HWGetWord(pDLSData->hwInstData, pDLSData->fileHandle, &destination, EAS_FALSE)) != EAS_SUCCESS)
-            return result;
-        if ((result = EAS_HWGetWord(pDLSData->hwInstData, pDLSData->fileHandle, &transform, EAS_FALSE)) != EAS_SUCCESS)
-            return result;
-        if ((result = EAS_HWGetDWord(pDLSData->hwInstData, pDLSData->fileHandle, &scale, EAS_FALSE)) != EAS_SUCCESS)
-            return result;
+
+        /* read the connection data a block at a time */
+        if (blockCount == 0)
+        {
+            blockCount = (numConnections < DLS_CONNECTION_BLOCK) ? numConnections + 1 : DLS_CONNECTION_BLOCK;
+            if ((result = EAS_HWReadFile(pDLSData->hwInstData, pDLSData->fileHandle, connections, (EAS_I32) (blockCount * DLS_CONNECTION_SIZE), &count)) != EAS_SUCCESS)
+                return result;
+            p = connections;
+        }
+        blockCount--;
+
+        /* source, control, destination and transform words, then the scale */
+        source = (EAS_U16) (p[0] | (p[1] << 8));
+        control = (EAS_U16) (p[2] | (p[3] << 8));
+        destination = (EAS_U16) (p[4] | (p[5] << 8));
+        scale = (EAS_I32) ((EAS_U32) p[8] | ((EAS_U32) p[9] << 8) | ((EAS_U32) p[10] << 16) | ((EAS_U32) p[11] << 24));
+        p += DLS_CONNECTION_SIZE;
 
         /* look up the connection */
         for (i = 0; i < (EAS_INT) ENTRIES_IN_CONN_TABLE; i++)
@@ -2454,7 +3224,13 @@ static void Convert_rgn (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_U16 regionIndex, E
     pRgn->wtRegion.gain = (EAS_I16) (pWsmp->gain >> 16);
     pRgn->wtRegion.loopStart = pWsmp->loopStart;
     pRgn->wtRegion.loopEnd = (pWsmp->loopStart + pWsmp->loopLength);
-    pRgn->wtRegion.tuning = pWsmp->fineTune -(pWsmp->unityNote * 100) + ConvertSampleRate(pWsmp->sampleRate);
+    /* waves in a collection mostly share a sample rate, convert it once */
+    if ((pWsmp->sampleRate != pDLSData->lastSampleRate) || (pDLSData->lastSampleRate == 0))
+    {
+        pDLSData->lastSampleRate = pWsmp->sampleRate;
+        pDLSData->lastSampleRateCents = ConvertSampleRate(pWsmp->sampleRate);
+    }
+    pRgn->wtRegion.tuning = pWsmp->fineTune -(pWsmp->unityNote * 100) + pDLSData->lastSampleRateCents;
     if (pWsmp->loopLength != 0)
         pRgn->wtRegion.region.keyGroupAndFlags |= REGION_FLAG_IS_LOOPED;
 }
@@ -2508,6 +3284,10 @@ static void Convert_art (SDLS_SYNTHESIZER_DATA *pDLSData, const S_DLS_ART_VALUES
     pArt->eg2.velToAttack = pDLSArt->values[PARAM_MOD_EG_VEL_TO_ATTACK];
     pArt->eg2.keyNumToDecay = pDLSArt->values[PARAM_MOD_EG_KEY_TO_DECAY];
     pArt->eg2.keyNumToHold = pDLSArt->values[PARAM_MOD_EG_KEY_TO_HOLD];
+#ifdef _DLS_ENVELOPE_RATES
+    ConvertEnvelopeRates(&pArt->eg1);
+    ConvertEnvelopeRates(&pArt->eg2);
+#endif
 
     /* filter parameters */
     pArt->filterCutoff = pDLSArt->values[PARAM_INITIAL_FC];
@@ -2552,6 +3332,30 @@ static void Convert_art (SDLS_SYNTHESIZER_DATA *pDLSData, const S_DLS_ART_VALUES
 #endif
 }
 
+#ifdef _DLS_ENVELOPE_RATES
+/*----------------------------------------------------------------------------
+ * ConvertEnvelopeRates()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts the attack, hold and decay times of an envelope once, so that
+ * notes whose velocity and key number don't scale them need no conversion
+ * when the envelope enters each state
+ *
+ * Inputs:
+ * pEnv - envelope with the times in timecents
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ConvertEnvelopeRates (S_DLS_ENVELOPE *pEnv)
+{
+    pEnv->attackRate = ConvertRate(pEnv->attackTime);
+    pEnv->holdFrames = ConvertDelay(pEnv->holdTime);
+    pEnv->decayRate = ConvertRate(pEnv->decayTime);
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * ConvertSampleRate()
  *----------------------------------------------------------------------------
@@ -283,6 +283,10 @@ typedef struct s_dls_params
 EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, S_DLS **pDLS);
 EAS_RESULT DLSCleanup (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS);
 void DLSAddRef (S_DLS *pDLS);
+#ifdef _DLS_LAZY_SAMPLES
+EAS_RESULT DLSParserLazy (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, S_DLS **pDLS);
+EAS_RESULT DLSLoadWave (S_DLS *pDLS, EAS_U16 waveIndex);
+#endif
 EAS_I16 ConvertDelay (EAS_I32 timeCents);
 EAS_I16 ConvertRate (EAS_I32 timeCents);
 
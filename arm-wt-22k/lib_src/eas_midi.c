@@ -212,6 +212,43 @@ EAS_RESULT EAS_ParseMIDIStream (S_EAS_DATA *pEASData, S_SYNTH *pSynth, S_MIDI_ST
     return EAS_SUCCESS;
 }
 
+#ifdef _SMF_COMPILE_EVENTS
+/*----------------------------------------------------------------------------
+ * EAS_ParseMIDIMessage()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Processes a complete channel message. The stream state is left as if the
+ * message had been passed to EAS_ParseMIDIStream a byte at a time.
+ *
+ * Inputs:
+ * status       - channel status byte
+ * d1, d2       - data bytes, d2 is ignored for 2-byte messages
+ *
+ * Outputs:
+ * returns EAS_RESULT (EAS_SUCCESS is OK)
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_ParseMIDIMessage (S_EAS_DATA *pEASData, S_SYNTH *pSynth, S_MIDI_STREAM *pMIDIStream, EAS_U8 status, EAS_U8 d1, EAS_U8 d2, EAS_INT parserMode)
+{
+    pMIDIStream->runningStatus = status;
+    pMIDIStream->status = status;
+    pMIDIStream->d1 = d1;
+    pMIDIStream->byte3 = EAS_FALSE;
+    pMIDIStream->pending = EAS_FALSE;
+
+    /* program change and channel pressure are 2-byte messages */
+    if ((status < 0xc0) || (status >= 0xe0))
+        pMIDIStream->d2 = d2;
+
+    if (parserMode == eParserModeMetaData)
+        return EAS_SUCCESS;
+    return ProcessMIDIMessage(pEASData, pSynth, pMIDIStream, parserMode);
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * ProcessMIDIMessage()
  *----------------------------------------------------------------------------
@@ -67,5 +67,27 @@ void EAS_InitMIDIStream (S_MIDI_STREAM *pMIDIStream);
 */
 EAS_RESULT EAS_ParseMIDIStream (S_EAS_DATA *pEASData, S_SYNTH *pSynth, S_MIDI_STREAM *pMIDIStream, EAS_U8 c, EAS_INT parserMode);
 
+#ifdef _SMF_COMPILE_EVENTS
+/*----------------------------------------------------------------------------
+ * EAS_ParseMIDIMessage()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Processes a complete channel message. The stream state is left as if the
+ * message had been passed to EAS_ParseMIDIStream a byte at a time.
+ *
+ * Inputs:
+ * status       - channel status byte
+ * d1, d2       - data bytes, d2 is ignored for 2-byte messages
+ *
+ * Outputs:
+ * returns EAS_RESULT (EAS_SUCCESS is OK)
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_ParseMIDIMessage (S_EAS_DATA *pEASData, S_SYNTH *pSynth, S_MIDI_STREAM *pMIDIStream, EAS_U8 status, EAS_U8 d1, EAS_U8 d2, EAS_INT parserMode);
+#endif
+
 #endif /* #define _EAS_MIDI_H */
 
@@ -82,8 +82,67 @@ typedef struct s_smf_stream_tag
     EAS_U32             ticks;              /* time of next event in stream */
     EAS_I32             startFilePos;       /* start location of track within file */
     S_MIDI_STREAM       midiStream;         /* MIDI stream state */
+#ifdef _SMF_TRACK_TREE
+    EAS_U16             winner;             /* stream with the next event below tree node n */
+#endif
 } S_SMF_STREAM;
 
+#ifdef _SMF_COMPILE_EVENTS
+/*----------------------------------------------------------------------------
+ *
+ * S_SMF_EVENT
+ *
+ * This structure contains a single event from the time-sorted event list
+ * built by SMF_Prepare. Channel messages are stored as complete messages;
+ * SysEx and most meta-events are fetched from the file when they are played.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+typedef struct s_smf_event_tag
+{
+    EAS_U32             ticks;              /* absolute time of event in ticks */
+    EAS_U32             value;              /* tempo or file position of SysEx/meta-event data */
+    EAS_U8              stream;             /* index of the stream the event belongs to */
+    EAS_U8              status;             /* status byte, see SMF_EVENT_XXX for other events */
+    EAS_U8              d1;                 /* first data byte or meta-event type */
+    EAS_U8              d2;                 /* second data byte */
+} S_SMF_EVENT;
+
+/* status for events without a MIDI status byte */
+#define SMF_EVENT_NONE              0x00    /* end of stream was reached */
+#define SMF_EVENT_META              0xff    /* meta-event */
+#endif
+
+#ifdef _RINGTONE_COMPILE_EVENTS
+/*----------------------------------------------------------------------------
+ *
+ * S_TONE_EVENT
+ *
+ * This structure contains a single note or rest from the event list built
+ * by the iMelody, RTTTL and OTA parsers when the file is prepared. Repeats
+ * are already unrolled.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+typedef struct s_tone_event_tag
+{
+    EAS_I32             ticks;              /* time to the end of the note in 256ths of a msec */
+    EAS_I32             restTicks;          /* ticks to rest after the note */
+    EAS_U8              note;               /* MIDI note number, zero for a rest */
+    EAS_U8              velocity;           /* note velocity */
+} S_TONE_EVENT;
+
+/* limit on the size of the compiled event list, larger files are parsed from the file */
+#ifndef TONE_MAX_EVENTS
+#define TONE_MAX_EVENTS             16384
+#endif
+
+/* the compiled event list grows in blocks of this many events */
+#define TONE_EVENT_BLOCK_SIZE       256
+#endif
+
 /*----------------------------------------------------------------------------
  *
  * S_SMF_DATA
@@ -110,17 +169,64 @@ typedef struct s_smf_data_tag
     EAS_U16             ppqn;               /* ticks per quarter note */
     EAS_U8              state;              /* current state EAS_STATE_XXXX */
     EAS_U8              flags;              /* flags - see definitions below */
+#ifdef _SMF_SEEK_INDEX
+    struct s_smf_seek_index_tag *pSeekIndex; /* checkpoints for fast locate */
+#endif
+#ifdef _SMF_COMPILE_EVENTS
+    S_SMF_EVENT         *events;            /* time-sorted events from all streams */
+    EAS_U32             numEvents;          /* number of compiled events */
+    EAS_U32             eventIndex;         /* index of next event */
+#endif
+#ifdef _PROGRESSIVE_FILES
+    EAS_I32             available;          /* bytes of a partial file received so far */
+#endif
 } S_SMF_DATA;
 
 #define SMF_FLAGS_CHASE_MODE        0x01    /* chase mode - skip to first note */
 #define SMF_FLAGS_HAS_TIME_SIG      0x02    /* time signature encountered at time 0 */
 #define SMF_FLAGS_HAS_TEMPO         0x04    /* tempo encountered at time 0  */
 #define SMF_FLAGS_HAS_GM_ON         0x08    /* GM System On encountered at time 0 */
+#define SMF_FLAGS_NO_SEEK_INDEX     0x10    /* file state can't be restored from a seek checkpoint */
+#define SMF_FLAGS_PROGRESSIVE       0x20    /* file is still downloading, don't read past available */
+#define SMF_FLAGS_UNDERRUN          0x40    /* stalled waiting for more of the file */
 #define SMF_FLAGS_JET_STREAM        0x80    /* JET in use - keep strict timing */
 
 /* combo flags indicate setup bar */
 #define SMF_FLAGS_SETUP_BAR (SMF_FLAGS_HAS_TIME_SIG | SMF_FLAGS_HAS_TEMPO | SMF_FLAGS_HAS_GM_ON)
 
+#ifdef _MIDI_INPUT_RING
+/*----------------------------------------------------------------------------
+ * MIDI input ring
+ *
+ * Single producer, single consumer queue between the thread calling
+ * EAS_WriteMIDIStream and the thread calling EAS_Render. Each slot holds up
+ * to MIDI_RING_EVENT_BYTES of the MIDI byte stream and the sample time it is
+ * due, longer writes take consecutive slots with the same time.
+ *----------------------------------------------------------------------------
+*/
+#ifndef MIDI_RING_SIZE
+#define MIDI_RING_SIZE              256     /* number of slots, must be a power of 2 */
+#endif
+#define MIDI_RING_EVENT_BYTES       4
+
+typedef struct s_midi_ring_event_tag
+{
+    EAS_U32             time;               /* sample time the bytes are due */
+    EAS_U8              count;              /* number of bytes in this slot */
+    EAS_U8              data[MIDI_RING_EVENT_BYTES];
+} S_MIDI_RING_EVENT;
+
+/* head and tail are kept on separate cache lines so the threads don't share them */
+typedef struct s_midi_ring_tag
+{
+    S_MIDI_RING_EVENT   events[MIDI_RING_SIZE];
+    volatile EAS_U32    head;               /* next slot to write, only the producer writes it */
+    EAS_U8              headPad[64 - sizeof(EAS_U32)];
+    volatile EAS_U32    tail;               /* next slot to read, only the consumer writes it */
+    EAS_U8              tailPad[64 - sizeof(EAS_U32)];
+} S_MIDI_RING;
+#endif
+
 /*----------------------------------------------------------------------------
  * Interactive MIDI structure
  *----------------------------------------------------------------------------
@@ -132,6 +238,9 @@ typedef struct s_interactive_midi_tag
 #endif
     S_SYNTH     *pSynth;            /* pointer to synth */
     S_MIDI_STREAM       stream;             /* stream data */
+#ifdef _MIDI_INPUT_RING
+    S_MIDI_RING         ring;               /* input from EAS_WriteMIDIStream */
+#endif
 } S_INTERACTIVE_MIDI;
 
 #endif /* #ifndef _EAS_MIDITYPES_H */
@@ -32,5 +32,5 @@
 #include "eas_mixer.h"
 
 // globals
-EAS_I32 eas_MixBuffer[BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS];
+EAS_I32 eas_MixBuffer[MAX_BLOCK_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS];
 
@@ -31,6 +31,9 @@
 //3 dls: This module is in the midst of being converted from a synth
 //3 specific module to a general purpose mix engine
 
+/* allocations of this module are reported as mix buffers */
+#define EAS_MEM_CATEGORY    EAS_MEM_MIX_BUFFERS
+
 /*------------------------------------
  * includes
  *------------------------------------
@@ -41,6 +44,11 @@
 #include "eas_mixer.h"
 #include "eas_config.h"
 #include "eas_report.h"
+#include "eas_trace.h"
+#ifdef _CHORUS_ENABLED
+#include "eas_vm_protos.h"
+#include "eas_chorusdata.h"
+#endif
 
 #ifdef _MAXIMIZER_ENABLED
 EAS_I32 MaximizerProcess (EAS_VOID_PTR pInstData, EAS_I32 *pSrc, EAS_I32 *pDst, EAS_I32 numSamples);
@@ -54,6 +62,103 @@ EAS_I32 MaximizerProcess (EAS_VOID_PTR pInstData, EAS_I32 *pSrc, EAS_I32 *pDst,
 /* need to boost stereo by ~3dB to compensate for the panner */
 #define STEREO_3DB_GAIN_BOOST       512
 
+/*----------------------------------------------------------------------------
+ * Vector kernels
+ *
+ * EAS_MixStream and the float conversion are vectorized with NEON or SSE2
+ * intrinsics when the target always provides them. Define _NO_SIMD_KERNEL
+ * to force the C reference code, the output is bit-exact either way.
+ *----------------------------------------------------------------------------
+*/
+#if !defined(_NO_SIMD_KERNEL)
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define _NEON_KERNEL
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#define _SSE2_KERNEL
+#include <emmintrin.h>
+#endif
+#endif
+
+#ifdef _HIGH_RES_OUTPUT
+/* the master gain stage leaves 9 fractional bits below the 16-bit output */
+#define WIDE_FRAC_BITS              9
+#define WIDE_MAX                    ((1L << (15 + WIDE_FRAC_BITS)) - 1)
+#define WIDE_MIN                    (-(1L << (15 + WIDE_FRAC_BITS)))
+
+/*----------------------------------------------------------------------------
+ * SynthMasterGainWide
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Same gain stage as SynthMasterGain, but keeps the fractional bits. The
+ * result saturates where SynthMasterGain does, so shifting it down by
+ * WIDE_FRAC_BITS gives the same 16-bit sample.
+ *
+ * Inputs:
+ * pInputBuffer     - 32-bit mix buffer
+ * pWideBuffer      - receives the samples with WIDE_FRAC_BITS fraction bits
+ * nGain            - master gain
+ * numSamples       - number of samples, all channels
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void SynthMasterGainWide (const EAS_I32 *pInputBuffer, int32_t *pWideBuffer, EAS_U16 nGain, EAS_I32 numSamples)
+{
+    EAS_I32 s;
+
+    while (numSamples--)
+    {
+        /*lint -e{704} <avoid divide for performance>*/
+        s = (*pInputBuffer++ >> 7) * (EAS_I32) nGain;
+        if (s > WIDE_MAX)
+            s = WIDE_MAX;
+        else if (s < WIDE_MIN)
+            s = WIDE_MIN;
+        *pWideBuffer++ = (int32_t) s;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * SynthWideEffects
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds whatever the 16-bit effects changed in the output buffer to the wide
+ * samples and left justifies them to 32 bits. Where no effect ran, the
+ * result is just the wide sample.
+ *
+ * Inputs:
+ * pOutputBuffer    - 16-bit output after the effects
+ * pWideBuffer      - wide samples from SynthMasterGainWide, left justified
+ *                    on return
+ * numSamples       - number of samples, all channels
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void SynthWideEffects (const EAS_PCM *pOutputBuffer, int32_t *pWideBuffer, EAS_I32 numSamples)
+{
+    EAS_I32 s;
+    EAS_I32 dry;
+
+    while (numSamples--)
+    {
+        s = *pWideBuffer;
+
+        /*lint -e{704} <avoid divide for performance>*/
+        dry = s >> WIDE_FRAC_BITS;
+        s += ((EAS_I32) *pOutputBuffer++ - dry) * (1L << WIDE_FRAC_BITS);
+        if (s > WIDE_MAX)
+            s = WIDE_MAX;
+        else if (s < WIDE_MIN)
+            s = WIDE_MIN;
+        *pWideBuffer++ = (int32_t) (s * (1L << (16 - WIDE_FRAC_BITS)));
+    }
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * EAS_MixEngineInit()
  *----------------------------------------------------------------------------
@@ -77,13 +182,13 @@ EAS_RESULT EAS_MixEngineInit (S_EAS_DATA *pEASData)
     if (pEASData->staticMemoryModel)
         pEASData->pMixBuffer = EAS_CMEnumData(EAS_CM_MIX_BUFFER);
     else
-        pEASData->pMixBuffer = EAS_HWMalloc(pEASData->hwInstData, BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
+        pEASData->pMixBuffer = EAS_HWMalloc(pEASData->hwInstData, MAX_BLOCK_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
     if (pEASData->pMixBuffer == NULL)
     {
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_FATAL, "Failed to allocate mix buffer memory\n"); */ }
         return EAS_ERROR_MALLOC_FAILED;
     }
-    EAS_HWMemSet((void *)(pEASData->pMixBuffer), 0, BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
+    EAS_HWMemSet((void *)(pEASData->pMixBuffer), 0, MAX_BLOCK_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
 
     return EAS_SUCCESS;
 }
@@ -138,6 +243,12 @@ void EAS_MixEnginePost (S_EAS_DATA *pEASData, EAS_I32 numSamples)
 
 //3 dls: Need to restore the mix engine metrics
 
+#ifdef _INSERT_EFFECTS
+    /* master inserts, bypassed ones are not in the active list */
+    if ((pEASData->pMasterInserts != NULL) && pEASData->pMasterInserts->numActive)
+        EAS_InsertChainProcess(pEASData->pMasterInserts, pEASData->pMixBuffer, numSamples);
+#endif
+
     /* calculate the gain multiplier */
 #ifdef _MAXIMIZER_ENABLED
     if (pEASData->effectsModules[EAS_MODULE_MAXIMIZER].effect)
@@ -175,6 +286,12 @@ void EAS_MixEnginePost (S_EAS_DATA *pEASData, EAS_I32 numSamples)
     SynthMasterGain(pEASData->pMixBuffer, pEASData->pOutputAudioBuffer, gain, (EAS_U16) numSamples);
 #endif
 
+#ifdef _HIGH_RES_OUTPUT
+    /* keep the full precision mix when EAS_RenderFormat wants it */
+    if (pEASData->pWideOutput != NULL)
+        SynthMasterGainWide(pEASData->pMixBuffer, pEASData->pWideOutput, gain, numSamples * NUM_OUTPUT_CHANNELS);
+#endif
+
 #ifdef _ENHANCER_ENABLED
     /* enhancer effect */
     if (pEASData->effectsModules[EAS_MODULE_ENHANCER].effectData)
@@ -231,24 +348,301 @@ void EAS_MixEnginePost (S_EAS_DATA *pEASData, EAS_I32 numSamples)
 #ifdef _REVERB_ENABLED
     /* Reverb effect */
     if (pEASData->effectsModules[EAS_MODULE_REVERB].effectData)
+    {
+#ifdef _METRICS_ENABLED
+        if (pEASData->pMetricsData)
+            (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_REVERB_TIME);
+#endif
+        EAS_TRACE_BEGIN("Reverb");
         (*pEASData->effectsModules[EAS_MODULE_REVERB].effect->pfProcess)
             (pEASData->effectsModules[EAS_MODULE_REVERB].effectData,
             pEASData->pOutputAudioBuffer,
             pEASData->pOutputAudioBuffer,
             numSamples);
+        EAS_TRACE_END();
+#ifdef _METRICS_ENABLED
+        if (pEASData->pMetricsData)
+            (void)(*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_REVERB_TIME);
+#endif
+    }
 #endif
 
 #ifdef _CHORUS_ENABLED
-    /* Chorus effect */
+    /* Chorus effect, it follows the largest chorus send of the channels that are playing */
     if (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData)
+    {
+        EAS_TRACE_BEGIN("Chorus");
+        (void) (*pEASData->effectsModules[EAS_MODULE_CHORUS].effect->pFSetParam)
+            (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData,
+            CHORUS_PARAM_SEND,
+            pEASData->chorusSend);
         (*pEASData->effectsModules[EAS_MODULE_CHORUS].effect->pfProcess)
             (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData,
             pEASData->pOutputAudioBuffer,
             pEASData->pOutputAudioBuffer,
             numSamples);
+        EAS_TRACE_END();
+    }
+#endif
+
+#ifdef _HIGH_RES_OUTPUT
+    /* add the effects to the full precision mix */
+    if (pEASData->pWideOutput != NULL)
+        SynthWideEffects(pEASData->pOutputAudioBuffer, pEASData->pWideOutput, numSamples * NUM_OUTPUT_CHANNELS);
+#endif
+}
+
+#ifdef _BLOCK_RENDER
+/*----------------------------------------------------------------------------
+ * EAS_MixEngineBlockPost
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Post-processes a block of whole frames one frame at a time, so the
+ * effects update their parameters at the same rate as in frame mode.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * numSamples       - samples per channel in the block
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_MixEngineBlockPost (S_EAS_DATA *pEASData, EAS_I32 numSamples)
+{
+    EAS_I32 *pMixBuffer;
+    EAS_PCM *pOutputAudioBuffer;
+#ifdef _HIGH_RES_OUTPUT
+    int32_t *pWideOutput;
+#endif
+    EAS_I32 offset;
+
+    /* the effects read and write the instance buffers, step them through the block */
+    pMixBuffer = pEASData->pMixBuffer;
+    pOutputAudioBuffer = pEASData->pOutputAudioBuffer;
+#ifdef _HIGH_RES_OUTPUT
+    pWideOutput = pEASData->pWideOutput;
+#endif
+    for (offset = 0; offset < numSamples; offset += EAS_FRAME_SIZE(pEASData))
+    {
+        pEASData->pMixBuffer = &pMixBuffer[offset * NUM_OUTPUT_CHANNELS];
+        pEASData->pOutputAudioBuffer = &pOutputAudioBuffer[offset * NUM_OUTPUT_CHANNELS];
+#ifdef _HIGH_RES_OUTPUT
+        if (pWideOutput != NULL)
+            pEASData->pWideOutput = &pWideOutput[offset * NUM_OUTPUT_CHANNELS];
+#endif
+        /* a slice of a frame is post-processed as it is */
+        EAS_MixEnginePost(pEASData, (numSamples - offset < EAS_FRAME_SIZE(pEASData)) ? numSamples - offset : EAS_FRAME_SIZE(pEASData));
+    }
+    pEASData->pMixBuffer = pMixBuffer;
+    pEASData->pOutputAudioBuffer = pOutputAudioBuffer;
+#ifdef _HIGH_RES_OUTPUT
+    pEASData->pWideOutput = pWideOutput;
+#endif
+}
+#endif
+
+#ifdef _IDLE_DETECT
+/*----------------------------------------------------------------------------
+ * EAS_MixEngineIdle
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Post-processes a block with no voice or stream playing in place of
+ * EAS_MixEnginePost. The mix is silent, so the output is zero filled and
+ * only the reverb and chorus are run to keep their state where the full
+ * post-processing would leave it, both return at once when their tail
+ * has died away. Returns EAS_FALSE, leaving the output alone, when an
+ * effect other than the reverb and chorus is in the chain.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * numSamples       - samples per channel in the block
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL EAS_MixEngineIdle (S_EAS_DATA *pEASData, EAS_I32 numSamples)
+{
+    EAS_PCM *pOutputAudioBuffer;
+    EAS_I32 offset;
+    EAS_I32 count;
+
+    /* the state of the other effects does not follow from silent input */
+#ifdef _INSERT_EFFECTS
+    if ((pEASData->pMasterInserts != NULL) && pEASData->pMasterInserts->numActive)
+        return EAS_FALSE;
+#endif
+#ifdef _MAXIMIZER_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_MAXIMIZER].effect)
+        return EAS_FALSE;
+#endif
+#ifdef _ENHANCER_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_ENHANCER].effectData)
+        return EAS_FALSE;
+#endif
+#ifdef _GRAPHIC_EQ_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_GRAPHIC_EQ].effectData)
+        return EAS_FALSE;
+#endif
+#ifdef _COMPRESSOR_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_COMPRESSOR].effectData)
+        return EAS_FALSE;
+#endif
+#ifdef _WOW_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_WOW].effectData)
+        return EAS_FALSE;
+#endif
+#ifdef _TONECONTROLEQ_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_TONECONTROLEQ].effectData)
+        return EAS_FALSE;
+#endif
+
+    EAS_HWMemSet(pEASData->pOutputAudioBuffer, 0, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+#ifdef _HIGH_RES_OUTPUT
+    if (pEASData->pWideOutput != NULL)
+        EAS_HWMemSet(pEASData->pWideOutput, 0, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(int32_t));
+#endif
+
+    /* the effects see the block a frame at a time, as in EAS_MixEngineBlockPost */
+    pOutputAudioBuffer = pEASData->pOutputAudioBuffer;
+    for (offset = 0; offset < numSamples; offset += count)
+    {
+        count = (numSamples - offset < EAS_FRAME_SIZE(pEASData)) ? numSamples - offset : EAS_FRAME_SIZE(pEASData);
+#ifdef _REVERB_ENABLED
+        if (pEASData->effectsModules[EAS_MODULE_REVERB].effectData)
+            (*pEASData->effectsModules[EAS_MODULE_REVERB].effect->pfProcess)
+                (pEASData->effectsModules[EAS_MODULE_REVERB].effectData,
+                &pOutputAudioBuffer[offset * NUM_OUTPUT_CHANNELS],
+                &pOutputAudioBuffer[offset * NUM_OUTPUT_CHANNELS],
+                count);
+#endif
+#ifdef _CHORUS_ENABLED
+        if (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData)
+        {
+            (void) (*pEASData->effectsModules[EAS_MODULE_CHORUS].effect->pFSetParam)
+                (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData,
+                CHORUS_PARAM_SEND,
+                pEASData->chorusSend);
+            (*pEASData->effectsModules[EAS_MODULE_CHORUS].effect->pfProcess)
+                (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData,
+                &pOutputAudioBuffer[offset * NUM_OUTPUT_CHANNELS],
+                &pOutputAudioBuffer[offset * NUM_OUTPUT_CHANNELS],
+                count);
+        }
+#endif
+    }
+
+#ifdef _HIGH_RES_OUTPUT
+    /* a reverb or chorus tail that is still ringing reaches the full precision mix */
+    if (pEASData->pWideOutput != NULL)
+        SynthWideEffects(pEASData->pOutputAudioBuffer, pEASData->pWideOutput, numSamples * NUM_OUTPUT_CHANNELS);
+#endif
+    return EAS_TRUE;
+}
+#endif
+
+#ifdef _STEM_OUTPUT
+/*----------------------------------------------------------------------------
+ * EAS_MixEngineStems
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts the stem mix buffers of the last frame to 16-bit with the same
+ * master gain as the output. The stems are taken before the effects, the
+ * maximizer is not applied to them.
+ *
+ * Inputs:
+ * pEASData         - instance data
+ * ppStems          - one output buffer per stem, NULL entries are skipped
+ * numSamples       - samples per channel in the frame
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_MixEngineStems (S_EAS_DATA *pEASData, EAS_PCM * const *ppStems, EAS_I32 numSamples)
+{
+    S_VOICE_MGR *pVoiceMgr;
+    EAS_U16 gain;
+    EAS_INT stem;
+
+#ifdef _COMPRESSOR_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_COMPRESSOR].effectData)
+        gain = (EAS_U16) (pEASData->masterGain >> 5);
+    else
+        gain = (EAS_U16) (pEASData->masterGain >> 4);
+#else
+    gain = (EAS_U16) (pEASData->masterGain >> 4);
 #endif
 
+    pVoiceMgr = pEASData->pVoiceMgr;
+    for (stem = 0; stem < pVoiceMgr->numStems; stem++)
+        if (ppStems[stem] != NULL)
+            SynthMasterGain(&pVoiceMgr->pStemMixBuffers[stem * STEM_MIX_BUFFER_SIZE], ppStems[stem], gain, (EAS_U16) (numSamples * NUM_OUTPUT_CHANNELS));
 }
+#endif
+
+#ifdef _HIGH_RES_OUTPUT
+/*----------------------------------------------------------------------------
+ * EAS_MixEngineConvert
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts left justified 32-bit samples to an E_EAS_PCM_FORMAT
+ *
+ * Inputs:
+ * pSrc             - left justified samples
+ * pDst             - output, need not be aligned
+ * format           - EAS_PCM_FORMAT_FLOAT, _24_PACKED or _32
+ * numSamples       - number of samples, all channels
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_MixEngineConvert (const int32_t *pSrc, EAS_VOID_PTR pDst, EAS_I32 format, EAS_I32 numSamples)
+{
+    EAS_U8 *pBytes;
+    float *pFloat;
+    EAS_I32 i;
+
+    switch (format)
+    {
+        case EAS_PCM_FORMAT_FLOAT:
+            pFloat = (float*) pDst;
+            i = 0;
+#if defined(_NEON_KERNEL)
+            for (; i + 4 <= numSamples; i += 4)
+                vst1q_f32(&pFloat[i], vcvtq_n_f32_s32(vld1q_s32(&pSrc[i]), 31));
+#elif defined(_SSE2_KERNEL)
+            {
+                const __m128 vScale = _mm_set1_ps(1.0f / 2147483648.0f);
+                for (; i + 4 <= numSamples; i += 4)
+                    _mm_storeu_ps(&pFloat[i], _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*) &pSrc[i])), vScale));
+            }
+#endif
+            for (; i < numSamples; i++)
+                pFloat[i] = (float) pSrc[i] * (1.0f / 2147483648.0f);
+            break;
+
+        case EAS_PCM_FORMAT_24_PACKED:
+            pBytes = (EAS_U8*) pDst;
+            for (i = 0; i < numSamples; i++)
+            {
+                *pBytes++ = (EAS_U8) ((EAS_U32) pSrc[i] >> 8);
+                *pBytes++ = (EAS_U8) ((EAS_U32) pSrc[i] >> 16);
+                *pBytes++ = (EAS_U8) ((EAS_U32) pSrc[i] >> 24);
+            }
+            break;
+
+        case EAS_PCM_FORMAT_32:
+            EAS_HWMemCpy(pDst, pSrc, numSamples * (EAS_I32) sizeof(int32_t));
+            break;
+
+        default:
+            break;
+    }
+}
+#endif
 
 #ifndef NATIVE_EAS_KERNEL
 /*----------------------------------------------------------------------------
@@ -311,6 +705,10 @@ void SynthMasterGain (long *pInputBuffer, EAS_PCM *pOutputBuffer, EAS_U16 nGain,
 EAS_RESULT EAS_MixEngineShutdown (S_EAS_DATA *pEASData)
 {
 
+#ifdef _INSERT_EFFECTS
+    EAS_InsertChainShutdown(pEASData, &pEASData->pMasterInserts);
+#endif
+
     /* check Configuration Module for static memory allocation */
     if (!pEASData->staticMemoryModel && (pEASData->pMixBuffer != NULL))
         EAS_HWFree(pEASData->hwInstData, pEASData->pMixBuffer);
@@ -318,8 +716,482 @@ EAS_RESULT EAS_MixEngineShutdown (S_EAS_DATA *pEASData)
     return EAS_SUCCESS;
 }
 
-#ifdef UNIFIED_MIXER
+#ifdef _INSERT_EFFECTS
+/*----------------------------------------------------------------------------
+ * InsertChainUpdate
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Rebuilds the list of inserts that are in use and not bypassed
+ *
+ * Inputs:
+ * pChain           - insert chain
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void InsertChainUpdate (S_INSERT_CHAIN *pChain)
+{
+    EAS_INT i;
+
+    pChain->numActive = 0;
+    for (i = 0; i < EAS_MAX_INSERTS; i++)
+        if ((pChain->inserts[i].effect != NULL) && !pChain->inserts[i].bypass)
+            pChain->pActive[pChain->numActive++] = &pChain->inserts[i];
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertGet
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Looks up an insert of a chain
+ *
+ * Inputs:
+ * pChain           - insert chain, may be NULL
+ * index            - index from EAS_InsertAdd
+ *
+ * Outputs:
+ * the insert, or NULL if there is none at the index
+ *
+ *----------------------------------------------------------------------------
+*/
+S_INSERT_EFFECT *EAS_InsertGet (S_INSERT_CHAIN *pChain, EAS_I32 index)
+{
+    if ((pChain == NULL) || (index < 0) || (index >= EAS_MAX_INSERTS) || (pChain->inserts[index].effect == NULL))
+        return NULL;
+    return &pChain->inserts[index];
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertAdd
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds an effect to an insert chain, allocating the chain on the first
+ * insert
+ *
+ * Inputs:
+ * pEASData         - instance data
+ * ppChain          - insert chain, NULL until the first insert
+ * bufferSize       - samples in the chain's mix buffer, 0 for none
+ * pEffect          - effect interface
+ * pUserData        - initial instance data of the effect
+ * pIndex           - receives the index of the insert
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_InsertAdd (S_EAS_DATA *pEASData, S_INSERT_CHAIN **ppChain, EAS_I32 bufferSize, const S_EFFECTS32_INTERFACE *pEffect, EAS_VOID_PTR pUserData, EAS_I32 *pIndex)
+{
+    S_INSERT_CHAIN *pChain;
+    EAS_VOID_PTR effectData;
+    EAS_RESULT result;
+    EAS_INT i;
+
+    if ((pEffect == NULL) || (pEffect->pfProcess == NULL) || (pIndex == NULL))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    /* the chain and its mix buffer are one allocation */
+    if ((pChain = *ppChain) == NULL)
+    {
+        pChain = EAS_HWMalloc(pEASData->hwInstData, (EAS_I32) sizeof(S_INSERT_CHAIN) + bufferSize * (EAS_I32) sizeof(EAS_I32));
+        if (pChain == NULL)
+            return EAS_ERROR_MALLOC_FAILED;
+        EAS_HWMemSet(pChain, 0, (EAS_I32) sizeof(S_INSERT_CHAIN));
+        if (bufferSize)
+            pChain->pBuffer = (EAS_I32*) (pChain + 1);
+        *ppChain = pChain;
+    }
+
+    for (i = 0; i < EAS_MAX_INSERTS; i++)
+        if (pChain->inserts[i].effect == NULL)
+            break;
+    if (i == EAS_MAX_INSERTS)
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    effectData = pUserData;
+    if (pEffect->pfInit != NULL)
+    {
+        if ((result = (*pEffect->pfInit)(pEASData, &effectData)) != EAS_SUCCESS)
+            return result;
+    }
+
+    pChain->inserts[i].effect = pEffect;
+    pChain->inserts[i].effectData = effectData;
+    pChain->inserts[i].bypass = EAS_FALSE;
+    InsertChainUpdate(pChain);
+    *pIndex = i;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertRemove
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Shuts down an insert and frees its slot
+ *
+ * Inputs:
+ * pEASData         - instance data
+ * pChain           - insert chain, may be NULL
+ * index            - index from EAS_InsertAdd
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_InsertRemove (S_EAS_DATA *pEASData, S_INSERT_CHAIN *pChain, EAS_I32 index)
+{
+    S_INSERT_EFFECT *pInsert;
+
+    if ((pInsert = EAS_InsertGet(pChain, index)) == NULL)
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    if (pInsert->effect->pfShutdown != NULL)
+        (void) (*pInsert->effect->pfShutdown)(pEASData, pInsert->effectData);
+    pInsert->effect = NULL;
+    pInsert->effectData = NULL;
+    InsertChainUpdate(pChain);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertBypass
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Takes an insert out of the active list of its chain, or puts it back
+ *
+ * Inputs:
+ * pChain           - insert chain, may be NULL
+ * index            - index from EAS_InsertAdd
+ * bypass           - EAS_TRUE to bypass the insert
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_InsertBypass (S_INSERT_CHAIN *pChain, EAS_I32 index, EAS_BOOL bypass)
+{
+    S_INSERT_EFFECT *pInsert;
+
+    if ((pInsert = EAS_InsertGet(pChain, index)) == NULL)
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    pInsert->bypass = bypass ? EAS_TRUE : EAS_FALSE;
+    InsertChainUpdate(pChain);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertChainProcess
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Runs the active inserts of a chain over a 32-bit mix buffer in place
+ *
+ * Inputs:
+ * pChain           - insert chain
+ * pBuffer          - interleaved mix buffer
+ * numSamples       - samples per channel
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_InsertChainProcess (S_INSERT_CHAIN *pChain, EAS_I32 *pBuffer, EAS_I32 numSamples)
+{
+    EAS_INT i;
+
+    EAS_TRACE_BEGIN("Inserts");
+    for (i = 0; i < pChain->numActive; i++)
+        (*pChain->pActive[i]->effect->pfProcess)(pChain->pActive[i]->effectData, pBuffer, pBuffer, numSamples);
+    EAS_TRACE_END();
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertChainShutdown
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Shuts down the inserts of a chain and frees it
+ *
+ * Inputs:
+ * pEASData         - instance data
+ * ppChain          - insert chain, set to NULL
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_InsertChainShutdown (S_EAS_DATA *pEASData, S_INSERT_CHAIN **ppChain)
+{
+    EAS_INT i;
+
+    if (*ppChain == NULL)
+        return;
+    for (i = 0; i < EAS_MAX_INSERTS; i++)
+        (void) EAS_InsertRemove(pEASData, *ppChain, i);
+    EAS_HWFree(pEASData->hwInstData, *ppChain);
+    *ppChain = NULL;
+}
+#endif
+
 #ifndef NATIVE_MIX_STREAM
+#if defined(_NEON_KERNEL)
+/* add four 32-bit values to the mix buffer */
+EAS_INLINE void MixAccumulate (EAS_I32 *pMixBuffer, int32x4_t v)
+{
+#if defined(__LP64__)
+    vst1q_s64((int64_t*) pMixBuffer, vaddw_s32(vld1q_s64((const int64_t*) pMixBuffer), vget_low_s32(v)));
+    vst1q_s64((int64_t*) pMixBuffer + 2, vaddw_s32(vld1q_s64((const int64_t*) pMixBuffer + 2), vget_high_s32(v)));
+#else
+    vst1q_s32((int32_t*) pMixBuffer, vaddq_s32(vld1q_s32((const int32_t*) pMixBuffer), v));
+#endif
+}
+
+/* (sample * (gain >> 15)) >> NUM_MIXER_GUARD_BITS for four samples */
+EAS_INLINE int32x4_t MixScale (const EAS_PCM *pInputBuffer, int32x4_t vGain)
+{
+    return vshrq_n_s32(vmulq_s32(vmovl_s16(vld1_s16(pInputBuffer)), vshrq_n_s32(vGain, 15)), NUM_MIXER_GUARD_BITS);
+}
+
+/* gains of the next four samples, for a stereo source left and right alternate */
+EAS_INLINE int32x4_t MixGains (EAS_I32 gain0, EAS_I32 gain1, EAS_I32 gain2, EAS_I32 gain3)
+{
+    int32_t gains[4];
+
+    gains[0] = (int32_t) gain0;
+    gains[1] = (int32_t) gain1;
+    gains[2] = (int32_t) gain2;
+    gains[3] = (int32_t) gain3;
+    return vld1q_s32(gains);
+}
+
+/*----------------------------------------------------------------------------
+ * MixStreamVector
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * NEON version of the EAS_MixStream loops, four output frames at a time.
+ * A gain without an increment is the ramp with a zero increment, so one
+ * loop serves both.
+ *
+ * Inputs:
+ * numFrames must be a multiple of four
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void MixStreamVector (const EAS_PCM *pInputBuffer, EAS_I32 *pMixBuffer, EAS_I32 numFrames, EAS_I32 gainLeft, EAS_I32 gainRight, EAS_I32 gainIncLeft, EAS_I32 gainIncRight, EAS_I32 flags)
+{
+    int32x4_t vGain0;
+    int32x4_t vGain1;
+    int32x4_t vGainInc0;
+    int32x4_t vGainInc1;
+    int32x4_t vLeft;
+    int32x4_t vRight;
+    int32x4x2_t vPair;
+
+    switch (flags & (MIX_FLAGS_STEREO_SOURCE | MIX_FLAGS_STEREO_OUTPUT))
+    {
+        /* mono to mono */
+        case 0:
+            vGain0 = MixGains(gainLeft + gainIncLeft, gainLeft + 2 * gainIncLeft, gainLeft + 3 * gainIncLeft, gainLeft + 4 * gainIncLeft);
+            vGainInc0 = vdupq_n_s32((int32_t) (4 * gainIncLeft));
+            for (; numFrames > 0; numFrames -= 4)
+            {
+                MixAccumulate(pMixBuffer, MixScale(pInputBuffer, vGain0));
+                vGain0 = vaddq_s32(vGain0, vGainInc0);
+                pInputBuffer += 4;
+                pMixBuffer += 4;
+            }
+            break;
+
+        /* mono to stereo */
+        case MIX_FLAGS_STEREO_OUTPUT:
+            vGain0 = MixGains(gainLeft + gainIncLeft, gainLeft + 2 * gainIncLeft, gainLeft + 3 * gainIncLeft, gainLeft + 4 * gainIncLeft);
+            vGain1 = MixGains(gainRight + gainIncRight, gainRight + 2 * gainIncRight, gainRight + 3 * gainIncRight, gainRight + 4 * gainIncRight);
+            vGainInc0 = vdupq_n_s32((int32_t) (4 * gainIncLeft));
+            vGainInc1 = vdupq_n_s32((int32_t) (4 * gainIncRight));
+            for (; numFrames > 0; numFrames -= 4)
+            {
+                vLeft = MixScale(pInputBuffer, vGain0);
+                vRight = MixScale(pInputBuffer, vGain1);
+                vPair = vzipq_s32(vLeft, vRight);
+                MixAccumulate(pMixBuffer, vPair.val[0]);
+                MixAccumulate(pMixBuffer + 4, vPair.val[1]);
+                vGain0 = vaddq_s32(vGain0, vGainInc0);
+                vGain1 = vaddq_s32(vGain1, vGainInc1);
+                pInputBuffer += 4;
+                pMixBuffer += 8;
+            }
+            break;
+
+        /* stereo to mono */
+        case MIX_FLAGS_STEREO_SOURCE:
+            vGain0 = MixGains(gainLeft + gainIncLeft, gainRight + gainIncRight, gainLeft + 2 * gainIncLeft, gainRight + 2 * gainIncRight);
+            vGain1 = MixGains(gainLeft + 3 * gainIncLeft, gainRight + 3 * gainIncRight, gainLeft + 4 * gainIncLeft, gainRight + 4 * gainIncRight);
+            vGainInc0 = MixGains(4 * gainIncLeft, 4 * gainIncRight, 4 * gainIncLeft, 4 * gainIncRight);
+            for (; numFrames > 0; numFrames -= 4)
+            {
+                /* add the right channel of each frame to the left */
+                vPair = vuzpq_s32(MixScale(pInputBuffer, vGain0), MixScale(pInputBuffer + 4, vGain1));
+                MixAccumulate(pMixBuffer, vaddq_s32(vPair.val[0], vPair.val[1]));
+                vGain0 = vaddq_s32(vGain0, vGainInc0);
+                vGain1 = vaddq_s32(vGain1, vGainInc0);
+                pInputBuffer += 8;
+                pMixBuffer += 4;
+            }
+            break;
+
+        /* stereo to stereo */
+        default:
+            vGain0 = MixGains(gainLeft + gainIncLeft, gainRight + gainIncRight, gainLeft + 2 * gainIncLeft, gainRight + 2 * gainIncRight);
+            vGain1 = MixGains(gainLeft + 3 * gainIncLeft, gainRight + 3 * gainIncRight, gainLeft + 4 * gainIncLeft, gainRight + 4 * gainIncRight);
+            vGainInc0 = MixGains(4 * gainIncLeft, 4 * gainIncRight, 4 * gainIncLeft, 4 * gainIncRight);
+            for (; numFrames > 0; numFrames -= 4)
+            {
+                MixAccumulate(pMixBuffer, MixScale(pInputBuffer, vGain0));
+                MixAccumulate(pMixBuffer + 4, MixScale(pInputBuffer + 4, vGain1));
+                vGain0 = vaddq_s32(vGain0, vGainInc0);
+                vGain1 = vaddq_s32(vGain1, vGainInc0);
+                pInputBuffer += 8;
+                pMixBuffer += 8;
+            }
+            break;
+    }
+}
+#endif
+
+#if defined(_SSE2_KERNEL)
+/* low 32 bits of a 32 x 32 bit multiply, the same for signed and unsigned */
+EAS_INLINE __m128i MixMulLo32 (__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/* add four 32-bit values to the mix buffer */
+EAS_INLINE void MixAccumulate (EAS_I32 *pMixBuffer, __m128i v)
+{
+#if defined(__LP64__)
+    __m128i sign = _mm_srai_epi32(v, 31);
+    _mm_storeu_si128((__m128i*) pMixBuffer, _mm_add_epi64(_mm_loadu_si128((const __m128i*) pMixBuffer), _mm_unpacklo_epi32(v, sign)));
+    _mm_storeu_si128((__m128i*) pMixBuffer + 1, _mm_add_epi64(_mm_loadu_si128((const __m128i*) pMixBuffer + 1), _mm_unpackhi_epi32(v, sign)));
+#else
+    _mm_storeu_si128((__m128i*) pMixBuffer, _mm_add_epi32(_mm_loadu_si128((const __m128i*) pMixBuffer), v));
+#endif
+}
+
+/* (sample * (gain >> 15)) >> NUM_MIXER_GUARD_BITS for four samples */
+EAS_INLINE __m128i MixScale (const EAS_PCM *pInputBuffer, __m128i vGain)
+{
+    __m128i vTmp;
+
+    vTmp = _mm_loadl_epi64((const __m128i*) pInputBuffer);
+    vTmp = _mm_srai_epi32(_mm_unpacklo_epi16(vTmp, vTmp), 16);
+    return _mm_srai_epi32(MixMulLo32(vTmp, _mm_srai_epi32(vGain, 15)), NUM_MIXER_GUARD_BITS);
+}
+
+/* gains of the next four samples, for a stereo source left and right alternate */
+EAS_INLINE __m128i MixGains (EAS_I32 gain0, EAS_I32 gain1, EAS_I32 gain2, EAS_I32 gain3)
+{
+    return _mm_setr_epi32((int) gain0, (int) gain1, (int) gain2, (int) gain3);
+}
+
+/*----------------------------------------------------------------------------
+ * MixStreamVector
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * SSE2 version of the EAS_MixStream loops, four output frames at a time.
+ * A gain without an increment is the ramp with a zero increment, so one
+ * loop serves both.
+ *
+ * Inputs:
+ * numFrames must be a multiple of four
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void MixStreamVector (const EAS_PCM *pInputBuffer, EAS_I32 *pMixBuffer, EAS_I32 numFrames, EAS_I32 gainLeft, EAS_I32 gainRight, EAS_I32 gainIncLeft, EAS_I32 gainIncRight, EAS_I32 flags)
+{
+    __m128i vGain0;
+    __m128i vGain1;
+    __m128i vGainInc0;
+    __m128i vGainInc1;
+    __m128i vLeft;
+    __m128i vRight;
+
+    switch (flags & (MIX_FLAGS_STEREO_SOURCE | MIX_FLAGS_STEREO_OUTPUT))
+    {
+        /* mono to mono */
+        case 0:
+            vGain0 = MixGains(gainLeft + gainIncLeft, gainLeft + 2 * gainIncLeft, gainLeft + 3 * gainIncLeft, gainLeft + 4 * gainIncLeft);
+            vGainInc0 = _mm_set1_epi32((int) (4 * gainIncLeft));
+            for (; numFrames > 0; numFrames -= 4)
+            {
+                MixAccumulate(pMixBuffer, MixScale(pInputBuffer, vGain0));
+                vGain0 = _mm_add_epi32(vGain0, vGainInc0);
+                pInputBuffer += 4;
+                pMixBuffer += 4;
+            }
+            break;
+
+        /* mono to stereo */
+        case MIX_FLAGS_STEREO_OUTPUT:
+            vGain0 = MixGains(gainLeft + gainIncLeft, gainLeft + 2 * gainIncLeft, gainLeft + 3 * gainIncLeft, gainLeft + 4 * gainIncLeft);
+            vGain1 = MixGains(gainRight + gainIncRight, gainRight + 2 * gainIncRight, gainRight + 3 * gainIncRight, gainRight + 4 * gainIncRight);
+            vGainInc0 = _mm_set1_epi32((int) (4 * gainIncLeft));
+            vGainInc1 = _mm_set1_epi32((int) (4 * gainIncRight));
+            for (; numFrames > 0; numFrames -= 4)
+            {
+                vLeft = MixScale(pInputBuffer, vGain0);
+                vRight = MixScale(pInputBuffer, vGain1);
+                MixAccumulate(pMixBuffer, _mm_unpacklo_epi32(vLeft, vRight));
+                MixAccumulate(pMixBuffer + 4, _mm_unpackhi_epi32(vLeft, vRight));
+                vGain0 = _mm_add_epi32(vGain0, vGainInc0);
+                vGain1 = _mm_add_epi32(vGain1, vGainInc1);
+                pInputBuffer += 4;
+                pMixBuffer += 8;
+            }
+            break;
+
+        /* stereo to mono */
+        case MIX_FLAGS_STEREO_SOURCE:
+            vGain0 = MixGains(gainLeft + gainIncLeft, gainRight + gainIncRight, gainLeft + 2 * gainIncLeft, gainRight + 2 * gainIncRight);
+            vGain1 = MixGains(gainLeft + 3 * gainIncLeft, gainRight + 3 * gainIncRight, gainLeft + 4 * gainIncLeft, gainRight + 4 * gainIncRight);
+            vGainInc0 = MixGains(4 * gainIncLeft, 4 * gainIncRight, 4 * gainIncLeft, 4 * gainIncRight);
+            for (; numFrames > 0; numFrames -= 4)
+            {
+                /* add the right channel of each frame to the left */
+                vLeft = _mm_shuffle_epi32(MixScale(pInputBuffer, vGain0), _MM_SHUFFLE(3, 1, 2, 0));
+                vRight = _mm_shuffle_epi32(MixScale(pInputBuffer + 4, vGain1), _MM_SHUFFLE(3, 1, 2, 0));
+                MixAccumulate(pMixBuffer, _mm_add_epi32(_mm_unpacklo_epi64(vLeft, vRight), _mm_unpackhi_epi64(vLeft, vRight)));
+                vGain0 = _mm_add_epi32(vGain0, vGainInc0);
+                vGain1 = _mm_add_epi32(vGain1, vGainInc0);
+                pInputBuffer += 8;
+                pMixBuffer += 4;
+            }
+            break;
+
+        /* stereo to stereo */
+        default:
+            vGain0 = MixGains(gainLeft + gainIncLeft, gainRight + gainIncRight, gainLeft + 2 * gainIncLeft, gainRight + 2 * gainIncRight);
+            vGain1 = MixGains(gainLeft + 3 * gainIncLeft, gainRight + 3 * gainIncRight, gainLeft + 4 * gainIncLeft, gainRight + 4 * gainIncRight);
+            vGainInc0 = MixGains(4 * gainIncLeft, 4 * gainIncRight, 4 * gainIncLeft, 4 * gainIncRight);
+            for (; numFrames > 0; numFrames -= 4)
+            {
+                MixAccumulate(pMixBuffer, MixScale(pInputBuffer, vGain0));
+                MixAccumulate(pMixBuffer + 4, MixScale(pInputBuffer + 4, vGain1));
+                vGain0 = _mm_add_epi32(vGain0, vGainInc0);
+                vGain1 = _mm_add_epi32(vGain1, vGainInc0);
+                pInputBuffer += 8;
+                pMixBuffer += 8;
+            }
+            break;
+    }
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * EAS_MixStream
  *----------------------------------------------------------------------------
@@ -334,6 +1206,9 @@ EAS_RESULT EAS_MixEngineShutdown (S_EAS_DATA *pEASData)
  * gainRight    right gain increment per sample
  * flags        bit 0 = stereo source
  *              bit 1 = stereo output
+ *
+ * The vector kernels keep the gains and products in 32 bits, gain >> 15
+ * must fit in 16 bits as it does for all callers
  *----------------------------------------------------------------------------
 */
 void EAS_MixStream (EAS_PCM *pInputBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSamples, EAS_I32 gainLeft, EAS_I32 gainRight, EAS_I32 gainIncLeft, EAS_I32 gainIncRight, EAS_I32 flags)
@@ -341,6 +1216,21 @@ void EAS_MixStream (EAS_PCM *pInputBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSampl
     EAS_I32 temp;
     EAS_INT src, dest;
 
+#if defined(_NEON_KERNEL) || defined(_SSE2_KERNEL)
+    /* vector kernel does groups of four output frames, the rest are done below */
+    temp = ((flags & MIX_FLAGS_STEREO_SOURCE) ? (numSamples >> 1) : numSamples) & ~3;
+    if (temp > 0)
+    {
+        MixStreamVector(pInputBuffer, pMixBuffer, temp, gainLeft, gainRight, gainIncLeft, gainIncRight, flags);
+        src = (flags & MIX_FLAGS_STEREO_SOURCE) ? temp * 2 : temp;
+        pInputBuffer += src;
+        numSamples -= src;
+        pMixBuffer += (flags & MIX_FLAGS_STEREO_OUTPUT) ? temp * 2 : temp;
+        gainLeft += temp * gainIncLeft;
+        gainRight += temp * gainIncRight;
+    }
+#endif
+
     /* NOTE: There are a lot of optimizations that can be done
      * in the native implementations based on register
      * availability, etc. For example, it may make sense to
@@ -461,5 +1351,4 @@ void EAS_MixStream (EAS_PCM *pInputBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSampl
     }
 }
 #endif
-#endif
 
@@ -38,6 +38,8 @@
 #define MIX_FLAGS_STEREO_OUTPUT     2
 #define NUM_MIXER_GUARD_BITS        4
 
+#include <stdint.h>
+
 #include "eas_effects.h"
 
 extern void SynthMasterGain( long *pInputBuffer, EAS_PCM *pOutputBuffer, EAS_U16 nGain, EAS_U16 nNumLoopSamples);
@@ -95,6 +97,45 @@ void EAS_MixEnginePrep (EAS_DATA_HANDLE pEASData, EAS_I32 nNumSamplesToAdd);
 */
 void EAS_MixEnginePost (EAS_DATA_HANDLE pEASData, EAS_I32 nNumSamplesToAdd);
 
+#ifdef _BLOCK_RENDER
+/*----------------------------------------------------------------------------
+ * EAS_MixEngineBlockPost
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Post-processes a block of whole frames one frame at a time, so the
+ * effects update their parameters at the same rate as in frame mode.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * numSamples       - samples per channel in the block
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_MixEngineBlockPost (EAS_DATA_HANDLE pEASData, EAS_I32 numSamples);
+#endif
+
+#ifdef _IDLE_DETECT
+/*----------------------------------------------------------------------------
+ * EAS_MixEngineIdle
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Post-processes a block with no voice or stream playing in place of
+ * EAS_MixEnginePost. Returns EAS_FALSE, leaving the output alone, when an
+ * effect other than the reverb and chorus is in the chain.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * numSamples       - samples per channel in the block
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL EAS_MixEngineIdle (EAS_DATA_HANDLE pEASData, EAS_I32 numSamples);
+#endif
+
 /*----------------------------------------------------------------------------
  * EAS_MixEngineShutdown()
  *----------------------------------------------------------------------------
@@ -113,7 +154,108 @@ void EAS_MixEnginePost (EAS_DATA_HANDLE pEASData, EAS_I32 nNumSamplesToAdd);
 */
 EAS_RESULT EAS_MixEngineShutdown (EAS_DATA_HANDLE pEASData);
 
-#ifdef UNIFIED_MIXER
+#ifdef _STEM_OUTPUT
+/*----------------------------------------------------------------------------
+ * EAS_MixEngineStems
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts the stem mix buffers of the last frame to 16-bit
+ *
+ * Inputs:
+ * pEASData         - instance data
+ * ppStems          - one output buffer per stem, NULL entries are skipped
+ * numSamples       - samples per channel in the frame
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_MixEngineStems (EAS_DATA_HANDLE pEASData, EAS_PCM * const *ppStems, EAS_I32 numSamples);
+#endif
+
+#ifdef _HIGH_RES_OUTPUT
+/*----------------------------------------------------------------------------
+ * EAS_MixEngineConvert
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts left justified 32-bit samples to an E_EAS_PCM_FORMAT
+ *
+ * Inputs:
+ * pSrc             - left justified samples
+ * pDst             - output, need not be aligned
+ * format           - EAS_PCM_FORMAT_FLOAT, _24_PACKED or _32
+ * numSamples       - number of samples, all channels
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_MixEngineConvert (const int32_t *pSrc, EAS_VOID_PTR pDst, EAS_I32 format, EAS_I32 numSamples);
+#endif
+
+#ifdef _INSERT_EFFECTS
+/*----------------------------------------------------------------------------
+ * EAS_InsertGet
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Looks up an insert of a chain, NULL if there is none at the index
+ *
+ *----------------------------------------------------------------------------
+*/
+S_INSERT_EFFECT *EAS_InsertGet (S_INSERT_CHAIN *pChain, EAS_I32 index);
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertAdd
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds an effect to an insert chain, allocating the chain and a mix buffer
+ * of bufferSize samples on the first insert
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_InsertAdd (EAS_DATA_HANDLE pEASData, S_INSERT_CHAIN **ppChain, EAS_I32 bufferSize, const S_EFFECTS32_INTERFACE *pEffect, EAS_VOID_PTR pUserData, EAS_I32 *pIndex);
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertRemove
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Shuts down an insert and frees its slot
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_InsertRemove (EAS_DATA_HANDLE pEASData, S_INSERT_CHAIN *pChain, EAS_I32 index);
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertBypass
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Takes an insert out of the active list of its chain, or puts it back
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_InsertBypass (S_INSERT_CHAIN *pChain, EAS_I32 index, EAS_BOOL bypass);
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertChainProcess
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Runs the active inserts of a chain over a 32-bit mix buffer in place
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_InsertChainProcess (S_INSERT_CHAIN *pChain, EAS_I32 *pBuffer, EAS_I32 numSamples);
+
+/*----------------------------------------------------------------------------
+ * EAS_InsertChainShutdown
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Shuts down the inserts of a chain and frees it
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_InsertChainShutdown (EAS_DATA_HANDLE pEASData, S_INSERT_CHAIN **ppChain);
+#endif
+
 /*----------------------------------------------------------------------------
  * EAS_MixStream
  *----------------------------------------------------------------------------
@@ -131,7 +273,6 @@ EAS_RESULT EAS_MixEngineShutdown (EAS_DATA_HANDLE pEASData);
  *----------------------------------------------------------------------------
 */
 void EAS_MixStream (EAS_PCM *pInputBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSamples, EAS_I32 gainLeft, EAS_I32 gainRight, EAS_I32 gainIncLeft, EAS_I32 gainIncRight, EAS_I32 flags);
-#endif
 
 #endif /* #ifndef _EAS_MIXER_H */
 
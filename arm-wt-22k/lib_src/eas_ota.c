@@ -27,6 +27,9 @@
  *----------------------------------------------------------------------------
 */
 
+/* allocations of this module are reported as parser state */
+#define EAS_MEM_CATEGORY    EAS_MEM_PARSERS
+
 #define LOG_TAG "Sonivox"
 #include <log/log.h>
 
@@ -39,6 +42,7 @@
 #include "eas_config.h"
 #include "eas_vm_protos.h"
 #include "eas_otadata.h"
+#include "eas_tonecache.h"
 
 /* increase gain for mono ringtones */
 #define OTA_GAIN_OFFSET             8
@@ -99,6 +103,10 @@ static EAS_RESULT OTA_ParseHeader (S_EAS_DATA *pEASData, S_OTA_DATA* pData);
 static EAS_RESULT OTA_FetchBitField (EAS_HW_DATA_HANDLE hwInstData, S_OTA_DATA *pData, EAS_I32 numBits, EAS_U8 *pValue);
 static EAS_RESULT OTA_SavePosition (EAS_HW_DATA_HANDLE hwInstData, S_OTA_DATA *pData, S_OTA_LOC *pLoc);
 static EAS_RESULT OTA_RestorePosition (EAS_HW_DATA_HANDLE hwInstData, S_OTA_DATA *pData, S_OTA_LOC *pLoc);
+#ifdef _RINGTONE_COMPILE_EVENTS
+static EAS_RESULT OTA_CompileEvents (S_EAS_DATA *pEASData, S_OTA_DATA *pData);
+static EAS_RESULT OTA_PlayEvent (S_EAS_DATA *pEASData, S_OTA_DATA *pData, EAS_INT parserMode);
+#endif
 
 
 /*----------------------------------------------------------------------------
@@ -272,6 +280,16 @@ static EAS_RESULT OTA_Prepare (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
         return result;
 
     pData->state = EAS_STATE_READY;
+
+#ifdef _RINGTONE_COMPILE_EVENTS
+    /* unroll the patterns into an event list, a metadata probe reads the file once */
+    if (!pEASData->staticMemoryModel && (pData->pSynth != NULL))
+    {
+        if ((result = OTA_CompileEvents(pEASData, pData)) != EAS_SUCCESS)
+            return result;
+    }
+#endif
+
     return EAS_SUCCESS;
 }
 
@@ -334,6 +352,12 @@ static EAS_RESULT OTA_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I
     if (pData->state >= EAS_STATE_OPEN)
         return EAS_SUCCESS;
 
+#ifdef _RINGTONE_COMPILE_EVENTS
+    /* play from the compiled event list */
+    if (pData->events != NULL)
+        return OTA_PlayEvent(pEASData, pData, parserMode);
+#endif
+
     /* initialize MIDI channel when the track starts playing */
     if (pData->time == 0)
     {
@@ -350,7 +374,8 @@ static EAS_RESULT OTA_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I
     if (pData->note)
     {
         /* stop the note */
-        VMStopNote(pEASData->pVoiceMgr, pData->pSynth, OTA_CHANNEL, pData->note, 0);
+        if (parserMode != eParserModeMetaData)
+            VMStopNote(pEASData->pVoiceMgr, pData->pSynth, OTA_CHANNEL, pData->note, 0);
         pData->note = 0;
 
         /* check for rest between notes */
@@ -636,6 +661,12 @@ static EAS_RESULT OTA_Close (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     if (pData->pSynth != NULL)
         VMMIDIShutdown(pEASData, pData->pSynth);
 
+#ifdef _RINGTONE_COMPILE_EVENTS
+    /* free the compiled event list */
+    if (pData->events != NULL)
+        EAS_HWFree(pEASData->hwInstData, pData->events);
+#endif
+
     /* if using dynamic memory, free it */
     if (!pEASData->staticMemoryModel)
         EAS_HWFree(pEASData->hwInstData, pData);
@@ -670,6 +701,9 @@ static EAS_RESULT OTA_Reset (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     /* reset the synth */
     VMReset(pEASData->pVoiceMgr, pData->pSynth, EAS_TRUE);
     pData->note = 0;
+#ifdef _RINGTONE_COMPILE_EVENTS
+    pData->eventIndex = 0;
+#endif
 
     /* reset file position and re-parse header */
     pData->state = EAS_STATE_ERROR;
@@ -1087,3 +1121,206 @@ static EAS_RESULT OTA_RestorePosition (EAS_HW_DATA_HANDLE hwInstData, S_OTA_DATA
     return EAS_HWFileSeek(hwInstData, pData->fileHandle, pLoc->fileOffset);
 }
 
+
+#ifdef _RINGTONE_COMPILE_EVENTS
+/*----------------------------------------------------------------------------
+ * OTA_CompileEvents()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses the whole song once and saves the notes and rests in an event
+ * list, so that playback and locating don't read the file. Pattern loops
+ * and repeats are unrolled; the scale, style, tempo and volume instructions
+ * are folded into the notes. Songs with an infinite loop, an unknown note
+ * style or a parsing error are left to be parsed from the file.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pData            - pointer to parser instance data
+ *
+ * Outputs:
+ * Returns EAS_SUCCESS if the song is to be parsed from the file.
+ *
+ * Side Effects:
+ * The parser state is restored when done.
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT OTA_CompileEvents (S_EAS_DATA *pEASData, S_OTA_DATA *pData)
+{
+    S_OTA_DATA saved;
+    S_TONE_EVENT *pEvents;
+    S_TONE_EVENT *pEvent;
+    EAS_I32 filePos;
+    EAS_I32 time;
+    EAS_U32 numEvents;
+    EAS_U32 maxEvents;
+    EAS_RESULT result;
+    EAS_BOOL rest;
+#ifdef _RINGTONE_EVENT_CACHE
+    S_TONE_CACHE_KEY key;
+#endif
+
+    /* save the parser state, the walk below uses the parser */
+    if ((result = EAS_HWFilePos(pEASData->hwInstData, pData->fileHandle, &filePos)) != EAS_SUCCESS)
+        return result;
+#ifdef _RINGTONE_EVENT_CACHE
+    /* a ringtone compiled before is copied from the cache */
+    if ((result = EAS_ToneCacheLookup(pEASData, pData->fileHandle, TONE_CACHE_OTA, &key, &pData->events, &pData->numEvents)) != EAS_SUCCESS)
+        return result;
+    if (pData->events != NULL)
+    {
+        pData->eventIndex = 0;
+        return EAS_HWFileSeek(pEASData->hwInstData, pData->fileHandle, filePos);
+    }
+    if ((result = EAS_HWFileSeek(pEASData->hwInstData, pData->fileHandle, filePos)) != EAS_SUCCESS)
+        return result;
+#endif
+    saved = *pData;
+
+    pEvents = NULL;
+    numEvents = 0;
+    maxEvents = 0;
+    for (;;)
+    {
+        /* a call that ends the rest after a note adds no event */
+        rest = (pData->note != 0) && (pData->restTicks != 0);
+        time = pData->time;
+        if ((result = OTA_Event(pEASData, pData, eParserModeMetaData)) != EAS_SUCCESS)
+            break;
+
+        /* infinite loops are only played in play mode */
+        if (pData->loopCount == OTA_INFINITE_LOOP)
+        {
+            result = EAS_ERROR_FEATURE_NOT_AVAILABLE;
+            break;
+        }
+        if (pData->state == EAS_STATE_STOPPING)
+            break;
+        if (rest || ((pData->note == 0) && (pData->time == time)))
+            continue;
+
+        /* an unknown style keeps the rest of an earlier note */
+        if (pData->note && (pData->style > 2))
+        {
+            result = EAS_ERROR_FEATURE_NOT_AVAILABLE;
+            break;
+        }
+
+        /* grow the event list */
+        if (numEvents == maxEvents)
+        {
+            S_TONE_EVENT *pTemp;
+
+            if (maxEvents >= TONE_MAX_EVENTS)
+            {
+                result = EAS_ERROR_DATA_INCONSISTENCY;
+                break;
+            }
+            maxEvents += TONE_EVENT_BLOCK_SIZE;
+            if ((pTemp = EAS_HWMalloc(pEASData->hwInstData, (EAS_I32) (maxEvents * sizeof(S_TONE_EVENT)))) == NULL)
+            {
+                result = EAS_ERROR_MALLOC_FAILED;
+                break;
+            }
+            if (pEvents != NULL)
+            {
+                EAS_HWMemCpy(pTemp, pEvents, (EAS_I32) (numEvents * sizeof(S_TONE_EVENT)));
+                EAS_HWFree(pEASData->hwInstData, pEvents);
+            }
+            pEvents = pTemp;
+        }
+
+        /* save the note or rest */
+        pEvent = &pEvents[numEvents++];
+        pEvent->ticks = pData->time - time;
+        pEvent->restTicks = pData->note ? (EAS_I32) pData->restTicks : 0;
+        pEvent->note = pData->note;
+        pEvent->velocity = pData->velocity;
+    }
+
+    /* restore the parser state */
+    *pData = saved;
+    if ((result == EAS_SUCCESS) && (numEvents != 0))
+    {
+        pData->events = pEvents;
+        pData->numEvents = numEvents;
+        pData->eventIndex = 0;
+#ifdef _RINGTONE_EVENT_CACHE
+        EAS_ToneCacheStore(pEASData, &key, pEvents, numEvents);
+#endif
+    }
+    else
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "OTA_CompileEvents: parsing from file, error %d\n", result); */ }
+        if (pEvents != NULL)
+            EAS_HWFree(pEASData->hwInstData, pEvents);
+    }
+    return EAS_HWFileSeek(pEASData->hwInstData, pData->fileHandle, filePos);
+}
+
+/*----------------------------------------------------------------------------
+ * OTA_PlayEvent()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Plays the next event from the compiled event list, the same way
+ * OTA_Event plays it from the file
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pData            - pointer to parser instance data
+ * parserMode       - parser mode
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT OTA_PlayEvent (S_EAS_DATA *pEASData, S_OTA_DATA *pData, EAS_INT parserMode)
+{
+    S_TONE_EVENT *pEvent;
+
+    /* initialize MIDI channel when the track starts playing */
+    if ((pData->time == 0) && (parserMode != eParserModeMetaData))
+    {
+        VMProgramChange(pEASData->pVoiceMgr, pData->pSynth, OTA_CHANNEL, OTA_PROGRAM);
+        VMControlChange(pEASData->pVoiceMgr, pData->pSynth, OTA_CHANNEL, 7, 127);
+    }
+
+    /* check for end of note */
+    if (pData->note)
+    {
+        if (parserMode != eParserModeMetaData)
+            VMStopNote(pEASData->pVoiceMgr, pData->pSynth, OTA_CHANNEL, pData->note, 0);
+        pData->note = 0;
+
+        /* check for rest between notes */
+        if (pData->restTicks)
+        {
+            pData->time += (EAS_I32) pData->restTicks;
+            pData->restTicks = 0;
+            return EAS_SUCCESS;
+        }
+    }
+
+    /* end of the list */
+    if (pData->eventIndex >= pData->numEvents)
+    {
+        pData->state = EAS_STATE_STOPPING;
+        VMReleaseAllVoices(pEASData->pVoiceMgr, pData->pSynth);
+        return EAS_SUCCESS;
+    }
+
+    /* start the note */
+    pEvent = &pData->events[pData->eventIndex++];
+    if (pEvent->note)
+    {
+        pData->note = pEvent->note;
+        pData->restTicks = (EAS_U32) pEvent->restTicks;
+        if (parserMode == eParserModePlay)
+            VMStartNote(pEASData->pVoiceMgr, pData->pSynth, OTA_CHANNEL, pData->note, pEvent->velocity);
+    }
+    pData->time += pEvent->ticks;
+    return EAS_SUCCESS;
+}
+#endif
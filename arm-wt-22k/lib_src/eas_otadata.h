@@ -33,6 +33,7 @@
 #define EAS_OTADATA_H
 
 #include "eas_data.h"
+#include "eas_miditypes.h"
 
 /* definition for state flags */
 #define OTA_FLAGS_UNICODE           0x01    /* unicode text */
@@ -74,6 +75,11 @@ typedef struct
     EAS_U8          velocity;               /* current volume */
     EAS_U8          state;                  /* current state EAS_STATE_XXXX */
     EAS_U8          loopCount;              /* loop count for pattern */
+#ifdef _RINGTONE_COMPILE_EVENTS
+    S_TONE_EVENT    *events;                /* notes and rests of the whole file */
+    EAS_U32         numEvents;              /* number of compiled events */
+    EAS_U32         eventIndex;             /* index of next event */
+#endif
 } S_OTA_DATA;
 
 #endif
@@ -34,6 +34,39 @@
 #include "eas_pan.h"
 #include "eas_math.h"
 
+#ifdef _MATH_TABLES
+/*----------------------------------------------------------------------------
+ * Left and right gains for each pan value from -63 to 63, the results of the
+ * sin/cos approximations below
+ *----------------------------------------------------------------------------
+*/
+static const EAS_I16 panGains[127][2] =
+{
+    {32722,   466}, {32673,   929}, {32621,  1389}, {32565,  1845}, {32506,  2298}, {32444,  2748},
+    {32379,  3195}, {32310,  3638}, {32238,  4078}, {32162,  4514}, {32083,  4947}, {32001,  5377},
+    {31916,  5804}, {31828,  6228}, {31736,  6648}, {31640,  7064}, {31542,  7478}, {31440,  7888},
+    {31335,  8295}, {31226,  8698}, {31114,  9098}, {30999,  9495}, {30880,  9888}, {30759, 10279},
+    {30633, 10665}, {30505, 11049}, {30374, 11430}, {30238, 11806}, {30100, 12180}, {29958, 12550},
+    {29813, 12917}, {29665, 13281}, {29513, 13641}, {29358, 13998}, {29200, 14352}, {29039, 14703},
+    {28874, 15050}, {28705, 15393}, {28534, 15734}, {28359, 16071}, {28181, 16405}, {28000, 16736},
+    {27815, 17063}, {27627, 17387}, {27435, 17707}, {27241, 18025}, {27043, 18339}, {26841, 18649},
+    {26637, 18957}, {26429, 19261}, {26217, 19561}, {26003, 19859}, {25785, 20153}, {25564, 20444},
+    {25339, 20731}, {25112, 21016}, {24880, 21296}, {24646, 21574}, {24408, 21848}, {24167, 22119},
+    {23923, 22387}, {23675, 22651}, {23424, 22912}, {23170, 23170}, {22912, 23424}, {22651, 23675},
+    {22387, 23923}, {22119, 24167}, {21848, 24408}, {21574, 24646}, {21296, 24880}, {21015, 25111},
+    {20731, 25339}, {20444, 25564}, {20153, 25785}, {19859, 26003}, {19561, 26217}, {19261, 26429},
+    {18957, 26637}, {18649, 26841}, {18339, 27043}, {18025, 27241}, {17707, 27435}, {17387, 27627},
+    {17063, 27815}, {16736, 28000}, {16405, 28181}, {16071, 28359}, {15734, 28534}, {15393, 28705},
+    {15049, 28873}, {14702, 29038}, {14352, 29200}, {13998, 29358}, {13641, 29513}, {13281, 29665},
+    {12917, 29813}, {12550, 29958}, {12180, 30100}, {11806, 30238}, {11429, 30373}, {11049, 30505},
+    {10665, 30633}, {10278, 30758}, { 9888, 30880}, { 9495, 30999}, { 9098, 31114}, { 8698, 31226},
+    { 8294, 31334}, { 7887, 31439}, { 7477, 31541}, { 7064, 31640}, { 6647, 31735}, { 6227, 31827},
+    { 5804, 31916}, { 5377, 32001}, { 4947, 32083}, { 4514, 32162}, { 4077, 32237}, { 3637, 32309},
+    { 3194, 32378}, { 2748, 32444}, { 2298, 32506}, { 1845, 32565}, { 1388, 32620}, {  928, 32672},
+    {  465, 32721}
+};
+#endif
+
 /*----------------------------------------------------------------------------
  * EAS_CalcPanControl()
  *----------------------------------------------------------------------------
@@ -48,6 +81,8 @@
  * where  c = 1/sqrt(2)
  * using the a0 + x*(a1 + x*a2) approach
  *
+ * With _MATH_TABLES the gains are looked up in a table of the results.
+ *
  * Inputs:
  * pan          - pan value (-63 to + 63)
  *
@@ -60,7 +95,9 @@
 */
 void EAS_CalcPanControl (EAS_INT pan, EAS_I16 *pGainLeft, EAS_I16 *pGainRight)
 {
+#ifndef _MATH_TABLES
     EAS_INT temp;
+#endif
     EAS_INT netAngle;
 
     /* impose hard limit */
@@ -71,6 +108,11 @@ void EAS_CalcPanControl (EAS_INT pan, EAS_I16 *pGainLeft, EAS_I16 *pGainRight)
     else
         netAngle = pan;
 
+#ifdef _MATH_TABLES
+    *pGainLeft = panGains[netAngle + 63][0];
+    *pGainRight = panGains[netAngle + 63][1];
+#else
+
     /*lint -e{701} <avoid multiply for performance reasons>*/
     netAngle = netAngle << 8;
 
@@ -94,5 +136,6 @@ void EAS_CalcPanControl (EAS_INT pan, EAS_I16 *pGainLeft, EAS_I16 *pGainRight)
         temp = 0;
 
     *pGainLeft = (EAS_I16) temp;
+#endif
 }
 
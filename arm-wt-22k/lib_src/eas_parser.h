@@ -92,7 +92,31 @@ typedef enum
     PARSER_DATA_NOTE_COUNT,
     PARSER_DATA_MAX_PCM_STREAMS,
     PARSER_DATA_GAIN_OFFSET,
-    PARSER_DATA_PLAY_MODE
+    PARSER_DATA_PLAY_MODE,
+    PARSER_DATA_SEEK_CHECKPOINT,
+    PARSER_DATA_BYTES_AVAILABLE,
+    PARSER_DATA_DOWNLOAD_COMPLETE,
+    PARSER_DATA_TICK_POSITION,      /* get only, *pValue is a time in msecs/256 on input and receives the MIDI tick at that time */
+    PARSER_DATA_PREFETCH_NOTES,     /* set only, value is the end of the next frame in msecs/256, parsers without look ahead ignore it */
+    PARSER_DATA_STATE_SIZE,         /* get only, bytes of a parser snapshot */
+    PARSER_DATA_SAVE_STATE,         /* set only, value points to PARSER_DATA_STATE_SIZE bytes that receive a snapshot */
+    PARSER_DATA_RESTORE_STATE       /* set only, value points to a snapshot from PARSER_DATA_SAVE_STATE */
 } E_PARSER_DATA;
 
+#ifdef _PARSE_LIMITS
+/* events between two reads of the clock for the time limit */
+#define PARSE_BUDGET_CLOCK_EVENTS   64
+
+/* work done by one parse, charged against the limits of the instance */
+typedef struct
+{
+    EAS_U32                 numEvents;
+    EAS_U32                 startTime;
+    EAS_INT                 clockCount;
+} S_PARSE_BUDGET;
+
+extern void EAS_ParseBudgetStart (struct s_eas_data_tag *pEASData, S_PARSE_BUDGET *pBudget);
+extern EAS_RESULT EAS_ParseBudgetCharge (struct s_eas_data_tag *pEASData, S_PARSE_BUDGET *pBudget);
+#endif
+
 #endif /* #ifndef _EAS_PARSER_H */
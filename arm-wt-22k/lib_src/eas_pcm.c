@@ -27,6 +27,9 @@
  *----------------------------------------------------------------------------
 */
 
+/* allocations of this module are reported as parser state */
+#define EAS_MEM_CATEGORY    EAS_MEM_PARSERS
+
 #include "eas_data.h"
 #include "eas_report.h"
 #include "eas_host.h"
@@ -38,11 +41,34 @@
 
 #define PCM_MIXER_GUARD_BITS (NUM_MIXER_GUARD_BITS + 1)
 
+/* shift from a 1.15 stream gain to the EAS_MixStream gain, leaves the extra guard bit */
+#define PCM_GAIN_SHIFT      (15 - (PCM_MIXER_GUARD_BITS - NUM_MIXER_GUARD_BITS))
+
+/* output frames interpolated before each mix */
+#define PCM_MIX_CHUNK       64
+
+/* local prototypes */
+static EAS_RESULT PCMDecoderInit (EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState);
+static EAS_RESULT PCMDecoderDecode (EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState);
+
+/*----------------------------------------------------------------------------
+ * PCMDecoder
+ *
+ * Decoder interface for linear PCM, 8-bit or 16-bit little-endian
+ *----------------------------------------------------------------------------
+*/
+static const S_DECODER_INTERFACE PCMDecoder =
+{
+    PCMDecoderInit,
+    PCMDecoderDecode
+};
+
 /*----------------------------------------------------------------------------
  * EAS_PEInit()
  *----------------------------------------------------------------------------
  * Purpose:
- * Initializes the PCM engine
+ * Initializes the PCM engine. With dynamic memory the stream table is not
+ * allocated until the first stream is opened.
  *
  * Inputs:
  *
@@ -56,6 +82,17 @@
 */
 EAS_RESULT EAS_PEInit (S_EAS_DATA *pEASData)
 {
+    EAS_INT i;
+
+    pEASData->pPCMStreams = NULL;
+    if (pEASData->staticMemoryModel)
+    {
+        pEASData->pPCMStreams = EAS_CMEnumData(EAS_CM_PCM_DATA);
+        if (pEASData->pPCMStreams == NULL)
+            return EAS_ERROR_MALLOC_FAILED;
+        for (i = 0; i < MAX_PCM_STREAMS; i++)
+            pEASData->pPCMStreams[i].state = EAS_STATE_EMPTY;
+    }
     return EAS_SUCCESS;
 }
 
@@ -77,5 +114,667 @@ EAS_RESULT EAS_PEInit (S_EAS_DATA *pEASData)
 */
 EAS_RESULT EAS_PEShutdown (S_EAS_DATA *pEASData)
 {
+    if (!pEASData->staticMemoryModel && (pEASData->pPCMStreams != NULL))
+        EAS_HWFree(pEASData->hwInstData, pEASData->pPCMStreams);
+    pEASData->pPCMStreams = NULL;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * PCMMixRate()
+ *----------------------------------------------------------------------------
+ * Returns the sample rate of the mix buffer
+ *----------------------------------------------------------------------------
+*/
+static EAS_U32 PCMMixRate (S_EAS_DATA *pEASData)
+{
+#ifdef _RUNTIME_SAMPLE_RATE
+    return (EAS_U32) _OUTPUT_SAMPLE_RATE << pEASData->rateShift;
+#else
+    return _OUTPUT_SAMPLE_RATE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * PCMRewind()
+ *----------------------------------------------------------------------------
+ * Empties the ring and moves the stream to a frame, the frames between the
+ * start of the block and the requested one are dropped as they are decoded
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT PCMRewind (S_EAS_DATA *pEASData, S_PCM_STATE *pState, EAS_U32 frame)
+{
+    EAS_I32 location;
+    EAS_U32 block;
+
+    block = frame / (EAS_U32) pState->samplesPerBlock;
+    pState->skipFrames = (EAS_I32) (frame - block * (EAS_U32) pState->samplesPerBlock);
+
+    /* past the end, the stream stops on the next frame */
+    if (block > (EAS_U32) (pState->byteCount / pState->blockSize))
+    {
+        location = pState->byteCount;
+        pState->skipFrames = 0;
+    }
+    else
+        location = (EAS_I32) (block * (EAS_U32) pState->blockSize);
+
+    pState->readPos = pState->writePos = 0;
+    pState->phase = 0;
+    pState->blockBytes = pState->blockPos = 0;
+    pState->flags &= ~PCM_FLAGS_EMPTY;
+    pState->currentGain = pState->gain;
+    return EAS_PESeek(pEASData, pState, &location);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PEOpenStream()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Starts a PCM stream
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pParams          - format and location of the audio
+ *
+ * Outputs:
+ * pHandle          - handle of the new stream
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEOpenStream (S_EAS_DATA *pEASData, S_PCM_OPEN_PARAMS *pParams, EAS_PCM_HANDLE *pHandle)
+{
+    S_PCM_STATE *pState;
+    EAS_RESULT result;
+    EAS_INT i;
+
+    *pHandle = NULL;
+    if ((pParams->sampleRate == 0) || (pParams->sampleRate > PCM_MAX_SAMPLE_RATE) || (pParams->size < 0))
+        return EAS_ERROR_INVALID_PCM_TYPE;
+
+    /* the stream table is allocated by the first open */
+    if (pEASData->pPCMStreams == NULL)
+    {
+        pEASData->pPCMStreams = EAS_HWMalloc(pEASData->hwInstData, (EAS_I32) (sizeof(S_PCM_STATE) * MAX_PCM_STREAMS));
+        if (pEASData->pPCMStreams == NULL)
+            return EAS_ERROR_MALLOC_FAILED;
+        for (i = 0; i < MAX_PCM_STREAMS; i++)
+            pEASData->pPCMStreams[i].state = EAS_STATE_EMPTY;
+    }
+
+    /* find a free stream */
+    pState = NULL;
+    for (i = 0; i < MAX_PCM_STREAMS; i++)
+    {
+        if (pEASData->pPCMStreams[i].state == EAS_STATE_EMPTY)
+        {
+            pState = &pEASData->pPCMStreams[i];
+            break;
+        }
+    }
+    if (pState == NULL)
+        return EAS_ERROR_MAX_PCM_STREAMS;
+
+    /* the ring and file buffers are not cleared, they are written before they are read */
+    EAS_HWMemSet(pState, 0, (EAS_I32) ((EAS_U8*) pState->ring - (EAS_U8*) pState));
+    pState->fileHandle = pParams->fileHandle;
+    pState->startPos = pParams->startPos;
+    pState->byteCount = pParams->size;
+    pState->blockSize = pParams->blockSize;
+    pState->sampleRate = pParams->sampleRate;
+    pState->flags = pParams->flags & (PCM_FLAGS_STEREO | PCM_FLAGS_8_BIT | PCM_FLAGS_UNSIGNED);
+    pState->gain = pState->currentGain = pParams->volume;
+    pState->phaseInc = (pParams->sampleRate << PCM_PHASE_SHIFT) / PCMMixRate(pEASData);
+
+    switch (pParams->decoder)
+    {
+        case EAS_DECODER_PCM:
+            pState->pDecoder = &PCMDecoder;
+            break;
+#ifdef _IMA_DECODER
+        case EAS_DECODER_IMA_ADPCM:
+            pState->pDecoder = &IMADecoder;
+            break;
+#endif
+        default:
+            pState->state = EAS_STATE_EMPTY;
+            return EAS_ERROR_INVALID_PCM_TYPE;
+    }
+
+    /* the decoder sets the block size */
+    if ((result = (*pState->pDecoder->pfInit)(pEASData, pState)) == EAS_SUCCESS)
+        result = PCMRewind(pEASData, pState, 0);
+    if (result != EAS_SUCCESS)
+    {
+        pState->state = EAS_STATE_EMPTY;
+        return result;
+    }
+
+    pState->state = EAS_STATE_READY;
+    *pHandle = pState;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PECloseStream()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees a PCM stream
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PECloseStream (S_EAS_DATA *pEASData, EAS_PCM_HANDLE pState)
+{
+    pState->state = EAS_STATE_EMPTY;
+    pState->fileHandle = NULL;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PEReset()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Rewinds a PCM stream and makes it ready to play
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEReset (S_EAS_DATA *pEASData, EAS_PCM_HANDLE pState)
+{
+    EAS_RESULT result;
+
+    if ((result = PCMRewind(pEASData, pState, 0)) != EAS_SUCCESS)
+        return result;
+    pState->state = EAS_STATE_READY;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PELocate()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Moves a PCM stream to a time in milliseconds
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ * time             - new position in milliseconds
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PELocate (S_EAS_DATA *pEASData, EAS_PCM_HANDLE pState, EAS_I32 time)
+{
+    EAS_RESULT result;
+    EAS_U32 frame;
+
+    if (time < 0)
+        time = 0;
+    if (((EAS_U32) time / 1000) >= (0xffffffff / pState->sampleRate) - 1)
+        frame = 0xffffffff;
+    else
+        frame = ((EAS_U32) time / 1000) * pState->sampleRate + (((EAS_U32) time % 1000) * pState->sampleRate) / 1000;
+    if ((result = PCMRewind(pEASData, pState, frame)) != EAS_SUCCESS)
+        return result;
+    if ((pState->state != EAS_STATE_PAUSING) && (pState->state != EAS_STATE_PAUSED))
+        pState->state = EAS_STATE_READY;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PEState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the state of a PCM stream
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pInstData        - stream handle
+ *
+ * Outputs:
+ * pState           - EAS_STATE_XXX
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEState (S_EAS_DATA *pEASData, EAS_PCM_HANDLE pInstData, EAS_STATE *pState)
+{
+    *pState = pInstData->state;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PEPause()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Pauses a PCM stream
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEPause (S_EAS_DATA *pEASData, EAS_PCM_HANDLE pState)
+{
+    if ((pState->state != EAS_STATE_READY) && (pState->state != EAS_STATE_PLAY))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    pState->state = EAS_STATE_PAUSED;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PEResume()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Resumes a paused PCM stream
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEResume (S_EAS_DATA *pEASData, EAS_PCM_HANDLE pState)
+{
+    if ((pState->state != EAS_STATE_PAUSING) && (pState->state != EAS_STATE_PAUSED))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    pState->state = EAS_STATE_PLAY;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PEUpdateVolume()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the gain of a PCM stream
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ * gain             - new gain, 1.15 format
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEUpdateVolume (S_EAS_DATA *pEASData, EAS_PCM_HANDLE pState, EAS_I16 gain)
+{
+    /* nothing has played yet, there is no step to smooth */
+    pState->gain = gain;
+    if (pState->state == EAS_STATE_READY)
+        pState->currentGain = gain;
     return EAS_SUCCESS;
 }
+
+/*----------------------------------------------------------------------------
+ * EAS_PESeek()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Locate to a particular byte in a PCM stream
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ * pLocation        - byte offset from the start of the audio
+ *
+ * Outputs:
+ * pLocation        - offset reached, no further than the end of the audio
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PESeek (S_EAS_DATA *pEASData, S_PCM_STATE *pState, EAS_I32 *pLocation)
+{
+    if (*pLocation > pState->byteCount)
+        *pLocation = pState->byteCount;
+    pState->bytesLeft = pState->byteCount - *pLocation;
+    return EAS_HWFileSeek(pEASData->hwInstData, pState->fileHandle, pState->startPos + *pLocation);
+}
+
+/*----------------------------------------------------------------------------
+ * PCMFill()
+ *----------------------------------------------------------------------------
+ * Reads and decodes blocks until the ring is full or the file runs out.
+ * Each block is read with one call to the host.
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT PCMFill (S_EAS_DATA *pEASData, S_PCM_STATE *pState)
+{
+    EAS_RESULT result;
+    EAS_I32 count;
+    EAS_U32 writePos;
+    EAS_INT shift;
+
+    shift = (pState->flags & PCM_FLAGS_STEREO) ? 1 : 0;
+    while ((PCM_RING_SIZE - (EAS_I32) (pState->writePos - pState->readPos)) >= PCM_DECODE_GRANULE)
+    {
+        /* read the next block */
+        if (pState->blockPos >= pState->blockBytes)
+        {
+            if (pState->bytesLeft == 0)
+            {
+                pState->flags |= PCM_FLAGS_EMPTY;
+                break;
+            }
+            count = (pState->bytesLeft < pState->blockSize) ? pState->bytesLeft : pState->blockSize;
+            if ((result = EAS_HWReadFile(pEASData->hwInstData, pState->fileHandle, pState->fileBuffer, count, &count)) != EAS_SUCCESS)
+                return result;
+            if (count == 0)
+                return EAS_ERROR_FILE_READ_FAILED;
+            pState->bytesLeft -= count;
+            pState->blockBytes = count;
+            pState->blockPos = 0;
+        }
+
+        writePos = pState->writePos;
+        if ((result = (*pState->pDecoder->pfDecode)(pEASData, pState)) != EAS_SUCCESS)
+            return result;
+
+        /* drop the frames before a locate position */
+        if (pState->skipFrames)
+        {
+            count = (EAS_I32) (pState->writePos - pState->readPos) >> shift;
+            if (count > pState->skipFrames)
+                count = pState->skipFrames;
+            pState->readPos += (EAS_U32) count << shift;
+            pState->skipFrames -= count;
+        }
+
+        /* a block too short for the decoder is used up */
+        if ((pState->writePos == writePos) && (pState->blockPos < pState->blockBytes))
+            break;
+    }
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * PCMInterpolate()
+ *----------------------------------------------------------------------------
+ * Converts decoded frames to the mix rate with linear interpolation.
+ * Returns the number of output frames written, fewer than requested when
+ * the ring runs short.
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 PCMInterpolate (S_PCM_STATE *pState, EAS_PCM *pOutput, EAS_I32 numFrames)
+{
+    EAS_I32 avail;
+    EAS_I32 count;
+    EAS_I32 advance;
+    EAS_I32 s0, s1;
+    EAS_U32 phase;
+    EAS_U32 readPos;
+    EAS_INT channels;
+    EAS_INT channel;
+    EAS_BOOL empty;
+
+    channels = (pState->flags & PCM_FLAGS_STEREO) ? 2 : 1;
+    empty = (pState->flags & PCM_FLAGS_EMPTY) ? EAS_TRUE : EAS_FALSE;
+    avail = (EAS_I32) (pState->writePos - pState->readPos) / channels;
+    readPos = pState->readPos;
+    phase = pState->phase;
+
+    for (count = 0; count < numFrames; count++)
+    {
+        /* the last frame of the stream is held until the phase passes it */
+        if ((avail < 2) && !(empty && (avail == 1)))
+            break;
+        advance = (EAS_I32) ((phase + pState->phaseInc) >> PCM_PHASE_SHIFT);
+        if ((advance > avail) && !empty)
+            break;
+
+        for (channel = 0; channel < channels; channel++)
+        {
+            s0 = pState->ring[(readPos + (EAS_U32) channel) & PCM_RING_MASK];
+            s1 = (avail > 1) ? pState->ring[(readPos + (EAS_U32) (channels + channel)) & PCM_RING_MASK] : s0;
+            *pOutput++ = (EAS_PCM) (s0 + (((s1 - s0) * (EAS_I32) phase) >> PCM_PHASE_SHIFT));
+        }
+
+        phase = (phase + pState->phaseInc) & PCM_PHASE_MASK;
+        if (advance > avail)
+            advance = avail;
+        readPos += (EAS_U32) (advance * channels);
+        avail -= advance;
+    }
+
+    pState->readPos = readPos;
+    pState->phase = phase;
+    return count;
+}
+
+/*----------------------------------------------------------------------------
+ * PCMRenderStream()
+ *----------------------------------------------------------------------------
+ * Decodes, rate converts and mixes one frame of a stream into the mix buffer
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT PCMRenderStream (S_EAS_DATA *pEASData, S_PCM_STATE *pState, EAS_I32 numSamples)
+{
+    EAS_PCM buffer[PCM_MIX_CHUNK * 2];
+    EAS_I32 *pMixBuffer;
+    EAS_RESULT result;
+    EAS_I32 count;
+    EAS_I32 gain;
+    EAS_I32 gainInc;
+    EAS_I32 flags;
+
+    pMixBuffer = pEASData->pMixBuffer;
+    flags = (pState->flags & PCM_FLAGS_STEREO) ? MIX_FLAGS_STEREO_SOURCE : 0;
+#if (NUM_OUTPUT_CHANNELS == 2)
+    flags |= MIX_FLAGS_STEREO_OUTPUT;
+#endif
+
+    while (numSamples > 0)
+    {
+        if ((result = PCMFill(pEASData, pState)) != EAS_SUCCESS)
+            return result;
+        count = PCMInterpolate(pState, buffer, (numSamples < PCM_MIX_CHUNK) ? numSamples : PCM_MIX_CHUNK);
+        if (count == 0)
+            break;
+
+        /* ramp a gain change over the first chunk */
+        gain = (EAS_I32) pState->currentGain << PCM_GAIN_SHIFT;
+        gainInc = (((EAS_I32) pState->gain << PCM_GAIN_SHIFT) - gain) / count;
+        pState->currentGain = pState->gain;
+#if (NUM_OUTPUT_CHANNELS == 1)
+        /* a stereo source is summed to mono at half gain */
+        if (flags & MIX_FLAGS_STEREO_SOURCE)
+        {
+            gain >>= 1;
+            gainInc >>= 1;
+        }
+#endif
+        EAS_MixStream(buffer, pMixBuffer, (flags & MIX_FLAGS_STEREO_SOURCE) ? count * 2 : count, gain, gain, gainInc, gainInc, flags);
+
+        pMixBuffer += count * NUM_OUTPUT_CHANNELS;
+        numSamples -= count;
+    }
+
+    /* the stream stops once the last decoded frame has played */
+    if ((pState->flags & PCM_FLAGS_EMPTY) && (pState->writePos == pState->readPos))
+        pState->state = EAS_STATE_STOPPED;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PERender()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Render a buffer of PCM audio
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * numSamples       - frames to mix into the mix buffer
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PERender (S_EAS_DATA *pEASData, EAS_I32 numSamples)
+{
+    S_PCM_STATE *pState;
+    EAS_RESULT result;
+    EAS_INT i;
+
+    if (pEASData->pPCMStreams == NULL)
+        return EAS_SUCCESS;
+
+    for (i = 0; i < MAX_PCM_STREAMS; i++)
+    {
+        pState = &pEASData->pPCMStreams[i];
+        if (pState->state == EAS_STATE_READY)
+            pState->state = EAS_STATE_PLAY;
+        if (pState->state != EAS_STATE_PLAY)
+            continue;
+        if ((result = PCMRenderStream(pEASData, pState, numSamples)) != EAS_SUCCESS)
+        {
+            pState->state = EAS_STATE_ERROR;
+            return result;
+        }
+    }
+    return EAS_SUCCESS;
+}
+
+#ifdef _IDLE_DETECT
+/*----------------------------------------------------------------------------
+ * EAS_PEActive()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns EAS_TRUE if a PCM stream plays in the next EAS_PERender call
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL EAS_PEActive (S_EAS_DATA *pEASData)
+{
+    EAS_INT i;
+
+    if (pEASData->pPCMStreams == NULL)
+        return EAS_FALSE;
+
+    for (i = 0; i < MAX_PCM_STREAMS; i++)
+        if ((pEASData->pPCMStreams[i].state == EAS_STATE_READY) || (pEASData->pPCMStreams[i].state == EAS_STATE_PLAY))
+            return EAS_TRUE;
+    return EAS_FALSE;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * PCMDecoderInit()
+ *----------------------------------------------------------------------------
+ * Reads whole frames, as many as fit in the file buffer
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT PCMDecoderInit (EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState)
+{
+    EAS_I32 frameSize;
+
+    frameSize = (pState->flags & PCM_FLAGS_8_BIT) ? 1 : 2;
+    if (pState->flags & PCM_FLAGS_STEREO)
+        frameSize *= 2;
+    pState->samplesPerBlock = PCM_FILE_BUFFER_SIZE / frameSize;
+    pState->blockSize = pState->samplesPerBlock * frameSize;
+
+    /* a partial frame at the end is not played */
+    pState->byteCount -= pState->byteCount % frameSize;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * PCMDecoderDecode()
+ *----------------------------------------------------------------------------
+ * Copies samples from the file buffer to the ring
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT PCMDecoderDecode (EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState)
+{
+    const EAS_U8 *pSrc;
+    EAS_U32 writePos;
+    EAS_I32 count;
+
+    count = PCM_RING_SIZE - (EAS_I32) (pState->writePos - pState->readPos);
+    if (pState->flags & PCM_FLAGS_STEREO)
+        count &= ~1;
+    pSrc = pState->fileBuffer + pState->blockPos;
+    writePos = pState->writePos;
+
+    if (pState->flags & PCM_FLAGS_8_BIT)
+    {
+        if (count > pState->blockBytes - pState->blockPos)
+            count = pState->blockBytes - pState->blockPos;
+        pState->blockPos += count;
+        if (pState->flags & PCM_FLAGS_UNSIGNED)
+        {
+            while (count--)
+                pState->ring[writePos++ & PCM_RING_MASK] = (EAS_PCM) ((*pSrc++ - 128) << 8);
+        }
+        else
+        {
+            while (count--)
+                pState->ring[writePos++ & PCM_RING_MASK] = (EAS_PCM) ((EAS_I8) *pSrc++ * 256);
+        }
+    }
+    else
+    {
+        if (count > (pState->blockBytes - pState->blockPos) >> 1)
+            count = (pState->blockBytes - pState->blockPos) >> 1;
+        pState->blockPos += count * 2;
+        while (count--)
+        {
+            pState->ring[writePos++ & PCM_RING_MASK] = (EAS_PCM) (EAS_I16) (pSrc[0] | (pSrc[1] << 8));
+            pSrc += 2;
+        }
+    }
+
+    pState->writePos = writePos;
+    return EAS_SUCCESS;
+}
+
@@ -37,6 +37,19 @@
 typedef struct s_pcm_state_tag *EAS_PCM_HANDLE;
 typedef void (*EAS_PCM_CALLBACK) (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR cbInstData, EAS_PCM_HANDLE pcmHandle, EAS_STATE state);
 
+/* parameters for EAS_PEOpenStream */
+typedef struct s_pcm_open_params_tag
+{
+    EAS_FILE_HANDLE     fileHandle;         /* file holding the audio */
+    E_DECODER_MODULES   decoder;            /* audio format */
+    EAS_U32             sampleRate;         /* sample rate of the audio */
+    EAS_I32             startPos;           /* file position of the first audio byte */
+    EAS_I32             size;               /* bytes of audio */
+    EAS_I32             blockSize;          /* ADPCM block size in bytes, unused for PCM */
+    EAS_U32             flags;              /* PCM_FLAGS_XXX, 16-bit samples are little-endian */
+    EAS_I16             volume;             /* initial gain */
+} S_PCM_OPEN_PARAMS;
+
 /*----------------------------------------------------------------------------
  * EAS_PEInit()
  *----------------------------------------------------------------------------
@@ -91,5 +104,180 @@ EAS_RESULT EAS_PEShutdown (EAS_DATA_HANDLE pEASData);
 */
 EAS_RESULT EAS_PERender (EAS_DATA_HANDLE pEASData, EAS_I32 numSamples);
 
+#ifdef _IDLE_DETECT
+/*----------------------------------------------------------------------------
+ * EAS_PEActive()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns EAS_TRUE if a PCM stream plays in the next EAS_PERender call
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL EAS_PEActive (EAS_DATA_HANDLE pEASData);
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_PEOpenStream()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Starts a PCM stream. The stream reads its audio from the file one block
+ * at a time and plays from the next EAS_PERender call.
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pParams          - format and location of the audio
+ *
+ * Outputs:
+ * pHandle          - handle of the new stream
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEOpenStream (EAS_DATA_HANDLE pEASData, S_PCM_OPEN_PARAMS *pParams, EAS_PCM_HANDLE *pHandle);
+
+/*----------------------------------------------------------------------------
+ * EAS_PECloseStream()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees a PCM stream, the file is left open
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PECloseStream (EAS_DATA_HANDLE pEASData, EAS_PCM_HANDLE pState);
+
+/*----------------------------------------------------------------------------
+ * EAS_PEReset()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Rewinds a PCM stream and makes it ready to play
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEReset (EAS_DATA_HANDLE pEASData, EAS_PCM_HANDLE pState);
+
+/*----------------------------------------------------------------------------
+ * EAS_PELocate()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Moves a PCM stream to a time in milliseconds. A paused stream stays paused.
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ * time             - new position in milliseconds
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PELocate (EAS_DATA_HANDLE pEASData, EAS_PCM_HANDLE pState, EAS_I32 time);
+
+/*----------------------------------------------------------------------------
+ * EAS_PEState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the state of a PCM stream
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pInstData        - stream handle
+ *
+ * Outputs:
+ * pState           - EAS_STATE_XXX
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEState (EAS_DATA_HANDLE pEASData, EAS_PCM_HANDLE pInstData, EAS_STATE *pState);
+
+/*----------------------------------------------------------------------------
+ * EAS_PEPause()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Pauses a PCM stream at the end of the current frame
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEPause (EAS_DATA_HANDLE pEASData, EAS_PCM_HANDLE pState);
+
+/*----------------------------------------------------------------------------
+ * EAS_PEResume()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Resumes a paused PCM stream
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEResume (EAS_DATA_HANDLE pEASData, EAS_PCM_HANDLE pState);
+
+/*----------------------------------------------------------------------------
+ * EAS_PEUpdateVolume()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the gain of a PCM stream, the change is ramped over the next frame
+ *
+ * Inputs:
+ * pEASData         - pointer to EAS persistent data object
+ * pState           - stream handle
+ * gain             - new gain, 1.15 format
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PEUpdateVolume (EAS_DATA_HANDLE pEASData, EAS_PCM_HANDLE pState, EAS_I16 gain);
+
 #endif /* end _EAS_PCM_H */
 
@@ -0,0 +1,334 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_pcmcache.c
+ *
+ * Contents and purpose:
+ * Cache of rendered audio for files that are played over and over. The
+ * render loop in eas_public.c decides when a stream is recorded or played
+ * from the cache; this module only manages the entries and their memory.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+/* allocations of this module are reported as PCM cache memory */
+#define EAS_MEM_CATEGORY    EAS_MEM_PCM_CACHE
+
+/*------------------------------------
+ * includes
+ *------------------------------------
+*/
+
+#include "eas_pcmcache.h"
+#include "eas_host.h"
+#include "eas_report.h"
+
+/* FNV-1a constants */
+#define FNV_OFFSET_BASIS                0x811c9dc5
+#define FNV_PRIME                       0x01000193
+
+/* bytes read from the file at a time while hashing */
+#define PCM_CACHE_HASH_BLOCK            256
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheHashFile()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Fills in the file identity of a cache key. Files larger than
+ * PCM_CACHE_MAX_FILE_SIZE get a zero file size and are not cached.
+ *
+ * Inputs:
+ * hwInstData       - host instance data
+ * fileHandle       - file to identify, rewound to the start afterwards
+ * pKey             - receives the hash and size of the file
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PCMCacheHashFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, S_PCM_CACHE_KEY *pKey)
+{
+    EAS_U8 buffer[PCM_CACHE_HASH_BLOCK];
+    const EAS_U8 *pData;
+    EAS_RESULT result;
+    EAS_I32 length;
+    EAS_I32 count;
+    EAS_I32 i;
+    EAS_U32 hash;
+
+    EAS_HWMemSet(pKey, 0, sizeof(S_PCM_CACHE_KEY));
+    hash = FNV_OFFSET_BASIS;
+
+    /* memory files are hashed in place */
+    if ((result = EAS_HWFileData(hwInstData, fileHandle, (const void**) &pData, &length)) != EAS_SUCCESS)
+        return result;
+    if (pData != NULL)
+    {
+        if (length > PCM_CACHE_MAX_FILE_SIZE)
+            return EAS_SUCCESS;
+        for (i = 0; i < length; i++)
+            hash = (hash ^ pData[i]) * FNV_PRIME;
+    }
+
+    /* read anything else, giving up on files that are too large */
+    else
+    {
+        if ((result = EAS_HWFileSeek(hwInstData, fileHandle, 0)) != EAS_SUCCESS)
+            return result;
+        for (length = 0; length <= PCM_CACHE_MAX_FILE_SIZE; length += count)
+        {
+            count = 0;
+            result = EAS_HWReadFile(hwInstData, fileHandle, buffer, PCM_CACHE_HASH_BLOCK, &count);
+            if ((result != EAS_SUCCESS) && (result != EAS_EOF))
+                return result;
+            for (i = 0; i < count; i++)
+                hash = (hash ^ buffer[i]) * FNV_PRIME;
+            if ((result == EAS_EOF) || (count < PCM_CACHE_HASH_BLOCK))
+            {
+                length += count;
+                break;
+            }
+        }
+        if ((result = EAS_HWFileSeek(hwInstData, fileHandle, 0)) != EAS_SUCCESS)
+            return result;
+        if (length > PCM_CACHE_MAX_FILE_SIZE)
+            return EAS_SUCCESS;
+    }
+
+    pKey->hash = hash;
+    pKey->fileSize = length;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheFind()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Looks up a complete entry and moves it to the front of the cache
+ *
+ * Inputs:
+ * pCache           - cache
+ * pKey             - key of the stream
+ * frameSize        - samples per channel in a frame
+ *
+ * Outputs:
+ * the entry, or NULL if the file is not cached with these settings
+ *
+ *----------------------------------------------------------------------------
+*/
+S_PCM_CACHE_ENTRY *EAS_PCMCacheFind (S_PCM_CACHE *pCache, const S_PCM_CACHE_KEY *pKey, EAS_I32 frameSize)
+{
+    S_PCM_CACHE_ENTRY **ppEntry;
+    S_PCM_CACHE_ENTRY *pEntry;
+
+    for (ppEntry = &pCache->pEntries; *ppEntry != NULL; ppEntry = &(*ppEntry)->pNext)
+    {
+        pEntry = *ppEntry;
+        if (!pEntry->complete || (pEntry->frameSize != frameSize))
+            continue;
+        if ((pEntry->key.hash != pKey->hash) ||
+            (pEntry->key.fileSize != pKey->fileSize) ||
+            (pEntry->key.frameLength != pKey->frameLength) ||
+            (pEntry->key.gain != pKey->gain) ||
+            (pEntry->key.transposition != pKey->transposition))
+            continue;
+
+        /* most recently used first */
+        *ppEntry = pEntry->pNext;
+        pEntry->pNext = pCache->pEntries;
+        pCache->pEntries = pEntry;
+        return pEntry;
+    }
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheNewEntry()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds an empty entry to record a stream into
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pCache           - cache
+ * pKey             - key of the stream
+ * frameSize        - samples per channel in a frame
+ *
+ * Outputs:
+ * the entry, or NULL if there is no memory
+ *
+ *----------------------------------------------------------------------------
+*/
+S_PCM_CACHE_ENTRY *EAS_PCMCacheNewEntry (EAS_HW_DATA_HANDLE hwInstData, S_PCM_CACHE *pCache, const S_PCM_CACHE_KEY *pKey, EAS_I32 frameSize)
+{
+    S_PCM_CACHE_ENTRY *pEntry;
+
+    if ((pEntry = EAS_HWMalloc(hwInstData, sizeof(S_PCM_CACHE_ENTRY))) == NULL)
+        return NULL;
+    EAS_HWMemSet(pEntry, 0, sizeof(S_PCM_CACHE_ENTRY));
+    pEntry->key = *pKey;
+    pEntry->frameSize = frameSize;
+    pEntry->pNext = pCache->pEntries;
+    pCache->pEntries = pEntry;
+    return pEntry;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheAddFrame()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Appends a frame to an entry being recorded. Unused entries are evicted,
+ * least recently used first, to keep the cache within its size.
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pCache           - cache
+ * pEntry           - entry being recorded
+ * pFrame           - mix buffer of the frame
+ * time             - stream time after the frame
+ * state            - parser state after the frame
+ *
+ * Outputs:
+ * EAS_ERROR_MALLOC_FAILED if the frame does not fit in the cache
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PCMCacheAddFrame (EAS_HW_DATA_HANDLE hwInstData, S_PCM_CACHE *pCache, S_PCM_CACHE_ENTRY *pEntry, const EAS_I32 *pFrame, EAS_U32 time, EAS_I32 state)
+{
+    EAS_I32 frameBytes;
+
+    frameBytes = pEntry->frameSize * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_I32);
+
+    /* grow the entry a block of frames at a time */
+    if (pEntry->numFrames == pEntry->maxFrames)
+    {
+        EAS_I32 *pFrames;
+        S_PCM_CACHE_MARK *pMarks;
+        EAS_I32 maxFrames;
+        EAS_I32 size;
+
+        /* grow by half to keep the copies short, by a block when the cache is nearly full */
+        maxFrames = pEntry->maxFrames + (pEntry->maxFrames >> 1) + PCM_CACHE_BLOCK_FRAMES;
+        size = maxFrames * (frameBytes + (EAS_I32) sizeof(S_PCM_CACHE_MARK));
+        if (size - pEntry->size > pCache->maxSize - pCache->size)
+        {
+            maxFrames = pEntry->maxFrames + PCM_CACHE_BLOCK_FRAMES;
+            size = maxFrames * (frameBytes + (EAS_I32) sizeof(S_PCM_CACHE_MARK));
+            if (size - pEntry->size > pCache->maxSize)
+                return EAS_ERROR_MALLOC_FAILED;
+            EAS_PCMCacheTrim(hwInstData, pCache, pCache->maxSize - (size - pEntry->size));
+            if (size - pEntry->size > pCache->maxSize - pCache->size)
+                return EAS_ERROR_MALLOC_FAILED;
+        }
+
+        if ((pFrames = EAS_HWMalloc(hwInstData, maxFrames * frameBytes)) == NULL)
+            return EAS_ERROR_MALLOC_FAILED;
+        if ((pMarks = EAS_HWMalloc(hwInstData, maxFrames * (EAS_I32) sizeof(S_PCM_CACHE_MARK))) == NULL)
+        {
+            EAS_HWFree(hwInstData, pFrames);
+            return EAS_ERROR_MALLOC_FAILED;
+        }
+        if (pEntry->numFrames > 0)
+        {
+            EAS_HWMemCpy(pFrames, pEntry->pFrames, pEntry->numFrames * frameBytes);
+            EAS_HWMemCpy(pMarks, pEntry->pMarks, pEntry->numFrames * (EAS_I32) sizeof(S_PCM_CACHE_MARK));
+            EAS_HWFree(hwInstData, pEntry->pFrames);
+            EAS_HWFree(hwInstData, pEntry->pMarks);
+        }
+        pEntry->pFrames = pFrames;
+        pEntry->pMarks = pMarks;
+        pEntry->maxFrames = maxFrames;
+        pCache->size += size - pEntry->size;
+        pEntry->size = size;
+    }
+
+    EAS_HWMemCpy(&pEntry->pFrames[pEntry->numFrames * pEntry->frameSize * NUM_OUTPUT_CHANNELS], pFrame, frameBytes);
+    pEntry->pMarks[pEntry->numFrames].time = time;
+    pEntry->pMarks[pEntry->numFrames].state = state;
+    pEntry->numFrames++;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheRemove()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees an entry, e.g. one whose recording was abandoned
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pCache           - cache
+ * pEntry           - entry to free
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_PCMCacheRemove (EAS_HW_DATA_HANDLE hwInstData, S_PCM_CACHE *pCache, S_PCM_CACHE_ENTRY *pEntry)
+{
+    S_PCM_CACHE_ENTRY **ppEntry;
+
+    for (ppEntry = &pCache->pEntries; *ppEntry != NULL; ppEntry = &(*ppEntry)->pNext)
+    {
+        if (*ppEntry == pEntry)
+        {
+            *ppEntry = pEntry->pNext;
+            break;
+        }
+    }
+
+    pCache->size -= pEntry->size;
+    if (pEntry->pFrames != NULL)
+        EAS_HWFree(hwInstData, pEntry->pFrames);
+    if (pEntry->pMarks != NULL)
+        EAS_HWFree(hwInstData, pEntry->pMarks);
+    EAS_HWFree(hwInstData, pEntry);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheTrim()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Evicts complete entries no stream is playing, least recently used first,
+ * until the cache uses no more than size bytes
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pCache           - cache
+ * size             - bytes to trim to, 0 frees every unused entry
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_PCMCacheTrim (EAS_HW_DATA_HANDLE hwInstData, S_PCM_CACHE *pCache, EAS_I32 size)
+{
+    S_PCM_CACHE_ENTRY *pEntry;
+    S_PCM_CACHE_ENTRY *pVictim;
+
+    while (pCache->size > size)
+    {
+        /* the last unused entry in the list is the least recently used */
+        pVictim = NULL;
+        for (pEntry = pCache->pEntries; pEntry != NULL; pEntry = pEntry->pNext)
+            if (pEntry->complete && (pEntry->users == 0))
+                pVictim = pEntry;
+        if (pVictim == NULL)
+            break;
+        EAS_PCMCacheRemove(hwInstData, pCache, pVictim);
+    }
+}
@@ -0,0 +1,215 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_pcmcache.h
+ *
+ * Contents and purpose:
+ * Cache of rendered audio for files that are played over and over, such
+ * as ringtones and notification sounds.
+ *
+ * The cache holds the synthesizer mix buffer of each frame, before the
+ * master volume and the post-processing effects are applied, so a cached
+ * play sounds exactly like the synthesizer whatever the master volume and
+ * effect settings are when it is played.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_PCMCACHE_H
+#define _EAS_PCMCACHE_H
+
+#include "eas_types.h"
+#include "eas_audioconst.h"
+#include "eas.h"
+
+/* larger files are not cached, see EAS_PCM_CACHE_MAX_FILE_SIZE */
+#define PCM_CACHE_MAX_FILE_SIZE         EAS_PCM_CACHE_MAX_FILE_SIZE
+
+/* an entry grows by at least this many frames at a time while it is recorded */
+#define PCM_CACHE_BLOCK_FRAMES          64
+
+/* S_EAS_STREAM cacheState */
+#define PCM_CACHE_OFF                   0       /* stream does not use the cache */
+#define PCM_CACHE_IDLE                  1       /* not rendered yet, may use the cache */
+#define PCM_CACHE_RECORD                2       /* synthesizer output is being recorded */
+#define PCM_CACHE_PLAY                  3       /* stream plays from the cache */
+
+/*----------------------------------------------------------------------------
+ * S_PCM_CACHE_KEY
+ *
+ * Everything that changes the synthesizer output of a file. Settings that
+ * apply to the whole instance flush the cache instead.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_pcm_cache_key_tag
+{
+    EAS_U32                         hash;           /* FNV-1a hash of the file */
+    EAS_I32                         fileSize;       /* size of the file, 0 if it can't be cached */
+    EAS_U32                         frameLength;    /* stream time per frame */
+    EAS_I32                         gain;           /* stream gain */
+    EAS_I32                         transposition;  /* stream transposition */
+    EAS_U32                         startFlags;     /* stream flags at the first frame */
+} S_PCM_CACHE_KEY;
+
+/* stream time and parser state after a cached frame */
+typedef struct s_pcm_cache_mark_tag
+{
+    EAS_U32                         time;
+    EAS_I32                         state;
+} S_PCM_CACHE_MARK;
+
+/*----------------------------------------------------------------------------
+ * S_PCM_CACHE_ENTRY
+ *
+ * The frames rendered for one file, from the start until the parser
+ * reported EAS_STATE_STOPPED.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_pcm_cache_entry_tag
+{
+    struct s_pcm_cache_entry_tag    *pNext;         /* next entry, most recently used first */
+    S_PCM_CACHE_KEY                 key;
+    EAS_I32                         frameSize;      /* samples per channel in a frame */
+    EAS_I32                         numFrames;
+    EAS_I32                         maxFrames;      /* frames allocated */
+    EAS_I32                         *pFrames;       /* mix buffer of each frame */
+    S_PCM_CACHE_MARK                *pMarks;        /* stream state after each frame */
+    EAS_I32                         size;           /* bytes allocated for the frames */
+    EAS_I32                         users;          /* streams playing the entry */
+    EAS_BOOL8                       complete;       /* recorded to the end */
+} S_PCM_CACHE_ENTRY;
+
+typedef struct s_pcm_cache_tag
+{
+    S_PCM_CACHE_ENTRY               *pEntries;
+    EAS_I32                         maxSize;        /* bytes, 0 if the cache is disabled */
+    EAS_I32                         size;           /* bytes used by all entries */
+} S_PCM_CACHE;
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheHashFile()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Fills in the file identity of a cache key. Files larger than
+ * PCM_CACHE_MAX_FILE_SIZE get a zero file size and are not cached.
+ *
+ * Inputs:
+ * hwInstData       - host instance data
+ * fileHandle       - file to identify, rewound to the start afterwards
+ * pKey             - receives the hash and size of the file
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PCMCacheHashFile (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, S_PCM_CACHE_KEY *pKey);
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheFind()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Looks up a complete entry and moves it to the front of the cache
+ *
+ * Inputs:
+ * pCache           - cache
+ * pKey             - key of the stream
+ * frameSize        - samples per channel in a frame
+ *
+ * Outputs:
+ * the entry, or NULL if the file is not cached with these settings
+ *
+ *----------------------------------------------------------------------------
+*/
+S_PCM_CACHE_ENTRY *EAS_PCMCacheFind (S_PCM_CACHE *pCache, const S_PCM_CACHE_KEY *pKey, EAS_I32 frameSize);
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheNewEntry()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds an empty entry to record a stream into
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pCache           - cache
+ * pKey             - key of the stream
+ * frameSize        - samples per channel in a frame
+ *
+ * Outputs:
+ * the entry, or NULL if there is no memory
+ *
+ *----------------------------------------------------------------------------
+*/
+S_PCM_CACHE_ENTRY *EAS_PCMCacheNewEntry (EAS_HW_DATA_HANDLE hwInstData, S_PCM_CACHE *pCache, const S_PCM_CACHE_KEY *pKey, EAS_I32 frameSize);
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheAddFrame()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Appends a frame to an entry being recorded. Unused entries are evicted,
+ * least recently used first, to keep the cache within its size.
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pCache           - cache
+ * pEntry           - entry being recorded
+ * pFrame           - mix buffer of the frame
+ * time             - stream time after the frame
+ * state            - parser state after the frame
+ *
+ * Outputs:
+ * EAS_ERROR_MALLOC_FAILED if the frame does not fit in the cache
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_PCMCacheAddFrame (EAS_HW_DATA_HANDLE hwInstData, S_PCM_CACHE *pCache, S_PCM_CACHE_ENTRY *pEntry, const EAS_I32 *pFrame, EAS_U32 time, EAS_I32 state);
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheRemove()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees an entry, e.g. one whose recording was abandoned
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pCache           - cache
+ * pEntry           - entry to free
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_PCMCacheRemove (EAS_HW_DATA_HANDLE hwInstData, S_PCM_CACHE *pCache, S_PCM_CACHE_ENTRY *pEntry);
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMCacheTrim()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Evicts complete entries no stream is playing, least recently used first,
+ * until the cache uses no more than size bytes
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pCache           - cache
+ * size             - bytes to trim to, 0 frees every unused entry
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_PCMCacheTrim (EAS_HW_DATA_HANDLE hwInstData, S_PCM_CACHE *pCache, EAS_I32 size);
+
+#endif /* end _EAS_PCMCACHE_H */
@@ -29,7 +29,9 @@
 
 #include "eas_data.h"
 
-/* static data allocation */
+/* static data allocation, each stream carries its decode buffers */
+#ifdef _STATIC_MEMORY
 S_PCM_STATE eas_PCMData[MAX_PCM_STREAMS];
+#endif
 
 
@@ -31,17 +31,38 @@
 #ifndef _EAS_PCMDATA_H
 #define _EAS_PCMDATA_H
 
+#include "eas_imaadpcm.h"
+
 /* sets the maximum number of simultaneous PCM streams */
 #ifndef MAX_PCM_STREAMS
 #define MAX_PCM_STREAMS             16
 #define PCM_STREAM_THRESHOLD        (MAX_PCM_STREAMS - 4)
 #endif
 
-/* coefficents for high-pass filter in ADPCM */
-#define INTEGRATOR_COEFFICIENT      100     /* coefficient for leaky integrator */
+/* decoded samples held for each stream, must be a power of 2 */
+#ifndef PCM_RING_SIZE
+#define PCM_RING_SIZE               1024
+#endif
+#define PCM_RING_MASK               (PCM_RING_SIZE - 1)
+
+/* largest block read from the file in one call, limits the ADPCM block size */
+#ifndef PCM_FILE_BUFFER_SIZE
+#define PCM_FILE_BUFFER_SIZE        2048
+#endif
+
+/* most samples a decoder writes to the ring without a pause */
+#define PCM_DECODE_GRANULE          16
+
+/* fractional bits of the sample rate converter phase */
+#define PCM_PHASE_SHIFT             15
+#define PCM_PHASE_ONE               (1L << PCM_PHASE_SHIFT)
+#define PCM_PHASE_MASK              (PCM_PHASE_ONE - 1)
+
+/* highest file sample rate supported */
+#define PCM_MAX_SAMPLE_RATE         96000
 
 /* additional flags in S_PCM_STATE.flags used internal to module */
-#define PCM_FLAGS_EMPTY             0x01000000  /* unsigned format */
+#define PCM_FLAGS_EMPTY             0x01000000  /* all of the audio has been read from the file */
 
 /*----------------------------------------------------------------------------
  * S_PCM_STATE
@@ -49,93 +70,53 @@
  * Retains state information for PCM streams.
  *----------------------------------------------------------------------------
 */
-typedef struct s_decoder_state_tag
-{
-    EAS_I32             output;             /* last output for DC offset filter */
-    EAS_I32             acc;                /* accumulator for DC offset filter */
-    EAS_I32             step;               /* current ADPCM step size */
-    EAS_PCM             x1;                 /* current generated sample */
-    EAS_PCM             x0;                 /* previous generated sample */
-} S_DECODER_STATE;
-
-typedef enum
-{
-    PCM_ENV_START = 0,
-    PCM_ENV_ATTACK,
-    PCM_ENV_DECAY,
-    PCM_ENV_SUSTAIN,
-    PCM_ENV_RELEASE,
-    PCM_ENV_END
-} E_PCM_ENV_STATE;
-
 typedef struct s_pcm_state_tag
 {
 #ifdef _CHECKED_BUILD
     EAS_U32             handleCheck;        /* signature check for checked build */
 #endif
     EAS_FILE_HANDLE     fileHandle;         /* pointer to input file */
-    EAS_PCM_CALLBACK    pCallback;          /* pointer to callback function */
-    EAS_VOID_PTR        cbInstData;         /* instance data for callback function */
     struct s_decoder_interface_tag EAS_CONST * pDecoder;    /* pointer to decoder interface */
-    EAS_STATE           state;              /* stream state */
-    EAS_I32             time;               /* media time */
+    EAS_STATE           state;              /* stream state, EAS_STATE_EMPTY if the slot is free */
     EAS_I32             startPos;           /* start of PCM stream */
-    EAS_I32             loopLocation;       /* file location where loop starts */
-    EAS_I32             byteCount;          /* size of file */
-    EAS_U32             loopStart;          /* loop start, offset in samples from startPos */
-                                            /* NOTE: For CMF, we use this to store total sample size */
-    EAS_U32             loopSamples;        /* total loop length, in samples, 0 means no loop */
-                                            /* NOTE: For CMF, non-zero means looped */
-    EAS_U32             samplesInLoop;      /* samples left in the loop to play back */
-    EAS_I32             samplesTilLoop;     /* samples left to play until top of loop */
+    EAS_I32             byteCount;          /* size of PCM stream */
     EAS_I32             bytesLeft;          /* count of bytes left in stream */
-    EAS_I32             bytesLeftLoop;      /* count of bytes left in stream, value at start of loop */
-    EAS_U32             phase;              /* current phase for interpolator */
-    EAS_U32             basefreq;           /* frequency multiplier */
+    EAS_I32             blockSize;          /* bytes read from the file at a time */
+    EAS_I32             samplesPerBlock;    /* frames decoded from one full block */
+    EAS_I32             blockBytes;         /* bytes of the current block in fileBuffer */
+    EAS_I32             blockPos;           /* next byte of the current block to decode */
+    EAS_I32             skipFrames;         /* decoded frames to drop after a locate */
+    EAS_U32             readPos;            /* ring index of the next sample to play */
+    EAS_U32             writePos;           /* ring index of the next sample to decode */
+    EAS_U32             phase;              /* interpolator position between readPos and the next frame */
+    EAS_U32             phaseInc;           /* frames advanced per output sample */
+    EAS_U32             sampleRate;         /* input sample rate */
     EAS_U32             flags;              /* stream flags */
-    EAS_U32             envData;            /* envelope data (and LFO data) */
-    EAS_U32             envValue;           /* current envelope value */
-    EAS_U32             envScale;           /* current envelope scale */
-    EAS_U32             startOrder;         /* start order index, first is 0, next is 1, etc. */
     S_DECODER_STATE     decoderL;           /* left (mono) ADPCM state */
     S_DECODER_STATE     decoderR;           /* right ADPCM state */
-    S_DECODER_STATE     decoderLLoop;       /* left (mono) ADPCM state, value at start of loop */
-    S_DECODER_STATE     decoderRLoop;       /* right ADPCM state, value at start of loop */
-    E_PCM_ENV_STATE     envState;           /* current envelope state */
-    EAS_I16             volume;             /* volume for stream */
-    EAS_I16             pitch;              /* relative pitch in cents - zero is unity playback */
-    EAS_I16             gainLeft;           /* requested gain */
-    EAS_I16             gainRight;          /* requested gain */
-    EAS_I16             currentGainLeft;    /* current gain for anti-zipper filter */
-    EAS_I16             currentGainRight;   /* current gain for anti-zipper filter */
-    EAS_U16             blockSize;          /* block size for ADPCM decoder */
-    EAS_U16             blockCount;         /* block counter for ADPCM decoder */
-    EAS_U16             sampleRate;         /* input sample rate */
-    EAS_U8              srcByte;            /* source byte */
-    EAS_U8              msBitCount;         /* count keeps track of MS bits */
-    EAS_U8              msBitMask;          /* mask keeps track of MS bits */
-    EAS_U8              msBitValue;         /* value keeps track of MS bits */
-    EAS_U8              msBitCountLoop;     /* count keeps track of MS bits, value at loop start */
-    EAS_U8              msBitMaskLoop;      /* mask keeps track of MS bits, value at loop start */
-    EAS_U8              msBitValueLoop;     /* value keeps track of MS bits, value at loop start */
-    EAS_BOOL8           hiNibble;           /* indicates high/low nibble is next */
-    EAS_BOOL8           hiNibbleLoop;       /* indicates high/low nibble is next, value loop start */
-    EAS_U8              rateShift;          /* for playback rate greater than 1.0 */
+    EAS_I16             gain;               /* requested gain */
+    EAS_I16             currentGain;        /* current gain for anti-zipper filter */
+    EAS_PCM             ring[PCM_RING_SIZE];                /* decoded samples, interleaved if stereo */
+    EAS_U8              fileBuffer[PCM_FILE_BUFFER_SIZE];   /* current block from the file */
 } S_PCM_STATE;
 
 /*----------------------------------------------------------------------------
  * S_DECODER_INTERFACE
  *
- * Generic interface for audio decoders
+ * Generic interface for audio decoders. pfInit sets the block size of the
+ * stream, pfDecode decodes the block in fileBuffer into the ring until the
+ * block is used up or fewer than PCM_DECODE_GRANULE samples are free.
  *----------------------------------------------------------------------------
 */
 typedef struct s_decoder_interface_tag
 {
     EAS_RESULT (* EAS_CONST pfInit)(EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState);
-    EAS_RESULT (* EAS_CONST pfDecodeSample)(EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState);
-    EAS_RESULT (* EAS_CONST pfLocate)(EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState, EAS_I32 time);
+    EAS_RESULT (* EAS_CONST pfDecode)(EAS_DATA_HANDLE pEASData, S_PCM_STATE *pState);
 } S_DECODER_INTERFACE;
 
+#ifdef _IMA_DECODER
+extern const S_DECODER_INTERFACE IMADecoder;
+#endif
 
 /* header chunk for SMAF ADPCM */
 #define TAG_YAMAHA_ADPCM    0x4d776100
@@ -0,0 +1,367 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_perf.c
+ *
+ * Contents and purpose:
+ * Performance metrics module. Times each stage of every rendered frame
+ * with the host microsecond clock and keeps per-frame histograms that
+ * can be read back with EAS_GetMetrics.
+ *
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+/*------------------------------------
+ * includes
+ *------------------------------------
+*/
+
+#include "eas_data.h"
+#include "eas_perf.h"
+#include "eas_config.h"
+#include "eas_host.h"
+#include "eas_report.h"
+
+/* prototypes for metrics interface */
+static EAS_RESULT PerfInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData);
+static EAS_RESULT PerfShutdown (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
+static void PerfStartTimer (EAS_VOID_PTR pInstData, EAS_INT timer);
+static PERF_TIMER PerfStopTimer (EAS_VOID_PTR pInstData, EAS_INT timer);
+static void PerfIncrementCounter (EAS_VOID_PTR pInstData, EAS_INT counter, EAS_U32 value);
+static EAS_BOOL PerfRecordMaxValue (EAS_VOID_PTR pInstData, EAS_INT counter, EAS_U32 value);
+static void PerfRecordValue (EAS_VOID_PTR pInstData, EAS_INT counter, EAS_I32 value);
+static EAS_RESULT PerfReport (EAS_VOID_PTR pInstData);
+static EAS_RESULT PerfReset (EAS_VOID_PTR pInstData);
+static EAS_RESULT PerfGetMetrics (EAS_VOID_PTR pInstData, S_EAS_METRICS *pMetrics);
+
+/* metrics interface for configuration module */
+const S_METRICS_INTERFACE EAS_Metrics =
+{
+    PerfInit,
+    PerfShutdown,
+    PerfStartTimer,
+    PerfStopTimer,
+    PerfIncrementCounter,
+    PerfRecordMaxValue,
+    PerfRecordValue,
+    PerfReport,
+    PerfReset,
+    PerfGetMetrics
+};
+
+#ifdef _STATIC_MEMORY
+S_METRICS_DATA eas_MetricsData;
+#endif
+
+/*----------------------------------------------------------------------------
+ * PerfHistogramIndex()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Maps a timer or counter to its histogram, -1 if it doesn't have one
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_INT PerfHistogramIndex (EAS_INT counter)
+{
+    switch (counter)
+    {
+        case EAS_PM_TOTAL_TIME:
+            return EAS_METRIC_FRAME_TIME;
+        case EAS_PM_PARSE_TIME:
+            return EAS_METRIC_PARSE_TIME;
+        case EAS_PM_RENDER_TIME:
+            return EAS_METRIC_RENDER_TIME;
+        case EAS_PM_REVERB_TIME:
+            return EAS_METRIC_REVERB_TIME;
+        case EAS_PM_POST_TIME:
+            return EAS_METRIC_POST_TIME;
+        case EAS_PM_FRAME_VOICES:
+            return EAS_METRIC_VOICES;
+        case EAS_PM_FRAME_STOLEN_VOICES:
+            return EAS_METRIC_STOLEN_VOICES;
+        case EAS_PM_FRAME_WORKLOAD:
+            return EAS_METRIC_WORKLOAD;
+        default:
+            return -1;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * PerfRecordHistogram()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds a value to a histogram
+ *
+ *----------------------------------------------------------------------------
+*/
+static void PerfRecordHistogram (S_EAS_HISTOGRAM *pHistogram, EAS_U32 value)
+{
+    EAS_INT bin;
+    EAS_U32 temp;
+
+    /* find the log2 bin */
+    bin = 0;
+    for (temp = value; (temp != 0) && (bin < EAS_METRICS_HISTOGRAM_BINS - 1); temp >>= 1)
+        bin++;
+
+    pHistogram->bins[bin]++;
+    pHistogram->count++;
+    pHistogram->total += value;
+    if (value > pHistogram->max)
+        pHistogram->max = value;
+}
+
+/*----------------------------------------------------------------------------
+ * PerfInit()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Allocates and initializes the metrics data
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT PerfInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
+{
+    S_METRICS_DATA *pData;
+
+    /* check Configuration Module for data allocation */
+    if (pEASData->staticMemoryModel)
+        pData = EAS_CMEnumOptData(EAS_MODULE_METRICS);
+
+    /* allocate dynamic memory */
+    else
+        pData = EAS_HWMalloc(pEASData->hwInstData, sizeof(S_METRICS_DATA));
+
+    if (pData == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_FATAL, "Failed to allocate metrics memory\n"); */ }
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+
+    EAS_HWMemSet(pData, 0, sizeof(S_METRICS_DATA));
+    pData->hwInstData = pEASData->hwInstData;
+    *pInstData = pData;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * PerfShutdown()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees the metrics data
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT PerfShutdown (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData)
+{
+    /* check Configuration Module for static memory allocation */
+    if (!pEASData->staticMemoryModel)
+        EAS_HWFree(pEASData->hwInstData, pInstData);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * PerfStartTimer()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Starts a timer. The total timer marks the start of a frame, the other
+ * timers are ignored outside of a frame so that EAS_RenderFile and
+ * friends aren't counted.
+ *
+ *----------------------------------------------------------------------------
+*/
+static void PerfStartTimer (EAS_VOID_PTR pInstData, EAS_INT timer)
+{
+    S_METRICS_DATA *pData = (S_METRICS_DATA*) pInstData;
+
+    if ((timer < 0) || (timer >= EAS_PM_NUM_TIMERS))
+        return;
+    if (timer == EAS_PM_TOTAL_TIME)
+        pData->inFrame = EAS_TRUE;
+    else if (!pData->inFrame)
+        return;
+    pData->startTime[timer] = EAS_HWGetTime(pData->hwInstData);
+}
+
+/*----------------------------------------------------------------------------
+ * PerfStopTimer()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Stops a timer, records the elapsed time and returns it
+ *
+ *----------------------------------------------------------------------------
+*/
+static PERF_TIMER PerfStopTimer (EAS_VOID_PTR pInstData, EAS_INT timer)
+{
+    S_METRICS_DATA *pData = (S_METRICS_DATA*) pInstData;
+    PERF_TIMER elapsed;
+    EAS_INT index;
+
+    if ((timer < 0) || (timer >= EAS_PM_NUM_TIMERS) || !pData->inFrame)
+        return 0;
+
+    elapsed = (EAS_HWGetTime(pData->hwInstData) - pData->startTime[timer]) & 0xffffffffUL;
+    if ((index = PerfHistogramIndex(timer)) >= 0)
+        PerfRecordHistogram(&pData->metrics.histograms[index], elapsed);
+
+    /* end of frame */
+    if (timer == EAS_PM_TOTAL_TIME)
+        pData->inFrame = EAS_FALSE;
+    return elapsed;
+}
+
+/*----------------------------------------------------------------------------
+ * PerfIncrementCounter()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds to a counter
+ *
+ *----------------------------------------------------------------------------
+*/
+static void PerfIncrementCounter (EAS_VOID_PTR pInstData, EAS_INT counter, EAS_U32 value)
+{
+    S_METRICS_DATA *pData = (S_METRICS_DATA*) pInstData;
+
+    switch (counter)
+    {
+        case EAS_PM_FRAME_COUNT:
+            pData->metrics.numFrames += value;
+            break;
+        case EAS_PM_TOTAL_VOICE_COUNT:
+            pData->totalVoices += value;
+            break;
+        default:
+            break;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * PerfRecordMaxValue()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns EAS_TRUE if the value is a new maximum for the counter
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL PerfRecordMaxValue (EAS_VOID_PTR pInstData, EAS_INT counter, EAS_U32 value)
+{
+    S_METRICS_DATA *pData = (S_METRICS_DATA*) pInstData;
+
+    switch (counter)
+    {
+        /* the histograms already track these, compare against the last value recorded */
+        case EAS_PM_MAX_CYCLES:
+            return (value >= pData->metrics.histograms[EAS_METRIC_FRAME_TIME].max);
+        case EAS_PM_MAX_VOICES:
+            return (value >= pData->metrics.histograms[EAS_METRIC_VOICES].max);
+        default:
+            return EAS_FALSE;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * PerfRecordValue()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Records a per-frame value
+ *
+ *----------------------------------------------------------------------------
+*/
+static void PerfRecordValue (EAS_VOID_PTR pInstData, EAS_INT counter, EAS_I32 value)
+{
+    S_METRICS_DATA *pData = (S_METRICS_DATA*) pInstData;
+    EAS_INT index;
+
+    if (value < 0)
+        value = 0;
+
+    switch (counter)
+    {
+        case EAS_PM_MAX_CYCLES_VOICES:
+            pData->metrics.maxFrameVoices = (EAS_U32) value;
+            break;
+        case EAS_PM_MAX_CYCLES_TIME:
+            pData->metrics.maxFrameRenderTime = (EAS_U32) value;
+            break;
+        default:
+            if ((index = PerfHistogramIndex(counter)) >= 0)
+                PerfRecordHistogram(&pData->metrics.histograms[index], (EAS_U32) value);
+            break;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * PerfReport()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Displays the metrics through the report interface
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT PerfReport (EAS_VOID_PTR pInstData)
+{
+    S_METRICS_DATA *pData = (S_METRICS_DATA*) pInstData;
+    EAS_INT i;
+
+    /* referenced only by the reports, which may be compiled out */
+    (void) pData;
+
+    { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "Frames: %lu, average voices: %lu\n", pData->metrics.numFrames,
+        pData->metrics.numFrames ? pData->totalVoices / pData->metrics.numFrames : 0); */ }
+    { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "Slowest frame at %lu msec with %lu voices\n",
+        pData->metrics.maxFrameRenderTime, pData->metrics.maxFrameVoices); */ }
+    for (i = 0; i < EAS_NUM_METRICS; i++)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "Metric %d: count %lu, total %lu, max %lu\n", i,
+            pData->metrics.histograms[i].count, pData->metrics.histograms[i].total, pData->metrics.histograms[i].max); */ }
+    }
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * PerfReset()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Clears the metrics
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT PerfReset (EAS_VOID_PTR pInstData)
+{
+    S_METRICS_DATA *pData = (S_METRICS_DATA*) pInstData;
+
+    pData->totalVoices = 0;
+    EAS_HWMemSet(&pData->metrics, 0, sizeof(pData->metrics));
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * PerfGetMetrics()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Copies the metrics to the caller's structure
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT PerfGetMetrics (EAS_VOID_PTR pInstData, S_EAS_METRICS *pMetrics)
+{
+    S_METRICS_DATA *pData = (S_METRICS_DATA*) pInstData;
+
+    EAS_HWMemCpy(pMetrics, &pData->metrics, sizeof(S_EAS_METRICS));
+    return EAS_SUCCESS;
+}
+
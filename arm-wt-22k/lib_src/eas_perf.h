@@ -0,0 +1,87 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_perf.h
+ *
+ * Contents and purpose:
+ * Interface for the performance metrics module
+ *
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_PERF_H
+#define _EAS_PERF_H
+
+#include "eas_types.h"
+#include "eas.h"
+
+/* timer values are in microseconds */
+typedef EAS_U32 PERF_TIMER;
+
+/* enumerated timers and counters */
+typedef enum
+{
+    /* timers */
+    EAS_PM_TOTAL_TIME = 0,
+    EAS_PM_PARSE_TIME,
+    EAS_PM_RENDER_TIME,
+    EAS_PM_STREAM_TIME,
+    EAS_PM_POST_TIME,
+    EAS_PM_REVERB_TIME,
+    EAS_PM_NUM_TIMERS,
+
+    /* counters and values */
+    EAS_PM_FRAME_COUNT = EAS_PM_NUM_TIMERS,
+    EAS_PM_TOTAL_VOICE_COUNT,
+    EAS_PM_MAX_VOICES,
+    EAS_PM_MAX_CYCLES,
+    EAS_PM_MAX_CYCLES_VOICES,
+    EAS_PM_MAX_CYCLES_TIME,
+    EAS_PM_FRAME_VOICES,
+    EAS_PM_FRAME_STOLEN_VOICES,
+    EAS_PM_FRAME_WORKLOAD,
+    EAS_PM_NUM_COUNTERS
+} E_PERF_COUNTER;
+
+/* metrics module interface */
+typedef struct
+{
+    EAS_RESULT  (*pfInit)(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData);
+    EAS_RESULT  (*pfShutdown)(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
+    void        (*pfStartTimer)(EAS_VOID_PTR pInstData, EAS_INT timer);
+    PERF_TIMER  (*pfStopTimer)(EAS_VOID_PTR pInstData, EAS_INT timer);
+    void        (*pfIncrementCounter)(EAS_VOID_PTR pInstData, EAS_INT counter, EAS_U32 value);
+    EAS_BOOL    (*pfRecordMaxValue)(EAS_VOID_PTR pInstData, EAS_INT counter, EAS_U32 value);
+    void        (*pfRecordValue)(EAS_VOID_PTR pInstData, EAS_INT counter, EAS_I32 value);
+    EAS_RESULT  (*pfReport)(EAS_VOID_PTR pInstData);
+    EAS_RESULT  (*pfReset)(EAS_VOID_PTR pInstData);
+    EAS_RESULT  (*pfGetMetrics)(EAS_VOID_PTR pInstData, S_EAS_METRICS *pMetrics);
+} S_METRICS_INTERFACE;
+
+/* metrics module instance data */
+typedef struct
+{
+    EAS_HW_DATA_HANDLE  hwInstData;
+    EAS_BOOL            inFrame;
+    PERF_TIMER          startTime[EAS_PM_NUM_TIMERS];
+    EAS_U32             totalVoices;
+    S_EAS_METRICS       metrics;
+} S_METRICS_DATA;
+
+#endif /* end _EAS_PERF_H */
+
@@ -27,9 +27,6 @@
  *----------------------------------------------------------------------------
 */
 
-#define LOG_TAG "Sonivox"
-#include "log/log.h"
-
 #include "eas_synthcfg.h"
 #include "eas.h"
 #include "eas_config.h"
@@ -39,10 +36,25 @@
 #include "eas_parser.h"
 #include "eas_pcm.h"
 #include "eas_midi.h"
+#include "eas_miditypes.h"
 #include "eas_mixer.h"
 #include "eas_build.h"
 #include "eas_vm_protos.h"
 #include "eas_math.h"
+#include "eas_trace.h"
+#include "eas_diag.h"
+
+#ifdef FILE_HEADER_SEARCH
+/* lint doesn't like the way some string.h files look */
+#ifdef _lint
+#include "lint_stdlib.h"
+#else
+#include <string.h>
+#endif
+
+/* block size EAS_SearchFile reads the file in */
+#define SEARCH_BUFFER_SIZE  256
+#endif
 
 #ifdef JET_INTERFACE
 #include "jet_data.h"
@@ -52,9 +64,51 @@
 #include "eas_mdls.h"
 #endif
 
+#ifdef _RINGTONE_EVENT_CACHE
+#include "eas_tonecache.h"
+#endif
+
+#ifdef _EXTERNAL_SOUNDBANK
+#include "eas_soundbank.h"
+
+/* built-in sound library, for EAS_WriteSoundLibrary */
+extern S_EAS easSoundLib;
+#endif
+
 /* number of events to parse before calling EAS_HWYield function */
 #define YIELD_EVENT_COUNT       10
 
+/* number of frames passed to the write function by EAS_RenderFile */
+#define OFFLINE_RENDER_FRAMES   32
+
+#ifdef _ENGINE_SNAPSHOT
+/* first word of an EAS_SaveState snapshot */
+#define EAS_STATE_TAG           0x45415353
+
+/* the parser and synth state start on a pointer boundary */
+#define EAS_STATE_ALIGN(n)      (((n) + (EAS_I32) sizeof(void*) - 1) & ~((EAS_I32) sizeof(void*) - 1))
+
+/* an EAS_SaveState snapshot is this header, the parser state and the synth state */
+typedef struct
+{
+    EAS_U32             tag;
+    EAS_I32             size;               /* bytes in the snapshot */
+    EAS_VOID_PTR        handle;             /* parser instance of the stream */
+    EAS_U32             time;               /* stream time in msecs/256 */
+    EAS_I32             repeatCount;
+    EAS_I32             parserSize;         /* bytes of parser state, aligned */
+} S_EAS_STATE_HEADER;
+#endif
+
+#ifdef _INSTANCE_POOL
+/* released instances kept for EAS_AcquireInstance, protected by the global lock */
+#ifndef EAS_INSTANCE_POOL_SIZE
+#define EAS_INSTANCE_POOL_SIZE  4
+#endif
+static S_EAS_DATA *instancePool[EAS_INSTANCE_POOL_SIZE];
+static EAS_INT numPooledInstances = 0;
+#endif
+
 /*----------------------------------------------------------------------------
  * easLibConfig
  *
@@ -85,6 +139,26 @@ static const S_EAS_LIB_CONFIG easLibConfig =
 
 /* local prototypes */
 static EAS_RESULT EAS_ParseEvents (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream, EAS_U32 endTime, EAS_INT parseMode);
+#ifdef _SAMPLE_ACCURATE_EVENTS
+static void EAS_SetEventOffset (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream, EAS_U32 time);
+#endif
+#ifdef _MIDI_INPUT_RING
+static EAS_RESULT EAS_MIDIRingWrite (S_EAS_DATA *pEASData, S_INTERACTIVE_MIDI *pMIDIStream, EAS_U8 *pBuffer, EAS_I32 count, EAS_U32 sampleTime);
+static EAS_RESULT EAS_MIDIRingRead (S_EAS_DATA *pEASData, S_INTERACTIVE_MIDI *pMIDIStream, EAS_U32 endTime);
+#endif
+static EAS_RESULT EAS_FindParser (S_EAS_DATA *pEASData, EAS_FILE_HANDLE fileHandle, S_FILE_PARSER_INTERFACE **ppParserModule, EAS_VOID_PTR *pStreamHandle);
+#ifdef _ASYNC_OPEN
+static void EAS_AsyncOpenThread (EAS_VOID_PTR pArg);
+#endif
+static EAS_RESULT EAS_CloseAllStreams (S_EAS_DATA *pEASData);
+#ifdef _PCM_CACHE
+static EAS_RESULT EAS_StreamCacheLeave (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream, EAS_BOOL catchUp);
+static EAS_RESULT EAS_StreamCacheSetParam (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream, EAS_INT param, EAS_I32 value);
+static EAS_RESULT EAS_StreamCacheFlush (S_EAS_DATA *pEASData);
+#endif
+#ifdef _BLOCK_RENDER
+static EAS_I32 EAS_RenderBlockFrames (S_EAS_DATA *pEASData, EAS_I32 numRequested);
+#endif
 
 /*----------------------------------------------------------------------------
  * EAS_SetStreamParameter
@@ -165,6 +239,14 @@ EAS_RESULT EAS_IntSetStrmParam (S_EAS_DATA *pEASData, EAS_HANDLE pStream, EAS_IN
 {
     S_SYNTH *pSynth;
 
+#ifdef _PCM_CACHE
+    {
+        EAS_RESULT result;
+        if ((result = EAS_StreamCacheSetParam(pEASData, pStream, param, value)) != EAS_SUCCESS)
+            return result;
+    }
+#endif
+
     /* try to set the parameter using stream interface */
     if (EAS_SetStreamParameter(pEASData, pStream, param, value) == EAS_SUCCESS)
         return EAS_SUCCESS;
@@ -245,15 +327,25 @@ static EAS_INT EAS_AllocateStream (EAS_DATA_HANDLE pEASData)
         return 0;
     }
 
-    /* dynamic model */
-    for (streamNum = 0; streamNum < MAX_NUMBER_STREAMS; streamNum++)
+    /* dynamic model, streams being opened in the background are taken */
+    for (streamNum = 0; streamNum < EAS_MAX_STREAMS(pEASData); streamNum++)
+    {
+#ifdef _ASYNC_OPEN
+        if (pEASData->streams[streamNum].pAsyncOpen != NULL)
+            continue;
+#endif
         if (pEASData->streams[streamNum].handle == NULL)
             break;
-    if (streamNum == MAX_NUMBER_STREAMS)
+    }
+    if (streamNum == EAS_MAX_STREAMS(pEASData))
     {
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Exceeded maximum number of open streams\n"); */ }
         return -1;
     }
+#ifdef _DYNAMIC_STREAMS
+    if (streamNum >= pEASData->streamSlots)
+        pEASData->streamSlots = streamNum + 1;
+#endif
     return streamNum;
 }
 
@@ -278,6 +370,10 @@ static void EAS_InitStream (S_EAS_STREAM *pStream, EAS_VOID_PTR pParserModule, E
     pStream->repeatCount = 0;
     pStream->volume = DEFAULT_STREAM_VOLUME;
     pStream->streamFlags = 0;
+#ifdef _PCM_CACHE
+    pStream->pCacheEntry = NULL;
+    pStream->cacheState = PCM_CACHE_OFF;
+#endif
 }
 
 /*----------------------------------------------------------------------------
@@ -298,6 +394,115 @@ EAS_PUBLIC const S_EAS_LIB_CONFIG *EAS_Config (void)
     return &easLibConfig;
 }
 
+/*----------------------------------------------------------------------------
+ * EAS_GetInstanceConfig()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the library configuration with the output sample rate, mix
+ * buffer size and voice count of this instance.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pConfig         - receives the configuration
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetInstanceConfig (EAS_DATA_HANDLE pEASData, S_EAS_LIB_CONFIG *pConfig)
+{
+    if ((pEASData == NULL) || (pConfig == NULL))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    *pConfig = easLibConfig;
+#ifdef _RUNTIME_SAMPLE_RATE
+    pConfig->sampleRate = _OUTPUT_SAMPLE_RATE << pEASData->rateShift;
+#endif
+    pConfig->mixBufferSize = EAS_FRAME_SIZE(pEASData);
+    pConfig->maxVoices = VM_NUM_VOICES(pEASData->pVoiceMgr);
+
+#ifdef _OUTPUT_RESAMPLER
+    /* report the average frame length at the device rate */
+    if (pEASData->pResampler != NULL)
+    {
+        pConfig->sampleRate = pEASData->pResampler->outputRate;
+        pConfig->mixBufferSize = (BUFFER_SIZE_IN_MONO_SAMPLES * pConfig->sampleRate + (_OUTPUT_SAMPLE_RATE >> 1)) / _OUTPUT_SAMPLE_RATE;
+    }
+#endif
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_GetArenaUsage()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the memory allocated from the arena of the instance
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pInUse          - receives the bytes allocated now
+ *  pPeak           - receives the most bytes allocated at any time
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetArenaUsage (EAS_DATA_HANDLE pEASData, EAS_I32 *pInUse, EAS_I32 *pPeak)
+{
+    if ((pEASData == NULL) || (pInUse == NULL) || (pPeak == NULL))
+        return EAS_ERROR_INVALID_PARAMETER;
+    *pInUse = *pPeak = 0;
+#ifdef _MEMORY_ARENA
+    return EAS_HWArenaUsage(pEASData->hwInstData, pInUse, pPeak);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_GetMemoryUsage()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the memory allocated by the instance in each category
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pUsage          - receives the memory usage
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetMemoryUsage (EAS_DATA_HANDLE pEASData, S_EAS_MEMORY_USAGE *pUsage)
+{
+#ifdef _MEMORY_ACCOUNTING
+    EAS_I32 usage[EAS_MEM_NUM_CATEGORIES];
+    EAS_RESULT result;
+#endif
+
+    if ((pEASData == NULL) || (pUsage == NULL))
+        return EAS_ERROR_INVALID_PARAMETER;
+    EAS_HWMemSet(pUsage, 0, sizeof(S_EAS_MEMORY_USAGE));
+#ifdef _MEMORY_ACCOUNTING
+    if ((result = EAS_HWMemoryUsage(pEASData->hwInstData, usage)) != EAS_SUCCESS)
+        return result;
+    pUsage->voiceManager = usage[EAS_MEM_VOICE_MGR];
+    pUsage->mixBuffers = usage[EAS_MEM_MIX_BUFFERS];
+    pUsage->effects = usage[EAS_MEM_EFFECTS];
+    pUsage->dls = usage[EAS_MEM_DLS];
+    pUsage->parsers = usage[EAS_MEM_PARSERS];
+    pUsage->pcmCache = usage[EAS_MEM_PCM_CACHE];
+    pUsage->host = usage[EAS_MEM_HOST];
+    pUsage->other = usage[EAS_MEM_OTHER];
+    pUsage->total = pUsage->voiceManager + pUsage->mixBuffers + pUsage->effects + pUsage->dls +
+        pUsage->parsers + pUsage->pcmCache + pUsage->host + pUsage->other;
+    pUsage->sharedDLS = usage[EAS_MEM_SHARED];
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
 /*----------------------------------------------------------------------------
  * EAS_Init()
  *----------------------------------------------------------------------------
@@ -312,19 +517,89 @@ EAS_PUBLIC const S_EAS_LIB_CONFIG *EAS_Config (void)
  *----------------------------------------------------------------------------
 */
 EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData)
+{
+    return EAS_InitEx(ppEASData, NULL);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_InitEx()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Initialize the synthesizer library with the given instance configuration
+ *
+ * Inputs:
+ *  ppEASData       - pointer to data handle variable for this instance
+ *  pConfig         - instance configuration, NULL for the compiled defaults
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_InitEx (EAS_DATA_HANDLE *ppEASData, const S_EAS_INIT_CONFIG *pConfig)
 {
     EAS_HW_DATA_HANDLE pHWInstData;
     EAS_RESULT result;
     S_EAS_DATA *pEASData;
     EAS_INT module;
     EAS_BOOL staticMemoryModel;
+    EAS_I32 rateShift;
+    EAS_I32 resampleRate;
+
+    /* find the output rate as a power of two multiple of the compiled rate */
+    *ppEASData = NULL;
+    rateShift = 0;
+    resampleRate = 0;
+    if ((pConfig != NULL) && (pConfig->sampleRate != 0))
+    {
+        while ((rateShift <= MAX_RATE_SHIFT) && (pConfig->sampleRate != (_OUTPUT_SAMPLE_RATE << rateShift)))
+            rateShift++;
+        if (rateShift > MAX_RATE_SHIFT)
+        {
+            /* any other rate is resampled from the compiled rate */
+            rateShift = 0;
+#ifdef _OUTPUT_RESAMPLER
+            if ((pConfig->sampleRate >= RESAMPLER_MIN_RATE) && (pConfig->sampleRate <= RESAMPLER_MAX_RATE))
+                resampleRate = pConfig->sampleRate;
+            else
+#endif
+            {
+                { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Output sample rate %ld is not supported\n", pConfig->sampleRate); */ }
+#if defined(_RUNTIME_SAMPLE_RATE) || defined(_OUTPUT_RESAMPLER)
+                return EAS_ERROR_PARAMETER_RANGE;
+#else
+                return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+            }
+        }
+    }
+
+    /* check the size of the stream table */
+    if ((pConfig != NULL) && ((pConfig->maxStreams < 0) || (pConfig->maxStreams > MAX_DYNAMIC_STREAMS)))
+        return EAS_ERROR_PARAMETER_RANGE;
+#ifndef _DYNAMIC_STREAMS
+    if ((pConfig != NULL) && (pConfig->maxStreams > MAX_NUMBER_STREAMS))
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+
+    /* check the size of the voice pool */
+    if ((pConfig != NULL) && ((pConfig->maxVoices < 0) || (pConfig->maxVoices > MAX_SYNTH_VOICES) ||
+        (pConfig->maxSynths < 0) || (pConfig->maxSynths > MAX_VIRTUAL_SYNTHESIZERS)))
+        return EAS_ERROR_PARAMETER_RANGE;
 
     /* get the memory model */
     staticMemoryModel = EAS_CMStaticMemoryModel();
 
     /* initialize the host wrapper interface */
-    *ppEASData = NULL;
-    if ((result = EAS_HWInit(&pHWInstData)) != EAS_SUCCESS)
+#ifdef _MEMORY_ARENA
+    if (pConfig != NULL)
+        result = EAS_HWInitEx(&pHWInstData, pConfig->pAllocator, pConfig->pArena, pConfig->arenaSize);
+    else
+#else
+    if ((pConfig != NULL) && ((pConfig->pAllocator != NULL) || (pConfig->arenaSize != 0)))
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+    result = EAS_HWInit(&pHWInstData);
+    if (result != EAS_SUCCESS)
         return result;
 
     /* check Configuration Module for S_EAS_DATA allocation */
@@ -343,12 +618,41 @@ EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData)
     pEASData->staticMemoryModel = (EAS_BOOL8) staticMemoryModel;
     pEASData->hwInstData = pHWInstData;
     pEASData->renderTime = 0;
+#ifdef _RUNTIME_SAMPLE_RATE
+    pEASData->rateShift = rateShift;
+#endif
+#ifdef _BLOCK_RENDER
+    pEASData->blockFrames = 1;
+    pEASData->renderFrames = 1;
+#endif
+#ifdef _LOW_LATENCY
+    pEASData->sliceSize = EAS_FRAME_SIZE(pEASData);
+#endif
 
     /* set header search flag */
 #ifdef FILE_HEADER_SEARCH
     pEASData->searchHeaderFlag = EAS_TRUE;
 #endif
 
+    /* size the stream table */
+#ifdef _DYNAMIC_STREAMS
+    pEASData->streams = pEASData->defaultStreams;
+    pEASData->maxStreams = MAX_NUMBER_STREAMS;
+    if ((pConfig != NULL) && (pConfig->maxStreams > MAX_NUMBER_STREAMS))
+    {
+        if (staticMemoryModel)
+            return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+        pEASData->streams = EAS_HWMalloc(pHWInstData, pConfig->maxStreams * (EAS_I32) sizeof(S_EAS_STREAM));
+        if (pEASData->streams == NULL)
+        {
+            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_FATAL, "Failed to allocate stream table\n"); */ }
+            return EAS_ERROR_MALLOC_FAILED;
+        }
+        EAS_HWMemSet(pEASData->streams, 0, pConfig->maxStreams * (EAS_I32) sizeof(S_EAS_STREAM));
+        pEASData->maxStreams = pConfig->maxStreams;
+    }
+#endif
+
     /* initalize parameters */
     EAS_SetVolume(pEASData, NULL, DEFAULT_VOLUME);
 
@@ -366,9 +670,25 @@ EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData)
 #endif
 
     /* initailize the voice manager & synthesizer */
-    if ((result = VMInitialize(pEASData)) != EAS_SUCCESS)
+    if ((result = VMInitialize(pEASData, (pConfig != NULL) ? pConfig->maxVoices : 0, (pConfig != NULL) ? pConfig->maxSynths : 0)) != EAS_SUCCESS)
         return result;
 
+    /* replace the built-in sound library */
+    if ((pConfig != NULL) && (pConfig->soundLibrary != NULL))
+    {
+#ifdef _EXTERNAL_SOUNDBANK
+        if ((result = EAS_SoundbankLoadShared(pHWInstData, pConfig->soundLibrary, &pEASData->pSoundLibrary)) != EAS_SUCCESS)
+        {
+            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Error %ld loading sound library\n", result); */ }
+            return result;
+        }
+        if ((result = VMSetGlobalEASLib(pEASData->pVoiceMgr, pEASData->pSoundLibrary)) != EAS_SUCCESS)
+            return result;
+#else
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+    }
+
     /* initialize mix engine */
     if ((result = EAS_MixEngineInit(pEASData)) != EAS_SUCCESS)
     {
@@ -376,6 +696,18 @@ EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData)
         return result;
     }
 
+#ifdef _OUTPUT_RESAMPLER
+    /* initialize the output resampler */
+    if (resampleRate != 0)
+    {
+        if ((result = EAS_ResamplerInit(pHWInstData, resampleRate, pConfig->resamplerQuality, &pEASData->pResampler)) != EAS_SUCCESS)
+        {
+            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Error %ld starting up resampler\n", result); */ }
+            return result;
+        }
+    }
+#endif
+
     /* initialize effects modules */
     for (module = 0; module < NUM_EFFECTS_MODULES; module++)
     {
@@ -403,6 +735,54 @@ EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData)
     return EAS_SUCCESS;
 }
 
+/*----------------------------------------------------------------------------
+ * EAS_CloseAllStreams()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Closes every stream of the instance, waiting for background opens first
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *
+ * Outputs:
+ *  the last error returned by a parser module
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_CloseAllStreams (S_EAS_DATA *pEASData)
+{
+    EAS_RESULT reportResult = EAS_SUCCESS;
+    EAS_RESULT result;
+    EAS_INT i;
+
+#ifdef _ASYNC_OPEN
+    /* wait for background opens, the streams they prepared are closed below */
+    for (i = 0; i < EAS_STREAM_SLOTS(pEASData); i++)
+        if (pEASData->streams[i].pAsyncOpen != NULL)
+            (void) EAS_WaitOpen(pEASData, &pEASData->streams[i]);
+#endif
+
+    for (i = 0; i < EAS_STREAM_SLOTS(pEASData); i++)
+    {
+#ifdef _PCM_CACHE
+        (void) EAS_StreamCacheLeave(pEASData, &pEASData->streams[i], EAS_FALSE);
+#endif
+        if (pEASData->streams[i].pParserModule && pEASData->streams[i].handle)
+        {
+            if ((result = (*((S_FILE_PARSER_INTERFACE*)(pEASData->streams[i].pParserModule))->pfClose)(pEASData, pEASData->streams[i].handle)) != EAS_SUCCESS)
+            {
+                { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Error %ld shutting down parser module\n", result); */ }
+                reportResult = result;
+            }
+        }
+
+        /* raw MIDI streams have no parser module */
+        else if (pEASData->streams[i].handle)
+            (void) EAS_CloseMIDIStream(pEASData, &pEASData->streams[i]);
+    }
+    return reportResult;
+}
+
 /*----------------------------------------------------------------------------
  * EAS_Shutdown()
  *----------------------------------------------------------------------------
@@ -426,22 +806,29 @@ EAS_PUBLIC EAS_RESULT EAS_Shutdown (EAS_DATA_HANDLE pEASData)
     /* establish pointers */
     EAS_HW_DATA_HANDLE hwInstData = pEASData->hwInstData;
 
+#ifdef _RENDER_AHEAD
+    /* the render thread must not touch the instance past this point */
+    (void) EAS_StopRenderAhead(pEASData);
+#endif
+#ifdef _PIPELINED_RENDER
+    (void) EAS_SetPipelinedRender(pEASData, EAS_FALSE);
+#endif
+
     /* if there are streams open, close them */
-    EAS_RESULT reportResult = EAS_SUCCESS;
+    EAS_RESULT reportResult = EAS_CloseAllStreams(pEASData);
 
     EAS_RESULT result;
     EAS_INT i;
-    for (i = 0; i < MAX_NUMBER_STREAMS; i++)
-    {
-        if (pEASData->streams[i].pParserModule && pEASData->streams[i].handle)
-        {
-            if ((result = (*((S_FILE_PARSER_INTERFACE*)(pEASData->streams[i].pParserModule))->pfClose)(pEASData, pEASData->streams[i].handle)) != EAS_SUCCESS)
-            {
-                { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Error %ld shutting down parser module\n", result); */ }
-                reportResult = result;
-            }
-        }
-    }
+
+#ifdef _PCM_CACHE
+    /* free the cached audio */
+    EAS_PCMCacheTrim(hwInstData, &pEASData->pcmCache, 0);
+#endif
+
+#ifdef _RINGTONE_EVENT_CACHE
+    /* free the compiled ringtones */
+    EAS_ToneCacheTrim(pEASData, 0);
+#endif
 
     /* shutdown PCM engine */
     if ((result = EAS_PEShutdown(pEASData)) != EAS_SUCCESS)
@@ -459,6 +846,12 @@ EAS_PUBLIC EAS_RESULT EAS_Shutdown (EAS_DATA_HANDLE pEASData)
             reportResult = result;
     }
 
+#ifdef _OUTPUT_RESAMPLER
+    /* shutdown the output resampler */
+    EAS_ResamplerShutdown(hwInstData, pEASData->pResampler);
+    pEASData->pResampler = NULL;
+#endif
+
     /* shutdown effects modules */
     for (i = 0; i < NUM_EFFECTS_MODULES; i++)
     {
@@ -476,6 +869,11 @@ EAS_PUBLIC EAS_RESULT EAS_Shutdown (EAS_DATA_HANDLE pEASData)
     /* shutdown the voice manager & synthesizer */
     VMShutdown(pEASData);
 
+#ifdef _EXTERNAL_SOUNDBANK
+    /* the synthesizers are gone, release the sound library */
+    EAS_SoundbankUnload(hwInstData, pEASData->pSoundLibrary);
+#endif
+
 #ifdef _METRICS_ENABLED
     /* shutdown the metrics module */
     if (pEASData->pMetricsModule != NULL)
@@ -489,6 +887,11 @@ EAS_PUBLIC EAS_RESULT EAS_Shutdown (EAS_DATA_HANDLE pEASData)
     }
 #endif
 
+#ifdef _DYNAMIC_STREAMS
+    if (pEASData->streams != pEASData->defaultStreams)
+        EAS_HWFree(hwInstData, pEASData->streams);
+#endif
+
     /* release allocated memory */
     if (!pEASData->staticMemoryModel)
         EAS_HWFree(hwInstData, pEASData);
@@ -507,39 +910,265 @@ EAS_PUBLIC EAS_RESULT EAS_Shutdown (EAS_DATA_HANDLE pEASData)
     return reportResult;
 }
 
-#ifdef JET_INTERFACE
+#ifdef _INSTANCE_POOL
 /*----------------------------------------------------------------------------
- * EAS_OpenJETStream()
+ * EAS_ResetInstance()
  *----------------------------------------------------------------------------
- * Private interface for JET to open an SMF stream with an offset
+ * Purpose:
+ * Returns an instance to the state after EAS_Init so it can be used again
+ * without freeing and reallocating its memory. Closes every stream.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *
+ * Outputs:
+ *  EAS_ERROR_NOT_VALID_IN_THIS_STATE if the instance must be shut down
+ *
  *----------------------------------------------------------------------------
 */
-EAS_RESULT EAS_OpenJETStream (EAS_DATA_HANDLE pEASData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_HANDLE *ppStream)
+static EAS_RESULT EAS_ResetInstance (S_EAS_DATA *pEASData)
 {
     EAS_RESULT result;
-    EAS_VOID_PTR streamHandle;
-    S_FILE_PARSER_INTERFACE *pParserModule;
-    EAS_INT streamNum;
+    EAS_INT i;
 
-    /* allocate a stream */
-    if ((streamNum = EAS_AllocateStream(pEASData)) < 0)
-        return EAS_ERROR_MAX_STREAMS_OPEN;
+#ifdef JET_INTERFACE
+    /* JET keeps its own allocations in the instance */
+    if (pEASData->jetHandle != NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
 
-    /* check Configuration Module for SMF parser */
-    *ppStream = NULL;
-    streamHandle = NULL;
-    pParserModule = (S_FILE_PARSER_INTERFACE *) EAS_CMEnumModules(0);
-    if (pParserModule == NULL)
-        return EAS_ERROR_UNRECOGNIZED_FORMAT;
+#ifdef _RENDER_AHEAD
+    (void) EAS_StopRenderAhead(pEASData);
+#endif
+#ifdef _PIPELINED_RENDER
+    (void) EAS_SetPipelinedRender(pEASData, EAS_FALSE);
+#endif
 
-    /* see if SMF parser recognizes the file */
-    if ((result = (*pParserModule->pfCheckFileType)(pEASData, fileHandle, &streamHandle, offset)) != EAS_SUCCESS)
-    {
-        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "CheckFileType returned error %ld\n", result); */ }
+    if ((result = EAS_CloseAllStreams(pEASData)) != EAS_SUCCESS)
         return result;
-    }
 
-    /* parser recognized the file, return the handle */
+#ifdef _PCM_CACHE
+    /* the next user starts with the cache disabled */
+    EAS_PCMCacheTrim(pEASData->hwInstData, &pEASData->pcmCache, 0);
+    pEASData->pcmCache.maxSize = 0;
+#endif
+
+#ifdef _RINGTONE_EVENT_CACHE
+    /* ringtones opened by the last user are not kept for the next */
+    EAS_ToneCacheTrim(pEASData, 0);
+    pEASData->toneCacheSize = 0;
+#endif
+
+    if ((result = VMResetVoiceMgr(pEASData)) != EAS_SUCCESS)
+        return result;
+
+    /* effects without a reset are started again */
+    for (i = 0; i < NUM_EFFECTS_MODULES; i++)
+    {
+        const S_EFFECTS_INTERFACE *pEffect = pEASData->effectsModules[i].effect;
+        if (pEffect == NULL)
+            continue;
+        if (pEffect->pfReset != NULL)
+            (*pEffect->pfReset)(pEASData, pEASData->effectsModules[i].effectData);
+        else
+        {
+            if ((result = (*pEffect->pfShutdown)(pEASData, pEASData->effectsModules[i].effectData)) != EAS_SUCCESS)
+                return result;
+            pEASData->effectsModules[i].effectData = NULL;
+            if ((result = (*pEffect->pfInit)(pEASData, &pEASData->effectsModules[i].effectData)) != EAS_SUCCESS)
+                return result;
+        }
+    }
+
+#ifdef _METRICS_ENABLED
+    if (pEASData->pMetricsModule != NULL)
+        (void) (*pEASData->pMetricsModule->pfReset)(pEASData->pMetricsData);
+#endif
+
+    /* clear the render state */
+    EAS_HWMemSet(pEASData->streams, 0, EAS_MAX_STREAMS(pEASData) * (EAS_I32) sizeof(S_EAS_STREAM));
+#ifdef _DYNAMIC_STREAMS
+    pEASData->streamSlots = 0;
+#endif
+    EAS_HWMemSet(pEASData->pMixBuffer, 0, MAX_BLOCK_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
+    pEASData->carryOffset = 0;
+    pEASData->carryCount = 0;
+#ifdef _HIGH_RES_OUTPUT
+    pEASData->carryWide = EAS_FALSE;
+#endif
+    pEASData->renderTime = 0;
+#ifdef _SAMPLE_CLOCK
+    pEASData->sampleTime = 0;
+#endif
+#ifdef _DEADLINE_MONITOR
+    /* the next user has its own callback */
+    pEASData->pfDeadlineCallback = NULL;
+    pEASData->deadlineBudget = 0;
+#endif
+#ifdef _PARSE_LIMITS
+    EAS_HWMemSet(&pEASData->parseLimits, 0, sizeof(pEASData->parseLimits));
+#endif
+#ifdef FILE_HEADER_SEARCH
+    pEASData->searchHeaderFlag = EAS_TRUE;
+#endif
+#ifdef _RT_SAFE_RENDER
+    pEASData->realtimeRender = EAS_FALSE;
+#endif
+#ifdef _IDLE_DETECT
+    pEASData->silentSamples = 0;
+    pEASData->silentFrame = EAS_FALSE;
+    pEASData->skipIdle = EAS_FALSE;
+#endif
+    return EAS_SetVolume(pEASData, NULL, DEFAULT_VOLUME);
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_AcquireInstance()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns an instance released to the pool, or initializes a new one
+ * with the compiled defaults
+ *
+ * Inputs:
+ *  ppEASData       - pointer to data handle variable for this instance
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_AcquireInstance (EAS_DATA_HANDLE *ppEASData)
+{
+#ifdef _INSTANCE_POOL
+    EAS_RESULT result;
+
+    *ppEASData = NULL;
+    if (EAS_CMStaticMemoryModel())
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+
+    EAS_HWGlobalLock();
+    if (numPooledInstances > 0)
+        *ppEASData = instancePool[--numPooledInstances];
+    EAS_HWGlobalUnlock();
+    if (*ppEASData != NULL)
+        return EAS_SUCCESS;
+
+    if ((result = EAS_Init(ppEASData)) != EAS_SUCCESS)
+        return result;
+    (*ppEASData)->pooled = EAS_TRUE;
+    return EAS_SUCCESS;
+#else
+    *ppEASData = NULL;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ReleaseInstance()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Closes every stream of an instance from EAS_AcquireInstance and keeps
+ * it for the next EAS_AcquireInstance. The instance is shut down if the
+ * pool is full or it can't be reset.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_ReleaseInstance (EAS_DATA_HANDLE pEASData)
+{
+#ifdef _INSTANCE_POOL
+    EAS_BOOL kept;
+
+    if (!pEASData)
+        return EAS_ERROR_HANDLE_INTEGRITY;
+    if (!pEASData->pooled || (EAS_ResetInstance(pEASData) != EAS_SUCCESS))
+        return EAS_Shutdown(pEASData);
+
+    EAS_HWGlobalLock();
+    kept = (numPooledInstances < EAS_INSTANCE_POOL_SIZE);
+    if (kept)
+        instancePool[numPooledInstances++] = pEASData;
+    EAS_HWGlobalUnlock();
+    if (!kept)
+        return EAS_Shutdown(pEASData);
+    return EAS_SUCCESS;
+#else
+    return EAS_Shutdown(pEASData);
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_FlushInstancePool()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Shuts down every instance kept in the pool
+ *
+ * Inputs:
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_FlushInstancePool (void)
+{
+#ifdef _INSTANCE_POOL
+    EAS_DATA_HANDLE pEASData;
+    EAS_RESULT reportResult = EAS_SUCCESS;
+    EAS_RESULT result;
+
+    for (;;)
+    {
+        EAS_HWGlobalLock();
+        pEASData = (numPooledInstances > 0) ? instancePool[--numPooledInstances] : NULL;
+        EAS_HWGlobalUnlock();
+        if (pEASData == NULL)
+            break;
+        if ((result = EAS_Shutdown(pEASData)) != EAS_SUCCESS)
+            reportResult = result;
+    }
+    return reportResult;
+#else
+    return EAS_SUCCESS;
+#endif
+}
+
+#ifdef JET_INTERFACE
+/*----------------------------------------------------------------------------
+ * EAS_OpenJETStream()
+ *----------------------------------------------------------------------------
+ * Private interface for JET to open an SMF stream with an offset
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_OpenJETStream (EAS_DATA_HANDLE pEASData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_HANDLE *ppStream)
+{
+    EAS_RESULT result;
+    EAS_VOID_PTR streamHandle;
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_INT streamNum;
+
+    /* allocate a stream */
+    if ((streamNum = EAS_AllocateStream(pEASData)) < 0)
+        return EAS_ERROR_MAX_STREAMS_OPEN;
+
+    /* check Configuration Module for SMF parser */
+    *ppStream = NULL;
+    streamHandle = NULL;
+    pParserModule = (S_FILE_PARSER_INTERFACE *) EAS_CMEnumModules(0);
+    if (pParserModule == NULL)
+        return EAS_ERROR_UNRECOGNIZED_FORMAT;
+
+    /* see if SMF parser recognizes the file */
+    if ((result = (*pParserModule->pfCheckFileType)(pEASData, fileHandle, &streamHandle, offset)) != EAS_SUCCESS)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "CheckFileType returned error %ld\n", result); */ }
+        return result;
+    }
+
+    /* parser recognized the file, return the handle */
     if (streamHandle)
     {
         EAS_InitStream(&pEASData->streams[streamNum], pParserModule, streamHandle);
@@ -549,8 +1178,66 @@ EAS_RESULT EAS_OpenJETStream (EAS_DATA_HANDLE pEASData, EAS_FILE_HANDLE fileHand
 
     return EAS_ERROR_UNRECOGNIZED_FORMAT;
 }
+
+/*----------------------------------------------------------------------------
+ * EAS_RewindJETStream()
+ *----------------------------------------------------------------------------
+ * Private interface for JET to restart a segment that repeats. The parser
+ * is reset without the rest of EAS_Locate, which also marks the stream as
+ * parsed for the frame and so delays the restart by a frame. For SMF with
+ * _SMF_COMPILE_EVENTS the reset only rewinds the compiled event list.
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_RewindJETStream (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_RESULT result;
+
+    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+    if (pParserModule == NULL)
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+
+#ifdef _PCM_CACHE
+    if ((result = EAS_StreamCacheLeave(pEASData, pStream, EAS_FALSE)) != EAS_SUCCESS)
+        return result;
+#endif
+
+    /* reset the synth and parser, the stream is parsed from the start in the next frame */
+    if ((result = (*pParserModule->pfReset)(pEASData, pStream->handle)) != EAS_SUCCESS)
+        return result;
+    pStream->time = 0;
+    return EAS_SUCCESS;
+}
 #endif
 
+/*----------------------------------------------------------------------------
+ * EAS_InitMemoryLocator()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets up a file locator for content that is already in memory.
+ *
+ * Inputs:
+ * locator          - file locator to initialize
+ * pMemFile         - storage for the memory region description
+ * pData            - pointer to the file contents
+ * size             - size of the file in bytes
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC void EAS_InitMemoryLocator (EAS_FILE_LOCATOR locator, EAS_MEMORY_FILE *pMemFile, const void *pData, EAS_I32 size)
+{
+    pMemFile->pData = pData;
+    pMemFile->size = size;
+    locator->handle = pMemFile;
+    locator->readAt = EAS_HWMemReadAt;
+    locator->size = EAS_HWMemSize;
+}
+
 /*----------------------------------------------------------------------------
  * EAS_OpenFile()
  *----------------------------------------------------------------------------
@@ -575,7 +1262,9 @@ EAS_PUBLIC EAS_RESULT EAS_OpenFile (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR l
     EAS_VOID_PTR streamHandle;
     S_FILE_PARSER_INTERFACE *pParserModule;
     EAS_INT streamNum;
-    EAS_INT moduleNum;
+#ifdef _PCM_CACHE
+    S_PCM_CACHE_KEY cacheKey;
+#endif
 
     /* open the file */
     if ((result = EAS_HWOpenFile(pEASData->hwInstData, locator, &fileHandle, EAS_FILE_READ)) != EAS_SUCCESS)
@@ -588,62 +1277,148 @@ EAS_PUBLIC EAS_RESULT EAS_OpenFile (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR l
         EAS_HWCloseFile(pEASData->hwInstData, fileHandle);
         return EAS_ERROR_MAX_STREAMS_OPEN;
     }
+
+#ifdef _PCM_CACHE
+    /* identify the file for the PCM cache before a parser takes it */
+    cacheKey.fileSize = 0;
+    if (pEASData->pcmCache.maxSize > 0)
+        (void) EAS_PCMCacheHashFile(pEASData->hwInstData, fileHandle, &cacheKey);
+#endif
+
     /* check Configuration Module for file parsers */
-    pParserModule = NULL;
     *ppStream = NULL;
-    streamHandle = NULL;
-    for (moduleNum = 0; ; moduleNum++)
+    if ((result = EAS_FindParser(pEASData, fileHandle, &pParserModule, &streamHandle)) != EAS_SUCCESS)
+    {
+        /* Closing the opened file as no parser took it */
+        EAS_HWCloseFile(pEASData->hwInstData, fileHandle);
+        return result;
+    }
+
+    /* save the parser pointer and file handle */
+    EAS_InitStream(&pEASData->streams[streamNum], pParserModule, streamHandle);
+#ifdef _PCM_CACHE
+    pEASData->streams[streamNum].cacheKey = cacheKey;
+    if (cacheKey.fileSize > 0)
+        pEASData->streams[streamNum].cacheState = PCM_CACHE_IDLE;
+#endif
+    *ppStream = &pEASData->streams[streamNum];
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_FindParser()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Asks each file parser in turn whether it recognizes the file. With
+ * _FAST_FILE_PROBE the parser picked from the file's magic number is
+ * asked first, and the others only if it does not recognize the file.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * fileHandle       - file to check, rewound for each parser
+ * ppParserModule   - receives the parser that recognized the file
+ * pStreamHandle    - receives the parser instance data
+ *
+ * Outputs:
+ * EAS_ERROR_UNRECOGNIZED_FORMAT if no parser recognized the file. The file
+ * is left open on errors.
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_FindParser (S_EAS_DATA *pEASData, EAS_FILE_HANDLE fileHandle, S_FILE_PARSER_INTERFACE **ppParserModule, EAS_VOID_PTR *pStreamHandle)
+{
+    EAS_RESULT result;
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_INT moduleNum;
+    EAS_INT probeNum;
+#ifdef _FAST_FILE_PROBE
+    EAS_U8 header[EAS_CM_PROBE_SIZE];
+    EAS_I32 count;
+#endif
+
+    *ppParserModule = NULL;
+    *pStreamHandle = NULL;
+    probeNum = -1;
+
+#ifdef _RT_SAFE_RENDER
+    /* the parsers read the file from memory while rendering */
+    if (pEASData->realtimeRender)
     {
-        pParserModule = (S_FILE_PARSER_INTERFACE *) EAS_CMEnumModules(moduleNum);
+        if ((result = EAS_HWPreloadFile(pEASData->hwInstData, fileHandle)) != EAS_SUCCESS)
+            return result;
+    }
+#endif
+
+#ifdef _FAST_FILE_PROBE
+    /* the SMF header search looks past the magic number, so it needs the full search */
+#ifdef FILE_HEADER_SEARCH
+    if (!pEASData->searchHeaderFlag)
+#endif
+    {
+        /* files shorter than the header are probed on what was read */
+        count = 0;
+        result = EAS_HWReadFile(pEASData->hwInstData, fileHandle, header, sizeof(header), &count);
+        if ((result != EAS_SUCCESS) && (result != EAS_EOF))
+            return result;
+        if ((result = EAS_HWFileSeek(pEASData->hwInstData, fileHandle, 0L)) != EAS_SUCCESS)
+            return result;
+        probeNum = EAS_CMProbeModule(header, count);
+    }
+#endif
+
+    for (moduleNum = -1; ; moduleNum++)
+    {
+        /* the probed parser goes first and is not asked again */
+        if (moduleNum == -1)
+        {
+            if (probeNum < 0)
+                continue;
+            pParserModule = (S_FILE_PARSER_INTERFACE *) EAS_CMEnumModules(probeNum);
+        }
+        else if (moduleNum == probeNum)
+            continue;
+        else
+            pParserModule = (S_FILE_PARSER_INTERFACE *) EAS_CMEnumModules(moduleNum);
         if (pParserModule == NULL)
             break;
 
         /* see if this parser recognizes it */
-        if ((result = (*pParserModule->pfCheckFileType)(pEASData, fileHandle, &streamHandle, 0L)) != EAS_SUCCESS)
+        if ((result = (*pParserModule->pfCheckFileType)(pEASData, fileHandle, pStreamHandle, 0L)) != EAS_SUCCESS)
         {
-            /* Closing the opened file as file type check failed */
-            EAS_HWCloseFile(pEASData->hwInstData, fileHandle);
-
             { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "CheckFileType returned error %ld\n", result); */ }
             return result;
         }
 
         /* parser recognized the file, return the handle */
-        if (streamHandle)
+        if (*pStreamHandle)
         {
-
-            /* save the parser pointer and file handle */
-            EAS_InitStream(&pEASData->streams[streamNum], pParserModule, streamHandle);
-            *ppStream = &pEASData->streams[streamNum];
+            *ppParserModule = pParserModule;
             return EAS_SUCCESS;
         }
 
         /* rewind the file for the next parser */
         if ((result = EAS_HWFileSeek(pEASData->hwInstData, fileHandle, 0L)) != EAS_SUCCESS)
-        {
-            /* Closing the opened file as file seek failed */
-            EAS_HWCloseFile(pEASData->hwInstData, fileHandle);
-
             return result;
-         }
     }
 
-    /* no parser was able to recognize the file, close it and return an error */
-    EAS_HWCloseFile(pEASData->hwInstData, fileHandle);
+    /* no parser was able to recognize the file */
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "No parser recognized the requested file\n"); */ }
     return EAS_ERROR_UNRECOGNIZED_FORMAT;
 }
 
 /*----------------------------------------------------------------------------
- * EAS_Prepare()
+ * EAS_OpenFileAsync()
  *----------------------------------------------------------------------------
  * Purpose:
- * Prepares the synthesizer to play the file or stream. Parses the first
- * frame of data from the file and arms the synthesizer.
+ * Opens the file and reserves a stream for it, then identifies and
+ * prepares it on a background thread.
  *
  * Inputs:
  * pEASData         - pointer to overall EAS data structure
- * handle           - file or stream handle
+ * locator          - pointer to filename or other locating information
+ * pfCallback       - optional function called when the open completes
+ * pUserData        - passed to the callback
+ * ppStream         - pointer to stream handle variable
  *
  * Outputs:
  *
@@ -652,527 +1427,4555 @@ EAS_PUBLIC EAS_RESULT EAS_OpenFile (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR l
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_Prepare (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream)
+EAS_PUBLIC EAS_RESULT EAS_OpenFileAsync (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_OPEN_CALLBACK pfCallback, EAS_VOID_PTR pUserData, EAS_HANDLE *ppStream)
 {
-    S_FILE_PARSER_INTERFACE *pParserModule;
-    EAS_STATE state;
+#ifdef _ASYNC_OPEN
+    S_EAS_ASYNC_OPEN *pOpen;
+    S_EAS_STREAM *pStream;
     EAS_RESULT result;
+    EAS_INT streamNum;
 
-    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
-    if (pParserModule == NULL)
+    *ppStream = NULL;
+
+    /* the static memory model has a single stream and no threads */
+    if (pEASData->staticMemoryModel)
         return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#ifdef _RT_SAFE_RENDER
+    /* render locks the instance while the open runs */
+    if (pEASData->realtimeRender)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
 
-    /* check for valid state */
-    result = pParserModule->pfState(pEASData, pStream->handle, &state);
-    if (result == EAS_SUCCESS)
-    {
-        /* prepare the stream */
-        if (state == EAS_STATE_OPEN)
-        {
-            pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
-            result = (*pParserModule->pfPrepare)(pEASData, pStream->handle);
+    pOpen = EAS_HWMallocCategory(pEASData->hwInstData, sizeof(S_EAS_ASYNC_OPEN), EAS_MEM_PARSERS);
+    if (pOpen == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    EAS_HWMemSet(pOpen, 0, sizeof(S_EAS_ASYNC_OPEN));
 
-            /* set volume */
-            if (result == EAS_SUCCESS)
-                result = EAS_SetVolume(pEASData, pStream, pStream->volume);
-        }
-        else
-            result = EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    /* open the file */
+    if ((result = EAS_HWOpenFile(pEASData->hwInstData, locator, &pOpen->fileHandle, EAS_FILE_READ)) != EAS_SUCCESS)
+    {
+        EAS_HWFree(pEASData->hwInstData, pOpen);
+        return result;
+    }
 
+    /* reserve a stream, it is not rendered until the thread gives it a parser */
+    if ((streamNum = EAS_AllocateStream(pEASData)) < 0)
+    {
+        EAS_HWCloseFile(pEASData->hwInstData, pOpen->fileHandle);
+        EAS_HWFree(pEASData->hwInstData, pOpen);
+        return EAS_ERROR_MAX_STREAMS_OPEN;
+    }
+    pStream = &pEASData->streams[streamNum];
+    EAS_InitStream(pStream, NULL, NULL);
+    pStream->pAsyncOpen = pOpen;
+
+    pOpen->pEASData = pEASData;
+    pOpen->pStream = pStream;
+    pOpen->pfCallback = pfCallback;
+    pOpen->pUserData = pUserData;
+
+    /* render frames lock the instance from now until the open is joined */
+    pEASData->asyncOpens++;
+    if ((result = EAS_HWCreateThread(pEASData->hwInstData, EAS_AsyncOpenThread, pOpen, &pOpen->thread)) != EAS_SUCCESS)
+    {
+        pEASData->asyncOpens--;
+        pStream->pAsyncOpen = NULL;
+        EAS_HWCloseFile(pEASData->hwInstData, pOpen->fileHandle);
+        EAS_HWFree(pEASData->hwInstData, pOpen);
+        return result;
     }
 
-    return result;
+    *ppStream = pStream;
+    return EAS_SUCCESS;
+#else
+    *ppStream = NULL;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
 }
 
+#ifdef _ASYNC_OPEN
 /*----------------------------------------------------------------------------
- * EAS_Render()
+ * EAS_AsyncOpenThread()
  *----------------------------------------------------------------------------
  * Purpose:
- * Parse the Midi data and render PCM audio data.
+ * Background thread for EAS_OpenFileAsync. The file is identified and
+ * prepared before the stream gets its parser, so the render thread does
+ * not see the stream until it is ready to play. The synthesizer is shared
+ * with the render thread from the moment the parser creates it, so the
+ * parsers lock the instance while they change it.
  *
  * Inputs:
- *  pEASData        - buffer for internal EAS data
- *  pOut            - output buffer pointer
- *  nNumRequested   - requested num samples to generate
- *  pnNumGenerated  - actual number of samples generated
+ * pArg             - S_EAS_ASYNC_OPEN
  *
  * Outputs:
- *  EAS_SUCCESS if PCM data was successfully rendered
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
+static void EAS_AsyncOpenThread (EAS_VOID_PTR pArg)
 {
+    S_EAS_ASYNC_OPEN *pOpen;
+    S_EAS_DATA *pEASData;
     S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_VOID_PTR streamHandle;
     EAS_RESULT result;
-    EAS_I32 voicesRendered;
-    EAS_STATE parserState;
-    EAS_INT streamNum;
-
-    /* assume no samples generated and reset workload */
-    *pNumGenerated = 0;
-    VMInitWorkload(pEASData->pVoiceMgr);
-
-    /* no support for other buffer sizes yet */
-    if (numRequested != BUFFER_SIZE_IN_MONO_SAMPLES)
-    {
-        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "This library supports only %ld samples in buffer, host requested %ld samples\n",
-            (EAS_I32) BUFFER_SIZE_IN_MONO_SAMPLES, numRequested); */ }
-        return EAS_BUFFER_SIZE_MISMATCH;
-    }
-
-#ifdef _METRICS_ENABLED
-    /* start performance counter */
-    if (pEASData->pMetricsData)
-        (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_TOTAL_TIME);
-#endif
-
-    /* prep the frame buffer, do mix engine prep only if TRUE */
-#ifdef _SPLIT_ARCHITECTURE
-    if (VMStartFrame(pEASData))
-        EAS_MixEnginePrep(pEASData, numRequested);
-#else
-    /* prep the mix engine */
-    EAS_MixEnginePrep(pEASData, numRequested);
+#ifdef _PCM_CACHE
+    S_PCM_CACHE_KEY cacheKey;
 #endif
 
-    /* save the output buffer pointer */
-    pEASData->pOutputAudioBuffer = pOut;
-
+    pOpen = (S_EAS_ASYNC_OPEN*) pArg;
+    pEASData = pOpen->pEASData;
 
-#ifdef _METRICS_ENABLED
-        /* start performance counter */
-        if (pEASData->pMetricsData)
-            (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_PARSE_TIME);
+#ifdef _PCM_CACHE
+    /* identify the file for the PCM cache before a parser takes it */
+    cacheKey.fileSize = 0;
+    if (pEASData->pcmCache.maxSize > 0)
+        (void) EAS_PCMCacheHashFile(pEASData->hwInstData, pOpen->fileHandle, &cacheKey);
 #endif
 
-    /* if we haven't finished parsing from last time, do it now */
-    /* need to parse another frame of events before we render again */
-    for (streamNum = 0; streamNum < MAX_NUMBER_STREAMS; streamNum++)
+    /* the parser that recognizes the file owns it from then on */
+    if ((result = EAS_FindParser(pEASData, pOpen->fileHandle, &pParserModule, &streamHandle)) != EAS_SUCCESS)
+        EAS_HWCloseFile(pEASData->hwInstData, pOpen->fileHandle);
+
+    else
     {
-        /* clear the locate flag */
-        pEASData->streams[streamNum].streamFlags &= ~STREAM_FLAGS_LOCATE;
+        result = (*pParserModule->pfPrepare)(pEASData, streamHandle);
 
-        if (pEASData->streams[streamNum].pParserModule)
+        /* hand the stream to the render thread */
+        EAS_HWLock(pEASData->hwInstData);
+        if (result == EAS_SUCCESS)
         {
-
-            /* establish pointer to parser module */
-            pParserModule = pEASData->streams[streamNum].pParserModule;
-
-#ifdef JET_INTERFACE
-            /* handle pause */
-            if (pEASData->streams[streamNum].streamFlags & STREAM_FLAGS_PAUSE)
-            {
-                if (pParserModule->pfPause)
-                    result = pParserModule->pfPause(pEASData, pEASData->streams[streamNum].handle);
-                pEASData->streams[streamNum].streamFlags &= ~STREAM_FLAGS_PAUSE;
-            }
+            EAS_InitStream(pOpen->pStream, pParserModule, streamHandle);
+#ifdef _PCM_CACHE
+            pOpen->pStream->cacheKey = cacheKey;
+            if (cacheKey.fileSize > 0)
+                pOpen->pStream->cacheState = PCM_CACHE_IDLE;
 #endif
+            result = EAS_SetVolume(pEASData, pOpen->pStream, pOpen->pStream->volume);
+        }
+        if (result != EAS_SUCCESS)
+        {
+            (void) (*pParserModule->pfClose)(pEASData, streamHandle);
+            pOpen->pStream->handle = NULL;
+            pOpen->pStream->pParserModule = NULL;
+        }
+        EAS_HWUnlock(pEASData->hwInstData);
+    }
 
-            /* get current state */
-            if ((result = (*pParserModule->pfState)(pEASData, pEASData->streams[streamNum].handle, &parserState)) != EAS_SUCCESS)
-                return result;
-
-#ifdef JET_INTERFACE
-            /* handle resume */
-            if (parserState == EAS_STATE_PAUSED)
-            {
-                if (pEASData->streams[streamNum].streamFlags & STREAM_FLAGS_RESUME)
-                {
-                    if (pParserModule->pfResume)
-                        result = pParserModule->pfResume(pEASData, pEASData->streams[streamNum].handle);
-                    pEASData->streams[streamNum].streamFlags &= ~STREAM_FLAGS_RESUME;
-                }
-            }
+    pOpen->result = result;
+    if (pOpen->pfCallback != NULL)
+        (*pOpen->pfCallback)(pOpen->pUserData, pOpen->pStream, result);
+}
 #endif
 
-            /* if necessary, parse stream */
-            if ((pEASData->streams[streamNum].streamFlags & STREAM_FLAGS_PARSED) == 0)
-                if ((result = EAS_ParseEvents(pEASData, &pEASData->streams[streamNum], pEASData->streams[streamNum].time + pEASData->streams[streamNum].frameLength, eParserModePlay)) != EAS_SUCCESS)
-                    return result;
+/*----------------------------------------------------------------------------
+ * EAS_WaitOpen()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Joins the thread started by EAS_OpenFileAsync. A stream that failed to
+ * open was never given a parser, so releasing the open frees it.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream handle from EAS_OpenFileAsync
+ *
+ * Outputs:
+ * result of the open and prepare
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_WaitOpen (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream)
+{
+#ifdef _ASYNC_OPEN
+    S_EAS_ASYNC_OPEN *pOpen;
+    EAS_RESULT result;
 
-            /* check for an early abort */
-            if ((pEASData->streams[streamNum].streamFlags) == 0)
-            {
+    pOpen = pStream->pAsyncOpen;
+    if (pOpen == NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
 
-#ifdef _METRICS_ENABLED
-                /* stop performance counter */
-                if (pEASData->pMetricsData)
-                    (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_TOTAL_TIME);
+    EAS_HWJoinThread(pEASData->hwInstData, pOpen->thread);
+    result = pOpen->result;
+    pStream->pAsyncOpen = NULL;
+    pEASData->asyncOpens--;
+    EAS_HWFree(pEASData->hwInstData, pOpen);
+    return result;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
 #endif
+}
 
-                return EAS_SUCCESS;
-            }
-
-            /* check for repeat */
-            if (pEASData->streams[streamNum].repeatCount)
-            {
+/*----------------------------------------------------------------------------
+ * EAS_OpenFileProgressive()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Opens a file that is still arriving. Only a parser that takes the
+ * available byte count can play it, the file is not hashed for the PCM
+ * cache because it would read past the available bytes.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * locator          - pointer to filename or other locating information
+ * available        - bytes of the file received so far
+ * ppStream         - pointer to stream handle variable
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_OpenFileProgressive (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_I32 available, EAS_HANDLE *ppStream)
+{
+#ifdef _PROGRESSIVE_FILES
+    EAS_RESULT result;
+    EAS_FILE_HANDLE fileHandle;
+    EAS_VOID_PTR streamHandle;
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_INT streamNum;
 
-                /* check for stopped state */
-                if ((result = (*pParserModule->pfState)(pEASData, pEASData->streams[streamNum].handle, &parserState)) != EAS_SUCCESS)
-                    return result;
-                if (parserState == EAS_STATE_STOPPED)
-                {
+    *ppStream = NULL;
+    if (available < 0)
+        return EAS_ERROR_PARAMETER_RANGE;
+#ifdef _RT_SAFE_RENDER
+    /* a progressive file is read as it arrives, which cannot be from memory */
+    if (pEASData->realtimeRender)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
 
-                    /* decrement repeat count, unless it is negative */
-                    if (pEASData->streams[streamNum].repeatCount > 0)
-                        pEASData->streams[streamNum].repeatCount--;
+    /* open the file */
+    if ((result = EAS_HWOpenFile(pEASData->hwInstData, locator, &fileHandle, EAS_FILE_READ)) != EAS_SUCCESS)
+        return result;
 
-                    /* reset the parser */
-                    if ((result = (*pParserModule->pfReset)(pEASData, pEASData->streams[streamNum].handle)) != EAS_SUCCESS)
-                        return result;
-                    pEASData->streams[streamNum].time = 0;
-                }
-            }
-        }
+    /* allocate a stream */
+    if ((streamNum = EAS_AllocateStream(pEASData)) < 0)
+    {
+        EAS_HWCloseFile(pEASData->hwInstData, fileHandle);
+        return EAS_ERROR_MAX_STREAMS_OPEN;
     }
 
-#ifdef _METRICS_ENABLED
-    /* stop performance counter */
-    if (pEASData->pMetricsData)
-        (void)(*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_PARSE_TIME);
-#endif
-
-#ifdef _METRICS_ENABLED
-    /* start the render timer */
-    if (pEASData->pMetricsData)
-        (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_RENDER_TIME);
-#endif
-
-    /* render audio */
-    if ((result = VMRender(pEASData->pVoiceMgr, BUFFER_SIZE_IN_MONO_SAMPLES, pEASData->pMixBuffer, &voicesRendered)) != EAS_SUCCESS)
+    /* the parser checks the file type from the first few bytes */
+    if ((result = EAS_FindParser(pEASData, fileHandle, &pParserModule, &streamHandle)) != EAS_SUCCESS)
     {
-        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "pfRender function returned error %ld\n", result); */ }
+        EAS_HWCloseFile(pEASData->hwInstData, fileHandle);
         return result;
     }
 
-#ifdef _METRICS_ENABLED
-    /* stop the render timer */
-    if (pEASData->pMetricsData) {
-        (*pEASData->pMetricsModule->pfIncrementCounter)(pEASData->pMetricsData, EAS_PM_FRAME_COUNT, 1);
-        (void)(*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_RENDER_TIME);
-        (*pEASData->pMetricsModule->pfIncrementCounter)(pEASData->pMetricsData, EAS_PM_TOTAL_VOICE_COUNT, (EAS_U32) voicesRendered);
-        (void)(*pEASData->pMetricsModule->pfRecordMaxValue)(pEASData->pMetricsData, EAS_PM_MAX_VOICES, (EAS_U32) voicesRendered);
+    /* tell the parser how much it may read */
+    result = EAS_ERROR_FEATURE_NOT_AVAILABLE;
+    if (pParserModule->pfSetData != NULL)
+    {
+        result = (*pParserModule->pfSetData)(pEASData, streamHandle, PARSER_DATA_BYTES_AVAILABLE, available);
+        if (result == EAS_ERROR_INVALID_PARAMETER)
+            result = EAS_ERROR_FEATURE_NOT_AVAILABLE;
+    }
+    if (result != EAS_SUCCESS)
+    {
+        (void) (*pParserModule->pfClose)(pEASData, streamHandle);
+        return result;
     }
-#endif
-
-    //2 Do we really need frameParsed?
-    /* need to parse another frame of events before we render again */
-    for (streamNum = 0; streamNum < MAX_NUMBER_STREAMS; streamNum++)
-        if (pEASData->streams[streamNum].pParserModule != NULL)
-            pEASData->streams[streamNum].streamFlags &= ~STREAM_FLAGS_PARSED;
 
-#ifdef _METRICS_ENABLED
-    /* start performance counter */
-    if (pEASData->pMetricsData)
-        (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_STREAM_TIME);
+    EAS_InitStream(&pEASData->streams[streamNum], pParserModule, streamHandle);
+    *ppStream = &pEASData->streams[streamNum];
+    return EAS_SUCCESS;
+#else
+    *ppStream = NULL;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
 #endif
+}
 
-#ifdef _METRICS_ENABLED
-    /* stop the stream timer */
-    if (pEASData->pMetricsData)
-        (void)(*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_STREAM_TIME);
-#endif
+/*----------------------------------------------------------------------------
+ * EAS_SetStreamAvailable()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Updates the bytes received of a file opened with EAS_OpenFileProgressive.
+ * A stream that stalled waiting for data plays again from the next render.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream handle from EAS_OpenFileProgressive
+ * available        - bytes of the file received so far
+ * complete         - EAS_TRUE once the whole file has arrived
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetStreamAvailable (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 available, EAS_BOOL complete)
+{
+#ifdef _PROGRESSIVE_FILES
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_RESULT result;
 
-#ifdef _METRICS_ENABLED
-    /* start the post timer */
-    if (pEASData->pMetricsData)
-        (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_POST_TIME);
-#endif
+    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+    if ((pParserModule == NULL) || (pParserModule->pfSetData == NULL))
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
 
-    /* for split architecture, send DSP vectors.  Do post only if return is TRUE */
-#ifdef _SPLIT_ARCHITECTURE
-    if (VMEndFrame(pEASData))
-    {
-        /* now do post-processing */
-        EAS_MixEnginePost(pEASData, numRequested);
-        *pNumGenerated = numRequested;
-    }
+    if (complete)
+        result = (*pParserModule->pfSetData)(pEASData, pStream->handle, PARSER_DATA_DOWNLOAD_COMPLETE, 0);
+    else
+        result = (*pParserModule->pfSetData)(pEASData, pStream->handle, PARSER_DATA_BYTES_AVAILABLE, available);
+    return (result == EAS_ERROR_INVALID_PARAMETER) ? EAS_ERROR_FEATURE_NOT_AVAILABLE : result;
 #else
-    /* now do post-processing */
-    EAS_MixEnginePost(pEASData, numRequested);
-    *pNumGenerated = numRequested;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
 #endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_Prepare()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Prepares the synthesizer to play the file or stream. Parses the first
+ * frame of data from the file and arms the synthesizer.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - file or stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_Prepare (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_STATE state;
+    EAS_RESULT result;
+
+    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+    if (pParserModule == NULL)
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+
+    /* check for valid state */
+    result = pParserModule->pfState(pEASData, pStream->handle, &state);
+    if (result == EAS_SUCCESS)
+    {
+        /* prepare the stream */
+        if (state == EAS_STATE_OPEN)
+        {
+            pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+            result = (*pParserModule->pfPrepare)(pEASData, pStream->handle);
+
+            /* set volume */
+            if (result == EAS_SUCCESS)
+                result = EAS_SetVolume(pEASData, pStream, pStream->volume);
+        }
+        else
+            result = EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+    }
+
+    return result;
+}
+
+#ifdef _PCM_CACHE
+/*----------------------------------------------------------------------------
+ * EAS_StreamCacheEligible()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * The mix buffer only holds the output of a stream while nothing else is
+ * playing, so a stream is recorded or played from the PCM cache only while
+ * it is the only stream and plays straight through.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream to check
+ *
+ * Outputs:
+ * EAS_TRUE if the stream may use the cache
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL EAS_StreamCacheEligible (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream)
+{
+    EAS_INT i;
+
+    if ((pEASData->pcmCache.maxSize == 0) || (pStream->repeatCount != 0))
+        return EAS_FALSE;
+    if (pStream->streamFlags & (STREAM_FLAGS_PAUSE | STREAM_FLAGS_RESUME))
+        return EAS_FALSE;
+#ifdef JET_INTERFACE
+    if (pEASData->jetHandle != NULL)
+        return EAS_FALSE;
+#endif
+#ifdef _STEM_OUTPUT
+    if (pEASData->pVoiceMgr->numStems != 0)
+        return EAS_FALSE;
+#endif
+#ifdef _CPU_BUDGET
+    /* the budget changes the polyphony with the load */
+    if (pEASData->pVoiceMgr->cpuBudget != 0)
+        return EAS_FALSE;
+#endif
+#ifdef _LOW_LATENCY
+    /* the cache holds whole frames */
+    if ((pEASData->slicePos != 0) || (pEASData->sliceSize < EAS_FRAME_SIZE(pEASData)))
+        return EAS_FALSE;
+#endif
+
+    for (i = 0; i < EAS_STREAM_SLOTS(pEASData); i++)
+    {
+        if (&pEASData->streams[i] == pStream)
+            continue;
+#ifdef _ASYNC_OPEN
+        if (pEASData->streams[i].pAsyncOpen != NULL)
+            return EAS_FALSE;
+#endif
+        if (pEASData->streams[i].handle != NULL)
+            return EAS_FALSE;
+    }
+    return EAS_TRUE;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_StreamCacheStart()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Called before the first frame of a stream is parsed. If the file was
+ * played before with the same settings the stream plays from the cache,
+ * otherwise its output is recorded.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream about to be rendered
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_StreamCacheStart (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    S_PCM_CACHE_ENTRY *pEntry;
+    EAS_STATE state;
+
+    /* only streams played from the start are cached */
+    pStream->cacheState = PCM_CACHE_OFF;
+    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+    if ((pStream->time != 0) || (pParserModule->pfTime == NULL) || !EAS_StreamCacheEligible(pEASData, pStream))
+        return;
+    if (((*pParserModule->pfState)(pEASData, pStream->handle, &state) != EAS_SUCCESS) || (state != EAS_STATE_READY))
+        return;
+
+    pStream->cacheKey.frameLength = pStream->frameLength;
+    pStream->cacheKey.startFlags = pStream->streamFlags;
+    pStream->cacheFrame = 0;
+    if ((pEntry = EAS_PCMCacheFind(&pEASData->pcmCache, &pStream->cacheKey, EAS_FRAME_SIZE(pEASData))) != NULL)
+    {
+        pEntry->users++;
+        pStream->cacheState = PCM_CACHE_PLAY;
+    }
+    else if ((pEntry = EAS_PCMCacheNewEntry(pEASData->hwInstData, &pEASData->pcmCache, &pStream->cacheKey, EAS_FRAME_SIZE(pEASData))) != NULL)
+        pStream->cacheState = PCM_CACHE_RECORD;
+    pStream->pCacheEntry = pEntry;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_StreamCacheLeave()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Stops a stream using the cache. A recording is discarded. A stream that
+ * plays from the cache can continue from the synthesizer at the same
+ * position; notes sounding at that point are not restarted.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream
+ * catchUp          - bring the parser to the current position
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_StreamCacheLeave (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream, EAS_BOOL catchUp)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    S_PCM_CACHE_ENTRY *pEntry;
+    EAS_RESULT result;
+    EAS_U32 time;
+
+    pEntry = pStream->pCacheEntry;
+    pStream->pCacheEntry = NULL;
+    if (pStream->cacheState == PCM_CACHE_RECORD)
+    {
+        pStream->cacheState = PCM_CACHE_OFF;
+        EAS_PCMCacheRemove(pEASData->hwInstData, &pEASData->pcmCache, pEntry);
+        return EAS_SUCCESS;
+    }
+    if (pStream->cacheState != PCM_CACHE_PLAY)
+        return EAS_SUCCESS;
+
+    pStream->cacheState = PCM_CACHE_OFF;
+    pEntry->users--;
+    if (!catchUp)
+        return EAS_SUCCESS;
+
+    /* the parser is still at the start of the file */
+    time = pStream->time;
+    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+    if ((result = (*pParserModule->pfReset)(pEASData, pStream->handle)) != EAS_SUCCESS)
+        return result;
+    pStream->time = 0;
+    pStream->streamFlags &= ~STREAM_FLAGS_PARSED;
+    if (time != 0)
+        return EAS_ParseEvents(pEASData, pStream, time, eParserModeLocate);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_StreamCacheSetParam()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Called before a stream parameter is changed. The volume and the
+ * transposition are part of the cache key; a change while the stream uses
+ * the cache takes it off the cache. Other parameters keep the stream off
+ * the cache altogether.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream
+ * param            - PARSER_DATA_XXX
+ * value            - new value
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_StreamCacheSetParam (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream, EAS_INT param, EAS_I32 value)
+{
+    if (param == PARSER_DATA_VOLUME)
+    {
+        if (pStream->cacheKey.gain == value)
+            return EAS_SUCCESS;
+        pStream->cacheKey.gain = value;
+    }
+    else if (param == PARSER_DATA_TRANSPOSITION)
+    {
+        if (pStream->cacheKey.transposition == value)
+            return EAS_SUCCESS;
+        pStream->cacheKey.transposition = value;
+    }
+    else if (pStream->cacheState == PCM_CACHE_IDLE)
+        pStream->cacheState = PCM_CACHE_OFF;
+
+    return EAS_StreamCacheLeave(pEASData, pStream, EAS_TRUE);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_StreamCacheFlush()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Empties the cache after a change to the whole instance, such as the
+ * sound library or the interpolator. Streams playing from the cache
+ * continue from the synthesizer.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_StreamCacheFlush (S_EAS_DATA *pEASData)
+{
+    EAS_RESULT result;
+    EAS_INT i;
+
+    for (i = 0; i < EAS_STREAM_SLOTS(pEASData); i++)
+        if ((result = EAS_StreamCacheLeave(pEASData, &pEASData->streams[i], EAS_TRUE)) != EAS_SUCCESS)
+            return result;
+    EAS_PCMCacheTrim(pEASData->hwInstData, &pEASData->pcmCache, 0);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_StreamCacheRecord()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds the frame just rendered to the recording of a stream. The entry is
+ * complete when the parser stops.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream being recorded
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_StreamCacheRecord (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_STATE state;
+
+    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+    if (((*pParserModule->pfState)(pEASData, pStream->handle, &state) != EAS_SUCCESS) || (state == EAS_STATE_ERROR) ||
+        (EAS_PCMCacheAddFrame(pEASData->hwInstData, &pEASData->pcmCache, pStream->pCacheEntry, pEASData->pMixBuffer, pStream->time, state) != EAS_SUCCESS))
+    {
+        (void) EAS_StreamCacheLeave(pEASData, pStream, EAS_FALSE);
+        return;
+    }
+
+    if (state == EAS_STATE_STOPPED)
+    {
+        pStream->pCacheEntry->complete = EAS_TRUE;
+        pStream->pCacheEntry = NULL;
+        pStream->cacheState = PCM_CACHE_OFF;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_StreamCachePlay()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Fills the mix buffer with the next cached frame of a stream
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream playing from the cache
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_StreamCachePlay (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream)
+{
+    S_PCM_CACHE_ENTRY *pEntry;
+    EAS_I32 frameSamples;
+
+    /* the mix buffer is already silent past the end, as it would be from the synthesizer */
+    pEntry = pStream->pCacheEntry;
+    if (pStream->cacheFrame >= pEntry->numFrames)
+        return;
+
+    frameSamples = pEntry->frameSize * NUM_OUTPUT_CHANNELS;
+    EAS_HWMemCpy(pEASData->pMixBuffer, &pEntry->pFrames[pStream->cacheFrame * frameSamples], frameSamples * (EAS_I32) sizeof(EAS_I32));
+    pStream->time = pEntry->pMarks[pStream->cacheFrame].time;
+    pStream->cacheFrame++;
+}
+#endif
+
+#ifdef _DEADLINE_MONITOR
+/*----------------------------------------------------------------------------
+ * EAS_DeadlineParsed()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Charges the time since the last mark to a stream that parsed events,
+ * keeping the slowest one.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pTiming         - timing of the frame
+ *  pStream         - stream that parsed
+ *  pMark           - time of the last mark, updated
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_DeadlineParsed (S_EAS_DATA *pEASData, S_EAS_FRAME_TIMING *pTiming, S_EAS_STREAM *pStream, EAS_U32 *pMark)
+{
+    EAS_U32 now;
+
+    now = EAS_HWGetTime(pEASData->hwInstData);
+    pTiming->numParsedStreams++;
+    if ((pTiming->slowestStream == NULL) || (now - *pMark > pTiming->slowestParseTime))
+    {
+        pTiming->slowestStream = pStream;
+        pTiming->slowestParseTime = now - *pMark;
+    }
+    *pMark = now;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_DeadlineCheck()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Completes the timing of a frame and reports it if it missed the deadline.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pTiming         - timing of the frame
+ *  start           - time the frame started
+ *  mark            - time synthesis ended
+ *  numSamples      - samples rendered
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_DeadlineCheck (S_EAS_DATA *pEASData, S_EAS_FRAME_TIMING *pTiming, EAS_U32 start, EAS_U32 mark, EAS_I32 numSamples)
+{
+    EAS_U32 now;
+    EAS_U32 frameSize;
+
+    /* scale the budget to the samples without overflowing */
+    now = EAS_HWGetTime(pEASData->hwInstData);
+    frameSize = (EAS_U32) EAS_FRAME_SIZE(pEASData);
+    pTiming->numSamples = numSamples;
+    pTiming->budget = (pEASData->deadlineBudget / frameSize) * (EAS_U32) numSamples +
+        ((pEASData->deadlineBudget % frameSize) * (EAS_U32) numSamples) / frameSize;
+    pTiming->totalTime = now - start;
+    pTiming->postTime = now - mark;
+    if (pTiming->totalTime > pTiming->budget)
+        (*pEASData->pfDeadlineCallback)(pEASData->pDeadlineUserData, pTiming);
+}
+#endif
+
+#ifdef _IDLE_DETECT
+/* silent output before a frame is idle, longer than the reverb and chorus delay lines */
+#define EAS_IDLE_SAMPLES                8192
+
+/*----------------------------------------------------------------------------
+ * EAS_SoundPlaying()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns EAS_TRUE if a voice or a PCM stream is playing
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL EAS_SoundPlaying (S_EAS_DATA *pEASData)
+{
+    if (pEASData->pVoiceMgr->activeVoices != 0)
+        return EAS_TRUE;
+    return EAS_PEActive(pEASData);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_TrackSilence()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Counts the silent output rendered with nothing playing
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  numSamples      - samples per channel in the frame just rendered
+ *  playing         - EAS_SoundPlaying at the end of the frame
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_TrackSilence (S_EAS_DATA *pEASData, EAS_I32 numSamples, EAS_BOOL playing)
+{
+    EAS_I32 i;
+
+    pEASData->silentFrame = EAS_TRUE;
+#ifdef _HIGH_RES_OUTPUT
+    if (pEASData->pWideOutput != NULL)
+    {
+        for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+            if (pEASData->pWideOutput[i] != 0)
+                break;
+    }
+    else
+#endif
+    for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+        if (pEASData->pOutputAudioBuffer[i] != 0)
+            break;
+    if (i < numSamples * NUM_OUTPUT_CHANNELS)
+        pEASData->silentFrame = EAS_FALSE;
+
+    /* a note that is starting or a stream that plays silence is not idle */
+    if (pEASData->silentFrame && !playing)
+        pEASData->silentSamples += numSamples;
+    else
+        pEASData->silentSamples = 0;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_ParseFrame()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses the events of all streams for the frame about to be rendered.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pFrame          - receives the outcome of the parse
+ *  numRequested    - samples per channel in the frame
+ *  offline         - skip the metrics timers
+ *
+ * Outputs:
+ *  EAS_SUCCESS, with pFrame->aborted set if the frame is not to be rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_ParseFrame (S_EAS_DATA *pEASData, S_EAS_PARSED_FRAME *pFrame, EAS_I32 numRequested, EAS_BOOL offline)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_RESULT result;
+    EAS_STATE parserState;
+    EAS_INT streamNum;
+
+#ifdef _METRICS_ENABLED
+    /* start performance counter */
+    if (pEASData->pMetricsData && !offline)
+        (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_PARSE_TIME);
+#endif
+
+#ifdef _DYNAMIC_STREAMS
+    /* skip the free slots at the top of the stream table */
+    while (pEASData->streamSlots > 0)
+    {
+        S_EAS_STREAM *pStream = &pEASData->streams[pEASData->streamSlots - 1];
+#ifdef _ASYNC_OPEN
+        if (pStream->pAsyncOpen != NULL)
+            break;
+#endif
+        if (pStream->handle != NULL)
+            break;
+        pEASData->streamSlots--;
+    }
+#endif
+
+    /* if we haven't finished parsing from last time, do it now */
+    /* need to parse another frame of events before we render again */
+    for (streamNum = 0; streamNum < EAS_STREAM_SLOTS(pEASData); streamNum++)
+    {
+        /* clear the locate flag */
+        pEASData->streams[streamNum].streamFlags &= ~STREAM_FLAGS_LOCATE;
+
+        if (pEASData->streams[streamNum].pParserModule)
+        {
+
+#ifdef _LOW_LATENCY
+            /* the events of a frame are parsed at its first slice */
+            if (pEASData->slicePos != 0)
+                continue;
+#endif
+
+            /* establish pointer to parser module */
+            pParserModule = pEASData->streams[streamNum].pParserModule;
+
+#ifdef _PCM_CACHE
+            /* decide at the first frame whether the stream is recorded or played from the cache */
+            if (pEASData->streams[streamNum].cacheState == PCM_CACHE_IDLE)
+                EAS_StreamCacheStart(pEASData, &pEASData->streams[streamNum]);
+            else if ((pEASData->streams[streamNum].cacheState != PCM_CACHE_OFF) && !EAS_StreamCacheEligible(pEASData, &pEASData->streams[streamNum]))
+            {
+                if ((result = EAS_StreamCacheLeave(pEASData, &pEASData->streams[streamNum], EAS_TRUE)) != EAS_SUCCESS)
+                    return result;
+            }
+
+            /* a stream playing from the cache is not parsed */
+            if (pEASData->streams[streamNum].cacheState == PCM_CACHE_PLAY)
+            {
+                pFrame->pCacheStream = &pEASData->streams[streamNum];
+                continue;
+            }
+#endif
+
+#ifdef JET_INTERFACE
+            /* handle pause */
+            if (pEASData->streams[streamNum].streamFlags & STREAM_FLAGS_PAUSE)
+            {
+                if (pParserModule->pfPause)
+                    result = pParserModule->pfPause(pEASData, pEASData->streams[streamNum].handle);
+                pEASData->streams[streamNum].streamFlags &= ~STREAM_FLAGS_PAUSE;
+            }
+#endif
+
+            /* get current state */
+            if ((result = (*pParserModule->pfState)(pEASData, pEASData->streams[streamNum].handle, &parserState)) != EAS_SUCCESS)
+                return result;
+
+#ifdef JET_INTERFACE
+            /* handle resume */
+            if (parserState == EAS_STATE_PAUSED)
+            {
+                if (pEASData->streams[streamNum].streamFlags & STREAM_FLAGS_RESUME)
+                {
+                    if (pParserModule->pfResume)
+                        result = pParserModule->pfResume(pEASData, pEASData->streams[streamNum].handle);
+                    pEASData->streams[streamNum].streamFlags &= ~STREAM_FLAGS_RESUME;
+                }
+            }
+#endif
+
+            /* if necessary, parse stream */
+            if ((pEASData->streams[streamNum].streamFlags & STREAM_FLAGS_PARSED) == 0)
+            {
+                EAS_TRACE_BEGIN("EAS_ParseEvents");
+                result = EAS_ParseEvents(pEASData, &pEASData->streams[streamNum], pEASData->streams[streamNum].time + pEASData->streams[streamNum].frameLength * (EAS_U32) EAS_BLOCK_FRAMES(pEASData), eParserModePlay);
+                EAS_TRACE_END();
+                if (result != EAS_SUCCESS)
+                    return result;
+#ifdef _DEADLINE_MONITOR
+                if (pFrame->pTiming != NULL)
+                    EAS_DeadlineParsed(pEASData, pFrame->pTiming, &pEASData->streams[streamNum], &pFrame->mark);
+#endif
+            }
+
+            /* check for an early abort */
+            if ((pEASData->streams[streamNum].streamFlags) == 0)
+            {
+                pFrame->aborted = EAS_TRUE;
+                return EAS_SUCCESS;
+            }
+
+            /* check for repeat */
+            if (pEASData->streams[streamNum].repeatCount)
+            {
+
+                /* check for stopped state */
+                if ((result = (*pParserModule->pfState)(pEASData, pEASData->streams[streamNum].handle, &parserState)) != EAS_SUCCESS)
+                    return result;
+                if (parserState == EAS_STATE_STOPPED)
+                {
+
+                    /* decrement repeat count, unless it is negative */
+                    if (pEASData->streams[streamNum].repeatCount > 0)
+                        pEASData->streams[streamNum].repeatCount--;
+
+                    /* reset the parser */
+                    if ((result = (*pParserModule->pfReset)(pEASData, pEASData->streams[streamNum].handle)) != EAS_SUCCESS)
+                        return result;
+                    pEASData->streams[streamNum].time = 0;
+                }
+            }
+        }
+
+#ifdef _MIDI_INPUT_RING
+        /* play the MIDI stream input due in this frame */
+        else if (pEASData->streams[streamNum].handle)
+        {
+            if ((result = EAS_MIDIRingRead(pEASData, pEASData->streams[streamNum].handle, pEASData->sampleTime + (EAS_U32) numRequested)) != EAS_SUCCESS)
+                return result;
+        }
+#endif
+    }
+
+#ifdef _METRICS_ENABLED
+    /* stop performance counter */
+    if (pEASData->pMetricsData && !offline)
+        (void)(*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_PARSE_TIME);
+#endif
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_AdvanceFrame()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Advances the render time past the samples just rendered
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  numSamples      - samples per channel rendered
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_AdvanceFrame (S_EAS_DATA *pEASData, EAS_I32 numSamples)
+{
+#ifdef _LOW_LATENCY
+    EAS_BOOL frameDone;
+
+    frameDone = (EAS_BOOL) (pEASData->slicePos + numSamples >= EAS_FRAME_SIZE(pEASData));
+    pEASData->slicePos = (pEASData->slicePos + numSamples) % EAS_FRAME_SIZE(pEASData);
+    if (frameDone)
+#endif
+    pEASData->renderTime += AUDIO_FRAME_LENGTH * (EAS_U32) EAS_BLOCK_FRAMES(pEASData);
+#ifdef _SAMPLE_CLOCK
+    EAS_HWAtomicStore(&pEASData->sampleTime, pEASData->sampleTime + (EAS_U32) numSamples);
+#endif
+}
+
+#ifndef _SPLIT_ARCHITECTURE
+/*----------------------------------------------------------------------------
+ * EAS_PostFrame()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Runs the master gain and the effects on the mix of the frame
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  numSamples      - samples per channel in the frame
+ *  idleFrame       - the frame is idle, see EAS_SetIdleMode
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, idleFrame) used only with _IDLE_DETECT */
+static void EAS_PostFrame (S_EAS_DATA *pEASData, EAS_I32 numSamples, EAS_BOOL idleFrame)
+{
+#ifdef _IDLE_DETECT
+    /* the silent mix of an idle frame skips the master gain and effects chain */
+    if (idleFrame && EAS_MixEngineIdle(pEASData, numSamples))
+        return;
+#endif
+#ifdef _BLOCK_RENDER
+    EAS_MixEngineBlockPost(pEASData, numSamples);
+#else
+    EAS_MixEnginePost(pEASData, numSamples);
+#endif
+}
+#endif
+
+#ifdef _PIPELINED_RENDER
+/*----------------------------------------------------------------------------
+ * EAS_PipelineReady()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns EAS_TRUE if the next frame can be parsed while the current one
+ * is post-processed. EAS_Render must render another frame of the same
+ * block size in the same call, and the frame must be whole and rendered
+ * without the resampler or the CPU budget, which work on the time of the
+ * whole frame.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  numSamples      - samples per channel in the current frame
+ *  offline         - the frame is rendered offline
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL EAS_PipelineReady (S_EAS_DATA *pEASData, EAS_I32 numSamples, EAS_BOOL offline)
+{
+    EAS_I32 remaining;
+
+    remaining = pEASData->pipeRemaining - numSamples;
+    if ((pEASData->pPipeline == NULL) || offline || (remaining <= 0))
+        return EAS_FALSE;
+#ifdef _ASYNC_OPEN
+    if (pEASData->asyncOpens > 0)
+        return EAS_FALSE;
+#endif
+#ifdef _LOW_LATENCY
+    if ((pEASData->slicePos != 0) || (pEASData->sliceSize < EAS_FRAME_SIZE(pEASData)))
+        return EAS_FALSE;
+#endif
+#ifdef _OUTPUT_RESAMPLER
+    if (pEASData->pResampler != NULL)
+        return EAS_FALSE;
+#endif
+#ifdef _CPU_BUDGET
+    if (pEASData->pVoiceMgr->cpuBudget != 0)
+        return EAS_FALSE;
+#endif
+#ifdef _BLOCK_RENDER
+    /* the next frame is parsed for the block of this one */
+    if (((remaining >= EAS_MAX_FRAME_OUTPUT(pEASData)) ? EAS_RenderBlockFrames(pEASData, remaining) : 1) != pEASData->renderFrames)
+        return EAS_FALSE;
+#endif
+    return EAS_TRUE;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PipelineWorker()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Worker 0 post-processes the current frame while worker 1 parses the
+ * next one.
+ *
+ * Inputs:
+ *  pArg            - buffer for internal EAS data
+ *  workerNum       - worker index
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_PipelineWorker (EAS_VOID_PTR pArg, EAS_INT workerNum)
+{
+    S_EAS_DATA *pEASData;
+    S_EAS_PIPELINE *pPipeline;
+#ifdef _DEADLINE_MONITOR
+    EAS_U32 start = 0;
+#endif
+
+    pEASData = (S_EAS_DATA*) pArg;
+    pPipeline = pEASData->pPipeline;
+    if (workerNum == 0)
+    {
+        EAS_PostFrame(pEASData, pPipeline->numSamples, pPipeline->idleFrame);
+        return;
+    }
+
+#ifdef _RT_SAFE_RENDER
+    if (pEASData->realtimeRender)
+        EAS_HWBeginRealtime(pEASData->hwInstData);
+#endif
+    EAS_TRACE_BEGIN("EAS_ParseFrame");
+#ifdef _PCM_CACHE
+    pPipeline->frame.pCacheStream = NULL;
+#endif
+    pPipeline->frame.aborted = EAS_FALSE;
+#ifdef _DEADLINE_MONITOR
+    pPipeline->frame.pTiming = NULL;
+    if (pEASData->pfDeadlineCallback != NULL)
+    {
+        EAS_HWMemSet(&pPipeline->timing, 0, (EAS_I32) sizeof(pPipeline->timing));
+        pPipeline->frame.pTiming = &pPipeline->timing;
+        start = pPipeline->frame.mark = EAS_HWGetTime(pEASData->hwInstData);
+    }
+#endif
+    pPipeline->result = EAS_ParseFrame(pEASData, &pPipeline->frame, pPipeline->numSamples, EAS_FALSE);
+#ifdef _DEADLINE_MONITOR
+    if (pPipeline->frame.pTiming != NULL)
+        pPipeline->timing.parseTime = EAS_HWGetTime(pEASData->hwInstData) - start;
+#endif
+    EAS_TRACE_END();
+#ifdef _RT_SAFE_RENDER
+    if (pEASData->realtimeRender)
+        EAS_HWEndRealtime(pEASData->hwInstData);
+#endif
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_IntRenderFrame()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parse the Midi data and render one frame (BUFFER_SIZE_IN_MONO_SAMPLES)
+ * of PCM audio data.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  pnNumGenerated  - actual number of samples generated
+ *  offline         - skip the metrics timers and JET processing
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_IntRenderFrame (S_EAS_DATA *pEASData, EAS_PCM *pOut, EAS_I32 *pNumGenerated, EAS_BOOL offline)
+{
+    S_EAS_PARSED_FRAME frame;
+    EAS_RESULT result;
+    EAS_I32 voicesRendered;
+    EAS_INT streamNum;
+    EAS_I32 numRequested = EAS_BLOCK_SIZE(pEASData);
+#ifdef _PIPELINED_RENDER
+    EAS_BOOL parsed;
+    EAS_BOOL pipelined = EAS_FALSE;
+#endif
+#ifdef _LOW_LATENCY
+    EAS_BOOL frameDone;
+#endif
+#ifdef _CPU_BUDGET
+    EAS_BOOL budget;
+    EAS_U32 frameStart = 0;
+    EAS_U32 renderStart = 0;
+    EAS_U32 renderTime = 0;
+#endif
+#ifdef _DEADLINE_MONITOR
+    S_EAS_FRAME_TIMING timing;
+    EAS_BOOL monitor;
+    EAS_U32 monitorStart = 0;
+    EAS_U32 monitorMark = 0;
+#endif
+#ifndef _SPLIT_ARCHITECTURE
+    EAS_BOOL idleFrame = EAS_FALSE;
+#endif
+#ifdef _IDLE_DETECT
+    EAS_BOOL playing;
+#endif
+
+    /* assume no samples generated and reset workload */
+    *pNumGenerated = 0;
+#ifdef _PIPELINED_RENDER
+    /* the workload of a frame parsed ahead was reset before its parse */
+    parsed = (EAS_BOOL) ((pEASData->pPipeline != NULL) && pEASData->pPipeline->parsed);
+    if (!parsed)
+#endif
+    VMInitWorkload(pEASData->pVoiceMgr);
+
+#ifdef _LOW_LATENCY
+    /* in low latency mode a frame is rendered in slices */
+    if ((pEASData->slicePos != 0) || (pEASData->sliceSize < EAS_FRAME_SIZE(pEASData)))
+    {
+        numRequested = EAS_FRAME_SIZE(pEASData) - pEASData->slicePos;
+        if (numRequested > pEASData->sliceSize)
+            numRequested = pEASData->sliceSize;
+    }
+    frameDone = (EAS_BOOL) (pEASData->slicePos + numRequested >= EAS_FRAME_SIZE(pEASData));
+#endif
+
+#ifdef _CPU_BUDGET
+    /* time the frame for the CPU budget, offline renders are not limited */
+    budget = (EAS_BOOL) ((pEASData->pVoiceMgr->cpuBudget != 0) && !offline);
+    if (budget)
+        frameStart = EAS_HWGetTime(pEASData->hwInstData);
+#endif
+
+#ifdef _DEADLINE_MONITOR
+    /* time the frame against the deadline, offline renders have none */
+    monitor = (EAS_BOOL) ((pEASData->pfDeadlineCallback != NULL) && !offline);
+    if (monitor)
+    {
+        EAS_HWMemSet(&timing, 0, (EAS_I32) sizeof(timing));
+        monitorStart = monitorMark = EAS_HWGetTime(pEASData->hwInstData);
+    }
+#endif
+
+#ifdef _METRICS_ENABLED
+    /* start performance counter */
+    if (pEASData->pMetricsData && !offline)
+        (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_TOTAL_TIME);
+#endif
+
+    /* prep the frame buffer, do mix engine prep only if TRUE */
+#ifdef _SPLIT_ARCHITECTURE
+    if (VMStartFrame(pEASData))
+        EAS_MixEnginePrep(pEASData, numRequested);
+#else
+    /* prep the mix engine */
+    EAS_MixEnginePrep(pEASData, numRequested);
+#endif
+
+    /* save the output buffer pointer */
+#ifdef _OUTPUT_RESAMPLER
+    /* the resampler reads the frame from its own buffer */
+    if (pEASData->pResampler != NULL)
+        pEASData->pOutputAudioBuffer = pEASData->pResampler->input;
+    else
+#endif
+    pEASData->pOutputAudioBuffer = pOut;
+
+
+#ifdef _PIPELINED_RENDER
+    /* the events were parsed while the last frame was post-processed */
+    if (parsed)
+    {
+        pEASData->pPipeline->parsed = EAS_FALSE;
+        if ((result = pEASData->pPipeline->result) != EAS_SUCCESS)
+            return result;
+        frame = pEASData->pPipeline->frame;
+#ifdef _DEADLINE_MONITOR
+        if (monitor && (frame.pTiming != NULL))
+            timing = pEASData->pPipeline->timing;
+#endif
+    }
+    else
+#endif
+    {
+        /* parse the events of the frame */
+#ifdef _PCM_CACHE
+        frame.pCacheStream = NULL;
+#endif
+        frame.aborted = EAS_FALSE;
+#ifdef _DEADLINE_MONITOR
+        frame.pTiming = monitor ? &timing : NULL;
+        frame.mark = monitorMark;
+#endif
+        if ((result = EAS_ParseFrame(pEASData, &frame, numRequested, offline)) != EAS_SUCCESS)
+            return result;
+    }
+
+    /* check for an early abort */
+    if (frame.aborted)
+    {
+
+#ifdef _METRICS_ENABLED
+        /* stop performance counter */
+        if (pEASData->pMetricsData && !offline)
+            (void)(*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_TOTAL_TIME);
+#endif
+
+        return EAS_SUCCESS;
+    }
+
+#ifdef _DEADLINE_MONITOR
+    if (monitor)
+    {
+        monitorMark = EAS_HWGetTime(pEASData->hwInstData);
+#ifdef _PIPELINED_RENDER
+        if (!parsed)
+#endif
+        timing.parseTime = monitorMark - monitorStart;
+    }
+#endif
+
+#if defined(_IDLE_DETECT) && !defined(_SPLIT_ARCHITECTURE)
+    /* nothing was started by the events of this frame after a run of silence */
+    idleFrame = (EAS_BOOL) (pEASData->skipIdle && (pEASData->silentSamples >= EAS_IDLE_SAMPLES) && !EAS_SoundPlaying(pEASData));
+#ifdef _PCM_CACHE
+    if (frame.pCacheStream != NULL)
+        idleFrame = EAS_FALSE;
+#endif
+#endif
+
+#ifdef _METRICS_ENABLED
+    /* start the render timer */
+    if (pEASData->pMetricsData && !offline)
+        (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_RENDER_TIME);
+#endif
+
+#ifdef _CPU_BUDGET
+    if (budget)
+        renderStart = EAS_HWGetTime(pEASData->hwInstData);
+#endif
+
+#ifdef _PCM_CACHE
+    /* the cached frame replaces the synthesizer, the stream is the only one playing */
+    if (frame.pCacheStream != NULL)
+    {
+        EAS_StreamCachePlay(pEASData, frame.pCacheStream);
+        voicesRendered = 0;
+    }
+    else
+#endif
+    /* render audio */
+    if ((result = VMRender(pEASData->pVoiceMgr, numRequested, pEASData->pMixBuffer, &voicesRendered)) != EAS_SUCCESS)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "pfRender function returned error %ld\n", result); */ }
+        return result;
+    }
+    EAS_TRACE_COUNTER("EAS voices", voicesRendered);
+    EAS_TRACE_COUNTER("EAS stolen voices", pEASData->pVoiceMgr->numStolenVoices);
+
+#ifdef _PCM_CACHE
+    /* record the frame of a stream played for the first time */
+    for (streamNum = 0; streamNum < EAS_STREAM_SLOTS(pEASData); streamNum++)
+        if (pEASData->streams[streamNum].cacheState == PCM_CACHE_RECORD)
+            EAS_StreamCacheRecord(pEASData, &pEASData->streams[streamNum]);
+#endif
+
+#ifdef _CHORUS_ENABLED
+    /* the post-processing of the frame follows the channels as they are now */
+    pEASData->chorusSend = VMChorusSend(pEASData->pVoiceMgr);
+#endif
+
+#ifdef _CPU_BUDGET
+    if (budget)
+        renderTime = EAS_HWGetTime(pEASData->hwInstData) - renderStart;
+#endif
+
+#ifdef _DEADLINE_MONITOR
+    if (monitor)
+    {
+        timing.renderTime = EAS_HWGetTime(pEASData->hwInstData) - monitorMark;
+        monitorMark += timing.renderTime;
+        timing.numVoices = voicesRendered;
+        timing.numStolenVoices = pEASData->pVoiceMgr->numStolenVoices;
+    }
+#endif
+
+#ifdef _METRICS_ENABLED
+    /* stop the render timer */
+    if (pEASData->pMetricsData && !offline) {
+        (*pEASData->pMetricsModule->pfIncrementCounter)(pEASData->pMetricsData, EAS_PM_FRAME_COUNT, (EAS_U32) EAS_BLOCK_FRAMES(pEASData));
+        (void)(*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_RENDER_TIME);
+        (*pEASData->pMetricsModule->pfIncrementCounter)(pEASData->pMetricsData, EAS_PM_TOTAL_VOICE_COUNT, (EAS_U32) voicesRendered);
+        (void)(*pEASData->pMetricsModule->pfRecordMaxValue)(pEASData->pMetricsData, EAS_PM_MAX_VOICES, (EAS_U32) voicesRendered);
+        (*pEASData->pMetricsModule->pfRecordValue)(pEASData->pMetricsData, EAS_PM_FRAME_VOICES, voicesRendered);
+        (*pEASData->pMetricsModule->pfRecordValue)(pEASData->pMetricsData, EAS_PM_FRAME_STOLEN_VOICES, pEASData->pVoiceMgr->numStolenVoices);
+        (*pEASData->pMetricsModule->pfRecordValue)(pEASData->pMetricsData, EAS_PM_FRAME_WORKLOAD, pEASData->pVoiceMgr->workload);
+    }
+#endif
+
+    //2 Do we really need frameParsed?
+    /* need to parse another frame of events before we render again */
+    for (streamNum = 0; streamNum < EAS_STREAM_SLOTS(pEASData); streamNum++)
+        if (pEASData->streams[streamNum].pParserModule != NULL)
+            pEASData->streams[streamNum].streamFlags &= ~STREAM_FLAGS_PARSED;
+
+#ifdef _METRICS_ENABLED
+    /* start performance counter */
+    if (pEASData->pMetricsData && !offline)
+        (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_STREAM_TIME);
+#endif
+
+    /* mix in the PCM streams */
+    if ((result = EAS_PERender(pEASData, numRequested)) != EAS_SUCCESS)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "EAS_PERender returned error %ld\n", result); */ }
+        return result;
+    }
+
+#ifdef _METRICS_ENABLED
+    /* stop the stream timer */
+    if (pEASData->pMetricsData && !offline)
+        (void)(*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_STREAM_TIME);
+#endif
+
+#ifdef _METRICS_ENABLED
+    /* start the post timer */
+    if (pEASData->pMetricsData && !offline)
+        (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_POST_TIME);
+#endif
+
+#ifdef _IDLE_DETECT
+    playing = EAS_SoundPlaying(pEASData);
+#endif
+
+    /* for split architecture, send DSP vectors.  Do post only if return is TRUE */
+#ifdef _SPLIT_ARCHITECTURE
+    if (VMEndFrame(pEASData))
+    {
+        /* now do post-processing */
+        EAS_MixEnginePost(pEASData, numRequested);
+        *pNumGenerated = numRequested;
+    }
+#else
+#ifdef _PIPELINED_RENDER
+    /* parse the next frame during the post-processing, which only reads the mix and the effects */
+    if (EAS_PipelineReady(pEASData, numRequested, offline))
+    {
+        pipelined = EAS_TRUE;
+
+        /* the parse sees the time and the JET state the next frame would have */
+        EAS_AdvanceFrame(pEASData, numRequested);
+#ifdef JET_INTERFACE
+        if (pEASData->jetHandle != NULL)
+        {
+            EAS_TRACE_BEGIN("JET_Process");
+            result = JET_Process(pEASData);
+            EAS_TRACE_END();
+            if (result != EAS_SUCCESS)
+                return result;
+        }
+#endif
+
+        VMInitWorkload(pEASData->pVoiceMgr);
+        pEASData->pPipeline->numSamples = numRequested;
+        pEASData->pPipeline->frames = EAS_BLOCK_FRAMES(pEASData);
+        pEASData->pPipeline->idleFrame = (EAS_BOOL8) idleFrame;
+        EAS_HWRunWorkers(pEASData->pPipeline->workers);
+        pEASData->pPipeline->parsed = EAS_TRUE;
+    }
+    else
+#endif
+    /* now do post-processing */
+    EAS_PostFrame(pEASData, numRequested, idleFrame);
+    *pNumGenerated = numRequested;
+#endif
+
+#ifdef _IDLE_DETECT
+    if (*pNumGenerated > 0)
+        EAS_TrackSilence(pEASData, *pNumGenerated, playing);
+#endif
+
+#ifdef _OUTPUT_RESAMPLER
+    /* convert the frame to the device rate */
+    if ((pEASData->pResampler != NULL) && (*pNumGenerated > 0))
+        *pNumGenerated = EAS_ResamplerProcess(pEASData->pResampler, *pNumGenerated, pOut);
+#endif
+
+#ifdef _METRICS_ENABLED
+    /* stop the post timer */
+    if (pEASData->pMetricsData && !offline)
+        (void)(*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_POST_TIME);
+#endif
+
+#ifdef _CPU_BUDGET
+    /* fit the polyphony of the next frames to the budget, the times are scaled to one frame */
+    if (budget)
+        VMUpdateCPUBudget(pEASData->pVoiceMgr, (EAS_U32) (((EAS_HWGetTime(pEASData->hwInstData) - frameStart) * (EAS_U32) EAS_FRAME_SIZE(pEASData)) / (EAS_U32) numRequested),
+            (EAS_U32) ((renderTime * (EAS_U32) EAS_FRAME_SIZE(pEASData)) / (EAS_U32) numRequested), voicesRendered);
+#endif
+
+    /* advance render time */
+#ifdef _PIPELINED_RENDER
+    if (!pipelined)
+#endif
+    EAS_AdvanceFrame(pEASData, numRequested);
+
+#if 0
+    /* dump workload for debug */
+    if (pEASData->pVoiceMgr->workload)
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "Workload = %d\n", pEASData->pVoiceMgr->workload); */ }
+#endif
+
+#ifdef _METRICS_ENABLED
+    /* stop performance counter */
+    if (pEASData->pMetricsData && !offline)
+    {
+        PERF_TIMER temp;
+        temp = (*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_TOTAL_TIME);
+
+        /* if max render time, record the number of voices and time */
+        if ((*pEASData->pMetricsModule->pfRecordMaxValue)
+            (pEASData->pMetricsData, EAS_PM_MAX_CYCLES, (EAS_U32) temp))
+        {
+            (*pEASData->pMetricsModule->pfRecordValue)(pEASData->pMetricsData, EAS_PM_MAX_CYCLES_VOICES, (EAS_U32) voicesRendered);
+            (*pEASData->pMetricsModule->pfRecordValue)(pEASData->pMetricsData, EAS_PM_MAX_CYCLES_TIME, (EAS_I32) (pEASData->renderTime >> 8));
+        }
+    }
+#endif
+
+#ifdef JET_INTERFACE
+    /* let JET to do its thing */
+#if defined(_LOW_LATENCY) && defined(_PIPELINED_RENDER)
+    if ((pEASData->jetHandle != NULL) && !offline && frameDone && !pipelined)
+#elif defined(_LOW_LATENCY)
+    if ((pEASData->jetHandle != NULL) && !offline && frameDone)
+#elif defined(_PIPELINED_RENDER)
+    if ((pEASData->jetHandle != NULL) && !offline && !pipelined)
+#else
+    if ((pEASData->jetHandle != NULL) && !offline)
+#endif
+    {
+        EAS_TRACE_BEGIN("JET_Process");
+        result = JET_Process(pEASData);
+        EAS_TRACE_END();
+        if (result != EAS_SUCCESS)
+            return result;
+    }
+#endif
+
+#ifdef _DEADLINE_MONITOR
+    if (monitor)
+        EAS_DeadlineCheck(pEASData, &timing, monitorStart, monitorMark, numRequested);
+#endif
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderFrame()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders one frame, locking the instance while a background open is
+ * pending.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  pnNumGenerated  - actual number of samples generated
+ *  offline         - skip the metrics timers and JET processing
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_RenderFrame (S_EAS_DATA *pEASData, EAS_PCM *pOut, EAS_I32 *pNumGenerated, EAS_BOOL offline)
+{
+    EAS_RESULT result;
+
+    EAS_TRACE_BEGIN("EAS_RenderFrame");
+#ifdef _RT_SAFE_RENDER
+    /* debug builds catch allocations and file access from here on */
+    if (pEASData->realtimeRender)
+        EAS_HWBeginRealtime(pEASData->hwInstData);
+#endif
+#ifdef _ASYNC_OPEN
+    /* a background open may be changing the stream and synth tables */
+    if (pEASData->asyncOpens > 0)
+    {
+        EAS_HWLock(pEASData->hwInstData);
+        result = EAS_IntRenderFrame(pEASData, pOut, pNumGenerated, offline);
+        EAS_HWUnlock(pEASData->hwInstData);
+    }
+    else
+#endif
+    result = EAS_IntRenderFrame(pEASData, pOut, pNumGenerated, offline);
+#ifdef _RT_SAFE_RENDER
+    if (pEASData->realtimeRender)
+        EAS_HWEndRealtime(pEASData->hwInstData);
+#endif
+    EAS_TRACE_END();
+    return result;
+}
+
+#ifdef _BLOCK_RENDER
+/*----------------------------------------------------------------------------
+ * EAS_RenderBlockFrames()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the number of frames the next render can synthesize as one
+ * block. The resampler and the PCM cache work a frame at a time, and so
+ * does a stream that is starting or pausing, so that it only waits for
+ * the frame it would wait for in frame mode.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  numRequested    - samples still to be rendered into the caller's buffer
+ *
+ * Outputs:
+ *  frames in the block, at least one
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 EAS_RenderBlockFrames (S_EAS_DATA *pEASData, EAS_I32 numRequested)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    S_EAS_STREAM *pStream;
+    EAS_STATE state;
+    EAS_I32 frames;
+    EAS_INT streamNum;
+
+    frames = numRequested / EAS_FRAME_SIZE(pEASData);
+    if (frames > pEASData->blockFrames)
+        frames = pEASData->blockFrames;
+    if (frames <= 1)
+        return 1;
+
+#ifdef _LOW_LATENCY
+    /* slices are the opposite of blocks */
+    if ((pEASData->slicePos != 0) || (pEASData->sliceSize < EAS_FRAME_SIZE(pEASData)))
+        return 1;
+#endif
+
+#ifdef _OUTPUT_RESAMPLER
+    if (pEASData->pResampler != NULL)
+        return 1;
+#endif
+
+    for (streamNum = 0; streamNum < EAS_STREAM_SLOTS(pEASData); streamNum++)
+    {
+        pStream = &pEASData->streams[streamNum];
+        pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+        if (pParserModule == NULL)
+            continue;
+#ifdef _PCM_CACHE
+        if (pStream->cacheState != PCM_CACHE_OFF)
+            return 1;
+#endif
+        if (((*pParserModule->pfState)(pEASData, pStream->handle, &state) != EAS_SUCCESS) || (state != EAS_STATE_PLAY))
+            return 1;
+    }
+    return frames;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_Render()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parse the Midi data and render PCM audio data.
+ *
+ * Any number of samples may be requested. Whole frames are rendered
+ * directly into the caller's buffer; when the request ends part way
+ * through a frame, the remainder of that frame is held in the carry
+ * buffer and returned first on the next call.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  nNumRequested   - requested num samples to generate
+ *  pnNumGenerated  - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
+{
+    EAS_RESULT result;
+    EAS_I32 count;
+
+    /* assume no samples generated */
+    *pNumGenerated = 0;
+    if (numRequested < 0)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Host requested %ld samples\n", numRequested); */ }
+        return EAS_BUFFER_SIZE_MISMATCH;
+    }
+
+    /* return any samples left over from the last partial frame */
+    if (pEASData->carryCount > 0)
+    {
+#ifdef _HIGH_RES_OUTPUT
+        /* a partial frame from EAS_RenderFormat is held at full precision */
+        if (pEASData->carryWide)
+        {
+            EAS_I32 i;
+            for (i = pEASData->carryOffset * NUM_OUTPUT_CHANNELS; i < (pEASData->carryOffset + pEASData->carryCount) * NUM_OUTPUT_CHANNELS; i++)
+                /*lint -e{704} <avoid divide for performance>*/
+                pEASData->carryBuffer[i] = (EAS_PCM) (pEASData->wideBuffer[i] >> 16);
+            pEASData->carryWide = EAS_FALSE;
+        }
+#endif
+        count = pEASData->carryCount;
+        if (count > numRequested)
+            count = numRequested;
+        EAS_HWMemCpy(pOut, &pEASData->carryBuffer[pEASData->carryOffset * NUM_OUTPUT_CHANNELS],
+            count * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+        pEASData->carryOffset += count;
+        pEASData->carryCount -= count;
+        pOut += count * NUM_OUTPUT_CHANNELS;
+        numRequested -= count;
+        *pNumGenerated += count;
+    }
+
+    /* render whole frames directly into the output buffer */
+    while (numRequested >= EAS_MAX_FRAME_OUTPUT(pEASData))
+    {
+#ifdef _PIPELINED_RENDER
+        pEASData->pipeRemaining = numRequested;
+#endif
+#ifdef _BLOCK_RENDER
+#ifdef _PIPELINED_RENDER
+        /* a frame parsed ahead keeps the block it was parsed for */
+        if ((pEASData->pPipeline != NULL) && pEASData->pPipeline->parsed)
+            pEASData->renderFrames = pEASData->pPipeline->frames;
+        else
+#endif
+        pEASData->renderFrames = EAS_RenderBlockFrames(pEASData, numRequested);
+        result = EAS_RenderFrame(pEASData, pOut, &count, EAS_FALSE);
+        pEASData->renderFrames = 1;
+#else
+        result = EAS_RenderFrame(pEASData, pOut, &count, EAS_FALSE);
+#endif
+#ifdef _PIPELINED_RENDER
+        pEASData->pipeRemaining = 0;
+#endif
+        if (result != EAS_SUCCESS)
+            return result;
+        if (count == 0)
+            return EAS_SUCCESS;
+        pOut += count * NUM_OUTPUT_CHANNELS;
+        numRequested -= count;
+        *pNumGenerated += count;
+    }
+
+    /* render the rest through the carry buffer, keeping what is left over */
+    while (numRequested > 0)
+    {
+#ifdef _PIPELINED_RENDER
+        pEASData->pipeRemaining = numRequested;
+#endif
+        result = EAS_RenderFrame(pEASData, pEASData->carryBuffer, &count, EAS_FALSE);
+#ifdef _PIPELINED_RENDER
+        pEASData->pipeRemaining = 0;
+#endif
+        if (result != EAS_SUCCESS)
+            return result;
+        if (count == 0)
+            return EAS_SUCCESS;
+        if (count > numRequested)
+        {
+            pEASData->carryOffset = numRequested;
+            pEASData->carryCount = count - numRequested;
+#ifdef _HIGH_RES_OUTPUT
+            pEASData->carryWide = EAS_FALSE;
+#endif
+            count = numRequested;
+        }
+        EAS_HWMemCpy(pOut, pEASData->carryBuffer, count * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+        pOut += count * NUM_OUTPUT_CHANNELS;
+        numRequested -= count;
+        *pNumGenerated += count;
+    }
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderRing()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Same as EAS_Render, but writes into a ring buffer, wrapping around at
+ * its end. The part up to the end of the ring and the part from its start
+ * are each rendered with EAS_Render, so a frame that straddles the end is
+ * held in the carry buffer and finished on the second call.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pRing           - ring buffer of ringSize samples
+ *  ringSize        - samples in the ring
+ *  writePos        - sample of the ring written first
+ *  numRequested    - requested num samples to generate
+ *  pNumGenerated   - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderRing (EAS_DATA_HANDLE pEASData, EAS_PCM *pRing, EAS_I32 ringSize, EAS_I32 writePos, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
+{
+    EAS_RESULT result;
+    EAS_I32 count;
+    EAS_I32 generated;
+
+    /* assume no samples generated */
+    *pNumGenerated = 0;
+    if ((writePos < 0) || (writePos >= ringSize) || (numRequested < 0) || (numRequested > ringSize))
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Host requested %ld samples at %ld of a %ld sample ring\n", numRequested, writePos, ringSize); */ }
+        return EAS_BUFFER_SIZE_MISMATCH;
+    }
+
+    /* up to the end of the ring */
+    count = ringSize - writePos;
+    if (count > numRequested)
+        count = numRequested;
+    result = EAS_Render(pEASData, &pRing[writePos * NUM_OUTPUT_CHANNELS], count, pNumGenerated);
+    if ((result != EAS_SUCCESS) || (*pNumGenerated < count) || (count == numRequested))
+        return result;
+
+    /* the rest from the start of the ring */
+    result = EAS_Render(pEASData, pRing, numRequested - count, &generated);
+    *pNumGenerated += generated;
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderFormat()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Same as EAS_Render, but writes the samples in the given format. Each
+ * frame is rendered into wideBuffer at full precision and converted from
+ * there, so the carry of a partial frame is kept in wideBuffer as well.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  format          - E_EAS_PCM_FORMAT
+ *  numRequested    - requested num samples to generate
+ *  pNumGenerated   - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderFormat (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pOut, EAS_I32 format, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
+{
+#ifdef _HIGH_RES_OUTPUT
+    EAS_RESULT result;
+    EAS_U8 *pDst;
+    EAS_I32 sampleSize;
+    EAS_I32 count;
+    EAS_I32 i;
+#endif
+
+    if (format == EAS_PCM_FORMAT_16)
+        return EAS_Render(pEASData, (EAS_PCM*) pOut, numRequested, pNumGenerated);
+
+#ifdef _HIGH_RES_OUTPUT
+    /* assume no samples generated */
+    *pNumGenerated = 0;
+    switch (format)
+    {
+        case EAS_PCM_FORMAT_FLOAT:
+            sampleSize = (EAS_I32) sizeof(float);
+            break;
+        case EAS_PCM_FORMAT_24_PACKED:
+            sampleSize = 3;
+            break;
+        case EAS_PCM_FORMAT_32:
+            sampleSize = (EAS_I32) sizeof(int32_t);
+            break;
+        default:
+            return EAS_ERROR_PARAMETER_RANGE;
+    }
+    if (numRequested < 0)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Host requested %ld samples\n", numRequested); */ }
+        return EAS_BUFFER_SIZE_MISMATCH;
+    }
+
+    /* a partial frame left over from EAS_Render is only 16-bit */
+    if ((pEASData->carryCount > 0) && !pEASData->carryWide)
+    {
+        for (i = pEASData->carryOffset * NUM_OUTPUT_CHANNELS; i < (pEASData->carryOffset + pEASData->carryCount) * NUM_OUTPUT_CHANNELS; i++)
+            pEASData->wideBuffer[i] = (int32_t) pEASData->carryBuffer[i] * 65536;
+        pEASData->carryWide = EAS_TRUE;
+    }
+
+    pDst = (EAS_U8*) pOut;
+    while (numRequested > 0)
+    {
+        if (pEASData->carryCount == 0)
+        {
+            /* the carry buffer is free, use it for the 16-bit output */
+            pEASData->pWideOutput = pEASData->wideBuffer;
+#ifdef _OUTPUT_RESAMPLER
+            if (pEASData->pResampler != NULL)
+                pEASData->pWideOutput = NULL;
+#endif
+            result = EAS_RenderFrame(pEASData, pEASData->carryBuffer, &count, EAS_FALSE);
+            pEASData->pWideOutput = NULL;
+            if (result != EAS_SUCCESS)
+                return result;
+            if (count == 0)
+                return EAS_SUCCESS;
+
+#ifdef _OUTPUT_RESAMPLER
+            /* the resampler works on the 16-bit output */
+            if (pEASData->pResampler != NULL)
+                for (i = 0; i < count * NUM_OUTPUT_CHANNELS; i++)
+                    pEASData->wideBuffer[i] = (int32_t) pEASData->carryBuffer[i] * 65536;
+#endif
+            pEASData->carryOffset = 0;
+            pEASData->carryCount = count;
+            pEASData->carryWide = EAS_TRUE;
+        }
+
+        count = pEASData->carryCount;
+        if (count > numRequested)
+            count = numRequested;
+        EAS_MixEngineConvert(&pEASData->wideBuffer[pEASData->carryOffset * NUM_OUTPUT_CHANNELS], pDst, format, count * NUM_OUTPUT_CHANNELS);
+        pEASData->carryOffset += count;
+        pEASData->carryCount -= count;
+        pDst += count * NUM_OUTPUT_CHANNELS * sampleSize;
+        numRequested -= count;
+        *pNumGenerated += count;
+    }
+
+    return EAS_SUCCESS;
+#else
+    *pNumGenerated = 0;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderStems()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Same as EAS_Render, but also converts the stem mix buffers of each frame
+ * into the caller's stem buffers.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  ppStems         - one buffer per stem, NULL entries are skipped
+ *  numRequested    - requested num samples to generate, whole frames
+ *  pNumGenerated   - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderStems (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_PCM * const *ppStems, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
+{
+#ifdef _STEM_OUTPUT
+    EAS_PCM *pStems[EAS_MAX_STEMS];
+    EAS_RESULT result;
+    EAS_I32 offset;
+    EAS_I32 count;
+    EAS_INT stem;
+
+    /* assume no samples generated */
+    *pNumGenerated = 0;
+    if ((numRequested < 0) || (numRequested % EAS_FRAME_SIZE(pEASData)))
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Host requested %ld samples\n", numRequested); */ }
+        return EAS_BUFFER_SIZE_MISMATCH;
+    }
+
+    /* the stems are only at the synthesis rate, and a partial frame has no stems */
+    if ((pEASData->pVoiceMgr->numStems == 0) || (pEASData->carryCount > 0))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#ifdef _OUTPUT_RESAMPLER
+    if (pEASData->pResampler != NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
+
+    for (offset = 0; offset < numRequested; offset += count)
+    {
+        if ((result = EAS_RenderFrame(pEASData, &pOut[offset * NUM_OUTPUT_CHANNELS], &count, EAS_FALSE)) != EAS_SUCCESS)
+            return result;
+        if (count == 0)
+            break;
+
+        for (stem = 0; stem < pEASData->pVoiceMgr->numStems; stem++)
+            pStems[stem] = (ppStems[stem] != NULL) ? &ppStems[stem][offset * NUM_OUTPUT_CHANNELS] : NULL;
+        EAS_MixEngineStems(pEASData, pStems, count);
+        *pNumGenerated += count;
+    }
+    return EAS_SUCCESS;
+#else
+    *pNumGenerated = 0;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderOffline()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Opens a file, renders it to the end and closes it. Frames are rendered
+ * directly into pBuffer. With a write function, pBuffer is a scratch block
+ * that is passed to the write function each time it fills.
+ *
+ * Inputs:
+ *  pEASData        - pointer to overall EAS data structure
+ *  locator         - file locator
+ *  pfWrite         - write function, or NULL to render into pBuffer
+ *  pUserData       - passed to the write function
+ *  pBuffer         - output buffer
+ *  bufferSize      - size of pBuffer in samples
+ *  pStats          - optional render statistics
+ *
+ * Outputs:
+ *  EAS_BUFFER_FULL if pBuffer filled before the end of the file
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_RenderOffline (S_EAS_DATA *pEASData, EAS_FILE_LOCATOR locator, EAS_RENDER_WRITE_FUNC pfWrite, EAS_VOID_PTR pUserData,
+    EAS_PCM *pBuffer, EAS_I32 bufferSize, S_EAS_RENDER_STATS *pStats)
+{
+    EAS_HANDLE pStream;
+    EAS_RESULT result;
+    EAS_RESULT closeResult;
+    EAS_STATE state;
+    EAS_U32 startTime;
+    EAS_I32 numSamples;
+    EAS_I32 offset;
+    EAS_I32 count;
+
+    startTime = EAS_HWGetTime(pEASData->hwInstData);
+    numSamples = 0;
+
+    if ((result = EAS_OpenFile(pEASData, locator, &pStream)) != EAS_SUCCESS)
+        return result;
+
+    /* drop any partial frame left over from EAS_Render */
+    pEASData->carryCount = 0;
+
+    offset = 0;
+    if ((result = EAS_Prepare(pEASData, pStream)) == EAS_SUCCESS)
+    {
+        for (;;)
+        {
+            /* is playback complete? */
+            if ((result = EAS_State(pEASData, pStream, &state)) != EAS_SUCCESS)
+                break;
+            if (state == EAS_STATE_STOPPED)
+                break;
+            if (state == EAS_STATE_ERROR)
+            {
+                result = EAS_FAILURE;
+                break;
+            }
+
+            /* no room for another frame */
+            if (offset + EAS_MAX_FRAME_OUTPUT(pEASData) > bufferSize)
+            {
+                if (pfWrite == NULL)
+                {
+                    /* fill the end of the caller's buffer with partial frames */
+                    while (offset < bufferSize)
+                    {
+                        if ((result = EAS_RenderFrame(pEASData, pEASData->carryBuffer, &count, EAS_TRUE)) != EAS_SUCCESS)
+                            break;
+                        if (count == 0)
+                            break;
+                        if (count > bufferSize - offset)
+                            count = bufferSize - offset;
+                        EAS_HWMemCpy(&pBuffer[offset * NUM_OUTPUT_CHANNELS], pEASData->carryBuffer, count * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+                        offset += count;
+                        numSamples += count;
+                    }
+                    if (result == EAS_SUCCESS)
+                        result = EAS_BUFFER_FULL;
+                    break;
+                }
+
+                if ((result = pfWrite(pUserData, pBuffer, offset)) != EAS_SUCCESS)
+                    break;
+                offset = 0;
+            }
+
+            if ((result = EAS_RenderFrame(pEASData, &pBuffer[offset * NUM_OUTPUT_CHANNELS], &count, EAS_TRUE)) != EAS_SUCCESS)
+                break;
+            offset += count;
+            numSamples += count;
+        }
+
+        /* write the last block */
+        if ((result == EAS_SUCCESS) && (pfWrite != NULL) && (offset > 0))
+            result = pfWrite(pUserData, pBuffer, offset);
+    }
+
+    closeResult = EAS_CloseFile(pEASData, pStream);
+    if (result == EAS_SUCCESS)
+        result = closeResult;
+
+    if (pStats != NULL)
+    {
+        pStats->numSamples = numSamples;
+        pStats->elapsedTime = EAS_HWGetTime(pEASData->hwInstData) - startTime;
+        if (pStats->elapsedTime > 0)
+            pStats->samplesPerSec = (EAS_I32) (((double) numSamples * 1000000.0) / (double) pStats->elapsedTime);
+        else
+            pStats->samplesPerSec = 0;
+    }
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderFile()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders a whole file faster than real time and passes the PCM data to a
+ * write function in blocks of OFFLINE_RENDER_FRAMES frames.
+ *
+ * Inputs:
+ *  pEASData        - pointer to overall EAS data structure
+ *  locator         - file locator
+ *  pfWrite         - write function
+ *  pUserData       - passed to the write function
+ *  pStats          - optional render statistics
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderFile (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_RENDER_WRITE_FUNC pfWrite, EAS_VOID_PTR pUserData, S_EAS_RENDER_STATS *pStats)
+{
+    EAS_PCM *pBlock;
+    EAS_RESULT result;
+
+    if (pfWrite == NULL)
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    pBlock = EAS_HWMallocCategory(pEASData->hwInstData, OFFLINE_RENDER_FRAMES * EAS_MAX_FRAME_OUTPUT(pEASData) * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM), EAS_MEM_MIX_BUFFERS);
+    if (pBlock == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+
+    result = EAS_RenderOffline(pEASData, locator, pfWrite, pUserData, pBlock, OFFLINE_RENDER_FRAMES * EAS_MAX_FRAME_OUTPUT(pEASData), pStats);
+    EAS_HWFree(pEASData->hwInstData, pBlock);
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderToBuffer()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders a whole file faster than real time into the caller's buffer.
+ *
+ * Inputs:
+ *  pEASData        - pointer to overall EAS data structure
+ *  locator         - file locator
+ *  pBuffer         - output buffer
+ *  bufferSize      - size of the output buffer in samples
+ *  pStats          - optional render statistics
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderToBuffer (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_PCM *pBuffer, EAS_I32 bufferSize, S_EAS_RENDER_STATS *pStats)
+{
+    if ((pBuffer == NULL) || (bufferSize <= 0))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    return EAS_RenderOffline(pEASData, locator, NULL, NULL, pBuffer, bufferSize, pStats);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetPCMCacheSize()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the memory the PCM cache may use, 0 disables it
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  maxSize         - size in bytes
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetPCMCacheSize (EAS_DATA_HANDLE pEASData, EAS_I32 maxSize)
+{
+#ifdef _PCM_CACHE
+    if (maxSize < 0)
+        return EAS_ERROR_PARAMETER_RANGE;
+    if (pEASData->staticMemoryModel)
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+
+    /* streams stop using a disabled cache */
+    pEASData->pcmCache.maxSize = maxSize;
+    if (maxSize == 0)
+        return EAS_StreamCacheFlush(pEASData);
+    EAS_PCMCacheTrim(pEASData->hwInstData, &pEASData->pcmCache, maxSize);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetToneCacheSize()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Enables the cache of compiled ringtones
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  numEntries      - ringtones the cache may keep
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetToneCacheSize (EAS_DATA_HANDLE pEASData, EAS_I32 numEntries)
+{
+#ifdef _RINGTONE_EVENT_CACHE
+    if ((numEntries < 0) || (numEntries > TONE_CACHE_MAX_ENTRIES))
+        return EAS_ERROR_PARAMETER_RANGE;
+    if (pEASData->staticMemoryModel)
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+
+    /* open streams keep their own copy of the list */
+    pEASData->toneCacheSize = numEntries;
+    EAS_ToneCacheTrim(pEASData, numEntries);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+#ifdef _PCM_CACHE
+/*----------------------------------------------------------------------------
+ * EAS_DiscardPCM()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Write function for EAS_PrecacheFile, the audio only goes to the cache
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pUserData, pBuffer, numSamples) not used */
+static EAS_RESULT EAS_DiscardPCM (EAS_VOID_PTR pUserData, const EAS_PCM *pBuffer, EAS_I32 numSamples)
+{
+    return EAS_SUCCESS;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_PrecacheFile()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders a file into the PCM cache without playing it
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  locator         - file locator
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_PrecacheFile (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator)
+{
+#ifdef _PCM_CACHE
+    EAS_PCM *pBlock;
+    EAS_RESULT result;
+    EAS_INT i;
+
+    if (pEASData->pcmCache.maxSize == 0)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+    /* the file is only recorded while nothing else plays */
+    for (i = 0; i < EAS_STREAM_SLOTS(pEASData); i++)
+    {
+#ifdef _ASYNC_OPEN
+        if (pEASData->streams[i].pAsyncOpen != NULL)
+            return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
+        if (pEASData->streams[i].handle != NULL)
+            return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    }
+
+    pBlock = EAS_HWMallocCategory(pEASData->hwInstData, EAS_MAX_FRAME_OUTPUT(pEASData) * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM), EAS_MEM_MIX_BUFFERS);
+    if (pBlock == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+
+    result = EAS_RenderOffline(pEASData, locator, EAS_DiscardPCM, NULL, pBlock, EAS_MAX_FRAME_OUTPUT(pEASData), NULL);
+    EAS_HWFree(pEASData->hwInstData, pBlock);
+    return result;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_GetPCMCacheUsage()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the memory used by the PCM cache
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pSize           - receives the size in bytes
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pEASData) used only with _PCM_CACHE */
+EAS_PUBLIC EAS_RESULT EAS_GetPCMCacheUsage (EAS_DATA_HANDLE pEASData, EAS_I32 *pSize)
+{
+#ifdef _PCM_CACHE
+    *pSize = pEASData->pcmCache.size;
+    return EAS_SUCCESS;
+#else
+    *pSize = 0;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetRenderThreads()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the number of threads used to synthesize voices in EAS_Render.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  numThreads      - number of render threads, including the caller
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetRenderThreads (EAS_DATA_HANDLE pEASData, EAS_I32 numThreads)
+{
+#ifdef _PARALLEL_VOICE_RENDER
+    return VMSetRenderThreads(pEASData, (EAS_INT) numThreads);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+#ifdef _BATCH_RENDER
+/*----------------------------------------------------------------------------
+ * EAS_BatchWorker()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders the share of a thread, then takes items from the other shares
+ *
+ * Inputs:
+ *  pArg            - S_EAS_BATCH
+ *  workerNum       - thread number, 0 is the caller of EAS_RenderBatch
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_BatchWorker (EAS_VOID_PTR pArg, EAS_INT workerNum)
+{
+    S_EAS_BATCH *pBatch;
+    S_EAS_BATCH_ITEM *pItem;
+    EAS_I32 index;
+    EAS_INT share;
+    EAS_INT i;
+
+    pBatch = (S_EAS_BATCH*) pArg;
+    for (i = 0; i < pBatch->numThreads; i++)
+    {
+        share = (workerNum + i) % pBatch->numThreads;
+        for (;;)
+        {
+            /* the items of a share are numThreads apart */
+            index = (EAS_I32) EAS_HWAtomicAdd(&pBatch->next[share], 1) * pBatch->numThreads + share;
+            if (index >= pBatch->numItems)
+                break;
+            pItem = &pBatch->pItems[index];
+            pItem->result = EAS_Render(pItem->pEASData, pItem->pOut, pItem->numRequested, &pItem->numGenerated);
+        }
+    }
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_CreateBatch()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Creates a batch renderer
+ *
+ * Inputs:
+ *  numThreads      - number of threads, including the caller of EAS_RenderBatch
+ *  pBatch          - receives the batch handle
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_CreateBatch (EAS_I32 numThreads, EAS_BATCH_HANDLE *pBatch)
+{
+#ifdef _BATCH_RENDER
+    EAS_HW_DATA_HANDLE hwInstData;
+    S_EAS_BATCH *pNewBatch;
+    EAS_RESULT result;
+
+    *pBatch = NULL;
+    if ((numThreads < 1) || (numThreads > EAS_MAX_BATCH_THREADS))
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    /* the batch is not part of any instance, it has its own host data */
+    if ((result = EAS_HWInit(&hwInstData)) != EAS_SUCCESS)
+        return result;
+    if ((pNewBatch = EAS_HWMalloc(hwInstData, sizeof(S_EAS_BATCH))) == NULL)
+    {
+        (void) EAS_HWShutdown(hwInstData);
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+    EAS_HWMemSet(pNewBatch, 0, sizeof(S_EAS_BATCH));
+    pNewBatch->hwInstData = hwInstData;
+    pNewBatch->numThreads = (EAS_INT) numThreads;
+    if ((result = EAS_HWCreateWorkers(hwInstData, (EAS_INT) numThreads, EAS_BatchWorker, pNewBatch, &pNewBatch->workers)) != EAS_SUCCESS)
+    {
+        EAS_HWFree(hwInstData, pNewBatch);
+        (void) EAS_HWShutdown(hwInstData);
+        return result;
+    }
+    *pBatch = pNewBatch;
+    return EAS_SUCCESS;
+#else
+    *pBatch = NULL;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderBatch()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders every item of a batch on the threads of the batch renderer
+ *
+ * Inputs:
+ *  batch           - handle from EAS_CreateBatch
+ *  pItems          - the instances and their output buffers
+ *  numItems        - number of items
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderBatch (EAS_BATCH_HANDLE batch, S_EAS_BATCH_ITEM *pItems, EAS_I32 numItems)
+{
+#ifdef _BATCH_RENDER
+    EAS_INT i;
+
+    if ((batch == NULL) || (numItems < 0) || ((pItems == NULL) && (numItems > 0)))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    /* the workers see these once they are started */
+    batch->pItems = pItems;
+    batch->numItems = numItems;
+    for (i = 0; i < batch->numThreads; i++)
+        batch->next[i] = 0;
+    EAS_HWRunWorkers(batch->workers);
+    batch->pItems = NULL;
+
+    for (i = 0; i < numItems; i++)
+        if (pItems[i].result != EAS_SUCCESS)
+            return pItems[i].result;
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_DestroyBatch()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Stops the threads of a batch renderer and frees it
+ *
+ * Inputs:
+ *  batch           - handle from EAS_CreateBatch
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_DestroyBatch (EAS_BATCH_HANDLE batch)
+{
+#ifdef _BATCH_RENDER
+    EAS_HW_DATA_HANDLE hwInstData;
+
+    if (batch == NULL)
+        return EAS_ERROR_INVALID_PARAMETER;
+    hwInstData = batch->hwInstData;
+    EAS_HWDestroyWorkers(hwInstData, batch->workers);
+    EAS_HWFree(hwInstData, batch);
+    return EAS_HWShutdown(hwInstData);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+#ifdef _RENDER_AHEAD
+/*----------------------------------------------------------------------------
+ * EAS_RenderAheadCommand()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Applies a command from EAS_PostRenderCommand, on the render thread
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pCommand        - the command
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_RenderAheadCommand (EAS_DATA_HANDLE pEASData, const S_EAS_RENDER_COMMAND *pCommand)
+{
+    switch (pCommand->command)
+    {
+        case EAS_RENDER_CMD_VOLUME:
+            return EAS_SetVolume(pEASData, pCommand->stream, pCommand->param[0]);
+
+        case EAS_RENDER_CMD_LOCATE:
+            return EAS_Locate(pEASData, pCommand->stream, pCommand->param[0], (EAS_BOOL) pCommand->param[1]);
+
+        case EAS_RENDER_CMD_PAUSE:
+            return EAS_Pause(pEASData, pCommand->stream);
+
+        case EAS_RENDER_CMD_RESUME:
+            return EAS_Resume(pEASData, pCommand->stream);
+
+#ifdef JET_INTERFACE
+        case EAS_RENDER_CMD_JET_QUEUE:
+            return JET_QueueSegment(pEASData, (EAS_INT) pCommand->param[0], (EAS_INT) pCommand->param[1], (EAS_INT) pCommand->param[2],
+                (EAS_INT) pCommand->param[3], (EAS_U32) pCommand->param[4], (EAS_U8) pCommand->param[5]);
+
+        case EAS_RENDER_CMD_JET_PLAY:
+            return JET_Play(pEASData);
+
+        case EAS_RENDER_CMD_JET_PAUSE:
+            return JET_Pause(pEASData);
+#endif
+
+        default:
+            return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderAheadThread()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders a chunk whenever the ring has room for one, applying the
+ * commands that are due first
+ *
+ * Inputs:
+ *  pArg            - S_EAS_RENDER_AHEAD
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_RenderAheadThread (EAS_VOID_PTR pArg)
+{
+    S_EAS_RENDER_AHEAD *pAhead;
+    S_EAS_RENDER_COMMAND *pCommand;
+    EAS_RESULT result;
+    EAS_U32 head;
+    EAS_U32 offset;
+    EAS_U32 commandTail;
+    EAS_I32 count;
+    EAS_I32 first;
+
+    pAhead = (S_EAS_RENDER_AHEAD*) pArg;
+    head = pAhead->head;
+    commandTail = pAhead->commandTail;
+    while (!EAS_HWAtomicLoad(&pAhead->stop))
+    {
+        /* wait for the reader to make room for a chunk */
+        if ((head - EAS_HWAtomicLoad(&pAhead->tail)) > pAhead->ringSize - (EAS_U32) pAhead->chunkSize)
+        {
+            EAS_HWSleep(pAhead->pEASData->hwInstData, pAhead->sleepTime);
+            continue;
+        }
+
+        /* apply commands in order until one is not due, the read position of this chunk will be head */
+        while (commandTail != EAS_HWAtomicLoad(&pAhead->commandHead))
+        {
+            pCommand = &pAhead->commands[commandTail & (RENDER_AHEAD_COMMANDS - 1)];
+            if ((EAS_I32) (head - pCommand->sampleTime) < 0)
+                break;
+            if ((result = EAS_RenderAheadCommand(pAhead->pEASData, pCommand)) != EAS_SUCCESS)
+                EAS_HWAtomicStore(&pAhead->commandResult, (EAS_U32) result);
+            EAS_HWAtomicStore(&pAhead->commandTail, ++commandTail);
+        }
+
+        if ((result = EAS_Render(pAhead->pEASData, pAhead->pChunk, pAhead->chunkSize, &count)) != EAS_SUCCESS)
+        {
+            EAS_HWAtomicStore(&pAhead->result, (EAS_U32) result);
+            break;
+        }
+
+        /* copy into the ring, wrapping at the end */
+        offset = head & (pAhead->ringSize - 1);
+        first = (EAS_I32) (pAhead->ringSize - offset);
+        if (first > count)
+            first = count;
+        EAS_HWMemCpy(&pAhead->pRing[offset * NUM_OUTPUT_CHANNELS], pAhead->pChunk, first * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+        if (count > first)
+            EAS_HWMemCpy(pAhead->pRing, &pAhead->pChunk[first * NUM_OUTPUT_CHANNELS], (count - first) * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+        head += (EAS_U32) count;
+        EAS_HWAtomicStore(&pAhead->head, head);
+    }
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_StartRenderAhead()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Allocates the ring and starts the render thread
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  depth           - samples per channel in the ring
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_StartRenderAhead (EAS_DATA_HANDLE pEASData, EAS_I32 depth)
+{
+#ifdef _RENDER_AHEAD
+    S_EAS_RENDER_AHEAD *pAhead;
+    S_EAS_LIB_CONFIG config;
+    EAS_RESULT result;
+    EAS_U32 ringSize;
+
+    if (pEASData->pRenderAhead != NULL)
+        return EAS_ERROR_FEATURE_ALREADY_ACTIVE;
+    if (depth < 0)
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    /* the thread renders a mix buffer at a time and keeps at least two in the ring */
+    if ((result = EAS_GetInstanceConfig(pEASData, &config)) != EAS_SUCCESS)
+        return result;
+    if (depth < config.mixBufferSize * 2)
+        depth = config.mixBufferSize * 2;
+    for (ringSize = 1; ringSize < (EAS_U32) depth; ringSize <<= 1)
+        ;
+
+    pAhead = EAS_HWMallocCategory(pEASData->hwInstData, (EAS_I32) sizeof(S_EAS_RENDER_AHEAD) +
+        ((EAS_I32) ringSize + config.mixBufferSize) * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM), EAS_MEM_MIX_BUFFERS);
+    if (pAhead == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    EAS_HWMemSet(pAhead, 0, sizeof(S_EAS_RENDER_AHEAD));
+    pAhead->pEASData = pEASData;
+    pAhead->pRing = (EAS_PCM*) (pAhead + 1);
+    pAhead->pChunk = &pAhead->pRing[ringSize * NUM_OUTPUT_CHANNELS];
+    pAhead->ringSize = ringSize;
+    pAhead->chunkSize = config.mixBufferSize;
+
+    /* poll four times per mix buffer while the ring is full */
+    pAhead->sleepTime = (EAS_U32) ((config.mixBufferSize * 250000L) / config.sampleRate);
+
+    pEASData->pRenderAhead = pAhead;
+    if ((result = EAS_HWCreateThread(pEASData->hwInstData, EAS_RenderAheadThread, pAhead, &pAhead->thread)) != EAS_SUCCESS)
+    {
+        pEASData->pRenderAhead = NULL;
+        EAS_HWFree(pEASData->hwInstData, pAhead);
+        return result;
+    }
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_StopRenderAhead()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Stops the render thread and frees the ring
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_StopRenderAhead (EAS_DATA_HANDLE pEASData)
+{
+#ifdef _RENDER_AHEAD
+    S_EAS_RENDER_AHEAD *pAhead;
+
+    if ((pAhead = pEASData->pRenderAhead) == NULL)
+        return EAS_SUCCESS;
+    EAS_HWAtomicStore(&pAhead->stop, EAS_TRUE);
+    EAS_HWJoinThread(pEASData->hwInstData, pAhead->thread);
+    pEASData->pRenderAhead = NULL;
+    EAS_HWFree(pEASData->hwInstData, pAhead);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ReadRenderAhead()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Copies rendered audio out of the ring without waiting
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pOut            - output buffer
+ *  numRequested    - samples per channel wanted
+ *  pNumGenerated   - receives the samples per channel copied
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_ReadRenderAhead (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
+{
+#ifdef _RENDER_AHEAD
+    S_EAS_RENDER_AHEAD *pAhead;
+    EAS_U32 tail;
+    EAS_U32 offset;
+    EAS_I32 count;
+    EAS_I32 first;
+
+    *pNumGenerated = 0;
+    if ((pAhead = pEASData->pRenderAhead) == NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    if (numRequested < 0)
+        return EAS_BUFFER_SIZE_MISMATCH;
+
+    /* the reader owns the tail */
+    tail = pAhead->tail;
+    count = (EAS_I32) (EAS_HWAtomicLoad(&pAhead->head) - tail);
+    if (count > numRequested)
+        count = numRequested;
+
+    offset = tail & (pAhead->ringSize - 1);
+    first = (EAS_I32) (pAhead->ringSize - offset);
+    if (first > count)
+        first = count;
+    EAS_HWMemCpy(pOut, &pAhead->pRing[offset * NUM_OUTPUT_CHANNELS], first * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+    if (count > first)
+        EAS_HWMemCpy(&pOut[first * NUM_OUTPUT_CHANNELS], pAhead->pRing, (count - first) * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+    EAS_HWAtomicStore(&pAhead->tail, tail + (EAS_U32) count);
+
+    /* silence what the render thread has not caught up with */
+    if (count < numRequested)
+    {
+        EAS_HWMemSet(&pOut[count * NUM_OUTPUT_CHANNELS], 0, (numRequested - count) * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+        EAS_HWAtomicStore(&pAhead->underruns, pAhead->underruns + (EAS_U32) (numRequested - count));
+    }
+    *pNumGenerated = count;
+    return EAS_SUCCESS;
+#else
+    *pNumGenerated = 0;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PostRenderCommand()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Queues a command for the render thread
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pCommand        - the command
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_PostRenderCommand (EAS_DATA_HANDLE pEASData, const S_EAS_RENDER_COMMAND *pCommand)
+{
+#ifdef _RENDER_AHEAD
+    S_EAS_RENDER_AHEAD *pAhead;
+    EAS_U32 head;
+
+    if ((pAhead = pEASData->pRenderAhead) == NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    if ((pCommand == NULL) || (pCommand->command < 0) || (pCommand->command >= EAS_NUM_RENDER_CMDS))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    /* the poster owns the head */
+    head = pAhead->commandHead;
+    if ((head - EAS_HWAtomicLoad(&pAhead->commandTail)) >= RENDER_AHEAD_COMMANDS)
+        return EAS_ERROR_QUEUE_IS_FULL;
+    pAhead->commands[head & (RENDER_AHEAD_COMMANDS - 1)] = *pCommand;
+    EAS_HWAtomicStore(&pAhead->commandHead, head + 1);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_GetRenderAheadStatus()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reports the read position, the fill of the ring and any errors
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStatus         - receives the status
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetRenderAheadStatus (EAS_DATA_HANDLE pEASData, S_EAS_RENDER_AHEAD_STATUS *pStatus)
+{
+#ifdef _RENDER_AHEAD
+    S_EAS_RENDER_AHEAD *pAhead;
+
+    if ((pAhead = pEASData->pRenderAhead) == NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    pStatus->position = EAS_HWAtomicLoad(&pAhead->tail);
+    pStatus->buffered = (EAS_I32) (EAS_HWAtomicLoad(&pAhead->head) - pStatus->position);
+    pStatus->underruns = EAS_HWAtomicLoad(&pAhead->underruns);
+    pStatus->result = (EAS_RESULT) EAS_HWAtomicLoad(&pAhead->result);
+    pStatus->commandResult = (EAS_RESULT) EAS_HWAtomicLoad(&pAhead->commandResult);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetStemCount()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the number of stems EAS_RenderStems splits the output into.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  numStems        - number of stems, 0 to EAS_MAX_STEMS
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetStemCount (EAS_DATA_HANDLE pEASData, EAS_I32 numStems)
+{
+#ifdef _STEM_OUTPUT
+    return VMSetStemCount(pEASData, (EAS_INT) numStems);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetStreamStem()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Assigns a MIDI channel of a stream to a stem.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to stream
+ *  channel         - MIDI channel, or -1 for every channel
+ *  stem            - stem number
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetStreamStem (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 channel, EAS_I32 stem)
+{
+#ifdef _STEM_OUTPUT
+    S_SYNTH *pSynth;
+
+    if (!EAS_StreamReady(pEASData, pStream))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+    /*lint -e{740} we are cheating by passing a pointer through this interface */
+    if ((EAS_GetStreamParameter(pEASData, pStream, PARSER_DATA_SYNTH_HANDLE, (EAS_I32*) &pSynth) != EAS_SUCCESS) || (pSynth == NULL))
+        return EAS_ERROR_INVALID_PARAMETER;
+    return VMSetChannelStem(pSynth, (EAS_INT) channel, (EAS_INT) stem);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+#ifdef _INSERT_EFFECTS
+/*----------------------------------------------------------------------------
+ * EAS_FindInsertChain()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Finds the insert chain of a MIDI stream, or the master chain
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to stream, or NULL for the master chain
+ *  pppChain        - receives the address of the chain pointer
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_FindInsertChain (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, S_INSERT_CHAIN ***pppChain)
+{
+    S_SYNTH *pSynth;
+
+    if (pStream == NULL)
+    {
+        *pppChain = &pEASData->pMasterInserts;
+        return EAS_SUCCESS;
+    }
+
+    if (pStream->handle == NULL)
+        return EAS_ERROR_INVALID_HANDLE;
+
+    /* streams from EAS_OpenMIDIStream have no parser */
+    if (pStream->pParserModule == NULL)
+        pSynth = ((S_INTERACTIVE_MIDI*) pStream->handle)->pSynth;
+
+    /*lint -e{740} we are cheating by passing a pointer through this interface */
+    else if (EAS_GetStreamParameter(pEASData, pStream, PARSER_DATA_SYNTH_HANDLE, (EAS_I32*) &pSynth) != EAS_SUCCESS)
+        pSynth = NULL;
+
+    if (pSynth == NULL)
+        return EAS_ERROR_INVALID_PARAMETER;
+    *pppChain = &pSynth->pInserts;
+    return EAS_SUCCESS;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_AddInsert()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds an effect to the insert chain of a stream, or to the master chain
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to stream, or NULL for the master chain
+ *  pEffect         - effect interface
+ *  pUserData       - initial instance data of the effect
+ *  pIndex          - receives the index of the insert
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_AddInsert (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, const S_EFFECTS32_INTERFACE *pEffect, EAS_VOID_PTR pUserData, EAS_I32 *pIndex)
+{
+#ifdef _INSERT_EFFECTS
+    S_INSERT_CHAIN **ppChain;
+    EAS_RESULT result;
+
+    if ((result = EAS_FindInsertChain(pEASData, pStream, &ppChain)) != EAS_SUCCESS)
+        return result;
+
+    /* a stream chain mixes the stream's voices in its own buffer */
+    return EAS_InsertAdd(pEASData, ppChain, (pStream != NULL) ? MAX_BLOCK_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS : 0, pEffect, pUserData, pIndex);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RemoveInsert()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Shuts down an insert and removes it from its chain
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to stream, or NULL for the master chain
+ *  index           - index from EAS_AddInsert
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RemoveInsert (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 index)
+{
+#ifdef _INSERT_EFFECTS
+    S_INSERT_CHAIN **ppChain;
+    EAS_RESULT result;
+
+    if ((result = EAS_FindInsertChain(pEASData, pStream, &ppChain)) != EAS_SUCCESS)
+        return result;
+    return EAS_InsertRemove(pEASData, *ppChain, index);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetInsertBypass()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Bypasses an insert, or puts it back in the chain
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to stream, or NULL for the master chain
+ *  index           - index from EAS_AddInsert
+ *  bypass          - EAS_TRUE to bypass the insert
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetInsertBypass (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 index, EAS_BOOL bypass)
+{
+#ifdef _INSERT_EFFECTS
+    S_INSERT_CHAIN **ppChain;
+    EAS_RESULT result;
+
+    if ((result = EAS_FindInsertChain(pEASData, pStream, &ppChain)) != EAS_SUCCESS)
+        return result;
+    return EAS_InsertBypass(*ppChain, index, bypass);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetInsertParameter()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Passes a parameter to an insert
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to stream, or NULL for the master chain
+ *  index           - index from EAS_AddInsert
+ *  param           - parameter number
+ *  value           - new value
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetInsertParameter (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 index, EAS_I32 param, EAS_I32 value)
+{
+#ifdef _INSERT_EFFECTS
+    S_INSERT_CHAIN **ppChain;
+    S_INSERT_EFFECT *pInsert;
+    EAS_RESULT result;
+
+    if ((result = EAS_FindInsertChain(pEASData, pStream, &ppChain)) != EAS_SUCCESS)
+        return result;
+    if ((pInsert = EAS_InsertGet(*ppChain, index)) == NULL)
+        return EAS_ERROR_PARAMETER_RANGE;
+    if (pInsert->effect->pFSetParam == NULL)
+        return EAS_ERROR_NOT_IMPLEMENTED;
+    return (*pInsert->effect->pFSetParam)(pInsert->effectData, param, value);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_GetInsertParameter()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reads a parameter of an insert
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to stream, or NULL for the master chain
+ *  index           - index from EAS_AddInsert
+ *  param           - parameter number
+ *  pValue          - receives the value
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetInsertParameter (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 index, EAS_I32 param, EAS_I32 *pValue)
+{
+#ifdef _INSERT_EFFECTS
+    S_INSERT_CHAIN **ppChain;
+    S_INSERT_EFFECT *pInsert;
+    EAS_RESULT result;
+
+    if ((result = EAS_FindInsertChain(pEASData, pStream, &ppChain)) != EAS_SUCCESS)
+        return result;
+    if ((pInsert = EAS_InsertGet(*ppChain, index)) == NULL)
+        return EAS_ERROR_PARAMETER_RANGE;
+    if (pInsert->effect->pFGetParam == NULL)
+        return EAS_ERROR_NOT_IMPLEMENTED;
+    return (*pInsert->effect->pFGetParam)(pInsert->effectData, param, pValue);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_LoadSoundLibrary()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Loads a wavetable sound library file to use in place of the built-in
+ * library.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  locator         - sound library file
+ *  ppLib           - receives the sound library handle
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_LoadSoundLibrary (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_SNDLIB_HANDLE *ppLib)
+{
+#ifdef _EXTERNAL_SOUNDBANK
+    return EAS_SoundbankLoad(pEASData->hwInstData, locator, ppLib);
+#else
+    *ppLib = NULL;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetSoundLibrary()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Selects the sound library for a stream, or for streams opened later
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  streamHandle    - stream, or NULL for streams opened later
+ *  pLib            - sound library, NULL for the built-in library
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetSoundLibrary (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_SNDLIB_HANDLE pLib)
+{
+#ifdef _EXTERNAL_SOUNDBANK
+    S_SYNTH *pSynth;
+#ifdef _PCM_CACHE
+    EAS_RESULT result;
+#endif
+
+    if (streamHandle == NULL)
+    {
+#ifdef _PCM_CACHE
+        /* the cached audio was rendered with the old library */
+        if ((result = EAS_StreamCacheFlush(pEASData)) != EAS_SUCCESS)
+            return result;
+#endif
+        return VMSetGlobalEASLib(pEASData->pVoiceMgr, pLib);
+    }
+
+    if (!EAS_StreamReady(pEASData, streamHandle))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+#ifdef _PCM_CACHE
+    if ((result = EAS_StreamCacheSetParam(pEASData, streamHandle, PARSER_DATA_EAS_LIBRARY, 0)) != EAS_SUCCESS)
+        return result;
+#endif
+
+    /*lint -e{740} we are cheating by passing a pointer through this interface */
+    if ((EAS_GetStreamParameter(pEASData, streamHandle, PARSER_DATA_SYNTH_HANDLE, (EAS_I32*) &pSynth) != EAS_SUCCESS) || (pSynth == NULL))
+        return EAS_ERROR_INVALID_PARAMETER;
+    return VMChangeEASLib(pEASData->pVoiceMgr, pSynth, pLib);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_UnloadSoundLibrary()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees a library loaded by EAS_LoadSoundLibrary
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pLib            - sound library
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_UnloadSoundLibrary (EAS_DATA_HANDLE pEASData, EAS_SNDLIB_HANDLE pLib)
+{
+#ifdef _EXTERNAL_SOUNDBANK
+    EAS_INT i;
+
+    if ((pLib == NULL) || (pLib == pEASData->pSoundLibrary))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    /* refuse while any synthesizer could still use it */
+    if (pEASData->pVoiceMgr->pGlobalEAS == pLib)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    for (i = 0; i < MAX_VIRTUAL_SYNTHESIZERS; i++)
+        if ((pEASData->pVoiceMgr->pSynth[i] != NULL) && (pEASData->pVoiceMgr->pSynth[i]->pEAS == pLib))
+            return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+    EAS_SoundbankUnload(pEASData->hwInstData, pLib);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_WriteSoundLibrary()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Writes a sound library in the file format read by EAS_LoadSoundLibrary
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pLib            - sound library, NULL for the built-in library
+ *  pBuffer         - receives the file, or NULL for the size only
+ *  bufferSize      - size of pBuffer in bytes
+ *  pSize           - receives the size of the file in bytes
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_WriteSoundLibrary (EAS_DATA_HANDLE pEASData, EAS_SNDLIB_HANDLE pLib, EAS_VOID_PTR pBuffer, EAS_I32 bufferSize, EAS_I32 *pSize)
+{
+#ifdef _EXTERNAL_SOUNDBANK
+    if (pLib == NULL)
+        pLib = &easSoundLib;
+    return EAS_SoundbankWrite(pLib, pBuffer, bufferSize, pSize);
+#else
+    *pSize = 0;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetCPUBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the time each frame may take to render.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  budget          - microseconds per frame, 0 for no limit
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetCPUBudget (EAS_DATA_HANDLE pEASData, EAS_I32 budget)
+{
+#ifdef _CPU_BUDGET
+    return VMSetCPUBudget(pEASData->pVoiceMgr, budget);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetDeadlineCallback()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the time each frame may take and the function called when one
+ * takes longer.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  budget          - microseconds per frame, 0 to stop timing
+ *  pfCallback      - function called for each late frame
+ *  pUserData       - passed to the callback
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetDeadlineCallback (EAS_DATA_HANDLE pEASData, EAS_I32 budget, EAS_DEADLINE_CALLBACK pfCallback, EAS_VOID_PTR pUserData)
+{
+#ifdef _DEADLINE_MONITOR
+    if (budget < 0)
+        return EAS_ERROR_PARAMETER_RANGE;
+    if ((budget != 0) && (pfCallback == NULL))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    /* the callback is cleared first so a render never sees half of the change */
+    pEASData->pfDeadlineCallback = NULL;
+    pEASData->deadlineBudget = (EAS_U32) budget;
+    pEASData->pDeadlineUserData = pUserData;
+    if (budget != 0)
+        pEASData->pfDeadlineCallback = pfCallback;
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetParseLimits()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the bounds on the work of one parse, see eas.h.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pLimits         - the limits, NULL to remove them
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetParseLimits (EAS_DATA_HANDLE pEASData, const S_EAS_PARSE_LIMITS *pLimits)
+{
+#ifdef _PARSE_LIMITS
+    if (pLimits == NULL)
+    {
+        EAS_HWMemSet(&pEASData->parseLimits, 0, sizeof(pEASData->parseLimits));
+        return EAS_SUCCESS;
+    }
+    if ((pLimits->maxEvents < 0) || (pLimits->maxNodes < 0) || (pLimits->maxTime < 0))
+        return EAS_ERROR_PARAMETER_RANGE;
+    pEASData->parseLimits = *pLimits;
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+#ifdef _PARSE_LIMITS
+/*----------------------------------------------------------------------------
+ * EAS_ParseBudgetStart()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Starts counting the work of a parse against the limits of the instance.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pBudget         - work done by this parse
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_ParseBudgetStart (S_EAS_DATA *pEASData, S_PARSE_BUDGET *pBudget)
+{
+    pBudget->numEvents = 0;
+    pBudget->clockCount = PARSE_BUDGET_CLOCK_EVENTS;
+    pBudget->startTime = 0;
+    if (pEASData->parseLimits.maxTime != 0)
+        pBudget->startTime = EAS_HWGetTime(pEASData->hwInstData);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ParseBudgetCharge()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Charges one event to a parse. The clock is read once every
+ * PARSE_BUDGET_CLOCK_EVENTS events, so a slow event can overrun the time
+ * limit by that many events.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pBudget         - work done by this parse
+ *
+ * Outputs:
+ *  EAS_ERROR_PARSE_LIMIT once the parse has exceeded a limit
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_ParseBudgetCharge (S_EAS_DATA *pEASData, S_PARSE_BUDGET *pBudget)
+{
+    pBudget->numEvents++;
+    if ((pEASData->parseLimits.maxEvents != 0) && (pBudget->numEvents > (EAS_U32) pEASData->parseLimits.maxEvents))
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Parse aborted after %u events\n", pBudget->numEvents); */ }
+        return EAS_ERROR_PARSE_LIMIT;
+    }
+    if ((pEASData->parseLimits.maxTime != 0) && (--pBudget->clockCount == 0))
+    {
+        pBudget->clockCount = PARSE_BUDGET_CLOCK_EVENTS;
+        if ((EAS_HWGetTime(pEASData->hwInstData) - pBudget->startTime) > (EAS_U32) pEASData->parseLimits.maxTime * 1000)
+        {
+            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "Parse aborted after %d msecs\n", pEASData->parseLimits.maxTime); */ }
+            return EAS_ERROR_PARSE_LIMIT;
+        }
+    }
+    return EAS_SUCCESS;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_GetPolyphonyLimit()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the number of voices the instance currently allows.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pPolyphony      - receives the voice limit
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetPolyphonyLimit (EAS_DATA_HANDLE pEASData, EAS_I32 *pPolyphony)
+{
+    *pPolyphony = pEASData->pVoiceMgr->maxPolyphony;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetInterpolation()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Selects the wavetable interpolator.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  mode            - E_EAS_INTERPOLATION
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetInterpolation (EAS_DATA_HANDLE pEASData, EAS_I32 mode)
+{
+#ifdef _CUBIC_INTERPOLATION
+    if ((mode < EAS_INTERPOLATION_LINEAR) || (mode > EAS_INTERPOLATION_ADAPTIVE))
+        return EAS_ERROR_PARAMETER_RANGE;
+#ifdef _PCM_CACHE
+    /* the cached audio was rendered with the old interpolator */
+    if (mode != pEASData->pVoiceMgr->interpolation)
+    {
+        EAS_RESULT result;
+        if ((result = EAS_StreamCacheFlush(pEASData)) != EAS_SUCCESS)
+            return result;
+    }
+#endif
+    pEASData->pVoiceMgr->interpolation = mode;
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetSynthEngine()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Selects the engine of the MIDI channels left at the default.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  engine          - EAS_SYNTH_ENGINE_WAVETABLE or EAS_SYNTH_ENGINE_FM
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetSynthEngine (EAS_DATA_HANDLE pEASData, EAS_I32 engine)
+{
+#ifdef _FM_FALLBACK
+    if ((engine < EAS_SYNTH_ENGINE_WAVETABLE) || (engine > EAS_SYNTH_ENGINE_FM))
+        return EAS_ERROR_PARAMETER_RANGE;
+#ifdef _PCM_CACHE
+    /* the cached audio was rendered by the other engine */
+    if (engine != pEASData->pVoiceMgr->synthEngine)
+    {
+        EAS_RESULT result;
+        if ((result = EAS_StreamCacheFlush(pEASData)) != EAS_SUCCESS)
+            return result;
+    }
+#endif
+    VMSetSynthEngine(pEASData->pVoiceMgr, (EAS_INT) engine);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetStreamEngine()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Selects the engine of a MIDI channel of a stream.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pStream         - handle to stream
+ *  channel         - MIDI channel, or -1 for every channel
+ *  engine          - E_EAS_SYNTH_ENGINE
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetStreamEngine (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 channel, EAS_I32 engine)
+{
+#ifdef _FM_FALLBACK
+    S_SYNTH *pSynth;
+#ifdef _PCM_CACHE
+    EAS_RESULT result;
+#endif
+
+    if (!EAS_StreamReady(pEASData, pStream))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    if ((engine < EAS_SYNTH_ENGINE_DEFAULT) || (engine > EAS_SYNTH_ENGINE_FM) || (channel < -1) || (channel >= NUM_SYNTH_CHANNELS))
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    /*lint -e{740} we are cheating by passing a pointer through this interface */
+    if ((EAS_GetStreamParameter(pEASData, pStream, PARSER_DATA_SYNTH_HANDLE, (EAS_I32*) &pSynth) != EAS_SUCCESS) || (pSynth == NULL))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+#ifdef _PCM_CACHE
+    /* the stream no longer sounds like the cached audio of its file */
+    if (pStream->cacheState == PCM_CACHE_IDLE)
+        pStream->cacheState = PCM_CACHE_OFF;
+    if ((result = EAS_StreamCacheLeave(pEASData, pStream, EAS_TRUE)) != EAS_SUCCESS)
+        return result;
+#endif
+    VMSetChannelEngine(pEASData->pVoiceMgr, pSynth, (EAS_INT) channel, (EAS_INT) engine);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetRenderBlock()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the number of frames EAS_Render synthesizes per block.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  frames          - frames per block, 1 to MAX_RENDER_BLOCK_FRAMES
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetRenderBlock (EAS_DATA_HANDLE pEASData, EAS_I32 frames)
+{
+#ifdef _BLOCK_RENDER
+    if ((frames < 1) || (frames > MAX_RENDER_BLOCK_FRAMES))
+        return EAS_ERROR_PARAMETER_RANGE;
+    pEASData->blockFrames = frames;
+    return EAS_SUCCESS;
+#else
+    if (frames == 1)
+        return EAS_SUCCESS;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetRenderSlice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the number of samples EAS_Render synthesizes per slice of a frame.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  samples         - the frame size, or the frame size divided by 2 or 4
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetRenderSlice (EAS_DATA_HANDLE pEASData, EAS_I32 samples)
+{
+#ifdef _LOW_LATENCY
+    EAS_I32 shift;
+
+    for (shift = 0; shift <= MAX_RENDER_SLICE_SHIFT; shift++)
+        if (samples == (EAS_FRAME_SIZE(pEASData) >> shift))
+            break;
+    if (shift > MAX_RENDER_SLICE_SHIFT)
+        return EAS_ERROR_PARAMETER_RANGE;
+
+#ifdef _OUTPUT_RESAMPLER
+    /* the resampler converts whole frames */
+    if ((pEASData->pResampler != NULL) && (shift != 0))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
+
+    /* a frame already started finishes with the new slice size */
+    pEASData->sliceSize = samples;
+    return EAS_SUCCESS;
+#else
+    if (samples == EAS_FRAME_SIZE(pEASData))
+        return EAS_SUCCESS;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetFrameBuffer()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Attaches the frame buffer shared with the off-chip synthesizer.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pFrameBuffer    - the frame buffer, or NULL to detach it
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pFrameBuffer) used only with _SPLIT_ARCHITECTURE */
+EAS_PUBLIC EAS_RESULT EAS_SetFrameBuffer (EAS_DATA_HANDLE pEASData, EAS_FRAME_BUFFER_HANDLE pFrameBuffer)
+{
+#ifdef _SPLIT_ARCHITECTURE
+    EAS_INT i;
+
+    /* the engine has no state for voices started before it was attached */
+    for (i = 0; i < VOICE_MASK_WORDS; i++)
+        if (pEASData->pVoiceMgr->activeVoiceMask[i])
+            return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+    pEASData->pVoiceMgr->pFrameBuffer = pFrameBuffer;
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_DrainDiagnostics()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Logs the diagnostics posted by the render path since the last call.
+ *
+ * Inputs:
+ *  pfCallback      - receives each message, or NULL for the Android log
+ *  pUserData       - passed to the callback
+ *  pNumEvents      - receives the number of events drained, may be NULL
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pfCallback, pUserData) used only with _DIAG_RING */
+EAS_PUBLIC EAS_RESULT EAS_DrainDiagnostics (EAS_DIAG_CALLBACK pfCallback, EAS_VOID_PTR pUserData, EAS_I32 *pNumEvents)
+{
+#ifdef _DIAG_RING
+    return EAS_DiagDrain(pfCallback, pUserData, pNumEvents);
+#else
+    if (pNumEvents != NULL)
+        *pNumEvents = 0;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetRealtimeRender()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Makes EAS_Render safe to call from a realtime audio thread
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  enable          - EAS_TRUE for realtime rendering
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pEASData, enable) used only with _RT_SAFE_RENDER */
+EAS_PUBLIC EAS_RESULT EAS_SetRealtimeRender (EAS_DATA_HANDLE pEASData, EAS_BOOL enable)
+{
+#if defined(_RT_SAFE_RENDER) && (!defined(JET_INTERFACE) || defined(_JET_DYNAMIC_QUEUE))
+    EAS_INT i;
+
+    /* files opened before the switch are not in memory */
+    for (i = 0; i < EAS_STREAM_SLOTS(pEASData); i++)
+    {
+#ifdef _ASYNC_OPEN
+        if (pEASData->streams[i].pAsyncOpen != NULL)
+            return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
+        if (pEASData->streams[i].handle != NULL)
+            return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    }
+#ifdef JET_INTERFACE
+    if ((pEASData->jetHandle != NULL) && (pEASData->jetHandle->jetFileHandle != NULL))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
+
+    pEASData->realtimeRender = (EAS_BOOL8) (enable ? EAS_TRUE : EAS_FALSE);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetIdleMode()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Zero fills the output of idle frames instead of post-processing them
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  skipIdle        - EAS_TRUE to zero fill idle frames
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pEASData, skipIdle) used only with _IDLE_DETECT */
+EAS_PUBLIC EAS_RESULT EAS_SetIdleMode (EAS_DATA_HANDLE pEASData, EAS_BOOL skipIdle)
+{
+#ifdef _IDLE_DETECT
+    pEASData->skipIdle = (EAS_BOOL8) (skipIdle ? EAS_TRUE : EAS_FALSE);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetPipelinedRender()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses the next frame on a worker thread during the post-processing of
+ * the current one
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  enable          - EAS_TRUE to pipeline the render
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pEASData, enable) used only with _PIPELINED_RENDER */
+EAS_PUBLIC EAS_RESULT EAS_SetPipelinedRender (EAS_DATA_HANDLE pEASData, EAS_BOOL enable)
+{
+#ifdef _PIPELINED_RENDER
+    S_EAS_PIPELINE *pPipeline;
+    EAS_RESULT result;
+
+    /* a pipeline that is stopped has no frame parsed ahead, EAS_Render consumes it within the call */
+    if (!enable)
+    {
+        if ((pPipeline = pEASData->pPipeline) == NULL)
+            return EAS_SUCCESS;
+        pEASData->pPipeline = NULL;
+        EAS_HWDestroyWorkers(pEASData->hwInstData, pPipeline->workers);
+        EAS_HWFree(pEASData->hwInstData, pPipeline);
+        return EAS_SUCCESS;
+    }
+    if (pEASData->pPipeline != NULL)
+        return EAS_SUCCESS;
+
+    pPipeline = EAS_HWMallocCategory(pEASData->hwInstData, (EAS_I32) sizeof(S_EAS_PIPELINE), EAS_MEM_MIX_BUFFERS);
+    if (pPipeline == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    EAS_HWMemSet(pPipeline, 0, sizeof(S_EAS_PIPELINE));
+    pEASData->pPipeline = pPipeline;
+    if ((result = EAS_HWCreateWorkers(pEASData->hwInstData, 2, EAS_PipelineWorker, pEASData, &pPipeline->workers)) != EAS_SUCCESS)
+    {
+        pEASData->pPipeline = NULL;
+        EAS_HWFree(pEASData->hwInstData, pPipeline);
+        return result;
+    }
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_GetSilence()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reports whether the last frame was silent and the instance is idle
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pSilent         - receives EAS_TRUE if the last frame was silent
+ *  pIdle           - receives EAS_TRUE if the instance is idle, may be NULL
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pEASData) used only with _IDLE_DETECT */
+EAS_PUBLIC EAS_RESULT EAS_GetSilence (EAS_DATA_HANDLE pEASData, EAS_BOOL *pSilent, EAS_BOOL *pIdle)
+{
+#ifdef _IDLE_DETECT
+    *pSilent = (EAS_BOOL) pEASData->silentFrame;
+    if (pIdle != NULL)
+        *pIdle = (EAS_BOOL) ((pEASData->silentSamples >= EAS_IDLE_SAMPLES) && !EAS_SoundPlaying(pEASData));
+    return EAS_SUCCESS;
+#else
+    *pSilent = EAS_FALSE;
+    if (pIdle != NULL)
+        *pIdle = EAS_FALSE;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+#ifdef JET_INTERFACE
+/*----------------------------------------------------------------------------
+ * EAS_SetTransposition)
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the key tranposition for the synthesizer. Transposes all
+ * melodic instruments by the specified amount. Range is limited
+ * to +/-12 semitones.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  handle          - handle to stream
+ *  transposition   - +/-12 semitones
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetTransposition (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 transposition)
+{
+
+    /* check range */
+    if ((transposition < -12) || (transposition > 12))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    if (!EAS_StreamReady(pEASData, pStream))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    return EAS_IntSetStrmParam(pEASData, pStream, PARSER_DATA_TRANSPOSITION, transposition);
+}
+#endif
+
+#ifdef _SAMPLE_ACCURATE_EVENTS
+/*----------------------------------------------------------------------------
+ * EAS_SetEventOffset()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Tells the voice manager where in the frame being parsed the next event
+ * falls, so that notes it starts begin on that sample.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pStream         - stream being parsed, its time is the start of the frame
+ *  time            - event time in milliseconds
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_SetEventOffset (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream, EAS_U32 time)
+{
+    EAS_I32 offset;
+
+    /* events that are late, e.g. after a workload abort, play at the start */
+    offset = (EAS_I32) ((time << 8) - pStream->time);
+    if ((offset <= 0) || (pStream->frameLength == 0))
+        offset = 0;
+
+    /* frame length includes the playback rate */
+    else
+    {
+        offset = (EAS_I32) (((EAS_U32) offset * EAS_FRAME_SIZE(pEASData)) / pStream->frameLength);
+        if (offset >= EAS_BLOCK_SIZE(pEASData))
+            offset = EAS_BLOCK_SIZE(pEASData) - 1;
+    }
+    pEASData->pVoiceMgr->eventOffset = offset;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_ParseEvents()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parse events in the current streams until the desired time is reached.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  endTime         - stop parsing if this time is reached
+ *  parseMode       - play, locate, or metadata
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_ParseEvents (S_EAS_DATA *pEASData, EAS_HANDLE pStream, EAS_U32 endTime, EAS_INT parseMode)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_RESULT result;
+    EAS_I32 parserState;
+    EAS_BOOL done;
+    EAS_INT yieldCount = YIELD_EVENT_COUNT;
+    EAS_U32 time = 0;
+
+    // This constant is the maximum number of events that can be processed in a single time slice.
+    // A typical ringtone will contain a few events per time slice.
+    // Extremely dense ringtones might go up to 50 events.
+    // If we see this many events then the file is probably stuck in an infinite loop
+    // and should be aborted.
+    static const EAS_INT MAX_EVENT_COUNT = 100000;
+    EAS_INT eventCount = 0;
+#ifdef _PARSE_LIMITS
+    S_PARSE_BUDGET budget;
+
+    EAS_ParseBudgetStart(pEASData, &budget);
+#endif
+
+#ifdef _COALESCE_CONTROLLERS
+    pEASData->parseEndTime = endTime;
+#endif
+
+    /* does this parser have a time function? */
+    pParserModule = pStream->pParserModule;
+    if (pParserModule->pfTime == NULL)
+    {
+        /* check state */
+        if ((result = (*pParserModule->pfState)(pEASData, pStream->handle, &parserState)) != EAS_SUCCESS)
+            return result;
+        /* if play state, advance time */
+        if ((parserState >= EAS_STATE_READY) && (parserState <= EAS_STATE_PAUSING))
+            pStream->time += pStream->frameLength * (EAS_U32) EAS_BLOCK_FRAMES(pEASData);
+        done = EAS_TRUE;
+    }
+
+    /* assume we're not done, in case we abort out */
+    else
+    {
+        pStream->streamFlags &= ~STREAM_FLAGS_PARSED;
+        done = EAS_FALSE;
+    }
+
+    while (!done)
+    {
+
+        /* check for stopped state */
+        if ((result = (*pParserModule->pfState)(pEASData, pStream->handle, &parserState)) != EAS_SUCCESS)
+            return result;
+        if (parserState > EAS_STATE_PLAY)
+        {
+            /* save current time if we're not in play mode */
+            if (parseMode != eParserModePlay)
+                pStream->time = time << 8;
+            done = EAS_TRUE;
+            break;
+        }
+
+        /* get the next event time */
+        if (pParserModule->pfTime)
+        {
+            if ((result = (*pParserModule->pfTime)(pEASData, pStream->handle, &time)) != EAS_SUCCESS)
+                return result;
+
+            /* if next event is within this frame, parse it */
+            if (time < (endTime >> 8))
+            {
+
+#ifdef _SAMPLE_ACCURATE_EVENTS
+                /* convert the event time to a sample offset in the frame */
+                if (parseMode == eParserModePlay)
+                    EAS_SetEventOffset(pEASData, pStream, time);
+#endif
+
+#if defined(JET_INTERFACE) && defined(_JET_TIMED_COMMANDS)
+                /* JET mute changes and clip triggers due by this event take effect first */
+                if ((parseMode == eParserModePlay) && (pEASData->jetHandle != NULL) && (pEASData->jetHandle->numTimedCommands != 0))
+                {
+#ifdef _SAMPLE_ACCURATE_EVENTS
+                    JET_EventTime(pEASData, pStream, pEASData->sampleTime + (EAS_U32) pEASData->pVoiceMgr->eventOffset);
+#else
+                    JET_EventTime(pEASData, pStream, pEASData->sampleTime);
+#endif
+                }
+#endif
+
+                /* parse the next event */
+                if (pParserModule->pfEvent) {
+                    if ((result = (*pParserModule->pfEvent)(pEASData, pStream->handle, parseMode))
+                            != EAS_SUCCESS) {
+                        EAS_DIAG_POST(eDiagParseError, result);
+                        return result;
+                    }
+                }
+
+#ifdef _PARSE_LIMITS
+                if ((result = EAS_ParseBudgetCharge(pEASData, &budget)) != EAS_SUCCESS)
+                    return result;
+#endif
+
+                // An infinite loop within a ringtone file can cause this function
+                // to loop forever.  Try to detect that and return an error.
+                // Only check when playing. Otherwise a very large file could be rejected
+                // when scanning the entire file in a single call to this function.
+                // OTA files will only do infinite loops when in eParserModePlay.
+                if (++eventCount >= MAX_EVENT_COUNT && parseMode == eParserModePlay) {
+                    EAS_DIAG_POST(eDiagEventLimit, eventCount);
+                    return EAS_ERROR_FILE_POS;
+                }
+            }
+
+            /* no more events in this frame, advance time */
+            else
+            {
+                pStream->time = endTime;
+                done = EAS_TRUE;
+            }
+        }
+
+        /* check for max workload exceeded */
+        if ((pEASData->pVoiceMgr != NULL) && VMCheckWorkload(pEASData->pVoiceMgr))
+        {
+            /* stop even though we may not have parsed
+             * all the events in this frame. The parser will try to
+             * catch up on the next frame.
+             */
+            break;
+        }
+
+        /* give host a chance for an early abort */
+        if (--yieldCount == 0)
+        {
+            if (EAS_HWYield(pEASData->hwInstData))
+                break;
+            yieldCount = YIELD_EVENT_COUNT;
+        }
+    }
+
+#ifdef _SAMPLE_ACCURATE_EVENTS
+    /* anything else happens at the start of the frame */
+    if (pEASData->pVoiceMgr != NULL)
+        pEASData->pVoiceMgr->eventOffset = 0;
+#endif
+
+    /* if no early abort, parsing is complete for this frame */
+    if (done)
+        pStream->streamFlags |= STREAM_FLAGS_PARSED;
+
+#ifdef _LOOKAHEAD_PREFETCH
+    /* let the parser load the samples of the next frame while this one renders */
+    if (done && (parseMode == eParserModePlay) && (pParserModule->pfSetData != NULL))
+        (void) (*pParserModule->pfSetData)(pEASData, pStream->handle, PARSER_DATA_PREFETCH_NOTES,
+            (EAS_I32) (endTime + pStream->frameLength * (EAS_U32) EAS_BLOCK_FRAMES(pEASData)));
+#endif
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ParseMetaData()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ *
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - file or stream handle
+ * playLength       - pointer to variable to store the play length (in msecs)
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *                  - resets the parser to the start of the file
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_ParseMetaData (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 *playLength)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_RESULT result;
+    EAS_STATE state;
+
+    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+    if (pParserModule == NULL)
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+
+    /* check parser state */
+    if ((result = (*pParserModule->pfState)(pEASData, pStream->handle, &state)) != EAS_SUCCESS)
+        return result;
+    if (state >= EAS_STATE_OPEN)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+#ifdef _PCM_CACHE
+    /* the stream is left at the start of the file */
+    if ((result = EAS_StreamCacheLeave(pEASData, pStream, EAS_FALSE)) != EAS_SUCCESS)
+        return result;
+#endif
+
+    /* if parser has metadata function, use that */
+    if (pParserModule->pfGetMetaData != NULL)
+    {
+        if ((result = pParserModule->pfGetMetaData(pEASData, pStream->handle, playLength)) != EAS_SUCCESS)
+            return result;
+
+        /* leave the stream as parsing the file to the end would */
+        pStream->time = 0;
+        pStream->streamFlags |= STREAM_FLAGS_PARSED;
+        return EAS_SUCCESS;
+    }
+
+    /* reset the parser to the beginning */
+    if ((result = (*pParserModule->pfReset)(pEASData, pStream->handle)) != EAS_SUCCESS)
+        return result;
+
+    /* parse the file to end */
+    pStream->time = 0;
+    if (pEASData->pVoiceMgr != NULL)
+        VMInitWorkload(pEASData->pVoiceMgr);
+    if ((result = EAS_ParseEvents(pEASData, pStream, 0x7fffffff, eParserModeMetaData)) != EAS_SUCCESS)
+        return result;
+
+    /* get the parser time */
+    if ((result = EAS_GetLocation(pEASData, pStream, playLength)) != EAS_SUCCESS)
+        return result;
+
+    /* reset the parser to the beginning */
+    pStream->time = 0;
+    return (*pParserModule->pfReset)(pEASData, pStream->handle);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ProbeFile()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the file type, play length and metadata of a file without an
+ * EAS_Init instance
+ *
+ * Inputs:
+ * locator          - pointer to filename or other locating information
+ * cbFunc           - optional metadata callback
+ * metaDataBuffer   - pointer to metadata buffer
+ * metaDataBufSize  - maximum size of the metadata buffer
+ * pUserData        - passed to the callback
+ * pFileType        - pointer to variable to store the file type, may be NULL
+ * pPlayLength      - pointer to variable to store the play length (in msecs)
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * The probe instance has no voice manager, so the parsers get no synth
+ * from VMInitMIDI and only run in eParserModeMetaData.
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_ProbeFile (EAS_FILE_LOCATOR locator, EAS_METADATA_CBFUNC cbFunc, char *metaDataBuffer, EAS_I32 metaDataBufSize, EAS_VOID_PTR pUserData, EAS_I32 *pFileType, EAS_I32 *pPlayLength)
+{
+#ifdef _FILE_PROBE
+    EAS_HW_DATA_HANDLE hwInstData;
+    S_EAS_DATA *pEASData;
+    S_EAS_STREAM *pStream;
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_FILE_HANDLE fileHandle;
+    EAS_VOID_PTR streamHandle;
+    S_METADATA_CB metadata;
+    EAS_RESULT result;
+
+    /* parsers share their static instance data */
+    *pPlayLength = 0;
+    if (EAS_CMStaticMemoryModel())
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+
+    /* a private host instance keeps concurrent probes apart */
+    if ((result = EAS_HWInit(&hwInstData)) != EAS_SUCCESS)
+        return result;
+    if ((pEASData = EAS_HWMalloc(hwInstData, sizeof(S_EAS_DATA))) == NULL)
+    {
+        EAS_HWShutdown(hwInstData);
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+    EAS_HWMemSet(pEASData, 0, sizeof(S_EAS_DATA));
+    pEASData->hwInstData = hwInstData;
+#ifdef FILE_HEADER_SEARCH
+    pEASData->searchHeaderFlag = EAS_TRUE;
+#endif
+#ifdef _DYNAMIC_STREAMS
+    pEASData->streams = pEASData->defaultStreams;
+    pEASData->maxStreams = MAX_NUMBER_STREAMS;
+#endif
+
+    /* find the parser */
+    if ((result = EAS_HWOpenFile(hwInstData, locator, &fileHandle, EAS_FILE_READ)) == EAS_SUCCESS)
+    {
+        if ((result = EAS_FindParser(pEASData, fileHandle, &pParserModule, &streamHandle)) != EAS_SUCCESS)
+            EAS_HWCloseFile(hwInstData, fileHandle);
+    }
+
+    if (result == EAS_SUCCESS)
+    {
+        pStream = &pEASData->streams[0];
+        EAS_InitStream(pStream, pParserModule, streamHandle);
+
+        /* the metadata callback must be set before the parser reads the header */
+        if (cbFunc != NULL)
+        {
+            metadata.callback = cbFunc;
+            metadata.buffer = metaDataBuffer;
+            metadata.bufferSize = metaDataBufSize;
+            metadata.pUserData = pUserData;
+            result = EAS_SetStreamParameter(pEASData, pStream, PARSER_DATA_METADATA_CB, (EAS_I32) &metadata);
+        }
+
+        if (result == EAS_SUCCESS)
+            result = (*pParserModule->pfPrepare)(pEASData, pStream->handle);
+        if ((result == EAS_SUCCESS) && (pFileType != NULL))
+            result = EAS_GetStreamParameter(pEASData, pStream, PARSER_DATA_FILE_TYPE, pFileType);
+        if (result == EAS_SUCCESS)
+            result = EAS_ParseMetaData(pEASData, pStream, pPlayLength);
+
+        /* the parser closes its file */
+        (void) (*pParserModule->pfClose)(pEASData, pStream->handle);
+    }
+
+    EAS_HWFree(hwInstData, pEASData);
+    EAS_HWShutdown(hwInstData);
+    return result;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_CloseFile()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Closes an audio file or stream. Playback should have either paused or
+ * completed (EAS_State returns EAS_PAUSED or EAS_STOPPED).
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - file or stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_CloseFile (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_RESULT result;
+
+#ifdef _ASYNC_OPEN
+    /* wait for a background open, a stream that failed to open is already closed */
+    if (pStream->pAsyncOpen != NULL)
+    {
+        if (EAS_WaitOpen(pEASData, pStream) != EAS_SUCCESS)
+            return EAS_SUCCESS;
+    }
+#endif
+
+    /* call the close function */
+    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+    if (pParserModule == NULL)
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+
+#ifdef _PCM_CACHE
+    (void) EAS_StreamCacheLeave(pEASData, pStream, EAS_FALSE);
+#endif
+
+    result = (*pParserModule->pfClose)(pEASData, pStream->handle);
+
+    /* clear the handle and parser interface pointer */
+    pStream->handle = NULL;
+    pStream->pParserModule = NULL;
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_OpenMIDIStream()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Opens a raw MIDI stream allowing the host to route MIDI cable data directly to the synthesizer
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pHandle          - pointer to variable to hold file or stream handle
+ * streamHandle     - open MIDI stream or NULL for new synthesizer instance
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_OpenMIDIStream (EAS_DATA_HANDLE pEASData, EAS_HANDLE *pHandle, EAS_HANDLE streamHandle)
+{
+    EAS_RESULT result;
+    S_INTERACTIVE_MIDI *pMIDIStream;
+    EAS_INT streamNum;
 
-#ifdef _METRICS_ENABLED
-    /* stop the post timer */
-    if (pEASData->pMetricsData)
-        (void)(*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_POST_TIME);
-#endif
+    /* initialize some pointers */
+    *pHandle = NULL;
 
-    /* advance render time */
-    pEASData->renderTime += AUDIO_FRAME_LENGTH;
+    /* a synth can only be shared with another MIDI stream */
+    if ((streamHandle != NULL) && ((streamHandle->pParserModule != NULL) || (streamHandle->handle == NULL)))
+        return EAS_ERROR_INVALID_HANDLE;
 
-#if 0
-    /* dump workload for debug */
-    if (pEASData->pVoiceMgr->workload)
-        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "Workload = %d\n", pEASData->pVoiceMgr->workload); */ }
-#endif
+    /* allocate a stream */
+    if ((streamNum = EAS_AllocateStream(pEASData)) < 0)
+        return EAS_ERROR_MAX_STREAMS_OPEN;
 
-#ifdef _METRICS_ENABLED
-    /* stop performance counter */
-    if (pEASData->pMetricsData)
-    {
-        PERF_TIMER temp;
-        temp = (*pEASData->pMetricsModule->pfStopTimer)(pEASData->pMetricsData, EAS_PM_TOTAL_TIME);
+    /* check Configuration Module for static memory allocation */
+    if (pEASData->staticMemoryModel)
+        pMIDIStream = EAS_CMEnumData(EAS_CM_MIDI_STREAM_DATA);
+    else
+        pMIDIStream = EAS_HWMallocCategory(pEASData->hwInstData, sizeof(S_INTERACTIVE_MIDI), EAS_MEM_PARSERS);
 
-        /* if max render time, record the number of voices and time */
-        if ((*pEASData->pMetricsModule->pfRecordMaxValue)
-            (pEASData->pMetricsData, EAS_PM_MAX_CYCLES, (EAS_U32) temp))
+    /* abort if there is no memory */
+    if (pMIDIStream == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    EAS_HWMemSet(pMIDIStream, 0, sizeof(S_INTERACTIVE_MIDI));
+
+    /* allocate and initialize a new synth */
+    if (streamHandle == NULL)
+    {
+        if ((result = VMInitMIDI(pEASData, &pMIDIStream->pSynth)) != EAS_SUCCESS)
         {
-            (*pEASData->pMetricsModule->pfRecordValue)(pEASData->pMetricsData, EAS_PM_MAX_CYCLES_VOICES, (EAS_U32) voicesRendered);
-            (*pEASData->pMetricsModule->pfRecordValue)(pEASData->pMetricsData, EAS_PM_MAX_CYCLES_TIME, (EAS_I32) (pEASData->renderTime >> 8));
+            if (!pEASData->staticMemoryModel)
+                EAS_HWFree(pEASData->hwInstData, pMIDIStream);
+            return result;
         }
     }
-#endif
 
-#ifdef JET_INTERFACE
-    /* let JET to do its thing */
-    if (pEASData->jetHandle != NULL)
+    /* use an existing synth */
+    else
     {
-        result = JET_Process(pEASData);
-        if (result != EAS_SUCCESS)
-            return result;
+        pMIDIStream->pSynth = ((S_INTERACTIVE_MIDI*) streamHandle->handle)->pSynth;
+        pMIDIStream->pSynth->refCount++;
     }
-#endif
 
+    /* initialize the MIDI stream data */
+    EAS_InitMIDIStream(&pMIDIStream->stream);
+    EAS_InitStream(&pEASData->streams[streamNum], NULL, pMIDIStream);
+
+    /* return the handle to the caller */
+    *pHandle = &pEASData->streams[streamNum];
     return EAS_SUCCESS;
 }
 
-#ifdef JET_INTERFACE
 /*----------------------------------------------------------------------------
- * EAS_SetTransposition)
+ * EAS_WriteMIDIStream()
  *----------------------------------------------------------------------------
  * Purpose:
- * Sets the key tranposition for the synthesizer. Transposes all
- * melodic instruments by the specified amount. Range is limited
- * to +/-12 semitones.
+ * Send data to the MIDI stream device
  *
  * Inputs:
- *  pEASData        - handle to data for this instance
- *  handle          - handle to stream
- *  transposition   - +/-12 semitones
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream handle
+ * pBuffer          - pointer to buffer
+ * count            - number of bytes to write
  *
  * Outputs:
  *
+ *
  * Side Effects:
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_SetTransposition (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 transposition)
+EAS_PUBLIC EAS_RESULT EAS_WriteMIDIStream (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_U8 *pBuffer, EAS_I32 count)
 {
+    S_INTERACTIVE_MIDI *pMIDIStream;
+#ifndef _MIDI_INPUT_RING
+    EAS_RESULT result;
+#endif
 
-    /* check range */
-    if ((transposition < -12) || (transposition > 12))
-        return EAS_ERROR_INVALID_PARAMETER;
+    if ((pStream->pParserModule != NULL) || (pStream->handle == NULL))
+        return EAS_ERROR_INVALID_HANDLE;
+    pMIDIStream = (S_INTERACTIVE_MIDI*) pStream->handle;
 
-    if (!EAS_StreamReady(pEASData, pStream))
-        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
-    return EAS_IntSetStrmParam(pEASData, pStream, PARSER_DATA_TRANSPOSITION, transposition);
-}
+    if (count <= 0)
+        return EAS_ERROR_PARAMETER_RANGE;
+
+#ifdef _MIDI_INPUT_RING
+    /* queue for the start of the next frame */
+    return EAS_MIDIRingWrite(pEASData, pMIDIStream, pBuffer, count, EAS_HWAtomicLoad(&pEASData->sampleTime));
+#else
+    /* send the entire buffer */
+    while (count--)
+    {
+        if ((result = EAS_ParseMIDIStream(pEASData, pMIDIStream->pSynth, &pMIDIStream->stream, *pBuffer++, eParserModePlay)) != EAS_SUCCESS)
+            return result;
+    }
+    return EAS_SUCCESS;
 #endif
+}
 
 /*----------------------------------------------------------------------------
- * EAS_ParseEvents()
+ * EAS_WriteMIDIStreamAt()
  *----------------------------------------------------------------------------
  * Purpose:
- * Parse events in the current streams until the desired time is reached.
+ * Queue data for the MIDI stream device to be played at a given sample time
  *
  * Inputs:
- *  pEASData        - buffer for internal EAS data
- *  endTime         - stop parsing if this time is reached
- *  parseMode       - play, locate, or metadata
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream handle
+ * pBuffer          - pointer to buffer
+ * count            - number of bytes to write
+ * sampleTime       - due time, see EAS_GetSampleTime
  *
  * Outputs:
- *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *
+ * Side Effects:
  *
  *----------------------------------------------------------------------------
 */
-static EAS_RESULT EAS_ParseEvents (S_EAS_DATA *pEASData, EAS_HANDLE pStream, EAS_U32 endTime, EAS_INT parseMode)
+EAS_PUBLIC EAS_RESULT EAS_WriteMIDIStreamAt (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_U8 *pBuffer, EAS_I32 count, EAS_U32 sampleTime)
 {
-    S_FILE_PARSER_INTERFACE *pParserModule;
-    EAS_RESULT result;
-    EAS_I32 parserState;
-    EAS_BOOL done;
-    EAS_INT yieldCount = YIELD_EVENT_COUNT;
-    EAS_U32 time = 0;
-
-    // This constant is the maximum number of events that can be processed in a single time slice.
-    // A typical ringtone will contain a few events per time slice.
-    // Extremely dense ringtones might go up to 50 events.
-    // If we see this many events then the file is probably stuck in an infinite loop
-    // and should be aborted.
-    static const EAS_INT MAX_EVENT_COUNT = 100000;
-    EAS_INT eventCount = 0;
-
-    /* does this parser have a time function? */
-    pParserModule = pStream->pParserModule;
-    if (pParserModule->pfTime == NULL)
-    {
-        /* check state */
-        if ((result = (*pParserModule->pfState)(pEASData, pStream->handle, &parserState)) != EAS_SUCCESS)
-            return result;
-        /* if play state, advance time */
-        if ((parserState >= EAS_STATE_READY) && (parserState <= EAS_STATE_PAUSING))
-            pStream->time += pStream->frameLength;
-        done = EAS_TRUE;
-    }
-
-    /* assume we're not done, in case we abort out */
-    else
-    {
-        pStream->streamFlags &= ~STREAM_FLAGS_PARSED;
-        done = EAS_FALSE;
-    }
-
-    while (!done)
-    {
-
-        /* check for stopped state */
-        if ((result = (*pParserModule->pfState)(pEASData, pStream->handle, &parserState)) != EAS_SUCCESS)
-            return result;
-        if (parserState > EAS_STATE_PLAY)
-        {
-            /* save current time if we're not in play mode */
-            if (parseMode != eParserModePlay)
-                pStream->time = time << 8;
-            done = EAS_TRUE;
-            break;
-        }
-
-        /* get the next event time */
-        if (pParserModule->pfTime)
-        {
-            if ((result = (*pParserModule->pfTime)(pEASData, pStream->handle, &time)) != EAS_SUCCESS)
-                return result;
-
-            /* if next event is within this frame, parse it */
-            if (time < (endTime >> 8))
-            {
+#ifdef _MIDI_INPUT_RING
+    if ((pStream->pParserModule != NULL) || (pStream->handle == NULL))
+        return EAS_ERROR_INVALID_HANDLE;
 
-                /* parse the next event */
-                if (pParserModule->pfEvent) {
-                    if ((result = (*pParserModule->pfEvent)(pEASData, pStream->handle, parseMode))
-                            != EAS_SUCCESS) {
-                        ALOGE("%s() pfEvent returned %ld", __func__, result);
-                        return result;
-                    }
-                }
+    if (count <= 0)
+        return EAS_ERROR_PARAMETER_RANGE;
 
-                // An infinite loop within a ringtone file can cause this function
-                // to loop forever.  Try to detect that and return an error.
-                // Only check when playing. Otherwise a very large file could be rejected
-                // when scanning the entire file in a single call to this function.
-                // OTA files will only do infinite loops when in eParserModePlay.
-                if (++eventCount >= MAX_EVENT_COUNT && parseMode == eParserModePlay) {
-                    ALOGE("%s() aborting, %d events. Infinite loop in song file?!",
-                            __func__, eventCount);
-                    android_errorWriteLog(0x534e4554, "68664359");
-                    return EAS_ERROR_FILE_POS;
-                }
-            }
+    return EAS_MIDIRingWrite(pEASData, (S_INTERACTIVE_MIDI*) pStream->handle, pBuffer, count, sampleTime);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
 
-            /* no more events in this frame, advance time */
-            else
-            {
-                pStream->time = endTime;
-                done = EAS_TRUE;
-            }
-        }
+/*----------------------------------------------------------------------------
+ * EAS_CloseMIDIStream()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Closes a raw MIDI stream
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_CloseMIDIStream (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream)
+{
+    S_INTERACTIVE_MIDI *pMIDIStream;
 
-        /* check for max workload exceeded */
-        if (VMCheckWorkload(pEASData->pVoiceMgr))
-        {
-            /* stop even though we may not have parsed
-             * all the events in this frame. The parser will try to
-             * catch up on the next frame.
-             */
-            break;
-        }
+    if ((pStream->pParserModule != NULL) || (pStream->handle == NULL))
+        return EAS_ERROR_INVALID_HANDLE;
+    pMIDIStream = (S_INTERACTIVE_MIDI*) pStream->handle;
 
-        /* give host a chance for an early abort */
-        if (--yieldCount == 0)
-        {
-            if (EAS_HWYield(pEASData->hwInstData))
-                break;
-            yieldCount = YIELD_EVENT_COUNT;
-        }
+    /* close synth, it is freed when the last stream using it closes */
+    if (pMIDIStream->pSynth != NULL)
+    {
+        VMMIDIShutdown(pEASData, pMIDIStream->pSynth);
+        pMIDIStream->pSynth = NULL;
     }
 
-    /* if no early abort, parsing is complete for this frame */
-    if (done)
-        pStream->streamFlags |= STREAM_FLAGS_PARSED;
+    /* release allocated memory */
+    if (!pEASData->staticMemoryModel)
+        EAS_HWFree(pEASData->hwInstData, pMIDIStream);
 
+    pStream->handle = NULL;
     return EAS_SUCCESS;
 }
 
 /*----------------------------------------------------------------------------
- * EAS_ParseMetaData()
+ * EAS_GetSampleTime()
  *----------------------------------------------------------------------------
  * Purpose:
- *
+ * Returns the number of samples rendered since the library was initialized
  *
  * Inputs:
  * pEASData         - pointer to overall EAS data structure
- * handle           - file or stream handle
- * playLength       - pointer to variable to store the play length (in msecs)
+ * pSampleTime      - pointer to variable to receive the sample count
  *
  * Outputs:
  *
  *
  * Side Effects:
- *                  - resets the parser to the start of the file
+ *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_ParseMetaData (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 *playLength)
+EAS_PUBLIC EAS_RESULT EAS_GetSampleTime (EAS_DATA_HANDLE pEASData, EAS_U32 *pSampleTime)
 {
-    S_FILE_PARSER_INTERFACE *pParserModule;
-    EAS_RESULT result;
-    EAS_STATE state;
-
-    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
-    if (pParserModule == NULL)
-        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
-
-    /* check parser state */
-    if ((result = (*pParserModule->pfState)(pEASData, pStream->handle, &state)) != EAS_SUCCESS)
-        return result;
-    if (state >= EAS_STATE_OPEN)
-        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#ifdef _SAMPLE_CLOCK
+    *pSampleTime = EAS_HWAtomicLoad(&pEASData->sampleTime);
+    return EAS_SUCCESS;
+#else
+    *pSampleTime = 0;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
 
-    /* if parser has metadata function, use that */
-    if (pParserModule->pfGetMetaData != NULL)
-        return pParserModule->pfGetMetaData(pEASData, pStream->handle, playLength);
+#ifdef _MIDI_INPUT_RING
+/*----------------------------------------------------------------------------
+ * EAS_MIDIRingWrite()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Queues MIDI data on the input ring of a MIDI stream. Called from the
+ * producer thread only, never blocks.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pMIDIStream      - MIDI stream
+ * pBuffer          - pointer to buffer
+ * count            - number of bytes to write
+ * sampleTime       - due time
+ *
+ * Outputs:
+ * Returns EAS_ERROR_QUEUE_IS_FULL, without queuing anything, if there is not
+ * room for the whole buffer.
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_MIDIRingWrite (S_EAS_DATA *pEASData, S_INTERACTIVE_MIDI *pMIDIStream, EAS_U8 *pBuffer, EAS_I32 count, EAS_U32 sampleTime)
+{
+    S_MIDI_RING *pRing;
+    S_MIDI_RING_EVENT *pEvent;
+    EAS_U32 head;
+    EAS_U32 numSlots;
+    EAS_INT i;
 
-    /* reset the parser to the beginning */
-    if ((result = (*pParserModule->pfReset)(pEASData, pStream->handle)) != EAS_SUCCESS)
-        return result;
+    pRing = &pMIDIStream->ring;
 
-    /* parse the file to end */
-    pStream->time = 0;
-    VMInitWorkload(pEASData->pVoiceMgr);
-    if ((result = EAS_ParseEvents(pEASData, pStream, 0x7fffffff, eParserModeMetaData)) != EAS_SUCCESS)
-        return result;
+    /* the producer owns the head, the tail may move while we look at it */
+    head = pRing->head;
+    numSlots = ((EAS_U32) count + MIDI_RING_EVENT_BYTES - 1) / MIDI_RING_EVENT_BYTES;
+    if (numSlots > MIDI_RING_SIZE - (head - EAS_HWAtomicLoad(&pRing->tail)))
+        return EAS_ERROR_QUEUE_IS_FULL;
 
-    /* get the parser time */
-    if ((result = EAS_GetLocation(pEASData, pStream, playLength)) != EAS_SUCCESS)
-        return result;
+    while (count > 0)
+    {
+        pEvent = &pRing->events[head & (MIDI_RING_SIZE - 1)];
+        pEvent->time = sampleTime;
+        pEvent->count = (EAS_U8) (count < MIDI_RING_EVENT_BYTES ? count : MIDI_RING_EVENT_BYTES);
+        for (i = 0; i < pEvent->count; i++)
+            pEvent->data[i] = *pBuffer++;
+        count -= pEvent->count;
+        head++;
+    }
 
-    /* reset the parser to the beginning */
-    pStream->time = 0;
-    return (*pParserModule->pfReset)(pEASData, pStream->handle);
+    /* publish the new slots */
+    EAS_HWAtomicStore(&pRing->head, head);
+    return EAS_SUCCESS;
 }
 
 /*----------------------------------------------------------------------------
- * EAS_CloseFile()
+ * EAS_MIDIRingRead()
  *----------------------------------------------------------------------------
  * Purpose:
- * Closes an audio file or stream. Playback should have either paused or
- * completed (EAS_State returns EAS_PAUSED or EAS_STOPPED).
+ * Sends the data queued on the input ring of a MIDI stream that is due
+ * before endTime to the synthesizer. Called from the render thread only.
  *
  * Inputs:
  * pEASData         - pointer to overall EAS data structure
- * handle           - file or stream handle
+ * pMIDIStream      - MIDI stream
+ * endTime          - sample time of the end of the frame
  *
  * Outputs:
  *
@@ -1181,23 +5984,52 @@ EAS_PUBLIC EAS_RESULT EAS_ParseMetaData (EAS_DATA_HANDLE pEASData, EAS_HANDLE pS
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_CloseFile (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream)
+static EAS_RESULT EAS_MIDIRingRead (S_EAS_DATA *pEASData, S_INTERACTIVE_MIDI *pMIDIStream, EAS_U32 endTime)
 {
-    S_FILE_PARSER_INTERFACE *pParserModule;
+    S_MIDI_RING *pRing;
+    S_MIDI_RING_EVENT *pEvent;
     EAS_RESULT result;
+    EAS_U32 head;
+    EAS_U32 tail;
+    EAS_INT i;
+#ifdef _SAMPLE_ACCURATE_EVENTS
+    EAS_I32 offset;
+#endif
 
-    /* call the close function */
-    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
-    if (pParserModule == NULL)
-        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+    pRing = &pMIDIStream->ring;
 
-    result = (*pParserModule->pfClose)(pEASData, pStream->handle);
+    /* the consumer owns the tail */
+    tail = pRing->tail;
+    head = EAS_HWAtomicLoad(&pRing->head);
+    result = EAS_SUCCESS;
+    while (tail != head)
+    {
+        /* stop at the first slot that is not due yet, the count wraps around */
+        pEvent = &pRing->events[tail & (MIDI_RING_SIZE - 1)];
+        if ((EAS_I32) (pEvent->time - endTime) >= 0)
+            break;
 
-    /* clear the handle and parser interface pointer */
-    pStream->handle = NULL;
-    pStream->pParserModule = NULL;
+#ifdef _SAMPLE_ACCURATE_EVENTS
+        /* late data plays at the start of the frame */
+        offset = (EAS_I32) (pEvent->time - pEASData->sampleTime);
+        pEASData->pVoiceMgr->eventOffset = (offset > 0) ? offset : 0;
+#endif
+        for (i = 0; (i < pEvent->count) && (result == EAS_SUCCESS); i++)
+            result = EAS_ParseMIDIStream(pEASData, pMIDIStream->pSynth, &pMIDIStream->stream, pEvent->data[i], eParserModePlay);
+        tail++;
+        if (result != EAS_SUCCESS)
+            break;
+    }
+
+#ifdef _SAMPLE_ACCURATE_EVENTS
+    pEASData->pVoiceMgr->eventOffset = 0;
+#endif
+
+    /* give the slots back to the producer */
+    EAS_HWAtomicStore(&pRing->tail, tail);
     return result;
 }
+#endif
 
 /*----------------------------------------------------------------------------
  * EAS_State()
@@ -1226,6 +6058,15 @@ EAS_PUBLIC EAS_RESULT EAS_State (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, E
     if (pParserModule == NULL)
         return EAS_ERROR_FEATURE_NOT_AVAILABLE;
 
+#ifdef _PCM_CACHE
+    /* the parser of a stream playing from the cache is idle, report the state it had when it was recorded */
+    if ((pStream->cacheState == PCM_CACHE_PLAY) && (pStream->cacheFrame > 0))
+    {
+        *pState = (EAS_STATE) pStream->pCacheEntry->pMarks[pStream->cacheFrame - 1].state;
+        return EAS_SUCCESS;
+    }
+#endif
+
     if ((result = (*pParserModule->pfState)(pEASData, pStream->handle, pState)) != EAS_SUCCESS)
         return result;
 
@@ -1364,9 +6205,18 @@ EAS_PUBLIC EAS_RESULT EAS_Locate (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream,
     if (requestedTime == (pStream->time >> 8))
         return EAS_SUCCESS;
 
+#ifdef _PCM_CACHE
+    /* the parser of a stream playing from the cache is still at the start */
+    if ((result = EAS_StreamCacheLeave(pEASData, pStream, EAS_FALSE)) != EAS_SUCCESS)
+        return result;
+#endif
+
     /* set the locate flag */
     pStream->streamFlags |= STREAM_FLAGS_LOCATE;
 
+    /* discard any samples rendered ahead of the old position */
+    pEASData->carryCount = 0;
+
     /* use the parser locate function, if available */
     if (pParserModule->pfLocate != NULL)
     {
@@ -1389,6 +6239,16 @@ EAS_PUBLIC EAS_RESULT EAS_Locate (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream,
         return result;
     pStream->time = 0;
 
+#ifdef _SMF_SEEK_INDEX
+    /* let the parser skip ahead to the nearest checkpoint in its seek index */
+    if (pParserModule->pfSetData != NULL)
+    {
+        result = (*pParserModule->pfSetData)(pEASData, pStream->handle, PARSER_DATA_SEEK_CHECKPOINT, (EAS_I32) requestedTime);
+        if ((result != EAS_SUCCESS) && (result != EAS_ERROR_INVALID_PARAMETER))
+            return result;
+    }
+#endif
+
     /* locating forward, clear parsed flag and parse data until we get to the requested location */
     if ((result = EAS_ParseEvents(pEASData, pStream, requestedTime << 8, eParserModeLocate)) != EAS_SUCCESS)
         return result;
@@ -1424,6 +6284,295 @@ EAS_PUBLIC EAS_RESULT EAS_GetLocation (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStr
     return EAS_SUCCESS;
 }
 
+/*----------------------------------------------------------------------------
+ * EAS_GetNextEventTime()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the time until the next event of the stream
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - file handle
+ *
+ * Outputs:
+ * The milliseconds of playback until the next event, 0 for a stream that
+ * plays all the time and -1 for one with no more events or that is paused.
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetNextEventTime (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 *pTime)
+{
+    S_FILE_PARSER_INTERFACE *pParserModule;
+    EAS_STATE state;
+    EAS_RESULT result;
+    EAS_U32 time;
+
+    if (!EAS_StreamReady(pEASData, pStream))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+    /* a paused or stopping stream plays no more events until it is resumed */
+    if ((result = EAS_State(pEASData, pStream, &state)) != EAS_SUCCESS)
+        return result;
+    if ((state != EAS_STATE_READY) && (state != EAS_STATE_PLAY))
+    {
+        *pTime = -1;
+        return EAS_SUCCESS;
+    }
+
+    /* audio files have no events, they play every frame */
+    pParserModule = (S_FILE_PARSER_INTERFACE*) pStream->pParserModule;
+    if (pParserModule->pfTime == NULL)
+    {
+        *pTime = 0;
+        return EAS_SUCCESS;
+    }
+    if ((result = (*pParserModule->pfTime)(pEASData, pStream->handle, &time)) != EAS_SUCCESS)
+        return result;
+
+    /* an event due in the frame being played is due now */
+    if (time <= (pStream->time >> 8))
+        *pTime = 0;
+    else
+        *pTime = (EAS_I32) (time - (pStream->time >> 8));
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_GetPosition()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the position of the stream at the end of the last frame rendered
+ * and the output samples between it and the next sample returned
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - file handle
+ * pPosition        - receives the position
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pEASData, pStream, pPosition) used only with _POSITION_REPORT */
+EAS_PUBLIC EAS_RESULT EAS_GetPosition (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, S_EAS_POSITION *pPosition)
+{
+#ifdef _POSITION_REPORT
+    EAS_U32 frameSize;
+    EAS_I32 ticks;
+    EAS_I32 pending;
+
+    if (!EAS_StreamReady(pEASData, pStream))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#ifdef _RENDER_AHEAD
+    /* the render thread owns the stream */
+    if (pEASData->pRenderAhead != NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
+
+    /* the stream time advances frameLength msecs/256 per frame, convert without overflowing */
+    frameSize = (EAS_U32) EAS_FRAME_SIZE(pEASData);
+    pPosition->sampleTime = pEASData->sampleTime;
+    pPosition->samples = (pStream->time / pStream->frameLength) * frameSize +
+        ((pStream->time % pStream->frameLength) * frameSize) / pStream->frameLength;
+
+    /* only the MIDI parsers count ticks */
+    ticks = (EAS_I32) pStream->time;
+    if (EAS_GetStreamParameter(pEASData, pStream, PARSER_DATA_TICK_POSITION, &ticks) != EAS_SUCCESS)
+        ticks = -1;
+    pPosition->ticks = ticks;
+
+    /* the events of a frame are parsed at its first slice */
+    pending = 0;
+#ifdef _LOW_LATENCY
+    if (pEASData->slicePos != 0)
+        pending = EAS_FRAME_SIZE(pEASData) - pEASData->slicePos;
+#endif
+#ifdef _OUTPUT_RESAMPLER
+    if (pEASData->pResampler != NULL)
+        pending = (pending * pEASData->pResampler->outputRate) / _OUTPUT_SAMPLE_RATE + EAS_ResamplerLatency(pEASData->pResampler);
+#endif
+    pPosition->latency = pending + pEASData->carryCount;
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SaveState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Takes a snapshot of the stream: the parser position, the channel state
+ * of its synth and the voices it is playing. With pState NULL only the
+ * size needed is returned.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream handle
+ * pState           - receives the snapshot, or NULL
+ * size             - size of pState in bytes
+ * pStateSize       - receives the size of the snapshot, or the size needed
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * A stream playing from the PCM cache continues from the synthesizer
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pEASData, pStream, pState, size, pStateSize) used only with _ENGINE_SNAPSHOT */
+EAS_PUBLIC EAS_RESULT EAS_SaveState (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, void *pState, EAS_I32 size, EAS_I32 *pStateSize)
+{
+#ifdef _ENGINE_SNAPSHOT
+    S_EAS_STATE_HEADER *pHeader;
+    S_SYNTH *pSynth;
+    EAS_RESULT result;
+    EAS_I32 parserSize;
+
+    if (!EAS_StreamReady(pEASData, pStream))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#ifdef _RENDER_AHEAD
+    /* the render thread owns the stream */
+    if (pEASData->pRenderAhead != NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
+
+    /* only the MIDI parsers keep snapshots */
+    if ((EAS_GetStreamParameter(pEASData, pStream, PARSER_DATA_STATE_SIZE, &parserSize) != EAS_SUCCESS) ||
+        (EAS_GetStreamParameter(pEASData, pStream, PARSER_DATA_SYNTH_HANDLE, (EAS_I32*) &pSynth) != EAS_SUCCESS) ||
+        (pSynth == NULL))
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+    parserSize = EAS_STATE_ALIGN(parserSize);
+
+    *pStateSize = (EAS_I32) sizeof(S_EAS_STATE_HEADER) + parserSize + VMStateSize(pEASData->pVoiceMgr);
+    if (pState == NULL)
+        return EAS_SUCCESS;
+    if (size < *pStateSize)
+        return EAS_BUFFER_SIZE_MISMATCH;
+
+#ifdef _PCM_CACHE
+    /* the parser of a stream playing from the cache is still at the start */
+    if ((result = EAS_StreamCacheLeave(pEASData, pStream, EAS_TRUE)) != EAS_SUCCESS)
+        return result;
+#endif
+
+    pHeader = (S_EAS_STATE_HEADER*) pState;
+    if ((result = EAS_SetStreamParameter(pEASData, pStream, PARSER_DATA_SAVE_STATE, (EAS_I32) (pHeader + 1))) != EAS_SUCCESS)
+        return result;
+    pHeader->tag = EAS_STATE_TAG;
+    pHeader->handle = pStream->handle;
+    pHeader->time = pStream->time;
+    pHeader->repeatCount = pStream->repeatCount;
+    pHeader->parserSize = parserSize;
+    pHeader->size = (EAS_I32) sizeof(S_EAS_STATE_HEADER) + parserSize +
+        VMSaveState(pEASData->pVoiceMgr, pSynth, (EAS_U8*) (pHeader + 1) + parserSize);
+    *pStateSize = pHeader->size;
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RestoreState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the stream to a snapshot from EAS_SaveState without parsing the
+ * file again. The voices playing on the stream are replaced by those of
+ * the snapshot, which continue from where they were.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream handle, the stream the snapshot was taken of
+ * pState           - snapshot
+ * size             - size of the snapshot in bytes
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * Samples rendered ahead of the old position are discarded
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pEASData, pStream, pState, size) used only with _ENGINE_SNAPSHOT */
+EAS_PUBLIC EAS_RESULT EAS_RestoreState (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, const void *pState, EAS_I32 size)
+{
+#ifdef _ENGINE_SNAPSHOT
+    const S_EAS_STATE_HEADER *pHeader;
+    S_SYNTH *pSynth;
+    EAS_RESULT result;
+
+    if (!EAS_StreamReady(pEASData, pStream))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#ifdef _RENDER_AHEAD
+    /* the render thread owns the stream */
+    if (pEASData->pRenderAhead != NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+#endif
+
+    pHeader = (const S_EAS_STATE_HEADER*) pState;
+    if ((pState == NULL) || (size < (EAS_I32) sizeof(S_EAS_STATE_HEADER)) || (pHeader->tag != EAS_STATE_TAG) ||
+        (pHeader->size > size) || (pHeader->parserSize < 0) ||
+        (pHeader->parserSize > pHeader->size - (EAS_I32) sizeof(S_EAS_STATE_HEADER)))
+        return EAS_ERROR_INVALID_PARAMETER;
+    if (pHeader->handle != pStream->handle)
+        return EAS_ERROR_INVALID_PARAMETER;
+    if ((EAS_GetStreamParameter(pEASData, pStream, PARSER_DATA_SYNTH_HANDLE, (EAS_I32*) &pSynth) != EAS_SUCCESS) ||
+        (pSynth == NULL))
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+
+#ifdef _PCM_CACHE
+    /* the recording or the cached output is at the old position */
+    if ((result = EAS_StreamCacheLeave(pEASData, pStream, EAS_FALSE)) != EAS_SUCCESS)
+        return result;
+#endif
+
+    /* the synth is checked first, it is left alone if the sound library has changed */
+    if ((result = VMRestoreState(pEASData->pVoiceMgr, pSynth, (const EAS_U8*) (pHeader + 1) + pHeader->parserSize,
+        pHeader->size - (EAS_I32) sizeof(S_EAS_STATE_HEADER) - pHeader->parserSize)) != EAS_SUCCESS)
+        return result;
+    if ((result = EAS_SetStreamParameter(pEASData, pStream, PARSER_DATA_RESTORE_STATE, (EAS_I32) (pHeader + 1))) != EAS_SUCCESS)
+        return result;
+
+    pStream->time = pHeader->time;
+    pStream->repeatCount = pHeader->repeatCount;
+
+    /* discard any samples rendered ahead of the old position */
+    pEASData->carryCount = 0;
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_GetFileType()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the file type (see eas_types.h for enumerations)
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pStream          - stream handle
+ * pFileType        - pointer to variable to receive file type
+ *
+ * Outputs:
+ * Valid from EAS_OpenFile on, before EAS_Prepare
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetFileType (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_I32 *pFileType)
+{
+    /* the parser knows the file type as soon as the file is opened */
+    return EAS_GetStreamParameter(pEASData, pStream, PARSER_DATA_FILE_TYPE, pFileType);
+}
+
 #ifdef JET_INTERFACE
 /*----------------------------------------------------------------------------
  * EAS_Pause()
@@ -1466,6 +6615,12 @@ EAS_PUBLIC EAS_RESULT EAS_Pause (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream)
         if (pParserModule->pfPause == NULL)
             result = EAS_ERROR_NOT_IMPLEMENTED;
 
+#ifdef _PCM_CACHE
+        /* the parser pauses the stream, so it must be where the cached play got to */
+        else if ((result = EAS_StreamCacheLeave(pEASData, pStream, EAS_TRUE)) != EAS_SUCCESS)
+            return result;
+#endif
+
         /* clear resume flag */
         pStream->streamFlags &= ~STREAM_FLAGS_RESUME;
 
@@ -1629,12 +6784,45 @@ EAS_PUBLIC EAS_RESULT EAS_MetricsReset (EAS_DATA_HANDLE pEASData)
 }
 #endif
 
+/*----------------------------------------------------------------------------
+ * EAS_GetMetrics()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns a snapshot of the per-frame metrics.
+ *
+ * Inputs:
+ * p                - instance data handle
+ * pMetrics         - pointer to structure to receive the metrics
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetMetrics (EAS_DATA_HANDLE pEASData, S_EAS_METRICS *pMetrics)
+{
+#ifdef _METRICS_ENABLED
+    if (pMetrics == NULL)
+        return EAS_ERROR_INVALID_PARAMETER;
+    if (!pEASData->pMetricsModule)
+        return EAS_ERROR_INVALID_MODULE;
+
+    return (*pEASData->pMetricsModule->pfGetMetrics)(pEASData->pMetricsData, pMetrics);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
 #ifdef FILE_HEADER_SEARCH
 /*----------------------------------------------------------------------------
  * EAS_SearchFile
  *----------------------------------------------------------------------------
  * Search file for specific sequence starting at current file
- * position. Returns offset to start of sequence.
+ * position. Returns offset to start of sequence. The file is read in
+ * blocks of SEARCH_BUFFER_SIZE bytes and left positioned after the
+ * sequence.
  *
  * Inputs:
  * pEASData         - pointer to EAS persistent data object
@@ -1649,32 +6837,54 @@ EAS_PUBLIC EAS_RESULT EAS_MetricsReset (EAS_DATA_HANDLE pEASData)
 EAS_RESULT EAS_SearchFile (S_EAS_DATA *pEASData, EAS_FILE_HANDLE fileHandle, const EAS_U8 *searchString, EAS_I32 len, EAS_I32 *pOffset)
 {
     EAS_RESULT result;
-    EAS_INT index;
-    EAS_U8 c;
+    EAS_U8 buffer[SEARCH_BUFFER_SIZE];
+    const EAS_U8 *p;
+    const EAS_U8 *pEnd;
+    EAS_I32 bufferPos;
+    EAS_I32 fill;
+    EAS_I32 count;
+    EAS_I32 keep;
 
     *pOffset = -1;
-    index = 0;
+    if ((len <= 0) || (len > SEARCH_BUFFER_SIZE / 2))
+        return EAS_ERROR_PARAMETER_RANGE;
+    if ((result = EAS_HWFilePos(pEASData->hwInstData, fileHandle, &bufferPos)) != EAS_SUCCESS)
+        return result;
+
+    /* scan a block at a time, keeping the tail of the previous block for matches across blocks */
+    fill = 0;
     for (;;)
     {
-        result = EAS_HWGetByte(pEASData->hwInstData, fileHandle, &c);
-        if (result != EAS_SUCCESS)
+        count = 0;
+        result = EAS_HWReadFile(pEASData->hwInstData, fileHandle, buffer + fill, SEARCH_BUFFER_SIZE - fill, &count);
+        if ((result != EAS_SUCCESS) && (result != EAS_EOF))
             return result;
-        if (c == searchString[index])
+        fill += count;
+
+        /* find the first byte, then compare the rest */
+        p = buffer;
+        pEnd = buffer + fill - len + 1;
+        while (p < pEnd)
         {
-            index++;
-            if (index == 4)
-            {
-                result = EAS_HWFilePos(pEASData->hwInstData, fileHandle, pOffset);
-                if (result != EAS_SUCCESS)
-                    return result;
-                *pOffset -= len;
+            if ((p = memchr(p, searchString[0], (size_t) (pEnd - p))) == NULL)
                 break;
+            if (memcmp(p, searchString, (size_t) len) == 0)
+            {
+                /* leave the file positioned after the sequence */
+                *pOffset = bufferPos + (EAS_I32) (p - buffer);
+                return EAS_HWFileSeek(pEASData->hwInstData, fileHandle, *pOffset + len);
             }
+            p++;
         }
-        else
-            index = 0;
+
+        if (result == EAS_EOF)
+            return EAS_EOF;
+
+        keep = (fill < len - 1) ? fill : len - 1;
+        memmove(buffer, buffer + fill - keep, (size_t) keep);
+        bufferPos += fill - keep;
+        fill = keep;
     }
-    return EAS_SUCCESS;
 }
 #endif
 
@@ -0,0 +1,331 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_resampler.c
+ *
+ * Contents and purpose:
+ * Converts the mixed output from the synthesizer rate to the device rate
+ * with a fixed point windowed sinc polyphase filter. The filter is built
+ * once at initialization; each output sample is then one dot product per
+ * channel against the nearest of the precomputed filter phases.
+ *
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+/* allocations of this module are reported as mix buffers */
+#define EAS_MEM_CATEGORY    EAS_MEM_MIX_BUFFERS
+
+/*------------------------------------
+ * includes
+ *------------------------------------
+*/
+
+#include <math.h>
+
+#include "eas_data.h"
+#include "eas_math.h"
+#include "eas_resampler.h"
+#include "eas_host.h"
+#include "eas_report.h"
+
+/*----------------------------------------------------------------------------
+ * resamplerQuality
+ *
+ * Filter length, number of filter phases, cutoff (as a fraction of the
+ * lower Nyquist rate) and whether to interpolate between phases for each
+ * quality setting. Shorter filters need a wider transition band to keep
+ * the stopband attenuation.
+ *----------------------------------------------------------------------------
+*/
+typedef struct
+{
+    EAS_I32     numTaps;
+    EAS_I32     numPhases;
+    double      cutoff;
+    EAS_BOOL    interpolate;
+} S_RESAMPLER_QUALITY;
+
+static const S_RESAMPLER_QUALITY resamplerQuality[] =
+{
+    { 16, 256, 0.88, EAS_FALSE },   /* EAS_RESAMPLER_QUALITY_DEFAULT */
+    {  8,  64, 0.80, EAS_FALSE },   /* EAS_RESAMPLER_QUALITY_LOW */
+    { 16, 256, 0.88, EAS_FALSE },   /* EAS_RESAMPLER_QUALITY_MEDIUM */
+    { 32, 256, 0.92, EAS_TRUE }     /* EAS_RESAMPLER_QUALITY_HIGH */
+};
+
+/*----------------------------------------------------------------------------
+ * ResamplerBuildFilter()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Computes the Blackman windowed sinc filter for each phase. Phase p is
+ * the filter for an output sample p/numPhases of the way from tap
+ * numTaps/2 - 1 to the next tap. Every phase is normalized to unity gain.
+ *
+ * Inputs:
+ * pResampler       - resampler with numTaps, numPhases and pCoefs set
+ * cutoff           - cutoff in cycles per input sample
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ResamplerBuildFilter (S_EAS_RESAMPLER *pResampler, double cutoff)
+{
+    EAS_I16 *pCoefs;
+    EAS_I32 numTaps;
+    EAS_I32 phase;
+    EAS_I32 tap;
+    EAS_I32 sum;
+    EAS_I32 center;
+    double taps[RESAMPLER_MAX_TAPS];
+    double total;
+    double t;
+    double x;
+
+    numTaps = pResampler->numTaps;
+    for (phase = 0; phase <= pResampler->numPhases; phase++)
+    {
+        /* design the filter at this fractional offset */
+        total = 0.0;
+        for (tap = 0; tap < numTaps; tap++)
+        {
+            t = (double) (tap - (numTaps / 2 - 1)) - (double) phase / (double) pResampler->numPhases;
+            x = 2.0 * M_PI * cutoff * t;
+            taps[tap] = (x == 0.0) ? 1.0 : sin(x) / x;
+            x = M_PI * t / (double) (numTaps / 2);
+            taps[tap] *= 0.42 + 0.5 * cos(x) + 0.08 * cos(2.0 * x);
+            total += taps[tap];
+        }
+
+        /* convert to fixed point, putting the rounding error on the center tap */
+        pCoefs = &pResampler->pCoefs[phase * numTaps];
+        sum = 0;
+        for (tap = 0; tap < numTaps; tap++)
+        {
+            pCoefs[tap] = (EAS_I16) floor(taps[tap] / total * (double) (1 << RESAMPLER_COEF_BITS) + 0.5);
+            sum += pCoefs[tap];
+        }
+        center = numTaps / 2 - 1 + ((phase * 2 >= pResampler->numPhases) ? 1 : 0);
+        pCoefs[center] = (EAS_I16) (pCoefs[center] + (1 << RESAMPLER_COEF_BITS) - sum);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ResamplerInit()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Allocates a resampler from _OUTPUT_SAMPLE_RATE to the given rate and
+ * builds its filter for the requested quality.
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * outputRate       - device sample rate
+ * quality          - filter quality
+ * ppResampler      - receives the resampler
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_ResamplerInit (EAS_HW_DATA_HANDLE hwInstData, EAS_I32 outputRate, EAS_I32 quality, S_EAS_RESAMPLER **ppResampler)
+{
+    S_EAS_RESAMPLER *pResampler;
+    const S_RESAMPLER_QUALITY *pQuality;
+    double cutoff;
+
+    *ppResampler = NULL;
+    if ((outputRate < RESAMPLER_MIN_RATE) || (outputRate > RESAMPLER_MAX_RATE))
+        return EAS_ERROR_PARAMETER_RANGE;
+    if ((quality < EAS_RESAMPLER_QUALITY_DEFAULT) || (quality > EAS_RESAMPLER_QUALITY_HIGH))
+        return EAS_ERROR_PARAMETER_RANGE;
+    pQuality = &resamplerQuality[quality];
+
+    /* allocate the state and the filter table */
+    pResampler = EAS_HWMalloc(hwInstData, sizeof(S_EAS_RESAMPLER));
+    if (pResampler == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_FATAL, "Failed to allocate resampler memory\n"); */ }
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+    EAS_HWMemSet(pResampler, 0, sizeof(S_EAS_RESAMPLER));
+    pResampler->pCoefs = EAS_HWMalloc(hwInstData, (pQuality->numPhases + 1) * pQuality->numTaps * (EAS_I32) sizeof(EAS_I16));
+    if (pResampler->pCoefs == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_FATAL, "Failed to allocate resampler filter\n"); */ }
+        EAS_HWFree(hwInstData, pResampler);
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+    pResampler->numTaps = pQuality->numTaps;
+    pResampler->numPhases = pQuality->numPhases;
+    pResampler->interpolate = pQuality->interpolate;
+    pResampler->outputRate = outputRate;
+    pResampler->step = _OUTPUT_SAMPLE_RATE / outputRate;
+    pResampler->stepRemainder = _OUTPUT_SAMPLE_RATE % outputRate;
+
+    /* band limit to the lower of the two Nyquist rates */
+    cutoff = 0.5 * pQuality->cutoff;
+    if (outputRate < _OUTPUT_SAMPLE_RATE)
+        cutoff = cutoff * (double) outputRate / (double) _OUTPUT_SAMPLE_RATE;
+    ResamplerBuildFilter(pResampler, cutoff);
+
+    /* the first output lines up with the first input sample */
+    pResampler->fill = pResampler->numTaps / 2 - 1;
+
+    *ppResampler = pResampler;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ResamplerShutdown()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees the resampler
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pResampler       - resampler to free
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_ResamplerShutdown (EAS_HW_DATA_HANDLE hwInstData, S_EAS_RESAMPLER *pResampler)
+{
+    if (pResampler == NULL)
+        return;
+    if (pResampler->pCoefs != NULL)
+        EAS_HWFree(hwInstData, pResampler->pCoefs);
+    EAS_HWFree(hwInstData, pResampler);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ResamplerProcess()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts the frame in pResampler->input to the device rate. The input
+ * position advances by step + stepRemainder / outputRate input samples per
+ * output sample, so the output stays locked to the input with no drift.
+ *
+ * Inputs:
+ * pResampler       - resampler
+ * numSamples       - samples per channel in pResampler->input
+ * pDst             - receives up to RESAMPLER_MAX_OUTPUT_SAMPLES samples
+ *
+ * Outputs:
+ * number of samples per channel written to pDst
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 EAS_ResamplerProcess (S_EAS_RESAMPLER *pResampler, EAS_I32 numSamples, EAS_PCM *pDst)
+{
+    EAS_I16 blend[RESAMPLER_MAX_TAPS];
+    const EAS_I16 *pCoefs;
+    const EAS_PCM *pHistory;
+    EAS_I32 numTaps;
+    EAS_I32 count;
+    EAS_I32 channel;
+    EAS_I32 tap;
+    EAS_I32 i;
+    EAS_I32 acc;
+    EAS_I32 phase;
+    EAS_I32 frac;
+
+    /* append the frame to the history of each channel */
+    for (channel = 0; channel < NUM_OUTPUT_CHANNELS; channel++)
+        for (i = 0; i < numSamples; i++)
+            pResampler->history[channel][pResampler->fill + i] = pResampler->input[i * NUM_OUTPUT_CHANNELS + channel];
+    pResampler->fill += numSamples;
+
+    /* generate every output sample whose taps are all available */
+    numTaps = pResampler->numTaps;
+    count = 0;
+    while (pResampler->index + numTaps <= pResampler->fill)
+    {
+        /* pick the nearest filter phase, or blend the two around the position */
+        phase = pResampler->phase * pResampler->numPhases;
+        if (pResampler->interpolate)
+        {
+            pCoefs = &pResampler->pCoefs[(phase / pResampler->outputRate) * numTaps];
+            frac = ((phase % pResampler->outputRate) << 15) / pResampler->outputRate;
+            for (tap = 0; tap < numTaps; tap++)
+                /*lint -e{702} use shift for performance */
+                blend[tap] = (EAS_I16) (pCoefs[tap] + (((pCoefs[tap + numTaps] - pCoefs[tap]) * frac) >> 15));
+            pCoefs = blend;
+        }
+        else
+            pCoefs = &pResampler->pCoefs[((phase + (pResampler->outputRate >> 1)) / pResampler->outputRate) * numTaps];
+
+        for (channel = 0; channel < NUM_OUTPUT_CHANNELS; channel++)
+        {
+            pHistory = &pResampler->history[channel][pResampler->index];
+            acc = 0;
+            for (tap = 0; tap < numTaps; tap++)
+                acc += pHistory[tap] * pCoefs[tap];
+
+            /*lint -e{702} use shift for performance */
+            acc = (acc + (1 << (RESAMPLER_COEF_BITS - 1))) >> RESAMPLER_COEF_BITS;
+            pDst[count * NUM_OUTPUT_CHANNELS + channel] = (EAS_PCM) SATURATE(acc);
+        }
+        count++;
+
+        pResampler->index += pResampler->step;
+        pResampler->phase += pResampler->stepRemainder;
+        if (pResampler->phase >= pResampler->outputRate)
+        {
+            pResampler->phase -= pResampler->outputRate;
+            pResampler->index++;
+        }
+    }
+
+    /* keep the samples the next output still needs */
+    pResampler->fill -= pResampler->index;
+    for (channel = 0; channel < NUM_OUTPUT_CHANNELS; channel++)
+        for (i = 0; i < pResampler->fill; i++)
+            pResampler->history[channel][i] = pResampler->history[channel][pResampler->index + i];
+    pResampler->index = 0;
+
+    return count;
+}
+
+#ifdef _POSITION_REPORT
+/*----------------------------------------------------------------------------
+ * EAS_ResamplerLatency()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the input held in the history that has not reached the output
+ * yet, in output samples. The next output sample is centered numTaps / 2 - 1
+ * samples into the history plus the fractional phase.
+ *
+ * Inputs:
+ * pResampler       - resampler
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 EAS_ResamplerLatency (const S_EAS_RESAMPLER *pResampler)
+{
+    EAS_I32 pending;
+
+    /* in 1/outputRate input samples */
+    pending = (pResampler->fill - pResampler->numTaps / 2 + 1) * pResampler->outputRate - pResampler->phase;
+    if (pending <= 0)
+        return 0;
+    return pending / _OUTPUT_SAMPLE_RATE;
+}
+#endif
@@ -0,0 +1,140 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_resampler.h
+ *
+ * Contents and purpose:
+ * Interface for the output sample rate converter
+ *
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_RESAMPLER_H
+#define _EAS_RESAMPLER_H
+
+#include "eas_types.h"
+#include "eas_audioconst.h"
+
+/* range of device rates the resampler converts to */
+#define RESAMPLER_MIN_RATE              8000
+#define RESAMPLER_MAX_RATE              48000
+
+/* longest filter, see the quality table in eas_resampler.c */
+#define RESAMPLER_MAX_TAPS              32
+
+/* fixed point format of the filter coefficients */
+#define RESAMPLER_COEF_BITS             14
+
+/* most samples one frame can produce at RESAMPLER_MAX_RATE */
+#define RESAMPLER_MAX_OUTPUT_SAMPLES    (BUFFER_SIZE_IN_MONO_SAMPLES * RESAMPLER_MAX_RATE / _OUTPUT_SAMPLE_RATE + 2)
+
+/*----------------------------------------------------------------------------
+ * S_EAS_RESAMPLER
+ *
+ * Polyphase resampler state. The input history is kept one array per
+ * channel so each output sample is a contiguous dot product.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_eas_resampler_tag
+{
+    EAS_I16     *pCoefs;                /* (numPhases + 1) x numTaps coefficients */
+    EAS_I32     numTaps;
+    EAS_I32     numPhases;
+    EAS_BOOL    interpolate;            /* blend adjacent phases */
+    EAS_I32     outputRate;
+    EAS_I32     step;                   /* whole input samples per output sample */
+    EAS_I32     stepRemainder;          /* fractional step in 1/outputRate input samples */
+    EAS_I32     phase;                  /* fractional position in 1/outputRate input samples */
+    EAS_I32     index;                  /* history position of the first tap */
+    EAS_I32     fill;                   /* samples in the history */
+    EAS_PCM     history[NUM_OUTPUT_CHANNELS][RESAMPLER_MAX_TAPS + BUFFER_SIZE_IN_MONO_SAMPLES];
+    EAS_PCM     input[BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS];
+} S_EAS_RESAMPLER;
+
+/*----------------------------------------------------------------------------
+ * EAS_ResamplerInit()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Allocates a resampler from _OUTPUT_SAMPLE_RATE to the given rate and
+ * builds its filter for the requested quality (E_EAS_RESAMPLER_QUALITY).
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * outputRate       - device sample rate
+ * quality          - filter quality
+ * ppResampler      - receives the resampler
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_ResamplerInit (EAS_HW_DATA_HANDLE hwInstData, EAS_I32 outputRate, EAS_I32 quality, S_EAS_RESAMPLER **ppResampler);
+
+/*----------------------------------------------------------------------------
+ * EAS_ResamplerShutdown()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees the resampler
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pResampler       - resampler to free
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_ResamplerShutdown (EAS_HW_DATA_HANDLE hwInstData, S_EAS_RESAMPLER *pResampler);
+
+/*----------------------------------------------------------------------------
+ * EAS_ResamplerProcess()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts the frame in pResampler->input to the device rate
+ *
+ * Inputs:
+ * pResampler       - resampler
+ * numSamples       - samples per channel in pResampler->input
+ * pDst             - receives up to RESAMPLER_MAX_OUTPUT_SAMPLES samples
+ *
+ * Outputs:
+ * number of samples per channel written to pDst
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 EAS_ResamplerProcess (S_EAS_RESAMPLER *pResampler, EAS_I32 numSamples, EAS_PCM *pDst);
+
+#ifdef _POSITION_REPORT
+/*----------------------------------------------------------------------------
+ * EAS_ResamplerLatency()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the input held in the history that has not reached the output
+ * yet, in output samples
+ *
+ * Inputs:
+ * pResampler       - resampler
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 EAS_ResamplerLatency (const S_EAS_RESAMPLER *pResampler);
+#endif
+
+#endif /* end _EAS_RESAMPLER_H */
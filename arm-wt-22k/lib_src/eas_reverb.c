@@ -28,6 +28,9 @@
  *----------------------------------------------------------------------------
 */
 
+/* allocations of this module are reported as effects memory */
+#define EAS_MEM_CATEGORY    EAS_MEM_EFFECTS
+
 /*------------------------------------
  * includes
  *------------------------------------
@@ -48,6 +51,192 @@ static void ReverbProcess (EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst,
 static EAS_RESULT ReverbShutdown (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
 static EAS_RESULT ReverbGetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue);
 static EAS_RESULT ReverbSetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value);
+static void ReverbReset (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
+static void ReverbSetDefaults (EAS_DATA_HANDLE pEASData, S_REVERB_OBJECT *pReverbData);
+#ifdef _RUNTIME_SAMPLE_RATE
+static void ReverbProcessResampled (S_REVERB_OBJECT *pReverbData, EAS_PCM *pSrc, EAS_PCM *pDst, EAS_I32 numSamples);
+#endif
+
+/*----------------------------------------------------------------------------
+ * reverbPresets
+ *----------------------------------------------------------------------------
+ * The room presets, shared read-only by every reverb instance in the
+ * process rather than copied into each one.
+ *----------------------------------------------------------------------------
+*/
+static const S_REVERB_PRESET_BANK reverbPresets =
+{
+    {
+        {
+            8307,   /* m_nLpfFbk */
+            14768,  /* m_nLpfFwd */
+            0,      /* m_nEarly */
+            27690,  /* m_nWet */
+            32767,  /* m_nDry */
+            3692,   /* m_nEarlyL_LpfFbk */
+            29075,  /* m_nEarlyL_LpfFwd */
+            922,    /* m_nEarlyL_Delay0 */
+            22152,  /* m_nEarlyL_Gain0 */
+            1462,   /* m_nEarlyL_Delay1 */
+            17537,  /* m_nEarlyL_Gain1 */
+            0,      /* m_nEarlyL_Delay2 */
+            14768,  /* m_nEarlyL_Gain2 */
+            1221,   /* m_nEarlyL_Delay3 */
+            14307,  /* m_nEarlyL_Gain3 */
+            0,      /* m_nEarlyL_Delay4 */
+            13384,  /* m_nEarlyL_Gain4 */
+            502,    /* m_nEarlyR_Delay0 */
+            20306,  /* m_nEarlyR_Gain0 */
+            1762,   /* m_nEarlyR_Delay1 */
+            17537,  /* m_nEarlyR_Gain1 */
+            0,      /* m_nEarlyR_Delay2 */
+            14768,  /* m_nEarlyR_Gain2 */
+            0,      /* m_nEarlyR_Delay3 */
+            16153,  /* m_nEarlyR_Gain3 */
+            0,      /* m_nEarlyR_Delay4 */
+            13384,  /* m_nEarlyR_Gain4 */
+            127,    /* m_nMaxExcursion */
+            6388,   /* m_nXfadeInterval */
+            15691,  /* m_nAp0_ApGain */
+            711,    /* m_nAp0_ApOut */
+            17999,  /* m_nAp1_ApGain */
+            1113,   /* m_nAp1_ApOut */
+            0,      /* m_rfu4 */
+            0,      /* m_rfu5 */
+            0,      /* m_rfu6 */
+            0,      /* m_rfu7 */
+            0,      /* m_rfu8 */
+            0,      /* m_rfu9 */
+            0       /* m_rfu10 */
+        },
+        {
+            6461,   /* m_nLpfFbk */
+            14307,  /* m_nLpfFwd */
+            0,      /* m_nEarly */
+            27690,  /* m_nWet */
+            32767,  /* m_nDry */
+            3692,   /* m_nEarlyL_LpfFbk */
+            29075,  /* m_nEarlyL_LpfFwd */
+            922,    /* m_nEarlyL_Delay0 */
+            22152,  /* m_nEarlyL_Gain0 */
+            1462,   /* m_nEarlyL_Delay1 */
+            17537,  /* m_nEarlyL_Gain1 */
+            0,      /* m_nEarlyL_Delay2 */
+            14768,  /* m_nEarlyL_Gain2 */
+            1221,   /* m_nEarlyL_Delay3 */
+            14307,  /* m_nEarlyL_Gain3 */
+            0,      /* m_nEarlyL_Delay4 */
+            13384,  /* m_nEarlyL_Gain4 */
+            502,    /* m_nEarlyR_Delay0 */
+            20306,  /* m_nEarlyR_Gain0 */
+            1762,   /* m_nEarlyR_Delay1 */
+            17537,  /* m_nEarlyR_Gain1 */
+            0,      /* m_nEarlyR_Delay2 */
+            14768,  /* m_nEarlyR_Gain2 */
+            0,      /* m_nEarlyR_Delay3 */
+            16153,  /* m_nEarlyR_Gain3 */
+            0,      /* m_nEarlyR_Delay4 */
+            13384,  /* m_nEarlyR_Gain4 */
+            127,    /* m_nMaxExcursion */
+            6391,   /* m_nXfadeInterval */
+            15230,  /* m_nAp0_ApGain */
+            708,    /* m_nAp0_ApOut */
+            9692,   /* m_nAp1_ApGain */
+            1113,   /* m_nAp1_ApOut */
+            0,      /* m_rfu4 */
+            0,      /* m_rfu5 */
+            0,      /* m_rfu6 */
+            0,      /* m_rfu7 */
+            0,      /* m_rfu8 */
+            0,      /* m_rfu9 */
+            0       /* m_rfu10 */
+        },
+        {
+            5077,   /* m_nLpfFbk */
+            12922,  /* m_nLpfFwd */
+            0,      /* m_nEarly */
+            24460,  /* m_nWet */
+            32767,  /* m_nDry */
+            3692,   /* m_nEarlyL_LpfFbk */
+            29075,  /* m_nEarlyL_LpfFwd */
+            922,    /* m_nEarlyL_Delay0 */
+            22152,  /* m_nEarlyL_Gain0 */
+            1462,   /* m_nEarlyL_Delay1 */
+            17537,  /* m_nEarlyL_Gain1 */
+            0,      /* m_nEarlyL_Delay2 */
+            14768,  /* m_nEarlyL_Gain2 */
+            1221,   /* m_nEarlyL_Delay3 */
+            14307,  /* m_nEarlyL_Gain3 */
+            0,      /* m_nEarlyL_Delay4 */
+            13384,  /* m_nEarlyL_Gain4 */
+            502,    /* m_nEarlyR_Delay0 */
+            20306,  /* m_nEarlyR_Gain0 */
+            1762,   /* m_nEarlyR_Delay1 */
+            17537,  /* m_nEarlyR_Gain1 */
+            0,      /* m_nEarlyR_Delay2 */
+            14768,  /* m_nEarlyR_Gain2 */
+            0,      /* m_nEarlyR_Delay3 */
+            16153,  /* m_nEarlyR_Gain3 */
+            0,      /* m_nEarlyR_Delay4 */
+            13384,  /* m_nEarlyR_Gain4 */
+            127,    /* m_nMaxExcursion */
+            6449,   /* m_nXfadeInterval */
+            15691,  /* m_nAp0_ApGain */
+            774,    /* m_nAp0_ApOut */
+            15691,  /* m_nAp1_ApGain */
+            1113,   /* m_nAp1_ApOut */
+            0,      /* m_rfu4 */
+            0,      /* m_rfu5 */
+            0,      /* m_rfu6 */
+            0,      /* m_rfu7 */
+            0,      /* m_rfu8 */
+            0,      /* m_rfu9 */
+            0       /* m_rfu10 */
+        },
+        {
+            5077,   /* m_nLpfFbk */
+            11076,  /* m_nLpfFwd */
+            0,      /* m_nEarly */
+            23075,  /* m_nWet */
+            32767,  /* m_nDry */
+            3692,   /* m_nEarlyL_LpfFbk */
+            29075,  /* m_nEarlyL_LpfFwd */
+            922,    /* m_nEarlyL_Delay0 */
+            22152,  /* m_nEarlyL_Gain0 */
+            1462,   /* m_nEarlyL_Delay1 */
+            17537,  /* m_nEarlyL_Gain1 */
+            0,      /* m_nEarlyL_Delay2 */
+            14768,  /* m_nEarlyL_Gain2 */
+            1221,   /* m_nEarlyL_Delay3 */
+            14307,  /* m_nEarlyL_Gain3 */
+            0,      /* m_nEarlyL_Delay4 */
+            13384,  /* m_nEarlyL_Gain4 */
+            502,    /* m_nEarlyR_Delay0 */
+            20306,  /* m_nEarlyR_Gain0 */
+            1762,   /* m_nEarlyR_Delay1 */
+            17537,  /* m_nEarlyR_Gain1 */
+            0,      /* m_nEarlyR_Delay2 */
+            14768,  /* m_nEarlyR_Gain2 */
+            0,      /* m_nEarlyR_Delay3 */
+            16153,  /* m_nEarlyR_Gain3 */
+            0,      /* m_nEarlyR_Delay4 */
+            13384,  /* m_nEarlyR_Gain4 */
+            127,    /* m_nMaxExcursion */
+            6470,   /* m_nXfadeInterval */
+            14768,  /* m_nAp0_ApGain */
+            792,    /* m_nAp0_ApOut */
+            15783,  /* m_nAp1_ApGain */
+            1113,   /* m_nAp1_ApOut */
+            0,      /* m_rfu4 */
+            0,      /* m_rfu5 */
+            0,      /* m_rfu6 */
+            0,      /* m_rfu7 */
+            0,      /* m_rfu8 */
+            0,      /* m_rfu9 */
+            0       /* m_rfu10 */
+        }
+    }
+};
 
 /* common effects interface for configuration module */
 const S_EFFECTS_INTERFACE EAS_Reverb =
@@ -56,7 +245,8 @@ const S_EFFECTS_INTERFACE EAS_Reverb =
     ReverbProcess,
     ReverbShutdown,
     ReverbGetParam,
-    ReverbSetParam
+    ReverbSetParam,
+    ReverbReset
 };
 
 
@@ -74,12 +264,7 @@ const S_EFFECTS_INTERFACE EAS_Reverb =
 */
 static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
 {
-    EAS_I32 i;
-    EAS_U16 nOffset;
-    EAS_INT temp;
-
     S_REVERB_OBJECT *pReverbData;
-    S_REVERB_PRESET *pPreset;
 
     /* check Configuration Module for data allocation */
     if (pEASData->staticMemoryModel)
@@ -98,7 +283,39 @@ static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
     /* clear the structure */
     EAS_HWMemSet(pReverbData, 0, sizeof(S_REVERB_OBJECT));
 
-    ReverbReadInPresets(pReverbData);
+    ReverbSetDefaults(pEASData, pReverbData);
+
+    *pInstData = pReverbData;
+
+    return EAS_SUCCESS;
+
+}   /* end InitializeReverb */
+
+/*----------------------------------------------------------------------------
+ * ReverbSetDefaults()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the reverb state after initialization, the presets must be read
+ *
+ * Inputs:
+ * pEASData - instance data, for the output rate
+ * pReverbData - cleared reverb instance data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbSetDefaults (EAS_DATA_HANDLE pEASData, S_REVERB_OBJECT *pReverbData)
+{
+    EAS_I32 i;
+    EAS_U16 nOffset;
+    EAS_INT temp;
+    const S_REVERB_PRESET *pPreset;
+
+#ifdef _RUNTIME_SAMPLE_RATE
+    /* the reverb always runs at the compiled rate */
+    pReverbData->m_nRateShift = ((S_EAS_DATA*) pEASData)->rateShift;
+#endif
 
     pReverbData->m_nMinSamplesToAdd = REVERB_UPDATE_PERIOD_IN_SAMPLES;
 
@@ -210,7 +427,7 @@ static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
     ////////////////////////////////
     ///code from the EAS DEMO Reverb
     //now copy from the new preset into the reverb
-    pPreset = &pReverbData->m_sPreset.m_sPreset[pReverbData->m_nNextRoom];
+    pPreset = &reverbPresets.m_sPreset[pReverbData->m_nNextRoom];
 
     pReverbData->m_nLpfFbk = pPreset->m_nLpfFbk;
     pReverbData->m_nLpfFwd = pPreset->m_nLpfFwd;
@@ -245,11 +462,29 @@ static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
     ///code from the EAS DEMO Reverb
     ////////////////////////////////
 
-    *pInstData = pReverbData;
+}
 
-    return EAS_SUCCESS;
+/*----------------------------------------------------------------------------
+ * ReverbReset()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the reverb to the state after ReverbInit
+ *
+ * Inputs:
+ * pEASData - instance data
+ * pInstData - reverb instance data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbReset (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData)
+{
+    S_REVERB_OBJECT *pReverbData = (S_REVERB_OBJECT*) pInstData;
 
-}   /* end InitializeReverb */
+    EAS_HWMemSet(pReverbData, 0, sizeof(S_REVERB_OBJECT));
+    ReverbSetDefaults(pEASData, pReverbData);
+}
 
 
 
@@ -292,9 +527,19 @@ static void ReverbProcess(EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst,
         ReverbUpdateRoom(pReverbData);
     }
 
-    ReverbUpdateXfade(pReverbData, numSamples);
+#ifdef _RUNTIME_SAMPLE_RATE
+    if (pReverbData->m_nRateShift)
+    {
+        ReverbProcessResampled(pReverbData, pSrc, pDst, numSamples);
+        numSamples >>= pReverbData->m_nRateShift;
+    }
+    else
+#endif
+    {
+        ReverbUpdateXfade(pReverbData, numSamples);
 
-    Reverb(pReverbData, numSamples, pDst, pSrc);
+        Reverb(pReverbData, numSamples, pDst, pSrc);
+    }
 
     /* check if update counter needs to be reset */
     if (pReverbData->m_nUpdateCounter >= REVERB_MODULO_UPDATE_PERIOD_IN_SAMPLES)
@@ -308,6 +553,93 @@ static void ReverbProcess(EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst,
 
 }   /* end ComputeReverb */
 
+#ifdef _RUNTIME_SAMPLE_RATE
+/*----------------------------------------------------------------------------
+ * ReverbProcessResampled()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reverberate a block for an instance whose output rate is a power of two
+ * multiple of the compiled rate. Each group of input samples is averaged
+ * down to the reverb rate, and the wet signal is linearly interpolated
+ * back up and added to the dry output.
+ *
+ * Inputs:
+ * pReverbData - reverb instance data
+ * pSrc - src buffer
+ * pDst - dst buffer (may be the same as pSrc)
+ * numSamples - number of output rate samples to process
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbProcessResampled (S_REVERB_OBJECT *pReverbData, EAS_PCM *pSrc, EAS_PCM *pDst, EAS_I32 numSamples)
+{
+    EAS_PCM input[BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS];
+    EAS_PCM wet[BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS];
+    EAS_I32 shift;
+    EAS_I32 count;
+    EAS_I32 i;
+    EAS_I32 j;
+    EAS_I32 ch;
+    EAS_I32 index;
+    EAS_I32 sum;
+    EAS_I32 prev;
+    EAS_I32 next;
+
+    shift = pReverbData->m_nRateShift;
+    while (numSamples > 0)
+    {
+        count = numSamples >> shift;
+        if (count > BUFFER_SIZE_IN_MONO_SAMPLES)
+            count = BUFFER_SIZE_IN_MONO_SAMPLES;
+        if (count == 0)
+            break;
+
+        /* average the input down to the reverb rate */
+        for (i = 0; i < count; i++)
+        {
+            for (ch = 0; ch < NUM_OUTPUT_CHANNELS; ch++)
+            {
+                sum = 0;
+                for (j = 0; j < (1 << shift); j++)
+                    sum += pSrc[((i << shift) + j) * NUM_OUTPUT_CHANNELS + ch];
+                /*lint -e{702} use shift for performance */
+                input[i * NUM_OUTPUT_CHANNELS + ch] = (EAS_PCM) (sum >> shift);
+            }
+        }
+
+        /* generate the wet signal only */
+        EAS_HWMemSet(wet, 0, count * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+        ReverbUpdateXfade(pReverbData, (EAS_INT) count);
+        Reverb(pReverbData, (EAS_INT) count, wet, input);
+
+        /* interpolate the wet signal back up and add it to the output */
+        for (ch = 0; ch < NUM_OUTPUT_CHANNELS; ch++)
+        {
+            prev = pReverbData->m_nPrevWet[ch];
+            for (i = 0; i < count; i++)
+            {
+                next = wet[i * NUM_OUTPUT_CHANNELS + ch];
+                for (j = 0; j < (1 << shift); j++)
+                {
+                    index = ((i << shift) + j) * NUM_OUTPUT_CHANNELS + ch;
+                    /*lint -e{702} use shift for performance */
+                    sum = pSrc[index] + prev + (((next - prev) * (j + 1)) >> shift);
+                    pDst[index] = (EAS_PCM) SATURATE(sum);
+                }
+                prev = next;
+            }
+            pReverbData->m_nPrevWet[ch] = (EAS_PCM) prev;
+        }
+
+        pSrc += (count << shift) * NUM_OUTPUT_CHANNELS;
+        pDst += (count << shift) * NUM_OUTPUT_CHANNELS;
+        numSamples -= count << shift;
+    }
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * ReverbUpdateXfade
  *----------------------------------------------------------------------------
@@ -505,270 +837,543 @@ static EAS_RESULT ReverbCalculateSinCos(EAS_I16 nPhase, EAS_I16 *pnSin, EAS_I16
 }   /* end ReverbCalculateSinCos */
 
 /*----------------------------------------------------------------------------
- * Reverb
+ * Vector kernels
+ *
+ * The early reflection taps are vectorized with NEON or SSE2 intrinsics
+ * when the target always provides them. Define _NO_SIMD_KERNEL to force
+ * the C reference code, the output is bit-exact either way.
+ *----------------------------------------------------------------------------
+*/
+#if !defined(_NO_SIMD_KERNEL)
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define _NEON_KERNEL
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#define _SSE2_KERNEL
+#include <emmintrin.h>
+#endif
+#endif
+
+#if defined(_NEON_KERNEL)
+/*----------------------------------------------------------------------------
+ * ReverbTapVector
  *----------------------------------------------------------------------------
  * Purpose:
- * apply reverb to the given signal
+ * NEON version of the early reflection tap loop, eight samples at a time.
+ * The tap walks backwards through the delay line, so each load is
+ * reversed into sample order.
  *
  * Inputs:
- * nNu
- * pnSin    - input old value, output new value
- * pnCos    - input old value, output new value
+ * pTap - delay line sample for the first output sample
+ * pEarlyOut - reflection sums, the tap is added to them
+ * numSamples - must be a multiple of eight
+ * gain - tap gain, must not be -32768
  *
  * Outputs:
- * number of samples actually reverberated
  *
- * Side Effects:
+ *----------------------------------------------------------------------------
+*/
+static void ReverbTapVector(const EAS_PCM *pTap, EAS_PCM *pEarlyOut, EAS_I32 numSamples, EAS_I32 gain)
+{
+    int16x8_t vGain;
+    int16x8_t vTap;
+    EAS_I32 k;
+
+    vGain = vdupq_n_s16((int16_t) gain);
+    for (k = 0; k < numSamples; k += 8)
+    {
+        vTap = vrev64q_s16(vld1q_s16(pTap - k - 7));
+        vTap = vcombine_s16(vget_high_s16(vTap), vget_low_s16(vTap));
+
+        /* (2 * tap * gain) >> 16 is MULT_EG1_EG1 */
+        vTap = vqdmulhq_s16(vTap, vGain);
+        vst1q_s16(pEarlyOut + k, vqaddq_s16(vld1q_s16(pEarlyOut + k), vTap));
+    }
+}
+#elif defined(_SSE2_KERNEL)
+/*----------------------------------------------------------------------------
+ * ReverbTapVector
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * SSE2 version of the early reflection tap loop, eight samples at a time.
+ * The tap walks backwards through the delay line, so each load is
+ * reversed into sample order.
+ *
+ * Inputs:
+ * pTap - delay line sample for the first output sample
+ * pEarlyOut - reflection sums, the tap is added to them
+ * numSamples - must be a multiple of eight
+ * gain - tap gain, must not be -32768
+ *
+ * Outputs:
  *
  *----------------------------------------------------------------------------
 */
-static EAS_RESULT Reverb(S_REVERB_OBJECT *pReverbData, EAS_INT nNumSamplesToAdd, EAS_PCM *pOutputBuffer, EAS_PCM *pInputBuffer)
+static void ReverbTapVector(const EAS_PCM *pTap, EAS_PCM *pEarlyOut, EAS_I32 numSamples, EAS_I32 gain)
+{
+    __m128i vGain;
+    __m128i vTap;
+    __m128i vLo;
+    __m128i vHi;
+    EAS_I32 k;
+
+    vGain = _mm_set1_epi16((short) gain);
+    for (k = 0; k < numSamples; k += 8)
+    {
+        vTap = _mm_loadu_si128((const __m128i*) (pTap - k - 7));
+        vTap = _mm_shuffle_epi32(vTap, _MM_SHUFFLE(1, 0, 3, 2));
+        vTap = _mm_shufflelo_epi16(vTap, _MM_SHUFFLE(0, 1, 2, 3));
+        vTap = _mm_shufflehi_epi16(vTap, _MM_SHUFFLE(0, 1, 2, 3));
+
+        /* MULT_EG1_EG1 from the high and low halves of the product */
+        vLo = _mm_mullo_epi16(vTap, vGain);
+        vHi = _mm_mulhi_epi16(vTap, vGain);
+        vTap = _mm_or_si128(_mm_slli_epi16(vHi, 1), _mm_srli_epi16(vLo, 15));
+        _mm_storeu_si128((__m128i*) (pEarlyOut + k),
+            _mm_adds_epi16(_mm_loadu_si128((const __m128i*) (pEarlyOut + k)), vTap));
+    }
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * ReverbBlockLength
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns how many samples the late reverb can run ahead of the early
+ * reflections. The early reflections of a block are computed after the
+ * late reverb has written the whole block into the delay line, so no
+ * block may be longer than the distance from an active reflection tap
+ * forward to a delay line input, or the tap would read a sample written
+ * after its time.
+ *
+ * Inputs:
+ * pReverbData - reverb instance data
+ *
+ * Outputs:
+ * samples per block, at most REVERB_BLOCK_SIZE
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 ReverbBlockLength(const S_REVERB_OBJECT *pReverbData)
 {
+    const S_EARLY_REFLECTION_OBJECT *pEarly;
+    EAS_I32 nInputs[4];
+    EAS_I32 nLength;
+    EAS_I32 nDistance;
     EAS_I32 i;
-    EAS_I32 nDelayOut;
-    EAS_U16 nBase;
+    EAS_I32 j;
+    EAS_I32 k;
+
+    nInputs[0] = pReverbData->m_sAp0.m_zApIn;
+    nInputs[1] = pReverbData->m_sAp1.m_zApIn;
+    nInputs[2] = pReverbData->m_zD0In;
+    nInputs[3] = pReverbData->m_zD1In;
+
+    nLength = REVERB_BLOCK_SIZE;
+    for (i = 0; i < 2; i++)
+    {
+        pEarly = (i == 0) ? &pReverbData->m_sEarlyL : &pReverbData->m_sEarlyR;
+        for (j = 0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
+        {
+            if (pEarly->m_nGain[j] == 0)
+                continue;
+            for (k = 0; k < 4; k++)
+            {
+                nDistance = (nInputs[k] - (EAS_I32) pEarly->m_zDelay[j]) & REVERB_BUFFER_MASK;
+                if ((nDistance > 0) && (nDistance < nLength))
+                    nLength = nDistance;
+            }
+        }
+    }
+    return nLength;
+}
 
+/*----------------------------------------------------------------------------
+ * ReverbEarly
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Generates the early reflections for one channel of a block, filters
+ * them, adds the late reverb and mixes the wet signal into the output.
+ * Each reflection is one tap walking backwards through the delay line.
+ * Its span is split at the buffer wrap into at most two linear runs, so
+ * the multiply-accumulate over a run is one vector loop. Taps with no
+ * gain are skipped.
+ *
+ * Inputs:
+ * pReverbData - reverb instance data
+ * pEarly - early reflections for this channel
+ * nBase - base index of the first sample in the block
+ * nNumSamples - samples in the block
+ * pLate - late reverb output for each sample
+ * pOutputBuffer - interleaved output, the wet signal is added to it
+ *
+ * Outputs:
+ * largest magnitude of the wet signal in the block
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 ReverbEarly(S_REVERB_OBJECT *pReverbData, S_EARLY_REFLECTION_OBJECT *pEarly, EAS_U16 nBase,
+    EAS_I32 nNumSamples, const EAS_PCM *pLate, EAS_PCM *pOutputBuffer)
+{
+    EAS_PCM nEarlyOut[REVERB_BLOCK_SIZE];
+    const EAS_PCM *pTap;
     EAS_U32 nAddr;
+    EAS_I32 nSpan;
+    EAS_I32 nGain;
     EAS_I32 nTemp1;
     EAS_I32 nTemp2;
-    EAS_I32 nApIn;
-    EAS_I32 nApOut;
-
-    EAS_I32 j;
-    EAS_I32 nEarlyOut;
-
+    EAS_I32 nPeak;
     EAS_I32 tempValue;
+    EAS_I32 i;
+    EAS_I32 j;
+    EAS_I32 k;
 
+    for (i = 0; i < nNumSamples; i++)
+        nEarlyOut[i] = 0;
 
-    // get the base address
-    nBase = pReverbData->m_nBaseIndex;
-
-    for (i=0; i < nNumSamplesToAdd; i++)
+    for (j = 0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
     {
-        // ********** Left Allpass - start
-        // left input = (left dry/4) + right feedback from previous period
-        /*lint -e{702} use shift for performance */
-        nApIn = ((*pInputBuffer++)>>2) + pReverbData->m_nRevOutFbkR;
-//      nApIn = *pInputBuffer++;    // 1xxx test and debug ap
+        nGain = pEarly->m_nGain[j];
+        if (nGain == 0)
+            continue;
 
-        // fetch allpass delay line out
-        //nAddr = CIRCULAR(nBase, psAp0->m_zApOut, REVERB_BUFFER_MASK);
-        nAddr = CIRCULAR(nBase, pReverbData->m_sAp0.m_zApOut, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
-
-        // calculate allpass feedforward; subtract the feedforward result
-        nTemp1 = MULT_EG1_EG1(nApIn, pReverbData->m_sAp0.m_nApGain);
-        nApOut = SATURATE(nDelayOut - nTemp1);          // allpass output
+        nAddr = CIRCULAR(nBase, pEarly->m_zDelay[j], REVERB_BUFFER_MASK);
+        for (i = 0; i < nNumSamples; i += nSpan)
+        {
+            /* run down to the start of the buffer, then wrap to the end */
+            nSpan = nNumSamples - i;
+            if (nSpan > (EAS_I32) nAddr + 1)
+                nSpan = (EAS_I32) nAddr + 1;
+            pTap = &pReverbData->m_nDelayLine[nAddr];
+            k = 0;
+#if defined(_NEON_KERNEL) || defined(_SSE2_KERNEL)
+            /* the vector multiply cannot represent -1 * -1 */
+            if (nGain != -32768)
+            {
+                k = nSpan & ~7;
+                ReverbTapVector(pTap, &nEarlyOut[i], k, nGain);
+            }
+#endif
+            for (; k < nSpan; k++)
+            {
+                // calculate reflection
+                nTemp1 = MULT_EG1_EG1(pTap[-k], nGain);
+                nEarlyOut[i + k] = (EAS_PCM) SATURATE(nEarlyOut[i + k] + nTemp1);
+            }
+            nAddr = REVERB_BUFFER_MASK;
+        }
+    }
 
-        // calculate allpass feedback; add the feedback result
-        nTemp1 = MULT_EG1_EG1(nApOut, pReverbData->m_sAp0.m_nApGain);
-        nTemp1 = SATURATE(nApIn + nTemp1);
+    nPeak = 0;
+    for (i = 0; i < nNumSamples; i++)
+    {
+        // apply lowpass to early reflections
+        nTemp1 = MULT_EG1_EG1(nEarlyOut[i], pEarly->m_nLpfFwd);
 
-        // inject into allpass delay
-        nAddr = CIRCULAR(nBase, pReverbData->m_sAp0.m_zApIn, REVERB_BUFFER_MASK);
-        pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nTemp1;
+        nTemp2 = MULT_EG1_EG1(pEarly->m_zLpf, pEarly->m_nLpfFbk);
 
-        // inject allpass output into delay line
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD0In, REVERB_BUFFER_MASK);
-        pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nApOut;
+        // calculate filtered out and simultaneously update LPF state variable
+        pEarly->m_zLpf = (EAS_PCM) SATURATE(nTemp1 + nTemp2);
 
-        // ********** Left Allpass - end
+        // combine filtered early and late reflections for output
+        tempValue = SATURATE((EAS_I32)pEarly->m_zLpf + (EAS_I32)pLate[i]);
+        //scale reverb output by wet level
+        /*lint -e{701} use shift for performance */
+        tempValue = MULT_EG1_EG1(tempValue, (pReverbData->m_nWet<<1));
+        if (tempValue > nPeak)
+            nPeak = tempValue;
+        else if (-tempValue > nPeak)
+            nPeak = -tempValue;
+        //sum with output buffer
+        tempValue += pOutputBuffer[i * NUM_OUTPUT_CHANNELS];
+        pOutputBuffer[i * NUM_OUTPUT_CHANNELS] = (EAS_PCM)SATURATE(tempValue);
+    }
 
-        // ********** Right Allpass - start
-        // right input = (right dry/4) + left feedback from previous period
-        /*lint -e{702} use shift for performance */
-        nApIn = ((*pInputBuffer++)>>2) + pReverbData->m_nRevOutFbkL;
-//      nApIn = *pInputBuffer++;    // 1xxx test and debug ap
+    return nPeak;
+}
 
-        // fetch allpass delay line out
-        nAddr = CIRCULAR(nBase, pReverbData->m_sAp1.m_zApOut, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+#ifdef _REVERB_TAIL_BYPASS
+/*----------------------------------------------------------------------------
+ * ReverbClearTail
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Clears the delay line and filter states once the tail has died away so
+ * the reverb can be skipped until the input is no longer silent. Clearing
+ * also removes the limit cycle, so processing resumes from silence.
+ *
+ * Inputs:
+ * pReverbData - reverb instance data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbClearTail(S_REVERB_OBJECT *pReverbData)
+{
+    EAS_HWMemSet(pReverbData->m_nDelayLine, 0, (EAS_I32) sizeof(pReverbData->m_nDelayLine));
+    pReverbData->m_nRevOutFbkL = 0;
+    pReverbData->m_nRevOutFbkR = 0;
+    pReverbData->m_zLpf0 = 0;
+    pReverbData->m_zLpf1 = 0;
+    pReverbData->m_sEarlyL.m_zLpf = 0;
+    pReverbData->m_sEarlyR.m_zLpf = 0;
+    pReverbData->m_nSilentSamples = 0;
+    pReverbData->m_bTailIdle = EAS_TRUE;
+}
+#endif
 
-        // calculate allpass feedforward; subtract the feedforward result
-        nTemp1 = MULT_EG1_EG1(nApIn, pReverbData->m_sAp1.m_nApGain);
-        nApOut = SATURATE(nDelayOut - nTemp1);          // allpass output
+/*----------------------------------------------------------------------------
+ * Reverb
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * apply reverb to the given signal
+ *
+ * The late reverb is recursive from one sample to the next and runs one
+ * sample at a time. The early reflections only read the delay line, so
+ * they are computed a block at a time afterwards by ReverbEarly.
+ *
+ * Inputs:
+ * nNumSamplesToAdd - number of samples to reverberate
+ * pOutputBuffer - interleaved output, the wet signal is added to it
+ * pInputBuffer - interleaved input
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT Reverb(S_REVERB_OBJECT *pReverbData, EAS_INT nNumSamplesToAdd, EAS_PCM *pOutputBuffer, EAS_PCM *pInputBuffer)
+{
+    EAS_PCM nLateL[REVERB_BLOCK_SIZE];
+    EAS_PCM nLateR[REVERB_BLOCK_SIZE];
+    EAS_I32 nBlockLength;
+    EAS_I32 nCount;
+    EAS_I32 nPeak;
+    EAS_U16 nBlockBase;
 
-        // calculate allpass feedback; add the feedback result
-        nTemp1 = MULT_EG1_EG1(nApOut, pReverbData->m_sAp1.m_nApGain);
-        nTemp1 = SATURATE(nApIn + nTemp1);
+    EAS_I32 i;
+    EAS_I32 nDelayOut;
+    EAS_U16 nBase;
 
-        // inject into allpass delay
-        nAddr = CIRCULAR(nBase, pReverbData->m_sAp1.m_zApIn, REVERB_BUFFER_MASK);
-        pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nTemp1;
+    EAS_U32 nAddr;
+    EAS_I32 nTemp1;
+    EAS_I32 nTemp2;
+    EAS_I32 nApIn;
+    EAS_I32 nApOut;
 
-        // inject allpass output into delay line
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD1In, REVERB_BUFFER_MASK);
-        pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nApOut;
+#ifdef _REVERB_TAIL_BYPASS
+    EAS_I32 nNumSamples;
+    EAS_BOOL bSilent;
 
-        // ********** Right Allpass - end
+    /* nothing to do while the input is silent and the tail has died away */
+    nNumSamples = nNumSamplesToAdd;
+    bSilent = EAS_TRUE;
+    for (i = 0; i < nNumSamplesToAdd * NUM_OUTPUT_CHANNELS; i++)
+    {
+        if (pInputBuffer[i] != 0)
+        {
+            bSilent = EAS_FALSE;
+            break;
+        }
+    }
+    if (!bSilent)
+    {
+        pReverbData->m_nSilentSamples = 0;
+        pReverbData->m_bTailIdle = EAS_FALSE;
+    }
+    else if (pReverbData->m_bTailIdle)
+    {
+        /* keep the modulation running as if the samples were processed */
+        pReverbData->m_nBaseIndex = (EAS_U16) (pReverbData->m_nBaseIndex - nNumSamplesToAdd);
+        pReverbData->m_nSin = (EAS_I16) (pReverbData->m_nSin + pReverbData->m_nSinIncrement * nNumSamplesToAdd);
+        pReverbData->m_nCos = (EAS_I16) (pReverbData->m_nCos + pReverbData->m_nCosIncrement * nNumSamplesToAdd);
+        return EAS_SUCCESS;
+    }
+#endif
 
-        // ********** D0 output - start
-        // fetch delay line self out
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD0Self, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+    // get the base address
+    nBase = pReverbData->m_nBaseIndex;
+    nBlockLength = ReverbBlockLength(pReverbData);
+    nPeak = 0;
 
-        // calculate delay line self out
-        nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nSin);
+    while (nNumSamplesToAdd > 0)
+    {
+        nCount = (nNumSamplesToAdd < nBlockLength) ? nNumSamplesToAdd : nBlockLength;
+        nBlockBase = nBase;
 
-        // fetch delay line cross out
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD1Cross, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+        for (i=0; i < nCount; i++)
+        {
+            // ********** Left Allpass - start
+            // left input = (left dry/4) + right feedback from previous period
+            /*lint -e{702} use shift for performance */
+            nApIn = ((*pInputBuffer++)>>2) + pReverbData->m_nRevOutFbkR;
+//          nApIn = *pInputBuffer++;    // 1xxx test and debug ap
+
+            // fetch allpass delay line out
+            //nAddr = CIRCULAR(nBase, psAp0->m_zApOut, REVERB_BUFFER_MASK);
+            nAddr = CIRCULAR(nBase, pReverbData->m_sAp0.m_zApOut, REVERB_BUFFER_MASK);
+            nDelayOut = pReverbData->m_nDelayLine[nAddr];
 
-        // calculate delay line self out
-        nTemp2 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nCos);
+            // calculate allpass feedforward; subtract the feedforward result
+            nTemp1 = MULT_EG1_EG1(nApIn, pReverbData->m_sAp0.m_nApGain);
+            nApOut = SATURATE(nDelayOut - nTemp1);          // allpass output
 
-        // calculate unfiltered delay out
-        nDelayOut = SATURATE(nTemp1 + nTemp2);
+            // calculate allpass feedback; add the feedback result
+            nTemp1 = MULT_EG1_EG1(nApOut, pReverbData->m_sAp0.m_nApGain);
+            nTemp1 = SATURATE(nApIn + nTemp1);
 
-        // calculate lowpass filter (mixer scale factor included in LPF feedforward)
-        nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nLpfFwd);
+            // inject into allpass delay
+            nAddr = CIRCULAR(nBase, pReverbData->m_sAp0.m_zApIn, REVERB_BUFFER_MASK);
+            pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nTemp1;
 
-        nTemp2 = MULT_EG1_EG1(pReverbData->m_zLpf0, pReverbData->m_nLpfFbk);
+            // inject allpass output into delay line
+            nAddr = CIRCULAR(nBase, pReverbData->m_zD0In, REVERB_BUFFER_MASK);
+            pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nApOut;
 
-        // calculate filtered delay out and simultaneously update LPF state variable
-        // filtered delay output is stored in m_zLpf0
-        pReverbData->m_zLpf0 = (EAS_PCM) SATURATE(nTemp1 + nTemp2);
+            // ********** Left Allpass - end
 
-        // ********** D0 output - end
+            // ********** Right Allpass - start
+            // right input = (right dry/4) + left feedback from previous period
+            /*lint -e{702} use shift for performance */
+            nApIn = ((*pInputBuffer++)>>2) + pReverbData->m_nRevOutFbkL;
+//          nApIn = *pInputBuffer++;    // 1xxx test and debug ap
 
-        // ********** D1 output - start
-        // fetch delay line self out
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD1Self, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+            // fetch allpass delay line out
+            nAddr = CIRCULAR(nBase, pReverbData->m_sAp1.m_zApOut, REVERB_BUFFER_MASK);
+            nDelayOut = pReverbData->m_nDelayLine[nAddr];
 
-        // calculate delay line self out
-        nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nSin);
+            // calculate allpass feedforward; subtract the feedforward result
+            nTemp1 = MULT_EG1_EG1(nApIn, pReverbData->m_sAp1.m_nApGain);
+            nApOut = SATURATE(nDelayOut - nTemp1);          // allpass output
 
-        // fetch delay line cross out
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD0Cross, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+            // calculate allpass feedback; add the feedback result
+            nTemp1 = MULT_EG1_EG1(nApOut, pReverbData->m_sAp1.m_nApGain);
+            nTemp1 = SATURATE(nApIn + nTemp1);
 
-        // calculate delay line self out
-        nTemp2 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nCos);
+            // inject into allpass delay
+            nAddr = CIRCULAR(nBase, pReverbData->m_sAp1.m_zApIn, REVERB_BUFFER_MASK);
+            pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nTemp1;
 
-        // calculate unfiltered delay out
-        nDelayOut = SATURATE(nTemp1 + nTemp2);
+            // inject allpass output into delay line
+            nAddr = CIRCULAR(nBase, pReverbData->m_zD1In, REVERB_BUFFER_MASK);
+            pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nApOut;
 
-        // calculate lowpass filter (mixer scale factor included in LPF feedforward)
-        nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nLpfFwd);
+            // ********** Right Allpass - end
 
-        nTemp2 = MULT_EG1_EG1(pReverbData->m_zLpf1, pReverbData->m_nLpfFbk);
+            // ********** D0 output - start
+            // fetch delay line self out
+            nAddr = CIRCULAR(nBase, pReverbData->m_zD0Self, REVERB_BUFFER_MASK);
+            nDelayOut = pReverbData->m_nDelayLine[nAddr];
 
-        // calculate filtered delay out and simultaneously update LPF state variable
-        // filtered delay output is stored in m_zLpf1
-        pReverbData->m_zLpf1 = (EAS_PCM)SATURATE(nTemp1 + nTemp2);
+            // calculate delay line self out
+            nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nSin);
 
-        // ********** D1 output - end
+            // fetch delay line cross out
+            nAddr = CIRCULAR(nBase, pReverbData->m_zD1Cross, REVERB_BUFFER_MASK);
+            nDelayOut = pReverbData->m_nDelayLine[nAddr];
 
-        // ********** mixer and feedback - start
-        // sum is fedback to right input (R + L)
-        pReverbData->m_nRevOutFbkL =
-            (EAS_PCM)SATURATE((EAS_I32)pReverbData->m_zLpf1 + (EAS_I32)pReverbData->m_zLpf0);
+            // calculate delay line self out
+            nTemp2 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nCos);
 
-        // difference is feedback to left input (R - L)
-        /*lint -e{685} lint complains that it can't saturate negative */
-        pReverbData->m_nRevOutFbkR =
-            (EAS_PCM)SATURATE((EAS_I32)pReverbData->m_zLpf1 - (EAS_I32)pReverbData->m_zLpf0);
+            // calculate unfiltered delay out
+            nDelayOut = SATURATE(nTemp1 + nTemp2);
 
-        // ********** mixer and feedback - end
+            // calculate lowpass filter (mixer scale factor included in LPF feedforward)
+            nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nLpfFwd);
 
-        // ********** start early reflection generator, left
-        //psEarly = &(pReverbData->m_sEarlyL);
+            nTemp2 = MULT_EG1_EG1(pReverbData->m_zLpf0, pReverbData->m_nLpfFbk);
 
-        nEarlyOut = 0;
+            // calculate filtered delay out and simultaneously update LPF state variable
+            // filtered delay output is stored in m_zLpf0
+            pReverbData->m_zLpf0 = (EAS_PCM) SATURATE(nTemp1 + nTemp2);
 
-        for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
-        {
-            // fetch delay line out
-            //nAddr = CIRCULAR(nBase, psEarly->m_zDelay[j], REVERB_BUFFER_MASK);
-            nAddr = CIRCULAR(nBase, pReverbData->m_sEarlyL.m_zDelay[j], REVERB_BUFFER_MASK);
+            // ********** D0 output - end
 
+            // ********** D1 output - start
+            // fetch delay line self out
+            nAddr = CIRCULAR(nBase, pReverbData->m_zD1Self, REVERB_BUFFER_MASK);
             nDelayOut = pReverbData->m_nDelayLine[nAddr];
 
-            // calculate reflection
-            //nTemp1 = MULT_EG1_EG1(nDelayOut, psEarly->m_nGain[j]);
-            nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_sEarlyL.m_nGain[j]);
-
-            nEarlyOut = SATURATE(nEarlyOut + nTemp1);
+            // calculate delay line self out
+            nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nSin);
 
-        }   // end for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
-
-        // apply lowpass to early reflections
-        //nTemp1 = MULT_EG1_EG1(nEarlyOut, psEarly->m_nLpfFwd);
-        nTemp1 = MULT_EG1_EG1(nEarlyOut, pReverbData->m_sEarlyL.m_nLpfFwd);
-
-        //nTemp2 = MULT_EG1_EG1(psEarly->m_zLpf, psEarly->m_nLpfFbk);
-        nTemp2 = MULT_EG1_EG1(pReverbData->m_sEarlyL.m_zLpf, pReverbData->m_sEarlyL.m_nLpfFbk);
-
-
-        // calculate filtered out and simultaneously update LPF state variable
-        // filtered output is stored in m_zLpf1
-        //psEarly->m_zLpf = SATURATE(nTemp1 + nTemp2);
-        pReverbData->m_sEarlyL.m_zLpf = (EAS_PCM) SATURATE(nTemp1 + nTemp2);
-
-        // combine filtered early and late reflections for output
-        //*pOutputBuffer++ = inL;
-        //tempValue = SATURATE(psEarly->m_zLpf + pReverbData->m_nRevOutFbkL);
-        tempValue = SATURATE((EAS_I32)pReverbData->m_sEarlyL.m_zLpf + (EAS_I32)pReverbData->m_nRevOutFbkL);
-        //scale reverb output by wet level
-        /*lint -e{701} use shift for performance */
-        tempValue = MULT_EG1_EG1(tempValue, (pReverbData->m_nWet<<1));
-        //sum with output buffer
-        tempValue += *pOutputBuffer;
-        *pOutputBuffer++ = (EAS_PCM)SATURATE(tempValue);
+            // fetch delay line cross out
+            nAddr = CIRCULAR(nBase, pReverbData->m_zD0Cross, REVERB_BUFFER_MASK);
+            nDelayOut = pReverbData->m_nDelayLine[nAddr];
 
-        // ********** end early reflection generator, left
+            // calculate delay line self out
+            nTemp2 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nCos);
 
-        // ********** start early reflection generator, right
-        //psEarly = &(pReverbData->m_sEarlyR);
+            // calculate unfiltered delay out
+            nDelayOut = SATURATE(nTemp1 + nTemp2);
 
-        nEarlyOut = 0;
+            // calculate lowpass filter (mixer scale factor included in LPF feedforward)
+            nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nLpfFwd);
 
-        for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
-        {
-            // fetch delay line out
-            nAddr = CIRCULAR(nBase, pReverbData->m_sEarlyR.m_zDelay[j], REVERB_BUFFER_MASK);
-            nDelayOut = pReverbData->m_nDelayLine[nAddr];
+            nTemp2 = MULT_EG1_EG1(pReverbData->m_zLpf1, pReverbData->m_nLpfFbk);
 
-            // calculate reflection
-            nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_sEarlyR.m_nGain[j]);
+            // calculate filtered delay out and simultaneously update LPF state variable
+            // filtered delay output is stored in m_zLpf1
+            pReverbData->m_zLpf1 = (EAS_PCM)SATURATE(nTemp1 + nTemp2);
 
-            nEarlyOut = SATURATE(nEarlyOut + nTemp1);
+            // ********** D1 output - end
 
-        }   // end for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
+            // ********** mixer and feedback - start
+            // sum is fedback to right input (R + L)
+            pReverbData->m_nRevOutFbkL =
+                (EAS_PCM)SATURATE((EAS_I32)pReverbData->m_zLpf1 + (EAS_I32)pReverbData->m_zLpf0);
 
-        // apply lowpass to early reflections
-        nTemp1 = MULT_EG1_EG1(nEarlyOut, pReverbData->m_sEarlyR.m_nLpfFwd);
+            // difference is feedback to left input (R - L)
+            /*lint -e{685} lint complains that it can't saturate negative */
+            pReverbData->m_nRevOutFbkR =
+                (EAS_PCM)SATURATE((EAS_I32)pReverbData->m_zLpf1 - (EAS_I32)pReverbData->m_zLpf0);
 
-        nTemp2 = MULT_EG1_EG1(pReverbData->m_sEarlyR.m_zLpf, pReverbData->m_sEarlyR.m_nLpfFbk);
+            // ********** mixer and feedback - end
 
-        // calculate filtered out and simultaneously update LPF state variable
-        // filtered output is stored in m_zLpf1
-        pReverbData->m_sEarlyR.m_zLpf = (EAS_PCM)SATURATE(nTemp1 + nTemp2);
+            nLateL[i] = pReverbData->m_nRevOutFbkL;
+            nLateR[i] = pReverbData->m_nRevOutFbkR;
 
-        // combine filtered early and late reflections for output
-        //*pOutputBuffer++ = inR;
-        tempValue = SATURATE((EAS_I32)pReverbData->m_sEarlyR.m_zLpf + (EAS_I32)pReverbData->m_nRevOutFbkR);
-        //scale reverb output by wet level
-        /*lint -e{701} use shift for performance */
-        tempValue = MULT_EG1_EG1(tempValue, (pReverbData->m_nWet << 1));
-        //sum with output buffer
-        tempValue = tempValue + *pOutputBuffer;
-        *pOutputBuffer++ = (EAS_PCM)SATURATE(tempValue);
+            // decrement base addr for next sample period
+            nBase--;
 
-        // ********** end early reflection generator, right
+            pReverbData->m_nSin += pReverbData->m_nSinIncrement;
+            pReverbData->m_nCos += pReverbData->m_nCosIncrement;
 
-        // decrement base addr for next sample period
-        nBase--;
+        }   // end for (i=0; i < nCount; i++)
 
-        pReverbData->m_nSin += pReverbData->m_nSinIncrement;
-        pReverbData->m_nCos += pReverbData->m_nCosIncrement;
+        // ********** early reflection generators and output mix
+        nTemp1 = ReverbEarly(pReverbData, &pReverbData->m_sEarlyL, nBlockBase, nCount, nLateL, pOutputBuffer);
+        nTemp2 = ReverbEarly(pReverbData, &pReverbData->m_sEarlyR, nBlockBase, nCount, nLateR, pOutputBuffer + 1);
+        if (nTemp1 > nPeak)
+            nPeak = nTemp1;
+        if (nTemp2 > nPeak)
+            nPeak = nTemp2;
 
-    }   // end for (i=0; i < nNumSamplesToAdd; i++)
+        pOutputBuffer += nCount * NUM_OUTPUT_CHANNELS;
+        nNumSamplesToAdd -= nCount;
+    }
 
     // store the most up to date version
     pReverbData->m_nBaseIndex = nBase;
 
+#ifdef _REVERB_TAIL_BYPASS
+    /* bypass once only the limit cycle of the tail is left */
+    if (bSilent)
+    {
+        if (nPeak > REVERB_TAIL_THRESHOLD)
+            pReverbData->m_nSilentSamples = 0;
+        else
+        {
+            pReverbData->m_nSilentSamples += nNumSamples;
+            if (pReverbData->m_nSilentSamples >= REVERB_TAIL_SAMPLES)
+                ReverbClearTail(pReverbData);
+        }
+    }
+#else
+    (void) nPeak;
+#endif
+
     return EAS_SUCCESS;
 }   /* end Reverb */
 
@@ -915,7 +1520,7 @@ static EAS_RESULT ReverbUpdateRoom(S_REVERB_OBJECT *pReverbData)
 {
     EAS_INT temp;
 
-    S_REVERB_PRESET *pPreset = &pReverbData->m_sPreset.m_sPreset[pReverbData->m_nNextRoom];
+    const S_REVERB_PRESET *pPreset = &reverbPresets.m_sPreset[pReverbData->m_nNextRoom];
 
     pReverbData->m_nLpfFwd = pPreset->m_nLpfFwd;
     pReverbData->m_nLpfFbk = pPreset->m_nLpfFbk;
@@ -954,201 +1559,3 @@ static EAS_RESULT ReverbUpdateRoom(S_REVERB_OBJECT *pReverbData)
 }   /* end ReverbUpdateRoom */
 
 
-/*----------------------------------------------------------------------------
- * ReverbReadInPresets()
- *----------------------------------------------------------------------------
- * Purpose: sets global reverb preset bank to defaults
- *
- * Inputs:
- *
- * Outputs:
- *
- *----------------------------------------------------------------------------
-*/
-static EAS_RESULT ReverbReadInPresets(S_REVERB_OBJECT *pReverbData)
-{
-
-    int preset = 0;
-    int defaultPreset = 0;
-
-    //now init any remaining presets to defaults
-    for (defaultPreset = preset; defaultPreset < REVERB_MAX_ROOM_TYPE; defaultPreset++)
-    {
-        S_REVERB_PRESET *pPreset = &pReverbData->m_sPreset.m_sPreset[defaultPreset];
-        if (defaultPreset == 0 || defaultPreset > REVERB_MAX_ROOM_TYPE-1)
-        {
-            pPreset->m_nLpfFbk = 8307;
-            pPreset->m_nLpfFwd = 14768;
-            pPreset->m_nEarly = 0;
-            pPreset->m_nWet = 27690;
-            pPreset->m_nDry = 32767;
-            pPreset->m_nEarlyL_LpfFbk = 3692;
-            pPreset->m_nEarlyL_LpfFwd = 29075;
-            pPreset->m_nEarlyL_Delay0 = 922;
-            pPreset->m_nEarlyL_Gain0 = 22152;
-            pPreset->m_nEarlyL_Delay1 = 1462;
-            pPreset->m_nEarlyL_Gain1 = 17537;
-            pPreset->m_nEarlyL_Delay2 = 0;
-            pPreset->m_nEarlyL_Gain2 = 14768;
-            pPreset->m_nEarlyL_Delay3 = 1221;
-            pPreset->m_nEarlyL_Gain3 = 14307;
-            pPreset->m_nEarlyL_Delay4 = 0;
-            pPreset->m_nEarlyL_Gain4 = 13384;
-            pPreset->m_nEarlyR_Delay0 = 502;
-            pPreset->m_nEarlyR_Gain0 = 20306;
-            pPreset->m_nEarlyR_Delay1 = 1762;
-            pPreset->m_nEarlyR_Gain1 = 17537;
-            pPreset->m_nEarlyR_Delay2 = 0;
-            pPreset->m_nEarlyR_Gain2 = 14768;
-            pPreset->m_nEarlyR_Delay3 = 0;
-            pPreset->m_nEarlyR_Gain3 = 16153;
-            pPreset->m_nEarlyR_Delay4 = 0;
-            pPreset->m_nEarlyR_Gain4 = 13384;
-            pPreset->m_nMaxExcursion = 127;
-            pPreset->m_nXfadeInterval = 6388;
-            pPreset->m_nAp0_ApGain = 15691;
-            pPreset->m_nAp0_ApOut = 711;
-            pPreset->m_nAp1_ApGain = 17999;
-            pPreset->m_nAp1_ApOut = 1113;
-            pPreset->m_rfu4 = 0;
-            pPreset->m_rfu5 = 0;
-            pPreset->m_rfu6 = 0;
-            pPreset->m_rfu7 = 0;
-            pPreset->m_rfu8 = 0;
-            pPreset->m_rfu9 = 0;
-            pPreset->m_rfu10 = 0;
-        }
-        else if (defaultPreset == 1)
-        {
-            pPreset->m_nLpfFbk = 6461;
-            pPreset->m_nLpfFwd = 14307;
-            pPreset->m_nEarly = 0;
-            pPreset->m_nWet = 27690;
-            pPreset->m_nDry = 32767;
-            pPreset->m_nEarlyL_LpfFbk = 3692;
-            pPreset->m_nEarlyL_LpfFwd = 29075;
-            pPreset->m_nEarlyL_Delay0 = 922;
-            pPreset->m_nEarlyL_Gain0 = 22152;
-            pPreset->m_nEarlyL_Delay1 = 1462;
-            pPreset->m_nEarlyL_Gain1 = 17537;
-            pPreset->m_nEarlyL_Delay2 = 0;
-            pPreset->m_nEarlyL_Gain2 = 14768;
-            pPreset->m_nEarlyL_Delay3 = 1221;
-            pPreset->m_nEarlyL_Gain3 = 14307;
-            pPreset->m_nEarlyL_Delay4 = 0;
-            pPreset->m_nEarlyL_Gain4 = 13384;
-            pPreset->m_nEarlyR_Delay0 = 502;
-            pPreset->m_nEarlyR_Gain0 = 20306;
-            pPreset->m_nEarlyR_Delay1 = 1762;
-            pPreset->m_nEarlyR_Gain1 = 17537;
-            pPreset->m_nEarlyR_Delay2 = 0;
-            pPreset->m_nEarlyR_Gain2 = 14768;
-            pPreset->m_nEarlyR_Delay3 = 0;
-            pPreset->m_nEarlyR_Gain3 = 16153;
-            pPreset->m_nEarlyR_Delay4 = 0;
-            pPreset->m_nEarlyR_Gain4 = 13384;
-            pPreset->m_nMaxExcursion = 127;
-            pPreset->m_nXfadeInterval = 6391;
-            pPreset->m_nAp0_ApGain = 15230;
-            pPreset->m_nAp0_ApOut = 708;
-            pPreset->m_nAp1_ApGain = 9692;
-            pPreset->m_nAp1_ApOut = 1113;
-            pPreset->m_rfu4 = 0;
-            pPreset->m_rfu5 = 0;
-            pPreset->m_rfu6 = 0;
-            pPreset->m_rfu7 = 0;
-            pPreset->m_rfu8 = 0;
-            pPreset->m_rfu9 = 0;
-            pPreset->m_rfu10 = 0;
-        }
-        else if (defaultPreset == 2)
-        {
-            pPreset->m_nLpfFbk = 5077;
-            pPreset->m_nLpfFwd = 12922;
-            pPreset->m_nEarly = 0;
-            pPreset->m_nWet = 24460;
-            pPreset->m_nDry = 32767;
-            pPreset->m_nEarlyL_LpfFbk = 3692;
-            pPreset->m_nEarlyL_LpfFwd = 29075;
-            pPreset->m_nEarlyL_Delay0 = 922;
-            pPreset->m_nEarlyL_Gain0 = 22152;
-            pPreset->m_nEarlyL_Delay1 = 1462;
-            pPreset->m_nEarlyL_Gain1 = 17537;
-            pPreset->m_nEarlyL_Delay2 = 0;
-            pPreset->m_nEarlyL_Gain2 = 14768;
-            pPreset->m_nEarlyL_Delay3 = 1221;
-            pPreset->m_nEarlyL_Gain3 = 14307;
-            pPreset->m_nEarlyL_Delay4 = 0;
-            pPreset->m_nEarlyL_Gain4 = 13384;
-            pPreset->m_nEarlyR_Delay0 = 502;
-            pPreset->m_nEarlyR_Gain0 = 20306;
-            pPreset->m_nEarlyR_Delay1 = 1762;
-            pPreset->m_nEarlyR_Gain1 = 17537;
-            pPreset->m_nEarlyR_Delay2 = 0;
-            pPreset->m_nEarlyR_Gain2 = 14768;
-            pPreset->m_nEarlyR_Delay3 = 0;
-            pPreset->m_nEarlyR_Gain3 = 16153;
-            pPreset->m_nEarlyR_Delay4 = 0;
-            pPreset->m_nEarlyR_Gain4 = 13384;
-            pPreset->m_nMaxExcursion = 127;
-            pPreset->m_nXfadeInterval = 6449;
-            pPreset->m_nAp0_ApGain = 15691;
-            pPreset->m_nAp0_ApOut = 774;
-            pPreset->m_nAp1_ApGain = 15691;
-            pPreset->m_nAp1_ApOut = 1113;
-            pPreset->m_rfu4 = 0;
-            pPreset->m_rfu5 = 0;
-            pPreset->m_rfu6 = 0;
-            pPreset->m_rfu7 = 0;
-            pPreset->m_rfu8 = 0;
-            pPreset->m_rfu9 = 0;
-            pPreset->m_rfu10 = 0;
-        }
-        else if (defaultPreset == 3)
-        {
-            pPreset->m_nLpfFbk = 5077;
-            pPreset->m_nLpfFwd = 11076;
-            pPreset->m_nEarly = 0;
-            pPreset->m_nWet = 23075;
-            pPreset->m_nDry = 32767;
-            pPreset->m_nEarlyL_LpfFbk = 3692;
-            pPreset->m_nEarlyL_LpfFwd = 29075;
-            pPreset->m_nEarlyL_Delay0 = 922;
-            pPreset->m_nEarlyL_Gain0 = 22152;
-            pPreset->m_nEarlyL_Delay1 = 1462;
-            pPreset->m_nEarlyL_Gain1 = 17537;
-            pPreset->m_nEarlyL_Delay2 = 0;
-            pPreset->m_nEarlyL_Gain2 = 14768;
-            pPreset->m_nEarlyL_Delay3 = 1221;
-            pPreset->m_nEarlyL_Gain3 = 14307;
-            pPreset->m_nEarlyL_Delay4 = 0;
-            pPreset->m_nEarlyL_Gain4 = 13384;
-            pPreset->m_nEarlyR_Delay0 = 502;
-            pPreset->m_nEarlyR_Gain0 = 20306;
-            pPreset->m_nEarlyR_Delay1 = 1762;
-            pPreset->m_nEarlyR_Gain1 = 17537;
-            pPreset->m_nEarlyR_Delay2 = 0;
-            pPreset->m_nEarlyR_Gain2 = 14768;
-            pPreset->m_nEarlyR_Delay3 = 0;
-            pPreset->m_nEarlyR_Gain3 = 16153;
-            pPreset->m_nEarlyR_Delay4 = 0;
-            pPreset->m_nEarlyR_Gain4 = 13384;
-            pPreset->m_nMaxExcursion = 127;
-            pPreset->m_nXfadeInterval = 6470;   //6483;
-            pPreset->m_nAp0_ApGain = 14768;
-            pPreset->m_nAp0_ApOut = 792;
-            pPreset->m_nAp1_ApGain = 15783;
-            pPreset->m_nAp1_ApOut = 1113;
-            pPreset->m_rfu4 = 0;
-            pPreset->m_rfu5 = 0;
-            pPreset->m_rfu6 = 0;
-            pPreset->m_rfu7 = 0;
-            pPreset->m_rfu8 = 0;
-            pPreset->m_rfu9 = 0;
-            pPreset->m_rfu10 = 0;
-
-        }
-    }
-
-    return EAS_SUCCESS;
-}
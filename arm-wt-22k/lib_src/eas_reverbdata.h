@@ -93,6 +93,21 @@ if the buffer size is a power of two.
 #define REVERB_MAX_ROOM_TYPE            4   // any room numbers larger than this are invalid
 #define REVERB_MAX_NUM_REFLECTIONS      5   // max num reflections per channel
 
+/* the early reflections are generated in blocks of at most this many samples */
+#define REVERB_BLOCK_SIZE               64
+
+#ifdef _REVERB_TAIL_BYPASS
+/*
+The fixed point feedback never decays to zero, it settles into a limit
+cycle of up to about a hundred LSBs depending on the room. Once the input
+has been silent and the wet output at or below REVERB_TAIL_THRESHOLD
+(about -48 dB) for REVERB_TAIL_SAMPLES, only the limit cycle is left and
+the reverb is bypassed until the input returns.
+*/
+#define REVERB_TAIL_THRESHOLD           128
+#define REVERB_TAIL_SAMPLES             _OUTPUT_SAMPLE_RATE
+#endif
+
 /* synth parameters are updated every SYNTH_UPDATE_PERIOD_IN_SAMPLES */
 #define REVERB_UPDATE_PERIOD_IN_SAMPLES (EAS_I32)(0x1L << REVERB_UPDATE_PERIOD_IN_BITS)
 
@@ -351,6 +366,18 @@ typedef struct
 
     EAS_I16             m_nEarly;                   // gain for early (widen) signal
 
+#ifdef _REVERB_TAIL_BYPASS
+    EAS_I32             m_nSilentSamples;           // samples of silent input with an inaudible tail
+
+    EAS_BOOL            m_bTailIdle;                // if EAS_TRUE, the tail has been cleared and processing is skipped
+#endif
+
+#ifdef _RUNTIME_SAMPLE_RATE
+    EAS_I32             m_nRateShift;               // output rate is the reverb rate << m_nRateShift
+
+    EAS_PCM             m_nPrevWet[NUM_OUTPUT_CHANNELS];    // last wet sample of the previous block
+#endif
+
     S_EARLY_REFLECTION_OBJECT   m_sEarlyL;          // left channel early reflections
     S_EARLY_REFLECTION_OBJECT   m_sEarlyR;          // right channel early reflections
 
@@ -358,8 +385,6 @@ typedef struct
 
     S_REVERB_PRESET     pPreset;
 
-    S_REVERB_PRESET_BANK    m_sPreset;
-
     //EAS_I8            preset;
 
 } S_REVERB_OBJECT;
@@ -449,20 +474,6 @@ static EAS_RESULT ReverbCalculateSinCos(EAS_I16 nPhase, EAS_I16 *pnSin, EAS_I16
 */
 static EAS_RESULT Reverb(S_REVERB_OBJECT* pReverbData, EAS_INT nNumSamplesToAdd, EAS_PCM *pOutputBuffer, EAS_PCM *pInputBuffer);
 
-/*----------------------------------------------------------------------------
- * ReverbReadInPresets()
- *----------------------------------------------------------------------------
- * Purpose: sets global reverb preset bank to defaults
- *
- * Inputs:
- *
- * Outputs:
- *
- *----------------------------------------------------------------------------
-*/
-static EAS_RESULT ReverbReadInPresets(S_REVERB_OBJECT* pReverbData);
-
-
 /*----------------------------------------------------------------------------
  * ReverbUpdateRoom
  *----------------------------------------------------------------------------
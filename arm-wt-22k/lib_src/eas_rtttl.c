@@ -27,6 +27,9 @@
  *----------------------------------------------------------------------------
 */
 
+/* allocations of this module are reported as parser state */
+#define EAS_MEM_CATEGORY    EAS_MEM_PARSERS
+
 #include "eas_data.h"
 #include "eas_miditypes.h"
 #include "eas_parser.h"
@@ -36,6 +39,7 @@
 #include "eas_config.h"
 #include "eas_vm_protos.h"
 #include "eas_rtttldata.h"
+#include "eas_tonecache.h"
 #include "eas_ctype.h"
 
 /* increase gain for mono ringtones */
@@ -81,6 +85,10 @@ static EAS_RESULT RTTTL_GetNumber (EAS_HW_DATA_HANDLE hwInstData, S_RTTTL_DATA *
 static EAS_RESULT RTTTL_ParseHeader (S_EAS_DATA *pEASData, S_RTTTL_DATA* pData, EAS_BOOL metaData);
 static EAS_RESULT RTTTL_GetNextChar (EAS_HW_DATA_HANDLE hwInstData, S_RTTTL_DATA *pData, EAS_I8 *pValue);
 static EAS_RESULT RTTTL_PeekNextChar (EAS_HW_DATA_HANDLE hwInstData, S_RTTTL_DATA *pData, EAS_I8 *pValue);
+#ifdef _RINGTONE_COMPILE_EVENTS
+static EAS_RESULT RTTTL_CompileEvents (S_EAS_DATA *pEASData, S_RTTTL_DATA *pData);
+static EAS_RESULT RTTTL_PlayEvent (S_EAS_DATA *pEASData, S_RTTTL_DATA *pData, EAS_INT parserMode);
+#endif
 
 /* inline functions */
 EAS_INLINE void RTTTL_PutBackChar (S_RTTTL_DATA *pData, EAS_I8 value) { pData->dataByte = value; }
@@ -202,15 +210,21 @@ static EAS_RESULT RTTTL_Prepare (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     }
 
     pData->state = EAS_STATE_ERROR;
+    /* the instance data is freed by RTTTL_Close */
     if ((result = RTTTL_ParseHeader (pEASData,  pData, (EAS_BOOL) (pData->metadata.callback != NULL))) != EAS_SUCCESS)
-    {
-        /* if using dynamic memory, free it */
-        if (!pEASData->staticMemoryModel)
-            EAS_HWFree(pEASData->hwInstData, pData);
         return result;
-    }
 
     pData->state = EAS_STATE_READY;
+
+#ifdef _RINGTONE_COMPILE_EVENTS
+    /* unroll the notes into an event list, a metadata probe reads the file once */
+    if (!pEASData->staticMemoryModel && (pData->pSynth != NULL))
+    {
+        if ((result = RTTTL_CompileEvents(pEASData, pData)) != EAS_SUCCESS)
+            return result;
+    }
+#endif
+
     return EAS_SUCCESS;
 }
 
@@ -276,21 +290,30 @@ static EAS_RESULT RTTTL_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS
     if (pData->state >= EAS_STATE_OPEN)
         return EAS_SUCCESS;
 
+#ifdef _RINGTONE_COMPILE_EVENTS
+    /* play from the compiled event list */
+    if (pData->events != NULL)
+        return RTTTL_PlayEvent(pEASData, pData, parserMode);
+#endif
+
     /* initialize MIDI channel when the track starts playing */
     if (pData->time == 0)
     {
         /* set program to square lead */
-        VMProgramChange(pEASData->pVoiceMgr, pData->pSynth, RTTTL_CHANNEL, RTTTL_PROGRAM);
+        if (parserMode != eParserModeMetaData)
+            VMProgramChange(pEASData->pVoiceMgr, pData->pSynth, RTTTL_CHANNEL, RTTTL_PROGRAM);
 
         /* set channel volume to max */
-        VMControlChange(pEASData->pVoiceMgr, pData->pSynth, RTTTL_CHANNEL, 7, 127);
+        if (parserMode != eParserModeMetaData)
+            VMControlChange(pEASData->pVoiceMgr, pData->pSynth, RTTTL_CHANNEL, 7, 127);
     }
 
     /* check for end of note */
     if (pData->note)
     {
         /* stop the note */
-        VMStopNote(pEASData->pVoiceMgr, pData->pSynth, RTTTL_CHANNEL, pData->note, 0);
+        if (parserMode != eParserModeMetaData)
+            VMStopNote(pEASData->pVoiceMgr, pData->pSynth, RTTTL_CHANNEL, pData->note, 0);
         pData->note = 0;
 
         /* check for rest between notes */
@@ -598,6 +621,12 @@ static EAS_RESULT RTTTL_Close (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     if (pData->pSynth != NULL)
         VMMIDIShutdown(pEASData, pData->pSynth);
 
+#ifdef _RINGTONE_COMPILE_EVENTS
+    /* free the compiled event list */
+    if (pData->events != NULL)
+        EAS_HWFree(pEASData->hwInstData, pData->events);
+#endif
+
     /* if using dynamic memory, free it */
     if (!pEASData->staticMemoryModel)
         EAS_HWFree(pEASData->hwInstData, pData);
@@ -635,6 +664,9 @@ static EAS_RESULT RTTTL_Reset (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     /* reset time to zero */
     pData->time = 0;
     pData->note = 0;
+#ifdef _RINGTONE_COMPILE_EVENTS
+    pData->eventIndex = 0;
+#endif
 
     /* reset file position and re-parse header */
     pData->state = EAS_STATE_ERROR;
@@ -1233,3 +1265,197 @@ static EAS_RESULT RTTTL_PeekNextChar (EAS_HW_DATA_HANDLE hwInstData, S_RTTTL_DAT
     }
 }
 
+
+#ifdef _RINGTONE_COMPILE_EVENTS
+/*----------------------------------------------------------------------------
+ * RTTTL_CompileEvents()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses the whole file once and saves the notes and rests in an event
+ * list, so that playback and locating don't read the file. Finite repeats
+ * are unrolled. Files with an infinite loop or a parsing error are left to
+ * be parsed from the file.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pData            - pointer to parser instance data
+ *
+ * Outputs:
+ * Returns EAS_SUCCESS if the file is to be parsed from the file.
+ *
+ * Side Effects:
+ * The parser state is restored when done.
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT RTTTL_CompileEvents (S_EAS_DATA *pEASData, S_RTTTL_DATA *pData)
+{
+    S_RTTTL_DATA saved;
+    S_TONE_EVENT *pEvents;
+    S_TONE_EVENT *pEvent;
+    EAS_I32 filePos;
+    EAS_I32 time;
+    EAS_U32 numEvents;
+    EAS_U32 maxEvents;
+    EAS_RESULT result;
+    EAS_BOOL rest;
+#ifdef _RINGTONE_EVENT_CACHE
+    S_TONE_CACHE_KEY key;
+#endif
+
+    /* infinite loops are only played in play mode */
+    if (pData->repeatCount == RTTTL_INFINITE_LOOP)
+        return EAS_SUCCESS;
+
+    /* save the parser state, the walk below uses the parser */
+    if ((result = EAS_HWFilePos(pEASData->hwInstData, pData->fileHandle, &filePos)) != EAS_SUCCESS)
+        return result;
+#ifdef _RINGTONE_EVENT_CACHE
+    /* a ringtone compiled before is copied from the cache */
+    if ((result = EAS_ToneCacheLookup(pEASData, pData->fileHandle, TONE_CACHE_RTTTL, &key, &pData->events, &pData->numEvents)) != EAS_SUCCESS)
+        return result;
+    if (pData->events != NULL)
+    {
+        pData->eventIndex = 0;
+        return EAS_HWFileSeek(pEASData->hwInstData, pData->fileHandle, filePos);
+    }
+    if ((result = EAS_HWFileSeek(pEASData->hwInstData, pData->fileHandle, filePos)) != EAS_SUCCESS)
+        return result;
+#endif
+    saved = *pData;
+
+    pEvents = NULL;
+    numEvents = 0;
+    maxEvents = 0;
+    for (;;)
+    {
+        /* a call that ends the rest after a note adds no event */
+        rest = (pData->note != 0) && (pData->restTicks != 0);
+        time = pData->time;
+        if ((result = RTTTL_Event(pEASData, pData, eParserModeMetaData)) != EAS_SUCCESS)
+            break;
+        if (pData->state == EAS_STATE_STOPPING)
+            break;
+        if (rest || ((pData->note == 0) && (pData->time == time)))
+            continue;
+
+        /* grow the event list */
+        if (numEvents == maxEvents)
+        {
+            S_TONE_EVENT *pTemp;
+
+            if (maxEvents >= TONE_MAX_EVENTS)
+            {
+                result = EAS_ERROR_DATA_INCONSISTENCY;
+                break;
+            }
+            maxEvents += TONE_EVENT_BLOCK_SIZE;
+            if ((pTemp = EAS_HWMalloc(pEASData->hwInstData, (EAS_I32) (maxEvents * sizeof(S_TONE_EVENT)))) == NULL)
+            {
+                result = EAS_ERROR_MALLOC_FAILED;
+                break;
+            }
+            if (pEvents != NULL)
+            {
+                EAS_HWMemCpy(pTemp, pEvents, (EAS_I32) (numEvents * sizeof(S_TONE_EVENT)));
+                EAS_HWFree(pEASData->hwInstData, pEvents);
+            }
+            pEvents = pTemp;
+        }
+
+        /* save the note or rest */
+        pEvent = &pEvents[numEvents++];
+        pEvent->ticks = pData->time - time;
+        pEvent->restTicks = pData->note ? pData->restTicks : 0;
+        pEvent->note = pData->note;
+        pEvent->velocity = RTTTL_VELOCITY;
+    }
+
+    /* restore the parser state */
+    *pData = saved;
+    if ((result == EAS_SUCCESS) && (numEvents != 0))
+    {
+        pData->events = pEvents;
+        pData->numEvents = numEvents;
+        pData->eventIndex = 0;
+#ifdef _RINGTONE_EVENT_CACHE
+        EAS_ToneCacheStore(pEASData, &key, pEvents, numEvents);
+#endif
+    }
+    else
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "RTTTL_CompileEvents: parsing from file, error %d\n", result); */ }
+        if (pEvents != NULL)
+            EAS_HWFree(pEASData->hwInstData, pEvents);
+    }
+    return EAS_HWFileSeek(pEASData->hwInstData, pData->fileHandle, filePos);
+}
+
+/*----------------------------------------------------------------------------
+ * RTTTL_PlayEvent()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Plays the next event from the compiled event list, the same way
+ * RTTTL_Event plays it from the file
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pData            - pointer to parser instance data
+ * parserMode       - parser mode
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT RTTTL_PlayEvent (S_EAS_DATA *pEASData, S_RTTTL_DATA *pData, EAS_INT parserMode)
+{
+    S_TONE_EVENT *pEvent;
+
+    /* initialize MIDI channel when the track starts playing */
+    if ((pData->time == 0) && (parserMode != eParserModeMetaData))
+    {
+        VMProgramChange(pEASData->pVoiceMgr, pData->pSynth, RTTTL_CHANNEL, RTTTL_PROGRAM);
+        VMControlChange(pEASData->pVoiceMgr, pData->pSynth, RTTTL_CHANNEL, 7, 127);
+    }
+
+    /* check for end of note */
+    if (pData->note)
+    {
+        if (parserMode != eParserModeMetaData)
+            VMStopNote(pEASData->pVoiceMgr, pData->pSynth, RTTTL_CHANNEL, pData->note, 0);
+        pData->note = 0;
+
+        /* check for rest between notes */
+        if (pData->restTicks)
+        {
+            pData->time += pData->restTicks;
+            pData->restTicks = 0;
+            return EAS_SUCCESS;
+        }
+    }
+
+    /* end of the list */
+    if (pData->eventIndex >= pData->numEvents)
+    {
+        pData->state = EAS_STATE_STOPPING;
+        VMReleaseAllVoices(pEASData->pVoiceMgr, pData->pSynth);
+        return EAS_SUCCESS;
+    }
+
+    /* start the note */
+    pEvent = &pData->events[pData->eventIndex++];
+    if (pEvent->note)
+    {
+        pData->note = pEvent->note;
+        pData->restTicks = pEvent->restTicks;
+        if (parserMode == eParserModePlay)
+            VMStartNote(pEASData->pVoiceMgr, pData->pSynth, RTTTL_CHANNEL, pData->note, pEvent->velocity);
+    }
+    pData->time += pEvent->ticks;
+
+    pData->state = EAS_STATE_PLAY;
+    return EAS_SUCCESS;
+}
+#endif
@@ -33,6 +33,7 @@
 #define EAS_RTTTLDATA_H
 
 #include "eas_data.h"
+#include "eas_miditypes.h"
 
 
 /* maximum line size as specified in iMelody V1.2 spec */
@@ -64,6 +65,11 @@ typedef struct
     EAS_U8      note;                       /* MIDI note number */
     EAS_U8      octave;                     /* decault octave prefix */
     EAS_I8      duration;                   /* default note duration */
+#ifdef _RINGTONE_COMPILE_EVENTS
+    S_TONE_EVENT *events;                   /* notes and rests of the whole file */
+    EAS_U32     numEvents;                  /* number of compiled events */
+    EAS_U32     eventIndex;                 /* index of next event */
+#endif
 } S_RTTTL_DATA;
 
 #endif
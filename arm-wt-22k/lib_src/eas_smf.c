@@ -29,8 +29,8 @@
  *----------------------------------------------------------------------------
 */
 
-#define LOG_TAG "Sonivox"
-#include "log/log.h"
+/* allocations of this module are reported as parser state */
+#define EAS_MEM_CATEGORY    EAS_MEM_PARSERS
 
 #include "eas_data.h"
 #include "eas_miditypes.h"
@@ -38,10 +38,12 @@
 #include "eas_report.h"
 #include "eas_host.h"
 #include "eas_midi.h"
+#include "eas_midictrl.h"
 #include "eas_config.h"
 #include "eas_vm_protos.h"
 #include "eas_smfdata.h"
 #include "eas_smf.h"
+#include "eas_diag.h"
 
 #ifdef JET_INTERFACE
 #include "jet_data.h"
@@ -61,6 +63,146 @@ static EAS_RESULT SMF_ParseSysEx (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_
 static EAS_RESULT SMF_ParseEvent (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_SMF_STREAM *pSMFStream, EAS_INT parserMode);
 static EAS_RESULT SMF_GetDeltaTime (EAS_HW_DATA_HANDLE hwInstData, S_SMF_STREAM *pSMFStream);
 static void SMF_UpdateTime (S_SMF_DATA *pSMFData, EAS_U32 ticks);
+static void SMF_SetTempo (S_SMF_DATA *pSMFData, EAS_U32 tempo);
+static void SMF_UpdateChaseMode (S_SMF_DATA *pSMFData, S_SMF_STREAM *pSMFStream);
+static S_SMF_STREAM *SMF_NextStream (S_SMF_DATA *pSMFData, S_SMF_STREAM *pSMFStream);
+#ifdef _SMF_TRACK_TREE
+static EAS_U16 SMF_TreeWinner (S_SMF_DATA *pSMFData, EAS_INT node);
+static void SMF_InitTree (S_SMF_DATA *pSMFData);
+#endif
+#ifdef _SMF_FAST_METADATA
+static EAS_RESULT SMF_SkipEvent (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_SMF_STREAM *pSMFStream);
+static EAS_RESULT SMF_ScanStreams (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData);
+#ifdef _SMF_COMPILE_EVENTS
+static EAS_RESULT SMF_ScanEvents (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData);
+#endif
+#endif
+#ifdef _SMF_COMPILE_EVENTS
+static EAS_RESULT SMF_CompileEvents (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData);
+static EAS_RESULT SMF_CompileEvent (S_EAS_DATA *pEASData, S_SMF_STREAM *pSMFStream, S_SMF_EVENT *pEvent, EAS_U8 *pRunningStatus);
+static EAS_RESULT SMF_PlayEvent (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, EAS_INT parserMode);
+#ifdef _COALESCE_CONTROLLERS
+static EAS_BOOL SMF_IsControllerValue (const S_SMF_EVENT *pEvent);
+static EAS_BOOL SMF_Superseded (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, const S_SMF_EVENT *pEvent);
+#endif
+#ifdef _LOOKAHEAD_PREFETCH
+static void SMF_PrefetchNotes (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, EAS_I32 endTime);
+#endif
+#endif
+#ifdef _SMF_SEEK_INDEX
+static void SMF_RecordCheckpoint (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData);
+static EAS_RESULT SMF_RestoreCheckpoint (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, EAS_I32 time);
+static void SMF_FreeSeekIndex (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData);
+#endif
+#ifdef _PROGRESSIVE_FILES
+static EAS_RESULT SMF_HeaderAvailable (EAS_HW_DATA_HANDLE hwInstData, S_SMF_DATA *pSMFData);
+static EAS_RESULT SMF_EventAvailable (EAS_HW_DATA_HANDLE hwInstData, S_SMF_DATA *pSMFData, S_SMF_STREAM *pSMFStream, EAS_BOOL *pAvailable);
+static void SMF_DataArrived (S_SMF_DATA *pSMFData);
+#endif
+#ifdef _POSITION_REPORT
+static EAS_RESULT SMF_TickPosition (S_SMF_DATA *pSMFData, EAS_I32 *pValue);
+#endif
+
+#ifdef _PROGRESSIVE_FILES
+/* longest channel message and longest delta time, in bytes */
+#define SMF_MAX_MESSAGE_SIZE        3
+#define SMF_MAX_DELTA_SIZE          4
+#endif
+
+#ifdef _SMF_COMPILE_EVENTS
+/* limit on the size of the compiled event list, larger files are parsed from the file */
+#ifndef SMF_MAX_EVENTS
+#define SMF_MAX_EVENTS              65536
+#endif
+
+/* the compiled event list grows in blocks of this many events */
+#define SMF_EVENT_BLOCK_SIZE        1024
+
+#ifdef _COALESCE_CONTROLLERS
+/* events looked at for a later value of the same controller */
+#ifndef SMF_COALESCE_WINDOW
+#define SMF_COALESCE_WINDOW         32
+#endif
+#endif
+
+#ifdef _LOOKAHEAD_PREFETCH
+/* events looked at for the notes of the next frame */
+#ifndef SMF_PREFETCH_WINDOW
+#define SMF_PREFETCH_WINDOW         64
+#endif
+#endif
+#endif
+
+#ifdef _SMF_SEEK_INDEX
+/*----------------------------------------------------------------------------
+ * Seek index
+ *
+ * While locating, a checkpoint of the parser and channel state is recorded
+ * at least SMF_CHECKPOINT_INTERVAL msecs apart. A later locate restores the
+ * nearest checkpoint before the requested time and only parses the events
+ * after it. When the table is full, every other checkpoint is dropped and
+ * the interval is doubled.
+ *----------------------------------------------------------------------------
+*/
+#ifndef SMF_MAX_CHECKPOINTS
+#define SMF_MAX_CHECKPOINTS         32
+#endif
+
+#ifndef SMF_CHECKPOINT_INTERVAL
+#define SMF_CHECKPOINT_INTERVAL     1000
+#endif
+#endif
+
+#if defined(_SMF_SEEK_INDEX) || defined(_ENGINE_SNAPSHOT)
+typedef struct
+{
+    EAS_I32             filePos;            /* file position of next event */
+    EAS_U32             ticks;              /* time of next event in stream */
+    S_MIDI_STREAM       midiStream;         /* MIDI stream state */
+} S_SMF_CHECKPOINT_STREAM;
+
+/* each checkpoint is followed by one S_SMF_CHECKPOINT_STREAM per stream */
+typedef struct
+{
+    EAS_I32             time;               /* time of next event in milliseconds/256 */
+    EAS_U16             tickConv;           /* MIDI tick to msec conversion */
+    EAS_U16             nextStream;         /* index of next stream with event */
+    EAS_U8              flags;              /* parser flags */
+#ifdef _SMF_COMPILE_EVENTS
+    EAS_U32             eventIndex;         /* index of next compiled event */
+#endif
+    S_SYNTH_CHANNEL     channels[NUM_SYNTH_CHANNELS];
+    S_SYNTH_CHANNEL_STATE channelState[NUM_SYNTH_CHANNELS];
+} S_SMF_CHECKPOINT;
+
+static EAS_RESULT SMF_SaveCheckpoint (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_SMF_CHECKPOINT *pCheckpoint);
+static EAS_RESULT SMF_LoadCheckpoint (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, const S_SMF_CHECKPOINT *pCheckpoint);
+#endif
+
+#ifdef _ENGINE_SNAPSHOT
+/* a snapshot of the parser is this header followed by a checkpoint */
+typedef struct
+{
+    EAS_I32             numStreams;
+    EAS_I32             state;              /* parser state, a checkpoint is always played */
+} S_SMF_SNAPSHOT;
+
+static EAS_RESULT SMF_SaveState (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_SMF_SNAPSHOT *pSnapshot);
+static EAS_RESULT SMF_RestoreState (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, const S_SMF_SNAPSHOT *pSnapshot);
+#endif
+
+#ifdef _SMF_SEEK_INDEX
+typedef struct s_smf_seek_index_tag
+{
+    S_SMF_CHECKPOINT    *checkpoints[SMF_MAX_CHECKPOINTS];
+    EAS_I32             interval;           /* minimum msecs between checkpoints */
+    EAS_I32             nextTime;           /* earliest time for next checkpoint in msecs */
+#ifdef DLS_SYNTHESIZER
+    S_DLS               *pDLS;              /* collection the checkpoints were recorded with */
+#endif
+    EAS_U16             numCheckpoints;
+} S_SMF_SEEK_INDEX;
+#endif
 
 
 /*----------------------------------------------------------------------------
@@ -89,7 +231,11 @@ const S_FILE_PARSER_INTERFACE EAS_SMF_Parser =
     NULL,
     SMF_SetData,
     SMF_GetData,
+#ifdef _SMF_FAST_METADATA
+    SMF_GetMetaData
+#else
     NULL
+#endif
 };
 
 /*----------------------------------------------------------------------------
@@ -193,6 +339,15 @@ EAS_RESULT SMF_Prepare (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     if (pSMFData->state != EAS_STATE_OPEN)
         return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
 
+#ifdef _PROGRESSIVE_FILES
+    /* a partial file can't be prepared until every track has started to arrive */
+    if (pSMFData->flags & SMF_FLAGS_PROGRESSIVE)
+    {
+        if ((result = SMF_HeaderAvailable(pEASData->hwInstData, pSMFData)) != EAS_SUCCESS)
+            return result;
+    }
+#endif
+
     /* instantiate a synthesizer */
     if ((result = VMInitMIDI(pEASData, &pSMFData->pSynth)) != EAS_SUCCESS)
     {
@@ -204,6 +359,19 @@ EAS_RESULT SMF_Prepare (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     if ((result = SMF_ParseHeader(pEASData->hwInstData, pSMFData)) != EAS_SUCCESS)
         return result;
 
+#ifdef _SMF_COMPILE_EVENTS
+    /* merge the streams into a single event list, a metadata probe reads the streams once */
+    if (!pEASData->staticMemoryModel && (pSMFData->pSynth != NULL)
+#ifdef _PROGRESSIVE_FILES
+        && !(pSMFData->flags & SMF_FLAGS_PROGRESSIVE)
+#endif
+        )
+    {
+        if ((result = SMF_CompileEvents(pEASData, pSMFData)) != EAS_SUCCESS)
+            return result;
+    }
+#endif
+
     /* ready to play */
     pSMFData->state = EAS_STATE_READY;
     return EAS_SUCCESS;
@@ -284,9 +452,10 @@ EAS_RESULT SMF_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_INT pars
 {
     S_SMF_DATA* pSMFData;
     EAS_RESULT result;
-    EAS_I32 i;
     EAS_U32 ticks;
-    EAS_U32 temp;
+#ifdef _SMF_SEEK_INDEX
+    EAS_I32 time;
+#endif
 
     /* establish pointer to instance data */
     pSMFData = (S_SMF_DATA*) pInstData;
@@ -297,6 +466,31 @@ EAS_RESULT SMF_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_INT pars
         return EAS_ERROR_FILE_FORMAT;
     }
 
+#ifdef _SMF_COMPILE_EVENTS
+    /* play from the compiled event list */
+    if (pSMFData->events != NULL)
+        return SMF_PlayEvent(pEASData, pSMFData, parserMode);
+#endif
+
+#ifdef _PROGRESSIVE_FILES
+    /* wait for the rest of the event, the stream time stops until it arrives */
+    if (pSMFData->flags & SMF_FLAGS_PROGRESSIVE)
+    {
+        EAS_BOOL available;
+
+        if ((result = SMF_EventAvailable(pEASData->hwInstData, pSMFData, pSMFData->nextStream, &available)) != EAS_SUCCESS)
+            return result;
+        if (!available)
+        {
+            /* only playback can wait, a locate or metadata scan can't get past the data */
+            if (parserMode != eParserModePlay)
+                return EAS_ERROR_DATA_UNDERRUN;
+            pSMFData->flags |= SMF_FLAGS_UNDERRUN;
+            pSMFData->state = EAS_STATE_PAUSING;
+            return EAS_SUCCESS;
+        }
+    }
+#endif
 
     /* get current ticks */
     ticks = pSMFData->nextStream->ticks;
@@ -343,16 +537,7 @@ EAS_RESULT SMF_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_INT pars
     }
 
     /* find next event in all streams */
-    temp = 0x7ffffff;
-    pSMFData->nextStream = NULL;
-    for (i = 0; i < pSMFData->numStreams; i++)
-    {
-        if (pSMFData->streams[i].ticks < temp)
-        {
-            temp = pSMFData->streams[i].ticks;
-            pSMFData->nextStream = &pSMFData->streams[i];
-        }
-    }
+    pSMFData->nextStream = SMF_NextStream(pSMFData, pSMFData->nextStream);
 
     /* are there any more events to parse? */
     if (pSMFData->nextStream)
@@ -360,7 +545,17 @@ EAS_RESULT SMF_Event (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_INT pars
         pSMFData->state = EAS_STATE_PLAY;
 
         /* update the time of the next event */
+#ifdef _SMF_SEEK_INDEX
+        time = pSMFData->time;
+#endif
         SMF_UpdateTime(pSMFData, pSMFData->nextStream->ticks - ticks);
+
+#ifdef _SMF_SEEK_INDEX
+        /* checkpoints are only valid at the first event of a new millisecond */
+        /*lint -e{704} use shift for performance */
+        if ((parserMode == eParserModeLocate) && ((pSMFData->time >> 8) > (time >> 8)))
+            SMF_RecordCheckpoint(pEASData, pSMFData);
+#endif
     }
     else
     {
@@ -457,12 +652,21 @@ EAS_RESULT SMF_Close (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     if (pSMFData->pSynth != NULL)
         VMMIDIShutdown(pEASData, pSMFData->pSynth);
 
+#ifdef _SMF_SEEK_INDEX
+    SMF_FreeSeekIndex(pEASData, pSMFData);
+#endif
+
     /* if using dynamic memory, free it */
     if (!pEASData->staticMemoryModel)
     {
         if (pSMFData->streams)
             EAS_HWFree(pEASData->hwInstData, pSMFData->streams);
 
+#ifdef _SMF_COMPILE_EVENTS
+        if (pSMFData->events)
+            EAS_HWFree(pEASData->hwInstData, pSMFData->events);
+#endif
+
         /* free the instance data */
         EAS_HWFree(pEASData->hwInstData, pSMFData);
     }
@@ -498,10 +702,26 @@ EAS_RESULT SMF_Reset (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
 
     /* reset time to zero */
     pSMFData->time = 0;
+#ifdef _PROGRESSIVE_FILES
+    pSMFData->flags &= ~SMF_FLAGS_UNDERRUN;
+#endif
 
     /* reset the synth */
     VMReset(pEASData->pVoiceMgr, pSMFData->pSynth, EAS_TRUE);
 
+#ifdef _SMF_COMPILE_EVENTS
+    /* rewind the compiled event list, the stream file positions aren't used */
+    if (pSMFData->events != NULL)
+    {
+        for (i = 0; i < pSMFData->numStreams; i++)
+            EAS_InitMIDIStream(&pSMFData->streams[i].midiStream);
+        pSMFData->eventIndex = 0;
+        pSMFData->nextStream = &pSMFData->streams[pSMFData->events[0].stream];
+        pSMFData->state = EAS_STATE_READY;
+        return EAS_SUCCESS;
+    }
+#endif
+
     /* find the start of each track */
     ticks = 0x7fffffffL;
     pSMFData->nextStream = NULL;
@@ -527,7 +747,9 @@ EAS_RESULT SMF_Reset (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
             pSMFData->nextStream = &pSMFData->streams[i];
         }
     }
-
+#ifdef _SMF_TRACK_TREE
+    SMF_InitTree(pSMFData);
+#endif
 
     pSMFData->state = EAS_STATE_READY;
     return EAS_SUCCESS;
@@ -563,6 +785,10 @@ EAS_RESULT SMF_Pause (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     /* mute the synthesizer */
     VMMuteAllVoices(pEASData->pVoiceMgr, pSMFData->pSynth);
     pSMFData->state = EAS_STATE_PAUSING;
+#ifdef _PROGRESSIVE_FILES
+    /* stay paused when more of the file arrives */
+    pSMFData->flags &= ~SMF_FLAGS_UNDERRUN;
+#endif
     return EAS_SUCCESS;
 }
 
@@ -679,6 +905,48 @@ EAS_RESULT SMF_SetData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 pa
             break;
 #endif
 
+#ifdef _SMF_SEEK_INDEX
+        /* skip ahead to the nearest checkpoint before the locate time */
+        case PARSER_DATA_SEEK_CHECKPOINT:
+            return SMF_RestoreCheckpoint(pEASData, pSMFData, value);
+#endif
+
+#ifdef _PROGRESSIVE_FILES
+        /* bytes of a partial file received, the file is only made progressive before it is prepared */
+        case PARSER_DATA_BYTES_AVAILABLE:
+            if (value < 0)
+                return EAS_ERROR_PARAMETER_RANGE;
+            if (pSMFData->state == EAS_STATE_OPEN)
+                pSMFData->flags |= SMF_FLAGS_PROGRESSIVE;
+            else if (!(pSMFData->flags & SMF_FLAGS_PROGRESSIVE))
+                return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+            pSMFData->available = value;
+            SMF_DataArrived(pSMFData);
+            break;
+
+        /* the whole file has arrived */
+        case PARSER_DATA_DOWNLOAD_COMPLETE:
+            pSMFData->flags &= ~SMF_FLAGS_PROGRESSIVE;
+            SMF_DataArrived(pSMFData);
+            break;
+#endif
+
+#if defined(_SMF_COMPILE_EVENTS) && defined(_LOOKAHEAD_PREFETCH)
+        /* load the samples of the notes in the next frame */
+        case PARSER_DATA_PREFETCH_NOTES:
+            SMF_PrefetchNotes(pEASData, pSMFData, value);
+            break;
+#endif
+
+#ifdef _ENGINE_SNAPSHOT
+        /* snapshots for EAS_SaveState and EAS_RestoreState */
+        case PARSER_DATA_SAVE_STATE:
+            return SMF_SaveState(pEASData, pSMFData, (S_SMF_SNAPSHOT*) value);
+
+        case PARSER_DATA_RESTORE_STATE:
+            return SMF_RestoreState(pEASData, pSMFData, (const S_SMF_SNAPSHOT*) value);
+#endif
+
         default:
             return EAS_ERROR_INVALID_PARAMETER;
     }
@@ -743,6 +1011,18 @@ EAS_RESULT SMF_GetData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 pa
             *pValue = (EAS_I32) pSMFData->pSynth;
             break;
 
+#ifdef _POSITION_REPORT
+        case PARSER_DATA_TICK_POSITION:
+            return SMF_TickPosition(pSMFData, pValue);
+#endif
+
+#ifdef _ENGINE_SNAPSHOT
+        /* room PARSER_DATA_SAVE_STATE needs */
+        case PARSER_DATA_STATE_SIZE:
+            *pValue = (EAS_I32) (sizeof(S_SMF_SNAPSHOT) + sizeof(S_SMF_CHECKPOINT) + pSMFData->numStreams * sizeof(S_SMF_CHECKPOINT_STREAM));
+            break;
+#endif
+
         default:
             return EAS_ERROR_INVALID_PARAMETER;
     }
@@ -750,6 +1030,107 @@ EAS_RESULT SMF_GetData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 pa
     return EAS_SUCCESS;
 }
 
+#ifdef _POSITION_REPORT
+/*----------------------------------------------------------------------------
+ * SMF_TickPosition()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts a time before the next event to MIDI ticks. The tempo cannot
+ * change between the last event and the next, so the ticks are counted
+ * back from the next event at the current tempo.
+ *
+ * Inputs:
+ * pSMFData         - pointer to parser instance data
+ * pValue           - time in msecs/256, receives the tick at that time
+ *
+ * Outputs:
+ * EAS_ERROR_NOT_VALID_IN_THIS_STATE once the last event has been parsed
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_TickPosition (S_SMF_DATA *pSMFData, EAS_I32 *pValue)
+{
+    EAS_U32 ticks;
+    EAS_U32 delta;
+
+    if (pSMFData->nextStream == NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+#ifdef _SMF_COMPILE_EVENTS
+    if (pSMFData->events != NULL)
+        ticks = pSMFData->events[pSMFData->eventIndex].ticks;
+    else
+#endif
+    ticks = pSMFData->nextStream->ticks;
+
+    /* a tick takes tickConv/4 msecs/256, the time is part way to the next tick */
+    if ((pSMFData->time > *pValue) && (pSMFData->tickConv != 0))
+    {
+        delta = (((EAS_U32) (pSMFData->time - *pValue) << 2) + pSMFData->tickConv - 1) / pSMFData->tickConv;
+        ticks = (delta < ticks) ? ticks - delta : 0;
+    }
+    *pValue = (EAS_I32) ticks;
+    return EAS_SUCCESS;
+}
+#endif
+
+#ifdef _SMF_FAST_METADATA
+/*----------------------------------------------------------------------------
+ * SMF_GetMetaData()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the play length and reports the metadata without running the
+ * events through the MIDI parser. Only the delta times and the meta-events
+ * are decoded, the tracks are still merged in play order because the time
+ * is rounded at every delta.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pInstData        - pointer to parser instance data
+ * pMediaLength     - pointer to variable to hold the play length (in msecs)
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * Resets the parser to the start of the file
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT SMF_GetMetaData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 *pMediaLength)
+{
+    S_SMF_DATA *pSMFData;
+    EAS_RESULT result;
+
+    pSMFData = (S_SMF_DATA*) pInstData;
+#ifdef _PROGRESSIVE_FILES
+    /* the length isn't known until the whole file has arrived */
+    if (pSMFData->flags & SMF_FLAGS_PROGRESSIVE)
+        return EAS_ERROR_DATA_UNDERRUN;
+#endif
+    if ((result = SMF_Reset(pEASData, pSMFData)) != EAS_SUCCESS)
+        return result;
+
+#ifdef _SMF_COMPILE_EVENTS
+    if (pSMFData->events != NULL)
+        result = SMF_ScanEvents(pEASData, pSMFData);
+    else
+#endif
+        result = SMF_ScanStreams(pEASData, pSMFData);
+    if (result != EAS_SUCCESS)
+    {
+        pSMFData->state = EAS_STATE_ERROR;
+        return result;
+    }
+
+    /*lint -e{704} use shift for performance */
+    *pMediaLength = pSMFData->time >> 8;
+    return SMF_Reset(pEASData, pSMFData);
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * SMF_GetVarLenData()
  *----------------------------------------------------------------------------
@@ -855,15 +1236,13 @@ static EAS_RESULT SMF_ParseMetaEvent (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData
     /* prevent a large unsigned length from being treated as a negative length */
     if ((EAS_I32) len < 0) {
         /* note that EAS_I32 is a long, which can be 64-bits on some computers */
-        ALOGE("%s() negative len = %ld", __func__, (long) len);
-        android_errorWriteLog(0x534e4554, "68953854");
+        EAS_DIAG_POST(eDiagNegativeLength, len);
         return EAS_ERROR_FILE_FORMAT;
     }
     /* prevent numeric overflow caused by a very large len, assume pos > 0 */
     const EAS_I32 EAS_I32_MAX = 0x7FFFFFFF;
     if ((EAS_I32) len > (EAS_I32_MAX - pos)) {
-        ALOGE("%s() too large len = %ld", __func__, (long) len);
-        android_errorWriteLog(0x534e4554, "68953854");
+        EAS_DIAG_POST(eDiagLargeLength, len);
         return EAS_ERROR_FILE_FORMAT;
     }
 
@@ -888,21 +1267,7 @@ static EAS_RESULT SMF_ParseMetaEvent (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData
                 return result;
             temp = (temp << 8) | c;
         }
-        {
-            // pSMFData->tickConv = (EAS_U16) (((temp * 1024) / pSMFData->ppqn + 500) / 1000);
-            uint64_t temp64;
-            if (__builtin_mul_overflow(temp, 1024u, &temp64) ||
-                    pSMFData->ppqn == 0 ||
-                    (temp64 /= pSMFData->ppqn, false) ||
-                    __builtin_add_overflow(temp64, 500, &temp64) ||
-                    (temp64 /= 1000, false) ||
-                    temp64 > 65535) {
-                pSMFData->tickConv = 65535;
-            } else {
-                pSMFData->tickConv = (EAS_U16) temp64;
-            }
-        }
-        pSMFData->flags |= SMF_FLAGS_HAS_TEMPO;
+        SMF_SetTempo(pSMFData, temp);
     }
 
     /* check for time signature - see iMelody spec V1.4 section 4.1.2.2.3.6 */
@@ -970,6 +1335,9 @@ static EAS_RESULT SMF_ParseSysEx (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_
     EAS_RESULT result;
     EAS_U32 len;
     EAS_U8 c;
+#ifdef _SMF_SEEK_INDEX
+    EAS_U16 masterVolume = (pSMFData->pSynth != NULL) ? pSMFData->pSynth->masterVolume : 0;
+#endif
 
     /* get the length */
     if ((result = SMF_GetVarLenData(pEASData->hwInstData, pSMFStream->fileHandle, &len)) != EAS_SUCCESS)
@@ -996,6 +1364,16 @@ static EAS_RESULT SMF_ParseSysEx (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_
             pSMFData->flags |= SMF_FLAGS_HAS_GM_ON;
     }
 
+#ifdef _SMF_SEEK_INDEX
+    /* checkpoints don't capture SP-MIDI or master volume, stop indexing if the file uses them */
+    if ((pSMFData->pSynth != NULL) &&
+        ((pSMFData->pSynth->masterVolume != masterVolume) || (pSMFData->pSynth->synthFlags & SYNTH_FLAG_SP_MIDI_ON)))
+    {
+        pSMFData->flags |= SMF_FLAGS_NO_SEEK_INDEX;
+        SMF_FreeSeekIndex(pEASData, pSMFData);
+    }
+#endif
+
     return EAS_SUCCESS;
 }
 
@@ -1055,34 +1433,23 @@ static EAS_RESULT SMF_ParseEvent (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_
 
     }
 
-    /* chase mode logic */
-    if (pSMFData->time == 0)
-    {
-        if (pSMFData->flags & SMF_FLAGS_CHASE_MODE)
-        {
-            if (pSMFStream->midiStream.flags & MIDI_FLAG_FIRST_NOTE)
-                pSMFData->flags &= ~SMF_FLAGS_CHASE_MODE;
-        }
-        else if ((pSMFData->flags & SMF_FLAGS_SETUP_BAR) == SMF_FLAGS_SETUP_BAR)
-            pSMFData->flags = (pSMFData->flags & ~SMF_FLAGS_SETUP_BAR) | SMF_FLAGS_CHASE_MODE;
-    }
-
+    SMF_UpdateChaseMode(pSMFData, pSMFStream);
     return EAS_SUCCESS;
 }
 
+#ifdef _SMF_FAST_METADATA
 /*----------------------------------------------------------------------------
- * SMF_ParseHeader()
+ * SMF_SkipEvent()
  *----------------------------------------------------------------------------
  * Purpose:
- * Parses the header of an SMF file, allocates memory the stream parsers and initializes the
- * stream parsers.
+ * Steps over the next event in a stream for SMF_GetMetaData. Channel
+ * messages are skipped without decoding, meta-events and SysEx are
+ * parsed as in metadata mode.
  *
  * Inputs:
  * pEASData         - pointer to overall EAS data structure
  * pSMFData         - pointer to parser instance data
- * fileHandle       - file handle
- * fileOffset       - offset in the file where the header data starts, usually 0
- *
+ * pSMFStream       - stream to read the event from
  *
  * Outputs:
  *
@@ -1091,159 +1458,1763 @@ static EAS_RESULT SMF_ParseEvent (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_
  *
  *----------------------------------------------------------------------------
 */
-/*lint -e{801} we know that 'goto' is deprecated - but it's cleaner in this case */
-EAS_RESULT SMF_ParseHeader (EAS_HW_DATA_HANDLE hwInstData, S_SMF_DATA *pSMFData)
+static EAS_RESULT SMF_SkipEvent (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_SMF_STREAM *pSMFStream)
 {
+    S_MIDI_STREAM *pMIDIStream;
     EAS_RESULT result;
-    EAS_I32 i;
-    EAS_U16 division;
-    EAS_U16 numStreams;
-    EAS_U32 chunkSize;
-    EAS_U32 chunkStart;
-    EAS_U32 temp;
-    EAS_U32 ticks;
-
-    /* explicitly set numStreams to 0. It will later be used by SMF_Close to
-     * determine whether we have valid streams or not. */
-    pSMFData->numStreams = 0;
-
-    /* rewind the file and find the end of the header chunk */
-    if ((result = EAS_HWFileSeek(hwInstData, pSMFData->fileHandle, pSMFData->fileOffset + SMF_OFS_HEADER_SIZE)) != EAS_SUCCESS)
-        goto ReadError;
-    if ((result = EAS_HWGetDWord(hwInstData, pSMFData->fileHandle, &chunkSize, EAS_TRUE)) != EAS_SUCCESS)
-        goto ReadError;
+    EAS_INT count;
+    EAS_INT read;
+    EAS_U8 status;
+    EAS_U8 c;
 
-    /* determine the number of tracks */
-    if ((result = EAS_HWFileSeek(hwInstData, pSMFData->fileHandle, pSMFData->fileOffset + SMF_OFS_NUM_TRACKS)) != EAS_SUCCESS)
-        goto ReadError;
-    if ((result = EAS_HWGetWord(hwInstData, pSMFData->fileHandle, &numStreams, EAS_TRUE)) != EAS_SUCCESS)
-        goto ReadError;
+    /* get the event type */
+    if ((result = EAS_HWGetByte(pEASData->hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+        return result;
 
-    /* limit the number of tracks */
-    if (numStreams > MAX_SMF_STREAMS)
-    {
-        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "SMF file contains %u tracks, playing %d tracks\n", numStreams, MAX_SMF_STREAMS); */ }
-        numStreams = MAX_SMF_STREAMS;
-    } else if (numStreams == 0)
+    /* parse meta-event */
+    if (c == 0xff)
     {
-        /* avoid 0 sized allocation */
-        return EAS_ERROR_PARAMETER_RANGE;
+        if ((result = SMF_ParseMetaEvent(pEASData, pSMFData, pSMFStream)) != EAS_SUCCESS)
+            return result;
     }
 
-    /* get the time division */
-    if ((result = EAS_HWGetWord(hwInstData, pSMFData->fileHandle, &division, EAS_TRUE)) != EAS_SUCCESS)
-        goto ReadError;
+    /* parse SysEx, F7 packets can carry data bytes for the running status */
+    else if ((c == 0xf0) || (c == 0xf7))
+    {
+        if ((result = SMF_ParseSysEx(pEASData, pSMFData, pSMFStream, c, eParserModeMetaData)) != EAS_SUCCESS)
+            return result;
+    }
 
-    /* setup default timebase for 120 bpm */
-    pSMFData->ppqn = 192;
-    if (!division || division & 0x8000)
-        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING,"No support for SMPTE code timebase\n"); */ }
     else
-        pSMFData->ppqn = (division & 0x7fff);
-    pSMFData->tickConv = (EAS_U16) (((SMF_DEFAULT_TIMEBASE * 1024) / pSMFData->ppqn + 500) / 1000);
+    {
+        pMIDIStream = &pSMFStream->midiStream;
+        status = (c & 0x80) ? c : pMIDIStream->runningStatus;
+
+        /* skip the data bytes of a channel message */
+        if ((status >= 0x80) && (status < 0xf0))
+        {
+            pMIDIStream->runningStatus = status;
+            count = ((status & 0xe0) == 0xc0) ? 1 : 2;
+            read = (c & 0x80) ? 0 : 1;
+            while (read < count)
+            {
+                if ((result = EAS_HWGetByte(pEASData->hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+                    return result;
+                if (c & 0x80)
+                    break;
+                read++;
+            }
+
+            if (read == count)
+            {
+                SMF_UpdateChaseMode(pSMFData, pSMFStream);
+                return EAS_SUCCESS;
+            }
+
+            /* status byte inside the message, leave the rest to the MIDI parser */
+            pMIDIStream->status = status;
+            pMIDIStream->byte3 = (read == 1) && (count == 2);
+            pMIDIStream->pending = EAS_TRUE;
+        }
+
+        /* anything else is parsed as SMF_ParseEvent would */
+        if ((result = EAS_ParseMIDIStream(pEASData, pSMFData->pSynth, pMIDIStream, c, eParserModeMetaData)) != EAS_SUCCESS)
+            return result;
+        while (pMIDIStream->pending)
+        {
+            if ((result = EAS_HWGetByte(pEASData->hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+                return result;
+            if ((result = EAS_ParseMIDIStream(pEASData, pSMFData->pSynth, pMIDIStream, c, eParserModeMetaData)) != EAS_SUCCESS)
+                return result;
+        }
+    }
+
+    SMF_UpdateChaseMode(pSMFData, pSMFStream);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_ScanStreams()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Steps through the events of all streams in the order SMF_Event parses
+ * them, leaving the time of the last event in pSMFData->time
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_ScanStreams (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData)
+{
+    S_SMF_STREAM *pSMFStream;
+    EAS_RESULT result;
+    EAS_U32 ticks;
+#ifdef _PARSE_LIMITS
+    S_PARSE_BUDGET budget;
+
+    EAS_ParseBudgetStart(pEASData, &budget);
+#endif
+
+    if ((pSMFStream = pSMFData->nextStream) == NULL)
+        return EAS_ERROR_FILE_FORMAT;
+
+    for (;;)
+    {
+#ifdef _PARSE_LIMITS
+        if ((result = EAS_ParseBudgetCharge(pEASData, &budget)) != EAS_SUCCESS)
+            return result;
+#endif
+        ticks = pSMFStream->ticks;
+        if ((result = SMF_SkipEvent(pEASData, pSMFData, pSMFStream)) != EAS_SUCCESS)
+        {
+            /* check for unexpected end-of-file */
+            if (result != EAS_EOF)
+                return result;
+            pSMFStream->ticks = SMF_END_OF_TRACK;
+        }
+
+        /* get next delta time, unless already at end of track */
+        else if (pSMFStream->ticks != SMF_END_OF_TRACK)
+        {
+            if ((result = SMF_GetDeltaTime(pEASData->hwInstData, pSMFStream)) != EAS_SUCCESS)
+            {
+                if (result != EAS_EOF)
+                    return result;
+                pSMFStream->ticks = SMF_END_OF_TRACK;
+            }
+
+            /* if zero delta to next event, stay with this stream */
+            else if (pSMFStream->ticks == ticks)
+                continue;
+        }
+
+        /* find next event in all streams */
+        if ((pSMFStream = SMF_NextStream(pSMFData, pSMFStream)) == NULL)
+            return EAS_SUCCESS;
+        SMF_UpdateTime(pSMFData, pSMFStream->ticks - ticks);
+    }
+}
+
+#ifdef _SMF_COMPILE_EVENTS
+/*----------------------------------------------------------------------------
+ * SMF_ScanEvents()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Steps through the compiled event list as SMF_PlayEvent would in
+ * metadata mode, leaving the time of the last event in pSMFData->time
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_ScanEvents (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData)
+{
+    S_SMF_EVENT *pEvent;
+    S_SMF_STREAM *pSMFStream;
+    EAS_RESULT result;
+    EAS_U32 i;
+#ifdef _PARSE_LIMITS
+    S_PARSE_BUDGET budget;
+
+    EAS_ParseBudgetStart(pEASData, &budget);
+#endif
+
+    for (i = 0, pEvent = pSMFData->events; i < pSMFData->numEvents; i++, pEvent++)
+    {
+#ifdef _PARSE_LIMITS
+        if ((result = EAS_ParseBudgetCharge(pEASData, &budget)) != EAS_SUCCESS)
+            return result;
+#endif
+        pSMFStream = &pSMFData->streams[pEvent->stream];
+        if (pEvent->status == SMF_EVENT_META)
+        {
+            if (pEvent->d1 == SMF_META_END_OF_TRACK)
+                pSMFStream->ticks = SMF_END_OF_TRACK;
+            else if (pEvent->d1 == SMF_META_TEMPO)
+                SMF_SetTempo(pSMFData, pEvent->value);
+            else if (pEvent->d1 == SMF_META_TIME_SIGNATURE)
+                pSMFData->flags |= SMF_FLAGS_HAS_TIME_SIG;
+            else if (pSMFData->metadata.callback)
+            {
+                if ((result = EAS_HWFileSeek(pEASData->hwInstData, pSMFStream->fileHandle, (EAS_I32) pEvent->value)) != EAS_SUCCESS)
+                    return result;
+                if ((result = SMF_ParseMetaEvent(pEASData, pSMFData, pSMFStream)) != EAS_SUCCESS)
+                    return result;
+            }
+        }
+        else if ((pEvent->status == 0xf0) || (pEvent->status == 0xf7))
+        {
+            if ((result = EAS_HWFileSeek(pEASData->hwInstData, pSMFStream->fileHandle, (EAS_I32) pEvent->value)) != EAS_SUCCESS)
+                return result;
+            if ((result = SMF_ParseSysEx(pEASData, pSMFData, pSMFStream, pEvent->status, eParserModeMetaData)) != EAS_SUCCESS)
+                return result;
+        }
+
+        /* the end of a stream doesn't count as an event */
+        if (pEvent->status != SMF_EVENT_NONE)
+            SMF_UpdateChaseMode(pSMFData, pSMFStream);
+
+        if ((i + 1) < pSMFData->numEvents)
+            SMF_UpdateTime(pSMFData, pEvent[1].ticks - pEvent->ticks);
+    }
+    return EAS_SUCCESS;
+}
+#endif
+#endif
+
+/*----------------------------------------------------------------------------
+ * SMF_UpdateChaseMode()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Chase mode logic, called after each event. A setup bar at time 0 is
+ * skipped up to the first note.
+ *
+ * Inputs:
+ * pSMFData         - pointer to parser instance data
+ * pSMFStream       - stream the event was parsed from
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void SMF_UpdateChaseMode (S_SMF_DATA *pSMFData, S_SMF_STREAM *pSMFStream)
+{
+    if (pSMFData->time == 0)
+    {
+        if (pSMFData->flags & SMF_FLAGS_CHASE_MODE)
+        {
+            if (pSMFStream->midiStream.flags & MIDI_FLAG_FIRST_NOTE)
+                pSMFData->flags &= ~SMF_FLAGS_CHASE_MODE;
+        }
+        else if ((pSMFData->flags & SMF_FLAGS_SETUP_BAR) == SMF_FLAGS_SETUP_BAR)
+            pSMFData->flags = (pSMFData->flags & ~SMF_FLAGS_SETUP_BAR) | SMF_FLAGS_CHASE_MODE;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_NextStream()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Finds the stream with the next event, after the event time of one
+ * stream has changed. Ties go to the lowest numbered stream, the streams
+ * at the end of their track are skipped.
+ *
+ * Inputs:
+ * pSMFData         - pointer to parser instance data
+ * pSMFStream       - stream with the new event time
+ *
+ * Outputs:
+ * Returns the stream with the next event, NULL if there are none left
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+#ifdef _SMF_TRACK_TREE
+static S_SMF_STREAM *SMF_NextStream (S_SMF_DATA *pSMFData, S_SMF_STREAM *pSMFStream)
+{
+    S_SMF_STREAM *pNext;
+    EAS_INT node;
+
+    /* replay the matches on the path from the stream to the root */
+    for (node = ((EAS_INT) (pSMFStream - pSMFData->streams) + pSMFData->numStreams) >> 1; node > 0; node >>= 1)
+        pSMFData->streams[node].winner = SMF_TreeWinner(pSMFData, node);
+
+    pNext = &pSMFData->streams[(pSMFData->numStreams > 1) ? pSMFData->streams[1].winner : 0];
+    if (pNext->ticks >= 0x7ffffff)
+        return NULL;
+    return pNext;
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_TreeWinner()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Plays the match at a node of the tournament tree over the streams. The
+ * nodes 1 to numStreams - 1 are stored in the streams, the nodes from
+ * numStreams on are the streams themselves.
+ *
+ * Inputs:
+ * pSMFData         - pointer to parser instance data
+ * node             - tree node
+ *
+ * Outputs:
+ * Returns the index of the stream with the earlier event
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_U16 SMF_TreeWinner (S_SMF_DATA *pSMFData, EAS_INT node)
+{
+    EAS_INT left, right;
+
+    left = node << 1;
+    right = left + 1;
+    left = (left >= pSMFData->numStreams) ? left - pSMFData->numStreams : pSMFData->streams[left].winner;
+    right = (right >= pSMFData->numStreams) ? right - pSMFData->numStreams : pSMFData->streams[right].winner;
+
+    if ((pSMFData->streams[right].ticks < pSMFData->streams[left].ticks) ||
+        ((pSMFData->streams[right].ticks == pSMFData->streams[left].ticks) && (right < left)))
+        return (EAS_U16) right;
+    return (EAS_U16) left;
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_InitTree()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Builds the tournament tree after the event times of all streams have
+ * been set
+ *
+ * Inputs:
+ * pSMFData         - pointer to parser instance data
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void SMF_InitTree (S_SMF_DATA *pSMFData)
+{
+    EAS_INT node;
+
+    for (node = pSMFData->numStreams - 1; node > 0; node--)
+        pSMFData->streams[node].winner = SMF_TreeWinner(pSMFData, node);
+}
+#else
+/*lint -esym(715, pSMFStream) only used by the tournament tree */
+static S_SMF_STREAM *SMF_NextStream (S_SMF_DATA *pSMFData, S_SMF_STREAM *pSMFStream)
+{
+    S_SMF_STREAM *pNext;
+    EAS_U32 temp;
+    EAS_INT i;
+
+    temp = 0x7ffffff;
+    pNext = NULL;
+    for (i = 0; i < pSMFData->numStreams; i++)
+    {
+        if (pSMFData->streams[i].ticks < temp)
+        {
+            temp = pSMFData->streams[i].ticks;
+            pNext = &pSMFData->streams[i];
+        }
+    }
+    return pNext;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * SMF_ParseHeader()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses the header of an SMF file, allocates memory the stream parsers and initializes the
+ * stream parsers.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ * fileHandle       - file handle
+ * fileOffset       - offset in the file where the header data starts, usually 0
+ *
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -e{801} we know that 'goto' is deprecated - but it's cleaner in this case */
+EAS_RESULT SMF_ParseHeader (EAS_HW_DATA_HANDLE hwInstData, S_SMF_DATA *pSMFData)
+{
+    EAS_RESULT result;
+    EAS_I32 i;
+    EAS_U16 division;
+    EAS_U16 numStreams;
+    EAS_U32 chunkSize;
+    EAS_U32 chunkStart;
+    EAS_U32 temp;
+    EAS_U32 ticks;
+
+    /* explicitly set numStreams to 0. It will later be used by SMF_Close to
+     * determine whether we have valid streams or not. */
+    pSMFData->numStreams = 0;
+
+    /* rewind the file and find the end of the header chunk */
+    if ((result = EAS_HWFileSeek(hwInstData, pSMFData->fileHandle, pSMFData->fileOffset + SMF_OFS_HEADER_SIZE)) != EAS_SUCCESS)
+        goto ReadError;
+    if ((result = EAS_HWGetDWord(hwInstData, pSMFData->fileHandle, &chunkSize, EAS_TRUE)) != EAS_SUCCESS)
+        goto ReadError;
+
+    /* determine the number of tracks */
+    if ((result = EAS_HWFileSeek(hwInstData, pSMFData->fileHandle, pSMFData->fileOffset + SMF_OFS_NUM_TRACKS)) != EAS_SUCCESS)
+        goto ReadError;
+    if ((result = EAS_HWGetWord(hwInstData, pSMFData->fileHandle, &numStreams, EAS_TRUE)) != EAS_SUCCESS)
+        goto ReadError;
+
+    /* limit the number of tracks */
+    if (numStreams > MAX_SMF_STREAMS)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "SMF file contains %u tracks, playing %d tracks\n", numStreams, MAX_SMF_STREAMS); */ }
+        numStreams = MAX_SMF_STREAMS;
+    } else if (numStreams == 0)
+    {
+        /* avoid 0 sized allocation */
+        return EAS_ERROR_PARAMETER_RANGE;
+    }
+
+    /* get the time division */
+    if ((result = EAS_HWGetWord(hwInstData, pSMFData->fileHandle, &division, EAS_TRUE)) != EAS_SUCCESS)
+        goto ReadError;
+
+    /* setup default timebase for 120 bpm */
+    pSMFData->ppqn = 192;
+    if (!division || division & 0x8000)
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING,"No support for SMPTE code timebase\n"); */ }
+    else
+        pSMFData->ppqn = (division & 0x7fff);
+    pSMFData->tickConv = (EAS_U16) (((SMF_DEFAULT_TIMEBASE * 1024) / pSMFData->ppqn + 500) / 1000);
 
     /* dynamic memory allocation, allocate memory for streams */
     if (pSMFData->streams == NULL)
     {
-        pSMFData->streams = EAS_HWMalloc(hwInstData,sizeof(S_SMF_STREAM) * numStreams);
-        if (pSMFData->streams == NULL)
-            return EAS_ERROR_MALLOC_FAILED;
+        pSMFData->streams = EAS_HWMalloc(hwInstData,sizeof(S_SMF_STREAM) * numStreams);
+        if (pSMFData->streams == NULL)
+            return EAS_ERROR_MALLOC_FAILED;
+
+        /* zero the memory to insure complete initialization */
+        EAS_HWMemSet((void *)(pSMFData->streams), 0, sizeof(S_SMF_STREAM) * numStreams);
+    }
+    pSMFData->numStreams = numStreams;
+
+    /* find the start of each track */
+    chunkStart = (EAS_U32) pSMFData->fileOffset;
+    ticks = 0x7fffffffL;
+    pSMFData->nextStream = NULL;
+    for (i = 0; i < pSMFData->numStreams; i++)
+    {
+
+        for (;;)
+        {
+
+            /* calculate start of next chunk - checking for errors */
+            temp = chunkStart + SMF_CHUNK_INFO_SIZE + chunkSize;
+            if (temp <= chunkStart)
+            {
+                { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING,"Error in chunk size at offset %d\n", chunkStart); */ }
+                return EAS_ERROR_FILE_FORMAT;
+            }
+            chunkStart = temp;
+
+            /* seek to the start of the next chunk */
+            if ((result = EAS_HWFileSeek(hwInstData, pSMFData->fileHandle, (EAS_I32) chunkStart)) != EAS_SUCCESS)
+                goto ReadError;
+
+            /* read the chunk identifier */
+            if ((result = EAS_HWGetDWord(hwInstData, pSMFData->fileHandle, &temp, EAS_TRUE)) != EAS_SUCCESS)
+                goto ReadError;
+
+            /* read the chunk size */
+            if ((result = EAS_HWGetDWord(hwInstData, pSMFData->fileHandle, &chunkSize, EAS_TRUE)) != EAS_SUCCESS)
+                goto ReadError;
+
+            /* make sure this is an 'MTrk' chunk */
+            if (temp == SMF_CHUNK_TYPE_TRACK)
+                break;
+
+            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING,"Unexpected chunk type: 0x%08x\n", temp); */ }
+        }
+
+        /* initalize some data */
+        pSMFData->streams[i].ticks = 0;
+        pSMFData->streams[i].fileHandle = pSMFData->fileHandle;
+
+        /* NULL the file handle so we don't try to close it twice */
+        pSMFData->fileHandle = NULL;
+
+        /* save this file position as the start of the track */
+        pSMFData->streams[i].startFilePos = (EAS_I32) chunkStart + SMF_CHUNK_INFO_SIZE;
+
+        /* initalize the MIDI parser data */
+        EAS_InitMIDIStream(&pSMFData->streams[i].midiStream);
+
+        /* parse the first delta time in each stream */
+        if ((result = SMF_GetDeltaTime(hwInstData, &pSMFData->streams[i])) != EAS_SUCCESS)
+                goto ReadError;
+
+        if (pSMFData->streams[i].ticks < ticks)
+        {
+            ticks = pSMFData->streams[i].ticks;
+            pSMFData->nextStream = &pSMFData->streams[i];
+        }
+
+        /* more tracks to do, create a duplicate file handle */
+        if (i < (pSMFData->numStreams - 1))
+        {
+            if ((result = EAS_HWDupHandle(hwInstData, pSMFData->streams[i].fileHandle, &pSMFData->fileHandle)) != EAS_SUCCESS)
+                goto ReadError;
+        }
+    }
+
+#ifdef _SMF_TRACK_TREE
+    SMF_InitTree(pSMFData);
+#endif
+
+    /* update the time of the next event */
+    if (pSMFData->nextStream)
+        SMF_UpdateTime(pSMFData, pSMFData->nextStream->ticks);
+
+    return EAS_SUCCESS;
+
+    /* ugly goto: but simpler than structured */
+    ReadError:
+        if (result == EAS_EOF)
+            return EAS_ERROR_FILE_FORMAT;
+        return result;
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_UpdateTime()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Update the millisecond time base by converting the ticks into millieconds
+ *
+ * Inputs:
+ *
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void SMF_UpdateTime (S_SMF_DATA *pSMFData, EAS_U32 ticks)
+{
+    EAS_U32 temp1, temp2;
+
+    if (pSMFData->flags & SMF_FLAGS_CHASE_MODE)
+        return;
+
+    temp1 = (ticks >> 10) * pSMFData->tickConv;
+    temp2 = (ticks & 0x3ff) * pSMFData->tickConv;
+    pSMFData->time += (EAS_I32)((temp1 << 8) + (temp2 >> 2));
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_SetTempo()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Update the MIDI tick to millisecond conversion from a tempo meta-event
+ *
+ * Inputs:
+ * pSMFData         - pointer to parser instance data
+ * tempo            - tempo in microseconds per quarter note
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void SMF_SetTempo (S_SMF_DATA *pSMFData, EAS_U32 tempo)
+{
+    // pSMFData->tickConv = (EAS_U16) (((tempo * 1024) / pSMFData->ppqn + 500) / 1000);
+    uint64_t temp64;
+    if (__builtin_mul_overflow(tempo, 1024u, &temp64) ||
+            pSMFData->ppqn == 0 ||
+            (temp64 /= pSMFData->ppqn, false) ||
+            __builtin_add_overflow(temp64, 500, &temp64) ||
+            (temp64 /= 1000, false) ||
+            temp64 > 65535) {
+        pSMFData->tickConv = 65535;
+    } else {
+        pSMFData->tickConv = (EAS_U16) temp64;
+    }
+    pSMFData->flags |= SMF_FLAGS_HAS_TEMPO;
+}
+
+
+#ifdef _SMF_COMPILE_EVENTS
+/*----------------------------------------------------------------------------
+ * SMF_CompileEvents()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Merges the events of all streams into a single time-sorted list, in the
+ * order that SMF_Event would parse them from the file.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ *
+ * Outputs:
+ * Returns EAS_SUCCESS if the file could not be compiled. The parser then
+ * falls back to parsing events from the file.
+ *
+ * Side Effects:
+ * The stream file positions are restored before returning.
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_CompileEvents (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData)
+{
+    S_SMF_STREAM *pSMFStream;
+    S_SMF_EVENT *pEvents;
+    S_SMF_EVENT *pEvent;
+    EAS_I32 filePos[MAX_SMF_STREAMS];
+    EAS_U32 streamTicks[MAX_SMF_STREAMS];
+    EAS_U8 runningStatus[MAX_SMF_STREAMS];
+    EAS_U32 numEvents;
+    EAS_U32 maxEvents;
+    EAS_U32 ticks;
+    EAS_RESULT result;
+    EAS_INT i;
+#ifdef _PARSE_LIMITS
+    S_PARSE_BUDGET budget;
+    EAS_RESULT limitResult;
+
+    EAS_ParseBudgetStart(pEASData, &budget);
+    limitResult = EAS_SUCCESS;
+#endif
+
+    /* stream index must fit in an event */
+    if (pSMFData->numStreams > 256)
+        return EAS_SUCCESS;
+
+    /* save the stream positions, the walk below uses the stream file handles */
+    for (i = 0; i < pSMFData->numStreams; i++)
+    {
+        if ((result = EAS_HWFilePos(pEASData->hwInstData, pSMFData->streams[i].fileHandle, &filePos[i])) != EAS_SUCCESS)
+            return result;
+        streamTicks[i] = pSMFData->streams[i].ticks;
+        runningStatus[i] = 0;
+    }
+
+    pEvents = NULL;
+    numEvents = 0;
+    maxEvents = 0;
+    result = EAS_SUCCESS;
+    pSMFStream = pSMFData->nextStream;
+    while (pSMFStream != NULL)
+    {
+#ifdef _PARSE_LIMITS
+        /* a file over the limit is rejected rather than parsed from the file */
+        if ((limitResult = EAS_ParseBudgetCharge(pEASData, &budget)) != EAS_SUCCESS)
+        {
+            result = limitResult;
+            break;
+        }
+#endif
+
+        /* grow the event list */
+        if (numEvents == maxEvents)
+        {
+            S_SMF_EVENT *pTemp;
+
+            if (maxEvents >= SMF_MAX_EVENTS)
+            {
+                result = EAS_ERROR_DATA_INCONSISTENCY;
+                break;
+            }
+            maxEvents += SMF_EVENT_BLOCK_SIZE;
+            if ((pTemp = EAS_HWMalloc(pEASData->hwInstData, (EAS_I32) (maxEvents * sizeof(S_SMF_EVENT)))) == NULL)
+            {
+                result = EAS_ERROR_MALLOC_FAILED;
+                break;
+            }
+            if (pEvents != NULL)
+            {
+                EAS_HWMemCpy(pTemp, pEvents, (EAS_I32) (numEvents * sizeof(S_SMF_EVENT)));
+                EAS_HWFree(pEASData->hwInstData, pEvents);
+            }
+            pEvents = pTemp;
+        }
+
+        /* get the next event from this stream */
+        i = (EAS_INT) (pSMFStream - pSMFData->streams);
+        pEvent = &pEvents[numEvents++];
+        pEvent->ticks = pSMFStream->ticks;
+        pEvent->stream = (EAS_U8) i;
+        if ((result = SMF_CompileEvent(pEASData, pSMFStream, pEvent, &runningStatus[i])) != EAS_SUCCESS)
+            break;
+
+        /* the rest follows SMF_Event */
+        ticks = pSMFStream->ticks;
+        if ((pEvent->status == SMF_EVENT_NONE) ||
+            ((pEvent->status == SMF_EVENT_META) && (pEvent->d1 == SMF_META_END_OF_TRACK)))
+        {
+            pSMFStream->ticks = SMF_END_OF_TRACK;
+        }
+
+        else if ((result = SMF_GetDeltaTime(pEASData->hwInstData, pSMFStream)) != EAS_SUCCESS)
+        {
+            if (result != EAS_EOF)
+                break;
+            result = EAS_SUCCESS;
+            pSMFStream->ticks = SMF_END_OF_TRACK;
+        }
+
+        /* if zero delta to next event, stay with this stream */
+        else if (pSMFStream->ticks == ticks)
+            continue;
+
+        /* find next event in all streams */
+        pSMFStream = SMF_NextStream(pSMFData, pSMFStream);
+    }
+
+    /* keep the list if the whole file was compiled */
+    if ((result == EAS_SUCCESS) && (numEvents != 0))
+    {
+        pSMFData->events = pEvents;
+        pSMFData->numEvents = numEvents;
+        pSMFData->eventIndex = 0;
+    }
+    else
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "SMF_CompileEvents: parsing from file, error %d\n", result); */ }
+        if (pEvents != NULL)
+            EAS_HWFree(pEASData->hwInstData, pEvents);
+    }
+
+    /* restore the stream positions */
+    for (i = 0; i < pSMFData->numStreams; i++)
+    {
+        if ((result = EAS_HWFileSeek(pEASData->hwInstData, pSMFData->streams[i].fileHandle, filePos[i])) != EAS_SUCCESS)
+            return result;
+        pSMFData->streams[i].ticks = streamTicks[i];
+    }
+#ifdef _SMF_TRACK_TREE
+    SMF_InitTree(pSMFData);
+#endif
+#ifdef _PARSE_LIMITS
+    if (limitResult != EAS_SUCCESS)
+        return limitResult;
+#endif
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_CompileEvent()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reads one event from a stream into the compiled event list. Anything the
+ * compiled player could not reproduce exactly (system common messages,
+ * data bytes without a channel running status, status bytes inside SysEx
+ * data, truncated events) is reported as an error so that the file is
+ * parsed from the file instead.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFStream       - stream to read from
+ * pEvent           - event to fill in
+ * pRunningStatus   - running status of the stream
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_CompileEvent (S_EAS_DATA *pEASData, S_SMF_STREAM *pSMFStream, S_SMF_EVENT *pEvent, EAS_U8 *pRunningStatus)
+{
+    EAS_HW_DATA_HANDLE hwInstData;
+    EAS_RESULT result;
+    EAS_U32 len;
+    EAS_I32 pos;
+    EAS_U32 temp;
+    EAS_U8 c;
+
+    hwInstData = pEASData->hwInstData;
+    pEvent->value = 0;
+    pEvent->d1 = 0;
+    pEvent->d2 = 0;
+
+    /* end of file where an event is expected ends the stream */
+    if ((result = EAS_HWGetByte(hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+    {
+        if (result != EAS_EOF)
+            return result;
+        pEvent->status = SMF_EVENT_NONE;
+        return EAS_SUCCESS;
+    }
+
+    /* meta-event, see SMF_ParseMetaEvent */
+    if (c == 0xff)
+    {
+        pEvent->status = SMF_EVENT_META;
+        if ((result = EAS_HWFilePos(hwInstData, pSMFStream->fileHandle, &pos)) != EAS_SUCCESS)
+            return result;
+        pEvent->value = (EAS_U32) pos;
+        if ((result = EAS_HWGetByte(hwInstData, pSMFStream->fileHandle, &pEvent->d1)) != EAS_SUCCESS)
+            return result;
+        if ((result = SMF_GetVarLenData(hwInstData, pSMFStream->fileHandle, &len)) != EAS_SUCCESS)
+            return result;
+        if ((result = EAS_HWFilePos(hwInstData, pSMFStream->fileHandle, &pos)) != EAS_SUCCESS)
+            return result;
+        if (((EAS_I32) len < 0) || ((EAS_I32) len > (0x7FFFFFFF - pos)))
+            return EAS_ERROR_FILE_FORMAT;
+        pos += (EAS_I32) len;
+
+        /* tempo is stored in the event */
+        if (pEvent->d1 == SMF_META_TEMPO)
+        {
+            if (len != 3)
+                return EAS_ERROR_FILE_FORMAT;
+            temp = 0;
+            while (len)
+            {
+                len--;
+                if ((result = EAS_HWGetByte(hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+                    return result;
+                temp = (temp << 8) | c;
+            }
+            pEvent->value = temp;
+        }
+        return EAS_HWFileSeek(hwInstData, pSMFStream->fileHandle, pos);
+    }
+
+    /* SysEx, see SMF_ParseSysEx */
+    if ((c == 0xf0) || (c == 0xf7))
+    {
+        pEvent->status = c;
+        if ((result = EAS_HWFilePos(hwInstData, pSMFStream->fileHandle, &pos)) != EAS_SUCCESS)
+            return result;
+        pEvent->value = (EAS_U32) pos;
+        if ((result = SMF_GetVarLenData(hwInstData, pSMFStream->fileHandle, &len)) != EAS_SUCCESS)
+            return result;
+
+        /* only SysEx messages and continuation packets */
+        if (c == 0xf0)
+            *pRunningStatus = 0xf0;
+        else if ((*pRunningStatus != 0xf0) && (*pRunningStatus != 0xf7))
+            return EAS_ERROR_FILE_FORMAT;
+
+        /* track the running status the MIDI parser will be left with */
+        while (len)
+        {
+            len--;
+            if ((result = EAS_HWGetByte(hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+                return result;
+            if (c & 0x80)
+            {
+                if ((c != 0xf7) || len)
+                    return EAS_ERROR_FILE_FORMAT;
+                *pRunningStatus = c;
+            }
+            else if (*pRunningStatus == 0xf7)
+                *pRunningStatus = 0;
+        }
+        return EAS_SUCCESS;
+    }
+
+    /* new status byte, system messages are not expected in a file */
+    if (c & 0x80)
+    {
+        if (c >= 0xf0)
+            return EAS_ERROR_FILE_FORMAT;
+        *pRunningStatus = c;
+        if ((result = EAS_HWGetByte(hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+            return result;
+    }
+
+    /* running status must be a channel message */
+    else if ((*pRunningStatus < 0x80) || (*pRunningStatus >= 0xf0))
+        return EAS_ERROR_FILE_FORMAT;
+
+    pEvent->status = *pRunningStatus;
+    if (c & 0x80)
+        return EAS_ERROR_FILE_FORMAT;
+    pEvent->d1 = c;
+
+    /* program change and channel pressure are 2-byte messages */
+    if ((pEvent->status < 0xc0) || (pEvent->status >= 0xe0))
+    {
+        if ((result = EAS_HWGetByte(hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+            return result;
+        if (c & 0x80)
+            return EAS_ERROR_FILE_FORMAT;
+        pEvent->d2 = c;
+    }
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_PlayEvent()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Plays the next event from the compiled event list. Equivalent to
+ * SMF_Event, but SysEx and meta-events are the only events read from
+ * the file.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ * parserMode       - play, locate, mute or metadata
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_PlayEvent (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, EAS_INT parserMode)
+{
+    S_SMF_EVENT *pEvent;
+    S_SMF_STREAM *pSMFStream;
+    EAS_RESULT result;
+    EAS_U32 ticks;
+#ifdef _SMF_SEEK_INDEX
+    EAS_I32 time;
+#endif
+
+    pEvent = &pSMFData->events[pSMFData->eventIndex];
+    pSMFStream = pSMFData->nextStream;
+
+    /* assume that an error occurred */
+    pSMFData->state = EAS_STATE_ERROR;
+
+#ifdef JET_INTERFACE
+    /* if JET has track muted, set parser mode to mute */
+    if (pSMFStream->midiStream.jetData & MIDI_FLAGS_JET_MUTE)
+        parserMode = eParserModeMute;
+#endif
+
+    switch (pEvent->status)
+    {
+        case SMF_EVENT_NONE:
+            break;
+
+        case SMF_EVENT_META:
+            if (pEvent->d1 == SMF_META_END_OF_TRACK)
+                pSMFStream->ticks = SMF_END_OF_TRACK;
+            else if (pEvent->d1 == SMF_META_TEMPO)
+                SMF_SetTempo(pSMFData, pEvent->value);
+            else if (pEvent->d1 == SMF_META_TIME_SIGNATURE)
+                pSMFData->flags |= SMF_FLAGS_HAS_TIME_SIG;
+
+            /* text events are only read if the host wants them */
+            else if (pSMFData->metadata.callback)
+            {
+                if ((result = EAS_HWFileSeek(pEASData->hwInstData, pSMFStream->fileHandle, (EAS_I32) pEvent->value)) != EAS_SUCCESS)
+                    return result;
+                if ((result = SMF_ParseMetaEvent(pEASData, pSMFData, pSMFStream)) != EAS_SUCCESS)
+                    return result;
+            }
+            break;
+
+        case 0xf0:
+        case 0xf7:
+            if ((result = EAS_HWFileSeek(pEASData->hwInstData, pSMFStream->fileHandle, (EAS_I32) pEvent->value)) != EAS_SUCCESS)
+                return result;
+            if ((result = SMF_ParseSysEx(pEASData, pSMFData, pSMFStream, pEvent->status, parserMode)) != EAS_SUCCESS)
+                return result;
+            break;
+
+        default:
+#ifdef _COALESCE_CONTROLLERS
+            /* a value replaced later in the frame only updates the stream state */
+            if (((parserMode == eParserModePlay) || (parserMode == eParserModeMute)) && SMF_Superseded(pEASData, pSMFData, pEvent))
+            {
+                if ((result = EAS_ParseMIDIMessage(pEASData, pSMFData->pSynth, &pSMFStream->midiStream,
+                    pEvent->status, pEvent->d1, pEvent->d2, eParserModeMetaData)) != EAS_SUCCESS)
+                    return result;
+                break;
+            }
+#endif
+            if ((result = EAS_ParseMIDIMessage(pEASData, pSMFData->pSynth, &pSMFStream->midiStream,
+                pEvent->status, pEvent->d1, pEvent->d2, parserMode)) != EAS_SUCCESS)
+                return result;
+            break;
+    }
+
+    /* the end of a stream doesn't count as an event */
+    if (pEvent->status != SMF_EVENT_NONE)
+        SMF_UpdateChaseMode(pSMFData, pSMFStream);
+
+    /* are there any more events to parse? */
+    ticks = pEvent->ticks;
+    if (++pSMFData->eventIndex < pSMFData->numEvents)
+    {
+        pEvent++;
+        pSMFData->nextStream = &pSMFData->streams[pEvent->stream];
+        pSMFData->state = EAS_STATE_PLAY;
+
+        /* update the time of the next event */
+#ifdef _SMF_SEEK_INDEX
+        time = pSMFData->time;
+#endif
+        SMF_UpdateTime(pSMFData, pEvent->ticks - ticks);
+
+#ifdef _SMF_SEEK_INDEX
+        /* checkpoints are only valid at the first event of a new millisecond */
+        /*lint -e{704} use shift for performance */
+        if ((parserMode == eParserModeLocate) && ((pSMFData->time >> 8) > (time >> 8)))
+            SMF_RecordCheckpoint(pEASData, pSMFData);
+#endif
+    }
+    else
+    {
+        pSMFData->nextStream = NULL;
+        pSMFData->state = EAS_STATE_STOPPING;
+        VMReleaseAllVoices(pEASData->pVoiceMgr, pSMFData->pSynth);
+    }
+
+    return EAS_SUCCESS;
+}
+#endif
+
+#if defined(_SMF_COMPILE_EVENTS) && defined(_COALESCE_CONTROLLERS)
+/*----------------------------------------------------------------------------
+ * SMF_IsControllerValue()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns EAS_TRUE for the channel messages that only store a value in the
+ * channel: pitch bend, channel pressure, and the mod wheel, volume, pan,
+ * expression and effect send controllers. Sustain, bank select, RPN and
+ * NRPN and the channel mode messages act on the order of events.
+ *
+ * Inputs:
+ * pEvent           - compiled event
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL SMF_IsControllerValue (const S_SMF_EVENT *pEvent)
+{
+    if ((pEvent->status < 0x80) || (pEvent->status >= 0xf0))
+        return EAS_FALSE;
+
+    switch (pEvent->status & 0xf0)
+    {
+        case 0xd0:
+        case 0xe0:
+            return EAS_TRUE;
+
+        case 0xb0:
+            switch (pEvent->d1)
+            {
+                case MIDI_CONTROLLER_MOD_WHEEL:
+                case MIDI_CONTROLLER_VOLUME:
+                case MIDI_CONTROLLER_PAN:
+                case MIDI_CONTROLLER_EXPRESSION:
+                case MIDI_CONTROLLER_REVERB_SEND:
+                case MIDI_CONTROLLER_CHORUS_SEND:
+                    return EAS_TRUE;
+                default:
+                    break;
+            }
+            break;
+
+        default:
+            break;
+    }
+    return EAS_FALSE;
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_Superseded()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks whether a later event in the frame being parsed sets the same
+ * controller value on the same channel. The synth updates the channel
+ * parameters once a frame, so only the last value is heard unless another
+ * event on the channel uses it first. The look ahead stops at any other
+ * message on the channel, at SysEx and tempo changes, at the end of the
+ * frame and after SMF_COALESCE_WINDOW events.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ * pEvent           - next event, the time of the parser is its time
+ *
+ * Outputs:
+ * EAS_TRUE if the event need not be applied
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL SMF_Superseded (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, const S_SMF_EVENT *pEvent)
+{
+    const S_SMF_EVENT *pNext;
+    const S_SMF_EVENT *pEnd;
+    EAS_U32 ticks;
+    EAS_U32 temp1, temp2;
+    EAS_I32 time;
+    EAS_U8 channel;
+
+    /* chase mode doesn't keep time */
+    if (!SMF_IsControllerValue(pEvent) || (pSMFData->flags & SMF_FLAGS_CHASE_MODE))
+        return EAS_FALSE;
+
+#ifdef JET_INTERFACE
+    /* JET is told of every controller of a callback track */
+    if (pSMFData->streams[pEvent->stream].midiStream.jetData & MIDI_FLAGS_JET_CB)
+        return EAS_FALSE;
+#endif
+
+    pEnd = pSMFData->events + pSMFData->numEvents;
+    if (pEnd - pEvent > SMF_COALESCE_WINDOW)
+        pEnd = pEvent + SMF_COALESCE_WINDOW;
+
+    channel = pEvent->status & 0x0f;
+    ticks = pEvent->ticks;
+    time = pSMFData->time;
+    for (pNext = pEvent + 1; pNext < pEnd; pNext++)
+    {
+        /* the time of the event as SMF_UpdateTime will find it */
+        temp1 = ((pNext->ticks - ticks) >> 10) * pSMFData->tickConv;
+        temp2 = ((pNext->ticks - ticks) & 0x3ff) * pSMFData->tickConv;
+        time += (EAS_I32)((temp1 << 8) + (temp2 >> 2));
+        ticks = pNext->ticks;
+
+        /*lint -e{704} use shift for performance */
+        if ((EAS_U32) (time >> 8) >= (pEASData->parseEndTime >> 8))
+            return EAS_FALSE;
+
+        /* end of stream and meta-events other than tempo don't touch the channels */
+        if (pNext->status == SMF_EVENT_NONE)
+            continue;
+        if (pNext->status == SMF_EVENT_META)
+        {
+            if (pNext->d1 == SMF_META_TEMPO)
+                return EAS_FALSE;
+            continue;
+        }
+        if (pNext->status >= 0xf0)
+            return EAS_FALSE;
+
+        if ((pNext->status & 0x0f) != channel)
+            continue;
+        if (!SMF_IsControllerValue(pNext))
+            return EAS_FALSE;
+        if ((pNext->status == pEvent->status) && (((pEvent->status & 0xf0) != 0xb0) || (pNext->d1 == pEvent->d1)))
+            return EAS_TRUE;
+    }
+    return EAS_FALSE;
+}
+#endif
+
+#if defined(_SMF_COMPILE_EVENTS) && defined(_LOOKAHEAD_PREFETCH)
+/*----------------------------------------------------------------------------
+ * SMF_PrefetchNotes()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Called after a frame is parsed to start loading the regions and samples
+ * of the notes due before endTime, so that the loads overlap the render of
+ * this frame instead of stalling the voices when they start. Only the
+ * compiled event list can be read ahead without moving the parser. The
+ * look ahead stops at a tempo change, at endTime and after
+ * SMF_PREFETCH_WINDOW events.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ * endTime          - end of the next frame in msecs/256
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * None, the parser and synth state are not changed
+ *
+ *----------------------------------------------------------------------------
+*/
+static void SMF_PrefetchNotes (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, EAS_I32 endTime)
+{
+    const S_SMF_EVENT *pNext;
+    const S_SMF_EVENT *pEnd;
+    EAS_U32 ticks;
+    EAS_U32 temp1, temp2;
+    EAS_I32 time;
+
+    /* chase mode doesn't keep time */
+    if ((pSMFData->events == NULL) || (pSMFData->pSynth == NULL) || (pSMFData->state > EAS_STATE_PLAY) ||
+        (pSMFData->flags & SMF_FLAGS_CHASE_MODE) || (pSMFData->eventIndex >= pSMFData->numEvents))
+        return;
+
+    pNext = pSMFData->events + pSMFData->eventIndex;
+    pEnd = pSMFData->events + pSMFData->numEvents;
+    if (pEnd - pNext > SMF_PREFETCH_WINDOW)
+        pEnd = pNext + SMF_PREFETCH_WINDOW;
+
+    ticks = pNext->ticks;
+    time = pSMFData->time;
+    for (; pNext < pEnd; pNext++)
+    {
+        /* the time of the event as SMF_UpdateTime will find it */
+        temp1 = ((pNext->ticks - ticks) >> 10) * pSMFData->tickConv;
+        temp2 = ((pNext->ticks - ticks) & 0x3ff) * pSMFData->tickConv;
+        time += (EAS_I32)((temp1 << 8) + (temp2 >> 2));
+        ticks = pNext->ticks;
+
+        /*lint -e{704} use shift for performance */
+        if ((EAS_U32) (time >> 8) >= ((EAS_U32) endTime >> 8))
+            return;
+
+        if (pNext->status == SMF_EVENT_META)
+        {
+            if (pNext->d1 == SMF_META_TEMPO)
+                return;
+            continue;
+        }
+        if (((pNext->status & 0xf0) != 0x90) || (pNext->d2 == 0))
+            continue;
+
+#ifdef JET_INTERFACE
+        if (pSMFData->streams[pNext->stream].midiStream.jetData & MIDI_FLAGS_JET_MUTE)
+            continue;
+#endif
+        VMPrefetchNote(pEASData->pVoiceMgr, pSMFData->pSynth, pNext->status & 0x0f, pNext->d1);
+    }
+}
+#endif
+
+#ifdef _SMF_SEEK_INDEX
+/*----------------------------------------------------------------------------
+ * SMF_RecordCheckpoint()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds a checkpoint of the parser and channel state to the seek index
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * The seek index is allocated on first use. Allocation failures are not
+ * reported, the locate simply parses from an earlier checkpoint.
+ *
+ *----------------------------------------------------------------------------
+*/
+static void SMF_RecordCheckpoint (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData)
+{
+    S_SMF_SEEK_INDEX *pIndex;
+    S_SMF_CHECKPOINT *pCheckpoint;
+    EAS_INT i;
+
+    /* the metadata and JET callbacks must see every event during a locate */
+    if (pEASData->staticMemoryModel || (pSMFData->metadata.callback != NULL) ||
+        (pSMFData->flags & (SMF_FLAGS_JET_STREAM | SMF_FLAGS_NO_SEEK_INDEX)))
+        return;
+
+    /* allocate the index on first use */
+    if ((pIndex = pSMFData->pSeekIndex) == NULL)
+    {
+        if ((pIndex = EAS_HWMalloc(pEASData->hwInstData, sizeof(S_SMF_SEEK_INDEX))) == NULL)
+            return;
+        EAS_HWMemSet(pIndex, 0, sizeof(S_SMF_SEEK_INDEX));
+        pIndex->interval = SMF_CHECKPOINT_INTERVAL;
+        pIndex->nextTime = SMF_CHECKPOINT_INTERVAL;
+#ifdef DLS_SYNTHESIZER
+        pIndex->pDLS = pSMFData->pSynth->pDLS;
+#endif
+        pSMFData->pSeekIndex = pIndex;
+    }
+
+    /*lint -e{704} use shift for performance */
+    if ((pSMFData->time >> 8) < pIndex->nextTime)
+        return;
+
+    /* table is full, drop every other checkpoint and double the interval */
+    if (pIndex->numCheckpoints == SMF_MAX_CHECKPOINTS)
+    {
+        for (i = 0; i < SMF_MAX_CHECKPOINTS / 2; i++)
+        {
+            EAS_HWFree(pEASData->hwInstData, pIndex->checkpoints[i * 2 + 1]);
+            pIndex->checkpoints[i] = pIndex->checkpoints[i * 2];
+            pIndex->checkpoints[i * 2 + 1] = NULL;
+        }
+        pIndex->numCheckpoints = SMF_MAX_CHECKPOINTS / 2;
+        pIndex->interval *= 2;
+
+        /*lint -e{704} use shift for performance */
+        pIndex->nextTime = (pIndex->checkpoints[pIndex->numCheckpoints - 1]->time >> 8) + pIndex->interval;
+        if ((pSMFData->time >> 8) < pIndex->nextTime)
+            return;
+    }
+
+    pCheckpoint = EAS_HWMalloc(pEASData->hwInstData,
+        (EAS_I32) (sizeof(S_SMF_CHECKPOINT) + pSMFData->numStreams * sizeof(S_SMF_CHECKPOINT_STREAM)));
+    if (pCheckpoint == NULL)
+        return;
+
+    if (SMF_SaveCheckpoint(pEASData, pSMFData, pCheckpoint) != EAS_SUCCESS)
+    {
+        EAS_HWFree(pEASData->hwInstData, pCheckpoint);
+        return;
+    }
+
+    pIndex->checkpoints[pIndex->numCheckpoints++] = pCheckpoint;
+    /*lint -e{704} use shift for performance */
+    pIndex->nextTime = (pSMFData->time >> 8) + pIndex->interval;
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_RestoreCheckpoint()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Restores the nearest checkpoint at or before the requested time. Called
+ * after SMF_Reset when locating, so that only the events after the
+ * checkpoint need to be parsed.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ * time             - locate time in milliseconds
+ *
+ * Outputs:
+ * Returns EAS_SUCCESS if there is no suitable checkpoint. The parser is
+ * then left at the start of the file.
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_RestoreCheckpoint (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, EAS_I32 time)
+{
+    S_SMF_SEEK_INDEX *pIndex;
+    S_SMF_CHECKPOINT *pCheckpoint;
+    EAS_INT low, high, mid;
+
+    if ((pIndex = pSMFData->pSeekIndex) == NULL)
+        return EAS_SUCCESS;
+
+#ifdef DLS_SYNTHESIZER
+    /* program assignments are stale if the collection has changed */
+    if (pIndex->pDLS != pSMFData->pSynth->pDLS)
+    {
+        SMF_FreeSeekIndex(pEASData, pSMFData);
+        return EAS_SUCCESS;
+    }
+#endif
+
+    /* find the last checkpoint at or before the requested time */
+    low = 0;
+    high = pIndex->numCheckpoints;
+    while (low < high)
+    {
+        mid = (low + high) >> 1;
+        /*lint -e{704} use shift for performance */
+        if ((pIndex->checkpoints[mid]->time >> 8) <= time)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if (low == 0)
+        return EAS_SUCCESS;
+    pCheckpoint = pIndex->checkpoints[low - 1];
+
+    return SMF_LoadCheckpoint(pEASData, pSMFData, pCheckpoint);
+}
+#endif
+
+#if defined(_SMF_SEEK_INDEX) || defined(_ENGINE_SNAPSHOT)
+/*----------------------------------------------------------------------------
+ * SMF_SaveCheckpoint()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Fills a checkpoint with the parser and channel state
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ * pCheckpoint      - receives the checkpoint, followed by room for one
+ *                    S_SMF_CHECKPOINT_STREAM per stream
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_SaveCheckpoint (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_SMF_CHECKPOINT *pCheckpoint)
+{
+    S_SMF_CHECKPOINT_STREAM *pStream;
+    EAS_RESULT result;
+    EAS_INT i;
+
+    /* save the position and MIDI state of each stream */
+    pStream = (S_SMF_CHECKPOINT_STREAM*) (pCheckpoint + 1);
+    for (i = 0; i < pSMFData->numStreams; i++, pStream++)
+    {
+        if ((result = EAS_HWFilePos(pEASData->hwInstData, pSMFData->streams[i].fileHandle, &pStream->filePos)) != EAS_SUCCESS)
+            return result;
+        pStream->ticks = pSMFData->streams[i].ticks;
+        pStream->midiStream = pSMFData->streams[i].midiStream;
+    }
 
-        /* zero the memory to insure complete initialization */
-        EAS_HWMemSet((void *)(pSMFData->streams), 0, sizeof(S_SMF_STREAM) * numStreams);
+    /* save the parser and channel state */
+    pCheckpoint->time = pSMFData->time;
+    pCheckpoint->tickConv = pSMFData->tickConv;
+    pCheckpoint->nextStream = (EAS_U16) (pSMFData->nextStream - pSMFData->streams);
+    pCheckpoint->flags = pSMFData->flags;
+#ifdef _SMF_COMPILE_EVENTS
+    pCheckpoint->eventIndex = pSMFData->eventIndex;
+#endif
+    EAS_HWMemCpy(pCheckpoint->channels, pSMFData->pSynth->channels, sizeof(pCheckpoint->channels));
+    EAS_HWMemCpy(pCheckpoint->channelState, pSMFData->pSynth->channelState, sizeof(pCheckpoint->channelState));
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_LoadCheckpoint()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the parser and channel state to a checkpoint and leaves the
+ * parser playing
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ * pCheckpoint      - checkpoint from SMF_SaveCheckpoint
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_LoadCheckpoint (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, const S_SMF_CHECKPOINT *pCheckpoint)
+{
+    const S_SMF_CHECKPOINT_STREAM *pStream;
+    EAS_RESULT result;
+    EAS_INT i;
+
+    /* restore the position and MIDI state of each stream, JET owns the track flags */
+    pStream = (const S_SMF_CHECKPOINT_STREAM*) (pCheckpoint + 1);
+    for (i = 0; i < pSMFData->numStreams; i++, pStream++)
+    {
+        if ((result = EAS_HWFileSeek(pEASData->hwInstData, pSMFData->streams[i].fileHandle, pStream->filePos)) != EAS_SUCCESS)
+            return result;
+        pSMFData->streams[i].ticks = pStream->ticks;
+#ifdef JET_INTERFACE
+        {
+            EAS_U32 jetData = pSMFData->streams[i].midiStream.jetData;
+            pSMFData->streams[i].midiStream = pStream->midiStream;
+            pSMFData->streams[i].midiStream.jetData = jetData;
+        }
+#else
+        pSMFData->streams[i].midiStream = pStream->midiStream;
+#endif
     }
-    pSMFData->numStreams = numStreams;
 
-    /* find the start of each track */
+    /* restore the parser and channel state */
+    pSMFData->time = pCheckpoint->time;
+    pSMFData->tickConv = pCheckpoint->tickConv;
+    pSMFData->nextStream = &pSMFData->streams[pCheckpoint->nextStream];
+#ifdef _PROGRESSIVE_FILES
+    /* the download has moved on since the checkpoint */
+    pSMFData->flags = (EAS_U8) ((pCheckpoint->flags & ~(SMF_FLAGS_PROGRESSIVE | SMF_FLAGS_UNDERRUN)) | (pSMFData->flags & SMF_FLAGS_PROGRESSIVE));
+#else
+    pSMFData->flags = pCheckpoint->flags;
+#endif
+#ifdef _SMF_TRACK_TREE
+    SMF_InitTree(pSMFData);
+#endif
+#ifdef _SMF_COMPILE_EVENTS
+    pSMFData->eventIndex = pCheckpoint->eventIndex;
+#endif
+    pSMFData->state = EAS_STATE_PLAY;
+    EAS_HWMemCpy(pSMFData->pSynth->channels, pCheckpoint->channels, sizeof(pCheckpoint->channels));
+    EAS_HWMemCpy(pSMFData->pSynth->channelState, pCheckpoint->channelState, sizeof(pCheckpoint->channelState));
+
+    return EAS_SUCCESS;
+}
+#endif
+
+#ifdef _ENGINE_SNAPSHOT
+/*----------------------------------------------------------------------------
+ * SMF_SaveState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Saves the parser state for EAS_SaveState, as a checkpoint of the seek
+ * index would hold it
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ * pSnapshot        - receives the state, PARSER_DATA_STATE_SIZE bytes
+ *
+ * Outputs:
+ * EAS_ERROR_NOT_VALID_IN_THIS_STATE unless the parser is ready, playing
+ * or paused
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_SaveState (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, S_SMF_SNAPSHOT *pSnapshot)
+{
+    if ((pSMFData->pSynth == NULL) || (pSMFData->nextStream == NULL))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    if ((pSMFData->state != EAS_STATE_READY) && (pSMFData->state != EAS_STATE_PLAY) &&
+        (pSMFData->state != EAS_STATE_PAUSING) && (pSMFData->state != EAS_STATE_PAUSED))
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+    pSnapshot->numStreams = pSMFData->numStreams;
+    pSnapshot->state = pSMFData->state;
+    return SMF_SaveCheckpoint(pEASData, pSMFData, (S_SMF_CHECKPOINT*) (pSnapshot + 1));
+}
+
+/*----------------------------------------------------------------------------
+ * SMF_RestoreState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the parser to a state saved by SMF_SaveState
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ * pSnapshot        - state from SMF_SaveState
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_RestoreState (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData, const S_SMF_SNAPSHOT *pSnapshot)
+{
+    EAS_RESULT result;
+
+    if ((pSMFData->pSynth == NULL) || (pSnapshot->numStreams != pSMFData->numStreams))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    if ((result = SMF_LoadCheckpoint(pEASData, pSMFData, (const S_SMF_CHECKPOINT*) (pSnapshot + 1))) != EAS_SUCCESS)
+        return result;
+    pSMFData->state = (EAS_STATE) pSnapshot->state;
+    return EAS_SUCCESS;
+}
+#endif
+
+#ifdef _SMF_SEEK_INDEX
+/*----------------------------------------------------------------------------
+ * SMF_FreeSeekIndex()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees the seek index and all of its checkpoints
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pSMFData         - pointer to parser instance data
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void SMF_FreeSeekIndex (S_EAS_DATA *pEASData, S_SMF_DATA *pSMFData)
+{
+    S_SMF_SEEK_INDEX *pIndex;
+    EAS_INT i;
+
+    if ((pIndex = pSMFData->pSeekIndex) == NULL)
+        return;
+
+    for (i = 0; i < pIndex->numCheckpoints; i++)
+        EAS_HWFree(pEASData->hwInstData, pIndex->checkpoints[i]);
+    EAS_HWFree(pEASData->hwInstData, pIndex);
+    pSMFData->pSeekIndex = NULL;
+}
+#endif
+
+#ifdef _PROGRESSIVE_FILES
+/*----------------------------------------------------------------------------
+ * SMF_HeaderAvailable()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks that the header chunk, the header of every track and the first
+ * delta time of every track of a partial file have arrived, so that
+ * SMF_ParseHeader can set up the streams. Type 1 tracks are stored one
+ * after the other, so this is most of a type 1 file.
+ *
+ * Inputs:
+ * hwInstData       - instance data for the host layer
+ * pSMFData         - pointer to parser instance data
+ *
+ * Outputs:
+ * EAS_ERROR_DATA_UNDERRUN if more of the file is needed
+ *
+ * Side Effects:
+ * Moves the file position, SMF_ParseHeader seeks to the header anyway
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_HeaderAvailable (EAS_HW_DATA_HANDLE hwInstData, S_SMF_DATA *pSMFData)
+{
+    EAS_RESULT result;
+    EAS_I32 i;
+    EAS_U16 numStreams;
+    EAS_U32 chunkSize;
+    EAS_U32 chunkStart;
+    EAS_U32 temp;
+
+    /* the header chunk up to the time division */
+    if (pSMFData->available < pSMFData->fileOffset + SMF_OFS_NUM_TRACKS + 4)
+        return EAS_ERROR_DATA_UNDERRUN;
+    if ((result = EAS_HWFileSeek(hwInstData, pSMFData->fileHandle, pSMFData->fileOffset + SMF_OFS_HEADER_SIZE)) != EAS_SUCCESS)
+        return result;
+    if ((result = EAS_HWGetDWord(hwInstData, pSMFData->fileHandle, &chunkSize, EAS_TRUE)) != EAS_SUCCESS)
+        return result;
+    if ((result = EAS_HWFileSeek(hwInstData, pSMFData->fileHandle, pSMFData->fileOffset + SMF_OFS_NUM_TRACKS)) != EAS_SUCCESS)
+        return result;
+    if ((result = EAS_HWGetWord(hwInstData, pSMFData->fileHandle, &numStreams, EAS_TRUE)) != EAS_SUCCESS)
+        return result;
+    if (numStreams > MAX_SMF_STREAMS)
+        numStreams = MAX_SMF_STREAMS;
+
+    /* walk the chunks as SMF_ParseHeader does, it reports any errors */
     chunkStart = (EAS_U32) pSMFData->fileOffset;
-    ticks = 0x7fffffffL;
-    pSMFData->nextStream = NULL;
-    for (i = 0; i < pSMFData->numStreams; i++)
+    for (i = 0; i < numStreams; i++)
     {
-
         for (;;)
         {
-
-            /* calculate start of next chunk - checking for errors */
             temp = chunkStart + SMF_CHUNK_INFO_SIZE + chunkSize;
             if (temp <= chunkStart)
-            {
-                { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING,"Error in chunk size at offset %d\n", chunkStart); */ }
-                return EAS_ERROR_FILE_FORMAT;
-            }
+                return EAS_SUCCESS;
             chunkStart = temp;
 
-            /* seek to the start of the next chunk */
+            /* the chunk header and the first delta time */
+            if ((EAS_I32) chunkStart > pSMFData->available - SMF_CHUNK_INFO_SIZE - SMF_MAX_DELTA_SIZE)
+                return EAS_ERROR_DATA_UNDERRUN;
             if ((result = EAS_HWFileSeek(hwInstData, pSMFData->fileHandle, (EAS_I32) chunkStart)) != EAS_SUCCESS)
-                goto ReadError;
-
-            /* read the chunk identifier */
+                return result;
             if ((result = EAS_HWGetDWord(hwInstData, pSMFData->fileHandle, &temp, EAS_TRUE)) != EAS_SUCCESS)
-                goto ReadError;
-
-            /* read the chunk size */
+                return result;
             if ((result = EAS_HWGetDWord(hwInstData, pSMFData->fileHandle, &chunkSize, EAS_TRUE)) != EAS_SUCCESS)
-                goto ReadError;
-
-            /* make sure this is an 'MTrk' chunk */
+                return result;
             if (temp == SMF_CHUNK_TYPE_TRACK)
                 break;
-
-            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING,"Unexpected chunk type: 0x%08x\n", temp); */ }
         }
+    }
+    return EAS_SUCCESS;
+}
 
-        /* initalize some data */
-        pSMFData->streams[i].ticks = 0;
-        pSMFData->streams[i].fileHandle = pSMFData->fileHandle;
-
-        /* NULL the file handle so we don't try to close it twice */
-        pSMFData->fileHandle = NULL;
-
-        /* save this file position as the start of the track */
-        pSMFData->streams[i].startFilePos = (EAS_I32) chunkStart + SMF_CHUNK_INFO_SIZE;
+/*----------------------------------------------------------------------------
+ * SMF_EventAvailable()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks that the next event of a stream and the delta time after it have
+ * arrived. Channel messages are assumed to take SMF_MAX_MESSAGE_SIZE bytes
+ * and meta-events and SysEx are checked against their length. Only bytes
+ * before the available count are read.
+ *
+ * Inputs:
+ * hwInstData       - instance data for the host layer
+ * pSMFData         - pointer to parser instance data
+ * pSMFStream       - stream to check
+ * pAvailable       - set to EAS_TRUE if the event can be parsed
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * The stream file position is restored
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SMF_EventAvailable (EAS_HW_DATA_HANDLE hwInstData, S_SMF_DATA *pSMFData, S_SMF_STREAM *pSMFStream, EAS_BOOL *pAvailable)
+{
+    EAS_RESULT result;
+    EAS_I32 start;
+    EAS_I32 pos;
+    EAS_U32 len;
+    EAS_U8 c;
 
-        /* initalize the MIDI parser data */
-        EAS_InitMIDIStream(&pSMFData->streams[i].midiStream);
+    *pAvailable = EAS_FALSE;
+    if ((result = EAS_HWFilePos(hwInstData, pSMFStream->fileHandle, &start)) != EAS_SUCCESS)
+        return result;
 
-        /* parse the first delta time in each stream */
-        if ((result = SMF_GetDeltaTime(hwInstData, &pSMFData->streams[i])) != EAS_SUCCESS)
-                goto ReadError;
+    /* get the event type */
+    pos = start;
+    if (pos >= pSMFData->available)
+        return EAS_SUCCESS;
+    if ((result = EAS_HWGetByte(hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+        return result;
+    pos++;
 
-        if (pSMFData->streams[i].ticks < ticks)
+    /* meta-events and SysEx have a length */
+    if ((c == 0xff) || (c == 0xf0) || (c == 0xf7))
+    {
+        /* skip the meta-event type */
+        if (c == 0xff)
         {
-            ticks = pSMFData->streams[i].ticks;
-            pSMFData->nextStream = &pSMFData->streams[i];
+            if (pos >= pSMFData->available)
+                goto Restore;
+            if ((result = EAS_HWGetByte(hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+                return result;
+            pos++;
         }
 
-        /* more tracks to do, create a duplicate file handle */
-        if (i < (pSMFData->numStreams - 1))
+        /* read the length until bit 7 is zero */
+        len = 0;
+        do
         {
-            if ((result = EAS_HWDupHandle(hwInstData, pSMFData->streams[i].fileHandle, &pSMFData->fileHandle)) != EAS_SUCCESS)
-                goto ReadError;
-        }
+            if (pos >= pSMFData->available)
+                goto Restore;
+            if ((result = EAS_HWGetByte(hwInstData, pSMFStream->fileHandle, &c)) != EAS_SUCCESS)
+                return result;
+            pos++;
+            len = (len << 7) | (c & 0x7f);
+        } while (c & 0x80);
     }
 
-    /* update the time of the next event */
-    if (pSMFData->nextStream)
-        SMF_UpdateTime(pSMFData, pSMFData->nextStream->ticks);
+    /* rest of a channel message, the status byte may be running */
+    else
+        len = SMF_MAX_MESSAGE_SIZE - 1;
 
-    return EAS_SUCCESS;
+    /* the event data and the next delta time */
+    *pAvailable = ((EAS_I32) len <= pSMFData->available - pos - SMF_MAX_DELTA_SIZE);
 
-    /* ugly goto: but simpler than structured */
-    ReadError:
-        if (result == EAS_EOF)
-            return EAS_ERROR_FILE_FORMAT;
-        return result;
+    Restore:
+        return EAS_HWFileSeek(hwInstData, pSMFStream->fileHandle, start);
 }
 
 /*----------------------------------------------------------------------------
- * SMF_UpdateTime()
+ * SMF_DataArrived()
  *----------------------------------------------------------------------------
  * Purpose:
- * Update the millisecond time base by converting the ticks into millieconds
+ * Resumes a stream that stalled waiting for more of the file,
+ * SMF_Event checks the next event again.
  *
  * Inputs:
- *
+ * pSMFData         - pointer to parser instance data
  *
  * Outputs:
  *
@@ -1252,15 +3223,12 @@ EAS_RESULT SMF_ParseHeader (EAS_HW_DATA_HANDLE hwInstData, S_SMF_DATA *pSMFData)
  *
  *----------------------------------------------------------------------------
 */
-static void SMF_UpdateTime (S_SMF_DATA *pSMFData, EAS_U32 ticks)
+static void SMF_DataArrived (S_SMF_DATA *pSMFData)
 {
-    EAS_U32 temp1, temp2;
-
-    if (pSMFData->flags & SMF_FLAGS_CHASE_MODE)
+    if (!(pSMFData->flags & SMF_FLAGS_UNDERRUN))
         return;
-
-    temp1 = (ticks >> 10) * pSMFData->tickConv;
-    temp2 = (ticks & 0x3ff) * pSMFData->tickConv;
-    pSMFData->time += (EAS_I32)((temp1 << 8) + (temp2 >> 2));
+    pSMFData->flags &= ~SMF_FLAGS_UNDERRUN;
+    if ((pSMFData->state == EAS_STATE_PAUSING) || (pSMFData->state == EAS_STATE_PAUSED))
+        pSMFData->state = EAS_STATE_PLAY;
 }
-
+#endif
@@ -126,6 +126,12 @@ typedef struct s_dls_envelope_tag
     EAS_I16         velToAttack;
     EAS_I16         keyNumToDecay;
     EAS_I16         keyNumToHold;
+#ifdef _DLS_ENVELOPE_RATES
+    /* attack, hold and decay converted for notes they don't scale with */
+    EAS_I16         attackRate;
+    EAS_I16         holdFrames;
+    EAS_I16         decayRate;
+#endif
 } S_DLS_ENVELOPE;
 
 /*----------------------------------------------------------------------------
@@ -329,6 +335,44 @@ typedef struct s_bank_tag
 #define LIB_FORMAT_16_BIT_SAMPLES       0x00200000
 
 #ifdef DLS_SYNTHESIZER
+#ifdef _DLS_PROGRAM_INDEX
+/* slot of a locale in the program index, which is open addressed and at most half full */
+#define DLS_PROGRAM_HASH(locale, bits)  (((((EAS_U32) (locale)) * 0x9e3779b1UL) & 0xffffffffUL) >> (32 - (bits)))
+#endif
+
+#ifdef _DLS_KEY_INDEX
+/* entries per program in the key index, one per key plus the end of the last list */
+#define DLS_KEY_INDEX_STRIDE            129
+#define DLS_NO_KEY_INDEX                0xffff
+#endif
+
+#ifdef _DLS_LAZY_SAMPLES
+/*----------------------------------------------------------------------------
+ * DLS wave loaded on first use
+ *
+ * pSamples         converted samples, NULL until the wave is loaded
+ * dataPos          file position of the data chunk
+ * dataSize         size of the data chunk in bytes
+ * poolOffset       end of the wave in the wave pool of a resident collection
+ * loopStart        loop from the wave's wsmp chunk, for the loop guard sample
+ * loopLength
+ * bitsPerSample    sample size in the file
+ * allocated        pSamples was allocated, else it points into the file
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_dls_wave_tag
+{
+    EAS_SAMPLE          *pSamples;
+    EAS_I32             dataPos;
+    EAS_I32             dataSize;
+    EAS_U32             poolOffset;
+    EAS_U32             loopStart;
+    EAS_U32             loopLength;
+    EAS_U16             bitsPerSample;
+    EAS_BOOL8           allocated;
+} S_DLS_WAVE;
+#endif
+
 /*----------------------------------------------------------------------------
  * DLS data structure
  *
@@ -341,6 +385,18 @@ typedef struct s_bank_tag
  * numDLSRegions        number of DLS regions
  * numDLSArticulations  number of DLS articulations
  * numDLSSamples        number of DLS samples
+ * pProgramIndex        hash table of the programs by locale
+ * programIndexBits     log2 of the hash table size
+ * pKeyIndex            per program, start of each key's list in pKeyRegions
+ * pRegionKeyIndex      per region, program slot in pKeyIndex if it starts a program
+ * pKeyRegions          region indices that cover each key, in region order
+ * pDLSWaves            per wave load state, NULL if the samples are in pDLSSamples
+ * hwInstData           instance that owns fileHandle
+ * fileHandle           handle the waves are loaded from
+ * pFileData            contents of fileHandle if the host holds it in memory
+ * fileDataSize         size of pFileData
+ * wavePoolSize         size the wave pool would have if the samples were resident
+ * bigEndian            byte order of the file
  *----------------------------------------------------------------------------
 */
 typedef struct s_eas_dls_tag
@@ -355,7 +411,31 @@ typedef struct s_eas_dls_tag
     EAS_U16             numDLSRegions;
     EAS_U16             numDLSArticulations;
     EAS_U16             numDLSSamples;
-    EAS_U8              refCount;
+    EAS_U16             refCount;
+#ifdef _DLS_PROGRAM_INDEX
+    S_PROGRAM           *pProgramIndex;
+    EAS_U16             programIndexBits;
+#endif
+#ifdef _DLS_KEY_INDEX
+    EAS_U32             *pKeyIndex;
+    EAS_U16             *pRegionKeyIndex;
+    EAS_U16             *pKeyRegions;
+#endif
+#ifdef _DLS_LAZY_SAMPLES
+    S_DLS_WAVE          *pDLSWaves;
+    EAS_HW_DATA_HANDLE  hwInstData;
+    EAS_FILE_HANDLE     fileHandle;
+    const EAS_U8        *pFileData;
+    EAS_I32             fileDataSize;
+    EAS_U32             wavePoolSize;
+    EAS_BOOL            bigEndian;
+#endif
+#ifdef _DLS_COLLECTION_CACHE
+    struct s_eas_dls_tag *pCacheNext;
+    EAS_U8              *pCacheData;
+    EAS_I32             cacheSize;
+    EAS_U32             cacheHash;
+#endif
 } S_DLS;
 #endif
 
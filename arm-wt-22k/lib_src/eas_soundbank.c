@@ -0,0 +1,757 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_soundbank.c
+ *
+ * Contents and purpose:
+ * Loads and writes the binary sound library format described in
+ * eas_soundbank.h. The tables are decoded into S_EAS structures; the
+ * sample data, which is nearly all of a library, stays in the file's
+ * mapping so it is shared and never dirtied.
+ *
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+/* sound libraries are reported with the DLS collections */
+#define EAS_MEM_CATEGORY    EAS_MEM_DLS
+
+/*------------------------------------
+ * includes
+ *------------------------------------
+*/
+
+/* this define allows us to use the sndlib.h structures as RW memory */
+#define SCNST
+
+#include <stdint.h>
+
+#include "eas_data.h"
+#include "eas_host.h"
+#include "eas_imaadpcm.h"
+#include "eas_report.h"
+#include "eas_soundbank.h"
+#include "eas_vm_protos.h"
+
+/*----------------------------------------------------------------------------
+ * S_EAS_SOUNDBANK
+ *
+ * A loaded sound library. The S_EAS must come first, the handle given to
+ * the synthesizer points to it. The tables follow in the same allocation.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_eas_soundbank_tag
+{
+    S_EAS           lib;
+    EAS_VOID_PTR    mapping;            /* from EAS_HWMapFile */
+    EAS_SAMPLE      *pSampleCopy;       /* samples, if they cannot be used in place */
+#ifdef _SOUNDBANK_CACHE
+    struct s_eas_soundbank_tag *pCacheNext;
+    EAS_I32         cacheSize;          /* size of the file */
+    EAS_U32         cacheHash;          /* FNV-1a hash of the file */
+    EAS_U32         refCount;           /* users of a cached library, 0 if not cached */
+#endif
+} S_EAS_SOUNDBANK;
+
+#ifdef _SOUNDBANK_CACHE
+/* libraries shared by all library instances, protected by EAS_HWGlobalLock */
+static S_EAS_SOUNDBANK *pSoundbankCache = NULL;
+#endif
+
+/*----------------------------------------------------------------------------
+ * little-endian field access
+ *----------------------------------------------------------------------------
+*/
+static EAS_U16 GetU16 (const EAS_U8 *p)
+{
+    return (EAS_U16) (p[0] | (p[1] << 8));
+}
+
+static EAS_U32 GetU32 (const EAS_U8 *p)
+{
+    return (EAS_U32) p[0] | ((EAS_U32) p[1] << 8) | ((EAS_U32) p[2] << 16) | ((EAS_U32) p[3] << 24);
+}
+
+static void PutU16 (EAS_U8 *p, EAS_U32 value)
+{
+    p[0] = (EAS_U8) value;
+    p[1] = (EAS_U8) (value >> 8);
+}
+
+static void PutU32 (EAS_U8 *p, EAS_U32 value)
+{
+    p[0] = (EAS_U8) value;
+    p[1] = (EAS_U8) (value >> 8);
+    p[2] = (EAS_U8) (value >> 16);
+    p[3] = (EAS_U8) (value >> 24);
+}
+
+/* samples can be used in place on little-endian hosts */
+static EAS_BOOL SamplesInPlace (const void *pSamples)
+{
+    const EAS_U16 probe = 1;
+
+    if ((sizeof(EAS_SAMPLE) > 1) && (*((const EAS_U8*) &probe) != 1))
+        return EAS_FALSE;
+    return ((((uintptr_t) pSamples) % sizeof(EAS_SAMPLE)) == 0) ? EAS_TRUE : EAS_FALSE;
+}
+
+/*----------------------------------------------------------------------------
+ * SoundbankValidate()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks every index and sample range in a decoded library so a damaged
+ * file cannot send the synthesizer outside the library.
+ *
+ * Inputs:
+ * pLib             - decoded library
+ * samplesSize      - bytes of sample data, including the guard
+ *
+ * Outputs:
+ * EAS_ERROR_SOUND_LIBRARY if the library is not consistent
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SoundbankValidate (const S_EAS *pLib, EAS_U32 samplesSize)
+{
+    const S_WT_REGION *pRegion;
+    EAS_INT i;
+    EAS_INT j;
+
+    if ((pLib->numWTRegions == 0) || (pLib->numArticulations == 0) || (pLib->numSamples == 0))
+        return EAS_ERROR_SOUND_LIBRARY;
+    if ((pLib->libAttr & LIB_FORMAT_TYPE_MASK) != LIB_FORMAT_WAVETABLE)
+        return EAS_ERROR_SOUND_LIBRARY;
+
+    /* programs must start at a region */
+    for (i = 0; i < pLib->numBanks; i++)
+        for (j = 0; j < NUM_PROGRAMS_IN_BANK; j++)
+            if ((pLib->pBanks[i].regionIndex[j] != INVALID_REGION_INDEX) && (pLib->pBanks[i].regionIndex[j] >= pLib->numWTRegions))
+                return EAS_ERROR_SOUND_LIBRARY;
+    for (i = 0; i < pLib->numPrograms; i++)
+        if (pLib->pPrograms[i].regionIndex >= pLib->numWTRegions)
+            return EAS_ERROR_SOUND_LIBRARY;
+
+    /* the search for a region always stops at the last region */
+    if ((pLib->pWTRegions[pLib->numWTRegions - 1].region.keyGroupAndFlags & REGION_FLAG_LAST_REGION) == 0)
+        return EAS_ERROR_SOUND_LIBRARY;
+
+    /* samples lie inside the sample data, leaving the guard */
+    for (i = 0; i < pLib->numSamples; i++)
+    {
+        if ((pLib->pSampleOffsets[i] % sizeof(EAS_SAMPLE)) || (pLib->pSampleLen[i] < 2 * sizeof(EAS_SAMPLE)))
+            return EAS_ERROR_SOUND_LIBRARY;
+        if ((pLib->pSampleOffsets[i] > samplesSize - SOUNDBANK_SAMPLE_GUARD) ||
+            (pLib->pSampleLen[i] > samplesSize - SOUNDBANK_SAMPLE_GUARD - pLib->pSampleOffsets[i]))
+            return EAS_ERROR_SOUND_LIBRARY;
+    }
+
+    /* regions refer to samples and articulations, and loop inside the sample */
+    for (i = 0, pRegion = pLib->pWTRegions; i < pLib->numWTRegions; i++, pRegion++)
+    {
+        if ((pRegion->waveIndex >= pLib->numSamples) || (pRegion->artIndex >= pLib->numArticulations))
+            return EAS_ERROR_SOUND_LIBRARY;
+        if ((pRegion->region.keyGroupAndFlags & REGION_FLAG_IS_LOOPED) &&
+            ((pRegion->loopStart >= pRegion->loopEnd) || (pRegion->loopEnd > pLib->pSampleLen[pRegion->waveIndex] / sizeof(EAS_SAMPLE))))
+            return EAS_ERROR_SOUND_LIBRARY;
+
+        /* compressed samples are decoded in one pass, so cannot loop */
+        if (pRegion->region.keyGroupAndFlags & REGION_FLAG_USE_ADPCM)
+        {
+#ifdef _WT_ADPCM
+            if ((pRegion->region.keyGroupAndFlags & (REGION_FLAG_IS_LOOPED | REGION_FLAG_USE_WAVE_GENERATOR)) ||
+                (pLib->pSampleLen[pRegion->waveIndex] <= IMA_HEADER_SIZE))
+                return EAS_ERROR_SOUND_LIBRARY;
+#else
+            return EAS_ERROR_SOUND_LIBRARY;
+#endif
+        }
+    }
+
+    /* filter resonance indexes the coefficient tables */
+    for (i = 0; i < pLib->numArticulations; i++)
+        if (pLib->pArticulations[i].filterQ > FILTER_Q_MASK)
+            return EAS_ERROR_SOUND_LIBRARY;
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * SoundbankDecode()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Decodes and validates a sound library file held in memory. The library
+ * owns the mapping from then on, it is released with the library or, if
+ * the file is rejected, before returning.
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pFile            - contents of the file
+ * fileSize         - size of the file in bytes
+ * mapping          - from EAS_HWMapFile, or the copy of a cached library
+ * memCategory      - category charged for the tables
+ * ppBank           - receives the sound library
+ *
+ * Outputs:
+ * EAS_ERROR_SOUND_LIBRARY if the file is not a valid sound library for
+ * this build
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT SoundbankDecode (EAS_HW_DATA_HANDLE hwInstData, const EAS_U8 *pFile, EAS_I32 fileSize, EAS_VOID_PTR mapping, EAS_INT memCategory, S_EAS_SOUNDBANK **ppBank)
+{
+    S_EAS_SOUNDBANK *pBank;
+    S_EAS *pLib;
+    EAS_RESULT result;
+    const EAS_U8 *p;
+    EAS_U8 *pAlloc;
+    EAS_U32 tablesOffset;
+    EAS_U32 tablesSize;
+    EAS_U32 samplesOffset;
+    EAS_U32 samplesSize;
+    EAS_U16 numBanks;
+    EAS_U16 numPrograms;
+    EAS_U16 numRegions;
+    EAS_U16 numArticulations;
+    EAS_U16 numSamples;
+    EAS_INT i;
+    EAS_INT j;
+
+    *ppBank = NULL;
+
+    /* check the header */
+    result = EAS_ERROR_SOUND_LIBRARY;
+    if ((fileSize < SOUNDBANK_HEADER_SIZE) || (GetU32(pFile) != SOUNDBANK_MAGIC) || (GetU32(pFile + 4) != SOUNDBANK_VERSION))
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "EAS_SoundbankLoad: Not a sound library\n"); */ }
+        EAS_HWUnmapFile(hwInstData, mapping);
+        return result;
+    }
+    numBanks = GetU16(pFile + 16);
+    numPrograms = GetU16(pFile + 18);
+    numRegions = GetU16(pFile + 20);
+    numArticulations = GetU16(pFile + 22);
+    numSamples = GetU16(pFile + 24);
+    tablesOffset = GetU32(pFile + 28);
+    tablesSize = GetU32(pFile + 32);
+    samplesOffset = GetU32(pFile + 36);
+    samplesSize = GetU32(pFile + 40);
+    if ((GetU16(pFile + 26) != 0) ||
+        (tablesSize != (EAS_U32) numBanks * SOUNDBANK_BANK_SIZE + (EAS_U32) numPrograms * SOUNDBANK_PROGRAM_SIZE +
+            (EAS_U32) numRegions * SOUNDBANK_REGION_SIZE + (EAS_U32) numArticulations * SOUNDBANK_ARTICULATION_SIZE +
+            (EAS_U32) numSamples * SOUNDBANK_SAMPLE_INFO_SIZE) ||
+        (tablesOffset > (EAS_U32) fileSize) || (tablesSize > (EAS_U32) fileSize - tablesOffset) ||
+        (samplesOffset % SOUNDBANK_SAMPLE_ALIGN) || (samplesSize < SOUNDBANK_SAMPLE_GUARD) ||
+        (samplesOffset > (EAS_U32) fileSize) || (samplesSize > (EAS_U32) fileSize - samplesOffset))
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "EAS_SoundbankLoad: Sound library header is damaged\n"); */ }
+        EAS_HWUnmapFile(hwInstData, mapping);
+        return result;
+    }
+
+    /* one allocation for the library and its tables, widest types first */
+    pAlloc = EAS_HWMallocCategory(hwInstData, (EAS_I32) (sizeof(S_EAS_SOUNDBANK) + 2 * numSamples * sizeof(EAS_U32) +
+        numPrograms * sizeof(S_PROGRAM) + numRegions * sizeof(S_WT_REGION) +
+        numArticulations * sizeof(S_ARTICULATION) + numBanks * sizeof(S_BANK)), memCategory);
+    if (pAlloc == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_FATAL, "Failed to allocate sound library memory\n"); */ }
+        EAS_HWUnmapFile(hwInstData, mapping);
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+    pBank = (S_EAS_SOUNDBANK*) pAlloc;
+    pLib = &pBank->lib;
+    EAS_HWMemSet(pBank, 0, sizeof(S_EAS_SOUNDBANK));
+    pBank->mapping = mapping;
+    pAlloc += sizeof(S_EAS_SOUNDBANK);
+    pLib->identifier = GetU32(pFile + 8);
+    pLib->libAttr = GetU32(pFile + 12);
+    pLib->numBanks = numBanks;
+    pLib->numPrograms = numPrograms;
+    pLib->numWTRegions = numRegions;
+    pLib->numArticulations = numArticulations;
+    pLib->numSamples = numSamples;
+    pLib->pSampleLen = (EAS_U32*) pAlloc;
+    pAlloc += numSamples * sizeof(EAS_U32);
+    pLib->pSampleOffsets = (EAS_U32*) pAlloc;
+    pAlloc += numSamples * sizeof(EAS_U32);
+    pLib->pPrograms = (S_PROGRAM*) pAlloc;
+    pAlloc += numPrograms * sizeof(S_PROGRAM);
+    pLib->pWTRegions = (S_WT_REGION*) pAlloc;
+    pAlloc += numRegions * sizeof(S_WT_REGION);
+    pLib->pArticulations = (S_ARTICULATION*) pAlloc;
+    pAlloc += numArticulations * sizeof(S_ARTICULATION);
+    pLib->pBanks = (S_BANK*) pAlloc;
+
+    /* decode the tables */
+    p = pFile + tablesOffset;
+    for (i = 0; i < numBanks; i++, p += SOUNDBANK_BANK_SIZE)
+    {
+        pLib->pBanks[i].locale = GetU16(p);
+        for (j = 0; j < NUM_PROGRAMS_IN_BANK; j++)
+            pLib->pBanks[i].regionIndex[j] = GetU16(p + 2 + 2 * j);
+    }
+    for (i = 0; i < numPrograms; i++, p += SOUNDBANK_PROGRAM_SIZE)
+    {
+        pLib->pPrograms[i].locale = GetU32(p);
+        pLib->pPrograms[i].regionIndex = GetU16(p + 4);
+    }
+    for (i = 0; i < numRegions; i++, p += SOUNDBANK_REGION_SIZE)
+    {
+        pLib->pWTRegions[i].region.keyGroupAndFlags = GetU16(p);
+        pLib->pWTRegions[i].region.rangeLow = p[2];
+        pLib->pWTRegions[i].region.rangeHigh = p[3];
+        pLib->pWTRegions[i].tuning = (EAS_I16) GetU16(p + 4);
+        pLib->pWTRegions[i].gain = (EAS_I16) GetU16(p + 6);
+        pLib->pWTRegions[i].loopStart = GetU32(p + 8);
+        pLib->pWTRegions[i].loopEnd = GetU32(p + 12);
+        pLib->pWTRegions[i].waveIndex = GetU16(p + 16);
+        pLib->pWTRegions[i].artIndex = GetU16(p + 18);
+    }
+    for (i = 0; i < numArticulations; i++, p += SOUNDBANK_ARTICULATION_SIZE)
+    {
+        S_ARTICULATION *pArt = &pLib->pArticulations[i];
+        pArt->eg1.attackTime = (EAS_I16) GetU16(p);
+        pArt->eg1.decayTime = (EAS_I16) GetU16(p + 2);
+        pArt->eg1.sustainLevel = (EAS_I16) GetU16(p + 4);
+        pArt->eg1.releaseTime = (EAS_I16) GetU16(p + 6);
+        pArt->eg2.attackTime = (EAS_I16) GetU16(p + 8);
+        pArt->eg2.decayTime = (EAS_I16) GetU16(p + 10);
+        pArt->eg2.sustainLevel = (EAS_I16) GetU16(p + 12);
+        pArt->eg2.releaseTime = (EAS_I16) GetU16(p + 14);
+        pArt->lfoToPitch = (EAS_I16) GetU16(p + 16);
+        pArt->lfoDelay = (EAS_I16) GetU16(p + 18);
+        pArt->lfoFreq = (EAS_I16) GetU16(p + 20);
+        pArt->eg2ToPitch = (EAS_I16) GetU16(p + 22);
+        pArt->eg2ToFc = (EAS_I16) GetU16(p + 24);
+        pArt->filterCutoff = (EAS_I16) GetU16(p + 26);
+        pArt->lfoToGain = (EAS_I8) p[28];
+        pArt->filterQ = p[29];
+        pArt->pan = (EAS_I8) p[30];
+    }
+    for (i = 0; i < numSamples; i++, p += 4)
+        pLib->pSampleLen[i] = GetU32(p);
+    for (i = 0; i < numSamples; i++, p += 4)
+        pLib->pSampleOffsets[i] = GetU32(p);
+
+    /* check the library against this build, then check its contents */
+    result = VMValidateEASLib(pLib);
+    if (result == EAS_SUCCESS)
+        result = SoundbankValidate(pLib, samplesSize);
+
+    /* use the samples in place, or convert them to host order */
+    if ((result == EAS_SUCCESS) && SamplesInPlace(pFile + samplesOffset))
+        pLib->pSamples = (EAS_SAMPLE*) (pFile + samplesOffset);
+    else if (result == EAS_SUCCESS)
+    {
+        pBank->pSampleCopy = EAS_HWMallocCategory(hwInstData, (EAS_I32) samplesSize, memCategory);
+        if (pBank->pSampleCopy == NULL)
+            result = EAS_ERROR_MALLOC_FAILED;
+        else
+        {
+            p = pFile + samplesOffset;
+            for (i = 0; i < (EAS_INT) (samplesSize / sizeof(EAS_SAMPLE)); i++, p += sizeof(EAS_SAMPLE))
+                pBank->pSampleCopy[i] = (sizeof(EAS_SAMPLE) > 1) ? (EAS_SAMPLE) GetU16(p) : (EAS_SAMPLE) p[0];
+            pLib->pSamples = pBank->pSampleCopy;
+        }
+    }
+
+    if (result != EAS_SUCCESS)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "EAS_SoundbankLoad: Sound library rejected\n"); */ }
+        EAS_SoundbankUnload(hwInstData, pLib);
+        return result;
+    }
+
+    *ppBank = pBank;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SoundbankLoad()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Maps a sound library file and validates it. The sample data is used in
+ * place when the host maps the file; only the tables are copied.
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * locator          - sound library file
+ * ppLib            - receives the sound library
+ *
+ * Outputs:
+ * EAS_ERROR_SOUND_LIBRARY if the file is not a valid sound library for
+ * this build
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_SoundbankLoad (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_LOCATOR locator, EAS_SNDLIB_HANDLE *ppLib)
+{
+    S_EAS_SOUNDBANK *pBank;
+    EAS_FILE_HANDLE fileHandle;
+    EAS_VOID_PTR mapping;
+    EAS_RESULT result;
+    const void *pData;
+    EAS_I32 fileSize;
+
+    *ppLib = NULL;
+
+    /* map the file, the view outlives the handle */
+    if ((result = EAS_HWOpenFile(hwInstData, locator, &fileHandle, EAS_FILE_READ)) != EAS_SUCCESS)
+        return result;
+    result = EAS_HWMapFile(hwInstData, fileHandle, &pData, &fileSize, &mapping);
+    EAS_HWCloseFile(hwInstData, fileHandle);
+    if (result != EAS_SUCCESS)
+        return result;
+
+    if ((result = SoundbankDecode(hwInstData, (const EAS_U8*) pData, fileSize, mapping, EAS_MEM_DLS, &pBank)) != EAS_SUCCESS)
+        return result;
+    *ppLib = &pBank->lib;
+    return EAS_SUCCESS;
+}
+
+#ifdef _SOUNDBANK_CACHE
+/*----------------------------------------------------------------------------
+ * SoundbankFind()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the cached library read from a file with these contents. The
+ * caller holds EAS_HWGlobalLock.
+ *
+ * Inputs:
+ * pFile            - contents of the file
+ * fileSize         - size of the file in bytes
+ * hash             - FNV-1a hash of the contents
+ *
+ * Outputs:
+ * the library, or NULL if there is none
+ *
+ *----------------------------------------------------------------------------
+*/
+static S_EAS_SOUNDBANK *SoundbankFind (const EAS_U8 *pFile, EAS_I32 fileSize, EAS_U32 hash)
+{
+    S_EAS_SOUNDBANK *pBank;
+
+    for (pBank = pSoundbankCache; pBank != NULL; pBank = pBank->pCacheNext)
+    {
+        if ((pBank->cacheSize == fileSize) && (pBank->cacheHash == hash) &&
+            (EAS_HWMemCmp(pBank->mapping, pFile, fileSize) == 0))
+            return pBank;
+    }
+    return NULL;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_SoundbankLoadShared()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Loads a sound library that may be shared with other instances. With
+ * _SOUNDBANK_CACHE, a file read through the host is read into memory and
+ * decoded once for the process, and every instance that loads a file with
+ * the same contents uses that copy until the last one unloads it. Files the
+ * host holds in memory are already shared and are loaded as by
+ * EAS_SoundbankLoad, as are all files of an instance with its own heap.
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * locator          - sound library file
+ * ppLib            - receives the sound library
+ *
+ * Outputs:
+ * EAS_ERROR_SOUND_LIBRARY if the file is not a valid sound library for
+ * this build
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_SoundbankLoadShared (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_LOCATOR locator, EAS_SNDLIB_HANDLE *ppLib)
+{
+#ifdef _SOUNDBANK_CACHE
+    S_EAS_SOUNDBANK *pBank;
+    S_EAS_SOUNDBANK *pNewBank;
+    EAS_FILE_HANDLE fileHandle;
+    EAS_RESULT result;
+    const void *pData;
+    EAS_U8 *pCopy;
+    EAS_I32 fileSize;
+    EAS_I32 count;
+    EAS_U32 hash;
+    EAS_I32 i;
+
+    /* another instance could not free memory from a private heap */
+    *ppLib = NULL;
+    if (!EAS_HWSharedHeap(hwInstData))
+        return EAS_SoundbankLoad(hwInstData, locator, ppLib);
+
+    /* the host decides how long a file in memory stays valid */
+    if ((result = EAS_HWOpenFile(hwInstData, locator, &fileHandle, EAS_FILE_READ)) != EAS_SUCCESS)
+        return result;
+    if (((result = EAS_HWFileData(hwInstData, fileHandle, &pData, &fileSize)) == EAS_SUCCESS) && (pData == NULL))
+    {
+        if (((result = EAS_HWFileLength(hwInstData, fileHandle, &fileSize)) == EAS_SUCCESS) && (fileSize <= 0))
+            result = EAS_ERROR_FILE_READ_FAILED;
+    }
+    if ((result != EAS_SUCCESS) || (pData != NULL))
+    {
+        EAS_HWCloseFile(hwInstData, fileHandle);
+        return (result != EAS_SUCCESS) ? result : EAS_SoundbankLoad(hwInstData, locator, ppLib);
+    }
+
+    /* read it into memory that any instance may free */
+    if ((pCopy = EAS_HWMallocCategory(hwInstData, fileSize, EAS_MEM_SHARED)) == NULL)
+    {
+        EAS_HWCloseFile(hwInstData, fileHandle);
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+    result = EAS_HWReadFile(hwInstData, fileHandle, pCopy, fileSize, &count);
+    EAS_HWCloseFile(hwInstData, fileHandle);
+    if (result != EAS_SUCCESS)
+    {
+        EAS_HWFree(hwInstData, pCopy);
+        return EAS_ERROR_FILE_READ_FAILED;
+    }
+    hash = 2166136261UL;
+    for (i = 0; i < fileSize; i++)
+        hash = ((hash ^ pCopy[i]) * 16777619UL) & 0xffffffffUL;
+
+    /* use the cached library if there is one */
+    EAS_HWGlobalLock();
+    if ((pBank = SoundbankFind(pCopy, fileSize, hash)) != NULL)
+        pBank->refCount++;
+    EAS_HWGlobalUnlock();
+    if (pBank != NULL)
+    {
+        EAS_HWFree(hwInstData, pCopy);
+        *ppLib = &pBank->lib;
+        return EAS_SUCCESS;
+    }
+
+    /* decode it without holding the lock, the instance that frees it may be another one */
+    if ((result = SoundbankDecode(hwInstData, pCopy, fileSize, pCopy, EAS_MEM_SHARED, &pNewBank)) != EAS_SUCCESS)
+        return result;
+    pNewBank->cacheSize = fileSize;
+    pNewBank->cacheHash = hash;
+
+    /* another instance may have loaded the same library in the meantime */
+    EAS_HWGlobalLock();
+    if ((pBank = SoundbankFind(pCopy, fileSize, hash)) != NULL)
+        pBank->refCount++;
+    else
+    {
+        pNewBank->refCount = 1;
+        pNewBank->pCacheNext = pSoundbankCache;
+        pSoundbankCache = pNewBank;
+    }
+    EAS_HWGlobalUnlock();
+    if (pBank != NULL)
+    {
+        EAS_SoundbankUnload(hwInstData, &pNewBank->lib);
+        pNewBank = pBank;
+    }
+    *ppLib = &pNewBank->lib;
+    return EAS_SUCCESS;
+#else
+    return EAS_SoundbankLoad(hwInstData, locator, ppLib);
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SoundbankUnload()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees a sound library returned by EAS_SoundbankLoad or
+ * EAS_SoundbankLoadShared
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pLib             - sound library
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_SoundbankUnload (EAS_HW_DATA_HANDLE hwInstData, EAS_SNDLIB_HANDLE pLib)
+{
+    S_EAS_SOUNDBANK *pBank;
+
+    if (pLib == NULL)
+        return;
+    /*lint -e{740} the library is the first member of the sound bank */
+    pBank = (S_EAS_SOUNDBANK*) pLib;
+
+#ifdef _SOUNDBANK_CACHE
+    /* a cached library is freed by its last user, which may be another instance */
+    if (pBank->refCount != 0)
+    {
+        S_EAS_SOUNDBANK **ppPrev;
+
+        EAS_HWGlobalLock();
+        if (--pBank->refCount != 0)
+        {
+            EAS_HWGlobalUnlock();
+            return;
+        }
+        for (ppPrev = &pSoundbankCache; *ppPrev != NULL; ppPrev = &(*ppPrev)->pCacheNext)
+        {
+            if (*ppPrev == pBank)
+            {
+                *ppPrev = pBank->pCacheNext;
+                break;
+            }
+        }
+        EAS_HWGlobalUnlock();
+    }
+#endif
+
+    if (pBank->pSampleCopy != NULL)
+        EAS_HWFree(hwInstData, pBank->pSampleCopy);
+    EAS_HWUnmapFile(hwInstData, pBank->mapping);
+    EAS_HWFree(hwInstData, pBank);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SoundbankWrite()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Writes a sound library in the file format
+ *
+ * Inputs:
+ * pLib             - sound library
+ * pBuffer          - receives the file, NULL to only return the size
+ * bufferSize       - size of pBuffer in bytes
+ * pSize            - receives the size of the file in bytes
+ *
+ * Outputs:
+ * EAS_BUFFER_SIZE_MISMATCH if pBuffer is too small
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_SoundbankWrite (EAS_SNDLIB_HANDLE pLib, EAS_VOID_PTR pBuffer, EAS_I32 bufferSize, EAS_I32 *pSize)
+{
+    const S_ARTICULATION *pArt;
+    const S_WT_REGION *pRegion;
+    EAS_U8 *pFile;
+    EAS_U8 *p;
+    EAS_U32 tablesSize;
+    EAS_U32 samplesOffset;
+    EAS_U32 samplesSize;
+    EAS_U32 sampleBytes;
+    EAS_U32 fileSize;
+    EAS_INT i;
+    EAS_INT j;
+
+    *pSize = 0;
+    if ((pLib == NULL) || (pLib->numFMRegions != 0))
+        return EAS_ERROR_SOUND_LIBRARY;
+
+    /* the sample data ends with the last byte of any sample */
+    sampleBytes = 0;
+    for (i = 0; i < pLib->numSamples; i++)
+        if (pLib->pSampleOffsets[i] + pLib->pSampleLen[i] > sampleBytes)
+            sampleBytes = pLib->pSampleOffsets[i] + pLib->pSampleLen[i];
+
+    tablesSize = (EAS_U32) pLib->numBanks * SOUNDBANK_BANK_SIZE + (EAS_U32) pLib->numPrograms * SOUNDBANK_PROGRAM_SIZE +
+        (EAS_U32) pLib->numWTRegions * SOUNDBANK_REGION_SIZE + (EAS_U32) pLib->numArticulations * SOUNDBANK_ARTICULATION_SIZE +
+        (EAS_U32) pLib->numSamples * SOUNDBANK_SAMPLE_INFO_SIZE;
+    samplesOffset = (SOUNDBANK_HEADER_SIZE + tablesSize + SOUNDBANK_SAMPLE_ALIGN - 1) & ~(EAS_U32) (SOUNDBANK_SAMPLE_ALIGN - 1);
+    samplesSize = sampleBytes + SOUNDBANK_SAMPLE_GUARD;
+    fileSize = samplesOffset + samplesSize;
+    *pSize = (EAS_I32) fileSize;
+    if (pBuffer == NULL)
+        return EAS_SUCCESS;
+    if (bufferSize < (EAS_I32) fileSize)
+        return EAS_BUFFER_SIZE_MISMATCH;
+
+    /* header, the padding and the guard are zero */
+    pFile = (EAS_U8*) pBuffer;
+    EAS_HWMemSet(pFile, 0, (EAS_I32) fileSize);
+    PutU32(pFile, SOUNDBANK_MAGIC);
+    PutU32(pFile + 4, SOUNDBANK_VERSION);
+    PutU32(pFile + 8, pLib->identifier);
+    PutU32(pFile + 12, pLib->libAttr);
+    PutU16(pFile + 16, pLib->numBanks);
+    PutU16(pFile + 18, pLib->numPrograms);
+    PutU16(pFile + 20, pLib->numWTRegions);
+    PutU16(pFile + 22, pLib->numArticulations);
+    PutU16(pFile + 24, pLib->numSamples);
+    PutU32(pFile + 28, SOUNDBANK_HEADER_SIZE);
+    PutU32(pFile + 32, tablesSize);
+    PutU32(pFile + 36, samplesOffset);
+    PutU32(pFile + 40, samplesSize);
+
+    /* tables */
+    p = pFile + SOUNDBANK_HEADER_SIZE;
+    for (i = 0; i < pLib->numBanks; i++, p += SOUNDBANK_BANK_SIZE)
+    {
+        PutU16(p, pLib->pBanks[i].locale);
+        for (j = 0; j < NUM_PROGRAMS_IN_BANK; j++)
+            PutU16(p + 2 + 2 * j, pLib->pBanks[i].regionIndex[j]);
+    }
+    for (i = 0; i < pLib->numPrograms; i++, p += SOUNDBANK_PROGRAM_SIZE)
+    {
+        PutU32(p, pLib->pPrograms[i].locale);
+        PutU16(p + 4, pLib->pPrograms[i].regionIndex);
+    }
+    for (i = 0, pRegion = pLib->pWTRegions; i < pLib->numWTRegions; i++, pRegion++, p += SOUNDBANK_REGION_SIZE)
+    {
+        PutU16(p, pRegion->region.keyGroupAndFlags);
+        p[2] = pRegion->region.rangeLow;
+        p[3] = pRegion->region.rangeHigh;
+        PutU16(p + 4, (EAS_U16) pRegion->tuning);
+        PutU16(p + 6, (EAS_U16) pRegion->gain);
+        PutU32(p + 8, pRegion->loopStart);
+        PutU32(p + 12, pRegion->loopEnd);
+        PutU16(p + 16, pRegion->waveIndex);
+        PutU16(p + 18, pRegion->artIndex);
+    }
+    for (i = 0, pArt = pLib->pArticulations; i < pLib->numArticulations; i++, pArt++, p += SOUNDBANK_ARTICULATION_SIZE)
+    {
+        PutU16(p, (EAS_U16) pArt->eg1.attackTime);
+        PutU16(p + 2, (EAS_U16) pArt->eg1.decayTime);
+        PutU16(p + 4, (EAS_U16) pArt->eg1.sustainLevel);
+        PutU16(p + 6, (EAS_U16) pArt->eg1.releaseTime);
+        PutU16(p + 8, (EAS_U16) pArt->eg2.attackTime);
+        PutU16(p + 10, (EAS_U16) pArt->eg2.decayTime);
+        PutU16(p + 12, (EAS_U16) pArt->eg2.sustainLevel);
+        PutU16(p + 14, (EAS_U16) pArt->eg2.releaseTime);
+        PutU16(p + 16, (EAS_U16) pArt->lfoToPitch);
+        PutU16(p + 18, (EAS_U16) pArt->lfoDelay);
+        PutU16(p + 20, (EAS_U16) pArt->lfoFreq);
+        PutU16(p + 22, (EAS_U16) pArt->eg2ToPitch);
+        PutU16(p + 24, (EAS_U16) pArt->eg2ToFc);
+        PutU16(p + 26, (EAS_U16) pArt->filterCutoff);
+        p[28] = (EAS_U8) pArt->lfoToGain;
+        p[29] = pArt->filterQ;
+        p[30] = (EAS_U8) pArt->pan;
+    }
+    for (i = 0; i < pLib->numSamples; i++, p += 4)
+        PutU32(p, pLib->pSampleLen[i]);
+    for (i = 0; i < pLib->numSamples; i++, p += 4)
+        PutU32(p, pLib->pSampleOffsets[i]);
+
+    /* sample data */
+    p = pFile + samplesOffset;
+    for (i = 0; i < (EAS_INT) (sampleBytes / sizeof(EAS_SAMPLE)); i++, p += sizeof(EAS_SAMPLE))
+    {
+        if (sizeof(EAS_SAMPLE) > 1)
+            PutU16(p, (EAS_U16) pLib->pSamples[i]);
+        else
+            p[0] = (EAS_U8) pLib->pSamples[i];
+    }
+
+    return EAS_SUCCESS;
+}
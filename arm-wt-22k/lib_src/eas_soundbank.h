@@ -0,0 +1,165 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_soundbank.h
+ *
+ * Contents and purpose:
+ * Binary sound library format, so the wavetable library can be loaded
+ * from a file instead of being linked in.
+ *
+ * A file is a header followed by the tables and the sample data. Every
+ * field is little-endian and fixed width, so one file serves every ABI.
+ *
+ * header (SOUNDBANK_HEADER_SIZE bytes)
+ *  0   u32     SOUNDBANK_MAGIC
+ *  4   u32     SOUNDBANK_VERSION
+ *  8   u32     S_EAS identifier, _EAS_LIBRARY_VERSION
+ *  12  u32     S_EAS libAttr, sample rate and sample depth
+ *  16  u16     numBanks
+ *  18  u16     numPrograms
+ *  20  u16     numWTRegions
+ *  22  u16     numArticulations
+ *  24  u16     numSamples
+ *  26  u16     numFMRegions, must be 0
+ *  28  u32     offset of the tables
+ *  32  u32     size of the tables
+ *  36  u32     offset of the sample data, a multiple of SOUNDBANK_SAMPLE_ALIGN
+ *  40  u32     size of the sample data
+ *  44          reserved, zero
+ *
+ * tables, each table packed after the previous one
+ *  banks           u16 locale, u16 regionIndex[128]
+ *  programs        u32 locale, u16 regionIndex, u16 reserved
+ *  regions         u16 keyGroupAndFlags, u8 rangeLow, u8 rangeHigh,
+ *                  i16 tuning, i16 gain, u32 loopStart, u32 loopEnd,
+ *                  u16 waveIndex, u16 artIndex
+ *  articulations   i16 eg1 attack, decay, sustain, release,
+ *                  i16 eg2 attack, decay, sustain, release,
+ *                  i16 lfoToPitch, lfoDelay, lfoFreq, eg2ToPitch,
+ *                  i16 eg2ToFc, filterCutoff,
+ *                  i8 lfoToGain, u8 filterQ, i8 pan, u8 reserved
+ *  sample lengths  u32, in bytes
+ *  sample offsets  u32, in bytes from the start of the sample data
+ *
+ * The sample data is stored in the format S_EAS uses in memory, and is
+ * followed by at least SOUNDBANK_SAMPLE_GUARD bytes of silence for the
+ * interpolators to read past the end of the last sample. With _WT_ADPCM,
+ * unlooped regions flagged REGION_FLAG_USE_ADPCM play a sample compressed
+ * to IMA ADPCM: the first sample (i16), the step index (u8) and a zero
+ * byte, then one nibble per sample, low nibble first. Its length is the
+ * size of the compressed data.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_SOUNDBANK_H
+#define _EAS_SOUNDBANK_H
+
+#include "eas_types.h"
+
+/* "EASB" */
+#define SOUNDBANK_MAGIC                 0x42534145
+#define SOUNDBANK_VERSION               1
+
+#define SOUNDBANK_HEADER_SIZE           64
+#define SOUNDBANK_SAMPLE_ALIGN          16
+#define SOUNDBANK_SAMPLE_GUARD          16
+
+/* size of each table record in the file */
+#define SOUNDBANK_BANK_SIZE             258
+#define SOUNDBANK_PROGRAM_SIZE          8
+#define SOUNDBANK_REGION_SIZE           20
+#define SOUNDBANK_ARTICULATION_SIZE     32
+#define SOUNDBANK_SAMPLE_INFO_SIZE      8
+
+/*----------------------------------------------------------------------------
+ * EAS_SoundbankLoad()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Maps a sound library file and validates it. The sample data is used in
+ * place when the host maps the file; only the tables are copied.
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * locator          - sound library file
+ * ppLib            - receives the sound library
+ *
+ * Outputs:
+ * EAS_ERROR_SOUND_LIBRARY if the file is not a valid sound library for
+ * this build
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_SoundbankLoad (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_LOCATOR locator, EAS_SNDLIB_HANDLE *ppLib);
+
+/*----------------------------------------------------------------------------
+ * EAS_SoundbankLoadShared()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Loads a sound library like EAS_SoundbankLoad. With _SOUNDBANK_CACHE,
+ * instances that load files with the same contents share one read-only
+ * copy of the library.
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * locator          - sound library file
+ * ppLib            - receives the sound library
+ *
+ * Outputs:
+ * EAS_ERROR_SOUND_LIBRARY if the file is not a valid sound library for
+ * this build
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_SoundbankLoadShared (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_LOCATOR locator, EAS_SNDLIB_HANDLE *ppLib);
+
+/*----------------------------------------------------------------------------
+ * EAS_SoundbankUnload()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees a sound library returned by EAS_SoundbankLoad
+ *
+ * Inputs:
+ * hwInstData       - host instance data for memory allocation
+ * pLib             - sound library
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_SoundbankUnload (EAS_HW_DATA_HANDLE hwInstData, EAS_SNDLIB_HANDLE pLib);
+
+/*----------------------------------------------------------------------------
+ * EAS_SoundbankWrite()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Writes a sound library in the file format
+ *
+ * Inputs:
+ * pLib             - sound library
+ * pBuffer          - receives the file, NULL to only return the size
+ * bufferSize       - size of pBuffer in bytes
+ * pSize            - receives the size of the file in bytes
+ *
+ * Outputs:
+ * EAS_BUFFER_SIZE_MISMATCH if pBuffer is too small
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_SoundbankWrite (EAS_SNDLIB_HANDLE pLib, EAS_VOID_PTR pBuffer, EAS_I32 bufferSize, EAS_I32 *pSize);
+
+#endif /* end _EAS_SOUNDBANK_H */
@@ -37,7 +37,7 @@
 #include "eas_wtsynth.h"
 #endif
 
-#ifdef _FM_SYNTH
+#if defined(_FM_SYNTH) || defined(_FM_FALLBACK)
 #include "eas_fmsynth.h"
 #endif
 
@@ -50,8 +50,24 @@
 #endif
 
 #ifndef MAX_VIRTUAL_SYNTHESIZERS
+#ifdef _DYNAMIC_STREAMS
+/* each file stream has its own synthesizer, voice channels have room for 16 */
+#define MAX_VIRTUAL_SYNTHESIZERS    16
+#else
 #define MAX_VIRTUAL_SYNTHESIZERS    4
 #endif
+#endif
+
+#ifdef _PARALLEL_VOICE_RENDER
+#ifndef MAX_RENDER_THREADS
+#define MAX_RENDER_THREADS          8
+#endif
+
+/* below this many active voices a frame is rendered on the calling thread */
+#ifndef MIN_PARALLEL_VOICES
+#define MIN_PARALLEL_VOICES         8
+#endif
+#endif
 
 /* defines */
 #ifndef NUM_PRIMARY_VOICES
@@ -101,6 +117,21 @@
 /* synth parameters are updated every SYNTH_UPDATE_PERIOD_IN_SAMPLES */
 #define SYNTH_UPDATE_PERIOD_IN_SAMPLES  (EAS_I32)(0x1L << SYNTH_UPDATE_PERIOD_IN_BITS)
 
+/* largest update period when the output rate is selected at runtime */
+#define MAX_SYNTH_UPDATE_PERIOD_IN_SAMPLES  (SYNTH_UPDATE_PERIOD_IN_SAMPLES << MAX_RATE_SHIFT)
+
+/* update period of a voice manager, one frame of its output */
+#ifdef _RUNTIME_SAMPLE_RATE
+#define VM_UPDATE_PERIOD(pVoiceMgr)     (SYNTH_UPDATE_PERIOD_IN_SAMPLES << (pVoiceMgr)->rateShift)
+#else
+#define VM_UPDATE_PERIOD(pVoiceMgr)     SYNTH_UPDATE_PERIOD_IN_SAMPLES
+#endif
+
+#ifdef EAS_SPLIT_WT_SYNTH
+/* sample of the frame a mix buffer pointer of VMAddSamples starts at */
+#define VM_FRAME_OFFSET(pVoiceMgr, pMixBuffer)  ((EAS_I32) (((pMixBuffer) - (pVoiceMgr)->pFrameMixBuffer) / NUM_OUTPUT_CHANNELS))
+#endif
+
 /* stealing weighting factors */
 #define NOTE_AGE_STEAL_WEIGHT           1
 #define NOTE_GAIN_STEAL_WEIGHT          4
@@ -141,7 +172,8 @@
 #define DEFAULT_REVERB_SEND     40      /* some reverb */
 #endif
 
-#ifdef _CHORUS
+/* the chorus effect follows the channel sends */
+#if defined(_CHORUS) || defined(_CHORUS_ENABLED)
 #define DEFAULT_CHORUS_SEND     0       /* no chorus */
 #endif
 
@@ -191,6 +223,27 @@
 #define GET_VSYNTH(a) ((a) >> 4)
 #define GET_CHANNEL(a) ((a) & 15)
 
+/* voice sets are bit masks in voice order, one bit per voice */
+#define VOICE_MASK_WORDS ((MAX_SYNTH_VOICES + 31) >> 5)
+#define NUM_VOICE_MGR_CHANNELS (MAX_VIRTUAL_SYNTHESIZERS * NUM_SYNTH_CHANNELS)
+
+/* voices and virtual synthesizers of a voice manager, at most the compiled limits */
+#ifdef _RUNTIME_POLYPHONY
+#if !defined(EAS_WT_SYNTH)
+#error "_RUNTIME_POLYPHONY is only supported with EAS_WT_SYNTH"
+#endif
+#define VM_NUM_VOICES(pVoiceMgr)    ((pVoiceMgr)->numVoices)
+#define VM_NUM_SYNTHS(pVoiceMgr)    ((pVoiceMgr)->numVirtualSynths)
+#else
+#define VM_NUM_VOICES(pVoiceMgr)    MAX_SYNTH_VOICES
+#define VM_NUM_SYNTHS(pVoiceMgr)    MAX_VIRTUAL_SYNTHESIZERS
+#endif
+
+/*
+ * The channel parameters read while voices are started, updated and
+ * stolen, kept small so the channels of a synth share a few cache lines.
+ * The MIDI state they are calculated from is in S_SYNTH_CHANNEL_STATE.
+ */
 typedef struct s_synth_channel_tag
 {
     /* use static channel parameters to reduce MIPs */
@@ -200,44 +253,52 @@ typedef struct s_synth_channel_tag
 
     EAS_U16     regionIndex;        /* index of first region in program */
 
-    EAS_U16     bankNum;            /* play programs from this bank */
-    EAS_I16     pitchBend;          /* pitch wheel value */
-    EAS_I16     pitchBendSensitivity;
-    EAS_I16     registeredParam;    /* currently selected registered param */
-
-
 #if defined(_FM_SYNTH)
     EAS_I16     lfoAmt;             /* amount of LFO to apply to voice */
 #endif
 
-    EAS_U8      programNum;         /* play this instrument number */
-    EAS_U8      modWheel;           /* CC1 */
-    EAS_U8      volume;             /* CC7 */
-    EAS_U8      pan;                /* CC10 */
-
-    EAS_U8      expression;         /* CC11 */
-
-    /* the following parameters are controlled by RPNs */
-    EAS_I8      finePitch;
-    EAS_I8      coarsePitch;
-
-    EAS_U8      channelPressure;    /* applied to all voices on a given channel */
-
     EAS_U8      channelFlags;       /* bit field channelFlags for */
                                     /* CC64, SP-MIDI channel masking */
 
     EAS_U8      pool;               /* SPMIDI channel voice pool */
-    EAS_U8      mip;                /* SPMIDI MIP setting */
+    EAS_U8      modWheel;           /* CC1 */
+    EAS_U8      channelPressure;    /* applied to all voices on a given channel */
+    EAS_U8      pan;                /* CC10 */
 
 #ifdef  _REVERB
     EAS_U8      reverbSend;         /* CC91 */
 #endif
 
-#ifdef  _CHORUS
+#if defined(_CHORUS) || defined(_CHORUS_ENABLED)
     EAS_U8      chorusSend;         /* CC93 */
 #endif
 } S_SYNTH_CHANNEL;
 
+/*------------------------------------
+ * S_SYNTH_CHANNEL_STATE data structure
+ *
+ * The MIDI state of a channel that is only read when a controller
+ * changes, a note starts or the channel parameters are recalculated
+ *------------------------------------
+*/
+typedef struct s_synth_channel_state_tag
+{
+    EAS_U16     bankNum;            /* play programs from this bank */
+    EAS_I16     pitchBend;          /* pitch wheel value */
+    EAS_I16     pitchBendSensitivity;
+    EAS_I16     registeredParam;    /* currently selected registered param */
+
+    EAS_U8      programNum;         /* play this instrument number */
+    EAS_U8      volume;             /* CC7 */
+    EAS_U8      expression;         /* CC11 */
+
+    /* the following parameters are controlled by RPNs */
+    EAS_I8      finePitch;
+    EAS_I8      coarsePitch;
+
+    EAS_U8      mip;                /* SPMIDI MIP setting */
+} S_SYNTH_CHANNEL_STATE;
+
 /*------------------------------------
  * S_SYNTH_VOICE data structure
  *------------------------------------
@@ -274,20 +335,41 @@ typedef struct s_synth_voice_tag
  * specific to that synthesizer and reflected back through the
  * common state data available here.
  */
-    EAS_U16             regionIndex;        /* index to wave and playback params */
+
+/* the fields read by the voice stealing and note age scans come first */
     EAS_I16             gain;               /* current gain */
     EAS_U16             age;                /* large value means old note */
-    EAS_U16             nextRegionIndex;    /* index to wave and playback params */
     EAS_U8              voiceState;         /* current voice state */
     EAS_U8              voiceFlags;         /* misc flags/bit fields */
     EAS_U8              channel;            /* this voice plays on this synth channel */
     EAS_U8              note;               /* 12 <= key number <= 108 */
+    EAS_U16             regionIndex;        /* index to wave and playback params */
+#ifdef _SAMPLE_ACCURATE_EVENTS
+    EAS_U16             startOffset;        /* first sample of the frame the voice plays in */
+#endif
+#ifdef _LOW_LATENCY
+    EAS_U16             framePos;           /* position in the frame of the samples being synthesized */
+#endif
     EAS_U8              velocity;           /* 0 <= velocity <= 127 */
-    EAS_U8              nextChannel;        /* play stolen voice on this channel */
-    EAS_U8              nextNote;           /* 12 <= key number <= 108 */
-    EAS_U8              nextVelocity;       /* 0 <= velocity <= 127 */
 } S_SYNTH_VOICE;
 
+/*------------------------------------
+ * S_STOLEN_VOICE data structure
+ *
+ * The note a stolen voice plays once it
+ * has been muted. It is only read for
+ * stolen voices, so it is kept in its own
+ * array to keep S_SYNTH_VOICE compact.
+ *------------------------------------
+*/
+typedef struct s_stolen_voice_tag
+{
+    EAS_U16             regionIndex;        /* index to wave and playback params */
+    EAS_U8              channel;            /* play stolen voice on this channel */
+    EAS_U8              note;               /* 12 <= key number <= 108 */
+    EAS_U8              velocity;           /* 0 <= velocity <= 127 */
+} S_STOLEN_VOICE;
+
 /*------------------------------------
  * S_SYNTH data structure
  *
@@ -318,6 +400,7 @@ typedef struct s_synth_tag
 #endif
 
     S_SYNTH_CHANNEL         channels[NUM_SYNTH_CHANNELS];
+    S_SYNTH_CHANNEL_STATE   channelState[NUM_SYNTH_CHANNELS];
     EAS_I32                 totalNoteCount;
     EAS_U16                 maxPolyphony;
     EAS_U16                 numActiveVoices;
@@ -325,6 +408,19 @@ typedef struct s_synth_tag
     EAS_U8                  channelsByPriority[NUM_SYNTH_CHANNELS];
     EAS_U8                  poolCount[NUM_SYNTH_CHANNELS];
     EAS_U8                  poolAlloc[NUM_SYNTH_CHANNELS];
+#ifdef _INCREMENTAL_MIP
+    EAS_U8                  mipPools[NUM_SYNTH_CHANNELS];   /* channel pools when poolCount was last taken */
+#endif
+#ifdef _STEM_OUTPUT
+    EAS_U8                  channelStems[NUM_SYNTH_CHANNELS];
+#endif
+#ifdef _FM_FALLBACK
+    EAS_U8                  channelEngines[NUM_SYNTH_CHANNELS];     /* EAS_SYNTH_ENGINE_XXX */
+#endif
+#ifdef _INSERT_EFFECTS
+    struct s_insert_chain_tag *pInserts;    /* inserts on this stream's voices, NULL until the first one */
+#endif
+    EAS_U16                 dirtyChannels;      /* bit per channel with CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS set */
     EAS_U8                  synthFlags;
     EAS_I8                  globalTranspose;
     EAS_U8                  vSynthNum;
@@ -332,6 +428,11 @@ typedef struct s_synth_tag
     EAS_U8                  priority;
 } S_SYNTH;
 
+#ifdef _STEM_OUTPUT
+/* samples in each stem mix buffer */
+#define STEM_MIX_BUFFER_SIZE    (MAX_BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS)
+#endif
+
 /*------------------------------------
  * S_VOICE_MGR data structure
  *
@@ -341,7 +442,7 @@ typedef struct s_synth_tag
 typedef struct s_voice_mgr_tag
 {
     S_SYNTH                 *pSynth[MAX_VIRTUAL_SYNTHESIZERS];
-    EAS_PCM                 voiceBuffer[SYNTH_UPDATE_PERIOD_IN_SAMPLES];
+    EAS_PCM                 voiceBuffer[MAX_SYNTH_UPDATE_PERIOD_IN_SAMPLES];
 
 #ifdef _FM_SYNTH
     EAS_PCM                 operMixBuffer[SYNTH_UPDATE_PERIOD_IN_SAMPLES];
@@ -349,8 +450,22 @@ typedef struct s_voice_mgr_tag
 #endif
 
 #ifdef _WT_SYNTH
+#ifdef _RUNTIME_POLYPHONY
+    S_WT_VOICE              *wtVoices;
+#else
     S_WT_VOICE              wtVoices[NUM_WT_VOICES];
 #endif
+#endif
+
+#ifdef _FM_FALLBACK
+    /* FM state of the voices that play on the FM fallback engine */
+#ifdef _RUNTIME_POLYPHONY
+    S_FM_VOICE              *fmVoices;
+#else
+    S_FM_VOICE              fmVoices[MAX_SYNTH_VOICES];
+#endif
+    EAS_U8                  synthEngine;        /* EAS_SYNTH_ENGINE_XXX of the channels left at the default */
+#endif
 
 #ifdef _REVERB
     EAS_PCM                 reverbSendBuffer[NUM_OUTPUT_CHANNELS * SYNTH_UPDATE_PERIOD_IN_SAMPLES];
@@ -359,7 +474,17 @@ typedef struct s_voice_mgr_tag
 #ifdef _CHORUS
     EAS_PCM                 chorusSendBuffer[NUM_OUTPUT_CHANNELS * SYNTH_UPDATE_PERIOD_IN_SAMPLES];
 #endif
+#ifdef _RUNTIME_POLYPHONY
+    /* tables sized to numVoices and numVirtualSynths, see S_VM_TABLES */
+    S_SYNTH_VOICE           *voices;
+    S_STOLEN_VOICE          *stolenVoices;
+    EAS_U32                 (*channelVoiceMask)[VOICE_MASK_WORDS];
+    EAS_U16                 numVoices;
+    EAS_U8                  numVirtualSynths;
+#else
     S_SYNTH_VOICE           voices[MAX_SYNTH_VOICES];
+    S_STOLEN_VOICE          stolenVoices[MAX_SYNTH_VOICES];
+#endif
 
     EAS_SNDLIB_HANDLE       pGlobalEAS;
 
@@ -371,6 +496,10 @@ typedef struct s_voice_mgr_tag
     EAS_FRAME_BUFFER_HANDLE pFrameBuffer;
 #endif
 
+#ifdef EAS_SPLIT_WT_SYNTH
+    EAS_I32                 *pFrameMixBuffer;       /* start of the mix of the frame */
+#endif
+
 #if defined(_SECONDARY_SYNTH) || defined(EAS_SPLIT_WT_SYNTH)
     EAS_U16                 maxPolyphonyPrimary;
     EAS_U16                 maxPolyphonySecondary;
@@ -378,18 +507,96 @@ typedef struct s_voice_mgr_tag
 
     EAS_I32                 workload;
     EAS_I32                 maxWorkLoad;
+    EAS_I32                 numStolenVoices;
+
+#ifdef _CPU_BUDGET
+    /* microseconds per frame (0 = off) and the measured cost model in 1/256 microseconds */
+    EAS_I32                 cpuBudget;
+    EAS_I32                 voiceCost;
+    EAS_I32                 frameOverhead;
+#endif
 
     EAS_U16                 activeVoices;
     EAS_U16                 maxPolyphony;
 
     EAS_U16                 age;
 
+    /* active voices and active voices by channel (indexed by S_SYNTH_VOICE.channel) */
+    EAS_U32                 activeVoiceMask[VOICE_MASK_WORDS];
+#ifndef _RUNTIME_POLYPHONY
+    EAS_U32                 channelVoiceMask[NUM_VOICE_MGR_CHANNELS][VOICE_MASK_WORDS];
+#endif
+
+    /* voices that have been stolen, a voice that has left the stolen state stays until it is next checked */
+    EAS_U32                 stolenVoiceMask[VOICE_MASK_WORDS];
+
+#ifdef _SAMPLE_ACCURATE_EVENTS
+    /* position in the current frame of the event being processed */
+    EAS_I32                 eventOffset;
+#endif
+
+#ifdef _RUNTIME_SAMPLE_RATE
+    /* output rate is _OUTPUT_SAMPLE_RATE << rateShift */
+    EAS_I32                 rateShift;
+#endif
+
+#ifdef _LOW_LATENCY
+    /* position in the frame of the slice being rendered */
+    EAS_I32                 slicePos;
+#endif
+
+#ifdef _CUBIC_INTERPOLATION
+    /* E_EAS_INTERPOLATION */
+    EAS_I32                 interpolation;
+#endif
+
 /* limits the number of voice starts in a frame for split architecture */
 #ifdef MAX_VOICE_STARTS
     EAS_U16                 numVoiceStarts;
 #endif
+
+#ifdef _PARALLEL_VOICE_RENDER
+    /* worker pool and per-worker scratch for parallel voice rendering */
+    EAS_HW_WORKERS_HANDLE   pWorkers;
+    EAS_I32                 *pWorkerMixBuffers;
+    EAS_PCM                 *pWorkerVoiceBuffers;
+    EAS_I32                 *pRenderMixBuffer;
+    EAS_I32                 renderNumSamples;
+    EAS_INT                 numWorkers;
+    EAS_INT                 renderStride;
+    EAS_INT                 numRenderVoices;
+    EAS_U8                  renderVoices[MAX_SYNTH_VOICES];
+    EAS_BOOL8               renderDone[MAX_SYNTH_VOICES];
+#endif
+
+#ifdef _STEM_OUTPUT
+    /* one mix buffer per stem, summed into the output mix buffer */
+    EAS_I32                 *pStemMixBuffers;
+    EAS_INT                 numStems;
+#endif
 } S_VOICE_MGR;
 
+#ifdef _RUNTIME_POLYPHONY
+/*------------------------------------
+ * S_VM_TABLES data structure
+ *
+ * Voice tables for the compiled limits, used by the static memory
+ * model. The dynamic model allocates the same tables after the
+ * S_VOICE_MGR, sized to the voice and synthesizer counts.
+ *------------------------------------
+*/
+typedef struct s_vm_tables_tag
+{
+    S_WT_VOICE              wtVoices[NUM_WT_VOICES];
+    S_SYNTH_VOICE           voices[MAX_SYNTH_VOICES];
+    S_STOLEN_VOICE          stolenVoices[MAX_SYNTH_VOICES];
+    EAS_U32                 channelVoiceMask[NUM_VOICE_MGR_CHANNELS][VOICE_MASK_WORDS];
+#ifdef _FM_FALLBACK
+    S_FM_VOICE              fmVoices[MAX_SYNTH_VOICES];
+#endif
+} S_VM_TABLES;
+#endif
+
 #endif /* #ifdef _EAS_SYNTH_H */
 
 
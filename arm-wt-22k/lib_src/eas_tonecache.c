@@ -0,0 +1,184 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_tonecache.c
+ *
+ * Contents and purpose:
+ * Cache of the event lists compiled by the iMelody, RTTTL and OTA parsers.
+ * Applications often open the same short ringtone over and over; a list
+ * found here is copied to the parser instead of walking the file again.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+/* allocations of this module are reported as parser memory */
+#define EAS_MEM_CATEGORY    EAS_MEM_PARSERS
+
+/*------------------------------------
+ * includes
+ *------------------------------------
+*/
+
+#include "eas_tonecache.h"
+#include "eas_pcmcache.h"
+#include "eas_host.h"
+#include "eas_report.h"
+
+#ifdef _RINGTONE_EVENT_CACHE
+
+/* the events of an entry */
+#define TONE_CACHE_EVENTS(pEntry)   ((S_TONE_EVENT*) ((pEntry) + 1))
+
+/*----------------------------------------------------------------------------
+ * EAS_ToneCacheLookup()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Identifies the file of a ringtone and copies its event list if it was
+ * compiled before. The file is not read while the cache is disabled.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * fileHandle       - file of the ringtone, the file position is not kept
+ * parser           - TONE_CACHE_XXX
+ * pKey             - receives the key to store the compiled list with
+ * ppEvents         - receives a copy of the event list, NULL if not cached
+ * pNumEvents       - receives the number of events
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_ToneCacheLookup (S_EAS_DATA *pEASData, EAS_FILE_HANDLE fileHandle, EAS_U8 parser, S_TONE_CACHE_KEY *pKey, S_TONE_EVENT **ppEvents, EAS_U32 *pNumEvents)
+{
+    S_PCM_CACHE_KEY fileKey;
+    S_TONE_CACHE_ENTRY **ppEntry;
+    S_TONE_CACHE_ENTRY *pEntry;
+    S_TONE_EVENT *pEvents;
+    EAS_RESULT result;
+
+    *ppEvents = NULL;
+    *pNumEvents = 0;
+    EAS_HWMemSet(pKey, 0, sizeof(S_TONE_CACHE_KEY));
+    if (pEASData->toneCacheSize == 0)
+        return EAS_SUCCESS;
+
+    /* the PCM cache hashes files the same way */
+    if ((result = EAS_PCMCacheHashFile(pEASData->hwInstData, fileHandle, &fileKey)) != EAS_SUCCESS)
+        return result;
+    pKey->hash = fileKey.hash;
+    pKey->fileSize = fileKey.fileSize;
+    pKey->parser = parser;
+    if (pKey->fileSize == 0)
+        return EAS_SUCCESS;
+
+    for (ppEntry = &pEASData->pToneCache; (pEntry = *ppEntry) != NULL; ppEntry = &pEntry->pNext)
+    {
+        if ((pEntry->key.hash != pKey->hash) || (pEntry->key.fileSize != pKey->fileSize) || (pEntry->key.parser != parser))
+            continue;
+
+        /* move the entry to the front */
+        *ppEntry = pEntry->pNext;
+        pEntry->pNext = pEASData->pToneCache;
+        pEASData->pToneCache = pEntry;
+
+        /* a copy that the parser frees like a list it compiled */
+        if ((pEvents = EAS_HWMalloc(pEASData->hwInstData, (EAS_I32) (pEntry->numEvents * sizeof(S_TONE_EVENT)))) == NULL)
+            return EAS_SUCCESS;
+        EAS_HWMemCpy(pEvents, TONE_CACHE_EVENTS(pEntry), (EAS_I32) (pEntry->numEvents * sizeof(S_TONE_EVENT)));
+        *ppEvents = pEvents;
+        *pNumEvents = pEntry->numEvents;
+        break;
+    }
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ToneCacheStore()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Saves a copy of a compiled event list, evicting the least recently
+ * used list when the cache is full
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pKey             - key from EAS_ToneCacheLookup
+ * pEvents          - event list
+ * numEvents        - number of events
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_ToneCacheStore (S_EAS_DATA *pEASData, const S_TONE_CACHE_KEY *pKey, const S_TONE_EVENT *pEvents, EAS_U32 numEvents)
+{
+    S_TONE_CACHE_ENTRY *pEntry;
+
+    if ((pEASData->toneCacheSize == 0) || (pKey->fileSize == 0) || (numEvents == 0) || (numEvents > TONE_CACHE_MAX_EVENTS))
+        return;
+
+    /* make room in a full cache */
+    EAS_ToneCacheTrim(pEASData, pEASData->toneCacheSize - 1);
+
+    if ((pEntry = EAS_HWMalloc(pEASData->hwInstData, (EAS_I32) (sizeof(S_TONE_CACHE_ENTRY) + numEvents * sizeof(S_TONE_EVENT)))) == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "EAS_ToneCacheStore: no memory for %u events\n", numEvents); */ }
+        return;
+    }
+    pEntry->key = *pKey;
+    pEntry->numEvents = numEvents;
+    EAS_HWMemCpy(TONE_CACHE_EVENTS(pEntry), pEvents, (EAS_I32) (numEvents * sizeof(S_TONE_EVENT)));
+    pEntry->pNext = pEASData->pToneCache;
+    pEASData->pToneCache = pEntry;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ToneCacheTrim()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees the least recently used event lists until no more than
+ * numEntries are left
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * numEntries       - event lists to keep, 0 frees every list
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_ToneCacheTrim (S_EAS_DATA *pEASData, EAS_I32 numEntries)
+{
+    S_TONE_CACHE_ENTRY **ppEntry;
+    S_TONE_CACHE_ENTRY *pEntry;
+    EAS_I32 count;
+
+    /* the entries past the first numEntries are the least recently used */
+    count = 0;
+    for (ppEntry = &pEASData->pToneCache; *ppEntry != NULL; count++)
+    {
+        if (count < numEntries)
+        {
+            ppEntry = &(*ppEntry)->pNext;
+            continue;
+        }
+        pEntry = *ppEntry;
+        *ppEntry = pEntry->pNext;
+        EAS_HWFree(pEASData->hwInstData, pEntry);
+    }
+}
+
+#endif /* #ifdef _RINGTONE_EVENT_CACHE */
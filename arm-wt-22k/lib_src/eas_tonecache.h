@@ -0,0 +1,141 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_tonecache.h
+ *
+ * Contents and purpose:
+ * Cache of the event lists compiled by the iMelody, RTTTL and OTA parsers,
+ * so that a ringtone opened again is not parsed again.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_TONECACHE_H
+#define _EAS_TONECACHE_H
+
+#include "eas_data.h"
+#include "eas_miditypes.h"
+
+#ifdef _RINGTONE_EVENT_CACHE
+
+#ifndef _RINGTONE_COMPILE_EVENTS
+#error "_RINGTONE_EVENT_CACHE requires _RINGTONE_COMPILE_EVENTS"
+#endif
+
+/* most event lists EAS_SetToneCacheSize lets an instance keep */
+#ifndef TONE_CACHE_MAX_ENTRIES
+#define TONE_CACHE_MAX_ENTRIES      64
+#endif
+
+/* longer event lists are not cached */
+#ifndef TONE_CACHE_MAX_EVENTS
+#define TONE_CACHE_MAX_EVENTS       2048
+#endif
+
+/* the parser that compiled an event list */
+#define TONE_CACHE_IMELODY          1
+#define TONE_CACHE_RTTTL            2
+#define TONE_CACHE_OTA              3
+
+/*----------------------------------------------------------------------------
+ * S_TONE_CACHE_KEY
+ *
+ * The file an event list was compiled from
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_tone_cache_key_tag
+{
+    EAS_U32                         hash;           /* FNV-1a hash of the file */
+    EAS_I32                         fileSize;       /* size of the file, 0 if it can't be cached */
+    EAS_U8                          parser;         /* TONE_CACHE_XXX */
+} S_TONE_CACHE_KEY;
+
+/*----------------------------------------------------------------------------
+ * S_TONE_CACHE_ENTRY
+ *
+ * One event list, the events follow the entry in the same allocation
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_tone_cache_entry_tag
+{
+    struct s_tone_cache_entry_tag   *pNext;         /* next entry, most recently used first */
+    S_TONE_CACHE_KEY                key;
+    EAS_U32                         numEvents;
+} S_TONE_CACHE_ENTRY;
+
+/*----------------------------------------------------------------------------
+ * EAS_ToneCacheLookup()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Identifies the file of a ringtone and copies its event list if it was
+ * compiled before. The file is not read while the cache is disabled.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * fileHandle       - file of the ringtone, the file position is not kept
+ * parser           - TONE_CACHE_XXX
+ * pKey             - receives the key to store the compiled list with
+ * ppEvents         - receives a copy of the event list, NULL if not cached
+ * pNumEvents       - receives the number of events
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT EAS_ToneCacheLookup (S_EAS_DATA *pEASData, EAS_FILE_HANDLE fileHandle, EAS_U8 parser, S_TONE_CACHE_KEY *pKey, S_TONE_EVENT **ppEvents, EAS_U32 *pNumEvents);
+
+/*----------------------------------------------------------------------------
+ * EAS_ToneCacheStore()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Saves a copy of a compiled event list, evicting the least recently
+ * used list when the cache is full. Nothing is saved if the cache is
+ * disabled, the file could not be identified, the list is too long or
+ * there is no memory.
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pKey             - key from EAS_ToneCacheLookup
+ * pEvents          - event list
+ * numEvents        - number of events
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_ToneCacheStore (S_EAS_DATA *pEASData, const S_TONE_CACHE_KEY *pKey, const S_TONE_EVENT *pEvents, EAS_U32 numEvents);
+
+/*----------------------------------------------------------------------------
+ * EAS_ToneCacheTrim()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Frees the least recently used event lists until no more than
+ * numEntries are left
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * numEntries       - event lists to keep, 0 frees every list
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_ToneCacheTrim (S_EAS_DATA *pEASData, EAS_I32 numEntries);
+
+#endif /* #ifdef _RINGTONE_EVENT_CACHE */
+
+#endif /* end _EAS_TONECACHE_H */
@@ -41,12 +41,34 @@
  *
  * Inputs:
  * psEASData - pointer to overall EAS data structure
+ * numVoices - voices in the voice pool, 0 for MAX_SYNTH_VOICES
+ * numSynths - virtual synthesizers, 0 for MAX_VIRTUAL_SYNTHESIZERS
  *
  * Outputs:
+ *  EAS_ERROR_FEATURE_NOT_AVAILABLE for other counts without _RUNTIME_POLYPHONY
  *
  *----------------------------------------------------------------------------
 */
-EAS_RESULT VMInitialize (S_EAS_DATA *pEASData);
+EAS_RESULT VMInitialize (S_EAS_DATA *pEASData, EAS_I32 numVoices, EAS_I32 numSynths);
+
+#ifdef _INSTANCE_POOL
+/*----------------------------------------------------------------------------
+ * VMResetVoiceMgr()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the voice manager to the state after VMInitialize, for an
+ * instance that is used again. Every stream must be closed.
+ *
+ * Inputs:
+ * psEASData - pointer to overall EAS data structure
+ *
+ * Outputs:
+ * EAS_ERROR_NOT_VALID_IN_THIS_STATE if a virtual synthesizer is in use
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMResetVoiceMgr (S_EAS_DATA *pEASData);
+#endif
 
 /*----------------------------------------------------------------------------
  * VMInitMIDI()
@@ -162,6 +184,61 @@ void VMUpdateMIPTable (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth);
 */
 void VMInitializeAllVoices (S_VOICE_MGR *pVoiceMgr, EAS_INT vSynthNum);
 
+#ifdef _ENGINE_SNAPSHOT
+/*----------------------------------------------------------------------------
+ * VMStateSize()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the size of the largest synth snapshot
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ *
+ * Outputs:
+ * size in bytes
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 VMStateSize (S_VOICE_MGR *pVoiceMgr);
+
+/*----------------------------------------------------------------------------
+ * VMSaveState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Saves the channel state of a synth and the state of its voices
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pSynth - pointer to synth
+ * pState - receives the snapshot, VMStateSize bytes
+ *
+ * Outputs:
+ * size of the snapshot in bytes
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 VMSaveState (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, void *pState);
+
+/*----------------------------------------------------------------------------
+ * VMRestoreState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns a synth and its voices to a snapshot from VMSaveState
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pSynth - pointer to synth
+ * pState - snapshot
+ * size - size of the snapshot in bytes
+ *
+ * Outputs:
+ * EAS_ERROR_INVALID_PARAMETER if the snapshot does not belong to the synth
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMRestoreState (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, const void *pState, EAS_I32 size);
+#endif
+
 /*----------------------------------------------------------------------------
  * VMStartNote()
  *----------------------------------------------------------------------------
@@ -181,6 +258,27 @@ void VMInitializeAllVoices (S_VOICE_MGR *pVoiceMgr, EAS_INT vSynthNum);
 */
 void VMStartNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 note, EAS_U8 velocity);
 
+#ifdef _LOOKAHEAD_PREFETCH
+/*----------------------------------------------------------------------------
+ * VMPrefetchNote()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Starts loading the region and sample data of a note that is due in the
+ * next frame, without changing the state of the synth.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pSynth - pointer to synth
+ * channel - the MIDI channel
+ * note - the MIDI key number for this note
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMPrefetchNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 note);
+#endif
+
 /*----------------------------------------------------------------------------
  * VMCheckKeyGroup()
  *----------------------------------------------------------------------------
@@ -839,6 +937,45 @@ void VMSetPitchBendRange (S_SYNTH *pSynth, EAS_INT channel, EAS_I16 pitchBendRan
 EAS_RESULT VMSetGlobalEASLib (S_VOICE_MGR *pVoiceMgr, EAS_SNDLIB_HANDLE pEAS);
 EAS_RESULT VMSetEASLib (S_SYNTH *pSynth, EAS_SNDLIB_HANDLE pEAS);
 
+/*----------------------------------------------------------------------------
+ * VMValidateEASLib()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks that a sound library matches the library version, sample rate
+ * and sample depth of this build
+ *
+ * Inputs:
+ * pEAS - sound library
+ *
+ * Outputs:
+ * EAS_ERROR_SOUND_LIBRARY if the library cannot be used
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMValidateEASLib (EAS_SNDLIB_HANDLE pEAS);
+
+#ifdef _EXTERNAL_SOUNDBANK
+/*----------------------------------------------------------------------------
+ * VMChangeEASLib()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Switches a synthesizer that is already playing to another sound library.
+ * Voices of the old library are stopped and every channel looks up its
+ * current program again in the new library.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pSynth - synthesizer to switch
+ * pEAS - sound library
+ *
+ * Outputs:
+ * EAS_ERROR_SOUND_LIBRARY if the library cannot be used
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMChangeEASLib (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_SNDLIB_HANDLE pEAS);
+#endif
+
 #ifdef DLS_SYNTHESIZER
 /*----------------------------------------------------------------------------
  * VMSetDLSLib()
@@ -925,11 +1062,113 @@ EAS_I32 VMGetNoteCount (S_SYNTH *pSynth);
 */
 EAS_RESULT VMRender (S_VOICE_MGR *pVoiceMgr, EAS_I32 numSamples, EAS_I32 *pMixBuffer, EAS_I32 *pVoicesRendered);
 
+#ifdef _PARALLEL_VOICE_RENDER
+/*----------------------------------------------------------------------------
+ * VMSetRenderThreads()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Set the number of threads used to synthesize voices
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * numThreads       - number of threads including the calling thread
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMSetRenderThreads (S_EAS_DATA *pEASData, EAS_INT numThreads);
+#endif
+
+#ifdef _STEM_OUTPUT
+/*----------------------------------------------------------------------------
+ * VMSetStemCount()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the number of stems the voices are mixed into, 0 to mix them
+ * straight into the output mix buffer
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * numStems         - number of stems, up to EAS_MAX_STEMS
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMSetStemCount (S_EAS_DATA *pEASData, EAS_INT numStems);
+
+/*----------------------------------------------------------------------------
+ * VMSetChannelStem()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Assigns a MIDI channel of a virtual synth to a stem
+ *
+ * Inputs:
+ * pSynth           - pointer to virtual synth
+ * channel          - MIDI channel, or -1 for all channels
+ * stem             - stem number
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMSetChannelStem (S_SYNTH *pSynth, EAS_INT channel, EAS_INT stem);
+#endif
+
+#ifdef _FM_FALLBACK
+/*----------------------------------------------------------------------------
+ * VMSetSynthEngine()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the engine of the channels left at EAS_SYNTH_ENGINE_DEFAULT and
+ * selects their programs again on every synth
+ *
+ * Inputs:
+ * pVoiceMgr        - pointer to voice manager
+ * engine           - EAS_SYNTH_ENGINE_WAVETABLE or EAS_SYNTH_ENGINE_FM
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMSetSynthEngine (S_VOICE_MGR *pVoiceMgr, EAS_INT engine);
+
+/*----------------------------------------------------------------------------
+ * VMSetChannelEngine()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the engine of a MIDI channel of a virtual synth and selects its
+ * program again
+ *
+ * Inputs:
+ * pVoiceMgr        - pointer to voice manager
+ * pSynth           - pointer to virtual synth
+ * channel          - MIDI channel, or -1 for all channels
+ * engine           - E_EAS_SYNTH_ENGINE
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMSetChannelEngine (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_INT channel, EAS_INT engine);
+#endif
+
 /*----------------------------------------------------------------------------
  * VMInitWorkload()
  *----------------------------------------------------------------------------
  * Purpose:
- * Clears the workload counter
+ * Clears the workload and stolen voice counters
  *
  * Inputs:
  * pVoiceMgr            - pointer to instance data
@@ -976,6 +1215,47 @@ void VMSetWorkload (S_VOICE_MGR *pVoiceMgr, EAS_I32 maxWorkLoad);
 */
 EAS_BOOL VMCheckWorkload (S_VOICE_MGR *pVoiceMgr);
 
+#ifdef _CPU_BUDGET
+/*----------------------------------------------------------------------------
+ * VMSetCPUBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the time in microseconds each frame may take, 0 for no limit
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ * budget               - microseconds per frame
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMSetCPUBudget (S_VOICE_MGR *pVoiceMgr, EAS_I32 budget);
+
+/*----------------------------------------------------------------------------
+ * VMUpdateCPUBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adjusts the polyphony from the measured cost of the last frame
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ * frameTime            - microseconds taken by the frame
+ * renderTime           - microseconds of frameTime spent rendering voices
+ * voicesRendered       - voices rendered in the frame
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * may mute voices
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMUpdateCPUBudget (S_VOICE_MGR *pVoiceMgr, EAS_U32 frameTime, EAS_U32 renderTime, EAS_I32 voicesRendered);
+#endif
+
 /*----------------------------------------------------------------------------
  * VMActiveVoices()
  *----------------------------------------------------------------------------
@@ -994,6 +1274,25 @@ EAS_BOOL VMCheckWorkload (S_VOICE_MGR *pVoiceMgr);
 */
 EAS_I32 VMActiveVoices (S_SYNTH *pSynth);
 
+#ifdef _CHORUS_ENABLED
+/*----------------------------------------------------------------------------
+ * VMChorusSend()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the largest chorus send of the channels that have voices, the
+ * chorus effect is idle while it is zero.
+ *
+ * Inputs:
+ * pVoiceMgr        pointer to the voice manager
+ *
+ * Outputs:
+ * chorus send, 0 to 127
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_U8 VMChorusSend (S_VOICE_MGR *pVoiceMgr);
+#endif
+
 /*----------------------------------------------------------------------------
  * VMMIDIShutdown()
  *----------------------------------------------------------------------------
@@ -27,6 +27,9 @@
  *----------------------------------------------------------------------------
 */
 
+/* allocations of this module are reported as voice manager memory */
+#define EAS_MEM_CATEGORY    EAS_MEM_VOICE_MGR
+
 /* includes */
 #include "eas.h"
 #include "eas_data.h"
@@ -36,11 +39,20 @@
 #include "eas_host.h"
 #include "eas_synth_protos.h"
 #include "eas_vm_protos.h"
+#include "eas_trace.h"
 
 #ifdef DLS_SYNTHESIZER
 #include "eas_mdls.h"
 #endif
 
+#ifdef _INSERT_EFFECTS
+#include "eas_mixer.h"
+#endif
+
+#ifdef _FM_FALLBACK
+#include "eas_fmengine.h"
+#endif
+
 // #define _DEBUG_VM
 
 /* some defines for workload */
@@ -50,6 +62,15 @@
 #define WORKLOAD_AMOUNT_KEY_GROUP           10
 #define WORKLOAD_AMOUNT_POLY_LIMIT          10
 
+#ifdef _CPU_BUDGET
+/* CPU budget: fewest voices kept, voices of headroom needed before
+ * polyphony is raised, and log2 of the frames the cost model averages */
+#define CPU_BUDGET_MIN_VOICES               4
+#define CPU_BUDGET_HYSTERESIS               2
+#define CPU_BUDGET_SMOOTHING                3
+#define CPU_BUDGET_MAX                      1000000
+#endif
+
 /* pointer to base sound library */
 extern S_EAS easSoundLib;
 
@@ -128,6 +149,10 @@ EAS_INLINE const S_REGION* GetRegionPtr (S_SYNTH *pSynth, EAS_U16 regionIndex)
     if (regionIndex & FLAG_RGN_IDX_DLS_SYNTH)
         return &pSynth->pDLS->pDLSRegions[regionIndex & REGION_INDEX_MASK].wtRegion.region;
 #endif
+#if defined(_FM_FALLBACK)
+    if (regionIndex & FLAG_RGN_IDX_FM_SYNTH)
+        return &fmPatches[regionIndex & REGION_INDEX_MASK].region;
+#endif
 #if defined(_HYBRID_SYNTH)
     if (regionIndex & FLAG_RGN_IDX_FM_SYNTH)
         return &pSynth->pEAS->pFMRegions[regionIndex & REGION_INDEX_MASK].region;
@@ -140,6 +165,19 @@ EAS_INLINE const S_REGION* GetRegionPtr (S_SYNTH *pSynth, EAS_U16 regionIndex)
 #endif
 }
 
+#ifdef _FM_FALLBACK
+/* returns EAS_TRUE if the channel plays on the FM fallback engine */
+EAS_INLINE EAS_BOOL VMChannelUsesFM (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel)
+{
+    EAS_INT engine;
+
+    engine = pSynth->channelEngines[channel];
+    if (engine == EAS_SYNTH_ENGINE_DEFAULT)
+        engine = pVoiceMgr->synthEngine;
+    return (EAS_BOOL) (engine == EAS_SYNTH_ENGINE_FM);
+}
+#endif
+
 /*lint -esym(715, voiceNum) used in some implementation */
 EAS_INLINE const S_SYNTH_INTERFACE* GetSynthPtr (EAS_INT voiceNum)
 {
@@ -168,22 +206,164 @@ EAS_INLINE EAS_U8 VSynthToChannel (S_SYNTH *pSynth, EAS_U8 channel)
     return channel | (pSynth->vSynthNum << 4);
 }
 
+/*----------------------------------------------------------------------------
+ * VMLowestBit()
+ *----------------------------------------------------------------------------
+ * Returns the index of the lowest set bit in a non-zero voice mask word
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE EAS_INT VMLowestBit (EAS_U32 bits)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzl(bits);
+#else
+    EAS_INT bit;
+    for (bit = 0; (bits & 1) == 0; bit++)
+        bits >>= 1;
+    return bit;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * VMNextVoice()
+ *----------------------------------------------------------------------------
+ * Returns the first voice at or after voiceNum that is in the voice mask,
+ * or MAX_SYNTH_VOICES if there are none. Voices are returned in voice
+ * order, so loops over a mask visit voices in the same order as a scan
+ * of the full voice array.
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE EAS_INT VMNextVoice (const EAS_U32 *pMask, EAS_INT voiceNum)
+{
+    EAS_INT word;
+    EAS_U32 bits;
+
+    if (voiceNum >= MAX_SYNTH_VOICES)
+        return MAX_SYNTH_VOICES;
+
+    word = voiceNum >> 5;
+    bits = pMask[word] & (0xffffffffUL << (voiceNum & 31)) & 0xffffffffUL;
+    while (bits == 0)
+    {
+        if (++word >= VOICE_MASK_WORDS)
+            return MAX_SYNTH_VOICES;
+        bits = pMask[word];
+    }
+    return (word << 5) + VMLowestBit(bits);
+}
+
+#if defined(_SAMPLE_PREFETCH) && defined(_WT_SYNTH)
+/*----------------------------------------------------------------------------
+ * VMPrefetchVoice()
+ *----------------------------------------------------------------------------
+ * Starts loading the samples a wavetable voice reads in the next frame.
+ * voiceNum may be MAX_SYNTH_VOICES, as VMNextVoice returns at the end of
+ * the mask.
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE void VMPrefetchVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum, EAS_I32 numSamples)
+{
+    if ((voiceNum >= MAX_SYNTH_VOICES) || (pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateFree))
+        return;
+#if defined(_HYBRID_SYNTH)
+    if (GetSynthPtr(voiceNum) != pPrimarySynth)
+        return;
+#endif
+#ifdef _FM_FALLBACK
+    /* FM voices have no samples */
+    if (pVoiceMgr->voices[voiceNum].regionIndex & FLAG_RGN_IDX_FM_SYNTH)
+        return;
+#endif
+#ifdef EAS_SPLIT_WT_SYNTH
+    /* off-chip voices hold sample offsets */
+    if (voiceNum >= NUM_PRIMARY_VOICES)
+        return;
+#endif
+    WT_PrefetchVoice(&pVoiceMgr->wtVoices[voiceNum], numSamples);
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * VMNextFreeVoice()
+ *----------------------------------------------------------------------------
+ * Returns the first free voice at or after voiceNum, or MAX_SYNTH_VOICES if
+ * there are none.
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE EAS_INT VMNextFreeVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
+{
+    EAS_INT word;
+    EAS_U32 bits;
+
+    if (voiceNum >= MAX_SYNTH_VOICES)
+        return MAX_SYNTH_VOICES;
+
+    word = voiceNum >> 5;
+    bits = ~pVoiceMgr->activeVoiceMask[word] & (0xffffffffUL << (voiceNum & 31)) & 0xffffffffUL;
+    while (bits == 0)
+    {
+        if (++word >= VOICE_MASK_WORDS)
+            return MAX_SYNTH_VOICES;
+        bits = ~pVoiceMgr->activeVoiceMask[word] & 0xffffffffUL;
+    }
+    voiceNum = (word << 5) + VMLowestBit(bits);
+    return (voiceNum < VM_NUM_VOICES(pVoiceMgr)) ? voiceNum : MAX_SYNTH_VOICES;
+}
+
+/*----------------------------------------------------------------------------
+ * VMActivateVoice()
+ *----------------------------------------------------------------------------
+ * Adds a voice to the active voice set and to the voice set of the channel
+ * it is assigned to. Called after the voice channel has been set.
+ *----------------------------------------------------------------------------
+*/
+static void VMActivateVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
+{
+    EAS_U32 bit = 1UL << (voiceNum & 31);
+
+    pVoiceMgr->activeVoiceMask[voiceNum >> 5] |= bit;
+    pVoiceMgr->channelVoiceMask[pVoiceMgr->voices[voiceNum].channel][voiceNum >> 5] |= bit;
+}
+
+/*----------------------------------------------------------------------------
+ * VMDeactivateVoice()
+ *----------------------------------------------------------------------------
+ * Removes a voice from the active voice set and from its channel voice set.
+ * Called before the voice channel is changed or the voice is initialized.
+ *----------------------------------------------------------------------------
+*/
+static void VMDeactivateVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
+{
+    EAS_U32 bit = 1UL << (voiceNum & 31);
+
+    /* free voices are not in any channel set */
+    if ((pVoiceMgr->activeVoiceMask[voiceNum >> 5] & bit) == 0)
+        return;
+
+    pVoiceMgr->activeVoiceMask[voiceNum >> 5] &= ~bit;
+    pVoiceMgr->channelVoiceMask[pVoiceMgr->voices[voiceNum].channel][voiceNum >> 5] &= ~bit;
+}
+
 /*----------------------------------------------------------------------------
  * InitVoice()
  *----------------------------------------------------------------------------
  * Initialize a synthesizer voice
  *----------------------------------------------------------------------------
 */
-void InitVoice (S_SYNTH_VOICE *pVoice)
+void InitVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
 {
+    S_SYNTH_VOICE *pVoice = &pVoiceMgr->voices[voiceNum];
+    S_STOLEN_VOICE *pStolen = &pVoiceMgr->stolenVoices[voiceNum];
+
     pVoice->channel = UNASSIGNED_SYNTH_CHANNEL;
-    pVoice->nextChannel = UNASSIGNED_SYNTH_CHANNEL;
-    pVoice->note = pVoice->nextNote = DEFAULT_KEY_NUMBER;
-    pVoice->velocity = pVoice->nextVelocity = DEFAULT_VELOCITY;
+    pStolen->channel = UNASSIGNED_SYNTH_CHANNEL;
+    pVoice->note = pStolen->note = DEFAULT_KEY_NUMBER;
+    pVoice->velocity = pStolen->velocity = DEFAULT_VELOCITY;
     pVoice->regionIndex = DEFAULT_REGION_INDEX;
     pVoice->age = DEFAULT_AGE;
     pVoice->voiceFlags = DEFAULT_VOICE_FLAGS;
     pVoice->voiceState = DEFAULT_VOICE_STATE;
+    pVoiceMgr->stolenVoiceMask[voiceNum >> 5] &= ~(1UL << (voiceNum & 31));
 }
 
 /*----------------------------------------------------------------------------
@@ -196,6 +376,7 @@ static void IncVoicePoolCount (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice)
 {
     S_SYNTH *pSynth;
     EAS_INT pool;
+    EAS_U8 nextChannel;
 
     /* ignore muting voices */
     if (pVoice->voiceState == eVoiceStateMuting)
@@ -203,8 +384,9 @@ static void IncVoicePoolCount (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice)
 
     if (pVoice->voiceState == eVoiceStateStolen)
     {
-        pSynth = pVoiceMgr->pSynth[GET_VSYNTH(pVoice->nextChannel)];
-        pool = pSynth->channels[GET_CHANNEL(pVoice->nextChannel)].pool;
+        nextChannel = pVoiceMgr->stolenVoices[pVoice - pVoiceMgr->voices].channel;
+        pSynth = pVoiceMgr->pSynth[GET_VSYNTH(nextChannel)];
+        pool = pSynth->channels[GET_CHANNEL(nextChannel)].pool;
     }
     else
     {
@@ -229,6 +411,7 @@ static void DecVoicePoolCount (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice)
 {
     S_SYNTH *pSynth;
     EAS_INT pool;
+    EAS_U8 nextChannel;
 
     /* ignore muting voices */
     if (pVoice->voiceState == eVoiceStateMuting)
@@ -236,8 +419,9 @@ static void DecVoicePoolCount (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice)
 
     if (pVoice->voiceState == eVoiceStateStolen)
     {
-        pSynth = pVoiceMgr->pSynth[GET_VSYNTH(pVoice->nextChannel)];
-        pool = pSynth->channels[GET_CHANNEL(pVoice->nextChannel)].pool;
+        nextChannel = pVoiceMgr->stolenVoices[pVoice - pVoiceMgr->voices].channel;
+        pSynth = pVoiceMgr->pSynth[GET_VSYNTH(nextChannel)];
+        pool = pSynth->channels[GET_CHANNEL(nextChannel)].pool;
     }
     else
     {
@@ -253,49 +437,73 @@ static void DecVoicePoolCount (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice)
 }
 
 /*----------------------------------------------------------------------------
- * VMInitialize()
+ * VMInitVoiceMgr()
  *----------------------------------------------------------------------------
  * Purpose:
+ * Sets the voice manager to its initial state
  *
  * Inputs:
  * psEASData - pointer to overall EAS data structure
+ * pVoiceMgr - voice manager memory
  *
  * Outputs:
  *
  *----------------------------------------------------------------------------
 */
-EAS_RESULT VMInitialize (S_EAS_DATA *pEASData)
+static void VMInitVoiceMgr (S_EAS_DATA *pEASData, S_VOICE_MGR *pVoiceMgr)
 {
-    S_VOICE_MGR *pVoiceMgr;
     EAS_INT i;
+#ifdef _RUNTIME_POLYPHONY
+    /* the tables are kept, only their contents are cleared */
+    S_WT_VOICE *wtVoices = pVoiceMgr->wtVoices;
+    S_SYNTH_VOICE *voices = pVoiceMgr->voices;
+    S_STOLEN_VOICE *stolenVoices = pVoiceMgr->stolenVoices;
+    EAS_U32 (*channelVoiceMask)[VOICE_MASK_WORDS] = pVoiceMgr->channelVoiceMask;
+#ifdef _FM_FALLBACK
+    S_FM_VOICE *fmVoices = pVoiceMgr->fmVoices;
+#endif
+    EAS_U16 numVoices = pVoiceMgr->numVoices;
+    EAS_U8 numVirtualSynths = pVoiceMgr->numVirtualSynths;
+#endif
 
-    /* check Configuration Module for data allocation */
-    if (pEASData->staticMemoryModel)
-        pVoiceMgr = EAS_CMEnumData(EAS_CM_SYNTH_DATA);
-    else
-        pVoiceMgr = EAS_HWMalloc(pEASData->hwInstData, sizeof(S_VOICE_MGR));
-    if (!pVoiceMgr)
-    {
-        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "VMInitialize: Failed to allocate synthesizer memory\n"); */ }
-        return EAS_ERROR_MALLOC_FAILED;
-    }
     EAS_HWMemSet(pVoiceMgr, 0, sizeof(S_VOICE_MGR));
 
+#ifdef _RUNTIME_POLYPHONY
+    EAS_HWMemSet(wtVoices, 0, numVoices * (EAS_I32) sizeof(S_WT_VOICE));
+    EAS_HWMemSet(voices, 0, numVoices * (EAS_I32) sizeof(S_SYNTH_VOICE));
+    EAS_HWMemSet(stolenVoices, 0, numVoices * (EAS_I32) sizeof(S_STOLEN_VOICE));
+    EAS_HWMemSet(channelVoiceMask, 0, numVirtualSynths * NUM_SYNTH_CHANNELS * (EAS_I32) sizeof(channelVoiceMask[0]));
+    pVoiceMgr->wtVoices = wtVoices;
+    pVoiceMgr->voices = voices;
+    pVoiceMgr->stolenVoices = stolenVoices;
+    pVoiceMgr->channelVoiceMask = channelVoiceMask;
+#ifdef _FM_FALLBACK
+    EAS_HWMemSet(fmVoices, 0, numVoices * (EAS_I32) sizeof(S_FM_VOICE));
+    pVoiceMgr->fmVoices = fmVoices;
+#endif
+    pVoiceMgr->numVoices = numVoices;
+    pVoiceMgr->numVirtualSynths = numVirtualSynths;
+#endif
+
     /* initialize non-zero variables */
     pVoiceMgr->pGlobalEAS = (S_EAS*) &easSoundLib;
-    pVoiceMgr->maxPolyphony = (EAS_U16) MAX_SYNTH_VOICES;
+    pVoiceMgr->maxPolyphony = (EAS_U16) VM_NUM_VOICES(pVoiceMgr);
 
 #if defined(_SECONDARY_SYNTH) || defined(EAS_SPLIT_WT_SYNTH)
     pVoiceMgr->maxPolyphonyPrimary = NUM_PRIMARY_VOICES;
     pVoiceMgr->maxPolyphonySecondary = NUM_SECONDARY_VOICES;
 #endif
 
+#ifdef _RUNTIME_SAMPLE_RATE
+    pVoiceMgr->rateShift = pEASData->rateShift;
+#endif
+
     /* set max workload to zero */
     pVoiceMgr->maxWorkLoad = 0;
 
     /* initialize the voice manager parameters */
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
-        InitVoice(&pVoiceMgr->voices[i]);
+    for (i = 0; i < VM_NUM_VOICES(pVoiceMgr); i++)
+        InitVoice(pVoiceMgr, i);
 
     /* initialize the synth */
     /*lint -e{522} return unused at this time */
@@ -306,24 +514,172 @@ EAS_RESULT VMInitialize (S_EAS_DATA *pEASData)
     /*lint -e{522} return unused at this time */
     pSecondarySynth->pfInitialize(pVoiceMgr);
 #endif
+}
+
+/*----------------------------------------------------------------------------
+ * VMInitialize()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ *
+ * Inputs:
+ * psEASData - pointer to overall EAS data structure
+ * numVoices - voices in the voice pool, 0 for MAX_SYNTH_VOICES
+ * numSynths - virtual synthesizers, 0 for MAX_VIRTUAL_SYNTHESIZERS
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMInitialize (S_EAS_DATA *pEASData, EAS_I32 numVoices, EAS_I32 numSynths)
+{
+    S_VOICE_MGR *pVoiceMgr;
+#ifdef _RUNTIME_POLYPHONY
+    S_VM_TABLES *pStaticTables = NULL;
+    EAS_I32 wtVoicesSize;
+    EAS_I32 voicesSize;
+    EAS_I32 stolenVoicesSize;
+    EAS_I32 masksSize;
+    EAS_I32 fmVoicesSize;
+    EAS_U8 *pTables;
+#endif
+
+    /* zero selects the compiled limits */
+    if (numVoices == 0)
+        numVoices = MAX_SYNTH_VOICES;
+    if (numSynths == 0)
+        numSynths = MAX_VIRTUAL_SYNTHESIZERS;
+#ifndef _RUNTIME_POLYPHONY
+    if ((numVoices != MAX_SYNTH_VOICES) || (numSynths != MAX_VIRTUAL_SYNTHESIZERS))
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#else
+    if ((numVoices < 1) || (numVoices > MAX_SYNTH_VOICES) || (numSynths < 1) || (numSynths > MAX_VIRTUAL_SYNTHESIZERS))
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    /* tables follow the voice manager, each one 8 byte aligned */
+    wtVoicesSize = (numVoices * (EAS_I32) sizeof(S_WT_VOICE) + 7) & ~7;
+    voicesSize = (numVoices * (EAS_I32) sizeof(S_SYNTH_VOICE) + 7) & ~7;
+    stolenVoicesSize = (numVoices * (EAS_I32) sizeof(S_STOLEN_VOICE) + 7) & ~7;
+    masksSize = numSynths * NUM_SYNTH_CHANNELS * VOICE_MASK_WORDS * (EAS_I32) sizeof(EAS_U32);
+#ifdef _FM_FALLBACK
+    /* after the masks, which keep it 4 byte aligned */
+    fmVoicesSize = numVoices * (EAS_I32) sizeof(S_FM_VOICE);
+#else
+    fmVoicesSize = 0;
+#endif
+#endif
+
+    /* check Configuration Module for data allocation */
+    if (pEASData->staticMemoryModel)
+    {
+        pVoiceMgr = EAS_CMEnumData(EAS_CM_SYNTH_DATA);
+#ifdef _RUNTIME_POLYPHONY
+        if ((pStaticTables = EAS_CMEnumData(EAS_CM_SYNTH_TABLES)) == NULL)
+            pVoiceMgr = NULL;
+#endif
+    }
+    else
+#ifdef _RUNTIME_POLYPHONY
+        pVoiceMgr = EAS_HWMalloc(pEASData->hwInstData, (EAS_I32) sizeof(S_VOICE_MGR) + wtVoicesSize + voicesSize + stolenVoicesSize + masksSize + fmVoicesSize);
+#else
+        pVoiceMgr = EAS_HWMalloc(pEASData->hwInstData, sizeof(S_VOICE_MGR));
+#endif
+    if (!pVoiceMgr)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "VMInitialize: Failed to allocate synthesizer memory\n"); */ }
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+
+#ifdef _RUNTIME_POLYPHONY
+    if (pStaticTables != NULL)
+    {
+        pVoiceMgr->wtVoices = pStaticTables->wtVoices;
+        pVoiceMgr->voices = pStaticTables->voices;
+        pVoiceMgr->stolenVoices = pStaticTables->stolenVoices;
+        pVoiceMgr->channelVoiceMask = pStaticTables->channelVoiceMask;
+#ifdef _FM_FALLBACK
+        pVoiceMgr->fmVoices = pStaticTables->fmVoices;
+#endif
+    }
+    else
+    {
+        pTables = (EAS_U8*) (pVoiceMgr + 1);
+        pVoiceMgr->wtVoices = (S_WT_VOICE*) pTables;
+        pVoiceMgr->voices = (S_SYNTH_VOICE*) (pTables + wtVoicesSize);
+        pVoiceMgr->stolenVoices = (S_STOLEN_VOICE*) (pTables + wtVoicesSize + voicesSize);
+        pVoiceMgr->channelVoiceMask = (EAS_U32 (*)[VOICE_MASK_WORDS]) (pTables + wtVoicesSize + voicesSize + stolenVoicesSize);
+#ifdef _FM_FALLBACK
+        pVoiceMgr->fmVoices = (S_FM_VOICE*) (pTables + wtVoicesSize + voicesSize + stolenVoicesSize + masksSize);
+#endif
+    }
+    pVoiceMgr->numVoices = (EAS_U16) numVoices;
+    pVoiceMgr->numVirtualSynths = (EAS_U8) numSynths;
+#endif
+    VMInitVoiceMgr(pEASData, pVoiceMgr);
 
     pEASData->pVoiceMgr = pVoiceMgr;
     return EAS_SUCCESS;
 }
 
+#ifdef _INSTANCE_POOL
 /*----------------------------------------------------------------------------
- * VMInitMIDI()
+ * VMResetVoiceMgr()
  *----------------------------------------------------------------------------
  * Purpose:
+ * Returns the voice manager to the state after VMInitialize, for an
+ * instance that is used again. Every stream must be closed.
  *
  * Inputs:
  * psEASData - pointer to overall EAS data structure
  *
  * Outputs:
+ * EAS_ERROR_NOT_VALID_IN_THIS_STATE if a virtual synthesizer is in use
  *
  *----------------------------------------------------------------------------
 */
-EAS_RESULT VMInitMIDI (S_EAS_DATA *pEASData, S_SYNTH **ppSynth)
+EAS_RESULT VMResetVoiceMgr (S_EAS_DATA *pEASData)
+{
+    S_VOICE_MGR *pVoiceMgr = pEASData->pVoiceMgr;
+    EAS_INT i;
+
+    for (i = 0; i < MAX_VIRTUAL_SYNTHESIZERS; i++)
+        if (pVoiceMgr->pSynth[i] != NULL)
+            return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+#ifdef _PARALLEL_VOICE_RENDER
+    /* stop the worker threads */
+    (void) VMSetRenderThreads(pEASData, 1);
+#endif
+
+#ifdef _STEM_OUTPUT
+    /* free the stem buffers */
+    (void) VMSetStemCount(pEASData, 0);
+#endif
+
+#ifdef DLS_SYNTHESIZER
+    /* release the global DLS collection */
+    if (pVoiceMgr->pGlobalDLS)
+        DLSCleanup(pEASData->hwInstData, pVoiceMgr->pGlobalDLS);
+#endif
+
+    VMInitVoiceMgr(pEASData, pVoiceMgr);
+    return EAS_SUCCESS;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * VMCreateSynth()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Allocates a virtual synthesizer and adds it to the synth table
+ *
+ * Inputs:
+ * psEASData - pointer to overall EAS data structure
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT VMCreateSynth (S_EAS_DATA *pEASData, S_SYNTH **ppSynth)
 {
     EAS_RESULT result;
     S_SYNTH *pSynth;
@@ -348,10 +704,10 @@ EAS_RESULT VMInitMIDI (S_EAS_DATA *pEASData, S_SYNTH **ppSynth)
     /* dynamic memory model */
     else
     {
-        for (virtualSynthNum = 0; virtualSynthNum < MAX_VIRTUAL_SYNTHESIZERS; virtualSynthNum++)
+        for (virtualSynthNum = 0; virtualSynthNum < VM_NUM_SYNTHS(pEASData->pVoiceMgr); virtualSynthNum++)
             if (pEASData->pVoiceMgr->pSynth[virtualSynthNum] == NULL)
                 break;
-        if (virtualSynthNum == MAX_VIRTUAL_SYNTHESIZERS)
+        if (virtualSynthNum == VM_NUM_SYNTHS(pEASData->pVoiceMgr))
         {
             { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "VMInitMIDI: Exceeded number of active virtual synthesizers"); */ }
             return EAS_ERROR_NO_VIRTUAL_SYNTHESIZER;
@@ -399,6 +755,40 @@ EAS_RESULT VMInitMIDI (S_EAS_DATA *pEASData, S_SYNTH **ppSynth)
     return EAS_SUCCESS;
 }
 
+/*----------------------------------------------------------------------------
+ * VMInitMIDI()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ *
+ * Inputs:
+ * psEASData - pointer to overall EAS data structure
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMInitMIDI (S_EAS_DATA *pEASData, S_SYNTH **ppSynth)
+{
+    /* an instance without a voice manager only parses metadata */
+    if (pEASData->pVoiceMgr == NULL)
+    {
+        *ppSynth = NULL;
+        return EAS_SUCCESS;
+    }
+
+#ifdef _ASYNC_OPEN
+    EAS_RESULT result;
+
+    /* background opens create synths while the caller renders */
+    EAS_HWLock(pEASData->hwInstData);
+    result = VMCreateSynth(pEASData, ppSynth);
+    EAS_HWUnlock(pEASData->hwInstData);
+    return result;
+#else
+    return VMCreateSynth(pEASData, ppSynth);
+#endif
+}
+
 /*----------------------------------------------------------------------------
  * VMReset()
  *----------------------------------------------------------------------------
@@ -429,6 +819,10 @@ EAS_RESULT VMInitMIDI (S_EAS_DATA *pEASData, S_SYNTH **ppSynth)
 void VMReset (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_BOOL force)
 {
 
+    /* metadata probes have no synth */
+    if (pSynth == NULL)
+        return;
+
 #ifdef _DEBUG_VM
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMReset: request to reset synth. Force = %d\n", force); */ }
 #endif
@@ -486,28 +880,34 @@ void VMReset (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_BOOL force)
 void VMInitializeAllChannels (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
 {
     S_SYNTH_CHANNEL *pChannel;
+    S_SYNTH_CHANNEL_STATE *pState;
     EAS_INT i;
 
     VMResetControllers(pSynth);
 
     /* init each channel */
     pChannel = pSynth->channels;
+    pState = pSynth->channelState;
 
-    for (i = 0; i < NUM_SYNTH_CHANNELS; i++, pChannel++)
+    for (i = 0; i < NUM_SYNTH_CHANNELS; i++, pChannel++, pState++)
     {
         pChannel->channelFlags = DEFAULT_CHANNEL_FLAGS;
         pChannel->staticGain = DEFAULT_CHANNEL_STATIC_GAIN;
         pChannel->staticPitch = DEFAULT_CHANNEL_STATIC_PITCH;
         pChannel->pool = 0;
+#ifdef _INCREMENTAL_MIP
+        /* no pool can match, so the next SP-MIDI update counts the voices */
+        pSynth->mipPools[i] = 0xff;
+#endif
 
         /* the drum channel needs a different init */
         if (i == DEFAULT_DRUM_CHANNEL)
         {
-            pChannel->bankNum = DEFAULT_RHYTHM_BANK_NUMBER;
+            pState->bankNum = DEFAULT_RHYTHM_BANK_NUMBER;
             pChannel->channelFlags |= CHANNEL_FLAG_RHYTHM_CHANNEL;
         }
         else
-            pChannel->bankNum = DEFAULT_MELODY_BANK_NUMBER;
+            pState->bankNum = DEFAULT_MELODY_BANK_NUMBER;
 
         VMProgramChange(pVoiceMgr, pSynth, (EAS_U8) i, DEFAULT_SYNTH_PROGRAM_NUMBER);
     }
@@ -529,34 +929,37 @@ void VMInitializeAllChannels (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
 void VMResetControllers (S_SYNTH *pSynth)
 {
     S_SYNTH_CHANNEL *pChannel;
+    S_SYNTH_CHANNEL_STATE *pState;
     EAS_INT i;
 
     pChannel = pSynth->channels;
+    pState = pSynth->channelState;
 
-    for (i = 0; i < NUM_SYNTH_CHANNELS; i++, pChannel++)
+    for (i = 0; i < NUM_SYNTH_CHANNELS; i++, pChannel++, pState++)
     {
-        pChannel->pitchBend = DEFAULT_PITCH_BEND;
+        pState->pitchBend = DEFAULT_PITCH_BEND;
         pChannel->modWheel = DEFAULT_MOD_WHEEL;
-        pChannel->volume = DEFAULT_CHANNEL_VOLUME;
+        pState->volume = DEFAULT_CHANNEL_VOLUME;
         pChannel->pan = DEFAULT_PAN;
-        pChannel->expression = DEFAULT_EXPRESSION;
+        pState->expression = DEFAULT_EXPRESSION;
 
 #ifdef  _REVERB
         pSynth->channels[i].reverbSend = DEFAULT_REVERB_SEND;
 #endif
 
-#ifdef  _CHORUS
+#if defined(_CHORUS) || defined(_CHORUS_ENABLED)
         pSynth->channels[i].chorusSend = DEFAULT_CHORUS_SEND;
 #endif
 
         pChannel->channelPressure = DEFAULT_CHANNEL_PRESSURE;
-        pChannel->registeredParam = DEFAULT_REGISTERED_PARAM;
-        pChannel->pitchBendSensitivity = DEFAULT_PITCH_BEND_SENSITIVITY;
-        pChannel->finePitch = DEFAULT_FINE_PITCH;
-        pChannel->coarsePitch = DEFAULT_COARSE_PITCH;
+        pState->registeredParam = DEFAULT_REGISTERED_PARAM;
+        pState->pitchBendSensitivity = DEFAULT_PITCH_BEND_SENSITIVITY;
+        pState->finePitch = DEFAULT_FINE_PITCH;
+        pState->coarsePitch = DEFAULT_COARSE_PITCH;
 
         /* update all voices on this channel */
         pChannel->channelFlags |= CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS;
+        pSynth->dirtyChannels |= (EAS_U16) (1 << i);
     }
 }
 
@@ -577,61 +980,347 @@ void VMInitializeAllVoices (S_VOICE_MGR *pVoiceMgr, EAS_INT vSynthNum)
     EAS_INT i;
 
     /* initialize the voice manager parameters */
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); i < MAX_SYNTH_VOICES; i = VMNextVoice(pVoiceMgr->activeVoiceMask, i + 1))
     {
         if (pVoiceMgr->voices[i].voiceState != eVoiceStateStolen)
         {
             if (GET_VSYNTH(pVoiceMgr->voices[i].channel) == vSynthNum)
-                InitVoice(&pVoiceMgr->voices[i]);
+            {
+                VMDeactivateVoice(pVoiceMgr, i);
+                InitVoice(pVoiceMgr, i);
+            }
         }
         else
         {
-            if (GET_VSYNTH(pVoiceMgr->voices[i].nextChannel) == vSynthNum)
-                InitVoice(&pVoiceMgr->voices[i]);
+            if (GET_VSYNTH(pVoiceMgr->stolenVoices[i].channel) == vSynthNum)
+            {
+                VMDeactivateVoice(pVoiceMgr, i);
+                InitVoice(pVoiceMgr, i);
+            }
         }
     }
 }
 
+#ifdef _ENGINE_SNAPSHOT
 /*----------------------------------------------------------------------------
- * VMMuteVoice()
- *----------------------------------------------------------------------------
- * Mute the selected voice
+ * Synth snapshots
+ *
+ * A snapshot holds the channel state of a synth and the complete state of
+ * the voices it owns, a stolen voice being owned by the synth of its next
+ * note as in VMInitializeAllVoices. The engine state of the free voices is
+ * kept as well, a note starts from the phase fraction the last note on its
+ * voice left. The voices hold sample addresses, so a snapshot is only valid
+ * in the library instance it was taken in and with the same sound library
+ * and DLS collection.
  *----------------------------------------------------------------------------
 */
-void VMMuteVoice (S_VOICE_MGR *pVoiceMgr, EAS_I32 voiceNum)
+typedef struct
 {
-    S_SYNTH *pSynth;
-    S_SYNTH_VOICE *pVoice;
-
-    /* take no action if voice is already muted */
-    pVoice = &pVoiceMgr->voices[voiceNum];
-    if ((pVoice->voiceState == eVoiceStateMuting) || (pVoice->voiceState == eVoiceStateFree))
-        return;
-
-    /* one less voice in pool */
-    DecVoicePoolCount(pVoiceMgr, pVoice);
-
-    pSynth = pVoiceMgr->pSynth[GET_VSYNTH(pVoice->channel)];
-    GetSynthPtr(voiceNum)->pfMuteVoice(pVoiceMgr, pSynth, pVoice, GetAdjustedVoiceNum(voiceNum));
-    pVoice->voiceState = eVoiceStateMuting;
-
-}
+    const S_EAS             *pEAS;
+#ifdef DLS_SYNTHESIZER
+    const S_DLS             *pDLS;
+#endif
+    S_SYNTH_CHANNEL         channels[NUM_SYNTH_CHANNELS];
+    S_SYNTH_CHANNEL_STATE   channelState[NUM_SYNTH_CHANNELS];
+    EAS_I32                 totalNoteCount;
+    EAS_U8                  channelsByPriority[NUM_SYNTH_CHANNELS];
+    EAS_U8                  poolAlloc[NUM_SYNTH_CHANNELS];
+#ifdef _INCREMENTAL_MIP
+    EAS_U8                  mipPools[NUM_SYNTH_CHANNELS];
+#endif
+    EAS_U16                 dirtyChannels;
+    EAS_U16                 age;                /* voice manager note age when saved */
+    EAS_U16                 numVoices;          /* S_VM_VOICE_STATE that follow */
+    EAS_U8                  synthFlags;
+    EAS_U8                  vSynthNum;
+} S_VM_STATE;
+
+typedef struct
+{
+    S_SYNTH_VOICE           voice;
+    S_STOLEN_VOICE          stolen;
+    union
+    {
+#ifdef _WT_SYNTH
+        S_WT_VOICE          wt;
+#endif
+#ifdef _FM_SYNTH
+        S_FM_VOICE          fm;
+#endif
+    } engine;
+#ifdef _FM_FALLBACK
+    S_FM_VOICE              fm;                 /* the voice may play on either engine */
+#endif
+    EAS_U16                 voiceNum;
+    EAS_BOOL8               inStolenMask;
+} S_VM_VOICE_STATE;
 
 /*----------------------------------------------------------------------------
- * VMReleaseVoice()
+ * VMCopyEngineVoice()
  *----------------------------------------------------------------------------
- * Release the selected voice
+ * Copies the synthesizer's own voice data between the voice manager and a
+ * snapshot, in the direction given by save
  *----------------------------------------------------------------------------
 */
-void VMReleaseVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 voiceNum)
+static void VMCopyEngineVoice (S_VOICE_MGR *pVoiceMgr, S_VM_VOICE_STATE *pVoiceState, EAS_INT voiceNum, EAS_BOOL save)
 {
-    S_SYNTH_VOICE *pVoice = &pVoiceMgr->voices[voiceNum];
-
-    /* take no action if voice is already free, muting, or releasing */
-    if (( pVoice->voiceState == eVoiceStateMuting) ||
-        (pVoice->voiceState == eVoiceStateFree) ||
-        (pVoice->voiceState == eVoiceStateRelease))
-            return;
+    void *pVoice;
+    EAS_I32 size;
+
+#if defined(_HYBRID_SYNTH)
+    if (voiceNum >= NUM_PRIMARY_VOICES)
+    {
+        pVoice = &pVoiceMgr->fmVoices[GetAdjustedVoiceNum(voiceNum)];
+        size = sizeof(S_FM_VOICE);
+    }
+    else
+    {
+        pVoice = &pVoiceMgr->wtVoices[voiceNum];
+        size = sizeof(S_WT_VOICE);
+    }
+#elif defined(_WT_SYNTH)
+    pVoice = &pVoiceMgr->wtVoices[voiceNum];
+    size = sizeof(S_WT_VOICE);
+#else
+    pVoice = &pVoiceMgr->fmVoices[voiceNum];
+    size = sizeof(S_FM_VOICE);
+#endif
+
+    if (save)
+        EAS_HWMemCpy(&pVoiceState->engine, pVoice, size);
+    else
+        EAS_HWMemCpy(pVoice, &pVoiceState->engine, size);
+
+#ifdef _FM_FALLBACK
+    if (save)
+        EAS_HWMemCpy(&pVoiceState->fm, &pVoiceMgr->fmVoices[voiceNum], sizeof(S_FM_VOICE));
+    else
+        EAS_HWMemCpy(&pVoiceMgr->fmVoices[voiceNum], &pVoiceState->fm, sizeof(S_FM_VOICE));
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * VMStateSize()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the largest snapshot VMSaveState writes, with every voice
+ * owned by the synth
+ *
+ * Inputs:
+ * pVoiceMgr        - pointer to voice manager
+ *
+ * Outputs:
+ * size in bytes
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 VMStateSize (S_VOICE_MGR *pVoiceMgr)
+{
+    return (EAS_I32) (sizeof(S_VM_STATE) + VM_NUM_VOICES(pVoiceMgr) * sizeof(S_VM_VOICE_STATE));
+}
+
+/*----------------------------------------------------------------------------
+ * VMSaveState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Writes a snapshot of the synth and the voices it owns
+ *
+ * Inputs:
+ * pVoiceMgr        - pointer to voice manager
+ * pSynth           - pointer to synth
+ * pState           - receives the snapshot, VMStateSize bytes
+ *
+ * Outputs:
+ * size of the snapshot in bytes
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 VMSaveState (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, void *pState)
+{
+    S_VM_STATE *pSynthState;
+    S_VM_VOICE_STATE *pVoiceState;
+    EAS_INT i;
+    EAS_U8 channel;
+
+    pSynthState = (S_VM_STATE*) pState;
+    pSynthState->pEAS = pSynth->pEAS;
+#ifdef DLS_SYNTHESIZER
+    pSynthState->pDLS = pSynth->pDLS;
+#endif
+    EAS_HWMemCpy(pSynthState->channels, pSynth->channels, sizeof(pSynthState->channels));
+    EAS_HWMemCpy(pSynthState->channelState, pSynth->channelState, sizeof(pSynthState->channelState));
+    EAS_HWMemCpy(pSynthState->channelsByPriority, pSynth->channelsByPriority, sizeof(pSynthState->channelsByPriority));
+    EAS_HWMemCpy(pSynthState->poolAlloc, pSynth->poolAlloc, sizeof(pSynthState->poolAlloc));
+#ifdef _INCREMENTAL_MIP
+    EAS_HWMemCpy(pSynthState->mipPools, pSynth->mipPools, sizeof(pSynthState->mipPools));
+#endif
+    pSynthState->totalNoteCount = pSynth->totalNoteCount;
+    pSynthState->dirtyChannels = pSynth->dirtyChannels;
+    pSynthState->synthFlags = pSynth->synthFlags;
+    pSynthState->vSynthNum = pSynth->vSynthNum;
+    pSynthState->age = pVoiceMgr->age;
+    pSynthState->numVoices = 0;
+
+    pVoiceState = (S_VM_VOICE_STATE*) (pSynthState + 1);
+    for (i = 0; i < VM_NUM_VOICES(pVoiceMgr); i++)
+    {
+        if (pVoiceMgr->voices[i].voiceState != eVoiceStateFree)
+        {
+            if (pVoiceMgr->voices[i].voiceState == eVoiceStateStolen)
+                channel = pVoiceMgr->stolenVoices[i].channel;
+            else
+                channel = pVoiceMgr->voices[i].channel;
+            if (GET_VSYNTH(channel) != pSynth->vSynthNum)
+                continue;
+        }
+
+#ifdef EAS_SPLIT_WT_SYNTH
+        /* the engine keeps the state of off-chip voices */
+        if (i >= NUM_PRIMARY_VOICES)
+            continue;
+#endif
+
+        pVoiceState->voice = pVoiceMgr->voices[i];
+        pVoiceState->stolen = pVoiceMgr->stolenVoices[i];
+        VMCopyEngineVoice(pVoiceMgr, pVoiceState, i, EAS_TRUE);
+        pVoiceState->voiceNum = (EAS_U16) i;
+        pVoiceState->inStolenMask = (pVoiceMgr->stolenVoiceMask[i >> 5] & (1UL << (i & 31))) ? EAS_TRUE : EAS_FALSE;
+        pVoiceState++;
+        pSynthState->numVoices++;
+    }
+
+    return (EAS_I32) (sizeof(S_VM_STATE) + pSynthState->numVoices * sizeof(S_VM_VOICE_STATE));
+}
+
+/*----------------------------------------------------------------------------
+ * VMRestoreState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the synth and its voices to a snapshot from VMSaveState. The
+ * voices the synth owns now are stopped without a ramp and each voice of
+ * the snapshot is restored to the same voice number. A voice taken by
+ * another synth since the snapshot stays with that synth and the note of
+ * the snapshot is lost, as is the engine state of a free voice. The user settings of the synth (polyphony,
+ * priority, volume, transposition) are not part of a snapshot.
+ *
+ * Inputs:
+ * pVoiceMgr        - pointer to voice manager
+ * pSynth           - pointer to synth
+ * pState           - snapshot
+ * size             - size of the snapshot in bytes
+ *
+ * Outputs:
+ * EAS_ERROR_INVALID_PARAMETER if the snapshot was taken from another synth
+ * or with another sound library, nothing is changed then
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMRestoreState (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, const void *pState, EAS_I32 size)
+{
+    const S_VM_STATE *pSynthState;
+    const S_VM_VOICE_STATE *pVoiceState;
+    S_SYNTH_VOICE *pVoice;
+    EAS_INT voiceNum;
+    EAS_INT i;
+
+    pSynthState = (const S_VM_STATE*) pState;
+    if ((size < (EAS_I32) sizeof(S_VM_STATE)) ||
+        (size < (EAS_I32) (sizeof(S_VM_STATE) + pSynthState->numVoices * sizeof(S_VM_VOICE_STATE))))
+        return EAS_ERROR_INVALID_PARAMETER;
+    if ((pSynthState->vSynthNum != pSynth->vSynthNum) || (pSynthState->pEAS != pSynth->pEAS))
+        return EAS_ERROR_INVALID_PARAMETER;
+#ifdef DLS_SYNTHESIZER
+    if (pSynthState->pDLS != pSynth->pDLS)
+        return EAS_ERROR_INVALID_PARAMETER;
+#endif
+
+    /* stop the voices of the synth, as a forced VMReset does */
+    pVoiceMgr->activeVoices -= pSynth->numActiveVoices;
+    pSynth->numActiveVoices = 0;
+    VMInitializeAllVoices(pVoiceMgr, pSynth->vSynthNum);
+    for (i = 0; i < NUM_SYNTH_CHANNELS; i++)
+        pSynth->poolCount[i] = 0;
+
+    EAS_HWMemCpy(pSynth->channels, pSynthState->channels, sizeof(pSynthState->channels));
+    EAS_HWMemCpy(pSynth->channelState, pSynthState->channelState, sizeof(pSynthState->channelState));
+    EAS_HWMemCpy(pSynth->channelsByPriority, pSynthState->channelsByPriority, sizeof(pSynthState->channelsByPriority));
+    EAS_HWMemCpy(pSynth->poolAlloc, pSynthState->poolAlloc, sizeof(pSynthState->poolAlloc));
+#ifdef _INCREMENTAL_MIP
+    EAS_HWMemCpy(pSynth->mipPools, pSynthState->mipPools, sizeof(pSynthState->mipPools));
+#endif
+    pSynth->totalNoteCount = pSynthState->totalNoteCount;
+    pSynth->dirtyChannels = pSynthState->dirtyChannels;
+    pSynth->synthFlags = pSynthState->synthFlags;
+
+    pVoiceState = (const S_VM_VOICE_STATE*) (pSynthState + 1);
+    for (i = 0; i < pSynthState->numVoices; i++, pVoiceState++)
+    {
+        voiceNum = pVoiceState->voiceNum;
+        if ((voiceNum >= VM_NUM_VOICES(pVoiceMgr)) || (pVoiceMgr->voices[voiceNum].voiceState != eVoiceStateFree))
+            continue;
+
+        pVoice = &pVoiceMgr->voices[voiceNum];
+        *pVoice = pVoiceState->voice;
+        pVoiceMgr->stolenVoices[voiceNum] = pVoiceState->stolen;
+        VMCopyEngineVoice(pVoiceMgr, (S_VM_VOICE_STATE*) pVoiceState, voiceNum, EAS_FALSE);
+        if (pVoice->voiceState == eVoiceStateFree)
+            continue;
+
+        /* keep the age relative to the notes started since the snapshot */
+        pVoice->age = (EAS_U16) (pVoiceMgr->age - (EAS_U16) (pSynthState->age - pVoice->age));
+        if (pVoiceState->inStolenMask)
+            pVoiceMgr->stolenVoiceMask[voiceNum >> 5] |= 1UL << (voiceNum & 31);
+
+        pVoiceMgr->activeVoices++;
+        pSynth->numActiveVoices++;
+        VMActivateVoice(pVoiceMgr, voiceNum);
+        IncVoicePoolCount(pVoiceMgr, pVoice);
+    }
+
+    return EAS_SUCCESS;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * VMMuteVoice()
+ *----------------------------------------------------------------------------
+ * Mute the selected voice
+ *----------------------------------------------------------------------------
+*/
+void VMMuteVoice (S_VOICE_MGR *pVoiceMgr, EAS_I32 voiceNum)
+{
+    S_SYNTH *pSynth;
+    S_SYNTH_VOICE *pVoice;
+
+    /* take no action if voice is already muted */
+    pVoice = &pVoiceMgr->voices[voiceNum];
+    if ((pVoice->voiceState == eVoiceStateMuting) || (pVoice->voiceState == eVoiceStateFree))
+        return;
+
+    /* one less voice in pool */
+    DecVoicePoolCount(pVoiceMgr, pVoice);
+
+    pSynth = pVoiceMgr->pSynth[GET_VSYNTH(pVoice->channel)];
+    GetSynthPtr(voiceNum)->pfMuteVoice(pVoiceMgr, pSynth, pVoice, GetAdjustedVoiceNum(voiceNum));
+    pVoice->voiceState = eVoiceStateMuting;
+
+}
+
+/*----------------------------------------------------------------------------
+ * VMReleaseVoice()
+ *----------------------------------------------------------------------------
+ * Release the selected voice
+ *----------------------------------------------------------------------------
+*/
+void VMReleaseVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 voiceNum)
+{
+    S_SYNTH_VOICE *pVoice = &pVoiceMgr->voices[voiceNum];
+
+    /* take no action if voice is already free, muting, or releasing */
+    if (( pVoice->voiceState == eVoiceStateMuting) ||
+        (pVoice->voiceState == eVoiceStateFree) ||
+        (pVoice->voiceState == eVoiceStateRelease))
+            return;
 
     /* stolen voices should just be muted */
     if (pVoice->voiceState == eVoiceStateStolen)
@@ -661,7 +1350,7 @@ void VMInitMIPTable (S_SYNTH *pSynth)
     for (i = 0; i < NUM_SYNTH_CHANNELS; i++)
     {
         pSynth->channels[i].pool = 0;
-        pSynth->channels[i].mip = 0;
+        pSynth->channelState[i].mip = 0;
     }
 }
 
@@ -683,7 +1372,7 @@ void VMSetMIPEntry (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS
     if (priority < NUM_SYNTH_CHANNELS)
     {
         pSynth->channels[channel].pool = priority;
-        pSynth->channels[channel].mip = mip;
+        pSynth->channelState[channel].mip = mip;
     }
 }
 
@@ -693,6 +1382,11 @@ void VMSetMIPEntry (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS
  * This routine is called after an SP-MIDI message is received and
  * any time the allocated polyphony changes. It mutes or unmutes
  * channels based on polyphony.
+ *
+ * With _INCREMENTAL_MIP the voices are only visited when a channel is
+ * newly muted or moved to another pool. Otherwise the pool counts kept
+ * by IncVoicePoolCount and DecVoicePoolCount are already what the scan
+ * would count, and channels that stay muted have no voices to release.
  *----------------------------------------------------------------------------
 */
 void VMMIPUpdateChannelMuting (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
@@ -702,6 +1396,9 @@ void VMMIPUpdateChannelMuting (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
     EAS_INT channel;
     EAS_INT vSynthNum;
     EAS_INT pool;
+#ifdef _INCREMENTAL_MIP
+    EAS_BOOL scan;
+#endif
 
 #ifdef _DEBUG_VM
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMUpdateMIPTable\n"); */ }
@@ -713,12 +1410,45 @@ void VMMIPUpdateChannelMuting (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
     else
         maxPolyphony = pVoiceMgr->maxPolyphony;
 
+    /* the voice manager limit is lower when a CPU budget is in force */
+    if (maxPolyphony > pVoiceMgr->maxPolyphony)
+        maxPolyphony = pVoiceMgr->maxPolyphony;
+
+#ifdef _INCREMENTAL_MIP
+    /* process channels */
+    scan = EAS_FALSE;
+    for (i = 0; i < NUM_SYNTH_CHANNELS; i++)
+    {
+
+        /* channel must be in MIP message and must meet allocation target */
+        if ((pSynth->channelState[i].mip != 0) && (pSynth->channelState[i].mip <= maxPolyphony))
+            pSynth->channels[i].channelFlags &= ~CHANNEL_FLAG_MUTE;
+        else if (!(pSynth->channels[i].channelFlags & CHANNEL_FLAG_MUTE))
+        {
+            pSynth->channels[i].channelFlags |= CHANNEL_FLAG_MUTE;
+            scan = EAS_TRUE;
+        }
+
+        /* the pool counts hold while every channel stays in its pool */
+        if (pSynth->mipPools[i] != pSynth->channels[i].pool)
+        {
+            pSynth->mipPools[i] = pSynth->channels[i].pool;
+            scan = EAS_TRUE;
+        }
+    }
+    if (!scan)
+        return;
+
+    /* reset voice pool counts */
+    for (i = 0; i < NUM_SYNTH_CHANNELS; i++)
+        pSynth->poolCount[i] = 0;
+#else
     /* process channels */
     for (i = 0; i < NUM_SYNTH_CHANNELS; i++)
     {
 
         /* channel must be in MIP message and must meet allocation target */
-        if ((pSynth->channels[i].mip != 0) && (pSynth->channels[i].mip <= maxPolyphony))
+        if ((pSynth->channelState[i].mip != 0) && (pSynth->channelState[i].mip <= maxPolyphony))
             pSynth->channels[i].channelFlags &= ~CHANNEL_FLAG_MUTE;
         else
             pSynth->channels[i].channelFlags |= CHANNEL_FLAG_MUTE;
@@ -726,9 +1456,10 @@ void VMMIPUpdateChannelMuting (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
         /* reset voice pool count */
         pSynth->poolCount[i] = 0;
     }
+#endif
 
     /* mute any voices on muted channels, and count unmuted voices */
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); i < MAX_SYNTH_VOICES; i = VMNextVoice(pVoiceMgr->activeVoiceMask, i + 1))
     {
 
         /* ignore free voices */
@@ -743,8 +1474,8 @@ void VMMIPUpdateChannelMuting (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
         }
         else
         {
-            vSynthNum = GET_VSYNTH(pVoiceMgr->voices[i].nextChannel);
-            channel = GET_CHANNEL(pVoiceMgr->voices[i].nextChannel);
+            vSynthNum = GET_VSYNTH(pVoiceMgr->stolenVoices[i].channel);
+            channel = GET_CHANNEL(pVoiceMgr->stolenVoices[i].channel);
         }
 
         /* ignore voices on other synths */
@@ -824,15 +1555,15 @@ void VMUpdateMIPTable (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
         /* when 2 or more channels have the same MIP setting, they
          * share a common voice pool
          */
-        if (pChannel->mip == currentMIP && currentPool != -1)
+        if (pSynth->channelState[priority[i]].mip == currentMIP && currentPool != -1)
             pChannel->pool = (EAS_U8) currentPool;
 
         /* new voice pool */
         else
         {
             currentPool++;
-            pSynth->poolAlloc[currentPool] = (EAS_U8) (pChannel->mip - currentMIP);
-            currentMIP = pChannel->mip;
+            pSynth->poolAlloc[currentPool] = (EAS_U8) (pSynth->channelState[priority[i]].mip - currentMIP);
+            currentMIP = pSynth->channelState[priority[i]].mip;
         }
     }
 
@@ -868,12 +1599,12 @@ void VMMuteAllVoices (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMMuteAllVoices: about to mute all voices!!\n"); */ }
 #endif
 
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); i < MAX_SYNTH_VOICES; i = VMNextVoice(pVoiceMgr->activeVoiceMask, i + 1))
     {
         /* for stolen voices, check new channel */
         if (pVoiceMgr->voices[i].voiceState == eVoiceStateStolen)
         {
-            if (GET_VSYNTH(pVoiceMgr->voices[i].nextChannel) == pSynth->vSynthNum)
+            if (GET_VSYNTH(pVoiceMgr->stolenVoices[i].channel) == pSynth->vSynthNum)
                 VMMuteVoice(pVoiceMgr, i);
         }
 
@@ -905,6 +1636,10 @@ void VMReleaseAllVoices (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
 {
     EAS_INT i;
 
+    /* metadata probes have no synth */
+    if (pSynth == NULL)
+        return;
+
     /* release sustain pedal on all channels */
     for (i = 0; i < NUM_SYNTH_CHANNELS; i++)
     {
@@ -916,7 +1651,7 @@ void VMReleaseAllVoices (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
     }
 
     /* release all voices */
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); i < MAX_SYNTH_VOICES; i = VMNextVoice(pVoiceMgr->activeVoiceMask, i + 1))
     {
 
         switch (pVoiceMgr->voices[i].voiceState)
@@ -929,7 +1664,7 @@ void VMReleaseAllVoices (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
                 break;
 
             case eVoiceStateStolen:
-                if (GET_VSYNTH(pVoiceMgr->voices[i].nextChannel) == pSynth->vSynthNum)
+                if (GET_VSYNTH(pVoiceMgr->stolenVoices[i].channel) == pSynth->vSynthNum)
                     VMMuteVoice(pVoiceMgr, i);
                 break;
 
@@ -985,13 +1720,13 @@ void VMAllNotesOff (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel)
 
     /* check each voice */
     channel = VSynthToChannel(pSynth, channel);
-    for (voiceNum = 0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); voiceNum < MAX_SYNTH_VOICES; voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, voiceNum + 1))
     {
         pVoice = &pVoiceMgr->voices[voiceNum];
         if (pVoice->voiceState != eVoiceStateFree)
         {
             if (((pVoice->voiceState != eVoiceStateStolen) && (channel == pVoice->channel)) ||
-                ((pVoice->voiceState == eVoiceStateStolen) && (channel == pVoice->nextChannel)))
+                ((pVoice->voiceState == eVoiceStateStolen) && (channel == pVoiceMgr->stolenVoices[voiceNum].channel)))
             {
                 /* this voice is assigned to the requested channel */
                 GetSynthPtr(voiceNum)->pfMuteVoice(pVoiceMgr, pSynth, pVoice, GetAdjustedVoiceNum(voiceNum));
@@ -1028,7 +1763,7 @@ void VMDeferredStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
     deferredNoteOff = EAS_FALSE;
 
     /* check each voice to see if it requires a deferred note off */
-    for (voiceNum=0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); voiceNum < MAX_SYNTH_VOICES; voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, voiceNum + 1))
     {
         if (pVoiceMgr->voices[voiceNum].voiceFlags & VOICE_FLAG_DEFER_MIDI_NOTE_OFF)
         {
@@ -1056,7 +1791,7 @@ void VMDeferredStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
 #ifdef _DEBUG_VM
                 { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMDeferredStopNote: defer request to stop voice %d (channel=%d note=%d) - voice not started\n",
                     voiceNum,
-                    pVoiceMgr->voices[voiceNum].nextChannel,
+                    pVoiceMgr->stolenVoices[voiceNum].channel,
                     pVoiceMgr->voices[voiceNum].note); */ }
 
                 /* sanity check: this stolen voice better be ramped to zero */
@@ -1076,7 +1811,7 @@ void VMDeferredStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
 #ifdef _DEBUG_VM
                 { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMDeferredStopNote: Stop voice %d (channel=%d note=%d)\n",
                     voiceNum,
-                    pVoiceMgr->voices[voiceNum].nextChannel,
+                    pVoiceMgr->stolenVoices[voiceNum].channel,
                     pVoiceMgr->voices[voiceNum].note); */ }
 #endif
 
@@ -1145,7 +1880,7 @@ void VMReleaseAllDeferredNoteOffs (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_
 
     /* find all the voices assigned to this channel */
     channel = VSynthToChannel(pSynth, channel);
-    for (voiceNum = 0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = VMNextVoice(pVoiceMgr->channelVoiceMask[channel], 0); voiceNum < MAX_SYNTH_VOICES; voiceNum = VMNextVoice(pVoiceMgr->channelVoiceMask[channel], voiceNum + 1))
     {
 
         pVoice = &pVoiceMgr->voices[voiceNum];
@@ -1204,7 +1939,7 @@ void VMCatchNotesForSustainPedal (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U
     channel = VSynthToChannel(pSynth, channel);
 
     /* find all the voices assigned to this channel */
-    for (voiceNum = 0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = VMNextVoice(pVoiceMgr->channelVoiceMask[channel], 0); voiceNum < MAX_SYNTH_VOICES; voiceNum = VMNextVoice(pVoiceMgr->channelVoiceMask[channel], voiceNum + 1))
     {
         if (channel == pVoiceMgr->voices[voiceNum].channel)
         {
@@ -1233,7 +1968,7 @@ void VMUpdateAllNotesAge (S_VOICE_MGR *pVoiceMgr, EAS_U16 age)
 {
     EAS_INT i;
 
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); i < MAX_SYNTH_VOICES; i = VMNextVoice(pVoiceMgr->activeVoiceMask, i + 1))
     {
         if (age - pVoiceMgr->voices[i].age > 0)
             pVoiceMgr->voices[i].age++;
@@ -1260,6 +1995,7 @@ void VMUpdateAllNotesAge (S_VOICE_MGR *pVoiceMgr, EAS_U16 age)
 static void VMStolenVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 voiceNum, EAS_U8 channel, EAS_U8 note, EAS_U8 velocity, EAS_U16 regionIndex)
 {
     S_SYNTH_VOICE *pVoice = &pVoiceMgr->voices[voiceNum];
+    S_STOLEN_VOICE *pStolen = &pVoiceMgr->stolenVoices[voiceNum];
 
     /* one less voice in old pool */
     DecVoicePoolCount(pVoiceMgr, pVoice);
@@ -1267,12 +2003,13 @@ static void VMStolenVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 voic
     /* mute the sound that is currently playing */
     GetSynthPtr(voiceNum)->pfMuteVoice(pVoiceMgr, pVoiceMgr->pSynth[GET_VSYNTH(pVoice->channel)], &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(voiceNum));
     pVoice->voiceState = eVoiceStateStolen;
+    pVoiceMgr->stolenVoiceMask[voiceNum >> 5] |= 1UL << (voiceNum & 31);
 
     /* set new note data */
-    pVoice->nextChannel = VSynthToChannel(pSynth, channel);
-    pVoice->nextNote = note;
-    pVoice->nextVelocity = velocity;
-    pVoice->nextRegionIndex = regionIndex;
+    pStolen->channel = VSynthToChannel(pSynth, channel);
+    pStolen->note = note;
+    pStolen->velocity = velocity;
+    pStolen->regionIndex = regionIndex;
 
     /* one more voice in new pool */
     IncVoicePoolCount(pVoiceMgr, pVoice);
@@ -1326,7 +2063,8 @@ static void VMFreeVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     /* return to free voice pool */
     pVoiceMgr->activeVoices--;
     pSynth->numActiveVoices--;
-    InitVoice(pVoice);
+    VMDeactivateVoice(pVoiceMgr, (EAS_INT) (pVoice - pVoiceMgr->voices));
+    InitVoice(pVoiceMgr, (EAS_INT) (pVoice - pVoiceMgr->voices));
 
 #ifdef _DEBUG_VM
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMFreeVoice: free voice %d\n", pVoice - pVoiceMgr->voices); */ }
@@ -1355,21 +2093,23 @@ static EAS_BOOL VMRetargetStolenVoice (S_VOICE_MGR *pVoiceMgr, EAS_I32 voiceNum)
     EAS_U8 flags;
     S_SYNTH_CHANNEL *pMIDIChannel;
     S_SYNTH_VOICE *pVoice;
+    S_STOLEN_VOICE *pStolen;
     S_SYNTH *pSynth;
     S_SYNTH *pNextSynth;
 
     /* establish some pointers */
     pVoice = &pVoiceMgr->voices[voiceNum];
+    pStolen = &pVoiceMgr->stolenVoices[voiceNum];
     pSynth = pVoiceMgr->pSynth[GET_VSYNTH(pVoice->channel)];
     pMIDIChannel = &pSynth->channels[pVoice->channel & 15];
-    pNextSynth = pVoiceMgr->pSynth[GET_VSYNTH(pVoice->nextChannel)];
+    pNextSynth = pVoiceMgr->pSynth[GET_VSYNTH(pStolen->channel)];
 
 #ifdef _DEBUG_VM
 { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMRetargetStolenVoice: retargeting stolen voice %d on channel %d\n",
         voiceNum, pVoice->channel); */ }
 
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "\to channel %d note: %d velocity: %d\n",
-        pVoice->nextChannel, pVoice->nextNote, pVoice->nextVelocity); */ }
+        pStolen->channel, pStolen->note, pStolen->velocity); */ }
 #endif
 
     /* make sure new channel hasn't been muted by SP-MIDI since the voice was stolen */
@@ -1381,7 +2121,7 @@ static EAS_BOOL VMRetargetStolenVoice (S_VOICE_MGR *pVoiceMgr, EAS_I32 voiceNum)
     }
 
     /* if assigned to a new synth, correct the active voice count */
-    if (pVoice->channel != pVoice->nextChannel)
+    if (pVoice->channel != pStolen->channel)
     {
 #ifdef _DEBUG_VM
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMRetargetStolenVoice: Note assigned to different virtual synth, adjusting numActiveVoices\n"); */ }
@@ -1391,14 +2131,16 @@ static EAS_BOOL VMRetargetStolenVoice (S_VOICE_MGR *pVoiceMgr, EAS_I32 voiceNum)
     }
 
     /* assign new channel number, and increase channel voice count */
-    pVoice->channel = pVoice->nextChannel;
+    VMDeactivateVoice(pVoiceMgr, voiceNum);
+    pVoice->channel = pStolen->channel;
+    VMActivateVoice(pVoiceMgr, voiceNum);
     pMIDIChannel = &pNextSynth->channels[pVoice->channel & 15];
 
     /* assign other data */
-    pVoice->note = pVoice->nextNote;
-    pVoice->velocity = pVoice->nextVelocity;
-    pVoice->nextChannel = UNASSIGNED_SYNTH_CHANNEL;
-    pVoice->regionIndex = pVoice->nextRegionIndex;
+    pVoice->note = pStolen->note;
+    pVoice->velocity = pStolen->velocity;
+    pStolen->channel = UNASSIGNED_SYNTH_CHANNEL;
+    pVoice->regionIndex = pStolen->regionIndex;
 
     /* save the flags, pfStartVoice() will clear them */
     flags = pVoice->voiceFlags;
@@ -1406,8 +2148,11 @@ static EAS_BOOL VMRetargetStolenVoice (S_VOICE_MGR *pVoiceMgr, EAS_I32 voiceNum)
     /* keep track of the note-start related workload */
     pVoiceMgr->workload += WORKLOAD_AMOUNT_START_NOTE;
 
-    /* setup the voice parameters */
+    /* setup the voice parameters, stolen voices restart at the frame boundary */
     pVoice->voiceState = eVoiceStateStart;
+#ifdef _SAMPLE_ACCURATE_EVENTS
+    pVoice->startOffset = 0;
+#endif
 
     /*lint -e{522} return not used at this time */
     GetSynthPtr(voiceNum)->pfStartVoice(pVoiceMgr, pNextSynth, &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(voiceNum), pVoice->regionIndex);
@@ -1443,7 +2188,7 @@ void VMCheckKeyGroup (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U16 keyGroup,
 
     /* need to check all voices in case this is a layered sound */
     channel = VSynthToChannel(pSynth, channel);
-    for (voiceNum = 0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = VMNextVoice(pVoiceMgr->channelVoiceMask[channel], 0); voiceNum < MAX_SYNTH_VOICES; voiceNum = VMNextVoice(pVoiceMgr->channelVoiceMask[channel], voiceNum + 1))
     {
         if (pVoiceMgr->voices[voiceNum].voiceState != eVoiceStateStolen)
         {
@@ -1473,10 +2218,10 @@ void VMCheckKeyGroup (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U16 keyGroup,
         else
         {
             /* voice must be on the same channel */
-            if (channel == pVoiceMgr->voices[voiceNum].nextChannel)
+            if (channel == pVoiceMgr->stolenVoices[voiceNum].channel)
             {
                 /* check key group */
-                pRegion = GetRegionPtr(pSynth, pVoiceMgr->voices[voiceNum].nextRegionIndex);
+                pRegion = GetRegionPtr(pSynth, pVoiceMgr->stolenVoices[voiceNum].regionIndex);
                 if (keyGroup == (pRegion->keyGroupAndFlags & 0x0f00))
                 {
 #ifdef _DEBUG_VM
@@ -1537,36 +2282,39 @@ EAS_BOOL VMCheckPolyphonyLimiting (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_
     channel = VSynthToChannel(pSynth, channel);
 
     /* examine each voice on this channel playing this note */
-    for (voiceNum = lowVoice; voiceNum <= highVoice; voiceNum++)
+    for (voiceNum = VMNextVoice(pVoiceMgr->channelVoiceMask[channel], lowVoice); voiceNum <= highVoice; voiceNum = VMNextVoice(pVoiceMgr->channelVoiceMask[channel], voiceNum + 1))
     {
-        /* check stolen notes separately */
-        if (pVoiceMgr->voices[voiceNum].voiceState != eVoiceStateStolen)
+        /* stolen voices count for the channel they will play on */
+        if (pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateStolen)
+            continue;
+
+        if (note == pVoiceMgr->voices[voiceNum].note)
         {
+            numVoicesPlayingNote++;
+            age = pVoiceMgr->age - pVoiceMgr->voices[voiceNum].age;
 
-            /* same channel and note ? */
-            if ((channel == pVoiceMgr->voices[voiceNum].channel) && (note == pVoiceMgr->voices[voiceNum].note))
+            /* is this the oldest voice for this note? */
+            if (age >= oldestNoteAge)
             {
-                numVoicesPlayingNote++;
-                age = pVoiceMgr->age - pVoiceMgr->voices[voiceNum].age;
-
-                /* is this the oldest voice for this note? */
-                if (age >= oldestNoteAge)
-                {
-                    oldestNoteAge = age;
-                    oldestVoiceNum = voiceNum;
-                }
+                oldestNoteAge = age;
+                oldestVoiceNum = voiceNum;
             }
         }
+    }
 
-        /* handle stolen voices */
-        else
+    /* handle stolen voices */
+    for (voiceNum = VMNextVoice(pVoiceMgr->stolenVoiceMask, lowVoice); voiceNum <= highVoice; voiceNum = VMNextVoice(pVoiceMgr->stolenVoiceMask, voiceNum + 1))
+    {
+        /* forget voices that have been restarted or muted since */
+        if (pVoiceMgr->voices[voiceNum].voiceState != eVoiceStateStolen)
         {
-            /* same channel and note ? */
-            if ((channel == pVoiceMgr->voices[voiceNum].nextChannel) && (note == pVoiceMgr->voices[voiceNum].nextNote))
-            {
-                numVoicesPlayingNote++;
-            }
+            pVoiceMgr->stolenVoiceMask[voiceNum >> 5] &= ~(1UL << (voiceNum & 31));
+            continue;
         }
+
+        /* same channel and note ? */
+        if ((channel == pVoiceMgr->stolenVoices[voiceNum].channel) && (note == pVoiceMgr->stolenVoices[voiceNum].note))
+            numVoicesPlayingNote++;
     }
 
     /* check to see if we exceeded poly limit */
@@ -1608,11 +2356,26 @@ void VMStartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_
     pChannel = &pSynth->channels[channel];
     pRegion = GetRegionPtr(pSynth, regionIndex);
 
+#if defined(DLS_SYNTHESIZER) && defined(_DLS_LAZY_SAMPLES)
+    /* page in the wave on its first note, skip the note if it can't be loaded */
+    if ((regionIndex & FLAG_RGN_IDX_DLS_SYNTH) &&
+        (DLSLoadWave(pSynth->pDLS, ((const S_DLS_REGION*) pRegion)->wtRegion.waveIndex) != EAS_SUCCESS))
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "VMStartVoice: failed to load DLS wave for region %u\n", regionIndex); */ }
+        return;
+    }
+#endif
+
     /* select correct synth */
 #if defined(_SECONDARY_SYNTH) || defined(EAS_SPLIT_WT_SYNTH)
     {
 #ifdef EAS_SPLIT_WT_SYNTH
-        if ((pRegion->keyGroupAndFlags & REGION_FLAG_OFF_CHIP) == 0)
+        /* the engine has no compressed or DLS samples, those stay on-chip */
+        if (((pRegion->keyGroupAndFlags & (REGION_FLAG_OFF_CHIP | REGION_FLAG_USE_ADPCM)) != REGION_FLAG_OFF_CHIP)
+#ifdef DLS_SYNTHESIZER
+            || (regionIndex & FLAG_RGN_IDX_DLS_SYNTH)
+#endif
+            )
 #else
         if ((regionIndex & FLAG_RGN_IDX_FM_SYNTH) == 0)
 #endif
@@ -1628,7 +2391,7 @@ void VMStartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_
     }
 #else
     lowVoice = 0;
-    highVoice = MAX_SYNTH_VOICES - 1;
+    highVoice = VM_NUM_VOICES(pVoiceMgr) - 1;
 #endif
 
     /* keep track of the note-start related workload */
@@ -1687,6 +2450,10 @@ void VMStartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_
 
         /* setup the synthesis parameters */
         pVoiceMgr->voices[voiceNum].voiceState = eVoiceStateStart;
+#ifdef _SAMPLE_ACCURATE_EVENTS
+        pVoiceMgr->voices[voiceNum].startOffset = (EAS_U16) pVoiceMgr->eventOffset;
+#endif
+        VMActivateVoice(pVoiceMgr, voiceNum);
 
         /* increment voice pool count */
         IncVoicePoolCount(pVoiceMgr, pVoice);
@@ -1768,9 +2535,9 @@ void VMStartNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U
     /* handle transposition */
     adjustedNote = note;
     if (pChannel->channelFlags & CHANNEL_FLAG_RHYTHM_CHANNEL)
-        adjustedNote += pChannel->coarsePitch;
+        adjustedNote += pSynth->channelState[channel].coarsePitch;
     else
-        adjustedNote += pChannel->coarsePitch + pSynth->globalTranspose;
+        adjustedNote += pSynth->channelState[channel].coarsePitch + pSynth->globalTranspose;
 
     /* limit adjusted key number so it does not wraparound, over/underflow */
     if (adjustedNote < 0)
@@ -1785,6 +2552,26 @@ void VMStartNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U
 #if defined(DLS_SYNTHESIZER)
     if (regionIndex & FLAG_RGN_IDX_DLS_SYNTH)
     {
+#ifdef _DLS_KEY_INDEX
+        /* only check the velocity range of the regions that cover this key */
+        if ((pSynth->pDLS->pKeyIndex != NULL) && (pSynth->pDLS->pRegionKeyIndex[regionIndex & REGION_INDEX_MASK] != DLS_NO_KEY_INDEX))
+        {
+            const EAS_U32 *pKeyIndex;
+            const S_DLS_REGION *pDLSRegion;
+            EAS_U32 i;
+
+            pKeyIndex = &pSynth->pDLS->pKeyIndex[pSynth->pDLS->pRegionKeyIndex[regionIndex & REGION_INDEX_MASK] * DLS_KEY_INDEX_STRIDE + adjustedNote];
+            for (i = pKeyIndex[0]; i < pKeyIndex[1]; i++)
+            {
+                regionIndex = pSynth->pDLS->pKeyRegions[i];
+                pDLSRegion = &pSynth->pDLS->pDLSRegions[regionIndex & REGION_INDEX_MASK];
+                if ((velocity >= pDLSRegion->velLow) && (velocity <= pDLSRegion->velHigh))
+                    VMStartVoice(pVoiceMgr, pSynth, channel, note, velocity, regionIndex);
+            }
+            return;
+        }
+#endif
+
         /* DLS voice */
         for (;;)
         {
@@ -1833,6 +2620,91 @@ void VMStartNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U
     }
 }
 
+#ifdef _LOOKAHEAD_PREFETCH
+/*----------------------------------------------------------------------------
+ * VMPrefetchNote()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Finds the region VMStartNote would start for a note due in the next frame
+ * and starts loading its data. Nothing in the synth is changed, so a note
+ * that is not played after all, or a program change before it, only costs
+ * the wasted loads.
+ *
+ * Inputs:
+ * pVoiceMgr        - pointer to voice manager
+ * pSynth           - pointer to synth
+ * channel          - the MIDI channel
+ * note             - the MIDI key number for this note
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * None
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pVoiceMgr) reserved for future use */
+void VMPrefetchNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 note)
+{
+#ifdef _WT_SYNTH
+    const S_SYNTH_CHANNEL *pChannel;
+    EAS_U16 regionIndex;
+    EAS_I16 adjustedNote;
+
+    pChannel = &pSynth->channels[channel];
+    if (pChannel->channelFlags & CHANNEL_FLAG_MUTE)
+        return;
+
+    regionIndex = pChannel->regionIndex;
+
+    /* same transposition as VMStartNote */
+    adjustedNote = note;
+    if (pChannel->channelFlags & CHANNEL_FLAG_RHYTHM_CHANNEL)
+        adjustedNote += pSynth->channelState[channel].coarsePitch;
+    else
+        adjustedNote += pSynth->channelState[channel].coarsePitch + pSynth->globalTranspose;
+    if (adjustedNote < 0)
+        adjustedNote = 0;
+    else if (adjustedNote > 127)
+        adjustedNote = 127;
+
+#if defined(DLS_SYNTHESIZER)
+    /* DLS regions are matched on velocity too, only load the first one */
+    if (regionIndex & FLAG_RGN_IDX_DLS_SYNTH)
+    {
+        EAS_PREFETCH(GetRegionPtr(pSynth, regionIndex));
+        return;
+    }
+#endif
+
+#if defined(_HYBRID_SYNTH) || defined(_FM_FALLBACK)
+    /* FM voices have no samples */
+    if (regionIndex & FLAG_RGN_IDX_FM_SYNTH)
+        return;
+#endif
+
+    for (;;)
+    {
+        const S_REGION *pRegion = GetRegionPtr(pSynth, regionIndex);
+
+        if ((adjustedNote >= pRegion->rangeLow) && (adjustedNote <= pRegion->rangeHigh))
+        {
+            WT_PrefetchRegion(pSynth->pEAS, regionIndex);
+            break;
+        }
+        if (pRegion->keyGroupAndFlags & REGION_FLAG_LAST_REGION)
+            break;
+        regionIndex++;
+    }
+#else
+    /* FM voices have no samples */
+    (void) pSynth;
+    (void) channel;
+    (void) note;
+#endif
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * VMStopNote()
  *----------------------------------------------------------------------------
@@ -1879,7 +2751,7 @@ void VMStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8
 
     channel = VSynthToChannel(pSynth, channel);
 
-    for (voiceNum=0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); voiceNum < MAX_SYNTH_VOICES; voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, voiceNum + 1))
     {
 
         /* stolen notes are handled separately */
@@ -1919,7 +2791,7 @@ void VMStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8
         }
 
         /* process stolen notes, new channel and key number must match */
-        else if ((channel == pVoiceMgr->voices[voiceNum].nextChannel) && (note == pVoiceMgr->voices[voiceNum].nextNote))
+        else if ((channel == pVoiceMgr->stolenVoices[voiceNum].channel) && (note == pVoiceMgr->stolenVoices[voiceNum].note))
         {
 
 #ifdef _DEBUG_VM
@@ -1950,15 +2822,12 @@ EAS_RESULT VMFindAvailableVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT *pVoiceNumber,
 {
     EAS_INT voiceNum;
 
-    /* Check each voice to see if it has been assigned to a synth channel */
-    for (voiceNum = lowVoice; voiceNum <= highVoice; voiceNum++)
+    /* find the first voice that has not been assigned to a synth channel */
+    voiceNum = VMNextFreeVoice(pVoiceMgr, lowVoice);
+    if (voiceNum <= highVoice)
     {
-        /* check if this voice has been assigned to a synth channel */
-        if ( pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateFree)
-        {
-            *pVoiceNumber = voiceNum;       /* this voice is available */
-            return EAS_SUCCESS;
-        }
+        *pVoiceNumber = voiceNum;       /* this voice is available */
+        return EAS_SUCCESS;
     }
 
     /* if we reach here, we have not found a free voice */
@@ -2014,7 +2883,7 @@ EAS_RESULT VMStealVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_INT *pVoic
     bestPriority = 0;
     bestCandidate = MAX_SYNTH_VOICES;
 
-    for (voiceNum = lowVoice; voiceNum <= highVoice; voiceNum++)
+    for (voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, lowVoice); voiceNum <= highVoice; voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, voiceNum + 1))
     {
         pCurrVoice = &pVoiceMgr->voices[voiceNum];
 
@@ -2025,9 +2894,9 @@ EAS_RESULT VMStealVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_INT *pVoic
         /* for stolen voices, use the new parameters, not the old */
         if (pCurrVoice->voiceState == eVoiceStateStolen)
         {
-            pCurrSynth = pVoiceMgr->pSynth[GET_VSYNTH(pCurrVoice->nextChannel)];
-            currChannel = pCurrVoice->nextChannel;
-            currNote = pCurrVoice->nextNote;
+            currChannel = pVoiceMgr->stolenVoices[voiceNum].channel;
+            currNote = pVoiceMgr->stolenVoices[voiceNum].note;
+            pCurrSynth = pVoiceMgr->pSynth[GET_VSYNTH(currChannel)];
         }
         else
         {
@@ -2046,7 +2915,7 @@ EAS_RESULT VMStealVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_INT *pVoic
         /* if voice is stolen or just started, reduce the likelihood it will be stolen */
         if (( pCurrVoice->voiceState == eVoiceStateStolen) || (pCurrVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET))
         {
-            currentPriority = 128 - pCurrVoice->nextVelocity;
+            currentPriority = 128 - pVoiceMgr->stolenVoices[voiceNum].velocity;
         }
         else
         {
@@ -2099,12 +2968,13 @@ EAS_RESULT VMStealVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_INT *pVoic
     {
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "VMStealVoice: Voice %d is already marked as stolen and was scheduled to play ch: %d note: %d vel: %d\n",
             bestCandidate,
-            pVoiceMgr->voices[bestCandidate].nextChannel,
-            pVoiceMgr->voices[bestCandidate].nextNote,
-            pVoiceMgr->voices[bestCandidate].nextVelocity); */ }
+            pVoiceMgr->stolenVoices[bestCandidate].channel,
+            pVoiceMgr->stolenVoices[bestCandidate].note,
+            pVoiceMgr->stolenVoices[bestCandidate].velocity); */ }
     }
 #endif
 
+    pVoiceMgr->numStolenVoices++;
     *pVoiceNumber = (EAS_U16) bestCandidate;
     return EAS_SUCCESS;
 }
@@ -2137,6 +3007,7 @@ void VMChannelPressure (S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 value)
     for all the voices associated with this channel
     */
     pChannel->channelFlags |= CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS;
+    pSynth->dirtyChannels |= (EAS_U16) (1 << channel);
 }
 
 /*----------------------------------------------------------------------------
@@ -2172,13 +3043,14 @@ void VMPitchBend (S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 nPitchLSB, EAS_U8 nPit
     S_SYNTH_CHANNEL *pChannel;
 
     pChannel = &(pSynth->channels[channel]);
-    pChannel->pitchBend = (EAS_I16) ((nPitchMSB << 7) | nPitchLSB);
+    pSynth->channelState[channel].pitchBend = (EAS_I16) ((nPitchMSB << 7) | nPitchLSB);
 
     /*
     set a channel flag to request parameter updates
     for all the voices associated with this channel
     */
     pChannel->channelFlags |= CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS;
+    pSynth->dirtyChannels |= (EAS_U16) (1 << channel);
 }
 
 /*----------------------------------------------------------------------------
@@ -2202,14 +3074,17 @@ void VMPitchBend (S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 nPitchLSB, EAS_U8 nPit
 void VMControlChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 controller, EAS_U8 value)
 {
     S_SYNTH_CHANNEL *pChannel;
+    S_SYNTH_CHANNEL_STATE *pState;
 
     pChannel = &(pSynth->channels[channel]);
+    pState = &(pSynth->channelState[channel]);
 
     /*
     set a channel flag to request parameter updates
     for all the voices associated with this channel
     */
     pChannel->channelFlags |= CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS;
+    pSynth->dirtyChannels |= (EAS_U16) (1 << channel);
 
     switch ( controller )
     {
@@ -2218,7 +3093,7 @@ void VMControlChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMControlChange: Bank Select MSB: msb 0x%X\n", value); */ }
 #endif
         /* use this MSB with a zero LSB, until we get an LSB message */
-        pChannel->bankNum = value << 8;
+        pState->bankNum = value << 8;
         break;
 
     case MIDI_CONTROLLER_MOD_WHEEL:
@@ -2228,7 +3103,7 @@ void VMControlChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
 
     case MIDI_CONTROLLER_VOLUME:
         /* we treat volume as a 7-bit controller and only use the MSB */
-        pChannel->volume = value;
+        pState->volume = value;
         break;
 
     case MIDI_CONTROLLER_PAN:
@@ -2238,7 +3113,7 @@ void VMControlChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
 
     case MIDI_CONTROLLER_EXPRESSION:
         /* we treat expression as a 7-bit controller and only use the MSB */
-        pChannel->expression = value;
+        pState->expression = value;
         break;
 
     case MIDI_CONTROLLER_BANK_SELECT_LSB:
@@ -2249,8 +3124,8 @@ void VMControlChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
         construct bank number as 7-bits (stored as 8) of existing MSB
         and 7-bits of new LSB (also stored as 8(
         */
-        pChannel->bankNum =
-            (pChannel->bankNum & 0xFF00) | value;
+        pState->bankNum =
+            (pState->bankNum & 0xFF00) | value;
 
         break;
 
@@ -2312,7 +3187,7 @@ void VMControlChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
         pSynth->channels[channel].reverbSend = value;
         break;
 #endif
-#ifdef _CHORUS
+#if defined(_CHORUS) || defined(_CHORUS_ENABLED)
     case MIDI_CONTROLLER_CHORUS_SEND:
         /* we treat send as a 7-bit controller and only use the MSB */
         pSynth->channels[channel].chorusSend = value;
@@ -2321,20 +3196,20 @@ void VMControlChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
     case MIDI_CONTROLLER_RESET_CONTROLLERS:
         /* despite the Midi message name, not ALL controllers are reset */
         pChannel->modWheel = DEFAULT_MOD_WHEEL;
-        pChannel->expression = DEFAULT_EXPRESSION;
+        pState->expression = DEFAULT_EXPRESSION;
 
         /* turn the sustain pedal off as default/reset */
         pChannel->channelFlags &= ~CHANNEL_FLAG_SUSTAIN_PEDAL;
-        pChannel->pitchBend = DEFAULT_PITCH_BEND;
+        pState->pitchBend = DEFAULT_PITCH_BEND;
 
         /* reset channel pressure */
         pChannel->channelPressure = DEFAULT_CHANNEL_PRESSURE;
 
         /* reset RPN values */
-        pChannel->registeredParam = DEFAULT_REGISTERED_PARAM;
-        pChannel->pitchBendSensitivity = DEFAULT_PITCH_BEND_SENSITIVITY;
-        pChannel->finePitch = DEFAULT_FINE_PITCH;
-        pChannel->coarsePitch = DEFAULT_COARSE_PITCH;
+        pState->registeredParam = DEFAULT_REGISTERED_PARAM;
+        pState->pitchBendSensitivity = DEFAULT_PITCH_BEND_SENSITIVITY;
+        pState->finePitch = DEFAULT_FINE_PITCH;
+        pState->coarsePitch = DEFAULT_COARSE_PITCH;
 
         /*
         program change, bank select, channel volume CC7, pan CC10
@@ -2410,7 +3285,7 @@ void VMControlChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
 */
 EAS_RESULT VMUpdateRPNStateMachine (S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 controller, EAS_U8 value)
 {
-    S_SYNTH_CHANNEL *pChannel;
+    S_SYNTH_CHANNEL_STATE *pState;
 
 #ifdef _DEBUG_VM
     if (channel >= NUM_SYNTH_CHANNELS)
@@ -2421,41 +3296,41 @@ EAS_RESULT VMUpdateRPNStateMachine (S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 cont
     }
 #endif
 
-    pChannel = &(pSynth->channels[channel]);
+    pState = &(pSynth->channelState[channel]);
 
     switch (controller)
     {
     case MIDI_CONTROLLER_SELECT_NRPN_MSB:
     case MIDI_CONTROLLER_SELECT_NRPN_LSB:
-        pChannel->registeredParam = DEFAULT_REGISTERED_PARAM;
+        pState->registeredParam = DEFAULT_REGISTERED_PARAM;
         break;
     case MIDI_CONTROLLER_SELECT_RPN_MSB:
-        pChannel->registeredParam =
-            (pChannel->registeredParam & 0x7F) | (value<<7);
+        pState->registeredParam =
+            (pState->registeredParam & 0x7F) | (value<<7);
         break;
     case MIDI_CONTROLLER_SELECT_RPN_LSB:
-        pChannel->registeredParam =
-            (pChannel->registeredParam & 0x7F00) | value;
+        pState->registeredParam =
+            (pState->registeredParam & 0x7F00) | value;
         break;
     case MIDI_CONTROLLER_ENTER_DATA_MSB:
-        switch (pChannel->registeredParam)
+        switch (pState->registeredParam)
         {
         case 0:
-            pChannel->pitchBendSensitivity = value * 100;
+            pState->pitchBendSensitivity = value * 100;
             break;
         case 1:
             /*lint -e{702} <avoid division for performance reasons>*/
-            pChannel->finePitch = (EAS_I8)((((value << 7) - 8192) * 100) >> 13);
+            pState->finePitch = (EAS_I8)((((value << 7) - 8192) * 100) >> 13);
             break;
         case 2:
-            pChannel->coarsePitch = (EAS_I8)(value - 64);
+            pState->coarsePitch = (EAS_I8)(value - 64);
             break;
         default:
             break;
         }
         break;
     case MIDI_CONTROLLER_ENTER_DATA_LSB:
-        switch (pChannel->registeredParam)
+        switch (pState->registeredParam)
         {
         case 0:
             //ignore lsb
@@ -2484,7 +3359,8 @@ EAS_RESULT VMUpdateRPNStateMachine (S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 cont
  * Update all of the static channel parameters for channels that have had
  * a controller change values
  * Or if the synth has signalled that all channels must forcibly
- * be updated
+ * be updated. The controller handlers put changed channels on the
+ * dirty list of the synth, so idle channels are not visited.
  *
  * Inputs:
  * psEASData - pointer to overall EAS data structure
@@ -2502,6 +3378,7 @@ EAS_RESULT VMUpdateRPNStateMachine (S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 cont
 void VMUpdateStaticChannelParameters (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
 {
     EAS_INT channel;
+    EAS_U32 dirty;
 
     if (pSynth->synthFlags & SYNTH_FLAG_UPDATE_ALL_CHANNEL_PARAMETERS)
     {
@@ -2531,10 +3408,10 @@ void VMUpdateStaticChannelParameters (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
     else
     {
 
-        /* only update channel params if signalled by a channel flag */
-        for (channel = 0; channel < NUM_SYNTH_CHANNELS; channel++)
+        /* only update the channels on the dirty list, if still signalled by a channel flag */
+        for (channel = 0, dirty = pSynth->dirtyChannels; dirty != 0; channel++, dirty >>= 1)
         {
-            if ( 0 != (pSynth->channels[channel].channelFlags & CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS))
+            if ((dirty & 1) && (0 != (pSynth->channels[channel].channelFlags & CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS)))
             {
 #ifdef _HYBRID_SYNTH
                 if (pSynth->channels[channel].regionIndex & FLAG_RGN_IDX_FM_SYNTH)
@@ -2626,6 +3503,10 @@ static EAS_RESULT VMFindDLSProgram (const S_DLS *pDLS, EAS_U32 bank, EAS_U8 prog
     EAS_U32 locale;
     const S_PROGRAM *p;
     EAS_U16 i;
+#ifdef _DLS_PROGRAM_INDEX
+    EAS_U32 mask;
+    EAS_U32 slot;
+#endif
 
     /* make sure we have a valid sound library */
     if (pDLS == NULL)
@@ -2634,6 +3515,23 @@ static EAS_RESULT VMFindDLSProgram (const S_DLS *pDLS, EAS_U32 bank, EAS_U8 prog
     /* establish locale */
     locale = (bank << 8) | programNum;
 
+#ifdef _DLS_PROGRAM_INDEX
+    /* probe the program index, an empty slot ends the search */
+    if (pDLS->pProgramIndex != NULL)
+    {
+        mask = (1UL << pDLS->programIndexBits) - 1;
+        for (slot = DLS_PROGRAM_HASH(locale, pDLS->programIndexBits); pDLS->pProgramIndex[slot].regionIndex != INVALID_REGION_INDEX; slot = (slot + 1) & mask)
+        {
+            if (pDLS->pProgramIndex[slot].locale == locale)
+            {
+                *pRegionIndex = pDLS->pProgramIndex[slot].regionIndex;
+                return EAS_SUCCESS;
+            }
+        }
+        return EAS_FAILURE;
+    }
+#endif
+
     /* search for program */
     for (i = 0, p = pDLS->pDLSPrograms; i < pDLS->numDLSPrograms; i++, p++)
     {
@@ -2685,7 +3583,7 @@ void VMProgramChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
 
     /* setup pointer to MIDI channel data */
     pChannel = &pSynth->channels[channel];
-    bank = pChannel->bankNum;
+    bank = pSynth->channelState[channel].bankNum;
 
     /* allow channels to switch between being melodic or rhythm channels, using GM2 CC values */
     if ((bank & 0xFF00) == DEFAULT_RHYTHM_BANK_NUMBER)
@@ -2716,6 +3614,13 @@ void VMProgramChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
 #endif
 
 
+#ifdef _FM_FALLBACK
+    /* the FM engine plays its own patch set */
+    if (VMChannelUsesFM(pVoiceMgr, pSynth, channel))
+        regionIndex = FM_FindProgram((EAS_BOOL) ((pChannel->channelFlags & CHANNEL_FLAG_RHYTHM_CHANNEL) != 0), program);
+    else
+#endif
+
 #ifdef DLS_SYNTHESIZER
     /* first check for DLS program that may overlay the internal instrument */
     if (VMFindDLSProgram(pSynth->pDLS, bank, program, &regionIndex) != EAS_SUCCESS)
@@ -2746,7 +3651,7 @@ void VMProgramChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
     }
 
     /* we have our new program change for this channel */
-    pChannel->programNum = program;
+    pSynth->channelState[channel].programNum = program;
     pChannel->regionIndex = regionIndex;
 
     /*
@@ -2754,10 +3659,460 @@ void VMProgramChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
     for all the voices associated with this channel
     */
     pChannel->channelFlags |= CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS;
+    pSynth->dirtyChannels |= (EAS_U16) (1 << channel);
 
     return;
 }
 
+/*----------------------------------------------------------------------------
+ * VMUpdateVoice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Synthesize one frame of a voice. A voice started part way through the
+ * frame is mixed in from its start offset on its first frame. With
+ * _BLOCK_RENDER numSamples may be several frames, which are synthesized
+ * one update period at a time. With _LOW_LATENCY numSamples may be a slice
+ * of an update period, and the voice is told where in the period it is.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pSynth - pointer to virtual synth the voice belongs to
+ * voiceNum - voice number
+ * pVoiceBuffer - voice scratch buffer
+ * pMixBuffer - mix buffer for the frame
+ * numSamples - number of samples in the frame
+ *
+ * Outputs:
+ * Returns EAS_TRUE if the voice has finished
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL VMUpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_INT voiceNum, EAS_PCM *pVoiceBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSamples)
+{
+    S_SYNTH_VOICE *pVoice;
+#if defined(_BLOCK_RENDER) || defined(_LOW_LATENCY)
+    EAS_I32 offset;
+    EAS_I32 count;
+    EAS_I32 pos;
+    EAS_BOOL done;
+#endif
+
+    pVoice = &pVoiceMgr->voices[voiceNum];
+
+#if defined(_BLOCK_RENDER) || defined(_LOW_LATENCY)
+    /* a block is synthesized a frame at a time, a voice starting in a later frame waits for it */
+    offset = 0;
+#ifdef _SAMPLE_ACCURATE_EVENTS
+    if (pVoice->startOffset)
+    {
+        if (pVoice->startOffset >= numSamples)
+        {
+            pVoice->startOffset = (EAS_U16) (pVoice->startOffset - numSamples);
+            return EAS_FALSE;
+        }
+        offset = pVoice->startOffset;
+        pVoice->startOffset = 0;
+    }
+#endif
+    done = EAS_FALSE;
+    while (!done && (offset < numSamples))
+    {
+        pos = offset;
+#ifdef _LOW_LATENCY
+        pos += pVoiceMgr->slicePos;
+#endif
+        count = VM_UPDATE_PERIOD(pVoiceMgr) - (pos % VM_UPDATE_PERIOD(pVoiceMgr));
+        if (count > numSamples - offset)
+            count = numSamples - offset;
+#ifdef _LOW_LATENCY
+        pVoice->framePos = (EAS_U16) (pos % VM_UPDATE_PERIOD(pVoiceMgr));
+#endif
+        done = GetSynthPtr(voiceNum)->pfUpdateVoice(pVoiceMgr, pSynth, pVoice, GetAdjustedVoiceNum(voiceNum), pVoiceBuffer, &pMixBuffer[offset * NUM_OUTPUT_CHANNELS], count);
+        offset += count;
+    }
+    return done;
+#else
+
+#ifdef _SAMPLE_ACCURATE_EVENTS
+    if (pVoice->startOffset)
+    {
+        if (pVoice->startOffset < numSamples)
+        {
+            pMixBuffer += pVoice->startOffset * NUM_OUTPUT_CHANNELS;
+            numSamples -= pVoice->startOffset;
+        }
+        pVoice->startOffset = 0;
+    }
+#endif
+
+    return GetSynthPtr(voiceNum)->pfUpdateVoice(pVoiceMgr, pSynth, pVoice, GetAdjustedVoiceNum(voiceNum), pVoiceBuffer, pMixBuffer, numSamples);
+#endif
+}
+
+#ifdef _PARALLEL_VOICE_RENDER
+/*----------------------------------------------------------------------------
+ * VMRenderWorker()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Synthesize a share of the voices collected by VMAddSamplesParallel.
+ * Worker 0 mixes directly into the output mix buffer, the other workers
+ * mix into their own partial buffers which are summed afterwards.
+ *
+ * Inputs:
+ * pArg - pointer to voice manager
+ * workerNum - worker number
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * Only the state of the voices assigned to this worker is modified
+ *
+ *----------------------------------------------------------------------------
+*/
+static void VMRenderWorker (EAS_VOID_PTR pArg, EAS_INT workerNum)
+{
+    S_VOICE_MGR *pVoiceMgr;
+    S_SYNTH *pSynth;
+    EAS_I32 *pMixBuffer;
+    EAS_PCM *pVoiceBuffer;
+    EAS_INT voiceNum;
+    EAS_INT i;
+
+    pVoiceMgr = (S_VOICE_MGR*) pArg;
+    if (workerNum == 0)
+    {
+        pMixBuffer = pVoiceMgr->pRenderMixBuffer;
+        pVoiceBuffer = pVoiceMgr->voiceBuffer;
+    }
+    else
+    {
+        pMixBuffer = &pVoiceMgr->pWorkerMixBuffers[(workerNum - 1) * MAX_BLOCK_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS];
+        pVoiceBuffer = &pVoiceMgr->pWorkerVoiceBuffers[(workerNum - 1) * MAX_SYNTH_UPDATE_PERIOD_IN_SAMPLES];
+        EAS_HWMemSet(pMixBuffer, 0, pVoiceMgr->renderNumSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_I32));
+    }
+
+    for (i = workerNum; i < pVoiceMgr->numRenderVoices; i += pVoiceMgr->renderStride)
+    {
+        voiceNum = pVoiceMgr->renderVoices[i];
+        pSynth = pVoiceMgr->pSynth[pVoiceMgr->voices[voiceNum].channel >> 4];
+#if defined(_SAMPLE_PREFETCH) && defined(_WT_SYNTH)
+        /* the samples of this worker's next voice load while this one is synthesized */
+        if (i + pVoiceMgr->renderStride < pVoiceMgr->numRenderVoices)
+            VMPrefetchVoice(pVoiceMgr, pVoiceMgr->renderVoices[i + pVoiceMgr->renderStride], pVoiceMgr->renderNumSamples);
+#endif
+        pVoiceMgr->renderDone[i] = (EAS_BOOL8) VMUpdateVoice(pVoiceMgr, pSynth, voiceNum, pVoiceBuffer, pMixBuffer, pVoiceMgr->renderNumSamples);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * VMAddSamplesParallel()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parallel version of VMAddSamples. Stolen voices are retargeted and the
+ * voice state bookkeeping is done on the calling thread in voice order,
+ * only the synthesis itself is spread across the worker pool. Since the
+ * partial mixes are integer sums the output is identical to VMAddSamples.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pMixBuffer - pointer to mix buffer
+ * numSamples - number of samples to synthesize
+ *
+ * Outputs:
+ * number of voices rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 VMAddSamplesParallel (S_VOICE_MGR *pVoiceMgr, EAS_I32 *pMixBuffer, EAS_I32 numSamples)
+{
+    S_SYNTH *pSynth;
+    EAS_I32 *pPartial;
+    EAS_INT voiceNum;
+    EAS_INT worker;
+    EAS_INT i;
+
+    /* retarget stolen voices and collect the voices to render */
+    pVoiceMgr->numRenderVoices = 0;
+    for (voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); voiceNum < MAX_SYNTH_VOICES; voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, voiceNum + 1))
+    {
+        if ((pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateStolen) && (pVoiceMgr->voices[voiceNum].gain <= 0))
+            VMRetargetStolenVoice(pVoiceMgr, voiceNum);
+        if (pVoiceMgr->voices[voiceNum].voiceState != eVoiceStateFree)
+            pVoiceMgr->renderVoices[pVoiceMgr->numRenderVoices++] = (EAS_U8) voiceNum;
+    }
+
+    /* synthesize the voices */
+    pVoiceMgr->pRenderMixBuffer = pMixBuffer;
+    pVoiceMgr->renderNumSamples = numSamples;
+    if (pVoiceMgr->numRenderVoices < MIN_PARALLEL_VOICES)
+    {
+        pVoiceMgr->renderStride = 1;
+        VMRenderWorker(pVoiceMgr, 0);
+    }
+    else
+    {
+        pVoiceMgr->renderStride = pVoiceMgr->numWorkers;
+        EAS_HWRunWorkers(pVoiceMgr->pWorkers);
+
+        /* sum the partial mixes */
+        for (worker = 1; worker < pVoiceMgr->numWorkers; worker++)
+        {
+            pPartial = &pVoiceMgr->pWorkerMixBuffers[(worker - 1) * MAX_BLOCK_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS];
+            for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+                pMixBuffer[i] += pPartial[i];
+        }
+    }
+
+    /* update the voice states */
+    for (i = 0; i < pVoiceMgr->numRenderVoices; i++)
+    {
+        voiceNum = pVoiceMgr->renderVoices[i];
+        pSynth = pVoiceMgr->pSynth[pVoiceMgr->voices[voiceNum].channel >> 4];
+
+        /* voice is finished */
+        if (pVoiceMgr->renderDone[i])
+        {
+            /* set gain of stolen voice to zero so it will be restarted */
+            if (pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateStolen)
+                pVoiceMgr->voices[voiceNum].gain = 0;
+
+            /* or return it to the free voice pool */
+            else
+                VMFreeVoice(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum]);
+        }
+
+        /* if this voice is scheduled to be muted, set the mute flag */
+        if (pVoiceMgr->voices[voiceNum].voiceFlags & VOICE_FLAG_DEFER_MUTE)
+        {
+            pVoiceMgr->voices[voiceNum].voiceFlags &= ~(VOICE_FLAG_DEFER_MUTE | VOICE_FLAG_DEFER_MIDI_NOTE_OFF);
+            VMMuteVoice(pVoiceMgr, voiceNum);
+        }
+
+        /* if voice just started, advance state to play */
+        if (pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateStart)
+            pVoiceMgr->voices[voiceNum].voiceState = eVoiceStatePlay;
+    }
+
+    return pVoiceMgr->numRenderVoices;
+}
+
+/*----------------------------------------------------------------------------
+ * VMSetRenderThreads()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Set the number of threads used to synthesize voices. One thread
+ * selects the serial VMAddSamples path and releases the worker pool.
+ *
+ * Inputs:
+ * pEASData - pointer to overall EAS data structure
+ * numThreads - number of threads including the calling thread
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMSetRenderThreads (S_EAS_DATA *pEASData, EAS_INT numThreads)
+{
+    S_VOICE_MGR *pVoiceMgr;
+    EAS_RESULT result;
+
+    if ((numThreads < 1) || (numThreads > MAX_RENDER_THREADS))
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    /* release the current pool */
+    pVoiceMgr = pEASData->pVoiceMgr;
+    if (pVoiceMgr->pWorkers != NULL)
+    {
+        EAS_HWDestroyWorkers(pEASData->hwInstData, pVoiceMgr->pWorkers);
+        pVoiceMgr->pWorkers = NULL;
+    }
+    if (pVoiceMgr->pWorkerMixBuffers != NULL)
+    {
+        EAS_HWFree(pEASData->hwInstData, pVoiceMgr->pWorkerMixBuffers);
+        pVoiceMgr->pWorkerMixBuffers = NULL;
+    }
+    if (pVoiceMgr->pWorkerVoiceBuffers != NULL)
+    {
+        EAS_HWFree(pEASData->hwInstData, pVoiceMgr->pWorkerVoiceBuffers);
+        pVoiceMgr->pWorkerVoiceBuffers = NULL;
+    }
+    pVoiceMgr->numWorkers = 1;
+    if (numThreads == 1)
+        return EAS_SUCCESS;
+
+    /* allocate scratch buffers for the extra workers */
+    pVoiceMgr->pWorkerMixBuffers = EAS_HWMallocCategory(pEASData->hwInstData,
+        (numThreads - 1) * MAX_BLOCK_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_I32), EAS_MEM_MIX_BUFFERS);
+    pVoiceMgr->pWorkerVoiceBuffers = EAS_HWMallocCategory(pEASData->hwInstData,
+        (numThreads - 1) * MAX_SYNTH_UPDATE_PERIOD_IN_SAMPLES * (EAS_I32) sizeof(EAS_PCM), EAS_MEM_MIX_BUFFERS);
+    if ((pVoiceMgr->pWorkerMixBuffers == NULL) || (pVoiceMgr->pWorkerVoiceBuffers == NULL))
+    {
+        (void) VMSetRenderThreads(pEASData, 1);
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+
+    if ((result = EAS_HWCreateWorkers(pEASData->hwInstData, numThreads, VMRenderWorker, pVoiceMgr, &pVoiceMgr->pWorkers)) != EAS_SUCCESS)
+    {
+        (void) VMSetRenderThreads(pEASData, 1);
+        return result;
+    }
+    pVoiceMgr->numWorkers = numThreads;
+    return EAS_SUCCESS;
+}
+#endif
+
+#ifdef _STEM_OUTPUT
+/*----------------------------------------------------------------------------
+ * VMSetStemCount()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Set the number of stems the voices are mixed into. Zero releases the
+ * stem buffers and voices mix straight into the output mix buffer.
+ *
+ * Inputs:
+ * pEASData - pointer to overall EAS data structure
+ * numStems - number of stems, up to EAS_MAX_STEMS
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMSetStemCount (S_EAS_DATA *pEASData, EAS_INT numStems)
+{
+    S_VOICE_MGR *pVoiceMgr;
+
+    if ((numStems < 0) || (numStems > EAS_MAX_STEMS))
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    /* release the current buffers */
+    pVoiceMgr = pEASData->pVoiceMgr;
+    if (pVoiceMgr->pStemMixBuffers != NULL)
+    {
+        EAS_HWFree(pEASData->hwInstData, pVoiceMgr->pStemMixBuffers);
+        pVoiceMgr->pStemMixBuffers = NULL;
+    }
+    pVoiceMgr->numStems = 0;
+    if (numStems == 0)
+        return EAS_SUCCESS;
+
+    pVoiceMgr->pStemMixBuffers = EAS_HWMallocCategory(pEASData->hwInstData, numStems * STEM_MIX_BUFFER_SIZE * (EAS_I32) sizeof(EAS_I32), EAS_MEM_MIX_BUFFERS);
+    if (pVoiceMgr->pStemMixBuffers == NULL)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_FATAL, "Failed to allocate stem mix buffers\n"); */ }
+        return EAS_ERROR_MALLOC_FAILED;
+    }
+    pVoiceMgr->numStems = numStems;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * VMSetChannelStem()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Assign a MIDI channel of a virtual synth to a stem. Voices already
+ * playing move to the new stem on the next frame.
+ *
+ * Inputs:
+ * pSynth - pointer to virtual synth
+ * channel - MIDI channel, or -1 for all channels
+ * stem - stem number
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMSetChannelStem (S_SYNTH *pSynth, EAS_INT channel, EAS_INT stem)
+{
+    if ((stem < 0) || (stem >= EAS_MAX_STEMS) || (channel < -1) || (channel >= NUM_SYNTH_CHANNELS))
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    if (channel < 0)
+    {
+        for (channel = 0; channel < NUM_SYNTH_CHANNELS; channel++)
+            pSynth->channelStems[channel] = (EAS_U8) stem;
+    }
+    else
+        pSynth->channelStems[channel] = (EAS_U8) stem;
+    return EAS_SUCCESS;
+}
+#endif
+
+#ifdef _FM_FALLBACK
+/*----------------------------------------------------------------------------
+ * VMSetSynthEngine()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the engine of the channels left at EAS_SYNTH_ENGINE_DEFAULT. Their
+ * programs are selected again, the notes sounding keep their engine.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * engine - EAS_SYNTH_ENGINE_WAVETABLE or EAS_SYNTH_ENGINE_FM
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMSetSynthEngine (S_VOICE_MGR *pVoiceMgr, EAS_INT engine)
+{
+    S_SYNTH *pSynth;
+    EAS_INT vSynthNum;
+    EAS_INT channel;
+
+    if (engine == pVoiceMgr->synthEngine)
+        return;
+    pVoiceMgr->synthEngine = (EAS_U8) engine;
+
+    for (vSynthNum = 0; vSynthNum < VM_NUM_SYNTHS(pVoiceMgr); vSynthNum++)
+    {
+        if ((pSynth = pVoiceMgr->pSynth[vSynthNum]) == NULL)
+            continue;
+        for (channel = 0; channel < NUM_SYNTH_CHANNELS; channel++)
+        {
+            if (pSynth->channelEngines[channel] == EAS_SYNTH_ENGINE_DEFAULT)
+                VMProgramChange(pVoiceMgr, pSynth, (EAS_U8) channel, pSynth->channelState[channel].programNum);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * VMSetChannelEngine()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the engine of a MIDI channel of a virtual synth. The program of the
+ * channel is selected again, the notes sounding keep their engine.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pSynth - pointer to virtual synth
+ * channel - MIDI channel, or -1 for all channels
+ * engine - E_EAS_SYNTH_ENGINE
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMSetChannelEngine (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_INT channel, EAS_INT engine)
+{
+    EAS_INT first;
+    EAS_INT last;
+
+    if (channel < 0)
+    {
+        first = 0;
+        last = NUM_SYNTH_CHANNELS - 1;
+    }
+    else
+        first = last = channel;
+
+    for (channel = first; channel <= last; channel++)
+    {
+        pSynth->channelEngines[channel] = (EAS_U8) engine;
+        VMProgramChange(pVoiceMgr, pSynth, (EAS_U8) channel, pSynth->channelState[channel].programNum);
+    }
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * VMAddSamples()
  *----------------------------------------------------------------------------
@@ -2779,9 +4134,26 @@ void VMProgramChange (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, E
 EAS_I32 VMAddSamples (S_VOICE_MGR *pVoiceMgr, EAS_I32 *pMixBuffer, EAS_I32 numSamples)
 {
     S_SYNTH *pSynth;
+    EAS_I32 *pVoiceMixBuffer;
     EAS_INT voicesRendered;
     EAS_INT voiceNum;
     EAS_BOOL done;
+#if defined(_STEM_OUTPUT) || defined(_INSERT_EFFECTS)
+    EAS_INT i;
+#endif
+#ifdef _STEM_OUTPUT
+    EAS_I32 *pStem;
+    EAS_INT stem;
+#endif
+#ifdef _INSERT_EFFECTS
+    S_INSERT_CHAIN *pChain;
+    EAS_I32 *pInsertOutput;
+    EAS_BOOL inserts;
+    EAS_INT vSynthNum;
+#endif
+#ifdef _PARALLEL_VOICE_RENDER
+    EAS_BOOL parallel;
+#endif
 
 #ifdef  _REVERB
     EAS_PCM *pReverbSendBuffer;
@@ -2791,8 +4163,47 @@ EAS_I32 VMAddSamples (S_VOICE_MGR *pVoiceMgr, EAS_I32 *pMixBuffer, EAS_I32 numSa
     EAS_PCM *pChorusSendBuffer;
 #endif  // ifdef    _CHORUS
 
+#ifdef _INSERT_EFFECTS
+    /* clear the mix buffers of the streams with inserts that are not bypassed */
+    inserts = EAS_FALSE;
+    for (vSynthNum = 0; vSynthNum < VM_NUM_SYNTHS(pVoiceMgr); vSynthNum++)
+    {
+        if (((pSynth = pVoiceMgr->pSynth[vSynthNum]) != NULL) && (pSynth->pInserts != NULL) && pSynth->pInserts->numActive)
+        {
+            EAS_HWMemSet(pSynth->pInserts->pBuffer, 0, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_I32));
+            inserts = EAS_TRUE;
+        }
+    }
+#endif
+
+#ifdef _PARALLEL_VOICE_RENDER
+    parallel = (pVoiceMgr->pWorkers != NULL);
+#ifdef _STEM_OUTPUT
+    /* the partial mixes of the workers are not split by stem */
+    if (pVoiceMgr->numStems)
+        parallel = EAS_FALSE;
+#endif
+#ifdef _INSERT_EFFECTS
+    /* nor by stream */
+    if (inserts)
+        parallel = EAS_FALSE;
+#endif
+#ifdef EAS_SPLIT_WT_SYNTH
+    /* the offload ring has a single writer */
+    parallel = EAS_FALSE;
+#endif
+    if (parallel)
+        return VMAddSamplesParallel(pVoiceMgr, pMixBuffer, numSamples);
+#endif
+
+#ifdef _STEM_OUTPUT
+    /* clear the stems */
+    for (stem = 0; stem < pVoiceMgr->numStems; stem++)
+        EAS_HWMemSet(&pVoiceMgr->pStemMixBuffers[stem * STEM_MIX_BUFFER_SIZE], 0, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_I32));
+#endif
+
     voicesRendered = 0;
-    for (voiceNum = 0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); voiceNum < MAX_SYNTH_VOICES; voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, voiceNum + 1))
     {
 
         /* retarget stolen voices */
@@ -2805,7 +4216,32 @@ EAS_I32 VMAddSamples (S_VOICE_MGR *pVoiceMgr, EAS_I32 *pMixBuffer, EAS_I32 numSa
         /* synthesize active voices */
         if (pVoiceMgr->voices[voiceNum].voiceState != eVoiceStateFree)
         {
-            done = GetSynthPtr(voiceNum)->pfUpdateVoice(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(voiceNum), pMixBuffer, numSamples);
+            pVoiceMixBuffer = pMixBuffer;
+#ifdef _STEM_OUTPUT
+            /* mix into the stem of the voice's channel, stems past the count go to stem 0 */
+            if (pVoiceMgr->numStems)
+            {
+                stem = pSynth->channelStems[GET_CHANNEL(pVoiceMgr->voices[voiceNum].channel)];
+                if (stem >= pVoiceMgr->numStems)
+                    stem = 0;
+                pVoiceMixBuffer = &pVoiceMgr->pStemMixBuffers[stem * STEM_MIX_BUFFER_SIZE];
+            }
+#endif
+#ifdef _INSERT_EFFECTS
+            /* or into the mix of the stream, for its inserts */
+            if ((pSynth->pInserts != NULL) && pSynth->pInserts->numActive)
+                pVoiceMixBuffer = pSynth->pInserts->pBuffer;
+#endif
+#ifdef EAS_SPLIT_WT_SYNTH
+            /* the engine mixes the off-chip voices into the frame */
+            if (voiceNum >= NUM_PRIMARY_VOICES)
+                pVoiceMixBuffer = pMixBuffer;
+#endif
+#if defined(_SAMPLE_PREFETCH) && defined(_WT_SYNTH)
+            /* the samples of the next voice load while this one is synthesized */
+            VMPrefetchVoice(pVoiceMgr, VMNextVoice(pVoiceMgr->activeVoiceMask, voiceNum + 1), numSamples);
+#endif
+            done = VMUpdateVoice(pVoiceMgr, pSynth, voiceNum, pVoiceMgr->voiceBuffer, pVoiceMixBuffer, numSamples);
             voicesRendered++;
 
             /* voice is finished */
@@ -2833,14 +4269,71 @@ EAS_I32 VMAddSamples (S_VOICE_MGR *pVoiceMgr, EAS_I32 *pMixBuffer, EAS_I32 numSa
         }
     }
 
+#ifdef _INSERT_EFFECTS
+    /* run the stream inserts and add the streams to the mix, or to stem 0 */
+    if (inserts)
+    {
+        pInsertOutput = pMixBuffer;
+#ifdef _STEM_OUTPUT
+        if (pVoiceMgr->numStems)
+            pInsertOutput = pVoiceMgr->pStemMixBuffers;
+#endif
+        for (vSynthNum = 0; vSynthNum < VM_NUM_SYNTHS(pVoiceMgr); vSynthNum++)
+        {
+            if (((pSynth = pVoiceMgr->pSynth[vSynthNum]) == NULL) || ((pChain = pSynth->pInserts) == NULL) || !pChain->numActive)
+                continue;
+            EAS_InsertChainProcess(pChain, pChain->pBuffer, numSamples);
+            for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+                pInsertOutput[i] += pChain->pBuffer[i];
+        }
+    }
+#endif
+
+#ifdef _STEM_OUTPUT
+    /* the output mix is the sum of the stems */
+    for (stem = 0; stem < pVoiceMgr->numStems; stem++)
+    {
+        pStem = &pVoiceMgr->pStemMixBuffers[stem * STEM_MIX_BUFFER_SIZE];
+        for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+            pMixBuffer[i] += pStem[i];
+    }
+#endif
+
     return voicesRendered;
 }
 
+#ifdef _BLOCK_RENDER
+/*----------------------------------------------------------------------------
+ * VMStolenVoices()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks for stolen voices waiting to restart with their new note
+ *
+ * Inputs:
+ * pVoiceMgr        - pointer to voice manager
+ *
+ * Outputs:
+ * EAS_TRUE if any voice is stolen
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL VMStolenVoices (S_VOICE_MGR *pVoiceMgr)
+{
+    EAS_INT voiceNum;
+
+    for (voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, 0); voiceNum < MAX_SYNTH_VOICES; voiceNum = VMNextVoice(pVoiceMgr->activeVoiceMask, voiceNum + 1))
+        if (pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateStolen)
+            return EAS_TRUE;
+    return EAS_FALSE;
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * VMRender()
  *----------------------------------------------------------------------------
  * Purpose:
- * This routine renders a frame of audio
+ * This routine renders a frame of audio, or with _BLOCK_RENDER a block
+ * of whole frames
  *
  * Inputs:
  * psEASData        - pointer to overall EAS data structure
@@ -2857,6 +4350,7 @@ EAS_RESULT VMRender (S_VOICE_MGR *pVoiceMgr, EAS_I32 numSamples, EAS_I32 *pMixBu
     S_SYNTH *pSynth;
     EAS_INT i;
     EAS_INT channel;
+    EAS_U32 dirty;
 
 #ifdef _CHECKED_BUILD
     SanityCheck(pVoiceMgr);
@@ -2870,8 +4364,31 @@ EAS_RESULT VMRender (S_VOICE_MGR *pVoiceMgr, EAS_I32 numSamples, EAS_I32 *pMixBu
             VMUpdateStaticChannelParameters(pVoiceMgr, pVoiceMgr->pSynth[i]);
     }
 
+    EAS_TRACE_BEGIN("VMAddSamples");
+#ifdef _BLOCK_RENDER
+    /* a stolen voice restarts at the first frame boundary after it has faded out,
+     * so while any are fading the block is synthesized a frame at a time */
+    if ((numSamples > VM_UPDATE_PERIOD(pVoiceMgr)) && VMStolenVoices(pVoiceMgr))
+    {
+        EAS_I32 offset;
+
+        for (offset = 0; offset < numSamples; offset += VM_UPDATE_PERIOD(pVoiceMgr))
+        {
+            i = VMAddSamples(pVoiceMgr, &pMixBuffer[offset * NUM_OUTPUT_CHANNELS], VM_UPDATE_PERIOD(pVoiceMgr));
+            if (i > *pVoicesRendered)
+                *pVoicesRendered = i;
+        }
+    }
+    else
+#endif
     /* synthesize a buffer of audio */
     *pVoicesRendered = VMAddSamples(pVoiceMgr, pMixBuffer, numSamples);
+    EAS_TRACE_END();
+
+#ifdef _LOW_LATENCY
+    /* the next slice continues the update period */
+    pVoiceMgr->slicePos = (pVoiceMgr->slicePos + numSamples) % VM_UPDATE_PERIOD(pVoiceMgr);
+#endif
 
     /*
      * check for deferred note-off messages
@@ -2909,9 +4426,11 @@ EAS_RESULT VMRender (S_VOICE_MGR *pVoiceMgr, EAS_I32 numSamples, EAS_I32 *pMixBu
             pSynth->synthFlags &= ~SYNTH_FLAG_RESET_IS_REQUESTED;
         }
 
-        /* clear channel update flags */
-        for (channel = 0; channel < NUM_SYNTH_CHANNELS; channel++)
-            pSynth->channels[channel].channelFlags &= ~CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS;
+        /* clear channel update flags of the channels on the dirty list */
+        for (channel = 0, dirty = pSynth->dirtyChannels; dirty != 0; channel++, dirty >>= 1)
+            if (dirty & 1)
+                pSynth->channels[channel].channelFlags &= ~CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS;
+        pSynth->dirtyChannels = 0;
 
         }
 
@@ -2926,7 +4445,7 @@ EAS_RESULT VMRender (S_VOICE_MGR *pVoiceMgr, EAS_I32 numSamples, EAS_I32 *pMixBu
  * VMInitWorkload()
  *----------------------------------------------------------------------------
  * Purpose:
- * Clears the workload counter
+ * Clears the workload and stolen voice counters
  *
  * Inputs:
  * pVoiceMgr            - pointer to instance data
@@ -2940,6 +4459,7 @@ EAS_RESULT VMRender (S_VOICE_MGR *pVoiceMgr, EAS_I32 numSamples, EAS_I32 *pMixBu
 void VMInitWorkload (S_VOICE_MGR *pVoiceMgr)
 {
     pVoiceMgr->workload = 0;
+    pVoiceMgr->numStolenVoices = 0;
 }
 
 /*----------------------------------------------------------------------------
@@ -3002,9 +4522,108 @@ EAS_BOOL VMCheckWorkload (S_VOICE_MGR *pVoiceMgr)
 */
 EAS_I32 VMActiveVoices (S_SYNTH *pSynth)
 {
+    /* metadata probes have no synth */
+    if (pSynth == NULL)
+        return 0;
     return pSynth->numActiveVoices;
 }
 
+#ifdef _CHORUS_ENABLED
+/*----------------------------------------------------------------------------
+ * VMChorusSend()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the largest chorus send of the channels that have voices, the
+ * chorus effect is idle while it is zero.
+ *
+ * Inputs:
+ * pVoiceMgr        pointer to the voice manager
+ *
+ * Outputs:
+ * chorus send, 0 to 127
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_U8 VMChorusSend (S_VOICE_MGR *pVoiceMgr)
+{
+    S_SYNTH *pSynth;
+    EAS_INT vSynthNum;
+    EAS_INT channel;
+    EAS_INT i;
+    EAS_U8 send;
+
+    send = 0;
+    for (vSynthNum = 0; vSynthNum < VM_NUM_SYNTHS(pVoiceMgr); vSynthNum++)
+    {
+        pSynth = pVoiceMgr->pSynth[vSynthNum];
+        if ((pSynth == NULL) || (pSynth->numActiveVoices == 0))
+            continue;
+        for (channel = 0; channel < NUM_SYNTH_CHANNELS; channel++)
+        {
+            if (pSynth->channels[channel].chorusSend <= send)
+                continue;
+            for (i = 0; i < VOICE_MASK_WORDS; i++)
+            {
+                if (pVoiceMgr->channelVoiceMask[VSynthToChannel(pSynth, (EAS_U8) channel)][i])
+                {
+                    send = pSynth->channels[channel].chorusSend;
+                    break;
+                }
+            }
+        }
+    }
+    return send;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * VMShedPriority()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the steal priority of a voice when reducing polyphony. Higher
+ * values are muted first.
+ *
+ * Inputs:
+ * pVoiceMgr        pointer to the voice manager
+ * pSynth           pointer to the virtual synth of the voice
+ * voiceNum         the voice
+ *
+ * Outputs:
+ * steal priority
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 VMShedPriority (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_INT voiceNum)
+{
+    S_SYNTH_VOICE *pVoice = &pVoiceMgr->voices[voiceNum];
+    S_STOLEN_VOICE *pStolen = &pVoiceMgr->stolenVoices[voiceNum];
+    EAS_I32 currentPriority;
+
+    /* if voice is stolen or just started, reduce the likelihood it will be stolen */
+    if (( pVoice->voiceState == eVoiceStateStolen) || (pVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET))
+    {
+        /* include velocity */
+        currentPriority = 128 - pStolen->velocity;
+
+        /* include channel priority */
+        currentPriority += pSynth->channels[GET_CHANNEL(pStolen->channel)].pool << CHANNEL_PRIORITY_STEAL_WEIGHT;
+    }
+    else
+    {
+        /* include age */
+        currentPriority = (EAS_I32) pVoice->age << NOTE_AGE_STEAL_WEIGHT;
+
+        /* include note gain -higher gain is lower steal value */
+        /*lint -e{704} use shift for performance */
+        currentPriority += ((32768 >> (12 - NOTE_GAIN_STEAL_WEIGHT)) + 256) -
+            ((EAS_I32) pVoice->gain >> (12 - NOTE_GAIN_STEAL_WEIGHT));
+
+        /* include channel priority */
+        currentPriority += pSynth->channels[GET_CHANNEL(pStolen->channel)].pool << CHANNEL_PRIORITY_STEAL_WEIGHT;
+    }
+    return currentPriority;
+}
+
 /*----------------------------------------------------------------------------
  * VMSetPolyphony()
  *----------------------------------------------------------------------------
@@ -3034,7 +4653,7 @@ EAS_RESULT VMSetPolyphony (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 poly
         return EAS_ERROR_PARAMETER_RANGE;
 
     /* zero is max polyphony */
-    if ((polyphonyCount == 0) || (polyphonyCount > MAX_SYNTH_VOICES))
+    if ((polyphonyCount == 0) || (polyphonyCount > VM_NUM_VOICES(pVoiceMgr)))
     {
         pSynth->maxPolyphony = 0;
         return EAS_SUCCESS;
@@ -3059,10 +4678,10 @@ EAS_RESULT VMSetPolyphony (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 poly
 
     /* count the number of active voices */
     activeVoices = 0;
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = 0; i < VM_NUM_VOICES(pVoiceMgr); i++)
     {
         /* this synth? */
-        if (GET_VSYNTH(pVoiceMgr->voices[i].nextChannel) != pSynth->vSynthNum)
+        if (GET_VSYNTH(pVoiceMgr->stolenVoices[i].channel) != pSynth->vSynthNum)
             continue;
 
         /* is voice active? */
@@ -3073,42 +4692,17 @@ EAS_RESULT VMSetPolyphony (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 poly
     /* we may have to mute voices to reach new target */
     while (activeVoices > polyphonyCount)
     {
-        S_SYNTH_VOICE *pVoice;
         EAS_I32 currentPriority, bestPriority;
         EAS_INT bestCandidate;
 
         /* find the lowest priority voice */
         bestPriority = bestCandidate = -1;
-        for (i = 0; i < MAX_SYNTH_VOICES; i++)
+        for (i = 0; i < VM_NUM_VOICES(pVoiceMgr); i++)
         {
-            pVoice = &pVoiceMgr->voices[i];
-
             /* this synth? */
-            if (GET_VSYNTH(pVoice->nextChannel) != pSynth->vSynthNum)
+            if (GET_VSYNTH(pVoiceMgr->stolenVoices[i].channel) != pSynth->vSynthNum)
                 continue;
-
-            /* if voice is stolen or just started, reduce the likelihood it will be stolen */
-            if (( pVoice->voiceState == eVoiceStateStolen) || (pVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET))
-            {
-                /* include velocity */
-                currentPriority = 128 - pVoice->nextVelocity;
-
-                /* include channel priority */
-                currentPriority += pSynth->channels[GET_CHANNEL(pVoice->nextChannel)].pool << CHANNEL_PRIORITY_STEAL_WEIGHT;
-            }
-            else
-            {
-                /* include age */
-                currentPriority = (EAS_I32) pVoice->age << NOTE_AGE_STEAL_WEIGHT;
-
-                /* include note gain -higher gain is lower steal value */
-                /*lint -e{704} use shift for performance */
-                currentPriority += ((32768 >> (12 - NOTE_GAIN_STEAL_WEIGHT)) + 256) -
-                    ((EAS_I32) pVoice->gain >> (12 - NOTE_GAIN_STEAL_WEIGHT));
-
-                /* include channel priority */
-                currentPriority += pSynth->channels[GET_CHANNEL(pVoice->nextChannel)].pool << CHANNEL_PRIORITY_STEAL_WEIGHT;
-            }
+            currentPriority = VMShedPriority(pVoiceMgr, pSynth, i);
 
             /* is this the best choice so far? */
             if (currentPriority > bestPriority)
@@ -3133,6 +4727,162 @@ EAS_RESULT VMSetPolyphony (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 poly
     return EAS_SUCCESS;
 }
 
+#ifdef _CPU_BUDGET
+/*----------------------------------------------------------------------------
+ * VMLimitPolyphony()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the voice manager polyphony for the CPU budget. SP-MIDI synths
+ * mute channels according to their MIP table; any voices still over the
+ * limit are then muted lowest priority first, as VMSetPolyphony does.
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ * polyphony            - new voice limit
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void VMLimitPolyphony (S_VOICE_MGR *pVoiceMgr, EAS_INT polyphony)
+{
+    S_SYNTH_VOICE *pVoice;
+    S_SYNTH *pSynth;
+    EAS_I32 currentPriority;
+    EAS_I32 bestPriority;
+    EAS_INT bestCandidate;
+    EAS_INT activeVoices;
+    EAS_INT i;
+
+    pVoiceMgr->maxPolyphony = (EAS_U16) polyphony;
+    for (i = 0; i < MAX_VIRTUAL_SYNTHESIZERS; i++)
+        if ((pVoiceMgr->pSynth[i] != NULL) && (pVoiceMgr->pSynth[i]->synthFlags & SYNTH_FLAG_SP_MIDI_ON))
+            VMMIPUpdateChannelMuting(pVoiceMgr, pVoiceMgr->pSynth[i]);
+
+    /* count the voices that are still sounding */
+    activeVoices = 0;
+    for (i = 0; i < VM_NUM_VOICES(pVoiceMgr); i++)
+        if ((pVoiceMgr->voices[i].voiceState != eVoiceStateFree) && (pVoiceMgr->voices[i].voiceState != eVoiceStateMuting))
+            activeVoices++;
+
+    /* mute the lowest priority voices to reach the new limit */
+    while (activeVoices > polyphony)
+    {
+        bestPriority = bestCandidate = -1;
+        for (i = 0; i < VM_NUM_VOICES(pVoiceMgr); i++)
+        {
+            pVoice = &pVoiceMgr->voices[i];
+            if ((pVoice->voiceState == eVoiceStateFree) || (pVoice->voiceState == eVoiceStateMuting))
+                continue;
+            pSynth = pVoiceMgr->pSynth[GET_VSYNTH(pVoiceMgr->stolenVoices[i].channel)];
+            if (pSynth == NULL)
+                continue;
+
+            currentPriority = VMShedPriority(pVoiceMgr, pSynth, i);
+            if (currentPriority > bestPriority)
+            {
+                bestPriority = currentPriority;
+                bestCandidate = i;
+            }
+        }
+        if (bestCandidate < 0)
+            break;
+
+        VMMuteVoice(pVoiceMgr, bestCandidate);
+        activeVoices--;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * VMSetCPUBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the time in microseconds each frame may take. Zero turns the
+ * budget off and restores full polyphony.
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ * budget               - microseconds per frame
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMSetCPUBudget (S_VOICE_MGR *pVoiceMgr, EAS_I32 budget)
+{
+    if ((budget < 0) || (budget > CPU_BUDGET_MAX))
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    pVoiceMgr->cpuBudget = budget;
+    pVoiceMgr->voiceCost = 0;
+    pVoiceMgr->frameOverhead = 0;
+    if ((budget == 0) && (pVoiceMgr->maxPolyphony != VM_NUM_VOICES(pVoiceMgr)))
+        VMLimitPolyphony(pVoiceMgr, VM_NUM_VOICES(pVoiceMgr));
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * VMUpdateCPUBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adjusts the polyphony after a frame so the next frames fit the budget.
+ * The frame time is modeled as a fixed overhead plus a cost per rendered
+ * voice, both smoothed over about eight frames. Polyphony drops at
+ * once when the budget is exceeded and recovers one voice per frame.
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ * frameTime            - microseconds taken by the frame
+ * renderTime           - microseconds of frameTime spent rendering voices
+ * voicesRendered       - voices rendered in the frame
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMUpdateCPUBudget (S_VOICE_MGR *pVoiceMgr, EAS_U32 frameTime, EAS_U32 renderTime, EAS_I32 voicesRendered)
+{
+    EAS_I32 sample;
+    EAS_I32 polyphony;
+
+    if (pVoiceMgr->cpuBudget == 0)
+        return;
+    if (renderTime > frameTime)
+        renderTime = frameTime;
+
+    /* update the cost model, times are in 1/256 microseconds */
+    if (voicesRendered > 0)
+    {
+        /*lint -e{703} use shift for performance */
+        sample = (EAS_I32) (renderTime << 8) / voicesRendered;
+        if (pVoiceMgr->voiceCost == 0)
+            pVoiceMgr->voiceCost = sample;
+        else
+            /*lint -e{704} use shift for performance */
+            pVoiceMgr->voiceCost += (sample - pVoiceMgr->voiceCost) >> CPU_BUDGET_SMOOTHING;
+    }
+    /*lint -e{703} use shift for performance */
+    sample = (EAS_I32) ((frameTime - renderTime) << 8);
+    /*lint -e{704} use shift for performance */
+    pVoiceMgr->frameOverhead += (sample - pVoiceMgr->frameOverhead) >> CPU_BUDGET_SMOOTHING;
+    if (pVoiceMgr->voiceCost <= 0)
+        return;
+
+    /* voices that fit in what the overhead leaves of the budget */
+    /*lint -e{703} use shift for performance */
+    polyphony = ((pVoiceMgr->cpuBudget << 8) - pVoiceMgr->frameOverhead) / pVoiceMgr->voiceCost;
+    if (polyphony < CPU_BUDGET_MIN_VOICES)
+        polyphony = CPU_BUDGET_MIN_VOICES;
+    if (polyphony > VM_NUM_VOICES(pVoiceMgr))
+        polyphony = VM_NUM_VOICES(pVoiceMgr);
+
+    if (polyphony < pVoiceMgr->maxPolyphony)
+        VMLimitPolyphony(pVoiceMgr, polyphony);
+    else if (polyphony > pVoiceMgr->maxPolyphony + CPU_BUDGET_HYSTERESIS)
+        VMLimitPolyphony(pVoiceMgr, pVoiceMgr->maxPolyphony + 1);
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * VMSetPriority()
  *----------------------------------------------------------------------------
@@ -3190,7 +4940,7 @@ void VMSetVolume (S_SYNTH *pSynth, EAS_U16 masterVolume)
 */
 void VMSetPitchBendRange (S_SYNTH *pSynth, EAS_INT channel, EAS_I16 pitchBendRange)
 {
-    pSynth->channels[channel].pitchBendSensitivity = pitchBendRange;
+    pSynth->channelState[channel].pitchBendSensitivity = pitchBendRange;
 }
 
 /*----------------------------------------------------------------------------
@@ -3271,6 +5021,85 @@ EAS_RESULT VMSetEASLib (S_SYNTH *pSynth, EAS_SNDLIB_HANDLE pEAS)
     return EAS_SUCCESS;
 }
 
+/*----------------------------------------------------------------------------
+ * VMSetGlobalEASLib()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the EAS library given to synthesizers created from now on
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pEAS - sound library, NULL for the built-in library
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMSetGlobalEASLib (S_VOICE_MGR *pVoiceMgr, EAS_SNDLIB_HANDLE pEAS)
+{
+    EAS_RESULT result;
+
+    if (pEAS == NULL)
+        pEAS = (S_EAS*) &easSoundLib;
+    result = VMValidateEASLib(pEAS);
+    if (result != EAS_SUCCESS)
+        return result;
+
+    pVoiceMgr->pGlobalEAS = pEAS;
+    return EAS_SUCCESS;
+}
+
+#ifdef _EXTERNAL_SOUNDBANK
+/*----------------------------------------------------------------------------
+ * VMChangeEASLib()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Switches a synthesizer that is already playing to another sound library.
+ * Voices of the old library are stopped and every channel looks up its
+ * current program again in the new library.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pSynth - synthesizer to switch
+ * pEAS - sound library, NULL for the built-in library
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * voices playing on the synthesizer are cut off
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT VMChangeEASLib (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_SNDLIB_HANDLE pEAS)
+{
+    EAS_RESULT result;
+    EAS_INT i;
+
+    if (pEAS == NULL)
+        pEAS = (S_EAS*) &easSoundLib;
+    result = VMValidateEASLib(pEAS);
+    if (result != EAS_SUCCESS)
+        return result;
+
+    /* voices refer to regions of the old library, stop them now */
+    pVoiceMgr->activeVoices -= pSynth->numActiveVoices;
+    pSynth->numActiveVoices = 0;
+    VMInitializeAllVoices(pVoiceMgr, pSynth->vSynthNum);
+    for (i = 0; i < NUM_SYNTH_CHANNELS; i++)
+        pSynth->poolCount[i] = 0;
+
+    /* find each channel's program in the new library */
+    pSynth->pEAS = pEAS;
+    for (i = 0; i < NUM_SYNTH_CHANNELS; i++)
+        VMProgramChange(pVoiceMgr, pSynth, (EAS_U8) i, pSynth->channelState[i].programNum);
+    return EAS_SUCCESS;
+}
+#endif
+
 #ifdef DLS_SYNTHESIZER
 /*----------------------------------------------------------------------------
  * VMSetDLSLib()
@@ -3342,6 +5171,11 @@ void VMMIDIShutdown (S_EAS_DATA *pEASData, S_SYNTH *pSynth)
     if (--pSynth->refCount > 0)
         return;
 
+#ifdef _ASYNC_OPEN
+    /* a background open that fails shuts its synth down while the caller renders */
+    EAS_HWLock(pEASData->hwInstData);
+#endif
+
     vSynthNum = pSynth->vSynthNum;
 
     /* cleanup DLS load */
@@ -3358,12 +5192,20 @@ void VMMIDIShutdown (S_EAS_DATA *pEASData, S_SYNTH *pSynth)
 
     VMReset(pEASData->pVoiceMgr, pSynth, EAS_TRUE);
 
+#ifdef _INSERT_EFFECTS
+    EAS_InsertChainShutdown(pEASData, &pSynth->pInserts);
+#endif
+
     /* check Configuration Module for static memory allocation */
     if (!pEASData->staticMemoryModel)
         EAS_HWFree(pEASData->hwInstData, pSynth);
 
     /* clear pointer to MIDI state */
     pEASData->pVoiceMgr->pSynth[vSynthNum] = NULL;
+
+#ifdef _ASYNC_OPEN
+    EAS_HWUnlock(pEASData->hwInstData);
+#endif
 }
 
 /*----------------------------------------------------------------------------
@@ -3389,6 +5231,16 @@ void VMShutdown (S_EAS_DATA *pEASData)
     if (pEASData->pVoiceMgr == NULL)
         return;
 
+#ifdef _PARALLEL_VOICE_RENDER
+    /* stop the worker threads */
+    (void) VMSetRenderThreads(pEASData, 1);
+#endif
+
+#ifdef _STEM_OUTPUT
+    /* free the stem buffers */
+    (void) VMSetStemCount(pEASData, 0);
+#endif
+
 #ifdef DLS_SYNTHESIZER
     /* if we have a global DLS collection, clean it up */
     if (pEASData->pVoiceMgr->pGlobalDLS)
@@ -3427,9 +5279,9 @@ void VMRegExtAudioCallback (S_SYNTH *pSynth, EAS_VOID_PTR pInstData, EAS_EXT_PRG
 void VMGetMIDIControllers (S_SYNTH *pSynth, EAS_U8 channel, S_MIDI_CONTROLLERS *pControl)
 {
     pControl->modWheel = pSynth->channels[channel].modWheel;
-    pControl->volume = pSynth->channels[channel].volume;
+    pControl->volume = pSynth->channelState[channel].volume;
     pControl->pan = pSynth->channels[channel].pan;
-    pControl->expression = pSynth->channels[channel].expression;
+    pControl->expression = pSynth->channelState[channel].expression;
     pControl->channelPressure = pSynth->channels[channel].channelPressure;
 
 #ifdef _REVERB
@@ -3466,6 +5318,11 @@ EAS_BOOL VMStartFrame (S_EAS_DATA *pEASData)
     pVoiceMgr->numVoiceStarts = 0;
 #endif
 
+#ifdef EAS_SPLIT_WT_SYNTH
+    /* off-chip voices send their position in the frame instead of a pointer */
+    pEASData->pVoiceMgr->pFrameMixBuffer = pEASData->pMixBuffer;
+#endif
+
     return pFrameInterface->pfStartFrame(pEASData->pVoiceMgr->pFrameBuffer);
 }
 
@@ -3487,7 +5344,7 @@ EAS_BOOL VMStartFrame (S_EAS_DATA *pEASData)
 EAS_BOOL VMEndFrame (S_EAS_DATA *pEASData)
 {
 
-    return pFrameInterface->pfEndFrame(pEASData->pVoiceMgr->pFrameBuffer, pEASData->pMixBuffer, pEASData->masterGain);
+    return pFrameInterface->pfEndFrame(pEASData->hwInstData, pEASData->pVoiceMgr->pFrameBuffer, pEASData->pMixBuffer, pEASData->masterGain);
 }
 #endif
 
@@ -3517,7 +5374,7 @@ EAS_RESULT VMSanityCheck (EAS_DATA_HANDLE pEASData)
     freeVoices = activeVoices = playingVoices = stolenVoices = releasingVoices = mutingVoices = 0;
 
     /* iterate through all voices */
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = 0; i < VM_NUM_VOICES(pEASData->pVoiceMgr); i++)
     {
         pVoice = &pEASData->pVoiceMgr->voices[i];
         if (pVoice->voiceState != eVoiceStateFree)
@@ -3539,7 +5396,7 @@ EAS_RESULT VMSanityCheck (EAS_DATA_HANDLE pEASData)
                     break;
 
                 case eVoiceStateStolen:
-                    vSynthNum = GET_VSYNTH(pVoice->nextChannel);
+                    vSynthNum = GET_VSYNTH(pEASData->pVoiceMgr->stolenVoices[i].channel);
                     if (vSynthNum >= MAX_VIRTUAL_SYNTHESIZERS)
                     {
                         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "VMSanityCheck: Voice %d has invalid virtual synth number %d\n", i, vSynthNum); */ }
@@ -3549,7 +5406,7 @@ EAS_RESULT VMSanityCheck (EAS_DATA_HANDLE pEASData)
                     pSynth = pEASData->pVoiceMgr->pSynth[vSynthNum];
                     activeVoices++;
                     stolenVoices++;
-                    poolCount[vSynthNum][pSynth->channels[GET_CHANNEL(pVoice->nextChannel)].pool]++;
+                    poolCount[vSynthNum][pSynth->channels[GET_CHANNEL(pEASData->pVoiceMgr->stolenVoices[i].channel)].pool]++;
                     break;
 
                 case eVoiceStateStart:
@@ -3599,7 +5456,7 @@ EAS_RESULT VMSanityCheck (EAS_DATA_HANDLE pEASData)
             continue;
 
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "Synth %d numActiveVoices: %d\n", i, pEASData->pVoiceMgr->pSynth[i]->numActiveVoices); */ }
-        if (pEASData->pVoiceMgr->pSynth[i]->numActiveVoices > MAX_SYNTH_VOICES)
+        if (pEASData->pVoiceMgr->pSynth[i]->numActiveVoices > VM_NUM_VOICES(pEASData->pVoiceMgr))
         {
             { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "VMSanityCheck: Synth %d illegal count for numActiveVoices: %d\n", i, pEASData->pVoiceMgr->pSynth[i]->numActiveVoices); */ }
             result = EAS_FAILURE;
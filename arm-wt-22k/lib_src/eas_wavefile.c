@@ -0,0 +1,636 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_wavefile.c
+ *
+ * Contents and purpose:
+ * WAVE file parser. Finds the fmt and data chunks of a RIFF WAVE file and
+ * hands the audio to the PCM engine, which streams it from the file.
+ * Linear PCM and, with _IMA_DECODER, IMA ADPCM files are supported.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+/* allocations of this module are reported as parser state */
+#define EAS_MEM_CATEGORY    EAS_MEM_PARSERS
+
+#include "eas_data.h"
+#include "eas_parser.h"
+#include "eas_report.h"
+#include "eas_host.h"
+#include "eas_config.h"
+#include "eas_pcm.h"
+#include "eas_wavefiledata.h"
+
+/* RIFF chunk IDs, as read little-endian */
+#define WAVE_RIFF_ID            0x46464952  /* "RIFF" */
+#define WAVE_WAVE_ID            0x45564157  /* "WAVE" */
+#define WAVE_FMT_ID             0x20746d66  /* "fmt " */
+#define WAVE_DATA_ID            0x61746164  /* "data" */
+
+/* format tags */
+#define WAVE_FORMAT_PCM         0x0001
+#define WAVE_FORMAT_IMA_ADPCM   0x0011
+
+/* size of the fmt chunk fields that are read */
+#define WAVE_FMT_SIZE           16
+
+/* gives up on files with more chunks than this before the audio */
+#define WAVE_MAX_CHUNKS         64
+
+/* local prototypes */
+static EAS_RESULT WaveCheckFileType (S_EAS_DATA *pEASData, EAS_FILE_HANDLE fileHandle, EAS_VOID_PTR *ppHandle, EAS_I32 offset);
+static EAS_RESULT WavePrepare (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData);
+static EAS_RESULT WaveState (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_STATE *pState);
+static EAS_RESULT WaveClose (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData);
+static EAS_RESULT WaveReset (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData);
+static EAS_RESULT WavePause (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData);
+static EAS_RESULT WaveResume (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData);
+static EAS_RESULT WaveLocate (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 time, EAS_BOOL *pParserLocate);
+static EAS_RESULT WaveSetData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value);
+static EAS_RESULT WaveGetData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue);
+static EAS_RESULT WaveGetMetaData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 *pMediaLength);
+static EAS_RESULT WaveParseHeader (S_EAS_DATA *pEASData, S_WAVE_STATE *pData);
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_Wave_Parser
+ *
+ * This structure contains the functional interface for the WAVE parser.
+ * There is no time or event function, the stream time is advanced by the
+ * render loop while the PCM engine plays the audio.
+ *----------------------------------------------------------------------------
+*/
+const S_FILE_PARSER_INTERFACE EAS_Wave_Parser =
+{
+    WaveCheckFileType,
+    WavePrepare,
+    NULL,
+    NULL,
+    WaveState,
+    WaveClose,
+    WaveReset,
+#ifdef JET_INTERFACE
+    WavePause,
+    WaveResume,
+#else
+    NULL,
+    NULL,
+#endif
+    WaveLocate,
+    WaveSetData,
+    WaveGetData,
+    WaveGetMetaData
+};
+
+/*----------------------------------------------------------------------------
+ * WaveCheckFileType()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Check the file type to see if we can parse it
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WaveCheckFileType (S_EAS_DATA *pEASData, EAS_FILE_HANDLE fileHandle, EAS_VOID_PTR *ppHandle, EAS_I32 offset)
+{
+    S_WAVE_STATE data;
+    S_WAVE_STATE *pData;
+
+    /* see if we can parse the header */
+    *ppHandle = NULL;
+    EAS_HWMemSet(&data, 0, sizeof(S_WAVE_STATE));
+    data.fileHandle = fileHandle;
+    data.fileOffset = offset;
+    if (WaveParseHeader(pEASData, &data) != EAS_SUCCESS)
+        return EAS_SUCCESS;
+
+    /* check for static memory allocation */
+    if (pEASData->staticMemoryModel)
+        pData = EAS_CMEnumData(EAS_CM_WAVE_DATA);
+    else
+        pData = EAS_HWMalloc(pEASData->hwInstData, sizeof(S_WAVE_STATE));
+    if (!pData)
+        return EAS_ERROR_MALLOC_FAILED;
+
+    /* return a pointer to the instance data */
+    EAS_HWMemCpy(pData, &data, sizeof(S_WAVE_STATE));
+    pData->volume = PCM_DEFAULT_GAIN_SETTING;
+    pData->state = EAS_STATE_OPEN;
+    *ppHandle = pData;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * WaveParseHeader()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Finds the fmt and data chunks and checks that the format can be played
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * pData            - instance data, fileHandle and fileOffset are set
+ *
+ * Outputs:
+ * returns EAS_SUCCESS if the file can be played
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WaveParseHeader (S_EAS_DATA *pEASData, S_WAVE_STATE *pData)
+{
+    EAS_HW_DATA_HANDLE hwInstData;
+    EAS_RESULT result;
+    EAS_U32 chunkID;
+    EAS_U32 chunkSize;
+    EAS_U32 sampleRate;
+    EAS_U32 frames;
+    EAS_U32 temp;
+    EAS_I32 fileLength;
+    EAS_I32 pos;
+    EAS_I32 end;
+    EAS_I32 remainder;
+    EAS_U16 formatTag;
+    EAS_U16 channels;
+    EAS_U16 blockAlign;
+    EAS_U16 bitsPerSample;
+    EAS_BOOL foundFmt;
+    EAS_INT count;
+
+    hwInstData = pEASData->hwInstData;
+
+    /* RIFF header */
+    if ((result = EAS_HWFileSeek(hwInstData, pData->fileHandle, pData->fileOffset)) != EAS_SUCCESS)
+        return result;
+    if ((result = EAS_HWGetDWord(hwInstData, pData->fileHandle, &chunkID, EAS_FALSE)) != EAS_SUCCESS)
+        return result;
+    if ((result = EAS_HWGetDWord(hwInstData, pData->fileHandle, &chunkSize, EAS_FALSE)) != EAS_SUCCESS)
+        return result;
+    if ((result = EAS_HWGetDWord(hwInstData, pData->fileHandle, &temp, EAS_FALSE)) != EAS_SUCCESS)
+        return result;
+    if ((chunkID != WAVE_RIFF_ID) || (temp != WAVE_WAVE_ID))
+        return EAS_ERROR_UNRECOGNIZED_FORMAT;
+
+    /* a RIFF size past the end of the file is common, the file length wins */
+    if ((result = EAS_HWFileLength(hwInstData, pData->fileHandle, &fileLength)) != EAS_SUCCESS)
+        return result;
+    end = pData->fileOffset + 8 + (EAS_I32) (chunkSize & 0x7ffffffe);
+    if ((end > fileLength) || (end < pData->fileOffset))
+        end = fileLength;
+
+    formatTag = channels = blockAlign = bitsPerSample = 0;
+    sampleRate = 0;
+    foundFmt = EAS_FALSE;
+    pos = pData->fileOffset + 12;
+    for (count = 0; (count < WAVE_MAX_CHUNKS) && (pos + 8 <= end); count++)
+    {
+        if ((result = EAS_HWFileSeek(hwInstData, pData->fileHandle, pos)) != EAS_SUCCESS)
+            return result;
+        if ((result = EAS_HWGetDWord(hwInstData, pData->fileHandle, &chunkID, EAS_FALSE)) != EAS_SUCCESS)
+            return result;
+        if ((result = EAS_HWGetDWord(hwInstData, pData->fileHandle, &chunkSize, EAS_FALSE)) != EAS_SUCCESS)
+            return result;
+        pos += 8;
+
+        if (chunkID == WAVE_FMT_ID)
+        {
+            if (chunkSize < WAVE_FMT_SIZE)
+                return EAS_ERROR_FILE_FORMAT;
+            if ((result = EAS_HWGetWord(hwInstData, pData->fileHandle, &formatTag, EAS_FALSE)) != EAS_SUCCESS)
+                return result;
+            if ((result = EAS_HWGetWord(hwInstData, pData->fileHandle, &channels, EAS_FALSE)) != EAS_SUCCESS)
+                return result;
+            if ((result = EAS_HWGetDWord(hwInstData, pData->fileHandle, &sampleRate, EAS_FALSE)) != EAS_SUCCESS)
+                return result;
+            if ((result = EAS_HWGetDWord(hwInstData, pData->fileHandle, &temp, EAS_FALSE)) != EAS_SUCCESS)
+                return result;
+            if ((result = EAS_HWGetWord(hwInstData, pData->fileHandle, &blockAlign, EAS_FALSE)) != EAS_SUCCESS)
+                return result;
+            if ((result = EAS_HWGetWord(hwInstData, pData->fileHandle, &bitsPerSample, EAS_FALSE)) != EAS_SUCCESS)
+                return result;
+            foundFmt = EAS_TRUE;
+        }
+
+        /* the audio must come after the format */
+        else if (chunkID == WAVE_DATA_ID)
+        {
+            if (!foundFmt)
+                return EAS_ERROR_FILE_FORMAT;
+            pData->audioOffset = pos;
+            pData->audioSize = end - pos;
+            if (chunkSize < (EAS_U32) pData->audioSize)
+                pData->audioSize = (EAS_I32) chunkSize;
+            break;
+        }
+
+        /* chunks are padded to an even size */
+        if (chunkSize > (EAS_U32) (end - pos))
+            break;
+        pos += (EAS_I32) ((chunkSize + 1) & ~1);
+    }
+    if (pData->audioOffset == 0)
+        return EAS_ERROR_FILE_FORMAT;
+
+    /* check the format */
+    if ((channels != 1) && (channels != 2))
+        return EAS_ERROR_INVALID_PCM_TYPE;
+    if ((sampleRate == 0) || (sampleRate > PCM_MAX_SAMPLE_RATE))
+        return EAS_ERROR_INVALID_PCM_TYPE;
+    pData->sampleRate = sampleRate;
+    pData->flags = (channels == 2) ? PCM_FLAGS_STEREO : 0;
+
+    switch (formatTag)
+    {
+        case WAVE_FORMAT_PCM:
+            if (bitsPerSample == 8)
+                pData->flags |= PCM_FLAGS_8_BIT | PCM_FLAGS_UNSIGNED;
+            else if (bitsPerSample != 16)
+                return EAS_ERROR_INVALID_PCM_TYPE;
+            pData->decoder = EAS_DECODER_PCM;
+            frames = (EAS_U32) pData->audioSize / ((bitsPerSample / 8) * (EAS_U32) channels);
+            break;
+
+#ifdef _IMA_DECODER
+        /* each block holds a header frame and two frames per byte per channel */
+        case WAVE_FORMAT_IMA_ADPCM:
+            if ((bitsPerSample != 4) || (blockAlign <= 4 * channels) || (blockAlign > PCM_FILE_BUFFER_SIZE))
+                return EAS_ERROR_INVALID_PCM_TYPE;
+            if ((channels == 2) && (blockAlign % 8))
+                return EAS_ERROR_INVALID_PCM_TYPE;
+            pData->decoder = EAS_DECODER_IMA_ADPCM;
+            pData->blockAlign = blockAlign;
+            frames = ((EAS_U32) pData->audioSize / blockAlign) * ((blockAlign - 4 * channels) * 2 / channels + 1);
+            remainder = pData->audioSize % blockAlign;
+            if (remainder >= 4 * channels)
+            {
+                if (channels == 2)
+                    remainder -= (remainder - 8) % 8;
+                frames += (EAS_U32) (remainder - 4 * channels) * 2 / channels + 1;
+            }
+            break;
+#endif
+
+        default:
+            return EAS_ERROR_INVALID_PCM_TYPE;
+    }
+
+    pData->mediaLength = (EAS_I32) ((frames / sampleRate) * 1000 + ((frames % sampleRate) * 1000) / sampleRate);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * WavePrepare()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Opens the PCM engine stream for the audio
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WavePrepare (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
+{
+    S_WAVE_STATE *pData;
+    S_PCM_OPEN_PARAMS params;
+    EAS_RESULT result;
+
+    /* check for valid state */
+    pData = (S_WAVE_STATE*) pInstData;
+    if (pData->state != EAS_STATE_OPEN)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+
+    params.fileHandle = pData->fileHandle;
+    params.decoder = pData->decoder;
+    params.sampleRate = pData->sampleRate;
+    params.startPos = pData->audioOffset;
+    params.size = pData->audioSize;
+    params.blockSize = pData->blockAlign;
+    params.flags = pData->flags;
+    params.volume = pData->volume;
+    if ((result = EAS_PEOpenStream(pEASData, &params, &pData->pcmHandle)) != EAS_SUCCESS)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "EAS_PEOpenStream returned %d\n", result); */ }
+        pData->state = EAS_STATE_ERROR;
+        return result;
+    }
+
+    pData->state = EAS_STATE_READY;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * WaveState()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the current state of the stream
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ * pState           - pointer to variable to store state
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WaveState (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_STATE *pState)
+{
+    S_WAVE_STATE *pData;
+
+    /* the PCM engine has the state once the stream is open */
+    pData = (S_WAVE_STATE*) pInstData;
+    if (pData->pcmHandle != NULL)
+        return EAS_PEState(pEASData, pData->pcmHandle, pState);
+    *pState = pData->state;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * WaveClose()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Close the file and clean up
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WaveClose (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
+{
+    S_WAVE_STATE *pData;
+    EAS_RESULT result;
+
+    pData = (S_WAVE_STATE*) pInstData;
+
+    /* free the PCM stream */
+    if (pData->pcmHandle != NULL)
+    {
+        if ((result = EAS_PECloseStream(pEASData, pData->pcmHandle)) != EAS_SUCCESS)
+            return result;
+        pData->pcmHandle = NULL;
+    }
+
+    /* close the file */
+    if ((result = EAS_HWCloseFile(pEASData->hwInstData, pData->fileHandle)) != EAS_SUCCESS)
+        return result;
+
+    /* if using dynamic memory, free it */
+    if (!pEASData->staticMemoryModel)
+        EAS_HWFree(pEASData->hwInstData, pData);
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * WaveReset()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reset the stream to the start of the audio
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WaveReset (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
+{
+    S_WAVE_STATE *pData;
+
+    pData = (S_WAVE_STATE*) pInstData;
+    if (pData->pcmHandle == NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    return EAS_PEReset(pEASData, pData->pcmHandle);
+}
+
+/*----------------------------------------------------------------------------
+ * WavePause()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Pauses the stream
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WavePause (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
+{
+    S_WAVE_STATE *pData;
+
+    pData = (S_WAVE_STATE*) pInstData;
+    if (pData->pcmHandle == NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    return EAS_PEPause(pEASData, pData->pcmHandle);
+}
+
+/*----------------------------------------------------------------------------
+ * WaveResume()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Resume playing after a pause
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WaveResume (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
+{
+    S_WAVE_STATE *pData;
+
+    pData = (S_WAVE_STATE*) pInstData;
+    if (pData->pcmHandle == NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    return EAS_PEResume(pEASData, pData->pcmHandle);
+}
+
+/*----------------------------------------------------------------------------
+ * WaveLocate()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Moves the stream without parsing up to the new time, the PCM engine seeks
+ * to the block holding it
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ * time             - new time in milliseconds
+ *
+ * Outputs:
+ * pParserLocate    - EAS_FALSE, the caller does not parse the file
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WaveLocate (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 time, EAS_BOOL *pParserLocate)
+{
+    S_WAVE_STATE *pData;
+
+    pData = (S_WAVE_STATE*) pInstData;
+    *pParserLocate = EAS_FALSE;
+    if (pData->pcmHandle == NULL)
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    return EAS_PELocate(pEASData, pData->pcmHandle, time);
+}
+
+/*----------------------------------------------------------------------------
+ * WaveSetData()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Set the stream parameters
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WaveSetData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value)
+{
+    S_WAVE_STATE *pData;
+
+    pData = (S_WAVE_STATE*) pInstData;
+    switch (param)
+    {
+        /* set the gain, the PCM engine ramps to it */
+        case PARSER_DATA_VOLUME:
+            pData->volume = (EAS_I16) value;
+            if (pData->pcmHandle != NULL)
+                return EAS_PEUpdateVolume(pEASData, pData->pcmHandle, (EAS_I16) value);
+            break;
+
+        /* set metadata callback */
+        case PARSER_DATA_METADATA_CB:
+            EAS_HWMemCpy(&pData->metadata, (void*) value, sizeof(S_METADATA_CB));
+            break;
+
+        default:
+            return EAS_ERROR_INVALID_PARAMETER;
+    }
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * WaveGetData()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Retrieves the stream parameters
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WaveGetData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue)
+{
+    S_WAVE_STATE *pData;
+
+    pData = (S_WAVE_STATE*) pInstData;
+    switch (param)
+    {
+        /* return file type as WAVE */
+        case PARSER_DATA_FILE_TYPE:
+            *pValue = (pData->decoder == EAS_DECODER_IMA_ADPCM) ? EAS_FILE_WAVE_IMA_ADPCM : EAS_FILE_WAVE_PCM;
+            break;
+
+        default:
+            return EAS_ERROR_INVALID_PARAMETER;
+    }
+
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * WaveGetMetaData()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the play length, found from the size of the data chunk
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ *
+ * Outputs:
+ * pMediaLength     - play length in milliseconds
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT WaveGetMetaData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 *pMediaLength)
+{
+    *pMediaLength = ((S_WAVE_STATE*) pInstData)->mediaLength;
+    return EAS_SUCCESS;
+}
+
@@ -0,0 +1,58 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_wavefiledata.h
+ *
+ * Contents and purpose:
+ * Data declarations for the WAVE file parser
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef EAS_WAVEFILEDATA_H
+#define EAS_WAVEFILEDATA_H
+
+#include "eas_data.h"
+#include "eas_parser.h"
+#include "eas_pcm.h"
+
+/*----------------------------------------------------------------------------
+ * S_WAVE_STATE
+ *
+ * Instance data for the WAVE parser. The audio is played by the PCM engine,
+ * the parser only finds it in the file and forwards the stream controls.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_wave_state_tag
+{
+    EAS_FILE_HANDLE     fileHandle;         /* file handle */
+    EAS_PCM_HANDLE      pcmHandle;          /* PCM engine stream, NULL until prepared */
+    S_METADATA_CB       metadata;           /* metadata callback */
+    EAS_I32             fileOffset;         /* offset of the RIFF header in the file */
+    EAS_I32             audioOffset;        /* file position of the data chunk contents */
+    EAS_I32             audioSize;          /* bytes of audio in the data chunk */
+    EAS_I32             mediaLength;        /* play length in milliseconds */
+    EAS_U32             sampleRate;         /* sample rate of the audio */
+    EAS_U32             flags;              /* PCM_FLAGS_XXX */
+    EAS_I32             blockAlign;         /* ADPCM block size */
+    E_DECODER_MODULES   decoder;            /* audio format */
+    EAS_STATE           state;              /* state before the PCM stream is opened */
+    EAS_I16             volume;             /* stream gain */
+} S_WAVE_STATE;
+
+#endif
+
@@ -69,6 +69,10 @@ typedef struct s_wt_config_tag
     EAS_U32             loopEnd;                /* points to last PCM sample (not 1 beyond last) */
     EAS_U32             loopStart;              /* points to first sample at start of loop */
     EAS_U32             phaseAccum;             /* current sample, integer portion of phase */
+    EAS_U32             phaseFrac;              /* fractional portion of phase */
+#ifdef _CUBIC_INTERPOLATION
+    EAS_U32             sampleStart;            /* points to first PCM sample */
+#endif
 
 #if (NUM_OUTPUT_CHANNELS == 2)
     EAS_I16             gainLeft;               /* left channel gain */
@@ -78,5 +82,57 @@ typedef struct s_wt_config_tag
     EAS_I16             gain;                   /* current voice gain */
 } S_WT_CONFIG;
 
+/*----------------------------------------------------------------------------
+ * S_WT_PROCESS
+ *
+ * This structure contains the parameters for synthesizing one block of
+ * an off-chip voice. The samples are added to the engine's mix of the
+ * audio frame starting at mixOffset.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_wt_process_tag
+{
+    S_WT_FRAME          frame;
+    EAS_I32             prevGain;               /* gain at the start of the block */
+    EAS_I32             numSamples;
+    EAS_I32             mixOffset;              /* first sample of the block in the frame */
+
+#ifdef _RUNTIME_SAMPLE_RATE
+    EAS_I32             rateShift;
+#endif
+#ifdef _CUBIC_INTERPOLATION
+    EAS_BOOL            cubic;                  /* use the 4 point interpolator */
+#endif
+#ifdef _LOW_LATENCY
+    EAS_I32             rampOffset;             /* samples of the gain ramp done by earlier slices */
+#endif
+#if defined(_FILTER_ENABLED) && defined(_FILTER_RAMP)
+    EAS_I32             k;                      /* filter coefficients of the last update period */
+    EAS_I32             b1;
+    EAS_I32             b2;
+#endif
+} S_WT_PROCESS;
+
+/*----------------------------------------------------------------------------
+ * S_WT_MESSAGE
+ *
+ * A message from the voice manager to the wavetable engine
+ *----------------------------------------------------------------------------
+*/
+#define WT_MSG_CONFIG               1           /* start a voice */
+#define WT_MSG_PROCESS              2           /* synthesize a block of a voice */
+#define WT_MSG_END_FRAME            3           /* the audio frame is complete */
+
+typedef struct s_wt_message_tag
+{
+    EAS_U32             type;
+    EAS_I32             voiceNum;               /* off-chip voice number, 0 is the first */
+    union
+    {
+        S_WT_CONFIG     config;
+        S_WT_PROCESS    process;
+    } u;
+} S_WT_MESSAGE;
+
 #endif
 
@@ -32,21 +32,25 @@
  * includes
  *------------------------------------
 */
-#include "log/log.h"
-#include <cutils/log.h>
-
 #include "eas_types.h"
 #include "eas_math.h"
 #include "eas_audioconst.h"
 #include "eas_sndlib.h"
 #include "eas_wtengine.h"
 #include "eas_mixer.h"
+#include "eas_diag.h"
+#ifdef _TONE_GENERATORS
+#include <stdint.h>
+#endif
 
 /*----------------------------------------------------------------------------
  * prototypes
  *----------------------------------------------------------------------------
 */
 extern void WT_NoiseGenerator (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame);
+#ifdef _TONE_GENERATORS
+static void WT_SquareGenerator (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame);
+#endif
 extern void WT_VoiceGain (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame);
 
 #if defined(_OPTIMIZED_MONO)
@@ -64,7 +68,163 @@ extern void WT_VoiceFilter (S_FILTER_CONTROL*pFilter, S_WT_INT_FRAME *pWTIntFram
 #undef  NO_INT_OVERFLOW_CHECKS
 #define NO_INT_OVERFLOW_CHECKS __attribute__((no_sanitize("integer")))
 
+/* fused voice kernels replace the separate interpolate, filter and gain passes */
+#if defined(_WT_FUSED_KERNEL) && !defined(_OPTIMIZED_MONO) && !defined(UNIFIED_MIXER) && (!defined(NATIVE_EAS_KERNEL) || defined(_16_BIT_SAMPLES))
+#define WT_FUSED_KERNELS
+#endif
+
+/*----------------------------------------------------------------------------
+ * Vector kernels
+ *
+ * The stereo voice gain stage is vectorized with NEON or SSE2 intrinsics
+ * when the target always provides them. Define _NO_SIMD_KERNEL to force
+ * the C reference code, the output is bit-exact either way.
+ *----------------------------------------------------------------------------
+*/
+#if !defined(_NO_SIMD_KERNEL) && !defined(_OPTIMIZED_MONO) && (NUM_OUTPUT_CHANNELS == 2)
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define _NEON_KERNEL
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#define _SSE2_KERNEL
+#include <emmintrin.h>
+#endif
+#endif
+
 #if defined(_OPTIMIZED_MONO) || !defined(NATIVE_EAS_KERNEL) || defined(_16_BIT_SAMPLES)
+#if defined(_NEON_KERNEL)
+/*----------------------------------------------------------------------------
+ * WT_VoiceGainVector
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * NEON version of the stereo WT_VoiceGain loop, four samples at a time
+ *
+ * Inputs:
+ * numSamples must be a multiple of four
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void WT_VoiceGainVector (const EAS_PCM *pInputBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSamples,
+    EAS_I32 gain, EAS_I32 gainIncrement, EAS_I32 gainLeft, EAS_I32 gainRight)
+{
+    int32x4_t vGain;
+    int32x4_t vGainIncrement;
+    int32x4_t vTmp;
+    int32x4_t vLeft;
+    int32x4_t vRight;
+    int32x4x2_t vOut;
+    int32_t gains[4];
+
+    gains[0] = (int32_t) (gain + gainIncrement);
+    gains[1] = (int32_t) (gain + 2 * gainIncrement);
+    gains[2] = (int32_t) (gain + 3 * gainIncrement);
+    gains[3] = (int32_t) (gain + 4 * gainIncrement);
+    vGain = vld1q_s32(gains);
+    vGainIncrement = vdupq_n_s32((int32_t) (4 * gainIncrement));
+
+    for (; numSamples > 0; numSamples -= 4)
+    {
+        /* scale samples by gain */
+        vTmp = vmulq_s32(vshrq_n_s32(vGain, 16), vmovl_s16(vld1_s16(pInputBuffer)));
+        vTmp = vshrq_n_s32(vTmp, 14);
+        vGain = vaddq_s32(vGain, vGainIncrement);
+        pInputBuffer += 4;
+
+        /* left and right channels, interleaved */
+        vLeft = vshrq_n_s32(vmulq_n_s32(vTmp, (int32_t) gainLeft), NUM_MIXER_GUARD_BITS);
+        vRight = vshrq_n_s32(vmulq_n_s32(vTmp, (int32_t) gainRight), NUM_MIXER_GUARD_BITS);
+        vOut = vzipq_s32(vLeft, vRight);
+
+        /* accumulate into the final mix buffer */
+#if defined(__LP64__)
+        vst1q_s64((int64_t*) pMixBuffer, vaddw_s32(vld1q_s64((const int64_t*) pMixBuffer), vget_low_s32(vOut.val[0])));
+        vst1q_s64((int64_t*) pMixBuffer + 2, vaddw_s32(vld1q_s64((const int64_t*) pMixBuffer + 2), vget_high_s32(vOut.val[0])));
+        vst1q_s64((int64_t*) pMixBuffer + 4, vaddw_s32(vld1q_s64((const int64_t*) pMixBuffer + 4), vget_low_s32(vOut.val[1])));
+        vst1q_s64((int64_t*) pMixBuffer + 6, vaddw_s32(vld1q_s64((const int64_t*) pMixBuffer + 6), vget_high_s32(vOut.val[1])));
+#else
+        vst1q_s32((int32_t*) pMixBuffer, vaddq_s32(vld1q_s32((const int32_t*) pMixBuffer), vOut.val[0]));
+        vst1q_s32((int32_t*) pMixBuffer + 4, vaddq_s32(vld1q_s32((const int32_t*) pMixBuffer + 4), vOut.val[1]));
+#endif
+        pMixBuffer += 8;
+    }
+}
+#endif
+
+#if defined(_SSE2_KERNEL)
+/* low 32 bits of a 32 x 32 bit multiply, the same for signed and unsigned */
+EAS_INLINE __m128i WT_MulLo32 (__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/* add four 32-bit values to the mix buffer */
+EAS_INLINE void WT_MixAccumulate (EAS_I32 *pMixBuffer, __m128i v)
+{
+#if defined(__LP64__)
+    __m128i sign = _mm_srai_epi32(v, 31);
+    _mm_storeu_si128((__m128i*) pMixBuffer, _mm_add_epi64(_mm_loadu_si128((const __m128i*) pMixBuffer), _mm_unpacklo_epi32(v, sign)));
+    _mm_storeu_si128((__m128i*) pMixBuffer + 1, _mm_add_epi64(_mm_loadu_si128((const __m128i*) pMixBuffer + 1), _mm_unpackhi_epi32(v, sign)));
+#else
+    _mm_storeu_si128((__m128i*) pMixBuffer, _mm_add_epi32(_mm_loadu_si128((const __m128i*) pMixBuffer), v));
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * WT_VoiceGainVector
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * SSE2 version of the stereo WT_VoiceGain loop, four samples at a time
+ *
+ * Inputs:
+ * numSamples must be a multiple of four
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void WT_VoiceGainVector (const EAS_PCM *pInputBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSamples,
+    EAS_I32 gain, EAS_I32 gainIncrement, EAS_I32 gainLeft, EAS_I32 gainRight)
+{
+    __m128i vGain;
+    __m128i vGainIncrement;
+    __m128i vGainLeft;
+    __m128i vGainRight;
+    __m128i vTmp;
+    __m128i vLeft;
+    __m128i vRight;
+
+    vGain = _mm_setr_epi32((int) (gain + gainIncrement), (int) (gain + 2 * gainIncrement),
+        (int) (gain + 3 * gainIncrement), (int) (gain + 4 * gainIncrement));
+    vGainIncrement = _mm_set1_epi32((int) (4 * gainIncrement));
+    vGainLeft = _mm_set1_epi32((int) gainLeft);
+    vGainRight = _mm_set1_epi32((int) gainRight);
+
+    for (; numSamples > 0; numSamples -= 4)
+    {
+        /* scale samples by gain */
+        vTmp = _mm_loadl_epi64((const __m128i*) pInputBuffer);
+        vTmp = _mm_srai_epi32(_mm_unpacklo_epi16(vTmp, vTmp), 16);
+        vTmp = WT_MulLo32(_mm_srai_epi32(vGain, 16), vTmp);
+        vTmp = _mm_srai_epi32(vTmp, 14);
+        vGain = _mm_add_epi32(vGain, vGainIncrement);
+        pInputBuffer += 4;
+
+        /* left and right channels */
+        vLeft = _mm_srai_epi32(WT_MulLo32(vTmp, vGainLeft), NUM_MIXER_GUARD_BITS);
+        vRight = _mm_srai_epi32(WT_MulLo32(vTmp, vGainRight), NUM_MIXER_GUARD_BITS);
+
+        /* interleave and accumulate into the final mix buffer */
+        WT_MixAccumulate(pMixBuffer, _mm_unpacklo_epi32(vLeft, vRight));
+        WT_MixAccumulate(pMixBuffer + 4, _mm_unpackhi_epi32(vLeft, vRight));
+        pMixBuffer += 8;
+    }
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * WT_VoiceGain
  *----------------------------------------------------------------------------
@@ -96,23 +256,39 @@ void WT_VoiceGain (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
     /* initialize some local variables */
     numSamples = pWTIntFrame->numSamples;
     if (numSamples <= 0) {
-        ALOGE("b/26366256");
-        android_errorWriteLog(0x534e4554, "26366256");
+        EAS_DIAG_POST(eDiagNoSamples, numSamples);
         return;
     }
     pMixBuffer = pWTIntFrame->pMixBuffer;
     pInputBuffer = pWTIntFrame->pAudioBuffer;
 
-    gainIncrement = (pWTIntFrame->frame.gainTarget - pWTIntFrame->prevGain) * (1 << (16 - SYNTH_UPDATE_PERIOD_IN_BITS));
+    gainIncrement = (pWTIntFrame->frame.gainTarget - pWTIntFrame->prevGain) * (1 << (16 - WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame)));
     if (gainIncrement < 0)
         gainIncrement++;
     gain = pWTIntFrame->prevGain * (1 << 16);
+#ifdef _LOW_LATENCY
+    /* continue the ramp from the slices already synthesized */
+    gain += gainIncrement * pWTIntFrame->rampOffset;
+#endif
 
 #if (NUM_OUTPUT_CHANNELS == 2)
     gainLeft = pWTVoice->gainLeft;
     gainRight = pWTVoice->gainRight;
 #endif
 
+#if defined(_NEON_KERNEL) || defined(_SSE2_KERNEL)
+    /* vector kernel does groups of four samples, the rest are done below */
+    tmp0 = numSamples & ~3;
+    if (tmp0 > 0)
+    {
+        WT_VoiceGainVector(pInputBuffer, pMixBuffer, tmp0, gain, gainIncrement, gainLeft, gainRight);
+        pInputBuffer += tmp0;
+        pMixBuffer += tmp0 * NUM_OUTPUT_CHANNELS;
+        gain += tmp0 * gainIncrement;
+        numSamples -= tmp0;
+    }
+#endif
+
     while (numSamples--) {
 
         /* incremental gain step to prevent zipper noise */
@@ -193,8 +369,7 @@ void WT_Interpolate (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
     /* initialize some local variables */
     numSamples = pWTIntFrame->numSamples;
     if (numSamples <= 0) {
-        ALOGE("b/26366256");
-        android_errorWriteLog(0x534e4554, "26366256");
+        EAS_DIAG_POST(eDiagNoSamples, numSamples);
         return;
     }
     pOutputBuffer = pWTIntFrame->pAudioBuffer;
@@ -291,8 +466,7 @@ void WT_InterpolateNoLoop (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
     /* initialize some local variables */
     numSamples = pWTIntFrame->numSamples;
     if (numSamples <= 0) {
-        ALOGE("b/26366256");
-        android_errorWriteLog(0x534e4554, "26366256");
+        EAS_DIAG_POST(eDiagNoSamples, numSamples);
         return;
     }
     pOutputBuffer = pWTIntFrame->pAudioBuffer;
@@ -356,12 +530,469 @@ void WT_InterpolateNoLoop (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
 }
 #endif
 
+#ifdef _WT_ADPCM
+/*----------------------------------------------------------------------------
+ * WT_StartADPCM
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets up a voice to play an unlooped sample compressed to IMA ADPCM: a
+ * header holding the first sample and the step index, then one nibble per
+ * sample, low nibble first
+ *
+ * Inputs:
+ * pWTVoice         - voice
+ * pData            - compressed sample
+ * size             - bytes in the compressed sample, more than the header
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void WT_StartADPCM (S_WT_VOICE *pWTVoice, const EAS_U8 *pData, EAS_U32 size)
+{
+    EAS_U32 numSamples;
+
+    /* the phase counts samples from the start of the data */
+    numSamples = IMA_ADPCM_SAMPLES(size);
+    pWTVoice->phaseAccum = (EAS_U32) pData;
+#ifdef _CUBIC_INTERPOLATION
+    pWTVoice->sampleStart = pWTVoice->phaseAccum;
+#endif
+    pWTVoice->loopStart = pWTVoice->loopEnd = pWTVoice->phaseAccum + (numSamples - 1) * sizeof(EAS_SAMPLE);
+
+    /* decode the first two samples */
+    pWTVoice->adpcmSample = IMADecodeHeader(&pWTVoice->adpcm, pData);
+    pWTVoice->adpcmNibbles = numSamples - 2;
+    pWTVoice->pADPCMData = pData + IMA_HEADER_SIZE;
+    pWTVoice->flags = WT_FLAGS_USE_ADPCM | WT_FLAGS_ADPCM_NIBBLE | WT_FLAGS_ADPCM_READY;
+    (void) IMADecodeNibble(&pWTVoice->adpcm, pData[IMA_HEADER_SIZE] & 0x0f);
+}
+
+/*----------------------------------------------------------------------------
+ * WT_InterpolateADPCM
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Interpolation engine for compressed samples. The sample is decoded as
+ * the phase advances, so only the two samples being interpolated exist
+ * in decoded form.
+ *
+ * Inputs:
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void WT_InterpolateADPCM (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    EAS_PCM *pOutputBuffer;
+    EAS_I32 phaseInc;
+    EAS_I32 phaseFrac;
+    EAS_I32 acc0;
+    const EAS_U8 *pData;
+    S_DECODER_STATE decoder;
+    EAS_U32 nibbles;
+    EAS_U32 phaseAccum;
+    EAS_I32 samp1;
+    EAS_I32 samp2;
+    EAS_I32 numSamples;
+    EAS_INT highNibble;
+
+    /* initialize some local variables */
+    numSamples = pWTIntFrame->numSamples;
+    if (numSamples <= 0)
+        return;
+    pOutputBuffer = pWTIntFrame->pAudioBuffer;
+
+    phaseInc = pWTIntFrame->frame.phaseIncrement;
+    phaseFrac = (EAS_I32) pWTVoice->phaseFrac;
+    phaseAccum = pWTVoice->phaseAccum;
+    pData = pWTVoice->pADPCMData;
+    nibbles = pWTVoice->adpcmNibbles;
+    highNibble = pWTVoice->flags & WT_FLAGS_ADPCM_NIBBLE;
+    decoder = pWTVoice->adpcm;
+    samp1 = pWTVoice->adpcmSample;
+    samp2 = decoder.x1;
+
+    while (numSamples--) {
+
+        /* linear interpolation */
+        acc0 = samp2 - samp1;
+        acc0 = acc0 * phaseFrac;
+        /*lint -e{704} <avoid divide>*/
+        acc0 = samp1 + (acc0 >> NUM_PHASE_FRAC_BITS);
+
+        /* save new output sample in buffer */
+        /*lint -e{704} <avoid divide>*/
+        *pOutputBuffer++ = (EAS_I16)(acc0 >> 2);
+
+        /* increment phase */
+        phaseFrac += phaseInc;
+        /*lint -e{704} <avoid divide>*/
+        acc0 = phaseFrac >> NUM_PHASE_FRAC_BITS;
+
+        /* decode up to the new sample */
+        if (acc0 > 0) {
+            phaseFrac = (EAS_I32)((EAS_U32)phaseFrac & PHASE_FRAC_MASK);
+            phaseAccum += (EAS_U32) acc0 * sizeof(EAS_SAMPLE);
+            while (acc0--) {
+                samp1 = samp2;
+
+                /* past the end reads silence, as it does for PCM samples */
+                if (nibbles == 0) {
+                    samp2 = 0;
+                    continue;
+                }
+                nibbles--;
+                if (highNibble)
+                    samp2 = IMADecodeNibble(&decoder, *pData++ >> 4);
+                else
+                    samp2 = IMADecodeNibble(&decoder, *pData & 0x0f);
+                highNibble ^= WT_FLAGS_ADPCM_NIBBLE;
+            }
+        }
+    }
+
+    /* save the position and the decoder */
+    pWTVoice->phaseAccum = phaseAccum;
+    pWTVoice->phaseFrac = (EAS_U32) phaseFrac;
+    pWTVoice->pADPCMData = pData;
+    pWTVoice->adpcmNibbles = nibbles;
+    pWTVoice->flags = (EAS_U8) ((pWTVoice->flags & ~WT_FLAGS_ADPCM_NIBBLE) | highNibble);
+    pWTVoice->adpcmSample = samp1;
+    decoder.x1 = samp2;
+    pWTVoice->adpcm = decoder;
+}
+#endif
+
+#if defined(_CUBIC_INTERPOLATION) && (!defined(NATIVE_EAS_KERNEL) || defined(_16_BIT_SAMPLES))
+/* fractional bits used by the cubic interpolator, small enough that the
+ * polynomial cannot overflow 32 bits for any input */
+#define WT_CUBIC_FRAC_BITS      11
+
+#if defined(_8_BIT_SAMPLES)
+#define WT_CUBIC_SAMPLE(x)      ((EAS_I32) (x) << 8)
+#else
+#define WT_CUBIC_SAMPLE(x)      ((EAS_I32) (x))
+#endif
+
+/*----------------------------------------------------------------------------
+ * WT_CubicFetch
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Fetches the four samples around the current position. The sample before
+ * the start of the loop is the end of the loop and the sample before the
+ * start of the wave repeats the first one. The sample two past the end of
+ * the loop wraps to the start of the loop and the one two past the end of
+ * a one shot repeats the guard sample.
+ *
+ * Inputs:
+ * pWTVoice         - voice, for the wave and loop boundaries
+ * pSamples         - current position
+ * looped           - EAS_TRUE for a looped wave
+ *
+ * Outputs:
+ * pTaps            - samples at pSamples - 1 through pSamples + 2
+ *
+ *----------------------------------------------------------------------------
+*/
+static void WT_CubicFetch (const S_WT_VOICE *pWTVoice, const EAS_SAMPLE *pSamples, EAS_BOOL looped, EAS_I32 *pTaps)
+{
+    const EAS_SAMPLE *loopStart;
+    const EAS_SAMPLE *loopEnd;
+
+    loopStart = (const EAS_SAMPLE*) pWTVoice->loopStart;
+    loopEnd = (const EAS_SAMPLE*) pWTVoice->loopEnd;
+
+    if (looped && (pSamples == loopStart))
+        pTaps[0] = WT_CUBIC_SAMPLE(*loopEnd);
+    else if (pSamples == (const EAS_SAMPLE*) pWTVoice->sampleStart)
+        pTaps[0] = WT_CUBIC_SAMPLE(pSamples[0]);
+    else
+        pTaps[0] = WT_CUBIC_SAMPLE(pSamples[-1]);
+
+    pTaps[1] = WT_CUBIC_SAMPLE(pSamples[0]);
+    pTaps[2] = WT_CUBIC_SAMPLE(pSamples[1]);
+
+    if (pSamples < loopEnd)
+        pTaps[3] = WT_CUBIC_SAMPLE(pSamples[2]);
+    else if (looped)
+        pTaps[3] = WT_CUBIC_SAMPLE(loopStart[1]);
+    else
+        pTaps[3] = pTaps[2];
+}
+
+#ifndef WT_FUSED_KERNELS
+/*----------------------------------------------------------------------------
+ * WT_InterpolateCubic
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Interpolation engine for wavetable synth using a 4 point, 3rd order
+ * Hermite (Catmull-Rom) polynomial, for looped and unlooped waves. The
+ * polynomial is evaluated in Horner form with doubled coefficients to
+ * stay in integer arithmetic.
+ *
+ * Inputs:
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void WT_InterpolateCubic (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    EAS_PCM *pOutputBuffer;
+    EAS_I32 phaseInc;
+    EAS_I32 phaseFrac;
+    EAS_I32 frac;
+    EAS_I32 acc0;
+    EAS_I32 c1;
+    EAS_I32 c2;
+    EAS_I32 c3;
+    const EAS_SAMPLE *pSamples;
+    const EAS_SAMPLE *loopEnd;
+    EAS_I32 taps[4];
+    EAS_I32 numSamples;
+    EAS_BOOL looped;
+
+    /* initialize some local variables */
+    numSamples = pWTIntFrame->numSamples;
+    if (numSamples <= 0) {
+        EAS_DIAG_POST(eDiagNoSamples, numSamples);
+        return;
+    }
+    pOutputBuffer = pWTIntFrame->pAudioBuffer;
+
+    looped = (EAS_BOOL) (pWTVoice->loopStart != pWTVoice->loopEnd);
+    loopEnd = (const EAS_SAMPLE*) pWTVoice->loopEnd + 1;
+    pSamples = (const EAS_SAMPLE*) pWTVoice->phaseAccum;
+    /*lint -e{713} truncation is OK */
+    phaseFrac = pWTVoice->phaseFrac;
+    phaseInc = pWTIntFrame->frame.phaseIncrement;
+
+    /* fetch the samples around the current position */
+    WT_CubicFetch(pWTVoice, pSamples, looped, taps);
+
+    while (numSamples--) {
+
+        /* cubic interpolation */
+        /*lint -e{704} <avoid divide>*/
+        frac = phaseFrac >> (NUM_PHASE_FRAC_BITS - WT_CUBIC_FRAC_BITS);
+        c1 = taps[2] - taps[0];
+        c2 = 2 * taps[0] - 5 * taps[1] + 4 * taps[2] - taps[3];
+        c3 = taps[3] - taps[0] + 3 * (taps[1] - taps[2]);
+        /*lint -e{704} <avoid divide>*/
+        acc0 = ((c3 * frac) >> WT_CUBIC_FRAC_BITS) + c2;
+        /*lint -e{704} <avoid divide>*/
+        acc0 = ((acc0 * frac) >> WT_CUBIC_FRAC_BITS) + c1;
+        /*lint -e{704} <avoid divide>*/
+        acc0 = taps[1] + ((acc0 * frac) >> (WT_CUBIC_FRAC_BITS + 1));
+
+        /* save new output sample in buffer */
+        /*lint -e{704} <avoid divide>*/
+        *pOutputBuffer++ = (EAS_I16)(acc0 >> 2);
+
+        /* increment phase */
+        phaseFrac += phaseInc;
+        /*lint -e{704} <avoid divide>*/
+        acc0 = phaseFrac >> NUM_PHASE_FRAC_BITS;
+
+        /* next sample */
+        if (acc0 > 0) {
+
+            /* advance sample pointer */
+            pSamples += acc0;
+            phaseFrac = (EAS_I32)((EAS_U32)phaseFrac & PHASE_FRAC_MASK);
+
+            /* check for loop end */
+            if (looped) {
+                acc0 = (EAS_I32) (pSamples - loopEnd);
+                if (acc0 >= 0)
+                    pSamples = (const EAS_SAMPLE*) pWTVoice->loopStart + acc0;
+            }
+
+            /* fetch new samples */
+            WT_CubicFetch(pWTVoice, pSamples, looped, taps);
+        }
+    }
+
+    /* save pointer and phase */
+    pWTVoice->phaseAccum = (EAS_U32) pSamples;
+    pWTVoice->phaseFrac = (EAS_U32) phaseFrac;
+}
+#endif
+#endif
+
+#ifdef WT_FUSED_KERNELS
+/*----------------------------------------------------------------------------
+ * Fused voice kernels
+ *
+ * One kernel per combination of interpolator, looped wave, active filter
+ * and ramping gain, generated from eas_wtkernel.h, so each voice is
+ * interpolated, filtered and mixed in a single pass with no tests in the
+ * inner loop for the features it does not use.
+ *----------------------------------------------------------------------------
+*/
+#define WT_KERNEL_NAME WT_KernelNoLoop
+#define WT_KERNEL_LOOPED 0
+#define WT_KERNEL_FILTERED 0
+#define WT_KERNEL_RAMPED 0
+#define WT_KERNEL_CUBIC 0
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelNoLoopRamp
+#define WT_KERNEL_LOOPED 0
+#define WT_KERNEL_FILTERED 0
+#define WT_KERNEL_RAMPED 1
+#define WT_KERNEL_CUBIC 0
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelLoop
+#define WT_KERNEL_LOOPED 1
+#define WT_KERNEL_FILTERED 0
+#define WT_KERNEL_RAMPED 0
+#define WT_KERNEL_CUBIC 0
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelLoopRamp
+#define WT_KERNEL_LOOPED 1
+#define WT_KERNEL_FILTERED 0
+#define WT_KERNEL_RAMPED 1
+#define WT_KERNEL_CUBIC 0
+#include "eas_wtkernel.h"
+
+#ifdef _FILTER_ENABLED
+#define WT_KERNEL_NAME WT_KernelNoLoopFilter
+#define WT_KERNEL_LOOPED 0
+#define WT_KERNEL_FILTERED 1
+#define WT_KERNEL_RAMPED 0
+#define WT_KERNEL_CUBIC 0
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelNoLoopFilterRamp
+#define WT_KERNEL_LOOPED 0
+#define WT_KERNEL_FILTERED 1
+#define WT_KERNEL_RAMPED 1
+#define WT_KERNEL_CUBIC 0
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelLoopFilter
+#define WT_KERNEL_LOOPED 1
+#define WT_KERNEL_FILTERED 1
+#define WT_KERNEL_RAMPED 0
+#define WT_KERNEL_CUBIC 0
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelLoopFilterRamp
+#define WT_KERNEL_LOOPED 1
+#define WT_KERNEL_FILTERED 1
+#define WT_KERNEL_RAMPED 1
+#define WT_KERNEL_CUBIC 0
+#include "eas_wtkernel.h"
+#endif
+
+#ifdef _CUBIC_INTERPOLATION
+#define WT_KERNEL_NAME WT_KernelCubicNoLoop
+#define WT_KERNEL_LOOPED 0
+#define WT_KERNEL_FILTERED 0
+#define WT_KERNEL_RAMPED 0
+#define WT_KERNEL_CUBIC 1
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelCubicNoLoopRamp
+#define WT_KERNEL_LOOPED 0
+#define WT_KERNEL_FILTERED 0
+#define WT_KERNEL_RAMPED 1
+#define WT_KERNEL_CUBIC 1
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelCubicLoop
+#define WT_KERNEL_LOOPED 1
+#define WT_KERNEL_FILTERED 0
+#define WT_KERNEL_RAMPED 0
+#define WT_KERNEL_CUBIC 1
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelCubicLoopRamp
+#define WT_KERNEL_LOOPED 1
+#define WT_KERNEL_FILTERED 0
+#define WT_KERNEL_RAMPED 1
+#define WT_KERNEL_CUBIC 1
+#include "eas_wtkernel.h"
+
+#ifdef _FILTER_ENABLED
+#define WT_KERNEL_NAME WT_KernelCubicNoLoopFilter
+#define WT_KERNEL_LOOPED 0
+#define WT_KERNEL_FILTERED 1
+#define WT_KERNEL_RAMPED 0
+#define WT_KERNEL_CUBIC 1
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelCubicNoLoopFilterRamp
+#define WT_KERNEL_LOOPED 0
+#define WT_KERNEL_FILTERED 1
+#define WT_KERNEL_RAMPED 1
+#define WT_KERNEL_CUBIC 1
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelCubicLoopFilter
+#define WT_KERNEL_LOOPED 1
+#define WT_KERNEL_FILTERED 1
+#define WT_KERNEL_RAMPED 0
+#define WT_KERNEL_CUBIC 1
+#include "eas_wtkernel.h"
+
+#define WT_KERNEL_NAME WT_KernelCubicLoopFilterRamp
+#define WT_KERNEL_LOOPED 1
+#define WT_KERNEL_FILTERED 1
+#define WT_KERNEL_RAMPED 1
+#define WT_KERNEL_CUBIC 1
+#include "eas_wtkernel.h"
+#endif
+#endif
+
+/* kernels indexed by WT_KERNEL_CUBIC | WT_KERNEL_FILTER | WT_KERNEL_LOOP | WT_KERNEL_RAMP */
+#define WT_KERNEL_RAMP      1
+#define WT_KERNEL_LOOP      2
+#define WT_KERNEL_FILTER    4
+#ifdef _FILTER_ENABLED
+#define WT_KERNEL_CUBIC     8
+#else
+#define WT_KERNEL_CUBIC     4
+#endif
+static void (* const wtKernels[])(S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame) =
+{
+    WT_KernelNoLoop,
+    WT_KernelNoLoopRamp,
+    WT_KernelLoop,
+    WT_KernelLoopRamp,
+#ifdef _FILTER_ENABLED
+    WT_KernelNoLoopFilter,
+    WT_KernelNoLoopFilterRamp,
+    WT_KernelLoopFilter,
+    WT_KernelLoopFilterRamp,
+#endif
+#ifdef _CUBIC_INTERPOLATION
+    WT_KernelCubicNoLoop,
+    WT_KernelCubicNoLoopRamp,
+    WT_KernelCubicLoop,
+    WT_KernelCubicLoopRamp,
+#ifdef _FILTER_ENABLED
+    WT_KernelCubicNoLoopFilter,
+    WT_KernelCubicNoLoopFilterRamp,
+    WT_KernelCubicLoopFilter,
+    WT_KernelCubicLoopFilterRamp,
+#endif
+#endif
+};
+#endif
+
 #if defined(_FILTER_ENABLED) && !defined(NATIVE_EAS_KERNEL)
 /*----------------------------------------------------------------------------
  * WT_VoiceFilter
  *----------------------------------------------------------------------------
  * Purpose:
- * Implements a 2-pole filter
+ * Implements a 2-pole filter. With _FILTER_RAMP the coefficients move
+ * linearly from those of the last update period to the new ones, one
+ * step per sample, so a moving cutoff does not step at frame boundaries.
  *
  * Inputs:
  *
@@ -380,12 +1011,17 @@ void WT_VoiceFilter (S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pWTIntFrame)
     EAS_I32 acc0;
     EAS_I32 acc1;
     EAS_I32 numSamples;
+#ifdef _FILTER_RAMP
+    EAS_I32 rampBits;
+    EAS_I32 kAcc, kInc;
+    EAS_I32 b1Acc, b1Inc;
+    EAS_I32 b2Acc, b2Inc;
+#endif
 
     /* initialize some local variables */
     numSamples = pWTIntFrame->numSamples;
     if (numSamples <= 0) {
-        ALOGE("b/26366256");
-        android_errorWriteLog(0x534e4554, "26366256");
+        EAS_DIAG_POST(eDiagNoSamples, numSamples);
         return;
     }
     pAudioBuffer = pWTIntFrame->pAudioBuffer;
@@ -400,9 +1036,40 @@ void WT_VoiceFilter (S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pWTIntFrame)
     /*lint -e{702} <avoid divide> */
     k = pWTIntFrame->frame.k >> 1;
 
+#ifdef _FILTER_RAMP
+    /* ramp from the coefficients of the last update period */
+    rampBits = WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame);
+    b1Inc = b1 + pFilter->b1;
+    /*lint -e{702} <avoid divide> */
+    b2Inc = b2 - (-pFilter->b2 >> 1);
+    /*lint -e{702} <avoid divide> */
+    kInc = k - (pFilter->k >> 1);
+    b1Acc = b1 * (1 << rampBits) - b1Inc * (1 << rampBits);
+    b2Acc = b2 * (1 << rampBits) - b2Inc * (1 << rampBits);
+    kAcc = k * (1 << rampBits) - kInc * (1 << rampBits);
+#ifdef _LOW_LATENCY
+    b1Acc += b1Inc * pWTIntFrame->rampOffset;
+    b2Acc += b2Inc * pWTIntFrame->rampOffset;
+    kAcc += kInc * pWTIntFrame->rampOffset;
+#endif
+#endif
+
     while (numSamples--)
     {
 
+#ifdef _FILTER_RAMP
+        /* step the coefficients toward their targets */
+        b1Acc += b1Inc;
+        b2Acc += b2Inc;
+        kAcc += kInc;
+        /*lint -e{702} <avoid divide> */
+        b1 = b1Acc >> rampBits;
+        /*lint -e{702} <avoid divide> */
+        b2 = b2Acc >> rampBits;
+        /*lint -e{702} <avoid divide> */
+        k = kAcc >> rampBits;
+#endif
+
         /* do filter calculations */
         acc0 = *pAudioBuffer;
         acc1 = z1 * b1;
@@ -452,8 +1119,7 @@ void WT_VoiceFilter (S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pWTIntFrame)
     /* initialize some local variables */
     numSamples = pWTIntFrame->numSamples;
     if (numSamples <= 0) {
-        ALOGE("b/26366256");
-        android_errorWriteLog(0x534e4554, "26366256");
+        EAS_DIAG_POST(eDiagNoSamples, numSamples);
         return;
     }
     pOutputBuffer = pWTIntFrame->pAudioBuffer;
@@ -465,6 +1131,37 @@ void WT_VoiceFilter (S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pWTIntFrame)
     /*lint -e{704} <avoid divide for performance>*/
     tmp1 = (EAS_I32) (pWTVoice->loopEnd) >> 18;
 
+#ifdef _TONE_GENERATORS
+    /* at or above the rate of the PRNG it advances every sample */
+    if (phaseInc >= PHASE_ONE)
+    {
+        EAS_U32 phaseFrac;
+        EAS_U32 prng;
+        EAS_U32 prev;
+
+        phaseFrac = pWTVoice->phaseFrac;
+        prev = pWTVoice->phaseAccum;
+        prng = pWTVoice->loopEnd;
+        while (numSamples--)
+        {
+            nInterpolatedSample = MULT_AUDIO_COEF( tmp0, (PHASE_ONE - phaseFrac));
+            nInterpolatedSample += MULT_AUDIO_COEF( tmp1, phaseFrac);
+            *pOutputBuffer++ = (EAS_PCM) nInterpolatedSample;
+
+            tmp0 = tmp1;
+            prev = prng;
+            prng = 5 * prng + 1;
+            /*lint -e{704} <avoid divide for performance>*/
+            tmp1 = (EAS_I32) prng >> 18;
+            phaseFrac = GET_PHASE_FRAC_PART(phaseFrac + (EAS_U32) phaseInc);
+        }
+        pWTVoice->phaseAccum = prev;
+        pWTVoice->loopEnd = prng;
+        pWTVoice->phaseFrac = phaseFrac;
+        return;
+    }
+#endif
+
     /* generate a buffer of noise */
     while (numSamples--) {
         nInterpolatedSample = MULT_AUDIO_COEF( tmp0, (PHASE_ONE - pWTVoice->phaseFrac));
@@ -484,6 +1181,183 @@ void WT_VoiceFilter (S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pWTIntFrame)
     }
 }
 
+#ifdef _TONE_GENERATORS
+/*----------------------------------------------------------------------------
+ * WT_BLEPResidual()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the polyBLEP correction of a sample near an edge of the square,
+ * (1 - d)^2 of the step for a distance of d samples, zero one sample away
+ *
+ * Inputs:
+ * dist             - distance of the sample from the edge, at most the phase increment
+ * recip            - 2^47 divided by the phase increment
+ *
+ * Outputs:
+ * correction scaled to WT_SQUARE_AMPLITUDE
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE EAS_I32 WT_BLEPResidual (uint32_t dist, uint64_t recip)
+{
+    EAS_I32 d;
+
+    /* one less the distance in samples, 1.15 */
+    d = 32768 - (EAS_I32) (((uint64_t) dist * recip) >> 32);
+    return (WT_SQUARE_AMPLITUDE * ((d * d) >> 15)) >> 15;
+}
+
+/*----------------------------------------------------------------------------
+ * WT_SquareGenerator()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Generates a band-limited square wave without reading samples. The
+ * naive square is written in one pass the compiler can vectorize, then
+ * the sample on each side of every edge is corrected with a polyBLEP
+ * residual, which removes most of the aliasing of the steps.
+ *
+ * Inputs:
+ * pWTVoice         - pointer to the voice
+ * pWTIntFrame      - pointer to the frame, the phase increment counts samples of the virtual wave
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * The cycle phase in pWTVoice->phaseAccum is advanced
+ *
+ *----------------------------------------------------------------------------
+*/
+static void WT_SquareGenerator (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    EAS_PCM *pOutputBuffer;
+    EAS_I32 numSamples;
+    EAS_I32 sign;
+    EAS_I32 i;
+    uint64_t inc;
+    uint64_t recip;
+    uint64_t edge;
+    uint64_t k;
+    uint32_t phase;
+    uint32_t phaseInc;
+
+    numSamples = pWTIntFrame->numSamples;
+    if (numSamples <= 0)
+        return;
+    pOutputBuffer = pWTIntFrame->pAudioBuffer;
+    phase = (uint32_t) pWTVoice->phaseAccum;
+
+    /* cycles per output sample, held below half a cycle so the edges alternate */
+    inc = ((uint64_t) pWTIntFrame->frame.phaseIncrement << (32 - NUM_PHASE_FRAC_BITS)) / pWTVoice->loopEnd;
+    if (inc > 0x7fffffff)
+        inc = 0x7fffffff;
+    phaseInc = (uint32_t) inc;
+
+    /* naive square, high for the first half of the cycle */
+    for (i = 0; i < numSamples; i++)
+        pOutputBuffer[i] = (EAS_PCM) (WT_SQUARE_AMPLITUDE - (EAS_I32) ((uint32_t) (phase + (uint32_t) i * phaseInc) >> 31) * (2 * WT_SQUARE_AMPLITUDE));
+
+    if (phaseInc != 0)
+    {
+        recip = ((uint64_t) 1 << 47) / phaseInc;
+
+        /* distance to the first edge at or after the phase, then every half cycle */
+        edge = (uint32_t) (0u - phase) & 0x7fffffffu;
+        sign = ((uint32_t) (phase + (uint32_t) edge) == 0) ? 1 : -1;
+        for (;;)
+        {
+            /* first sample at or after the edge, the one before may be the last of the frame */
+            k = (edge + phaseInc - 1) / phaseInc;
+            if (k > (uint64_t) numSamples)
+                break;
+            if (k < (uint64_t) numSamples)
+                pOutputBuffer[k] = (EAS_PCM) (pOutputBuffer[k] - sign * WT_BLEPResidual((uint32_t) (k * phaseInc - edge), recip));
+            if (k > 0)
+                pOutputBuffer[k - 1] = (EAS_PCM) (pOutputBuffer[k - 1] + sign * WT_BLEPResidual((uint32_t) (edge - (k - 1) * phaseInc), recip));
+            edge += 0x80000000u;
+            sign = -sign;
+        }
+    }
+    pWTVoice->phaseAccum = (EAS_U32) (uint32_t) (phase + (uint32_t) numSamples * phaseInc);
+}
+#endif
+
+#ifdef _SAMPLE_PREFETCH
+/*----------------------------------------------------------------------------
+ * WT_PrefetchVoice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Asks for the samples the voice reads in its next frame to be loaded into
+ * the data cache, so that the loads overlap the synthesis of the voice
+ * before it. The span is estimated from the phase increment of the last
+ * frame and continues at the loop start where it passes the loop end.
+ *
+ * Inputs:
+ * pWTVoice         - pointer to the voice
+ * numSamples       - number of samples in the frame
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * None, the samples are not read
+ *
+ *----------------------------------------------------------------------------
+*/
+void WT_PrefetchVoice (const S_WT_VOICE *pWTVoice, EAS_I32 numSamples)
+{
+    EAS_U32 pos;
+    EAS_U32 end;
+    EAS_U32 span;
+    EAS_INT lines;
+
+    if (pWTVoice->loopStart == WT_NOISE_GENERATOR)
+        return;
+#ifdef _TONE_GENERATORS
+    if (pWTVoice->loopStart == WT_SQUARE_GENERATOR)
+        return;
+#endif
+
+#ifdef _WT_ADPCM
+    /* a compressed voice reads a nibble per sample */
+    if (pWTVoice->flags & WT_FLAGS_USE_ADPCM)
+    {
+        EAS_PREFETCH(pWTVoice->pADPCMData);
+        return;
+    }
+#endif
+
+    /* bytes read at the pitch of the last frame, one line when it isn't known */
+    span = EAS_CACHE_LINE_SIZE;
+#ifdef _ARTICULATION_CACHE
+    if ((pWTVoice->cache.pitchCents != WT_CACHE_INVALID) && (pWTVoice->cache.phaseIncrement > 0))
+    {
+        span = (((EAS_U32) pWTVoice->cache.phaseIncrement >> 7) * (EAS_U32) numSamples) >> (NUM_PHASE_FRAC_BITS - 7);
+        span = (span + 2) * sizeof(EAS_SAMPLE);
+    }
+#endif
+    if (span > WT_PREFETCH_MAX_LINES * EAS_CACHE_LINE_SIZE)
+        span = WT_PREFETCH_MAX_LINES * EAS_CACHE_LINE_SIZE;
+
+    pos = pWTVoice->phaseAccum & ~(EAS_U32) (EAS_CACHE_LINE_SIZE - 1);
+    end = pWTVoice->phaseAccum + span;
+    lines = WT_PREFETCH_MAX_LINES;
+
+    /* the rest of a looped frame is read from the loop start */
+    if ((pWTVoice->loopStart != pWTVoice->loopEnd) && (end > pWTVoice->loopEnd + sizeof(EAS_SAMPLE)))
+    {
+        span = end - (pWTVoice->loopEnd + sizeof(EAS_SAMPLE));
+        end = pWTVoice->loopEnd + sizeof(EAS_SAMPLE);
+        for (; (pos < end) && (lines > 0); pos += EAS_CACHE_LINE_SIZE, lines--)
+            EAS_PREFETCH((const void*) pos);
+        pos = pWTVoice->loopStart & ~(EAS_U32) (EAS_CACHE_LINE_SIZE - 1);
+        end = pWTVoice->loopStart + span;
+    }
+    for (; (pos < end) && (lines > 0); pos += EAS_CACHE_LINE_SIZE, lines--)
+        EAS_PREFETCH((const void*) pos);
+}
+#endif
+
 #ifndef _OPTIMIZED_MONO
 /*----------------------------------------------------------------------------
  * WT_ProcessVoice
@@ -508,6 +1382,48 @@ void WT_ProcessVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
     if (pWTVoice->loopStart == WT_NOISE_GENERATOR)
         WT_NoiseGenerator(pWTVoice, pWTIntFrame);
 
+#ifdef _TONE_GENERATORS
+    /* or the square generator */
+    else if (pWTVoice->loopStart == WT_SQUARE_GENERATOR)
+        WT_SquareGenerator(pWTVoice, pWTIntFrame);
+#endif
+
+#ifdef _WT_ADPCM
+    /* decode compressed samples as they are interpolated */
+    else if (pWTVoice->flags & WT_FLAGS_USE_ADPCM)
+        WT_InterpolateADPCM(pWTVoice, pWTIntFrame);
+#endif
+
+#ifdef WT_FUSED_KERNELS
+    /* interpolate, filter and mix in one pass */
+    else
+    {
+        EAS_INT kernel;
+
+        kernel = 0;
+#ifdef _CUBIC_INTERPOLATION
+        if (pWTIntFrame->cubic)
+            kernel |= WT_KERNEL_CUBIC;
+#endif
+        if (pWTVoice->loopStart != pWTVoice->loopEnd)
+            kernel |= WT_KERNEL_LOOP;
+#ifdef _FILTER_ENABLED
+        if (pWTIntFrame->frame.k != 0)
+            kernel |= WT_KERNEL_FILTER;
+#endif
+        if (pWTIntFrame->frame.gainTarget != pWTIntFrame->prevGain)
+            kernel |= WT_KERNEL_RAMP;
+        wtKernels[kernel](pWTVoice, pWTIntFrame);
+        return;
+    }
+#else
+
+#if defined(_CUBIC_INTERPOLATION) && (!defined(NATIVE_EAS_KERNEL) || defined(_16_BIT_SAMPLES))
+    /* generate cubic interpolated samples for either kind of wave */
+    else if (pWTIntFrame->cubic)
+        WT_InterpolateCubic(pWTVoice, pWTIntFrame);
+#endif
+
     /* generate interpolated samples for looped waves */
     else if (pWTVoice->loopStart != pWTVoice->loopEnd)
         WT_Interpolate(pWTVoice, pWTIntFrame);
@@ -517,6 +1433,7 @@ void WT_ProcessVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
     {
         WT_InterpolateNoLoop(pWTVoice, pWTIntFrame);
     }
+#endif
 
 #ifdef _FILTER_ENABLED
     if (pWTIntFrame->frame.k != 0)
@@ -533,11 +1450,11 @@ void WT_ProcessVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
 #endif
 
         gainLeft = (pWTIntFrame->prevGain * pWTVoice->gainLeft) << 1;
-        gainIncLeft = (((pWTIntFrame->frame.gainTarget * pWTVoice->gainLeft) << 1) - gainLeft) >> SYNTH_UPDATE_PERIOD_IN_BITS;
+        gainIncLeft = (((pWTIntFrame->frame.gainTarget * pWTVoice->gainLeft) << 1) - gainLeft) >> WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame);
 
 #if (NUM_OUTPUT_CHANNELS == 2)
         gainRight = (pWTIntFrame->prevGain * pWTVoice->gainRight) << 1;
-        gainIncRight = (((pWTIntFrame->frame.gainTarget * pWTVoice->gainRight) << 1) - gainRight) >> SYNTH_UPDATE_PERIOD_IN_BITS;
+        gainIncRight = (((pWTIntFrame->frame.gainTarget * pWTVoice->gainRight) << 1) - gainRight) >> WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame);
         EAS_MixStream(
             pWTIntFrame->pAudioBuffer,
             pWTIntFrame->pMixBuffer,
@@ -600,17 +1517,20 @@ void WT_InterpolateMono (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
 
     numSamples = pWTIntFrame->numSamples;
     if (numSamples <= 0) {
-        ALOGE("b/26366256");
-        android_errorWriteLog(0x534e4554, "26366256");
+        EAS_DIAG_POST(eDiagNoSamples, numSamples);
         return;
     }
     pMixBuffer = pWTIntFrame->pMixBuffer;
 
     /* calculate gain increment */
-    gainIncrement = (pWTIntFrame->gainTarget - pWTIntFrame->prevGain) * (1 << (16 - SYNTH_UPDATE_PERIOD_IN_BITS));
+    gainIncrement = (pWTIntFrame->gainTarget - pWTIntFrame->prevGain) * (1 << (16 - WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame)));
     if (gainIncrement < 0)
         gainIncrement++;
     gain = pWTIntFrame->prevGain * (1 << 16);
+#ifdef _LOW_LATENCY
+    /* continue the ramp from the slices already synthesized */
+    gain += gainIncrement * pWTIntFrame->rampOffset;
+#endif
 
     pCurrentPhaseInt = pWTVoice->pPhaseAccum;
     currentPhaseFrac = pWTVoice->phaseFrac;
@@ -638,7 +1558,7 @@ InterpolationLoop:
     currentPhaseFrac = tmp2 & PHASE_FRAC_MASK;
 
     gain += gainIncrement;
-    tmp2 = (gain >> SYNTH_UPDATE_PERIOD_IN_BITS);
+    tmp2 = (gain >> WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame));
 
     tmp0 = *pMixBuffer;
     tmp2 = tmp1 * tmp2;
@@ -653,7 +1573,7 @@ InterpolationLoop:
     pWTVoice->pPhaseAccum = pCurrentPhaseInt;
     pWTVoice->phaseFrac = currentPhaseFrac;
     /*lint -e{702} <avoid divide>*/
-    pWTVoice->gain = (EAS_I16)(gain >> SYNTH_UPDATE_PERIOD_IN_BITS);
+    pWTVoice->gain = (EAS_I16)(gain >> WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame));
 }
 #endif
 
@@ -686,6 +1606,24 @@ void WT_ProcessVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
         WT_VoiceGain(pWTVoice, pWTIntFrame);
     }
 
+#ifdef _TONE_GENERATORS
+    /* or the square generator */
+    else if (pWTVoice->loopStart == WT_SQUARE_GENERATOR)
+    {
+        WT_SquareGenerator(pWTVoice, pWTIntFrame);
+        WT_VoiceGain(pWTVoice, pWTIntFrame);
+    }
+#endif
+
+#ifdef _WT_ADPCM
+    /* decode compressed samples as they are interpolated */
+    else if (pWTVoice->flags & WT_FLAGS_USE_ADPCM)
+    {
+        WT_InterpolateADPCM(pWTVoice, pWTIntFrame);
+        WT_VoiceGain(pWTVoice, pWTIntFrame);
+    }
+#endif
+
     /* or generate interpolated samples */
     else
     {
@@ -40,6 +40,9 @@
 #endif
 
 #include "eas_wt_IPC_frame.h"
+#ifdef _WT_ADPCM
+#include "eas_imaadpcm.h"
+#endif
 
 /*----------------------------------------------------------------------------
  * defines
@@ -47,6 +50,28 @@
 */
 #define WT_NOISE_GENERATOR                  0xffffffff
 
+#ifdef _TONE_GENERATORS
+/*
+A square voice has WT_SQUARE_GENERATOR in loopStart, the length of a cycle
+in samples of the virtual wave in loopEnd and the phase of the cycle in
+phaseAccum, 2^32 is a cycle.
+*/
+#define WT_SQUARE_GENERATOR                 0xfffffffe
+
+/* cycle length of a square region without a loop */
+#define WT_SQUARE_DEFAULT_PERIOD            64
+
+/* -12 dB, the same headroom as the noise generator leaves for the filter */
+#define WT_SQUARE_AMPLITUDE                 8192
+#endif
+
+#ifdef _SAMPLE_PREFETCH
+/* most cache lines requested for the next frame of a voice */
+#ifndef WT_PREFETCH_MAX_LINES
+#define WT_PREFETCH_MAX_LINES               8
+#endif
+#endif
+
 /*----------------------------------------------------------------------------
  * typedefs
  *----------------------------------------------------------------------------
@@ -66,8 +91,24 @@ typedef struct s_wt_int_frame_tag
     EAS_I32         *pMixBuffer;
     EAS_I32         numSamples;
     EAS_I32         prevGain;
+#ifdef _RUNTIME_SAMPLE_RATE
+    EAS_I32         rateShift;
+#endif
+#ifdef _CUBIC_INTERPOLATION
+    EAS_BOOL        cubic;                      /* use the 4 point interpolator */
+#endif
+#ifdef _LOW_LATENCY
+    EAS_I32         rampOffset;                 /* samples of the gain ramp done by earlier slices */
+#endif
 } S_WT_INT_FRAME;
 
+/* log2 of the samples in one update period for this frame */
+#ifdef _RUNTIME_SAMPLE_RATE
+#define WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame)   (SYNTH_UPDATE_PERIOD_IN_BITS + (pWTIntFrame)->rateShift)
+#else
+#define WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame)   SYNTH_UPDATE_PERIOD_IN_BITS
+#endif
+
 #if defined(_FILTER_ENABLED)
 /*----------------------------------------------------------------------------
  * S_FILTER_CONTROL data structure
@@ -77,6 +118,11 @@ typedef struct s_filter_control_tag
 {
     EAS_I16     z1;                             /* 1 sample delay state variable */
     EAS_I16     z2;                             /* 2 sample delay state variable */
+#ifdef _FILTER_RAMP
+    EAS_I32     k;                              /* coefficients of the last update period */
+    EAS_I32     b1;
+    EAS_I32     b2;
+#endif
 } S_FILTER_CONTROL;
 #endif
 
@@ -90,11 +136,43 @@ typedef struct s_lfo_control_tag
     EAS_I16     lfoPhase;           /* LFO current phase */
 } S_LFO_CONTROL;
 
+#ifdef _ARTICULATION_CACHE
+/*----------------------------------------------------------------------------
+ * S_WT_CACHE data structure
+ *
+ * Control values computed for the previous frame and the input each was
+ * computed from. A value is reused while its input is unchanged.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_wt_cache_tag
+{
+    EAS_I32     pitchCents;                     /* pitch of phaseIncrement */
+    EAS_I32     phaseIncrement;
+    EAS_I32     lfoGainCents;                   /* LFO gain of lfoGain */
+    EAS_I32     lfoGain;
+#if defined(_FILTER_ENABLED)
+    EAS_I32     cutoff;                         /* cutoff of k, b1 and b2 */
+    EAS_I32     k;
+    EAS_I32     b1;
+    EAS_I32     b2;
+#endif
+} S_WT_CACHE;
+
+/* no pitch, gain or cutoff reaches this, so an entry holding it always misses */
+#define WT_CACHE_INVALID                0x7fffffff
+#endif
+
 /* bit definitions for S_WT_VOICE:flags */
 #define WT_FLAGS_ADPCM_NIBBLE           1       /* high/low nibble flag */
 #define WT_FLAGS_ADPCM_READY            2       /* first 2 samples are decoded */
 #define WT_FLAGS_USE_ADPCM              4       /* sample is ADPCM encoded */
 
+#ifdef _LOW_LATENCY
+/* bit definitions for S_WT_VOICE:sliceFlags */
+#define WT_SLICE_CULLED                 1       /* voice is not rendered this update period */
+#define WT_SLICE_CUBIC                  2       /* voice uses the cubic interpolator */
+#endif
+
 /* eg1State and eg2State */
 typedef enum {
     eEnvelopeStateInit = 0,
@@ -128,6 +206,9 @@ typedef struct s_wt_voice_tag
     EAS_U32             loopStart;              /* points to first sample at start of loop */
     EAS_U32             phaseAccum;             /* current sample, integer portion of phase */
     EAS_U32             phaseFrac;              /* fractional portion of phase */
+#ifdef _CUBIC_INTERPOLATION
+    EAS_U32             sampleStart;            /* points to first PCM sample */
+#endif
 
 #if (NUM_OUTPUT_CHANNELS == 2)
     EAS_I16             gainLeft;               /* current gain, left ch  */
@@ -154,6 +235,28 @@ typedef struct s_wt_voice_tag
 
     EAS_U16             artIndex;               /* index to articulation params */
 
+#ifdef _ARTICULATION_CACHE
+    S_WT_CACHE          cache;                  /* control values from the last frame */
+#endif
+
+#ifdef _WT_ADPCM
+    /* phaseAccum, loopStart and loopEnd of a compressed sample count samples
+     * as if it were stored uncompressed and are never dereferenced */
+    const EAS_U8        *pADPCMData;            /* byte holding the next nibble */
+    EAS_U32             adpcmNibbles;           /* nibbles left in the sample */
+    S_DECODER_STATE     adpcm;                  /* x1 is the sample after phaseAccum */
+    EAS_I32             adpcmSample;            /* sample at phaseAccum */
+    EAS_U8              flags;
+#endif
+
+#ifdef _LOW_LATENCY
+    /* an update period synthesized in several slices */
+    S_WT_FRAME          sliceFrame;             /* parameters of the update period */
+    EAS_I16             frameLeft;              /* samples left in the update period */
+    EAS_I16             rampOffset;             /* samples of the gain ramp already synthesized */
+    EAS_U8              sliceFlags;
+#endif
+
 } S_WT_VOICE;
 
 /*----------------------------------------------------------------------------
@@ -162,10 +265,18 @@ typedef struct s_wt_voice_tag
 */
 EAS_BOOL WT_CheckSampleEnd (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame, EAS_BOOL update);
 void WT_ProcessVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame);
+#ifdef _SAMPLE_PREFETCH
+void WT_PrefetchVoice (const S_WT_VOICE *pWTVoice, EAS_I32 numSamples);
+#endif
+#ifdef _WT_ADPCM
+void WT_StartADPCM (S_WT_VOICE *pWTVoice, const EAS_U8 *pData, EAS_U32 size);
+#endif
 
 #ifdef EAS_SPLIT_WT_SYNTH
+EAS_BOOL WTE_StartFrame (EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
+EAS_BOOL WTE_EndFrame (EAS_HW_DATA_HANDLE hwInstData, EAS_FRAME_BUFFER_HANDLE pFrameBuffer, EAS_I32 *pMixBuffer, EAS_I16 masterGain);
 void WTE_ConfigVoice (EAS_I32 voiceNum, S_WT_CONFIG *pWTConfig, EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
-void WTE_ProcessVoice (EAS_I32 voiceNum, S_WT_FRAME *pWTParams, EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
+void WTE_ProcessVoice (EAS_I32 voiceNum, S_WT_VOICE *pWTVoice, const S_WT_INT_FRAME *pWTIntFrame, EAS_I32 mixOffset, EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
 #endif
 
 #endif
@@ -0,0 +1,280 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_wtkernel.h
+ *
+ * Contents and purpose:
+ * Template for the fused wavetable voice kernels. eas_wtengine.c includes
+ * this file once for each combination of the switches below, each time
+ * generating a kernel that interpolates, filters and mixes a voice in a
+ * single pass over the samples, with the state of all three in registers.
+ *
+ * Define before including:
+ * WT_KERNEL_NAME       - name of the generated function
+ * WT_KERNEL_LOOPED     - 1 to wrap at the loop end, 0 for unlooped waves
+ * WT_KERNEL_FILTERED   - 1 to run the 2-pole filter, 0 when it is open
+ * WT_KERNEL_RAMPED     - 1 to ramp the gain, 0 when it is constant
+ * WT_KERNEL_CUBIC      - 1 for the cubic interpolator, 0 for linear
+ *
+ * The output is bit-exact with WT_Interpolate, WT_InterpolateNoLoop or
+ * WT_InterpolateCubic, then WT_VoiceFilter, then WT_VoiceGain, without
+ * the intermediate voice buffer.
+ * With _FILTER_RAMP the filtered kernels ramp the coefficients per
+ * sample the same way WT_VoiceFilter does.
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+/* no include guard, this file is included once per kernel */
+
+static void WT_KERNEL_NAME (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    EAS_I32 *pMixBuffer;
+    EAS_I32 phaseInc;
+    EAS_I32 phaseFrac;
+    EAS_I32 acc0;
+    const EAS_SAMPLE *pSamples;
+#if WT_KERNEL_LOOPED
+    const EAS_SAMPLE *loopEnd;
+#endif
+#if WT_KERNEL_CUBIC
+    EAS_I32 frac;
+    EAS_I32 c1;
+    EAS_I32 c2;
+    EAS_I32 c3;
+    EAS_I32 taps[4];
+#else
+    EAS_I32 samp1;
+    EAS_I32 samp2;
+#endif
+    EAS_I32 gain;
+#if WT_KERNEL_RAMPED
+    EAS_I32 gainIncrement;
+#endif
+#if WT_KERNEL_FILTERED
+    EAS_I32 k;
+    EAS_I32 b1;
+    EAS_I32 b2;
+    EAS_I32 z1;
+    EAS_I32 z2;
+#ifdef _FILTER_RAMP
+    EAS_I32 rampBits;
+    EAS_I32 kAcc, kInc;
+    EAS_I32 b1Acc, b1Inc;
+    EAS_I32 b2Acc, b2Inc;
+#endif
+#endif
+#if (NUM_OUTPUT_CHANNELS == 2)
+    EAS_I32 gainLeft, gainRight;
+#endif
+    EAS_I32 numSamples;
+
+    /* initialize some local variables */
+    numSamples = pWTIntFrame->numSamples;
+    if (numSamples <= 0) {
+        EAS_DIAG_POST(eDiagNoSamples, numSamples);
+        return;
+    }
+    pMixBuffer = pWTIntFrame->pMixBuffer;
+
+#if WT_KERNEL_LOOPED
+    loopEnd = (const EAS_SAMPLE*) pWTVoice->loopEnd + 1;
+#endif
+    pSamples = (const EAS_SAMPLE*) pWTVoice->phaseAccum;
+    /*lint -e{713} truncation is OK */
+    phaseFrac = (EAS_I32) pWTVoice->phaseFrac;
+    phaseInc = pWTIntFrame->frame.phaseIncrement;
+
+#if WT_KERNEL_FILTERED
+    z1 = pWTVoice->filter.z1;
+    z2 = pWTVoice->filter.z2;
+    b1 = -pWTIntFrame->frame.b1;
+    /*lint -e{702} <avoid divide> */
+    b2 = -pWTIntFrame->frame.b2 >> 1;
+    /*lint -e{702} <avoid divide> */
+    k = pWTIntFrame->frame.k >> 1;
+#ifdef _FILTER_RAMP
+    /* ramp from the coefficients of the last update period */
+    rampBits = WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame);
+    b1Inc = b1 + pWTVoice->filter.b1;
+    /*lint -e{702} <avoid divide> */
+    b2Inc = b2 - (-pWTVoice->filter.b2 >> 1);
+    /*lint -e{702} <avoid divide> */
+    kInc = k - (pWTVoice->filter.k >> 1);
+    b1Acc = b1 * (1 << rampBits) - b1Inc * (1 << rampBits);
+    b2Acc = b2 * (1 << rampBits) - b2Inc * (1 << rampBits);
+    kAcc = k * (1 << rampBits) - kInc * (1 << rampBits);
+#ifdef _LOW_LATENCY
+    b1Acc += b1Inc * pWTIntFrame->rampOffset;
+    b2Acc += b2Inc * pWTIntFrame->rampOffset;
+    kAcc += kInc * pWTIntFrame->rampOffset;
+#endif
+#endif
+#endif
+
+#if WT_KERNEL_RAMPED
+    gainIncrement = (pWTIntFrame->frame.gainTarget - pWTIntFrame->prevGain) * (1 << (16 - WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame)));
+    if (gainIncrement < 0)
+        gainIncrement++;
+    gain = pWTIntFrame->prevGain * (1 << 16);
+#ifdef _LOW_LATENCY
+    gain += gainIncrement * pWTIntFrame->rampOffset;
+#endif
+#else
+    /* the gain is already in its integer part */
+    gain = pWTIntFrame->prevGain;
+#endif
+
+#if (NUM_OUTPUT_CHANNELS == 2)
+    gainLeft = pWTVoice->gainLeft;
+    gainRight = pWTVoice->gainRight;
+#endif
+
+    /* fetch adjacent samples */
+#if WT_KERNEL_CUBIC
+    WT_CubicFetch(pWTVoice, pSamples, WT_KERNEL_LOOPED, taps);
+#elif defined(_8_BIT_SAMPLES)
+    /*lint -e{701} <avoid multiply for performance>*/
+    samp1 = pSamples[0] << 8;
+    /*lint -e{701} <avoid multiply for performance>*/
+    samp2 = pSamples[1] << 8;
+#else
+    samp1 = pSamples[0];
+    samp2 = pSamples[1];
+#endif
+
+    while (numSamples--) {
+
+#if WT_KERNEL_CUBIC
+        /* cubic interpolation */
+        /*lint -e{704} <avoid divide>*/
+        frac = phaseFrac >> (NUM_PHASE_FRAC_BITS - WT_CUBIC_FRAC_BITS);
+        c1 = taps[2] - taps[0];
+        c2 = 2 * taps[0] - 5 * taps[1] + 4 * taps[2] - taps[3];
+        c3 = taps[3] - taps[0] + 3 * (taps[1] - taps[2]);
+        /*lint -e{704} <avoid divide>*/
+        acc0 = ((c3 * frac) >> WT_CUBIC_FRAC_BITS) + c2;
+        /*lint -e{704} <avoid divide>*/
+        acc0 = ((acc0 * frac) >> WT_CUBIC_FRAC_BITS) + c1;
+        /*lint -e{704} <avoid divide>*/
+        acc0 = taps[1] + ((acc0 * frac) >> (WT_CUBIC_FRAC_BITS + 1));
+#else
+        /* linear interpolation */
+        acc0 = samp2 - samp1;
+        acc0 = acc0 * phaseFrac;
+        /*lint -e{704} <avoid divide>*/
+        acc0 = samp1 + (acc0 >> NUM_PHASE_FRAC_BITS);
+#endif
+
+        /* truncate to the width of the voice buffer it replaces */
+        /*lint -e{704} <avoid divide>*/
+        acc0 = (EAS_I16)(acc0 >> 2);
+
+#if WT_KERNEL_FILTERED
+#ifdef _FILTER_RAMP
+        /* step the coefficients toward their targets */
+        b1Acc += b1Inc;
+        b2Acc += b2Inc;
+        kAcc += kInc;
+        /*lint -e{702} <avoid divide> */
+        b1 = b1Acc >> rampBits;
+        /*lint -e{702} <avoid divide> */
+        b2 = b2Acc >> rampBits;
+        /*lint -e{702} <avoid divide> */
+        k = kAcc >> rampBits;
+#endif
+
+        /* do filter calculations, the delay keeps the full result */
+        acc0 = z1 * b1 + z2 * b2 + k * acc0;
+        z2 = z1;
+        /*lint -e{702} <avoid divide> */
+        z1 = acc0 >> 14;
+        acc0 = (EAS_I16) z1;
+#endif
+
+        /* scale sample by gain, incrementally to prevent zipper noise */
+#if WT_KERNEL_RAMPED
+        gain += gainIncrement;
+        /*lint -e{704} <avoid divide>*/
+        acc0 *= gain >> 16;
+#else
+        acc0 *= gain;
+#endif
+
+#if (NUM_OUTPUT_CHANNELS == 2)
+        /*lint -e{704} <avoid divide>*/
+        acc0 = acc0 >> 14;
+        /*lint -e{704} <avoid divide>*/
+        pMixBuffer[0] += (acc0 * gainLeft) >> NUM_MIXER_GUARD_BITS;
+        /*lint -e{704} <avoid divide>*/
+        pMixBuffer[1] += (acc0 * gainRight) >> NUM_MIXER_GUARD_BITS;
+        pMixBuffer += 2;
+#else
+        /*lint -e{704} <avoid divide>*/
+        *pMixBuffer++ += acc0 >> (NUM_MIXER_GUARD_BITS - 1);
+#endif
+
+        /* increment phase */
+        phaseFrac += phaseInc;
+        /*lint -e{704} <avoid divide>*/
+        acc0 = phaseFrac >> NUM_PHASE_FRAC_BITS;
+
+        /* next sample */
+        if (acc0 > 0) {
+
+            /* advance sample pointer */
+            pSamples += acc0;
+            phaseFrac = (EAS_I32)((EAS_U32)phaseFrac & PHASE_FRAC_MASK);
+
+#if WT_KERNEL_LOOPED
+            /* check for loop end */
+            acc0 = (EAS_I32) (pSamples - loopEnd);
+            if (acc0 >= 0)
+                pSamples = (const EAS_SAMPLE*) pWTVoice->loopStart + acc0;
+#endif
+
+            /* fetch new samples */
+#if WT_KERNEL_CUBIC
+            WT_CubicFetch(pWTVoice, pSamples, WT_KERNEL_LOOPED, taps);
+#elif defined(_8_BIT_SAMPLES)
+            /*lint -e{701} <avoid multiply for performance>*/
+            samp1 = pSamples[0] << 8;
+            /*lint -e{701} <avoid multiply for performance>*/
+            samp2 = pSamples[1] << 8;
+#else
+            samp1 = pSamples[0];
+            samp2 = pSamples[1];
+#endif
+        }
+    }
+
+    /* save pointer and phase */
+    pWTVoice->phaseAccum = (EAS_U32) pSamples;
+    pWTVoice->phaseFrac = (EAS_U32) phaseFrac;
+
+#if WT_KERNEL_FILTERED
+    /* save delay values */
+    pWTVoice->filter.z1 = (EAS_I16) z1;
+    pWTVoice->filter.z2 = (EAS_I16) z2;
+#endif
+}
+
+#undef WT_KERNEL_NAME
+#undef WT_KERNEL_LOOPED
+#undef WT_KERNEL_FILTERED
+#undef WT_KERNEL_RAMPED
+#undef WT_KERNEL_CUBIC
@@ -0,0 +1,506 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_wtoffload.c
+ *
+ * Contents and purpose:
+ * Both sides of the split architecture wavetable synth. The WTE_ functions
+ * called by the voice manager write messages to the ring in a shared
+ * memory frame buffer, WTE_RunEngine reads them in the render process or
+ * on the DSP, synthesizes the off-chip voices and mixes them into the
+ * frame buffer, which WTE_EndFrame adds to the host mix.
+ *
+ * The ring has one writer and one reader, so it needs no locks. Only the
+ * head, tail and frameDone counters are written with release semantics and
+ * read with acquire semantics, everything else in the frame buffer is
+ * owned by one side until the counter handing it over is published.
+ *
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#include "eas_synthcfg.h"
+
+#ifdef EAS_SPLIT_WT_SYNTH
+
+#include "eas_host.h"
+#include "eas_math.h"
+#include "eas_report.h"
+#include "eas_wtoffload.h"
+
+#if (NUM_SECONDARY_VOICES <= 0)
+#error "EAS_SPLIT_WT_SYNTH requires NUM_PRIMARY_VOICES less than MAX_SYNTH_VOICES"
+#endif
+
+/* host sleep between polls of the engine at the end of a frame, in microseconds */
+#define WT_OFFLOAD_POLL_INTERVAL        20
+
+/*----------------------------------------------------------------------------
+ * WTE_InitFrameBuffer()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Prepares a frame buffer. Call once, before the host attaches it with
+ * EAS_SetFrameBuffer and before the engine calls WTE_InitEngine.
+ *
+ * Inputs:
+ * pFrameBuffer - the frame buffer, in memory both sides can reach
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void WTE_InitFrameBuffer (S_EAS_FRAME_BUFFER *pFrameBuffer)
+{
+    EAS_HWMemSet(pFrameBuffer, 0, (EAS_I32) sizeof(S_EAS_FRAME_BUFFER));
+    pFrameBuffer->version = WT_OFFLOAD_VERSION;
+}
+
+/*----------------------------------------------------------------------------
+ * WTE_NewMessage()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the next free message of the ring. If the ring is full, the
+ * engine gets a while to catch up before the message is dropped.
+ *
+ * Inputs:
+ * pFrameBuffer - the frame buffer
+ *
+ * Outputs:
+ * Pointer to the message, or NULL if the ring is still full
+ *
+ *----------------------------------------------------------------------------
+*/
+static S_WT_MESSAGE *WTE_NewMessage (S_EAS_FRAME_BUFFER *pFrameBuffer)
+{
+    EAS_U32 head;
+    EAS_I32 polls;
+
+    head = pFrameBuffer->head;
+    for (polls = 0; (EAS_U32) (head - EAS_HWAtomicLoad(&pFrameBuffer->tail)) >= WT_OFFLOAD_RING_SIZE; polls++)
+    {
+        if (polls >= WT_OFFLOAD_FULL_POLLS)
+        {
+            pFrameBuffer->dropped++;
+            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "WTE_NewMessage: ring full, message dropped\n"); */ }
+            return NULL;
+        }
+    }
+    return &pFrameBuffer->ring[head & WT_OFFLOAD_RING_MASK];
+}
+
+/*----------------------------------------------------------------------------
+ * WTE_PostMessage()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Hands the message returned by WTE_NewMessage to the engine
+ *
+ * Inputs:
+ * pFrameBuffer - the frame buffer
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE void WTE_PostMessage (S_EAS_FRAME_BUFFER *pFrameBuffer)
+{
+    EAS_HWAtomicStore(&pFrameBuffer->head, pFrameBuffer->head + 1);
+}
+
+/*----------------------------------------------------------------------------
+ * WTE_StartFrame()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Starts an audio frame. The on-chip voices and the effects still run on
+ * the host, so the host mix engine is always used.
+ *
+ * Inputs:
+ * pFrameBuffer - the frame buffer, or NULL if none is attached
+ *
+ * Outputs:
+ * EAS_TRUE
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pFrameBuffer) not used */
+EAS_BOOL WTE_StartFrame (EAS_FRAME_BUFFER_HANDLE pFrameBuffer)
+{
+    return EAS_TRUE;
+}
+
+/*----------------------------------------------------------------------------
+ * WTE_ConfigVoice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sends the start of a note on an off-chip voice to the engine
+ *
+ * Inputs:
+ * voiceNum - the off-chip voice, 0 is the first
+ * pWTConfig - sample addresses as offsets into the sample data, and gains
+ * pFrameBuffer - the frame buffer, or NULL if none is attached
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void WTE_ConfigVoice (EAS_I32 voiceNum, S_WT_CONFIG *pWTConfig, EAS_FRAME_BUFFER_HANDLE pFrameBuffer)
+{
+    S_WT_MESSAGE *pMsg;
+
+    /* without an engine the off-chip voices are silent */
+    if ((pFrameBuffer == NULL) || ((pMsg = WTE_NewMessage(pFrameBuffer)) == NULL))
+        return;
+
+    pMsg->type = WT_MSG_CONFIG;
+    pMsg->voiceNum = voiceNum;
+    pMsg->u.config = *pWTConfig;
+    WTE_PostMessage(pFrameBuffer);
+}
+
+/*----------------------------------------------------------------------------
+ * WTE_ProcessVoice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sends the parameters of a block of an off-chip voice to the engine
+ *
+ * Inputs:
+ * voiceNum - the off-chip voice, 0 is the first
+ * pWTVoice - host state of the voice
+ * pWTIntFrame - parameters of the block, the buffer pointers are not sent
+ * mixOffset - first sample of the block in the frame
+ * pFrameBuffer - the frame buffer, or NULL if none is attached
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * The host phase moves as far as the engine moves it. WT_CheckSampleEnd
+ * finds the end of an unlooped sample from it, and the next note on the
+ * voice starts at the fraction left by this one, as it does on-chip.
+ *
+ *----------------------------------------------------------------------------
+*/
+void WTE_ProcessVoice (EAS_I32 voiceNum, S_WT_VOICE *pWTVoice, const S_WT_INT_FRAME *pWTIntFrame, EAS_I32 mixOffset, EAS_FRAME_BUFFER_HANDLE pFrameBuffer)
+{
+    S_WT_MESSAGE *pMsg;
+    S_WT_PROCESS *pProcess;
+    EAS_U32 phaseFrac;
+
+    if ((pWTIntFrame->numSamples > 0)
+#ifdef _TONE_GENERATORS
+        && (pWTVoice->loopStart != WT_SQUARE_GENERATOR)
+#endif
+        )
+    {
+        phaseFrac = pWTVoice->phaseFrac + (EAS_U32) pWTIntFrame->frame.phaseIncrement * (EAS_U32) pWTIntFrame->numSamples;
+        if ((pWTVoice->loopStart != WT_NOISE_GENERATOR) && (pWTVoice->loopStart == pWTVoice->loopEnd))
+        {
+#if defined (_8_BIT_SAMPLES)
+            pWTVoice->phaseAccum += GET_PHASE_INT_PART(phaseFrac);
+#else //_16_BIT_SAMPLES
+            pWTVoice->phaseAccum += GET_PHASE_INT_PART(phaseFrac) << 1;
+#endif
+        }
+        pWTVoice->phaseFrac = phaseFrac & PHASE_FRAC_MASK;
+    }
+
+    if ((pFrameBuffer == NULL) || (pWTIntFrame->numSamples <= 0) || ((pMsg = WTE_NewMessage(pFrameBuffer)) == NULL))
+        return;
+
+    pMsg->type = WT_MSG_PROCESS;
+    pMsg->voiceNum = voiceNum;
+    pProcess = &pMsg->u.process;
+    pProcess->frame = pWTIntFrame->frame;
+    pProcess->prevGain = pWTIntFrame->prevGain;
+    pProcess->numSamples = pWTIntFrame->numSamples;
+    pProcess->mixOffset = mixOffset;
+#ifdef _RUNTIME_SAMPLE_RATE
+    pProcess->rateShift = pWTIntFrame->rateShift;
+#endif
+#ifdef _CUBIC_INTERPOLATION
+    pProcess->cubic = pWTIntFrame->cubic;
+#endif
+#ifdef _LOW_LATENCY
+    pProcess->rampOffset = pWTIntFrame->rampOffset;
+#endif
+#if defined(_FILTER_ENABLED) && defined(_FILTER_RAMP)
+    /* the engine ramps from the coefficients the host saved last period */
+    pProcess->k = pWTVoice->filter.k;
+    pProcess->b1 = pWTVoice->filter.b1;
+    pProcess->b2 = pWTVoice->filter.b2;
+#endif
+    WTE_PostMessage(pFrameBuffer);
+}
+
+/*----------------------------------------------------------------------------
+ * WTE_EndFrame()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Ends an audio frame. Waits for the engine to mix the frame and adds its
+ * mix to the host mix. A frame the engine does not finish in time is
+ * dropped, the off-chip voices are silent for that frame.
+ *
+ * Inputs:
+ * hwInstData - host instance data, for waiting
+ * pFrameBuffer - the frame buffer, or NULL if none is attached
+ * pMixBuffer - host mix of the frame
+ * masterGain - applied by the host post-processing
+ *
+ * Outputs:
+ * EAS_TRUE, the host post-processing always runs
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, masterGain) not used */
+EAS_BOOL WTE_EndFrame (EAS_HW_DATA_HANDLE hwInstData, EAS_FRAME_BUFFER_HANDLE pFrameBuffer, EAS_I32 *pMixBuffer, EAS_I16 masterGain)
+{
+    S_WT_MESSAGE *pMsg;
+    EAS_U32 startTime;
+    EAS_I32 count;
+    EAS_I32 i;
+
+    if ((pFrameBuffer == NULL) || ((pMsg = WTE_NewMessage(pFrameBuffer)) == NULL))
+        return EAS_TRUE;
+
+    pMsg->type = WT_MSG_END_FRAME;
+    pMsg->voiceNum = 0;
+    WTE_PostMessage(pFrameBuffer);
+    pFrameBuffer->frameCount++;
+
+    /* a late frame is still counted when it ends, so the next frame catches up */
+    startTime = EAS_HWGetTime(hwInstData);
+    while (EAS_HWAtomicLoad(&pFrameBuffer->frameDone) != pFrameBuffer->frameCount)
+    {
+        if ((EAS_U32) (EAS_HWGetTime(hwInstData) - startTime) > WT_OFFLOAD_TIMEOUT)
+        {
+            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "WTE_EndFrame: engine missed frame %u\n", pFrameBuffer->frameCount); */ }
+            return EAS_TRUE;
+        }
+        EAS_HWSleep(hwInstData, WT_OFFLOAD_POLL_INTERVAL);
+    }
+
+    count = pFrameBuffer->mixSamples * NUM_OUTPUT_CHANNELS;
+    if (count > WT_OFFLOAD_MIX_SIZE)
+        count = WT_OFFLOAD_MIX_SIZE;
+    for (i = 0; i < count; i++)
+        pMixBuffer[i] += pFrameBuffer->mix[i];
+    return EAS_TRUE;
+}
+
+/*----------------------------------------------------------------------------
+ * WTE_InitEngine()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Prepares the engine side of a frame buffer
+ *
+ * Inputs:
+ * pEngine - engine state
+ * pFrameBuffer - the frame buffer, prepared by WTE_InitFrameBuffer
+ * pSamples - the sample data of the sound library the host plays, the
+ *            sample offsets the host sends are relative to it
+ *
+ * Outputs:
+ * EAS_ERROR_INCOMPATIBLE_VERSION if the frame buffer has another layout
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT WTE_InitEngine (S_WT_OFFLOAD_ENGINE *pEngine, S_EAS_FRAME_BUFFER *pFrameBuffer, const void *pSamples)
+{
+    if (pFrameBuffer->version != WT_OFFLOAD_VERSION)
+        return EAS_ERROR_INCOMPATIBLE_VERSION;
+
+    EAS_HWMemSet(pEngine, 0, (EAS_I32) sizeof(S_WT_OFFLOAD_ENGINE));
+    pEngine->pFrameBuffer = pFrameBuffer;
+    pEngine->pSamples = (const EAS_U8*) pSamples;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * WTE_EngineConfig()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Starts a note on an off-chip voice
+ *
+ * Inputs:
+ * pEngine - engine state
+ * pWTVoice - the voice
+ * pWTConfig - the message
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void WTE_EngineConfig (S_WT_OFFLOAD_ENGINE *pEngine, S_WT_VOICE *pWTVoice, const S_WT_CONFIG *pWTConfig)
+{
+    EAS_U32 base;
+
+    pWTVoice->loopEnd = pWTConfig->loopEnd;
+    pWTVoice->loopStart = pWTConfig->loopStart;
+    pWTVoice->phaseAccum = pWTConfig->phaseAccum;
+    pWTVoice->phaseFrac = pWTConfig->phaseFrac;
+#ifdef _CUBIC_INTERPOLATION
+    pWTVoice->sampleStart = pWTConfig->sampleStart;
+#endif
+
+    /* the generators hold their state in these fields instead of addresses */
+    if ((pWTVoice->loopStart != WT_NOISE_GENERATOR)
+#ifdef _TONE_GENERATORS
+        && (pWTVoice->loopStart != WT_SQUARE_GENERATOR)
+#endif
+        )
+    {
+        base = (EAS_U32) pEngine->pSamples;
+        pWTVoice->loopEnd += base;
+        pWTVoice->loopStart += base;
+        pWTVoice->phaseAccum += base;
+#ifdef _CUBIC_INTERPOLATION
+        pWTVoice->sampleStart += base;
+#endif
+    }
+
+#if (NUM_OUTPUT_CHANNELS == 2)
+    pWTVoice->gainLeft = pWTConfig->gainLeft;
+    pWTVoice->gainRight = pWTConfig->gainRight;
+#endif
+
+#if defined(_FILTER_ENABLED)
+    pWTVoice->filter.z1 = 0;
+    pWTVoice->filter.z2 = 0;
+#endif
+
+#ifdef _WT_ADPCM
+    /* the host keeps compressed samples on-chip */
+    pWTVoice->flags = 0;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * WTE_EngineProcess()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Synthesizes a block of an off-chip voice into the mix of the frame
+ *
+ * Inputs:
+ * pEngine - engine state
+ * pWTVoice - the voice
+ * pProcess - the message
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void WTE_EngineProcess (S_WT_OFFLOAD_ENGINE *pEngine, S_WT_VOICE *pWTVoice, const S_WT_PROCESS *pProcess)
+{
+    S_WT_INT_FRAME intFrame;
+    EAS_I32 end;
+
+    /* a corrupt message must not write outside the mix */
+    if ((pProcess->numSamples <= 0) || (pProcess->numSamples > MAX_SYNTH_UPDATE_PERIOD_IN_SAMPLES) ||
+        (pProcess->mixOffset < 0) || (pProcess->mixOffset > MAX_BLOCK_SIZE_IN_MONO_SAMPLES - pProcess->numSamples))
+        return;
+
+    intFrame.frame = pProcess->frame;
+    intFrame.pAudioBuffer = pEngine->voiceBuffer;
+    intFrame.numSamples = pProcess->numSamples;
+    intFrame.prevGain = pProcess->prevGain;
+#ifdef _RUNTIME_SAMPLE_RATE
+    intFrame.rateShift = pProcess->rateShift;
+#endif
+#ifdef _CUBIC_INTERPOLATION
+    intFrame.cubic = pProcess->cubic;
+#endif
+#ifdef _LOW_LATENCY
+    intFrame.rampOffset = pProcess->rampOffset;
+#endif
+#if defined(_FILTER_ENABLED) && defined(_FILTER_RAMP)
+    pWTVoice->filter.k = pProcess->k;
+    pWTVoice->filter.b1 = pProcess->b1;
+    pWTVoice->filter.b2 = pProcess->b2;
+#endif
+
+    /* the mix is cleared as the frame reaches it */
+    end = pProcess->mixOffset + pProcess->numSamples;
+    if (end > pEngine->mixSamples)
+    {
+        EAS_HWMemSet(&pEngine->pFrameBuffer->mix[pEngine->mixSamples * NUM_OUTPUT_CHANNELS], 0,
+            (end - pEngine->mixSamples) * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_I32));
+        pEngine->mixSamples = end;
+    }
+    intFrame.pMixBuffer = &pEngine->pFrameBuffer->mix[pProcess->mixOffset * NUM_OUTPUT_CHANNELS];
+
+    WT_ProcessVoice(pWTVoice, &intFrame);
+}
+
+/*----------------------------------------------------------------------------
+ * WTE_RunEngine()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Handles the messages in the ring. The render process or DSP calls this
+ * in a loop, waiting a little whenever it returns EAS_FALSE.
+ *
+ * Inputs:
+ * pEngine - engine state
+ *
+ * Outputs:
+ * EAS_TRUE if any messages were handled
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL WTE_RunEngine (S_WT_OFFLOAD_ENGINE *pEngine)
+{
+    S_EAS_FRAME_BUFFER *pFrameBuffer;
+    const S_WT_MESSAGE *pMsg;
+    EAS_U32 head;
+    EAS_U32 tail;
+
+    pFrameBuffer = pEngine->pFrameBuffer;
+    head = EAS_HWAtomicLoad(&pFrameBuffer->head);
+    tail = pFrameBuffer->tail;
+    if (head == tail)
+        return EAS_FALSE;
+
+    while (tail != head)
+    {
+        pMsg = &pFrameBuffer->ring[tail & WT_OFFLOAD_RING_MASK];
+        switch (pMsg->type)
+        {
+            case WT_MSG_CONFIG:
+                if ((pMsg->voiceNum >= 0) && (pMsg->voiceNum < NUM_SECONDARY_VOICES))
+                    WTE_EngineConfig(pEngine, &pEngine->voices[pMsg->voiceNum], &pMsg->u.config);
+                break;
+
+            case WT_MSG_PROCESS:
+                if ((pMsg->voiceNum >= 0) && (pMsg->voiceNum < NUM_SECONDARY_VOICES))
+                    WTE_EngineProcess(pEngine, &pEngine->voices[pMsg->voiceNum], &pMsg->u.process);
+                break;
+
+            case WT_MSG_END_FRAME:
+                /* the mix belongs to the host until its next message */
+                pFrameBuffer->mixSamples = pEngine->mixSamples;
+                pEngine->mixSamples = 0;
+                EAS_HWAtomicStore(&pFrameBuffer->frameDone, pFrameBuffer->frameDone + 1);
+                break;
+
+            default:
+                { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "WTE_RunEngine: unknown message %u\n", pMsg->type); */ }
+                break;
+        }
+        tail++;
+        EAS_HWAtomicStore(&pFrameBuffer->tail, tail);
+    }
+    return EAS_TRUE;
+}
+
+#endif /* #ifdef EAS_SPLIT_WT_SYNTH */
@@ -0,0 +1,121 @@
+/*----------------------------------------------------------------------------
+ *
+ * File:
+ * eas_wtoffload.h
+ *
+ * Contents and purpose:
+ * Shared memory frame buffer for the split architecture wavetable synth.
+ * The voice manager runs on the host processor and sends the parameters
+ * of the off-chip voices through a ring of messages in the frame buffer
+ * to a wavetable engine running in another process or on a DSP, which
+ * returns the mix of those voices for each audio frame.
+ *
+ *
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+#ifndef _EAS_WTOFFLOAD_H
+#define _EAS_WTOFFLOAD_H
+
+#include "eas_types.h"
+#include "eas_audioconst.h"
+#include "eas_synth.h"
+#include "eas_wtengine.h"
+
+#ifdef EAS_SPLIT_WT_SYNTH
+
+/*------------------------------------
+ * defines
+ *------------------------------------
+*/
+
+/* messages in the ring, a power of 2 */
+#ifndef WT_OFFLOAD_RING_SIZE
+#define WT_OFFLOAD_RING_SIZE            512
+#endif
+#define WT_OFFLOAD_RING_MASK            (WT_OFFLOAD_RING_SIZE - 1)
+
+/* longest the host waits for the engine to finish a frame, in microseconds */
+#ifndef WT_OFFLOAD_TIMEOUT
+#define WT_OFFLOAD_TIMEOUT              100000
+#endif
+
+/* polls of a full ring before the host drops a message */
+#define WT_OFFLOAD_FULL_POLLS           100000
+
+/* version of the layout, the engine does not run a frame buffer of another */
+#define WT_OFFLOAD_VERSION              1
+
+/* samples in the engine's mix of a frame */
+#define WT_OFFLOAD_MIX_SIZE             (MAX_BLOCK_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS)
+
+/*------------------------------------
+ * S_EAS_FRAME_BUFFER
+ *
+ * The frame buffer lives in memory shared by the host and the engine and
+ * holds no pointers, so the two may map it at different addresses. The
+ * host writes head and the engine writes tail and frameDone, both count
+ * up forever and only their difference is meaningful.
+ *------------------------------------
+*/
+typedef struct s_eas_frame_buffer_tag
+{
+    EAS_U32             version;
+
+    volatile EAS_U32    head;                   /* messages written by the host */
+    volatile EAS_U32    tail;                   /* messages read by the engine */
+    volatile EAS_U32    frameDone;              /* frames mixed by the engine */
+
+    EAS_U32             frameCount;             /* frames sent by the host */
+    EAS_U32             dropped;                /* messages lost to a full ring */
+
+    EAS_I32             mixSamples;             /* samples of the frame in mix, written before frameDone */
+    EAS_I32             mix[WT_OFFLOAD_MIX_SIZE];
+
+    S_WT_MESSAGE        ring[WT_OFFLOAD_RING_SIZE];
+} S_EAS_FRAME_BUFFER;
+
+/*------------------------------------
+ * S_WT_OFFLOAD_ENGINE
+ *
+ * State of the engine side, private to the engine
+ *------------------------------------
+*/
+typedef struct s_wt_offload_engine_tag
+{
+    S_EAS_FRAME_BUFFER  *pFrameBuffer;
+    const EAS_U8        *pSamples;              /* sample data of the sound library */
+    EAS_I32             mixSamples;             /* samples of mix cleared in this frame */
+    S_WT_VOICE          voices[NUM_SECONDARY_VOICES];
+    EAS_PCM             voiceBuffer[MAX_SYNTH_UPDATE_PERIOD_IN_SAMPLES];
+} S_WT_OFFLOAD_ENGINE;
+
+/*------------------------------------
+ * prototypes
+ *------------------------------------
+*/
+
+/* prepares a frame buffer before either side uses it */
+void WTE_InitFrameBuffer (S_EAS_FRAME_BUFFER *pFrameBuffer);
+
+/* engine side */
+EAS_RESULT WTE_InitEngine (S_WT_OFFLOAD_ENGINE *pEngine, S_EAS_FRAME_BUFFER *pFrameBuffer, const void *pSamples);
+EAS_BOOL WTE_RunEngine (S_WT_OFFLOAD_ENGINE *pEngine);
+
+#endif /* #ifdef EAS_SPLIT_WT_SYNTH */
+
+#endif /* #ifndef _EAS_WTOFFLOAD_H */
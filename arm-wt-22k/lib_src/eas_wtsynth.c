@@ -28,10 +28,6 @@
 */
 
 // includes
-#define LOG_TAG "SYNTH"
-#include "log/log.h"
-#include <cutils/log.h>
-
 #include "eas_data.h"
 #include "eas_report.h"
 #include "eas_host.h"
@@ -39,11 +35,16 @@
 #include "eas_synth_protos.h"
 #include "eas_wtsynth.h"
 #include "eas_pan.h"
+#include "eas_diag.h"
 
 #ifdef DLS_SYNTHESIZER
 #include "eas_dlssynth.h"
 #endif
 
+#ifdef _FM_FALLBACK
+#include "eas_fmengine.h"
+#endif
+
 #ifdef _METRICS_ENABLED
 #include "eas_perf.h"
 #endif
@@ -54,18 +55,13 @@ static void WT_ReleaseVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VO
 static void WT_MuteVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum);
 static void WT_SustainPedal (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, S_SYNTH_CHANNEL *pChannel, EAS_I32 voiceNum);
 static EAS_RESULT WT_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum, EAS_U16 regionIndex);
-static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum, EAS_I32 *pMixBuffer, EAS_I32 numSamples);
+static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum, EAS_PCM *pVoiceBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSamples);
 static void WT_UpdateChannel (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel);
 static EAS_I32 WT_UpdatePhaseInc (S_WT_VOICE *pWTVoice, const S_ARTICULATION *pArt, S_SYNTH_CHANNEL *pChannel, EAS_I32 pitchCents);
 static EAS_I32 WT_UpdateGain (S_SYNTH_VOICE *pVoice, S_WT_VOICE *pWTVoice, const S_ARTICULATION *pArt, S_SYNTH_CHANNEL *pChannel, EAS_I32 gain);
 static void WT_UpdateEG1 (S_WT_VOICE *pWTVoice, const S_ENVELOPE *pEnv);
 static void WT_UpdateEG2 (S_WT_VOICE *pWTVoice, const S_ENVELOPE *pEnv);
 
-#ifdef EAS_SPLIT_WT_SYNTH
-extern EAS_BOOL WTE_StartFrame (EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
-extern EAS_BOOL WTE_EndFrame (EAS_FRAME_BUFFER_HANDLE pFrameBuffer, EAS_I32 *pMixBuffer, EAS_I16 masterGain);
-#endif
-
 #ifdef _FILTER_ENABLED
 static void WT_UpdateFilter (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pIntFrame, const S_ARTICULATION *pArt);
 #endif
@@ -118,7 +114,7 @@ static EAS_RESULT WT_Initialize (S_VOICE_MGR *pVoiceMgr)
 {
     EAS_INT i;
 
-    for (i = 0; i < NUM_WT_VOICES; i++)
+    for (i = 0; i < VM_NUM_VOICES(pVoiceMgr); i++)
     {
 
         pVoiceMgr->wtVoices[i].artIndex = DEFAULT_ARTICULATION_INDEX;
@@ -144,6 +140,10 @@ static EAS_RESULT WT_Initialize (S_VOICE_MGR *pVoiceMgr)
         pVoiceMgr->wtVoices[i].filter.z1 = DEFAULT_FILTER_ZERO;
         pVoiceMgr->wtVoices[i].filter.z2 = DEFAULT_FILTER_ZERO;
 #endif
+
+#ifdef _WT_ADPCM
+        pVoiceMgr->wtVoices[i].flags = 0;
+#endif
     }
 
     return EAS_TRUE;
@@ -177,6 +177,14 @@ static void WT_ReleaseVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VO
     }
 #endif
 
+#ifdef _FM_FALLBACK
+    if (pVoice->regionIndex & FLAG_RGN_IDX_FM_SYNTH)
+    {
+        FM_ReleaseVoice(pVoiceMgr, pSynth, pVoice, voiceNum);
+        return;
+    }
+#endif
+
     pWTVoice = &pVoiceMgr->wtVoices[voiceNum];
     pArticulation = &pSynth->pEAS->pArticulations[pWTVoice->artIndex];
 
@@ -220,6 +228,14 @@ static void WT_MuteVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     }
 #endif
 
+#ifdef _FM_FALLBACK
+    if (pVoice->regionIndex & FLAG_RGN_IDX_FM_SYNTH)
+    {
+        FM_MuteVoice(pVoiceMgr, pSynth, pVoice, voiceNum);
+        return;
+    }
+#endif
+
     /* clear deferred action flags */
     pVoice->voiceFlags &=
         ~(VOICE_FLAG_DEFER_MIDI_NOTE_OFF |
@@ -257,6 +273,14 @@ static void WT_SustainPedal (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VO
     }
 #endif
 
+#ifdef _FM_FALLBACK
+    if (pVoice->regionIndex & FLAG_RGN_IDX_FM_SYNTH)
+    {
+        FM_SustainPedal(pVoiceMgr, pSynth, pVoice, pChannel, voiceNum);
+        return;
+    }
+#endif
+
     /* don't catch the voice if below the sustain level */
     pWTVoice = &pVoiceMgr->wtVoices[voiceNum];
     if (pWTVoice->eg1Value < pSynth->pEAS->pArticulations[pWTVoice->artIndex].eg1.sustainLevel)
@@ -331,6 +355,16 @@ static EAS_RESULT WT_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNT
     pWTVoice = &pVoiceMgr->wtVoices[voiceNum];
     pChannel = &pSynth->channels[pVoice->channel & 15];
 
+#ifdef _ARTICULATION_CACHE
+    /* nothing carries over from the previous note on this voice */
+    WT_ResetCache(pWTVoice);
+#endif
+
+#ifdef _LOW_LATENCY
+    /* the first slice of the note updates its parameters */
+    pWTVoice->frameLeft = 0;
+#endif
+
     /* update static channel parameters */
     if (pChannel->channelFlags & CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS)
         WT_UpdateChannel(pVoiceMgr, pSynth, pVoice->channel & 15);
@@ -340,6 +374,11 @@ static EAS_RESULT WT_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNT
         return DLS_StartVoice(pVoiceMgr, pSynth, pVoice, voiceNum, regionIndex);
 #endif
 
+#ifdef _FM_FALLBACK
+    if (pVoice->regionIndex & FLAG_RGN_IDX_FM_SYNTH)
+        return FM_StartVoice(pVoiceMgr, pSynth, pVoice, voiceNum, regionIndex);
+#endif
+
     pRegion = &(pSynth->pEAS->pWTRegions[regionIndex]);
     pWTVoice->artIndex = pRegion->artIndex;
 
@@ -382,6 +421,25 @@ static EAS_RESULT WT_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNT
     pWTVoice->filter.z2 = 0;
 #endif
 
+#ifdef _WT_ADPCM
+    pWTVoice->flags = 0;
+#endif
+
+#ifdef _TONE_GENERATORS
+    /* a square generator counts its cycle in phaseAccum, the loop sets the period */
+    if ((pRegion->region.keyGroupAndFlags & (REGION_FLAG_USE_WAVE_GENERATOR | REGION_FLAG_SQUARE_WAVE)) ==
+        (REGION_FLAG_USE_WAVE_GENERATOR | REGION_FLAG_SQUARE_WAVE))
+    {
+        pWTVoice->phaseAccum = 0;
+        pWTVoice->loopStart = WT_SQUARE_GENERATOR;
+        if ((pRegion->region.keyGroupAndFlags & REGION_FLAG_IS_LOOPED) && (pRegion->loopEnd > pRegion->loopStart))
+            pWTVoice->loopEnd = pRegion->loopEnd - pRegion->loopStart;
+        else
+            pWTVoice->loopEnd = WT_SQUARE_DEFAULT_PERIOD;
+    }
+    else
+#endif
+
     /* if this wave is to be generated using noise generator */
     if (pRegion->region.keyGroupAndFlags & REGION_FLAG_USE_WAVE_GENERATOR)
     {
@@ -390,6 +448,15 @@ static EAS_RESULT WT_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNT
         pWTVoice->loopEnd = 4574295;
     }
 
+#ifdef _WT_ADPCM
+    /* compressed sample, decoded by the interpolator */
+    else if (pRegion->region.keyGroupAndFlags & REGION_FLAG_USE_ADPCM)
+    {
+        WT_StartADPCM(pWTVoice, (const EAS_U8*) pSynth->pEAS->pSamples + pSynth->pEAS->pSampleOffsets[pRegion->waveIndex],
+            pSynth->pEAS->pSampleLen[pRegion->waveIndex]);
+    }
+#endif
+
     /* normal sample */
     else
     {
@@ -402,6 +469,9 @@ static EAS_RESULT WT_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNT
 #else
         pWTVoice->phaseAccum = (EAS_U32) pSynth->pEAS->pSamples + pSynth->pEAS->pSampleOffsets[pRegion->waveIndex];
 #endif
+#ifdef _CUBIC_INTERPOLATION
+        pWTVoice->sampleStart = pWTVoice->phaseAccum;
+#endif
 
         if (pRegion->region.keyGroupAndFlags & REGION_FLAG_IS_LOOPED)
         {
@@ -427,6 +497,10 @@ static EAS_RESULT WT_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNT
     if (voiceNum >= NUM_PRIMARY_VOICES)
     {
         wtConfig.phaseAccum = pWTVoice->phaseAccum;
+        wtConfig.phaseFrac = pWTVoice->phaseFrac;
+#ifdef _CUBIC_INTERPOLATION
+        wtConfig.sampleStart = pWTVoice->sampleStart;
+#endif
         wtConfig.loopStart = pWTVoice->loopStart;
         wtConfig.loopEnd = pWTVoice->loopEnd;
         wtConfig.gain = pVoice->gain;
@@ -466,7 +540,7 @@ EAS_BOOL WT_CheckSampleEnd (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame, E
 
     /* check to see if we hit the end of the waveform this time */
     /*lint -e{703} use shift for performance */
-    endPhaseFrac = pWTVoice->phaseFrac + (pWTIntFrame->frame.phaseIncrement << SYNTH_UPDATE_PERIOD_IN_BITS);
+    endPhaseFrac = pWTVoice->phaseFrac + (pWTIntFrame->frame.phaseIncrement << WT_UPDATE_PERIOD_IN_BITS(pWTIntFrame));
 #if defined (_8_BIT_SAMPLES)
     endPhaseAccum = pWTVoice->phaseAccum + GET_PHASE_INT_PART(endPhaseFrac);
 #else //_16_BIT_SAMPLES
@@ -489,8 +563,7 @@ EAS_BOOL WT_CheckSampleEnd (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame, E
             pWTIntFrame->numSamples = numSamples;
         }
         if (pWTIntFrame->numSamples < 0) {
-            ALOGE("b/26366256");
-            android_errorWriteLog(0x534e4554, "26366256");
+            EAS_DIAG_POST(eDiagSampleEnd, pWTIntFrame->numSamples);
             pWTIntFrame->numSamples = 0;
         }
 
@@ -526,7 +599,7 @@ EAS_BOOL WT_CheckSampleEnd (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame, E
  *
  *----------------------------------------------------------------------------
 */
-static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum, EAS_I32 *pMixBuffer, EAS_I32  numSamples)
+static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE *pVoice, EAS_I32 voiceNum, EAS_PCM *pVoiceBuffer, EAS_I32 *pMixBuffer, EAS_I32  numSamples)
 {
     S_WT_VOICE *pWTVoice;
     S_WT_INT_FRAME intFrame;
@@ -536,9 +609,21 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
     EAS_I32 temp;
     EAS_BOOL done;
 
+#ifdef _FM_FALLBACK
+    /* FM voices keep their own slice state */
+    if (pVoice->regionIndex & FLAG_RGN_IDX_FM_SYNTH)
+        return FM_UpdateVoice(pVoiceMgr, pSynth, pVoice, voiceNum, pVoiceBuffer, pMixBuffer, numSamples);
+#endif
+
+#ifdef _LOW_LATENCY
+    /* later slices of an update period reuse its parameters */
+    if (pVoiceMgr->wtVoices[voiceNum].frameLeft > 0)
+        return WT_UpdateSlice(pVoiceMgr, pVoice, &pVoiceMgr->wtVoices[voiceNum], pVoiceBuffer, pMixBuffer, numSamples);
+#endif
+
 #ifdef DLS_SYNTHESIZER
     if (pVoice->regionIndex & FLAG_RGN_IDX_DLS_SYNTH)
-        return DLS_UpdateVoice(pVoiceMgr, pSynth, pVoice, voiceNum, pMixBuffer, numSamples);
+        return DLS_UpdateVoice(pVoiceMgr, pSynth, pVoice, voiceNum, pVoiceBuffer, pMixBuffer, numSamples);
 #endif
     /* establish pointers to critical data */
     pWTVoice = &pVoiceMgr->wtVoices[voiceNum];
@@ -546,6 +631,12 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
     pArt = &pSynth->pEAS->pArticulations[pWTVoice->artIndex];
     pChannel = &pSynth->channels[pVoice->channel & 15];
     intFrame.prevGain = pVoice->gain;
+#ifdef _RUNTIME_SAMPLE_RATE
+    intFrame.rateShift = pVoiceMgr->rateShift;
+#endif
+#ifdef _LOW_LATENCY
+    intFrame.rampOffset = 0;
+#endif
 
     /* update the envelopes */
     WT_UpdateEG1(pWTVoice, &pArt->eg1);
@@ -560,10 +651,18 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
         WT_UpdateFilter(pWTVoice, &intFrame, pArt);
     else
         intFrame.frame.k = 0;
+#ifdef _FILTER_RAMP
+    /* a new note has no earlier coefficients to ramp from */
+    if (pVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)
+        WT_SaveFilterCoeffs(pWTVoice, &intFrame.frame);
+#endif
 #endif
 
     /* update the gain */
     intFrame.frame.gainTarget = WT_UpdateGain(pVoice, pWTVoice, pArt, pChannel, pWTRegion->gain);
+#ifdef _CUBIC_INTERPOLATION
+    intFrame.cubic = WT_UseCubic(pVoiceMgr->interpolation, intFrame.frame.gainTarget);
+#endif
 
     /* calculate base pitch*/
     temp = pChannel->staticPitch + pWTRegion->tuning;
@@ -573,9 +672,18 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
         temp += pVoice->note * 100;
     else
         temp += (pVoice->note + pSynth->globalTranspose) * 100;
+
+#ifdef _RUNTIME_SAMPLE_RATE
+    /* each doubling of the output rate lowers the increment one octave */
+    temp -= intFrame.rateShift * 1200;
+#endif
     intFrame.frame.phaseIncrement = WT_UpdatePhaseInc(pWTVoice, pArt, pChannel, temp);
     if (pWTVoice->loopStart == WT_NOISE_GENERATOR) {
         temp = 0;
+#ifdef _TONE_GENERATORS
+    } else if (pWTVoice->loopStart == WT_SQUARE_GENERATOR) {
+        temp = 0;
+#endif
     } else {
         temp = pWTVoice->loopEnd - pWTVoice->loopStart;
     }
@@ -585,26 +693,35 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
     if (temp != 0) {
         temp = temp << NUM_PHASE_FRAC_BITS;
         if (intFrame.frame.phaseIncrement > temp) {
-            ALOGW("%p phaseIncrement=%d", pWTVoice, (int)intFrame.frame.phaseIncrement);
+            EAS_DIAG_POST(eDiagPhaseIncrement, intFrame.frame.phaseIncrement);
             intFrame.frame.phaseIncrement %= temp;
         }
     }
 
     /* call into engine to generate samples */
-    intFrame.pAudioBuffer = pVoiceMgr->voiceBuffer;
+    intFrame.pAudioBuffer = pVoiceBuffer;
     intFrame.pMixBuffer = pMixBuffer;
     intFrame.numSamples = numSamples;
 
     /* check for end of sample */
     if ((pWTVoice->loopStart != WT_NOISE_GENERATOR) && (pWTVoice->loopStart == pWTVoice->loopEnd))
-        done = WT_CheckSampleEnd(pWTVoice, &intFrame, (EAS_BOOL) (voiceNum >= NUM_PRIMARY_VOICES));
+        done = WT_CheckSampleEnd(pWTVoice, &intFrame, EAS_FALSE);
     else
         done = EAS_FALSE;
 
+#ifdef _LOW_LATENCY
+    /* a sample ending after this slice ends in a later slice of the update period */
+    if (done && (intFrame.numSamples > numSamples) && (pVoice->framePos + numSamples < VM_UPDATE_PERIOD(pVoiceMgr)))
+    {
+        intFrame.numSamples = numSamples;
+        done = EAS_FALSE;
+    }
+#endif
+
     if (intFrame.numSamples < 0) intFrame.numSamples = 0;
 
-    if (intFrame.numSamples > BUFFER_SIZE_IN_MONO_SAMPLES)
-        intFrame.numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+    if (intFrame.numSamples > MAX_BUFFER_SIZE_IN_MONO_SAMPLES)
+        intFrame.numSamples = MAX_BUFFER_SIZE_IN_MONO_SAMPLES;
 
 #ifdef EAS_SPLIT_WT_SYNTH
     if (voiceNum < NUM_PRIMARY_VOICES)
@@ -614,14 +731,26 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
 #endif
     }
     else
-        WTE_ProcessVoice(voiceNum - NUM_PRIMARY_VOICES, &intFrame.frame, pVoiceMgr->pFrameBuffer);
+        WTE_ProcessVoice(voiceNum - NUM_PRIMARY_VOICES, pWTVoice, &intFrame, VM_FRAME_OFFSET(pVoiceMgr, pMixBuffer), pVoiceMgr->pFrameBuffer);
 #else
+#ifdef _VOICE_CULLING
+    /* voices too quiet to be heard are not rendered */
+    if (WT_CullVoice(pWTVoice, pVoice->gain, intFrame.frame.gainTarget))
+        intFrame.numSamples = 0;
+    if (intFrame.numSamples > 0)
+#endif
     WT_ProcessVoice(pWTVoice, &intFrame);
 #endif
 
     /* clear flag */
     pVoice->voiceFlags &= ~VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET;
 
+#ifdef _LOW_LATENCY
+    /* the gain reaches its target at the end of the update period */
+    if (!done && WT_StartSlices(pVoiceMgr, pVoice, pWTVoice, &intFrame, numSamples))
+        return EAS_FALSE;
+#endif
+
     /* if voice has finished, set flag for voice manager */
     if ((pVoice->voiceState != eVoiceStateStolen) && (pWTVoice->eg1State == eEnvelopeStateMuted))
         done = EAS_TRUE;
@@ -631,10 +760,141 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
      * very close to the target gain.
      */
     pVoice->gain = (EAS_I16) intFrame.frame.gainTarget;
+#ifdef _FILTER_RAMP
+    WT_SaveFilterCoeffs(pWTVoice, &intFrame.frame);
+#endif
 
     return done;
 }
 
+#ifdef _LOW_LATENCY
+/*----------------------------------------------------------------------------
+ * WT_StartSlices()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Called after the first slice of an update period is synthesized. If the
+ * period continues past the slice, its parameters are saved so the later
+ * slices continue the gain ramp instead of updating the envelopes and
+ * LFOs again, which keeps the control rate at one update per period.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pVoice - pointer to the voice
+ * pWTVoice - pointer to the wavetable voice
+ * pIntFrame - parameters the first slice was synthesized with
+ * numSamples - number of samples in the first slice
+ *
+ * Outputs:
+ * EAS_TRUE if the update period continues in later slices
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL WT_StartSlices (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice, S_WT_VOICE *pWTVoice, const S_WT_INT_FRAME *pIntFrame, EAS_I32 numSamples)
+{
+    EAS_I32 frameLeft;
+
+    frameLeft = VM_UPDATE_PERIOD(pVoiceMgr) - pVoice->framePos - numSamples;
+    if (frameLeft <= 0)
+        return EAS_FALSE;
+
+    pWTVoice->sliceFrame = pIntFrame->frame;
+    pWTVoice->frameLeft = (EAS_I16) frameLeft;
+    pWTVoice->rampOffset = (EAS_I16) numSamples;
+    pWTVoice->sliceFlags = 0;
+    if (pIntFrame->numSamples <= 0)
+        pWTVoice->sliceFlags |= WT_SLICE_CULLED;
+#ifdef _CUBIC_INTERPOLATION
+    if (pIntFrame->cubic)
+        pWTVoice->sliceFlags |= WT_SLICE_CUBIC;
+#endif
+    return EAS_TRUE;
+}
+
+/*----------------------------------------------------------------------------
+ * WT_UpdateSlice()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Synthesize a later slice of an update period with the parameters saved
+ * by WT_StartSlices. Used for both WT and DLS voices.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pVoice - pointer to the voice
+ * pWTVoice - pointer to the wavetable voice
+ * pVoiceBuffer - voice scratch buffer
+ * pMixBuffer - mix buffer for the slice
+ * numSamples - number of samples in the slice
+ *
+ * Outputs:
+ * Returns EAS_TRUE if the voice has finished
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL WT_UpdateSlice (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice, S_WT_VOICE *pWTVoice, EAS_PCM *pVoiceBuffer, EAS_I32 *pMixBuffer, EAS_I32 numSamples)
+{
+    S_WT_INT_FRAME intFrame;
+    EAS_BOOL done;
+#ifdef EAS_SPLIT_WT_SYNTH
+    EAS_I32 voiceNum;
+
+    voiceNum = (EAS_I32) (pWTVoice - pVoiceMgr->wtVoices);
+#endif
+
+    if (numSamples > pWTVoice->frameLeft)
+        numSamples = pWTVoice->frameLeft;
+
+    intFrame.frame = pWTVoice->sliceFrame;
+    intFrame.pAudioBuffer = pVoiceBuffer;
+    intFrame.pMixBuffer = pMixBuffer;
+    intFrame.numSamples = numSamples;
+    intFrame.prevGain = pVoice->gain;
+    intFrame.rampOffset = pWTVoice->rampOffset;
+#ifdef _RUNTIME_SAMPLE_RATE
+    intFrame.rateShift = pVoiceMgr->rateShift;
+#endif
+#ifdef _CUBIC_INTERPOLATION
+    intFrame.cubic = (EAS_BOOL) ((pWTVoice->sliceFlags & WT_SLICE_CUBIC) != 0);
+#endif
+
+    /* check for end of sample, in this slice or a later one */
+    done = EAS_FALSE;
+    if ((pWTVoice->loopStart != WT_NOISE_GENERATOR) && (pWTVoice->loopStart == pWTVoice->loopEnd))
+    {
+        done = WT_CheckSampleEnd(pWTVoice, &intFrame, EAS_FALSE);
+        if (intFrame.numSamples > numSamples)
+        {
+            intFrame.numSamples = numSamples;
+            done = EAS_FALSE;
+        }
+    }
+
+    if (((pWTVoice->sliceFlags & WT_SLICE_CULLED) == 0) && (intFrame.numSamples > 0))
+    {
+#ifdef EAS_SPLIT_WT_SYNTH
+        if (voiceNum >= NUM_PRIMARY_VOICES)
+            WTE_ProcessVoice(voiceNum - NUM_PRIMARY_VOICES, pWTVoice, &intFrame, VM_FRAME_OFFSET(pVoiceMgr, pMixBuffer), pVoiceMgr->pFrameBuffer);
+        else
+#endif
+        WT_ProcessVoice(pWTVoice, &intFrame);
+    }
+
+    pWTVoice->rampOffset = (EAS_I16) (pWTVoice->rampOffset + numSamples);
+    pWTVoice->frameLeft = (EAS_I16) (pWTVoice->frameLeft - numSamples);
+    if (!done && (pWTVoice->frameLeft > 0))
+        return EAS_FALSE;
+
+    /* the update period is complete */
+    pWTVoice->frameLeft = 0;
+    if ((pVoice->voiceState != eVoiceStateStolen) && (pWTVoice->eg1State == eEnvelopeStateMuted))
+        done = EAS_TRUE;
+    pVoice->gain = (EAS_I16) intFrame.frame.gainTarget;
+#ifdef _FILTER_RAMP
+    WT_SaveFilterCoeffs(pWTVoice, &intFrame.frame);
+#endif
+    return done;
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * WT_UpdatePhaseInc()
  *----------------------------------------------------------------------------
@@ -681,7 +941,11 @@ static EAS_I32 WT_UpdatePhaseInc (S_WT_VOICE *pWTVoice, const S_ARTICULATION *pA
         (MULT_EG1_EG1(pWTVoice->modLFO.lfoValue, pArt->lfoToPitch));
 
     /* convert from cents to linear phase increment */
+#ifdef _ARTICULATION_CACHE
+    return WT_Cached2toX(&pWTVoice->cache.pitchCents, &pWTVoice->cache.phaseIncrement, temp);
+#else
     return EAS_Calculate2toX(temp);
+#endif
 }
 
 /*----------------------------------------------------------------------------
@@ -708,15 +972,17 @@ static void WT_UpdateChannel (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 ch
     EAS_I32 staticGain;
     EAS_I32 pitchBend;
     S_SYNTH_CHANNEL *pChannel;
+    S_SYNTH_CHANNEL_STATE *pState;
 
     pChannel = &pSynth->channels[channel];
+    pState = &pSynth->channelState[channel];
 
     /*
     nChannelGain = (CC7 * CC11)^2  * master volume
     where CC7 == 100 by default, CC11 == 127, master volume == 32767
     */
-    staticGain = MULT_EG1_EG1((pChannel->volume) << (NUM_EG1_FRAC_BITS - 7),
-        (pChannel->expression) << (NUM_EG1_FRAC_BITS - 7));
+    staticGain = MULT_EG1_EG1((pState->volume) << (NUM_EG1_FRAC_BITS - 7),
+        (pState->expression) << (NUM_EG1_FRAC_BITS - 7));
 
     /* staticGain has to be squared */
     staticGain = MULT_EG1_EG1(staticGain, staticGain);
@@ -733,15 +999,15 @@ static void WT_UpdateChannel (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 ch
     */
     /*lint -e{703} <avoid multiply for performance>*/
     pitchBend =
-        (((EAS_I32)(pChannel->pitchBend) << 2)
+        (((EAS_I32)(pState->pitchBend) << 2)
         - 32768);
 
     pChannel->staticPitch =
-        MULT_EG1_EG1(pitchBend, pChannel->pitchBendSensitivity);
+        MULT_EG1_EG1(pitchBend, pState->pitchBendSensitivity);
 
     /* if this is not a drum channel, then add in the per-channel tuning */
     if (!(pChannel->channelFlags & CHANNEL_FLAG_RHYTHM_CHANNEL))
-        pChannel->staticPitch += pChannel->finePitch + (pChannel->coarsePitch * 100);
+        pChannel->staticPitch += pState->finePitch + (pState->coarsePitch * 100);
 
     /* clear update flag */
     pChannel->channelFlags &= ~CHANNEL_FLAG_UPDATE_CHANNEL_PARAMETERS;
@@ -792,7 +1058,11 @@ static EAS_I32 WT_UpdateGain (S_SYNTH_VOICE *pVoice, S_WT_VOICE *pWTVoice, const
     lfoGain = MULT_EG1_EG1(lfoGain, LFO_GAIN_TO_CENTS);
 
     /* convert from a dB-like value to linear gain */
+#ifdef _ARTICULATION_CACHE
+    lfoGain = WT_Cached2toX(&pWTVoice->cache.lfoGainCents, &pWTVoice->cache.lfoGain, lfoGain);
+#else
     lfoGain = EAS_Calculate2toX(lfoGain);
+#endif
     temp = MULT_EG1_EG1(temp, lfoGain);
 
     /* calculate the voice's gain */
@@ -983,6 +1253,212 @@ static void WT_UpdateEG2 (S_WT_VOICE *pWTVoice, const S_ENVELOPE *pEnv)
     pWTVoice->eg2Value = (EAS_I16) temp;
 }
 
+#ifdef _LOOKAHEAD_PREFETCH
+/*----------------------------------------------------------------------------
+ * WT_PrefetchRegion ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Asks for the data WT_StartVoice reads for a region to be loaded into the
+ * data cache: the region, its articulation and the first lines of its
+ * sample. Called a frame before the note starts, so that the loads are
+ * done by the time the voice is started and first rendered.
+ *
+ * Inputs:
+ * pEAS             - pointer to the sound library
+ * regionIndex      - index of a wavetable region in the library
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * None, the data is not read
+ *
+ *----------------------------------------------------------------------------
+*/
+void WT_PrefetchRegion (const S_EAS *pEAS, EAS_U16 regionIndex)
+{
+    const S_WT_REGION *pRegion;
+    const EAS_U8 *pSample;
+    EAS_INT i;
+
+    pRegion = &pEAS->pWTRegions[regionIndex];
+    EAS_PREFETCH(pRegion);
+    EAS_PREFETCH(&pEAS->pArticulations[pRegion->artIndex]);
+
+    /* generators have no sample data */
+    if (pRegion->region.keyGroupAndFlags & REGION_FLAG_USE_WAVE_GENERATOR)
+        return;
+
+    pSample = (const EAS_U8*) pEAS->pSamples + pEAS->pSampleOffsets[pRegion->waveIndex];
+    for (i = 0; i < WT_PREFETCH_START_LINES; i++)
+        EAS_PREFETCH(pSample + i * EAS_CACHE_LINE_SIZE);
+}
+#endif
+
+#ifdef _CUBIC_INTERPOLATION
+/*----------------------------------------------------------------------------
+ * WT_UseCubic ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Decides whether a voice uses the cubic interpolator this frame. In
+ * adaptive mode only voices loud enough for the lower aliasing to be
+ * audible are worth the extra cost.
+ *
+ * Inputs:
+ * interpolation    - E_EAS_INTERPOLATION from the voice manager
+ * gain             - target gain of the voice for this frame
+ *
+ * Outputs:
+ * EAS_TRUE to use the cubic interpolator
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL WT_UseCubic (EAS_I32 interpolation, EAS_I32 gain)
+{
+    if (interpolation == EAS_INTERPOLATION_CUBIC)
+        return EAS_TRUE;
+    if (interpolation == EAS_INTERPOLATION_ADAPTIVE)
+        return (EAS_BOOL) (gain >= WT_CUBIC_GAIN_THRESHOLD);
+    return EAS_FALSE;
+}
+#endif
+
+#ifdef _VOICE_CULLING
+/*----------------------------------------------------------------------------
+ * WT_CullVoice ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks whether a voice is too quiet to be heard this frame. The gain
+ * already combines velocity, channel volume and expression, and EG1.
+ * A release tail below the threshold can only get quieter, so its
+ * envelope is ended and the voice manager frees it. A quiet looped voice
+ * held by its envelope may get louder again. It is frozen: the envelopes
+ * and gain keep updating, but it is not rendered until it is audible.
+ * Attacks and mute ramps, including those of stolen voices, always run.
+ *
+ * Inputs:
+ * pWTVoice         - pointer to the wavetable voice
+ * prevGain         - gain of the voice at the start of this frame
+ * gainTarget       - gain of the voice at the end of this frame
+ *
+ * Outputs:
+ * EAS_TRUE to skip rendering the voice this frame
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL WT_CullVoice (S_WT_VOICE *pWTVoice, EAS_I32 prevGain, EAS_I32 gainTarget)
+{
+    if ((prevGain >= WT_CULL_GAIN_THRESHOLD) || (gainTarget >= WT_CULL_GAIN_THRESHOLD))
+        return EAS_FALSE;
+
+    switch (pWTVoice->eg1State)
+    {
+        case eEnvelopeStateRelease:
+            pWTVoice->eg1State = eEnvelopeStateMuted;
+            return EAS_TRUE;
+
+        case eEnvelopeStateDelay:
+        case eEnvelopeStateHold:
+        case eEnvelopeStateDecay:
+        case eEnvelopeStateSustain:
+            /* a one shot keeps playing so it still ends with its sample */
+            return (EAS_BOOL) (pWTVoice->loopStart != pWTVoice->loopEnd);
+
+        default:
+            return EAS_FALSE;
+    }
+}
+#endif
+
+#ifdef _ARTICULATION_CACHE
+/*----------------------------------------------------------------------------
+ * WT_ResetCache ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Invalidates the cached control values of a voice
+ *
+ * Inputs:
+ * pWTVoice         - pointer to the wavetable voice
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void WT_ResetCache (S_WT_VOICE *pWTVoice)
+{
+    pWTVoice->cache.pitchCents = WT_CACHE_INVALID;
+    pWTVoice->cache.lfoGainCents = WT_CACHE_INVALID;
+#if defined(_FILTER_ENABLED)
+    pWTVoice->cache.cutoff = WT_CACHE_INVALID;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * WT_Cached2toX ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns EAS_Calculate2toX(cents), only recalculating it when cents is
+ * different from the last call for this cache entry. Pitch and gain only
+ * move while an envelope segment, the LFO or a controller is changing
+ * them, so most frames reuse the previous result.
+ *
+ * Inputs:
+ * pCents           - input of the cached result
+ * pResult          - cached result
+ * cents            - value to convert
+ *
+ * Outputs:
+ * 2^(cents/1200)
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 WT_Cached2toX (EAS_I32 *pCents, EAS_I32 *pResult, EAS_I32 cents)
+{
+    if (cents != *pCents)
+    {
+        *pCents = cents;
+        *pResult = EAS_Calculate2toX(cents);
+    }
+    return *pResult;
+}
+
+#if defined(_FILTER_ENABLED)
+/*----------------------------------------------------------------------------
+ * WT_SetCachedFilterCoeffs ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the filter coefficients for the frame, only recalculating them
+ * when the cutoff has changed. The resonance is fixed by the articulation
+ * for the life of the voice.
+ *
+ * Inputs:
+ * pWTVoice         - pointer to the wavetable voice
+ * pIntFrame        - receives the coefficients
+ * cutoff           - cutoff in cents with A5 subtracted
+ * resonance        - resonance index
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void WT_SetCachedFilterCoeffs (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pIntFrame, EAS_I32 cutoff, EAS_I32 resonance)
+{
+    if (cutoff != pWTVoice->cache.cutoff)
+    {
+        WT_SetFilterCoeffs(pIntFrame, cutoff, resonance);
+        pWTVoice->cache.cutoff = cutoff;
+        pWTVoice->cache.k = pIntFrame->frame.k;
+        pWTVoice->cache.b1 = pIntFrame->frame.b1;
+        pWTVoice->cache.b2 = pIntFrame->frame.b2;
+        return;
+    }
+    pIntFrame->frame.k = pWTVoice->cache.k;
+    pIntFrame->frame.b1 = pWTVoice->cache.b1;
+    pIntFrame->frame.b2 = pWTVoice->cache.b2;
+}
+#endif
+#endif
+
 /*----------------------------------------------------------------------------
  * WT_UpdateLFO ()
  *----------------------------------------------------------------------------
@@ -1057,6 +1533,9 @@ static void WT_UpdateFilter (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pIntFrame, co
 
     /* subtract the A5 offset and the sampling frequency */
     cutoff -= FILTER_CUTOFF_FREQ_ADJUST + A5_PITCH_OFFSET_IN_CENTS;
+#ifdef _RUNTIME_SAMPLE_RATE
+    cutoff -= pIntFrame->rateShift * 1200;
+#endif
 
     /* limit the cutoff frequency */
     if (cutoff > FILTER_CUTOFF_MAX_PITCH_CENTS)
@@ -1064,7 +1543,11 @@ static void WT_UpdateFilter (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pIntFrame, co
     else if (cutoff < FILTER_CUTOFF_MIN_PITCH_CENTS)
         cutoff = FILTER_CUTOFF_MIN_PITCH_CENTS;
 
+#ifdef _ARTICULATION_CACHE
+    WT_SetCachedFilterCoeffs(pWTVoice, pIntFrame, cutoff, pArt->filterQ);
+#else
     WT_SetFilterCoeffs(pIntFrame, cutoff, pArt->filterQ);
+#endif
 }
 #endif
 
@@ -1298,3 +1781,27 @@ void WT_SetFilterCoeffs (S_WT_INT_FRAME *pIntFrame, EAS_I32 cutoff, EAS_I32 reso
 }
 #endif
 
+#ifdef _FILTER_RAMP
+/*----------------------------------------------------------------------------
+ * WT_SaveFilterCoeffs()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Saves the filter coefficients of an update period when it is complete.
+ * The filter of the next period ramps from them to its own coefficients.
+ *
+ * Inputs:
+ * pWTVoice - pointer to the wavetable voice
+ * pFrame - parameters of the update period
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void WT_SaveFilterCoeffs (S_WT_VOICE *pWTVoice, const S_WT_FRAME *pFrame)
+{
+    pWTVoice->filter.k = pFrame->k;
+    pWTVoice->filter.b1 = pFrame->b1;
+    pWTVoice->filter.b2 = pFrame->b2;
+}
+#endif
+
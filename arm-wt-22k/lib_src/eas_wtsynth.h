@@ -54,13 +54,54 @@
 #error "_SAMPLE_RATE_XXXXX must be defined to valid rate"
 #endif
 
+#ifdef _VOICE_CULLING
+/* voice gain below which the output is under one LSB (about -72 dB) */
+#define WT_CULL_GAIN_THRESHOLD          8
+#endif
+
+#ifdef _CUBIC_INTERPOLATION
+/* voices at or above this gain (about -18 dB) use the cubic interpolator in adaptive mode */
+#define WT_CUBIC_GAIN_THRESHOLD         0x1000
+#endif
+
+#ifdef _LOOKAHEAD_PREFETCH
+/* cache lines loaded at the start of the sample of a note about to start */
+#ifndef WT_PREFETCH_START_LINES
+#define WT_PREFETCH_START_LINES         2
+#endif
+#endif
+
 /* function prototypes */
 void WT_UpdateLFO (S_LFO_CONTROL *pLFO, EAS_I16 phaseInc);
 
+#ifdef _CUBIC_INTERPOLATION
+EAS_BOOL WT_UseCubic (EAS_I32 interpolation, EAS_I32 gain);
+#endif
+
+#ifdef _VOICE_CULLING
+EAS_BOOL WT_CullVoice (S_WT_VOICE *pWTVoice, EAS_I32 prevGain, EAS_I32 gainTarget);
+#endif
+
 #if defined(_FILTER_ENABLED) || defined(DLS_SYNTHESIZER)
 void WT_SetFilterCoeffs (S_WT_INT_FRAME *pIntFrame, EAS_I32 cutoff, EAS_I32 resonance);
 #endif
 
+#ifdef _LOOKAHEAD_PREFETCH
+void WT_PrefetchRegion (const S_EAS *pEAS, EAS_U16 regionIndex);
+#endif
+
+#ifdef _FILTER_RAMP
+void WT_SaveFilterCoeffs (S_WT_VOICE *pWTVoice, const S_WT_FRAME *pFrame);
+#endif
+
+#ifdef _ARTICULATION_CACHE
+void WT_ResetCache (S_WT_VOICE *pWTVoice);
+EAS_I32 WT_Cached2toX (EAS_I32 *pCents, EAS_I32 *pResult, EAS_I32 cents);
+#if defined(_FILTER_ENABLED)
+void WT_SetCachedFilterCoeffs (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pIntFrame, EAS_I32 cutoff, EAS_I32 resonance);
+#endif
+#endif
+
 #endif
 
 
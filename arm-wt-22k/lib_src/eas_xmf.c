@@ -27,6 +27,9 @@
  *----------------------------------------------------------------------------
 */
 
+/* allocations of this module are reported as parser state */
+#define EAS_MEM_CATEGORY    EAS_MEM_PARSERS
+
 #include <log/log.h>
 
 #include "eas_data.h"
@@ -66,9 +69,25 @@ static EAS_RESULT XMF_Pause (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData);
 static EAS_RESULT XMF_Resume (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData);
 static EAS_RESULT XMF_SetData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value);
 static EAS_RESULT XMF_GetData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue);
+#ifdef _SMF_FAST_METADATA
+static EAS_RESULT XMF_GetMetaData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 *pMediaLength);
+#endif
 static EAS_RESULT XMF_FindFileContents (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFData);
 static EAS_RESULT XMF_ReadNode (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFData, EAS_I32 nodeOffset, EAS_I32 endOffset, EAS_I32 *pLength, EAS_I32 depth);
 static EAS_RESULT XMF_ReadVLQ (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_U32 *remainingBytes, EAS_I32 *value);
+#ifdef _XMF_INDEX_CACHE
+static void XMF_IndexRange (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFData, EAS_I32 start);
+static EAS_RESULT XMF_IndexReadBytes (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, const S_XMF_INDEX *pIndex, EAS_U8 *pBytes);
+static EAS_BOOL XMF_IndexLookup (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFData, EAS_I32 start);
+static void XMF_IndexStore (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFData, S_XMF_INDEX *pIndex);
+
+/* number of tree walks remembered */
+#define XMF_INDEX_CACHE_SIZE    4
+
+/* tree walks shared by all library instances, protected by EAS_HWGlobalLock */
+static S_XMF_INDEX xmfIndexCache[XMF_INDEX_CACHE_SIZE];
+static EAS_INT xmfIndexNext = 0;
+#endif
 
 
 /*----------------------------------------------------------------------------
@@ -97,7 +116,11 @@ const S_FILE_PARSER_INTERFACE EAS_XMF_Parser =
     NULL,
     XMF_SetData,
     XMF_GetData,
+#ifdef _SMF_FAST_METADATA
+    XMF_GetMetaData
+#else
     NULL
+#endif
 };
 
 /*----------------------------------------------------------------------------
@@ -181,6 +204,9 @@ static EAS_RESULT XMF_CheckFileType (S_EAS_DATA *pEASData, EAS_FILE_HANDLE fileH
 
     pXMFData->fileHandle = fileHandle;
     pXMFData->fileOffset = offset;
+#ifdef _PARSE_LIMITS
+    pXMFData->maxNodes = pEASData->parseLimits.maxNodes;
+#endif
 
     /* locate the SMF and DLS contents */
     if ((result = XMF_FindFileContents(pEASData->hwInstData, pXMFData)) != EAS_SUCCESS)
@@ -228,9 +254,21 @@ static EAS_RESULT XMF_Prepare (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
 
     /* parse DLS collection */
     pXMFData = (S_XMF_DATA*) pInstData;
-    if (pXMFData->dlsOffset != 0)
+    if ((pXMFData->dlsOffset != 0) && (pEASData->pVoiceMgr != NULL))
     {
-        if ((result = DLSParser(pEASData->hwInstData, pXMFData->fileHandle, pXMFData->dlsOffset, &pXMFData->pDLS)) != EAS_SUCCESS)
+#ifdef _DLS_LAZY_SAMPLES
+        /* the collection is released in XMF_Close, so the waves can stay in the file until they are played */
+#ifdef _RT_SAFE_RENDER
+        /* except in realtime mode, where a note must not allocate its wave */
+        if (pEASData->realtimeRender)
+            result = DLSParser(pEASData->hwInstData, pXMFData->fileHandle, pXMFData->dlsOffset, &pXMFData->pDLS);
+        else
+#endif
+        result = DLSParserLazy(pEASData->hwInstData, pXMFData->fileHandle, pXMFData->dlsOffset, &pXMFData->pDLS);
+#else
+        result = DLSParser(pEASData->hwInstData, pXMFData->fileHandle, pXMFData->dlsOffset, &pXMFData->pDLS);
+#endif
+        if (result != EAS_SUCCESS)
         {
             { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "Error converting XMF DLS data\n"); */ }
             return result;
@@ -246,12 +284,19 @@ static EAS_RESULT XMF_Prepare (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
         return EAS_SUCCESS;
 
     /* tell the synth to use the DLS collection */
+#ifdef _ASYNC_OPEN
+    /* the synth is already visible to the render thread */
+    EAS_HWLock(pEASData->hwInstData);
+#endif
     result = VMSetDLSLib(((S_SMF_DATA*) pXMFData->pSMFData)->pSynth, pXMFData->pDLS);
     if (result == EAS_SUCCESS)
     {
         DLSAddRef(pXMFData->pDLS);
         VMInitializeAllChannels(pEASData->pVoiceMgr, ((S_SMF_DATA*) pXMFData->pSMFData)->pSynth);
     }
+#ifdef _ASYNC_OPEN
+    EAS_HWUnlock(pEASData->hwInstData);
+#endif
     return result;
 }
 
@@ -386,6 +431,32 @@ static EAS_RESULT XMF_Reset (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData)
     return SMF_Reset(pEASData, ((S_XMF_DATA*) pInstData)->pSMFData);
 }
 
+#ifdef _SMF_FAST_METADATA
+/*----------------------------------------------------------------------------
+ * XMF_GetMetaData()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the play length of the embedded SMF file
+ *
+ * Inputs:
+ * pEASData         - pointer to overall EAS data structure
+ * handle           - pointer to file handle
+ * pMediaLength     - pointer to variable to hold the play length (in msecs)
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * Resets the parser to the start of the file
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT XMF_GetMetaData (S_EAS_DATA *pEASData, EAS_VOID_PTR pInstData, EAS_I32 *pMediaLength)
+{
+    return SMF_GetMetaData(pEASData, ((S_XMF_DATA*) pInstData)->pSMFData, pMediaLength);
+}
+#endif
+
 #ifdef JET_INTERFACE
 /*----------------------------------------------------------------------------
  * XMF_Pause()
@@ -523,10 +594,30 @@ static EAS_RESULT XMF_FindFileContents (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DAT
     EAS_I32 node_depth = 0 ;
     EAS_I32 fileLength;
     EAS_U32 remainingBytes;
+#ifdef _XMF_INDEX_CACHE
+    S_XMF_INDEX index;
+    EAS_I32 start;
+#endif
 
     /* initialize offsets */
     pXMFData->dlsOffset = pXMFData->midiOffset = 0;
 
+#ifdef _XMF_INDEX_CACHE
+    /* skip the walk if the tree has been walked before */
+    if ((result = EAS_HWFilePos(hwInstData, pXMFData->fileHandle, &start)) != EAS_SUCCESS)
+        return result;
+    if (XMF_IndexLookup(hwInstData, pXMFData, start))
+        return EAS_SUCCESS;
+    if ((result = EAS_HWFileSeek(hwInstData, pXMFData->fileHandle, start)) != EAS_SUCCESS)
+        return result;
+
+    /* record what the walk reads */
+    index.fileOffset = pXMFData->fileOffset;
+    index.numRanges = 0;
+    index.numBytes = 0;
+    pXMFData->pIndex = &index;
+#endif
+
     /* read file length. We're arbitrarily limiting the size of this field to
      * 16 bytes, since we don't yet have an actual limit. Once the field is
      * read, we correct remainingBytes using the actual value that we had read.
@@ -551,9 +642,16 @@ static EAS_RESULT XMF_FindFileContents (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DAT
         return result;
     if (value > remainingBytes)
         return EAS_ERROR_FILE_FORMAT;
+#ifdef _XMF_INDEX_CACHE
+    XMF_IndexRange(hwInstData, pXMFData, start);
+#endif
     if ((result = EAS_HWFileSeekOfs(hwInstData, pXMFData->fileHandle, value)) != EAS_SUCCESS)
         return result;
     remainingBytes -= value;
+#ifdef _XMF_INDEX_CACHE
+    if ((result = EAS_HWFilePos(hwInstData, pXMFData->fileHandle, &start)) != EAS_SUCCESS)
+        return result;
+#endif
 
     /* get TreeStart and TreeEnd offsets */
     if ((result = XMF_ReadVLQ(hwInstData, pXMFData->fileHandle, &remainingBytes, &treeStart)) != EAS_SUCCESS)
@@ -565,8 +663,15 @@ static EAS_RESULT XMF_FindFileContents (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DAT
         return result;
     if (treeEnd < treeStart || treeEnd >= fileLength)
         return EAS_ERROR_FILE_FORMAT;
+#ifdef _XMF_INDEX_CACHE
+    XMF_IndexRange(hwInstData, pXMFData, start);
+#endif
 
-    if ((result = XMF_ReadNode(hwInstData, pXMFData, treeStart, treeEnd + 1, &length, node_depth)) != EAS_SUCCESS)
+    result = XMF_ReadNode(hwInstData, pXMFData, treeStart, treeEnd + 1, &length, node_depth);
+#ifdef _XMF_INDEX_CACHE
+    pXMFData->pIndex = NULL;
+#endif
+    if (result != EAS_SUCCESS)
         return result;
 
     /* check for SMF data */
@@ -580,6 +685,12 @@ static EAS_RESULT XMF_FindFileContents (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DAT
     if ((pXMFData->dlsOffset > 0) && (pXMFData->midiOffset < pXMFData->dlsOffset))
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "DLS data must precede SMF data in Mobile XMF file\n"); */ }
 
+#ifdef _XMF_INDEX_CACHE
+    /* a walk that read too much to record is not cached */
+    if (index.numRanges >= 0)
+        XMF_IndexStore(hwInstData, pXMFData, &index);
+#endif
+
     return EAS_SUCCESS;
 }
 
@@ -608,11 +719,21 @@ static EAS_RESULT XMF_ReadNode (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFD
     EAS_U32 chunkType;
     EAS_U32 remainingInlineBytes;
     EAS_U32 deltaBytes;
+#ifdef _XMF_INDEX_CACHE
+    EAS_I32 start;
+#endif
 
     /* check the depth of current node*/
     if ( depth > 100 )
         return EAS_ERROR_FILE_FORMAT;
 
+#ifdef _PARSE_LIMITS
+    /* a wide tree is as costly as a deep one */
+    pXMFData->numNodes++;
+    if ((pXMFData->maxNodes != 0) && (pXMFData->numNodes > pXMFData->maxNodes))
+        return EAS_ERROR_PARSE_LIMIT;
+#endif
+
     /* this will be used to check we don't read past the node limits */
     remainingInlineBytes = endOffset - nodeOffset;
 
@@ -659,6 +780,9 @@ static EAS_RESULT XMF_ReadNode (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFD
     /* check that we didn't go past the header. */
     if (offset - nodeOffset > headerLength)
         return EAS_FAILURE;
+#ifdef _XMF_INDEX_CACHE
+    XMF_IndexRange(hwInstData, pXMFData, nodeOffset);
+#endif
 
     /* skip to node contents */
     if ((result = EAS_HWFileSeek(hwInstData, pXMFData->fileHandle, nodeOffset + headerLength)) != EAS_SUCCESS)
@@ -672,6 +796,9 @@ static EAS_RESULT XMF_ReadNode (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFD
     /* get the current location */
     if ((result = EAS_HWFilePos(hwInstData, pXMFData->fileHandle, &offset)) != EAS_SUCCESS)
         return result;
+#ifdef _XMF_INDEX_CACHE
+    XMF_IndexRange(hwInstData, pXMFData, nodeOffset + headerLength);
+#endif
 
     /* process file node */
     if (numItems == 0)
@@ -680,8 +807,14 @@ static EAS_RESULT XMF_ReadNode (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFD
         /* if in-file resource, find out where it is and jump to it */
         if (refType == 2)
         {
+#ifdef _XMF_INDEX_CACHE
+            start = offset;
+#endif
             if ((result = XMF_ReadVLQ(hwInstData, pXMFData->fileHandle, &remainingInlineBytes, &offset)) != EAS_SUCCESS)
                 return result;
+#ifdef _XMF_INDEX_CACHE
+            XMF_IndexRange(hwInstData, pXMFData, start);
+#endif
             offset += pXMFData->fileOffset;
             if ((result = EAS_HWFileSeek(hwInstData, pXMFData->fileHandle, offset)) != EAS_SUCCESS)
                 return result;
@@ -717,6 +850,9 @@ static EAS_RESULT XMF_ReadNode (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFD
         /* found an SMF chunk */
         else if (chunkType == XMF_SMF_CHUNK)
             pXMFData->midiOffset = offset;
+#ifdef _XMF_INDEX_CACHE
+        XMF_IndexRange(hwInstData, pXMFData, offset);
+#endif
     }
 
     /* folder node, process the items in the list */
@@ -943,3 +1079,192 @@ static EAS_RESULT XMF_ReadVLQ (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fi
     return EAS_SUCCESS;
 }
 
+
+#ifdef _XMF_INDEX_CACHE
+/*----------------------------------------------------------------------------
+ * XMF_IndexRange()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Records that the tree walk read the file from start up to the current
+ * position. A walk that reads more than the index can hold is marked so
+ * that it is not cached.
+ *
+ * Inputs:
+ * hwInstData       - host instance data
+ * pXMFData         - pointer to XMF parser instance data
+ * start            - offset of the first byte read
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void XMF_IndexRange (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFData, EAS_I32 start)
+{
+    S_XMF_INDEX *pIndex;
+    EAS_I32 pos;
+    EAS_I32 n;
+
+    pIndex = pXMFData->pIndex;
+    if ((pIndex == NULL) || (pIndex->numRanges < 0))
+        return;
+    if (EAS_HWFilePos(hwInstData, pXMFData->fileHandle, &pos) != EAS_SUCCESS)
+    {
+        pIndex->numRanges = -1;
+        return;
+    }
+
+    /* extend the last range if this one follows it */
+    n = pIndex->numRanges;
+    if ((n > 0) && (pIndex->rangeStart[n-1] + pIndex->rangeLength[n-1] == start))
+        pIndex->rangeLength[n-1] += pos - start;
+    else if (n < XMF_INDEX_MAX_RANGES)
+    {
+        pIndex->rangeStart[n] = start;
+        pIndex->rangeLength[n] = pos - start;
+        pIndex->numRanges++;
+    }
+    else
+    {
+        pIndex->numRanges = -1;
+        return;
+    }
+
+    pIndex->numBytes += pos - start;
+    if (pIndex->numBytes > XMF_INDEX_MAX_BYTES)
+        pIndex->numRanges = -1;
+}
+
+/*----------------------------------------------------------------------------
+ * XMF_IndexReadBytes()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reads the bytes in the ranges recorded in an index
+ *
+ * Inputs:
+ * hwInstData       - host instance data
+ * fileHandle       - file handle
+ * pIndex           - pointer to the index
+ *
+ * Outputs:
+ * pBytes           - XMF_INDEX_MAX_BYTES buffer for the bytes
+ *
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT XMF_IndexReadBytes (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, const S_XMF_INDEX *pIndex, EAS_U8 *pBytes)
+{
+    EAS_RESULT result;
+    EAS_I32 count;
+    EAS_INT i;
+
+    for (i = 0; i < pIndex->numRanges; i++)
+    {
+        if ((result = EAS_HWFileSeek(hwInstData, fileHandle, pIndex->rangeStart[i])) != EAS_SUCCESS)
+            return result;
+        if ((result = EAS_HWReadFile(hwInstData, fileHandle, pBytes, pIndex->rangeLength[i], &count)) != EAS_SUCCESS)
+            return result;
+        if (count != pIndex->rangeLength[i])
+            return EAS_EOF;
+        pBytes += count;
+    }
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * XMF_IndexLookup()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Looks for an earlier walk of a tree with the same bytes in every range
+ * the walk read, and if there is one, takes the contents offsets from it
+ *
+ * Inputs:
+ * hwInstData       - host instance data
+ * pXMFData         - pointer to XMF parser instance data
+ * start            - offset of the XMF file length field
+ *
+ * Outputs:
+ * returns EAS_TRUE if the offsets were found
+ *
+ *
+ * Side Effects:
+ * Moves the file position
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL XMF_IndexLookup (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFData, EAS_I32 start)
+{
+    S_XMF_INDEX index;
+    EAS_U8 bytes[XMF_INDEX_MAX_BYTES];
+    EAS_BOOL found;
+    EAS_INT i;
+
+    for (i = 0; i < XMF_INDEX_CACHE_SIZE; i++)
+    {
+        /* copy the entry, the file is read without holding the lock */
+        EAS_HWGlobalLock();
+        found = (xmfIndexCache[i].numRanges > 0) &&
+            (xmfIndexCache[i].fileOffset == pXMFData->fileOffset) &&
+            (xmfIndexCache[i].rangeStart[0] == start);
+#ifdef _PARSE_LIMITS
+        /* a tree over the node limit must fail the walk */
+        if ((pXMFData->maxNodes != 0) && (xmfIndexCache[i].numNodes > pXMFData->maxNodes))
+            found = EAS_FALSE;
+#endif
+        if (found)
+            EAS_HWMemCpy(&index, &xmfIndexCache[i], sizeof(index));
+        EAS_HWGlobalUnlock();
+        if (!found)
+            continue;
+
+        if (XMF_IndexReadBytes(hwInstData, pXMFData->fileHandle, &index, bytes) != EAS_SUCCESS)
+            continue;
+        if (EAS_HWMemCmp(bytes, index.bytes, index.numBytes) == 0)
+        {
+            pXMFData->midiOffset = index.midiOffset;
+            pXMFData->dlsOffset = index.dlsOffset;
+            return EAS_TRUE;
+        }
+    }
+    return EAS_FALSE;
+}
+
+/*----------------------------------------------------------------------------
+ * XMF_IndexStore()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds a completed tree walk to the cache, replacing the oldest entry
+ *
+ * Inputs:
+ * hwInstData       - host instance data
+ * pXMFData         - pointer to XMF parser instance data
+ * pIndex           - ranges the walk read
+ *
+ * Outputs:
+ *
+ *
+ * Side Effects:
+ * Moves the file position
+ *
+ *----------------------------------------------------------------------------
+*/
+static void XMF_IndexStore (EAS_HW_DATA_HANDLE hwInstData, S_XMF_DATA *pXMFData, S_XMF_INDEX *pIndex)
+{
+    pIndex->midiOffset = pXMFData->midiOffset;
+    pIndex->dlsOffset = pXMFData->dlsOffset;
+#ifdef _PARSE_LIMITS
+    pIndex->numNodes = pXMFData->numNodes;
+#endif
+    if (XMF_IndexReadBytes(hwInstData, pXMFData->fileHandle, pIndex, pIndex->bytes) != EAS_SUCCESS)
+        return;
+
+    EAS_HWGlobalLock();
+    EAS_HWMemCpy(&xmfIndexCache[xmfIndexNext], pIndex, sizeof(*pIndex));
+    xmfIndexNext = (xmfIndexNext + 1) % XMF_INDEX_CACHE_SIZE;
+    EAS_HWGlobalUnlock();
+}
+#endif
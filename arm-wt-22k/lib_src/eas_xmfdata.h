@@ -33,6 +33,39 @@
 
 #include "eas_data.h"
 
+#ifdef _XMF_INDEX_CACHE
+/* the most byte ranges and bytes a cached tree walk may read */
+#define XMF_INDEX_MAX_RANGES    32
+#define XMF_INDEX_MAX_BYTES     256
+
+/*----------------------------------------------------------------------------
+ *
+ * S_XMF_INDEX
+ *
+ * The result of walking an XMF node tree, with every byte range the walk
+ * read and the bytes it found there. A file with the same bytes in those
+ * ranges has the same contents offsets, so they can be reused without
+ * walking its tree again.
+ *
+ *----------------------------------------------------------------------------
+*/
+
+typedef struct
+{
+    EAS_I32             fileOffset;
+    EAS_I32             midiOffset;
+    EAS_I32             dlsOffset;
+    EAS_I32             numRanges;
+    EAS_I32             numBytes;
+#ifdef _PARSE_LIMITS
+    EAS_I32             numNodes;
+#endif
+    EAS_I32             rangeStart[XMF_INDEX_MAX_RANGES];
+    EAS_I32             rangeLength[XMF_INDEX_MAX_RANGES];
+    EAS_U8              bytes[XMF_INDEX_MAX_BYTES];
+} S_XMF_INDEX;
+#endif
+
 /*----------------------------------------------------------------------------
  *
  * S_XMF_DATA
@@ -50,6 +83,13 @@ typedef struct
     EAS_I32             midiOffset;
     EAS_I32             dlsOffset;
     S_DLS               *pDLS;
+#ifdef _PARSE_LIMITS
+    EAS_I32             maxNodes;
+    EAS_I32             numNodes;
+#endif
+#ifdef _XMF_INDEX_CACHE
+    S_XMF_INDEX         *pIndex;
+#endif
 } S_XMF_DATA;
 
 #endif
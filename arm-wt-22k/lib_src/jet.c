@@ -36,19 +36,25 @@
 #include "jet_data.h"
 #include "eas_host.h"
 #include "eas_report.h"
+#include "eas_trace.h"
 
 
 /* default configuration */
 static const S_JET_CONFIG jetDefaultConfig =
 {
     JET_EVENT_APP_LOW,
-    JET_EVENT_APP_HIGH
+    JET_EVENT_APP_HIGH,
+    0,
+    0,
+    0
 };
 
 /* function prototypes */
 extern EAS_RESULT EAS_IntSetStrmParam (S_EAS_DATA *pEASData, EAS_HANDLE pStream, EAS_INT param, EAS_I32 value);
 extern EAS_RESULT EAS_OpenJETStream (EAS_DATA_HANDLE pEASData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_HANDLE *ppStream);
+extern EAS_RESULT EAS_RewindJETStream (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream);
 extern EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_DLSLIB_HANDLE *ppDLS);
+extern EAS_RESULT DLSCleanup (EAS_HW_DATA_HANDLE hwInstData, EAS_DLSLIB_HANDLE pDLS);
 
 /*----------------------------------------------------------------------------
  * JET_ParseEvent()
@@ -136,15 +142,74 @@ EAS_INLINE EAS_BOOL JET_ReadQueue (EAS_U32 *pEventQueue, EAS_U8 *pReadIndex, EAS
     return EAS_TRUE;
 }
 
+#ifdef _JET_EVENT_RING
+/*----------------------------------------------------------------------------
+ * JET_WriteAppEvent
+ *----------------------------------------------------------------------------
+ * Save application event to the ring, on the render thread
+ *----------------------------------------------------------------------------
+*/
+static void JET_WriteAppEvent (EAS_DATA_HANDLE easHandle, EAS_U32 event)
+{
+    S_JET_APP_RING *pRing;
+    S_JET_APP_EVENT *pEvent;
+    EAS_U32 head;
+
+    /* the producer owns the head, a full ring drops the event and counts it */
+    pRing = &easHandle->jetHandle->appEvents;
+    head = pRing->head;
+    if ((head - EAS_HWAtomicLoad(&pRing->tail)) >= pRing->size)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "JET_Event: App event queue overflow --- event ignored!\n"); */ }
+        EAS_HWAtomicStore(&pRing->overflows, pRing->overflows + 1);
+        return;
+    }
+
+    /* parsing runs at the start of the frame, the event offset places the event within it */
+    pEvent = &pRing->pEvents[head & (pRing->size - 1)];
+    pEvent->event = event;
+    pEvent->sampleTime = easHandle->sampleTime;
+#ifdef _SAMPLE_ACCURATE_EVENTS
+    pEvent->sampleTime += (EAS_U32) easHandle->pVoiceMgr->eventOffset;
+#endif
+    EAS_HWAtomicStore(&pRing->head, head + 1);
+}
+
+/*----------------------------------------------------------------------------
+ * JET_ReadAppEvent
+ *----------------------------------------------------------------------------
+ * Read application event from the ring, on the consumer thread
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL JET_ReadAppEvent (EAS_DATA_HANDLE easHandle, EAS_U32 *pEvent, EAS_U32 *pSampleTime)
+{
+    S_JET_APP_RING *pRing;
+    S_JET_APP_EVENT *pSlot;
+    EAS_U32 tail;
+
+    /* the consumer owns the tail */
+    pRing = &easHandle->jetHandle->appEvents;
+    tail = pRing->tail;
+    if (tail == EAS_HWAtomicLoad(&pRing->head))
+        return EAS_FALSE;
+
+    pSlot = &pRing->pEvents[tail & (pRing->size - 1)];
+    *pEvent = pSlot->event;
+    *pSampleTime = pSlot->sampleTime;
+    EAS_HWAtomicStore(&pRing->tail, tail + 1);
+    return EAS_TRUE;
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * JET_NextSegment
  *----------------------------------------------------------------------------
  * Advances segment number
  *----------------------------------------------------------------------------
 */
-EAS_INLINE EAS_INT JET_NextSegment (EAS_INT seg_num)
+EAS_INLINE EAS_INT JET_NextSegment (S_JET_DATA *pJet, EAS_INT seg_num)
 {
-    if (++seg_num == SEG_QUEUE_DEPTH)
+    if (++seg_num == JET_SEG_QUEUE_DEPTH(pJet))
         seg_num = 0;
     return seg_num;
 }
@@ -163,7 +228,9 @@ static EAS_RESULT JET_PrepareSegment (EAS_DATA_HANDLE easHandle, EAS_I32 queueNu
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "JET_PrepareSegment: %d\n", queueNum); */ }
 
     p = &easHandle->jetHandle->segQueue[queueNum];
+    EAS_TRACE_BEGIN("JET_PrepareSegment");
     result = EAS_Prepare(easHandle, p->streamHandle);
+    EAS_TRACE_END();
     if (result != EAS_SUCCESS)
         return result;
 
@@ -289,7 +356,7 @@ static EAS_RESULT JetParseInfoChunk (EAS_DATA_HANDLE easHandle, EAS_I32 pos, EAS
                 break;
 
             case INFO_NUM_DLS_CHUNKS:
-                if (temp >= JET_MAX_DLS_COLLECTIONS) {
+                if (temp >= JET_MAX_LIBRARIES(easHandle->jetHandle)) {
                     return EAS_ERROR_INCOMPATIBLE_VERSION;
                 }
                 easHandle->jetHandle->numLibraries = (EAS_U8) temp;
@@ -339,6 +406,12 @@ EAS_PUBLIC EAS_RESULT JET_OpenFile (EAS_DATA_HANDLE easHandle, EAS_FILE_LOCATOR
     if (result != EAS_SUCCESS)
         return result;
 
+#ifdef _RT_SAFE_RENDER
+    /* the segments are parsed from memory while rendering */
+    if (easHandle->realtimeRender)
+        result = EAS_HWPreloadFile(easHandle->hwInstData, easHandle->jetHandle->jetFileHandle);
+    if (result == EAS_SUCCESS)
+#endif
     /* check header */
     result = EAS_HWGetDWord(easHandle->hwInstData, easHandle->jetHandle->jetFileHandle, &chunkType, EAS_TRUE);
     if (result == EAS_SUCCESS)
@@ -451,8 +524,16 @@ EAS_PUBLIC EAS_RESULT JET_CloseFile (EAS_DATA_HANDLE easHandle)
     EAS_INT index;
     EAS_RESULT result = EAS_SUCCESS;
 
+#ifdef _JET_DYNAMIC_QUEUE
+    /* drop the segments still waiting to join the queue */
+    EAS_HWAtomicStore(&easHandle->jetHandle->commands.tail, EAS_HWAtomicLoad(&easHandle->jetHandle->commands.head));
+#endif
+#ifdef _JET_TIMED_COMMANDS
+    easHandle->jetHandle->numTimedCommands = 0;
+#endif
+
     /* close open streams */
-    for (index = 0; index < SEG_QUEUE_DEPTH; index++)
+    for (index = 0; index < JET_SEG_QUEUE_DEPTH(easHandle->jetHandle); index++)
     {
         if (easHandle->jetHandle->segQueue[index].streamHandle != NULL)
         {
@@ -482,7 +563,18 @@ EAS_PUBLIC EAS_RESULT JET_CloseFile (EAS_DATA_HANDLE easHandle)
 EAS_PUBLIC EAS_RESULT JET_Init (EAS_DATA_HANDLE easHandle, const S_JET_CONFIG *pConfig, EAS_INT configSize)
 {
     S_JET_DATA *pJet;
+    S_JET_CONFIG config;
     EAS_U8 flags = 0;
+    EAS_I32 size;
+#ifdef _JET_DYNAMIC_QUEUE
+    EAS_U32 numCommands;
+    EAS_I32 segQueueOffset;
+    EAS_I32 libHandlesOffset;
+    EAS_I32 commandsOffset;
+#endif
+#ifdef _JET_EVENT_RING
+    EAS_I32 appEventsOffset;
+#endif
 
     /* sanity check */
     if (easHandle == NULL)
@@ -490,22 +582,80 @@ EAS_PUBLIC EAS_RESULT JET_Init (EAS_DATA_HANDLE easHandle, const S_JET_CONFIG *p
     if (easHandle->jetHandle != NULL)
         return EAS_ERROR_FEATURE_ALREADY_ACTIVE;
     if (pConfig == NULL)
+    {
         pConfig = &jetDefaultConfig;
+        configSize = sizeof(S_JET_CONFIG);
+    }
+
+    /* fields the caller's config doesn't have keep their defaults of zero */
+    if (configSize > (EAS_INT) sizeof(S_JET_CONFIG))
+        configSize = sizeof(S_JET_CONFIG);
+    EAS_HWMemSet(&config, 0, sizeof(config));
+    if (configSize > 0)
+        EAS_HWMemCpy(&config, pConfig, configSize);
+
+    /* the ring indices wrap around, so its size is a power of 2 */
+    if (config.appEventQueueSize == 0)
+        config.appEventQueueSize = APP_EVENT_QUEUE_SIZE;
+    size = sizeof(S_JET_DATA);
+#ifdef _JET_EVENT_RING
+    if ((config.appEventQueueSize > MAX_APP_EVENT_QUEUE_SIZE) ||
+        ((config.appEventQueueSize & (config.appEventQueueSize - 1)) != 0))
+        return EAS_ERROR_PARAMETER_RANGE;
+#else
+    if (config.appEventQueueSize != APP_EVENT_QUEUE_SIZE)
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+
+    if (config.segmentQueueDepth == 0)
+        config.segmentQueueDepth = SEG_QUEUE_DEPTH;
+    if (config.maxLibraries == 0)
+        config.maxLibraries = JET_MAX_DLS_COLLECTIONS;
+#ifdef _JET_DYNAMIC_QUEUE
+    /* a segment that is stopping and the one after it need two entries */
+    if ((config.segmentQueueDepth < 2) || (config.segmentQueueDepth > MAX_SEG_QUEUE_DEPTH) ||
+        (config.maxLibraries > MAX_JET_DLS_COLLECTIONS))
+        return EAS_ERROR_PARAMETER_RANGE;
+    for (numCommands = 1; numCommands < config.segmentQueueDepth; numCommands <<= 1) {}
+
+    /* the segment queue, DLS collections and command ring follow the JET data */
+    segQueueOffset = size;
+    size += config.segmentQueueDepth * (EAS_I32) sizeof(S_JET_SEGMENT);
+    libHandlesOffset = size;
+    size += config.maxLibraries * (EAS_I32) sizeof(EAS_DLSLIB_HANDLE);
+    commandsOffset = size;
+    size += (EAS_I32) (numCommands * sizeof(S_JET_COMMAND));
+#else
+    if ((config.segmentQueueDepth != SEG_QUEUE_DEPTH) || (config.maxLibraries != JET_MAX_DLS_COLLECTIONS))
+        return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+#ifdef _JET_EVENT_RING
+    appEventsOffset = size;
+    size += config.appEventQueueSize * (EAS_I32) sizeof(S_JET_APP_EVENT);
+#endif
 
     /* allocate the JET data object */
-    pJet = EAS_HWMalloc(easHandle->hwInstData, sizeof(S_JET_DATA));
+    pJet = EAS_HWMalloc(easHandle->hwInstData, size);
     if (pJet == NULL)
         return EAS_ERROR_MALLOC_FAILED;
 
     /* initialize JET data structure */
-    EAS_HWMemSet(pJet, 0, sizeof(S_JET_DATA));
+    EAS_HWMemSet(pJet, 0, size);
     easHandle->jetHandle = pJet;
     pJet->flags = flags;
-
-    /* copy config data */
-    if (configSize > (EAS_INT) sizeof(S_JET_CONFIG))
-        configSize = sizeof(S_JET_CONFIG);
-    EAS_HWMemCpy(&pJet->config, pConfig, configSize);
+    pJet->config = config;
+#ifdef _JET_DYNAMIC_QUEUE
+    pJet->segQueue = (S_JET_SEGMENT*) ((EAS_U8*) pJet + segQueueOffset);
+    pJet->libHandles = (EAS_DLSLIB_HANDLE*) ((EAS_U8*) pJet + libHandlesOffset);
+    pJet->commands.pCommands = (S_JET_COMMAND*) ((EAS_U8*) pJet + commandsOffset);
+    pJet->commands.size = numCommands;
+    pJet->segQueueDepth = config.segmentQueueDepth;
+    pJet->maxLibraries = config.maxLibraries;
+#endif
+#ifdef _JET_EVENT_RING
+    pJet->appEvents.pEvents = (S_JET_APP_EVENT*) ((EAS_U8*) pJet + appEventsOffset);
+    pJet->appEvents.size = config.appEventQueueSize;
+#endif
     return EAS_SUCCESS;
 }
 
@@ -523,10 +673,10 @@ EAS_PUBLIC EAS_RESULT JET_Shutdown (EAS_DATA_HANDLE easHandle)
     /* close any open files */
     result = JET_CloseFile(easHandle);
 
-    /* free allocated data */
+    /* release the DLS collections, they may be shared with other instances */
     for(i = 0 ; i < easHandle->jetHandle->numLibraries ; i++) {
         if(easHandle->jetHandle->libHandles[i] != NULL) {
-            EAS_HWFree(easHandle->hwInstData, easHandle->jetHandle->libHandles[i]);
+            DLSCleanup(easHandle->hwInstData, easHandle->jetHandle->libHandles[i]);
             easHandle->jetHandle->libHandles[i] = NULL;
         }
     }
@@ -582,15 +732,33 @@ EAS_PUBLIC EAS_RESULT JET_Status (EAS_DATA_HANDLE easHandle, S_JET_STATUS *pStat
  *----------------------------------------------------------------------------
 */
 EAS_PUBLIC EAS_BOOL JET_GetEvent (EAS_DATA_HANDLE easHandle, EAS_U32 *pEventRaw, S_JET_EVENT *pEvent)
+{
+    EAS_U32 sampleTime;
+
+    return JET_GetTimedEvent(easHandle, pEventRaw, pEvent, &sampleTime);
+}
+
+/*----------------------------------------------------------------------------
+ * JET_GetTimedEvent()
+ *----------------------------------------------------------------------------
+ * Checks for application events and the sample they fall on
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_BOOL JET_GetTimedEvent (EAS_DATA_HANDLE easHandle, EAS_U32 *pEventRaw, S_JET_EVENT *pEvent, EAS_U32 *pSampleTime)
 {
     EAS_U32 jetEvent;
     EAS_BOOL gotEvent;
 
     /* process event queue */
+#ifdef _JET_EVENT_RING
+    gotEvent = JET_ReadAppEvent(easHandle, &jetEvent, pSampleTime);
+#else
     gotEvent = JET_ReadQueue(easHandle->jetHandle->appEventQueue,
         &easHandle->jetHandle->appEventQueueRead,
         easHandle->jetHandle->appEventQueueWrite,
         APP_EVENT_QUEUE_SIZE, &jetEvent);
+    *pSampleTime = 0;
+#endif
 
     if (gotEvent)
     {
@@ -604,6 +772,40 @@ EAS_PUBLIC EAS_BOOL JET_GetEvent (EAS_DATA_HANDLE easHandle, EAS_U32 *pEventRaw,
     return gotEvent;
 }
 
+/*----------------------------------------------------------------------------
+ * JET_GetEventOverflows()
+ *----------------------------------------------------------------------------
+ * Returns the number of application events dropped
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_GetEventOverflows (EAS_DATA_HANDLE easHandle, EAS_U32 *pCount)
+{
+#ifdef _JET_EVENT_RING
+    *pCount = EAS_HWAtomicLoad(&easHandle->jetHandle->appEvents.overflows);
+    return EAS_SUCCESS;
+#else
+    *pCount = 0;
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * JET_SetEventCallback()
+ *----------------------------------------------------------------------------
+ * Delivers application events to a callback after each frame
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_SetEventCallback (EAS_DATA_HANDLE easHandle, JET_EVENT_CALLBACK pCallback, EAS_VOID_PTR pUserData)
+{
+#ifdef _JET_EVENT_RING
+    easHandle->jetHandle->appEvents.pCallbackData = pUserData;
+    easHandle->jetHandle->appEvents.pCallback = pCallback;
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
 /*----------------------------------------------------------------------------
  * JET_QueueSegment()
  *----------------------------------------------------------------------------
@@ -645,13 +847,22 @@ EAS_PUBLIC EAS_RESULT JET_QueueSegment (EAS_DATA_HANDLE easHandle, EAS_INT segme
         return result;
     p->state = JET_STATE_OPEN;
 
-    /* if less than SEG_QUEUE_DEPTH segments queued up, prepare file for playback */
-    if (++easHandle->jetHandle->numQueuedSegments < SEG_QUEUE_DEPTH)
+#ifdef _JET_PREFETCH
+    /* prepare every segment here rather than in JET_Process on the render thread,
+       a segment that can't get a synthesizer yet is prepared when the one before it starts */
+    easHandle->jetHandle->numQueuedSegments++;
+    result = JET_PrepareSegment(easHandle, easHandle->jetHandle->queueSegment);
+    if ((result != EAS_SUCCESS) && (result != EAS_ERROR_NO_VIRTUAL_SYNTHESIZER))
+        return result;
+#else
+    /* if the queue is not about to fill up, prepare file for playback */
+    if (++easHandle->jetHandle->numQueuedSegments < JET_SEG_QUEUE_DEPTH(easHandle->jetHandle))
     {
         result = JET_PrepareSegment(easHandle, easHandle->jetHandle->queueSegment);
         if (result != EAS_SUCCESS)
             return result;
     }
+#endif
 
     /* create duplicate file handle */
     result = EAS_HWDupHandle(easHandle->hwInstData, easHandle->jetHandle->jetFileHandle, &fileHandle);
@@ -659,10 +870,51 @@ EAS_PUBLIC EAS_RESULT JET_QueueSegment (EAS_DATA_HANDLE easHandle, EAS_INT segme
         return result;
 
     easHandle->jetHandle->jetFileHandle = fileHandle;
-    easHandle->jetHandle->queueSegment = (EAS_U8) JET_NextSegment(easHandle->jetHandle->queueSegment);
+    easHandle->jetHandle->queueSegment = (EAS_U8) JET_NextSegment(easHandle->jetHandle, easHandle->jetHandle->queueSegment);
     return result;
 }
 
+/*----------------------------------------------------------------------------
+ * JET_QueueSegmentAsync()
+ *----------------------------------------------------------------------------
+ * Queue a segment for playback from outside the render thread
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_QueueSegmentAsync (EAS_DATA_HANDLE easHandle, EAS_INT segmentNum, EAS_INT libNum, EAS_INT repeatCount, EAS_INT transpose, EAS_U32 muteFlags, EAS_U8 userID)
+{
+#ifdef _JET_DYNAMIC_QUEUE
+    S_JET_COMMAND_RING *pRing;
+    S_JET_COMMAND *pCmd;
+    EAS_U32 head;
+
+    { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "JET_QueueSegmentAsync segNum=%d\n", segmentNum); */ }
+
+    /* make sure it's a valid segment and DLS */
+    if ((segmentNum < 0) || (segmentNum >= easHandle->jetHandle->numSegments))
+        return EAS_ERROR_PARAMETER_RANGE;
+    if (libNum >= easHandle->jetHandle->numLibraries)
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    /* the caller owns the head, JET_Process joins the commands and owns the tail */
+    pRing = &easHandle->jetHandle->commands;
+    head = pRing->head;
+    if ((head - EAS_HWAtomicLoad(&pRing->tail)) >= easHandle->jetHandle->segQueueDepth)
+        return EAS_ERROR_QUEUE_IS_FULL;
+
+    pCmd = &pRing->pCommands[head & (pRing->size - 1)];
+    pCmd->muteFlags = muteFlags;
+    pCmd->repeatCount = (EAS_I16) repeatCount;
+    pCmd->segmentNum = (EAS_U8) segmentNum;
+    pCmd->libNum = (EAS_I8) libNum;
+    pCmd->transpose = (EAS_I8) transpose;
+    pCmd->userID = userID;
+    EAS_HWAtomicStore(&pRing->head, head + 1);
+    return EAS_SUCCESS;
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
 /*----------------------------------------------------------------------------
  * JET_Play()
  *----------------------------------------------------------------------------
@@ -682,7 +934,7 @@ EAS_PUBLIC EAS_RESULT JET_Play (EAS_DATA_HANDLE easHandle)
         return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
 
     /* resume all paused streams */
-    for (index = 0; index < SEG_QUEUE_DEPTH; index++)
+    for (index = 0; index < JET_SEG_QUEUE_DEPTH(easHandle->jetHandle); index++)
     {
         if (((index == easHandle->jetHandle->playSegment) && (easHandle->jetHandle->segQueue[index].state == JET_STATE_READY)) ||
             (easHandle->jetHandle->segQueue[index].state == JET_STATE_PAUSED))
@@ -721,7 +973,7 @@ EAS_PUBLIC EAS_RESULT JET_Pause (EAS_DATA_HANDLE easHandle)
         return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
 
     /* pause all playing streams */
-    for (index = 0; index < SEG_QUEUE_DEPTH; index++)
+    for (index = 0; index < JET_SEG_QUEUE_DEPTH(easHandle->jetHandle); index++)
     {
         if (easHandle->jetHandle->segQueue[index].state == JET_STATE_PLAYING)
         {
@@ -823,6 +1075,38 @@ EAS_PUBLIC EAS_RESULT JET_SetMuteFlag (EAS_DATA_HANDLE easHandle, EAS_INT trackN
     return EAS_SUCCESS;
 }
 
+/*----------------------------------------------------------------------------
+ * JET_ArmClip()
+ *----------------------------------------------------------------------------
+ * Puts a clip trigger in the mute queue for JET_Event to act on
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT JET_ArmClip (EAS_DATA_HANDLE easHandle, EAS_INT clipID)
+{
+    EAS_INT i;
+    EAS_INT index = -1;
+
+    /* set active flag */
+    clipID |= JET_CLIP_ACTIVE_FLAG;
+
+    /* Reverse the search so that we get the first empty element */
+    for (i = JET_MUTE_QUEUE_SIZE-1; i >= 0 ; i--)
+    {
+        if (easHandle->jetHandle->muteQueue[i] == clipID)
+        {
+            index = i;
+            break;
+        }
+        if (easHandle->jetHandle->muteQueue[i] == 0)
+            index = i;
+    }
+    if (index < 0)
+        return EAS_ERROR_QUEUE_IS_FULL;
+
+    easHandle->jetHandle->muteQueue[index] = (EAS_U8) clipID | JET_CLIP_TRIGGER_FLAG;
+    return EAS_SUCCESS;
+}
+
 /*----------------------------------------------------------------------------
  * JET_TriggerClip()
  *----------------------------------------------------------------------------
@@ -839,34 +1123,390 @@ EAS_PUBLIC EAS_RESULT JET_SetMuteFlag (EAS_DATA_HANDLE easHandle, EAS_INT trackN
 */
 EAS_PUBLIC EAS_RESULT JET_TriggerClip (EAS_DATA_HANDLE easHandle, EAS_INT clipID)
 {
+    /* check for valid clipID */
+    if ((clipID < 0) || (clipID > 63))
+        return EAS_ERROR_PARAMETER_RANGE;
+    return JET_ArmClip(easHandle, clipID);
+}
+
+#ifdef _JET_TIMED_COMMANDS
+/*----------------------------------------------------------------------------
+ * JET_QueueTimedCommand()
+ *----------------------------------------------------------------------------
+ * Inserts a mute change or clip trigger in the timed queue, in time order
+ * and after the commands due at the same sample
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT JET_QueueTimedCommand (EAS_DATA_HANDLE easHandle, EAS_U8 type, EAS_U32 setFlags, EAS_U32 clearFlags, EAS_U32 sampleTime)
+{
+    S_JET_TIMED_COMMAND *pQueue;
     EAS_INT i;
-    EAS_INT index = -1;
 
+    if (easHandle->jetHandle->numTimedCommands >= JET_TIMED_QUEUE_SIZE)
+        return EAS_ERROR_QUEUE_IS_FULL;
+
+    /* the sample clock wraps around, compare the difference */
+    pQueue = easHandle->jetHandle->timedQueue;
+    for (i = easHandle->jetHandle->numTimedCommands; i > 0; i--)
+    {
+        if ((EAS_I32) (pQueue[i - 1].sampleTime - sampleTime) <= 0)
+            break;
+        pQueue[i] = pQueue[i - 1];
+    }
+    pQueue[i].sampleTime = sampleTime;
+    pQueue[i].setFlags = setFlags;
+    pQueue[i].clearFlags = clearFlags;
+    pQueue[i].type = type;
+    easHandle->jetHandle->numTimedCommands++;
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * JET_RunTimedCommands()
+ *----------------------------------------------------------------------------
+ * Applies the mute changes and clip triggers due at or before a sample
+ *----------------------------------------------------------------------------
+*/
+static void JET_RunTimedCommands (EAS_DATA_HANDLE easHandle, EAS_U32 sampleTime)
+{
+    S_JET_DATA *pJet;
+    S_JET_SEGMENT *pSeg;
+    S_JET_TIMED_COMMAND cmd;
+    EAS_INT i;
+
+    pJet = easHandle->jetHandle;
+    while ((pJet->numTimedCommands != 0) && ((EAS_I32) (sampleTime - pJet->timedQueue[0].sampleTime) >= 0))
+    {
+        cmd = pJet->timedQueue[0];
+        pJet->numTimedCommands--;
+        for (i = 0; i < pJet->numTimedCommands; i++)
+            pJet->timedQueue[i] = pJet->timedQueue[i + 1];
+
+        /* a clip that finds the mute queue full is dropped, as is a mute change with nothing playing */
+        if (cmd.type == JET_TIMED_CLIP)
+        {
+            (void) JET_ArmClip(easHandle, (EAS_INT) cmd.setFlags);
+            continue;
+        }
+        pSeg = &pJet->segQueue[pJet->playSegment];
+        if (pSeg->streamHandle == NULL)
+            continue;
+        pSeg->muteFlags = (pSeg->muteFlags & ~cmd.clearFlags) | cmd.setFlags;
+        EAS_IntSetStrmParam(easHandle, pSeg->streamHandle, PARSER_DATA_MUTE_FLAGS, (EAS_I32) pSeg->muteFlags);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * JET_EventTime()
+ *----------------------------------------------------------------------------
+ * Called from EAS_ParseEvents before each event it plays, so that the
+ * commands due by then change the events of the playing segment from
+ * that sample on
+ *----------------------------------------------------------------------------
+*/
+void JET_EventTime (EAS_DATA_HANDLE easHandle, EAS_HANDLE pStream, EAS_U32 sampleTime)
+{
+    /* other segments are parsed before or after it in the frame, not in time order with it */
+    if (pStream != easHandle->jetHandle->segQueue[easHandle->jetHandle->playSegment].streamHandle)
+        return;
+    JET_RunTimedCommands(easHandle, sampleTime);
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * JET_SetMuteFlagsAt()
+ *----------------------------------------------------------------------------
+ * Change the state of the mute flags at a sample time
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_SetMuteFlagsAt (EAS_DATA_HANDLE easHandle, EAS_U32 muteFlags, EAS_U32 sampleTime)
+{
+#ifdef _JET_TIMED_COMMANDS
+    return JET_QueueTimedCommand(easHandle, JET_TIMED_MUTE, muteFlags, ~muteFlags, sampleTime);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * JET_SetMuteFlagAt()
+ *----------------------------------------------------------------------------
+ * Change the state of a single mute flag at a sample time
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_SetMuteFlagAt (EAS_DATA_HANDLE easHandle, EAS_INT trackNum, EAS_BOOL muteFlag, EAS_U32 sampleTime)
+{
+#ifdef _JET_TIMED_COMMANDS
+    EAS_U32 trackMuteFlag;
+
+    /* setup flag */
+    if ((trackNum < 0) || (trackNum > 31))
+        return EAS_ERROR_PARAMETER_RANGE;
+    trackMuteFlag = (1 << trackNum);
+    if (muteFlag)
+        return JET_QueueTimedCommand(easHandle, JET_TIMED_MUTE, trackMuteFlag, 0, sampleTime);
+    return JET_QueueTimedCommand(easHandle, JET_TIMED_MUTE, 0, trackMuteFlag, sampleTime);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * JET_TriggerClipAt()
+ *----------------------------------------------------------------------------
+ * Trigger a clip at a sample time
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT JET_TriggerClipAt (EAS_DATA_HANDLE easHandle, EAS_INT clipID, EAS_U32 sampleTime)
+{
+#ifdef _JET_TIMED_COMMANDS
     /* check for valid clipID */
     if ((clipID < 0) || (clipID > 63))
         return EAS_ERROR_PARAMETER_RANGE;
+    return JET_QueueTimedCommand(easHandle, JET_TIMED_CLIP, (EAS_U32) clipID, 0, sampleTime);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
 
-    /* set active flag */
-    clipID |= JET_CLIP_ACTIVE_FLAG;
 
-    /* Reverse the search so that we get the first empty element */
-    for (i = JET_MUTE_QUEUE_SIZE-1; i >= 0 ; i--)
+/*----------------------------------------------------------------------------
+ * JET_RepeatSegment()
+ *----------------------------------------------------------------------------
+ * Restarts a segment that has more repeats to play
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT JET_RepeatSegment (EAS_DATA_HANDLE easHandle, EAS_INT queueNum)
+{
+    S_JET_SEGMENT *pSeg;
+    EAS_RESULT result;
+
+    { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "JET_Render repeating segment %d\n", queueNum); */ }
+
+    pSeg = &easHandle->jetHandle->segQueue[queueNum];
+    result = EAS_RewindJETStream(easHandle, pSeg->streamHandle);
+    if (result != EAS_SUCCESS)
+        return result;
+    if (pSeg->repeatCount > 0)
+        pSeg->repeatCount--;
+
+    /* update mute flags if necessary */
+    if (pSeg->flags & JET_SEG_FLAG_MUTE_UPDATE)
     {
-        if (easHandle->jetHandle->muteQueue[i] == clipID)
+        result = EAS_IntSetStrmParam(easHandle, pSeg->streamHandle, PARSER_DATA_MUTE_FLAGS, (EAS_I32) pSeg->muteFlags);
+        if (result != EAS_SUCCESS)
+            return result;
+        pSeg->flags &= ~JET_SEG_FLAG_MUTE_UPDATE;
+    }
+    return EAS_SUCCESS;
+}
+
+#ifdef _JET_DYNAMIC_QUEUE
+/*----------------------------------------------------------------------------
+ * JET_JoinCommand()
+ *----------------------------------------------------------------------------
+ * Joins one segment queued by JET_QueueSegmentAsync while there is room
+ * for it, returns EAS_EOF if there was nothing to join
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT JET_JoinCommand (EAS_DATA_HANDLE easHandle)
+{
+    S_JET_DATA *pJet;
+    S_JET_COMMAND *pCmd;
+    EAS_U32 tail;
+    EAS_RESULT result;
+
+    pJet = easHandle->jetHandle;
+    tail = pJet->commands.tail;
+    if ((tail == EAS_HWAtomicLoad(&pJet->commands.head)) || (pJet->segQueue[pJet->queueSegment].streamHandle != NULL))
+        return EAS_EOF;
+
+    pCmd = &pJet->commands.pCommands[tail & (pJet->commands.size - 1)];
+    result = JET_QueueSegment(easHandle, pCmd->segmentNum, pCmd->libNum, pCmd->repeatCount, pCmd->transpose, pCmd->muteFlags, pCmd->userID);
+    EAS_HWAtomicStore(&pJet->commands.tail, tail + 1);
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+ * JET_ServiceQueue()
+ *----------------------------------------------------------------------------
+ * Prepares the segment after the playing one and closes the oldest
+ * stopping segment once its notes have died out
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT JET_ServiceQueue (EAS_DATA_HANDLE easHandle)
+{
+    S_JET_DATA *pJet;
+    S_JET_SEGMENT *pSeg;
+    EAS_STATE state;
+    EAS_INT index;
+    EAS_RESULT result;
+
+    pJet = easHandle->jetHandle;
+
+    /* prepare the segment after the playing one */
+    if (pJet->segQueue[pJet->playSegment].state == JET_STATE_PLAYING)
+    {
+        index = JET_NextSegment(pJet, pJet->playSegment);
+        if (pJet->segQueue[index].state == JET_STATE_OPEN)
         {
-            index = i;
-            break;
+            result = JET_PrepareSegment(easHandle, index);
+            if ((result != EAS_SUCCESS) && (result != EAS_ERROR_NO_VIRTUAL_SYNTHESIZER))
+                return result;
         }
-        if (easHandle->jetHandle->muteQueue[i] == 0)
-            index = i;
     }
-    if (index < 0)
-        return EAS_ERROR_QUEUE_IS_FULL;
 
-    easHandle->jetHandle->muteQueue[index] = (EAS_U8) clipID | JET_CLIP_TRIGGER_FLAG;
+    /* close the oldest stopping segment once its notes have died out */
+    while ((pJet->stopSegment != pJet->playSegment) && (pJet->segQueue[pJet->stopSegment].state == JET_STATE_CLOSED))
+        pJet->stopSegment = (EAS_U8) JET_NextSegment(pJet, pJet->stopSegment);
+    pSeg = &pJet->segQueue[pJet->stopSegment];
+    if (pSeg->state == JET_STATE_STOPPING)
+    {
+        result = EAS_State(easHandle, pSeg->streamHandle, &state);
+        if (result != EAS_SUCCESS)
+            return result;
+        if (state == EAS_STATE_STOPPED)
+        {
+            result = JET_CloseSegment(easHandle, pJet->stopSegment);
+            if (result != EAS_SUCCESS)
+                return result;
+            pJet->stopSegment = (EAS_U8) JET_NextSegment(pJet, pJet->stopSegment);
+        }
+    }
     return EAS_SUCCESS;
 }
 
+/*----------------------------------------------------------------------------
+ * JET_ProcessQueue()
+ *----------------------------------------------------------------------------
+ * Advances the segment queue by looking only at the segments that can
+ * change state this frame, so the cost does not grow with the queue depth.
+ * In realtime mode the segments are opened, prepared and closed by
+ * JET_Service, and a segment becomes the playing one only once prepared.
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT JET_ProcessQueue (EAS_DATA_HANDLE easHandle, EAS_BOOL endOfLoop)
+{
+    S_JET_DATA *pJet;
+    S_JET_SEGMENT *pSeg;
+    EAS_STATE state;
+    EAS_INT index;
+    EAS_BOOL service;
+    EAS_RESULT result = EAS_SUCCESS;
+
+    pJet = easHandle->jetHandle;
+    service = EAS_TRUE;
+#ifdef _RT_SAFE_RENDER
+    if (easHandle->realtimeRender)
+        service = EAS_FALSE;
+#endif
+
+    /* join one segment queued by JET_QueueSegmentAsync while there is room for it */
+    if (service)
+    {
+        result = JET_JoinCommand(easHandle);
+        if ((result != EAS_SUCCESS) && (result != EAS_EOF))
+            return result;
+        result = EAS_SUCCESS;
+    }
+
+    /* take action if the playing segment is stopping */
+    index = pJet->playSegment;
+    pSeg = &pJet->segQueue[index];
+    if (pSeg->state == JET_STATE_PLAYING)
+    {
+        result = EAS_State(easHandle, pSeg->streamHandle, &state);
+        if (result != EAS_SUCCESS)
+            return result;
+        if (endOfLoop || (state == EAS_STATE_STOPPING) || (state == EAS_STATE_STOPPED))
+        {
+            /* handle repeats */
+            if (pSeg->repeatCount != 0)
+            {
+                result = JET_RepeatSegment(easHandle, index);
+                if (result != EAS_SUCCESS)
+                    return result;
+            }
+
+            /* no repeat, start next segment */
+            else
+            {
+                { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "JET_Render stopping queue %d\n", index); */ }
+                pSeg->state = JET_STATE_STOPPING;
+                index = JET_NextSegment(pJet, index);
+                pJet->playSegment = (EAS_U8) index;
+                pSeg = &pJet->segQueue[index];
+                if (service && (pSeg->state == JET_STATE_OPEN))
+                {
+                    result = JET_PrepareSegment(easHandle, index);
+                    if (result != EAS_SUCCESS)
+                        return result;
+                }
+            }
+        }
+    }
+
+    /* start the next segment, including one queued after the previous one ended */
+    if ((pSeg->state == JET_STATE_READY) && (pJet->flags & JET_FLAGS_PLAYING))
+    {
+        result = JET_StartPlayback(easHandle, index);
+        if (result != EAS_SUCCESS)
+            return result;
+    }
+
+    /* prepare the next segment and close the stopped ones */
+    if (service)
+    {
+        result = JET_ServiceQueue(easHandle);
+        if (result != EAS_SUCCESS)
+            return result;
+    }
+
+    /* if out of segments, clear playing flag */
+    if (pJet->numQueuedSegments == 0)
+        pJet->flags &= ~JET_FLAGS_PLAYING;
+    return result;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * JET_Service()
+ *----------------------------------------------------------------------------
+ * Does the work on the segment queue that EAS_Render defers in realtime
+ * mode
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, easHandle) used only with _JET_DYNAMIC_QUEUE */
+EAS_PUBLIC EAS_RESULT JET_Service (EAS_DATA_HANDLE easHandle)
+{
+#ifdef _JET_DYNAMIC_QUEUE
+    S_JET_DATA *pJet;
+    EAS_RESULT result;
+
+    pJet = easHandle->jetHandle;
+
+    /* join the segments queued by JET_QueueSegmentAsync while there is room */
+    do
+    {
+        result = JET_JoinCommand(easHandle);
+    } while (result == EAS_SUCCESS);
+    if (result != EAS_EOF)
+        return result;
+
+    /* the playing segment waits here when the one before it ended unprepared */
+    if (pJet->segQueue[pJet->playSegment].state == JET_STATE_OPEN)
+    {
+        result = JET_PrepareSegment(easHandle, pJet->playSegment);
+        if ((result != EAS_SUCCESS) && (result != EAS_ERROR_NO_VIRTUAL_SYNTHESIZER))
+            return result;
+    }
+
+    return JET_ServiceQueue(easHandle);
+#else
+    return EAS_ERROR_FEATURE_NOT_AVAILABLE;
+#endif
+}
+
 /*----------------------------------------------------------------------------
  * JET_Process()
  *----------------------------------------------------------------------------
@@ -875,16 +1515,38 @@ EAS_PUBLIC EAS_RESULT JET_TriggerClip (EAS_DATA_HANDLE easHandle, EAS_INT clipID
 */
 EAS_PUBLIC EAS_RESULT JET_Process (EAS_DATA_HANDLE easHandle)
 {
+#ifndef _JET_DYNAMIC_QUEUE
     S_JET_SEGMENT *pSeg;
     EAS_STATE state;
     EAS_INT index;
     EAS_INT playIndex;
     EAS_RESULT result = EAS_SUCCESS;
-    EAS_BOOL endOfLoop = EAS_FALSE;
     EAS_BOOL startNextSegment = EAS_FALSE;
     EAS_BOOL prepareNextSegment = EAS_FALSE;
+#endif
+    EAS_BOOL endOfLoop = EAS_FALSE;
     EAS_U32 jetEvent;
 
+#ifdef _JET_TIMED_COMMANDS
+    /* commands due in the frame just rendered after the last event of the playing segment */
+    if (easHandle->jetHandle->numTimedCommands != 0)
+        JET_RunTimedCommands(easHandle, easHandle->sampleTime - 1);
+#endif
+
+#ifdef _JET_EVENT_RING
+    /* deliver the application events of the frame just rendered */
+    if (easHandle->jetHandle->appEvents.pCallback != NULL)
+    {
+        S_JET_EVENT event;
+        EAS_U32 sampleTime;
+        while (JET_ReadAppEvent(easHandle, &jetEvent, &sampleTime))
+        {
+            JET_ParseEvent(jetEvent, &event);
+            (*easHandle->jetHandle->appEvents.pCallback)(easHandle->jetHandle->appEvents.pCallbackData, jetEvent, &event, sampleTime);
+        }
+    }
+#endif
+
     /* process event queue */
     while (JET_ReadQueue(easHandle->jetHandle->jetEventQueue,
         &easHandle->jetHandle->jetEventQueueRead,
@@ -904,6 +1566,9 @@ EAS_PUBLIC EAS_RESULT JET_Process (EAS_DATA_HANDLE easHandle)
             endOfLoop = EAS_TRUE;
     }
 
+#ifdef _JET_DYNAMIC_QUEUE
+    return JET_ProcessQueue(easHandle, endOfLoop);
+#else
     /* check state of all streams */
     index = playIndex = easHandle->jetHandle->playSegment;
     for (;;)
@@ -927,22 +1592,9 @@ EAS_PUBLIC EAS_RESULT JET_Process (EAS_DATA_HANDLE easHandle)
                         /* handle repeats */
                         if (pSeg->repeatCount != 0)
                         {
-                            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "JET_Render repeating segment %d\n", index); */ }
-                            result = EAS_Locate(easHandle, pSeg->streamHandle, 0, EAS_FALSE);
+                            result = JET_RepeatSegment(easHandle, index);
                             if (result != EAS_SUCCESS)
                                 return result;
-                            if (pSeg->repeatCount > 0)
-                                pSeg->repeatCount--;
-
-                            /* update mute flags if necessary */
-                            if (pSeg->flags & JET_SEG_FLAG_MUTE_UPDATE)
-                            {
-                                result = EAS_IntSetStrmParam(easHandle, pSeg->streamHandle, PARSER_DATA_MUTE_FLAGS, (EAS_I32) pSeg->muteFlags);
-                                if (result != EAS_SUCCESS)
-                                    return result;
-                                pSeg->flags &= ~JET_SEG_FLAG_MUTE_UPDATE;
-                            }
-
                         }
                         /* no repeat, start next segment */
                         else
@@ -950,7 +1602,7 @@ EAS_PUBLIC EAS_RESULT JET_Process (EAS_DATA_HANDLE easHandle)
                             { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "JET_Render stopping queue %d\n", index); */ }
                             startNextSegment = EAS_TRUE;
                             pSeg->state = JET_STATE_STOPPING;
-                            easHandle->jetHandle->playSegment = (EAS_U8) JET_NextSegment(index);
+                            easHandle->jetHandle->playSegment = (EAS_U8) JET_NextSegment(easHandle->jetHandle, index);
                         }
                     }
                     break;
@@ -996,7 +1648,7 @@ EAS_PUBLIC EAS_RESULT JET_Process (EAS_DATA_HANDLE easHandle)
         }
 
         /* increment index */
-        index = JET_NextSegment(index);
+        index = JET_NextSegment(easHandle->jetHandle, index);
         if (index == playIndex)
             break;
     }
@@ -1006,6 +1658,7 @@ EAS_PUBLIC EAS_RESULT JET_Process (EAS_DATA_HANDLE easHandle)
         easHandle->jetHandle->flags &= ~JET_FLAGS_PLAYING;
 
     return result;
+#endif
 }
 
 /*----------------------------------------------------------------------------
@@ -1071,11 +1724,15 @@ void JET_Event (EAS_DATA_HANDLE easHandle, EAS_U32 segTrack, EAS_U8 channel, EAS
 #ifdef DEBUG_JET
         JET_DumpEvent("JET_Event[app]", event);
 #endif
+#ifdef _JET_EVENT_RING
+        JET_WriteAppEvent(easHandle, event);
+#else
         JET_WriteQueue(easHandle->jetHandle->appEventQueue,
             &easHandle->jetHandle->appEventQueueWrite,
             easHandle->jetHandle->appEventQueueRead,
             APP_EVENT_QUEUE_SIZE,
             event);
+#endif
     }
 
     /* write to JET queue */
@@ -1107,7 +1764,7 @@ EAS_RESULT JET_Clear_Queue(EAS_DATA_HANDLE easHandle)
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "JET_Clear_Queue\n"); */ }
 
     /* pause all playing streams */
-    for (index = 0; index < SEG_QUEUE_DEPTH; index++)
+    for (index = 0; index < JET_SEG_QUEUE_DEPTH(easHandle->jetHandle); index++)
     {
         if (easHandle->jetHandle->segQueue[index].state == JET_STATE_PLAYING)
         {
@@ -1120,7 +1777,7 @@ EAS_RESULT JET_Clear_Queue(EAS_DATA_HANDLE easHandle)
     }
 
     /* close all streams */
-    for (index = 0; index < SEG_QUEUE_DEPTH; index++)
+    for (index = 0; index < JET_SEG_QUEUE_DEPTH(easHandle->jetHandle); index++)
     {
         if (easHandle->jetHandle->segQueue[index].streamHandle != NULL)
         {
@@ -1135,9 +1792,17 @@ EAS_RESULT JET_Clear_Queue(EAS_DATA_HANDLE easHandle)
     {
         easHandle->jetHandle->muteQueue[index] = 0;
     }
+#ifdef _JET_TIMED_COMMANDS
+    easHandle->jetHandle->numTimedCommands = 0;
+#endif
 
     easHandle->jetHandle->flags &= ~JET_FLAGS_PLAYING;
     easHandle->jetHandle->playSegment = easHandle->jetHandle->queueSegment = 0;
+#ifdef _JET_DYNAMIC_QUEUE
+    /* drop the segments still waiting to join the queue */
+    easHandle->jetHandle->stopSegment = 0;
+    EAS_HWAtomicStore(&easHandle->jetHandle->commands.tail, EAS_HWAtomicLoad(&easHandle->jetHandle->commands.head));
+#endif
     return result;
 }
 
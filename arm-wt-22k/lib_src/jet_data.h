@@ -37,26 +37,38 @@
 #define JET_MAX_SEGMENTS            32
 #endif
 
-/* maximum number of DLS collections allowed in a JET file */
+/* maximum number of DLS collections allowed in a JET file, default with _JET_DYNAMIC_QUEUE */
 #ifndef JET_MAX_DLS_COLLECTIONS
 #define JET_MAX_DLS_COLLECTIONS     4
 #endif
 
+/* largest S_JET_CONFIG.maxLibraries and segmentQueueDepth, S_JET_SEGMENT.libNum is 8 bits */
+#define MAX_JET_DLS_COLLECTIONS     64
+#define MAX_SEG_QUEUE_DEPTH         64
+
 /* maximum number of JET events in internal queue */
 #ifndef JET_EVENT_QUEUE_SIZE
 #define JET_EVENT_QUEUE_SIZE        32
 #endif
 
-/* maximum number of JET events in application queue */
+/* maximum number of JET events in application queue, default ring size with _JET_EVENT_RING */
 #ifndef APP_EVENT_QUEUE_SIZE
 #define APP_EVENT_QUEUE_SIZE        32
 #endif
 
+/* largest application event ring S_JET_CONFIG.appEventQueueSize can ask for */
+#define MAX_APP_EVENT_QUEUE_SIZE    4096
+
 /* maximum number of active mute events */
 #ifndef JET_MUTE_QUEUE_SIZE
 #define JET_MUTE_QUEUE_SIZE         8
 #endif
 
+/* maximum number of mute changes and clip triggers waiting for their sample time */
+#ifndef JET_TIMED_QUEUE_SIZE
+#define JET_TIMED_QUEUE_SIZE        16
+#endif
+
 /*----------------------------------------------------------------------------
  * JET event definitions
  *----------------------------------------------------------------------------
@@ -128,6 +140,88 @@ typedef enum
 /* S_JEG_SEGMENT.flags */
 #define JET_SEG_FLAG_MUTE_UPDATE        0x01
 
+#ifdef _JET_DYNAMIC_QUEUE
+/*----------------------------------------------------------------------------
+ * S_JET_COMMAND
+ *
+ * JET_QueueSegmentAsync arguments, waiting for JET_Process to queue the
+ * segment. The command ring is a single producer, single consumer queue
+ * between the thread queueing segments and the render thread.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_jet_command_tag
+{
+    EAS_U32             muteFlags;
+    EAS_I16             repeatCount;
+    EAS_U8              segmentNum;
+    EAS_I8              libNum;
+    EAS_I8              transpose;
+    EAS_U8              userID;
+} S_JET_COMMAND;
+
+typedef struct s_jet_command_ring_tag
+{
+    S_JET_COMMAND       *pCommands;         /* size slots, following S_JET_DATA */
+    EAS_U32             size;               /* number of slots, a power of 2 */
+    volatile EAS_U32    head;               /* next slot to write, only the producer writes it */
+    EAS_U8              headPad[64 - sizeof(EAS_U32)];
+    volatile EAS_U32    tail;               /* next slot to read, only the consumer writes it */
+    EAS_U8              tailPad[64 - sizeof(EAS_U32)];
+} S_JET_COMMAND_RING;
+#endif
+
+#ifdef _JET_TIMED_COMMANDS
+/*----------------------------------------------------------------------------
+ * S_JET_TIMED_COMMAND
+ *
+ * Mute change or clip trigger waiting for its sample time. The queue is
+ * kept in time order, so only its first entry has to be checked before
+ * each event the parser plays.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_jet_timed_command_tag
+{
+    EAS_U32             sampleTime;         /* see EAS_GetSampleTime */
+    EAS_U32             setFlags;           /* tracks to mute, or the clip ID */
+    EAS_U32             clearFlags;         /* tracks to un-mute */
+    EAS_U8              type;
+} S_JET_TIMED_COMMAND;
+
+/* S_JET_TIMED_COMMAND.type */
+#define JET_TIMED_MUTE                  0
+#define JET_TIMED_CLIP                  1
+#endif
+
+#ifdef _JET_EVENT_RING
+/*----------------------------------------------------------------------------
+ * S_JET_APP_EVENT
+ *
+ * Application event ring slot. The ring is a single producer, single
+ * consumer queue between the render thread and the thread that calls
+ * JET_GetEvent, or the render thread itself when an event callback is set.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_jet_app_event_tag
+{
+    EAS_U32             event;              /* event in JET_GetEvent format */
+    EAS_U32             sampleTime;         /* sample the event falls on, see EAS_GetSampleTime */
+} S_JET_APP_EVENT;
+
+/* head and tail are kept on separate cache lines so the threads don't share them */
+typedef struct s_jet_app_ring_tag
+{
+    S_JET_APP_EVENT     *pEvents;           /* size slots, following S_JET_DATA */
+    EAS_U32             size;               /* number of slots, a power of 2 */
+    JET_EVENT_CALLBACK  pCallback;          /* drains the ring after each frame if set */
+    EAS_VOID_PTR        pCallbackData;
+    volatile EAS_U32    overflows;          /* events dropped because the ring was full */
+    volatile EAS_U32    head;               /* next slot to write, only the producer writes it */
+    EAS_U8              headPad[64 - sizeof(EAS_U32)];
+    volatile EAS_U32    tail;               /* next slot to read, only the consumer writes it */
+    EAS_U8              tailPad[64 - sizeof(EAS_U32)];
+} S_JET_APP_RING;
+#endif
+
 /*----------------------------------------------------------------------------
  * S_JET_DATA
  *
@@ -138,15 +232,31 @@ typedef enum
 typedef struct s_jet_data_tag
 {
     EAS_FILE_HANDLE     jetFileHandle;
+#ifdef _JET_DYNAMIC_QUEUE
+    S_JET_SEGMENT       *segQueue;          /* segQueueDepth entries, following S_JET_DATA */
+    EAS_DLSLIB_HANDLE   *libHandles;        /* maxLibraries entries */
+    S_JET_COMMAND_RING  commands;
+#else
     S_JET_SEGMENT       segQueue[SEG_QUEUE_DEPTH];
+#endif
     EAS_I32             segmentOffsets[JET_MAX_SEGMENTS];
     EAS_I32             appDataOffset;
     EAS_I32             appDataSize;
+#ifndef _JET_DYNAMIC_QUEUE
     EAS_DLSLIB_HANDLE   libHandles[JET_MAX_DLS_COLLECTIONS];
+#endif
     EAS_U32             jetEventQueue[JET_EVENT_QUEUE_SIZE];
+#ifdef _JET_EVENT_RING
+    S_JET_APP_RING      appEvents;
+#else
     EAS_U32             appEventQueue[APP_EVENT_QUEUE_SIZE];
+#endif
     S_JET_CONFIG        config;
     EAS_U32             segmentTime;
+#ifdef _JET_TIMED_COMMANDS
+    S_JET_TIMED_COMMAND timedQueue[JET_TIMED_QUEUE_SIZE];
+    EAS_U8              numTimedCommands;
+#endif
     EAS_U8              muteQueue[JET_MUTE_QUEUE_SIZE];
     EAS_U8              numSegments;
     EAS_U8              numLibraries;
@@ -154,15 +264,31 @@ typedef struct s_jet_data_tag
     EAS_U8              playSegment;
     EAS_U8              queueSegment;
     EAS_U8              numQueuedSegments;
+#ifdef _JET_DYNAMIC_QUEUE
+    EAS_U8              stopSegment;        /* oldest segment that may still be stopping */
+    EAS_U8              segQueueDepth;
+    EAS_U8              maxLibraries;
+#endif
     EAS_U8              jetEventQueueRead;
     EAS_U8              jetEventQueueWrite;
+#ifndef _JET_EVENT_RING
     EAS_U8              appEventQueueRead;
     EAS_U8              appEventQueueWrite;
+#endif
 } S_JET_DATA;
 
 /* flags for S_JET_DATA.flags */
 #define JET_FLAGS_PLAYING       1
 
+/* segment queue depth and DLS collections of this instance */
+#ifdef _JET_DYNAMIC_QUEUE
+#define JET_SEG_QUEUE_DEPTH(pJet)   ((pJet)->segQueueDepth)
+#define JET_MAX_LIBRARIES(pJet)     ((pJet)->maxLibraries)
+#else
+#define JET_SEG_QUEUE_DEPTH(pJet)   SEG_QUEUE_DEPTH
+#define JET_MAX_LIBRARIES(pJet)     JET_MAX_DLS_COLLECTIONS
+#endif
+
 #define JET_EVENT_VAL_MASK      0x0000007f  /* mask for value */
 #define JET_EVENT_CTRL_MASK     0x00003f80  /* mask for controller */
 #define JET_EVENT_CHAN_MASK     0x0003c000  /* mask for channel */
@@ -179,5 +305,10 @@ extern void JET_Event (EAS_DATA_HANDLE easHandle, EAS_U32 segTrack, EAS_U8 chann
 /* prototype for JET render function */
 extern EAS_PUBLIC EAS_RESULT JET_Process (EAS_DATA_HANDLE easHandle);
 
+#ifdef _JET_TIMED_COMMANDS
+/* prototype for the function that applies timed commands before an event the parser plays */
+extern void JET_EventTime (EAS_DATA_HANDLE easHandle, EAS_HANDLE pStream, EAS_U32 sampleTime);
+#endif
+
 #endif
 
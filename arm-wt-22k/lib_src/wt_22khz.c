@@ -1391,7 +1391,7 @@ const S_BANK eas_banks[] =
 
 /* NOTE: this array should have size of at least eas_sampleOffsets[last_element] + eas_sampleLengths[last_element] */
 #ifdef _8_BIT_SAMPLES
-const EAS_SAMPLE eas_samples[0x00033cbd + 20] =
+const EAS_SAMPLE eas_samples[0x00033cbd + 20] EAS_CACHE_ALIGNED =
 {
        0,    0,   -3,   -4,   -6,   -8,  -10,  -12,  -12,  -11,   -8,   -3,    3,    7,   10,   14,
       16,   16,   15,   12,    9,    4,   -4,  -12,  -18,  -21,  -21,  -19,  -18,  -15,  -10,   -3,
@@ -14698,7 +14698,7 @@ const EAS_U32 eas_sampleOffsets[] =
 };
 #else //_16_BIT_SAMPLES
 /* NOTE: this array should have size of at least eas_sampleOffsets[last_element] + eas_sampleLengths[last_element] */
-const EAS_SAMPLE eas_samples[0x00033cbd + 20] =
+const EAS_SAMPLE eas_samples[0x00033cbd + 20] EAS_CACHE_ALIGNED =
 {
     0, 0, -768, -1024, -1536, -2048, -2560, -3072, -3072, -2816, -2048, -768, 768, 1792, 2560, 3584,
     4096, 4096, 3840, 3072, 2304, 1024, -1024, -3072, -4608, -5376, -5376, -4864, -4608, -3840, -2560, -768,
@@ -1015,6 +1015,20 @@ class JET_Status (Structure):
 				('currentQueuedSegment', c_int),
 				]
 
+#---------------------------------------------------------------
+# JET_BounceSegment
+#---------------------------------------------------------------
+class JET_BounceSegment (Structure):
+	_fields_ = [('segmentNum', c_int),
+				('libNum', c_int),
+				('repeatCount', c_int),
+				('transpose', c_int),
+				('muteFlags', c_ulong),
+				('outFile', c_char_p),
+				('numSamples', c_long),
+				('result', c_long),
+				]
+
 #---------------------------------------------------------------
 # JET_File
 #---------------------------------------------------------------
@@ -1226,4 +1240,27 @@ class JET (object):
 			if result:
 				raise EAS_Exception(result, 'JET_SetMuteFlag error %d' % result, 'JET_SetMuteFlags')
 
-
+#---------------------------------------------------------------
+# BounceSegments
+#---------------------------------------------------------------
+def BounceSegments (jet_file, segments, max_threads=0):
+	"""Renders JET segments to WAV files faster than realtime, several
+	at a time, without the output device. Returns the number of sample
+	frames written for each segment.
+
+	Arguments:
+		jet_file - path to the JET file
+		segments - list of (seg_num, out_file, dls_num, repeat, transpose, mute_flags),
+		           everything after out_file may be left out
+		max_threads - most segments rendered at once, 0 for one per core
+
+	"""
+	bounce = (JET_BounceSegment * len(segments))()
+	for i, seg in enumerate(segments):
+		seg = tuple(seg) + (-1, 0, 0, 0)[len(seg) - 2:]
+		bounce[i].segmentNum, bounce[i].outFile, bounce[i].libNum, bounce[i].repeatCount, bounce[i].transpose, bounce[i].muteFlags = seg
+	eas_logger.debug('Call JET_BounceSegments for file: %s' % jet_file)
+	result = eas_dll.JET_BounceSegments(jet_file, bounce, len(segments), max_threads)
+	if result:
+		raise EAS_Exception(result, 'JET_BounceSegments error %d on file %s' % (result, jet_file), 'JET_BounceSegments')
+	return [bounce[i].numSamples for i in range(len(segments))]
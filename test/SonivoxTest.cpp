@@ -20,10 +20,18 @@
 
 #include <fcntl.h>
 #include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <thread>
+#include <vector>
 
 #include <libsonivox/eas.h>
+#include <libsonivox/eas_chorus.h>
 #include <libsonivox/eas_reverb.h>
+#include <libsonivox/jet.h>
 
 #include "SonivoxTestEnvironment.h"
 
@@ -36,6 +44,7 @@ static constexpr uint32_t kSeekBeyondPlayTimeOffsetMs = 10;
 static SonivoxTestEnvironment *gEnv = nullptr;
 static int readAt(void *, void *, int, int);
 static int getSize(void *);
+static EAS_RESULT writePCM(EAS_VOID_PTR, const EAS_PCM *, EAS_I32);
 
 class SonivoxTest : public ::testing::TestWithParam<tuple</*fileName*/ string,
                                                           /*audioPlayTimeMs*/ uint32_t,
@@ -146,6 +155,10 @@ class SonivoxTest : public ::testing::TestWithParam<tuple</*fileName*/ string,
 
     bool seekToLocation(EAS_I32);
     bool renderAudio();
+    void openInstance(EAS_DATA_HANDLE *, EAS_HANDLE *, EAS_FILE_LOCATOR locator = nullptr);
+    void closeInstance(EAS_DATA_HANDLE, EAS_HANDLE);
+    void renderFrames(EAS_DATA_HANDLE, vector<EAS_PCM> &);
+    bool makeJetFile(vector<uint8_t> &);
     int readAt(void *buf, int offset, int size);
     int getSize();
 
@@ -175,6 +188,12 @@ static int getSize(void *handle) {
     return ((SonivoxTest *)handle)->getSize();
 }
 
+static EAS_RESULT writePCM(EAS_VOID_PTR userData, const EAS_PCM *buffer, EAS_I32 numSamples) {
+    vector<EAS_PCM> *output = (vector<EAS_PCM> *)userData;
+    output->insert(output->end(), buffer, buffer + numSamples * EAS_Config()->numChannels);
+    return EAS_SUCCESS;
+}
+
 int SonivoxTest::readAt(void *buffer, int offset, int size) {
     if (offset > mLength) offset = mLength;
     lseek(mFd, mBase + offset, SEEK_SET);
@@ -189,6 +208,69 @@ int SonivoxTest::getSize() {
     return mLength;
 }
 
+void SonivoxTest::openInstance(EAS_DATA_HANDLE *pEASDataHandle, EAS_HANDLE *pEASStreamHandle,
+                               EAS_FILE_LOCATOR locator) {
+    EAS_RESULT result = EAS_Init(pEASDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+
+    result = EAS_OpenFile(*pEASDataHandle, locator ? locator : &mEasFile, pEASStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open file";
+
+    result = EAS_Prepare(*pEASDataHandle, *pEASStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to prepare EAS data and stream handles";
+
+    /* match the state of the fixture instance */
+    EAS_I32 playTimeMs;
+    result = EAS_ParseMetaData(*pEASDataHandle, *pEASStreamHandle, &playTimeMs);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to parse meta data";
+}
+
+void SonivoxTest::closeInstance(EAS_DATA_HANDLE easDataHandle, EAS_HANDLE easStreamHandle) {
+    EAS_RESULT result = EAS_CloseFile(easDataHandle, easStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to close audio file/stream";
+    result = EAS_Shutdown(easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to deallocate the resources for synthesizer library";
+}
+
+void SonivoxTest::renderFrames(EAS_DATA_HANDLE easDataHandle, vector<EAS_PCM> &output) {
+    EAS_I32 count;
+    for (size_t offset = 0; offset < output.size(); offset += count * mEASConfig->numChannels) {
+        EAS_RESULT result =
+                EAS_Render(easDataHandle, &output[offset], mEASConfig->mixBufferSize, &count);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+        ASSERT_EQ(count, mEASConfig->mixBufferSize) << "Short render";
+    }
+}
+
+// a JET file holding the test file as its only segment, false if it isn't a standard MIDI file
+bool SonivoxTest::makeJetFile(vector<uint8_t> &jet) {
+    vector<uint8_t> smf(mLength);
+    if (readAt(smf.data(), 0, mLength) != mLength) return false;
+    if (mLength < 4 || memcmp(smf.data(), "MThd", 4) != 0) return false;
+
+    auto putTag = [&](const char *tag) { jet.insert(jet.end(), tag, tag + 4); };
+    auto putDWord = [&](uint32_t value) {
+        for (int i = 0; i < 4; i++) jet.push_back((value >> (8 * i)) & 0xff);
+    };
+    jet.clear();
+    putTag("JET ");
+    putDWord(0);
+    putTag("JINF");
+    putDWord(24);
+    putTag("SMF#");
+    putDWord(1);
+    putTag("DLS#");
+    putDWord(0);
+    putTag("JVER");
+    putDWord(0x01000000);
+    putTag("JSMF");
+    putDWord(smf.size());
+    jet.insert(jet.end(), smf.begin(), smf.end());
+    uint32_t jetSize = jet.size();
+    memcpy(&jet[4], &jetSize, sizeof(jetSize));
+    return true;
+}
+
 bool SonivoxTest::seekToLocation(EAS_I32 locationExpectedMs) {
     EAS_RESULT result = EAS_Locate(mEASDataHandle, mEASStreamHandle, locationExpectedMs, false);
     if (result != EAS_SUCCESS) return false;
@@ -347,6 +429,3840 @@ TEST_P(SonivoxTest, DecodePauseResumeTest) {
     ASSERT_EQ(state, EAS_STATE_PLAY) << "Invalid state reached when resumed";
 }
 
+TEST_P(SonivoxTest, SeekRepeatTest) {
+    // seek past the middle and back again, so the second seek can start from a
+    // checkpoint recorded by the first; output must match a single seek
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+
+    EAS_I32 seekPosition = mAudioplayTimeMs / 2;
+    ASSERT_TRUE(seekToLocation(mAudioplayTimeMs * 3 / 4)) << "Failed to seek past the middle";
+    ASSERT_TRUE(seekToLocation(seekPosition)) << "Failed to seek to " << seekPosition;
+    EAS_RESULT result = EAS_Locate(easDataHandle, easStreamHandle, seekPosition, false);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to seek to " << seekPosition;
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 16;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, expected));
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, actual));
+    ASSERT_EQ(expected, actual) << "Repeated seek does not match a single seek";
+
+    closeInstance(easDataHandle, easStreamHandle);
+}
+
+TEST_P(SonivoxTest, DecodeVariableBufferTest) {
+    // render the same stream with a second instance in buffers that are not a
+    // multiple of the mix buffer size, output must match frame sized rendering
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+
+    EAS_I32 numChannels = mEASConfig->numChannels;
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 16;
+    vector<EAS_PCM> expected(totalSamples * numChannels);
+    vector<EAS_PCM> actual(totalSamples * numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+
+    static constexpr EAS_I32 kRequestSizes[] = {1, 77, 960, 1024, 300};
+    uint32_t request = 0;
+    EAS_I32 count;
+    for (EAS_I32 offset = 0; offset < totalSamples; offset += count) {
+        EAS_I32 numRequested = min(kRequestSizes[request++ % (sizeof(kRequestSizes) / sizeof(kRequestSizes[0]))],
+                                   totalSamples - offset);
+        EAS_RESULT result =
+                EAS_Render(easDataHandle, &actual[offset * numChannels], numRequested, &count);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+        ASSERT_EQ(count, numRequested) << "Short render";
+    }
+    ASSERT_EQ(expected, actual) << "Variable size render does not match frame size render";
+
+    closeInstance(easDataHandle, easStreamHandle);
+}
+
+TEST_P(SonivoxTest, DecodeParallelTest) {
+    // render the same stream with a second instance using worker threads,
+    // output must match serial rendering
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+
+    EAS_RESULT result = EAS_SetRenderThreads(easDataHandle, 4);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        closeInstance(easDataHandle, easStreamHandle);
+        GTEST_SKIP() << "Parallel voice rendering not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set the number of render threads";
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+    ASSERT_EQ(expected, actual) << "Parallel render does not match serial render";
+
+    closeInstance(easDataHandle, easStreamHandle);
+}
+
+TEST_P(SonivoxTest, CPUBudgetTest) {
+    // a budget no frame can meet must lower the polyphony limit, and
+    // removing the budget must restore it
+    EAS_RESULT result = EAS_SetCPUBudget(mEASDataHandle, -1);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "CPU budget not supported";
+    }
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Negative budget accepted";
+
+    EAS_I32 fullPolyphony;
+    result = EAS_GetPolyphonyLimit(mEASDataHandle, &fullPolyphony);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the polyphony limit";
+
+    result = EAS_SetCPUBudget(mEASDataHandle, 1);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set the CPU budget";
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> output(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, output));
+
+    EAS_I32 polyphony;
+    result = EAS_GetPolyphonyLimit(mEASDataHandle, &polyphony);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the polyphony limit";
+    ASSERT_GT(polyphony, 0) << "All voices shed";
+    ASSERT_LT(polyphony, fullPolyphony) << "Polyphony not reduced to meet the budget";
+
+    result = EAS_SetCPUBudget(mEASDataHandle, 0);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to clear the CPU budget";
+    result = EAS_GetPolyphonyLimit(mEASDataHandle, &polyphony);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the polyphony limit";
+    ASSERT_EQ(polyphony, fullPolyphony) << "Polyphony not restored";
+}
+
+struct DeadlineState {
+    EAS_I32 calls = 0;
+    bool consistent = true;
+};
+
+static void onDeadline(EAS_VOID_PTR pUserData, const S_EAS_FRAME_TIMING *pTiming) {
+    DeadlineState *state = static_cast<DeadlineState *>(pUserData);
+    state->calls++;
+    if (pTiming->totalTime <= pTiming->budget || pTiming->numSamples <= 0 ||
+        pTiming->parseTime > pTiming->totalTime || pTiming->renderTime > pTiming->totalTime ||
+        pTiming->postTime > pTiming->totalTime ||
+        (pTiming->numParsedStreams > 0) != (pTiming->slowestStream != nullptr)) {
+        state->consistent = false;
+    }
+}
+
+TEST_P(SonivoxTest, DeadlineCallbackTest) {
+    // a deadline no frame can meet must report every frame with a consistent
+    // breakdown, and one every frame meets must report none
+    DeadlineState state;
+    EAS_RESULT result = EAS_SetDeadlineCallback(mEASDataHandle, -1, onDeadline, &state);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Deadline monitor not supported";
+    }
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Negative budget accepted";
+    ASSERT_EQ(EAS_SetDeadlineCallback(mEASDataHandle, 1, nullptr, nullptr),
+              EAS_ERROR_INVALID_PARAMETER) << "Budget accepted without a callback";
+
+    // a budget of zero would stop timing, a second per frame is never missed
+    result = EAS_SetDeadlineCallback(mEASDataHandle, 1000000, onDeadline, &state);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set the deadline";
+    vector<EAS_PCM> output(mEASConfig->mixBufferSize * kNumBuffersToCombine * 16 *
+                           mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, output));
+    ASSERT_EQ(state.calls, 0) << "Frames reported late against a generous deadline";
+
+    // the clock is in microseconds, so some frames may take no measurable
+    // time, but most of a busy passage cannot
+    result = EAS_SetDeadlineCallback(mEASDataHandle, 1, onDeadline, &state);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set the deadline";
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, output));
+    ASSERT_GT(state.calls, 0) << "No frame reported late against an impossible deadline";
+    ASSERT_TRUE(state.consistent) << "Inconsistent timing reported";
+
+    result = EAS_SetDeadlineCallback(mEASDataHandle, 0, nullptr, nullptr);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to clear the deadline";
+    EAS_I32 calls = state.calls;
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, output));
+    ASSERT_EQ(state.calls, calls) << "Frames reported after the deadline was cleared";
+}
+
+struct DiagState {
+    EAS_I32 messages = 0;
+    bool parseError = false;
+};
+
+static void onDiagnostic(EAS_VOID_PTR pUserData, EAS_INT, const char *pMessage) {
+    DiagState *state = static_cast<DiagState *>(pUserData);
+    state->messages++;
+    if (strstr(pMessage, "pfEvent returned") != nullptr) {
+        state->parseError = true;
+    }
+}
+
+TEST_P(SonivoxTest, DiagnosticsTest) {
+    // a MIDI file with a meta event running past its end fails while
+    // rendering, the error must wait in the ring until it is drained
+    const uint8_t smf[] = {
+            'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01, 0x00, 0x60,
+            'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x0f,
+            0x00, 0x90, 0x3c, 0x40,
+            0x60, 0xff, 0x01, 0xbf, 0xff, 0xff, 0x7f,
+            0x00, 0xff, 0x2f, 0x00,
+    };
+
+    DiagState state;
+    EAS_I32 numEvents = -1;
+    EAS_RESULT result = EAS_DrainDiagnostics(onDiagnostic, &state, &numEvents);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Diagnostics ring not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to drain the diagnostics";
+    ASSERT_GE(numEvents, 0) << "Wrong number of events drained";
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, smf, sizeof(smf));
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open the MIDI file";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to prepare the MIDI file";
+    vector<EAS_PCM> output(mEASConfig->mixBufferSize * mEASConfig->numChannels);
+    EAS_I32 count = 0;
+    result = EAS_SUCCESS;
+    for (int i = 0; i < 100 && result == EAS_SUCCESS; i++) {
+        result = EAS_Render(easDataHandle, output.data(), mEASConfig->mixBufferSize, &count);
+    }
+    ASSERT_NE(result, EAS_SUCCESS) << "Truncated file rendered without an error";
+
+    state = DiagState();
+    ASSERT_EQ(EAS_DrainDiagnostics(onDiagnostic, &state, &numEvents), EAS_SUCCESS)
+            << "Failed to drain the diagnostics";
+    ASSERT_GE(numEvents, 1) << "The parse error was not posted";
+    ASSERT_EQ(state.messages, numEvents) << "Wrong number of messages";
+    ASSERT_TRUE(state.parseError) << "The parse error was not reported";
+
+    ASSERT_EQ(EAS_DrainDiagnostics(onDiagnostic, &state, &numEvents), EAS_SUCCESS)
+            << "Failed to drain the diagnostics";
+    ASSERT_EQ(numEvents, 0) << "Events drained twice";
+
+    ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+struct CountingFile {
+    SonivoxTest *test;
+    int reads;
+};
+
+TEST_P(SonivoxTest, RealtimeRenderTest) {
+    // in realtime mode the file is read while it is opened and never while
+    // rendering, which sounds the same as rendering from the file
+    CountingFile counter = {this, 0};
+    EAS_FILE file;
+    file.handle = &counter;
+    file.readAt = [](void *handle, void *buffer, int offset, int size) {
+        CountingFile *f = (CountingFile *)handle;
+        f->reads++;
+        return ::readAt(f->test, buffer, offset, size);
+    };
+    file.size = [](void *handle) { return ::getSize(((CountingFile *)handle)->test); };
+
+    vector<EAS_PCM> output[2];
+    for (int realtime = 0; realtime < 2; realtime++) {
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS)
+                << "Failed to initialize synthesizer library";
+        if (realtime) {
+            EAS_RESULT result = EAS_SetRealtimeRender(easDataHandle, EAS_TRUE);
+            if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+                EAS_Shutdown(easDataHandle);
+                GTEST_SKIP() << "Realtime render not supported";
+            }
+            ASSERT_EQ(result, EAS_SUCCESS) << "Failed to enable realtime render";
+        }
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &file, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open audio file";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to prepare the audio file";
+        if (realtime) {
+            ASSERT_EQ(EAS_SetRealtimeRender(easDataHandle, EAS_FALSE),
+                      EAS_ERROR_NOT_VALID_IN_THIS_STATE)
+                    << "Realtime render changed with a stream open";
+            EAS_HANDLE progressiveHandle = nullptr;
+            ASSERT_EQ(EAS_OpenFileProgressive(easDataHandle, &file, 0, &progressiveHandle),
+                      EAS_ERROR_NOT_VALID_IN_THIS_STATE)
+                    << "Progressive file opened in realtime mode";
+        }
+
+        int reads = counter.reads;
+        EAS_I32 count;
+        EAS_STATE state = EAS_STATE_PLAY;
+        while (state != EAS_STATE_STOPPED) {
+            ASSERT_EQ(EAS_Render(easDataHandle, mPCMBuffer, mEASConfig->mixBufferSize, &count),
+                      EAS_SUCCESS)
+                    << "Failed to render the audio data";
+            output[realtime].insert(output[realtime].end(), mPCMBuffer,
+                                    mPCMBuffer + count * mEASConfig->numChannels);
+            ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS)
+                    << "Failed to get the stream state";
+        }
+        if (realtime) {
+            ASSERT_EQ(counter.reads, reads) << "File read while rendering";
+        }
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+        ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+                << "Failed to deallocate the resources for synthesizer library";
+    }
+    ASSERT_TRUE(output[1] == output[0]) << "Realtime render differs from rendering from the file";
+}
+
+TEST_P(SonivoxTest, IdleTest) {
+    // two notes eight seconds apart, the instance goes idle in between and
+    // zero filling the idle frames sounds the same as rendering them
+    const uint8_t smf[] = {
+            'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01, 0x00, 0x60,
+            'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x12,
+            0x00, 0x90, 0x3c, 0x40,
+            0x60, 0x3c, 0x00,
+            0x8c, 0x00, 0x3c, 0x40,
+            0x60, 0x3c, 0x00,
+            0x00, 0xff, 0x2f, 0x00,
+    };
+
+    vector<EAS_PCM> output[2];
+    for (int skipIdle = 0; skipIdle < 2; skipIdle++) {
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS)
+                << "Failed to initialize synthesizer library";
+        EAS_RESULT result = EAS_SetIdleMode(easDataHandle, (EAS_BOOL)skipIdle);
+        if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+            EAS_Shutdown(easDataHandle);
+            GTEST_SKIP() << "Idle detection not supported";
+        }
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set the idle mode";
+        EAS_FILE memLocator;
+        EAS_MEMORY_FILE memFile;
+        EAS_InitMemoryLocator(&memLocator, &memFile, smf, sizeof(smf));
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open the MIDI file";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to prepare the MIDI file";
+
+        EAS_I32 count;
+        EAS_I32 location = 0;
+        EAS_I32 lastTime = -1;
+        int idleFrames = 0;
+        EAS_STATE state = EAS_STATE_PLAY;
+        while (state != EAS_STATE_STOPPED) {
+            ASSERT_EQ(EAS_Render(easDataHandle, mPCMBuffer, mEASConfig->mixBufferSize, &count),
+                      EAS_SUCCESS)
+                    << "Failed to render the audio data";
+            output[skipIdle].insert(output[skipIdle].end(), mPCMBuffer,
+                                    mPCMBuffer + count * mEASConfig->numChannels);
+            EAS_BOOL silent = EAS_FALSE;
+            EAS_BOOL idle = EAS_FALSE;
+            ASSERT_EQ(EAS_GetSilence(easDataHandle, &silent, &idle), EAS_SUCCESS)
+                    << "Failed to get the silence";
+            bool zero = std::all_of(mPCMBuffer, mPCMBuffer + count * mEASConfig->numChannels,
+                                    [](EAS_PCM sample) { return sample == 0; });
+            ASSERT_EQ(silent != EAS_FALSE, zero) << "Wrong silent flag";
+            ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS)
+                    << "Failed to get the stream state";
+            if (!idle || state == EAS_STATE_STOPPED) continue;
+
+            // the time to the second note counts down while the instance is idle
+            EAS_I32 nextTime = -1;
+            ASSERT_EQ(EAS_GetNextEventTime(easDataHandle, easStreamHandle, &nextTime),
+                      EAS_SUCCESS)
+                    << "Failed to get the next event time";
+            ASSERT_EQ(EAS_GetLocation(easDataHandle, easStreamHandle, &location), EAS_SUCCESS)
+                    << "Failed to get the location";
+            ASSERT_GT(nextTime, 0) << "No event ahead of an idle stream";
+            ASSERT_NEAR(location + nextTime, 8500, 1) << "Wrong next event time";
+            if (lastTime >= 0) {
+                ASSERT_LT(nextTime, lastTime) << "Next event time did not count down";
+            }
+            lastTime = nextTime;
+            idleFrames++;
+        }
+        ASSERT_GT(idleFrames, 0) << "Instance never went idle";
+        ASSERT_GT(location, 0) << "Idle before anything played";
+
+        EAS_I32 nextTime = 0;
+        ASSERT_EQ(EAS_GetNextEventTime(easDataHandle, easStreamHandle, &nextTime), EAS_SUCCESS)
+                << "Failed to get the next event time";
+        ASSERT_EQ(nextTime, -1) << "Event ahead of a stopped stream";
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+        ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+                << "Failed to deallocate the resources for synthesizer library";
+    }
+    ASSERT_TRUE(output[1] == output[0]) << "Skipping idle frames changed the output";
+}
+
+TEST_P(SonivoxTest, InterpolationTest) {
+    // render the same stream with each interpolation mode, the higher order
+    // modes must change the output without changing its level
+    EAS_RESULT result = EAS_SetInterpolation(mEASDataHandle, EAS_INTERPOLATION_ADAPTIVE + 1);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Cubic interpolation not supported";
+    }
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Invalid interpolation mode accepted";
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> linear(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, linear));
+
+    double linearEnergy = 0;
+    for (EAS_PCM sample : linear) linearEnergy += (double)sample * sample;
+    ASSERT_GT(linearEnergy, 0) << "Silent output";
+
+    for (EAS_I32 mode : {EAS_INTERPOLATION_CUBIC, EAS_INTERPOLATION_ADAPTIVE}) {
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+        result = EAS_SetInterpolation(easDataHandle, mode);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set interpolation mode " << mode;
+
+        vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+        ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+        ASSERT_NE(linear, actual) << "Interpolation mode " << mode << " has no effect";
+
+        double energy = 0;
+        for (EAS_PCM sample : actual) energy += (double)sample * sample;
+        ASSERT_NEAR(energy / linearEnergy, 1.0, 0.1) << "Level differs in mode " << mode;
+
+        closeInstance(easDataHandle, easStreamHandle);
+    }
+}
+
+TEST_P(SonivoxTest, PositionTest) {
+    // a note held for ten seconds at 96 ticks per quarter note and 120 BPM;
+    // the position advances a whole frame at a time and the part of a frame
+    // held for the next call shows up as latency
+    const uint8_t smf[] = {
+            'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01, 0x00, 0x60,
+            'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x0c,
+            0x00, 0x90, 0x3c, 0x40,
+            0x8f, 0x00, 0x3c, 0x00,
+            0x00, 0xff, 0x2f, 0x00,
+    };
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, smf, sizeof(smf));
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open the MIDI file";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to prepare the MIDI file";
+    S_EAS_POSITION position;
+    EAS_RESULT result = EAS_GetPosition(easDataHandle, easStreamHandle, &position);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        EAS_CloseFile(easDataHandle, easStreamHandle);
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "Position report not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the position";
+    ASSERT_EQ(position.samples, 0u) << "Position before the first frame";
+    ASSERT_EQ(position.ticks, 0) << "Ticks before the first frame";
+    ASSERT_EQ(position.latency, 0) << "Latency before the first frame";
+
+    // requests that end part way through a frame
+    EAS_I32 returned = 0;
+    EAS_I32 count;
+    for (int i = 0; i < 200; i++) {
+        EAS_I32 numRequested = mEASConfig->mixBufferSize + (i % 3) * 17;
+        vector<EAS_PCM> output(numRequested * mEASConfig->numChannels);
+        ASSERT_EQ(EAS_Render(easDataHandle, output.data(), numRequested, &count), EAS_SUCCESS)
+                << "Failed to render the audio data";
+        returned += count;
+
+        ASSERT_EQ(EAS_GetPosition(easDataHandle, easStreamHandle, &position), EAS_SUCCESS)
+                << "Failed to get the position";
+        ASSERT_EQ(position.samples % mEASConfig->mixBufferSize, 0u) << "Position inside a frame";
+        ASSERT_EQ(position.sampleTime, position.samples) << "Position off the sample clock";
+        ASSERT_EQ((EAS_I32)position.samples - position.latency, returned) << "Wrong latency";
+
+        // 192 ticks a second
+        double seconds = (double)position.samples / mEASConfig->sampleRate;
+        ASSERT_NEAR(position.ticks, seconds * 192, 1.5) << "Wrong tick position";
+    }
+
+    ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, SnapshotTest) {
+    // take a snapshot while two notes sound and play on past more notes;
+    // after restoring the snapshot the stream must play the same samples
+    // again. The shared effects are not part of a snapshot, so they are off.
+    const uint8_t smf[] = {
+            'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01, 0x00, 0x60,
+            'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x25,
+            0x00, 0x90, 0x3c, 0x60,
+            0x00, 0x90, 0x40, 0x60,
+            0x60, 0x90, 0x43, 0x60,
+            0x60, 0x80, 0x3c, 0x00,
+            0x60, 0x90, 0x48, 0x60,
+            0x81, 0x40, 0x80, 0x40, 0x00,
+            0x00, 0x80, 0x43, 0x00,
+            0x60, 0x80, 0x48, 0x00,
+            0x00, 0xff, 0x2f, 0x00,
+    };
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    (void)EAS_SetParameter(easDataHandle, EAS_MODULE_REVERB, EAS_PARAM_REVERB_BYPASS, EAS_TRUE);
+    (void)EAS_SetParameter(easDataHandle, EAS_MODULE_CHORUS, EAS_PARAM_CHORUS_BYPASS, EAS_TRUE);
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, smf, sizeof(smf));
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open the MIDI file";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to prepare the MIDI file";
+
+    EAS_I32 stateSize = 0;
+    EAS_RESULT result = EAS_SaveState(easDataHandle, easStreamHandle, nullptr, 0, &stateSize);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        EAS_CloseFile(easDataHandle, easStreamHandle);
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "Snapshots not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the snapshot size";
+    ASSERT_GT(stateSize, 0) << "Empty snapshot";
+
+    const EAS_I32 frameSize = mEASConfig->mixBufferSize * mEASConfig->numChannels;
+    vector<EAS_PCM> output(frameSize * 50);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, output));
+
+    vector<uint8_t> state(stateSize);
+    EAS_I32 size = 0;
+    ASSERT_EQ(EAS_SaveState(easDataHandle, easStreamHandle, state.data(), stateSize - 1, &size),
+              EAS_BUFFER_SIZE_MISMATCH)
+            << "Accepted a short buffer";
+    ASSERT_EQ(EAS_SaveState(easDataHandle, easStreamHandle, state.data(), stateSize, &size),
+              EAS_SUCCESS)
+            << "Failed to save the state";
+    ASSERT_GT(size, 0) << "Empty snapshot";
+    ASSERT_LE(size, stateSize) << "Snapshot overran the buffer";
+    EAS_I32 savedMs = 0;
+    ASSERT_EQ(EAS_GetLocation(easDataHandle, easStreamHandle, &savedMs), EAS_SUCCESS)
+            << "Failed to get the location";
+
+    vector<EAS_PCM> expected(frameSize * 200);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, expected));
+    ASSERT_TRUE(std::any_of(expected.begin(), expected.end(),
+                            [](EAS_PCM sample) { return sample != 0; }))
+            << "Nothing played after the snapshot";
+
+    vector<uint8_t> corrupt(state.begin(), state.begin() + size);
+    corrupt[0] ^= 0xff;
+    ASSERT_EQ(EAS_RestoreState(easDataHandle, easStreamHandle, corrupt.data(), size),
+              EAS_ERROR_INVALID_PARAMETER)
+            << "Restored a corrupt snapshot";
+    ASSERT_EQ(EAS_RestoreState(easDataHandle, easStreamHandle, state.data(), size), EAS_SUCCESS)
+            << "Failed to restore the state";
+    EAS_I32 restoredMs = -1;
+    ASSERT_EQ(EAS_GetLocation(easDataHandle, easStreamHandle, &restoredMs), EAS_SUCCESS)
+            << "Failed to get the location";
+    ASSERT_EQ(restoredMs, savedMs) << "Restored to another location";
+
+    vector<EAS_PCM> actual(frameSize * 200);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+    ASSERT_TRUE(actual == expected) << "Restored stream played differently";
+
+    ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, RenderRingTest) {
+    // render into a ring that is not a whole number of frames, in requests
+    // that wrap around its end; unrolled, it must match a linear render
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 16;
+    vector<EAS_PCM> linear(totalSamples * mEASConfig->numChannels);
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, linear));
+    closeInstance(easDataHandle, easStreamHandle);
+
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+    EAS_I32 ringSize = mEASConfig->mixBufferSize * 3 + 37;
+    vector<EAS_PCM> ring(ringSize * mEASConfig->numChannels);
+    EAS_I32 count = -1;
+    ASSERT_EQ(EAS_RenderRing(easDataHandle, ring.data(), ringSize, ringSize, 1, &count),
+              EAS_BUFFER_SIZE_MISMATCH)
+            << "Write position past the ring accepted";
+    ASSERT_EQ(EAS_RenderRing(easDataHandle, ring.data(), ringSize, 0, ringSize + 1, &count),
+              EAS_BUFFER_SIZE_MISMATCH)
+            << "Request larger than the ring accepted";
+    ASSERT_EQ(count, 0) << "Samples generated for a rejected request";
+
+    vector<EAS_PCM> unrolled;
+    EAS_I32 writePos = ringSize - mEASConfig->mixBufferSize / 2;
+    const EAS_I32 requests[] = {mEASConfig->mixBufferSize * 2, mEASConfig->mixBufferSize + 5,
+                                ringSize, 3};
+    for (int i = 0; unrolled.size() < linear.size(); i++) {
+        EAS_I32 numRequested = requests[i % 4];
+        numRequested = std::min<EAS_I32>(
+                numRequested, (linear.size() - unrolled.size()) / mEASConfig->numChannels);
+        ASSERT_EQ(EAS_RenderRing(easDataHandle, ring.data(), ringSize, writePos, numRequested,
+                                 &count),
+                  EAS_SUCCESS)
+                << "Failed to render into the ring";
+        ASSERT_EQ(count, numRequested) << "Short render";
+        for (EAS_I32 n = 0; n < count; n++, writePos = (writePos + 1) % ringSize) {
+            unrolled.insert(unrolled.end(), &ring[writePos * mEASConfig->numChannels],
+                            &ring[(writePos + 1) * mEASConfig->numChannels]);
+        }
+    }
+    ASSERT_TRUE(unrolled == linear) << "Ring render differs from a linear render";
+    closeInstance(easDataHandle, easStreamHandle);
+}
+
+TEST_P(SonivoxTest, RenderBlockTest) {
+    // render the same stream a frame at a time and in blocks of frames; events
+    // move at most to the block boundary, so the level must stay the same
+    EAS_RESULT result = EAS_SetRenderBlock(mEASDataHandle, 0);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Block render not supported";
+    }
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Empty block accepted";
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> frames(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, frames));
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+    result = EAS_SetRenderBlock(easDataHandle, kNumBuffersToCombine);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set the render block";
+
+    vector<EAS_PCM> blocks(totalSamples * mEASConfig->numChannels);
+    EAS_I32 blockSize = mEASConfig->mixBufferSize * kNumBuffersToCombine;
+    EAS_I32 count;
+    for (size_t offset = 0; offset < blocks.size(); offset += count * mEASConfig->numChannels) {
+        result = EAS_Render(easDataHandle, &blocks[offset], blockSize, &count);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+        ASSERT_EQ(count, blockSize) << "Short render";
+    }
+
+    EAS_I32 frameTime, blockTime;
+    result = EAS_GetLocation(mEASDataHandle, mEASStreamHandle, &frameTime);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the location";
+    result = EAS_GetLocation(easDataHandle, easStreamHandle, &blockTime);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the location";
+    ASSERT_EQ(blockTime, frameTime) << "Location differs in block mode";
+    ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+
+    double frameEnergy = 0, blockEnergy = 0;
+    for (EAS_PCM sample : frames) frameEnergy += (double)sample * sample;
+    for (EAS_PCM sample : blocks) blockEnergy += (double)sample * sample;
+    ASSERT_GT(frameEnergy, 0) << "Silent output";
+    ASSERT_NEAR(blockEnergy / frameEnergy, 1.0, 0.1) << "Level differs in block mode";
+}
+
+TEST_P(SonivoxTest, RenderSliceTest) {
+    // render the same stream a frame at a time and in quarter frame slices;
+    // voices keep one update per frame, so the output must be the same
+    const EAS_I32 sliceSize = mEASConfig->mixBufferSize / 4;
+    EAS_RESULT result = EAS_SetRenderSlice(mEASDataHandle, sliceSize + 1);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Low latency render not supported";
+    }
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Odd slice size accepted";
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> frames(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, frames));
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+    result = EAS_SetRenderSlice(easDataHandle, sliceSize);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set the render slice";
+
+    vector<EAS_PCM> slices(totalSamples * mEASConfig->numChannels);
+    EAS_I32 count;
+    for (size_t offset = 0; offset < slices.size(); offset += count * mEASConfig->numChannels) {
+        result = EAS_Render(easDataHandle, &slices[offset], sliceSize, &count);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+        ASSERT_EQ(count, sliceSize) << "Short render";
+    }
+
+    EAS_I32 frameTime, sliceTime;
+    result = EAS_GetLocation(mEASDataHandle, mEASStreamHandle, &frameTime);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the location";
+    result = EAS_GetLocation(easDataHandle, easStreamHandle, &sliceTime);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the location";
+    ASSERT_EQ(sliceTime, frameTime) << "Location differs in slice mode";
+    ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+    ASSERT_TRUE(slices == frames) << "Output differs in slice mode";
+
+    // live input written between two slices sounds in the next slice
+    EAS_HANDLE midiStreamHandle = nullptr;
+    result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    result = EAS_SetRenderSlice(easDataHandle, sliceSize);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set the render slice";
+    result = EAS_OpenMIDIStream(easDataHandle, &midiStreamHandle, nullptr);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open MIDI stream";
+
+    vector<EAS_PCM> slice(sliceSize * mEASConfig->numChannels);
+    result = EAS_Render(easDataHandle, slice.data(), sliceSize, &count);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+    EAS_U8 noteOn[] = {0x90, 60, 127};
+    result = EAS_WriteMIDIStream(easDataHandle, midiStreamHandle, noteOn, sizeof(noteOn));
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to write MIDI stream";
+    result = EAS_Render(easDataHandle, slice.data(), sliceSize, &count);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+    ASSERT_TRUE(std::any_of(slice.begin(), slice.end(), [](EAS_PCM sample) { return sample != 0; }))
+            << "Note did not sound in the next slice";
+
+    EAS_CloseMIDIStream(easDataHandle, midiStreamHandle);
+    result = EAS_Shutdown(easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, MetricsTest) {
+    S_EAS_METRICS metrics;
+    EAS_RESULT result = EAS_GetMetrics(mEASDataHandle, &metrics);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Metrics not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get metrics";
+    ASSERT_EQ(metrics.numFrames, 0u) << "Metrics recorded before rendering";
+
+    vector<EAS_PCM> buffer(mEASConfig->mixBufferSize * kNumBuffersToCombine * 16 *
+                           mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, buffer));
+    result = EAS_GetMetrics(mEASDataHandle, &metrics);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get metrics";
+    ASSERT_EQ(metrics.numFrames, kNumBuffersToCombine * 16u) << "Wrong number of frames";
+
+    // every frame lands in exactly one bin of each histogram
+    for (int i = 0; i < EAS_NUM_METRICS; i++) {
+        if (i == EAS_METRIC_REVERB_TIME) continue;
+        const S_EAS_HISTOGRAM &histogram = metrics.histograms[i];
+        ASSERT_EQ(histogram.count, metrics.numFrames) << "Wrong count for metric " << i;
+        EAS_U32 total = 0;
+        for (int bin = 0; bin < EAS_METRICS_HISTOGRAM_BINS; bin++) total += histogram.bins[bin];
+        ASSERT_EQ(total, histogram.count) << "Histogram does not add up for metric " << i;
+    }
+    ASSERT_GT(metrics.histograms[EAS_METRIC_VOICES].max, 0u) << "No voices recorded";
+}
+
+TEST_P(SonivoxTest, DecodeMemoryTest) {
+    // open the same file from memory with a second instance, output must
+    // match rendering through the readAt callback
+    vector<uint8_t> contents(mLength);
+    ASSERT_EQ(readAt(contents.data(), 0, mLength), mLength) << "Failed to read file";
+
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, contents.data(), contents.size());
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle, &memLocator));
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+    ASSERT_EQ(expected, actual) << "Memory file render does not match readAt render";
+
+    closeInstance(easDataHandle, easStreamHandle);
+}
+
+TEST_P(SonivoxTest, XMFReopenTest) {
+    // reopening an XMF file plays the same, and a copy whose tree differs
+    // from the one opened before is parsed from its own tree
+    bool isXMF = mInputMediaFile.size() > 5 &&
+            mInputMediaFile.compare(mInputMediaFile.size() - 5, 5, ".mxmf") == 0;
+    if (!isXMF) {
+        GTEST_SKIP() << "Not an XMF file";
+    }
+    vector<uint8_t> contents(mLength);
+    ASSERT_EQ(readAt(contents.data(), 0, mLength), mLength) << "Failed to read file";
+    static const uint8_t kSMFChunk[] = {'M', 'T', 'h', 'd'};
+    auto smf = std::search(contents.begin(), contents.end(), kSMFChunk, kSMFChunk + 4);
+    ASSERT_NE(smf, contents.end()) << "No SMF chunk in file";
+
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, contents.data(), contents.size());
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+
+    // without an SMF chunk where the tree points, the file must not open
+    (*smf)++;
+    ASSERT_NE(EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle), EAS_SUCCESS)
+            << "Opened an XMF file without SMF data";
+    (*smf)--;
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle, &memLocator));
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+    ASSERT_EQ(expected, actual) << "Reopened file render does not match";
+    closeInstance(easDataHandle, easStreamHandle);
+}
+
+TEST_P(SonivoxTest, AsyncOpenTest) {
+    // open and prepare on a background thread while the instance renders,
+    // then check a background open plays the same as a synchronous one
+    vector<uint8_t> contents(mLength);
+    ASSERT_EQ(readAt(contents.data(), 0, mLength), mLength) << "Failed to read file";
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, contents.data(), contents.size());
+
+    struct OpenState {
+        std::atomic<bool> done{false};
+        EAS_RESULT result = EAS_FAILURE;
+    };
+    auto onOpen = [](EAS_VOID_PTR pUserData, EAS_HANDLE, EAS_RESULT result) {
+        OpenState *pState = static_cast<OpenState *>(pUserData);
+        pState->result = result;
+        pState->done = true;
+    };
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    OpenState state;
+    EAS_RESULT result =
+            EAS_OpenFileAsync(easDataHandle, &memLocator, onOpen, &state, &easStreamHandle);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "Background open not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to start the background open";
+    vector<EAS_PCM> frame(mEASConfig->mixBufferSize * mEASConfig->numChannels);
+    for (EAS_I32 i = 0; i < 100000 && !state.done; i++) {
+        ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, frame));
+    }
+    ASSERT_EQ(EAS_WaitOpen(easDataHandle, easStreamHandle), EAS_SUCCESS) << "Background open failed";
+    ASSERT_TRUE(state.done) << "Completion callback not called";
+    ASSERT_EQ(state.result, EAS_SUCCESS) << "Completion callback reported an error";
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, frame));
+    closeInstance(easDataHandle, easStreamHandle);
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    ASSERT_EQ(EAS_OpenFileAsync(easDataHandle, &memLocator, nullptr, nullptr, &easStreamHandle),
+              EAS_SUCCESS)
+            << "Failed to start the background open";
+    ASSERT_EQ(EAS_WaitOpen(easDataHandle, easStreamHandle), EAS_SUCCESS) << "Background open failed";
+    EAS_I32 playTimeMs;
+    ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+            << "Failed to parse meta data";
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+    ASSERT_EQ(expected, actual) << "Background open does not match synchronous open";
+    ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+
+    // a file no parser recognizes is reported to the callback and releases the stream
+    vector<uint8_t> garbage(256, 0x5a);
+    EAS_InitMemoryLocator(&memLocator, &memFile, garbage.data(), garbage.size());
+    OpenState failed;
+    ASSERT_EQ(EAS_OpenFileAsync(easDataHandle, &memLocator, onOpen, &failed, &easStreamHandle),
+              EAS_SUCCESS)
+            << "Failed to start the background open";
+    ASSERT_EQ(EAS_WaitOpen(easDataHandle, easStreamHandle), EAS_ERROR_UNRECOGNIZED_FORMAT)
+            << "Unrecognized file opened";
+    ASSERT_EQ(failed.result, EAS_ERROR_UNRECOGNIZED_FORMAT) << "Callback not told of the failure";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, ProgressiveFileTest) {
+    // a file arriving a block at a time prepares once every track has
+    // started, pauses where the data runs out and resumes when the rest
+    // arrives. Once complete it plays the same as the whole file
+    bool isSMF = mInputMediaFile.size() > 4 &&
+            mInputMediaFile.compare(mInputMediaFile.size() - 4, 4, ".mid") == 0;
+    if (!isSMF) {
+        GTEST_SKIP() << "Only SMF files play progressively";
+    }
+    vector<uint8_t> contents(mLength);
+    ASSERT_EQ(readAt(contents.data(), 0, mLength), mLength) << "Failed to read file";
+
+    struct Download {
+        const vector<uint8_t> *pContents;
+        int available;
+    } download = {&contents, 0};
+    EAS_FILE locator;
+    locator.handle = &download;
+    locator.readAt = [](void *handle, void *buf, int offset, int size) -> int {
+        Download *pDownload = static_cast<Download *>(handle);
+        if (offset >= pDownload->available) return 0;
+        if (size > pDownload->available - offset) size = pDownload->available - offset;
+        memcpy(buf, pDownload->pContents->data() + offset, size);
+        return size;
+    };
+    locator.size = [](void *handle) -> int {
+        return static_cast<Download *>(handle)->pContents->size();
+    };
+
+    static constexpr int kBlockSize = 64;
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    auto openProgressive = [&]() {
+        ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS)
+                << "Failed to initialize synthesizer library";
+        download.available = kBlockSize;
+        ASSERT_EQ(EAS_OpenFileProgressive(easDataHandle, &locator, download.available,
+                                          &easStreamHandle),
+                  EAS_SUCCESS)
+                << "Failed to open a partial file";
+        EAS_RESULT result;
+        while ((result = EAS_Prepare(easDataHandle, easStreamHandle)) == EAS_ERROR_DATA_UNDERRUN) {
+            ASSERT_LT(download.available, mLength) << "Prepare needs more than the whole file";
+            download.available = std::min<int>(download.available + kBlockSize, mLength);
+            ASSERT_EQ(EAS_SetStreamAvailable(easDataHandle, easStreamHandle, download.available,
+                                             EAS_FALSE),
+                      EAS_SUCCESS)
+                    << "Failed to report more data";
+        }
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to prepare a partial file";
+    };
+
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    download.available = kBlockSize;
+    EAS_RESULT result =
+            EAS_OpenFileProgressive(easDataHandle, &locator, download.available, &easStreamHandle);
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Progressive playback not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open a partial file";
+
+    // the last event always waits for the end of the file
+    ASSERT_NO_FATAL_FAILURE(openProgressive());
+    EAS_I32 playTimeMs;
+    ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs),
+              EAS_ERROR_DATA_UNDERRUN)
+            << "Length of a partial file reported";
+    vector<EAS_PCM> frame(mEASConfig->mixBufferSize * mEASConfig->numChannels);
+    EAS_STATE state = EAS_STATE_PLAY;
+    for (EAS_I32 i = 0; i < 100000 && state != EAS_STATE_PAUSING && state != EAS_STATE_PAUSED;
+         i++) {
+        ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, frame));
+        ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS);
+        ASSERT_NE(state, EAS_STATE_STOPPED) << "Played past the available data";
+    }
+    EAS_I32 stalledMs, laterMs;
+    ASSERT_EQ(EAS_GetLocation(easDataHandle, easStreamHandle, &stalledMs), EAS_SUCCESS);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, frame));
+    ASSERT_EQ(EAS_GetLocation(easDataHandle, easStreamHandle, &laterMs), EAS_SUCCESS);
+    ASSERT_EQ(stalledMs, laterMs) << "Stream time moved while waiting for data";
+
+    download.available = mLength;
+    ASSERT_EQ(EAS_SetStreamAvailable(easDataHandle, easStreamHandle, download.available, EAS_TRUE),
+              EAS_SUCCESS)
+            << "Failed to complete the download";
+    for (EAS_I32 i = 0; i < 100000 && state != EAS_STATE_STOPPED; i++) {
+        ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, frame));
+        ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS);
+    }
+    ASSERT_EQ(state, EAS_STATE_STOPPED) << "Stream did not play to the end";
+    closeInstance(easDataHandle, easStreamHandle);
+
+    // with the rest of the file ahead of playback the output is unchanged
+    ASSERT_NO_FATAL_FAILURE(openProgressive());
+    download.available = mLength;
+    ASSERT_EQ(EAS_SetStreamAvailable(easDataHandle, easStreamHandle, download.available, EAS_TRUE),
+              EAS_SUCCESS)
+            << "Failed to complete the download";
+    ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+            << "Failed to parse meta data";
+    ASSERT_EQ(playTimeMs, mAudioplayTimeMs) << "Wrong play time after the download";
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+    ASSERT_EQ(expected, actual) << "Progressive file render does not match";
+    closeInstance(easDataHandle, easStreamHandle);
+}
+
+TEST_P(SonivoxTest, FileTypeTest) {
+    // text ringtones are identified by their header, including an iMelody
+    // header in lower case, which must not be taken for an RTTTL name
+    const struct {
+        const char *contents;
+        EAS_I32 fileType;
+    } files[] = {
+            {"Test:d=4,o=5,b=120:c,e,g", EAS_FILE_RTTTL},
+            {"BEGIN:IMELODY\r\nVERSION:1.2\r\nFORMAT:CLASS1.0\r\nMELODY:c2d2e2\r\n"
+             "END:IMELODY\r\n",
+             EAS_FILE_IMELODY},
+            {"begin:imelody\r\nversion:1.2\r\nformat:class1.0\r\nmelody:c2d2e2\r\n"
+             "end:imelody\r\n",
+             EAS_FILE_IMELODY},
+    };
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    for (const auto &file : files) {
+        EAS_FILE memLocator;
+        EAS_MEMORY_FILE memFile;
+        EAS_InitMemoryLocator(&memLocator, &memFile, file.contents, strlen(file.contents));
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open " << file.contents;
+        EAS_I32 fileType = EAS_FILE_UNKNOWN;
+        ASSERT_EQ(EAS_GetFileType(easDataHandle, easStreamHandle, &fileType), EAS_SUCCESS)
+                << "Failed to get the file type";
+        ASSERT_EQ(fileType, file.fileType) << "Wrong file type for " << file.contents;
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+    }
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, MetaDataLengthTest) {
+    // the play length of a MIDI file with running status, SysEx and a tempo
+    // change part way through, it must be the same on every call
+    const uint8_t smf[] = {
+            'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06, 0x00, 0x01, 0x00, 0x02, 0x00, 0x60,
+            'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x25,
+            0x00, 0xff, 0x03, 0x04, 'T', 'e', 's', 't',
+            0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20,
+            0x00, 0x90, 0x3c, 0x40,
+            0x60, 0x3c, 0x00,
+            0x00, 0xff, 0x51, 0x03, 0x0f, 0x42, 0x40,
+            0x60, 0x80, 0x3c, 0x00,
+            0x00, 0xff, 0x2f, 0x00,
+            'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x17,
+            0x00, 0xf0, 0x05, 0x7e, 0x7f, 0x09, 0x01, 0xf7,
+            0x30, 0xc0, 0x05,
+            0x81, 0x00, 0x90, 0x40, 0x40,
+            0x40, 0x40, 0x00,
+            0x00, 0xff, 0x2f, 0x00,
+    };
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, smf, sizeof(smf));
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open the MIDI file";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to prepare the MIDI file";
+    for (int i = 0; i < 2; i++) {
+        EAS_I32 playTimeMs = 0;
+        ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+                << "Failed to parse the metadata";
+        ASSERT_EQ(playTimeMs, 2000) << "Wrong play length";
+    }
+    ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, MultiTrackTest) {
+    // every track ends one beat after the one before it, the next event is
+    // found in a different track each time
+    constexpr int kNumTracks = 40;
+    vector<uint8_t> smf = {'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06, 0x00, 0x01,
+                           0x00, kNumTracks, 0x00, 0x18};
+    for (int i = 0; i < kNumTracks; i++) {
+        const uint8_t channel = i % 16;
+        const int ticks = (i + 1) * 24;
+        const uint8_t track[] = {'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x0c,
+                                 0x00, (uint8_t)(0x90 | channel), 0x3c, 0x40,
+                                 (uint8_t)(0x80 | ticks >> 7), (uint8_t)(ticks & 0x7f), 0x3c, 0x00,
+                                 0x00, 0xff, 0x2f, 0x00};
+        smf.insert(smf.end(), track, track + sizeof(track));
+    }
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, smf.data(), smf.size());
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open the MIDI file";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to prepare the MIDI file";
+    EAS_I32 playTimeMs = 0;
+    ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+            << "Failed to parse the metadata";
+    ASSERT_EQ(playTimeMs, 19999) << "Wrong play length";
+    ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, ControllerFloodTest) {
+    // a controller and pitch bend on every tick, faster than the frame
+    // rate. Values replaced within a frame are not applied, the output
+    // must match a player that applies every event
+    constexpr int kNumTicks = 2000;
+    vector<uint8_t> events;
+    uint8_t delta = 0;
+    auto addEvent = [&events, &delta](uint8_t status, uint8_t d1, uint8_t d2) {
+        const uint8_t event[] = {delta, status, d1, d2};
+        // channel pressure has a single data byte
+        events.insert(events.end(), event, event + ((status & 0xf0) == 0xd0 ? 3 : 4));
+        delta = 0;
+    };
+    for (int tick = 0; tick < kNumTicks; tick++) {
+        const uint8_t value = (tick * 5) & 0x7f;
+        delta = tick ? 0x01 : 0x00;
+        if (tick % 240 == 0) {
+            if (tick) {
+                addEvent(0x80, 0x3c, 0x00);
+                addEvent(0x81, 0x43, 0x00);
+            }
+            addEvent(0x90, 0x3c, 0x60);
+            addEvent(0x91, 0x43, 0x60);
+        } else {
+            addEvent(0xb0, 0x07, 0x40 + (value >> 1));
+        }
+        addEvent(0xb0, 0x0b, 0x7f - value);
+        addEvent(0xe0, value, 0x7f - value);
+        addEvent(0xb1, 0x01, value);
+        addEvent(0xd1, value, 0x00);
+    }
+    const uint8_t endOfTrack[] = {0x01, 0x80, 0x3c, 0x00, 0x00, 0x81, 0x43, 0x00,
+                                  0x00, 0xff, 0x2f, 0x00};
+    events.insert(events.end(), endOfTrack, endOfTrack + sizeof(endOfTrack));
+    const uint32_t trackLength = events.size();
+    vector<uint8_t> smf = {'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01,
+                           0x03, 0xc0, 'M', 'T', 'r', 'k',
+                           (uint8_t)(trackLength >> 24), (uint8_t)(trackLength >> 16),
+                           (uint8_t)(trackLength >> 8), (uint8_t)trackLength};
+    smf.insert(smf.end(), events.begin(), events.end());
+
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, smf.data(), smf.size());
+
+    // the compiled event list coalesces, a file prepared while downloading
+    // is parsed as it plays
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    EAS_RESULT result =
+            EAS_OpenFileProgressive(easDataHandle, &memLocator, smf.size(), &easStreamHandle);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+                << "Failed to deallocate the resources for synthesizer library";
+        GTEST_SKIP() << "Progressive playback not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open the MIDI file";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to prepare the MIDI file";
+    ASSERT_EQ(EAS_SetStreamAvailable(easDataHandle, easStreamHandle, smf.size(), EAS_TRUE),
+              EAS_SUCCESS)
+            << "Failed to complete the download";
+    EAS_I32 playTimeMs;
+    ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+            << "Failed to parse meta data";
+
+    EAS_DATA_HANDLE coalescedDataHandle = nullptr;
+    EAS_HANDLE coalescedStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(
+            openInstance(&coalescedDataHandle, &coalescedStreamHandle, &memLocator));
+
+    // longer than the file so both play to the end
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, expected));
+    ASSERT_NO_FATAL_FAILURE(renderFrames(coalescedDataHandle, actual));
+    ASSERT_EQ(expected, actual) << "Coalesced controllers change the output";
+    ASSERT_NE(expected, vector<EAS_PCM>(expected.size(), 0)) << "No output rendered";
+
+    closeInstance(coalescedDataHandle, coalescedStreamHandle);
+    closeInstance(easDataHandle, easStreamHandle);
+}
+
+TEST_P(SonivoxTest, SPMIDIRepeatTest) {
+    // a MIP message before every note. A channel whose MIP is over the
+    // polyphony stays muted, repeating the table must not change the output
+    auto buildSMF = [](uint8_t mute, bool repeat, bool second) {
+        vector<uint8_t> events;
+        for (int note = 0; note < 8; note++) {
+            const uint8_t delta = note ? 0x60 : 0x00;
+            if (note == 0 || repeat) {
+                const uint8_t mip[] = {delta, 0xf0, 0x09, 0x7f, 0x7f, 0x0b,
+                                       0x01, 0x00, 0x02, 0x01, mute, 0xf7};
+                events.insert(events.end(), mip, mip + sizeof(mip));
+            } else {
+                events.push_back(delta);
+                events.push_back(0xb2);
+                events.push_back(0x07);
+                events.push_back(0x64);
+            }
+            const uint8_t noteOn[] = {0x00, 0x90, (uint8_t)(0x3c + note), 0x60,
+                                      0x00, 0x91, (uint8_t)(0x48 - note), 0x60};
+            events.insert(events.end(), noteOn, noteOn + (second ? 8 : 4));
+        }
+        const uint8_t endOfTrack[] = {0x60, 0xff, 0x2f, 0x00};
+        events.insert(events.end(), endOfTrack, endOfTrack + sizeof(endOfTrack));
+        const uint32_t trackLength = events.size();
+        vector<uint8_t> smf = {'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01,
+                               0x00, 0x60, 'M', 'T', 'r', 'k',
+                               (uint8_t)(trackLength >> 24), (uint8_t)(trackLength >> 16),
+                               (uint8_t)(trackLength >> 8), (uint8_t)trackLength};
+        smf.insert(smf.end(), events.begin(), events.end());
+        return smf;
+    };
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 16;
+    auto render = [&](vector<uint8_t> smf, vector<EAS_PCM> &out) {
+        EAS_FILE memLocator;
+        EAS_MEMORY_FILE memFile;
+        EAS_InitMemoryLocator(&memLocator, &memFile, smf.data(), smf.size());
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        EAS_HANDLE easStreamHandle = nullptr;
+        out.assign(totalSamples * mEASConfig->numChannels, 0);
+        ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle, &memLocator));
+        ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, out));
+        closeInstance(easDataHandle, easStreamHandle);
+    };
+
+    // the second channel needs more voices than the synth has
+    vector<EAS_PCM> expected, actual, unmuted;
+    ASSERT_NO_FATAL_FAILURE(render(buildSMF(0x7f, false, false), expected));
+    ASSERT_NO_FATAL_FAILURE(render(buildSMF(0x7f, true, true), actual));
+    ASSERT_NE(expected, vector<EAS_PCM>(expected.size(), 0)) << "No output rendered";
+    ASSERT_EQ(expected, actual) << "Muted channel played or repeated MIP changed the output";
+    ASSERT_NO_FATAL_FAILURE(render(buildSMF(0x04, true, true), unmuted));
+    ASSERT_NE(expected, unmuted) << "Channel within the polyphony was muted";
+}
+
+TEST_P(SonivoxTest, RingtoneRepeatTest) {
+    // an RTTTL ringtone played three times, the play length must not change
+    // after locating into one of the repeats
+    const char rtttl[] = "Test:d=4,o=5,b=120,l=2:c,p,8e";
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, rtttl, sizeof(rtttl) - 1);
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open the ringtone";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to prepare the ringtone";
+    for (int i = 0; i < 2; i++) {
+        EAS_I32 playTimeMs = 0;
+        ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+                << "Failed to parse the metadata";
+        ASSERT_EQ(playTimeMs, 3750) << "Wrong play length";
+        ASSERT_EQ(EAS_Locate(easDataHandle, easStreamHandle, 2000, EAS_FALSE), EAS_SUCCESS)
+                << "Failed to locate";
+    }
+    ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, ToneCacheTest) {
+    // prepare two ringtones on an instance with the tone cache; preparing
+    // the first again must play from its cached events exactly as a fresh
+    // instance plays it from the file, and disabling the cache frees it
+    const char first[] = "First:d=4,o=5,b=120:c,p,8e,g";
+    const char second[] = "Second:d=8,o=6,b=100:c,d,e,f,g";
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    EAS_RESULT result = EAS_SetToneCacheSize(easDataHandle, 4);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "Tone cache not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to enable the tone cache";
+    ASSERT_EQ(EAS_SetToneCacheSize(easDataHandle, -1), EAS_ERROR_PARAMETER_RANGE)
+            << "Accepted a negative cache size";
+    S_EAS_MEMORY_USAGE before, after;
+    bool accounted = EAS_GetMemoryUsage(easDataHandle, &before) == EAS_SUCCESS;
+
+    auto play = [&](EAS_DATA_HANDLE easDataHandle, const char *rtttl, size_t size,
+                    EAS_I32 &playTimeMs, vector<EAS_PCM> *output) {
+        EAS_FILE memLocator;
+        EAS_MEMORY_FILE memFile;
+        EAS_InitMemoryLocator(&memLocator, &memFile, rtttl, size - 1);
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open the ringtone";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to prepare the ringtone";
+        ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+                << "Failed to parse the metadata";
+        EAS_STATE state = EAS_STATE_READY;
+        while (output != nullptr) {
+            ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS)
+                    << "Failed to get EAS State";
+            if (state == EAS_STATE_STOPPED) break;
+            size_t offset = output->size();
+            output->resize(offset + mEASConfig->mixBufferSize * mEASConfig->numChannels);
+            EAS_I32 count;
+            ASSERT_EQ(EAS_Render(easDataHandle, &(*output)[offset], mEASConfig->mixBufferSize, &count),
+                      EAS_SUCCESS)
+                    << "Failed to render the audio data";
+        }
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+    };
+
+    EAS_I32 firstMs = 0, secondMs = 0, cachedMs = 0;
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, first, sizeof(first), firstMs, nullptr));
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, second, sizeof(second), secondMs, nullptr));
+    ASSERT_NE(firstMs, secondMs) << "Different ringtones have the same length";
+    vector<EAS_PCM> actual;
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, first, sizeof(first), cachedMs, &actual));
+    ASSERT_EQ(cachedMs, firstMs) << "Cached ringtone has a different length";
+
+    vector<EAS_PCM> expected;
+    EAS_DATA_HANDLE referenceHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&referenceHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    ASSERT_NO_FATAL_FAILURE(play(referenceHandle, first, sizeof(first), firstMs, &expected));
+    ASSERT_EQ(EAS_Shutdown(referenceHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+    ASSERT_TRUE(actual == expected) << "Cached ringtone played differently";
+
+    ASSERT_EQ(EAS_SetToneCacheSize(easDataHandle, 0), EAS_SUCCESS) << "Failed to disable the tone cache";
+    if (accounted) {
+        ASSERT_EQ(EAS_GetMemoryUsage(easDataHandle, &after), EAS_SUCCESS)
+                << "Failed to get the memory usage";
+        ASSERT_EQ(after.total, before.total) << "Disabling the tone cache leaked memory";
+    }
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, ProbeFileTest) {
+    // the probe must report the same play length as a full instance, from
+    // several threads at once
+    vector<uint8_t> contents(mLength);
+    ASSERT_EQ(readAt(contents.data(), 0, mLength), mLength) << "Failed to read file";
+
+    constexpr int kNumThreads = 4;
+    EAS_RESULT results[kNumThreads];
+    EAS_I32 playTimes[kNumThreads];
+    EAS_I32 fileTypes[kNumThreads];
+    vector<std::thread> threads;
+    for (int i = 0; i < kNumThreads; i++) {
+        threads.emplace_back([&, i]() {
+            EAS_FILE memLocator;
+            EAS_MEMORY_FILE memFile;
+            EAS_InitMemoryLocator(&memLocator, &memFile, contents.data(), contents.size());
+            results[i] = EAS_ProbeFile(&memLocator, nullptr, nullptr, 0, nullptr, &fileTypes[i],
+                                       &playTimes[i]);
+        });
+    }
+    for (std::thread &thread : threads) thread.join();
+    if (results[0] == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "File probe not supported";
+    }
+    for (int i = 0; i < kNumThreads; i++) {
+        ASSERT_EQ(results[i], EAS_SUCCESS) << "Failed to probe the file";
+        ASSERT_EQ(playTimes[i], mAudioplayTimeMs) << "Probed play length is wrong";
+        ASSERT_NE(fileTypes[i], EAS_FILE_UNKNOWN) << "Probed file type is unknown";
+    }
+
+    // metadata is reported through the callback
+    const char tune[] = "Test:d=4,o=5,b=120:c,e,g";
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, tune, strlen(tune));
+    auto onMetaData = [](E_EAS_METADATA_TYPE type, char *buffer, EAS_VOID_PTR pUserData) {
+        if (type == EAS_METADATA_TITLE) *static_cast<string *>(pUserData) = buffer;
+    };
+    string title;
+    char buffer[64];
+    EAS_I32 fileType;
+    EAS_I32 playTimeMs;
+    ASSERT_EQ(EAS_ProbeFile(&memLocator, onMetaData, buffer, sizeof(buffer), &title, &fileType,
+                            &playTimeMs),
+              EAS_SUCCESS)
+            << "Failed to probe the ringtone";
+    ASSERT_EQ(fileType, EAS_FILE_RTTTL) << "Wrong file type for the ringtone";
+    ASSERT_EQ(title, "Test") << "Wrong title for the ringtone";
+    ASSERT_GT(playTimeMs, 0) << "No play length for the ringtone";
+}
+
+TEST_P(SonivoxTest, MIDIStreamTest) {
+    // feed a raw MIDI stream from another thread while rendering, notes
+    // must not play before they are due
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE midiStreamHandle = nullptr;
+    EAS_RESULT result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+
+    result = EAS_OpenMIDIStream(easDataHandle, &midiStreamHandle, nullptr);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open MIDI stream";
+
+    // the sample clock is also there for JET, so ask the ring itself
+    if (EAS_WriteMIDIStreamAt(easDataHandle, midiStreamHandle, nullptr, 0, 0) ==
+        EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        EAS_CloseMIDIStream(easDataHandle, midiStreamHandle);
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "MIDI input ring not supported";
+    }
+    EAS_U32 startTime;
+    result = EAS_GetSampleTime(easDataHandle, &startTime);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the sample time";
+
+    constexpr EAS_I32 kDueFrame = 8;
+    std::thread producer([&]() {
+        EAS_U8 noteOn[] = {0x90, 60, 100};
+        for (EAS_I32 i = 0; i < 4; i++) {
+            noteOn[1] = 60 + i;
+            EAS_RESULT writeResult = EAS_WriteMIDIStreamAt(
+                    easDataHandle, midiStreamHandle, noteOn, sizeof(noteOn),
+                    startTime + (kDueFrame + i) * mEASConfig->mixBufferSize);
+            EXPECT_EQ(writeResult, EAS_SUCCESS) << "Failed to write MIDI stream";
+        }
+    });
+
+    vector<EAS_PCM> output(mEASConfig->mixBufferSize * 16 * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, output));
+    producer.join();
+    vector<EAS_PCM> tail(output.size());
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, tail));
+
+    auto dueOffset =
+            output.begin() + kDueFrame * mEASConfig->mixBufferSize * mEASConfig->numChannels;
+    ASSERT_TRUE(std::all_of(output.begin(), dueOffset, [](EAS_PCM sample) { return sample == 0; }))
+            << "Note played before it was due";
+    ASSERT_FALSE(std::all_of(tail.begin(), tail.end(), [](EAS_PCM sample) { return sample == 0; }))
+            << "Note did not play";
+
+    // writes that don't fit in the ring are rejected whole
+    EAS_U8 controller[] = {0xb0, 7, 100};
+    EAS_I32 numWrites = 0;
+    do {
+        result = EAS_WriteMIDIStreamAt(easDataHandle, midiStreamHandle, controller,
+                                       sizeof(controller), startTime + 0x10000000);
+    } while (result == EAS_SUCCESS && ++numWrites < 100000);
+    ASSERT_EQ(result, EAS_ERROR_QUEUE_IS_FULL) << "MIDI input ring did not fill up";
+
+    result = EAS_CloseMIDIStream(easDataHandle, midiStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to close MIDI stream";
+    result = EAS_Shutdown(easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, SampleAccurateMIDITest) {
+    // a note due part way through a frame must not sound before its sample
+    constexpr EAS_I32 kDueFrame = 4;
+    const EAS_I32 frameSamples = mEASConfig->mixBufferSize;
+    auto firstSound = [&](EAS_I32 dueOffset, size_t *pFirst) {
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        EAS_HANDLE midiStreamHandle = nullptr;
+        EAS_RESULT result = EAS_Init(&easDataHandle);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+        result = EAS_OpenMIDIStream(easDataHandle, &midiStreamHandle, nullptr);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open MIDI stream";
+
+        EAS_U32 startTime;
+        EAS_U8 noteOn[] = {0x90, 60, 127};
+        result = EAS_GetSampleTime(easDataHandle, &startTime);
+        if (result == EAS_SUCCESS) {
+            result = EAS_WriteMIDIStreamAt(easDataHandle, midiStreamHandle, noteOn, sizeof(noteOn),
+                                           startTime + kDueFrame * frameSamples + dueOffset);
+        }
+        if (result == EAS_SUCCESS) {
+            vector<EAS_PCM> output(frameSamples * (kDueFrame + 2) * mEASConfig->numChannels);
+            ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, output));
+            auto it = std::find_if(output.begin(), output.end(),
+                                   [](EAS_PCM sample) { return sample != 0; });
+            ASSERT_NE(it, output.end()) << "Note did not play";
+            *pFirst = (it - output.begin()) / mEASConfig->numChannels;
+        }
+
+        EAS_CloseMIDIStream(easDataHandle, midiStreamHandle);
+        EAS_Shutdown(easDataHandle);
+        if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) GTEST_SKIP() << "MIDI input ring not supported";
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to write MIDI stream";
+    };
+
+    size_t onFrame = 0;
+    size_t inFrame = 0;
+    ASSERT_NO_FATAL_FAILURE(firstSound(0, &onFrame));
+    if (IsSkipped()) return;
+    ASSERT_NO_FATAL_FAILURE(firstSound(frameSamples / 2, &inFrame));
+    if (inFrame == onFrame) GTEST_SKIP() << "Sample accurate events not supported";
+    ASSERT_GE(onFrame, (size_t)(kDueFrame * frameSamples)) << "Note played before its frame";
+    ASSERT_GE(inFrame, (size_t)(kDueFrame * frameSamples + frameSamples / 2))
+            << "Note played before its sample";
+    ASSERT_LT(inFrame, (size_t)((kDueFrame + 1) * frameSamples)) << "Note played late";
+}
+
+TEST_P(SonivoxTest, ReleaseTailTest) {
+    // a released note must end in digital silence once its tail decays
+    // below audibility rather than ramping down for seconds
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE midiStreamHandle = nullptr;
+    EAS_RESULT result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    result = EAS_OpenMIDIStream(easDataHandle, &midiStreamHandle, nullptr);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open MIDI stream";
+
+    EAS_U8 notes[] = {0x90, 60, 127, 0x80, 60, 0};
+    result = EAS_WriteMIDIStream(easDataHandle, midiStreamHandle, notes, sizeof(notes));
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to write MIDI stream";
+
+    const EAS_I32 frameSize = mEASConfig->mixBufferSize * mEASConfig->numChannels;
+    vector<EAS_PCM> output(frameSize * 1024);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, output));
+    auto last = std::find_if(output.rbegin(), output.rend(),
+                             [](EAS_PCM sample) { return sample != 0; });
+    ASSERT_NE(last, output.rend()) << "Note did not play";
+    size_t lastFrame = (output.rend() - last) / frameSize;
+    ASSERT_LT(lastFrame, output.size() / frameSize / 2) << "Release tail did not end";
+
+    EAS_CloseMIDIStream(easDataHandle, midiStreamHandle);
+    result = EAS_Shutdown(easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, ReverbTailTest) {
+    // once the reverb tail has died away the output must be digital silence
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE midiStreamHandle = nullptr;
+    EAS_RESULT result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    result = EAS_SetParameter(easDataHandle, EAS_MODULE_REVERB, EAS_PARAM_REVERB_PRESET,
+                              EAS_PARAM_REVERB_LARGE_HALL);
+    if (result == EAS_SUCCESS) {
+        result = EAS_SetParameter(easDataHandle, EAS_MODULE_REVERB, EAS_PARAM_REVERB_BYPASS,
+                                  EAS_FALSE);
+    }
+    if (result != EAS_SUCCESS) {
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "Reverb not supported";
+    }
+    result = EAS_OpenMIDIStream(easDataHandle, &midiStreamHandle, nullptr);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open MIDI stream";
+
+    EAS_U8 notes[] = {0x90, 60, 127, 0x90, 64, 127, 0x90, 67, 127};
+    result = EAS_WriteMIDIStream(easDataHandle, midiStreamHandle, notes, sizeof(notes));
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to write MIDI stream";
+
+    const EAS_I32 frameSize = mEASConfig->mixBufferSize * mEASConfig->numChannels;
+    vector<EAS_PCM> output(frameSize * 64);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, output));
+    EAS_U8 notesOff[] = {0xb0, 123, 0};
+    result = EAS_WriteMIDIStream(easDataHandle, midiStreamHandle, notesOff, sizeof(notesOff));
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to write MIDI stream";
+
+    output.resize(frameSize * 2048);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, output));
+    auto last = std::find_if(output.rbegin(), output.rend(),
+                             [](EAS_PCM sample) { return sample != 0; });
+    ASSERT_NE(last, output.rend()) << "Reverb tail did not play";
+
+    EAS_CloseMIDIStream(easDataHandle, midiStreamHandle);
+    EAS_Shutdown(easDataHandle);
+    size_t lastFrame = (output.rend() - last) / frameSize;
+    if (lastFrame == output.size() / frameSize) GTEST_SKIP() << "Reverb tail bypass not supported";
+    ASSERT_LT(lastFrame, output.size() / frameSize / 2) << "Reverb tail did not end";
+}
+
+TEST_P(SonivoxTest, ChorusSendTest) {
+    // the chorus must leave the output untouched until a channel sends to it
+    const EAS_I32 frameSize = mEASConfig->mixBufferSize * mEASConfig->numChannels;
+    auto render = [&](EAS_U8 send, EAS_BOOL bypass, vector<EAS_PCM> &output) {
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        EAS_HANDLE midiStreamHandle = nullptr;
+        EAS_RESULT result = EAS_Init(&easDataHandle);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+        result = EAS_SetParameter(easDataHandle, EAS_MODULE_CHORUS, EAS_PARAM_CHORUS_BYPASS,
+                                  bypass);
+        if (result != EAS_SUCCESS) {
+            EAS_Shutdown(easDataHandle);
+            GTEST_SKIP() << "Chorus not supported";
+        }
+        result = EAS_OpenMIDIStream(easDataHandle, &midiStreamHandle, nullptr);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open MIDI stream";
+        EAS_U8 notes[] = {0xb0, 93, send, 0x90, 60, 127, 0x90, 64, 127};
+        result = EAS_WriteMIDIStream(easDataHandle, midiStreamHandle, notes, sizeof(notes));
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to write MIDI stream";
+        output.assign(frameSize * 64, 0);
+        ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, output));
+        EAS_CloseMIDIStream(easDataHandle, midiStreamHandle);
+        result = EAS_Shutdown(easDataHandle);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to deallocate the resources for synthesizer library";
+    };
+
+    vector<EAS_PCM> dry, noSend, bypassed, chorus;
+    ASSERT_NO_FATAL_FAILURE(render(0, EAS_TRUE, dry));
+    if (IsSkipped()) return;
+    ASSERT_NO_FATAL_FAILURE(render(0, EAS_FALSE, noSend));
+    ASSERT_NO_FATAL_FAILURE(render(100, EAS_TRUE, bypassed));
+    ASSERT_NO_FATAL_FAILURE(render(100, EAS_FALSE, chorus));
+    ASSERT_EQ(noSend, dry) << "Chorus changed the output without a send";
+    ASSERT_EQ(bypassed, dry) << "Bypassed chorus changed the output";
+    ASSERT_NE(chorus, dry) << "Chorus send had no effect";
+}
+
+TEST_P(SonivoxTest, InsertEffectTest) {
+    // an insert that halves the mix must change the output, and must not run
+    // while bypassed; the user data counts the calls
+    static const S_EFFECTS32_INTERFACE halve = {
+            nullptr,
+            [](EAS_VOID_PTR pInstData, EAS_I32 *in, EAS_I32 *out, EAS_I32 numSamples) {
+                for (EAS_I32 i = 0; i < numSamples * 2; i++) out[i] = in[i] >> 1;
+                (*static_cast<EAS_I32 *>(pInstData))++;
+            },
+            nullptr, nullptr, nullptr};
+    const EAS_I32 frameSize = mEASConfig->mixBufferSize * mEASConfig->numChannels;
+    auto render = [&](bool onStream, bool bypass, EAS_I32 *pCalls, vector<EAS_PCM> &output) {
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        EAS_HANDLE midiStreamHandle = nullptr;
+        EAS_I32 index;
+        EAS_RESULT result = EAS_Init(&easDataHandle);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+        result = EAS_OpenMIDIStream(easDataHandle, &midiStreamHandle, nullptr);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open MIDI stream";
+        if (pCalls != nullptr) {
+            result = EAS_AddInsert(easDataHandle, onStream ? midiStreamHandle : nullptr, &halve,
+                                   pCalls, &index);
+            if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+                EAS_CloseMIDIStream(easDataHandle, midiStreamHandle);
+                EAS_Shutdown(easDataHandle);
+                GTEST_SKIP() << "Insert effects not supported";
+            }
+            ASSERT_EQ(result, EAS_SUCCESS) << "Failed to add insert";
+            result = EAS_SetInsertBypass(easDataHandle, onStream ? midiStreamHandle : nullptr,
+                                         index, bypass);
+            ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set insert bypass";
+        }
+        EAS_U8 notes[] = {0x90, 60, 127, 0x90, 64, 127};
+        result = EAS_WriteMIDIStream(easDataHandle, midiStreamHandle, notes, sizeof(notes));
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to write MIDI stream";
+        output.assign(frameSize * 16, 0);
+        ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, output));
+        EAS_CloseMIDIStream(easDataHandle, midiStreamHandle);
+        result = EAS_Shutdown(easDataHandle);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to deallocate the resources for synthesizer library";
+    };
+
+    vector<EAS_PCM> dry, master, masterBypassed, stream, streamBypassed;
+    EAS_I32 masterCalls = 0, masterBypassedCalls = 0, streamCalls = 0, streamBypassedCalls = 0;
+    ASSERT_NO_FATAL_FAILURE(render(false, false, nullptr, dry));
+    ASSERT_NO_FATAL_FAILURE(render(false, false, &masterCalls, master));
+    if (IsSkipped()) return;
+    ASSERT_NO_FATAL_FAILURE(render(false, true, &masterBypassedCalls, masterBypassed));
+    ASSERT_NO_FATAL_FAILURE(render(true, false, &streamCalls, stream));
+    ASSERT_NO_FATAL_FAILURE(render(true, true, &streamBypassedCalls, streamBypassed));
+    ASSERT_GT(masterCalls, 0) << "Master insert was not called";
+    ASSERT_GT(streamCalls, 0) << "Stream insert was not called";
+    ASSERT_EQ(masterBypassedCalls, 0) << "Bypassed master insert was called";
+    ASSERT_EQ(streamBypassedCalls, 0) << "Bypassed stream insert was called";
+    ASSERT_NE(master, dry) << "Master insert had no effect";
+    ASSERT_NE(stream, dry) << "Stream insert had no effect";
+    ASSERT_EQ(masterBypassed, dry) << "Bypassed master insert changed the output";
+    ASSERT_EQ(streamBypassed, dry) << "Bypassed stream insert changed the output";
+}
+
+TEST_P(SonivoxTest, BatchRenderTest) {
+    // instances advanced together on a batch renderer must each match EAS_Render
+    const EAS_I32 numInstances = 5;
+    EAS_I32 frameSize = mEASConfig->mixBufferSize * mEASConfig->numChannels;
+    EAS_BATCH_HANDLE batch = nullptr;
+    EAS_RESULT result = EAS_CreateBatch(3, &batch);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) GTEST_SKIP() << "Batch render not supported";
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to create batch renderer";
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    vector<EAS_PCM> expected(frameSize * 32);
+    result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    result = EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open file";
+    result = EAS_Prepare(easDataHandle, easStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to prepare EAS data and stream handles";
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, expected));
+    ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+
+    EAS_DATA_HANDLE instances[numInstances];
+    EAS_HANDLE streams[numInstances];
+    vector<EAS_PCM> outputs[numInstances];
+    for (EAS_I32 i = 0; i < numInstances; i++) {
+        result = EAS_Init(&instances[i]);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+        result = EAS_OpenFile(instances[i], &mEasFile, &streams[i]);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open file";
+        result = EAS_Prepare(instances[i], streams[i]);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to prepare EAS data and stream handles";
+        outputs[i].resize(expected.size());
+    }
+
+    // four frames per batch
+    for (size_t offset = 0; offset < expected.size(); offset += frameSize * 4) {
+        S_EAS_BATCH_ITEM items[numInstances];
+        for (EAS_I32 i = 0; i < numInstances; i++) {
+            items[i] = {instances[i], &outputs[i][offset], mEASConfig->mixBufferSize * 4, 0,
+                        EAS_ERROR_NOT_IMPLEMENTED};
+        }
+        result = EAS_RenderBatch(batch, items, numInstances);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the batch";
+        for (EAS_I32 i = 0; i < numInstances; i++) {
+            ASSERT_EQ(items[i].numGenerated, mEASConfig->mixBufferSize * 4) << "Short render";
+        }
+    }
+    for (EAS_I32 i = 0; i < numInstances; i++) {
+        ASSERT_EQ(outputs[i], expected) << "Batch render of instance " << i
+                                        << " does not match EAS_Render";
+        ASSERT_NO_FATAL_FAILURE(closeInstance(instances[i], streams[i]));
+    }
+    ASSERT_EQ(EAS_DestroyBatch(batch), EAS_SUCCESS);
+}
+
+TEST_P(SonivoxTest, RenderAheadTest) {
+    // audio read from the render-ahead ring must match EAS_Render
+    EAS_I32 numChannels = mEASConfig->numChannels;
+    EAS_I32 frameSize = mEASConfig->mixBufferSize * numChannels;
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    EAS_RESULT result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    result = EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open file";
+    result = EAS_Prepare(easDataHandle, easStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to prepare EAS data and stream handles";
+    vector<EAS_PCM> expected(frameSize * 64);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, expected));
+    ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+
+    result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    result = EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open file";
+    result = EAS_Prepare(easDataHandle, easStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to prepare EAS data and stream handles";
+    result = EAS_StartRenderAhead(easDataHandle, mEASConfig->mixBufferSize * 8);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+        GTEST_SKIP() << "Render ahead not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to start render ahead";
+    ASSERT_EQ(EAS_StartRenderAhead(easDataHandle, 0), EAS_ERROR_FEATURE_ALREADY_ACTIVE);
+
+    // read in pieces that are not whole frames, waiting when the ring runs dry
+    auto read = [&](vector<EAS_PCM> &output) {
+        EAS_I32 position = 0;
+        while (position * numChannels < (EAS_I32)output.size()) {
+            EAS_I32 count;
+            EAS_I32 request = std::min<EAS_I32>(77, output.size() / numChannels - position);
+            result = EAS_ReadRenderAhead(easDataHandle, &output[position * numChannels],
+                                         request, &count);
+            ASSERT_EQ(result, EAS_SUCCESS) << "Failed to read the ring";
+            position += count;
+            if (count < request) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+    vector<EAS_PCM> actual(expected.size());
+    ASSERT_NO_FATAL_FAILURE(read(actual));
+    ASSERT_EQ(expected, actual) << "Render ahead does not match EAS_Render";
+
+    // a command for the current position is applied once the ring has room
+    S_EAS_RENDER_AHEAD_STATUS status;
+    ASSERT_EQ(EAS_GetRenderAheadStatus(easDataHandle, &status), EAS_SUCCESS);
+    ASSERT_EQ(status.position, (EAS_U32)(actual.size() / numChannels)) << "Wrong read position";
+    S_EAS_RENDER_COMMAND command = {EAS_RENDER_CMD_PAUSE, easStreamHandle, status.position, {}};
+    ASSERT_EQ(EAS_PostRenderCommand(easDataHandle, &command), EAS_SUCCESS);
+    actual.assign(frameSize * 16, 0);
+    ASSERT_NO_FATAL_FAILURE(read(actual));
+    ASSERT_EQ(EAS_GetRenderAheadStatus(easDataHandle, &status), EAS_SUCCESS);
+    ASSERT_EQ(status.commandResult, EAS_SUCCESS) << "Pause command failed";
+    ASSERT_EQ(EAS_StopRenderAhead(easDataHandle), EAS_SUCCESS);
+    ASSERT_EQ(EAS_GetRenderAheadStatus(easDataHandle, &status), EAS_ERROR_NOT_VALID_IN_THIS_STATE);
+    EAS_STATE state;
+    ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS);
+    ASSERT_TRUE(state == EAS_STATE_PAUSING || state == EAS_STATE_PAUSED) << "Pause was not applied";
+    ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+}
+
+TEST_P(SonivoxTest, DecodeOfflineTest) {
+    // render the whole file with EAS_Render, then with the offline render
+    // functions, each on a fresh instance; the output must match
+    EAS_I32 numChannels = mEASConfig->numChannels;
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    EAS_RESULT result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    result = EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open file";
+    result = EAS_Prepare(easDataHandle, easStreamHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to prepare EAS data and stream handles";
+
+    vector<EAS_PCM> expected;
+    EAS_STATE state;
+    EAS_I32 count;
+    while (1) {
+        result = EAS_State(easDataHandle, easStreamHandle, &state);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get EAS State";
+        if (state == EAS_STATE_STOPPED) break;
+
+        size_t offset = expected.size();
+        expected.resize(offset + mEASConfig->mixBufferSize * numChannels);
+        result = EAS_Render(easDataHandle, &expected[offset], mEASConfig->mixBufferSize, &count);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+        ASSERT_EQ(count, mEASConfig->mixBufferSize) << "Short render";
+    }
+    ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+
+    // render into a buffer with room to spare
+    S_EAS_RENDER_STATS stats;
+    vector<EAS_PCM> actual(expected.size() + mEASConfig->mixBufferSize * numChannels);
+    result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    result = EAS_RenderToBuffer(easDataHandle, &mEasFile, actual.data(),
+                                actual.size() / numChannels, &stats);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render file to buffer";
+    ASSERT_EQ((size_t)(stats.numSamples * numChannels), expected.size()) << "Wrong number of samples";
+    actual.resize(expected.size());
+    ASSERT_EQ(expected, actual) << "Buffer render does not match EAS_Render";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS);
+
+    // render into a buffer that is too small and ends part way through a frame
+    EAS_I32 shortSize = expected.size() / numChannels / 2 + 77;
+    actual.assign(shortSize * numChannels, 0);
+    result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    result = EAS_RenderToBuffer(easDataHandle, &mEasFile, actual.data(), shortSize, &stats);
+    ASSERT_EQ(result, EAS_BUFFER_FULL) << "Short buffer not reported";
+    ASSERT_EQ(stats.numSamples, shortSize) << "Short buffer not filled";
+    ASSERT_TRUE(equal(actual.begin(), actual.end(), expected.begin()))
+            << "Short buffer render does not match EAS_Render";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS);
+
+    // render through the write callback
+    vector<EAS_PCM> written;
+    result = EAS_Init(&easDataHandle);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    result = EAS_RenderFile(easDataHandle, &mEasFile, writePCM, &written, &stats);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render file";
+    ASSERT_EQ(expected, written) << "Callback render does not match EAS_Render";
+    ALOGV("Rendered %ld samples in %lu us, %ld samples/sec", stats.numSamples, stats.elapsedTime,
+          stats.samplesPerSec);
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS);
+}
+
+TEST_P(SonivoxTest, PCMCacheTest) {
+    // play the file over and over on one instance; the plays from the PCM
+    // cache must match the file played on a fresh instance, which the
+    // synthesizer rendered, and follow the master volume
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    EAS_RESULT result = EAS_SetPCMCacheSize(easDataHandle, 16 << 20);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "PCM cache not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to enable the PCM cache";
+
+    auto play = [&](EAS_DATA_HANDLE easDataHandle, vector<EAS_PCM> &output) {
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open file";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to prepare EAS data and stream handles";
+        output.clear();
+        EAS_STATE state;
+        EAS_I32 count;
+        while (1) {
+            ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS)
+                    << "Failed to get EAS State";
+            if (state == EAS_STATE_STOPPED) break;
+            size_t offset = output.size();
+            output.resize(offset + mEASConfig->mixBufferSize * mEASConfig->numChannels);
+            ASSERT_EQ(EAS_Render(easDataHandle, &output[offset], mEASConfig->mixBufferSize, &count),
+                      EAS_SUCCESS)
+                    << "Failed to render the audio data";
+        }
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+    };
+
+    // the synthesizer leaves state behind from one play to the next, so the
+    // reference plays are rendered on fresh instances; a negative volume
+    // keeps the default
+    auto reference = [&](EAS_I32 volume, vector<EAS_PCM> &output) {
+        EAS_DATA_HANDLE referenceHandle = nullptr;
+        ASSERT_EQ(EAS_Init(&referenceHandle), EAS_SUCCESS)
+                << "Failed to initialize synthesizer library";
+        if (volume >= 0) {
+            ASSERT_EQ(EAS_SetVolume(referenceHandle, nullptr, volume), EAS_SUCCESS)
+                    << "Failed to set volume";
+        }
+        ASSERT_NO_FATAL_FAILURE(play(referenceHandle, output));
+        ASSERT_EQ(EAS_Shutdown(referenceHandle), EAS_SUCCESS)
+                << "Failed to deallocate the resources for synthesizer library";
+    };
+
+    vector<EAS_PCM> expected;
+    vector<EAS_PCM> actual;
+    EAS_I32 cacheSize = 0;
+    if (mLength > EAS_PCM_CACHE_MAX_FILE_SIZE) {
+        // a file over the limit is rendered by the synthesizer and not kept
+        ASSERT_NO_FATAL_FAILURE(reference(-1, expected));
+        ASSERT_NO_FATAL_FAILURE(play(easDataHandle, actual));
+        ASSERT_EQ(expected, actual) << "Play of a file too large to cache does not match";
+        ASSERT_EQ(EAS_GetPCMCacheUsage(easDataHandle, &cacheSize), EAS_SUCCESS)
+                << "Failed to get the PCM cache usage";
+        ASSERT_EQ(cacheSize, 0) << "File larger than EAS_PCM_CACHE_MAX_FILE_SIZE was cached";
+        ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+                << "Failed to deallocate the resources for synthesizer library";
+        return;
+    }
+
+    ASSERT_NO_FATAL_FAILURE(reference(-1, expected));
+    for (int i = 0; i < 2; i++) {
+        ASSERT_NO_FATAL_FAILURE(play(easDataHandle, actual));
+        ASSERT_EQ(expected, actual) << "Cached play does not match the synthesizer";
+        ASSERT_EQ(EAS_GetPCMCacheUsage(easDataHandle, &cacheSize), EAS_SUCCESS)
+                << "Failed to get the PCM cache usage";
+        ASSERT_GT(cacheSize, 0) << "File was not cached";
+    }
+
+    ASSERT_EQ(EAS_SetVolume(easDataHandle, nullptr, 50), EAS_SUCCESS) << "Failed to set volume";
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, actual));
+    ASSERT_NO_FATAL_FAILURE(reference(50, expected));
+    ASSERT_EQ(expected, actual) << "Cached play does not follow the master volume";
+
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+
+    // a file precached on a fresh instance plays from the cache the first time
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    ASSERT_EQ(EAS_PrecacheFile(easDataHandle, &mEasFile), EAS_ERROR_NOT_VALID_IN_THIS_STATE)
+            << "Precached with the cache disabled";
+    ASSERT_EQ(EAS_SetPCMCacheSize(easDataHandle, 16 << 20), EAS_SUCCESS)
+            << "Failed to enable the PCM cache";
+    ASSERT_EQ(EAS_PrecacheFile(easDataHandle, &mEasFile), EAS_SUCCESS) << "Failed to precache";
+    ASSERT_EQ(EAS_SetVolume(easDataHandle, nullptr, 50), EAS_SUCCESS) << "Failed to set volume";
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, actual));
+    ASSERT_EQ(expected, actual) << "Precached play does not match the synthesizer";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, DoubleRateTest) {
+    // render the file at the compiled rate and at twice the rate; the double
+    // rate output must be twice as long at about the same level
+    S_EAS_INIT_CONFIG initConfig = {mEASConfig->sampleRate * 3};
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_RESULT result = EAS_InitEx(&easDataHandle, &initConfig);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Runtime sample rate is not available";
+    }
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Unsupported rate accepted";
+
+    vector<EAS_PCM> output[2];
+    for (int rateShift = 0; rateShift < 2; rateShift++) {
+        initConfig.sampleRate = mEASConfig->sampleRate << rateShift;
+        result = EAS_InitEx(&easDataHandle, &initConfig);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+
+        S_EAS_LIB_CONFIG config;
+        result = EAS_GetInstanceConfig(easDataHandle, &config);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get instance config";
+        ASSERT_EQ(config.sampleRate, initConfig.sampleRate) << "Wrong instance sample rate";
+        ASSERT_EQ(config.mixBufferSize, mEASConfig->mixBufferSize << rateShift)
+                << "Wrong instance buffer size";
+
+        EAS_HANDLE easStreamHandle = nullptr;
+        result = EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open file";
+        result = EAS_Prepare(easDataHandle, easStreamHandle);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to prepare EAS data and stream handles";
+
+        EAS_STATE state;
+        EAS_I32 count;
+        while (1) {
+            result = EAS_State(easDataHandle, easStreamHandle, &state);
+            ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get EAS State";
+            if (state == EAS_STATE_STOPPED) break;
+
+            size_t offset = output[rateShift].size();
+            output[rateShift].resize(offset + config.mixBufferSize * config.numChannels);
+            result = EAS_Render(easDataHandle, &output[rateShift][offset], config.mixBufferSize,
+                                &count);
+            ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+            ASSERT_EQ(count, config.mixBufferSize) << "Short render";
+        }
+        ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+    }
+    ASSERT_EQ(output[1].size(), output[0].size() * 2) << "Wrong double rate length";
+
+    double energy[2] = {0, 0};
+    for (int rateShift = 0; rateShift < 2; rateShift++) {
+        for (EAS_PCM sample : output[rateShift]) energy[rateShift] += (double)sample * sample;
+        energy[rateShift] /= output[rateShift].size();
+    }
+    ASSERT_GT(energy[0], 0) << "Silent output";
+    ASSERT_NEAR(energy[1] / energy[0], 1.0, 0.2) << "Double rate level differs";
+}
+
+TEST_P(SonivoxTest, ResampledOutputTest) {
+    // render the file at the compiled rate and resampled to 48 kHz at each
+    // quality; the resampled output must scale in length and keep its level
+    const EAS_I32 kDeviceRate = 48000;
+    vector<EAS_PCM> output[EAS_RESAMPLER_QUALITY_HIGH + 2];
+    for (int i = 0; i <= EAS_RESAMPLER_QUALITY_HIGH + 1; i++) {
+        S_EAS_INIT_CONFIG initConfig = {mEASConfig->sampleRate, EAS_RESAMPLER_QUALITY_DEFAULT};
+        if (i > 0) {
+            initConfig.sampleRate = kDeviceRate;
+            initConfig.resamplerQuality = i - 1;
+        }
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        EAS_RESULT result = EAS_InitEx(&easDataHandle, &initConfig);
+        if (i > 0 && (result == EAS_ERROR_FEATURE_NOT_AVAILABLE ||
+                      result == EAS_ERROR_PARAMETER_RANGE)) {
+            GTEST_SKIP() << "Output resampler is not available";
+        }
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+
+        S_EAS_LIB_CONFIG config;
+        result = EAS_GetInstanceConfig(easDataHandle, &config);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get instance config";
+        ASSERT_EQ(config.sampleRate, initConfig.sampleRate) << "Wrong instance sample rate";
+
+        EAS_HANDLE easStreamHandle = nullptr;
+        result = EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open file";
+        result = EAS_Prepare(easDataHandle, easStreamHandle);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to prepare EAS data and stream handles";
+
+        EAS_STATE state;
+        EAS_I32 count;
+        while (1) {
+            result = EAS_State(easDataHandle, easStreamHandle, &state);
+            ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get EAS State";
+            if (state == EAS_STATE_STOPPED) break;
+
+            size_t offset = output[i].size();
+            output[i].resize(offset + config.mixBufferSize * config.numChannels);
+            result = EAS_Render(easDataHandle, &output[i][offset], config.mixBufferSize, &count);
+            ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+            ASSERT_EQ(count, config.mixBufferSize) << "Short render";
+        }
+        ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+    }
+
+    double energy[EAS_RESAMPLER_QUALITY_HIGH + 2];
+    for (int i = 0; i <= EAS_RESAMPLER_QUALITY_HIGH + 1; i++) {
+        energy[i] = 0;
+        for (EAS_PCM sample : output[i]) energy[i] += (double)sample * sample;
+        energy[i] /= output[i].size();
+    }
+    ASSERT_GT(energy[0], 0) << "Silent output";
+    for (int i = 1; i <= EAS_RESAMPLER_QUALITY_HIGH + 1; i++) {
+        double ratio = (double)output[i].size() / output[0].size();
+        ASSERT_NEAR(ratio * mEASConfig->sampleRate / kDeviceRate, 1.0, 0.01)
+                << "Wrong resampled length at quality " << i - 1;
+        ASSERT_NEAR(energy[i] / energy[0], 1.0, 0.2) << "Resampled level differs at quality " << i - 1;
+    }
+}
+
+TEST_P(SonivoxTest, HighResOutputTest) {
+    // render the same stream in each wide format with buffers that are not a
+    // multiple of the mix buffer size; the output must round down to the
+    // 16-bit render and carry extra bits below it
+    EAS_I32 numChannels = mEASConfig->numChannels;
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 16;
+    vector<EAS_PCM> expected(totalSamples * numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+
+    static constexpr EAS_I32 kFormats[] = {EAS_PCM_FORMAT_FLOAT, EAS_PCM_FORMAT_24_PACKED,
+                                           EAS_PCM_FORMAT_32};
+    static constexpr size_t kSampleSizes[] = {sizeof(float), 3, sizeof(int32_t)};
+    static constexpr EAS_I32 kRequestSizes[] = {1, 77, 960, 1024, 300};
+    for (size_t f = 0; f < sizeof(kFormats) / sizeof(kFormats[0]); f++) {
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+
+        vector<uint8_t> output(totalSamples * numChannels * kSampleSizes[f]);
+        uint32_t request = 0;
+        EAS_I32 count;
+        for (EAS_I32 offset = 0; offset < totalSamples; offset += count) {
+            EAS_I32 numRequested = min(kRequestSizes[request++ % (sizeof(kRequestSizes) / sizeof(kRequestSizes[0]))],
+                                       totalSamples - offset);
+            EAS_RESULT result = EAS_RenderFormat(easDataHandle,
+                                                 &output[offset * numChannels * kSampleSizes[f]],
+                                                 kFormats[f], numRequested, &count);
+            if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+                closeInstance(easDataHandle, easStreamHandle);
+                GTEST_SKIP() << "High resolution output not supported";
+            }
+            ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+            ASSERT_EQ(count, numRequested) << "Short render";
+        }
+        closeInstance(easDataHandle, easStreamHandle);
+
+        bool fractionFound = false;
+        for (size_t i = 0; i < expected.size(); i++) {
+            const uint8_t *sample = &output[i * kSampleSizes[f]];
+            double wide;
+            if (kFormats[f] == EAS_PCM_FORMAT_FLOAT) {
+                float value;
+                memcpy(&value, sample, sizeof(value));
+                wide = value * 32768.0;
+            } else if (kFormats[f] == EAS_PCM_FORMAT_24_PACKED) {
+                int32_t value = (int32_t)((uint32_t)sample[0] << 8 | (uint32_t)sample[1] << 16 |
+                                          (uint32_t)sample[2] << 24);
+                wide = value / 65536.0;
+            } else {
+                int32_t value;
+                memcpy(&value, sample, sizeof(value));
+                wide = value / 65536.0;
+            }
+            ASSERT_EQ(floor(wide), expected[i])
+                    << "Format " << kFormats[f] << " differs from 16-bit render at " << i;
+            if (wide != expected[i]) fractionFound = true;
+        }
+        ASSERT_TRUE(fractionFound) << "Format " << kFormats[f] << " has no extra precision";
+    }
+}
+
+TEST_P(SonivoxTest, StemOutputTest) {
+    // split the stream into even and odd channel stems; the output must match
+    // a normal render and, with no effects, the clipped sum of the stems too
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+
+    EAS_RESULT result = EAS_SetStemCount(easDataHandle, 2);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        closeInstance(easDataHandle, easStreamHandle);
+        GTEST_SKIP() << "Stem output not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to set the stem count";
+    ASSERT_EQ(EAS_SetStemCount(easDataHandle, EAS_MAX_STEMS + 1), EAS_ERROR_PARAMETER_RANGE)
+            << "Too many stems accepted";
+    ASSERT_EQ(EAS_SetStreamStem(easDataHandle, easStreamHandle, -1, 1), EAS_SUCCESS)
+            << "Failed to set the stream stem";
+    for (EAS_I32 channel = 0; channel < 16; channel += 2) {
+        ASSERT_EQ(EAS_SetStreamStem(easDataHandle, easStreamHandle, channel, 0), EAS_SUCCESS)
+                << "Failed to set the stem of channel " << channel;
+    }
+
+    EAS_I32 numChannels = mEASConfig->numChannels;
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> expected(totalSamples * numChannels);
+    vector<EAS_PCM> actual(totalSamples * numChannels);
+    vector<EAS_PCM> stems[2] = {vector<EAS_PCM>(totalSamples * numChannels),
+                                vector<EAS_PCM>(totalSamples * numChannels)};
+    EAS_PCM *stemBuffers[2] = {stems[0].data(), stems[1].data()};
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+
+    EAS_I32 count;
+    result = EAS_RenderStems(easDataHandle, actual.data(), stemBuffers, 1, &count);
+    ASSERT_EQ(result, EAS_BUFFER_SIZE_MISMATCH) << "Partial frame accepted";
+    result = EAS_RenderStems(easDataHandle, actual.data(), stemBuffers, totalSamples, &count);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the stems";
+    ASSERT_EQ(count, totalSamples) << "Short render";
+    closeInstance(easDataHandle, easStreamHandle);
+    ASSERT_EQ(expected, actual) << "Stem render output does not match normal render";
+
+    double energy[2] = {0, 0};
+    for (size_t i = 0; i < actual.size(); i++) {
+        // a stem that clipped on its own cannot sum to the output
+        bool clipped = false;
+        for (const vector<EAS_PCM> &stem : stems) {
+            if (stem[i] == 32767 || stem[i] == -32768) clipped = true;
+        }
+        int32_t sum = min(max(stems[0][i] + stems[1][i], -32768), 32767);
+        if (!clipped) {
+            ASSERT_NEAR(sum, actual[i], 2) << "Stems do not sum to the output at " << i;
+        }
+        energy[0] += (double)stems[0][i] * stems[0][i];
+        energy[1] += (double)stems[1][i] * stems[1][i];
+    }
+    ASSERT_GT(energy[0] + energy[1], 0) << "Silent stems";
+}
+
+TEST_P(SonivoxTest, SoundLibraryTest) {
+    // write the built-in library to a file image and play from it, loaded at
+    // init and switched in at run time; the output must match the built-in
+    EAS_I32 size;
+    EAS_RESULT result = EAS_WriteSoundLibrary(mEASDataHandle, nullptr, nullptr, 0, &size);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "External sound libraries not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to size the sound library";
+    vector<uint8_t> image(size);
+    ASSERT_EQ(EAS_WriteSoundLibrary(mEASDataHandle, nullptr, image.data(), size - 1, &size),
+              EAS_BUFFER_SIZE_MISMATCH)
+            << "Short buffer accepted";
+    result = EAS_WriteSoundLibrary(mEASDataHandle, nullptr, image.data(), size, &size);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to write the sound library";
+
+    // a truncated file must be rejected
+    EAS_FILE libLocator;
+    EAS_MEMORY_FILE libFile;
+    EAS_SNDLIB_HANDLE pLib = nullptr;
+    EAS_InitMemoryLocator(&libLocator, &libFile, image.data(), size - 64);
+    ASSERT_EQ(EAS_LoadSoundLibrary(mEASDataHandle, &libLocator, &pLib), EAS_ERROR_SOUND_LIBRARY)
+            << "Truncated sound library accepted";
+    EAS_InitMemoryLocator(&libLocator, &libFile, image.data(), size);
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    S_EAS_INIT_CONFIG initConfig = {0, 0, &libLocator};
+    ASSERT_EQ(EAS_InitEx(&easDataHandle, &initConfig), EAS_SUCCESS)
+            << "Failed to initialize with the sound library";
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open file";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS) << "Failed to prepare";
+    EAS_I32 playTimeMs;
+    ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+            << "Failed to parse meta data";
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+    closeInstance(easDataHandle, easStreamHandle);
+    ASSERT_EQ(expected, actual) << "Sound library loaded at init does not match the built-in";
+
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+    ASSERT_EQ(EAS_LoadSoundLibrary(easDataHandle, &libLocator, &pLib), EAS_SUCCESS)
+            << "Failed to load the sound library";
+    ASSERT_EQ(EAS_SetSoundLibrary(easDataHandle, easStreamHandle, pLib), EAS_SUCCESS)
+            << "Failed to switch the stream to the sound library";
+    ASSERT_EQ(EAS_UnloadSoundLibrary(easDataHandle, pLib), EAS_ERROR_NOT_VALID_IN_THIS_STATE)
+            << "Sound library in use was unloaded";
+    fill(actual.begin(), actual.end(), 0);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+    ASSERT_EQ(expected, actual) << "Sound library switched in does not match the built-in";
+    ASSERT_EQ(EAS_SetSoundLibrary(easDataHandle, easStreamHandle, nullptr), EAS_SUCCESS)
+            << "Failed to switch back to the built-in library";
+    ASSERT_EQ(EAS_UnloadSoundLibrary(easDataHandle, pLib), EAS_SUCCESS)
+            << "Failed to unload the sound library";
+    closeInstance(easDataHandle, easStreamHandle);
+}
+
+TEST_P(SonivoxTest, SharedSoundLibraryTest) {
+    // instances initialized with the same sound library file must share one
+    // copy of it, play like the built-in library and free it with the last one
+    EAS_I32 size;
+    EAS_RESULT result = EAS_WriteSoundLibrary(mEASDataHandle, nullptr, nullptr, 0, &size);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "External sound libraries not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to size the sound library";
+    vector<uint8_t> image(size);
+    ASSERT_EQ(EAS_WriteSoundLibrary(mEASDataHandle, nullptr, image.data(), size, &size), EAS_SUCCESS)
+            << "Failed to write the sound library";
+    S_EAS_MEMORY_USAGE before, first, second, after;
+    result = EAS_GetMemoryUsage(mEASDataHandle, &before);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Memory accounting not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the memory usage";
+
+    // read through callbacks, as a file that is not in memory
+    EAS_FILE libLocator;
+    libLocator.handle = &image;
+    libLocator.readAt = [](void *handle, void *buf, int offset, int size) -> int {
+        vector<uint8_t> *image = (vector<uint8_t> *)handle;
+        if (offset < 0 || offset > (int)image->size()) return 0;
+        size = min(size, (int)image->size() - offset);
+        memcpy(buf, image->data() + offset, size);
+        return size;
+    };
+    libLocator.size = [](void *handle) -> int { return ((vector<uint8_t> *)handle)->size(); };
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+
+    EAS_DATA_HANDLE easDataHandles[2] = {nullptr, nullptr};
+    S_EAS_INIT_CONFIG initConfig = {0, 0, &libLocator};
+    ASSERT_EQ(EAS_InitEx(&easDataHandles[0], &initConfig), EAS_SUCCESS)
+            << "Failed to initialize with the sound library";
+    ASSERT_EQ(EAS_GetMemoryUsage(mEASDataHandle, &first), EAS_SUCCESS)
+            << "Failed to get the memory usage";
+    if (first.sharedDLS < before.sharedDLS + size) {
+        EAS_Shutdown(easDataHandles[0]);
+        GTEST_SKIP() << "Sound library cache not supported";
+    }
+    ASSERT_EQ(EAS_InitEx(&easDataHandles[1], &initConfig), EAS_SUCCESS)
+            << "Failed to initialize with the sound library";
+    ASSERT_EQ(EAS_GetMemoryUsage(easDataHandles[1], &second), EAS_SUCCESS)
+            << "Failed to get the memory usage";
+    ASSERT_EQ(second.sharedDLS, first.sharedDLS) << "Second instance loaded its own copy";
+
+    for (EAS_DATA_HANDLE easDataHandle : easDataHandles) {
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open file";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS) << "Failed to prepare";
+        EAS_I32 playTimeMs;
+        ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+                << "Failed to parse meta data";
+        fill(actual.begin(), actual.end(), 0);
+        ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+        closeInstance(easDataHandle, easStreamHandle);
+        ASSERT_EQ(expected, actual) << "Shared sound library does not match the built-in";
+    }
+    ASSERT_EQ(EAS_GetMemoryUsage(mEASDataHandle, &after), EAS_SUCCESS)
+            << "Failed to get the memory usage";
+    ASSERT_EQ(after.sharedDLS, before.sharedDLS) << "Shared sound library was not freed";
+}
+
+TEST_P(SonivoxTest, DLSCollectionCollisionTest) {
+    // DLS collections that only collide on size and hashes must not share a
+    // conversion, identical ones must. The samples were chosen to give both
+    // collections the same FNV-1a hash and position weighted sum.
+    static const uint8_t kSamples[2][96] = {
+        {
+            0x4f, 0x05, 0x2c, 0xbb, 0xb4, 0x5b, 0xd2, 0x96, 0x45, 0x94, 0xe7, 0xfe,
+            0x30, 0x7e, 0x1c, 0x67, 0xaf, 0xc4, 0x11, 0x27, 0x09, 0x1d, 0xd0, 0x4e,
+            0xbd, 0xb7, 0xd2, 0x33, 0x61, 0xc8, 0x67, 0x9a, 0xf5, 0xf9, 0x52, 0x58,
+            0xda, 0xeb, 0x0b, 0xa9, 0x24, 0xe0, 0x68, 0xa0, 0x15, 0xaf, 0x8c, 0x57,
+            0xb3, 0xc1, 0x7a, 0xbc, 0xe3, 0xe5, 0x76, 0xa7, 0x92, 0x9c, 0x37, 0xee,
+            0x42, 0xf3, 0x00, 0xa4, 0xb7, 0xba, 0x73, 0xa2, 0xae, 0xab, 0x00, 0x59,
+            0xdd, 0x15, 0x10, 0x8f, 0x44, 0x67, 0xe4, 0xc8, 0xd5, 0x9d, 0xa6, 0x7e,
+            0x95, 0x5f, 0x45, 0x0d, 0x72, 0xc2, 0x65, 0x93, 0x5b, 0x65, 0x77, 0xbb,
+        },
+        {
+            0x4f, 0x05, 0x2c, 0xbb, 0xb4, 0x5b, 0xd2, 0x96, 0x45, 0x94, 0xe7, 0xfe,
+            0x30, 0x7e, 0x1c, 0x67, 0xaf, 0xc4, 0x11, 0x27, 0x09, 0x1d, 0xd0, 0x4e,
+            0xd9, 0x3e, 0xf2, 0x0a, 0x17, 0x97, 0x54, 0x66, 0xf5, 0xf9, 0x52, 0x58,
+            0xb4, 0xda, 0xd2, 0xb5, 0x1e, 0x3c, 0x5f, 0x8f, 0x63, 0xfe, 0x4d, 0xa3,
+            0xb3, 0xc1, 0x7a, 0xbc, 0x87, 0x6a, 0x5a, 0x9c, 0x58, 0x30, 0xb0, 0x01,
+            0x08, 0x23, 0x5f, 0x43, 0x9d, 0x53, 0x10, 0x40, 0xae, 0xab, 0x00, 0x59,
+            0xf1, 0xda, 0x74, 0x88, 0x44, 0x67, 0xe4, 0xc8, 0x0d, 0x2b, 0xe2, 0x6c,
+            0x95, 0x5f, 0x45, 0x0d, 0x72, 0xc2, 0x65, 0x93, 0x5b, 0x65, 0x77, 0xbb,
+        },
+    };
+
+    auto putDWord = [](vector<uint8_t> &out, uint32_t value) {
+        for (int i = 0; i < 4; i++) out.push_back((value >> (8 * i)) & 0xff);
+    };
+    auto putWords = [](vector<uint8_t> &out, std::initializer_list<uint16_t> values) {
+        for (uint16_t value : values) {
+            out.push_back(value & 0xff);
+            out.push_back(value >> 8);
+        }
+    };
+    auto chunk = [&](const char *tag, const vector<uint8_t> &body) {
+        vector<uint8_t> out(tag, tag + 4);
+        putDWord(out, body.size());
+        out.insert(out.end(), body.begin(), body.end());
+        if (body.size() & 1) out.push_back(0);
+        return out;
+    };
+    auto list = [&](const char *tag, const char *form, vector<vector<uint8_t>> chunks) {
+        vector<uint8_t> body(form, form + 4);
+        for (const vector<uint8_t> &c : chunks) body.insert(body.end(), c.begin(), c.end());
+        return chunk(tag, body);
+    };
+    auto makeDLS = [&](const uint8_t *samples) {
+        vector<uint8_t> colh, insh, rgnh, wlnk, art1, ptbl, fmt;
+        putDWord(colh, 1);
+        putDWord(insh, 1);
+        putDWord(insh, 0);
+        putDWord(insh, 0);
+        putWords(rgnh, {0, 127, 0, 127, 0, 0});
+        putWords(wlnk, {0, 0});
+        putDWord(wlnk, 1);
+        putDWord(wlnk, 0);
+        // one connection, the volume envelope attack time
+        putDWord(art1, 8);
+        putDWord(art1, 1);
+        putWords(art1, {0, 0, 0x0206, 0});
+        putDWord(art1, 0);
+        putDWord(ptbl, 8);
+        putDWord(ptbl, 1);
+        putDWord(ptbl, 0);
+        putWords(fmt, {1, 1});
+        putDWord(fmt, 22050);
+        putDWord(fmt, 44100);
+        putWords(fmt, {2, 16});
+        return list("RIFF", "DLS ", {
+            chunk("colh", colh),
+            list("LIST", "lins", {
+                list("LIST", "ins ", {
+                    chunk("insh", insh),
+                    list("LIST", "lrgn", {
+                        list("LIST", "rgn ", {chunk("rgnh", rgnh), chunk("wlnk", wlnk)}),
+                    }),
+                    list("LIST", "lart", {chunk("art1", art1)}),
+                }),
+            }),
+            list("LIST", "wvpl", {
+                list("LIST", "wave", {
+                    chunk("fmt ", fmt),
+                    chunk("data", vector<uint8_t>(samples, samples + 96)),
+                }),
+            }),
+            chunk("ptbl", ptbl),
+        });
+    };
+    auto makeJet = [&](const vector<uint8_t> &dls) {
+        vector<uint8_t> info = {'S', 'M', 'F', '#'};
+        putDWord(info, 0);
+        info.insert(info.end(), {'D', 'L', 'S', '#'});
+        putDWord(info, 1);
+        vector<uint8_t> jet = {'J', 'E', 'T', ' '};
+        putDWord(jet, 0);
+        vector<uint8_t> c = chunk("JINF", info);
+        jet.insert(jet.end(), c.begin(), c.end());
+        c = chunk("JDLS", dls);
+        jet.insert(jet.end(), c.begin(), c.end());
+        uint32_t jetSize = jet.size();
+        memcpy(&jet[4], &jetSize, sizeof(jetSize));
+        return jet;
+    };
+
+    vector<uint8_t> dls[2] = {makeDLS(kSamples[0]), makeDLS(kSamples[1])};
+    uint32_t hash[2], sum[2];
+    for (int i = 0; i < 2; i++) {
+        hash[i] = 2166136261u;
+        sum[i] = 0;
+        for (uint8_t b : dls[i]) {
+            hash[i] = (hash[i] ^ b) * 16777619u;
+            sum[i] = sum[i] * 31 + b + 1;
+        }
+    }
+    ASSERT_EQ(dls[0].size(), dls[1].size()) << "Collections differ in size";
+    ASSERT_EQ(hash[0], hash[1]) << "Collections differ in their FNV-1a hash";
+    ASSERT_EQ(sum[0], sum[1]) << "Collections differ in their sum";
+    ASSERT_NE(dls[0], dls[1]) << "Collections are identical";
+
+    S_EAS_MEMORY_USAGE before, usage[3], after;
+    EAS_RESULT result = EAS_GetMemoryUsage(mEASDataHandle, &before);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Memory accounting not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the memory usage";
+
+    // the first two instances open the same collection, the third the other one
+    vector<uint8_t> jet[2] = {makeJet(dls[0]), makeJet(dls[1])};
+    EAS_FILE memLocators[3];
+    EAS_MEMORY_FILE memFiles[3];
+    EAS_DATA_HANDLE easDataHandles[3] = {nullptr, nullptr, nullptr};
+    for (int i = 0; i < 3; i++) {
+        const vector<uint8_t> &file = jet[i == 2];
+        EAS_InitMemoryLocator(&memLocators[i], &memFiles[i], file.data(), file.size());
+        ASSERT_EQ(EAS_Init(&easDataHandles[i]), EAS_SUCCESS)
+                << "Failed to initialize synthesizer library";
+        ASSERT_EQ(JET_Init(easDataHandles[i], nullptr, 0), EAS_SUCCESS) << "Failed to initialize JET";
+        ASSERT_EQ(JET_OpenFile(easDataHandles[i], &memLocators[i]), EAS_SUCCESS)
+                << "Failed to open JET file";
+        ASSERT_EQ(EAS_GetMemoryUsage(mEASDataHandle, &usage[i]), EAS_SUCCESS)
+                << "Failed to get the memory usage";
+    }
+    bool cached = usage[1].sharedDLS == usage[0].sharedDLS && usage[0].sharedDLS > before.sharedDLS;
+    bool distinct = usage[2].sharedDLS > usage[1].sharedDLS;
+
+    for (EAS_DATA_HANDLE easDataHandle : easDataHandles) {
+        ASSERT_EQ(JET_CloseFile(easDataHandle), EAS_SUCCESS) << "Failed to close JET file";
+        ASSERT_EQ(JET_Shutdown(easDataHandle), EAS_SUCCESS) << "Failed to shut down JET";
+        ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+                << "Failed to deallocate the resources for synthesizer library";
+    }
+    ASSERT_EQ(EAS_GetMemoryUsage(mEASDataHandle, &after), EAS_SUCCESS)
+            << "Failed to get the memory usage";
+    ASSERT_EQ(after.sharedDLS, before.sharedDLS) << "Shared DLS collections were not freed";
+    if (!cached) GTEST_SKIP() << "DLS collection cache not supported";
+    ASSERT_TRUE(distinct) << "Collection with colliding hashes shared a conversion";
+}
+
+TEST_P(SonivoxTest, ToneGeneratorTest) {
+    // a library whose regions are all square generators plays without
+    // reading the sample data, so scrambling the samples changes nothing
+    EAS_I32 size;
+    EAS_RESULT result = EAS_WriteSoundLibrary(mEASDataHandle, nullptr, nullptr, 0, &size);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "External sound libraries not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to size the sound library";
+    vector<uint8_t> image(size);
+    ASSERT_EQ(EAS_WriteSoundLibrary(mEASDataHandle, nullptr, image.data(), size, &size), EAS_SUCCESS)
+            << "Failed to write the sound library";
+
+    auto getU16 = [&](size_t offset) -> uint32_t {
+        return image[offset] | (image[offset + 1] << 8);
+    };
+    auto getU32 = [&](size_t offset) -> uint32_t {
+        return getU16(offset) | (getU16(offset + 2) << 16);
+    };
+
+    // the noise regions stay noise, compressed regions become squares as well
+    size_t regions = getU32(28) + getU16(16) * 258 + getU16(18) * 8;
+    for (uint32_t i = 0; i < getU16(20); i++) {
+        uint8_t *region = &image[regions + i * 20];
+        uint32_t flags = region[0] | (region[1] << 8);
+        if (!(flags & 0x02)) {
+            flags = (flags & ~0x04) | 0x12;
+        }
+        region[0] = flags & 0xff;
+        region[1] = flags >> 8;
+    }
+    vector<uint8_t> scrambled(image);
+    uint32_t samplesOffset = getU32(36);
+    uint32_t samplesSize = getU32(40) - 16;
+    for (uint32_t i = 0; i < samplesSize; i++) {
+        scrambled[samplesOffset + i] = (uint8_t)(i * 167 + 13);
+    }
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 16;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+
+    auto render = [&](vector<uint8_t> &lib, vector<EAS_PCM> &out) {
+        EAS_FILE libLocator;
+        EAS_MEMORY_FILE libFile;
+        EAS_InitMemoryLocator(&libLocator, &libFile, lib.data(), lib.size());
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        EAS_HANDLE easStreamHandle = nullptr;
+        S_EAS_INIT_CONFIG initConfig = {0, 0, &libLocator};
+        ASSERT_EQ(EAS_InitEx(&easDataHandle, &initConfig), EAS_SUCCESS)
+                << "Failed to initialize with the sound library";
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open file";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS) << "Failed to prepare";
+        EAS_I32 playTimeMs;
+        ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+                << "Failed to parse meta data";
+        ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, out));
+        closeInstance(easDataHandle, easStreamHandle);
+    };
+    vector<EAS_PCM> tones(expected.size());
+    vector<EAS_PCM> scrambledTones(expected.size());
+    ASSERT_NO_FATAL_FAILURE(render(image, tones));
+    ASSERT_NO_FATAL_FAILURE(render(scrambled, scrambledTones));
+    ASSERT_NE(tones, vector<EAS_PCM>(tones.size(), 0)) << "Tone generators are silent";
+    ASSERT_EQ(tones, scrambledTones) << "Tone generators read the sample data";
+    if (tones == expected) {
+        GTEST_SKIP() << "File plays only the instruments of its own collection";
+    }
+}
+
+TEST_P(SonivoxTest, ArenaTest) {
+    // play the file on an instance allocated from an arena; the output must
+    // match the C library instance, closing the file must give its memory
+    // back and opening it again must not need more
+    static constexpr EAS_I32 kArenaSize = 4 << 20;
+    vector<uint8_t> arena(kArenaSize);
+    S_EAS_INIT_CONFIG initConfig = {};
+    initConfig.pArena = arena.data();
+    initConfig.arenaSize = 1024;
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_RESULT result = EAS_InitEx(&easDataHandle, &initConfig);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Memory arena not supported";
+    }
+    ASSERT_EQ(result, EAS_ERROR_MALLOC_FAILED) << "Initialized in a tiny arena";
+    initConfig.arenaSize = kArenaSize;
+    ASSERT_EQ(EAS_InitEx(&easDataHandle, &initConfig), EAS_SUCCESS)
+            << "Failed to initialize in the arena";
+    EAS_I32 initUse, inUse, peak;
+    ASSERT_EQ(EAS_GetArenaUsage(easDataHandle, &initUse, &peak), EAS_SUCCESS)
+            << "Failed to get the arena usage";
+    ASSERT_EQ(EAS_GetArenaUsage(mEASDataHandle, &inUse, &peak), EAS_ERROR_NOT_VALID_IN_THIS_STATE)
+            << "Arena usage reported without an arena";
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 16;
+    vector<EAS_PCM> expected(totalSamples * mEASConfig->numChannels);
+    vector<EAS_PCM> actual(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, expected));
+
+    EAS_I32 firstPeak = 0;
+    for (int i = 0; i < 3; i++) {
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open file";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS) << "Failed to prepare";
+        EAS_I32 playTimeMs;
+        ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+                << "Failed to parse meta data";
+        if (i == 0) {
+            ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, actual));
+            ASSERT_EQ(expected, actual) << "Arena instance does not match the C library";
+        }
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+        ASSERT_EQ(EAS_GetArenaUsage(easDataHandle, &inUse, &peak), EAS_SUCCESS)
+                << "Failed to get the arena usage";
+        ASSERT_EQ(inUse, initUse) << "Closing the file leaked arena memory";
+        if (i == 0) {
+            firstPeak = peak;
+        }
+        ASSERT_EQ(peak, firstPeak) << "Opening the file again needed more arena memory";
+    }
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+
+    // a host allocator must see every allocation freed again
+    struct Counter {
+        static void *allocate(void *context, EAS_I32 size) {
+            (*static_cast<std::atomic<int> *>(context))++;
+            return malloc(size);
+        }
+        static void deallocate(void *context, void *p) {
+            (*static_cast<std::atomic<int> *>(context))--;
+            free(p);
+        }
+    };
+    std::atomic<int> allocations(0);
+    EAS_ALLOCATOR allocator = {Counter::allocate, Counter::deallocate, &allocations};
+    initConfig = {};
+    initConfig.pAllocator = &allocator;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_InitEx(&easDataHandle, &initConfig), EAS_SUCCESS)
+            << "Failed to initialize with the allocator";
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open file";
+    ASSERT_GT(allocations, 0) << "Allocator not used";
+    closeInstance(easDataHandle, easStreamHandle);
+    ASSERT_EQ(allocations, 0) << "Allocations not freed through the allocator";
+}
+
+TEST_P(SonivoxTest, MemoryUsageTest) {
+    // the categories must add up to the total, opening a second stream must
+    // add parser state and closing it must give the same memory back
+    S_EAS_MEMORY_USAGE before, during, after;
+    EAS_RESULT result = EAS_GetMemoryUsage(mEASDataHandle, &before);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Memory accounting not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the memory usage";
+    ASSERT_GT(before.voiceManager, 0) << "Voice manager not accounted";
+    ASSERT_GT(before.mixBuffers, 0) << "Mix buffers not accounted";
+    ASSERT_GT(before.host, 0) << "Host data not accounted";
+    ASSERT_EQ(before.total, before.voiceManager + before.mixBuffers + before.effects + before.dls +
+            before.parsers + before.pcmCache + before.host + before.other)
+            << "Categories do not add up to the total";
+
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_OpenFile(mEASDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open file";
+    ASSERT_EQ(EAS_Prepare(mEASDataHandle, easStreamHandle), EAS_SUCCESS) << "Failed to prepare";
+    ASSERT_EQ(EAS_GetMemoryUsage(mEASDataHandle, &during), EAS_SUCCESS)
+            << "Failed to get the memory usage";
+    ASSERT_GT(during.parsers, before.parsers) << "Parser state not accounted";
+    ASSERT_EQ(EAS_CloseFile(mEASDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+    ASSERT_EQ(EAS_GetMemoryUsage(mEASDataHandle, &after), EAS_SUCCESS)
+            << "Failed to get the memory usage";
+    ASSERT_EQ(after.parsers, before.parsers) << "Closing the stream leaked parser state";
+    ASSERT_EQ(after.dls, before.dls) << "Closing the stream leaked DLS memory";
+    ASSERT_EQ(after.voiceManager, before.voiceManager) << "Closing the stream leaked its synthesizer";
+    ASSERT_EQ(after.total, before.total) << "Closing the stream leaked memory";
+    ASSERT_EQ(EAS_GetMemoryUsage(mEASDataHandle, nullptr), EAS_ERROR_INVALID_PARAMETER)
+            << "Accepted a NULL usage";
+}
+
+TEST_P(SonivoxTest, ParseLimitsTest) {
+    // a parse over a limit must fail with its own error, and a stream
+    // opened without limits must parse the whole file
+    S_EAS_PARSE_LIMITS limits = {};
+    limits.maxEvents = -1;
+    EAS_RESULT result = EAS_SetParseLimits(mEASDataHandle, &limits);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Parse limits not supported";
+    }
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Accepted a negative limit";
+
+    limits.maxEvents = 1;
+    ASSERT_EQ(EAS_SetParseLimits(mEASDataHandle, &limits), EAS_SUCCESS) << "Failed to set limits";
+    EAS_I32 playTimeMs = 0;
+    ASSERT_EQ(EAS_ParseMetaData(mEASDataHandle, mEASStreamHandle, &playTimeMs),
+              EAS_ERROR_PARSE_LIMIT) << "Parsed more events than the limit";
+
+    // an XMF tree larger than the node limit is rejected when opened
+    EAS_HANDLE easStreamHandle = nullptr;
+    bool isXMF = mInputMediaFile.size() > 5 &&
+            mInputMediaFile.compare(mInputMediaFile.size() - 5, 5, ".mxmf") == 0;
+    if (isXMF) {
+        limits.maxEvents = 0;
+        limits.maxNodes = 1;
+        ASSERT_EQ(EAS_SetParseLimits(mEASDataHandle, &limits), EAS_SUCCESS)
+                << "Failed to set limits";
+        ASSERT_EQ(EAS_OpenFile(mEASDataHandle, &mEasFile, &easStreamHandle), EAS_ERROR_PARSE_LIMIT)
+                << "Opened an XMF file with more nodes than the limit";
+    }
+
+    ASSERT_EQ(EAS_SetParseLimits(mEASDataHandle, nullptr), EAS_SUCCESS) << "Failed to clear limits";
+    ASSERT_EQ(EAS_OpenFile(mEASDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open file";
+    ASSERT_EQ(EAS_Prepare(mEASDataHandle, easStreamHandle), EAS_SUCCESS) << "Failed to prepare";
+    ASSERT_EQ(EAS_ParseMetaData(mEASDataHandle, easStreamHandle, &playTimeMs), EAS_SUCCESS)
+            << "Failed to parse metadata without limits";
+    ASSERT_EQ(playTimeMs, mAudioplayTimeMs) << "Wrong play time without limits";
+    ASSERT_EQ(EAS_CloseFile(mEASDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+}
+
+TEST_P(SonivoxTest, InstancePoolTest) {
+    // an instance released to the pool and acquired again must play the file
+    // exactly like a fresh instance, whatever the previous user changed
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_RESULT result = EAS_AcquireInstance(&easDataHandle);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Instance pool not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to acquire an instance";
+
+    auto play = [&](EAS_DATA_HANDLE easDataHandle, vector<EAS_PCM> &output) {
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open file";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to prepare EAS data and stream handles";
+        output.clear();
+        EAS_STATE state;
+        EAS_I32 count;
+        while (1) {
+            ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS)
+                    << "Failed to get EAS State";
+            if (state == EAS_STATE_STOPPED) break;
+            size_t offset = output.size();
+            output.resize(offset + mEASConfig->mixBufferSize * mEASConfig->numChannels);
+            ASSERT_EQ(EAS_Render(easDataHandle, &output[offset], mEASConfig->mixBufferSize, &count),
+                      EAS_SUCCESS)
+                    << "Failed to render the audio data";
+        }
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+    };
+
+    vector<EAS_PCM> expected;
+    vector<EAS_PCM> actual;
+    EAS_DATA_HANDLE referenceHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&referenceHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    ASSERT_NO_FATAL_FAILURE(play(referenceHandle, expected));
+    ASSERT_EQ(EAS_Shutdown(referenceHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+
+    // change what the instance allows and leave a stream open
+    ASSERT_EQ(EAS_SetVolume(easDataHandle, nullptr, 50), EAS_SUCCESS) << "Failed to set volume";
+    (void) EAS_SetInterpolation(easDataHandle, EAS_INTERPOLATION_CUBIC);
+    (void) EAS_SetPCMCacheSize(easDataHandle, 1 << 20);
+    (void) EAS_SetParameter(easDataHandle, EAS_MODULE_REVERB, EAS_PARAM_REVERB_PRESET,
+                            EAS_PARAM_REVERB_LARGE_HALL);
+    (void) EAS_SetParameter(easDataHandle, EAS_MODULE_REVERB, EAS_PARAM_REVERB_BYPASS, EAS_FALSE);
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, actual));
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+            << "Failed to open file";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+            << "Failed to prepare EAS data and stream handles";
+    EAS_I32 count;
+    ASSERT_EQ(EAS_Render(easDataHandle, actual.data(), mEASConfig->mixBufferSize, &count),
+              EAS_SUCCESS)
+            << "Failed to render the audio data";
+
+    EAS_DATA_HANDLE released = easDataHandle;
+    ASSERT_EQ(EAS_ReleaseInstance(easDataHandle), EAS_SUCCESS) << "Failed to release the instance";
+    ASSERT_EQ(EAS_AcquireInstance(&easDataHandle), EAS_SUCCESS) << "Failed to acquire an instance";
+    ASSERT_EQ(easDataHandle, released) << "Released instance not reused";
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, actual));
+    ASSERT_EQ(expected, actual) << "Reused instance does not play like a fresh one";
+
+    ASSERT_EQ(EAS_ReleaseInstance(easDataHandle), EAS_SUCCESS) << "Failed to release the instance";
+    ASSERT_EQ(EAS_FlushInstancePool(), EAS_SUCCESS) << "Failed to flush the instance pool";
+}
+
+TEST_P(SonivoxTest, DynamicStreamsTest) {
+    // an instance with a larger stream table plays more files at once than
+    // the default table of 4, and a single file exactly like a default instance
+    constexpr EAS_I32 kMaxStreams = 8;
+    S_EAS_INIT_CONFIG initConfig = {};
+    initConfig.maxStreams = kMaxStreams;
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_RESULT result = EAS_InitEx(&easDataHandle, &initConfig);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Dynamic stream table not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize with a larger stream table";
+
+    vector<EAS_HANDLE> streams(kMaxStreams);
+    for (EAS_HANDLE &stream : streams) {
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &stream), EAS_SUCCESS)
+                << "Failed to open file";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, stream), EAS_SUCCESS)
+                << "Failed to prepare EAS data and stream handles";
+    }
+    EAS_HANDLE extraStream = nullptr;
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &extraStream), EAS_ERROR_MAX_STREAMS_OPEN)
+            << "Opened more streams than the table holds";
+
+    vector<EAS_PCM> output(mEASConfig->mixBufferSize * mEASConfig->numChannels);
+    EAS_I32 count;
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ(EAS_Render(easDataHandle, output.data(), mEASConfig->mixBufferSize, &count),
+                  EAS_SUCCESS)
+                << "Failed to render the audio data";
+    }
+    for (EAS_HANDLE stream : streams) {
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, stream), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+    }
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+
+    auto play = [&](EAS_DATA_HANDLE easDataHandle, vector<EAS_PCM> &output) {
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open file";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to prepare EAS data and stream handles";
+        output.clear();
+        EAS_STATE state;
+        EAS_I32 count;
+        while (1) {
+            ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS)
+                    << "Failed to get EAS State";
+            if (state == EAS_STATE_STOPPED) break;
+            size_t offset = output.size();
+            output.resize(offset + mEASConfig->mixBufferSize * mEASConfig->numChannels);
+            ASSERT_EQ(EAS_Render(easDataHandle, &output[offset], mEASConfig->mixBufferSize, &count),
+                      EAS_SUCCESS)
+                    << "Failed to render the audio data";
+        }
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+    };
+
+    vector<EAS_PCM> expected;
+    vector<EAS_PCM> actual;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, expected));
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+    ASSERT_EQ(EAS_InitEx(&easDataHandle, &initConfig), EAS_SUCCESS)
+            << "Failed to initialize with a larger stream table";
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, actual));
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+    ASSERT_EQ(expected, actual) << "Stream table size changed the output";
+
+    initConfig.maxStreams = -1;
+    ASSERT_EQ(EAS_InitEx(&easDataHandle, &initConfig), EAS_ERROR_PARAMETER_RANGE)
+            << "Negative stream table size accepted";
+}
+
+TEST_P(SonivoxTest, RuntimePolyphonyTest) {
+    // an instance with a small voice pool plays the file and reports its size,
+    // and an instance with the full pool sounds exactly like a default instance
+    constexpr EAS_I32 kMaxVoices = 16;
+    S_EAS_INIT_CONFIG initConfig = {};
+    initConfig.maxVoices = kMaxVoices;
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_RESULT result = EAS_InitEx(&easDataHandle, &initConfig);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Runtime polyphony not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize with a smaller voice pool";
+
+    auto play = [&](EAS_DATA_HANDLE easDataHandle, vector<EAS_PCM> &output) {
+        EAS_HANDLE easStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &easStreamHandle), EAS_SUCCESS)
+                << "Failed to open file";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to prepare EAS data and stream handles";
+        output.clear();
+        EAS_STATE state;
+        EAS_I32 count;
+        while (1) {
+            ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS)
+                    << "Failed to get EAS State";
+            if (state == EAS_STATE_STOPPED) break;
+            size_t offset = output.size();
+            output.resize(offset + mEASConfig->mixBufferSize * mEASConfig->numChannels);
+            ASSERT_EQ(EAS_Render(easDataHandle, &output[offset], mEASConfig->mixBufferSize, &count),
+                      EAS_SUCCESS)
+                    << "Failed to render the audio data";
+        }
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+    };
+
+    EAS_I32 polyphony;
+    ASSERT_EQ(EAS_GetPolyphonyLimit(easDataHandle, &polyphony), EAS_SUCCESS)
+            << "Failed to get the polyphony limit";
+    ASSERT_EQ(polyphony, kMaxVoices) << "Polyphony limit is not the voice pool size";
+    S_EAS_LIB_CONFIG instanceConfig;
+    ASSERT_EQ(EAS_GetInstanceConfig(easDataHandle, &instanceConfig), EAS_SUCCESS)
+            << "Failed to get the instance configuration";
+    ASSERT_EQ(instanceConfig.maxVoices, kMaxVoices) << "Wrong voice count reported";
+    vector<EAS_PCM> actual;
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, actual));
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+
+    vector<EAS_PCM> expected;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    ASSERT_EQ(EAS_GetInstanceConfig(easDataHandle, &instanceConfig), EAS_SUCCESS)
+            << "Failed to get the instance configuration";
+    initConfig.maxVoices = instanceConfig.maxVoices;
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, expected));
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+    ASSERT_EQ(EAS_InitEx(&easDataHandle, &initConfig), EAS_SUCCESS)
+            << "Failed to initialize with the full voice pool";
+    ASSERT_NO_FATAL_FAILURE(play(easDataHandle, actual));
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+    ASSERT_EQ(expected, actual) << "Voice pool size changed the output";
+
+    // a single virtual synthesizer plays one file at a time
+    initConfig.maxSynths = 1;
+    ASSERT_EQ(EAS_InitEx(&easDataHandle, &initConfig), EAS_SUCCESS)
+            << "Failed to initialize with a single synthesizer";
+    EAS_HANDLE firstStream = nullptr;
+    EAS_HANDLE secondStream = nullptr;
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &firstStream), EAS_SUCCESS)
+            << "Failed to open file";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, firstStream), EAS_SUCCESS)
+            << "Failed to prepare EAS data and stream handles";
+    ASSERT_EQ(EAS_OpenFile(easDataHandle, &mEasFile, &secondStream), EAS_SUCCESS)
+            << "Failed to open file";
+    ASSERT_EQ(EAS_Prepare(easDataHandle, secondStream), EAS_ERROR_NO_VIRTUAL_SYNTHESIZER)
+            << "Prepared more files than there are synthesizers";
+    ASSERT_EQ(EAS_CloseFile(easDataHandle, secondStream), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+    ASSERT_EQ(EAS_CloseFile(easDataHandle, firstStream), EAS_SUCCESS)
+            << "Failed to close audio file/stream";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+
+    initConfig.maxSynths = 0;
+    initConfig.maxVoices = 1000;
+    ASSERT_EQ(EAS_InitEx(&easDataHandle, &initConfig), EAS_ERROR_PARAMETER_RANGE)
+            << "Voice pool larger than the compiled limit accepted";
+}
+
+TEST_P(SonivoxTest, JetRepeatTest) {
+    // a JET segment that repeats restarts in the frame after it ends, and so
+    // does the segment queued after it
+    vector<uint8_t> jet;
+    if (!makeJetFile(jet)) {
+        GTEST_SKIP() << "JET segments are standard MIDI files";
+    }
+
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, jet.data(), jet.size());
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    ASSERT_EQ(JET_Init(easDataHandle, nullptr, 0), EAS_SUCCESS) << "Failed to initialize JET";
+    ASSERT_EQ(JET_OpenFile(easDataHandle, &memLocator), EAS_SUCCESS) << "Failed to open JET file";
+
+    // the stream time is back at zero after the frame that ends a play, and
+    // advances again in the next frame
+    ASSERT_EQ(JET_QueueSegment(easDataHandle, 0, -1, 1, 0, 0, 0), EAS_SUCCESS)
+            << "Failed to queue the segment";
+    ASSERT_EQ(JET_QueueSegment(easDataHandle, 0, -1, 0, 0, 0, 1), EAS_SUCCESS)
+            << "Failed to queue the second segment";
+    ASSERT_EQ(JET_Play(easDataHandle), EAS_SUCCESS) << "Failed to start JET playback";
+    vector<EAS_PCM> buffer(mEASConfig->mixBufferSize * mEASConfig->numChannels);
+    S_JET_STATUS status;
+    EAS_I32 count;
+    EAS_I32 lastLocation = 0;
+    int restarts = 0;
+    for (int frame = 0; frame < (1 << 20); frame++) {
+        ASSERT_EQ(EAS_Render(easDataHandle, buffer.data(), mEASConfig->mixBufferSize, &count),
+                  EAS_SUCCESS)
+                << "Failed to render the audio data";
+        // JET_Status leaves the location alone while it is zero
+        status.location = -1;
+        ASSERT_EQ(JET_Status(easDataHandle, &status), EAS_SUCCESS) << "Failed to get JET status";
+        if (status.numQueuedSegments == 0) break;
+        // the release tail of the last play is no longer the current segment
+        if (status.currentUserID < 0) continue;
+        // zero right after the frame that rewinds the segment, but not for a second frame
+        if (status.location < 0) {
+            ASSERT_GT(lastLocation, 0) << "Segment did not advance in frame " << frame;
+            restarts++;
+            lastLocation = 0;
+        } else {
+            lastLocation = status.location;
+        }
+    }
+    ASSERT_EQ(status.numQueuedSegments, 0) << "Segment did not finish";
+    ASSERT_TRUE(status.paused) << "JET still playing after the last segment";
+    ASSERT_EQ(restarts, 2) << "Segment did not repeat and play the next one";
+
+    ASSERT_EQ(JET_CloseFile(easDataHandle), EAS_SUCCESS) << "Failed to close JET file";
+    ASSERT_EQ(JET_Shutdown(easDataHandle), EAS_SUCCESS) << "Failed to shut down JET";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, JetEventTest) {
+    // application events queue up to the configured depth and count what
+    // doesn't fit, and a callback gets them at the end of their frame
+    // instead, timestamped on the sample clock
+    vector<uint8_t> jet;
+    if (!makeJetFile(jet)) {
+        GTEST_SKIP() << "JET segments are standard MIDI files";
+    }
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    constexpr EAS_U16 kQueueSize = 8;
+    S_JET_CONFIG config = {0, 101, 12};
+    EAS_RESULT result = JET_Init(easDataHandle, &config, sizeof(config));
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "JET event ring not supported";
+    }
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Queue size that is not a power of 2 accepted";
+    config.appEventQueueSize = kQueueSize;
+    ASSERT_EQ(JET_Init(easDataHandle, &config, sizeof(config)), EAS_SUCCESS)
+            << "Failed to initialize JET";
+
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, jet.data(), jet.size());
+    ASSERT_EQ(JET_OpenFile(easDataHandle, &memLocator), EAS_SUCCESS) << "Failed to open JET file";
+    ASSERT_EQ(JET_QueueSegment(easDataHandle, 0, -1, 0, 0, 0, 7), EAS_SUCCESS)
+            << "Failed to queue the segment";
+    ASSERT_EQ(JET_Play(easDataHandle), EAS_SUCCESS) << "Failed to start JET playback";
+
+    vector<EAS_PCM> buffer(mEASConfig->mixBufferSize * mEASConfig->numChannels);
+    EAS_I32 count;
+    EAS_U32 overflows = 0;
+    EAS_U32 sampleTime;
+    for (int frame = 0; frame < (1 << 20) && overflows == 0; frame++) {
+        ASSERT_EQ(EAS_Render(easDataHandle, buffer.data(), mEASConfig->mixBufferSize, &count),
+                  EAS_SUCCESS)
+                << "Failed to render the audio data";
+        ASSERT_EQ(JET_GetEventOverflows(easDataHandle, &overflows), EAS_SUCCESS)
+                << "Failed to get the overflow count";
+    }
+    ASSERT_GT(overflows, 0u) << "File has too few controllers to fill the queue";
+    ASSERT_EQ(EAS_GetSampleTime(easDataHandle, &sampleTime), EAS_SUCCESS)
+            << "Failed to get the sample time";
+
+    // the queue holds the first events in order
+    S_JET_EVENT event;
+    EAS_U32 eventTime;
+    EAS_U32 lastTime = 0;
+    for (int i = 0; i < kQueueSize; i++) {
+        ASSERT_TRUE(JET_GetTimedEvent(easDataHandle, nullptr, &event, &eventTime))
+                << "Queue holds fewer events than its size";
+        ASSERT_EQ(event.segment, 7) << "Wrong user ID";
+        ASSERT_LE(event.controller, 101) << "Controller outside the application range";
+        ASSERT_GE(eventTime, lastTime) << "Events out of order";
+        ASSERT_LT(eventTime, sampleTime) << "Event time after the samples rendered";
+        lastTime = eventTime;
+    }
+    ASSERT_FALSE(JET_GetEvent(easDataHandle, nullptr, &event)) << "Queue holds more than its size";
+
+    // with a queue deep enough for the busiest frame, the callback sees each
+    // event at the end of the frame it falls in
+    ASSERT_EQ(JET_CloseFile(easDataHandle), EAS_SUCCESS) << "Failed to close JET file";
+    ASSERT_EQ(JET_Shutdown(easDataHandle), EAS_SUCCESS) << "Failed to shut down JET";
+    config.appEventQueueSize = 256;
+    ASSERT_EQ(JET_Init(easDataHandle, &config, sizeof(config)), EAS_SUCCESS)
+            << "Failed to initialize JET";
+    EAS_InitMemoryLocator(&memLocator, &memFile, jet.data(), jet.size());
+    ASSERT_EQ(JET_OpenFile(easDataHandle, &memLocator), EAS_SUCCESS) << "Failed to open JET file";
+    struct CallbackData {
+        EAS_DATA_HANDLE easDataHandle;
+        EAS_U32 frameSize;
+        int events;
+        bool inFrame;
+    } data = {easDataHandle, (EAS_U32) mEASConfig->mixBufferSize, 0, true};
+    auto callback = [](EAS_VOID_PTR pUserData, EAS_U32, const S_JET_EVENT *, EAS_U32 time) {
+        CallbackData *pData = (CallbackData *) pUserData;
+        EAS_U32 frameEnd;
+        EAS_GetSampleTime(pData->easDataHandle, &frameEnd);
+        if ((time >= frameEnd) || (frameEnd - time > pData->frameSize)) pData->inFrame = false;
+        pData->events++;
+    };
+    ASSERT_EQ(JET_SetEventCallback(easDataHandle, callback, &data), EAS_SUCCESS)
+            << "Failed to set the event callback";
+    ASSERT_EQ(JET_QueueSegment(easDataHandle, 0, -1, 0, 0, 0, 7), EAS_SUCCESS)
+            << "Failed to queue the segment";
+    ASSERT_EQ(JET_Play(easDataHandle), EAS_SUCCESS) << "Failed to start JET playback";
+    S_JET_STATUS status;
+    for (int frame = 0; frame < (1 << 20); frame++) {
+        ASSERT_EQ(EAS_Render(easDataHandle, buffer.data(), mEASConfig->mixBufferSize, &count),
+                  EAS_SUCCESS)
+                << "Failed to render the audio data";
+        ASSERT_FALSE(JET_GetEvent(easDataHandle, nullptr, &event)) << "Event queued with a callback";
+        ASSERT_EQ(JET_Status(easDataHandle, &status), EAS_SUCCESS) << "Failed to get JET status";
+        if (status.numQueuedSegments == 0) break;
+    }
+    ASSERT_EQ(status.numQueuedSegments, 0) << "Segment did not finish";
+    ASSERT_GT(data.events, 0) << "Callback got no events";
+    ASSERT_TRUE(data.inFrame) << "Callback event time outside its frame";
+    ASSERT_EQ(JET_GetEventOverflows(easDataHandle, &overflows), EAS_SUCCESS)
+            << "Failed to get the overflow count";
+    ASSERT_EQ(overflows, 0u) << "Events dropped with a callback";
+
+    ASSERT_EQ(JET_CloseFile(easDataHandle), EAS_SUCCESS) << "Failed to close JET file";
+    ASSERT_EQ(JET_Shutdown(easDataHandle), EAS_SUCCESS) << "Failed to shut down JET";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, JetQueueTest) {
+    // a deeper segment queue holds more segments than the default of 3, and
+    // segments queued asynchronously join it in order as it drains
+    vector<uint8_t> jet;
+    if (!makeJetFile(jet)) {
+        GTEST_SKIP() << "JET segments are standard MIDI files";
+    }
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    S_JET_CONFIG config = {80, 83, 0, 1, 0};
+    EAS_RESULT result = JET_Init(easDataHandle, &config, sizeof(config));
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "JET dynamic queue not supported";
+    }
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Queue depth of 1 accepted";
+    config.segmentQueueDepth = 65;
+    ASSERT_EQ(JET_Init(easDataHandle, &config, sizeof(config)), EAS_ERROR_PARAMETER_RANGE)
+            << "Queue depth of 65 accepted";
+    config.segmentQueueDepth = 0;
+    config.maxLibraries = 65;
+    ASSERT_EQ(JET_Init(easDataHandle, &config, sizeof(config)), EAS_ERROR_PARAMETER_RANGE)
+            << "65 DLS collections accepted";
+
+    constexpr int kDepth = 4;
+    config.segmentQueueDepth = kDepth;
+    config.maxLibraries = 0;
+    ASSERT_EQ(JET_Init(easDataHandle, &config, sizeof(config)), EAS_SUCCESS)
+            << "Failed to initialize JET";
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, jet.data(), jet.size());
+    ASSERT_EQ(JET_OpenFile(easDataHandle, &memLocator), EAS_SUCCESS) << "Failed to open JET file";
+
+    // fill the queue, then as many commands as it has room for again
+    for (int i = 0; i < kDepth; i++) {
+        ASSERT_EQ(JET_QueueSegment(easDataHandle, 0, -1, 0, 0, 0, i), EAS_SUCCESS)
+                << "Failed to queue segment " << i;
+    }
+    ASSERT_EQ(JET_QueueSegment(easDataHandle, 0, -1, 0, 0, 0, kDepth), EAS_ERROR_QUEUE_IS_FULL)
+            << "Segment queued beyond the queue depth";
+    for (int i = kDepth; i < 2 * kDepth; i++) {
+        ASSERT_EQ(JET_QueueSegmentAsync(easDataHandle, 0, -1, 0, 0, 0, i), EAS_SUCCESS)
+                << "Failed to queue segment " << i << " asynchronously";
+    }
+    ASSERT_EQ(JET_QueueSegmentAsync(easDataHandle, 0, -1, 0, 0, 0, 2 * kDepth),
+              EAS_ERROR_QUEUE_IS_FULL)
+            << "Too many segments waiting to join the queue";
+    ASSERT_EQ(JET_QueueSegmentAsync(easDataHandle, 1, -1, 0, 0, 0, 0), EAS_ERROR_PARAMETER_RANGE)
+            << "Segment that is not in the file accepted";
+    ASSERT_EQ(JET_Play(easDataHandle), EAS_SUCCESS) << "Failed to start JET playback";
+
+    vector<EAS_PCM> buffer(mEASConfig->mixBufferSize * mEASConfig->numChannels);
+    S_JET_STATUS status;
+    EAS_I32 count;
+    int nextUserID = 0;
+    for (int frame = 0; frame < (1 << 22); frame++) {
+        ASSERT_EQ(EAS_Render(easDataHandle, buffer.data(), mEASConfig->mixBufferSize, &count),
+                  EAS_SUCCESS)
+                << "Failed to render the audio data";
+        ASSERT_EQ(JET_Status(easDataHandle, &status), EAS_SUCCESS) << "Failed to get JET status";
+        if (status.numQueuedSegments == 0) break;
+        ASSERT_LE(status.numQueuedSegments, kDepth) << "Queue holds more segments than its depth";
+        if (status.currentUserID < 0) continue;
+        // each segment plays in turn, none is skipped
+        if (status.currentUserID != nextUserID - 1) {
+            ASSERT_EQ(status.currentUserID, nextUserID) << "Segment played out of order";
+            nextUserID++;
+        }
+    }
+    ASSERT_EQ(status.numQueuedSegments, 0) << "Segments did not finish";
+    ASSERT_EQ(nextUserID, 2 * kDepth) << "Not every queued segment played";
+    ASSERT_TRUE(status.paused) << "JET still playing after the last segment";
+
+    ASSERT_EQ(JET_CloseFile(easDataHandle), EAS_SUCCESS) << "Failed to close JET file";
+    ASSERT_EQ(JET_Shutdown(easDataHandle), EAS_SUCCESS) << "Failed to shut down JET";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, JetRealtimeTest) {
+    // in realtime mode the segments are opened and closed by JET_Service,
+    // and still play in order with no gap between them
+    vector<uint8_t> jet;
+    if (!makeJetFile(jet)) {
+        GTEST_SKIP() << "JET segments are standard MIDI files";
+    }
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    EAS_RESULT result = EAS_SetRealtimeRender(easDataHandle, EAS_TRUE);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "Realtime render not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to enable realtime render";
+    ASSERT_EQ(JET_Init(easDataHandle, nullptr, 0), EAS_SUCCESS) << "Failed to initialize JET";
+    EAS_FILE memLocator;
+    EAS_MEMORY_FILE memFile;
+    EAS_InitMemoryLocator(&memLocator, &memFile, jet.data(), jet.size());
+    ASSERT_EQ(JET_OpenFile(easDataHandle, &memLocator), EAS_SUCCESS) << "Failed to open JET file";
+    ASSERT_EQ(EAS_SetRealtimeRender(easDataHandle, EAS_FALSE), EAS_ERROR_NOT_VALID_IN_THIS_STATE)
+            << "Realtime render changed with a JET file open";
+
+    // the default queue depth of 3, and as many waiting to join it
+    constexpr int kSegments = 3;
+    for (int i = 0; i < kSegments; i++) {
+        ASSERT_EQ(JET_QueueSegmentAsync(easDataHandle, 0, -1, 0, 0, 0, i), EAS_SUCCESS)
+                << "Failed to queue segment " << i << " asynchronously";
+    }
+    S_JET_STATUS status;
+    ASSERT_EQ(JET_Status(easDataHandle, &status), EAS_SUCCESS) << "Failed to get JET status";
+    ASSERT_EQ(status.numQueuedSegments, 0) << "Segment joined the queue before JET_Service";
+    ASSERT_EQ(JET_Service(easDataHandle), EAS_SUCCESS) << "Failed to service the JET queue";
+    for (int i = kSegments; i < 2 * kSegments; i++) {
+        ASSERT_EQ(JET_QueueSegmentAsync(easDataHandle, 0, -1, 0, 0, 0, i), EAS_SUCCESS)
+                << "Failed to queue segment " << i << " asynchronously";
+    }
+    ASSERT_EQ(JET_Play(easDataHandle), EAS_SUCCESS) << "Failed to start JET playback";
+
+    vector<EAS_PCM> buffer(mEASConfig->mixBufferSize * mEASConfig->numChannels);
+    EAS_I32 count;
+    int nextUserID = 0;
+    for (int frame = 0; frame < (1 << 22); frame++) {
+        ASSERT_EQ(EAS_Render(easDataHandle, buffer.data(), mEASConfig->mixBufferSize, &count),
+                  EAS_SUCCESS)
+                << "Failed to render the audio data";
+        ASSERT_EQ(JET_Service(easDataHandle), EAS_SUCCESS) << "Failed to service the JET queue";
+        ASSERT_EQ(JET_Status(easDataHandle, &status), EAS_SUCCESS) << "Failed to get JET status";
+        if (status.numQueuedSegments == 0) break;
+        // never a frame without a playing segment until the last one ends
+        if (status.currentUserID < 0) {
+            ASSERT_EQ(nextUserID, 2 * kSegments) << "Gap between segments";
+            continue;
+        }
+        if (status.currentUserID != nextUserID - 1) {
+            ASSERT_EQ(status.currentUserID, nextUserID) << "Segment played out of order";
+            nextUserID++;
+        }
+    }
+    ASSERT_EQ(status.numQueuedSegments, 0) << "Segments did not finish";
+    ASSERT_EQ(nextUserID, 2 * kSegments) << "Not every queued segment played";
+
+    ASSERT_EQ(JET_CloseFile(easDataHandle), EAS_SUCCESS) << "Failed to close JET file";
+    ASSERT_EQ(JET_Shutdown(easDataHandle), EAS_SUCCESS) << "Failed to shut down JET";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+}
+
+TEST_P(SonivoxTest, JetTimedMuteTest) {
+    // a segment that starts muted and is un-muted at a sample time is silent
+    // before that sample, and a note that starts just before it stays muted
+    // even when both fall in the same frame
+    vector<uint8_t> jet;
+    if (!makeJetFile(jet)) {
+        GTEST_SKIP() << "JET segments are standard MIDI files";
+    }
+
+    // returns the first sample that is not silent, counted from the start of playback
+    auto firstSound = [&](EAS_U32 unmuteOffset, EAS_I32 *pFirst) {
+        *pFirst = -1;
+        EAS_FILE memLocator;
+        EAS_MEMORY_FILE memFile;
+        EAS_InitMemoryLocator(&memLocator, &memFile, jet.data(), jet.size());
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS)
+                << "Failed to initialize synthesizer library";
+        ASSERT_EQ(JET_Init(easDataHandle, nullptr, 0), EAS_SUCCESS) << "Failed to initialize JET";
+        ASSERT_EQ(JET_OpenFile(easDataHandle, &memLocator), EAS_SUCCESS)
+                << "Failed to open JET file";
+        ASSERT_EQ(JET_QueueSegment(easDataHandle, 0, -1, 0, 0, 0xffffffff, 0), EAS_SUCCESS)
+                << "Failed to queue the segment";
+        EAS_U32 start;
+        ASSERT_EQ(EAS_GetSampleTime(easDataHandle, &start), EAS_SUCCESS)
+                << "Failed to get the sample time";
+        ASSERT_EQ(JET_SetMuteFlagsAt(easDataHandle, 0, start + unmuteOffset), EAS_SUCCESS)
+                << "Failed to queue the mute change";
+        ASSERT_EQ(JET_Play(easDataHandle), EAS_SUCCESS) << "Failed to start JET playback";
+
+        vector<EAS_PCM> buffer(mEASConfig->mixBufferSize * mEASConfig->numChannels);
+        EAS_I32 count;
+        for (int frame = 0; (frame < 4000) && (*pFirst < 0); frame++) {
+            ASSERT_EQ(EAS_Render(easDataHandle, buffer.data(), mEASConfig->mixBufferSize, &count),
+                      EAS_SUCCESS)
+                    << "Failed to render the audio data";
+            for (size_t i = 0; i < buffer.size(); i++) {
+                if (buffer[i] != 0) {
+                    *pFirst = frame * mEASConfig->mixBufferSize + i / mEASConfig->numChannels;
+                    break;
+                }
+            }
+        }
+
+        ASSERT_EQ(JET_CloseFile(easDataHandle), EAS_SUCCESS) << "Failed to close JET file";
+        ASSERT_EQ(JET_Shutdown(easDataHandle), EAS_SUCCESS) << "Failed to shut down JET";
+        ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+                << "Failed to deallocate the resources for synthesizer library";
+    };
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS) << "Failed to initialize synthesizer library";
+    ASSERT_EQ(JET_Init(easDataHandle, nullptr, 0), EAS_SUCCESS) << "Failed to initialize JET";
+    EAS_RESULT result = JET_SetMuteFlagsAt(easDataHandle, 0, 0);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        JET_Shutdown(easDataHandle);
+        EAS_Shutdown(easDataHandle);
+        GTEST_SKIP() << "JET timed commands not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to queue the mute change";
+    ASSERT_EQ(JET_TriggerClipAt(easDataHandle, 64, 0), EAS_ERROR_PARAMETER_RANGE)
+            << "Clip ID out of range accepted";
+    ASSERT_EQ(JET_SetMuteFlagAt(easDataHandle, 32, EAS_TRUE, 0), EAS_ERROR_PARAMETER_RANGE)
+            << "Track out of range accepted";
+    result = EAS_SUCCESS;
+    for (int i = 0; (i < 64) && (result == EAS_SUCCESS); i++) {
+        result = JET_TriggerClipAt(easDataHandle, i, i);
+    }
+    ASSERT_EQ(result, EAS_ERROR_QUEUE_IS_FULL) << "Timed queue does not fill up";
+    ASSERT_EQ(JET_Clear_Queue(easDataHandle), EAS_SUCCESS) << "Failed to clear the queue";
+    ASSERT_EQ(JET_TriggerClipAt(easDataHandle, 0, 0), EAS_SUCCESS)
+            << "Timed queue not emptied by JET_Clear_Queue";
+    ASSERT_EQ(JET_Shutdown(easDataHandle), EAS_SUCCESS) << "Failed to shut down JET";
+    ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+            << "Failed to deallocate the resources for synthesizer library";
+
+    // un-mute in the middle of a frame
+    const EAS_U32 unmuteOffset = 20 * mEASConfig->mixBufferSize + mEASConfig->mixBufferSize / 2 + 7;
+    EAS_I32 first;
+    firstSound(unmuteOffset, &first);
+    ASSERT_GE(first, (EAS_I32) unmuteOffset) << "Sound before the segment was un-muted";
+
+    // the note heard first now starts while the segment is still muted
+    EAS_I32 later;
+    firstSound(first + 1, &later);
+    ASSERT_GT(later, first) << "Note that started before the mute change was heard";
+}
+
+static const int16_t kImaStepTable[89] = {
+        7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,
+        23,    25,    28,    31,    34,    37,    41,    45,    50,    55,    60,    66,
+        73,    80,    88,    97,    107,   118,   130,   143,   157,   173,   190,   209,
+        230,   253,   279,   307,   337,   371,   408,   449,   494,   544,   598,   658,
+        724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+        2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,
+        7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
+        22385, 24623, 27086, 29794, 32767};
+static const int kImaIndexTable[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+// IMA ADPCM encoder
+struct ImaEncoder {
+    int pred = 0;
+    int index = 0;
+    // returns the nibble, pred is left at the value the decoder produces
+    int encode(int sample) {
+        int step = kImaStepTable[index];
+        int diff = sample - pred;
+        int nibble = 0;
+        if (diff < 0) {
+            nibble = 8;
+            diff = -diff;
+        }
+        int delta = step >> 3;
+        for (int bit = 4; bit; bit >>= 1, step >>= 1) {
+            if (diff >= step) {
+                nibble |= bit;
+                diff -= step;
+                delta += step;
+            }
+        }
+        pred = std::clamp((nibble & 8) ? pred - delta : pred + delta, -32768, 32767);
+        index = std::clamp(index + kImaIndexTable[nibble & 7], 0, 88);
+        return nibble;
+    }
+};
+
+TEST_P(SonivoxTest, WaveFileTest) {
+    // an IMA ADPCM file and a 16-bit file of the samples it decodes to must
+    // play the same audio, from the start and after a locate into a block
+    constexpr uint32_t kSampleRate = 16000;
+    constexpr int kSamplesPerBlock = 505;
+    constexpr int kNumBlocks = 16;
+    // the last block is short, a header frame and 25 groups of 8 frames
+    constexpr int kLastBlockFrames = 201;
+    constexpr int kNumFrames = kNumBlocks * kSamplesPerBlock + kLastBlockFrames;
+    constexpr EAS_I32 kPlayTimeMs = (EAS_I32)(kNumFrames * 1000LL / kSampleRate);
+
+
+    auto put16 = [](vector<uint8_t> &v, uint32_t x) {
+        v.push_back(x & 0xff);
+        v.push_back((x >> 8) & 0xff);
+    };
+    auto put32 = [&](vector<uint8_t> &v, uint32_t x) {
+        put16(v, x & 0xffff);
+        put16(v, x >> 16);
+    };
+    auto putID = [](vector<uint8_t> &v, const char *id) { v.insert(v.end(), id, id + 4); };
+
+    // a RIFF file with an odd sized chunk before the format
+    auto makeWave = [&](uint16_t formatTag, uint16_t channels, uint16_t blockAlign,
+                        uint16_t bitsPerSample, const vector<uint8_t> &audio) {
+        vector<uint8_t> fmt;
+        put16(fmt, formatTag);
+        put16(fmt, channels);
+        put32(fmt, kSampleRate);
+        put32(fmt, kSampleRate * blockAlign / (formatTag == 1 ? 1 : kSamplesPerBlock));
+        put16(fmt, blockAlign);
+        put16(fmt, bitsPerSample);
+        if (formatTag != 1) {
+            put16(fmt, 2);
+            put16(fmt, kSamplesPerBlock);
+        }
+        vector<uint8_t> wave;
+        putID(wave, "RIFF");
+        put32(wave, 4 + 12 + 8 + fmt.size() + 8 + audio.size());
+        putID(wave, "WAVE");
+        putID(wave, "JUNK");
+        put32(wave, 3);
+        wave.insert(wave.end(), {1, 2, 3, 0});
+        putID(wave, "fmt ");
+        put32(wave, fmt.size());
+        wave.insert(wave.end(), fmt.begin(), fmt.end());
+        putID(wave, "data");
+        put32(wave, audio.size());
+        wave.insert(wave.end(), audio.begin(), audio.end());
+        return wave;
+    };
+
+    // plays a file to the end, returns the output, file type and play length
+    auto play = [&](const vector<uint8_t> &wave, EAS_I32 locateMs, vector<EAS_PCM> *pOutput,
+                    EAS_I32 *pFileType, EAS_I32 *pPlayTimeMs, bool *pSupported) {
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        ASSERT_EQ(EAS_Init(&easDataHandle), EAS_SUCCESS)
+                << "Failed to initialize synthesizer library";
+        EAS_FILE memLocator;
+        EAS_MEMORY_FILE memFile;
+        EAS_InitMemoryLocator(&memLocator, &memFile, wave.data(), wave.size());
+        EAS_HANDLE easStreamHandle = nullptr;
+        EAS_RESULT result = EAS_OpenFile(easDataHandle, &memLocator, &easStreamHandle);
+        *pSupported = (result != EAS_ERROR_UNRECOGNIZED_FORMAT);
+        if (!*pSupported) {
+            EAS_Shutdown(easDataHandle);
+            return;
+        }
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to open the WAVE file";
+        ASSERT_EQ(EAS_GetFileType(easDataHandle, easStreamHandle, pFileType), EAS_SUCCESS)
+                << "Failed to get the file type";
+        ASSERT_EQ(EAS_Prepare(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to prepare the WAVE file";
+        ASSERT_EQ(EAS_ParseMetaData(easDataHandle, easStreamHandle, pPlayTimeMs), EAS_SUCCESS)
+                << "Failed to parse the metadata";
+        if (locateMs) {
+            ASSERT_EQ(EAS_Locate(easDataHandle, easStreamHandle, locateMs, EAS_FALSE),
+                      EAS_SUCCESS)
+                    << "Failed to locate";
+        }
+
+        vector<EAS_PCM> buffer(mEASConfig->mixBufferSize * mEASConfig->numChannels);
+        EAS_STATE state = EAS_STATE_PLAY;
+        EAS_I32 count;
+        for (int frame = 0; (frame < 2000) && (state != EAS_STATE_STOPPED); frame++) {
+            ASSERT_EQ(EAS_Render(easDataHandle, buffer.data(), mEASConfig->mixBufferSize, &count),
+                      EAS_SUCCESS)
+                    << "Failed to render the audio data";
+            pOutput->insert(pOutput->end(), buffer.begin(),
+                            buffer.begin() + count * mEASConfig->numChannels);
+            ASSERT_EQ(EAS_State(easDataHandle, easStreamHandle, &state), EAS_SUCCESS)
+                    << "Failed to get the stream state";
+        }
+        ASSERT_EQ(state, EAS_STATE_STOPPED) << "WAVE file did not stop";
+        ASSERT_EQ(EAS_CloseFile(easDataHandle, easStreamHandle), EAS_SUCCESS)
+                << "Failed to close audio file/stream";
+        ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+                << "Failed to deallocate the resources for synthesizer library";
+    };
+
+    for (uint16_t channels = 1; channels <= 2; channels++) {
+        const uint16_t blockAlign = channels == 1 ? 256 : 512;
+        vector<ImaEncoder> encoders(channels);
+        vector<uint8_t> ima;
+        vector<uint8_t> pcm;
+        for (int start = 0; start < kNumFrames; start += kSamplesPerBlock) {
+            const int frames = std::min(kSamplesPerBlock, kNumFrames - start);
+            vector<vector<int>> nibbles(channels);
+            vector<vector<int>> decoded(channels);
+            for (int ch = 0; ch < channels; ch++) {
+                for (int i = 0; i < frames; i++) {
+                    const double t = (double)(start + i) / kSampleRate;
+                    const int sample = (int)(9000 * sin(2 * M_PI * (440 + 220 * ch) * t) +
+                                             4000 * sin(2 * M_PI * 1234 * t));
+                    if (i == 0) {
+                        encoders[ch].pred = sample;
+                        put16(ima, (uint16_t)sample);
+                        ima.push_back(encoders[ch].index);
+                        ima.push_back(0);
+                    } else {
+                        nibbles[ch].push_back(encoders[ch].encode(sample));
+                    }
+                    decoded[ch].push_back(encoders[ch].pred);
+                }
+            }
+            for (int i = 0; i < frames; i++) {
+                for (int ch = 0; ch < channels; ch++) {
+                    put16(pcm, (uint16_t)decoded[ch][i]);
+                }
+            }
+            // mono packs two frames a byte, stereo alternates 8 frames of each channel
+            const int groupSize = channels == 1 ? 2 : 8;
+            for (size_t i = 0; i < nibbles[0].size(); i += groupSize) {
+                for (int ch = 0; ch < channels; ch++) {
+                    for (int j = 0; j < groupSize; j += 2) {
+                        ima.push_back(nibbles[ch][i + j] | nibbles[ch][i + j + 1] << 4);
+                    }
+                }
+            }
+        }
+        const vector<uint8_t> imaWave = makeWave(0x11, channels, blockAlign, 4, ima);
+        const vector<uint8_t> pcmWave = makeWave(1, channels, channels * 2, 16, pcm);
+
+        for (EAS_I32 locateMs : {0, 250}) {
+            vector<EAS_PCM> imaOutput;
+            vector<EAS_PCM> pcmOutput;
+            EAS_I32 imaType, pcmType, imaTimeMs, pcmTimeMs;
+            bool supported;
+            play(imaWave, locateMs, &imaOutput, &imaType, &imaTimeMs, &supported);
+            if (!supported) {
+                GTEST_SKIP() << "WAVE files are not supported in this build";
+            }
+            play(pcmWave, locateMs, &pcmOutput, &pcmType, &pcmTimeMs, &supported);
+            ASSERT_FALSE(HasFatalFailure());
+
+            EXPECT_EQ(imaType, EAS_FILE_WAVE_IMA_ADPCM) << "Wrong type for IMA ADPCM file";
+            EXPECT_EQ(pcmType, EAS_FILE_WAVE_PCM) << "Wrong type for 16-bit file";
+            EXPECT_EQ(imaTimeMs, kPlayTimeMs) << "Wrong play time for IMA ADPCM file";
+            EXPECT_EQ(pcmTimeMs, kPlayTimeMs) << "Wrong play time for 16-bit file";
+            EXPECT_EQ(imaOutput, pcmOutput) << "IMA ADPCM and 16-bit files differ, channels "
+                                            << channels << ", locate " << locateMs << " ms";
+            EXPECT_NE(std::count(imaOutput.begin(), imaOutput.end(), 0), (long)imaOutput.size())
+                    << "WAVE file rendered silence";
+            // the file plays for its length, give or take a mix buffer
+            const int64_t frames = imaOutput.size() / mEASConfig->numChannels;
+            const int64_t expected =
+                    (int64_t)(kPlayTimeMs - locateMs) * mEASConfig->sampleRate / 1000;
+            EXPECT_NEAR(frames, expected, 2 * mEASConfig->mixBufferSize)
+                    << "Wrong rendered length, channels " << channels;
+        }
+    }
+}
+
+TEST_P(SonivoxTest, ADPCMSampleTest) {
+    // compress the unlooped samples of the built-in library to IMA ADPCM in
+    // a sound library file; drums played from it must match a library of
+    // the samples the compressed ones decode to, in a quarter of the memory
+    EAS_I32 size;
+    EAS_RESULT result = EAS_WriteSoundLibrary(mEASDataHandle, nullptr, nullptr, 0, &size);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "External sound libraries not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to size the sound library";
+    vector<uint8_t> image(size);
+    ASSERT_EQ(EAS_WriteSoundLibrary(mEASDataHandle, nullptr, image.data(), size, &size),
+              EAS_SUCCESS)
+            << "Failed to write the sound library";
+
+    // the fields of eas_soundbank.h used here
+    constexpr uint32_t kSixteenBitSamples = 0x00200000;
+    constexpr uint16_t kRegionLooped = 0x01;
+    constexpr uint16_t kRegionWaveGenerator = 0x02;
+    constexpr uint16_t kRegionADPCM = 0x04;
+    auto get16 = [&](size_t pos) { return (uint32_t)(image[pos] | image[pos + 1] << 8); };
+    auto get32 = [&](size_t pos) { return get16(pos) | get16(pos + 2) << 16; };
+    auto put16 = [&](size_t pos, uint32_t x) {
+        image[pos] = x & 0xff;
+        image[pos + 1] = (x >> 8) & 0xff;
+    };
+    const bool sixteenBit = (get32(12) & kSixteenBitSamples) != 0;
+    const uint32_t numRegions = get16(20);
+    const uint32_t numSamples = get16(24);
+    const size_t regions = get32(28) + get16(16) * 258 + get16(18) * 8;
+    const size_t sampleLengths = regions + numRegions * 20 + get16(22) * 32;
+    const size_t sampleOffsets = sampleLengths + numSamples * 4;
+    const size_t samples = get32(36);
+
+    // only samples that no region loops or generates can be compressed
+    vector<bool> compress(numSamples, true);
+    for (uint32_t i = 0; i < numRegions; i++) {
+        if (get16(regions + i * 20) & (kRegionLooped | kRegionWaveGenerator)) {
+            compress[get16(regions + i * 20 + 16)] = false;
+        }
+    }
+    vector<uint8_t> decoded(image);
+    auto putLength = [&](vector<uint8_t> &file, uint32_t i, uint32_t length) {
+        for (int j = 0; j < 4; j++) file[sampleLengths + i * 4 + j] = (length >> (8 * j)) & 0xff;
+    };
+    size_t before = 0;
+    size_t after = 0;
+    for (uint32_t i = 0; i < numSamples; i++) {
+        const uint32_t length = get32(sampleLengths + i * 4);
+        // an odd number of samples fills the last byte
+        int count = sixteenBit ? length / 2 : length;
+        count -= (count & 1) ^ 1;
+        if (!compress[i] || count < 3) {
+            compress[i] = false;
+            continue;
+        }
+        before += length;
+        const size_t pos = samples + get32(sampleOffsets + i * 4);
+        vector<int> pcm(count);
+        for (int j = 0; j < count; j++) {
+            pcm[j] = sixteenBit ? (int16_t)get16(pos + 2 * j) : (int8_t)image[pos + j] * 256;
+        }
+
+        // start with the step that best follows the attack
+        int bestIndex = 0;
+        double bestError = -1;
+        for (int index = 0; index <= 88; index++) {
+            ImaEncoder encoder;
+            encoder.pred = pcm[0];
+            encoder.index = index;
+            double error = 0;
+            for (int j = 1; j < std::min(count, 32); j++) {
+                encoder.encode(pcm[j]);
+                error += (double)(encoder.pred - pcm[j]) * (encoder.pred - pcm[j]);
+            }
+            if (bestError < 0 || error < bestError) {
+                bestError = error;
+                bestIndex = index;
+            }
+        }
+        ImaEncoder encoder;
+        encoder.pred = pcm[0];
+        encoder.index = bestIndex;
+        vector<uint8_t> adpcm = {(uint8_t)(pcm[0] & 0xff), (uint8_t)((pcm[0] >> 8) & 0xff),
+                                 (uint8_t)bestIndex, 0};
+        for (int j = 1; j < count; j++) {
+            const int nibble = encoder.encode(pcm[j]);
+            if (sixteenBit) {
+                decoded[pos + 2 * j] = encoder.pred & 0xff;
+                decoded[pos + 2 * j + 1] = (encoder.pred >> 8) & 0xff;
+            }
+            if (j & 1) {
+                adpcm.push_back(nibble);
+            } else {
+                adpcm.back() |= nibble << 4;
+            }
+        }
+        std::copy(adpcm.begin(), adpcm.end(), image.begin() + pos);
+        putLength(image, i, adpcm.size());
+        putLength(decoded, i, count * 2);
+        after += adpcm.size();
+    }
+    for (uint32_t i = 0; i < numRegions; i++) {
+        if (compress[get16(regions + i * 20 + 16)]) {
+            put16(regions + i * 20, get16(regions + i * 20) | kRegionADPCM);
+        }
+    }
+    ASSERT_GT(before, 0) << "No samples to compress";
+
+    // plays drum notes on an instance using the library, nullptr for the built-in
+    constexpr int kNumFrames = 256;
+    auto playDrums = [&](EAS_FILE_LOCATOR library, vector<EAS_PCM> *pOutput, bool *pSupported) {
+        EAS_DATA_HANDLE easDataHandle = nullptr;
+        S_EAS_INIT_CONFIG initConfig = {0, 0, library};
+        EAS_RESULT result = EAS_InitEx(&easDataHandle, &initConfig);
+        *pSupported = (result != EAS_ERROR_SOUND_LIBRARY);
+        if (!*pSupported) return;
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to initialize synthesizer library";
+        EAS_HANDLE midiStreamHandle = nullptr;
+        ASSERT_EQ(EAS_OpenMIDIStream(easDataHandle, &midiStreamHandle, nullptr), EAS_SUCCESS)
+                << "Failed to open MIDI stream";
+        pOutput->resize(kNumFrames * mEASConfig->mixBufferSize * mEASConfig->numChannels);
+        const size_t frameSize = mEASConfig->mixBufferSize * mEASConfig->numChannels;
+        EAS_I32 count;
+        for (int frame = 0; frame < kNumFrames; frame++) {
+            // a new drum every 16 frames
+            if ((frame & 15) == 0) {
+                EAS_U8 noteOn[] = {0x99, (EAS_U8)(35 + frame / 16 * 3), 110};
+                ASSERT_EQ(EAS_WriteMIDIStream(easDataHandle, midiStreamHandle, noteOn,
+                                              sizeof(noteOn)),
+                          EAS_SUCCESS)
+                        << "Failed to write MIDI stream";
+            }
+            ASSERT_EQ(EAS_Render(easDataHandle, pOutput->data() + frame * frameSize,
+                                 mEASConfig->mixBufferSize, &count),
+                      EAS_SUCCESS)
+                    << "Failed to render the audio data";
+        }
+        ASSERT_EQ(EAS_CloseMIDIStream(easDataHandle, midiStreamHandle), EAS_SUCCESS)
+                << "Failed to close MIDI stream";
+        ASSERT_EQ(EAS_Shutdown(easDataHandle), EAS_SUCCESS)
+                << "Failed to deallocate the resources for synthesizer library";
+    };
+
+    EAS_FILE libLocator;
+    EAS_MEMORY_FILE libFile;
+    EAS_InitMemoryLocator(&libLocator, &libFile, image.data(), size);
+    vector<EAS_PCM> builtIn;
+    vector<EAS_PCM> actual;
+    bool supported;
+    ASSERT_NO_FATAL_FAILURE(playDrums(&libLocator, &actual, &supported));
+    if (!supported) {
+        GTEST_SKIP() << "Compressed samples not supported";
+    }
+    ASSERT_NO_FATAL_FAILURE(playDrums(nullptr, &builtIn, &supported));
+    EXPECT_LT(after * 3, before) << "Compressed samples are not much smaller";
+
+    // the signal to noise ratio of a against b in dB
+    auto snr = [](const vector<EAS_PCM> &a, const vector<EAS_PCM> &b) {
+        double signal = 0;
+        double noise = 0;
+        for (size_t i = 0; i < a.size(); i++) {
+            signal += (double)b[i] * b[i];
+            noise += (double)(a[i] - b[i]) * (a[i] - b[i]);
+        }
+        return noise > 0 ? 10 * log10(signal / noise) : INFINITY;
+    };
+    ASSERT_FALSE(std::all_of(builtIn.begin(), builtIn.end(), [](EAS_PCM x) { return x == 0; }))
+            << "Drums did not play";
+    ASSERT_NE(actual, builtIn) << "Compressed samples were not played";
+    EXPECT_GT(snr(actual, builtIn), 10) << "Compressed drums do not sound like the built-in ones";
+
+    // only the sample after the end of each drum can differ from the decoded samples
+    if (sixteenBit) {
+        vector<EAS_PCM> expected;
+        EAS_InitMemoryLocator(&libLocator, &libFile, decoded.data(), size);
+        ASSERT_NO_FATAL_FAILURE(playDrums(&libLocator, &expected, &supported));
+        EXPECT_GT(snr(actual, expected), 60) << "Compressed samples decoded wrongly";
+    }
+}
+
+TEST_P(SonivoxTest, FMEngineTest) {
+    EAS_RESULT result = EAS_SetSynthEngine(mEASDataHandle, EAS_SYNTH_ENGINE_FM);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "FM engine not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to select the FM engine";
+    result = EAS_SetSynthEngine(mEASDataHandle, EAS_SYNTH_ENGINE_FM + 1);
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Unknown engine accepted";
+    result = EAS_SetStreamEngine(mEASDataHandle, mEASStreamHandle, 16,
+                                 EAS_SYNTH_ENGINE_FM);
+    ASSERT_EQ(result, EAS_ERROR_PARAMETER_RANGE) << "Channel out of range accepted";
+
+    EAS_I32 totalSamples = mEASConfig->mixBufferSize * kNumBuffersToCombine * 64;
+    vector<EAS_PCM> fm(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, fm));
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+    vector<EAS_PCM> wavetable(fm.size());
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, wavetable));
+    ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+
+    ASSERT_TRUE(std::any_of(fm.begin(), fm.end(), [](EAS_PCM sample) { return sample != 0; }))
+            << "FM engine is silent";
+    ASSERT_NE(fm, wavetable) << "FM engine plays the wavetable";
+
+    // a stream that selects the wavetable for all its channels is not
+    // affected by the instance setting
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+    result = EAS_SetSynthEngine(easDataHandle, EAS_SYNTH_ENGINE_FM);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to select the FM engine";
+    result = EAS_SetStreamEngine(easDataHandle, easStreamHandle, -1, EAS_SYNTH_ENGINE_WAVETABLE);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to select the stream engine";
+    vector<EAS_PCM> stream(fm.size());
+    ASSERT_NO_FATAL_FAILURE(renderFrames(easDataHandle, stream));
+    ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+    ASSERT_TRUE(stream == wavetable) << "Stream engine overridden by the instance";
+}
+
+TEST_P(SonivoxTest, PipelinedRenderTest) {
+    EAS_RESULT result = EAS_SetPipelinedRender(mEASDataHandle, EAS_TRUE);
+    if (result == EAS_ERROR_FEATURE_NOT_AVAILABLE) {
+        GTEST_SKIP() << "Pipelined render not supported";
+    }
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to start the pipelined render";
+
+    // several frames per call, and a call that ends part way through a frame
+    EAS_I32 chunk = mEASConfig->mixBufferSize * kNumBuffersToCombine + mEASConfig->mixBufferSize / 2;
+    EAS_I32 totalSamples = chunk * 32;
+    auto render = [&](EAS_DATA_HANDLE easDataHandle, vector<EAS_PCM> &output) {
+        EAS_I32 count;
+        for (size_t offset = 0; offset < output.size(); offset += count * mEASConfig->numChannels) {
+            EAS_RESULT result = EAS_Render(easDataHandle, &output[offset], chunk, &count);
+            ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+            ASSERT_EQ(count, chunk) << "Short render";
+        }
+    };
+    vector<EAS_PCM> pipelined(totalSamples * mEASConfig->numChannels);
+    ASSERT_NO_FATAL_FAILURE(render(mEASDataHandle, pipelined));
+    EAS_I32 pipelinedMs = 0;
+    result = EAS_GetLocation(mEASDataHandle, mEASStreamHandle, &pipelinedMs);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the location";
+
+    EAS_DATA_HANDLE easDataHandle = nullptr;
+    EAS_HANDLE easStreamHandle = nullptr;
+    ASSERT_NO_FATAL_FAILURE(openInstance(&easDataHandle, &easStreamHandle));
+    vector<EAS_PCM> serial(pipelined.size());
+    ASSERT_NO_FATAL_FAILURE(render(easDataHandle, serial));
+    EAS_I32 serialMs = 0;
+    result = EAS_GetLocation(easDataHandle, easStreamHandle, &serialMs);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to get the location";
+    ASSERT_NO_FATAL_FAILURE(closeInstance(easDataHandle, easStreamHandle));
+
+    ASSERT_TRUE(pipelined == serial) << "Pipelined render differs from the serial render";
+    ASSERT_EQ(pipelinedMs, serialMs) << "Pipelined render is at a different location";
+
+    // the render carries on in frame order after the pipeline is stopped
+    result = EAS_SetPipelinedRender(mEASDataHandle, EAS_FALSE);
+    ASSERT_EQ(result, EAS_SUCCESS) << "Failed to stop the pipelined render";
+    ASSERT_NO_FATAL_FAILURE(renderFrames(mEASDataHandle, pipelined));
+}
+
 INSTANTIATE_TEST_SUITE_P(SonivoxTestAll, SonivoxTest,
                          ::testing::Values(make_tuple("midi_a.mid", 2000, 2, 22050),
                                            make_tuple("midi8sec.mid", 8002, 2, 22050),